@@ -15,13 +15,20 @@
 #include "util/fileutils.h"
 #include "log/Logger.h"
 #include "lb/HFunction.h"
+#include "lb/WarmStart.h"
 #include "io/xml/XmlAbstractionLayer.h"
 #include "colloids/ColloidController.h"
 #include "net/BuildInfo.h"
 #include "net/IOCommunicator.h"
+#include "net/ProgressThread.h"
 #include "colloids/BodyForces.h"
 #include "colloids/BoundaryConditions.h"
+#ifdef HEMELB_USE_CATALYST
+#include "extraction/CatalystBackend.h"
+#endif
 
+#include <algorithm>
+#include <iterator>
 #include <map>
 #include <limits>
 #include <cstdlib>
@@ -33,8 +40,11 @@
  * object.
  */
 SimulationMaster::SimulationMaster(hemelb::configuration::CommandLine & options, const hemelb::net::IOCommunicator& ioComm) :
-  ioComms(ioComm), timings(ioComm), build_info(), communicationNet(ioComm)
+  ioComms(ioComm), timings(ioComm), build_info(), communicationNet(ioComm), commsStatistics(ioComm),
+      loadImbalance(ioComm), performance(ioComm), memoryUsage(ioComm),
+      prediction(ioComm), commsAutotuner(ioComm)
 {
+  communicationNet.SetStatistics(&commsStatistics);
   timings[hemelb::reporting::Timers::total].Start();
 
   latticeData = NULL;
@@ -42,33 +52,96 @@ SimulationMaster::SimulationMaster(hemelb::configuration::CommandLine & options,
   colloidController = NULL;
   latticeBoltzmannModel = NULL;
   steeringCpt = NULL;
+  regionStreamer = NULL;
+  flightRecorder = NULL;
   propertyDataSource = NULL;
   visualisationControl = NULL;
   propertyExtractor = NULL;
+  probeActor = NULL;
+  flowDiagnosticsActor = NULL;
+  inSituAdaptor = NULL;
   simulationState = NULL;
   stepManager = NULL;
   netConcern = NULL;
+  stepTracer = NULL;
   neighbouringDataManager = NULL;
+  network = NULL;
+  imageSendCpt = NULL;
+  inletValues = NULL;
+  outletValues = NULL;
+  stabilityTester = NULL;
+  steadyStateAccelerator = NULL;
+  entropyTester = NULL;
+  incompressibilityChecker = NULL;
   imagesPerSimulation = options.NumberOfImages();
   steeringSessionId = options.GetSteeringSessionId();
+  decompositionToLoad = options.GetDecompositionToLoad();
+  decompositionToSave = options.GetDecompositionToSave();
+  decompositionCache = options.GetDecompositionCache();
+  siteWeightsFile = options.GetSiteWeightsFile();
+  rebalancePeriod = options.GetRebalancePeriod();
+  rebalanceThreshold = options.GetRebalanceThreshold();
+  lbTimeAtLastBalanceCheck = 0.0;
+  colloidTimeAtLastBalanceCheck = 0.0;
+  firstSimulatedStep = 1;
+  checkpointPeriod = options.GetCheckpointPeriod();
+  captureStep = options.GetCaptureStep();
+  captureRank = options.GetCaptureRank();
+  flightRecorderSamples = options.GetFlightRecorderSamples();
+  flightRecorderPeriod = options.GetFlightRecorderPeriod();
+  flightRecorderFields = options.GetFlightRecorderFields();
+  flightRecorderRegion = options.GetFlightRecorderRegion();
+  flightRecorderWrites = 0;
+  restartFile = options.GetRestartFile();
+  serverFile = options.GetServerFile();
+  restartsDone = 0;
+  nodeSharedGeometry = options.GetNodeSharedGeometry();
+  dryRun = options.GetDryRun();
+  commsStrategy = options.GetCommsStrategy();
+  autotuneComms = options.GetAutotuneComms();
+  // The nets made from now on start with the chosen comms, as well as the simulation's.
+  hemelb::net::CommsStrategy::SetDefault(commsStrategy);
+  communicationNet.SetStrategy(commsStrategy);
+  commsAutotuner.SetStrategy(commsStrategy);
 
   fileManager = new hemelb::io::PathManager(options, IsCurrentProcTheIOProc(), GetProcessorCount());
-  simConfig = hemelb::configuration::SimConfig::New(fileManager->GetInputFile());
+  simConfig = hemelb::configuration::SimConfig::New(fileManager->GetInputFile(), ioComms);
   unitConverter = &simConfig->GetUnitConverter();
   monitoringConfig = simConfig->GetMonitoringConfiguration();
 
   fileManager->SaveConfiguration(simConfig);
+  if (options.GetTraceLastStep() > 0)
+  {
+    stepTracer = new hemelb::net::phased::StepTracer(ioComms,
+                                                     options.GetTraceFirstStep(),
+                                                     options.GetTraceLastStep());
+  }
+  checkpoint = checkpointPeriod > 0 ?
+    new hemelb::lb::Checkpoint(fileManager->GetCheckpointPath(),
+                               ioComms,
+                               options.GetCheckpointEncoding(),
+                               options.GetCheckpointRanksPerFile()) :
+    NULL;
   Initialise();
   if (IsCurrentProcTheIOProc())
   {
     reporter = new hemelb::reporting::Reporter(fileManager->GetReportPath(),
                                                fileManager->GetInputFile());
     reporter->AddReportable(&build_info);
-    if (monitoringConfig->doIncompressibilityCheck)
+    if (incompressibilityChecker != NULL)
     {
       reporter->AddReportable(incompressibilityChecker);
     }
     reporter->AddReportable(&timings);
+    reporter->AddReportable(&commsStatistics);
+    reporter->AddReportable(&commsAutotuner);
+    reporter->AddReportable(&loadImbalance);
+    reporter->AddReportable(&performance);
+    reporter->AddReportable(&memoryUsage);
+    if (dryRun)
+    {
+      reporter->AddReportable(&prediction);
+    }
     reporter->AddReportable(latticeData);
     reporter->AddReportable(simulationState);
   }
@@ -93,15 +166,22 @@ SimulationMaster::~SimulationMaster()
   delete outletValues;
   delete network;
   delete steeringCpt;
+  delete regionStreamer;
+  delete flightRecorder;
   delete visualisationControl;
   delete propertyExtractor;
+  delete probeActor;
+  delete flowDiagnosticsActor;
+  delete inSituAdaptor;
   delete propertyDataSource;
   delete stabilityTester;
+  delete steadyStateAccelerator;
   delete entropyTester;
   delete simulationState;
   delete incompressibilityChecker;
   delete neighbouringDataManager;
 
+  delete checkpoint;
   delete simConfig;
   delete fileManager;
   if (IsCurrentProcTheIOProc())
@@ -110,6 +190,7 @@ SimulationMaster::~SimulationMaster()
   }
   delete stepManager;
   delete netConcern;
+  delete stepTracer;
 }
 
 /**
@@ -137,6 +218,12 @@ void SimulationMaster::Initialise()
 {
 
   hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Beginning Initialisation.");
+#ifdef HEMELB_USE_MPI_PROGRESS_THREAD
+  if (!hemelb::net::ProgressThread::IsRunning())
+  {
+    hemelb::log::Logger::Log<hemelb::log::Warning, hemelb::log::Singleton>("MPI doesn't provide MPI_THREAD_MULTIPLE, so there is no MPI progress thread.");
+  }
+#endif
 
   simulationState = new hemelb::lb::SimulationState(simConfig->GetTimeStepLength(),
                                                     simConfig->GetTotalTimeSteps());
@@ -150,14 +237,90 @@ void SimulationMaster::Initialise()
   hemelb::geometry::GeometryReader reader(hemelb::steering::SteeringComponent::RequiresSeparateSteeringCore(),
                                           latticeType::GetLatticeInfo(),
                                           timings, ioComms);
+  if (!siteWeightsFile.empty()
+      && hemelb::geometry::decomposition::SiteWeights::Load(siteWeightsFile, ioComms, siteWeights))
+  {
+    hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Using the site weights in %s",
+                                                                        siteWeightsFile.c_str());
+  }
+  reader.SetSiteWeights(siteWeights);
+  reader.SetNodeSharedRead(nodeSharedGeometry);
+  reader.SetBalanceConstraints(simConfig->GetBalanceConstraints());
   hemelb::geometry::Geometry readGeometryData =
-      reader.LoadAndDecompose(simConfig->GetDataFilePath());
-
-  // Create a new lattice based on that info and return it.
-  latticeData = new hemelb::geometry::LatticeData(latticeType::GetLatticeInfo(), readGeometryData, ioComms);
+      reader.LoadAndDecompose(simConfig->GetDataFilePath(),
+                              decompositionToLoad,
+                              decompositionToSave,
+                              decompositionCache);
+  memoryUsage.RecordStage("geometry reading and decomposition");
+
+  // Create a new lattice based on that info and return it. A dry run only needs its size.
+#ifndef HEMELB_STABILISED_KERNEL
+  if (!simConfig->GetStabilisedRegions().empty())
+  {
+    hemelb::log::Logger::Log<hemelb::log::Warning, hemelb::log::Singleton>("Ignoring the stabilised regions, as there is no HEMELB_STABILISED_KERNEL.");
+  }
+#endif
+#ifndef HEMELB_USE_COMPRESSED_COLD_SITES
+  if (!simConfig->GetCompressedRegions().empty())
+  {
+    hemelb::log::Logger::Log<hemelb::log::Warning, hemelb::log::Singleton>("Ignoring the compressed regions, as there is no HEMELB_USE_COMPRESSED_COLD_SITES.");
+  }
+#endif
+  latticeData = new hemelb::geometry::LatticeData(latticeType::GetLatticeInfo(),
+                                                  readGeometryData,
+                                                  ioComms,
+                                                  !dryRun,
+                                                  GetStabilisedRegions(),
+                                                  GetCompressedRegions());
+  memoryUsage.RecordStage("lattice data");
+  // The reader's arenas go with it at the end of the initialisation.
+  memoryUsage.RecordSubsystem("geometry reading arenas (peak)", reader.GetArenaPeakBytes());
 
   timings[hemelb::reporting::Timers::latDatInitialise].Stop();
 
+  if (dryRun)
+  {
+    return;
+  }
+
+  // Initialise and begin the steering.
+  if (ioComms.OnIORank())
+  {
+    network = new hemelb::steering::Network(steeringSessionId, timings);
+  }
+  else
+  {
+    network = NULL;
+  }
+
+  InitialiseActors(readGeometryData);
+
+  if (!restartFile.empty())
+  {
+    RestoreCheckpoint();
+    memoryUsage.RecordStage("checkpoint restoring");
+  }
+  else if (!simConfig->GetWarmStartPath().empty())
+  {
+    WarmStart();
+    memoryUsage.RecordStage("warm start");
+  }
+
+  if (autotuneComms)
+  {
+    AutotuneComms();
+  }
+}
+
+/**
+ * Creates the LBM and everything else that works on the lattice data. This is done again
+ * whenever the domain is rebalanced; the network, simulation state and property extractor live
+ * for the whole run.
+ */
+void SimulationMaster::InitialiseActors(const hemelb::geometry::Geometry& geometry,
+                                        hemelb::colloids::ColloidController* previousColloidController,
+                                        const std::vector<hemelb::proc_t>& procForEachPreviousSite)
+{
   neighbouringDataManager =
       new hemelb::geometry::neighbouring::NeighbouringDataManager(*latticeData,
                                                                   latticeData->GetNeighbouringData(),
@@ -169,10 +332,29 @@ void SimulationMaster::Initialise()
                                                            simulationState,
                                                            timings,
                                                            neighbouringDataManager);
+  latticeBoltzmannModel->SetSiteWeights(siteWeights.GetWeights());
+  memoryUsage.RecordStage("lattice Boltzmann model");
 
   hemelb::lb::MacroscopicPropertyCache& propertyCache = latticeBoltzmannModel->GetPropertyCache();
 
-  if (simConfig->HasColloidSection())
+  if (previousColloidController != NULL)
+  {
+    timings[hemelb::reporting::Timers::colloidInitialisation].Start();
+    hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Moving Colloids onto the new decomposition.");
+    hemelb::colloids::BoundaryConditions::SetLatticeData(latticeData);
+    colloidController =
+        new hemelb::colloids::ColloidController(*latticeData,
+                                                *simulationState,
+                                                geometry,
+                                                propertyCache,
+                                                latticeBoltzmannModel->GetLbmParams(),
+                                                ioComms,
+                                                timings,
+                                                *previousColloidController,
+                                                procForEachPreviousSite);
+    timings[hemelb::reporting::Timers::colloidInitialisation].Stop();
+  }
+  else if (simConfig->HasColloidSection())
   {
     timings[hemelb::reporting::Timers::colloidInitialisation].Start();
     hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Loading Colloid config.");
@@ -180,7 +362,7 @@ void SimulationMaster::Initialise()
     hemelb::io::xml::Document xml(colloidConfigPath);
 
     hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Creating Body Forces.");
-    hemelb::colloids::BodyForces::InitBodyForces(xml);
+    hemelb::colloids::BodyForces::InitBodyForces(xml, *latticeData);
 
     hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Creating Boundary Conditions.");
     hemelb::colloids::BoundaryConditions::InitBoundaryConditions(latticeData, xml);
@@ -189,41 +371,43 @@ void SimulationMaster::Initialise()
     colloidController =
         new hemelb::colloids::ColloidController(*latticeData,
                                                 *simulationState,
-                                                readGeometryData,
+                                                geometry,
                                                 xml,
                                                 propertyCache,
                                                 latticeBoltzmannModel->GetLbmParams(),
                                                 fileManager->GetColloidPath(),
                                                 ioComms,
                                                 timings);
+    timings[hemelb::reporting::Timers::colloidInitialisation].Stop();
   }
-  timings[hemelb::reporting::Timers::colloidInitialisation].Stop();
 
-  // Initialise and begin the steering.
-  if (ioComms.OnIORank())
+  stabilityTester = new hemelb::lb::StabilityTester<latticeType, monitoringPolicy>(latticeData,
+                                                                                   &communicationNet,
+                                                                                   simulationState,
+                                                                                   latticeBoltzmannModel->GetPropertyCache(),
+                                                                                   timings,
+                                                                                   monitoringConfig);
+  steadyStateAccelerator = NULL;
+  if (monitoringConfig->accelerationPeriod > 0)
   {
-    network = new hemelb::steering::Network(steeringSessionId, timings);
+    steadyStateAccelerator = new hemelb::lb::SteadyStateAccelerator(*latticeData,
+                                                                    *simulationState,
+                                                                    ioComms,
+                                                                    timings,
+                                                                    monitoringConfig->accelerationPeriod,
+                                                                    monitoringConfig->accelerationFactor);
   }
-  else
-  {
-    network = NULL;
-  }
-
-  stabilityTester = new hemelb::lb::StabilityTester<latticeType>(latticeData,
-                                                                 &communicationNet,
-                                                                 simulationState,
-                                                                 timings,
-                                                                 monitoringConfig);
   entropyTester = NULL;
 
   if (monitoringConfig->doIncompressibilityCheck)
   {
-    incompressibilityChecker = new hemelb::lb::IncompressibilityChecker<
-        hemelb::net::PhasedBroadcastRegular<> >(latticeData,
-                                                &communicationNet,
-                                                simulationState,
-                                                latticeBoltzmannModel->GetPropertyCache(),
-                                                timings);
+    incompressibilityChecker = new hemelb::lb::IncompressibilityChecker<monitoringPolicy>(latticeData,
+                                                                                         &communicationNet,
+                                                                                         simulationState,
+                                                                                         latticeBoltzmannModel->GetPropertyCache(),
+                                                                                         timings,
+                                                                                         0.05,
+                                                                                         monitoringConfig->checkPeriod);
   }
   else
   {
@@ -238,6 +422,20 @@ void SimulationMaster::Initialise()
                                latticeBoltzmannModel->GetPropertyCache(),
                                latticeData,
                                timings[hemelb::reporting::Timers::visualisation]);
+  visualisationControl->visSettings.imageEncoding = simConfig->GetImageEncoding();
+  visualisationControl->visSettings.networkImageEncoding = simConfig->GetNetworkImageEncoding();
+  visualisationControl->visSettings.progressiveStride = simConfig->GetProgressiveStride();
+  const std::vector<hemelb::configuration::SimConfig::ImageView>& imageViews = simConfig->GetImageViews();
+  for (size_t view = 0; view < imageViews.size(); ++view)
+  {
+    visualisationControl->AddView(imageViews[view].pixelsX,
+                                  imageViews[view].pixelsY,
+                                  imageViews[view].longitude,
+                                  imageViews[view].latitude,
+                                  imageViews[view].zoom,
+                                  imageViews[view].mode);
+  }
+  memoryUsage.RecordStage("visualisation");
 
   if (ioComms.OnIORank())
   {
@@ -271,14 +469,6 @@ void SimulationMaster::Initialise()
   neighbouringDataManager->ShareNeeds();
   neighbouringDataManager->TransferNonFieldDependentInformation();
 
-  steeringCpt = new hemelb::steering::SteeringComponent(network,
-                                                        visualisationControl,
-                                                        imageSendCpt,
-                                                        &communicationNet,
-                                                        simulationState,
-                                                        simConfig,
-                                                        unitConverter);
-
   // Read in the visualisation parameters.
   latticeBoltzmannModel->ReadVisParameters();
 
@@ -288,11 +478,48 @@ void SimulationMaster::Initialise()
                                                    ioComms.Rank(),
                                                    *unitConverter);
 
-  if (simConfig->PropertyOutputCount() > 0)
+  // The region streamer reads the same data source, and is steered along with the rest.
+  regionStreamer = new hemelb::steering::RegionStreamer(*simulationState,
+                                                        *propertyDataSource,
+                                                        ioComms,
+                                                        network);
+  flightRecorder = flightRecorderSamples > 0 ?
+    new hemelb::extraction::FlightRecorder(*simulationState,
+                                           *propertyDataSource,
+                                           *latticeData,
+                                           ioComms,
+                                           flightRecorderSamples,
+                                           flightRecorderPeriod,
+                                           flightRecorderFields,
+                                           flightRecorderRegion) :
+    NULL;
+  steeringCpt = new hemelb::steering::SteeringComponent(network,
+                                                        visualisationControl,
+                                                        imageSendCpt,
+                                                        regionStreamer,
+                                                        &communicationNet,
+                                                        simulationState,
+                                                        simConfig,
+                                                        unitConverter);
+
+  if (propertyExtractor != NULL)
+  {
+    // Carry on writing the same files, from the new data source.
+    propertyExtractor->SetDataSource(*propertyDataSource);
+  }
+  else if (simConfig->PropertyOutputCount() > 0)
   {
 
     for (unsigned outputNumber = 0; outputNumber < simConfig->PropertyOutputCount(); ++outputNumber)
     {
+      // The triggers are on the quantities the incompressibility check finds.
+      if (!simConfig->GetPropertyOutput(outputNumber)->triggers.empty()
+          && !monitoringConfig->doIncompressibilityCheck)
+      {
+        throw hemelb::Exception() << "Property output "
+            << simConfig->GetPropertyOutput(outputNumber)->filename
+            << " has triggers, which need the incompressibility check";
+      }
       simConfig->GetPropertyOutput(outputNumber)->filename = fileManager->GetDataExtractionPath()
           + simConfig->GetPropertyOutput(outputNumber)->filename;
     }
@@ -303,11 +530,104 @@ void SimulationMaster::Initialise()
                                                               timings, ioComms);
   }
 
+  if (probeActor != NULL)
+  {
+    probeActor->SetDataSource(*propertyDataSource);
+  }
+  else if (simConfig->GetProbes() != NULL)
+  {
+    simConfig->GetProbes()->filename = fileManager->GetDataExtractionPath()
+        + simConfig->GetProbes()->filename;
+    probeActor = new hemelb::extraction::ProbeActor(*simulationState,
+                                                    simConfig->GetProbes(),
+                                                    *propertyDataSource,
+                                                    timings, ioComms);
+  }
+
+  if (flowDiagnosticsActor != NULL)
+  {
+    flowDiagnosticsActor->SetDataSource(*propertyDataSource, *latticeData);
+  }
+  else if (simConfig->GetFlowDiagnostics() != NULL)
+  {
+    simConfig->GetFlowDiagnostics()->filename = fileManager->GetDataExtractionPath()
+        + simConfig->GetFlowDiagnostics()->filename;
+    flowDiagnosticsActor = new hemelb::extraction::FlowDiagnosticsActor(*simulationState,
+                                                                        simConfig->GetFlowDiagnostics(),
+                                                                        *propertyDataSource,
+                                                                        *latticeData,
+                                                                        simConfig->GetInlets(),
+                                                                        simConfig->GetOutlets(),
+                                                                        timings,
+                                                                        ioComms);
+  }
+
+  if (inSituAdaptor != NULL)
+  {
+    inSituAdaptor->SetLatticeData(*latticeData, latticeBoltzmannModel->GetPropertyCache());
+  }
+  else if (!simConfig->GetInSituScript().empty())
+  {
+#ifdef HEMELB_USE_CATALYST
+    hemelb::extraction::InSituBackend* backend =
+        new hemelb::extraction::CatalystBackend(simConfig->GetInSituScript());
+    inSituAdaptor = new hemelb::extraction::InSituAdaptor(*simulationState,
+                                                          *latticeData,
+                                                          latticeBoltzmannModel->GetPropertyCache(),
+                                                          *unitConverter,
+                                                          backend,
+                                                          simConfig->GetInSituPeriod(),
+                                                          timings);
+#else
+    hemelb::log::Logger::Log<hemelb::log::Warning, hemelb::log::Singleton>("Ignoring the in situ script %s, as HemeLB was built without Catalyst",
+                                                                           simConfig->GetInSituScript().c_str());
+#endif
+  }
+
+#ifdef HEMELB_USE_SPARSE_PROPERTY_CACHE
+  if (propertyExtractor != NULL)
+  {
+    // Colloids and streaklines read every site, so the cache can only be restricted to the
+    // extracted sites without them. Vis is dealt with per step in
+    // RecalculatePropertyRequirements.
+    bool everySiteRead = colloidController != NULL;
+#ifndef NO_STREAKLINES
+    everySiteRead = true;
+#endif
+    if (!everySiteRead)
+    {
+      // The probes and flow diagnostics read sites of their own.
+      std::vector<hemelb::site_t> otherSites;
+      if (probeActor != NULL)
+      {
+        otherSites = probeActor->GetStencilSites();
+      }
+      if (flowDiagnosticsActor != NULL)
+      {
+        std::vector<hemelb::site_t> merged;
+        std::set_union(otherSites.begin(),
+                       otherSites.end(),
+                       flowDiagnosticsActor->GetSites().begin(),
+                       flowDiagnosticsActor->GetSites().end(),
+                       std::back_inserter(merged));
+        otherSites.swap(merged);
+      }
+      propertyExtractor->RestrictCacheToRequiredSites(latticeBoltzmannModel->GetPropertyCache(),
+                                                      otherSites);
+    }
+  }
+#endif
+
   imagesPeriod = OutputPeriod(imagesPerSimulation);
 
   stepManager = new hemelb::net::phased::StepManager(2,
                                                      &timings,
-                                                     hemelb::net::separate_communications);
+                                                     commsStrategy.separateConcerns);
+  // Periodic actions are due by time step; this may be after a rebalance.
+  stepManager->SetIteration(simulationState->Get0IndexedTimeStep());
+  stepManager->SetTracer(stepTracer);
+  stepManager->SetCommsStatistics(&commsStatistics);
+  memoryUsage.RecordStage("boundaries, neighbouring data and extraction");
   netConcern = new hemelb::net::phased::NetConcern(communicationNet);
   stepManager->RegisterIteratedActorSteps(*neighbouringDataManager, 0);
   if (colloidController != NULL)
@@ -315,11 +635,22 @@ void SimulationMaster::Initialise()
     stepManager->RegisterIteratedActorSteps(*colloidController, 1);
   }
   stepManager->RegisterIteratedActorSteps(*latticeBoltzmannModel, 1);
+  // After the LBM, so that it extrapolates the distributions the step has finished with.
+  if (steadyStateAccelerator != NULL)
+  {
+    stepManager->RegisterIteratedActorSteps(*steadyStateAccelerator, 1);
+  }
 
   stepManager->RegisterIteratedActorSteps(*inletValues, 1);
   stepManager->RegisterIteratedActorSteps(*outletValues, 1);
   stepManager->RegisterIteratedActorSteps(*steeringCpt, 1);
-  stepManager->RegisterIteratedActorSteps(*stabilityTester, 1);
+  stepManager->RegisterIteratedActorSteps(*regionStreamer, 1);
+  if (flightRecorder != NULL)
+  {
+    stepManager->RegisterIteratedActorSteps(*flightRecorder, 1);
+  }
+  // The checkers/testers only do anything on every checkPeriod-th step.
+  stepManager->RegisterIteratedActorSteps(*stabilityTester, 1, monitoringConfig->checkPeriod);
   if (entropyTester != NULL)
   {
     stepManager->RegisterIteratedActorSteps(*entropyTester, 1);
@@ -327,17 +658,24 @@ void SimulationMaster::Initialise()
 
   if (monitoringConfig->doIncompressibilityCheck)
   {
-    stepManager->RegisterIteratedActorSteps(*incompressibilityChecker, 1);
+    stepManager->RegisterIteratedActorSteps(*incompressibilityChecker, 1, monitoringConfig->checkPeriod);
   }
   stepManager->RegisterIteratedActorSteps(*visualisationControl, 1);
   if (propertyExtractor != NULL)
   {
     stepManager->RegisterIteratedActorSteps(*propertyExtractor, 1);
   }
-
-  if (ioComms.OnIORank())
+  if (probeActor != NULL)
   {
-    stepManager->RegisterIteratedActorSteps(*network, 1);
+    stepManager->RegisterIteratedActorSteps(*probeActor, 1);
+  }
+  if (flowDiagnosticsActor != NULL)
+  {
+    stepManager->RegisterIteratedActorSteps(*flowDiagnosticsActor, 1);
+  }
+  if (inSituAdaptor != NULL)
+  {
+    stepManager->RegisterIteratedActorSteps(*inSituAdaptor, 1, inSituAdaptor->GetPeriod());
   }
   stepManager->RegisterCommsForAllPhases(*netConcern);
 }
@@ -354,12 +692,17 @@ unsigned int SimulationMaster::OutputPeriod(unsigned int frequency)
 
 void SimulationMaster::HandleActors()
 {
+  if (stepTracer != NULL)
+  {
+    stepTracer->BeginTimeStep(simulationState->GetTimeStep());
+  }
   stepManager->CallActions();
 }
 
 void SimulationMaster::OnUnstableSimulation()
 {
   LogStabilityReport();
+  WriteFlightRecorder();
   hemelb::log::Logger::Log<hemelb::log::Warning, hemelb::log::Singleton>("Aborting: time step length: %f\n",
                                                                          simulationState->GetTimeStepLength());
   Finalise();
@@ -380,18 +723,26 @@ void SimulationMaster::WriteLocalImages()
     if (ioComms.OnIORank())
     {
       reporter->Image();
-      hemelb::io::writers::Writer * writer = fileManager->XdrImageWriter(1
-          + ( (it->second - 1) % simulationState->GetTimeStep()));
+      for (unsigned int view = 0; view < visualisationControl->GetViewCount(); ++view)
+      {
+        const hemelb::vis::PixelSet<hemelb::vis::ResultPixel>* result =
+            visualisationControl->GetResult(it->second, view);
+        if (result == NULL)
+        {
+          continue;
+        }
 
-      const hemelb::vis::PixelSet<hemelb::vis::ResultPixel>* result =
-          visualisationControl->GetResult(it->second);
+        hemelb::io::writers::Writer * writer = fileManager->XdrImageWriter(1
+            + ( (it->second - 1) % simulationState->GetTimeStep()), view);
 
-      visualisationControl->WriteImage(writer,
-                                       *result,
-                                       visualisationControl->domainStats,
-                                       visualisationControl->visSettings);
+        visualisationControl->WriteImage(writer,
+                                         *result,
+                                         visualisationControl->domainStats,
+                                         visualisationControl->GetViewSettings(view),
+                                         view);
 
-      delete writer;
+        delete writer;
+      }
     }
   }
 
@@ -442,9 +793,48 @@ void SimulationMaster::GenerateNetworkImages()
  * Begin the simulation.
  */
 void SimulationMaster::RunSimulation()
+{
+  if (dryRun)
+  {
+    DryRun();
+    return;
+  }
+
+  RunSteps();
+  Finalise();
+
+  // A server carries on with whichever configuration it's asked for next, until told to stop.
+  while (!serverFile.empty())
+  {
+    if (steeringCpt->GetRestartRequest() <= restartsDone)
+    {
+      steeringCpt->WaitWhileIdle(ioComms, restartsDone);
+      if (steeringCpt->GetRestartRequest() <= restartsDone)
+      {
+        break;
+      }
+    }
+
+    const std::vector<std::string> inputFiles = hemelb::util::ReadPathList(serverFile);
+    const unsigned configuration = steeringCpt->GetRestartConfiguration();
+    if (configuration >= inputFiles.size())
+    {
+      throw hemelb::Exception() << "Asked to restart with configuration " << configuration
+          << ", but " << serverFile << " only lists " << inputFiles.size();
+    }
+    restartsDone = steeringCpt->GetRestartRequest();
+    Reconfigure(inputFiles[configuration], steeringCpt->IsWarmRestart());
+
+    RunSteps();
+    Finalise();
+  }
+}
+
+void SimulationMaster::RunSteps()
 {
   hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Beginning to run simulation.");
   timings[hemelb::reporting::Timers::simulation].Start();
+  firstSimulatedStep = simulationState->GetTimeStep();
 
   while (simulationState->GetTimeStep() <= simulationState->GetTotalTimeSteps())
   {
@@ -456,13 +846,53 @@ void SimulationMaster::RunSimulation()
   }
 
   timings[hemelb::reporting::Timers::simulation].Stop();
-  Finalise();
 }
 
 void SimulationMaster::Finalise()
 {
+  if (checkpoint != NULL)
+  {
+    checkpoint->Finish();
+  }
+  if (probeActor != NULL)
+  {
+    probeActor->Flush();
+  }
+  if (flowDiagnosticsActor != NULL)
+  {
+    flowDiagnosticsActor->Flush();
+  }
+  if (stepTracer != NULL)
+  {
+    stepTracer->Write(fileManager->GetTracePath());
+  }
   timings[hemelb::reporting::Timers::total].Stop();
+  timings[hemelb::reporting::Timers::mpiProgress].Set(hemelb::net::ProgressThread::GetDrivingTime());
   timings.Reduce();
+  commsStatistics.Reduce(fileManager->GetCommsMatrixPath());
+  std::vector<hemelb::site_t> sitesPerType(hemelb::COLLISION_TYPES);
+  for (unsigned type = 0; type < hemelb::COLLISION_TYPES; ++type)
+  {
+    sitesPerType[type] = latticeData->GetMidDomainCollisionCount(type)
+        + latticeData->GetDomainEdgeCollisionCount(type);
+  }
+  loadImbalance.Reduce(sitesPerType,
+                       siteWeights.GetWeights(),
+                       timings,
+                       fileManager->GetLoadImbalancePath());
+  performance.Reduce(latticeData->GetTotalFluidSites(), simulationState->GetTimeStep() - 1, timings);
+  latticeData->RecordMemoryUsage(memoryUsage);
+  memoryUsage.RecordSubsystem("property cache", latticeBoltzmannModel->GetPropertyCache().GetMemoryUsage());
+  memoryUsage.RecordSubsystem("visualisation clusters", visualisationControl->GetMemoryUsage());
+  if (flightRecorder != NULL)
+  {
+    memoryUsage.RecordSubsystem("flight recorder", flightRecorder->GetMemoryUsage());
+  }
+  memoryUsage.Reduce();
+  if (!siteWeightsFile.empty())
+  {
+    CalibrateSiteWeights();
+  }
   if (IsCurrentProcTheIOProc())
   {
     reporter->FillDictionary();
@@ -476,6 +906,101 @@ void SimulationMaster::Finalise()
   hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Finish running simulation.");
 }
 
+/**
+ * Work out the site weights from the time spent on each collision type, over all cores, and
+ * save them for the next run to decompose with.
+ */
+void SimulationMaster::CalibrateSiteWeights()
+{
+  std::vector<double> timePerType(hemelb::COLLISION_TYPES);
+  std::vector<hemelb::site_t> sitesPerType(hemelb::COLLISION_TYPES);
+  for (unsigned type = 0; type < hemelb::COLLISION_TYPES; ++type)
+  {
+    timePerType[type] = latticeBoltzmannModel->GetCollisionTime(type);
+    sitesPerType[type] = latticeData->GetMidDomainCollisionCount(type)
+        + latticeData->GetDomainEdgeCollisionCount(type);
+  }
+  timePerType = ioComms.AllReduce(timePerType, MPI_SUM);
+  sitesPerType = ioComms.AllReduce(sitesPerType, MPI_SUM);
+
+  hemelb::geometry::decomposition::SiteWeights calibrated =
+      hemelb::geometry::decomposition::SiteWeights::Calibrate(timePerType,
+                                                              sitesPerType,
+                                                              simulationState->GetTimeStep()
+                                                                  - firstSimulatedStep);
+  if (IsCurrentProcTheIOProc())
+  {
+    hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Calibrated site weights %i %i %i %i %i %i, saving to %s",
+                                                                        calibrated[0],
+                                                                        calibrated[1],
+                                                                        calibrated[2],
+                                                                        calibrated[3],
+                                                                        calibrated[4],
+                                                                        calibrated[5],
+                                                                        siteWeightsFile.c_str());
+    calibrated.Write(siteWeightsFile);
+  }
+}
+
+void SimulationMaster::DryRun()
+{
+  hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Dry run: predicting the run from the decomposition without simulating.");
+
+  latticeData->RecordMemoryUsage(memoryUsage);
+  const hemelb::site_t localSites = latticeData->GetLocalFluidSiteCount();
+  memoryUsage.RecordSubsystem("property cache",
+                              hemelb::lb::MacroscopicPropertyCache::GetMemoryUsage(localSites));
+
+  // The peak so far has everything but the distributions and the property cache, which a dry
+  // run doesn't allocate.
+  const std::vector<hemelb::reporting::MemoryUsage::Record>& subsystems =
+      memoryUsage.GetSubsystems();
+  double bytes = 1024.0 * hemelb::reporting::Performance::GetPeakMemory();
+  for (size_t subsystem = 0; subsystem < subsystems.size(); ++subsystem)
+  {
+    if (subsystems[subsystem].name == "distributions"
+        || subsystems[subsystem].name == "property cache")
+    {
+      bytes += subsystems[subsystem].total;
+    }
+  }
+  memoryUsage.Reduce();
+
+  std::vector<hemelb::site_t> sitesPerType(hemelb::COLLISION_TYPES);
+  for (unsigned type = 0; type < hemelb::COLLISION_TYPES; ++type)
+  {
+    sitesPerType[type] = latticeData->GetMidDomainCollisionCount(type)
+        + latticeData->GetDomainEdgeCollisionCount(type);
+  }
+  prediction.Reduce(sitesPerType, siteWeights.GetWeights(), siteWeights.GetBulkSiteTime(), bytes);
+
+  timings[hemelb::reporting::Timers::total].Stop();
+  timings[hemelb::reporting::Timers::mpiProgress].Set(hemelb::net::ProgressThread::GetDrivingTime());
+  timings.Reduce();
+
+  if (IsCurrentProcTheIOProc())
+  {
+    const std::vector<hemelb::reporting::LoadImbalance::Distribution>& predicted =
+        prediction.GetDistributions();
+    hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Dry run: work imbalance (max/mean) %.3f, memory per process max %.1f MB, mean %.1f MB",
+                                                                        predicted[hemelb::reporting::Prediction::work].imbalance,
+                                                                        predicted[hemelb::reporting::Prediction::memory].max / 1048576.0,
+                                                                        predicted[hemelb::reporting::Prediction::memory].mean / 1048576.0);
+    if (prediction.IsCalibrated())
+    {
+      hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Dry run: step time %.3g s, %.3g MLUPS",
+                                                                          prediction.GetStepTime(),
+                                                                          prediction.GetMlups());
+    }
+    else
+    {
+      hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Dry run: give site weights calibrated by an earlier run on this machine with -site-weights to predict the step time");
+    }
+    reporter->FillDictionary();
+    reporter->Write();
+  }
+}
+
 void SimulationMaster::DoTimeStep()
 {
   bool writeImage = ( (simulationState->GetTimeStep() % imagesPeriod) == 0) ?
@@ -490,6 +1015,9 @@ void SimulationMaster::DoTimeStep()
      * The keys are the iterations on which production of an image will complete, and should be written or sent over the network.
      * The values are the iterations on which the image creation began.
      */
+    // Images on disk are never coarse, and show every view.
+    visualisationControl->RequestFullDetail();
+    visualisationControl->RequestAllViews();
     writtenImagesCompleted.insert(std::pair<unsigned long, unsigned long>(visualisationControl->Start(),
                                                                           simulationState->GetTimeStep()));
   }
@@ -529,10 +1057,23 @@ void SimulationMaster::DoTimeStep()
     LogStabilityReport();
   }
 
+  MonitorOutputTriggers();
   RecalculatePropertyRequirements();
 
   HandleActors();
 
+  if (flightRecorder != NULL && steeringCpt->GetFlightRecorderRequest() > flightRecorderWrites)
+  {
+    WriteFlightRecorder();
+    flightRecorderWrites = steeringCpt->GetFlightRecorderRequest();
+  }
+
+  // A server stops this run as soon as its client asks for the next.
+  if (!serverFile.empty() && steeringCpt->GetRestartRequest() > restartsDone)
+  {
+    simulationState->SetIsTerminating(true);
+  }
+
   if (simulationState->GetStability() == hemelb::lb::Unstable)
   {
     OnUnstableSimulation();
@@ -547,7 +1088,8 @@ void SimulationMaster::DoTimeStep()
     simulationState->SetIsTerminating(true);
   }
 
-  if ( (simulationState->GetTimeStep() % 500 == 0) && colloidController != NULL)
+  if (colloidController != NULL && colloidController->GetOutputPeriod() != 0
+      && simulationState->GetTimeStep() % colloidController->GetOutputPeriod() == 0)
     colloidController->OutputInformation(simulationState->GetTimeStep());
 
 #ifndef NO_STREAKLINES
@@ -566,13 +1108,461 @@ void SimulationMaster::DoTimeStep()
     GenerateNetworkImages();
   }
 
-  if (simulationState->GetTimeStep() % FORCE_FLUSH_PERIOD == 0 && IsCurrentProcTheIOProc())
+  if (simulationState->GetTimeStep() % FORCE_FLUSH_PERIOD == 0)
+  {
+    hemelb::log::Logger::Flush();
+    if (IsCurrentProcTheIOProc())
+    {
+      fflush(NULL);
+    }
+  }
+
+  if (rebalancePeriod > 0 && simulationState->GetTimeStep() % rebalancePeriod == 0
+      && !simulationState->IsTerminating())
+  {
+    CheckLoadBalance();
+  }
+
+  if (checkpointPeriod > 0 && simulationState->GetTimeStep() % checkpointPeriod == 0)
+  {
+    WriteCheckpoint();
+  }
+
+  if (captureStep > 0 && simulationState->GetTimeStep() == captureStep)
   {
-    fflush(NULL);
+    CaptureSubdomain();
   }
   simulationState->Increment();
 }
 
+void SimulationMaster::CaptureSubdomain()
+{
+  int rank = captureRank;
+  if (rank < 0)
+  {
+    // The rank that has spent longest on the LB so far, the lowest if several have.
+    const double lbTime = timings[hemelb::reporting::Timers::lb_calc].Get();
+    const double slowestTime = ioComms.AllReduce(lbTime, MPI_MAX);
+    rank = ioComms.AllReduce(lbTime == slowestTime ?
+                               ioComms.Rank() :
+                               ioComms.Size(),
+                             MPI_MIN);
+  }
+
+  if (ioComms.Rank() == rank)
+  {
+    hemelb::lb::SubdomainCapture::Write(fileManager->GetCapturePath(),
+                                        *latticeData,
+                                        *latticeBoltzmannModel->GetLbmParams(),
+                                        *inletValues,
+                                        *outletValues,
+                                        simulationState->GetTimeStep(),
+                                        ioComms);
+    hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::OnePerCore>("time step %lu, captured the subdomain of rank %i, with %li sites, to %s",
+                                                                        (unsigned long) simulationState->GetTimeStep(),
+                                                                        rank,
+                                                                        (long) latticeData->GetLocalFluidSiteCount(),
+                                                                        fileManager->GetCapturePath().c_str());
+  }
+}
+
+void SimulationMaster::WriteFlightRecorder()
+{
+  if (flightRecorder == NULL)
+  {
+    return;
+  }
+  timings[hemelb::reporting::Timers::extractionWriting].Start();
+  flightRecorder->Write(fileManager->GetFlightRecorderPath(simulationState->GetTimeStep()));
+  timings[hemelb::reporting::Timers::extractionWriting].Stop();
+}
+
+void SimulationMaster::WriteCheckpoint()
+{
+  timings[hemelb::reporting::Timers::checkpoint].Start();
+  checkpoint->Write(*latticeData, simulationState->GetTimeStep() + 1);
+  timings[hemelb::reporting::Timers::checkpoint].Stop();
+  hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("time step %i, checkpointing to %s",
+                                                                      simulationState->GetTimeStep(),
+                                                                      fileManager->GetCheckpointPath().c_str());
+}
+
+void SimulationMaster::RestoreCheckpoint()
+{
+  // The particles aren't in the checkpoint, and starting them again from their configured
+  // positions would put them out of step with the flow.
+  if (colloidController != NULL)
+  {
+    throw hemelb::Exception() << "Restarting from a checkpoint is not supported with colloids";
+  }
+
+  timings[hemelb::reporting::Timers::checkpoint].Start();
+  const hemelb::LatticeTimeStep restartTimeStep = hemelb::lb::Checkpoint::Read(restartFile,
+                                                                               *latticeData,
+                                                                               ioComms);
+  timings[hemelb::reporting::Timers::checkpoint].Stop();
+
+  if (restartTimeStep > simulationState->GetTotalTimeSteps() + 1)
+  {
+    throw hemelb::Exception() << "Checkpoint " << restartFile << " is from after the last of the "
+        << simulationState->GetTotalTimeSteps() << " time steps";
+  }
+  simulationState->SetTimeStep(restartTimeStep);
+  // So that the checkers run on the steps that the property cache gets their extremes.
+  stepManager->SetIteration(simulationState->Get0IndexedTimeStep());
+  hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Restarting from %s at time step %i",
+                                                                      restartFile.c_str(),
+                                                                      restartTimeStep);
+}
+
+void SimulationMaster::WarmStart()
+{
+  const std::string& path = simConfig->GetWarmStartPath();
+  if (hemelb::lb::Checkpoint::IsCheckpoint(path))
+  {
+    // Only the distributions: the run still starts at the first time step.
+    timings[hemelb::reporting::Timers::checkpoint].Start();
+    hemelb::lb::Checkpoint::Read(path, *latticeData, ioComms);
+    timings[hemelb::reporting::Timers::checkpoint].Stop();
+    hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Warm started from checkpoint %s",
+                                                                        path.c_str());
+    return;
+  }
+
+  const hemelb::lb::WarmStart<latticeType> warmStart(path,
+                                                     simConfig->GetWarmStartTimestep(),
+                                                     *latticeData,
+                                                     *unitConverter,
+                                                     latticeBoltzmannModel->GetLbmParams()->GetTau());
+  const hemelb::site_t missed = ioComms.Reduce(warmStart.Apply(*latticeData, *unitConverter),
+                                               MPI_SUM,
+                                               ioComms.GetIORank());
+
+  hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Warm started from %s%s; %li sites had no coarse flow to start from",
+                                                                      path.c_str(),
+                                                                      warmStart.HasStress() ?
+                                                                        "" :
+                                                                        " (equilibrium only, no stress tensor)",
+                                                                      missed);
+}
+
+void SimulationMaster::AutotuneComms()
+{
+  std::map<hemelb::proc_t, hemelb::site_t> distributionsForEachNeighbour;
+  const std::vector<hemelb::geometry::NeighbouringProcessor>& neighbours =
+      latticeData->GetNeighbouringProcessors();
+  for (std::vector<hemelb::geometry::NeighbouringProcessor>::const_iterator neighbour =
+      neighbours.begin(); neighbour != neighbours.end(); ++neighbour)
+  {
+    distributionsForEachNeighbour[neighbour->Rank] = neighbour->SharedDistributionCount;
+  }
+
+  commsStrategy.pointPoint = commsAutotuner.Tune(distributionsForEachNeighbour,
+                                                 COMMS_AUTOTUNE_EXCHANGES);
+  hemelb::net::CommsStrategy::SetDefault(commsStrategy);
+  communicationNet.SetStrategy(commsStrategy);
+  commsAutotuner.SetStrategy(commsStrategy);
+  hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Using the %s point to point comms, the fastest at the halo exchange",
+                                                                      hemelb::net::CommsStrategy::GetName(commsStrategy.pointPoint));
+}
+
+void SimulationMaster::CheckLoadBalance()
+{
+  // The particles' own calculations are part of each process's load, as well as the LB.
+  const double lbTime = timings[hemelb::reporting::Timers::lb_calc].Get();
+  const double colloidTime = timings[hemelb::reporting::Timers::colloidCalculateForces].Get()
+      + timings[hemelb::reporting::Timers::colloidUpdateCalculations].Get();
+  const double localLbTime = lbTime - lbTimeAtLastBalanceCheck;
+  const double localColloidTime = colloidTime - colloidTimeAtLastBalanceCheck;
+  const std::vector<double> timePerProc = ioComms.AllGather(localLbTime + localColloidTime);
+  const std::vector<hemelb::site_t> sitesPerProc =
+      ioComms.AllGather(latticeData->GetLocalFluidSiteCount());
+  lbTimeAtLastBalanceCheck = lbTime;
+  colloidTimeAtLastBalanceCheck = colloidTime;
+
+  // Only processes with sites do any LB, so leave out e.g. a separate steering process.
+  double maxTime = 0.0, totalTime = 0.0;
+  hemelb::site_t totalSites = 0;
+  unsigned busyProcs = 0;
+  for (size_t proc = 0; proc < timePerProc.size(); ++proc)
+  {
+    if (sitesPerProc[proc] > 0)
+    {
+      maxTime = std::max(maxTime, timePerProc[proc]);
+      totalTime += timePerProc[proc];
+      totalSites += sitesPerProc[proc];
+      ++busyProcs;
+    }
+  }
+  if (busyProcs == 0 || totalTime <= 0.0)
+  {
+    return;
+  }
+
+  const double imbalance = maxTime * busyProcs / totalTime;
+  hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("time step %i, load imbalance (max / mean time) %.3f",
+                                                                      simulationState->GetTimeStep(),
+                                                                      imbalance);
+  if (imbalance <= rebalanceThreshold)
+  {
+    return;
+  }
+
+  // The images being composited refer to the current decomposition, so wait.
+  int pendingImages = writtenImagesCompleted.empty() && networkImagesCompleted.empty() ?
+    0 :
+    1;
+  pendingImages = ioComms.AllReduce(pendingImages, MPI_MAX);
+  if (pendingImages != 0)
+  {
+    hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Not rebalancing while images are in progress");
+    return;
+  }
+
+  // Attribute each process's LB time evenly to its sites, and its colloid time evenly to its
+  // particles (or to its sites, if it has none), to estimate the cost of each block.
+  const hemelb::proc_t rank = ioComms.Rank();
+  std::vector<hemelb::site_t> particlesPerBlock(latticeData->GetBlockCount(), 0);
+  if (colloidController != NULL)
+  {
+    colloidController->CountLocalParticlesPerBlock(particlesPerBlock);
+  }
+  hemelb::site_t localParticles = 0;
+  for (size_t block = 0; block < particlesPerBlock.size(); ++block)
+  {
+    localParticles += particlesPerBlock[block];
+  }
+  const double costPerLocalParticle = localParticles > 0 ?
+    localColloidTime / localParticles :
+    0.0;
+  const double costPerLocalSite = sitesPerProc[rank] > 0 ?
+    (localParticles > 0 ?
+      localLbTime :
+      timePerProc[rank]) / sitesPerProc[rank] :
+    0.0;
+  std::vector<double> costPerBlock(latticeData->GetBlockCount(), 0.0);
+  std::vector<hemelb::site_t> sitesPerBlock(latticeData->GetBlockCount(), 0);
+  for (hemelb::site_t siteIndex = 0; siteIndex < latticeData->GetLocalFluidSiteCount(); ++siteIndex)
+  {
+    hemelb::util::Vector3D<hemelb::site_t> blockCoords, siteCoords;
+    latticeData->GetBlockAndLocalSiteCoords(latticeData->GetSite(siteIndex).GetGlobalSiteCoords(),
+                                            blockCoords,
+                                            siteCoords);
+    const hemelb::site_t blockId = latticeData->GetBlockIdFromBlockCoords(blockCoords);
+    costPerBlock[blockId] += costPerLocalSite;
+    ++sitesPerBlock[blockId];
+  }
+  for (size_t block = 0; block < particlesPerBlock.size(); ++block)
+  {
+    costPerBlock[block] += particlesPerBlock[block] * costPerLocalParticle;
+  }
+  costPerBlock = ioComms.AllReduce(costPerBlock, MPI_SUM);
+  sitesPerBlock = ioComms.AllReduce(sitesPerBlock, MPI_SUM);
+
+  // The factor for each block is its cost per site relative to the mean.
+  const double meanCostPerSite = totalTime / totalSites;
+  std::vector<double> blockCostFactors(costPerBlock.size(), 1.0);
+  for (size_t block = 0; block < costPerBlock.size(); ++block)
+  {
+    if (sitesPerBlock[block] > 0)
+    {
+      blockCostFactors[block] = costPerBlock[block] / sitesPerBlock[block] / meanCostPerSite;
+    }
+  }
+
+  hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Rebalancing the domain");
+  Rebalance(blockCostFactors);
+}
+
+void SimulationMaster::Rebalance(const std::vector<double>& blockCostFactors)
+{
+  timings[hemelb::reporting::Timers::rebalance].Start();
+
+  hemelb::geometry::GeometryReader reader(hemelb::steering::SteeringComponent::RequiresSeparateSteeringCore(),
+                                          latticeType::GetLatticeInfo(),
+                                          timings, ioComms);
+  reader.SetSiteWeights(siteWeights);
+  reader.SetNodeSharedRead(nodeSharedGeometry);
+  reader.SetBalanceConstraints(simConfig->GetBalanceConstraints());
+  reader.SetBlockCostFactors(blockCostFactors);
+  hemelb::geometry::Geometry geometry = reader.LoadAndDecompose(simConfig->GetDataFilePath());
+
+  // Where each of this process's sites has gone.
+  std::vector<hemelb::proc_t> procForEachSite(latticeData->GetLocalFluidSiteCount());
+  for (hemelb::site_t siteIndex = 0; siteIndex < latticeData->GetLocalFluidSiteCount(); ++siteIndex)
+  {
+    hemelb::util::Vector3D<hemelb::site_t> blockCoords, siteCoords;
+    latticeData->GetBlockAndLocalSiteCoords(latticeData->GetSite(siteIndex).GetGlobalSiteCoords(),
+                                            blockCoords,
+                                            siteCoords);
+    procForEachSite[siteIndex] =
+        reader.GetProcForSite(latticeData->GetBlockIdFromBlockCoords(blockCoords),
+                              latticeData->GetLocalSiteIdFromLocalSiteCoords(siteCoords));
+  }
+
+  // Everything built on the previous lattice has to go; the network, simulation state and
+  // property extractor carry on.
+  if (ioComms.OnIORank())
+  {
+    delete imageSendCpt;
+  }
+  delete stepManager;
+  delete netConcern;
+  delete steeringCpt;
+  delete regionStreamer;
+  delete flightRecorder;
+  delete visualisationControl;
+  delete stabilityTester;
+  delete steadyStateAccelerator;
+  delete entropyTester;
+  delete inletValues;
+  delete outletValues;
+  delete propertyDataSource;
+  delete latticeBoltzmannModel;
+  delete neighbouringDataManager;
+  hemelb::lb::IncompressibilityChecker<monitoringPolicy>* previousChecker = incompressibilityChecker;
+  hemelb::geometry::LatticeData* previous = latticeData;
+  // The particles are moved by site, so they go while the previous lattice is still there.
+  hemelb::colloids::ColloidController* previousColloidController = colloidController;
+  colloidController = NULL;
+
+  latticeData = new hemelb::geometry::LatticeData(latticeType::GetLatticeInfo(),
+                                                  geometry,
+                                                  ioComms,
+                                                  true,
+                                                  GetStabilisedRegions(),
+                                                  GetCompressedRegions());
+  InitialiseActors(geometry, previousColloidController, procForEachSite);
+  latticeData->TakeDistributionsFrom(*previous, procForEachSite);
+  delete previousColloidController;
+
+  if (IsCurrentProcTheIOProc())
+  {
+    reporter->ReplaceReportable(previous, latticeData);
+    if (monitoringConfig->doIncompressibilityCheck)
+    {
+      reporter->ReplaceReportable(previousChecker, incompressibilityChecker);
+    }
+  }
+  delete previousChecker;
+  delete previous;
+
+  timings[hemelb::reporting::Timers::rebalance].Stop();
+}
+
+void SimulationMaster::Reconfigure(const std::string& inputFile, bool warm)
+{
+  hemelb::configuration::SimConfig* newConfig = hemelb::configuration::SimConfig::New(inputFile,
+                                                                                       ioComms);
+  // The lattice is kept, so the geometry, where the stabilised kernel runs and which sites are
+  // compressed can't change.
+  if (newConfig->GetDataFilePath() != simConfig->GetDataFilePath())
+  {
+    std::string newGeometry = newConfig->GetDataFilePath();
+    delete newConfig;
+    throw hemelb::Exception() << "A simulation server can only restart with " << inputFile
+        << " on the same geometry, not " << newGeometry;
+  }
+  // Colloids are placed from their own configuration, against the geometry's decomposition.
+  if (colloidController != NULL || newConfig->HasColloidSection())
+  {
+    delete newConfig;
+    throw hemelb::Exception() << "A simulation server can't restart simulations with colloids";
+  }
+  hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Restarting with %s, %s",
+                                                                      inputFile.c_str(),
+                                                                      warm ?
+                                                                        "from the current flow" :
+                                                                        "from its initial conditions");
+
+  std::vector<hemelb::site_t> siteIds;
+  std::vector<hemelb::distribn_t> distributions;
+  if (warm)
+  {
+    latticeData->GetDistributionRecords(siteIds, distributions);
+  }
+
+  // Everything but the lattice and the network is built for the configuration, so goes with it.
+  if (ioComms.OnIORank())
+  {
+    delete imageSendCpt;
+  }
+  delete stepManager;
+  delete netConcern;
+  delete steeringCpt;
+  delete regionStreamer;
+  delete flightRecorder;
+  delete visualisationControl;
+  delete stabilityTester;
+  delete steadyStateAccelerator;
+  delete entropyTester;
+  delete inletValues;
+  delete outletValues;
+  delete propertyExtractor;
+  propertyExtractor = NULL;
+  delete probeActor;
+  probeActor = NULL;
+  delete flowDiagnosticsActor;
+  flowDiagnosticsActor = NULL;
+  delete inSituAdaptor;
+  inSituAdaptor = NULL;
+  delete propertyDataSource;
+  delete latticeBoltzmannModel;
+  delete neighbouringDataManager;
+  hemelb::lb::IncompressibilityChecker<monitoringPolicy>* previousChecker = incompressibilityChecker;
+  hemelb::lb::SimulationState* previousState = simulationState;
+
+  delete simConfig;
+  simConfig = newConfig;
+  unitConverter = &simConfig->GetUnitConverter();
+  monitoringConfig = simConfig->GetMonitoringConfiguration();
+  fileManager->SaveConfiguration(simConfig);
+
+  simulationState = new hemelb::lb::SimulationState(simConfig->GetTimeStepLength(),
+                                                    simConfig->GetTotalTimeSteps());
+  // Only the colloids need the geometry, and a server has none.
+  InitialiseActors(hemelb::geometry::Geometry(latticeData->GetBlockDimensions(),
+                                              latticeData->GetBlockSize()));
+
+  if (warm)
+  {
+    const unsigned numVectors = latticeType::NUMVECTORS;
+    for (hemelb::site_t site = 0; site < latticeData->GetLocalFluidSiteCount(); ++site)
+    {
+      latticeData->SetDistributions(site, &distributions[site * numVectors]);
+    }
+  }
+
+  if (IsCurrentProcTheIOProc())
+  {
+    reporter->ReplaceReportable(previousState, simulationState);
+    if (previousChecker == NULL && incompressibilityChecker != NULL)
+    {
+      reporter->AddReportable(incompressibilityChecker);
+    }
+    else if (incompressibilityChecker == NULL)
+    {
+      reporter->RemoveReportable(previousChecker);
+    }
+    else
+    {
+      reporter->ReplaceReportable(previousChecker, incompressibilityChecker);
+    }
+  }
+  delete previousChecker;
+  delete previousState;
+
+  writtenImagesCompleted.clear();
+  networkImagesCompleted.clear();
+
+  // Each run reports its own timings.
+  for (unsigned timer = 0; timer < hemelb::reporting::Timers::numberOfTimers; ++timer)
+  {
+    timings[timer].Set(0.0);
+  }
+  timings[hemelb::reporting::Timers::total].Start();
+}
+
 void SimulationMaster::RecalculatePropertyRequirements()
 {
   // Get the property cache & reset its list of properties to get.
@@ -580,6 +1570,23 @@ void SimulationMaster::RecalculatePropertyRequirements()
 
   propertyCache.ResetRequirements();
 
+  // Rendering, streaming a region, the flight recorder and in situ visualisation read sites the
+  // cache may not be restricted to, so lift any restriction of the cache on those iterations, and streaklines
+  // read the velocity at every site on every iteration.
+  regionStreamer->SetRequiredProperties(propertyCache);
+  if (flightRecorder != NULL)
+  {
+    flightRecorder->SetRequiredProperties(propertyCache);
+  }
+#ifndef NO_STREAKLINES
+  propertyCache.SetSiteRestrictionEnabled(false);
+#else
+  propertyCache.SetSiteRestrictionEnabled(!visualisationControl->IsRendering()
+      && !regionStreamer->StreamsThisIteration()
+      && ! (flightRecorder != NULL && flightRecorder->SamplesThisIteration())
+      && ! (inSituAdaptor != NULL && inSituAdaptor->RunsThisIteration()));
+#endif
+
   // Check whether we're rendering images on this iteration.
   if (visualisationControl->IsRendering())
   {
@@ -596,10 +1603,15 @@ void SimulationMaster::RecalculatePropertyRequirements()
     }
   }
 
-  if (monitoringConfig->doIncompressibilityCheck)
+  if (monitoringConfig->doIncompressibilityCheck
+      && simulationState->Get0IndexedTimeStep() % monitoringConfig->checkPeriod == 0)
   {
-    propertyCache.densityCache.SetRefreshFlag();
-    propertyCache.velocityCache.SetRefreshFlag();
+    propertyCache.SetDensityExtremesRequired();
+  }
+  if (monitoringConfig->doConvergenceCheck && monitoringConfig->convergenceOnDistributions
+      && simulationState->Get0IndexedTimeStep() % monitoringConfig->checkPeriod == 0)
+  {
+    propertyCache.SetRelativeChangeRequired();
   }
 
   // If extracting property results, check what's required by them.
@@ -607,6 +1619,18 @@ void SimulationMaster::RecalculatePropertyRequirements()
   {
     propertyExtractor->SetRequiredProperties(propertyCache);
   }
+  if (probeActor != NULL)
+  {
+    probeActor->SetRequiredProperties(propertyCache);
+  }
+  if (flowDiagnosticsActor != NULL)
+  {
+    flowDiagnosticsActor->SetRequiredProperties(propertyCache);
+  }
+  if (inSituAdaptor != NULL)
+  {
+    inSituAdaptor->SetRequiredProperties(propertyCache);
+  }
 
   // If using streaklines, the velocity will be needed.
 #ifndef NO_STREAKLINES
@@ -627,6 +1651,40 @@ void SimulationMaster::Abort()
   exit(1);
 }
 
+std::vector<hemelb::geometry::SiteBox> SimulationMaster::GetStabilisedRegions() const
+{
+#ifdef HEMELB_STABILISED_KERNEL
+  return simConfig->GetStabilisedRegions();
+#else
+  return std::vector<hemelb::geometry::SiteBox>();
+#endif
+}
+
+std::vector<hemelb::geometry::SiteBox> SimulationMaster::GetCompressedRegions() const
+{
+#ifdef HEMELB_USE_COMPRESSED_COLD_SITES
+  return simConfig->GetCompressedRegions();
+#else
+  return std::vector<hemelb::geometry::SiteBox>();
+#endif
+}
+
+void SimulationMaster::MonitorOutputTriggers()
+{
+  if (propertyExtractor == NULL || incompressibilityChecker == NULL
+      || simulationState->GetTimeStep() % monitoringConfig->checkPeriod != 0
+      || !incompressibilityChecker->AreDensitiesAvailable())
+  {
+    return;
+  }
+
+  // The checker's results are the same on every core, so they all trigger alike.
+  propertyExtractor->Monitor(hemelb::extraction::OutputTrigger::MaxVelocity,
+                             unitConverter->ConvertVelocityToPhysicalUnits(incompressibilityChecker->GetGlobalLargestVelocityMagnitude()));
+  propertyExtractor->Monitor(hemelb::extraction::OutputTrigger::MaxDensityDifference,
+                             incompressibilityChecker->GetMaxRelativeDensityDifference());
+}
+
 void SimulationMaster::LogStabilityReport()
 {
   if (monitoringConfig->doIncompressibilityCheck
@@ -8,11 +8,17 @@
 #define HEMELB_SIMULATIONMASTER_H
 #include "lb/lattices/Lattices.h"
 #include "extraction/PropertyActor.h"
+#include "extraction/ProbeActor.h"
+#include "extraction/FlowDiagnosticsActor.h"
+#include "extraction/InSituAdaptor.h"
 #include "lb/lb.hpp"
 #include "lb/StabilityTester.h"
+#include "lb/SteadyStateAccelerator.h"
 #include "net/net.h"
+#include "net/CommsStatistics.h"
 #include "steering/ImageSendComponent.h"
 #include "steering/SteeringComponent.h"
+#include "steering/RegionStreamer.h"
 #include "lb/EntropyTester.h"
 #include "lb/iolets/BoundaryValues.h"
 #include "util/UnitConverter.h"
@@ -20,12 +26,21 @@
 #include "io/PathManager.h"
 #include "reporting/Reporter.h"
 #include "reporting/Timers.h"
+#include "reporting/LoadImbalance.h"
+#include "reporting/Performance.h"
+#include "reporting/MemoryUsage.h"
+#include "reporting/Prediction.h"
 #include "reporting/BuildInfo.h"
 #include "lb/IncompressibilityChecker.hpp"
 #include "colloids/ColloidController.h"
 #include "net/phased/StepManager.h"
 #include "net/phased/NetConcern.h"
 #include "geometry/neighbouring/NeighbouringDataManager.h"
+#include "geometry/decomposition/SiteWeights.h"
+#include "lb/Checkpoint.h"
+#include "lb/SubdomainCapture.h"
+#include "extraction/FlightRecorder.h"
+#include "net/CommsAutotuner.h"
 
 class SimulationMaster
 {
@@ -57,9 +72,21 @@ class SimulationMaster
     hemelb::lb::LBM<latticeType>* latticeBoltzmannModel;
     hemelb::geometry::neighbouring::NeighbouringDataManager *neighbouringDataManager;
     const hemelb::net::IOCommunicator& ioComms;
+    hemelb::configuration::SimConfig *simConfig;
 
   private:
     void Initialise();
+    /**
+     * Create everything that works on the lattice data, once it has been created.
+     * @param geometry
+     * @param previousColloidController When rebalancing, the colloids on the previous lattice,
+     * which are moved onto the new one rather than read from the colloid config again.
+     * @param procForEachPreviousSite When rebalancing, the new owner of each previous local site.
+     */
+    void InitialiseActors(const hemelb::geometry::Geometry& geometry,
+                          hemelb::colloids::ColloidController* previousColloidController = NULL,
+                          const std::vector<hemelb::proc_t>& procForEachPreviousSite =
+                              std::vector<hemelb::proc_t>());
     void SetupReporting(); // set up the reporting file
     unsigned int OutputPeriod(unsigned int frequency);
     void HandleActors();
@@ -72,12 +99,103 @@ class SimulationMaster
      */
     void RecalculatePropertyRequirements();
 
+    /**
+     * Pass the quantities the property outputs' triggers can be on to them, once per check
+     * of the incompressibility, before the step's property requirements are worked out.
+     */
+    void MonitorOutputTriggers();
+
     /**
      * Helper method to log simulation parameters related to stability and accuracy
      */
     void LogStabilityReport();
 
-    hemelb::configuration::SimConfig *simConfig;
+    /**
+     * The boxes whose bulk sites the stabilised kernel collides, or none if there isn't a
+     * stabilised kernel built in.
+     */
+    std::vector<hemelb::geometry::SiteBox> GetStabilisedRegions() const;
+
+    /**
+     * The boxes whose bulk sites' distributions are kept compressed, or none if
+     * HEMELB_USE_COMPRESSED_COLD_SITES isn't built in.
+     */
+    std::vector<hemelb::geometry::SiteBox> GetCompressedRegions() const;
+
+    /**
+     * Calibrate the site weights from this run's timings and save them to the site weights file.
+     */
+    void CalibrateSiteWeights();
+
+    /**
+     * Compare the time each process has spent on the LB and the colloids since the last check
+     * and, if the slowest is too far behind the mean, rebalance the domain.
+     */
+    void CheckLoadBalance();
+
+    /**
+     * Decompose the geometry again, with the weight of each block scaled by the given factor,
+     * and move the simulation onto the new decomposition.
+     */
+    void Rebalance(const std::vector<double>& blockCostFactors);
+
+    /**
+     * Save the LB state to the checkpoint file, to restart from after the current time step.
+     */
+    void WriteCheckpoint();
+
+    /**
+     * Replace the initial conditions with the LB state in the restart file, and carry on from
+     * the time step it was saved at.
+     */
+    void RestoreCheckpoint();
+
+    /**
+     * Capture the subdomain of the chosen rank, or the slowest, for hemelb_replay. Collective
+     * when it is the slowest.
+     */
+    void CaptureSubdomain();
+
+    /**
+     * Write the flight recorder's samples, if there is a flight recorder. Collective.
+     */
+    void WriteFlightRecorder();
+
+    /**
+     * Replace the initial conditions with the flow of an earlier run: the distributions of a
+     * checkpoint of the same geometry, or the flow in a property output file of any resolution,
+     * interpolated onto this lattice (see lb::WarmStart).
+     */
+    void WarmStart();
+
+    /**
+     * Instead of simulating, report the memory, load balance and step time that the
+     * decomposition would give.
+     */
+    void DryRun();
+
+    /**
+     * Time the point-to-point comms implementations on this lattice's halo exchange and switch
+     * every net to the fastest.
+     */
+    void AutotuneComms();
+
+    /**
+     * Run time steps until the last, or until the simulation is terminated.
+     */
+    void RunSteps();
+
+    /**
+     * Restart a simulation server with another configuration of the same geometry, on the
+     * lattice it already has: everything working on the lattice is created again for the new
+     * configuration, and the distributions are either set to its initial conditions or, for a
+     * warm restart, kept as the previous run left them.
+     *
+     * @param inputFile The input xml file of the new configuration.
+     * @param warm Whether to carry on from the flow as it is.
+     */
+    void Reconfigure(const std::string& inputFile, bool warm);
+
     hemelb::io::PathManager* fileManager;
     hemelb::reporting::Timers timings;
     hemelb::reporting::Reporter* reporter;
@@ -90,32 +208,98 @@ class SimulationMaster
     hemelb::steering::Network* network;
     hemelb::steering::ImageSendComponent *imageSendCpt;
     hemelb::steering::SteeringComponent* steeringCpt;
+    hemelb::steering::RegionStreamer* regionStreamer;
+    /** Keeps the latest samples of the fields, to write if the simulation goes unstable */
+    hemelb::extraction::FlightRecorder* flightRecorder;
 
     hemelb::lb::SimulationState* simulationState;
 
+    /** How the checkers/testers combine their values across the processes */
+#if HEMELB_MONITORING_COLLECTIVE_STEPS > 0
+    typedef hemelb::net::CollectiveAction<HEMELB_MONITORING_COLLECTIVE_STEPS> monitoringPolicy;
+#else
+    typedef hemelb::net::PhasedBroadcastRegular<> monitoringPolicy;
+#endif
     /** Struct containing the configuration of various checkers/testers */
     const hemelb::configuration::SimConfig::MonitoringConfig* monitoringConfig;
-    hemelb::lb::StabilityTester<latticeType>* stabilityTester;
+    hemelb::lb::StabilityTester<latticeType, monitoringPolicy>* stabilityTester;
+    /** Actor extrapolating towards the steady state, if it is asked for */
+    hemelb::lb::SteadyStateAccelerator* steadyStateAccelerator;
     hemelb::lb::EntropyTester<latticeType>* entropyTester;
     /** Actor in charge of checking the maximum density difference across the domain */
-    hemelb::lb::IncompressibilityChecker<hemelb::net::PhasedBroadcastRegular<> >* incompressibilityChecker;
+    hemelb::lb::IncompressibilityChecker<monitoringPolicy>* incompressibilityChecker;
 
     hemelb::colloids::ColloidController* colloidController;
     hemelb::net::Net communicationNet;
+    /** Messages and waits of the communicationNet, for each peer rank and concern */
+    hemelb::net::CommsStatistics commsStatistics;
+    /** Each rank's sites and timings, to show how well the decomposition balanced them */
+    hemelb::reporting::LoadImbalance loadImbalance;
+    /** Throughput, bytes written and memory used, for the report */
+    hemelb::reporting::Performance performance;
+    /** Bytes held by the big data structures and the peak memory after each initialisation stage */
+    hemelb::reporting::MemoryUsage memoryUsage;
+    /** The memory, work and step time of each process predicted by a dry run */
+    hemelb::reporting::Prediction prediction;
+    /** Times the point-to-point comms on the halo exchange, if asked to, and reports the comms used */
+    hemelb::net::CommsAutotuner commsAutotuner;
+    /** The comms implementations the nets use */
+    hemelb::net::CommsStrategy commsStrategy;
+    bool autotuneComms;
 
     const hemelb::util::UnitConverter* unitConverter;
 
     hemelb::vis::Control* visualisationControl;
     hemelb::extraction::IterableDataSource* propertyDataSource;
     hemelb::extraction::PropertyActor* propertyExtractor;
+    hemelb::extraction::ProbeActor* probeActor;
+    hemelb::extraction::FlowDiagnosticsActor* flowDiagnosticsActor;
+    /** Hands the sites to the in situ visualisation script, if there is one */
+    hemelb::extraction::InSituAdaptor* inSituAdaptor;
 
     hemelb::net::phased::StepManager* stepManager;
     hemelb::net::phased::NetConcern* netConcern;
+    /** Traces the steps of the step manager over a window of time steps, if asked to */
+    hemelb::net::phased::StepTracer* stepTracer;
 
     unsigned int imagesPerSimulation;
     int steeringSessionId;
+    std::string decompositionToLoad;
+    std::string decompositionToSave;
+    std::string decompositionCache;
+    std::string siteWeightsFile;
+    hemelb::geometry::decomposition::SiteWeights siteWeights;
+    unsigned long rebalancePeriod;
+    double rebalanceThreshold;
+    double lbTimeAtLastBalanceCheck;
+    double colloidTimeAtLastBalanceCheck;
+    /** The time step the simulation started on, to calibrate the site weights with the timings */
+    unsigned long firstSimulatedStep;
+    /** Whether to read the geometry file once per node into shared memory */
+    bool nodeSharedGeometry;
+    /** Whether to stop after decomposing and predicting, without simulating */
+    bool dryRun;
+    unsigned long checkpointPeriod;
+    hemelb::lb::Checkpoint* checkpoint;
+    /** The time step at the end of which to capture a rank's subdomain, or 0 for none */
+    unsigned long captureStep;
+    /** The rank to capture, or -1 for the slowest */
+    int captureRank;
+    /** The number of samples the flight recorder keeps, or 0 for no flight recorder */
+    unsigned flightRecorderSamples;
+    unsigned long flightRecorderPeriod;
+    unsigned flightRecorderFields;
+    hemelb::geometry::SiteBox flightRecorderRegion;
+    /** The number of times the steering client's request for the flight recorder's samples has been met */
+    unsigned long flightRecorderWrites;
+    std::string restartFile;
+    /** The list of input files to serve, once the first has run, or empty to stop after it */
+    std::string serverFile;
+    /** The number of times the server has restarted with a new configuration */
+    unsigned long restartsDone;
     unsigned int imagesPeriod;
     static const hemelb::LatticeTimeStep FORCE_FLUSH_PERIOD=1000;
+    static const unsigned COMMS_AUTOTUNE_EXCHANGES = 20;
 };
 
 #endif /* HEMELB_SIMULATIONMASTER_H */
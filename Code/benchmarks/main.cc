@@ -0,0 +1,263 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+/*
+ * Micro-benchmark of the collide-and-stream step for the lattice, kernel and wall boundary this
+ * build was configured with (HEMELB_LATTICE, HEMELB_KERNEL, HEMELB_WALL_BOUNDARY).
+ *
+ * A synthetic cube of fluid, walled on every face, is built in memory on one core, big enough by
+ * default that its distributions don't fit in cache. The bulk and wall collisions are then timed
+ * separately, over their own sites, with no I/O or communication. For each the benchmark prints
+ * the millions of lattice site updates per second (MLUPS) and the effective memory bandwidth,
+ * counting one read and one write of every distribution per site update.
+ *
+ * With -p, the bulk collision is also timed prefetching its streamed-to distributions each of
+ * a range of distances ahead (see SimpleCollideAndStreamDelegate::PrefetchStreamedLinks), to
+ * choose HEMELB_STREAMING_PREFETCH_DISTANCE for the machine.
+ *
+ * Usage: hemelb_bench [-n sites along each side] [-b block size] [-i iterations] [-p]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include "net/mpi.h"
+#include "net/IOCommunicator.h"
+#include "log/Logger.h"
+#include "geometry/Geometry.h"
+#include "geometry/LatticeData.h"
+#include "lb/BuildSystemInterface.h"
+#include "lb/lb.h"
+#include "lb/MacroscopicPropertyCache.h"
+#include "lb/SimulationState.h"
+#include "util/utilityFunctions.h"
+
+namespace hemelb
+{
+  namespace benchmarks
+  {
+    // The same collisions as lb::LBM uses for the bulk and wall sites.
+    typedef lb::lattices:: HEMELB_LATTICE LatticeType;
+    typedef lb::HEMELB_KERNEL<LatticeType>::Type Kernel;
+    typedef lb::streamers::BulkCollideAndStream<lb::collisions::Normal<Kernel> >::Type BulkCollision;
+    typedef lb::HEMELB_WALL_BOUNDARY<lb::collisions::Normal<Kernel> >::Type WallCollision;
+
+#define HEMELB_BENCH_QUOTE(name) #name
+#define HEMELB_BENCH_NAME(name) HEMELB_BENCH_QUOTE(name)
+
+    /**
+     * Build the geometry of a cube of sitesAlong fluid sites along each side, with a layer of
+     * solid sites around it, all on this core. Links leaving the cube cross a wall half way.
+     */
+    geometry::Geometry* CreateCube(site_t sitesAlong, site_t blockSize)
+    {
+      const site_t extent = sitesAlong + 2;
+      const site_t blocksAlong = (extent + blockSize - 1) / blockSize;
+      geometry::Geometry* cube = new geometry::Geometry(util::Vector3D<site_t>(blocksAlong),
+                                                        blockSize);
+
+      for (site_t block = 0; block < cube->GetBlockCount(); ++block)
+      {
+        cube->Blocks[block].Sites.resize(cube->GetSitesPerBlock(), geometry::GeometrySite(false));
+      }
+
+      for (site_t i = 1; i <= sitesAlong; ++i)
+      {
+        for (site_t j = 1; j <= sitesAlong; ++j)
+        {
+          for (site_t k = 1; k <= sitesAlong; ++k)
+          {
+            const site_t block = cube->GetBlockIdFromBlockCoordinates(i / blockSize,
+                                                                      j / blockSize,
+                                                                      k / blockSize);
+            const site_t siteInBlock = ( (i % blockSize) * blockSize + j % blockSize) * blockSize
+                + k % blockSize;
+            geometry::GeometrySite& site = cube->Blocks[block].Sites[siteInBlock];
+            site.isFluid = true;
+            site.targetProcessor = 0;
+
+            for (Direction direction = 1; direction < LatticeType::NUMVECTORS; ++direction)
+            {
+              const site_t neighI = i + LatticeType::CX[direction];
+              const site_t neighJ = j + LatticeType::CY[direction];
+              const site_t neighK = k + LatticeType::CZ[direction];
+
+              geometry::GeometrySiteLink link;
+              if (neighI < 1 || neighJ < 1 || neighK < 1 || neighI > sitesAlong
+                  || neighJ > sitesAlong || neighK > sitesAlong)
+              {
+                link.type = geometry::GeometrySiteLink::WALL_INTERSECTION;
+                link.distanceToIntersection = 0.5;
+              }
+              site.SetLink(direction - 1, link);
+            }
+          }
+        }
+      }
+      return cube;
+    }
+
+    /**
+     * Time iterations of the collision over the sites of its type (the range from firstSite,
+     * siteCount long), swapping the distributions after each, and print the rates.
+     */
+    template<typename Collision>
+    void Time(const char* name, Collision& collision, site_t firstSite, site_t siteCount,
+              unsigned iterations, const lb::LbmParameters& lbmParams,
+              geometry::LatticeData& latticeData, lb::MacroscopicPropertyCache& propertyCache)
+    {
+      if (siteCount == 0)
+      {
+        log::Logger::Log<log::Info, log::Singleton>("%-10s no sites", name);
+        return;
+      }
+
+      // One untimed iteration to warm the caches and TLB.
+      collision.template StreamAndCollide<false>(firstSite, siteCount, &lbmParams, &latticeData,
+                                                 propertyCache);
+      latticeData.SwapOldAndNew();
+
+      const double start = util::myClock();
+      for (unsigned iteration = 0; iteration < iterations; ++iteration)
+      {
+        collision.template StreamAndCollide<false>(firstSite, siteCount, &lbmParams,
+                                                   &latticeData, propertyCache);
+        latticeData.SwapOldAndNew();
+      }
+      const double seconds = util::myClock() - start;
+
+      const double updates = double(siteCount) * iterations;
+      const double bytes = updates * 2.0 * LatticeType::NUMVECTORS * sizeof(stored_distribn_t);
+      log::Logger::Log<log::Info, log::Singleton>("%-10s %10li sites %10.2f MLUPS %10.2f GB/s",
+                                                     name,
+                                                     (long) siteCount,
+                                                     updates / seconds / 1.0e6,
+                                                     bytes / seconds / 1.0e9);
+    }
+
+    void Run(const net::IOCommunicator& comms, site_t sitesAlong, site_t blockSize,
+             unsigned iterations, bool sweepPrefetchDistance)
+    {
+      geometry::Geometry* cube = CreateCube(sitesAlong, blockSize);
+      geometry::LatticeData latticeData(LatticeType::GetLatticeInfo(), *cube, comms);
+      delete cube;
+
+      // Blood at rest, with a time step and voxel size giving a relaxation time of about 0.6.
+      lb::SimulationState simulationState(1.0e-4, iterations + 1);
+      lb::LbmParameters lbmParams(1.0e-4, 1.0e-4);
+      lb::MacroscopicPropertyCache propertyCache(simulationState, latticeData);
+
+      const site_t siteCount = latticeData.GetLocalFluidSiteCount();
+      for (int buffer = 0; buffer < 2; ++buffer)
+      {
+        for (site_t site = 0; site < siteCount; ++site)
+        {
+          for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+          {
+            *latticeData.GetFNew(latticeData.GetDistributionIndex<LatticeType>(site, direction)) =
+                LatticeType::EQMWEIGHTS[direction];
+          }
+        }
+        latticeData.SwapOldAndNew();
+      }
+
+      // The sites are ordered by collision type; on one core they're all mid-domain.
+      lb::kernels::InitParams initParams;
+      initParams.latDat = &latticeData;
+      initParams.lbmParams = &lbmParams;
+      initParams.neighbouringDataManager = NULL;
+      initParams.boundaryObject = NULL;
+
+      const site_t bulkCount = latticeData.GetMidDomainCollisionCount(0);
+      const site_t wallCount = latticeData.GetMidDomainCollisionCount(1);
+
+      initParams.siteCount = bulkCount;
+      initParams.siteRanges.push_back(std::pair<site_t, site_t>(0, bulkCount));
+      BulkCollision bulkCollision(initParams);
+
+      initParams.siteCount = wallCount;
+      initParams.siteRanges.clear();
+      initParams.siteRanges.push_back(std::pair<site_t, site_t>(bulkCount, bulkCount + wallCount));
+      WallCollision wallCollision(initParams);
+
+      log::Logger::Log<log::Info, log::Singleton>("hemelb_bench: %s lattice, %s kernel, %s walls, %li^3 sites in blocks of %li^3, %u iterations",
+                                                     HEMELB_BENCH_NAME(HEMELB_LATTICE),
+                                                     HEMELB_BENCH_NAME(HEMELB_KERNEL),
+                                                     HEMELB_BENCH_NAME(HEMELB_WALL_BOUNDARY),
+                                                     (long) sitesAlong,
+                                                     (long) blockSize,
+                                                     iterations);
+
+      Time("bulk", bulkCollision, 0, bulkCount, iterations, lbmParams, latticeData, propertyCache);
+      if (sweepPrefetchDistance)
+      {
+        const site_t distances[] = { 0, 1, 2, 4, 8, 16, 32 };
+        for (unsigned index = 0; index < sizeof(distances) / sizeof(distances[0]); ++index)
+        {
+          char name[32];
+          std::snprintf(name, sizeof(name), "bulk p=%li", (long) distances[index]);
+          bulkCollision.SetPrefetchDistance(distances[index]);
+          Time(name, bulkCollision, 0, bulkCount, iterations, lbmParams, latticeData, propertyCache);
+        }
+        bulkCollision.SetPrefetchDistance(HEMELB_STREAMING_PREFETCH_DISTANCE);
+      }
+      Time("wall",
+           wallCollision,
+           bulkCount,
+           wallCount,
+           iterations,
+           lbmParams,
+           latticeData,
+           propertyCache);
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  hemelb::net::MpiEnvironment mpi(argc, argv);
+  hemelb::log::Logger::Init();
+
+  hemelb::net::MpiCommunicator commWorld = hemelb::net::MpiCommunicator::World();
+  hemelb::net::IOCommunicator comms(commWorld);
+
+  // 128^3 sites is about 500 MB of D3Q15 distributions, well beyond any cache.
+  hemelb::site_t sitesAlong = 128;
+  hemelb::site_t blockSize = 8;
+  unsigned iterations = 20;
+  bool sweepPrefetchDistance = false;
+
+  int opt;
+  while ( (opt = getopt(argc, argv, "n:b:i:p")) != -1)
+  {
+    switch (opt)
+    {
+      case 'n':
+        sitesAlong = std::atol(optarg);
+        break;
+      case 'b':
+        blockSize = std::atol(optarg);
+        break;
+      case 'i':
+        iterations = std::atoi(optarg);
+        break;
+      case 'p':
+        sweepPrefetchDistance = true;
+        break;
+      default:
+        hemelb::log::Logger::Log<hemelb::log::Critical, hemelb::log::Singleton>("Usage: hemelb_bench [-n sites along each side] [-b block size] [-i iterations] [-p]");
+        return 1;
+    }
+  }
+
+  if (comms.Size() != 1)
+  {
+    hemelb::log::Logger::Log<hemelb::log::Critical, hemelb::log::Singleton>("hemelb_bench runs on one core");
+    return 1;
+  }
+
+  hemelb::benchmarks::Run(comms, sitesAlong, blockSize, iterations, sweepPrefetchDistance);
+  return 0;
+}
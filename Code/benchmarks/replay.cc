@@ -0,0 +1,410 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+/*
+ * Replay of one rank's collide-and-stream loop from a capture (see lb::SubdomainCapture), on one
+ * core, so that the kernels can be profiled on the real subdomain of a production run with the
+ * tools of a workstation, and without the rest of the run.
+ *
+ * hemelb writes the capture with -capture-step N, of the rank given by -capture-rank or of the
+ * slowest at colliding. The replay builds the same collisions as lb::LBM over the captured
+ * sites, and carries on from the captured distributions. Each step the halo takes the
+ * distributions that were received at the captured step, in place of the exchange, and the
+ * iolets keep their captured values. So the loop does the work the rank did, though the flow
+ * drifts from the run's.
+ *
+ * For each collision type it prints the sites, and the millions of lattice site updates per
+ * second (MLUPS) its collide-and-stream and post-step reached, then the rate of the whole step.
+ *
+ * Usage: hemelb_replay -c capture file [-i iterations]
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "net/mpi.h"
+#include "net/IOCommunicator.h"
+#include "log/Logger.h"
+#include "geometry/LatticeData.h"
+#include "lb/BuildSystemInterface.h"
+#include "lb/lb.h"
+#include "lb/MacroscopicPropertyCache.h"
+#include "lb/SimulationState.h"
+#include "lb/SubdomainCapture.h"
+#include "lb/iolets/BoundaryValues.h"
+#include "util/UnitConverter.h"
+#include "util/utilityFunctions.h"
+
+namespace hemelb
+{
+  namespace benchmarks
+  {
+    // The same collisions as lb::LBM uses for each collision type.
+    typedef lb::lattices:: HEMELB_LATTICE LatticeType;
+    typedef lb::HEMELB_KERNEL<LatticeType>::Type Kernel;
+    typedef lb::streamers::BulkCollideAndStream<lb::collisions::Normal<Kernel> >::Type BulkCollision;
+#ifdef HEMELB_STABILISED_KERNEL
+    typedef lb::streamers::BulkCollideAndStream<
+        lb::collisions::Normal<lb::HEMELB_STABILISED_KERNEL<LatticeType>::Type> >::Type StabilisedCollision;
+#else
+    typedef BulkCollision StabilisedCollision;
+#endif
+    typedef lb::HEMELB_WALL_BOUNDARY<lb::collisions::Normal<Kernel> >::Type WallCollision;
+    typedef lb::HEMELB_INLET_BOUNDARY<lb::collisions::Normal<Kernel> >::Type InletCollision;
+    typedef lb::HEMELB_OUTLET_BOUNDARY<lb::collisions::Normal<Kernel> >::Type OutletCollision;
+    typedef lb::HEMELB_WALL_INLET_BOUNDARY<lb::collisions::Normal<Kernel> >::Type InletWallCollision;
+    typedef lb::HEMELB_WALL_OUTLET_BOUNDARY<lb::collisions::Normal<Kernel> >::Type OutletWallCollision;
+
+    // The collision types as LatticeData counts them, then the stabilised bulk sites.
+    const unsigned CollisionTypes = 6;
+    const unsigned StabilisedType = CollisionTypes;
+    const char* const CollisionNames[CollisionTypes + 1] = { "bulk", "wall", "inlet", "outlet",
+                                                             "inlet-wall", "outlet-wall",
+                                                             "stabilised" };
+
+    /**
+     * The collide-and-stream loop of one rank, over its captured lattice, timing each collision
+     * type.
+     */
+    class Replay
+    {
+      public:
+        Replay(lb::SubdomainCapture& capture, const net::IOCommunicator& comms) :
+            latticeData(capture.GetLatticeData()), lbmParams(capture.GetLbmParameters()),
+                simulationState(lbmParams.GetTimeStep(), std::numeric_limits<unsigned long>::max()),
+                units(lbmParams.GetTimeStep(), lbmParams.GetVoxelSize(), PhysicalPosition(0.)),
+                inletValues(geometry::INLET_TYPE,
+                            &latticeData,
+                            capture.GetInlets(),
+                            &simulationState,
+                            comms,
+                            units),
+                outletValues(geometry::OUTLET_TYPE,
+                             &latticeData,
+                             capture.GetOutlets(),
+                             &simulationState,
+                             comms,
+                             units), propertyCache(simulationState, latticeData)
+        {
+          // Carry on from the step after the one captured.
+          simulationState.SetTimeStep(capture.GetTimeStep() + 1);
+          PrepareBoundaryObjects();
+          latticeData.GetReceived(halo);
+
+          // As lb::LBM::InitCollisions.
+          lb::kernels::InitParams initParams = lb::kernels::InitParams();
+          initParams.latDat = &latticeData;
+          initParams.lbmParams = &lbmParams;
+          initParams.neighbouringDataManager = NULL;
+          initParams.siteRanges.resize(2);
+          for (unsigned type = 0; type < CollisionTypes; ++type)
+          {
+            midFirst[type] = type == 0 ?
+              0 :
+              midFirst[type - 1] + latticeData.GetMidDomainCollisionCount(type - 1);
+            edgeFirst[type] = type == 0 ?
+              latticeData.GetMidDomainSiteCount() :
+              edgeFirst[type - 1] + latticeData.GetDomainEdgeCollisionCount(type - 1);
+          }
+
+          SetRanges(initParams, 0);
+          bulkCollision = new BulkCollision(initParams);
+          stabilisedCollision = new StabilisedCollision(initParams);
+          SetRanges(initParams, 1);
+          wallCollision = new WallCollision(initParams);
+          SetRanges(initParams, 2);
+          initParams.boundaryObject = &inletValues;
+          inletCollision = new InletCollision(initParams);
+          SetRanges(initParams, 3);
+          initParams.boundaryObject = &outletValues;
+          outletCollision = new OutletCollision(initParams);
+          SetRanges(initParams, 4);
+          initParams.boundaryObject = &inletValues;
+          inletWallCollision = new InletWallCollision(initParams);
+          SetRanges(initParams, 5);
+          initParams.boundaryObject = &outletValues;
+          outletWallCollision = new OutletWallCollision(initParams);
+
+          ResetTimes();
+        }
+
+        ~Replay()
+        {
+          delete bulkCollision;
+          delete stabilisedCollision;
+          delete wallCollision;
+          delete inletCollision;
+          delete outletCollision;
+          delete inletWallCollision;
+          delete outletWallCollision;
+        }
+
+        /**
+         * Do a time step as lb::LBM does, the domain edge first, with the halo exchange replaced
+         * by the captured distributions.
+         */
+        void DoTimeStep()
+        {
+          StreamAndCollideAll(edgeFirst, latticeData.GetDomainEdgeStabilisedCount(), false);
+          StreamAndCollideAll(midFirst, latticeData.GetMidDomainStabilisedCount(), true);
+          latticeData.SetReceived(halo);
+          PostStepAll(edgeFirst, latticeData.GetDomainEdgeStabilisedCount(), false);
+          PostStepAll(midFirst, latticeData.GetMidDomainStabilisedCount(), true);
+          latticeData.SwapOldAndNew();
+          simulationState.Increment();
+        }
+
+        void ResetTimes()
+        {
+          for (unsigned type = 0; type <= CollisionTypes; ++type)
+          {
+            seconds[type] = 0.0;
+          }
+        }
+
+        /**
+         * Print the rate each collision type reached over the iterations, and that of the step.
+         */
+        void Report(unsigned iterations, double stepSeconds) const
+        {
+          const site_t stabilisedCount = latticeData.GetMidDomainStabilisedCount()
+              + latticeData.GetDomainEdgeStabilisedCount();
+          for (unsigned type = 0; type <= CollisionTypes; ++type)
+          {
+            site_t siteCount = stabilisedCount;
+            if (type < CollisionTypes)
+            {
+              siteCount = latticeData.GetMidDomainCollisionCount(type)
+                  + latticeData.GetDomainEdgeCollisionCount(type);
+              if (type == 0)
+              {
+                siteCount -= stabilisedCount;
+              }
+            }
+            if (siteCount == 0)
+            {
+              log::Logger::Log<log::Info, log::Singleton>("%-12s no sites", CollisionNames[type]);
+              continue;
+            }
+            log::Logger::Log<log::Info, log::Singleton>("%-12s %10li sites %10.2f MLUPS",
+                                                         CollisionNames[type],
+                                                         (long) siteCount,
+                                                         double(siteCount) * iterations
+                                                             / seconds[type] / 1.0e6);
+          }
+          log::Logger::Log<log::Info, log::Singleton>("%-12s %10li sites %10.2f MLUPS",
+                                                       "step",
+                                                       (long) latticeData.GetLocalFluidSiteCount(),
+                                                       double(latticeData.GetLocalFluidSiteCount())
+                                                           * iterations / stepSeconds / 1.0e6);
+        }
+
+      private:
+        void SetRanges(lb::kernels::InitParams& initParams, unsigned type)
+        {
+          initParams.siteRanges[0].first = midFirst[type];
+          initParams.siteRanges[0].second = midFirst[type]
+              + latticeData.GetMidDomainCollisionCount(type);
+          initParams.siteRanges[1].first = edgeFirst[type];
+          initParams.siteRanges[1].second = edgeFirst[type]
+              + latticeData.GetDomainEdgeCollisionCount(type);
+          initParams.siteCount = latticeData.GetMidDomainCollisionCount(type)
+              + latticeData.GetDomainEdgeCollisionCount(type);
+        }
+
+        // As lb::LBM::PrepareBoundaryObjects.
+        void PrepareBoundaryObjects()
+        {
+          distribn_t minDensity = std::numeric_limits<distribn_t>::max();
+          for (unsigned inlet = 0; inlet < inletValues.GetLocalIoletCount(); ++inlet)
+          {
+            minDensity = std::min(minDensity, inletValues.GetLocalIolet(inlet)->GetDensityMin());
+          }
+          for (unsigned outlet = 0; outlet < outletValues.GetLocalIoletCount(); ++outlet)
+          {
+            minDensity = std::min(minDensity, outletValues.GetLocalIolet(outlet)->GetDensityMin());
+          }
+
+          for (unsigned inlet = 0; inlet < inletValues.GetLocalIoletCount(); ++inlet)
+          {
+            inletValues.GetLocalIolet(inlet)->SetMinimumSimulationDensity(minDensity);
+          }
+          for (unsigned outlet = 0; outlet < outletValues.GetLocalIoletCount(); ++outlet)
+          {
+            outletValues.GetLocalIolet(outlet)->SetMinimumSimulationDensity(minDensity);
+          }
+        }
+
+        /**
+         * Collide and stream the mid-domain or domain-edge sites of every type, from the first
+         * site of each.
+         */
+        void StreamAndCollideAll(const site_t* first, site_t stabilisedCount, bool midDomain)
+        {
+          const site_t bulkCount = Count(0, midDomain) - stabilisedCount;
+          StreamAndCollide(*bulkCollision, 0, first[0], bulkCount);
+          StreamAndCollide(*stabilisedCollision, StabilisedType, first[0] + bulkCount,
+                           stabilisedCount);
+          StreamAndCollide(*wallCollision, 1, first[1], Count(1, midDomain));
+          StreamAndCollide(*inletCollision, 2, first[2], Count(2, midDomain));
+          StreamAndCollide(*outletCollision, 3, first[3], Count(3, midDomain));
+          StreamAndCollide(*inletWallCollision, 4, first[4], Count(4, midDomain));
+          StreamAndCollide(*outletWallCollision, 5, first[5], Count(5, midDomain));
+        }
+
+        void PostStepAll(const site_t* first, site_t stabilisedCount, bool midDomain)
+        {
+          const site_t bulkCount = Count(0, midDomain) - stabilisedCount;
+          PostStep(*bulkCollision, 0, first[0], bulkCount);
+          PostStep(*stabilisedCollision, StabilisedType, first[0] + bulkCount, stabilisedCount);
+          PostStep(*wallCollision, 1, first[1], Count(1, midDomain));
+          PostStep(*inletCollision, 2, first[2], Count(2, midDomain));
+          PostStep(*outletCollision, 3, first[3], Count(3, midDomain));
+          PostStep(*inletWallCollision, 4, first[4], Count(4, midDomain));
+          PostStep(*outletWallCollision, 5, first[5], Count(5, midDomain));
+        }
+
+        site_t Count(unsigned type, bool midDomain) const
+        {
+          return midDomain ?
+            latticeData.GetMidDomainCollisionCount(type) :
+            latticeData.GetDomainEdgeCollisionCount(type);
+        }
+
+        template<typename Collision>
+        void StreamAndCollide(Collision& collision, unsigned type, site_t firstIndex,
+                              site_t siteCount)
+        {
+          if (siteCount == 0)
+          {
+            return;
+          }
+          const double start = util::myClock();
+          collision.template StreamAndCollide<false>(firstIndex, siteCount, &lbmParams,
+                                                     &latticeData, propertyCache);
+          seconds[type] += util::myClock() - start;
+        }
+
+        template<typename Collision>
+        void PostStep(Collision& collision, unsigned type, site_t firstIndex, site_t siteCount)
+        {
+          if (siteCount == 0)
+          {
+            return;
+          }
+          const double start = util::myClock();
+          collision.template PostStep<false>(firstIndex, siteCount, &lbmParams, &latticeData,
+                                             propertyCache);
+          seconds[type] += util::myClock() - start;
+        }
+
+        geometry::LatticeData& latticeData;
+        const lb::LbmParameters& lbmParams;
+        lb::SimulationState simulationState;
+        util::UnitConverter units;
+        lb::iolets::BoundaryValues inletValues;
+        lb::iolets::BoundaryValues outletValues;
+        lb::MacroscopicPropertyCache propertyCache;
+        std::vector<distribn_t> halo;
+
+        site_t midFirst[CollisionTypes];
+        site_t edgeFirst[CollisionTypes];
+        double seconds[CollisionTypes + 1];
+
+        BulkCollision* bulkCollision;
+        StabilisedCollision* stabilisedCollision;
+        WallCollision* wallCollision;
+        InletCollision* inletCollision;
+        OutletCollision* outletCollision;
+        InletWallCollision* inletWallCollision;
+        OutletWallCollision* outletWallCollision;
+    };
+
+    void Run(const net::IOCommunicator& comms, const std::string& capturePath,
+             unsigned iterations)
+    {
+      lb::SubdomainCapture capture(capturePath, LatticeType::GetLatticeInfo(), comms);
+      if (capture.GetConfiguration() != lb::SubdomainCapture::GetBuildConfiguration())
+      {
+        log::Logger::Log<log::Warning, log::Singleton>("The capture was written by a build of %s, but this is a build of %s",
+                                                       capture.GetConfiguration().c_str(),
+                                                       lb::SubdomainCapture::GetBuildConfiguration().c_str());
+      }
+      log::Logger::Log<log::Info, log::Singleton>("hemelb_replay: rank %i of %i at time step %lu, %li sites, %u iterations",
+                                                   (int) capture.GetRank(),
+                                                   (int) capture.GetRankCount(),
+                                                   (unsigned long) capture.GetTimeStep(),
+                                                   (long) capture.GetLatticeData().GetLocalFluidSiteCount(),
+                                                   iterations);
+
+      Replay replay(capture, comms);
+
+      // One untimed iteration to warm the caches and TLB.
+      replay.DoTimeStep();
+      replay.ResetTimes();
+
+      const double start = util::myClock();
+      for (unsigned iteration = 0; iteration < iterations; ++iteration)
+      {
+        replay.DoTimeStep();
+      }
+      replay.Report(iterations, util::myClock() - start);
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  hemelb::net::MpiEnvironment mpi(argc, argv);
+  hemelb::log::Logger::Init();
+
+  hemelb::net::MpiCommunicator commWorld = hemelb::net::MpiCommunicator::World();
+  hemelb::net::IOCommunicator comms(commWorld);
+
+  std::string capturePath;
+  unsigned iterations = 20;
+
+  int opt;
+  while ( (opt = getopt(argc, argv, "c:i:")) != -1)
+  {
+    switch (opt)
+    {
+      case 'c':
+        capturePath = optarg;
+        break;
+      case 'i':
+        iterations = std::atoi(optarg);
+        break;
+      default:
+        capturePath.clear();
+        break;
+    }
+  }
+
+  if (capturePath.empty())
+  {
+    hemelb::log::Logger::Log<hemelb::log::Critical, hemelb::log::Singleton>("Usage: hemelb_replay -c capture file [-i iterations]");
+    return 1;
+  }
+  if (comms.Size() != 1)
+  {
+    hemelb::log::Logger::Log<hemelb::log::Critical, hemelb::log::Singleton>("hemelb_replay runs on one core");
+    return 1;
+  }
+
+  try
+  {
+    hemelb::benchmarks::Run(comms, capturePath, iterations);
+  }
+  catch (const std::exception& e)
+  {
+    hemelb::log::Logger::Log<hemelb::log::Critical, hemelb::log::Singleton>("%s", e.what());
+    return 1;
+  }
+  return 0;
+}
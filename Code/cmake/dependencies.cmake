@@ -30,3 +30,29 @@ endif()
 #------zlib ----------------
 find_package(ZLIB REQUIRED)
 include_directories(${ZLIB_INCLUDE_DIR})
+
+if(HEMELB_USE_ZSTD)
+  #------zstd ----------------
+  find_path(ZSTD_INCLUDE_DIR zstd.h)
+  find_library(ZSTD_LIBRARIES zstd)
+  if(NOT ZSTD_INCLUDE_DIR OR NOT ZSTD_LIBRARIES)
+    message(FATAL_ERROR "HEMELB_USE_ZSTD needs the zstd library")
+  endif()
+  include_directories(${ZSTD_INCLUDE_DIR})
+endif()
+
+if(HEMELB_USE_HDF5)
+  #------HDF5 ----------------
+  find_package(HDF5 REQUIRED COMPONENTS C)
+  if(NOT HDF5_IS_PARALLEL)
+    message(FATAL_ERROR "HEMELB_USE_HDF5 needs a parallel (MPI) build of HDF5")
+  endif()
+  include_directories(${HDF5_INCLUDE_DIRS})
+  add_definitions(${HDF5_DEFINITIONS})
+endif()
+
+if(HEMELB_USE_CATALYST)
+  #------Catalyst ----------------
+  find_package(catalyst 2.0 REQUIRED)
+  set(CATALYST_LIBRARIES catalyst::catalyst)
+endif()
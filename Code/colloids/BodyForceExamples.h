@@ -31,6 +31,13 @@ namespace hemelb
           return constantForce;
         };
 
+        virtual const bool AddUniformForce(LatticeForceVector& uniformForce,
+                                           LatticeForceVector& forcePerUnitMass) const
+        {
+          uniformForce += constantForce;
+          return true;
+        }
+
       protected:
         ConstantBodyForce(const LatticeForceVector constantForce) :
           BodyForce(), constantForce(constantForce) {};
@@ -65,14 +72,17 @@ namespace hemelb
 
         virtual const LatticeForceVector GetForceForParticle(const Particle& particle) const
         {
-          const LatticePosition& direction = particle.GetGlobalPosition() - centrePoint;
-/*
-          printf("In RadialBF::GetForce - centre: {%g,%g,%g}, mag: %g, pos: {%g,%g,%g}, dir: {%g,%g,%g}\n",
-            centrePoint.x, centrePoint.y, centrePoint.z,
-            magnitude, particle.GetGlobalPosition().x,
-            particle.GetGlobalPosition().y, particle.GetGlobalPosition().z,
-            direction.x, direction.y, direction.z);
-*/
+          return GetForceAtPosition(particle.GetGlobalPosition());
+        };
+
+        virtual const bool CanBeSampled() const
+        {
+          return true;
+        }
+
+        virtual const LatticeForceVector GetForceAtPosition(const LatticePosition& position) const
+        {
+          const LatticePosition& direction = position - centrePoint;
           if (direction.GetMagnitudeSquared() < 0.0000001)
             return LatticeForceVector();
           return direction.GetNormalised() * (magnitude / direction.GetMagnitudeSquared());
@@ -4,6 +4,8 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <algorithm>
+#include <cmath>
 #include "colloids/BodyForces.h"
 #include "colloids/BodyForceExamples.h"
 #include "colloids/GraviticBodyForce.h"
@@ -13,10 +15,23 @@ namespace hemelb
   namespace colloids
   {
     std::map<std::string, const BodyForce* const > BodyForces::bodyForces;
-    std::map<site_t, LatticeForceVector> BodyForces::forceForEachSite;
+    LatticeForceVector BodyForces::uniformForce;
+    LatticeForceVector BodyForces::uniformForcePerUnitMass;
+    std::vector<const BodyForce*> BodyForces::sampledForces;
+    std::vector<const BodyForce*> BodyForces::otherForces;
+    site_t BodyForces::blockSize;
+    util::Vector3D<site_t> BodyForces::blockCounts;
+    std::map<site_t, std::vector<LatticeForceVector> > BodyForces::samplesForEachBlock;
+    std::vector<LatticeForceVector> BodyForces::forceForEachSite;
+    std::vector<bool> BodyForces::siteHasForce;
+    std::vector<site_t> BodyForces::sitesWithForce;
 
-    const void BodyForces::InitBodyForces(io::xml::Document& xml)
+    const void BodyForces::InitBodyForces(io::xml::Document& xml,
+                                          const geometry::LatticeData& latticeData)
     {
+      blockSize = latticeData.GetBlockSize();
+      blockCounts = latticeData.GetBlockDimensions();
+
       std::map<std::string, BodyForceFactory_Create> mapForceGenerators;
       mapForceGenerators["gravitic"] = & (GraviticBodyForceFactory::Create);
       mapForceGenerators["constant"] = & (ConstantBodyForceFactory::Create);
@@ -40,16 +55,94 @@ namespace hemelb
           BodyForces::bodyForces.insert(std::make_pair(forceName, nextForce));
         }
       }
+
+      // fold the forces that are the same everywhere into two constants, and separate
+      // those that can be sampled from those that must be evaluated for each particle
+      for (std::map<std::string, const BodyForce* const >::const_iterator iter = bodyForces.begin(); iter
+          != bodyForces.end(); iter++)
+      {
+        const BodyForce* force = iter->second;
+        if (force->AddUniformForce(uniformForce, uniformForcePerUnitMass))
+          continue;
+        if (force->CanBeSampled())
+          sampledForces.push_back(force);
+        else
+          otherForces.push_back(force);
+      }
     }
 
     const LatticeForceVector BodyForces::GetBodyForcesForParticle(const Particle& particle)
     {
-      LatticeForceVector totalForce;
-      for (std::map<std::string, const BodyForce* const >::const_iterator iter = bodyForces.begin(); iter
-          != bodyForces.end(); iter++)
-        totalForce += iter->second->GetForceForParticle(particle);
+      LatticeForceVector totalForce = uniformForce + uniformForcePerUnitMass * particle.GetMass();
+
+      if (!sampledForces.empty())
+      {
+        // interpolate trilinearly between the samples at the corners of the cell holding the
+        // particle, clamping to the lattice so that a particle just outside it still has a force
+        const LatticePosition& position = particle.GetGlobalPosition();
+        util::Vector3D<site_t> blockCoords, cell;
+        double fraction[3];
+        for (int xyz = 0; xyz < 3; xyz++)
+        {
+          const LatticeDistance highest = blockCounts[xyz] * blockSize;
+          const LatticeDistance clamped = std::min(std::max(position[xyz], 0.0), highest);
+          site_t site = (site_t) std::floor(clamped);
+          if (site >= blockCounts[xyz] * blockSize)
+            site = blockCounts[xyz] * blockSize - 1;
+          blockCoords[xyz] = site / blockSize;
+          cell[xyz] = site % blockSize;
+          fraction[xyz] = clamped - site;
+        }
+
+        const std::vector<LatticeForceVector>& samples = GetSamplesForBlock(blockCoords);
+        const site_t stride = blockSize + 1;
+        for (int corner = 0; corner < 8; corner++)
+        {
+          const int dx = (corner >> 2) & 1, dy = (corner >> 1) & 1, dz = corner & 1;
+          const double weight = (dx ? fraction[0] : 1.0 - fraction[0])
+              * (dy ? fraction[1] : 1.0 - fraction[1]) * (dz ? fraction[2] : 1.0 - fraction[2]);
+          totalForce += samples[ ( (cell.x + dx) * stride + cell.y + dy) * stride + cell.z + dz]
+              * weight;
+        }
+      }
+
+      for (std::vector<const BodyForce*>::const_iterator iter = otherForces.begin();
+           iter != otherForces.end(); iter++)
+        totalForce += (*iter)->GetForceForParticle(particle);
       return totalForce;
     }
 
+    const std::vector<LatticeForceVector>& BodyForces::GetSamplesForBlock(const util::Vector3D<site_t>& blockCoords)
+    {
+      const site_t blockId = (blockCoords.x * blockCounts.y + blockCoords.y) * blockCounts.z
+          + blockCoords.z;
+      std::map<site_t, std::vector<LatticeForceVector> >::iterator known =
+          samplesForEachBlock.find(blockId);
+      if (known != samplesForEachBlock.end())
+        return known->second;
+
+      const site_t stride = blockSize + 1;
+      std::vector<LatticeForceVector>& samples = samplesForEachBlock[blockId];
+      samples.resize(stride * stride * stride);
+      const util::Vector3D<site_t> origin = blockCoords * blockSize;
+      for (site_t i = 0; i < stride; i++)
+        for (site_t j = 0; j < stride; j++)
+          for (site_t k = 0; k < stride; k++)
+          {
+            const LatticePosition position(origin.x + i, origin.y + j, origin.z + k);
+            LatticeForceVector& sample = samples[ (i * stride + j) * stride + k];
+            for (std::vector<const BodyForce*>::const_iterator iter = sampledForces.begin();
+                 iter != sampledForces.end(); iter++)
+              sample += (*iter)->GetForceAtPosition(position);
+          }
+      return samples;
+    }
+
+    const std::vector<site_t>& BodyForces::GetSitesWithBodyForces()
+    {
+      std::sort(sitesWithForce.begin(), sitesWithForce.end());
+      return sitesWithForce;
+    }
+
   }
 }
@@ -10,7 +10,9 @@
 #include "io/xml/XmlAbstractionLayer.h"
 #include "units.h"
 #include <map>
+#include <vector>
 #include "colloids/Particle.h"
+#include "geometry/LatticeData.h"
 
 namespace hemelb
 {
@@ -21,6 +23,30 @@ namespace hemelb
     {
       public:
         virtual const LatticeForceVector GetForceForParticle(const Particle&) const =0;
+
+        /** for a force that is the same everywhere - adds it to constantForce, or to
+         *  forcePerUnitMass if it is proportional to the particle's mass, and returns true
+         *  otherwise returns false, and the force is evaluated in some other way
+         */
+        virtual const bool AddUniformForce(LatticeForceVector& constantForce,
+                                           LatticeForceVector& forcePerUnitMass) const
+        {
+          return false;
+        }
+
+        /** true if the force depends only on the particle's position, so can be sampled
+         *  at the lattice sites (with GetForceAtPosition) and interpolated between them
+         */
+        virtual const bool CanBeSampled() const
+        {
+          return false;
+        }
+
+        /** the force on a particle at the position, for forces that can be sampled */
+        virtual const LatticeForceVector GetForceAtPosition(const LatticePosition&) const
+        {
+          return LatticeForceVector();
+        }
       protected:
         virtual ~BodyForce() {};
     };
@@ -41,37 +67,92 @@ namespace hemelb
     class BodyForces
     {
       public:
-        /** factory method - gets initial values from xml configuration file */
-        static const void InitBodyForces(io::xml::Document& xml);
+        /**
+         * factory method - gets initial values from xml configuration file
+         * the lattice gives the blocks in which the forces that vary in space are sampled
+         */
+        static const void InitBodyForces(io::xml::Document& xml,
+                                         const geometry::LatticeData& latticeData);
 
         static const void AddBodyForce(const std::string name, const BodyForce* const);
 
         /** accumulates the effects of all known body forces on the particle */
         static const LatticeForceVector GetBodyForcesForParticle(const Particle& particle);
 
+        /** resets the force on every site that has one */
         static void ClearBodyForcesForAllSiteIds()
         {
-          forceForEachSite.clear();
+          for (std::vector<site_t>::const_iterator iter = sitesWithForce.begin();
+               iter != sitesWithForce.end(); iter++)
+          {
+            forceForEachSite[*iter] = LatticeForceVector();
+            siteHasForce[*iter] = false;
+          }
+          sitesWithForce.clear();
         }
 
-        static void SetBodyForcesForSiteId(const site_t siteId, const LatticeForceVector force)
+        /** adds to the force on the site, given by its local contiguous index */
+        static void AddBodyForcesForSiteId(const site_t siteId, const LatticeForceVector& force)
         {
-          forceForEachSite[siteId] = force;
+          if ((size_t) siteId >= forceForEachSite.size())
+          {
+            forceForEachSite.resize(siteId + 1);
+            siteHasForce.resize(siteId + 1, false);
+          }
+          if (!siteHasForce[siteId])
+          {
+            siteHasForce[siteId] = true;
+            sitesWithForce.push_back(siteId);
+          }
+          forceForEachSite[siteId] += force;
         }
 
         static const LatticeForceVector GetBodyForcesForSiteId(const site_t siteId)
         {
-          return forceForEachSite[siteId];
+          return (size_t) siteId < forceForEachSite.size() ?
+            forceForEachSite[siteId] :
+            LatticeForceVector();
         }
 
+        /**
+         * the local contiguous indices of the sites with a force, in increasing order, so
+         * the forces can be taken from GetBodyForcesForSiteId in one pass through the sites
+         */
+        static const std::vector<site_t>& GetSitesWithBodyForces();
+
       private:
+        /** the samples of the sampled forces in a block, at each of its sites and those on
+         *  its far faces, so that any position in the block lies between eight of them
+         */
+        static const std::vector<LatticeForceVector>& GetSamplesForBlock(const util::Vector3D<site_t>& blockCoords);
+
         /**
          * stores the details of all known body forces
          * the value type must be a base class pointer
          * as only pointers are type-compatible in C++
          */
         static std::map<std::string, const BodyForce* const> bodyForces;
-        static std::map<site_t, LatticeForceVector> forceForEachSite;
+
+        /** the sum of the forces that are the same everywhere and don't depend on mass */
+        static LatticeForceVector uniformForce;
+        /** the sum of the forces that are the same everywhere, per unit mass of particle */
+        static LatticeForceVector uniformForcePerUnitMass;
+        /** the forces that vary in space and are sampled into the blocks */
+        static std::vector<const BodyForce*> sampledForces;
+        /** the remaining forces, evaluated for each particle */
+        static std::vector<const BodyForce*> otherForces;
+
+        static site_t blockSize;
+        static util::Vector3D<site_t> blockCounts;
+        /** map blockId -> samples of the sampled forces, filled when a particle first needs them */
+        static std::map<site_t, std::vector<LatticeForceVector> > samplesForEachBlock;
+
+        /** the feedback force on each local site, indexed by local contiguous site id */
+        static std::vector<LatticeForceVector> forceForEachSite;
+        /** whether each local site is in sitesWithForce */
+        static std::vector<bool> siteHasForce;
+        /** the sites with a force since the last clear, in the order they were first added to */
+        static std::vector<site_t> sitesWithForce;
     };
   }
 }
@@ -17,6 +17,7 @@ namespace hemelb
     std::vector<BoundaryCondition*> BoundaryConditions::boundaryConditionsWall;
     std::vector<BoundaryCondition*> BoundaryConditions::boundaryConditionsInlet;
     std::vector<BoundaryCondition*> BoundaryConditions::boundaryConditionsOutlet;
+    std::vector<LatticePosition> BoundaryConditions::particleToWallVectors;
 
     const geometry::LatticeData* BoundaryConditions::latticeData;
 
@@ -25,6 +26,8 @@ namespace hemelb
                                      io::xml::Document& xml)
     {
       BoundaryConditions::latticeData = latticeData;
+      // at most one wall vector for each of the face-of-a-cube lattice vectors
+      particleToWallVectors.reserve(6);
 
       std::map<std::string, BoundaryConditionFactory_Create> mapBCGenerators;
       mapBCGenerators["lubricationBC"] = &(LubricationBoundaryConditionFactory::Create);
@@ -39,7 +42,7 @@ namespace hemelb
       {
         const std::string boundaryConditionClass = iter->first;
         const BoundaryConditionFactory_Create createFunction = iter->second;
-        log::Logger::Log<log::Debug, log::OnePerCore>(
+        HEMELB_LOG(Debug, OnePerCore,
           "*** In BoundaryConditions::InitBoundaryConditions - looking for %s BC in XML\n",
           boundaryConditionClass.c_str());
         for(// There must be at least one BC element for each type
@@ -77,7 +80,7 @@ namespace hemelb
       const bool isLocalFluid = latticeData->GetContiguousSiteId(
         siteGlobalPosition, procId, localContiguousId);
       if (particle.GetGlobalPosition().y < 1.5 && particle.GetGlobalPosition().y >= 0.5)
-        log::Logger::Log<log::Trace, log::OnePerCore>(
+        HEMELB_LOG(Trace, OnePerCore,
           "*** In BoundaryConditions::DoSomeThingsToParticle for id: %lu, p.pos: {%g,%g,%g}, p.vel: {%g,%g,%g}, isLocalFluid: %s, procId: %u, localContiguousId: %lu, siteCoords: {%lu,%lu,%lu}, ownerRank: %u\n",
           particle.GetParticleId(),
           particle.GetGlobalPosition().x,
@@ -112,7 +115,7 @@ namespace hemelb
         return keep;
       }
       ////else
-        log::Logger::Log<log::Trace, log::OnePerCore>(
+        HEMELB_LOG(Trace, OnePerCore,
           "*** In BoundaryConditions::DoSomeThingsToParticle for id: %lu, isNearWall: %s, isNearInlet: %s, isNearOutlet: %s ***\n",
           particle.GetParticleId(),
           isNearWall ? "TRUE" : "FALSE",
@@ -120,7 +123,7 @@ namespace hemelb
           isNearOutlet ? "TRUE" : "FALSE");
 
       // only use lattice vectors 1 to 6 (the face-of-a-cube vectors)
-      std::vector<LatticePosition> particleToWallVectors;
+      particleToWallVectors.clear();
       for (Direction direction = 1; direction <= 6; ++direction)
       {
         // in general, this "distance" is a fraction of a non-unit lattice vector
@@ -148,7 +151,7 @@ namespace hemelb
         const LatticePosition particleToWallVector = siteToWall +
           siteToWall.GetNormalised() * siteToWall.GetNormalised().Dot(particleToSite);
 
-        log::Logger::Log<log::Trace, log::OnePerCore>(
+        HEMELB_LOG(Trace, OnePerCore,
           "*** In BoundaryConditions::DoSomeThingsToParticle for id: %lu, siteToWall: {%g,%g,%g}, particleToSite: {%g,%g,%g}, particleToWall: {%g,%g,%g}\n",
           particle.GetParticleId(),
           siteToWall.x, siteToWall.y, siteToWall.z,
@@ -187,7 +190,7 @@ namespace hemelb
       else
       {
         particle.SetDeletionMarker(currentTimestep);
-        log::Logger::Log<log::Trace, log::OnePerCore>(
+        HEMELB_LOG(Trace, OnePerCore,
           "*** In BoundaryConditions::DoSomeThingsToParticle for id: %lu - attempting to set markedForDeletion to %lu (value actually becomes: %lu)\n",
           particle.GetParticleId(),
           currentTimestep,
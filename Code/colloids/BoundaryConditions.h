@@ -25,7 +25,7 @@ namespace hemelb
         /** applies the boundary condition by directly modifying the particle
          *  returns false if the particle must now be deleted, true otherwise
          */
-        virtual const bool DoSomethingToParticle(Particle&, const std::vector<LatticePosition>) =0;
+        virtual const bool DoSomethingToParticle(Particle&, const std::vector<LatticePosition>&) =0;
         virtual const std::vector<Particle> CreateNewParticles() =0;
       protected:
         virtual ~BoundaryCondition() {};
@@ -52,6 +52,12 @@ namespace hemelb
                             const geometry::LatticeData* const latticeData,
                             io::xml::Document& xml);
 
+        /** points the boundary conditions at the lattice of a new decomposition */
+        static const void SetLatticeData(const geometry::LatticeData* const latticeData)
+        {
+          BoundaryConditions::latticeData = latticeData;
+        }
+
         static const void AddBoundaryCondition(
                             const std::string name,
                             const BoundaryCondition* const);
@@ -76,6 +82,12 @@ namespace hemelb
         static std::vector<BoundaryCondition* > boundaryConditionsInlet;
         static std::vector<BoundaryCondition* > boundaryConditionsOutlet;
 
+        /**
+         * scratch space for the vectors from the particle being treated to the walls near it
+         * re-used for every particle, so that applying the boundary conditions never allocates
+         */
+        static std::vector<LatticePosition> particleToWallVectors;
+
         const static geometry::LatticeData* latticeData;
     };
   }
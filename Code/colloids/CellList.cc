@@ -0,0 +1,142 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <cmath>
+#include "colloids/CellList.h"
+
+namespace hemelb
+{
+  namespace colloids
+  {
+    CellList::CellList(site_t cellWidth, const util::Vector3D<site_t>& latticeExtent) :
+      cellWidth(cellWidth), currentSweep(0)
+    {
+      for (int xyz = 0; xyz < 3; xyz++)
+        cellCounts[xyz] = (latticeExtent[xyz] + cellWidth - 1) / cellWidth;
+    }
+
+    site_t CellList::GetCellCoordinate(LatticeDistance coordinate, int axis) const
+    {
+      // particles just outside the lattice share the cells at its faces
+      const site_t cell = (site_t) std::floor(coordinate / cellWidth);
+      if (cell < 0)
+        return 0;
+      if (cell >= cellCounts[axis])
+        return cellCounts[axis] - 1;
+      return cell;
+    }
+
+    site_t CellList::GetCellIndex(const util::Vector3D<site_t>& cellCoordinates) const
+    {
+      return (cellCoordinates.x * cellCounts.y + cellCoordinates.y) * cellCounts.z
+          + cellCoordinates.z;
+    }
+
+    const void CellList::Update(unsigned long particleId, const LatticePosition& position)
+    {
+      const site_t cell = GetCellIndex(util::Vector3D<site_t>(GetCellCoordinate(position.x, 0),
+                                                              GetCellCoordinate(position.y, 1),
+                                                              GetCellCoordinate(position.z, 2)));
+
+      std::map<unsigned long, Location>::iterator known = locations.find(particleId);
+      if (known != locations.end())
+      {
+        Location& location = known->second;
+        location.sweep = currentSweep;
+        if (location.cell == cell)
+        {
+          // still in the same cell, so only the position needs changing
+          buckets[cell][location.slot].position = position;
+          return;
+        }
+        RemoveEntry(location);
+      }
+
+      std::vector<Entry>& bucket = buckets[cell];
+      Entry entry;
+      entry.particleId = particleId;
+      entry.position = position;
+      bucket.push_back(entry);
+
+      Location& location = locations[particleId];
+      location.cell = cell;
+      location.slot = bucket.size() - 1;
+      location.sweep = currentSweep;
+    }
+
+    const void CellList::Remove(unsigned long particleId)
+    {
+      std::map<unsigned long, Location>::iterator known = locations.find(particleId);
+      if (known == locations.end())
+        return;
+      RemoveEntry(known->second);
+      locations.erase(known);
+    }
+
+    const void CellList::RemoveEntry(const Location& location)
+    {
+      std::map<site_t, std::vector<Entry> >::iterator bucket = buckets.find(location.cell);
+      std::vector<Entry>& entries = bucket->second;
+      if (location.slot != entries.size() - 1)
+      {
+        entries[location.slot] = entries.back();
+        locations[entries[location.slot].particleId].slot = location.slot;
+      }
+      entries.pop_back();
+      if (entries.empty())
+        buckets.erase(bucket);
+    }
+
+    const void CellList::BeginSweep()
+    {
+      currentSweep++;
+    }
+
+    const void CellList::RemoveStale()
+    {
+      std::map<unsigned long, Location>::iterator iter = locations.begin();
+      while (iter != locations.end())
+      {
+        if (iter->second.sweep != currentSweep)
+        {
+          RemoveEntry(iter->second);
+          locations.erase(iter++);
+        }
+        else
+          iter++;
+      }
+    }
+
+    const void CellList::FindNeighbours(const LatticePosition& position,
+                                        LatticeDistance range,
+                                        std::vector<Entry>& neighbours) const
+    {
+      util::Vector3D<site_t> lowest, highest;
+      for (int xyz = 0; xyz < 3; xyz++)
+      {
+        lowest[xyz] = GetCellCoordinate(position[xyz] - range, xyz);
+        highest[xyz] = GetCellCoordinate(position[xyz] + range, xyz);
+      }
+
+      const LatticeDistance rangeSquared = range * range;
+      for (site_t x = lowest.x; x <= highest.x; x++)
+        for (site_t y = lowest.y; y <= highest.y; y++)
+          for (site_t z = lowest.z; z <= highest.z; z++)
+          {
+            std::map<site_t, std::vector<Entry> >::const_iterator bucket =
+                buckets.find(GetCellIndex(util::Vector3D<site_t>(x, y, z)));
+            if (bucket == buckets.end())
+              continue;
+
+            for (std::vector<Entry>::const_iterator entry = bucket->second.begin();
+                 entry != bucket->second.end(); entry++)
+            {
+              if ( (entry->position - position).GetMagnitudeSquared() <= rangeSquared)
+                neighbours.push_back(*entry);
+            }
+          }
+    }
+  }
+}
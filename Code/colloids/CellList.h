@@ -0,0 +1,101 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_COLLOIDS_CELLLIST_H
+#define HEMELB_COLLOIDS_CELLLIST_H
+
+#include <map>
+#include <vector>
+#include "units.h"
+#include "util/Vector3D.h"
+
+namespace hemelb
+{
+  namespace colloids
+  {
+    /**
+     * spatial index of the particles known to the local process
+     *
+     * the lattice is divided into cubic cells and each particle is kept in the
+     * bucket of the cell containing its position, so finding the neighbours of
+     * a point only examines the few cells within range of it, rather than every
+     * particle; updating a particle only moves it between buckets when it has
+     * crossed into another cell
+     */
+    class CellList
+    {
+      public:
+        /** a particle in a bucket */
+        struct Entry
+        {
+          unsigned long particleId;
+          LatticePosition position;
+        };
+
+        /**
+         * constructor - divides the lattice into cells
+         * @param cellWidth the length of each side of a cell, in lattice units
+         * @param latticeExtent the number of sites along each axis of the lattice
+         */
+        CellList(site_t cellWidth, const util::Vector3D<site_t>& latticeExtent);
+
+        /** inserts the particle, or moves it to its new position if already known */
+        const void Update(unsigned long particleId, const LatticePosition& position);
+
+        /** removes the particle, if it is known */
+        const void Remove(unsigned long particleId);
+
+        /** starts a sweep over all known particles - those not updated
+         *  before the call to RemoveStale are assumed to have gone
+         */
+        const void BeginSweep();
+
+        /** removes the particles not updated since the sweep began */
+        const void RemoveStale();
+
+        /** property getter for the number of particles in the list */
+        const size_t GetParticleCount() const
+        {
+          return locations.size();
+        }
+
+        /** appends every particle within range of position (inclusive) to neighbours */
+        const void FindNeighbours(const LatticePosition& position,
+                                  LatticeDistance range,
+                                  std::vector<Entry>& neighbours) const;
+
+      private:
+        /** where a particle's entry is stored */
+        struct Location
+        {
+          site_t cell;
+          size_t slot;
+          /** the sweep in which the particle was last updated */
+          unsigned long sweep;
+        };
+
+        /** the cell coordinate along one axis, clamped to the lattice */
+        site_t GetCellCoordinate(LatticeDistance coordinate, int axis) const;
+
+        site_t GetCellIndex(const util::Vector3D<site_t>& cellCoordinates) const;
+
+        /** removes the entry at the given location, moving the last entry of its bucket into it */
+        const void RemoveEntry(const Location& location);
+
+        const site_t cellWidth;
+        util::Vector3D<site_t> cellCounts;
+
+        /** map cellIndex -> particles in that cell (only non-empty cells are kept) */
+        std::map<site_t, std::vector<Entry> > buckets;
+
+        /** map particleId -> location of its entry */
+        std::map<unsigned long, Location> locations;
+
+        unsigned long currentSweep;
+    };
+  }
+}
+
+#endif /* HEMELB_COLLOIDS_CELLLIST_H */
@@ -36,7 +36,7 @@ namespace hemelb
                                          const std::string& outputPath,
                                          const net::IOCommunicator& ioComms_,
                                          reporting::Timers& timers) :
-      ioComms(ioComms_), simulationState(simulationState), timers(timers)
+      ioComms(ioComms_), simulationState(simulationState), timers(timers), outputPeriod(500)
     {
       // The neighbourhood used here is different to the latticeInfo used to create latDatLBM
       // The portion of the geometry input file that was read in by this proc, i.e. gmyResult
@@ -55,12 +55,36 @@ namespace hemelb
         "[Rank %i]: ColloidController - neighbourhood %i, neighbours %i, allGood %i\n",
         ioComms.Rank(), neighbourhood.size(), neighbourProcessors.size(), allGood);
 
-      io::xml::Element particlesElem = xml.GetRoot().GetChildOrThrow("colloids").GetChildOrThrow("particles");
+      io::xml::Element colloidsElem = xml.GetRoot().GetChildOrThrow("colloids");
+      io::xml::Element outputElem = colloidsElem.GetChildOrNull("output");
+      if (outputElem != io::xml::Element::Missing())
+        outputElem.GetAttributeOrThrow("period", outputPeriod);
+
+      io::xml::Element particlesElem = colloidsElem.GetChildOrThrow("particles");
       particleSet = new ParticleSet(latDatLBM, particlesElem, propertyCache,
                                     lbmParams,
                                     neighbourProcessors, ioComms, outputPath);
     }
 
+    ColloidController::ColloidController(const geometry::LatticeData& latDatLBM,
+                                         const lb::SimulationState& simulationState,
+                                         const geometry::Geometry& gmyResult,
+                                         lb::MacroscopicPropertyCache& propertyCache,
+                                         const hemelb::lb::LbmParameters *lbmParams,
+                                         const net::IOCommunicator& ioComms_,
+                                         reporting::Timers& timers,
+                                         ColloidController& previous,
+                                         const std::vector<proc_t>& procForEachPreviousSite) :
+      ioComms(ioComms_), simulationState(simulationState), timers(timers),
+      outputPeriod(previous.outputPeriod)
+    {
+      // the neighbours are found afresh, as for the first decomposition
+      InitialiseNeighbourList(latDatLBM, gmyResult, GetNeighbourhoodVectors(REGION_OF_INFLUENCE));
+
+      particleSet = new ParticleSet(latDatLBM, propertyCache, lbmParams, neighbourProcessors,
+                                    ioComms, *previous.particleSet, procForEachPreviousSite);
+    }
+
     void ColloidController::InitialiseNeighbourList(
             const geometry::LatticeData& latDatLBM,
             const geometry::Geometry& gmyResult,
@@ -37,6 +37,22 @@ namespace hemelb
                           const net::IOCommunicator& ioComms_,
                           reporting::Timers& timers);
 
+        /**
+         * constructor - moves the particles of a controller made for a previous decomposition
+         * onto this one, carrying on with its output; collective
+         * @param previous the controller on the previous lattice, which must still be intact
+         * @param procForEachPreviousSite the new owner of each of the previous local sites
+         */
+        ColloidController(const geometry::LatticeData& latDatLBM,
+                          const lb::SimulationState& simulationState,
+                          const geometry::Geometry& gmyResult,
+                          lb::MacroscopicPropertyCache& propertyCache,
+                          const hemelb::lb::LbmParameters *lbmParams,
+                          const net::IOCommunicator& ioComms_,
+                          reporting::Timers& timers,
+                          ColloidController& previous,
+                          const std::vector<proc_t>& procForEachPreviousSite);
+
         /** destructor - releases resources allocated by this class */
         ~ColloidController();
 
@@ -48,6 +64,20 @@ namespace hemelb
 
         const void OutputInformation(const LatticeTimeStep timestep) const;
 
+        /** adds the number of locally owned particles in each lattice block to particlesPerBlock,
+         *  which is indexed by block id - for estimating the cost of each block
+         */
+        const void CountLocalParticlesPerBlock(std::vector<site_t>& particlesPerBlock) const
+        {
+          particleSet->CountLocalParticlesPerBlock(particlesPerBlock);
+        }
+
+        /** the number of steps between writes of the particles, or zero never to write them */
+        LatticeTimeStep GetOutputPeriod() const
+        {
+          return outputPeriod;
+        }
+
       private:
         /** Main code communicator */
         const net::IOCommunicator& ioComms;
@@ -60,6 +90,9 @@ namespace hemelb
         /** Timers object, for generating timing data for reports.*/
         reporting::Timers& timers;
 
+        /** the number of steps between writes of the particles, from the optional output element */
+        LatticeTimeStep outputPeriod;
+
         /** maximum separation from a colloid of sites used in its fluid velocity interpolation */
         const static site_t REGION_OF_INFLUENCE = (site_t)2;
 
@@ -30,11 +30,11 @@ namespace hemelb
 
         virtual const bool DoSomethingToParticle(
                              Particle& particle,
-                             const std::vector<LatticePosition> particleToWallVectors)
+                             const std::vector<LatticePosition>& particleToWallVectors)
         {
           // TODO: does not do *beyond* just *within* activation distance of boundary
           //LatticeDistance distance = wallNormal.GetMagnitudeSquared();
-          log::Logger::Log<log::Trace, log::OnePerCore>(
+          HEMELB_LOG(Trace, OnePerCore,
             "*** In DeletionBC::DoSomethingToParticle for particleId: %lu ***\n",
             particle.GetParticleId());
           return false;//distance < (activationDistance * activationDistance);
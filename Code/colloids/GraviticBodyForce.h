@@ -41,6 +41,13 @@ namespace hemelb
           return graviticForce * particle.GetMass();
         };
 
+        virtual const bool AddUniformForce(LatticeForceVector& constantForce,
+                                           LatticeForceVector& forcePerUnitMass) const
+        {
+          forcePerUnitMass += graviticForce;
+          return true;
+        }
+
       protected:
         GraviticBodyForce(const LatticeForceVector constantForce) :
           graviticForce(constantForce) {};
@@ -26,11 +26,11 @@ namespace hemelb
 
         virtual const bool DoSomethingToParticle(
                              Particle& particle,
-                             const std::vector<LatticePosition> particleToWallVectors)
+                             const std::vector<LatticePosition>& particleToWallVectors)
         {
           const bool keep = true;
 
-          log::Logger::Log<log::Trace, log::OnePerCore>(
+          HEMELB_LOG(Trace, OnePerCore,
             "*** In LubricationBC::DoSomethingToParticle for particleId: %lu ***\n",
             particle.GetParticleId());
 
@@ -45,7 +45,7 @@ namespace hemelb
             const LatticeDistance separation_h = particleToWallVector.GetMagnitude()
                                                - particle.GetRadius();
 
-            log::Logger::Log<log::Trace, log::OnePerCore>(
+            HEMELB_LOG(Trace, OnePerCore,
               "*** In LubricationBC::DoSomethingToParticle - wall vector: {%g,%g,%g}, mag: %g, particle radius: %g, separation_h: %g\n",
               particleToWallVector.x,
               particleToWallVector.y,
@@ -63,7 +63,7 @@ namespace hemelb
                 * particle.GetRadius() * particle.GetRadius()
                 * particle.GetInverseNormalisedRadius();
 
-              log::Logger::Log<log::Trace, log::OnePerCore>(
+              HEMELB_LOG(Trace, OnePerCore,
                 "*** In LubricationBC::DoSomethingToParticle - radius: %g, separation: %g, adj: {%g,%g,%g}\n",
                 particle.GetInverseNormalisedRadius(),
                 ( (effectiveRange - separation_h) / (separation_h * effectiveRange) ),
@@ -71,14 +71,14 @@ namespace hemelb
                 lubricationVelocityAdjustment.y,
                 lubricationVelocityAdjustment.z);
             } else {
-              log::Logger::Log<log::Trace, log::OnePerCore>(
+              HEMELB_LOG(Trace, OnePerCore,
                 "*** In LubricationBC::DoSomethingToParticle - separation: %g, range: %g\n",
                 separation_h, effectiveRange);
             }
           }
           particle.SetLubricationVelocityAdjustment(lubricationVelocityAdjustment);
 
-          log::Logger::Log<log::Trace, log::OnePerCore>(
+          HEMELB_LOG(Trace, OnePerCore,
             "*** In LubricationBC::DoSomethingToParticle - particleId: %lu, vel before: {%g,%g,%g}, total adj: {%g,%g,%g}, vel after: {%g,%g,%g}\n",
             particle.GetParticleId(),
             particle.GetVelocity().x - lubricationVelocityAdjustment.x,
@@ -4,6 +4,7 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <algorithm>
 #include "colloids/Particle.h"
 #include "colloids/BodyForces.h"
 #include "geometry/LatticeData.h"
@@ -18,6 +19,7 @@ namespace hemelb
                        const hemelb::lb::LbmParameters *lbmParams,
                        io::xml::Element& xml) :
       PersistedParticle(xml),
+      stencilCell(NoStencilCell),
       lbmParams(lbmParams)
     {
       // updating position with zero velocity and zero body force is necessary
@@ -28,13 +30,24 @@ namespace hemelb
       UpdatePosition(latDatLBM);
 
       OutputInformation();
-      if (log::Logger::ShouldDisplay<log::Trace>())
-        log::Logger::Log<log::Trace, log::OnePerCore>(
+      HEMELB_LOG(Trace, OnePerCore,
           "In colloids::Particle::ctor, id: %i, a0: %g, ah: %g, position: {%g,%g,%g}\n",
           particleId, smallRadius_a0, largeRadius_ah,
           globalPosition.x, globalPosition.y, globalPosition.z);
     }
 
+    Particle::Particle(const geometry::LatticeData& latDatLBM,
+                       const hemelb::lb::LbmParameters *lbmParams,
+                       const PersistedParticle& persisted) :
+      PersistedParticle(persisted),
+      stencilCell(NoStencilCell),
+      lbmParams(lbmParams)
+    {
+      // as above, the zero-velocity update sets the owner rank in the new decomposition
+      ownerRank = SITE_OR_BLOCK_SOLID;
+      UpdatePosition(latDatLBM);
+    }
+
 //    const bool Particle::operator<(const Particle& other) const
 //    {
 //      // ORDER BY isLocal, ownerRank, particleId
@@ -60,7 +73,7 @@ namespace hemelb
 
     const void Particle::OutputInformation() const
     {
-        log::Logger::Log<log::Trace, log::OnePerCore>(
+        HEMELB_LOG(Trace, OnePerCore,
           "In colloids::Particle::OutputInformation, id: %i, owner: %i, drag %g, mass %g, position: {%g,%g,%g}, velocity: {%g,%g,%g}, bodyForces: {%g,%g,%g}\n",
           particleId, ownerRank, CalculateDragCoefficient(), mass,
           globalPosition.x, globalPosition.y, globalPosition.z,
@@ -77,10 +90,11 @@ namespace hemelb
     {
       lastCheckpointTimestep = currentTimestep;
 
-      writer << (uint64_t)ownerRank;
-      writer << (uint64_t)particleId;
-      writer << smallRadius_a0 << largeRadius_ah;
-      writer << globalPosition.x << globalPosition.y << globalPosition.z;
+      const uint64_t ids[2] = { (uint64_t)ownerRank, (uint64_t)particleId };
+      writer.WriteArray(ids, 2);
+      const double values[5] = { smallRadius_a0, largeRadius_ah,
+                                 globalPosition.x, globalPosition.y, globalPosition.z };
+      writer.WriteArray(values, 5);
 
       // if the following code line is ever uncommented
       // change io::formats::colloids::RecordLength to 80
@@ -92,8 +106,7 @@ namespace hemelb
       // first, update the position: newPosition = oldPosition + velocity + bodyForces * drag
       // then,  update the owner rank for the particle based on its new position
 
-      if (log::Logger::ShouldDisplay<log::Trace>())
-        log::Logger::Log<log::Trace, log::OnePerCore>(
+      HEMELB_LOG(Trace, OnePerCore,
           "In colloids::Particle::UpdatePosition, id: %i,\nposition: {%g,%g,%g}\nvelocity: {%g,%g,%g}\nbodyForces: {%g,%g,%g}\n",
           particleId, globalPosition.x, globalPosition.y, globalPosition.z,
           velocity.x, velocity.y, velocity.z, bodyForces.x, bodyForces.y, bodyForces.z);
@@ -111,14 +124,13 @@ namespace hemelb
       isValid = (procId != SITE_OR_BLOCK_SOLID);
       if (isValid && (ownerRank != procId))
       {
-        log::Logger::Log<log::Debug, log::OnePerCore>(
+        HEMELB_LOG(Debug, OnePerCore,
           "Changing owner of particle %i from %i to %i - %s\n",
           particleId, ownerRank, procId, isValid ? "valid" : "INVALID");
         ownerRank = procId;
       }
 
-      if (log::Logger::ShouldDisplay<log::Trace>())
-        log::Logger::Log<log::Trace, log::OnePerCore>(
+      HEMELB_LOG(Trace, OnePerCore,
           "In colloids::Particle::UpdatePosition, id: %i, position is now: {%g,%g,%g}\n",
           particleId, globalPosition.x, globalPosition.y, globalPosition.z);
     }
@@ -139,41 +151,98 @@ namespace hemelb
 
     const void Particle::CalculateBodyForces()
     {
-      log::Logger::Log<log::Trace, log::OnePerCore>(
+      HEMELB_LOG(Trace, OnePerCore,
         "In colloids::Particle::CalculateBodyForces, id: %i, position: {%g,%g,%g}\n",
         particleId, globalPosition.x, globalPosition.y, globalPosition.z);
 
       // delegate the calculation of body forces to the BodyForces class
       bodyForces = BodyForces::GetBodyForcesForParticle(*this);
 
-      log::Logger::Log<log::Trace, log::OnePerCore>(
+      HEMELB_LOG(Trace, OnePerCore,
         "In colloids::Particle::CalculateBodyForces, id: %i, position: {%g,%g,%g}, bodyForces: {%g,%g,%g}\n",
         particleId, globalPosition.x, globalPosition.y, globalPosition.z,
         bodyForces.x, bodyForces.y, bodyForces.z);
     }
 
-    /** modified dirac delta function according to Peskin */
-    const Dimensionless diracOperation(const LatticePosition& relativePosition)
+    /** one-dimensional factor of the modified dirac delta function according to Peskin */
+    const Dimensionless diracAxisOperation(const LatticeDistance distance)
     {
-      Dimensionless delta = 1.0;
-      for (int xyz=0;xyz<3;xyz++)
-      {
-        const LatticeDistance rmod = fabs(relativePosition[xyz]);
+      const LatticeDistance rmod = fabs(distance);
+
+      if (rmod <= 1.0)
+        return 0.125*(3.0 - 2.0*rmod + sqrt(1.0 + 4.0*rmod - 4.0*rmod*rmod));
+      else if (rmod <= 2.0)
+        return 0.125*(5.0 - 2.0*rmod - sqrt(-7.0 + 12.0*rmod  - 4.0*rmod*rmod));
+      else
+        return 0.0;
+    }
+
+    const void Particle::UpdateStencil(const geometry::LatticeData& latDatLBM) const
+    {
+      const util::Vector3D<site_t> cell((site_t)globalPosition.x,
+                                        (site_t)globalPosition.y,
+                                        (site_t)globalPosition.z);
+      if (cell == stencilCell)
+        return;
+
+      HEMELB_LOG(Trace, OnePerCore,
+        "In colloids::Particle::UpdateStencil, particleId: %i, cell: {%i,%i,%i}\n",
+        particleId, cell.x, cell.y, cell.z);
+
+      // nested loop - x, y, z directions semi-open interval [-1, +3) from the cell
+      stencilRanks.clear();
+      int stencilIndex = 0;
+      for (site_t x = cell.x - 1; x < cell.x + StencilWidth - 1; x++)
+        for (site_t y = cell.y - 1; y < cell.y + StencilWidth - 1; y++)
+          for (site_t z = cell.z - 1; z < cell.z + StencilWidth - 1; z++)
+          {
+            // convert the global coordinates of the site into a local site index
+            // the owner is only found for sites in non-empty blocks of the lattice
+            proc_t procId = SITE_OR_BLOCK_SOLID;
+            site_t siteId;
+            const bool isSiteValid = latDatLBM.GetContiguousSiteId(util::Vector3D<site_t>(x, y, z),
+                                                                   procId, siteId);
+            const bool isSiteLocal = (procId == latDatLBM.GetLocalRank());
 
-        if (rmod <= 1.0)
-          delta *= 0.125*(3.0 - 2.0*rmod + sqrt(1.0 + 4.0*rmod - 4.0*rmod*rmod));
-        else if (rmod <= 2.0)
-          delta *= 0.125*(5.0 - 2.0*rmod - sqrt(-7.0 + 12.0*rmod  - 4.0*rmod*rmod));
-        else
-          delta = 0.0;
+            /** TODO: implement boundary conditions for invalid/solid sites */
+            stencilSites[stencilIndex++] = (isSiteValid && isSiteLocal) ? siteId : SITE_OR_BLOCK_SOLID;
 
-      }
-      return delta;
+            if (procId != SITE_OR_BLOCK_SOLID && !isSiteLocal &&
+                std::find(stencilRanks.begin(), stencilRanks.end(), procId) == stencilRanks.end())
+              stencilRanks.push_back(procId);
+          }
+
+      stencilCell = cell;
+    }
+
+    const std::vector<proc_t>& Particle::GetStencilRanks(const geometry::LatticeData& latDatLBM) const
+    {
+      UpdateStencil(latDatLBM);
+      return stencilRanks;
+    }
+
+    const void Particle::CalculateStencilWeights(Dimensionless weights[StencilSize]) const
+    {
+      // the delta function is separable, so only four one-dimensional
+      // weights along each axis need evaluating, rather than one per site
+      Dimensionless axisWeights[3][StencilWidth];
+      for (int xyz = 0; xyz < 3; xyz++)
+        for (int offset = 0; offset < StencilWidth; offset++)
+          axisWeights[xyz][offset] =
+            diracAxisOperation(LatticeDistance(stencilCell[xyz] - 1 + offset) - globalPosition[xyz]);
+
+      int stencilIndex = 0;
+      for (int x = 0; x < StencilWidth; x++)
+        for (int y = 0; y < StencilWidth; y++)
+        {
+          const Dimensionless weightXY = axisWeights[0][x] * axisWeights[1][y];
+          for (int z = 0; z < StencilWidth; z++)
+            weights[stencilIndex++] = weightXY * axisWeights[2][z];
+        }
     }
 
     const void Particle::CalculateFeedbackForces(
                            const geometry::LatticeData& latDatLBM) const
-                           //lb::MacroscopicPropertyCache& propertyCache) const
     {
       /** CalculateFeedbackForces
        *    For each local neighbour lattice site
@@ -181,69 +250,36 @@ namespace hemelb
        *    - set feedback force values into the body forces cache object
        */
 
-      log::Logger::Log<log::Debug, log::OnePerCore>(
+      HEMELB_LOG(Debug, OnePerCore,
         "In colloids::Particle::CalculateFeedbackForces, id: %i, position: {%g,%g,%g}\n",
         particleId, globalPosition.x, globalPosition.y, globalPosition.z);
 
-      // determine the global coordinates of the next neighbour site:
-      // nested loop - x, y, z directions semi-open interval [-2, +2)
-      for (site_t x = ((site_t)globalPosition.x)-1;
-                  x < ((site_t)globalPosition.x)+3; x++)
-        for (site_t y = ((site_t)globalPosition.y)-1;
-                    y < ((site_t)globalPosition.y)+3; y++)
-          for (site_t z = ((site_t)globalPosition.z)-1;
-                      z < ((site_t)globalPosition.z)+3; z++)
-          {
-            const util::Vector3D<site_t> siteGlobalPosition(x, y, z);
-
-            log::Logger::Log<log::Trace, log::OnePerCore>(
-              "In colloids::Particle::CalculateFeedbackForces, particleId: %i, position: {%g,%g,%g}, siteGlobalPosition: {%i,%i,%i}, getting siteId ...\n",
-              particleId, globalPosition.x, globalPosition.y, globalPosition.z,
-              siteGlobalPosition.x, siteGlobalPosition.y, siteGlobalPosition.z);
+      UpdateStencil(latDatLBM);
+      Dimensionless weights[StencilSize];
+      CalculateStencilWeights(weights);
 
-            // convert the global coordinates of the site into a local site index
-            proc_t procId;
-            site_t siteId;
-            bool isSiteValid = latDatLBM.GetContiguousSiteId(siteGlobalPosition, procId, siteId);
-            bool isSiteLocal = (procId == latDatLBM.GetLocalRank());
-
-            log::Logger::Log<log::Trace, log::OnePerCore>(
-              "In colloids::Particle::CalculateFeedbackForces, particleId: %i, position: {%g,%g,%g}, siteGlobalPosition: {%i,%i,%i}, got siteId: %i, isSiteValid: %s, isSiteLocal: %s, procId: %i\n",
-              particleId, globalPosition.x, globalPosition.y, globalPosition.z,
-              siteGlobalPosition.x, siteGlobalPosition.y, siteGlobalPosition.z,
-              siteId, isSiteValid ? "TRUE" : "FALSE", isSiteLocal ? "TRUE" : "FALSE", procId);
-
-            /** TODO: implement boundary conditions for invalid/solid sites */
-            if (!isSiteValid || !isSiteLocal)
-              continue;
-
-            // calculate term of the interpolation sum
-            LatticePosition relativePosition(siteGlobalPosition);
-            relativePosition -= globalPosition;
-            LatticeForceVector contribution = bodyForces * diracOperation(relativePosition);
-
-            log::Logger::Log<log::Trace, log::OnePerCore>(
-              "In colloids::Particle::CalculateFeedbackForces, particleId: %i, siteIndex: %i, bodyForces: {%g,%g,%g}, contribution: {%g,%g,%g}, reading cache ...\n",
-              particleId, siteId, bodyForces.x, bodyForces.y, bodyForces.z,
-              contribution.x, contribution.y, contribution.z);
-
-            // read value of force for site index from macroscopic cache
-            //LatticeForceVector partialInterpolation = propertyCache.bodyForcesCache.Get(siteId) +
-            LatticeForceVector partialInterpolation = BodyForces::GetBodyForcesForSiteId(siteId) +
-                                                      contribution;
-
-            // read value of force for site index from macroscopic cache
-            //propertyCache.bodyForcesCache.Put(siteId, partialInterpolation);
-            BodyForces::SetBodyForcesForSiteId(siteId, partialInterpolation);
-
-            log::Logger::Log<log::Trace, log::OnePerCore>(
-              "In colloids::Particle::CalculateFeedbackForces, particleId: %i, siteIndex: %i, bodyForces: {%g,%g,%g}, contribution: {%g,%g,%g}, forceOnSiteSoFar: {%g,%g,%g}\n",
-              particleId, siteId, bodyForces.x, bodyForces.y, bodyForces.z,
-              contribution.x, contribution.y, contribution.z,
-              partialInterpolation.x, partialInterpolation.y, partialInterpolation.z);
-          }
+      for (int stencilIndex = 0; stencilIndex < StencilSize; stencilIndex++)
+      {
+        const site_t siteId = stencilSites[stencilIndex];
+        if (siteId == SITE_OR_BLOCK_SOLID)
+          continue;
+
+        // calculate term of the interpolation sum
+        const LatticeForceVector contribution = bodyForces * weights[stencilIndex];
+
+        // add it to the force on the site in the body forces object
+        BodyForces::AddBodyForcesForSiteId(siteId, contribution);
+
+        HEMELB_LOG(Trace, OnePerCore,
+          "In colloids::Particle::CalculateFeedbackForces, particleId: %i, siteIndex: %i, bodyForces: {%g,%g,%g}, contribution: {%g,%g,%g}, forceOnSiteSoFar: {%g,%g,%g}\n",
+          particleId, siteId, bodyForces.x, bodyForces.y, bodyForces.z,
+          contribution.x, contribution.y, contribution.z,
+          BodyForces::GetBodyForcesForSiteId(siteId).x,
+          BodyForces::GetBodyForcesForSiteId(siteId).y,
+          BodyForces::GetBodyForcesForSiteId(siteId).z);
+      }
 
-      log::Logger::Log<log::Trace, log::OnePerCore>(
+      HEMELB_LOG(Trace, OnePerCore,
         "In colloids::Particle::CalculateFeedbackForces, particleId: %i, bodyForces: {%g,%g,%g}, finished\n",
         particleId, bodyForces.x, bodyForces.y, bodyForces.z);
     }
@@ -260,137 +296,33 @@ namespace hemelb
        *    - will require communication to transmit remote contributions
        */
 
-      log::Logger::Log<log::Debug, log::OnePerCore>(
+      HEMELB_LOG(Debug, OnePerCore,
         "In colloids::Particle::InterpolateFluidVelocity, id: %i, position: {%g,%g,%g}\n",
         particleId, globalPosition.x, globalPosition.y, globalPosition.z);
 
+      UpdateStencil(latDatLBM);
+      Dimensionless weights[StencilSize];
+      CalculateStencilWeights(weights);
+
       velocity *= 0.0;
-      // determine the global coordinates of the next neighbour site:
-      // nested loop - x, y, z directions semi-open interval [-2, +2)
-      for (site_t x = ((site_t)globalPosition.x)-1;
-                  x < ((site_t)globalPosition.x)+3; x++)
-        for (site_t y = ((site_t)globalPosition.y)-1;
-                    y < ((site_t)globalPosition.y)+3; y++)
-          for (site_t z = ((site_t)globalPosition.z)-1;
-                      z < ((site_t)globalPosition.z)+3; z++)
-          {
-            const util::Vector3D<site_t> siteGlobalPosition(x, y, z);
+      for (int stencilIndex = 0; stencilIndex < StencilSize; stencilIndex++)
+      {
+        const site_t siteId = stencilSites[stencilIndex];
+        if (siteId == SITE_OR_BLOCK_SOLID)
+          continue;
 
-            // convert the global coordinates of the site into a local site index
-            proc_t procId;
-            site_t siteId;
-            bool isSiteValid = latDatLBM.GetContiguousSiteId(siteGlobalPosition, procId, siteId);
-            bool isSiteLocal = (procId == latDatLBM.GetLocalRank());
-
-            if (log::Logger::ShouldDisplay<log::Trace>())
-            {
-              log::Logger::Log<log::Trace, log::OnePerCore>("WAIT A MINUTE 1 ...\n");
-
-              int globalStatus = 0; // valid && local fluid
-              int blockStatus = 0; // valid && non-empty
-              int siteStatus = 0; // valid && fluid
-
-              util::Vector3D<site_t> blockCoords, localSiteCoords;
-              latDatLBM.GetBlockAndLocalSiteCoords(siteGlobalPosition, blockCoords, localSiteCoords);
-              log::Logger::Log<log::Trace, log::OnePerCore>("WAIT A MINUTE 2 ...\n");
-              if (!latDatLBM.IsValidBlock(blockCoords))
-                blockStatus = 1; // invalid - out of range
-              else if (latDatLBM.GetBlock(latDatLBM.GetBlockIdFromBlockCoords(blockCoords)).IsEmpty())
-                blockStatus = 2; // empty - entire block is solid
-
-              log::Logger::Log<log::Trace, log::OnePerCore>("WAIT A MINUTE 3 ...\n");
-
-              if (!latDatLBM.IsValidLatticeSite(localSiteCoords))
-                siteStatus = 1; // invalid - out of range
-              else if (blockStatus == 2)
-                siteStatus = 2; // deemed solid because block is empty
-              else if (blockStatus == 0)
-              {
-                if (latDatLBM.GetBlock(latDatLBM.GetBlockIdFromBlockCoords(blockCoords)).GetProcessorRankForSite(latDatLBM.GetLocalSiteIdFromLocalSiteCoords(localSiteCoords)) == SITE_OR_BLOCK_SOLID)
-                {
-                  siteStatus = 3; // individual site is not simulated, i.e. must be solid
-                }
-                else if (latDatLBM.GetBlock(latDatLBM.GetBlockIdFromBlockCoords(blockCoords)).GetProcessorRankForSite(latDatLBM.GetLocalSiteIdFromLocalSiteCoords(localSiteCoords)) == latDatLBM.GetLocalRank())
-                {
-                  if (latDatLBM.GetBlock(latDatLBM.GetBlockIdFromBlockCoords(blockCoords)).SiteIsSolid(latDatLBM.GetLocalSiteIdFromLocalSiteCoords(localSiteCoords)))
-                  siteStatus = 4; // individual site is local but solid (should not happen?)
-                }
-              }
-              log::Logger::Log<log::Trace, log::OnePerCore>("WAIT A MINUTE 4 ...\n");
-
-              if (blockStatus == 1 || (siteStatus == 1))
-                globalStatus = 1; // invalid - out of range
-              else if (blockStatus == 2 || (siteStatus == 3) | (siteStatus == 4))
-                globalStatus = 2; // solid
-              else if (latDatLBM.GetBlock(latDatLBM.GetBlockIdFromBlockCoords(blockCoords)).GetProcessorRankForSite(latDatLBM.GetLocalSiteIdFromLocalSiteCoords(localSiteCoords)) != latDatLBM.GetLocalRank())
-                globalStatus = 3; // remote fluid
-
-              log::Logger::Log<log::Trace, log::OnePerCore>("ABOUT TO DO STUFF\n");
-              log::Logger::Log<log::Trace, log::OnePerCore>(
-                "In colloids::Particle::InterpolateFluidVelocity, particleId: %i, siteGlobalPosition: {%i,%i,%i} - %s \n",
-                particleId, siteGlobalPosition.x, siteGlobalPosition.y, siteGlobalPosition.z,
-                globalStatus == 0 ? "valid && local fluid" :
-                (globalStatus == 1 ? "invalid - out-of-range" :
-                (globalStatus == 2 ? "solid" :
-                (globalStatus == 3 ? "remote fluid" : "unknown status"))));
-              log::Logger::Log<log::Trace, log::OnePerCore>("ABOUT TO DO MORE STUFF\n");
-              log::Logger::Log<log::Trace, log::OnePerCore>(
-                "In colloids::Particle::InterpolateFluidVelocity, particleId: %i, blockCoords: {%i,%i,%i} - %s\n",
-                particleId, blockCoords.x, blockCoords.y, blockCoords.z,
-                blockStatus == 0 ? "valid && non-empty" :
-                (blockStatus == 1 ? "invalid - out-of-range" :
-                (blockStatus == 2 ? "empty - entire block is solid" : "unknown status")));
-              log::Logger::Log<log::Trace, log::OnePerCore>("ABOUT TO DO EVEN MORE STUFF\n");
-              log::Logger::Log<log::Trace, log::OnePerCore>(
-                "In colloids::Particle::InterpolateFluidVelocity, particleId: %i, localSiteCoords: {%i,%i,%i} - %s\n",
-                particleId, localSiteCoords.x, localSiteCoords.y, localSiteCoords.z,
-                siteStatus == 0 ? "valid && fluid" :
-                (siteStatus == 1 ? "invalid - out of range" :
-                (siteStatus == 2 ? "deemed solid because block is empty" :
-                (siteStatus == 3 ? "deemed solid because not simulated" :
-                (siteStatus == 4 ? "local but solid (should not happen?)" : "unknown status")))));
-//*/
-              if (siteStatus == 0)
-              log::Logger::Log<log::Trace, log::OnePerCore>("ABOUT TO DO ONE LAST THING\n");
-              if (siteStatus == 0)
-              log::Logger::Log<log::Trace, log::OnePerCore>(
-                "In colloids::Particle::InterpolateFluidVelocity, particleId: %i, procIdForSite: %i\n",
-                particleId, latDatLBM.GetBlock(latDatLBM.GetBlockIdFromBlockCoords(blockCoords)).GetProcessorRankForSite(latDatLBM.GetLocalSiteIdFromLocalSiteCoords(localSiteCoords)));
-              log::Logger::Log<log::Trace, log::OnePerCore>("DONE LOTS OF STUFF\n");
-
-              if (!isSiteValid || !isSiteLocal)
-                if (globalStatus == 0)
-                {
-                  log::Logger::Log<log::Trace, log::OnePerCore>("MAJOR PROBLEM! isValid: %s, isLocal: %s, procIdForSite: %i, localRank: %i\n", isSiteValid ? "T": "F", isSiteLocal ? "T" : "F",
-                    latDatLBM.GetBlock(latDatLBM.GetBlockIdFromBlockCoords(blockCoords)).GetProcessorRankForSite(latDatLBM.GetLocalSiteIdFromLocalSiteCoords(localSiteCoords)),
-                    latDatLBM.GetLocalRank());
-                }
-            }
+        // read value of velocity for site index from macroscopic cache
+        // TODO: should be LatticeVelocity == Vector3D<LatticeSpeed> (fix as part of #437)
+        const util::Vector3D<double>& siteFluidVelocity = propertyCache.velocityCache.Get(siteId);
 
-            /** TODO: implement boundary conditions for invalid/solid sites */
-            if (!isSiteValid || !isSiteLocal)
-              continue;
-
-            // read value of velocity for site index from macroscopic cache
-            // TODO: should be LatticeVelocity == Vector3D<LatticeSpeed> (fix as part of #437)
-            util::Vector3D<double> siteFluidVelocity = propertyCache.velocityCache.Get(siteId);
-
-            // calculate term of the interpolation sum
-            LatticePosition relativePosition(siteGlobalPosition);
-            relativePosition -= globalPosition;
-            // TODO: should be LatticeVelocity == Vector3D<LatticeSpeed> (fix as part of #437)
-            util::Vector3D<double> partialInterpolation = siteFluidVelocity *
-              diracOperation(relativePosition);
-
-            // accumulate each term of the interpolation
-            velocity += partialInterpolation;
-
-            log::Logger::Log<log::Trace, log::OnePerCore>(
-              "In colloids::Particle::InterpolateFluidVelocity, particleId: %i, siteIndex: %i, fluidVelocity: {%g,%g,%g}, partialInterpolation: {%g,%g,%g}, velocitySoFar: {%g,%g,%g}\n",
-              particleId, siteId, siteFluidVelocity.x, siteFluidVelocity.y, siteFluidVelocity.z,
-              partialInterpolation.x, partialInterpolation.y, partialInterpolation.z,
-              velocity.x, velocity.y, velocity.z);
-          }
+        // accumulate each term of the interpolation
+        velocity += siteFluidVelocity * weights[stencilIndex];
+
+        HEMELB_LOG(Trace, OnePerCore,
+          "In colloids::Particle::InterpolateFluidVelocity, particleId: %i, siteIndex: %i, fluidVelocity: {%g,%g,%g}, velocitySoFar: {%g,%g,%g}\n",
+          particleId, siteId, siteFluidVelocity.x, siteFluidVelocity.y, siteFluidVelocity.z,
+          velocity.x, velocity.y, velocity.z);
+      }
     }
 
   }
@@ -7,6 +7,8 @@
 #ifndef HEMELB_COLLOIDS_PARTICLE_H
 #define HEMELB_COLLOIDS_PARTICLE_H
 
+#include <limits>
+#include <vector>
 #include "net/mpi.h"
 #include "colloids/PersistedParticle.h"
 #include "geometry/LatticeData.h"
@@ -35,8 +37,18 @@ namespace hemelb
                  const hemelb::lb::LbmParameters *lbmParams,
                  io::xml::Element& xml);
 
+        /** constructor - gets persisted values from a particle moved from another process,
+         *  when the domain has been decomposed again
+         */
+        Particle(const geometry::LatticeData& latDatLBM,
+                 const hemelb::lb::LbmParameters *lbmParams,
+                 const PersistedParticle& persisted);
+
         /** constructor - gets an invalid particle for making MPI data types */
-        Particle() {};
+        Particle() :
+          stencilCell(NoStencilCell)
+        {
+        }
 
         /** property getter for particleId */
         const unsigned long GetParticleId() const { return particleId; }
@@ -102,6 +114,12 @@ namespace hemelb
         /** property getter for isValid */
         const bool IsValid() const { return isValid; }
 
+        /** the persisted properties of this particle, for moving it to another process */
+        const PersistedParticle& GetPersistedParticle() const
+        {
+          return *this;
+        }
+
         /**
          * less than operator for comparing particle objects
          *
@@ -147,6 +165,14 @@ namespace hemelb
                      const geometry::LatticeData& latDatLBM,
                      const lb::MacroscopicPropertyCache& propertyCache);
 
+        /** the other processes that own fluid sites in this particle's interpolation stencil
+         *  i.e. those that need to know about this particle to interpolate or feed back
+         */
+        const std::vector<proc_t>& GetStencilRanks(const geometry::LatticeData& latDatLBM) const;
+
+        /** property getter for the fluid velocity interpolated from local sites so far */
+        const LatticeVelocity& GetPartialVelocity() const { return velocity; }
+
         /** accumulate contributions to velocity from remote processes */
         const void AccumulateVelocity(util::Vector3D<double>& contribution)
         {
@@ -176,6 +202,34 @@ namespace hemelb
         const MPI_Datatype CreateMpiDatatypeWithVelocity() const;
 
       private:
+        /** marks the stencil cache as empty - no particle can be in this cell */
+        static const site_t NoStencilCell = std::numeric_limits<site_t>::min();
+
+        /** the number of lattice sites along each side of the interpolation stencil */
+        static const int StencilWidth = 4;
+        static const int StencilSize = StencilWidth * StencilWidth * StencilWidth;
+
+        /** resolves the stencil sites around the particle's current lattice cell
+         *  to local site indices, unless they are already cached for that cell
+         */
+        const void UpdateStencil(const geometry::LatticeData& latDatLBM) const;
+
+        /** evaluates the regularised delta function for every stencil site
+         *  as the product of one-dimensional weights along each axis
+         */
+        const void CalculateStencilWeights(Dimensionless weights[StencilSize]) const;
+
+        /** the lattice cell whose stencil sites are cached - or none at all */
+        mutable util::Vector3D<site_t> stencilCell;
+
+        /** the local contiguous index of each stencil site, with z varying fastest,
+         *  or SITE_OR_BLOCK_SOLID if the site is solid, outside the lattice or remote
+         */
+        mutable site_t stencilSites[StencilSize];
+
+        /** the other processes owning fluid sites in the cached stencil */
+        mutable std::vector<proc_t> stencilRanks;
+
         /** partial interpolation of fluid velocity - temporary value only */
         LatticeVelocity velocity;
 
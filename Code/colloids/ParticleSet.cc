@@ -45,8 +45,14 @@ namespace hemelb
                              std::vector<proc_t>& neighbourProcessors,
                              const net::IOCommunicator& ioComms_,
                              const std::string& outputPath) :
-        ioComms(ioComms_), localRank(ioComms.Rank()), latDatLBM(latDatLBM), propertyCache(propertyCache), path(outputPath), net(ioComms)
+        ioComms(ioComms_), localRank(ioComms.Rank()),
+        cellList(latDatLBM.GetBlockSize(), latDatLBM.GetSiteDimensions()),
+        latDatLBM(latDatLBM), propertyCache(propertyCache), net(ioComms),
+        nextBlockOffset(io::formats::colloids::MagicLength), path(outputPath)
     {
+#ifdef HEMELB_USE_ASYNC_COLLOID_WRITES
+      pendingWrite = MPI_REQUEST_NULL;
+#endif
       /**
        * Open the file, unless it already exists, for writing only, creating it if it doesn't exist.
        */
@@ -60,20 +66,10 @@ namespace hemelb
         writer << (uint32_t) io::formats::HemeLbMagicNumber;
         writer << (uint32_t) io::formats::colloids::MagicNumber;
         writer << (uint32_t) io::formats::colloids::VersionNumber;
-        file.Write(buffer);
+        file.WriteAt(0, buffer);
       }
 
-      HEMELB_MPI_CALL(MPI_File_seek_shared, (file, 0, MPI_SEEK_END));
-
-      // add an element into scanMap for each neighbour rank with zero for both counts
-      // sorting the list of neighbours allows the position in the map to be predicted
-      // & giving the correct position in the map makes insertion significantly faster
-      // the local rank is added last, because its position cannot be easily predicted
-      std::sort(neighbourProcessors.begin(), neighbourProcessors.end());
-      for (std::vector<proc_t>::const_iterator iter = neighbourProcessors.begin(); iter != neighbourProcessors.end();
-          iter++)
-        scanMap.insert(scanMap.end(), scanMapContentType(*iter, scanMapElementType(0, 0)));
-      scanMap.insert(scanMapContentType(localRank, scanMapElementType(0, 0)));
+      InitialiseScanMap(neighbourProcessors);
 
       // assume we are at the <Particles> node
       bool first = true;
@@ -93,29 +89,114 @@ namespace hemelb
         {
           // add the particle to the list of known particles ...
           particles.push_back(nextParticle);
+          cellList.Update(nextParticle.GetParticleId(), nextParticle.GetGlobalPosition());
           // ... and keep the count of local particles up-to-date
           scanMap[localRank].first++;
         }
       }
     }
 
+    ParticleSet::ParticleSet(const geometry::LatticeData& latDatLBM,
+                             lb::MacroscopicPropertyCache& propertyCache,
+                             const hemelb::lb::LbmParameters *lbmParams,
+                             std::vector<proc_t>& neighbourProcessors,
+                             const net::IOCommunicator& ioComms_,
+                             ParticleSet& previous,
+                             const std::vector<proc_t>& procForEachPreviousSite) :
+        ioComms(ioComms_), localRank(ioComms.Rank()),
+        cellList(latDatLBM.GetBlockSize(), latDatLBM.GetSiteDimensions()),
+        latDatLBM(latDatLBM), propertyCache(propertyCache), net(ioComms),
+        nextBlockOffset(previous.nextBlockOffset), path(previous.path), file(previous.file)
+    {
+#ifdef HEMELB_USE_ASYNC_COLLOID_WRITES
+      pendingWrite = MPI_REQUEST_NULL;
+#endif
+      // carry on writing to the same file, once the previous set has finished with it
+      previous.FinishWriting();
+
+      InitialiseScanMap(neighbourProcessors);
+
+      // send each of the previous set's local particles to the process that now owns the site
+      // nearest to it - the previous lattice is still intact, so its site indices are valid
+      std::vector<std::vector<PersistedParticle> > particlesForEachProc(ioComms.Size());
+      for (unsigned int particleIndex = 0; particleIndex < previous.scanMap[previous.localRank].first;
+          particleIndex++)
+      {
+        const Particle& particle = previous.particles[particleIndex];
+        const util::Vector3D<site_t> siteGlobalPosition(
+          (site_t)(0.5+particle.GetGlobalPosition().x),
+          (site_t)(0.5+particle.GetGlobalPosition().y),
+          (site_t)(0.5+particle.GetGlobalPosition().z));
+        proc_t procId = SITE_OR_BLOCK_SOLID;
+        site_t siteId;
+        if (previous.latDatLBM.GetContiguousSiteId(siteGlobalPosition, procId, siteId))
+          particlesForEachProc[procForEachPreviousSite[siteId]].push_back(particle.GetPersistedParticle());
+      }
+
+      std::vector<PersistedParticle> outgoing;
+      std::vector<int> sendCounts(ioComms.Size());
+      for (int proc = 0; proc < ioComms.Size(); proc++)
+      {
+        outgoing.insert(outgoing.end(), particlesForEachProc[proc].begin(), particlesForEachProc[proc].end());
+        sendCounts[proc] = particlesForEachProc[proc].size();
+      }
+      const std::vector<PersistedParticle> incoming = ioComms.AllToAllV(outgoing, sendCounts);
+
+      propertyCache.velocityCache.SetRefreshFlag();
+      for (std::vector<PersistedParticle>::const_iterator iter = incoming.begin(); iter != incoming.end(); iter++)
+      {
+        Particle nextParticle(latDatLBM, lbmParams, *iter);
+        if (nextParticle.IsValid() && nextParticle.GetOwnerRank() == localRank)
+        {
+          particles.push_back(nextParticle);
+          cellList.Update(nextParticle.GetParticleId(), nextParticle.GetGlobalPosition());
+          scanMap[localRank].first++;
+        }
+      }
+      std::sort(particles.begin(), particles.end(), ParticleSorter(localRank));
+    }
+
+    const void ParticleSet::InitialiseScanMap(std::vector<proc_t>& neighbourProcessors)
+    {
+      // add an element into scanMap for each neighbour rank with zero for both counts
+      // sorting the list of neighbours allows the position in the map to be predicted
+      // & giving the correct position in the map makes insertion significantly faster
+      // the local rank is added last, because its position cannot be easily predicted
+      std::sort(neighbourProcessors.begin(), neighbourProcessors.end());
+      for (std::vector<proc_t>::const_iterator iter = neighbourProcessors.begin(); iter != neighbourProcessors.end();
+          iter++)
+      {
+        scanMap.insert(scanMap.end(), scanMapContentType(*iter, scanMapElementType(0, 0)));
+        positionExchanges[*iter];
+        velocityExchanges[*iter];
+      }
+      scanMap.insert(scanMapContentType(localRank, scanMapElementType(0, 0)));
+    }
+
     ParticleSet::~ParticleSet()
     {
+      // The file can't be closed with a write still going.
+      FinishWriting();
       particles.clear();
     }
 
-    const void ParticleSet::OutputInformation(const LatticeTimeStep timestep)
+    const void ParticleSet::FinishWriting()
     {
-      // Ensure the buffer is large enough.
-      const unsigned int maxSize = io::formats::colloids::RecordLength * particles.size()
-          + io::formats::colloids::HeaderLength;
-      if (buffer.size() < maxSize)
+#ifdef HEMELB_USE_ASYNC_COLLOID_WRITES
+      if (pendingWrite != MPI_REQUEST_NULL)
       {
-        buffer.resize(maxSize);
+        HEMELB_MPI_CALL(MPI_Wait, (&pendingWrite, MPI_STATUS_IGNORE));
       }
+#endif
+    }
+
+    const void ParticleSet::OutputInformation(const LatticeTimeStep timestep)
+    {
+      // Ensure the buffer is large enough.
+      buffer.resize(io::formats::colloids::RecordLength * particles.size());
 
       // Create an XDR writer and write all the particles for this processor.
-      io::writers::xdr::XdrMemWriter writer(&buffer.front(), maxSize);
+      io::writers::xdr::XdrMemWriter writer(buffer.empty() ? NULL : &buffer.front(), buffer.size());
 
       for (std::vector<Particle>::iterator iter = particles.begin(); iter != particles.end(); iter++)
       {
@@ -128,130 +209,127 @@ namespace hemelb
       }
 
       // And get the number of bytes written.
-      const unsigned int count = writer.getCurrentStreamPosition();
+      const uint64_t count = writer.getCurrentStreamPosition();
+      buffer.resize(count);
 
-      // Find how far we currently are into the file.
-      MPI_Offset positionBeforeWriting;
-      HEMELB_MPI_CALL(MPI_File_get_position_shared, (file, &positionBeforeWriting));
+      // Each rank's records follow those of the ranks before it, after the block's header,
+      // so every rank knows where to write without going through a shared file pointer.
+      const uint64_t precedingBytes = ioComms.ExScan(count, MPI_SUM);
+      const uint64_t blockBytes = ioComms.AllReduce(count, MPI_SUM);
 
-      log::Logger::Log<log::Debug, log::OnePerCore>("from offsetEOF: %i\n", positionBeforeWriting);
+      HEMELB_LOG(Debug, OnePerCore, "from offsetEOF: %i\n", nextBlockOffset);
 
-      // Go past the header (which we'll write at the end)
-      unsigned int sizeOfHeader = io::formats::colloids::HeaderLength;
-      HEMELB_MPI_CALL(MPI_File_seek_shared, (file, sizeOfHeader, MPI_SEEK_END));
-
-      // Collective write: the effect is as though all writes are done
-      // in serialised order, i.e. as if rank 0 writes first, followed
-      // by rank 1, and so on, until all ranks have written their data
-      HEMELB_MPI_CALL(MPI_File_write_ordered, (file, &buffer.front(), count, MPI_CHAR, MPI_STATUS_IGNORE));
-
-      // the collective ordered write modifies the shared file pointer
-      // it should point to the byte following the highest rank's data
-      // (should be true for all ranks but) we only need it for rank 0
-      MPI_Offset positionAferWriting;
-      HEMELB_MPI_CALL(MPI_File_get_position_shared, (file, &positionAferWriting));
-
-      log::Logger::Log<log::Debug, log::OnePerCore>("new offsetEOF: %i\n", positionBeforeWriting);
-
-      // Now write the header section, only on rank 0.
+      // Write the header section, only on the IO rank.
       if (ioComms.OnIORank())
       {
-        writer << (uint32_t) io::formats::colloids::HeaderLength;
-        writer << (uint32_t) io::formats::colloids::RecordLength;
-        writer << (uint64_t) (positionAferWriting - positionBeforeWriting - io::formats::colloids::HeaderLength);
-        writer << (uint64_t) timestep;
-        HEMELB_MPI_CALL(MPI_File_write_at, (file, positionBeforeWriting, &buffer[count], sizeOfHeader, MPI_CHAR, MPI_STATUS_IGNORE));
+        headerBuffer.resize(io::formats::colloids::HeaderLength);
+        io::writers::xdr::XdrMemWriter headerWriter(&headerBuffer.front(), headerBuffer.size());
+        headerWriter << (uint32_t) io::formats::colloids::HeaderLength;
+        headerWriter << (uint32_t) io::formats::colloids::RecordLength;
+        headerWriter << (uint64_t) blockBytes;
+        headerWriter << (uint64_t) timestep;
+        file.WriteAt(nextBlockOffset, headerBuffer);
       }
 
+      const MPI_Offset recordsOffset = nextBlockOffset + io::formats::colloids::HeaderLength
+          + precedingBytes;
+#ifdef HEMELB_USE_ASYNC_COLLOID_WRITES
+      // Only one write at a time, so if the last one still hasn't finished, we wait for it here.
+      FinishWriting();
+      buffer.swap(writingBuffer);
+      file.IWriteAtAll(recordsOffset, writingBuffer, &pendingWrite);
+#else
+      file.WriteAtAll(recordsOffset, buffer);
+#endif
+      nextBlockOffset += io::formats::colloids::HeaderLength + blockBytes;
+
+      HEMELB_LOG(Debug, OnePerCore, "new offsetEOF: %i\n", nextBlockOffset);
+
       for (scanMapConstIterType iterMap = scanMap.begin(); iterMap != scanMap.end(); iterMap++)
       {
         const proc_t& neighbourRank = iterMap->first;
         const unsigned int& numberOfParticles = iterMap->second.first;
         const unsigned int& numberOfVelocities = iterMap->second.second;
-        log::Logger::Log<log::Debug, log::OnePerCore>("ScanMap[%i] = {%i, %i}\n",
-                                                      neighbourRank,
-                                                      numberOfParticles,
-                                                      numberOfVelocities);
+        HEMELB_LOG(Debug, OnePerCore, "ScanMap[%i] = {%i, %i}\n",
+                   neighbourRank,
+                   numberOfParticles,
+                   numberOfVelocities);
       }
     }
 
     const void ParticleSet::UpdatePositions()
     {
-      if (log::Logger::ShouldDisplay<log::Debug>())
-        log::Logger::Log<log::Debug, log::OnePerCore>("In colloids::ParticleSet::UpdatePositions #particles == %i ...\n",
-                                                      localRank,
-                                                      particles.size());
+      HEMELB_LOG(Debug, OnePerCore, "In colloids::ParticleSet::UpdatePositions #particles == %i ...\n",
+                 localRank,
+                 particles.size());
 
       // only update the position for particles that are locally owned because
       // only the owner has velocity contributions from all neighbouring ranks
-      for (std::vector<Particle>::iterator iter = particles.begin(); iter != particles.end(); iter++)
+      // - the particles are kept sorted local first, so these are the leading ones
+      const unsigned int numberOfLocalParticles = scanMap[localRank].first;
+      for (unsigned int particleIndex = 0; particleIndex < numberOfLocalParticles; particleIndex++)
       {
-        Particle& particle = *iter;
-        if (particle.GetOwnerRank() == localRank)
-          particle.UpdatePosition(latDatLBM);
+        Particle& particle = particles[particleIndex];
+        particle.UpdatePosition(latDatLBM);
+        cellList.Update(particle.GetParticleId(), particle.GetGlobalPosition());
       }
     }
 
     const void ParticleSet::CalculateBodyForces()
     {
-      for (std::vector<Particle>::iterator iter = particles.begin(); iter != particles.end(); iter++)
-      {
-        Particle& particle = *iter;
-        if (particle.GetOwnerRank() == localRank)
-          particle.CalculateBodyForces();
-      }
+      const unsigned int numberOfLocalParticles = scanMap[localRank].first;
+      for (unsigned int particleIndex = 0; particleIndex < numberOfLocalParticles; particleIndex++)
+        particles[particleIndex].CalculateBodyForces();
     }
 
     const void ParticleSet::ApplyBoundaryConditions(const LatticeTimeStep currentTimestep)
     {
-      for (std::vector<Particle>::iterator iter = particles.begin(); iter != particles.end(); iter++)
+      const unsigned int numberOfLocalParticles = scanMap[localRank].first;
+      for (unsigned int particleIndex = 0; particleIndex < numberOfLocalParticles; particleIndex++)
       {
-        Particle& particle = *iter;
-        if (particle.GetOwnerRank() == localRank)
-        {
-          BoundaryConditions::DoSomeThingsToParticle(currentTimestep, particle);
-          if (particle.IsReadyToBeDeleted())
-            log::Logger::Log<log::Trace, log::OnePerCore>("In ParticleSet::ApplyBoundaryConditions - timestep: %lu, particleId: %lu, IsReadyToBeDeleted: %s, markedForDeletion: %lu, lastCheckpoint: %lu\n",
-                                                          currentTimestep,
-                                                          particle.GetParticleId(),
-                                                          particle.IsReadyToBeDeleted() ?
-                                                            "YES" :
-                                                            "NO",
-                                                          particle.GetDeletionMarker(),
-                                                          particle.GetLastCheckpointTimestep());
-        }
+        Particle& particle = particles[particleIndex];
+        BoundaryConditions::DoSomeThingsToParticle(currentTimestep, particle);
+        if (particle.IsReadyToBeDeleted())
+          HEMELB_LOG(Trace, OnePerCore, "In ParticleSet::ApplyBoundaryConditions - timestep: %lu, particleId: %lu, IsReadyToBeDeleted: %s, markedForDeletion: %lu, lastCheckpoint: %lu\n",
+                     currentTimestep,
+                     particle.GetParticleId(),
+                     particle.IsReadyToBeDeleted() ?
+                       "YES" :
+                       "NO",
+                     particle.GetDeletionMarker(),
+                     particle.GetLastCheckpointTimestep());
       }
 
-      // shuffle (or partition) the particles in our vector containing all particles
-      // so the first partition contains all the local particles that should be kept
-      // and the other contains all the deletable-local plus the non-local particles
-      std::vector<Particle>::iterator bound =
-          std::partition(particles.begin(),
-                         particles.begin() + scanMap[localRank].first,
-                         std::not1(std::mem_fun_ref(&Particle::IsReadyToBeDeleted)));
+      // compact the local particles in place, so the ones that should be kept
+      // stay in order at the front and the deletable ones are dropped straight
+      // away - the non-local particles after them move down but keep their order
+      const std::vector<Particle>::iterator endOfLocalParticles =
+          particles.begin() + numberOfLocalParticles;
+      const std::vector<Particle>::iterator bound =
+          std::remove_if(particles.begin(),
+                         endOfLocalParticles,
+                         std::mem_fun_ref(&Particle::IsReadyToBeDeleted));
+      const unsigned int numberOfKeptParticles = bound - particles.begin();
+      particles.erase(bound, endOfLocalParticles);
+
+      if (numberOfLocalParticles > numberOfKeptParticles)
+        HEMELB_LOG(Debug, OnePerCore, "In ParticleSet::ApplyBoundaryConditions - timestep: %lu, scanMap[localRank].first: %lu, kept: %lu\n",
+                   currentTimestep,
+                   numberOfLocalParticles,
+                   numberOfKeptParticles);
 
-      if (scanMap[localRank].first > (bound - particles.begin()))
-        log::Logger::Log<log::Debug, log::OnePerCore>("In ParticleSet::ApplyBoundaryConditions - timestep: %lu, scanMap[localRank].first: %lu, bound-particles.begin(): %lu\n",
-                                                      currentTimestep,
-                                                      scanMap[localRank].first,
-                                                      bound - particles.begin());
-
-      // the partitioning above may invalidate the scanMap used by the communication
       // the next communication function called is CommunicatePositions, which needs
       // the number of local particles to be correct - i.e. scanMap[localRank].first
       // - the rest of scanMap will be re-built by the CommunicatePositions function
-      scanMap[localRank].first = bound - particles.begin();
+      scanMap[localRank].first = numberOfKeptParticles;
     }
 
     const void ParticleSet::CalculateFeedbackForces()
     {
       BodyForces::ClearBodyForcesForAllSiteIds();
-      for (std::vector<Particle>::const_iterator iter = particles.begin(); iter != particles.end(); iter++)
-      {
-        const Particle& particle = *iter;
-        if (particle.GetOwnerRank() == localRank)
-          particle.CalculateFeedbackForces(latDatLBM);
-      }
+      const unsigned int numberOfLocalParticles = scanMap[localRank].first;
+      for (unsigned int particleIndex = 0; particleIndex < numberOfLocalParticles; particleIndex++)
+        particles[particleIndex].CalculateFeedbackForces(latDatLBM);
     }
 
     const void ParticleSet::InterpolateFluidVelocity()
@@ -264,15 +342,77 @@ namespace hemelb
       propertyCache.velocityCache.SetRefreshFlag();
     }
 
+    /** the MPI payload of a particle sent to a neighbour - its persisted properties */
+    static PersistedParticle* Payload(Particle* particle)
+    {
+      return & ((PersistedParticle&) *particle);
+    }
+
+    static ParticleSet::VelocityContribution* Payload(ParticleSet::VelocityContribution* contribution)
+    {
+      return contribution;
+    }
+
+    template<typename T>
+    const void ParticleSet::ExchangeWithNeighbours(std::map<proc_t, PackedExchange<T> >& exchanges)
+    {
+      // every buffer is sent whole, so that the messages match in size on both sides
+      // and the count of values in it can travel in the same round as the values
+      for (typename std::map<proc_t, PackedExchange<T> >::iterator iter = exchanges.begin();
+          iter != exchanges.end(); iter++)
+      {
+        const proc_t& neighbourRank = iter->first;
+        PackedExchange<T>& exchange = iter->second;
+        exchange.sendCount = exchange.sendBuffer.size();
+        if (exchange.sendBuffer.size() < ExchangeCapacity)
+          exchange.sendBuffer.resize(ExchangeCapacity);
+        exchange.recvBuffer.resize(ExchangeCapacity);
+        net.RequestSendR(exchange.sendCount, neighbourRank);
+        net.RequestSend(Payload(&exchange.sendBuffer[0]), ExchangeCapacity, neighbourRank);
+        net.RequestReceiveR(exchange.recvCount, neighbourRank);
+        net.RequestReceive(Payload(&exchange.recvBuffer[0]), ExchangeCapacity, neighbourRank);
+      }
+      net.Dispatch();
+
+      // only the neighbours with more to exchange than fits need a second round
+      bool overflowed = false;
+      for (typename std::map<proc_t, PackedExchange<T> >::iterator iter = exchanges.begin();
+          iter != exchanges.end(); iter++)
+      {
+        const proc_t& neighbourRank = iter->first;
+        PackedExchange<T>& exchange = iter->second;
+        if (exchange.sendCount > ExchangeCapacity)
+        {
+          net.RequestSend(Payload(&exchange.sendBuffer[ExchangeCapacity]),
+                          exchange.sendCount - ExchangeCapacity, neighbourRank);
+          overflowed = true;
+        }
+        if (exchange.recvCount > ExchangeCapacity)
+        {
+          exchange.recvBuffer.resize(exchange.recvCount);
+          net.RequestReceive(Payload(&exchange.recvBuffer[ExchangeCapacity]),
+                             exchange.recvCount - ExchangeCapacity, neighbourRank);
+          overflowed = true;
+        }
+      }
+      if (overflowed)
+      {
+        HEMELB_LOG(Debug, OnePerCore,
+          "In colloids::ParticleSet::ExchangeWithNeighbours, exchange overflowed its capacity of %i\n",
+          ExchangeCapacity);
+        net.Dispatch();
+      }
+    }
+
     const void ParticleSet::CommunicateParticlePositions()
     {
       /** CommunicateParticlePositions
        *    For each neighbour rank p
-       *    - MPI_Irecv( number_of_remote_particles )
-       *    - MPI_Irecv( list_of_remote_particles )
-       *    - MPI_Isend( number_of_local_particles )
-       *    - MPI_Isend list_of_local_particles )
+       *    - pack the local particles with fluid sites of p in their stencils
+       *    - MPI_Irecv( number_of_remote_particles, fixed_size_buffer_of_remote_particles )
+       *    - MPI_Isend( number_of_local_particles, fixed_size_buffer_of_local_particles )
        *    MPI_Waitall()
+       *    and a second round, only for the particles that did not fit into the buffers
        *
        *  The global position of each particle is updated by the ownerRank process.
        *  The ownerRank for each particle is verified when its position is updated.
@@ -280,43 +420,38 @@ namespace hemelb
        *  
        */
 
-      unsigned int& numberOfParticlesToSend = scanMap[localRank].first;
+      const unsigned int numberOfLocalParticles = scanMap[localRank].first;
       if (scanMap.size() < 2)
       {
+        UpdateCellList();
         return;
       }
 
-      for (scanMapIterType iterMap = scanMap.begin(); iterMap != scanMap.end(); iterMap++)
+      // only the neighbours that own sites in a particle's stencil need to know about it
+      for (std::map<proc_t, PackedExchange<Particle> >::iterator iter = positionExchanges.begin();
+          iter != positionExchanges.end(); iter++)
+        iter->second.sendBuffer.clear();
+      for (unsigned int particleIndex = 0; particleIndex < numberOfLocalParticles; particleIndex++)
       {
-        const proc_t& neighbourRank = iterMap->first;
-        if (neighbourRank != localRank)
+        const Particle& particle = particles[particleIndex];
+        const std::vector<proc_t>& stencilRanks = particle.GetStencilRanks(latDatLBM);
+        for (std::vector<proc_t>::const_iterator rank = stencilRanks.begin(); rank != stencilRanks.end(); rank++)
         {
-          unsigned int& numberOfParticlesToRecv = iterMap->second.first;
-          net.RequestSendR(numberOfParticlesToSend, neighbourRank);
-          net.RequestReceiveR(numberOfParticlesToRecv, neighbourRank);
+          std::map<proc_t, PackedExchange<Particle> >::iterator exchange = positionExchanges.find(*rank);
+          if (exchange != positionExchanges.end())
+            exchange->second.sendBuffer.push_back(particle);
         }
       }
-      net.Dispatch();
 
-      unsigned int numberOfParticles = 0;
-      for (scanMapConstIterType iterMap = scanMap.begin(); iterMap != scanMap.end(); iterMap++)
-        numberOfParticles += iterMap->second.first;
-      particles.resize(numberOfParticles);
+      ExchangeWithNeighbours(positionExchanges);
 
-      std::vector<Particle>::iterator iterSendBegin = particles.begin();
-      std::vector<Particle>::iterator iterRecvBegin = particles.begin() + numberOfParticlesToSend;
-      for (scanMapConstIterType iterMap = scanMap.begin(); iterMap != scanMap.end(); iterMap++)
-      {
-        const proc_t& neighbourRank = iterMap->first;
-        if (neighbourRank != localRank)
-        {
-          const unsigned int& numberOfParticlesToRecv = iterMap->second.first;
-          net.RequestSend(& ((PersistedParticle&) *iterSendBegin), numberOfParticlesToSend, neighbourRank);
-          net.RequestReceive(& ((PersistedParticle&) * (iterRecvBegin)), numberOfParticlesToRecv, neighbourRank);
-          iterRecvBegin += numberOfParticlesToRecv;
-        }
-      }
-      net.Dispatch();
+      // keep the particles that were local, then add those received from each neighbour
+      particles.resize(numberOfLocalParticles);
+      for (std::map<proc_t, PackedExchange<Particle> >::const_iterator iter = positionExchanges.begin();
+          iter != positionExchanges.end(); iter++)
+        particles.insert(particles.end(),
+                         iter->second.recvBuffer.begin(),
+                         iter->second.recvBuffer.begin() + iter->second.recvCount);
 
       // remove particles owned by unknown ranks
       std::vector<Particle>::iterator newEndOfParticles =
@@ -334,17 +469,51 @@ namespace hemelb
       for (std::vector<Particle>::const_iterator iterParticles = particles.begin(); iterParticles != particles.end();
           iterParticles++)
         scanMap[iterParticles->GetOwnerRank()].first++;
+
+      UpdateCellList();
+    }
+
+    const void ParticleSet::CountLocalParticlesPerBlock(std::vector<site_t>& particlesPerBlock) const
+    {
+      for (unsigned int particleIndex = 0; particleIndex < scanMap.find(localRank)->second.first;
+          particleIndex++)
+      {
+        const LatticePosition& position = particles[particleIndex].GetGlobalPosition();
+        util::Vector3D<site_t> blockCoords, siteCoords;
+        latDatLBM.GetBlockAndLocalSiteCoords(util::Vector3D<site_t>((site_t)(0.5+position.x),
+                                                                    (site_t)(0.5+position.y),
+                                                                    (site_t)(0.5+position.z)),
+                                             blockCoords,
+                                             siteCoords);
+        if (latDatLBM.IsValidBlock(blockCoords))
+          particlesPerBlock[latDatLBM.GetBlockIdFromBlockCoords(blockCoords)]++;
+      }
+    }
+
+    const void ParticleSet::UpdateCellList()
+    {
+      // bring the spatial index up-to-date with the particles now known - those that moved
+      // or arrived are re-bucketed, and those that left or were deleted are dropped
+      unsigned int numberOfParticles = 0;
+      for (scanMapConstIterType iterMap = scanMap.begin(); iterMap != scanMap.end(); iterMap++)
+        numberOfParticles += iterMap->second.first;
+
+      cellList.BeginSweep();
+      for (std::vector<Particle>::const_iterator iterParticles = particles.begin();
+          iterParticles != particles.begin() + numberOfParticles; iterParticles++)
+        cellList.Update(iterParticles->GetParticleId(), iterParticles->GetGlobalPosition());
+      cellList.RemoveStale();
     }
 
     const void ParticleSet::CommunicateFluidVelocities()
     {
       /** CommunicateFluidVelocities
        *    For each neighbour rank p
-       *    - MPI_Irecv( number_of_incoming_velocities )
-       *    - MPI_Irecv( list_of_incoming_velocities )
-       *    - MPI_Isend( number_of_outgoing_velocities )
-       *    - MPI_Isend( list_of_outgoing_velocities )
+       *    - pack the partial velocities of the known particles owned by p
+       *    - MPI_Irecv( number_of_incoming_velocities, fixed_size_buffer_of_incoming_velocities )
+       *    - MPI_Isend( number_of_outgoing_velocities, fixed_size_buffer_of_outgoing_velocities )
        *    MPI_Waitall()
+       *    and a second round, only for the velocities that did not fit into the buffers
        */
 
       if (scanMap.size() < 2)
@@ -352,51 +521,34 @@ namespace hemelb
         return;
       }
 
-      // exchange counts
-      for (scanMapIterType iterMap = scanMap.begin(); iterMap != scanMap.end(); iterMap++)
+      // the particles are sorted by owner, so those owned by each neighbour follow on
+      for (std::map<proc_t, PackedExchange<VelocityContribution> >::iterator iter = velocityExchanges.begin();
+          iter != velocityExchanges.end(); iter++)
+        iter->second.sendBuffer.clear();
+      for (std::vector<Particle>::const_iterator iter = particles.begin() + scanMap[localRank].first;
+          iter != particles.end(); iter++)
       {
-        const proc_t& neighbourRank = iterMap->first;
-        if (neighbourRank != localRank)
-        {
-          unsigned int& numberOfVelocitiesToSend = iterMap->second.first;
-          unsigned int& numberOfVelocitiesToRecv = iterMap->second.second;
-          net.RequestSendR(numberOfVelocitiesToSend, neighbourRank);
-          net.RequestReceiveR(numberOfVelocitiesToRecv, neighbourRank);
-        }
+        std::map<proc_t, PackedExchange<VelocityContribution> >::iterator exchange =
+            velocityExchanges.find(iter->GetOwnerRank());
+        if (exchange != velocityExchanges.end())
+          exchange->second.sendBuffer.push_back(VelocityContribution(iter->GetParticleId(),
+                                                                     iter->GetPartialVelocity()));
       }
-      net.Dispatch();
 
-      // sum counts
-      unsigned int numberOfIncomingVelocities = 0;
-      for (scanMapConstIterType iterMap = scanMap.begin(); iterMap != scanMap.end(); iterMap++)
-        numberOfIncomingVelocities += iterMap->second.second;
-      velocityBuffer.resize(numberOfIncomingVelocities);
-
-      // exchange velocities
-      std::vector<Particle>::iterator iterSendBegin = particles.begin();
-      std::vector<std::pair<unsigned long, util::Vector3D<double> > >::iterator iterRecvBegin = velocityBuffer.begin();
-      for (scanMapConstIterType iterMap = scanMap.begin(); iterMap != scanMap.end(); iterMap++)
-      {
-        const proc_t& neighbourRank = iterMap->first;
-        if (neighbourRank != localRank)
-        {
-          const unsigned int& numberOfVelocitiesToSend = iterMap->second.first;
-          const unsigned int& numberOfVelocitiesToRecv = iterMap->second.second;
-          net.RequestSend(& ((Particle&) *iterSendBegin), numberOfVelocitiesToSend, neighbourRank);
-          net.RequestReceive(& (* (iterRecvBegin)), numberOfVelocitiesToRecv, neighbourRank);
-          iterRecvBegin += numberOfVelocitiesToRecv;
-        }
-      }
-      net.Dispatch();
+      ExchangeWithNeighbours(velocityExchanges);
 
       // sum velocities
       velocityMap.clear();
-      for (std::vector<std::pair<unsigned long, util::Vector3D<double> > >::const_iterator iterVelocityBuffer =
-          velocityBuffer.begin(); iterVelocityBuffer != velocityBuffer.end(); iterVelocityBuffer++)
+      for (std::map<proc_t, PackedExchange<VelocityContribution> >::const_iterator iter = velocityExchanges.begin();
+          iter != velocityExchanges.end(); iter++)
       {
-        const unsigned long& particleId = iterVelocityBuffer->first;
-        const util::Vector3D<double>& partialVelocity = iterVelocityBuffer->second;
-        velocityMap[particleId] += partialVelocity;
+        scanMap[iter->first].second = iter->second.recvCount;
+        for (unsigned int contribution = 0; contribution < iter->second.recvCount; contribution++)
+        {
+          const unsigned long& particleId = iter->second.recvBuffer[contribution].first;
+          const util::Vector3D<double>& partialVelocity = iter->second.recvBuffer[contribution].second;
+          velocityMap[particleId] += partialVelocity;
+        }
       }
 
       // update local particles
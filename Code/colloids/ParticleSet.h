@@ -13,6 +13,7 @@
 #include "lb/MacroscopicPropertyCache.h"
 #include "net/mpi.h"
 #include "colloids/Particle.h"
+#include "colloids/CellList.h"
 #include "net/IOCommunicator.h"
 #include "units.h"
 
@@ -24,6 +25,9 @@ namespace hemelb
     class ParticleSet
     {
       public:
+        /** a particle's id and the part of its fluid velocity interpolated by one process */
+        typedef std::pair<unsigned long, util::Vector3D<double> > VelocityContribution;
+
         /** constructor - gets local particle information from xml config file */
         ParticleSet(const geometry::LatticeData& latDatLBM,
                     io::xml::Element& xml,
@@ -33,6 +37,20 @@ namespace hemelb
                     const net::IOCommunicator& ioComms_,
                     const std::string& outputPath);
 
+        /**
+         * constructor - takes over the particles of the set made for a previous decomposition
+         * and its output file; collective, as particles move to the process that now owns them
+         * @param previous the set on the previous lattice, which must still be intact
+         * @param procForEachPreviousSite the new owner of each of the previous local sites
+         */
+        ParticleSet(const geometry::LatticeData& latDatLBM,
+                    lb::MacroscopicPropertyCache& propertyCache,
+                    const hemelb::lb::LbmParameters *lbmParams,
+                    std::vector<proc_t>& neighbourProcessors,
+                    const net::IOCommunicator& ioComms_,
+                    ParticleSet& previous,
+                    const std::vector<proc_t>& procForEachPreviousSite);
+
         /** destructor - de-allocates all Particle objects created by this Set */
         ~ParticleSet();
 
@@ -58,9 +76,33 @@ namespace hemelb
         /** communicates the partial fluid interpolations to&from all neighbours */
         const void CommunicateFluidVelocities();
 
+        /**
+         * writes a block of the particles owned by each process to the output file
+         * collective - each process writes its own records at an offset found by an exclusive scan
+         */
         const void OutputInformation(const LatticeTimeStep timestep);
 
+        /** waits for the output write in progress, if there is one */
+        const void FinishWriting();
+
+        /** spatial index of all particles known to this process, for finding neighbours */
+        const CellList& GetCellList() const
+        {
+          return cellList;
+        }
+
+        /** adds the number of locally owned particles in each lattice block to particlesPerBlock,
+         *  which is indexed by block id
+         */
+        const void CountLocalParticlesPerBlock(std::vector<site_t>& particlesPerBlock) const;
+
       private:
+        /** adds an entry with zero counts to the scanMap for each neighbour and the local rank */
+        const void InitialiseScanMap(std::vector<proc_t>& neighbourProcessors);
+
+        /** re-synchronises the spatial index with the particles known to this process */
+        const void UpdateCellList();
+
         const net::IOCommunicator& ioComms;
         /** cached copy of local rank (obtained from topology) */
         const proc_t localRank;
@@ -71,6 +113,12 @@ namespace hemelb
          */
         std::vector<Particle> particles;
 
+        /**
+         * buckets all particles known to this process by the lattice block they are in
+         * updated as local particles move and as particles arrive from or leave for neighbours
+         */
+        CellList cellList;
+
         /** map neighbourRank -> {numberOfParticlesFromThere, numberOfVelocitiesFromThere} */
         typedef std::pair<unsigned int, unsigned int> scanMapElementType;
         std::map<proc_t, scanMapElementType> scanMap;
@@ -78,8 +126,33 @@ namespace hemelb
         typedef std::map<proc_t, scanMapElementType>::iterator scanMapIterType;
         typedef std::pair<proc_t, scanMapElementType> scanMapContentType;
         
-        /** contiguous buffer into which MPI can write all the velocities from neighbours */
-        std::vector<std::pair<unsigned long, util::Vector3D<double> > > velocityBuffer;
+        /**
+         * the number of particles, or velocities, in the buffer exchanged with each neighbour
+         * every step - any more than this are sent in a second round
+         */
+        static const unsigned int ExchangeCapacity = 16;
+
+        /** the values exchanged with one neighbour */
+        template<typename T>
+        struct PackedExchange
+        {
+            unsigned int sendCount;
+            unsigned int recvCount;
+            std::vector<T> sendBuffer;
+            std::vector<T> recvBuffer;
+        };
+
+        /** sends each neighbour the values packed for it and receives theirs
+         *  in a single round, unless more than fits in a buffer is exchanged
+         */
+        template<typename T>
+        const void ExchangeWithNeighbours(std::map<proc_t, PackedExchange<T> >& exchanges);
+
+        /** map neighbourRank -> local particles with sites of that neighbour in their stencils */
+        std::map<proc_t, PackedExchange<Particle> > positionExchanges;
+
+        /** map neighbourRank -> partial velocities of the particles owned by that neighbour */
+        std::map<proc_t, PackedExchange<VelocityContribution> > velocityExchanges;
 
         /** map particleId -> sumOfvelocityContributionsFromNeighbours */
         std::map<unsigned long, util::Vector3D<double> > velocityMap;
@@ -100,6 +173,14 @@ namespace hemelb
          * Reusable output buffer.
          */
         std::vector<char> buffer;
+        /**
+         * Reusable buffer for the header of each output block, only used on the IO rank.
+         */
+        std::vector<char> headerBuffer;
+        /**
+         * Where in the file the next output block starts.
+         */
+        MPI_Offset nextBlockOffset;
         /**
          * Path to write to.
          */
@@ -108,6 +189,18 @@ namespace hemelb
          * MPI File handle to write with
          */
         net::MpiFile file;
+
+#ifdef HEMELB_USE_ASYNC_COLLOID_WRITES
+        /**
+         * The buffer being written from, if there is a write in progress.
+         */
+        std::vector<char> writingBuffer;
+
+        /**
+         * The write in progress, or MPI_REQUEST_NULL.
+         */
+        MPI_Request pendingWrite;
+#endif
     };
   }
 }
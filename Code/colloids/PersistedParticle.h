@@ -22,6 +22,9 @@ namespace hemelb
         /** constructor - gets initial values from xml configuration file */
         PersistedParticle(io::xml::Element& xml);
 
+        /** constructor - uses default values for each field, to be received into */
+        PersistedParticle() {};
+
       protected:
         /** constructor - uses explicitly supplied values */
         PersistedParticle(unsigned long particleId,
@@ -32,9 +35,6 @@ namespace hemelb
           mass(mass), globalPosition(globalPosition)
         {};
 
-        /** constructor - uses default values for each field */
-        PersistedParticle() {};
-
         /** system-wide-unique identifier for this particle */
         unsigned long   particleId;
 
@@ -5,17 +5,25 @@
 // license in the file LICENSE.
 
 #include "configuration/CommandLine.h"
+#include <cstdio>
 #include <cstring>
 #include <cstdlib>
+#include <string>
+#include "io/SubfileGroup.h"
 namespace hemelb
 {
   namespace configuration
   {
 
     CommandLine::CommandLine(int aargc, const char * const * const aargv) :
-      inputFile("input.xml"), outputDir(""), images(10), steeringSessionId(1), debugMode(false), argc(aargc),
-          argv(aargv)
+      inputFile("input.xml"), outputDir(""), images(10), steeringSessionId(1), decompositionToLoad(""),
+          decompositionToSave(""), decompositionCache(""), siteWeightsFile(""), rebalancePeriod(0),
+          rebalanceThreshold(1.2), checkpointPeriod(0),
+          checkpointEncoding(io::formats::checkpoint::DoubleEncoding), checkpointRanksPerFile(io::SubfileGroup::OneFile), restartFile(""), multiscaleLag(0), coupledModelLibrary(""), traceFirstStep(0), traceLastStep(0), captureStep(0), captureRank(-1), flightRecorderSamples(0), flightRecorderPeriod(1), flightRecorderFields(io::formats::flightrecorder::PressureField | io::formats::flightrecorder::VelocityField), nodeSharedGeometry(false), dryRun(false), ensembleFile(""), ensembleGroups(1), serverFile(""), commsStrategy(), autotuneComms(false), debugMode(false), argc(aargc), argv(aargv)
     {
+      // No region, as the minimum is beyond the maximum.
+      flightRecorderRegion.minimum = util::Vector3D<site_t>(0, 0, 0);
+      flightRecorderRegion.maximum = util::Vector3D<site_t>(-1, -1, -1);
 
       // There should be an odd number of arguments since the parameters occur in pairs.
       if ( (argc % 2) == 0)
@@ -47,6 +55,221 @@ namespace hemelb
           char *dummy;
           steeringSessionId = (unsigned int) (strtoul(paramValue, &dummy, 10));
         }
+        else if (std::strcmp(paramName, "-decomposition") == 0)
+        {
+          decompositionToLoad = std::string(paramValue);
+        }
+        else if (std::strcmp(paramName, "-save-decomposition") == 0)
+        {
+          decompositionToSave = std::string(paramValue);
+        }
+        else if (std::strcmp(paramName, "-decomposition-cache") == 0)
+        {
+          decompositionCache = std::string(paramValue);
+        }
+        else if (std::strcmp(paramName, "-site-weights") == 0)
+        {
+          siteWeightsFile = std::string(paramValue);
+        }
+        else if (std::strcmp(paramName, "-rebalance-period") == 0)
+        {
+          char *dummy;
+          rebalancePeriod = strtoul(paramValue, &dummy, 10);
+        }
+        else if (std::strcmp(paramName, "-rebalance-threshold") == 0)
+        {
+          char *dummy;
+          rebalanceThreshold = strtod(paramValue, &dummy);
+        }
+        else if (std::strcmp(paramName, "-checkpoint-period") == 0)
+        {
+          char *dummy;
+          checkpointPeriod = strtoul(paramValue, &dummy, 10);
+        }
+        else if (std::strcmp(paramName, "-checkpoint-precision") == 0)
+        {
+          if (std::strcmp(paramValue, "double") == 0)
+          {
+            checkpointEncoding = io::formats::checkpoint::DoubleEncoding;
+          }
+          else if (std::strcmp(paramValue, "single") == 0)
+          {
+            checkpointEncoding = io::formats::checkpoint::NonEquilibriumFloatEncoding;
+          }
+          else
+          {
+            throw OptionError() << "Unknown checkpoint precision: " << paramValue;
+          }
+        }
+        else if (std::strcmp(paramName, "-checkpoint-subfiles") == 0)
+        {
+          if (!io::SubfileGroup::ParseRanksPerFile(paramValue, checkpointRanksPerFile))
+          {
+            throw OptionError() << "Unknown checkpoint subfiles: " << paramValue;
+          }
+        }
+        else if (std::strcmp(paramName, "-restart") == 0)
+        {
+          restartFile = std::string(paramValue);
+        }
+        else if (std::strcmp(paramName, "-multiscale-lag") == 0)
+        {
+          char *dummy;
+          multiscaleLag = strtoul(paramValue, &dummy, 10);
+        }
+        else if (std::strcmp(paramName, "-coupled-model") == 0)
+        {
+          coupledModelLibrary = std::string(paramValue);
+        }
+        else if (std::strcmp(paramName, "-trace-steps") == 0)
+        {
+          char *separator;
+          traceFirstStep = strtoul(paramValue, &separator, 10);
+          if (*separator != ':')
+          {
+            throw OptionError() << "Trace steps should be given as first:last, not " << paramValue;
+          }
+          traceLastStep = strtoul(separator + 1, NULL, 10);
+        }
+        else if (std::strcmp(paramName, "-capture-step") == 0)
+        {
+          char *dummy;
+          captureStep = strtoul(paramValue, &dummy, 10);
+        }
+        else if (std::strcmp(paramName, "-capture-rank") == 0)
+        {
+          if (std::strcmp(paramValue, "slowest") == 0)
+          {
+            captureRank = -1;
+          }
+          else
+          {
+            char *end;
+            captureRank = (int) strtol(paramValue, &end, 10);
+            if (*end != '\0' || captureRank < 0)
+            {
+              throw OptionError() << "The rank to capture should be a rank or slowest, not " << paramValue;
+            }
+          }
+        }
+        else if (std::strcmp(paramName, "-flight-recorder") == 0)
+        {
+          char *dummy;
+          flightRecorderSamples = (unsigned) strtoul(paramValue, &dummy, 10);
+        }
+        else if (std::strcmp(paramName, "-flight-recorder-period") == 0)
+        {
+          char *dummy;
+          flightRecorderPeriod = strtoul(paramValue, &dummy, 10);
+          if (flightRecorderPeriod < 1)
+          {
+            throw OptionError() << "The flight recorder period should be at least 1, not " << paramValue;
+          }
+        }
+        else if (std::strcmp(paramName, "-flight-recorder-fields") == 0)
+        {
+          const std::string fields(paramValue);
+          flightRecorderFields = 0;
+          size_t start = 0;
+          while (start <= fields.size())
+          {
+            size_t end = fields.find(',', start);
+            if (end == std::string::npos)
+            {
+              end = fields.size();
+            }
+            const std::string field = fields.substr(start, end - start);
+            if (field == "pressure")
+            {
+              flightRecorderFields |= io::formats::flightrecorder::PressureField;
+            }
+            else if (field == "velocity")
+            {
+              flightRecorderFields |= io::formats::flightrecorder::VelocityField;
+            }
+            else
+            {
+              throw OptionError() << "Unknown flight recorder field: " << field;
+            }
+            start = end + 1;
+          }
+        }
+        else if (std::strcmp(paramName, "-flight-recorder-region") == 0)
+        {
+          long corners[6];
+          char separator;
+          if (std::sscanf(paramValue,
+                          "%ld,%ld,%ld%c%ld,%ld,%ld",
+                          &corners[0],
+                          &corners[1],
+                          &corners[2],
+                          &separator,
+                          &corners[3],
+                          &corners[4],
+                          &corners[5]) != 7 || separator != ':')
+          {
+            throw OptionError() << "The flight recorder region should be given as x,y,z:x,y,z, not " << paramValue;
+          }
+          flightRecorderRegion.minimum = util::Vector3D<site_t>(corners[0], corners[1], corners[2]);
+          flightRecorderRegion.maximum = util::Vector3D<site_t>(corners[3], corners[4], corners[5]);
+        }
+        else if (std::strcmp(paramName, "-node-shared-geometry") == 0)
+        {
+          nodeSharedGeometry = std::strcmp(paramValue, "0") != 0;
+        }
+        else if (std::strcmp(paramName, "-dry-run") == 0)
+        {
+          dryRun = std::strcmp(paramValue, "0") != 0;
+        }
+        else if (std::strcmp(paramName, "-ensemble") == 0)
+        {
+          ensembleFile = std::string(paramValue);
+        }
+        else if (std::strcmp(paramName, "-ensemble-groups") == 0)
+        {
+          char *dummy;
+          ensembleGroups = (unsigned int) (strtoul(paramValue, &dummy, 10));
+          if (ensembleGroups < 1)
+          {
+            throw OptionError() << "There should be at least one ensemble group, not " << paramValue;
+          }
+        }
+        else if (std::strcmp(paramName, "-server") == 0)
+        {
+          serverFile = std::string(paramValue);
+        }
+        else if (std::strncmp(paramName, "-comms-", 7) == 0 && !net::CommsStrategy::IsSelectable())
+        {
+          throw OptionError() << "The comms implementations were fixed when HemeLB was configured, so "
+              << paramName << " can't be given";
+        }
+        else if (std::strcmp(paramName, "-comms-pointpoint") == 0)
+        {
+          autotuneComms = std::strcmp(paramValue, "auto") == 0;
+          if (!autotuneComms
+              && !net::CommsStrategy::ParsePointPoint(paramValue, commsStrategy.pointPoint))
+          {
+            throw OptionError() << "Unknown point to point comms: " << paramValue;
+          }
+        }
+        else if (std::strcmp(paramName, "-comms-gathers") == 0)
+        {
+          if (!net::CommsStrategy::ParseCollective(paramValue, commsStrategy.gathers))
+          {
+            throw OptionError() << "Unknown gathers comms: " << paramValue;
+          }
+        }
+        else if (std::strcmp(paramName, "-comms-alltoall") == 0)
+        {
+          if (!net::CommsStrategy::ParseCollective(paramValue, commsStrategy.allToAll))
+          {
+            throw OptionError() << "Unknown all-to-all comms: " << paramValue;
+          }
+        }
+        else if (std::strcmp(paramName, "-comms-separate-concerns") == 0)
+        {
+          commsStrategy.separateConcerns = std::strcmp(paramValue, "0") != 0;
+        }
         else if (std::strcmp(paramName, "-debug") == 0)
         {
           debugMode = std::strcmp(paramName, "0") == 0 ? false : true;
@@ -66,7 +289,50 @@ namespace hemelb
       ans.append("-out \t Path to the output folder (default is based on input file, e.g. config_xml_results)\n");
       ans.append("-i \t Number of images to create (default is 10)\n");
       ans.append("-ss \t Steering session identifier (default is 1)\n");
+      ans.append("-decomposition \t Path to a decomposition saved by an earlier run on as many cores, to use instead of decomposing the geometry\n");
+      ans.append("-save-decomposition \t Path to save the decomposition to, for later runs\n");
+      ans.append("-decomposition-cache \t Directory to keep the decomposition of each geometry and core count in, to reuse it in later runs\n");
+      ans.append("-site-weights \t File of site weights to balance the decomposition with, recalibrated from the timings of each run\n");
+      ans.append("-rebalance-period \t Number of time steps between checks of the load balance (default is 0, never)\n");
+      ans.append("-rebalance-threshold \t Ratio of the slowest core's LB time to the mean above which to rebalance (default is 1.2)\n");
+      ans.append("-checkpoint-period \t Number of time steps between checkpoints of the LB state, saved as Checkpoint.dat in the output folder (default is 0, never)\n");
+      ans.append("-checkpoint-precision \t double, or single to save checkpoints about half the size by storing the non-equilibrium part of each distribution as a float (default is double)\n");
+      ans.append("-checkpoint-subfiles \t node, or a number of ranks, to write each node's or group's part of checkpoints to a file of its own, with Checkpoint.dat an index of them (default is one file)\n");
+      ans.append("-restart \t Path to a checkpoint to restart the simulation from, on any number of cores\n");
+      ans.append("-multiscale-lag \t Number of time steps a multiscale run may take with the previous boundary values while an exchange with the other model is in flight (default is 0, wait for every exchange)\n");
+      ans.append("-coupled-model \t Path to a shared library with a model for a multiscale run to couple to in the same process, instead of over MPWide (default is none)\n");
+      ans.append("-trace-steps \t Time steps to trace each step and concern of, given as first:last, written to Trace.json in the output folder in the Chrome trace format (default is none)\n");
+      ans.append("-capture-step \t Time step at the end of which to capture one rank's subdomain to Capture.dat in the output folder, for hemelb_replay to run its collide-and-stream loop again on one core (default is 0, never)\n");
+      ans.append("-capture-rank \t The rank to capture, or slowest for the one that has spent longest on the LB so far (default is slowest)\n");
+      ans.append("-flight-recorder \t Number of the latest samples of the fields to keep in memory on each rank, written to FlightRecorder_<time step>.dat in the output folder when the simulation goes unstable or the steering client asks (default is 0, none)\n");
+      ans.append("-flight-recorder-period \t Number of time steps between the flight recorder's samples (default is 1)\n");
+      ans.append("-flight-recorder-fields \t pressure, velocity or pressure,velocity, the fields the flight recorder keeps at every site (default is pressure,velocity)\n");
+      ans.append("-flight-recorder-region \t Lattice coordinates x,y,z:x,y,z of the corners of a box of sites the flight recorder also keeps the distributions of (default is none)\n");
+      ans.append("-node-shared-geometry \t 1 to read the geometry file on one core per node into memory all the node's cores share and parse it from there, rather than reading the blocks on a group of cores and sending them on (default is 0)\n");
+      ans.append("-dry-run \t 1 to read and decompose the geometry, report the predicted memory, load balance and step time of each core and stop without simulating (default is 0)\n");
+      ans.append("-ensemble \t File listing the input xml files, one per line, of simulations of the same geometry to run in this job, each writing to its own output folder; each simulation still reads the geometry file itself (default is none)\n");
+      ans.append("-ensemble-groups \t Number of equal groups of cores to run the ensemble's simulations on at the same time, sharing one decomposition (default is 1)\n");
+      ans.append("-server \t File listing the input xml files, one per line, of simulations of the same geometry to stay resident for once the first has run, restarting on the lattice already built with whichever the steering client asks for (default is none)\n");
+      ans.append("-comms-pointpoint \t Coalesce, Separated, Immediate or Persistent point to point comms, or auto to time the Coalesce, Separated and Persistent ones on the halo exchange at the start and use the fastest (default is as configured)\n");
+      ans.append("-comms-gathers \t Separated or ViaPointPoint gathers (default is as configured)\n");
+      ans.append("-comms-alltoall \t Separated or ViaPointPoint all-to-alls (default is as configured)\n");
+      ans.append("-comms-separate-concerns \t 1 for each concern of a phase of the step manager to send, receive and wait for its comms on its own, 0 for them to share (default is as configured)\n");
       return ans;
     }
+
+    CommandLine CommandLine::ForEnsembleMember(const std::string& memberInputFile,
+                                               const std::string& memberOutputDir,
+                                               const std::string& memberDecompositionToLoad,
+                                               const std::string& memberDecompositionToSave) const
+    {
+      CommandLine member(*this);
+      member.inputFile = memberInputFile;
+      member.outputDir = memberOutputDir;
+      member.decompositionToLoad = memberDecompositionToLoad;
+      member.decompositionToSave = memberDecompositionToSave;
+      member.ensembleFile = "";
+      member.serverFile = "";
+      return member;
+    }
   }
 }
@@ -10,7 +10,11 @@
 #include <string>
 
 #include "Exception.h"
+#include "geometry/SiteBox.h"
+#include "io/formats/checkpoint.h"
+#include "io/formats/flightrecorder.h"
 #include "log/Logger.h"
+#include "net/CommsStrategy.h"
 
 namespace hemelb
 {
@@ -23,6 +27,30 @@ namespace hemelb
      * - -out output folder (empty default, but the hemelb::io::PathManager will guess a value from the input file if not given.)
      * - -i number of images (default 10)
      * - -ss steering session i.d. (default 1)
+     * - -decomposition decomposition file to load instead of decomposing the geometry (none by default)
+     * - -save-decomposition file to save the decomposition to, for later runs (none by default)
+     * - -decomposition-cache directory of decompositions keyed by geometry and core count (none by default)
+     * - -site-weights file of site weights calibrated by an earlier run, updated by this one (none by default)
+     * - -rebalance-period number of time steps between checks of the load balance (0, never, by default)
+     * - -rebalance-threshold ratio of the slowest core's time to the mean above which to rebalance (default 1.2)
+     * - -checkpoint-period number of time steps between checkpoints of the LB state (0, never, by default)
+     * - -checkpoint-precision double, or single to save the non-equilibrium part of each distribution as a float (default double)
+     * - -checkpoint-subfiles node, or a number of ranks, to write checkpoints in a part per node or group of ranks (one file by default)
+     * - -restart checkpoint to restart the simulation from (none by default)
+     * - -trace-steps first:last time steps to trace the phased steps of, written as Trace.json (none by default)
+     * - -flight-recorder number of the latest samples of the fields to keep in memory, written when the simulation goes unstable (0, none, by default)
+     * - -flight-recorder-period number of time steps between the flight recorder's samples (default 1)
+     * - -flight-recorder-fields pressure, velocity or pressure,velocity for the fields the flight recorder keeps at every site (default pressure,velocity)
+     * - -flight-recorder-region x,y,z:x,y,z lattice coordinates of the corners of a box the flight recorder also keeps the distributions of (none by default)
+     * - -node-shared-geometry 1 to read the geometry file once per node into memory shared by the node's cores (0 by default)
+     * - -dry-run 1 to only decompose the geometry and predict the memory and step time, without simulating (0 by default)
+     * - -ensemble file listing the input xml files of an ensemble of simulations of one geometry (none by default); each still reads the geometry file itself
+     * - -ensemble-groups number of groups of cores to run the ensemble's simulations on at once (default 1)
+     * - -server file listing input xml files of the same geometry to restart with when the steering client asks (none by default)
+     * - -comms-pointpoint Coalesce, Separated, Immediate or Persistent point to point comms, or auto to time them on the halo exchange and use the fastest (as configured by default)
+     * - -comms-gathers Separated or ViaPointPoint gathers (as configured by default)
+     * - -comms-alltoall Separated or ViaPointPoint all-to-alls (as configured by default)
+     * - -comms-separate-concerns 1 for a Send, Receive and Wait for each concern of the step manager, 0 to share them (as configured by default)
      */
     class CommandLine
     {
@@ -69,6 +97,249 @@ namespace hemelb
           return (steeringSessionId);
         }
 
+        /**
+         * @return The path of a decomposition to load instead of decomposing the geometry, or
+         * empty if none was given.
+         */
+        std::string const & GetDecompositionToLoad() const
+        {
+          return (decompositionToLoad);
+        }
+
+        /**
+         * @return The path to save the decomposition to, or empty if none was given.
+         */
+        std::string const & GetDecompositionToSave() const
+        {
+          return (decompositionToSave);
+        }
+
+        /**
+         * @return The directory to cache decompositions in, or empty if none was given.
+         */
+        std::string const & GetDecompositionCache() const
+        {
+          return (decompositionCache);
+        }
+
+        /**
+         * @return The file of calibrated site weights to decompose with and update, or empty if
+         * none was given.
+         */
+        std::string const & GetSiteWeightsFile() const
+        {
+          return (siteWeightsFile);
+        }
+
+        /**
+         * @return The number of time steps between checks of the load balance, or 0 to never
+         * rebalance.
+         */
+        unsigned long GetRebalancePeriod() const
+        {
+          return (rebalancePeriod);
+        }
+
+        /**
+         * @return The ratio of the slowest core's LB time to the mean above which the domain is
+         * rebalanced.
+         */
+        double GetRebalanceThreshold() const
+        {
+          return (rebalanceThreshold);
+        }
+
+        /**
+         * @return The number of time steps between checkpoints, or 0 to never checkpoint.
+         */
+        unsigned long GetCheckpointPeriod() const
+        {
+          return (checkpointPeriod);
+        }
+
+        /**
+         * @return How to encode the distributions in checkpoints.
+         */
+        io::formats::checkpoint::Encoding GetCheckpointEncoding() const
+        {
+          return (checkpointEncoding);
+        }
+
+        /**
+         * @return How many ranks write each part of a checkpoint, or SubfileGroup::OneFile or
+         * SubfileGroup::PerNode.
+         */
+        int GetCheckpointRanksPerFile() const
+        {
+          return (checkpointRanksPerFile);
+        }
+
+        /**
+         * @return The path of a checkpoint to restart from, or empty if none was given.
+         */
+        std::string const & GetRestartFile() const
+        {
+          return (restartFile);
+        }
+
+        /**
+         * @return The number of time steps a multiscale run may take before applying the result
+         * of an exchange with the other model, or 0 to wait for every exchange.
+         */
+        unsigned long GetMultiscaleLag() const
+        {
+          return (multiscaleLag);
+        }
+
+        /**
+         * @return The path of a shared library with a model to couple a multiscale run to in the
+         * same process, or empty to couple over MPWide.
+         */
+        std::string const & GetCoupledModelLibrary() const
+        {
+          return (coupledModelLibrary);
+        }
+
+        /**
+         * @return The first time step to trace the steps and concerns of, or 0 if none.
+         */
+        unsigned long GetTraceFirstStep() const
+        {
+          return (traceFirstStep);
+        }
+
+        /**
+         * @return The last time step to trace the steps and concerns of, or 0 if none.
+         */
+        unsigned long GetTraceLastStep() const
+        {
+          return (traceLastStep);
+        }
+
+        /**
+         * @return The time step at the end of which to capture a rank's subdomain, or 0 if none.
+         */
+        unsigned long GetCaptureStep() const
+        {
+          return (captureStep);
+        }
+
+        /**
+         * @return The rank to capture the subdomain of, or -1 for the slowest.
+         */
+        int GetCaptureRank() const
+        {
+          return (captureRank);
+        }
+
+        /**
+         * @return The number of samples the flight recorder keeps, or 0 for no flight recorder.
+         */
+        unsigned GetFlightRecorderSamples() const
+        {
+          return (flightRecorderSamples);
+        }
+
+        /**
+         * @return The number of time steps between the flight recorder's samples.
+         */
+        unsigned long GetFlightRecorderPeriod() const
+        {
+          return (flightRecorderPeriod);
+        }
+
+        /**
+         * @return The io::formats::flightrecorder::Field bits of the fields the flight recorder
+         * keeps at every site.
+         */
+        unsigned GetFlightRecorderFields() const
+        {
+          return (flightRecorderFields);
+        }
+
+        /**
+         * @return The box of sites the flight recorder keeps the distributions of, empty if none.
+         */
+        const geometry::SiteBox& GetFlightRecorderRegion() const
+        {
+          return (flightRecorderRegion);
+        }
+
+        /**
+         * @return Whether to read the geometry file once per node into shared memory.
+         */
+        bool GetNodeSharedGeometry() const
+        {
+          return nodeSharedGeometry;
+        }
+
+        /**
+         * @return Whether to stop after decomposing the geometry and predicting the memory and
+         * time of the run, without simulating.
+         */
+        bool GetDryRun() const
+        {
+          return dryRun;
+        }
+
+        /**
+         * @return The file listing the input files of an ensemble to run, or empty to run just
+         * the one simulation.
+         */
+        std::string const & GetEnsembleFile() const
+        {
+          return (ensembleFile);
+        }
+
+        /**
+         * @return The number of groups of cores to split the ensemble's simulations between.
+         */
+        unsigned GetEnsembleGroups() const
+        {
+          return (ensembleGroups);
+        }
+
+        /**
+         * @return The file listing the input files a simulation server may be asked to restart
+         * with, or empty to run the one simulation and stop.
+         */
+        std::string const & GetServerFile() const
+        {
+          return (serverFile);
+        }
+
+        /**
+         * @return The comms implementations to use, those HemeLB was configured with unless
+         * chosen.
+         */
+        const net::CommsStrategy& GetCommsStrategy() const
+        {
+          return commsStrategy;
+        }
+
+        /**
+         * @return Whether to time the point-to-point comms implementations on the halo exchange
+         * and use the fastest, rather than the one in the comms strategy.
+         */
+        bool GetAutotuneComms() const
+        {
+          return autotuneComms;
+        }
+
+        /**
+         * The options for one simulation of an ensemble, the same as these except for the input
+         * and output and decomposition files.
+         * @param memberInputFile
+         * @param memberOutputDir
+         * @param memberDecompositionToLoad
+         * @param memberDecompositionToSave
+         * @return
+         */
+        CommandLine ForEnsembleMember(const std::string& memberInputFile,
+                                      const std::string& memberOutputDir,
+                                      const std::string& memberDecompositionToLoad,
+                                      const std::string& memberDecompositionToSave) const;
+
         /**
          * @return Whether the user requested a debug mode.
          */
@@ -104,6 +375,33 @@ namespace hemelb
         std::string outputDir; //! local or full path to input file
         unsigned int images; //! images to produce
         int steeringSessionId; //! unique identifier for steering session
+        std::string decompositionToLoad; //! local or full path to a saved decomposition to use
+        std::string decompositionToSave; //! local or full path to save the decomposition to
+        std::string decompositionCache; //! local or full path to a directory of cached decompositions
+        std::string siteWeightsFile; //! local or full path to a file of calibrated site weights
+        unsigned long rebalancePeriod; //! time steps between checks of the load balance
+        double rebalanceThreshold; //! imbalance above which to rebalance
+        unsigned long checkpointPeriod; //! time steps between checkpoints
+        io::formats::checkpoint::Encoding checkpointEncoding; //! encoding of the distributions in checkpoints
+        int checkpointRanksPerFile; //! ranks writing each part of checkpoints
+        std::string restartFile; //! local or full path to a checkpoint to restart from
+        unsigned long multiscaleLag; //! time steps to run on while a multiscale exchange is in flight
+        std::string coupledModelLibrary; //! local or full path to a co-located coupled model library
+        unsigned long traceFirstStep; //! first time step to trace
+        unsigned long traceLastStep; //! last time step to trace
+        unsigned long captureStep; //! time step to capture a rank's subdomain at
+        int captureRank; //! rank to capture, or -1 for the slowest
+        unsigned flightRecorderSamples; //! samples the flight recorder keeps
+        unsigned long flightRecorderPeriod; //! time steps between the flight recorder's samples
+        unsigned flightRecorderFields; //! fields the flight recorder keeps at every site
+        geometry::SiteBox flightRecorderRegion; //! sites the flight recorder keeps the distributions of
+        bool nodeSharedGeometry; //! read the geometry once per node into shared memory
+        bool dryRun; //! only decompose and predict, without simulating
+        std::string ensembleFile; //! local or full path to a list of the input files of an ensemble
+        unsigned ensembleGroups; //! groups of cores to run the ensemble on
+        std::string serverFile; //! local or full path to a list of the input files to serve
+        net::CommsStrategy commsStrategy; //! comms implementations to use
+        bool autotuneComms; //! time the point-to-point comms implementations and use the fastest
         bool debugMode; //! Use debugger
         int argc; //! count of command line arguments, including program name
         const char * const * const argv; //! command line arguments
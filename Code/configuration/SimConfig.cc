@@ -12,6 +12,7 @@
 
 #include "configuration/SimConfig.h"
 #include "log/Logger.h"
+#include "net/MpiFile.h"
 #include "util/fileutils.h"
 
 namespace hemelb
@@ -25,9 +26,17 @@ namespace hemelb
       return ans;
     }
 
+    SimConfig* SimConfig::New(const std::string& path, const net::MpiCommunicator& comms)
+    {
+      SimConfig* ans = new SimConfig(path);
+      ans->Init(net::MpiFile::ReadOnOneRank(comms, path));
+      return ans;
+    }
+
     SimConfig::SimConfig(const std::string& path) :
-        xmlFilePath(path), rawXmlDoc(NULL), hasColloidSection(false), warmUpSteps(0),
-            unitConverter(NULL)
+        xmlFilePath(path), rawXmlDoc(NULL), probes(NULL), flowDiagnostics(NULL),
+            inSituPeriod(1),
+            hasColloidSection(false), warmStartTimestep(-1), warmUpSteps(0), unitConverter(NULL)
     {
     }
     void SimConfig::Init()
@@ -42,12 +51,22 @@ namespace hemelb
       dataFilePath = util::NormalizePathRelativeToPath(dataFilePath, xmlFilePath);
     }
 
+    void SimConfig::Init(const std::string& xmlText)
+    {
+      rawXmlDoc = io::xml::Document::FromText(xmlText);
+      colloidConfigPath = xmlFilePath;
+      DoIO(rawXmlDoc->GetRoot());
+      dataFilePath = util::NormalizePathRelativeToPath(dataFilePath, xmlFilePath);
+    }
+
     SimConfig::~SimConfig()
     {
       for (unsigned outputNumber = 0; outputNumber < propertyOutputs.size(); ++outputNumber)
       {
         delete propertyOutputs[outputNumber];
       }
+      delete probes;
+      delete flowDiagnostics;
 
       delete rawXmlDoc;
       rawXmlDoc = NULL;
@@ -80,6 +99,21 @@ namespace hemelb
 
       DoIOForInitialConditions(topNode.GetChildOrThrow("initialconditions"));
 
+      // Optional element <stabilised_regions>
+      const io::xml::Element regionsEl = topNode.GetChildOrNull("stabilised_regions");
+      if (regionsEl != io::xml::Element::Missing())
+        DoIOForRegions(regionsEl, stabilisedRegions);
+
+      // Optional element <compressed_regions>
+      const io::xml::Element compressedEl = topNode.GetChildOrNull("compressed_regions");
+      if (compressedEl != io::xml::Element::Missing())
+        DoIOForRegions(compressedEl, compressedRegions);
+
+      // Optional element <decomposition>
+      const io::xml::Element decompositionEl = topNode.GetChildOrNull("decomposition");
+      if (decompositionEl != io::xml::Element::Missing())
+        DoIOForDecomposition(decompositionEl);
+
       inlets = DoIOForInOutlets(topNode.GetChildOrThrow("inlets"));
       outlets = DoIOForInOutlets(topNode.GetChildOrThrow("outlets"));
 
@@ -305,17 +339,199 @@ namespace hemelb
       io::xml::Element rangeEl = visEl.GetChildOrThrow("range");
       GetDimensionalValue(rangeEl.GetChildOrThrow("maxvelocity"), "m/s", maxVelocity);
       GetDimensionalValue(rangeEl.GetChildOrThrow("maxstress"), "Pa", maxStress);
+
+      // Optional element
+      // <encoding images="raw|deflate" steering="raw|deflate" />
+      // saying how the pixels of images written to disk and streamed to the steering client
+      // are stored. Both default to raw.
+      imageEncoding = io::formats::image::RawEncoding;
+      networkImageEncoding = io::formats::image::RawEncoding;
+      const io::xml::Element encodingEl = visEl.GetChildOrNull("encoding");
+      if (encodingEl != io::xml::Element::Missing())
+      {
+        const char* const attributes[] = { "images", "steering" };
+        io::formats::image::Encoding* const encodings[] = { &imageEncoding, &networkImageEncoding };
+        for (unsigned attribute = 0; attribute < 2; ++attribute)
+        {
+          const std::string* value = encodingEl.GetAttributeOrNull(attributes[attribute]);
+          if (value == NULL || *value == "raw")
+          {
+            continue;
+          }
+          if (*value != "deflate")
+          {
+            throw Exception() << "Unrecognised image encoding '" << *value << "' in element "
+                << encodingEl.GetPath();
+          }
+          *encodings[attribute] = io::formats::image::DeflateEncoding;
+        }
+      }
+
+      // Optional element
+      // <progressive stride="unsigned" />
+      // to render the images after the view moves with one pixel for every stride x stride
+      // of the image at first, refining to full detail over the images that follow. Defaults
+      // to 1, every image in full detail.
+      progressiveStride = 1;
+      const io::xml::Element progressiveEl = visEl.GetChildOrNull("progressive");
+      if (progressiveEl != io::xml::Element::Missing())
+      {
+        progressiveEl.GetAttributeOrThrow("stride", progressiveStride);
+        if (progressiveStride < 1)
+        {
+          throw Exception() << "The progressive stride must be at least 1 in element "
+              << progressiveEl.GetPath();
+        }
+      }
+
+      // Optional, repeated element
+      // <view width="unsigned" height="unsigned" zoom="float" mode="isosurfaces|glyphs|streaklines">
+      //   <longitude value="float" units="deg" />
+      //   <latitude value="float" units="deg" />
+      // </view>
+      // for each further view of the images written to disk, rendered in the same pass as the
+      // steered view. The mode defaults to isosurfaces.
+      imageViews.clear();
+      for (io::xml::ChildIterator viewPtr = visEl.IterChildren("view"); !viewPtr.AtEnd(); ++viewPtr)
+      {
+        const io::xml::Element& viewEl = *viewPtr;
+        ImageView view;
+        viewEl.GetAttributeOrThrow("width", view.pixelsX);
+        viewEl.GetAttributeOrThrow("height", view.pixelsY);
+        viewEl.GetAttributeOrThrow("zoom", view.zoom);
+        if (view.pixelsX < 1 || view.pixelsY < 1 || view.zoom <= 0.F)
+        {
+          throw Exception() << "A view needs a positive size and zoom in element " << viewEl.GetPath();
+        }
+        GetDimensionalValue(viewEl.GetChildOrThrow("longitude"), "deg", view.longitude);
+        GetDimensionalValue(viewEl.GetChildOrThrow("latitude"), "deg", view.latitude);
+
+        view.mode = vis::VisSettings::ISOSURFACES;
+        const std::string* mode = viewEl.GetAttributeOrNull("mode");
+        if (mode != NULL && *mode != "isosurfaces")
+        {
+          if (*mode == "glyphs")
+          {
+            view.mode = vis::VisSettings::ISOSURFACESANDGLYPHS;
+          }
+          else if (*mode == "streaklines")
+          {
+            view.mode = vis::VisSettings::WALLANDSTREAKLINES;
+          }
+          else
+          {
+            throw Exception() << "Unrecognised view mode '" << *mode << "' in element "
+                << viewEl.GetPath();
+          }
+        }
+        imageViews.push_back(view);
+      }
     }
 
     void SimConfig::DoIOForProperties(const io::xml::Element& propertiesEl)
     {
+      // Optional MPI-IO hints for all the output files, e.g.
+      // <iohint name="striping_factor" value="32" />
+      std::map<std::string, std::string> ioHints;
+      for (io::xml::ChildIterator hintPtr = propertiesEl.IterChildren("iohint"); !hintPtr.AtEnd();
+          ++hintPtr)
+      {
+        ioHints[hintPtr->GetAttributeOrThrow("name")] = hintPtr->GetAttributeOrThrow("value");
+      }
+
       for (io::xml::ChildIterator poPtr = propertiesEl.IterChildren("propertyoutput");
           !poPtr.AtEnd(); ++poPtr)
       {
         propertyOutputs.push_back(DoIOForPropertyOutputFile(*poPtr));
+        propertyOutputs.back()->ioHints = ioHints;
+      }
+
+      const io::xml::Element probesEl = propertiesEl.GetChildOrNull("probes");
+      if (probesEl != io::xml::Element::Missing())
+      {
+        probes = DoIOForProbes(probesEl);
+      }
+
+      const io::xml::Element diagnosticsEl = propertiesEl.GetChildOrNull("flowdiagnostics");
+      if (diagnosticsEl != io::xml::Element::Missing())
+      {
+        flowDiagnostics = DoIOForFlowDiagnostics(diagnosticsEl);
+      }
+
+      // Optionally, a Catalyst script to run on the fluid sites every period steps, e.g.
+      // <insitu script="slices.py" period="100" />
+      const io::xml::Element inSituEl = propertiesEl.GetChildOrNull("insitu");
+      if (inSituEl != io::xml::Element::Missing())
+      {
+        inSituScript = util::NormalizePathRelativeToPath(inSituEl.GetAttributeOrThrow("script"),
+                                                         xmlFilePath);
+        inSituEl.GetAttributeOrNull("period", inSituPeriod);
+        if (inSituPeriod == 0)
+        {
+          throw Exception() << "The in situ period must be positive in element "
+              << inSituEl.GetPath();
+        }
       }
     }
 
+    extraction::ProbeOutputFile* SimConfig::DoIOForProbes(const io::xml::Element& probesEl)
+    {
+      extraction::ProbeOutputFile* file = new extraction::ProbeOutputFile();
+      file->filename = probesEl.GetAttributeOrThrow("file");
+
+      // Optionally, how often to sample, if not every step, and how often to write the samples.
+      probesEl.GetAttributeOrNull("sampleperiod", file->samplePeriod);
+      probesEl.GetAttributeOrNull("gatherperiod", file->gatherPeriod);
+      if (file->samplePeriod == 0 || file->gatherPeriod == 0)
+      {
+        throw Exception() << "The sample and gather periods must be positive in element "
+            << probesEl.GetPath();
+      }
+
+      for (io::xml::ChildIterator pointPtr = probesEl.IterChildren("point"); !pointPtr.AtEnd();
+          ++pointPtr)
+      {
+        PhysicalPosition point;
+        GetDimensionalValue(*pointPtr, "m", point);
+        file->points.push_back(point);
+      }
+      if (file->points.empty())
+      {
+        throw Exception() << "No probe points in element " << probesEl.GetPath();
+      }
+      return file;
+    }
+
+    extraction::FlowDiagnosticsFile* SimConfig::DoIOForFlowDiagnostics(
+        const io::xml::Element& diagnosticsEl)
+    {
+      // <flowdiagnostics file="flow.csv" period="100">
+      //   <wssregion name="sac">
+      //     <minimum value="(x,y,z)" units="m" />
+      //     <maximum value="(x,y,z)" units="m" />
+      //   </wssregion>
+      // </flowdiagnostics>
+      extraction::FlowDiagnosticsFile* file = new extraction::FlowDiagnosticsFile();
+      file->filename = diagnosticsEl.GetAttributeOrThrow("file");
+      diagnosticsEl.GetAttributeOrNull("period", file->period);
+      if (file->period == 0)
+      {
+        throw Exception() << "The flow diagnostics period must be positive in element "
+            << diagnosticsEl.GetPath();
+      }
+
+      for (io::xml::ChildIterator regionPtr = diagnosticsEl.IterChildren("wssregion");
+          !regionPtr.AtEnd(); ++regionPtr)
+      {
+        extraction::FlowDiagnosticsFile::WallRegion region;
+        region.name = regionPtr->GetAttributeOrThrow("name");
+        GetDimensionalValue(regionPtr->GetChildOrThrow("minimum"), "m", region.minimum);
+        GetDimensionalValue(regionPtr->GetChildOrThrow("maximum"), "m", region.maximum);
+        file->wallRegions.push_back(region);
+      }
+      return file;
+    }
+
     extraction::PropertyOutputFile* SimConfig::DoIOForPropertyOutputFile(
         const io::xml::Element& propertyoutputEl)
     {
@@ -324,6 +540,196 @@ namespace hemelb
 
       propertyoutputEl.GetAttributeOrThrow("period", file->frequency);
 
+      // Optionally, how often to sample for the accumulated fields, if not every step.
+      propertyoutputEl.GetAttributeOrNull("sampleperiod", file->samplePeriod);
+      if (file->samplePeriod == 0)
+      {
+        throw Exception() << "The sample period must be positive in element "
+            << propertyoutputEl.GetPath();
+      }
+
+      // Optionally, positions="once" to write the site positions in a list of their own, rather
+      // than in every record, or "surface" to add each wall site's normal and area to that list.
+      const std::string* positions = propertyoutputEl.GetAttributeOrNull("positions");
+      if (positions != NULL)
+      {
+        if (*positions == "once")
+        {
+          file->positionsOnce = true;
+        }
+        else if (*positions == "surface")
+        {
+          file->positionsOnce = true;
+          file->surfaceSiteLists = true;
+        }
+        else if (*positions != "everyrecord")
+        {
+          throw Exception() << "Unrecognised property output positions '" << *positions
+              << "' in element " << propertyoutputEl.GetPath();
+        }
+      }
+
+      // Optionally, precision="half" or "fixed16" to store the field values in 16 bits, or
+      // "delta" to store compressed differences between records, with a keyframe at least every
+      // keyframeperiod records. Deltas only make sense with the positions in site lists.
+      const std::string* precision = propertyoutputEl.GetAttributeOrNull("precision");
+      if (precision != NULL)
+      {
+        if (*precision == "half")
+        {
+          file->encoding = io::formats::extraction::Float16Encoding;
+        }
+        else if (*precision == "fixed16")
+        {
+          file->encoding = io::formats::extraction::Fixed16Encoding;
+        }
+        else if (*precision == "delta")
+        {
+          file->encoding = io::formats::extraction::DeltaEncoding;
+          file->positionsOnce = true;
+          propertyoutputEl.GetAttributeOrNull("keyframeperiod", file->keyframePeriod);
+          if (file->keyframePeriod == 0)
+          {
+            throw Exception() << "The keyframe period must be positive in element "
+                << propertyoutputEl.GetPath();
+          }
+        }
+        else if (*precision != "single")
+        {
+          throw Exception() << "Unrecognised property output precision '" << *precision
+              << "' in element " << propertyoutputEl.GetPath();
+        }
+      }
+
+      // Optionally, format="hdf5" to write parallel HDF5 instead of the extraction format.
+      const std::string* format = propertyoutputEl.GetAttributeOrNull("format");
+      if (format != NULL)
+      {
+        if (*format == "hdf5")
+        {
+#ifndef HEMELB_USE_HDF5
+          throw Exception() << "HDF5 property output needs HemeLB built with HEMELB_USE_HDF5, in element "
+              << propertyoutputEl.GetPath();
+#endif
+          file->format = extraction::PropertyOutputFile::Hdf5Format;
+        }
+        else if (*format != "xdr")
+        {
+          throw Exception() << "Unrecognised property output format '" << *format
+              << "' in element " << propertyoutputEl.GetPath();
+        }
+      }
+      if (file->format == extraction::PropertyOutputFile::Hdf5Format
+          && file->encoding != io::formats::extraction::Float32Encoding)
+      {
+        throw Exception() << "HDF5 property output is always single precision, in element "
+            << propertyoutputEl.GetPath();
+      }
+      if (file->format == extraction::PropertyOutputFile::Hdf5Format && file->surfaceSiteLists)
+      {
+        throw Exception() << "HDF5 property output can't have surface site lists, in element "
+            << propertyoutputEl.GetPath();
+      }
+
+      // Optionally, a decimation element to write only every factor'th site along each axis,
+      // with mode="stride", or the averages over blocks of factor cubed sites, with
+      // mode="average".
+      const io::xml::Element decimationEl = propertyoutputEl.GetChildOrNull("decimation");
+      if (decimationEl != io::xml::Element::Missing())
+      {
+        decimationEl.GetAttributeOrThrow("factor", file->decimationFactor);
+        if (file->decimationFactor == 0)
+        {
+          throw Exception() << "The decimation factor must be positive in element "
+              << decimationEl.GetPath();
+        }
+        const std::string& mode = decimationEl.GetAttributeOrThrow("mode");
+        if (mode == "stride")
+        {
+          file->decimation = extraction::PropertyOutputFile::StrideDecimation;
+        }
+        else if (mode == "average")
+        {
+          file->decimation = extraction::PropertyOutputFile::BlockAverageDecimation;
+        }
+        else
+        {
+          throw Exception() << "Unrecognised decimation mode '" << mode << "' in element "
+              << decimationEl.GetPath();
+        }
+      }
+
+      if (file->decimation == extraction::PropertyOutputFile::BlockAverageDecimation
+          && file->surfaceSiteLists)
+      {
+        throw Exception() << "Block averaged property output can't have surface site lists, in element "
+            << propertyoutputEl.GetPath();
+      }
+
+      // Optionally, subfiles="node" to write a part of the file per node, or subfiles="N" per N
+      // ranks, with an index of the parts at the file's path.
+      const std::string* subfiles = propertyoutputEl.GetAttributeOrNull("subfiles");
+      if (subfiles != NULL)
+      {
+        if (!io::SubfileGroup::ParseRanksPerFile(*subfiles, file->ranksPerFile))
+        {
+          throw Exception() << "Unrecognised property output subfiles '" << *subfiles
+              << "' in element " << propertyoutputEl.GetPath();
+        }
+        if (file->format == extraction::PropertyOutputFile::Hdf5Format
+            || file->decimation == extraction::PropertyOutputFile::BlockAverageDecimation)
+        {
+          throw Exception() << "HDF5 and block averaged property output can't be split into subfiles, in element "
+              << propertyoutputEl.GetPath();
+        }
+      }
+
+      // Optionally, trigger elements to also write a record when a monitored quantity,
+      // quantity="velocity" (the largest, in m/s) or "densitydifference" (the largest relative
+      // one), goes above the threshold (condition="above"), changes by more than it relative to
+      // its last value ("change") or peaks above it ("peak"), at most once every holdoff steps.
+      for (io::xml::ChildIterator triggerPtr = propertyoutputEl.IterChildren("trigger");
+          !triggerPtr.AtEnd(); ++triggerPtr)
+      {
+        const io::xml::Element& triggerEl = *triggerPtr;
+        extraction::OutputTrigger trigger;
+        const std::string& quantity = triggerEl.GetAttributeOrThrow("quantity");
+        if (quantity == "velocity")
+        {
+          trigger.quantity = extraction::OutputTrigger::MaxVelocity;
+        }
+        else if (quantity == "densitydifference")
+        {
+          trigger.quantity = extraction::OutputTrigger::MaxDensityDifference;
+        }
+        else
+        {
+          throw Exception() << "Unrecognised trigger quantity '" << quantity << "' in element "
+              << triggerEl.GetPath();
+        }
+        const std::string& condition = triggerEl.GetAttributeOrThrow("condition");
+        if (condition == "above")
+        {
+          trigger.condition = extraction::OutputTrigger::Above;
+        }
+        else if (condition == "change")
+        {
+          trigger.condition = extraction::OutputTrigger::RelativeChange;
+        }
+        else if (condition == "peak")
+        {
+          trigger.condition = extraction::OutputTrigger::Peak;
+        }
+        else
+        {
+          throw Exception() << "Unrecognised trigger condition '" << condition << "' in element "
+              << triggerEl.GetPath();
+        }
+        triggerEl.GetAttributeOrThrow("threshold", trigger.threshold);
+        triggerEl.GetAttributeOrNull("holdoff", trigger.holdoff);
+        file->triggers.push_back(trigger);
+      }
+
       io::xml::Element geometryEl = propertyoutputEl.GetChildOrThrow("geometry");
       const std::string& type = geometryEl.GetAttributeOrThrow("type");
 
@@ -465,6 +871,22 @@ namespace hemelb
       {
         field.type = extraction::OutputField::MpiRank;
       }
+      else if (type == "averagedshearstress")
+      {
+        field.type = extraction::OutputField::AveragedShearStress;
+      }
+      else if (type == "oscillatoryshearindex")
+      {
+        field.type = extraction::OutputField::OscillatoryShearIndex;
+      }
+      else if (type == "averagedvelocity")
+      {
+        field.type = extraction::OutputField::AveragedVelocity;
+      }
+      else if (type == "velocityrms")
+      {
+        field.type = extraction::OutputField::VelocityRms;
+      }
       else
       {
         throw Exception() << "Unrecognised field type '" << type << "' in " << fieldEl.GetPath();
@@ -487,6 +909,62 @@ namespace hemelb
       value->SetNormal(norm);
     }
 
+    void SimConfig::DoIOForRegions(const io::xml::Element& regionsEl,
+                                   std::vector<geometry::SiteBox>& regions)
+    {
+      // <stabilised_regions> or <compressed_regions>
+      //   <box>
+      //     <minimum value="(x,y,z)" units="m" />
+      //     <maximum value="(x,y,z)" units="m" />
+      //   </box>
+      // </stabilised_regions> or </compressed_regions>
+      for (io::xml::ChildIterator boxPtr = regionsEl.IterChildren("box"); !boxPtr.AtEnd(); ++boxPtr)
+      {
+        PhysicalPosition minimum, maximum;
+        GetDimensionalValue(boxPtr->GetChildOrThrow("minimum"), "m", minimum);
+        GetDimensionalValue(boxPtr->GetChildOrThrow("maximum"), "m", maximum);
+
+        // Only the sites inside the box.
+        const LatticePosition latticeMinimum = unitConverter->ConvertPositionToLatticeUnits(minimum);
+        const LatticePosition latticeMaximum = unitConverter->ConvertPositionToLatticeUnits(maximum);
+        geometry::SiteBox box;
+        box.minimum = util::Vector3D<site_t>(site_t(std::ceil(latticeMinimum.x)),
+                                             site_t(std::ceil(latticeMinimum.y)),
+                                             site_t(std::ceil(latticeMinimum.z)));
+        box.maximum = util::Vector3D<site_t>(site_t(std::floor(latticeMaximum.x)),
+                                             site_t(std::floor(latticeMaximum.y)),
+                                             site_t(std::floor(latticeMaximum.z)));
+        regions.push_back(box);
+      }
+    }
+
+    void SimConfig::DoIOForDecomposition(const io::xml::Element& decompositionEl)
+    {
+      // <decomposition>
+      //   <compute tolerance="1.001" />
+      //   <memory tolerance="1.05" />
+      // </decomposition>
+      // Each tolerance is the largest ratio of a core's weight to the mean that ParMetis may
+      // leave. Without the memory element, only the compute cost is balanced.
+      const io::xml::Element computeEl = decompositionEl.GetChildOrNull("compute");
+      if (computeEl != io::xml::Element::Missing())
+      {
+        computeEl.GetAttributeOrThrow("tolerance", balanceConstraints.computeTolerance);
+      }
+      const io::xml::Element memoryEl = decompositionEl.GetChildOrNull("memory");
+      if (memoryEl != io::xml::Element::Missing())
+      {
+        memoryEl.GetAttributeOrThrow("tolerance", balanceConstraints.memoryTolerance);
+      }
+
+      if (balanceConstraints.computeTolerance < 1.0
+          || (memoryEl != io::xml::Element::Missing() && balanceConstraints.memoryTolerance < 1.0))
+      {
+        throw Exception() << "Decomposition tolerances must be at least 1 (line "
+            << decompositionEl.GetLine() << ")";
+      }
+    }
+
     void SimConfig::DoIOForInitialConditions(io::xml::Element initialconditionsEl)
     {
       //, isLoading, initialPressure
@@ -494,6 +972,21 @@ namespace hemelb
       io::xml::Element uniformEl = pressureEl.GetChildOrThrow("uniform");
 
       GetDimensionalValue(uniformEl, "mmHg", initialPressure_mmHg);
+
+      // Optional element
+      // <warmstart path="coarse.xtr" timestep="unsigned" />
+      const io::xml::Element warmStartEl = initialconditionsEl.GetChildOrNull("warmstart");
+      if (warmStartEl != io::xml::Element::Missing())
+      {
+        warmStartPath = util::NormalizePathRelativeToPath(warmStartEl.GetAttributeOrThrow("path"),
+                                                          xmlFilePath);
+        if (warmStartEl.GetAttributeOrNull("timestep") != NULL)
+        {
+          unsigned long timestep;
+          warmStartEl.GetAttributeOrThrow("timestep", timestep);
+          warmStartTimestep = timestep;
+        }
+      }
     }
 
     lb::iolets::InOutLetCosine* SimConfig::DoIOForCosinePressureInOutlet(
@@ -555,6 +1048,34 @@ namespace hemelb
       GetDimensionalValue(velocityEl, "m/s", newIolet->GetVelocityReference());
 
       newIolet->GetLabel() = conditionEl.GetChildOrThrow("label").GetAttributeOrThrow("value");
+
+      // Optional element
+      // <coupling interval="unsigned" interpolation="linear|cubic" />
+      const io::xml::Element couplingEl = conditionEl.GetChildOrNull("coupling");
+      if (couplingEl != io::xml::Element::Missing())
+      {
+        unsigned long interval;
+        couplingEl.GetAttributeOrThrow("interval", interval);
+        if (interval < 1)
+        {
+          throw Exception() << "Multiscale coupling interval must be at least 1";
+        }
+        newIolet->SetCouplingInterval(interval);
+
+        const std::string* interpolation = couplingEl.GetAttributeOrNull("interpolation");
+        if (interpolation == NULL || *interpolation == "linear")
+        {
+          newIolet->SetCouplingInterpolation(lb::iolets::InOutLetMultiscale::LinearInterpolation);
+        }
+        else if (*interpolation == "cubic")
+        {
+          newIolet->SetCouplingInterpolation(lb::iolets::InOutLetMultiscale::CubicInterpolation);
+        }
+        else
+        {
+          throw Exception() << "Unknown multiscale coupling interpolation: " << *interpolation;
+        }
+      }
       return newIolet;
     }
 
@@ -652,6 +1173,30 @@ namespace hemelb
 
       monitoringConfig.doIncompressibilityCheck = (monEl.GetChildOrNull("incompressibility")
           != io::xml::Element::Missing());
+
+      // Optional element
+      // <check_period value="unsigned" units="lattice" />
+      io::xml::Element periodEl = monEl.GetChildOrNull("check_period");
+      if (periodEl != io::xml::Element::Missing())
+      {
+        GetDimensionalValue(periodEl, "lattice", monitoringConfig.checkPeriod);
+        if (monitoringConfig.checkPeriod == 0)
+        {
+          throw Exception() << "The monitoring check period must be positive in " << periodEl.GetPath();
+        }
+      }
+
+      // Optional element
+      // <site_stride value="unsigned" />
+      io::xml::Element strideEl = monEl.GetChildOrNull("site_stride");
+      if (strideEl != io::xml::Element::Missing())
+      {
+        strideEl.GetAttributeOrThrow("value", monitoringConfig.siteStride);
+        if (monitoringConfig.siteStride <= 0)
+        {
+          throw Exception() << "The monitoring site stride must be positive in " << strideEl.GetPath();
+        }
+      }
     }
 
     void SimConfig::DoIOForSteadyFlowConvergence(const io::xml::Element& convEl)
@@ -670,13 +1215,29 @@ namespace hemelb
       {
         DoIOForConvergenceCriterion(*criteriaIt);
       }
+
+      // Optional element
+      // <acceleration period="unsigned" factor="double" />
+      io::xml::Element accelerationEl = convEl.GetChildOrNull("acceleration");
+      if (accelerationEl != io::xml::Element::Missing())
+      {
+        DoIOForSteadyFlowAcceleration(accelerationEl);
+      }
     }
 
     void SimConfig::DoIOForConvergenceCriterion(const io::xml::Element& criterionEl)
     {
       const std::string& criterionType = criterionEl.GetAttributeOrThrow("type");
 
-      // We only allow velocity-based convergence check for the time being
+      // The largest relative change in any distribution over a step, which is already relative
+      // and which the streamers find as they collide.
+      if (criterionType == "distributions")
+      {
+        monitoringConfig.convergenceOnDistributions = true;
+        return;
+      }
+
+      // Otherwise we only allow velocity-based convergence check for the time being
       if (criterionType != "velocity")
       {
         throw Exception() << "Invalid convergence criterion type " << criterionType << " in "
@@ -687,6 +1248,22 @@ namespace hemelb
           GetDimensionalValueInLatticeUnits<LatticeSpeed>(criterionEl, "m/s");
     }
 
+    void SimConfig::DoIOForSteadyFlowAcceleration(const io::xml::Element& accelerationEl)
+    {
+      accelerationEl.GetAttributeOrThrow("period", monitoringConfig.accelerationPeriod);
+      if (monitoringConfig.accelerationPeriod == 0)
+      {
+        throw Exception() << "The acceleration period must be positive in " << accelerationEl.GetPath();
+      }
+
+      // Without a factor, one is found as the run goes.
+      accelerationEl.GetAttributeOrNull("factor", monitoringConfig.accelerationFactor);
+      if (monitoringConfig.accelerationFactor < 0)
+      {
+        throw Exception() << "The acceleration factor must not be negative in " << accelerationEl.GetPath();
+      }
+    }
+
     const SimConfig::MonitoringConfig* SimConfig::GetMonitoringConfiguration() const
     {
       return &monitoringConfig;
@@ -12,8 +12,15 @@
 #include "lb/LbmParameters.h"
 #include "lb/iolets/InOutLets.h"
 #include "extraction/PropertyOutputFile.h"
+#include "extraction/ProbeOutputFile.h"
+#include "extraction/FlowDiagnosticsFile.h"
 #include "extraction/GeometrySelectors.h"
+#include "io/formats/image.h"
 #include "io/xml/XmlAbstractionLayer.h"
+#include "net/MpiCommunicator.h"
+#include "vis/VisSettings.h"
+#include "geometry/SiteBox.h"
+#include "geometry/decomposition/BalanceConstraints.h"
 
 namespace hemelb
 {
@@ -41,23 +48,58 @@ namespace hemelb
         struct MonitoringConfig
         {
             MonitoringConfig() :
-                doConvergenceCheck(false), convergenceRelativeTolerance(0), convergenceTerminate(false),
-                    doIncompressibilityCheck(false)
+                doConvergenceCheck(false), convergenceOnDistributions(false),
+                    convergenceRelativeTolerance(0), convergenceTerminate(false),
+                    accelerationPeriod(0), accelerationFactor(0), doIncompressibilityCheck(false),
+                    checkPeriod(1), siteStride(1)
             {
             }
             bool doConvergenceCheck; ///< Whether to turn on the convergence check or not
+            bool convergenceOnDistributions; ///< Whether to check for convergence on the distributions' largest relative change rather than convergenceVariable
             extraction::OutputField::FieldType convergenceVariable; ///< Macroscopic variable used to check for convergence
             double convergenceReferenceValue; ///< Reference value used to normalise an absolute error (making it relative)
             double convergenceRelativeTolerance; ///< Convergence check relative tolerance
             bool convergenceTerminate; ///< Whether to terminate a converged run or not
+            unsigned long accelerationPeriod; ///< Number of time steps between extrapolations towards the steady state, or 0 not to
+            double accelerationFactor; ///< Extrapolation factor, or 0 to find it as the run goes
             bool doIncompressibilityCheck; ///< Whether to turn on the IncompressibilityChecker or not
+            unsigned long checkPeriod; ///< Number of time steps between calls to the checkers/testers
+            site_t siteStride; ///< Only every siteStride-th site is swept by the checkers/testers
+        };
+
+        /**
+         * A further view of the visualisation, rendered with the steered one for the images
+         * written to disk.
+         */
+        struct ImageView
+        {
+            int pixelsX;
+            int pixelsY;
+            float longitude; ///< In degrees
+            float latitude; ///< In degrees
+            float zoom;
+            vis::VisSettings::Mode mode;
         };
 
         static SimConfig* New(const std::string& path);
 
+        /**
+         * Read the file on one process of comms only and parse it on all of them from memory,
+         * which spares a parallel file system all but one open of it. Collective.
+         * @param path
+         * @param comms
+         * @return
+         */
+        static SimConfig* New(const std::string& path, const net::MpiCommunicator& comms);
+
       protected:
         SimConfig(const std::string& path);
         void Init();
+        /**
+         * Set up from the given contents of the file, instead of reading it.
+         * @param xmlText
+         */
+        void Init(const std::string& xmlText);
 
       public:
         virtual ~SimConfig();
@@ -97,6 +139,22 @@ namespace hemelb
         {
           return visualisationBrightness;
         }
+        io::formats::image::Encoding GetImageEncoding() const
+        {
+          return imageEncoding;
+        }
+        io::formats::image::Encoding GetNetworkImageEncoding() const
+        {
+          return networkImageEncoding;
+        }
+        unsigned GetProgressiveStride() const
+        {
+          return progressiveStride;
+        }
+        const std::vector<ImageView>& GetImageViews() const
+        {
+          return imageViews;
+        }
         float GetMaximumVelocity() const
         {
           return maxVelocity;
@@ -141,6 +199,38 @@ namespace hemelb
         {
           return propertyOutputs;
         }
+        /**
+         * The probes to record, or NULL if there aren't any.
+         * @return
+         */
+        extraction::ProbeOutputFile* GetProbes() const
+        {
+          return probes;
+        }
+        /**
+         * The flow diagnostics to record, or NULL if there aren't any.
+         * @return
+         */
+        extraction::FlowDiagnosticsFile* GetFlowDiagnostics() const
+        {
+          return flowDiagnostics;
+        }
+        /**
+         * The Catalyst script to run on the fluid sites in situ, or empty if there isn't one.
+         * @return
+         */
+        const std::string& GetInSituScript() const
+        {
+          return inSituScript;
+        }
+        /**
+         * How many steps apart to run the in situ script.
+         * @return
+         */
+        unsigned GetInSituPeriod() const
+        {
+          return inSituPeriod;
+        }
         const std::string GetColloidConfigPath() const
         {
           return colloidConfigPath;
@@ -157,6 +247,55 @@ namespace hemelb
          */
         LatticeDensity GetInitialPressure() const;
 
+        /**
+         * The file of an earlier run to start the flow from, or empty to start from the uniform
+         * initial pressure. Either a property output file, of any resolution, or a checkpoint of
+         * the same geometry.
+         * @return
+         */
+        const std::string& GetWarmStartPath() const
+        {
+          return warmStartPath;
+        }
+        /**
+         * The time step of the record in the warm start property output file to start from, or
+         * -1 for the last.
+         * @return
+         */
+        long GetWarmStartTimestep() const
+        {
+          return warmStartTimestep;
+        }
+
+        /**
+         * The boxes whose bulk sites the stabilised kernel, if one is built in, collides
+         * instead of the main one.
+         * @return
+         */
+        const std::vector<geometry::SiteBox>& GetStabilisedRegions() const
+        {
+          return stabilisedRegions;
+        }
+
+        /**
+         * The boxes of slow flow whose bulk sites' distributions are kept compressed, with
+         * HEMELB_USE_COMPRESSED_COLD_SITES built in.
+         * @return
+         */
+        const std::vector<geometry::SiteBox>& GetCompressedRegions() const
+        {
+          return compressedRegions;
+        }
+
+        /**
+         * What to balance the decomposition by, and how closely.
+         * @return
+         */
+        const geometry::decomposition::BalanceConstraints& GetBalanceConstraints() const
+        {
+          return balanceConstraints;
+        }
+
         const util::UnitConverter& GetUnitConverter() const;
 
         /**
@@ -238,12 +377,16 @@ namespace hemelb
         extraction::OutputField DoIOForPropertyField(const io::xml::Element& xmlNode);
         extraction::PropertyOutputFile* DoIOForPropertyOutputFile(
             const io::xml::Element& propertyoutputEl);
+        extraction::ProbeOutputFile* DoIOForProbes(const io::xml::Element& probesEl);
+        extraction::FlowDiagnosticsFile* DoIOForFlowDiagnostics(const io::xml::Element& diagnosticsEl);
         extraction::StraightLineGeometrySelector* DoIOForLineGeometry(
             const io::xml::Element& xmlNode);
         extraction::PlaneGeometrySelector* DoIOForPlaneGeometry(const io::xml::Element&);
         extraction::SurfacePointSelector* DoIOForSurfacePoint(const io::xml::Element&);
 
         void DoIOForInitialConditions(io::xml::Element parent);
+        void DoIOForRegions(const io::xml::Element& regionsEl, std::vector<geometry::SiteBox>& regions);
+        void DoIOForDecomposition(const io::xml::Element& decompositionEl);
         void DoIOForVisualisation(const io::xml::Element& visEl);
 
         /**
@@ -267,6 +410,13 @@ namespace hemelb
          */
         void DoIOForConvergenceCriterion(const io::xml::Element& criterionEl);
 
+        /**
+         * Reads configuration of the acceleration towards the steady state from XML file
+         *
+         * @param accelerationEl in memory representation of the <acceleration> XML element
+         */
+        void DoIOForSteadyFlowAcceleration(const io::xml::Element& accelerationEl);
+
         const std::string& xmlFilePath;
         io::xml::Document* rawXmlDoc;
         std::string dataFilePath;
@@ -276,17 +426,30 @@ namespace hemelb
         float visualisationLatitude;
         float visualisationZoom;
         float visualisationBrightness;
+        io::formats::image::Encoding imageEncoding;
+        io::formats::image::Encoding networkImageEncoding;
+        unsigned progressiveStride;
+        std::vector<ImageView> imageViews;
         float maxVelocity;
         float maxStress;
         lb::StressTypes stressType;
         std::vector<extraction::PropertyOutputFile*> propertyOutputs;
+        extraction::ProbeOutputFile* probes;
+        extraction::FlowDiagnosticsFile* flowDiagnostics;
+        std::string inSituScript; ///< The in situ visualisation script, if any
+        unsigned inSituPeriod; ///< Steps between runs of the script
         std::string colloidConfigPath;
         /**
          * True if the file has a colloids section.
          */
         bool hasColloidSection;
         PhysicalPressure initialPressure_mmHg; ///< Pressure used to initialise the domain
+        std::string warmStartPath; ///< Coarse run to initialise the domain from, if any
+        long warmStartTimestep; ///< Its record to use, or -1 for the last
         MonitoringConfig monitoringConfig; ///< Configuration of various checks/tests
+        std::vector<geometry::SiteBox> stabilisedRegions; ///< Where to use the stabilised kernel
+        std::vector<geometry::SiteBox> compressedRegions; ///< Where to keep the distributions compressed
+        geometry::decomposition::BalanceConstraints balanceConstraints; ///< What to balance the decomposition by
 
       protected:
         // These have to contain pointers because there are multiple derived types that might be
@@ -40,6 +40,15 @@ namespace hemelb
           return false;
         }
 
+        /**
+         * Moves to the site with the given index in iteration order.
+         * @param index
+         * @return
+         */
+        bool ReadAt(site_t index) {
+          return false;
+        }
+
         /**
          * Returns the coordinates of the site.
          * @return
@@ -0,0 +1,128 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+#include <utility>
+#include "extraction/BlockAverager.h"
+#include "util/MortonOrder.h"
+#include "Exception.h"
+
+namespace hemelb
+{
+  namespace extraction
+  {
+    namespace
+    {
+      /**
+       * The inverse of util::SpreadBitsByThree.
+       * @param value
+       * @return
+       */
+      site_t GatherBitsByThree(uint64_t value)
+      {
+        site_t gathered = 0;
+        for (unsigned bit = 0; bit < 21; ++bit)
+        {
+          gathered |= site_t( (value >> (3 * bit)) & 1) << bit;
+        }
+        return gathered;
+      }
+    }
+
+    BlockAverager::BlockAverager(unsigned blockSize, const net::MpiCommunicator& comms) :
+        blockSize(blockSize), comms(comms), partialBlockCount(0)
+    {
+    }
+
+    int BlockAverager::GetOwner(uint64_t blockKey) const
+    {
+      // Runs of 64 blocks, 4 x 4 x 4 when aligned, go to each core in turn.
+      return int( (blockKey >> 6) % comms.Size());
+    }
+
+    void BlockAverager::SetSites(const std::vector<util::Vector3D<site_t> >& positions)
+    {
+      // The owner and key of each site's block.
+      typedef std::pair<int, uint64_t> PartialBlock;
+      std::vector<PartialBlock> blockOfSite(positions.size());
+      for (size_t site = 0; site < positions.size(); ++site)
+      {
+        const util::Vector3D<site_t> block = positions[site] / site_t(blockSize);
+        if (block.x >= (1 << 21) || block.y >= (1 << 21) || block.z >= (1 << 21))
+        {
+          throw Exception() << "Too many blocks across the domain to average over";
+        }
+        const uint64_t key = util::GetMortonKey(block);
+        blockOfSite[site] = PartialBlock(GetOwner(key), key);
+      }
+
+      std::vector<PartialBlock> partialBlocks(blockOfSite);
+      std::sort(partialBlocks.begin(), partialBlocks.end());
+      partialBlocks.erase(std::unique(partialBlocks.begin(), partialBlocks.end()),
+                          partialBlocks.end());
+      partialBlockCount = partialBlocks.size();
+
+      // Number the sites' blocks, and count the sites in each.
+      siteBlocks.resize(positions.size());
+      std::vector<uint64_t> partialSiteCounts(partialBlockCount, 0);
+      for (size_t site = 0; site < positions.size(); ++site)
+      {
+        siteBlocks[site] = std::lower_bound(partialBlocks.begin(),
+                                            partialBlocks.end(),
+                                            blockOfSite[site]) - partialBlocks.begin();
+        ++partialSiteCounts[siteBlocks[site]];
+      }
+
+      // Tell the owners about the partial blocks: the key and the number of sites of each.
+      partialBlocksPerCore.assign(comms.Size(), 0);
+      std::vector<uint64_t> keysAndCounts;
+      for (size_t partial = 0; partial < partialBlockCount; ++partial)
+      {
+        ++partialBlocksPerCore[partialBlocks[partial].first];
+        keysAndCounts.push_back(partialBlocks[partial].second);
+        keysAndCounts.push_back(partialSiteCounts[partial]);
+      }
+      std::vector<int> sendCounts(partialBlocksPerCore);
+      for (size_t core = 0; core < sendCounts.size(); ++core)
+      {
+        sendCounts[core] *= 2;
+      }
+      const std::vector<uint64_t> received = comms.AllToAllV(keysAndCounts, sendCounts);
+
+      // The owned blocks are those any core has sites in.
+      std::vector<uint64_t> ownedKeys;
+      for (size_t partial = 0; partial < received.size(); partial += 2)
+      {
+        ownedKeys.push_back(received[partial]);
+      }
+      std::sort(ownedKeys.begin(), ownedKeys.end());
+      ownedKeys.erase(std::unique(ownedKeys.begin(), ownedKeys.end()), ownedKeys.end());
+
+      blockPositions.resize(ownedKeys.size());
+      for (size_t block = 0; block < ownedKeys.size(); ++block)
+      {
+        blockPositions[block] = util::Vector3D<site_t>(GatherBitsByThree(ownedKeys[block]),
+                                                       GatherBitsByThree(ownedKeys[block] >> 1),
+                                                       GatherBitsByThree(ownedKeys[block] >> 2))
+            * site_t(blockSize);
+      }
+
+      receivedBlocks.resize(received.size() / 2);
+      blockSiteCounts.assign(ownedKeys.size(), 0);
+      for (size_t partial = 0; partial < receivedBlocks.size(); ++partial)
+      {
+        receivedBlocks[partial] = std::lower_bound(ownedKeys.begin(),
+                                                   ownedKeys.end(),
+                                                   received[2 * partial]) - ownedKeys.begin();
+        blockSiteCounts[receivedBlocks[partial]] += received[2 * partial + 1];
+      }
+    }
+
+    const std::vector<util::Vector3D<site_t> >& BlockAverager::GetBlockPositions() const
+    {
+      return blockPositions;
+    }
+  }
+}
@@ -0,0 +1,127 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_EXTRACTION_BLOCKAVERAGER_H
+#define HEMELB_EXTRACTION_BLOCKAVERAGER_H
+
+#include <vector>
+#include "net/MpiCommunicator.h"
+#include "units.h"
+#include "util/Vector3D.h"
+
+namespace hemelb
+{
+  namespace extraction
+  {
+    /**
+     * Averages values over the sites in each cube of k x k x k lattice sites, for decimated
+     * property output.
+     *
+     * A block's sites can be on several cores, so each block belongs to one core, picked from
+     * its position along the Morton curve so that nearby blocks tend to share an owner. Each
+     * core sums the values of its own sites block by block, and sends the partial sums to the
+     * blocks' owners, which add them up and divide by the number of sites. Which blocks each
+     * core has sites in only changes with the sites, so that is worked out once up front; each
+     * average is then a single exchange of about one value per block.
+     */
+    class BlockAverager
+    {
+      public:
+        /**
+         * @param blockSize The number of sites along each side of a block.
+         * @param comms
+         */
+        BlockAverager(unsigned blockSize, const net::MpiCommunicator& comms);
+
+        /**
+         * Find the blocks of the sites, and which of them this core owns. Collective.
+         * @param positions The lattice positions of the local sites to average over.
+         */
+        void SetSites(const std::vector<util::Vector3D<site_t> >& positions);
+
+        /**
+         * Average values over the blocks. Collective.
+         * @param siteValues valuesPerSite values for each local site, in the order of the
+         * positions given to SetSites.
+         * @param valuesPerSite
+         * @param blockValues Set to valuesPerSite values for each block this core owns, in the
+         * order of GetBlockPositions.
+         */
+        template<typename T>
+        void Average(const std::vector<T>& siteValues, unsigned valuesPerSite,
+                     std::vector<T>& blockValues) const
+        {
+          // Sum the local sites' values into the partial blocks...
+          std::vector<double> partialSums(partialBlockCount * valuesPerSite, 0.);
+          for (size_t site = 0; site < siteBlocks.size(); ++site)
+          {
+            double* const sums = &partialSums[siteBlocks[site] * valuesPerSite];
+            for (unsigned value = 0; value < valuesPerSite; ++value)
+            {
+              sums[value] += siteValues[site * valuesPerSite + value];
+            }
+          }
+
+          // ... and send them to the blocks' owners to add up.
+          std::vector<int> sendCounts(partialBlocksPerCore);
+          for (size_t core = 0; core < sendCounts.size(); ++core)
+          {
+            sendCounts[core] *= valuesPerSite;
+          }
+          const std::vector<double> received = comms.AllToAllV(partialSums, sendCounts);
+
+          std::vector<double> blockSums(blockPositions.size() * valuesPerSite, 0.);
+          for (size_t partial = 0; partial < receivedBlocks.size(); ++partial)
+          {
+            for (unsigned value = 0; value < valuesPerSite; ++value)
+            {
+              blockSums[receivedBlocks[partial] * valuesPerSite + value] += received[partial
+                  * valuesPerSite + value];
+            }
+          }
+
+          blockValues.resize(blockSums.size());
+          for (size_t block = 0; block < blockPositions.size(); ++block)
+          {
+            for (unsigned value = 0; value < valuesPerSite; ++value)
+            {
+              blockValues[block * valuesPerSite + value] = T(blockSums[block * valuesPerSite
+                  + value] / blockSiteCounts[block]);
+            }
+          }
+        }
+
+        /**
+         * Returns the position of the lowest corner of each block this core owns, in lattice
+         * units, in Morton order.
+         * @return
+         */
+        const std::vector<util::Vector3D<site_t> >& GetBlockPositions() const;
+
+      private:
+        /**
+         * Returns the core that owns the block.
+         * @param blockKey
+         * @return
+         */
+        int GetOwner(uint64_t blockKey) const;
+
+        const unsigned blockSize;
+        const net::MpiCommunicator& comms;
+        //! The partial block of each local site, the partial blocks being in order of owner
+        //! then Morton key.
+        std::vector<size_t> siteBlocks;
+        size_t partialBlockCount;
+        //! The number of partial blocks for each owner.
+        std::vector<int> partialBlocksPerCore;
+        //! The owned block that each partial block received adds to.
+        std::vector<size_t> receivedBlocks;
+        std::vector<util::Vector3D<site_t> > blockPositions;
+        std::vector<uint64_t> blockSiteCounts;
+    };
+  }
+}
+
+#endif /* HEMELB_EXTRACTION_BLOCKAVERAGER_H */
@@ -0,0 +1,39 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "extraction/BoxGeometrySelector.h"
+
+namespace hemelb
+{
+  namespace extraction
+  {
+    BoxGeometrySelector::BoxGeometrySelector(const util::Vector3D<float>& minimum,
+                                             const util::Vector3D<float>& maximum) :
+      minimum(minimum), maximum(maximum)
+    {
+
+    }
+
+    const util::Vector3D<float>& BoxGeometrySelector::GetMinimum() const
+    {
+      return minimum;
+    }
+
+    const util::Vector3D<float>& BoxGeometrySelector::GetMaximum() const
+    {
+      return maximum;
+    }
+
+    bool BoxGeometrySelector::IsWithinGeometry(const extraction::IterableDataSource& data,
+                                               const util::Vector3D<site_t>& location)
+    {
+      const util::Vector3D<float> coords = util::Vector3D<float>(location) * data.GetVoxelSize()
+          + data.GetOrigin();
+
+      return coords.x >= minimum.x && coords.y >= minimum.y && coords.z >= minimum.z
+          && coords.x <= maximum.x && coords.y <= maximum.y && coords.z <= maximum.z;
+    }
+  }
+}
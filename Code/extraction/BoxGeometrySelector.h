@@ -0,0 +1,48 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_EXTRACTION_BOXGEOMETRYSELECTOR_H
+#define HEMELB_EXTRACTION_BOXGEOMETRYSELECTOR_H
+
+#include "extraction/GeometrySelector.h"
+
+namespace hemelb
+{
+  namespace extraction
+  {
+    /**
+     * Selects the sites within an axis-aligned box.
+     */
+    class BoxGeometrySelector : public GeometrySelector
+    {
+      public:
+        /**
+         * @param minimum The corner of the box with the lowest coordinates, in metres.
+         * @param maximum The corner of the box with the highest coordinates, in metres.
+         */
+        BoxGeometrySelector(const util::Vector3D<float>& minimum, const util::Vector3D<float>& maximum);
+
+        const util::Vector3D<float>& GetMinimum() const;
+
+        const util::Vector3D<float>& GetMaximum() const;
+
+      protected:
+        /**
+         * Returns true for any location within the box, including on its faces.
+         *
+         * @param data
+         * @param location
+         * @return
+         */
+        bool IsWithinGeometry(const extraction::IterableDataSource& data, const util::Vector3D<site_t>& location);
+
+      private:
+        const util::Vector3D<float> minimum;
+        const util::Vector3D<float> maximum;
+    };
+  }
+}
+
+#endif /* HEMELB_EXTRACTION_BOXGEOMETRYSELECTOR_H */
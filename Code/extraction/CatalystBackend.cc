@@ -0,0 +1,124 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "extraction/CatalystBackend.h"
+#include "Exception.h"
+
+namespace hemelb
+{
+  namespace extraction
+  {
+    namespace
+    {
+      // Describes one component of an array of values with the given number of components each,
+      // without copying it.
+      void SetExternalComponent(conduit_node* node, const std::string& path, const double* data,
+                                site_t count, unsigned components, unsigned component)
+      {
+        conduit_node_set_path_external_float64_ptr_detailed(node,
+                                                            path.c_str(),
+                                                            const_cast<double*>(data),
+                                                            count,
+                                                            component * sizeof(double),
+                                                            components * sizeof(double),
+                                                            sizeof(double),
+                                                            CONDUIT_ENDIANNESS_DEFAULT_ID);
+      }
+    }
+
+    CatalystBackend::CatalystBackend(const std::string& scriptPath)
+    {
+      conduit_node* settings = conduit_node_create();
+      conduit_node_set_path_char8_str(settings, "catalyst/scripts/script/filename", scriptPath.c_str());
+      const enum catalyst_status status = catalyst_initialize(settings);
+      conduit_node_destroy(settings);
+      if (status != catalyst_status_ok)
+      {
+        throw Exception() << "Catalyst failed to initialise with script '" << scriptPath
+            << "', with status " << int(status);
+      }
+    }
+
+    CatalystBackend::~CatalystBackend()
+    {
+      conduit_node* settings = conduit_node_create();
+      catalyst_finalize(settings);
+      conduit_node_destroy(settings);
+    }
+
+    void CatalystBackend::Execute(LatticeTimeStep timeStep, PhysicalTime time,
+                                  const InSituMesh& mesh)
+    {
+      if (site_t(connectivity.size()) != mesh.pointCount)
+      {
+        connectivity.resize(mesh.pointCount);
+        for (site_t point = 0; point < mesh.pointCount; ++point)
+        {
+          connectivity[point] = point;
+        }
+      }
+
+      conduit_node* execute = conduit_node_create();
+      conduit_node_set_path_int64(execute, "catalyst/state/timestep", conduit_int64(timeStep));
+      conduit_node_set_path_float64(execute, "catalyst/state/time", time);
+      conduit_node_set_path_char8_str(execute, "catalyst/channels/grid/type", "mesh");
+
+      conduit_node* grid = conduit_node_fetch(execute, "catalyst/channels/grid/data");
+      conduit_node_set_path_char8_str(grid, "coordsets/coords/type", "explicit");
+      const char* axes[3] = { "x", "y", "z" };
+      for (unsigned axis = 0; axis < 3; ++axis)
+      {
+        SetExternalComponent(grid,
+                             std::string("coordsets/coords/values/") + axes[axis],
+                             mesh.coordinates,
+                             mesh.pointCount,
+                             3,
+                             axis);
+      }
+
+      conduit_node_set_path_char8_str(grid, "topologies/mesh/type", "unstructured");
+      conduit_node_set_path_char8_str(grid, "topologies/mesh/coordset", "coords");
+      conduit_node_set_path_char8_str(grid, "topologies/mesh/elements/shape", "point");
+      conduit_node_set_path_external_int64_ptr(grid,
+                                               "topologies/mesh/elements/connectivity",
+                                               connectivity.empty()
+                                                 ? NULL
+                                                 : &connectivity[0],
+                                               connectivity.size());
+
+      for (std::vector<InSituArray>::const_iterator field = mesh.fields.begin();
+          field != mesh.fields.end(); ++field)
+      {
+        const std::string path = "fields/" + field->name;
+        conduit_node_set_path_char8_str(grid, (path + "/association").c_str(), "vertex");
+        conduit_node_set_path_char8_str(grid, (path + "/topology").c_str(), "mesh");
+        if (field->components == 1)
+        {
+          SetExternalComponent(grid, path + "/values", field->data, mesh.pointCount, 1, 0);
+        }
+        else
+        {
+          for (unsigned component = 0; component < field->components; ++component)
+          {
+            SetExternalComponent(grid,
+                                 path + "/values/" + axes[component],
+                                 field->data,
+                                 mesh.pointCount,
+                                 field->components,
+                                 component);
+          }
+        }
+      }
+
+      const enum catalyst_status status = catalyst_execute(execute);
+      conduit_node_destroy(execute);
+      if (status != catalyst_status_ok)
+      {
+        throw Exception() << "Catalyst failed at time step " << timeStep << ", with status "
+            << int(status);
+      }
+    }
+  }
+}
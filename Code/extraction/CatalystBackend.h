@@ -0,0 +1,45 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_EXTRACTION_CATALYSTBACKEND_H
+#define HEMELB_EXTRACTION_CATALYSTBACKEND_H
+
+#include <string>
+#include <vector>
+#include <catalyst.h>
+#include "extraction/InSituAdaptor.h"
+
+namespace hemelb
+{
+  namespace extraction
+  {
+    /**
+     * Runs a ParaView Catalyst pipeline script on the mesh, through the Catalyst 2 API. The mesh
+     * goes to the script's "grid" channel as a Conduit Blueprint unstructured mesh of points,
+     * with the coordinates and fields described in place rather than copied.
+     *
+     * Catalyst is initialised with the backend and finalised when it is deleted, so there should
+     * only be one at a time.
+     */
+    class CatalystBackend : public InSituBackend
+    {
+      public:
+        /**
+         * @param scriptPath The Catalyst Python script.
+         */
+        CatalystBackend(const std::string& scriptPath);
+
+        ~CatalystBackend();
+
+        void Execute(LatticeTimeStep timeStep, PhysicalTime time, const InSituMesh& mesh);
+
+      private:
+        //! Each point as a cell of its own, only remade when the number of points changes.
+        std::vector<conduit_int64> connectivity;
+    };
+  }
+}
+
+#endif /* HEMELB_EXTRACTION_CATALYSTBACKEND_H */
@@ -0,0 +1,223 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "extraction/FlightRecorder.h"
+#include "io/formats/formats.h"
+#include "io/writers/xdr/XdrMemWriter.h"
+#include "log/Logger.h"
+#include "net/MpiFile.h"
+
+namespace hemelb
+{
+  namespace extraction
+  {
+    FlightRecorder::FlightRecorder(const lb::SimulationState& simulationState,
+                                   IterableDataSource& dataSource,
+                                   const geometry::LatticeData& latticeData,
+                                   const net::IOCommunicator& ioComms, unsigned capacity,
+                                   unsigned long period, unsigned fields,
+                                   const geometry::SiteBox& region) :
+        simulationState(simulationState), dataSource(dataSource), latticeData(latticeData),
+            comms(ioComms), capacity(capacity), period(period), fields(fields),
+            valuesPerSite( (fields & io::formats::flightrecorder::PressureField ?
+              1 :
+              0) + (fields & io::formats::flightrecorder::VelocityField ?
+              3 :
+              0)),
+            numVectors(latticeData.GetLatticeInfo().GetNumVectors()),
+            samplingThisIteration(false), sampleCount(0), nextSlot(0)
+    {
+      for (site_t site = 0; site < latticeData.GetLocalFluidSiteCount(); ++site)
+      {
+        sites.push_back(site);
+        if (region.Contains(latticeData.GetSite(site).GetGlobalSiteCoords()))
+        {
+          regionSites.push_back(site);
+        }
+      }
+
+      sampleTimeSteps.resize(capacity);
+      siteValues.resize(size_t(capacity) * sites.size() * valuesPerSite);
+      regionValues.resize(size_t(capacity) * regionSites.size() * numVectors);
+
+      log::Logger::Log<log::Info, log::Singleton>("Flight recorder keeping %u samples, every %lu time steps, in %.1f MB on the IO core",
+                                                  capacity,
+                                                  period,
+                                                  GetMemoryUsage() / 1048576.0);
+    }
+
+    void FlightRecorder::SetRequiredProperties(lb::MacroscopicPropertyCache& propertyCache)
+    {
+      samplingThisIteration = period > 0 && simulationState.GetTimeStep() % period == 0;
+      if (samplingThisIteration)
+      {
+        if (fields & io::formats::flightrecorder::PressureField)
+        {
+          propertyCache.densityCache.SetRefreshFlag();
+        }
+        if (fields & io::formats::flightrecorder::VelocityField)
+        {
+          propertyCache.velocityCache.SetRefreshFlag();
+        }
+      }
+    }
+
+    bool FlightRecorder::SamplesThisIteration() const
+    {
+      return samplingThisIteration;
+    }
+
+    void FlightRecorder::EndIteration()
+    {
+      if (!samplingThisIteration)
+      {
+        return;
+      }
+
+      sampleTimeSteps[nextSlot] = simulationState.GetTimeStep();
+
+      // The fields of each site in turn, in the order of the Field bits.
+      float* slotValues = siteValues.empty() ?
+        NULL :
+        &siteValues[size_t(nextSlot) * sites.size() * valuesPerSite];
+      unsigned fieldOffset = 0;
+      if (fields & io::formats::flightrecorder::PressureField)
+      {
+        dataSource.GetField(OutputField::Pressure, sites, fieldValues);
+        for (size_t site = 0; site < sites.size(); ++site)
+        {
+          slotValues[site * valuesPerSite + fieldOffset] = fieldValues[site];
+        }
+        fieldOffset += 1;
+      }
+      if (fields & io::formats::flightrecorder::VelocityField)
+      {
+        dataSource.GetField(OutputField::Velocity, sites, fieldValues);
+        for (size_t site = 0; site < sites.size(); ++site)
+        {
+          for (unsigned component = 0; component < 3; ++component)
+          {
+            slotValues[site * valuesPerSite + fieldOffset + component] =
+                fieldValues[site * 3 + component];
+          }
+        }
+        fieldOffset += 3;
+      }
+
+      std::vector<distribn_t> fOld(numVectors);
+      for (size_t regionSite = 0; regionSite < regionSites.size(); ++regionSite)
+      {
+        const distribn_t* f =
+            latticeData.GetSite(regionSites[regionSite]).GetFOld(numVectors, &fOld[0]);
+        float* siteDistributions = &regionValues[ (size_t(nextSlot) * regionSites.size()
+            + regionSite) * numVectors];
+        for (unsigned direction = 0; direction < numVectors; ++direction)
+        {
+          siteDistributions[direction] = f[direction];
+        }
+      }
+
+      nextSlot = (nextSlot + 1) % capacity;
+      if (sampleCount < capacity)
+      {
+        ++sampleCount;
+      }
+    }
+
+    void FlightRecorder::Write(const std::string& path) const
+    {
+      const site_t localSites = sites.size();
+      const site_t localRegionSites = regionSites.size();
+      const site_t precedingSites = comms.ExScan(localSites, MPI_SUM);
+      const site_t totalSites = comms.AllReduce(localSites, MPI_SUM);
+      const site_t precedingRegionSites = comms.ExScan(localRegionSites, MPI_SUM);
+      const site_t totalRegionSites = comms.AllReduce(localRegionSites, MPI_SUM);
+
+      // Every core has the same number of samples, as they are all taken on the same steps.
+      const MPI_Offset siteRecordLength = 3 * 4 + MPI_Offset(sampleCount) * valuesPerSite * 4;
+      const MPI_Offset regionRecordLength = 3 * 4 + MPI_Offset(sampleCount) * numVectors * 4;
+      const MPI_Offset sitesOffset = io::formats::flightrecorder::PreambleLength
+          + MPI_Offset(sampleCount) * 8;
+      const MPI_Offset regionOffset = sitesOffset + MPI_Offset(totalSites) * siteRecordLength;
+
+      std::vector<char> siteRecords(localSites * siteRecordLength);
+      if (!siteRecords.empty())
+      {
+        io::writers::xdr::XdrMemWriter writer(&siteRecords[0], siteRecords.size());
+        for (site_t site = 0; site < localSites; ++site)
+        {
+          const util::Vector3D<site_t> position = latticeData.GetSite(sites[site]).GetGlobalSiteCoords();
+          writer << uint32_t(position.x) << uint32_t(position.y) << uint32_t(position.z);
+          for (unsigned sample = 0; sample < sampleCount; ++sample)
+          {
+            writer.WriteArray(&siteValues[ (size_t(GetSlot(sample)) * localSites + site)
+                                  * valuesPerSite],
+                              valuesPerSite);
+          }
+        }
+      }
+
+      std::vector<char> regionRecords(localRegionSites * regionRecordLength);
+      if (!regionRecords.empty())
+      {
+        io::writers::xdr::XdrMemWriter writer(&regionRecords[0], regionRecords.size());
+        for (site_t regionSite = 0; regionSite < localRegionSites; ++regionSite)
+        {
+          const util::Vector3D<site_t> position =
+              latticeData.GetSite(regionSites[regionSite]).GetGlobalSiteCoords();
+          writer << uint32_t(position.x) << uint32_t(position.y) << uint32_t(position.z);
+          for (unsigned sample = 0; sample < sampleCount; ++sample)
+          {
+            writer.WriteArray(&regionValues[ (size_t(GetSlot(sample)) * localRegionSites
+                                  + regionSite) * numVectors],
+                              numVectors);
+          }
+        }
+      }
+
+      net::MpiFile file = net::MpiFile::Open(comms, path, MPI_MODE_WRONLY | MPI_MODE_CREATE);
+      HEMELB_MPI_CALL(MPI_File_set_size, (file, 0));
+
+      if (comms.OnIORank())
+      {
+        std::vector<char> preamble(sitesOffset);
+        io::writers::xdr::XdrMemWriter writer(&preamble[0], preamble.size());
+        writer << uint32_t(io::formats::HemeLbMagicNumber)
+            << uint32_t(io::formats::flightrecorder::MagicNumber)
+            << uint32_t(io::formats::flightrecorder::VersionNumber) << uint32_t(fields)
+            << uint32_t(numVectors) << uint32_t(sampleCount)
+            << uint64_t(simulationState.GetTimeStep()) << uint64_t(totalSites)
+            << uint64_t(totalRegionSites);
+        for (unsigned sample = 0; sample < sampleCount; ++sample)
+        {
+          writer << uint64_t(sampleTimeSteps[GetSlot(sample)]);
+        }
+        file.WriteAt(0, preamble);
+      }
+
+      file.WriteAtAll(sitesOffset + MPI_Offset(precedingSites) * siteRecordLength, siteRecords);
+      file.WriteAtAll(regionOffset + MPI_Offset(precedingRegionSites) * regionRecordLength,
+                      regionRecords);
+      file.Close();
+
+      log::Logger::Log<log::Info, log::Singleton>("time step %lu, wrote the last %u samples of the flight recorder to %s",
+                                                  (unsigned long) simulationState.GetTimeStep(),
+                                                  sampleCount,
+                                                  path.c_str());
+    }
+
+    size_t FlightRecorder::GetMemoryUsage() const
+    {
+      return siteValues.size() * sizeof(float) + regionValues.size() * sizeof(float)
+          + sites.size() * sizeof(site_t) + regionSites.size() * sizeof(site_t)
+          + sampleTimeSteps.size() * sizeof(LatticeTimeStep);
+    }
+
+    unsigned FlightRecorder::GetSlot(unsigned sample) const
+    {
+      return (nextSlot + capacity - sampleCount + sample) % capacity;
+    }
+  }
+}
@@ -0,0 +1,124 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_EXTRACTION_FLIGHTRECORDER_H
+#define HEMELB_EXTRACTION_FLIGHTRECORDER_H
+
+#include <string>
+#include <vector>
+#include "extraction/IterableDataSource.h"
+#include "geometry/LatticeData.h"
+#include "geometry/SiteBox.h"
+#include "io/formats/flightrecorder.h"
+#include "lb/MacroscopicPropertyCache.h"
+#include "lb/SimulationState.h"
+#include "net/IOCommunicator.h"
+#include "net/IteratedAction.h"
+
+namespace hemelb
+{
+  namespace extraction
+  {
+    /**
+     * Keeps the last few samples of the pressure and velocity at every local site, and of the
+     * distributions of the sites in a region, in a ring buffer on each core, so that the run up
+     * to an instability can be looked at without extracting the whole domain all along.
+     *
+     * Sampling only copies the values into the buffer, as floats; nothing is communicated or
+     * written until Write is called, when the simulation goes unstable or the steering client
+     * asks for it, which writes every core's samples to one file (see
+     * io/formats/flightrecorder.h) with collective MPI-IO.
+     *
+     * The samples are of the local sites, so they start afresh whenever the sites are
+     * redistributed between the cores.
+     */
+    class FlightRecorder : public net::IteratedAction
+    {
+      public:
+        /**
+         * @param simulationState
+         * @param dataSource
+         * @param latticeData
+         * @param ioComms
+         * @param capacity The number of samples to keep.
+         * @param period The number of time steps between samples.
+         * @param fields The io::formats::flightrecorder::Field bits of the fields to keep at
+         * every site.
+         * @param region The sites to keep the distributions of, empty for none.
+         */
+        FlightRecorder(const lb::SimulationState& simulationState,
+                       IterableDataSource& dataSource, const geometry::LatticeData& latticeData,
+                       const net::IOCommunicator& ioComms, unsigned capacity,
+                       unsigned long period, unsigned fields, const geometry::SiteBox& region);
+
+        /**
+         * Set which properties will be required this iteration, deciding whether to sample on it.
+         * @param propertyCache
+         */
+        void SetRequiredProperties(lb::MacroscopicPropertyCache& propertyCache);
+
+        /**
+         * True if the fields are sampled on this iteration, as decided by SetRequiredProperties,
+         * which needs them at every site.
+         * @return
+         */
+        bool SamplesThisIteration() const;
+
+        /**
+         * Sample the fields, if they are sampled on this iteration.
+         */
+        void EndIteration();
+
+        /**
+         * Write the samples kept. Collective.
+         * @param path
+         */
+        void Write(const std::string& path) const;
+
+        /**
+         * Returns the bytes allocated for the samples.
+         * @return
+         */
+        size_t GetMemoryUsage() const;
+
+      private:
+        /**
+         * The slot in the ring buffer of the given sample, counting from the oldest kept.
+         * @param sample
+         * @return
+         */
+        unsigned GetSlot(unsigned sample) const;
+
+        const lb::SimulationState& simulationState;
+        IterableDataSource& dataSource;
+        const geometry::LatticeData& latticeData;
+        const net::IOCommunicator& comms;
+        const unsigned capacity;
+        const unsigned long period;
+        const unsigned fields;
+        const unsigned valuesPerSite;
+        const unsigned numVectors;
+        bool samplingThisIteration;
+        //! The index, in the data source's order, of every local site.
+        std::vector<site_t> sites;
+        //! The local sites in the region.
+        std::vector<site_t> regionSites;
+        //! The time step of each slot.
+        std::vector<LatticeTimeStep> sampleTimeSteps;
+        //! For each slot, the fields of each site in turn.
+        std::vector<float> siteValues;
+        //! For each slot, the distributions of each region site in turn.
+        std::vector<float> regionValues;
+        //! The number of samples kept so far, up to the capacity.
+        unsigned sampleCount;
+        //! The slot the next sample goes in.
+        unsigned nextSlot;
+        //! A buffer for the fields of the sites.
+        std::vector<FloatingType> fieldValues;
+    };
+  }
+}
+
+#endif /* HEMELB_EXTRACTION_FLIGHTRECORDER_H */
@@ -0,0 +1,291 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include "extraction/FlowDiagnosticsActor.h"
+#include "net/MpiDataType.h"
+#include "Exception.h"
+
+namespace hemelb
+{
+  namespace extraction
+  {
+    namespace
+    {
+      /**
+       * The area of a plane with the given unit normal each lattice link along an axis that
+       * crosses it stands for.
+       */
+      double AreaPerAxisLink(const util::Vector3D<double>& normal, PhysicalDistance voxelSize)
+      {
+        const double linksCut = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+        return linksCut > 0. ?
+          voxelSize * voxelSize / linksCut :
+          0.;
+      }
+    }
+
+    FlowDiagnosticsActor::FlowDiagnosticsActor(const lb::SimulationState& simulationState,
+                                               const FlowDiagnosticsFile* outputSpec,
+                                               IterableDataSource& dataSource,
+                                               const geometry::LatticeData& latticeData,
+                                               const std::vector<lb::iolets::InOutLet*>& inlets,
+                                               const std::vector<lb::iolets::InOutLet*>& outlets,
+                                               reporting::Timers& timers,
+                                               const net::IOCommunicator& ioComms) :
+        simulationState(simulationState), outputSpec(outputSpec), dataSource(&dataSource),
+            latticeData(&latticeData), iolets(inlets), inletCount(inlets.size()), timers(timers),
+            comms(ioComms), request(MPI_REQUEST_NULL), reducing(false), reducingStep(0),
+            reducingTime(0.)
+    {
+      iolets.insert(iolets.end(), outlets.begin(), outlets.end());
+      localSums.resize(iolets.size() * SumsPerIolet
+          + outputSpec->wallRegions.size() * SumsPerRegion);
+      totals.resize(localSums.size());
+
+      FindSites();
+
+      if (comms.OnIORank())
+      {
+        output.open(outputSpec->filename.c_str());
+        if (!output)
+        {
+          throw Exception() << "Could not open flow diagnostics file " << outputSpec->filename;
+        }
+        output << "step,time_s";
+        for (unsigned iolet = 0; iolet < iolets.size(); ++iolet)
+        {
+          const char* const kind = iolet < inletCount ?
+            "inlet" :
+            "outlet";
+          const unsigned number = iolet < inletCount ?
+            iolet :
+            iolet - inletCount;
+          output << ',' << kind << number << "_flow_m3_per_s," << kind << number
+              << "_pressure_mmHg";
+        }
+        for (unsigned region = 0; region < outputSpec->wallRegions.size(); ++region)
+        {
+          const std::string& name = outputSpec->wallRegions[region].name;
+          output << ',' << name << "_wss_integral_N," << name << "_wss_mean_Pa";
+        }
+        output << '\n';
+        output.precision(8);
+      }
+    }
+
+    void FlowDiagnosticsActor::FindSites()
+    {
+      ioletSites.clear();
+      wallSites.clear();
+      const PhysicalDistance voxelSize = dataSource->GetVoxelSize();
+      const PhysicalPosition& origin = dataSource->GetOrigin();
+
+      // The lattice's links along the axes.
+      const lb::lattices::LatticeInfo& lattice = latticeData->GetLatticeInfo();
+      std::vector<Direction> axisDirections;
+      for (Direction direction = 1; direction < lattice.GetNumVectors(); ++direction)
+      {
+        const util::Vector3D<int>& vector = lattice.GetVector(direction);
+        if (std::abs(vector.x) + std::abs(vector.y) + std::abs(vector.z) == 1)
+        {
+          axisDirections.push_back(direction);
+        }
+      }
+
+      for (site_t siteIndex = 0; siteIndex < latticeData->GetLocalFluidSiteCount(); ++siteIndex)
+      {
+        const geometry::Site<const geometry::LatticeData> site = latticeData->GetSite(siteIndex);
+        const geometry::SiteType type = site.GetSiteType();
+        if (type == geometry::INLET_TYPE || type == geometry::OUTLET_TYPE)
+        {
+          const unsigned iolet = site.GetIoletId() + (type == geometry::OUTLET_TYPE ?
+            inletCount :
+            0);
+          unsigned linksCut = 0;
+          for (size_t axis = 0; axis < axisDirections.size(); ++axis)
+          {
+            linksCut += site.HasIolet(axisDirections[axis]);
+          }
+          if (linksCut > 0 && iolet < iolets.size())
+          {
+            WeightedSite ioletSite;
+            ioletSite.site = siteIndex;
+            ioletSite.index = iolet;
+            ioletSite.area = linksCut
+                * AreaPerAxisLink(util::Vector3D<double>(iolets[iolet]->GetNormal()), voxelSize);
+            ioletSites.push_back(ioletSite);
+          }
+        }
+
+        if (outputSpec->wallRegions.empty())
+        {
+          continue;
+        }
+        dataSource->ReadAt(siteIndex);
+        const util::Vector3D<site_t> location = dataSource->GetPosition();
+        if (!dataSource->IsWallSite(location))
+        {
+          continue;
+        }
+        const PhysicalPosition position(origin.x + location.x * voxelSize,
+                                        origin.y + location.y * voxelSize,
+                                        origin.z + location.z * voxelSize);
+        for (unsigned region = 0; region < outputSpec->wallRegions.size(); ++region)
+        {
+          const FlowDiagnosticsFile::WallRegion& box = outputSpec->wallRegions[region];
+          if (position.x < box.minimum.x || position.y < box.minimum.y
+              || position.z < box.minimum.z || position.x > box.maximum.x
+              || position.y > box.maximum.y || position.z > box.maximum.z)
+          {
+            continue;
+          }
+          WeightedSite wallSite;
+          wallSite.site = siteIndex;
+          wallSite.index = region;
+          wallSite.area = AreaPerAxisLink(util::Vector3D<double>(dataSource->GetWallNormal()),
+                                          voxelSize);
+          wallSites.push_back(wallSite);
+        }
+      }
+
+      // Both lists are in site order, so their union is too.
+      ioletSiteIndices.clear();
+      for (size_t site = 0; site < ioletSites.size(); ++site)
+      {
+        ioletSiteIndices.push_back(ioletSites[site].site);
+      }
+      wallSiteIndices.clear();
+      for (size_t site = 0; site < wallSites.size(); ++site)
+      {
+        wallSiteIndices.push_back(wallSites[site].site);
+      }
+      sites.clear();
+      std::set_union(ioletSiteIndices.begin(),
+                     ioletSiteIndices.end(),
+                     wallSiteIndices.begin(),
+                     wallSiteIndices.end(),
+                     std::back_inserter(sites));
+      sites.erase(std::unique(sites.begin(), sites.end()), sites.end());
+    }
+
+    bool FlowDiagnosticsActor::ShouldSample(unsigned long timestepNumber) const
+    {
+      return timestepNumber % outputSpec->period == 0;
+    }
+
+    void FlowDiagnosticsActor::SetRequiredProperties(lb::MacroscopicPropertyCache& propertyCache)
+    {
+      if (!ShouldSample(simulationState.GetTimeStep()))
+      {
+        return;
+      }
+      if (!ioletSites.empty())
+      {
+        propertyCache.densityCache.SetRefreshFlag();
+        propertyCache.velocityCache.SetRefreshFlag();
+      }
+      if (!wallSites.empty())
+      {
+        propertyCache.wallShearStressMagnitudeCache.SetRefreshFlag();
+      }
+    }
+
+    void FlowDiagnosticsActor::SetDataSource(IterableDataSource& newDataSource,
+                                             const geometry::LatticeData& newLatticeData)
+    {
+      Flush();
+      dataSource = &newDataSource;
+      latticeData = &newLatticeData;
+      FindSites();
+    }
+
+    void FlowDiagnosticsActor::EndIteration()
+    {
+      timers[reporting::Timers::extractionWriting].Start();
+      // The last reduction has had a step to get done in.
+      Flush();
+      if (ShouldSample(simulationState.GetTimeStep()))
+      {
+        StartReduction();
+      }
+      timers[reporting::Timers::extractionWriting].Stop();
+    }
+
+    void FlowDiagnosticsActor::StartReduction()
+    {
+      localSums.assign(localSums.size(), 0.);
+
+      std::vector<FloatingType> pressures, velocities;
+      dataSource->GetField(OutputField::Pressure, ioletSiteIndices, pressures);
+      dataSource->GetField(OutputField::Velocity, ioletSiteIndices, velocities);
+      for (size_t site = 0; site < ioletSites.size(); ++site)
+      {
+        const WeightedSite& ioletSite = ioletSites[site];
+        const util::Vector3D<Dimensionless>& normal = iolets[ioletSite.index]->GetNormal();
+        const FloatingType* const velocity = &velocities[3 * site];
+        double* const sums = &localSums[ioletSite.index * SumsPerIolet];
+        sums[0] += ioletSite.area
+            * (velocity[0] * normal.x + velocity[1] * normal.y + velocity[2] * normal.z);
+        sums[1] += ioletSite.area * pressures[site];
+        sums[2] += ioletSite.area;
+      }
+
+      std::vector<FloatingType> stresses;
+      dataSource->GetField(OutputField::ShearStress, wallSiteIndices, stresses);
+      double* const regionSums = &localSums[iolets.size() * SumsPerIolet];
+      for (size_t site = 0; site < wallSites.size(); ++site)
+      {
+        double* const sums = regionSums + wallSites[site].index * SumsPerRegion;
+        sums[0] += wallSites[site].area * stresses[site];
+        sums[1] += wallSites[site].area;
+      }
+
+      if (localSums.empty())
+      {
+        return;
+      }
+      HEMELB_MPI_CALL(MPI_Ireduce,
+                      (&localSums[0], &totals[0], int(localSums.size()), net::MpiDataType<double>(),
+                       MPI_SUM, comms.GetIORank(), comms, &request));
+      reducing = true;
+      reducingStep = simulationState.GetTimeStep();
+      reducingTime = simulationState.GetTime();
+    }
+
+    void FlowDiagnosticsActor::Flush()
+    {
+      if (!reducing)
+      {
+        return;
+      }
+      HEMELB_MPI_CALL(MPI_Wait, (&request, MPI_STATUS_IGNORE));
+      reducing = false;
+
+      if (comms.OnIORank())
+      {
+        output << reducingStep << ',' << reducingTime;
+        for (unsigned iolet = 0; iolet < iolets.size(); ++iolet)
+        {
+          const double* const sums = &totals[iolet * SumsPerIolet];
+          output << ',' << sums[0] << ',' << (sums[2] > 0. ?
+            sums[1] / sums[2] :
+            0.);
+        }
+        for (unsigned region = 0; region < outputSpec->wallRegions.size(); ++region)
+        {
+          const double* const sums = &totals[iolets.size() * SumsPerIolet + region * SumsPerRegion];
+          output << ',' << sums[0] << ',' << (sums[1] > 0. ?
+            sums[0] / sums[1] :
+            0.);
+        }
+        output << '\n';
+        output.flush();
+      }
+    }
+  }
+}
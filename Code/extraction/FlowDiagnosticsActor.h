@@ -0,0 +1,158 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_EXTRACTION_FLOWDIAGNOSTICSACTOR_H
+#define HEMELB_EXTRACTION_FLOWDIAGNOSTICSACTOR_H
+
+#include <fstream>
+#include <vector>
+#include "extraction/FlowDiagnosticsFile.h"
+#include "extraction/IterableDataSource.h"
+#include "geometry/LatticeData.h"
+#include "lb/iolets/InOutLet.h"
+#include "lb/MacroscopicPropertyCache.h"
+#include "lb/SimulationState.h"
+#include "net/IOCommunicator.h"
+#include "net/IteratedAction.h"
+#include "reporting/Timers.h"
+
+namespace hemelb
+{
+  namespace extraction
+  {
+    /**
+     * Records the flow rate and area-weighted mean pressure at each iolet, and the wall shear
+     * stress integrated over each wall region, every period steps, without writing planes of
+     * sites out.
+     *
+     * The sites and their areas are found once: the sites of each iolet are those the
+     * lattice data gives its iolet id, and each stands for the area of the iolet plane
+     * crossed by its axis-aligned iolet links (a plane with unit normal n cuts |n_x| + |n_y| +
+     * |n_z| such links per voxel face of its area). The wall sites take their area from their
+     * wall normal in the same way. Each period, every core sums its sites' weighted values,
+     * and one non-blocking reduction takes the sums to the IO core. It is finished on the next
+     * step, and the IO core appends a line to the file: the time step, the time (s), then for
+     * the inlets and then the outlets the flow rate (m^3/s, along the iolet's normal) and mean
+     * pressure (mmHg), then for each region the integrated (N) and mean (Pa) wall shear
+     * stress.
+     */
+    class FlowDiagnosticsActor : public net::IteratedAction
+    {
+      public:
+        /**
+         * Find the sites and their areas and open the file. Collective.
+         * @param simulationState
+         * @param outputSpec
+         * @param dataSource
+         * @param latticeData The lattice the data source reads from.
+         * @param inlets
+         * @param outlets
+         * @param timers
+         * @param ioComms
+         */
+        FlowDiagnosticsActor(const lb::SimulationState& simulationState,
+                             const FlowDiagnosticsFile* outputSpec, IterableDataSource& dataSource,
+                             const geometry::LatticeData& latticeData,
+                             const std::vector<lb::iolets::InOutLet*>& inlets,
+                             const std::vector<lb::iolets::InOutLet*>& outlets,
+                             reporting::Timers& timers, const net::IOCommunicator& ioComms);
+
+        /**
+         * True if the diagnostics are computed on the given time step.
+         * @param timestepNumber
+         * @return
+         */
+        bool ShouldSample(unsigned long timestepNumber) const;
+
+        /**
+         * Set which properties will be required this iteration.
+         * @param propertyCache
+         */
+        void SetRequiredProperties(lb::MacroscopicPropertyCache& propertyCache);
+
+        /**
+         * Returns the indices, in the data source's order, of the local sites read, in
+         * ascending order.
+         * @return
+         */
+        const std::vector<site_t>& GetSites() const
+        {
+          return sites;
+        }
+
+        /**
+         * Read from a new data source and lattice, once the sites have been redistributed
+         * between the cores. Collective.
+         * @param newDataSource
+         * @param newLatticeData
+         */
+        void SetDataSource(IterableDataSource& newDataSource,
+                           const geometry::LatticeData& newLatticeData);
+
+        /**
+         * Finish the reduction in progress, if there is one, and write its line. Collective.
+         */
+        void Flush();
+
+        /**
+         * Finish the last step's reduction, and start this step's if it is due.
+         */
+        void EndIteration();
+
+      private:
+        //! The sums for each iolet: the flow rate, area-weighted pressure and area.
+        static const unsigned SumsPerIolet = 3;
+        //! The sums for each region: the integrated wall shear stress and the area.
+        static const unsigned SumsPerRegion = 2;
+
+        /**
+         * A local site and the area it stands for in an iolet or region.
+         */
+        struct WeightedSite
+        {
+            site_t site;
+            unsigned index;
+            double area;
+        };
+
+        /**
+         * Find the local sites of each iolet and region and their areas.
+         */
+        void FindSites();
+
+        /**
+         * Start summing this step's values onto the IO core.
+         */
+        void StartReduction();
+
+        const lb::SimulationState& simulationState;
+        const FlowDiagnosticsFile* outputSpec;
+        IterableDataSource* dataSource;
+        const geometry::LatticeData* latticeData;
+        //! The inlets then the outlets.
+        std::vector<lb::iolets::InOutLet*> iolets;
+        const unsigned inletCount;
+        reporting::Timers& timers;
+        const net::IOCommunicator& comms;
+        std::vector<WeightedSite> ioletSites;
+        std::vector<WeightedSite> wallSites;
+        //! The data source's indices of each of ioletSites and wallSites.
+        std::vector<site_t> ioletSiteIndices;
+        std::vector<site_t> wallSiteIndices;
+        std::vector<site_t> sites;
+        //! The local sums and, on the IO core, the totals, of the reduction in progress.
+        std::vector<double> localSums;
+        std::vector<double> totals;
+        MPI_Request request;
+        bool reducing;
+        LatticeTimeStep reducingStep;
+        PhysicalTime reducingTime;
+        //! The output file, on the IO core.
+        std::ofstream output;
+    };
+  }
+}
+
+#endif /* HEMELB_EXTRACTION_FLOWDIAGNOSTICSACTOR_H */
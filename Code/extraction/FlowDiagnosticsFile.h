@@ -0,0 +1,47 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_EXTRACTION_FLOWDIAGNOSTICSFILE_H
+#define HEMELB_EXTRACTION_FLOWDIAGNOSTICSFILE_H
+
+#include <string>
+#include <vector>
+#include "units.h"
+
+namespace hemelb
+{
+  namespace extraction
+  {
+    /**
+     * A CSV time series of the flow rate and mean pressure at each iolet, and the wall shear
+     * stress integrated over each of a few regions of the wall.
+     */
+    struct FlowDiagnosticsFile
+    {
+        /**
+         * An axis-aligned box of the wall to integrate the wall shear stress over.
+         */
+        struct WallRegion
+        {
+            std::string name;
+            //! The corners of the box, in metres.
+            PhysicalPosition minimum;
+            PhysicalPosition maximum;
+        };
+
+        FlowDiagnosticsFile()
+        {
+          period = 100;
+        }
+
+        std::string filename;
+        //! How often to compute the diagnostics, in time steps.
+        unsigned long period;
+        std::vector<WallRegion> wallRegions;
+    };
+  }
+}
+
+#endif /* HEMELB_EXTRACTION_FLOWDIAGNOSTICSFILE_H */
@@ -7,6 +7,7 @@
 #ifndef HEMELB_EXTRACTION_GEOMETRYSELECTORS_H
 #define HEMELB_EXTRACTION_GEOMETRYSELECTORS_H
 
+#include "extraction/BoxGeometrySelector.h"
 #include "extraction/StraightLineGeometrySelector.h"
 #include "extraction/PlaneGeometrySelector.h"
 #include "extraction/WholeGeometrySelector.h"
@@ -0,0 +1,286 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <fstream>
+#include <map>
+#include <sstream>
+#include "extraction/Hdf5OutputFile.h"
+#include "net/mpi.h"
+#include "Exception.h"
+
+namespace hemelb
+{
+  namespace extraction
+  {
+    namespace
+    {
+      /**
+       * HDF5 returns a negative value on failure.
+       * @param result
+       * @param what What was being done, for the exception.
+       * @return The result.
+       */
+      template<typename T>
+      T Check(T result, const std::string& what)
+      {
+        if (result < 0)
+        {
+          throw Exception() << "HDF5 failed to " << what;
+        }
+        return result;
+      }
+
+      /**
+       * Write a one dimensional attribute. Collective.
+       * @param location The object to attach it to.
+       * @param name
+       * @param fileType
+       * @param memoryType
+       * @param count
+       * @param data
+       */
+      void WriteAttribute(hid_t location, const char* name, hid_t fileType, hid_t memoryType,
+                          hsize_t count, const void* data)
+      {
+        const hid_t space = Check(H5Screate_simple(1, &count, NULL), "create a dataspace");
+        const hid_t attribute = Check(H5Acreate2(location, name, fileType, space, H5P_DEFAULT,
+                                                 H5P_DEFAULT),
+                                      std::string("create attribute ") + name);
+        Check(H5Awrite(attribute, memoryType, data), std::string("write attribute ") + name);
+        H5Aclose(attribute);
+        H5Sclose(space);
+      }
+
+      const char* GetXdmfAttributeType(unsigned length)
+      {
+        switch (length)
+        {
+          case 1:
+            return "Scalar";
+          case 3:
+            return "Vector";
+          case 6:
+            return "Tensor6";
+          default:
+            return "Matrix";
+        }
+      }
+    }
+
+    Hdf5OutputFile::Hdf5OutputFile(const PropertyOutputFile* outputSpec,
+                                   const std::vector<unsigned>& fieldLengths,
+                                   const std::vector<double>& fieldOffsets,
+                                   PhysicalDistance voxelSize, const PhysicalPosition& origin,
+                                   const net::IOCommunicator& comms) :
+        outputSpec(outputSpec), fieldLengths(fieldLengths), fieldOffsets(fieldOffsets),
+            voxelSize(voxelSize), origin(origin), comms(comms), siteLists(0), siteCount(0),
+            precedingSites(0), localSites(0)
+    {
+      // Open the file through MPI-IO, with the same hints as the XDR output would have.
+      MPI_Info info;
+      HEMELB_MPI_CALL(MPI_Info_create, (&info));
+      for (std::map<std::string, std::string>::const_iterator hint = outputSpec->ioHints.begin();
+          hint != outputSpec->ioHints.end(); ++hint)
+      {
+        HEMELB_MPI_CALL(MPI_Info_set,
+                        (info, net::MpiConstCast(hint->first.c_str()), net::MpiConstCast(hint->second.c_str())));
+      }
+      const hid_t access = Check(H5Pcreate(H5P_FILE_ACCESS), "create file access properties");
+      Check(H5Pset_fapl_mpio(access, comms, info), "set up MPI-IO file access");
+      // As for the XDR output, don't overwrite an existing file.
+      file = Check(H5Fcreate(outputSpec->filename.c_str(), H5F_ACC_EXCL, H5P_DEFAULT, access),
+                   "create " + outputSpec->filename);
+      H5Pclose(access);
+      HEMELB_MPI_CALL(MPI_Info_free, (&info));
+
+      collectiveTransfer = Check(H5Pcreate(H5P_DATASET_XFER), "create transfer properties");
+      Check(H5Pset_dxpl_mpio(collectiveTransfer, H5FD_MPIO_COLLECTIVE),
+            "set up collective transfers");
+
+      const double voxel = voxelSize;
+      const double originValues[3] = { origin.x, origin.y, origin.z };
+      WriteAttribute(file, "voxelSize", H5T_IEEE_F64LE, H5T_NATIVE_DOUBLE, 1, &voxel);
+      WriteAttribute(file, "origin", H5T_IEEE_F64LE, H5T_NATIVE_DOUBLE, 3, originValues);
+
+      H5Gclose(Check(H5Gcreate2(file, "sites", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT),
+                     "create the sites group"));
+      H5Gclose(Check(H5Gcreate2(file, "steps", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT),
+                     "create the steps group"));
+    }
+
+    Hdf5OutputFile::~Hdf5OutputFile()
+    {
+      H5Pclose(collectiveTransfer);
+      H5Fclose(file);
+    }
+
+    void Hdf5OutputFile::WriteSites(const std::vector<util::Vector3D<site_t> >& positions)
+    {
+      localSites = positions.size();
+      precedingSites = comms.ExScan(localSites, MPI_SUM);
+      siteCount = comms.AllReduce(localSites, MPI_SUM);
+
+      std::vector<uint32_t> grid(3 * localSites);
+      std::vector<double> coordinates(3 * localSites);
+      for (size_t site = 0; site < positions.size(); ++site)
+      {
+        for (unsigned axis = 0; axis < 3; ++axis)
+        {
+          grid[3 * site + axis] = uint32_t(positions[site][axis]);
+          coordinates[3 * site + axis] = origin[axis] + voxelSize * positions[site][axis];
+        }
+      }
+
+      std::ostringstream name;
+      name << "sites/" << siteLists;
+      const hid_t group = Check(H5Gcreate2(file, name.str().c_str(), H5P_DEFAULT, H5P_DEFAULT,
+                                           H5P_DEFAULT),
+                                "create group " + name.str());
+      H5Dclose(WriteDataset(group, "grid", H5T_STD_U32LE, H5T_NATIVE_UINT32, 3, grid.empty()
+        ? NULL
+        : &grid[0]));
+      H5Dclose(WriteDataset(group, "coordinates", H5T_IEEE_F64LE, H5T_NATIVE_DOUBLE, 3,
+                            coordinates.empty()
+                              ? NULL
+                              : &coordinates[0]));
+      H5Gclose(group);
+
+      siteListSizes.push_back(siteCount);
+      ++siteLists;
+    }
+
+    void Hdf5OutputFile::WriteStep(unsigned long timestepNumber, const std::vector<float>& values)
+    {
+      std::ostringstream name;
+      name << "steps/" << timestepNumber;
+      const hid_t group = Check(H5Gcreate2(file, name.str().c_str(), H5P_DEFAULT, H5P_DEFAULT,
+                                           H5P_DEFAULT),
+                                "create group " + name.str());
+      const uint32_t siteList = siteLists - 1;
+      WriteAttribute(group, "sites", H5T_STD_U32LE, H5T_NATIVE_UINT32, 1, &siteList);
+
+      unsigned valuesPerSite = 0;
+      for (unsigned field = 0; field < fieldLengths.size(); ++field)
+      {
+        valuesPerSite += fieldLengths[field];
+      }
+
+      // Each field is a dataset of its own, so pick its values out of each site's.
+      unsigned firstValue = 0;
+      std::vector<float> fieldValues;
+      for (unsigned field = 0; field < fieldLengths.size(); ++field)
+      {
+        fieldValues.resize(fieldLengths[field] * localSites);
+        for (size_t site = 0; site < localSites; ++site)
+        {
+          for (unsigned value = 0; value < fieldLengths[field]; ++value)
+          {
+            fieldValues[site * fieldLengths[field] + value] = values[site * valuesPerSite
+                + firstValue + value];
+          }
+        }
+        firstValue += fieldLengths[field];
+
+        const hid_t dataset = WriteDataset(group, outputSpec->fields[field].name, H5T_IEEE_F32LE,
+                                           H5T_NATIVE_FLOAT, fieldLengths[field],
+                                           fieldValues.empty()
+                                             ? NULL
+                                             : &fieldValues[0]);
+        WriteAttribute(dataset, "offset", H5T_IEEE_F64LE, H5T_NATIVE_DOUBLE, 1,
+                       &fieldOffsets[field]);
+        H5Dclose(dataset);
+      }
+      H5Gclose(group);
+
+      // Make sure the data are all in the file before the XDMF points to them.
+      Check(H5Fflush(file, H5F_SCOPE_GLOBAL), "flush " + outputSpec->filename);
+      stepTimes.push_back(timestepNumber);
+      stepSiteLists.push_back(siteList);
+      if (comms.OnIORank())
+      {
+        WriteXdmf();
+      }
+    }
+
+    hid_t Hdf5OutputFile::WriteDataset(hid_t location, const std::string& name, hid_t fileType,
+                                       hid_t memoryType, unsigned columns, const void* data)
+    {
+      const hsize_t dimensions[2] = { siteCount, columns };
+      const hid_t fileSpace = Check(H5Screate_simple(2, dimensions, NULL), "create a dataspace");
+      const hid_t dataset = Check(H5Dcreate2(location, name.c_str(), fileType, fileSpace,
+                                             H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT),
+                                  "create dataset " + name);
+
+      // Every core takes part in the collective write, even with nothing to write.
+      const hsize_t start[2] = { precedingSites, 0 };
+      const hsize_t count[2] = { localSites, columns };
+      hid_t memorySpace;
+      if (localSites > 0)
+      {
+        memorySpace = Check(H5Screate_simple(2, count, NULL), "create a dataspace");
+        Check(H5Sselect_hyperslab(fileSpace, H5S_SELECT_SET, start, NULL, count, NULL),
+              "select this core's part of " + name);
+      }
+      else
+      {
+        memorySpace = Check(H5Scopy(fileSpace), "create a dataspace");
+        H5Sselect_none(memorySpace);
+        H5Sselect_none(fileSpace);
+      }
+
+      // HDF5 wants a buffer even when there is nothing in it.
+      const char nothing = 0;
+      Check(H5Dwrite(dataset, memoryType, memorySpace, fileSpace, collectiveTransfer, localSites > 0
+                       ? data
+                       : &nothing),
+            "write dataset " + name);
+
+      H5Sclose(memorySpace);
+      H5Sclose(fileSpace);
+      return dataset;
+    }
+
+    void Hdf5OutputFile::WriteXdmf() const
+    {
+      // The XDMF refers to the HDF5 file relative to itself.
+      const std::string::size_type slash = outputSpec->filename.rfind('/');
+      const std::string dataFile = slash == std::string::npos
+        ? outputSpec->filename
+        : outputSpec->filename.substr(slash + 1);
+
+      std::ofstream xdmf( (outputSpec->filename + ".xmf").c_str());
+      xdmf << "<?xml version=\"1.0\" ?>\n"
+          << "<Xdmf Version=\"3.0\">\n"
+          << "  <Domain>\n"
+          << "    <Grid Name=\"" << dataFile << "\" GridType=\"Collection\" CollectionType=\"Temporal\">\n";
+      for (size_t step = 0; step < stepTimes.size(); ++step)
+      {
+        const uint64_t sites = siteListSizes[stepSiteLists[step]];
+        xdmf << "      <Grid Name=\"" << stepTimes[step] << "\" GridType=\"Uniform\">\n"
+            << "        <Time Value=\"" << stepTimes[step] << "\"/>\n"
+            << "        <Topology TopologyType=\"Polyvertex\" NumberOfElements=\"" << sites
+            << "\" NodesPerElement=\"1\"/>\n"
+            << "        <Geometry GeometryType=\"XYZ\">\n"
+            << "          <DataItem Dimensions=\"" << sites << " 3\" NumberType=\"Float\" Precision=\"8\" Format=\"HDF\">"
+            << dataFile << ":/sites/" << stepSiteLists[step] << "/coordinates</DataItem>\n"
+            << "        </Geometry>\n";
+        for (unsigned field = 0; field < fieldLengths.size(); ++field)
+        {
+          const std::string& name = outputSpec->fields[field].name;
+          xdmf << "        <Attribute Name=\"" << name << "\" AttributeType=\""
+              << GetXdmfAttributeType(fieldLengths[field]) << "\" Center=\"Node\">\n"
+              << "          <DataItem Dimensions=\"" << sites << " " << fieldLengths[field]
+              << "\" NumberType=\"Float\" Precision=\"4\" Format=\"HDF\">" << dataFile
+              << ":/steps/" << stepTimes[step] << "/" << name << "</DataItem>\n"
+              << "        </Attribute>\n";
+        }
+        xdmf << "      </Grid>\n";
+      }
+      xdmf << "    </Grid>\n"
+          << "  </Domain>\n"
+          << "</Xdmf>\n";
+    }
+  }
+}
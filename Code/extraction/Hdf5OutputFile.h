@@ -0,0 +1,119 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_EXTRACTION_HDF5OUTPUTFILE_H
+#define HEMELB_EXTRACTION_HDF5OUTPUTFILE_H
+
+#include <string>
+#include <vector>
+#include <hdf5.h>
+#include "extraction/PropertyOutputFile.h"
+#include "net/IOCommunicator.h"
+#include "units.h"
+#include "util/Vector3D.h"
+
+namespace hemelb
+{
+  namespace extraction
+  {
+    /**
+     * Writes property output as parallel HDF5, with an XDMF description of it alongside, so
+     * that it can be read in parallel by ParaView, VisIt and h5py rather than through the
+     * extraction file parser.
+     *
+     * The file holds:
+     *  * /sites/<n>/grid - The lattice position of each site (uint32, sites x 3).
+     *  * /sites/<n>/coordinates - The physical position of each site (double, sites x 3).
+     *  * /steps/<time step>/<field name> - The field's values at each site (float, sites x the
+     *    field's length), in the order of the site list given by the "sites" attribute of the
+     *    step's group. The "offset" attribute of each is to be added to its values, as in the
+     *    extraction format.
+     * There is a new site list before the first step after the sites move between the cores.
+     * The root group has the voxel size and origin as attributes.
+     *
+     * The XDMF file, the HDF5 file name with ".xmf" after it, has a time series of point sets,
+     * one for each step, and is rewritten after each so that it is always whole.
+     */
+    class Hdf5OutputFile
+    {
+      public:
+        /**
+         * Create the file. Collective.
+         * @param outputSpec
+         * @param fieldLengths The number of values of each field at each site.
+         * @param fieldOffsets The offset to add to the values of each field.
+         * @param voxelSize
+         * @param origin
+         * @param comms
+         */
+        Hdf5OutputFile(const PropertyOutputFile* outputSpec,
+                       const std::vector<unsigned>& fieldLengths,
+                       const std::vector<double>& fieldOffsets, PhysicalDistance voxelSize,
+                       const PhysicalPosition& origin, const net::IOCommunicator& comms);
+
+        /**
+         * Close the file. Collective.
+         */
+        ~Hdf5OutputFile();
+
+        /**
+         * Write a new list of the sites, which the following steps' values are in the order of.
+         * Collective.
+         * @param positions The lattice positions of the local sites.
+         */
+        void WriteSites(const std::vector<util::Vector3D<site_t> >& positions);
+
+        /**
+         * Write a step's values. Collective.
+         * @param timestepNumber
+         * @param values The field values of each local site, one after another, in the order of
+         * the last site list.
+         */
+        void WriteStep(unsigned long timestepNumber, const std::vector<float>& values);
+
+      private:
+        /**
+         * Create a two dimensional dataset, with each core's part a run of its rows, and write
+         * the local rows to it. Collective.
+         * @param location The group to create it in.
+         * @param name
+         * @param fileType The HDF5 type to store it as.
+         * @param memoryType The HDF5 type of the data.
+         * @param columns
+         * @param data The local rows.
+         * @return The dataset, for the caller to close.
+         */
+        hid_t WriteDataset(hid_t location, const std::string& name, hid_t fileType,
+                           hid_t memoryType, unsigned columns, const void* data);
+
+        /**
+         * Rewrite the XDMF description of the steps so far, on the IO core.
+         */
+        void WriteXdmf() const;
+
+        const PropertyOutputFile* outputSpec;
+        const std::vector<unsigned> fieldLengths;
+        const std::vector<double> fieldOffsets;
+        const PhysicalDistance voxelSize;
+        const PhysicalPosition origin;
+        const net::IOCommunicator& comms;
+        hid_t file;
+        //! The transfer properties for collective writes.
+        hid_t collectiveTransfer;
+        //! The number of site lists so far.
+        unsigned siteLists;
+        //! The number of sites in the current list, in total, on the lower ranks and here.
+        uint64_t siteCount;
+        uint64_t precedingSites;
+        uint64_t localSites;
+        //! The time step and site list of each step written, and the size of each list.
+        std::vector<unsigned long> stepTimes;
+        std::vector<unsigned> stepSiteLists;
+        std::vector<uint64_t> siteListSizes;
+    };
+  }
+}
+
+#endif /* HEMELB_EXTRACTION_HDF5OUTPUTFILE_H */
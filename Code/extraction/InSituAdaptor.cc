@@ -0,0 +1,107 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "extraction/InSituAdaptor.h"
+#include "Exception.h"
+
+namespace hemelb
+{
+  namespace extraction
+  {
+    InSituAdaptor::InSituAdaptor(const lb::SimulationState& simulationState,
+                                 const geometry::LatticeData& latticeData,
+                                 const lb::MacroscopicPropertyCache& propertyCache,
+                                 const util::UnitConverter& unitConverter,
+                                 InSituBackend* backend, unsigned period,
+                                 reporting::Timers& timers) :
+        simulationState(simulationState), latticeData(&latticeData),
+            propertyCache(&propertyCache), unitConverter(unitConverter), backend(backend),
+            period(period), timers(timers)
+    {
+      if (period == 0)
+      {
+        throw Exception() << "The in situ period must be positive";
+      }
+      CalculateCoordinates();
+    }
+
+    InSituAdaptor::~InSituAdaptor()
+    {
+      delete backend;
+    }
+
+    void InSituAdaptor::SetLatticeData(const geometry::LatticeData& newLatticeData,
+                                       const lb::MacroscopicPropertyCache& newPropertyCache)
+    {
+      latticeData = &newLatticeData;
+      propertyCache = &newPropertyCache;
+      CalculateCoordinates();
+    }
+
+    void InSituAdaptor::CalculateCoordinates()
+    {
+      const site_t siteCount = latticeData->GetLocalFluidSiteCount();
+      coordinates.resize(3 * siteCount);
+      for (site_t site = 0; site < siteCount; ++site)
+      {
+        const util::Vector3D<site_t> siteCoords = latticeData->GetSite(site).GetGlobalSiteCoords();
+        const PhysicalPosition position =
+            unitConverter.ConvertPositionToPhysicalUnits(LatticePosition(siteCoords));
+        coordinates[3 * site] = position.x;
+        coordinates[3 * site + 1] = position.y;
+        coordinates[3 * site + 2] = position.z;
+      }
+    }
+
+    bool InSituAdaptor::RunsThisIteration() const
+    {
+      return simulationState.Get0IndexedTimeStep() % period == 0;
+    }
+
+    void InSituAdaptor::SetRequiredProperties(lb::MacroscopicPropertyCache& propertyCache)
+    {
+      if (RunsThisIteration())
+      {
+        propertyCache.densityCache.SetRefreshFlag();
+        propertyCache.velocityCache.SetRefreshFlag();
+      }
+    }
+
+    void InSituAdaptor::EndIteration()
+    {
+      // The step manager only calls this on every period-th step.
+      timers[reporting::Timers::inSitu].Start();
+
+      InSituMesh mesh;
+      mesh.pointCount = latticeData->GetLocalFluidSiteCount();
+      mesh.coordinates = mesh.pointCount == 0
+        ? NULL
+        : &coordinates[0];
+
+      const distribn_t* density = propertyCache->densityCache.GetData();
+      const util::Vector3D<distribn_t>* velocity = propertyCache->velocityCache.GetData();
+      if (mesh.pointCount > 0 && (density == NULL || velocity == NULL))
+      {
+        throw Exception() << "The property cache must hold every site when the in situ backend runs";
+      }
+
+      InSituArray field;
+      field.name = "density";
+      field.data = density;
+      field.components = 1;
+      mesh.fields.push_back(field);
+      // A Vector3D is just its three components, so the velocities are an array of them.
+      field.name = "velocity";
+      field.data = mesh.pointCount == 0
+        ? NULL
+        : &velocity->x;
+      field.components = 3;
+      mesh.fields.push_back(field);
+
+      backend->Execute(simulationState.GetTimeStep(), simulationState.GetTime(), mesh);
+      timers[reporting::Timers::inSitu].Stop();
+    }
+  }
+}
@@ -0,0 +1,142 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_EXTRACTION_INSITUADAPTOR_H
+#define HEMELB_EXTRACTION_INSITUADAPTOR_H
+
+#include <string>
+#include <vector>
+#include "geometry/LatticeData.h"
+#include "lb/MacroscopicPropertyCache.h"
+#include "lb/SimulationState.h"
+#include "net/IteratedAction.h"
+#include "reporting/Timers.h"
+#include "util/UnitConverter.h"
+
+namespace hemelb
+{
+  namespace extraction
+  {
+    /**
+     * An array of values at the points of an InSituMesh, held by someone else. The components
+     * of each point's value are next to each other, so component c of point i is at
+     * data[i * components + c].
+     */
+    struct InSituArray
+    {
+        std::string name;
+        const double* data;
+        unsigned components;
+    };
+
+    /**
+     * The local fluid sites, as a set of points with values. Nothing is copied: the arrays are
+     * those of the adaptor and the property cache, so are only valid during
+     * InSituBackend::Execute.
+     */
+    struct InSituMesh
+    {
+        site_t pointCount;
+        //! The position of each point, in metres, as x, y and z.
+        const double* coordinates;
+        std::vector<InSituArray> fields;
+    };
+
+    /**
+     * Something that visualises or analyses the mesh in situ, e.g. a Catalyst pipeline.
+     */
+    class InSituBackend
+    {
+      public:
+        virtual ~InSituBackend()
+        {
+        }
+
+        /**
+         * Do whatever is done with the mesh at a step.
+         * @param timeStep
+         * @param time The time of the step, in seconds.
+         * @param mesh
+         */
+        virtual void Execute(LatticeTimeStep timeStep, PhysicalTime time,
+                             const InSituMesh& mesh) = 0;
+    };
+
+    /**
+     * Hands the local fluid sites and their density and velocity to an in situ backend every
+     * few steps, so that slices and isosurfaces can be made without writing anything to disk.
+     *
+     * The fields are the property cache's own arrays, in lattice units, so on the steps the
+     * backend runs the cache must be unrestricted (see
+     * MacroscopicPropertyCache::SetSiteRestrictionEnabled). The coordinates are worked out
+     * once for each lattice.
+     */
+    class InSituAdaptor : public net::IteratedAction
+    {
+      public:
+        /**
+         * @param simulationState
+         * @param latticeData
+         * @param propertyCache
+         * @param unitConverter
+         * @param backend Deleted with the adaptor.
+         * @param period Run the backend on every period-th step.
+         * @param timers
+         */
+        InSituAdaptor(const lb::SimulationState& simulationState,
+                      const geometry::LatticeData& latticeData,
+                      const lb::MacroscopicPropertyCache& propertyCache,
+                      const util::UnitConverter& unitConverter, InSituBackend* backend,
+                      unsigned period, reporting::Timers& timers);
+
+        ~InSituAdaptor();
+
+        /**
+         * Read from a new lattice and property cache, once the sites have been redistributed
+         * between the cores.
+         * @param newLatticeData
+         * @param newPropertyCache
+         */
+        void SetLatticeData(const geometry::LatticeData& newLatticeData,
+                            const lb::MacroscopicPropertyCache& newPropertyCache);
+
+        /**
+         * @return Whether the backend runs this iteration.
+         */
+        bool RunsThisIteration() const;
+
+        /**
+         * Set which properties will be required this iteration.
+         * @param propertyCache
+         */
+        void SetRequiredProperties(lb::MacroscopicPropertyCache& propertyCache);
+
+        /**
+         * Run the backend, if it is due.
+         */
+        void EndIteration();
+
+        unsigned GetPeriod() const
+        {
+          return period;
+        }
+
+      private:
+        void CalculateCoordinates();
+
+        const lb::SimulationState& simulationState;
+        const geometry::LatticeData* latticeData;
+        const lb::MacroscopicPropertyCache* propertyCache;
+        const util::UnitConverter& unitConverter;
+        InSituBackend* backend;
+        const unsigned period;
+        reporting::Timers& timers;
+        //! x, y and z of each local fluid site, in metres.
+        std::vector<double> coordinates;
+    };
+  }
+}
+
+#endif /* HEMELB_EXTRACTION_INSITUADAPTOR_H */
@@ -5,6 +5,7 @@
 // license in the file LICENSE.
 
 #include "extraction/IterableDataSource.h"
+#include "Exception.h"
 
 namespace hemelb
 {
@@ -14,5 +15,92 @@ namespace hemelb
     {
 
     }
+
+    unsigned IterableDataSource::GetFieldComponentCount(OutputField::FieldType field)
+    {
+      switch (field)
+      {
+        case OutputField::Pressure:
+        case OutputField::ShearStress:
+        case OutputField::VonMisesStress:
+        case OutputField::ShearRate:
+          return 1;
+        case OutputField::Velocity:
+        case OutputField::Traction:
+        case OutputField::TangentialProjectionTraction:
+          return 3;
+        case OutputField::StressTensor:
+          return 6;
+        default:
+          return 0;
+      }
+    }
+
+    void IterableDataSource::GetField(OutputField::FieldType field,
+                                      const std::vector<site_t>& sites,
+                                      std::vector<FloatingType>& values)
+    {
+      const unsigned components = GetFieldComponentCount(field);
+      if (components == 0)
+      {
+        throw Exception() << "Field type " << field << " isn't available from a data source";
+      }
+      values.resize(sites.size() * components);
+
+      FloatingType* value = values.empty() ?
+        NULL :
+        &values[0];
+      for (size_t site = 0; site < sites.size(); ++site)
+      {
+        ReadAt(sites[site]);
+        switch (field)
+        {
+          case OutputField::Pressure:
+            *value++ = GetPressure();
+            break;
+          case OutputField::ShearStress:
+            *value++ = GetShearStress();
+            break;
+          case OutputField::VonMisesStress:
+            *value++ = GetVonMisesStress();
+            break;
+          case OutputField::ShearRate:
+            *value++ = GetShearRate();
+            break;
+          case OutputField::Velocity:
+          {
+            const util::Vector3D<FloatingType> velocity = GetVelocity();
+            *value++ = velocity.x;
+            *value++ = velocity.y;
+            *value++ = velocity.z;
+            break;
+          }
+          case OutputField::Traction:
+          case OutputField::TangentialProjectionTraction:
+          {
+            const util::Vector3D<PhysicalStress> traction = field == OutputField::Traction ?
+              GetTraction() :
+              GetTangentialProjectionTraction();
+            *value++ = traction.x;
+            *value++ = traction.y;
+            *value++ = traction.z;
+            break;
+          }
+          case OutputField::StressTensor:
+          {
+            util::Matrix3D tensor = GetStressTensor();
+            *value++ = tensor[0][0];
+            *value++ = tensor[0][1];
+            *value++ = tensor[0][2];
+            *value++ = tensor[1][1];
+            *value++ = tensor[1][2];
+            *value++ = tensor[2][2];
+            break;
+          }
+          default:
+            break;
+        }
+      }
+    }
   }
 }
@@ -7,9 +7,11 @@
 #ifndef HEMELB_EXTRACTION_ITERABLEDATASOURCE_H
 #define HEMELB_EXTRACTION_ITERABLEDATASOURCE_H
 
+#include <vector>
 #include "util/Vector3D.h"
 #include "units.h"
 #include "util/Matrix3D.h"
+#include "extraction/OutputField.h"
 
 namespace hemelb
 {
@@ -38,6 +40,16 @@ namespace hemelb
          */
         virtual bool ReadNext() = 0;
 
+        /**
+         * Moves straight to the fluid site with the given index, counting in the order ReadNext
+         * goes through them from the start, so that its values are available as after
+         * ReadNext. Returns true if there is such a site.
+         *
+         * @param index
+         * @return
+         */
+        virtual bool ReadAt(site_t index) = 0;
+
         /**
          * Returns the coordinates of the site.
          * @return
@@ -92,6 +104,39 @@ namespace hemelb
          */
         virtual util::Vector3D<PhysicalStress> GetTangentialProjectionTraction() const = 0;
 
+        /**
+         * Returns the unit normal to the wall at a wall site.
+         * @return wall normal
+         */
+        virtual util::Vector3D<distribn_t> GetWallNormal() const = 0;
+
+        /**
+         * Gets a field at many sites at once, in the same units as the single site getters, so
+         * that the caller makes one call rather than one or more per value. The sites are
+         * indices as for ReadAt; the values are GetFieldComponentCount(field) for each site,
+         * one site after the other (the stress tensor's upper triangle, row-wise). The current
+         * site is undefined afterwards.
+         *
+         * This reads each site in turn with the getters above; sources that hold their fields
+         * in arrays should do better.
+         *
+         * @param field Any field with components (see GetFieldComponentCount).
+         * @param sites
+         * @param values
+         */
+        virtual void GetField(OutputField::FieldType field,
+                              const std::vector<site_t>& sites,
+                              std::vector<FloatingType>& values);
+
+        /**
+         * Returns how many values GetField gives for each site, or 0 if the field isn't one a
+         * data source has (e.g. the statistics accumulated over time).
+         *
+         * @param field
+         * @return
+         */
+        static unsigned GetFieldComponentCount(OutputField::FieldType field);
+
         /**
          * Resets the iterator to the beginning again.
          */
@@ -31,6 +31,12 @@ namespace hemelb
       return true;
     }
 
+    bool LbDataSourceIterator::ReadAt(site_t index)
+    {
+      position = index;
+      return position >= 0 && position < data.GetLocalFluidSiteCount();
+    }
+
     util::Vector3D<site_t> LbDataSourceIterator::GetPosition() const
     {
       return data.GetSite(position).GetGlobalSiteCoords();
@@ -77,6 +83,130 @@ namespace hemelb
       return converter.ConvertStressToPhysicalUnits(propertyCache.tangentialProjectionTractionCache.Get(position));
     }
 
+    util::Vector3D<distribn_t> LbDataSourceIterator::GetWallNormal() const
+    {
+      return data.GetSite(position).GetWallNormal();
+    }
+
+    void LbDataSourceIterator::GetField(OutputField::FieldType field,
+                                        const std::vector<site_t>& sites,
+                                        std::vector<FloatingType>& values)
+    {
+      const unsigned components = GetFieldComponentCount(field);
+      if (components == 0)
+      {
+        // Which throws.
+        IterableDataSource::GetField(field, sites, values);
+        return;
+      }
+      values.resize(sites.size() * components);
+      if (values.empty())
+      {
+        return;
+      }
+
+      // The conversions are linear, so each one's factors are found once for all the sites.
+      const FloatingType stressScale = converter.ConvertStressToPhysicalUnits(1.0);
+      switch (field)
+      {
+        case OutputField::Pressure:
+          GetScalars(propertyCache.densityCache,
+                     sites,
+                     converter.ConvertPressureDifferenceToPhysicalUnits(Cs2),
+                     converter.ConvertPressureToPhysicalUnits(0.0),
+                     &values[0]);
+          break;
+        case OutputField::ShearStress:
+          GetScalars(propertyCache.wallShearStressMagnitudeCache,
+                     sites,
+                     stressScale,
+                     0.0,
+                     &values[0]);
+          break;
+        case OutputField::VonMisesStress:
+          GetScalars(propertyCache.vonMisesStressCache, sites, stressScale, 0.0, &values[0]);
+          break;
+        case OutputField::ShearRate:
+          GetScalars(propertyCache.shearRateCache,
+                     sites,
+                     converter.ConvertShearRateToPhysicalUnits(1.0),
+                     0.0,
+                     &values[0]);
+          break;
+        case OutputField::Velocity:
+          GetVectors(propertyCache.velocityCache,
+                     sites,
+                     converter.ConvertVelocityToPhysicalUnits(1.0),
+                     &values[0]);
+          break;
+        case OutputField::TangentialProjectionTraction:
+          GetVectors(propertyCache.tangentialProjectionTractionCache,
+                     sites,
+                     stressScale,
+                     &values[0]);
+          break;
+        case OutputField::Traction:
+          // This one also depends on the wall normal.
+          for (size_t site = 0; site < sites.size(); ++site)
+          {
+            const util::Vector3D<PhysicalStress> traction =
+                converter.ConvertTractionToPhysicalUnits(propertyCache.tractionCache.Get(sites[site]),
+                                                         data.GetSite(sites[site]).GetWallNormal());
+            values[3 * site] = traction.x;
+            values[3 * site + 1] = traction.y;
+            values[3 * site + 2] = traction.z;
+          }
+          break;
+        case OutputField::StressTensor:
+          for (size_t site = 0; site < sites.size(); ++site)
+          {
+            util::Matrix3D tensor =
+                converter.ConvertFullStressTensorToPhysicalUnits(propertyCache.stressTensorCache.Get(sites[site]));
+            FloatingType* const siteValues = &values[6 * site];
+            siteValues[0] = tensor[0][0];
+            siteValues[1] = tensor[0][1];
+            siteValues[2] = tensor[0][2];
+            siteValues[3] = tensor[1][1];
+            siteValues[4] = tensor[1][2];
+            siteValues[5] = tensor[2][2];
+          }
+          break;
+        default:
+          break;
+      }
+    }
+
+    void LbDataSourceIterator::GetScalars(const util::RefreshableCache<distribn_t>& cache,
+                                          const std::vector<site_t>& sites, FloatingType scale,
+                                          FloatingType offset, FloatingType* values)
+    {
+      for (size_t site = 0; site < sites.size(); ++site)
+      {
+        values[site] = cache.Get(sites[site]);
+      }
+      for (size_t site = 0; site < sites.size(); ++site)
+      {
+        values[site] = scale * values[site] + offset;
+      }
+    }
+
+    void LbDataSourceIterator::GetVectors(
+        const util::RefreshableCache<util::Vector3D<distribn_t> >& cache,
+        const std::vector<site_t>& sites, FloatingType scale, FloatingType* values)
+    {
+      for (size_t site = 0; site < sites.size(); ++site)
+      {
+        const util::Vector3D<distribn_t>& vector = cache.Get(sites[site]);
+        values[3 * site] = vector.x;
+        values[3 * site + 1] = vector.y;
+        values[3 * site + 2] = vector.z;
+      }
+      for (size_t value = 0; value < 3 * sites.size(); ++value)
+      {
+        values[value] *= scale;
+      }
+    }
+
     void LbDataSourceIterator::Reset()
     {
       position = -1;
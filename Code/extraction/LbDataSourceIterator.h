@@ -38,6 +38,8 @@ namespace hemelb
          */
         bool ReadNext();
 
+        bool ReadAt(site_t index);
+
         /**
          * Returns the coordinates of the site.
          * @return
@@ -92,6 +94,23 @@ namespace hemelb
          */
         util::Vector3D<PhysicalStress> GetTangentialProjectionTraction() const;
 
+        /**
+         * Returns the unit normal to the wall at a wall site.
+         * @return wall normal
+         */
+        util::Vector3D<distribn_t> GetWallNormal() const;
+
+        /**
+         * Gets a field at many sites straight from the property cache, converting all of the
+         * values with factors found once.
+         * @param field
+         * @param sites
+         * @param values
+         */
+        void GetField(OutputField::FieldType field,
+                      const std::vector<site_t>& sites,
+                      std::vector<FloatingType>& values);
+
         /**
          * Resets the iterator to the beginning again.
          */
@@ -136,6 +155,29 @@ namespace hemelb
 
 
       private:
+        /**
+         * Gets a scalar from a cache at each site, as scale * cached + offset.
+         * @param cache
+         * @param sites
+         * @param scale
+         * @param offset
+         * @param values
+         */
+        static void GetScalars(const util::RefreshableCache<distribn_t>& cache,
+                               const std::vector<site_t>& sites, FloatingType scale,
+                               FloatingType offset, FloatingType* values);
+
+        /**
+         * Gets a vector from a cache at each site, times scale.
+         * @param cache
+         * @param sites
+         * @param scale
+         * @param values
+         */
+        static void GetVectors(const util::RefreshableCache<util::Vector3D<distribn_t> >& cache,
+                               const std::vector<site_t>& sites, FloatingType scale,
+                               FloatingType* values);
+
         /**
          * The cache of properties for each site, which we iterate through.
          */
@@ -4,90 +4,157 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <zlib.h>
 #include "extraction/LocalPropertyOutput.h"
 #include "io/formats/formats.h"
 #include "io/formats/extraction.h"
 #include "io/writers/xdr/XdrMemWriter.h"
 #include "net/IOCommunicator.h"
+#include "util/HalfPrecision.h"
 #include "constants.h"
+#include "Exception.h"
 
 namespace hemelb
 {
   namespace extraction
   {
+    namespace
+    {
+      /**
+       * Collects the field values of the sites, to be encoded once they are all known.
+       */
+      template<typename T>
+      class ValueCollector
+      {
+        public:
+          ValueCollector(std::vector<T>& values) :
+              values(values)
+          {
+          }
+
+          ValueCollector& operator<<(T value)
+          {
+            values.push_back(value);
+            return *this;
+          }
+
+        private:
+          std::vector<T>& values;
+      };
+    }
+
     LocalPropertyOutput::LocalPropertyOutput(IterableDataSource& dataSource,
                                              const PropertyOutputFile* outputSpec,
                                              const net::IOCommunicator& ioComms) :
-      comms(ioComms), dataSource(dataSource), outputSpec(outputSpec)
+      subfiles(ioComms, outputSpec->ranksPerFile), rank(ioComms.Rank()),
+          comms(subfiles.GetComms()), dataSource(&dataSource), outputSpec(outputSpec),
+          triggerMonitor(outputSpec->triggers)
     {
-      // Open the file as write-only, create it if it doesn't exist, don't create if the file
-      // already exists.
-      outputFile = net::MpiFile::Open(comms, outputSpec->filename,
-                                      MPI_MODE_WRONLY | MPI_MODE_CREATE | MPI_MODE_EXCL);
-      // Count sites on this task
-      uint64_t siteCount = 0;
-      dataSource.Reset();
-      while (dataSource.ReadNext())
-      {
-        if (outputSpec->geometry->Include(dataSource, dataSource.GetPosition()))
-        {
-          ++siteCount;
-        }
+#ifdef HEMELB_USE_ASYNC_EXTRACTION_WRITES
+      pendingWrite = MPI_REQUEST_NULL;
+#endif
+      recordsSinceKeyframe = 0;
+      keyframeDue = true;
+      if (outputSpec->encoding == io::formats::extraction::DeltaEncoding
+          && !outputSpec->positionsOnce)
+      {
+        throw Exception() << "Delta encoded property output needs the positions in site lists, for "
+            << outputSpec->filename;
       }
+      blockAverager = outputSpec->decimation == PropertyOutputFile::BlockAverageDecimation
+        ? new BlockAverager(outputSpec->decimationFactor, comms)
+        : NULL;
 
-      // Calculate how long local writes need to be.
-
-      // First get the length per-site
-      // Always have 3 uint32's for the position of a site
-      writeLength = 3 * 4;
+      // Find the sites on this task
+      SelectLocalSites();
+      uint64_t siteCount = GetWrittenSiteCount();
+      partSiteCount = comms.AllReduce(siteCount, MPI_SUM);
 
-      // Then get add each field's length
+      accumulatorsPerSite = 0;
+      valuesPerSite = 0;
       for (unsigned outputNumber = 0; outputNumber < outputSpec->fields.size(); ++outputNumber)
       {
-        writeLength += sizeof(WrittenDataType)
-            * GetFieldLength(outputSpec->fields[outputNumber].type);
+        accumulatorsPerSite += GetAccumulatorLength(outputSpec->fields[outputNumber].type);
+        valuesPerSite += GetFieldLength(outputSpec->fields[outputNumber].type);
+        fieldOfValue.resize(valuesPerSite, outputNumber);
       }
+      ResetAccumulators();
 
-      //  Now multiply by local site count
-      writeLength *= siteCount;
-
-      // The IO proc also writes the iteration number
-      if (comms.OnIORank())
+#ifdef HEMELB_USE_HDF5
+      hdf5File = NULL;
+      if (outputSpec->format == PropertyOutputFile::Hdf5Format)
       {
-        writeLength += 8;
+        std::vector<unsigned> fieldLengths;
+        std::vector<double> fieldOffsets;
+        for (unsigned outputNumber = 0; outputNumber < outputSpec->fields.size(); ++outputNumber)
+        {
+          fieldLengths.push_back(GetFieldLength(outputSpec->fields[outputNumber].type));
+          fieldOffsets.push_back(GetOffset(outputSpec->fields[outputNumber].type));
+        }
+        hdf5File = new Hdf5OutputFile(outputSpec, fieldLengths, fieldOffsets,
+                                      dataSource.GetVoxelSize(), dataSource.GetOrigin(), comms);
+        CalculateWriteLengths(siteCount);
+        return;
       }
+#endif
 
-      //! @TODO: These two MPI calls can be replaced with one
+      // Open the file as write-only, create it if it doesn't exist, don't create if the file
+      // already exists.
+      outputFile = net::MpiFile::Open(comms, subfiles.GetPartPath(outputSpec->filename),
+                                      MPI_MODE_WRONLY | MPI_MODE_CREATE | MPI_MODE_EXCL,
+                                      outputSpec->ioHints);
 
-      // Everyone needs to know the total length written during one iteration.
-      allCoresWriteLength = comms.AllReduce(writeLength, MPI_SUM);
+      // Each group writes a whole extraction file of its own sites, and the index of them is at
+      // the path of the whole file.
+      if (subfiles.IsSplit())
+      {
+        const io::SubfileIndex index = subfiles.MakeIndex(outputSpec->filename,
+                                                          io::formats::extraction::MagicNumber,
+                                                          siteCount);
+        if (ioComms.OnIORank())
+        {
+          index.Write(outputSpec->filename);
+        }
+      }
+
+      // Calculate how long local writes need to be, and where they go.
+      CalculateWriteLengths(siteCount);
 
       // Only the root process needs to know the total number of sites written
       // Note this has a garbage value on other procs.
       uint64_t allSiteCount = comms.Reduce(siteCount, MPI_SUM,
                                            comms.GetIORank());
 
-      unsigned totalHeaderLength = 0;
+      // Compute the length of the field header. Every core works this out, as the data starts
+      // after it.
+      const bool encoded = outputSpec->encoding != io::formats::extraction::Float32Encoding
+          || outputSpec->surfaceSiteLists;
+      // The encoding and flags, in the version that has them
+      unsigned fieldHeaderLength = encoded
+        ? 8
+        : 0;
+      for (unsigned outputNumber = 0; outputNumber < outputSpec->fields.size(); ++outputNumber)
+      {
+        // Name
+        fieldHeaderLength
+            += io::formats::extraction::GetStoredLengthOfString(outputSpec->fields[outputNumber].name);
+        // Uint32 for number of fields
+        fieldHeaderLength += 4;
+        // Double for the offset in each field
+        fieldHeaderLength += 8;
+      }
+      const unsigned totalHeaderLength = io::formats::extraction::MainHeaderLength
+          + fieldHeaderLength;
 
       // Write the header information on the IO proc.
       if (comms.OnIORank())
       {
-        // Compute the length of the field header
-        unsigned fieldHeaderLength = 0;
-        for (unsigned outputNumber = 0; outputNumber < outputSpec->fields.size(); ++outputNumber)
-        {
-          // Name
-          fieldHeaderLength
-              += io::formats::extraction::GetStoredLengthOfString(outputSpec->fields[outputNumber].name);
-          // Uint32 for number of fields
-          fieldHeaderLength += 4;
-          // Double for the offset in each field
-          fieldHeaderLength += 8;
-        }
-
         // Create a header buffer
-        totalHeaderLength = io::formats::extraction::MainHeaderLength + fieldHeaderLength;
         std::vector<char> headerBuffer(totalHeaderLength);
 
         {
@@ -95,10 +162,20 @@ namespace hemelb
           io::writers::xdr::XdrMemWriter
               mainHeaderWriter(&headerBuffer[0], io::formats::extraction::MainHeaderLength);
 
+          // The version numbers are in different enums.
+          uint32_t version = io::formats::extraction::VersionNumber;
+          if (encoded)
+          {
+            version = io::formats::extraction::EncodedVersionNumber;
+          }
+          else if (outputSpec->positionsOnce)
+          {
+            version = io::formats::extraction::SiteListVersionNumber;
+          }
+
           // Fill it
           mainHeaderWriter << uint32_t(io::formats::HemeLbMagicNumber)
-              << uint32_t(io::formats::extraction::MagicNumber)
-              << uint32_t(io::formats::extraction::VersionNumber);
+              << uint32_t(io::formats::extraction::MagicNumber) << version;
           mainHeaderWriter << double(dataSource.GetVoxelSize());
           const util::Vector3D<distribn_t> &origin = dataSource.GetOrigin();
           mainHeaderWriter << double(origin[0]) << double(origin[1]) << double(origin[2]);
@@ -115,6 +192,15 @@ namespace hemelb
               fieldHeaderWriter(&headerBuffer[io::formats::extraction::MainHeaderLength],
                                 fieldHeaderLength);
           // Write it
+          if (encoded)
+          {
+            fieldHeaderWriter << uint32_t(outputSpec->encoding)
+                << uint32_t( (outputSpec->positionsOnce
+                  ? io::formats::extraction::SiteLists
+                  : 0) | (outputSpec->surfaceSiteLists
+                  ? io::formats::extraction::SurfaceSiteLists
+                  : 0));
+          }
           for (unsigned outputNumber = 0; outputNumber < outputSpec->fields.size(); ++outputNumber)
           {
             fieldHeaderWriter << outputSpec->fields[outputNumber].name
@@ -128,41 +214,338 @@ namespace hemelb
         outputFile.WriteAt(0, headerBuffer);
       }
 
-      // Calculate where each core should start writing
-      if (comms.OnIORank())
+      nextBlockOffset = totalHeaderLength;
+    }
+
+    LocalPropertyOutput::~LocalPropertyOutput()
+    {
+#ifdef HEMELB_USE_ASYNC_EXTRACTION_WRITES
+      // The file can't be closed with a write still going.
+      if (pendingWrite != MPI_REQUEST_NULL)
+      {
+        MPI_Wait(&pendingWrite, MPI_STATUS_IGNORE);
+      }
+#endif
+#ifdef HEMELB_USE_HDF5
+      delete hdf5File;
+#endif
+      delete blockAverager;
+    }
+
+    void LocalPropertyOutput::FinishWriting()
+    {
+#ifdef HEMELB_USE_ASYNC_EXTRACTION_WRITES
+      if (pendingWrite != MPI_REQUEST_NULL)
+      {
+        HEMELB_MPI_CALL(MPI_Wait, (&pendingWrite, MPI_STATUS_IGNORE));
+      }
+#endif
+    }
+
+    void LocalPropertyOutput::SetDataSource(IterableDataSource& newDataSource)
+    {
+      // The buffers are about to change size.
+      FinishWriting();
+
+      // The later records carry on from the next block, with each core's part in rank order as
+      // when the file was opened.
+      dataSource = &newDataSource;
+      SelectLocalSites();
+      if (subfiles.IsSplit() && comms.AllReduce(GetWrittenSiteCount(), MPI_SUM) != partSiteCount)
+      {
+        throw Exception() << "Sites have moved between the parts of " << outputSpec->filename
+            << ", which can't be rebalanced";
+      }
+      ResetAccumulators();
+      CalculateWriteLengths(GetWrittenSiteCount());
+    }
+
+    void LocalPropertyOutput::ResetAccumulators()
+    {
+      accumulators.assign(accumulatorsPerSite * selectedSites.size(), 0.);
+      sampleCount = 0;
+    }
+
+    void LocalPropertyOutput::CalculateWriteLengths(uint64_t siteCount)
+    {
+#ifdef HEMELB_USE_HDF5
+      // The HDF5 file lays itself out, from a new site list for the new site order.
+      if (hdf5File != NULL)
       {
-        // For core 0 this is easy: it passes the value for core 1 to the core.
-        localDataOffsetIntoFile = totalHeaderLength;
+        siteListDue = true;
+        return;
+      }
+#endif
+      // The quantised values of the last record are in the old site order.
+      keyframeDue = true;
+
+      writeLength = GetLocalWriteLength(siteCount);
+
+      // Each core writes after all the lower ranks (the IO proc, which writes the iteration
+      // number, being rank 0), and everyone needs to know the total length written during one
+      // iteration.
+      localRecordOffset = comms.ExScan(writeLength, MPI_SUM);
+      allCoresWriteLength = comms.AllReduce(writeLength, MPI_SUM);
 
-        if (comms.Size() > 1)
+      // The site order is this core's, so with the positions in a list of their own, there must
+      // be a new list before the next record.
+      siteListDue = outputSpec->positionsOnce;
+      if (siteListDue)
+      {
+        siteListLength = GetLocalSiteListLength(siteCount);
+        localSiteListOffset = comms.ExScan(siteListLength, MPI_SUM);
+        allCoresSiteListLength = comms.AllReduce(siteListLength, MPI_SUM);
+      }
+
+      // Create the buffer that we'll write each iteration's data into.
+      buffer.resize(writeLength);
+    }
+
+    void LocalPropertyOutput::SelectLocalSites()
+    {
+      selectedSites.clear();
+      site_t siteIndex = 0;
+      dataSource->Reset();
+      while (dataSource->ReadNext())
+      {
+        const util::Vector3D<site_t> position = dataSource->GetPosition();
+        if (outputSpec->decimation == PropertyOutputFile::StrideDecimation
+            && (position.x % outputSpec->decimationFactor != 0
+                || position.y % outputSpec->decimationFactor != 0
+                || position.z % outputSpec->decimationFactor != 0))
         {
-          comms.Send(localDataOffsetIntoFile+writeLength, 1, 1);
+          ++siteIndex;
+          continue;
         }
+        if (outputSpec->geometry->Include(*dataSource, position))
+        {
+          selectedSites.push_back(siteIndex);
+        }
+        ++siteIndex;
       }
-      else
+
+      // The wall normals and areas don't change, so they are found here once, rather than for
+      // every site list.
+      siteNormals.clear();
+      siteAreas.clear();
+      if (outputSpec->surfaceSiteLists)
       {
-        // Receive the writing start position from the previous core.
-        comms.Receive(localDataOffsetIntoFile, comms.Rank()-1, 1);
+        const PhysicalDistance voxelSize = dataSource->GetVoxelSize();
+        for (size_t site = 0; site < selectedSites.size(); ++site)
+        {
+          dataSource->ReadAt(selectedSites[site]);
+          util::Vector3D<float> normal(0.f);
+          float area = 0.f;
+          if (dataSource->IsWallSite(dataSource->GetPosition()))
+          {
+            normal = util::Vector3D<float>(dataSource->GetWallNormal());
+            // A plane with unit normal n cuts the lattice links along each axis i at |n_i| per
+            // voxel face, so there are about |n_x| + |n_y| + |n_z| wall sites to each voxel face
+            // of its area.
+            const float linksCut = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+            if (linksCut > 0.f)
+            {
+              area = float(voxelSize * voxelSize / linksCut);
+            }
+          }
+          siteNormals.push_back(normal);
+          siteAreas.push_back(area);
+        }
+      }
 
-        // Send the next core its start position.
-        if (comms.Rank() != (comms.Size() - 1))
+      if (blockAverager != NULL)
+      {
+        std::vector<util::Vector3D<site_t> > positions(selectedSites.size());
+        for (size_t site = 0; site < selectedSites.size(); ++site)
         {
-          comms.Send(localDataOffsetIntoFile+writeLength, comms.Rank() + 1, 1);
+          dataSource->ReadAt(selectedSites[site]);
+          positions[site] = dataSource->GetPosition();
         }
+        blockAverager->SetSites(positions);
       }
+    }
 
-      // Create the buffer that we'll write each iteration's data into.
-      buffer.resize(writeLength);
+    uint64_t LocalPropertyOutput::GetWrittenSiteCount() const
+    {
+      return blockAverager == NULL
+        ? selectedSites.size()
+        : blockAverager->GetBlockPositions().size();
     }
 
-    LocalPropertyOutput::~LocalPropertyOutput()
+    util::Vector3D<site_t> LocalPropertyOutput::GetWrittenPosition(size_t site)
+    {
+      if (blockAverager != NULL)
+      {
+        return blockAverager->GetBlockPositions()[site];
+      }
+      dataSource->ReadAt(selectedSites[site]);
+      return dataSource->GetPosition();
+    }
+
+    uint64_t LocalPropertyOutput::GetLocalWriteLength(uint64_t siteCount)
     {
+      // First get the length per-site
+      // 3 uint32's for the position of a site, unless they are in a list of their own.
+      uint64_t length = outputSpec->positionsOnce
+        ? 0
+        : 3 * 4;
 
+      // Then add the fields' values, 16-bit ones padded to a multiple of four bytes.
+      if (outputSpec->encoding == io::formats::extraction::Float32Encoding)
+      {
+        length += sizeof(WrittenDataType) * valuesPerSite;
+      }
+      else
+      {
+        length += 4 * ( (valuesPerSite + 1) / 2);
+      }
+
+      //  Now multiply by local site count
+      length *= siteCount;
+
+      // The IO proc also writes the iteration number, and the range of quantised fields.
+      if (comms.OnIORank())
+      {
+        length += 8;
+        if (outputSpec->encoding == io::formats::extraction::Fixed16Encoding)
+        {
+          length += 2 * 8 * outputSpec->fields.size();
+        }
+      }
+      return length;
+    }
+
+    uint64_t LocalPropertyOutput::GetLocalSiteListLength(uint64_t siteCount)
+    {
+      // 3 uint32's for the position of each site, 4 floats for the wall normal and area in a
+      // surface site list, and the marker from the IO proc.
+      uint64_t length = (outputSpec->surfaceSiteLists
+        ? 7 * 4
+        : 3 * 4) * siteCount;
+      if (comms.OnIORank())
+      {
+        length += 8;
+      }
+      return length;
     }
 
     bool LocalPropertyOutput::ShouldWrite(unsigned long timestepNumber) const
     {
-      return ( (timestepNumber % outputSpec->frequency) == 0);
+      return ( (timestepNumber % outputSpec->frequency) == 0)
+          || triggerMonitor.HasFired(timestepNumber);
+    }
+
+    void LocalPropertyOutput::Monitor(OutputTrigger::Quantity quantity, double value,
+                                      unsigned long timestepNumber)
+    {
+      triggerMonitor.Update(quantity, value, timestepNumber);
+    }
+
+    bool LocalPropertyOutput::ShouldSample(unsigned long timestepNumber) const
+    {
+      return accumulatorsPerSite > 0 && (timestepNumber % outputSpec->samplePeriod) == 0;
+    }
+
+    void LocalPropertyOutput::Sample(unsigned long timestepNumber)
+    {
+      SiteFieldValues fields(*dataSource, selectedSites);
+      Sample(timestepNumber, fields);
+    }
+
+    void LocalPropertyOutput::Sample(unsigned long timestepNumber, SiteFieldValues& fields)
+    {
+      if (!ShouldSample(timestepNumber))
+      {
+        return;
+      }
+
+      // Get the fields the statistics are of at all the sites at once, each only once.
+      std::vector<FloatingType> shearStresses, tractions, velocities;
+      bool haveShearStresses = false, haveTractions = false, haveVelocities = false;
+      for (unsigned outputNumber = 0; outputNumber < outputSpec->fields.size(); ++outputNumber)
+      {
+        switch (outputSpec->fields[outputNumber].type)
+        {
+          case OutputField::AveragedShearStress:
+            if (!haveShearStresses)
+            {
+              fields.Get(OutputField::ShearStress, selectedSites, shearStresses);
+              haveShearStresses = true;
+            }
+            break;
+          case OutputField::OscillatoryShearIndex:
+            if (!haveTractions)
+            {
+              fields.Get(OutputField::TangentialProjectionTraction, selectedSites, tractions);
+              haveTractions = true;
+            }
+            break;
+          case OutputField::AveragedVelocity:
+          case OutputField::VelocityRms:
+            if (!haveVelocities)
+            {
+              fields.Get(OutputField::Velocity, selectedSites, velocities);
+              haveVelocities = true;
+            }
+            break;
+          default:
+            break;
+        }
+      }
+
+      size_t accumulator = 0;
+      for (size_t site = 0; site < selectedSites.size(); ++site)
+      {
+        for (unsigned outputNumber = 0; outputNumber < outputSpec->fields.size(); ++outputNumber)
+        {
+          switch (outputSpec->fields[outputNumber].type)
+          {
+            case OutputField::AveragedShearStress:
+              accumulators[accumulator++] += shearStresses[site];
+              break;
+            case OutputField::OscillatoryShearIndex:
+            {
+              // The sum of the shear stress vectors, and of their magnitudes.
+              const util::Vector3D<PhysicalStress> shearStress(tractions[3 * site],
+                                                               tractions[3 * site + 1],
+                                                               tractions[3 * site + 2]);
+              accumulators[accumulator++] += shearStress.x;
+              accumulators[accumulator++] += shearStress.y;
+              accumulators[accumulator++] += shearStress.z;
+              accumulators[accumulator++] += shearStress.GetMagnitude();
+              break;
+            }
+            case OutputField::AveragedVelocity:
+            {
+              const util::Vector3D<FloatingType> velocity(velocities[3 * site],
+                                                          velocities[3 * site + 1],
+                                                          velocities[3 * site + 2]);
+              accumulators[accumulator++] += velocity.x;
+              accumulators[accumulator++] += velocity.y;
+              accumulators[accumulator++] += velocity.z;
+              break;
+            }
+            case OutputField::VelocityRms:
+            {
+              // The sum of each component, and of its square.
+              const util::Vector3D<FloatingType> velocity(velocities[3 * site],
+                                                          velocities[3 * site + 1],
+                                                          velocities[3 * site + 2]);
+              accumulators[accumulator++] += velocity.x;
+              accumulators[accumulator++] += velocity.y;
+              accumulators[accumulator++] += velocity.z;
+              accumulators[accumulator++] += velocity.x * velocity.x;
+              accumulators[accumulator++] += velocity.y * velocity.y;
+              accumulators[accumulator++] += velocity.z * velocity.z;
+              break;
+            }
+            default:
+              // The instantaneous fields aren't accumulated.
+              break;
+          }
+        }
+      }
+      ++sampleCount;
     }
 
     const PropertyOutputFile* LocalPropertyOutput::GetOutputSpec() const
@@ -170,7 +553,18 @@ namespace hemelb
       return outputSpec;
     }
 
+    const std::vector<site_t>& LocalPropertyOutput::GetSelectedSites() const
+    {
+      return selectedSites;
+    }
+
     void LocalPropertyOutput::Write(unsigned long timestepNumber)
+    {
+      SiteFieldValues fields(*dataSource, selectedSites);
+      Write(timestepNumber, fields);
+    }
+
+    void LocalPropertyOutput::Write(unsigned long timestepNumber, SiteFieldValues& fields)
     {
       // Don't write if we shouldn't this iteration.
       if (!ShouldWrite(timestepNumber))
@@ -178,96 +572,435 @@ namespace hemelb
         return;
       }
 
-      // Don't write if this core doesn't do anything.
-      if (writeLength <= 0)
+      if (siteListDue)
       {
+        WriteSiteList();
+      }
+
+      CollectValues(fields);
+#ifdef HEMELB_USE_HDF5
+      if (hdf5File != NULL)
+      {
+        hdf5File->WriteStep(timestepNumber, values);
+        if (accumulatorsPerSite > 0)
+        {
+          ResetAccumulators();
+        }
         return;
       }
+#endif
+      if (outputSpec->encoding == io::formats::extraction::DeltaEncoding)
+      {
+        SerialiseDeltas(timestepNumber);
+      }
+      else
+      {
+        if (outputSpec->encoding == io::formats::extraction::Fixed16Encoding)
+        {
+          std::vector<double> minimum, maximum;
+          GetFieldRanges(minimum, maximum);
+          SetQuantisation(minimum, maximum);
+        }
 
-      // Create the buffer.
-      io::writers::xdr::XdrMemWriter xdrWriter(&buffer[0], buffer.size());
+        // The write is collective, so even a core without anything to write takes part.
+        if (writeLength > 0)
+        {
+          Serialise(timestepNumber);
+        }
+      }
 
-      // Firstly, the IO proc must write the iteration number.
-      if (comms.OnIORank())
+      // The next record's statistics start afresh.
+      if (accumulatorsPerSite > 0)
       {
-        xdrWriter << (uint64_t) timestepNumber;
+        ResetAccumulators();
       }
 
-      dataSource.Reset();
+#ifdef HEMELB_USE_ASYNC_EXTRACTION_WRITES
+      // Only one write at a time, so if the last one still hasn't finished, we wait for it here.
+      FinishWriting();
+      buffer.swap(writingBuffer);
+      outputFile.IWriteAtAll(nextBlockOffset + localRecordOffset, writingBuffer, &pendingWrite);
+      // The swap moved the (now free) buffer of the last write here, so make sure it is the
+      // right size for the next iteration.
+      buffer.resize(writeLength);
+#else
+      // Actually do the MPI writing.
+      outputFile.WriteAtAll(nextBlockOffset + localRecordOffset, buffer);
+#endif
+
+      // Set the offset to the right place for writing on the next iteration.
+      nextBlockOffset += allCoresWriteLength;
+    }
 
-      while (dataSource.ReadNext())
+    void LocalPropertyOutput::WriteSiteList()
+    {
+#ifdef HEMELB_USE_HDF5
+      if (hdf5File != NULL)
       {
-        const util::Vector3D<site_t>& position = dataSource.GetPosition();
-        if (outputSpec->geometry->Include(dataSource, position))
+        std::vector<util::Vector3D<site_t> > positions;
+        for (size_t site = 0; site < GetWrittenSiteCount(); ++site)
         {
-          // Write the position
+          positions.push_back(GetWrittenPosition(site));
+        }
+        hdf5File->WriteSites(positions);
+        siteListDue = false;
+        return;
+      }
+#endif
+      // This is rare enough not to bother overlapping with any write in progress.
+      FinishWriting();
+
+      std::vector<char> siteList(siteListLength);
+      if (siteListLength > 0)
+      {
+        io::writers::xdr::XdrMemWriter xdrWriter(&siteList[0], siteList.size());
+        if (comms.OnIORank())
+        {
+          xdrWriter << io::formats::extraction::SiteListMarker;
+        }
+
+        for (size_t site = 0; site < GetWrittenSiteCount(); ++site)
+        {
+          const util::Vector3D<site_t> position = GetWrittenPosition(site);
           xdrWriter << (uint32_t) position.x << (uint32_t) position.y << (uint32_t) position.z;
+          if (outputSpec->surfaceSiteLists)
+          {
+            xdrWriter << siteNormals[site].x << siteNormals[site].y << siteNormals[site].z
+                << siteAreas[site];
+          }
+        }
+      }
 
-          // Write for each field.
-          for (unsigned outputNumber = 0; outputNumber < outputSpec->fields.size(); ++outputNumber)
+      outputFile.WriteAtAll(nextBlockOffset + localSiteListOffset, siteList);
+      nextBlockOffset += allCoresSiteListLength;
+      siteListDue = false;
+    }
+
+    void LocalPropertyOutput::CollectValues(SiteFieldValues& fields)
+    {
+      values.clear();
+      ValueCollector<WrittenDataType> collector(values);
+
+      // Get each instantaneous field at all the sites this output includes (which were found
+      // once up front) at once, shared with the other outputs on this iteration.
+      std::vector<std::vector<FloatingType> > fieldValues(outputSpec->fields.size());
+      for (unsigned outputNumber = 0; outputNumber < outputSpec->fields.size(); ++outputNumber)
+      {
+        const OutputField::FieldType type = outputSpec->fields[outputNumber].type;
+        if (IterableDataSource::GetFieldComponentCount(type) > 0)
+        {
+          fields.Get(type, selectedSites, fieldValues[outputNumber]);
+        }
+      }
+
+      size_t accumulator = 0;
+      for (size_t site = 0; site < selectedSites.size(); ++site)
+      {
+        // Get each field.
+        for (unsigned outputNumber = 0; outputNumber < outputSpec->fields.size(); ++outputNumber)
+        {
+          const OutputField::FieldType type = outputSpec->fields[outputNumber].type;
+          switch (type)
           {
-            switch (outputSpec->fields[outputNumber].type)
+            case OutputField::Pressure:
+              collector << static_cast<WrittenDataType> (fieldValues[outputNumber][site]
+                  - REFERENCE_PRESSURE_mmHg);
+              break;
+              //! @TODO: Work out how to handle the different stresses.
+            case OutputField::Velocity:
+            case OutputField::VonMisesStress:
+            case OutputField::ShearStress:
+            case OutputField::ShearRate:
+              // Only the upper triangular part of the symmetric tensor is stored. Storage is
+              // row-wise.
+            case OutputField::StressTensor:
+            case OutputField::Traction:
+            case OutputField::TangentialProjectionTraction:
             {
-              case OutputField::Pressure:
-                xdrWriter << static_cast<WrittenDataType> (dataSource.GetPressure()
-                    - REFERENCE_PRESSURE_mmHg);
-                break;
-              case OutputField::Velocity:
-                xdrWriter << static_cast<WrittenDataType> (dataSource.GetVelocity().x)
-                    << static_cast<WrittenDataType> (dataSource.GetVelocity().y)
-                    << static_cast<WrittenDataType> (dataSource.GetVelocity().z);
-                break;
-                //! @TODO: Work out how to handle the different stresses.
-              case OutputField::VonMisesStress:
-                xdrWriter << static_cast<WrittenDataType> (dataSource.GetVonMisesStress());
-                break;
-              case OutputField::ShearStress:
-                xdrWriter << static_cast<WrittenDataType> (dataSource.GetShearStress());
-                break;
-              case OutputField::ShearRate:
-                xdrWriter << static_cast<WrittenDataType> (dataSource.GetShearRate());
-                break;
-              case OutputField::StressTensor:
+              const unsigned components = IterableDataSource::GetFieldComponentCount(type);
+              for (unsigned component = 0; component < components; ++component)
               {
-                util::Matrix3D tensor = dataSource.GetStressTensor();
-                // Only the upper triangular part of the symmetric tensor is stored. Storage is row-wise.
-                xdrWriter << static_cast<WrittenDataType> (tensor[0][0])
-                    << static_cast<WrittenDataType> (tensor[0][1])
-                    << static_cast<WrittenDataType> (tensor[0][2])
-                    << static_cast<WrittenDataType> (tensor[1][1])
-                    << static_cast<WrittenDataType> (tensor[1][2])
-                    << static_cast<WrittenDataType> (tensor[2][2]);
-                break;
+                collector
+                    << static_cast<WrittenDataType> (fieldValues[outputNumber][site * components
+                        + component]);
               }
-              case OutputField::Traction:
-                xdrWriter << static_cast<WrittenDataType> (dataSource.GetTraction().x)
-                    << static_cast<WrittenDataType> (dataSource.GetTraction().y)
-                    << static_cast<WrittenDataType> (dataSource.GetTraction().z);
-                break;
-              case OutputField::TangentialProjectionTraction:
-                xdrWriter
-                    << static_cast<WrittenDataType> (dataSource.GetTangentialProjectionTraction().x)
-                    << static_cast<WrittenDataType> (dataSource.GetTangentialProjectionTraction().y)
-                    << static_cast<WrittenDataType> (dataSource.GetTangentialProjectionTraction().z);
-                break;
-              case OutputField::MpiRank:
-                xdrWriter
-                    << static_cast<WrittenDataType> (comms.Rank());
-                break;
-              default:
-                // This should never trip. It only occurs when a new OutputField field is added and no
-                // implementation is provided for its serialisation.
-                assert(false);
+              break;
+            }
+            case OutputField::MpiRank:
+              collector
+                  << static_cast<WrittenDataType> (rank);
+              break;
+            case OutputField::AveragedShearStress:
+              collector << static_cast<WrittenDataType> (GetMean(accumulator));
+              accumulator += 1;
+              break;
+            case OutputField::OscillatoryShearIndex:
+            {
+              // OSI = (1 - |mean shear stress vector| / mean shear stress magnitude) / 2
+              const double meanMagnitude = GetMean(accumulator + 3);
+              const util::Vector3D<double> meanShearStress(GetMean(accumulator),
+                                                           GetMean(accumulator + 1),
+                                                           GetMean(accumulator + 2));
+              collector << static_cast<WrittenDataType> (meanMagnitude > 0.
+                ? 0.5 * (1. - meanShearStress.GetMagnitude() / meanMagnitude)
+                : 0.);
+              accumulator += 4;
+              break;
             }
+            case OutputField::AveragedVelocity:
+              collector << static_cast<WrittenDataType> (GetMean(accumulator))
+                  << static_cast<WrittenDataType> (GetMean(accumulator + 1))
+                  << static_cast<WrittenDataType> (GetMean(accumulator + 2));
+              accumulator += 3;
+              break;
+            case OutputField::VelocityRms:
+              for (unsigned component = 0; component < 3; ++component)
+              {
+                const double mean = GetMean(accumulator + component);
+                const double variance = GetMean(accumulator + 3 + component) - mean * mean;
+                collector << static_cast<WrittenDataType> (std::sqrt(std::max(0., variance)));
+              }
+              accumulator += 6;
+              break;
+            default:
+              // This should never trip. It only occurs when a new OutputField field is added and no
+              // implementation is provided for its serialisation.
+              assert(false);
           }
         }
       }
 
-      // Actually do the MPI writing.
-      outputFile.WriteAt(localDataOffsetIntoFile, buffer);
+      // Only the averages over the blocks are written.
+      if (blockAverager != NULL)
+      {
+        std::vector<WrittenDataType> siteValues;
+        siteValues.swap(values);
+        blockAverager->Average(siteValues, valuesPerSite, values);
+      }
+    }
 
-      // Set the offset to the right place for writing on the next iteration.
-      localDataOffsetIntoFile += allCoresWriteLength;
+
+    void LocalPropertyOutput::Serialise(unsigned long timestepNumber)
+    {
+      // Create the buffer.
+      io::writers::xdr::XdrMemWriter xdrWriter(&buffer[0], buffer.size());
+
+      // Firstly, the IO proc must write the iteration number, and the range of any quantised
+      // fields.
+      if (comms.OnIORank())
+      {
+        xdrWriter << (uint64_t) timestepNumber;
+        if (outputSpec->encoding == io::formats::extraction::Fixed16Encoding)
+        {
+          for (unsigned outputNumber = 0; outputNumber < outputSpec->fields.size(); ++outputNumber)
+          {
+            xdrWriter << fieldMinimum[outputNumber] << fieldScale[outputNumber];
+          }
+        }
+      }
+
+      // With the positions in the site list, the values are all there is, so they go in one run.
+      if (outputSpec->positionsOnce && outputSpec->encoding
+          == io::formats::extraction::Float32Encoding)
+      {
+        if (!values.empty())
+        {
+          xdrWriter.WriteArray(&values[0], values.size());
+        }
+        return;
+      }
+
+      // XDR only has 32-bit integers, so 16-bit values are written in pairs, the first in the
+      // high half so that they come out big-endian, with a zero to pad an odd one out.
+      const unsigned wordsPerSite = (valuesPerSite + 1) / 2;
+      const size_t siteCount = GetWrittenSiteCount();
+      std::vector<uint32_t> words(outputSpec->positionsOnce
+        ? wordsPerSite * siteCount
+        : wordsPerSite);
+
+      for (size_t site = 0; site < siteCount; ++site)
+      {
+        // Write the position, unless it's in the site list.
+        if (!outputSpec->positionsOnce)
+        {
+          const util::Vector3D<site_t> position = GetWrittenPosition(site);
+          xdrWriter << (uint32_t) position.x << (uint32_t) position.y << (uint32_t) position.z;
+        }
+
+        const size_t firstValue = site * valuesPerSite;
+        if (outputSpec->encoding == io::formats::extraction::Float32Encoding)
+        {
+          if (valuesPerSite > 0)
+          {
+            xdrWriter.WriteArray(&values[firstValue], valuesPerSite);
+          }
+          continue;
+        }
+
+        uint32_t* const siteWords = &words[outputSpec->positionsOnce
+          ? site * wordsPerSite
+          : 0];
+        for (unsigned value = 0; value < valuesPerSite; value += 2)
+        {
+          const uint32_t high = Encode16(values[firstValue + value], value);
+          const uint32_t low = value + 1 < valuesPerSite
+            ? Encode16(values[firstValue + value + 1], value + 1)
+            : 0;
+          siteWords[value / 2] = (high << 16) | low;
+        }
+        if (!outputSpec->positionsOnce && wordsPerSite > 0)
+        {
+          xdrWriter.WriteArray(siteWords, wordsPerSite);
+        }
+      }
+
+      if (outputSpec->positionsOnce && !words.empty())
+      {
+        xdrWriter.WriteArray(&words[0], words.size());
+      }
+    }
+
+    void LocalPropertyOutput::SerialiseDeltas(unsigned long timestepNumber)
+    {
+      const unsigned fieldCount = outputSpec->fields.size();
+      std::vector<double> minimum, maximum;
+      GetFieldRanges(minimum, maximum);
+
+      // Everything deciding on a keyframe is the same on every core.
+      bool keyframe = keyframeDue || recordsSinceKeyframe >= outputSpec->keyframePeriod;
+      for (unsigned field = 0; field < fieldCount && !keyframe; ++field)
+      {
+        keyframe = minimum[field] < fieldMinimum[field] || maximum[field] > keyframeMaximum[field];
+      }
+      if (keyframe)
+      {
+        SetQuantisation(minimum, maximum);
+        keyframeMaximum = maximum;
+        previousQuantised.assign(values.size(), 0);
+        recordsSinceKeyframe = 0;
+        keyframeDue = false;
+      }
+      ++recordsSinceKeyframe;
+
+      // Quantise, take the differences from the last record, and split them into byte planes.
+      const size_t valueCount = values.size();
+      std::vector<Bytef> planes(4 * valueCount);
+      for (size_t value = 0; value < valueCount; ++value)
+      {
+        const unsigned field = fieldOfValue[value % valuesPerSite];
+        const int32_t quantised = fieldScale[field] > 0.
+          ? int32_t(std::floor( (values[value] - fieldMinimum[field]) / fieldScale[field] + 0.5))
+          : 0;
+        const int32_t difference = quantised - previousQuantised[value];
+        previousQuantised[value] = quantised;
+        const uint32_t zigzag = (uint32_t(difference) << 1) ^ uint32_t(difference >> 31);
+        planes[value] = Bytef(zigzag >> 24);
+        planes[valueCount + value] = Bytef(zigzag >> 16);
+        planes[2 * valueCount + value] = Bytef(zigzag >> 8);
+        planes[3 * valueCount + value] = Bytef(zigzag);
+      }
+
+      // Compress them, favouring speed, as the differences are mostly zero bytes anyway.
+      std::vector<Bytef> chunk;
+      if (valueCount > 0)
+      {
+        uLongf chunkLength = compressBound(planes.size());
+        chunk.resize(chunkLength);
+        if (compress2(&chunk[0], &chunkLength, &planes[0], planes.size(), Z_BEST_SPEED) != Z_OK)
+        {
+          throw Exception() << "Failed to compress the values for " << outputSpec->filename;
+        }
+        chunk.resize(chunkLength);
+      }
+
+      // The IO proc writes the record header, with every core's chunk length, before its own
+      // chunk; the other cores' chunks follow in rank order.
+      const uint32_t chunkLength = chunk.size();
+      const std::vector<uint32_t> chunkLengths = comms.Gather(chunkLength, comms.GetIORank());
+      const uint64_t headerLength = comms.OnIORank()
+        ? 8 + 4 + 16 * fieldCount + 4 + 4 * comms.Size()
+        : 0;
+      writeLength = headerLength + 4 * ( (chunkLength + 3) / 4);
+      localRecordOffset = comms.ExScan(writeLength, MPI_SUM);
+      allCoresWriteLength = comms.AllReduce(writeLength, MPI_SUM);
+
+      buffer.assign(writeLength, 0);
+      if (comms.OnIORank())
+      {
+        io::writers::xdr::XdrMemWriter xdrWriter(&buffer[0], headerLength);
+        xdrWriter << (uint64_t) timestepNumber << uint32_t(keyframe
+          ? 1
+          : 0);
+        for (unsigned field = 0; field < fieldCount; ++field)
+        {
+          xdrWriter << fieldMinimum[field] << fieldScale[field];
+        }
+        xdrWriter << uint32_t(comms.Size());
+        xdrWriter.WriteArray(&chunkLengths[0], chunkLengths.size());
+      }
+      if (chunkLength > 0)
+      {
+        std::memcpy(&buffer[headerLength], &chunk[0], chunkLength);
+      }
+    }
+
+    uint16_t LocalPropertyOutput::Encode16(WrittenDataType value, unsigned valueNumber) const
+    {
+      if (outputSpec->encoding == io::formats::extraction::Float16Encoding)
+      {
+        return util::FloatToHalf(value);
+      }
+
+      const unsigned field = fieldOfValue[valueNumber];
+      if (fieldScale[field] <= 0.)
+      {
+        return 0;
+      }
+      const double quantised = std::floor( (value - fieldMinimum[field]) / fieldScale[field] + 0.5);
+      return uint16_t(std::max(0., std::min(65535., quantised)));
+    }
+
+    void LocalPropertyOutput::GetFieldRanges(std::vector<double>& minimum,
+                                             std::vector<double>& maximum) const
+    {
+      const unsigned fieldCount = outputSpec->fields.size();
+      std::vector<double> localMinimum(fieldCount, std::numeric_limits<double>::max());
+      std::vector<double> localMaximum(fieldCount, -std::numeric_limits<double>::max());
+      for (size_t value = 0; value < values.size(); ++value)
+      {
+        const unsigned field = fieldOfValue[value % valuesPerSite];
+        localMinimum[field] = std::min(localMinimum[field], double(values[value]));
+        localMaximum[field] = std::max(localMaximum[field], double(values[value]));
+      }
+
+      minimum = comms.AllReduce(localMinimum, MPI_MIN);
+      maximum = comms.AllReduce(localMaximum, MPI_MAX);
+    }
+
+    void LocalPropertyOutput::SetQuantisation(const std::vector<double>& minimum,
+                                              const std::vector<double>& maximum)
+    {
+      const unsigned fieldCount = outputSpec->fields.size();
+      fieldMinimum = minimum;
+
+      // The 65536 levels of a uint16 span each field's range. A field that is the same
+      // everywhere (or that no core has) needs none.
+      fieldScale.resize(fieldCount);
+      for (unsigned field = 0; field < fieldCount; ++field)
+      {
+        if (maximum[field] > fieldMinimum[field])
+        {
+          fieldScale[field] = (maximum[field] - fieldMinimum[field]) / 65535.;
+        }
+        else
+        {
+          fieldScale[field] = 0.;
+          if (maximum[field] < fieldMinimum[field])
+          {
+            fieldMinimum[field] = 0.;
+          }
+        }
+      }
     }
 
     unsigned LocalPropertyOutput::GetFieldLength(OutputField::FieldType field)
@@ -279,10 +1012,14 @@ namespace hemelb
         case OutputField::ShearStress:
         case OutputField::ShearRate:
         case OutputField::MpiRank:
+        case OutputField::AveragedShearStress:
+        case OutputField::OscillatoryShearIndex:
           return 1;
         case OutputField::Velocity:
         case OutputField::Traction:
         case OutputField::TangentialProjectionTraction:
+        case OutputField::AveragedVelocity:
+        case OutputField::VelocityRms:
           return 3;
         case OutputField::StressTensor:
           return 6; // We only store the upper triangular part of the symmetric tensor
@@ -294,6 +1031,30 @@ namespace hemelb
       }
     }
 
+    unsigned LocalPropertyOutput::GetAccumulatorLength(OutputField::FieldType field)
+    {
+      switch (field)
+      {
+        case OutputField::AveragedShearStress:
+          return 1;
+        case OutputField::AveragedVelocity:
+          return 3;
+        case OutputField::OscillatoryShearIndex:
+          return 4; // The shear stress vector and its magnitude
+        case OutputField::VelocityRms:
+          return 6; // The velocity and its square
+        default:
+          return 0;
+      }
+    }
+
+    double LocalPropertyOutput::GetMean(size_t accumulator) const
+    {
+      return sampleCount == 0
+        ? 0.
+        : accumulators[accumulator] / sampleCount;
+    }
+
     double LocalPropertyOutput::GetOffset(OutputField::FieldType field) const
     {
       switch (field)
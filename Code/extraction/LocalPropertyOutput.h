@@ -7,10 +7,18 @@
 #ifndef HEMELB_EXTRACTION_LOCALPROPERTYOUTPUT_H
 #define HEMELB_EXTRACTION_LOCALPROPERTYOUTPUT_H
 
+#include <vector>
+#include "extraction/BlockAverager.h"
 #include "extraction/IterableDataSource.h"
+#include "extraction/OutputTriggerMonitor.h"
 #include "extraction/PropertyOutputFile.h"
+#include "extraction/SiteFieldValues.h"
+#include "io/SubfileGroup.h"
 #include "net/mpi.h"
 #include "net/MpiFile.h"
+#ifdef HEMELB_USE_HDF5
+#include "extraction/Hdf5OutputFile.h"
+#endif
 
 namespace hemelb
 {
@@ -41,24 +49,207 @@ namespace hemelb
         ~LocalPropertyOutput();
 
         /**
-         * True if this property output should be written on the current iteration.
+         * True if this property output should be written on the current iteration: every
+         * period, and whenever one of its triggers fires.
          * @return
          */
         bool ShouldWrite(unsigned long timestepNumber) const;
 
+        /**
+         * Take the latest value of a monitored quantity, before the step's properties are
+         * worked out, so that a trigger on it can make this step be written.
+         * @param quantity
+         * @param value
+         * @param timestepNumber
+         */
+        void Monitor(OutputTrigger::Quantity quantity, double value, unsigned long timestepNumber);
+
+        /**
+         * True if this property output has accumulated fields (averages etc.) and should sample
+         * them on the current iteration.
+         * @return
+         */
+        bool ShouldSample(unsigned long timestepNumber) const;
+
+        /**
+         * Add the current values to the accumulated fields, if this is an iteration to sample
+         * on. The records then hold the statistics over the samples since the previous record.
+         * @param timestepNumber
+         * @param fields The iteration's field values, at sites including the selected ones.
+         */
+        void Sample(unsigned long timestepNumber, SiteFieldValues& fields);
+        /**
+         * As above, getting the fields at just this output's sites.
+         * @param timestepNumber
+         */
+        void Sample(unsigned long timestepNumber);
+
         /**
          * Returns the property output file object to be written.
          * @return
          */
         const PropertyOutputFile* GetOutputSpec() const;
 
+        /**
+         * Returns the indices, in the data source's order, of the local sites this output
+         * includes, in ascending order.
+         * @return
+         */
+        const std::vector<site_t>& GetSelectedSites() const;
+
         /**
          * Write this core's section of the data file. Only writes if appropriate for the current
-         * iteration number
+         * iteration number. A collective operation, as all the cores write together with
+         * MPI_File_write_at_all.
+         *
+         * With HEMELB_USE_ASYNC_EXTRACTION_WRITES, the write is only started here, and goes on
+         * while the simulation does. The next iteration's data goes into a second buffer, so this
+         * only has to wait if the previous write still hasn't finished by the time the next one
+         * is due.
+         * @param timestepNumber
+         * @param fields The iteration's field values, at sites including the selected ones.
+         */
+        void Write(unsigned long timestepNumber, SiteFieldValues& fields);
+        /**
+         * As above, getting the fields at just this output's sites.
+         * @param timestepNumber
          */
         void Write(unsigned long timestepNumber);
 
+        /**
+         * Switch to a new data source, once the sites have been redistributed between the cores.
+         * Each core's part of the later iterations moves, but the file carries on from the
+         * iteration it had got to. A collective operation.
+         *
+         * The accumulated fields start again from the new data source's sites, so the next
+         * record's statistics only cover the samples taken after this.
+         * @param newDataSource
+         */
+        void SetDataSource(IterableDataSource& newDataSource);
+
       private:
+        /**
+         * Type of written values
+         */
+        typedef float WrittenDataType;
+
+        /**
+         * Wait for the write in progress, if there is one.
+         */
+        void FinishWriting();
+
+        /**
+         * Work out how much each core writes, and where, for the current data source. A
+         * collective operation.
+         * @param siteCount The number of local sites included.
+         */
+        void CalculateWriteLengths(uint64_t siteCount);
+
+        /**
+         * Write the positions of the sites in the list of their own, for the formats in which
+         * they aren't in every record.
+         */
+        void WriteSiteList();
+
+        /**
+         * Get the field values of the selected sites for the iteration.
+         * @param fields
+         */
+        void CollectValues(SiteFieldValues& fields);
+
+        /**
+         * Find each field's range over all the cores. A collective operation.
+         * @param minimum
+         * @param maximum
+         */
+        void GetFieldRanges(std::vector<double>& minimum, std::vector<double>& maximum) const;
+
+        /**
+         * Set the minimum of each field, and the scale to quantise it with, for the given ranges.
+         * @param minimum
+         * @param maximum
+         */
+        void SetQuantisation(const std::vector<double>& minimum,
+                             const std::vector<double>& maximum);
+
+        /**
+         * Fill the buffer with this core's data for the iteration.
+         * @param timestepNumber
+         */
+        void Serialise(unsigned long timestepNumber);
+
+        /**
+         * Fill the buffer with this core's part of a DeltaEncoding record, and work out where it
+         * goes. A collective operation, as the record's length isn't known in advance.
+         *
+         * A record is a keyframe when the keyframe period is up, after the sites move, and when
+         * any field has gone outside its range at the last keyframe, so that the quantisation
+         * keeps its resolution.
+         * @param timestepNumber
+         */
+        void SerialiseDeltas(unsigned long timestepNumber);
+
+        /**
+         * Encode a value in 16 bits, as a half or quantised.
+         * @param value
+         * @param valueNumber Which of a site's values it is.
+         * @return
+         */
+        uint16_t Encode16(WrittenDataType value, unsigned valueNumber) const;
+
+        /**
+         * Find the local sites this output includes. The geometry is fixed, so this only needs
+         * doing once per data source.
+         */
+        void SelectLocalSites();
+
+        /**
+         * Returns the number of sites this core writes: the selected sites, or the blocks this
+         * core owns when averaging over blocks.
+         * @return
+         */
+        uint64_t GetWrittenSiteCount() const;
+
+        /**
+         * Returns the lattice position of one of the sites this core writes.
+         * @param site
+         * @return
+         */
+        util::Vector3D<site_t> GetWrittenPosition(size_t site);
+
+        /**
+         * Returns the number of bytes this core writes in each iteration.
+         * @param siteCount The number of local sites included.
+         * @return
+         */
+        uint64_t GetLocalWriteLength(uint64_t siteCount);
+
+        /**
+         * Returns the number of bytes this core writes in a site list.
+         * @param siteCount The number of local sites included.
+         * @return
+         */
+        uint64_t GetLocalSiteListLength(uint64_t siteCount);
+
+        /**
+         * Size and zero the accumulators for the selected sites.
+         */
+        void ResetAccumulators();
+
+        /**
+         * Returns the number of accumulators each site needs for the field, 0 for those that
+         * aren't accumulated.
+         * @param field
+         */
+        unsigned GetAccumulatorLength(OutputField::FieldType field);
+
+        /**
+         * Returns the average over the samples of the given accumulator.
+         * @param accumulator
+         * @return
+         */
+        double GetMean(size_t accumulator) const;
+
         /**
          * Returns the number of floats written for the field.
          * @param field
@@ -72,7 +263,17 @@ namespace hemelb
          */
         double GetOffset(OutputField::FieldType field) const;
 
+        /**
+         * The cores that write the same part of the file as this one, all of them if it isn't
+         * split.
+         */
+        const io::SubfileGroup subfiles;
+        //! This core's rank among all the cores writing the file, for the MpiRank field.
+        const int rank;
+        //! The cores writing this core's part of the file.
         const net::IOCommunicator& comms;
+        //! The number of sites in this core's part of the file, which is fixed once written.
+        uint64_t partSiteCount;
         /**
          * The MPI file to write into.
          */
@@ -81,7 +282,7 @@ namespace hemelb
         /**
          * The data source to use for file output.
          */
-        IterableDataSource& dataSource;
+        IterableDataSource* dataSource;
 
         /**
          * PropertyOutputFile spec.
@@ -89,9 +290,79 @@ namespace hemelb
         const PropertyOutputFile* outputSpec;
 
         /**
-         * Where to begin writing into the file.
+         * Works out when the output's triggers fire.
          */
-        uint64_t localDataOffsetIntoFile;
+        OutputTriggerMonitor triggerMonitor;
+
+        /**
+         * The indices of the local sites this output includes.
+         */
+        std::vector<site_t> selectedSites;
+
+        /**
+         * Averages the selected sites' values over blocks, for BlockAverageDecimation, or NULL.
+         */
+        BlockAverager* blockAverager;
+
+        /**
+         * For surface site lists, the wall normal of each selected site and the area of wall it
+         * stands for.
+         */
+        std::vector<util::Vector3D<float> > siteNormals;
+        std::vector<float> siteAreas;
+
+        /**
+         * The running sums behind the accumulated fields, accumulatorsPerSite for each selected
+         * site, with each field's in the order of the fields.
+         */
+        std::vector<double> accumulators;
+        unsigned accumulatorsPerSite;
+
+        /**
+         * The number of samples in the accumulators.
+         */
+        unsigned long sampleCount;
+
+        /**
+         * The field values of the selected sites, valuesPerSite for each, in order.
+         */
+        std::vector<WrittenDataType> values;
+        unsigned valuesPerSite;
+
+        /**
+         * Which field each of a site's values belongs to.
+         */
+        std::vector<unsigned> fieldOfValue;
+
+        /**
+         * The minimum of each field over all the cores, and the scale of its quantised values,
+         * for Fixed16Encoding.
+         */
+        std::vector<double> fieldMinimum;
+        std::vector<double> fieldScale;
+
+        /**
+         * For DeltaEncoding, each field's maximum at the last keyframe, the quantised values of
+         * the last record, and the number of records since the last keyframe.
+         */
+        std::vector<double> keyframeMaximum;
+        std::vector<int32_t> previousQuantised;
+        unsigned long recordsSinceKeyframe;
+
+        /**
+         * Whether the next DeltaEncoding record must be a keyframe, as the sites have changed.
+         */
+        bool keyframeDue;
+
+        /**
+         * Where the next record or site list begins in the file.
+         */
+        uint64_t nextBlockOffset;
+
+        /**
+         * Where this core's part of each record begins, from the start of the record.
+         */
+        uint64_t localRecordOffset;
 
         /**
          * The length, in bytes, of the local write.
@@ -103,15 +374,45 @@ namespace hemelb
          */
         uint64_t allCoresWriteLength;
 
+        /**
+         * Where this core's part of a site list begins, from the start of the list.
+         */
+        uint64_t localSiteListOffset;
+
+        /**
+         * The lengths, in bytes, of this core's part of a site list and of the whole list.
+         */
+        uint64_t siteListLength;
+        uint64_t allCoresSiteListLength;
+
+        /**
+         * Whether a site list must be written before the next record.
+         */
+        bool siteListDue;
+
         /**
          * Buffer to write into before writing to disk.
          */
         std::vector<char> buffer;
 
+#ifdef HEMELB_USE_HDF5
         /**
-         * Type of written values
+         * The file to write to instead of outputFile, for HDF5 output, or NULL.
          */
-        typedef float WrittenDataType;
+        Hdf5OutputFile* hdf5File;
+#endif
+
+#ifdef HEMELB_USE_ASYNC_EXTRACTION_WRITES
+        /**
+         * The buffer being written from, if there is a write in progress.
+         */
+        std::vector<char> writingBuffer;
+
+        /**
+         * The write in progress, or MPI_REQUEST_NULL.
+         */
+        MPI_Request pendingWrite;
+#endif
     };
   }
 }
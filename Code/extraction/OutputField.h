@@ -7,6 +7,8 @@
 #ifndef HEMELB_EXTRACTION_OUTPUTFIELD_H
 #define HEMELB_EXTRACTION_OUTPUTFIELD_H
 
+#include <string>
+
 namespace hemelb
 {
   namespace extraction
@@ -24,11 +26,30 @@ namespace hemelb
           StressTensor,
           Traction,
           TangentialProjectionTraction,
-          MpiRank
+          MpiRank,
+          // The rest are statistics over the samples taken since the last record, rather than
+          // the values at the time of writing.
+          //! Time-averaged wall shear stress magnitude (TAWSS).
+          AveragedShearStress,
+          //! Oscillatory shear index, from the tangential projection of the traction.
+          OscillatoryShearIndex,
+          //! Time-averaged velocity.
+          AveragedVelocity,
+          //! Root mean square of each velocity component's fluctuation about its average.
+          VelocityRms
         };
 
         std::string name;
         FieldType type;
+
+        /**
+         * Whether the field is accumulated from samples between records.
+         * @return
+         */
+        bool IsAccumulated() const
+        {
+          return type >= AveragedShearStress;
+        }
     };
   }
 }
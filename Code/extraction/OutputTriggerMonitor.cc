@@ -0,0 +1,71 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <cmath>
+#include "extraction/OutputTriggerMonitor.h"
+
+namespace hemelb
+{
+  namespace extraction
+  {
+    OutputTriggerMonitor::OutputTriggerMonitor(const std::vector<OutputTrigger>& triggers) :
+        triggers(triggers), states(triggers.size()), hasFired(false), lastFiredStep(0)
+    {
+      for (size_t trigger = 0; trigger < states.size(); ++trigger)
+      {
+        states[trigger].hasPrevious = false;
+        states[trigger].previous = 0.;
+        states[trigger].rising = false;
+      }
+    }
+
+    void OutputTriggerMonitor::Update(OutputTrigger::Quantity quantity, double value,
+                                      unsigned long timestepNumber)
+    {
+      for (size_t trigger = 0; trigger < triggers.size(); ++trigger)
+      {
+        const OutputTrigger& condition = triggers[trigger];
+        TriggerState& state = states[trigger];
+        if (condition.quantity != quantity)
+        {
+          continue;
+        }
+
+        bool met = false;
+        if (state.hasPrevious)
+        {
+          switch (condition.condition)
+          {
+            case OutputTrigger::Above:
+              met = state.previous <= condition.threshold && value > condition.threshold;
+              break;
+            case OutputTrigger::RelativeChange:
+              met = std::abs(value - state.previous)
+                  > condition.threshold * std::abs(state.previous);
+              break;
+            case OutputTrigger::Peak:
+              met = state.rising && value < state.previous
+                  && state.previous > condition.threshold;
+              break;
+          }
+          state.rising = value > state.previous;
+        }
+        state.hasPrevious = true;
+        state.previous = value;
+
+        if (met && (!hasFired || timestepNumber >= lastFiredStep + condition.holdoff))
+        {
+          hasFired = true;
+          lastFiredStep = timestepNumber;
+        }
+      }
+    }
+
+    bool OutputTriggerMonitor::HasFired(unsigned long timestepNumber) const
+    {
+      return hasFired && lastFiredStep == timestepNumber;
+    }
+  }
+}
@@ -0,0 +1,64 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_EXTRACTION_OUTPUTTRIGGERMONITOR_H
+#define HEMELB_EXTRACTION_OUTPUTTRIGGERMONITOR_H
+
+#include <vector>
+#include "extraction/PropertyOutputFile.h"
+
+namespace hemelb
+{
+  namespace extraction
+  {
+    /**
+     * Follows the monitored quantities an output's triggers are on, and works out which steps
+     * they fire on.
+     */
+    class OutputTriggerMonitor
+    {
+      public:
+        /**
+         * @param triggers
+         */
+        OutputTriggerMonitor(const std::vector<OutputTrigger>& triggers);
+
+        /**
+         * Take the latest value of a monitored quantity, on the given step, and fire any of the
+         * triggers on it whose condition it meets, unless one fired too recently.
+         * @param quantity
+         * @param value
+         * @param timestepNumber
+         */
+        void Update(OutputTrigger::Quantity quantity, double value, unsigned long timestepNumber);
+
+        /**
+         * True if a trigger fired on the given step.
+         * @param timestepNumber
+         * @return
+         */
+        bool HasFired(unsigned long timestepNumber) const;
+
+      private:
+        /**
+         * What each trigger has seen of its quantity so far.
+         */
+        struct TriggerState
+        {
+            bool hasPrevious;
+            double previous;
+            bool rising;
+        };
+
+        std::vector<OutputTrigger> triggers;
+        std::vector<TriggerState> states;
+        //! Whether a trigger has fired yet, and the step it last did.
+        bool hasFired;
+        unsigned long lastFiredStep;
+    };
+  }
+}
+
+#endif /* HEMELB_EXTRACTION_OUTPUTTRIGGERMONITOR_H */
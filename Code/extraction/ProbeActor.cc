@@ -0,0 +1,243 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+#include <cmath>
+#include "extraction/ProbeActor.h"
+#include "net/MpiGroup.h"
+#include "Exception.h"
+
+namespace hemelb
+{
+  namespace extraction
+  {
+    ProbeActor::ProbeActor(const lb::SimulationState& simulationState,
+                           const ProbeOutputFile* outputSpec, IterableDataSource& dataSource,
+                           reporting::Timers& timers, const net::IOCommunicator& ioComms) :
+        simulationState(simulationState), outputSpec(outputSpec), dataSource(&dataSource),
+            timers(timers), comms(ioComms), probeRoot(0), sampleCount(0)
+    {
+      // Enough room for the samples of one gather period.
+      const unsigned long samplesPerGather = std::max(1UL,
+                                                      (outputSpec->gatherPeriod
+                                                          + outputSpec->samplePeriod - 1)
+                                                          / outputSpec->samplePeriod);
+      samples.resize(samplesPerGather * outputSpec->points.size() * ValuesPerProbe, 0.);
+      sampleSteps.resize(samplesPerGather);
+
+      ResolveStencils();
+
+      if (comms.OnIORank())
+      {
+        output.open(outputSpec->filename.c_str());
+        if (!output)
+        {
+          throw Exception() << "Could not open probe output file " << outputSpec->filename;
+        }
+        output << "# Time step, then the pressure (mmHg) and velocity (m/s) of each probe:\n";
+        for (unsigned probe = 0; probe < outputSpec->points.size(); ++probe)
+        {
+          output << "# " << probe << " at " << outputSpec->points[probe] << " m\n";
+        }
+        output.precision(8);
+      }
+    }
+
+    void ProbeActor::ResolveStencils()
+    {
+      const unsigned probeCount = outputSpec->points.size();
+
+      // The lattice site at the low corner of each probe's cell, and how far into the cell the
+      // probe is along each axis.
+      std::vector<util::Vector3D<site_t> > corners(probeCount);
+      std::vector<util::Vector3D<double> > fractions(probeCount);
+      for (unsigned probe = 0; probe < probeCount; ++probe)
+      {
+        const util::Vector3D<double> position = (util::Vector3D<double>(outputSpec->points[probe])
+            - util::Vector3D<double>(dataSource->GetOrigin())) / dataSource->GetVoxelSize();
+        for (unsigned axis = 0; axis < 3; ++axis)
+        {
+          corners[probe][axis] = site_t(std::floor(position[axis]));
+          fractions[probe][axis] = position[axis] - corners[probe][axis];
+        }
+      }
+
+      // The stencils are fixed, so one pass over the sites finds them, in site order.
+      stencil.clear();
+      stencilSites.clear();
+      std::vector<double> localWeights(probeCount, 0.);
+      site_t siteIndex = 0;
+      dataSource->Reset();
+      while (dataSource->ReadNext())
+      {
+        const util::Vector3D<site_t> position = dataSource->GetPosition();
+        for (unsigned probe = 0; probe < probeCount; ++probe)
+        {
+          const util::Vector3D<site_t> offset = position - corners[probe];
+          if (offset.x < 0 || offset.x > 1 || offset.y < 0 || offset.y > 1 || offset.z < 0
+              || offset.z > 1)
+          {
+            continue;
+          }
+
+          StencilSite stencilSite;
+          stencilSite.site = siteIndex;
+          stencilSite.probe = probe;
+          stencilSite.weight = 1.;
+          for (unsigned axis = 0; axis < 3; ++axis)
+          {
+            stencilSite.weight *= offset[axis] == 1
+              ? fractions[probe][axis]
+              : 1. - fractions[probe][axis];
+          }
+          stencil.push_back(stencilSite);
+          localWeights[probe] += stencilSite.weight;
+          if (stencilSites.empty() || stencilSites.back() != siteIndex)
+          {
+            stencilSites.push_back(siteIndex);
+          }
+        }
+        ++siteIndex;
+      }
+
+      // Scale the weights so that each probe's add up to one over the sites there are.
+      const std::vector<double> totalWeights = comms.AllReduce(localWeights, MPI_SUM);
+      for (unsigned probe = 0; probe < probeCount; ++probe)
+      {
+        if (totalWeights[probe] <= 0.)
+        {
+          throw Exception() << "Probe " << probe << " at " << outputSpec->points[probe]
+              << " has no fluid sites around it";
+        }
+      }
+      for (size_t site = 0; site < stencil.size(); ++site)
+      {
+        stencil[site].weight /= totalWeights[stencil[site].probe];
+      }
+
+      // Only the cores with stencil sites, and the IO core, take part in gathering.
+      const int involved = comms.OnIORank() || !stencil.empty();
+      const std::vector<int> allInvolved = comms.AllGather(involved);
+      std::vector<proc_t> probeRanks;
+      for (int rank = 0; rank < comms.Size(); ++rank)
+      {
+        if (allInvolved[rank])
+        {
+          if (rank == comms.GetIORank())
+          {
+            probeRoot = probeRanks.size();
+          }
+          probeRanks.push_back(rank);
+        }
+      }
+      probeComms = comms.Create(comms.Group().Include(probeRanks));
+    }
+
+    bool ProbeActor::ShouldSample(unsigned long timestepNumber) const
+    {
+      return timestepNumber % outputSpec->samplePeriod == 0;
+    }
+
+    void ProbeActor::SetRequiredProperties(lb::MacroscopicPropertyCache& propertyCache)
+    {
+      if (!stencil.empty() && ShouldSample(simulationState.GetTimeStep()))
+      {
+        propertyCache.densityCache.SetRefreshFlag();
+        propertyCache.velocityCache.SetRefreshFlag();
+      }
+    }
+
+    const std::vector<site_t>& ProbeActor::GetStencilSites() const
+    {
+      return stencilSites;
+    }
+
+    void ProbeActor::SetDataSource(IterableDataSource& newDataSource)
+    {
+      // The samples so far are in terms of the old stencils.
+      Gather();
+      dataSource = &newDataSource;
+      ResolveStencils();
+    }
+
+    void ProbeActor::Flush()
+    {
+      Gather();
+    }
+
+    void ProbeActor::EndIteration()
+    {
+      const unsigned long timestepNumber = simulationState.GetTimeStep();
+      if (!ShouldSample(timestepNumber))
+      {
+        return;
+      }
+
+      timers[reporting::Timers::extractionWriting].Start();
+      double* const sample = &samples[sampleCount * outputSpec->points.size() * ValuesPerProbe];
+      std::vector<FloatingType> pressures, velocities;
+      dataSource->GetField(OutputField::Pressure, stencilSites, pressures);
+      dataSource->GetField(OutputField::Velocity, stencilSites, velocities);
+      size_t uniqueSite = 0;
+      for (size_t site = 0; site < stencil.size(); ++site)
+      {
+        // A site can be in several stencils, one after another.
+        if (site > 0 && stencil[site].site != stencil[site - 1].site)
+        {
+          ++uniqueSite;
+        }
+        const double weight = stencil[site].weight;
+        const FloatingType* const velocity = &velocities[3 * uniqueSite];
+        double* const values = sample + stencil[site].probe * ValuesPerProbe;
+        values[0] += weight * pressures[uniqueSite];
+        values[1] += weight * velocity[0];
+        values[2] += weight * velocity[1];
+        values[3] += weight * velocity[2];
+      }
+      sampleSteps[sampleCount] = timestepNumber;
+      ++sampleCount;
+
+      if (sampleCount == sampleSteps.size())
+      {
+        Gather();
+      }
+      timers[reporting::Timers::extractionWriting].Stop();
+    }
+
+    void ProbeActor::Gather()
+    {
+      if (sampleCount == 0)
+      {
+        return;
+      }
+
+      const unsigned probeCount = outputSpec->points.size();
+      if (probeComms)
+      {
+        const std::vector<double> localSamples(samples.begin(),
+                                               samples.begin()
+                                                   + sampleCount * probeCount * ValuesPerProbe);
+        const std::vector<double> totals = probeComms.Reduce(localSamples, MPI_SUM, probeRoot);
+
+        if (comms.OnIORank())
+        {
+          for (unsigned sample = 0; sample < sampleCount; ++sample)
+          {
+            output << sampleSteps[sample];
+            for (unsigned value = 0; value < probeCount * ValuesPerProbe; ++value)
+            {
+              output << ' ' << totals[sample * probeCount * ValuesPerProbe + value];
+            }
+            output << '\n';
+          }
+          output.flush();
+        }
+      }
+
+      samples.assign(samples.size(), 0.);
+      sampleCount = 0;
+    }
+  }
+}
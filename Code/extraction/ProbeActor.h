@@ -0,0 +1,141 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_EXTRACTION_PROBEACTOR_H
+#define HEMELB_EXTRACTION_PROBEACTOR_H
+
+#include <fstream>
+#include <vector>
+#include "extraction/IterableDataSource.h"
+#include "extraction/ProbeOutputFile.h"
+#include "lb/MacroscopicPropertyCache.h"
+#include "lb/SimulationState.h"
+#include "net/IOCommunicator.h"
+#include "net/IteratedAction.h"
+#include "reporting/Timers.h"
+
+namespace hemelb
+{
+  namespace extraction
+  {
+    /**
+     * Records the pressure and velocity at a few points, trilinearly interpolated from the
+     * eight sites around each, without going through the property output files.
+     *
+     * Each probe is resolved once to the cores that have sites of its stencil, and the weight
+     * of each site. Every sample, those cores add their sites' weighted values into a buffer of
+     * their own; nothing is communicated. Once every gather period, the cores with any stencil
+     * sites sum their buffers onto the IO core, which appends the samples to the file. So the
+     * probes cost a few reads of the property cache per step and one small reduction, between
+     * only the cores involved, per gather.
+     *
+     * Stencil sites that aren't fluid are left out, with the weights of the others scaled up to
+     * make up for them. The file has a line per sample: the time step, then the pressure (mmHg)
+     * and velocity (m/s) of each probe in turn.
+     */
+    class ProbeActor : public net::IteratedAction
+    {
+      public:
+        /**
+         * Resolve the probes' stencils and open the file. Collective.
+         * @param simulationState
+         * @param outputSpec
+         * @param dataSource
+         * @param timers
+         * @param ioComms
+         */
+        ProbeActor(const lb::SimulationState& simulationState, const ProbeOutputFile* outputSpec,
+                   IterableDataSource& dataSource, reporting::Timers& timers,
+                   const net::IOCommunicator& ioComms);
+
+        /**
+         * True if the probes are sampled on the given time step.
+         * @param timestepNumber
+         * @return
+         */
+        bool ShouldSample(unsigned long timestepNumber) const;
+
+        /**
+         * Set which properties will be required this iteration.
+         * @param propertyCache
+         */
+        void SetRequiredProperties(lb::MacroscopicPropertyCache& propertyCache);
+
+        /**
+         * Returns the indices, in the data source's order, of the local stencil sites, in
+         * ascending order.
+         * @return
+         */
+        const std::vector<site_t>& GetStencilSites() const;
+
+        /**
+         * Read from a new data source, once the sites have been redistributed between the cores.
+         * The samples so far are written first, and the stencils resolved again. Collective.
+         * @param newDataSource
+         */
+        void SetDataSource(IterableDataSource& newDataSource);
+
+        /**
+         * Write out the samples not yet written. Collective.
+         */
+        void Flush();
+
+        /**
+         * Sample the probes, and gather the samples if the buffer is full.
+         */
+        void EndIteration();
+
+      private:
+        /**
+         * The number of values recorded for each probe: the pressure and the velocity.
+         */
+        static const unsigned ValuesPerProbe = 4;
+
+        /**
+         * One of the local sites of a probe's stencil.
+         */
+        struct StencilSite
+        {
+            site_t site;
+            unsigned probe;
+            //! The weight of the site in the probe's value, scaled so that the probe's weights
+            //! over all the cores add up to one.
+            double weight;
+        };
+
+        /**
+         * Find the local sites of each probe's stencil, and the cores to gather from. Collective.
+         */
+        void ResolveStencils();
+
+        /**
+         * Sum the samples so far onto the IO core and write them. Collective over the cores with
+         * stencil sites.
+         */
+        void Gather();
+
+        const lb::SimulationState& simulationState;
+        const ProbeOutputFile* outputSpec;
+        IterableDataSource* dataSource;
+        reporting::Timers& timers;
+        const net::IOCommunicator& comms;
+        std::vector<StencilSite> stencil;
+        std::vector<site_t> stencilSites;
+        //! The cores with stencil sites and the IO core, or a null communicator on the others.
+        net::MpiCommunicator probeComms;
+        //! The rank of the IO core in probeComms.
+        int probeRoot;
+        //! The weighted sums of the local sites' values, for each sample, probe and value.
+        std::vector<double> samples;
+        //! The time step of each sample.
+        std::vector<unsigned long> sampleSteps;
+        unsigned sampleCount;
+        //! The output file, on the IO core.
+        std::ofstream output;
+    };
+  }
+}
+
+#endif /* HEMELB_EXTRACTION_PROBEACTOR_H */
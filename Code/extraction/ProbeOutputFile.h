@@ -0,0 +1,40 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_EXTRACTION_PROBEOUTPUTFILE_H
+#define HEMELB_EXTRACTION_PROBEOUTPUTFILE_H
+
+#include <string>
+#include <vector>
+#include "units.h"
+
+namespace hemelb
+{
+  namespace extraction
+  {
+    /**
+     * A set of points to record the pressure and velocity at, as often as every time step, in
+     * one text file.
+     */
+    struct ProbeOutputFile
+    {
+        ProbeOutputFile()
+        {
+          samplePeriod = 1;
+          gatherPeriod = 1000;
+        }
+
+        std::string filename;
+        //! How often to sample the probes, in time steps.
+        unsigned long samplePeriod;
+        //! How often to collect the samples and write them out, in time steps.
+        unsigned long gatherPeriod;
+        //! Where the probes are, in metres.
+        std::vector<PhysicalPosition> points;
+    };
+  }
+}
+
+#endif /* HEMELB_EXTRACTION_PROBEOUTPUTFILE_H */
@@ -4,6 +4,8 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <algorithm>
+#include <iterator>
 #include "extraction/PropertyActor.h"
 
 namespace hemelb
@@ -15,7 +17,7 @@ namespace hemelb
                                  IterableDataSource& dataSource,
                                  reporting::Timers& timers,
                                  const net::IOCommunicator& ioComms) :
-        simulationState(simulationState), timers(timers)
+        simulationState(simulationState), dataSource(&dataSource), timers(timers)
     {
       propertyWriter = new PropertyWriter(dataSource, propertyOutputs, ioComms);
     }
@@ -34,14 +36,25 @@ namespace hemelb
       {
         const LocalPropertyOutput* propertyOutput = propertyOutputs[output];
 
-        // Only consider the ones that are being written this iteration.
-        if (propertyOutput->ShouldWrite(simulationState.GetTimeStep()))
+        // Only consider the ones that are being written or sampled this iteration.
+        const bool writing = propertyOutput->ShouldWrite(simulationState.GetTimeStep());
+        const bool sampling = propertyOutput->ShouldSample(simulationState.GetTimeStep());
+        if (writing || sampling)
         {
           const PropertyOutputFile* outputFile = propertyOutput->GetOutputSpec();
 
           // Iterate over each field.
           for (unsigned outputField = 0; outputField < outputFile->fields.size(); ++outputField)
           {
+            // The accumulated fields need their properties when sampling, the others when
+            // writing.
+            if (outputFile->fields[outputField].IsAccumulated()
+              ? !sampling
+              : !writing)
+            {
+              continue;
+            }
+
             // Set the cache to calculate each required field.
             switch (outputFile->fields[outputField].type)
             {
@@ -49,9 +62,12 @@ namespace hemelb
                 propertyCache.densityCache.SetRefreshFlag();
                 break;
               case OutputField::Velocity:
+              case OutputField::AveragedVelocity:
+              case OutputField::VelocityRms:
                 propertyCache.velocityCache.SetRefreshFlag();
                 break;
               case OutputField::ShearStress:
+              case OutputField::AveragedShearStress:
                 propertyCache.wallShearStressMagnitudeCache.SetRefreshFlag();
                 break;
               case OutputField::VonMisesStress:
@@ -67,6 +83,7 @@ namespace hemelb
                 propertyCache.tractionCache.SetRefreshFlag();
                 break;
               case OutputField::TangentialProjectionTraction:
+              case OutputField::OscillatoryShearIndex:
                 propertyCache.tangentialProjectionTractionCache.SetRefreshFlag();
                 break;
               case OutputField::MpiRank:
@@ -82,10 +99,45 @@ namespace hemelb
       }
     }
 
+    void PropertyActor::RestrictCacheToRequiredSites(lb::MacroscopicPropertyCache& propertyCache,
+                                                     const std::vector<site_t>& otherSites)
+    {
+      const std::vector<LocalPropertyOutput*>& propertyOutputs = propertyWriter->GetPropertyOutputs();
+
+      // Each output has already found the sites it includes, so the cache needs the union of
+      // those (each in ascending order) rather than another pass over every site.
+      std::vector<site_t> requiredSites(otherSites);
+      for (unsigned output = 0; output < propertyOutputs.size(); ++output)
+      {
+        const std::vector<site_t>& selectedSites = propertyOutputs[output]->GetSelectedSites();
+        std::vector<site_t> merged;
+        merged.reserve(requiredSites.size() + selectedSites.size());
+        std::set_union(requiredSites.begin(),
+                       requiredSites.end(),
+                       selectedSites.begin(),
+                       selectedSites.end(),
+                       std::back_inserter(merged));
+        requiredSites.swap(merged);
+      }
+
+      propertyCache.RestrictToSites(requiredSites);
+    }
+
+    void PropertyActor::SetDataSource(IterableDataSource& newDataSource)
+    {
+      dataSource = &newDataSource;
+      propertyWriter->SetDataSource(newDataSource);
+    }
+
+    void PropertyActor::Monitor(OutputTrigger::Quantity quantity, double value)
+    {
+      propertyWriter->Monitor(quantity, value, simulationState.GetTimeStep());
+    }
+
     void PropertyActor::EndIteration()
     {
       timers[reporting::Timers::extractionWriting].Start();
-      propertyWriter->Write(simulationState.GetTimeStep());
+      propertyWriter->SampleAndWrite(simulationState.GetTimeStep());
       timers[reporting::Timers::extractionWriting].Stop();
     }
 
@@ -42,12 +42,40 @@ namespace hemelb
         void SetRequiredProperties(lb::MacroscopicPropertyCache& propertyCache);
 
         /**
-         * Override the iterated actor end of iteration method to perform writing.
+         * Restrict the cache to the sites that at least one of the outputs reads. This relies on
+         * the data source visiting the local fluid sites in index order, as LbDataSourceIterator
+         * does.
+         * @param propertyCache
+         * @param otherSites Sites that something else reads too, e.g. the probes, in ascending
+         * order.
+         */
+        void RestrictCacheToRequiredSites(lb::MacroscopicPropertyCache& propertyCache,
+                                          const std::vector<site_t>& otherSites);
+
+        /**
+         * Read from a new data source, once the sites have been redistributed between the cores.
+         * The output files carry on from where they were. A collective operation.
+         * @param newDataSource
+         */
+        void SetDataSource(IterableDataSource& newDataSource);
+
+        /**
+         * Pass the latest value of a monitored quantity to the outputs' triggers. Call it on
+         * every core alike, before the step's required properties are set, so that a trigger
+         * firing writes the current step.
+         * @param quantity
+         * @param value
+         */
+        void Monitor(OutputTrigger::Quantity quantity, double value);
+
+        /**
+         * Override the iterated actor end of iteration method to perform sampling and writing.
          */
         void EndIteration();
 
       private:
         const lb::SimulationState& simulationState;
+        IterableDataSource* dataSource;
         PropertyWriter* propertyWriter;
         reporting::Timers& timers;
     };
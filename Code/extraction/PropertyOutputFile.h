@@ -7,20 +7,97 @@
 #ifndef HEMELB_EXTRACTION_PROPERTYOUTPUTFILE_H
 #define HEMELB_EXTRACTION_PROPERTYOUTPUTFILE_H
 
+#include <map>
 #include <string>
 #include <vector>
 #include "extraction/GeometrySelector.h"
 #include "extraction/OutputField.h"
+#include "io/SubfileGroup.h"
+#include "io/formats/extraction.h"
 
 namespace hemelb
 {
   namespace extraction
   {
+    /**
+     * A condition on a monitored quantity that makes a property output write a record on the
+     * step it is met, besides those every period.
+     */
+    struct OutputTrigger
+    {
+        /**
+         * The quantities that can be monitored. They are global values every core has, so
+         * every core decides alike whether to write.
+         */
+        enum Quantity
+        {
+          //! The largest velocity magnitude, in m/s, from the incompressibility check.
+          MaxVelocity,
+          //! The largest relative density difference, from the incompressibility check.
+          MaxDensityDifference
+        };
+
+        enum Condition
+        {
+          //! When the quantity goes above the threshold.
+          Above,
+          //! When the quantity changes by more than the threshold, relative to its last value.
+          RelativeChange,
+          //! When the quantity stops rising, having risen above the threshold, e.g. at peak
+          //! systole. This is seen a check late.
+          Peak
+        };
+
+        OutputTrigger() :
+            quantity(MaxVelocity), condition(Above), threshold(0.), holdoff(0)
+        {
+        }
+
+        Quantity quantity;
+        Condition condition;
+        double threshold;
+        //! The fewest steps from one triggered record to the next.
+        unsigned long holdoff;
+    };
+
     struct PropertyOutputFile
     {
+        /**
+         * The kind of file to write.
+         */
+        enum Format
+        {
+          //! The extraction format of io/formats/extraction.h.
+          XdrFormat,
+          //! Parallel HDF5 with XDMF metadata, see Hdf5OutputFile. Needs HEMELB_USE_HDF5.
+          Hdf5Format
+        };
+
+        /**
+         * How to thin out the sites, for a coarser view of the flow.
+         */
+        enum Decimation
+        {
+          NoDecimation,
+          //! Only the sites whose coordinates are all multiples of the decimation factor.
+          StrideDecimation,
+          //! The average over each cube of sites the decimation factor across, written as a
+          //! site at the lowest corner of the cube.
+          BlockAverageDecimation
+        };
+
         PropertyOutputFile()
         {
           geometry = NULL;
+          positionsOnce = false;
+          surfaceSiteLists = false;
+          samplePeriod = 1;
+          encoding = io::formats::extraction::Float32Encoding;
+          format = XdrFormat;
+          decimation = NoDecimation;
+          decimationFactor = 1;
+          keyframePeriod = 10;
+          ranksPerFile = io::SubfileGroup::OneFile;
         }
 
         ~PropertyOutputFile()
@@ -30,8 +107,28 @@ namespace hemelb
 
         std::string filename;
         unsigned long frequency;
+        //! How often the accumulated fields (averages etc.) are sampled, in time steps.
+        unsigned long samplePeriod;
         GeometrySelector* geometry;
         std::vector<OutputField> fields;
+        //! Write the site positions in a list of their own, rather than in every record.
+        bool positionsOnce;
+        //! Write each site's wall normal and wall area with its position in the site lists.
+        bool surfaceSiteLists;
+        //! How precisely to store the field values.
+        io::formats::extraction::Encoding encoding;
+        //! For DeltaEncoding, the most records from one keyframe to the next.
+        unsigned long keyframePeriod;
+        Format format;
+        Decimation decimation;
+        //! The spacing, in lattice sites, of the decimated sites or the size of the blocks.
+        unsigned decimationFactor;
+        //! MPI-IO hints to open the file with, e.g. cb_nodes or striping_factor, by key.
+        std::map<std::string, std::string> ioHints;
+        //! How many ranks write each part of the file, or SubfileGroup::OneFile or PerNode.
+        int ranksPerFile;
+        //! The conditions that also make a record be written, besides every frequency steps.
+        std::vector<OutputTrigger> triggers;
     };
   }
 }
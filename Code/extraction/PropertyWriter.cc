@@ -4,7 +4,10 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <algorithm>
+#include <iterator>
 #include "extraction/PropertyWriter.h"
+#include "extraction/SiteFieldValues.h"
 
 namespace hemelb
 {
@@ -12,7 +15,8 @@ namespace hemelb
   {
     PropertyWriter::PropertyWriter(IterableDataSource& dataSource,
                                    const std::vector<PropertyOutputFile*>& propertyOutputs,
-                                   const net::IOCommunicator& ioComms)
+                                   const net::IOCommunicator& ioComms) :
+        dataSource(&dataSource)
     {
       for (unsigned outputNumber = 0; outputNumber < propertyOutputs.size(); ++outputNumber)
       {
@@ -33,11 +37,77 @@ namespace hemelb
       return localPropertyOutputs;
     }
 
+    void PropertyWriter::SetDataSource(IterableDataSource& dataSource)
+    {
+      this->dataSource = &dataSource;
+      for (unsigned outputNumber = 0; outputNumber < localPropertyOutputs.size(); ++outputNumber)
+      {
+        localPropertyOutputs[outputNumber]->SetDataSource(dataSource);
+      }
+    }
+
+    void PropertyWriter::Sample(unsigned long iterationNumber) const
+    {
+      Extract(iterationNumber, true, false);
+    }
+
     void PropertyWriter::Write(unsigned long iterationNumber) const
+    {
+      Extract(iterationNumber, false, true);
+    }
+
+    void PropertyWriter::SampleAndWrite(unsigned long iterationNumber) const
+    {
+      Extract(iterationNumber, true, true);
+    }
+
+    void PropertyWriter::Monitor(OutputTrigger::Quantity quantity, double value,
+                                 unsigned long iterationNumber) const
     {
       for (unsigned outputNumber = 0; outputNumber < localPropertyOutputs.size(); ++outputNumber)
       {
-        localPropertyOutputs[outputNumber]->Write((uint64_t) iterationNumber);
+        localPropertyOutputs[outputNumber]->Monitor(quantity, value, iterationNumber);
+      }
+    }
+
+    void PropertyWriter::Extract(unsigned long iterationNumber, bool sample, bool write) const
+    {
+      // The union of the sites of the outputs due, each already in ascending order.
+      std::vector<site_t> sites;
+      for (unsigned outputNumber = 0; outputNumber < localPropertyOutputs.size(); ++outputNumber)
+      {
+        const LocalPropertyOutput* output = localPropertyOutputs[outputNumber];
+        if (! ( (sample && output->ShouldSample(iterationNumber))
+            || (write && output->ShouldWrite(iterationNumber))))
+        {
+          continue;
+        }
+        const std::vector<site_t>& selectedSites = output->GetSelectedSites();
+        std::vector<site_t> merged;
+        merged.reserve(sites.size() + selectedSites.size());
+        std::set_union(sites.begin(),
+                       sites.end(),
+                       selectedSites.begin(),
+                       selectedSites.end(),
+                       std::back_inserter(merged));
+        sites.swap(merged);
+      }
+
+      // Sample first, so that a record written this iteration includes it.
+      SiteFieldValues fields(*dataSource, sites);
+      if (sample)
+      {
+        for (unsigned outputNumber = 0; outputNumber < localPropertyOutputs.size(); ++outputNumber)
+        {
+          localPropertyOutputs[outputNumber]->Sample(iterationNumber, fields);
+        }
+      }
+      if (write)
+      {
+        for (unsigned outputNumber = 0; outputNumber < localPropertyOutputs.size(); ++outputNumber)
+        {
+          localPropertyOutputs[outputNumber]->Write(iterationNumber, fields);
+        }
       }
     }
   }
@@ -39,13 +39,57 @@ namespace hemelb
          */
         void Write(unsigned long iterationNumber) const;
 
+        /**
+         * Samples the accumulated fields of each of the property output files, if appropriate
+         * for the passed iteration number.
+         * @param iterationNumber
+         */
+        void Sample(unsigned long iterationNumber) const;
+
+        /**
+         * Samples and then writes the property output files, as Sample and Write would, with
+         * each field got from the data source once for all the outputs due.
+         * @param iterationNumber
+         */
+        void SampleAndWrite(unsigned long iterationNumber) const;
+
+        /**
+         * Pass the latest value of a monitored quantity to each output's triggers.
+         * @param quantity
+         * @param value
+         * @param iterationNumber
+         */
+        void Monitor(OutputTrigger::Quantity quantity, double value,
+                     unsigned long iterationNumber) const;
+
         /**
          * Returns a vector of all the LocalPropertyOutputs.
          * @return
          */
         const std::vector<LocalPropertyOutput*>& GetPropertyOutputs() const;
 
+        /**
+         * Switch every output to a new data source, once the sites have been redistributed
+         * between the cores. A collective operation.
+         * @param dataSource
+         */
+        void SetDataSource(IterableDataSource& dataSource);
+
       private:
+        /**
+         * Sample and/or write the outputs due on the iteration, getting each field they need
+         * at the union of their sites in one go.
+         * @param iterationNumber
+         * @param sample
+         * @param write
+         */
+        void Extract(unsigned long iterationNumber, bool sample, bool write) const;
+
+        /**
+         * The data source the outputs' values come from.
+         */
+        IterableDataSource* dataSource;
+
         /**
          * Holds sufficient information to output property information from this core.
          */
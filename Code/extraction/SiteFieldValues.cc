@@ -0,0 +1,51 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "extraction/SiteFieldValues.h"
+
+namespace hemelb
+{
+  namespace extraction
+  {
+    SiteFieldValues::SiteFieldValues(IterableDataSource& dataSource,
+                                     const std::vector<site_t>& sites) :
+        dataSource(dataSource), allSites(sites)
+    {
+    }
+
+    void SiteFieldValues::Get(OutputField::FieldType field, const std::vector<site_t>& sites,
+                              std::vector<FloatingType>& values)
+    {
+      std::map<OutputField::FieldType, std::vector<FloatingType> >::iterator all =
+          fieldValues.find(field);
+      if (all == fieldValues.end())
+      {
+        all = fieldValues.insert(std::make_pair(field, std::vector<FloatingType>())).first;
+        dataSource.GetField(field, allSites, all->second);
+      }
+
+      // All the sites, or those of them asked for, found by walking along both lists.
+      if (sites.size() == allSites.size())
+      {
+        values = all->second;
+        return;
+      }
+      const unsigned components = IterableDataSource::GetFieldComponentCount(field);
+      values.resize(sites.size() * components);
+      size_t position = 0;
+      for (size_t site = 0; site < sites.size(); ++site)
+      {
+        while (allSites[position] < sites[site])
+        {
+          ++position;
+        }
+        for (unsigned component = 0; component < components; ++component)
+        {
+          values[site * components + component] = all->second[position * components + component];
+        }
+      }
+    }
+  }
+}
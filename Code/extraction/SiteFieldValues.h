@@ -0,0 +1,53 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_EXTRACTION_SITEFIELDVALUES_H
+#define HEMELB_EXTRACTION_SITEFIELDVALUES_H
+
+#include <map>
+#include <vector>
+#include "extraction/IterableDataSource.h"
+#include "extraction/OutputField.h"
+#include "units.h"
+
+namespace hemelb
+{
+  namespace extraction
+  {
+    /**
+     * The values of the fields at the union of the sites of several outputs, for one
+     * iteration. Each field is got from the data source at all the sites at once, the first
+     * time any output asks for it, and each output then picks out its own sites' values, so
+     * outputs due on the same iteration share one pass over the data source per field.
+     */
+    class SiteFieldValues
+    {
+      public:
+        /**
+         * @param dataSource
+         * @param sites The indices, as for IterableDataSource::ReadAt, of all the sites values
+         * may be asked for at, in ascending order without repeats.
+         */
+        SiteFieldValues(IterableDataSource& dataSource, const std::vector<site_t>& sites);
+
+        /**
+         * Get a field's values at some of the sites, as IterableDataSource::GetField would.
+         * @param field Any field with components.
+         * @param sites Some of the sites given to the constructor, in ascending order.
+         * @param values [out]
+         */
+        void Get(OutputField::FieldType field, const std::vector<site_t>& sites,
+                 std::vector<FloatingType>& values);
+
+      private:
+        IterableDataSource& dataSource;
+        const std::vector<site_t>& allSites;
+        //! The values of each field got so far, at all the sites.
+        std::map<OutputField::FieldType, std::vector<FloatingType> > fieldValues;
+    };
+  }
+}
+
+#endif /* HEMELB_EXTRACTION_SITEFIELDVALUES_H */
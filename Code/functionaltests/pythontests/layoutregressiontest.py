@@ -0,0 +1,135 @@
+#!/usr/bin/env python
+# This file is part of HemeLB and is Copyright (C)
+# the HemeLB team and/or their institutions, as detailed in the
+# file AUTHORS. This software is provided under the terms of the
+# license in the file LICENSE.
+
+# encoding: utf-8
+
+"""Checks that a build variant gives the same results as the default build.
+
+Build options that only change how the distributions are laid out in memory or
+how many sites are collided at once (e.g. HEMELB_USE_SOA_DISTRIBUTIONS or
+HEMELB_BULK_SIMD) must not change the results at all. Each
+case runs a bundled geometry with the reference executable and with the variant
+one, on the same number of cores, and compares the extracted property files
+byte for byte.
+
+The executables are $HEMELB_REFERENCE_EXECUTABLE (the default build) and
+$HEMELB_VARIANT_EXECUTABLE; the tests are skipped unless both are set. Set
+$HEMELB_VARIANT_REORDERS_SITES=1 for variants that number the sites differently
+(e.g. HEMELB_USE_SPACE_FILLING_CURVE_ORDER), which extract the same rows in
+another order: the rows of each time are then compared sorted by their grid
+position, bar their ids.
+"""
+
+import unittest
+import subprocess
+import os
+import re
+import shutil
+import tempfile
+import numpy as np
+from hemeTools.parsers.extraction import ExtractedProperty
+
+here = os.path.dirname(os.path.abspath(__file__))
+unittest_resources = os.path.join(here, "..", "..", "unittests", "resources")
+
+# Each case: its input file and geometry in the unit test resources, the number of
+# steps to run and the number of cores to run on.
+cases = {
+    "four_cube": {"input": "four_cube.xml", "geometry": "four_cube.gmy",
+                  "steps": 100, "cores": 1},
+    "four_cube_parallel": {"input": "four_cube.xml", "geometry": "four_cube.gmy",
+                           "steps": 100, "cores": 3},
+}
+
+def executables():
+    return (os.environ.get("HEMELB_REFERENCE_EXECUTABLE"),
+            os.environ.get("HEMELB_VARIANT_EXECUTABLE"))
+
+def reorders_sites():
+    return os.environ.get("HEMELB_VARIANT_REORDERS_SITES", "0") != "0"
+
+def sorted_rows(rows):
+    """The rows sorted by their grid position."""
+    grid = rows['grid']
+    return rows[np.lexsort((grid[:, 2], grid[:, 1], grid[:, 0]))]
+
+def run_case(name, executable, out_dir):
+    """Run a case with the executable, leaving its results in out_dir, and return
+    the paths of its extracted property files relative to their directory."""
+    case = cases[name]
+    temp_dir = tempfile.mkdtemp("_HemeLB_LayoutRegressionTest")
+    try:
+        shutil.copy(os.path.join(unittest_resources, case["geometry"]), temp_dir)
+        with open(os.path.join(unittest_resources, case["input"])) as f:
+            config = f.read()
+        config = re.sub(r'<steps value="\d+"', '<steps value="%d"' % case["steps"], config)
+        with open(os.path.join(temp_dir, case["input"]), "w") as f:
+            f.write(config)
+
+        subprocess.check_call("mpirun -np %d %s -in %s -out results"
+                              % (case["cores"], os.path.abspath(executable), case["input"]),
+                              shell=True, cwd=temp_dir)
+        shutil.copytree(os.path.join(temp_dir, "results", "Extracted"), out_dir)
+    finally:
+        shutil.rmtree(temp_dir, ignore_errors=True)
+
+    return sorted(os.listdir(out_dir))
+
+class TestLayoutRegression(unittest.TestCase):
+    def setUp(self):
+        self.reference, self.variant = executables()
+        if not self.reference or not self.variant:
+            self.skipTest("Set HEMELB_REFERENCE_EXECUTABLE and HEMELB_VARIANT_EXECUTABLE "
+                          "to the builds to compare")
+        self.out_dir = tempfile.mkdtemp("_HemeLB_LayoutRegressionResults")
+
+    def tearDown(self):
+        shutil.rmtree(self.out_dir, ignore_errors=True)
+
+    def check_case(self, name):
+        reference_dir = os.path.join(self.out_dir, "reference")
+        variant_dir = os.path.join(self.out_dir, "variant")
+        reference_files = run_case(name, self.reference, reference_dir)
+        variant_files = run_case(name, self.variant, variant_dir)
+
+        self.assertEqual(reference_files, variant_files)
+        self.assertTrue(reference_files, msg="{} extracted nothing".format(name))
+        for filename in reference_files:
+            if reorders_sites():
+                self.check_rows(os.path.join(reference_dir, filename),
+                                os.path.join(variant_dir, filename),
+                                "{} in {}".format(filename, name))
+                continue
+            with open(os.path.join(reference_dir, filename), "rb") as f:
+                expected = f.read()
+            with open(os.path.join(variant_dir, filename), "rb") as f:
+                actual = f.read()
+            self.assertTrue(expected == actual,
+                            msg="{} differs from the reference in {}".format(filename, name))
+
+    def check_rows(self, reference_path, variant_path, description):
+        expected = ExtractedProperty(reference_path)
+        actual = ExtractedProperty(variant_path)
+        self.assertEqual(expected.siteCount, actual.siteCount, msg=description)
+        self.assertTrue(np.array_equal(expected.times, actual.times), msg=description)
+        for index in range(len(expected.times)):
+            expected_rows = sorted_rows(expected.GetByIndex(index))
+            actual_rows = sorted_rows(actual.GetByIndex(index))
+            for field in expected_rows.dtype.names:
+                if field == 'id':
+                    continue
+                self.assertTrue(expected_rows[field].tobytes() == actual_rows[field].tobytes(),
+                                msg="{} differs from the reference in {} at time {}".format(
+                                    field, description, expected.times[index]))
+
+    def test_four_cube(self):
+        self.check_case("four_cube")
+
+    def test_four_cube_parallel(self):
+        self.check_case("four_cube_parallel")
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,140 @@
+#!/usr/bin/env python
+# This file is part of HemeLB and is Copyright (C)
+# the HemeLB team and/or their institutions, as detailed in the
+# file AUTHORS. This software is provided under the terms of the
+# license in the file LICENSE.
+
+# encoding: utf-8
+
+"""Performance regression tests.
+
+Each case runs a small bundled geometry for a fixed number of steps and compares
+the MLUPS, the mean time of the main phases and the peak memory in its
+report.json with the baseline stored for this machine class in
+resources/performance_baselines.json, failing if any is worse by more than the
+tolerance.
+
+The machine class is $HEMELB_MACHINE_CLASS, or the host name if that is unset.
+Run with HEMELB_RECORD_PERFORMANCE=1 to record (or replace) the baselines of the
+current machine class instead of checking them; classes without baselines are
+skipped.
+"""
+
+import unittest
+import subprocess
+import os
+import re
+import json
+import shutil
+import socket
+import tempfile
+
+here = os.path.dirname(os.path.abspath(__file__))
+baselines_file = os.path.join(here, "resources", "performance_baselines.json")
+unittest_resources = os.path.join(here, "..", "..", "unittests", "resources")
+
+# Each case: its input file and geometry in the unit test resources, the number of
+# steps to run and the number of cores to run on.
+cases = {
+    "four_cube": {"input": "four_cube.xml", "geometry": "four_cube.gmy",
+                  "steps": 2000, "cores": 1},
+    "four_cube_parallel": {"input": "four_cube.xml", "geometry": "four_cube.gmy",
+                           "steps": 2000, "cores": 4},
+}
+
+# Phases too short to time reliably on these geometries are not compared.
+compared_timers = ["Simulation total", "Lattice Boltzmann", "LB calc only",
+                   "MPI Send", "MPI Wait", "Monitoring"]
+min_timer_seconds = 0.05
+
+def machine_class():
+    return os.environ.get("HEMELB_MACHINE_CLASS", socket.gethostname())
+
+def recording():
+    return os.environ.get("HEMELB_RECORD_PERFORMANCE", "0") != "0"
+
+def load_baselines():
+    with open(baselines_file) as f:
+        return json.load(f)
+
+def run_case(name):
+    """Run a case in a temporary directory and return what it measured."""
+    case = cases[name]
+    temp_dir = tempfile.mkdtemp("_HemeLB_PerformanceTest")
+    try:
+        shutil.copy(os.path.join(here, "..", "..", "build", "hemelb"), temp_dir)
+        shutil.copy(os.path.join(unittest_resources, case["geometry"]), temp_dir)
+        with open(os.path.join(unittest_resources, case["input"])) as f:
+            config = f.read()
+        config = re.sub(r'<steps value="\d+"', '<steps value="%d"' % case["steps"], config)
+        with open(os.path.join(temp_dir, case["input"]), "w") as f:
+            f.write(config)
+
+        subprocess.check_call("mpirun -np %d ./hemelb -in %s -out results"
+                              % (case["cores"], case["input"]),
+                              shell=True, cwd=temp_dir)
+
+        with open(os.path.join(temp_dir, "results", "report.json")) as f:
+            report = json.load(f)
+    finally:
+        shutil.rmtree(temp_dir, ignore_errors=True)
+
+    timers = dict((timer["name"], timer["mean"]) for timer in report["timings"]
+                  if timer["name"] in compared_timers)
+    return {"mlups": report["performance"]["mlups"],
+            "max_memory_kb": report["performance"]["max_memory_kb"],
+            "timers": timers}
+
+class TestPerformance(unittest.TestCase):
+    @classmethod
+    def setUpClass(self):
+        self.baselines = load_baselines()
+        self.tolerance = float(os.environ.get("HEMELB_PERFORMANCE_TOLERANCE",
+                                              self.baselines["tolerance"]))
+        self.machine = machine_class()
+
+    @classmethod
+    def tearDownClass(self):
+        if recording():
+            with open(baselines_file, "w") as f:
+                json.dump(self.baselines, f, indent=2, sort_keys=True)
+                f.write("\n")
+
+    def check_case(self, name):
+        measured = run_case(name)
+        print('# {}: {:.3f} MLUPS, {} kB peak memory'.format(name, measured["mlups"],
+                                                             measured["max_memory_kb"]))
+
+        if recording():
+            self.baselines["machines"].setdefault(self.machine, {})[name] = measured
+            return
+
+        baseline = self.baselines["machines"].get(self.machine, {}).get(name)
+        if baseline is None:
+            self.skipTest("No baseline for {} on machine class {}; record one with "
+                          "HEMELB_RECORD_PERFORMANCE=1".format(name, self.machine))
+
+        # Higher is better for MLUPS; lower for everything else.
+        self.assertGreaterEqual(measured["mlups"], baseline["mlups"] * (1 - self.tolerance),
+            msg="{} ran at {:.3f} MLUPS, down from {:.3f}".format(name, measured["mlups"],
+                                                                  baseline["mlups"]))
+        self.assertLessEqual(measured["max_memory_kb"],
+                             baseline["max_memory_kb"] * (1 + self.tolerance),
+            msg="{} peaked at {} kB, up from {}".format(name, measured["max_memory_kb"],
+                                                        baseline["max_memory_kb"]))
+        for timer, seconds in baseline["timers"].items():
+            if seconds < min_timer_seconds or timer not in measured["timers"]:
+                continue
+            self.assertLessEqual(measured["timers"][timer], seconds * (1 + self.tolerance),
+                msg="{} took {:.3f} s in {}, up from {:.3f}".format(name,
+                                                                    measured["timers"][timer],
+                                                                    timer, seconds))
+
+    def test_four_cube(self):
+        self.check_case("four_cube")
+
+    def test_four_cube_parallel(self):
+        self.check_case("four_cube_parallel")
+
+if __name__ == "__main__":
+    unittest.main()
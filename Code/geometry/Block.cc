@@ -1,4 +1,3 @@
-
 // This file is part of HemeLB and is Copyright (C)
 // the HemeLB team and/or their institutions, as detailed in the
 // file AUTHORS. This software is provided under the terms of the
@@ -6,6 +5,7 @@
 
 #include "constants.h"
 #include "geometry/Block.h"
+#include "util/utilityFunctions.h"
 
 namespace hemelb
 {
@@ -13,12 +13,14 @@ namespace hemelb
   {
     const site_t Block::SOLID_SITE_ID = 1U << 31;
 
-    Block::Block()
+    Block::Block() :
+        siteCount(0), fluidSiteCount(0), uniformRank(SITE_OR_BLOCK_SOLID)
     {
     }
 
     Block::Block(site_t sitesPerBlock) :
-        processorRankForEachBlockSite(sitesPerBlock, SITE_OR_BLOCK_SOLID), localContiguousIndex(sitesPerBlock, SOLID_SITE_ID)
+        siteCount(sitesPerBlock), fluidSiteMask( (sitesPerBlock + 63) / 64, 0), fluidSiteCount(0),
+            uniformRank(SITE_OR_BLOCK_SOLID)
     {
     }
 
@@ -28,32 +30,139 @@ namespace hemelb
 
     bool Block::IsEmpty() const
     {
-      return localContiguousIndex.empty();
+      return siteCount == 0;
+    }
+
+    size_t Block::GetMemoryUsage() const
+    {
+      return util::VectorBytes(fluidSiteMask) + util::VectorBytes(processorRankForEachBlockSite)
+          + util::VectorBytes(localContiguousIndex) + util::VectorBytes(fluidSitesBeforeWord);
     }
 
     proc_t Block::GetProcessorRankForSite(site_t localSiteIndex) const
     {
-      return processorRankForEachBlockSite[localSiteIndex];
+      if (!processorRankForEachBlockSite.empty())
+      {
+        return processorRankForEachBlockSite[localSiteIndex];
+      }
+      return SiteIsFluid(localSiteIndex) ?
+        uniformRank :
+        SITE_OR_BLOCK_SOLID;
     }
 
     site_t Block::GetLocalContiguousIndexForSite(site_t localSiteIndex) const
     {
-      return localContiguousIndex[localSiteIndex];
+      if (localContiguousIndex.empty())
+      {
+        return SOLID_SITE_ID;
+      }
+      if (fluidSiteCount == siteCount)
+      {
+        return localContiguousIndex[localSiteIndex];
+      }
+      return SiteIsFluid(localSiteIndex) ?
+        localContiguousIndex[GetFluidSitesBefore(localSiteIndex)] :
+        SOLID_SITE_ID;
     }
 
     bool Block::SiteIsSolid(site_t localSiteIndex) const
     {
-      return localContiguousIndex[localSiteIndex] == SOLID_SITE_ID;
+      return GetLocalContiguousIndexForSite(localSiteIndex) == SOLID_SITE_ID;
     }
 
     void Block::SetProcessorRankForSite(site_t localSiteIndex, proc_t rank)
     {
+      SetSiteIsFluid(localSiteIndex, rank != SITE_OR_BLOCK_SOLID);
+      if (!processorRankForEachBlockSite.empty())
+      {
+        processorRankForEachBlockSite[localSiteIndex] = rank;
+        return;
+      }
+
+      if (rank == SITE_OR_BLOCK_SOLID || rank == uniformRank)
+      {
+        return;
+      }
+      if (uniformRank == SITE_OR_BLOCK_SOLID)
+      {
+        uniformRank = rank;
+        return;
+      }
+
+      // The fluid sites are now on more than one rank, so store the rank of each.
+      processorRankForEachBlockSite.resize(siteCount);
+      for (site_t site = 0; site < siteCount; ++site)
+      {
+        processorRankForEachBlockSite[site] = SiteIsFluid(site) ?
+          uniformRank :
+          SITE_OR_BLOCK_SOLID;
+      }
       processorRankForEachBlockSite[localSiteIndex] = rank;
     }
 
     void Block::SetLocalContiguousIndexForSite(site_t localSiteIndex, site_t contiguousIndex)
     {
-      localContiguousIndex[localSiteIndex] = contiguousIndex;
+      // Only fluid sites have an index.
+      SetSiteIsFluid(localSiteIndex, true);
+      if (localContiguousIndex.empty())
+      {
+        localContiguousIndex.resize(fluidSiteCount, SOLID_SITE_ID);
+        CountFluidSitesBeforeWords();
+      }
+      localContiguousIndex[fluidSiteCount == siteCount ?
+        localSiteIndex :
+        GetFluidSitesBefore(localSiteIndex)] = contiguousIndex;
+    }
+
+    void Block::SetSiteIsFluid(site_t localSiteIndex, bool isFluid)
+    {
+      if (SiteIsFluid(localSiteIndex) == isFluid)
+      {
+        return;
+      }
+
+      // Any local indices move up or down one place to make room or close the gap.
+      if (!localContiguousIndex.empty())
+      {
+        const site_t position = fluidSiteCount == siteCount ?
+          localSiteIndex :
+          GetFluidSitesBefore(localSiteIndex);
+        if (isFluid)
+        {
+          localContiguousIndex.insert(localContiguousIndex.begin() + position, SOLID_SITE_ID);
+        }
+        else
+        {
+          localContiguousIndex.erase(localContiguousIndex.begin() + position);
+        }
+      }
+
+      fluidSiteMask[localSiteIndex >> 6] ^= uint64_t(1) << (localSiteIndex & 63);
+      fluidSiteCount += isFluid ?
+        1 :
+        -1;
+      if (!localContiguousIndex.empty())
+      {
+        CountFluidSitesBeforeWords();
+      }
+    }
+
+    void Block::CountFluidSitesBeforeWords()
+    {
+      // A block with no solid sites doesn't need them.
+      if (fluidSiteCount == siteCount)
+      {
+        std::vector<uint32_t>().swap(fluidSitesBeforeWord);
+        return;
+      }
+
+      fluidSitesBeforeWord.resize(fluidSiteMask.size());
+      uint32_t fluidSites = 0;
+      for (size_t word = 0; word < fluidSiteMask.size(); ++word)
+      {
+        fluidSitesBeforeWord[word] = fluidSites;
+        fluidSites += __builtin_popcountll(fluidSiteMask[word]);
+      }
     }
 
   }
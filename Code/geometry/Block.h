@@ -8,6 +8,7 @@
 #define HEMELB_GEOMETRY_BLOCK_H
 
 #include "units.h"
+#include <stdint.h>
 #include <vector>
 
 namespace hemelb
@@ -17,6 +18,11 @@ namespace hemelb
     // Data about each global block in the lattice,
     // site_data[] is an array containing individual lattice site data
     // within a global block.
+    //
+    // Most blocks along the vessel walls are largely solid, so the local index is only stored
+    // for the fluid sites, in site order; a site's position among them is found from a bitmask
+    // of the fluid sites and the count of fluid sites before each word of it. For a block with
+    // no solid sites that position is the site's own index, as in a dense array.
     class Block
     {
       public:
@@ -34,13 +40,56 @@ namespace hemelb
         void SetProcessorRankForSite(site_t localSiteIndex, proc_t rank);
         void SetLocalContiguousIndexForSite(site_t localSiteIndex, site_t localContiguousIndex);
 
+        /**
+         * @return The bytes allocated for the block's per-site arrays.
+         */
+        size_t GetMemoryUsage() const;
+
       private:
-        // An array of the ranks on which each lattice site within the block resides.
+        bool SiteIsFluid(site_t localSiteIndex) const
+        {
+          return (fluidSiteMask[localSiteIndex >> 6] >> (localSiteIndex & 63)) & 1u;
+        }
+
+        // The number of fluid sites before the given one on the block.
+        site_t GetFluidSitesBefore(site_t localSiteIndex) const
+        {
+          const uint64_t before = fluidSiteMask[localSiteIndex >> 6]
+              & ( (uint64_t(1) << (localSiteIndex & 63)) - 1);
+          return fluidSitesBeforeWord[localSiteIndex >> 6] + __builtin_popcountll(before);
+        }
+
+        // Mark a site as fluid or solid, keeping the local indices of the others.
+        void SetSiteIsFluid(site_t localSiteIndex, bool isFluid);
+
+        // Count the fluid sites before each word of the mask.
+        void CountFluidSitesBeforeWords();
+
+        // The number of lattice sites within the block.
+        site_t siteCount;
+
+        // Whether each lattice site within the block is fluid, one bit per site.
+        std::vector<uint64_t> fluidSiteMask;
+
+        // The number of fluid sites within the block.
+        site_t fluidSiteCount;
+
+        // The rank on which every fluid site within the block resides, while they are all on
+        // the same one, which is true of most blocks.
+        proc_t uniformRank;
+
+        // An array of the ranks on which each lattice site within the block resides, only
+        // once its fluid sites are on more than one rank.
         std::vector<proc_t> processorRankForEachBlockSite;
 
-        // The local index for each site on the block in the LocalLatticeData.
+        // The local index in the LocalLatticeData of each fluid site on the block, in site
+        // order (or SOLID_SITE_ID for those on other ranks), only if some of its sites are local.
         std::vector<site_t> localContiguousIndex;
 
+        // The number of fluid sites before each word of fluidSiteMask, only while
+        // localContiguousIndex is held for a block with some solid sites.
+        std::vector<uint32_t> fluidSitesBeforeWord;
+
         // Constant for the id assigned to any solid sites.
         static const site_t SOLID_SITE_ID;
     };
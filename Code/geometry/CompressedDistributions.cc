@@ -0,0 +1,121 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+#include <limits>
+#include "geometry/CompressedDistributions.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    CompressedDistributions::CompressedDistributions(const lb::lattices::LatticeInfo& latticeInfo,
+                                                     site_t siteCount) :
+        siteCount(siteCount), numVectors(latticeInfo.GetNumVectors()),
+            siteMoments(siteCount * MomentsPerSite, 0.0f),
+            nonEquilibrium(siteCount * latticeInfo.GetNumVectors(), 0)
+    {
+      for (Direction direction = 0; direction < numVectors; ++direction)
+      {
+        vectorX.push_back(latticeInfo.GetVector(direction).x);
+        vectorY.push_back(latticeInfo.GetVector(direction).y);
+        vectorZ.push_back(latticeInfo.GetVector(direction).z);
+        weights.push_back(latticeInfo.GetWeight(direction));
+      }
+    }
+
+    void CompressedDistributions::Store(site_t site, const distribn_t* f)
+    {
+      Store(site, f, numVectors, &vectorX[0], &vectorY[0], &vectorZ[0], &weights[0]);
+    }
+
+    distribn_t CompressedDistributions::Get(site_t site, Direction direction) const
+    {
+      const float* moments = &siteMoments[site * MomentsPerSite];
+      return Equilibrium(moments,
+                         weights[direction],
+                         vectorX[direction],
+                         vectorY[direction],
+                         vectorZ[direction])
+          + moments[ScaleMoment] * nonEquilibrium[site * numVectors + direction];
+    }
+
+    void CompressedDistributions::Get(site_t site, distribn_t* f) const
+    {
+      for (Direction direction = 0; direction < numVectors; ++direction)
+      {
+        f[direction] = Get(site, direction);
+      }
+    }
+
+    void CompressedDistributions::Store(site_t site, const distribn_t* f, Direction numVectors,
+                                        const distribn_t* cx, const distribn_t* cy,
+                                        const distribn_t* cz, const distribn_t* weights)
+    {
+      distribn_t density = 0.0, momentumX = 0.0, momentumY = 0.0, momentumZ = 0.0;
+      for (Direction direction = 0; direction < numVectors; ++direction)
+      {
+        density += f[direction];
+        momentumX += cx[direction] * f[direction];
+        momentumY += cy[direction] * f[direction];
+        momentumZ += cz[direction] * f[direction];
+      }
+
+      // The equilibrium is worked out from the moments as they're stored, as it will be read.
+      float* moments = &siteMoments[site * MomentsPerSite];
+      moments[0] = float(density - 1.0);
+      moments[1] = float(momentumX);
+      moments[2] = float(momentumY);
+      moments[3] = float(momentumZ);
+      moments[ScaleMoment] = 0.0f;
+
+      // The differences are worked out twice, to find the scale and then to quantise them, so
+      // that no buffer is needed for however many directions the lattice has.
+      distribn_t largest = 0.0;
+      for (Direction direction = 0; direction < numVectors; ++direction)
+      {
+        largest = std::max(largest,
+                           std::abs(f[direction]
+                               - Equilibrium(moments,
+                                             weights[direction],
+                                             cx[direction],
+                                             cy[direction],
+                                             cz[direction])));
+      }
+
+      // A site too close to equilibrium for the scale to be a normal float is kept at it.
+      const float scale = largest / LargestQuantum > std::numeric_limits<float>::min() ?
+        float(largest / LargestQuantum) :
+        0.0f;
+      moments[ScaleMoment] = scale;
+      int16_t* quanta = &nonEquilibrium[site * numVectors];
+      for (Direction direction = 0; direction < numVectors; ++direction)
+      {
+        quanta[direction] = scale > 0.0f ?
+          int16_t(std::floor( (f[direction]
+              - Equilibrium(moments, weights[direction], cx[direction], cy[direction], cz[direction]))
+              / scale + 0.5)) :
+          0;
+      }
+    }
+
+    void CompressedDistributions::swap(CompressedDistributions& other)
+    {
+      std::swap(siteCount, other.siteCount);
+      siteMoments.swap(other.siteMoments);
+      nonEquilibrium.swap(other.nonEquilibrium);
+    }
+
+    size_t CompressedDistributions::GetMemoryUsage() const
+    {
+      return GetMemoryUsage(numVectors, siteCount);
+    }
+
+    size_t CompressedDistributions::GetMemoryUsage(Direction numVectors, site_t siteCount)
+    {
+      return siteCount * (MomentsPerSite * sizeof(float) + numVectors * sizeof(int16_t));
+    }
+  }
+}
@@ -0,0 +1,165 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_GEOMETRY_COMPRESSEDDISTRIBUTIONS_H
+#define HEMELB_GEOMETRY_COMPRESSEDDISTRIBUTIONS_H
+
+#include <cmath>
+#include <vector>
+#include <stdint.h>
+#include "units.h"
+#include "lb/lattices/LatticeInfo.h"
+#include "util/LatticeAllocator.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    /**
+     * The distributions of a run of sites, each kept as its moments and quantised
+     * non-equilibrium part rather than as one value per direction.
+     *
+     * Each site's density (less 1) and momentum are kept as floats, from which its equilibrium
+     * distribution is worked out again when it is read. The differences of the distributions
+     * from that equilibrium are kept as 16-bit integers, multiples of a scale that is kept with
+     * the moments, chosen so that the largest difference just fits.
+     *
+     * For D3Q19 a site takes 58 bytes instead of 152. It only suits sites where the flow is
+     * slow and smooth: the error of each distribution is up to the largest of the site's
+     * differences from equilibrium over 65000, plus the rounding of the moments to floats,
+     * which goes unnoticed where the density and velocity vary little.
+     */
+    class CompressedDistributions
+    {
+      public:
+        /**
+         * Space for no sites.
+         */
+        CompressedDistributions() :
+            siteCount(0), numVectors(0)
+        {
+        }
+
+        /**
+         * Space for the given number of sites, all at rest with unit density.
+         * @param latticeInfo
+         * @param siteCount
+         */
+        CompressedDistributions(const lb::lattices::LatticeInfo& latticeInfo, site_t siteCount);
+
+        inline site_t GetSiteCount() const
+        {
+          return siteCount;
+        }
+
+        /**
+         * Compress and keep a site's distributions.
+         * @param site The site's position in the run
+         * @param f Its LatticeType::NUMVECTORS distributions
+         */
+        template<typename LatticeType>
+        inline void Store(site_t site, const distribn_t* f)
+        {
+          Store(site, f, LatticeType::NUMVECTORS, LatticeType::CXD, LatticeType::CYD,
+                LatticeType::CZD, LatticeType::EQMWEIGHTS);
+        }
+
+        /**
+         * @param site
+         * @param direction
+         * @return The site's distribution in the direction, as decompressed
+         */
+        template<typename LatticeType>
+        inline distribn_t Get(site_t site, Direction direction) const
+        {
+          const float* moments = &siteMoments[site * MomentsPerSite];
+          return Equilibrium(moments,
+                             LatticeType::EQMWEIGHTS[direction],
+                             LatticeType::CXD[direction],
+                             LatticeType::CYD[direction],
+                             LatticeType::CZD[direction])
+              + moments[ScaleMoment] * nonEquilibrium[site * LatticeType::NUMVECTORS + direction];
+        }
+
+        /**
+         * Decompress all of a site's distributions.
+         * @param site
+         * @param f Where to put its LatticeType::NUMVECTORS distributions
+         */
+        template<typename LatticeType>
+        inline void Get(site_t site, distribn_t* f) const
+        {
+          for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+          {
+            f[direction] = Get<LatticeType>(site, direction);
+          }
+        }
+
+        /**
+         * Non-templated versions of the above, for when you haven't got a lattice type handy.
+         */
+        void Store(site_t site, const distribn_t* f);
+        distribn_t Get(site_t site, Direction direction) const;
+        void Get(site_t site, distribn_t* f) const;
+
+        /**
+         * Where a site's moments are, to prefetch them.
+         * @param site
+         * @return
+         */
+        inline const void* GetAddress(site_t site) const
+        {
+          return &siteMoments[site * MomentsPerSite];
+        }
+
+        void swap(CompressedDistributions& other);
+
+        /**
+         * @return The bytes the compressed distributions take.
+         */
+        size_t GetMemoryUsage() const;
+
+        /**
+         * @param numVectors
+         * @param siteCount
+         * @return The bytes the compressed distributions of that many sites would take.
+         */
+        static size_t GetMemoryUsage(Direction numVectors, site_t siteCount);
+
+      private:
+        enum
+        {
+          ScaleMoment = 4, //! After the density less 1 and the momentum
+          MomentsPerSite = 5
+        };
+
+        static const int LargestQuantum = 32766; //! The largest difference from equilibrium, in units of the scale, short of int16_t's largest for the rounding of the scale
+
+        inline static distribn_t Equilibrium(const float* moments, distribn_t weight,
+                                             distribn_t cx, distribn_t cy, distribn_t cz)
+        {
+          const distribn_t density = 1.0 + moments[0];
+          const distribn_t momentumDotVector = cx * moments[1] + cy * moments[2] + cz * moments[3];
+          const distribn_t momentumMagnitudeSquared = distribn_t(moments[1]) * moments[1]
+              + distribn_t(moments[2]) * moments[2] + distribn_t(moments[3]) * moments[3];
+          return weight
+              * (density + 3. * momentumDotVector
+                  + ( (9. / 2.) * momentumDotVector * momentumDotVector
+                      - (3. / 2.) * momentumMagnitudeSquared) / density);
+        }
+
+        void Store(site_t site, const distribn_t* f, Direction numVectors, const distribn_t* cx,
+                   const distribn_t* cy, const distribn_t* cz, const distribn_t* weights);
+
+        site_t siteCount;
+        Direction numVectors;
+        std::vector<distribn_t> vectorX, vectorY, vectorZ, weights; //! The lattice's, for the non-templated versions.
+        std::vector<float, util::LatticeAllocator<float> > siteMoments; //! Each site's density less 1, momentum and scale.
+        std::vector<int16_t, util::LatticeAllocator<int16_t> > nonEquilibrium; //! Each site's differences from equilibrium, in units of its scale.
+    };
+  }
+}
+
+#endif /* HEMELB_GEOMETRY_COMPRESSEDDISTRIBUTIONS_H */
@@ -5,13 +5,21 @@
 // license in the file LICENSE.
 
 #include <cmath>
+#include <cstdio>
+#include <iomanip>
 #include <list>
 #include <map>
 #include <algorithm>
+#include <limits>
+#include <sstream>
 #include <zlib.h>
 
 #include "debug/Debugger.h"
+#include "io/formats/blockstats.h"
+#include "io/formats/decomposition.h"
 #include "io/formats/geometry.h"
+#include "io/writers/xdr/XdrFileReader.h"
+#include "io/writers/xdr/XdrFileWriter.h"
 #include "io/writers/xdr/XdrMemReader.h"
 #include "geometry/decomposition/BasicDecomposition.h"
 #include "geometry/decomposition/OptimisedDecomposition.h"
@@ -26,11 +34,20 @@ namespace hemelb
 {
   namespace geometry
   {
+#ifdef HEMELB_VALIDATE_GEOMETRY
+    const double GeometryReader::VALIDATION_FRACTION = 1.0;
+#else
+    const double GeometryReader::VALIDATION_FRACTION = HEMELB_GEOMETRY_VALIDATION_FRACTION;
+#endif
 
     GeometryReader::GeometryReader(const bool reserveSteeringCore,
                                    const lb::lattices::LatticeInfo& latticeInfo,
                                    reporting::Timers &atimings, const net::IOCommunicator& ioComm) :
-      latticeInfo(latticeInfo), hemeLbComms(ioComm), timings(atimings)
+      latticeInfo(latticeInfo), nodeSharedRead(false), sharedFile(NULL), sharedPosition(0),
+          hemeLbComms(ioComm), readingGroupSize(READING_GROUP_SIZE),
+          blockCompression(io::formats::geometry::ZLIB_COMPRESSION), geometryChecksum(0),
+          validationCount(0), loadedCachedDecomposition(false), ownedBlocksKept(false),
+          timings(atimings)
     {
       // This rank should participate in the domain decomposition if
       //  - there's no steering core (then all ranks are involved)
@@ -61,7 +78,10 @@ namespace hemelb
     {
     }
 
-    Geometry GeometryReader::LoadAndDecompose(const std::string& dataFilePath)
+    Geometry GeometryReader::LoadAndDecompose(const std::string& dataFilePath,
+                                              const std::string& decompositionToLoad,
+                                              const std::string& decompositionToSave,
+                                              const std::string& decompositionCache)
     {
       log::Logger::Log<log::Debug, log::OnePerCore>("Starting file read timer");
       timings[hemelb::reporting::Timers::fileRead].Start();
@@ -83,27 +103,84 @@ namespace hemelb
           const_cast<char*> (bufferingValue.c_str()))
       );
 
-      // Open the file.
-      file = net::MpiFile::Open(hemeLbComms, dataFilePath, MPI_MODE_RDONLY, fileInfo);
-      log::Logger::Log<log::Info, log::OnePerCore>("Opened config file %s", dataFilePath.c_str());
-      // TODO: Why is there this fflush?
-      fflush( NULL);
+      // Open the file, or read it all into memory shared on each node.
+      if (nodeSharedRead)
+      {
+        sharedFile = new net::NodeSharedFile(hemeLbComms, dataFilePath);
+        sharedPosition = 0;
+        log::Logger::Log<log::Info, log::Singleton>("Read config file %s into node shared memory",
+                                                    dataFilePath.c_str());
+      }
+      else
+      {
+        file = net::MpiFile::Open(hemeLbComms, dataFilePath, MPI_MODE_RDONLY, fileInfo);
+        log::Logger::Log<log::Info, log::OnePerCore>("Opened config file %s", dataFilePath.c_str());
+        // TODO: Why is there this fflush?
+        fflush( NULL);
 
-      // Set the view to the file.
-      file.SetView(0, MPI_CHAR, MPI_CHAR, "native", fileInfo);
+        // Set the view to the file.
+        file.SetView(0, MPI_CHAR, MPI_CHAR, "native", fileInfo);
+      }
+
+      // The preamble and header are hashed as they are read, to identify the geometry.
+      geometryChecksum = crc32(0L, Z_NULL, 0);
 
       log::Logger::Log<log::Debug, log::OnePerCore>("Reading file preamble");
       Geometry geometry = ReadPreamble();
 
       log::Logger::Log<log::Debug, log::OnePerCore>("Reading file header");
       ReadHeader(geometry.GetBlockCount());
+      ReadDictionary();
 
       // Close the file - only the ranks participating in the topology need to read it again.
-      file.Close();
+      if (!nodeSharedRead)
+      {
+        file.Close();
+      }
 
       timings[hemelb::reporting::Timers::initialDecomposition].Start();
       log::Logger::Log<log::Debug, log::OnePerCore>("Beginning initial decomposition");
       principalProcForEachBlock.resize(geometry.GetBlockCount());
+      // The site moves from each core, if we load a saved decomposition.
+      std::vector<idx_t> movesFromEachProc, movesList;
+
+      // Balance the cost of the sites rather than their number if the setup tool left
+      // statistics on the blocks' sites beside the geometry. They're read before the cache is
+      // looked in, as they change the decomposition.
+      std::vector<site_t> weightOnEachBlock;
+      bool haveBlockStats = false;
+      if (participateInTopology && decompositionToLoad.empty())
+      {
+        haveBlockStats = ReadBlockStats(dataFilePath + io::formats::blockstats::Extension(),
+                                        geometry.GetBlockCount(),
+                                        weightOnEachBlock);
+      }
+
+      // Use the cached decomposition for this geometry if there is one, or else cache it.
+      std::string decompositionFromCache, decompositionForCache;
+      cachedDecompositionFile.clear();
+      if (participateInTopology && !decompositionCache.empty() && decompositionToLoad.empty())
+      {
+        cachedDecompositionFile = GetCachedDecompositionPath(decompositionCache,
+                                                             haveBlockStats ?
+                                                               weightOnEachBlock :
+                                                               std::vector<site_t>());
+        if (DecompositionExists(cachedDecompositionFile))
+        {
+          decompositionFromCache = cachedDecompositionFile;
+        }
+        else if (decompositionToSave.empty())
+        {
+          decompositionForCache = cachedDecompositionFile;
+        }
+      }
+      loadedCachedDecomposition = !decompositionFromCache.empty();
+      const std::string& loadFrom = decompositionToLoad.empty()
+        ? decompositionFromCache
+        : decompositionToLoad;
+      const std::string& saveTo = decompositionToSave.empty()
+        ? decompositionForCache
+        : decompositionToSave;
 
       if (!participateInTopology)
       {
@@ -113,14 +190,25 @@ namespace hemelb
           principalProcForEachBlock[block] = -1;
         }
       }
+      else if (!loadFrom.empty())
+      {
+        log::Logger::Log<log::Info, log::Singleton>("Loading the decomposition from %s",
+                                                    loadFrom.c_str());
+        ReadDecomposition(loadFrom,
+                          geometry.GetBlockCount(),
+                          principalProcForEachBlock,
+                          movesFromEachProc,
+                          movesList);
+      }
       else
       {
-        // Get an initial base-level decomposition of the domain macro-blocks over processors.
-        // This will later be improved upon by ParMetis.
+        // Get an initial base-level decomposition of the domain macro-blocks over processors,
+        // along a space-filling curve. This will later be improved upon by ParMetis.
         decomposition::BasicDecomposition basicDecomposer(geometry,
-                                                          latticeInfo,
                                                           computeComms,
-                                                          fluidSitesOnEachBlock);
+                                                          haveBlockStats
+                                                            ? weightOnEachBlock
+                                                            : fluidSitesOnEachBlock);
         basicDecomposer.Decompose(principalProcForEachBlock);
 
         if (ShouldValidate())
@@ -132,17 +220,45 @@ namespace hemelb
       // Perform the initial read-in.
       log::Logger::Log<log::Debug, log::OnePerCore>("Reading in my blocks");
 
-      if (participateInTopology)
+      if (participateInTopology && !nodeSharedRead)
       {
+        readingGroupSize = ChooseReadingGroupSize();
+        log::Logger::Log<log::Info, log::Singleton>("Reading geometry blocks on %i cores",
+                                                    readingGroupSize);
+
+        // Let the MPI library aggregate the collective reads on as many cores as we read the
+        // blocks on.
+        std::stringstream readingGroupSizeString;
+        readingGroupSizeString << readingGroupSize;
+        std::string aggregators = "cb_nodes";
+        std::string aggregatorsValue = readingGroupSizeString.str();
+        std::string collectiveRead = "romio_cb_read";
+        std::string collectiveReadValue = "enable";
+        HEMELB_MPI_CALL(MPI_Info_set, (fileInfo,
+            const_cast<char*> (aggregators.c_str()),
+            const_cast<char*> (aggregatorsValue.c_str()))
+        );
+        HEMELB_MPI_CALL(MPI_Info_set, (fileInfo,
+            const_cast<char*> (collectiveRead.c_str()),
+            const_cast<char*> (collectiveReadValue.c_str()))
+        );
+
         // Reopen in the file just between the nodes in the topology decomposition. Read in blocks
         // local to this node.
         file = net::MpiFile::Open(computeComms, dataFilePath, MPI_MODE_RDONLY, fileInfo);
+      }
 
-        ReadInBlocksWithHalo(geometry, principalProcForEachBlock, computeComms.Rank());
-
-        if (ShouldValidate())
+      if (participateInTopology)
+      {
+        // With a saved decomposition, the blocks are only read once it has been implemented.
+        if (loadFrom.empty())
         {
-          ValidateGeometry(geometry);
+          ReadInBlocksWithHalo(geometry, principalProcForEachBlock, computeComms.Rank(), true);
+
+          if (ShouldValidateBlocks())
+          {
+            ValidateGeometry(geometry);
+          }
         }
       }
 
@@ -155,19 +271,31 @@ namespace hemelb
       // domain decomposition.
       if (participateInTopology)
       {
-        log::Logger::Log<log::Debug, log::OnePerCore>("Beginning domain decomposition optimisation");
-        OptimiseDomainDecomposition(geometry, principalProcForEachBlock);
-        log::Logger::Log<log::Debug, log::OnePerCore>("Ending domain decomposition optimisation");
+        if (loadFrom.empty())
+        {
+          log::Logger::Log<log::Debug, log::OnePerCore>("Beginning domain decomposition optimisation");
+          OptimiseDomainDecomposition(geometry, principalProcForEachBlock, saveTo);
+          log::Logger::Log<log::Debug, log::OnePerCore>("Ending domain decomposition optimisation");
+        }
+        else
+        {
+          ImplementDecomposition(geometry, principalProcForEachBlock, movesFromEachProc, movesList);
+        }
 
-        if (ShouldValidate())
+        if (ShouldValidateBlocks())
         {
           ValidateGeometry(geometry);
         }
-        file.Close();
+        if (!nodeSharedRead)
+        {
+          file.Close();
+        }
       }
 
       // Finish up - close the file, set the timings, deallocate memory.
       HEMELB_MPI_CALL(MPI_Info_free, (&fileInfo));
+      delete sharedFile;
+      sharedFile = NULL;
 
       timings[hemelb::reporting::Timers::domainDecomposition].Stop();
 
@@ -177,12 +305,31 @@ namespace hemelb
     std::vector<char> GeometryReader::ReadOnAllTasks(unsigned nBytes)
     {
       std::vector<char> buffer(nBytes);
-      const net::MpiCommunicator& comm = file.GetCommunicator();
-      if (comm.Rank() == HEADER_READING_RANK)
+      if (sharedFile != NULL)
       {
-        file.Read(buffer);
+        // Every core has the whole file already.
+        if (sharedPosition + nBytes > sharedFile->GetSize())
+        {
+          throw Exception() << "Geometry file ends after " << sharedFile->GetSize()
+              << " bytes, before its header does";
+        }
+        std::copy(sharedFile->GetData() + sharedPosition,
+                  sharedFile->GetData() + sharedPosition + nBytes,
+                  buffer.begin());
+        sharedPosition += nBytes;
       }
-      comm.Broadcast(buffer, HEADER_READING_RANK);
+      else
+      {
+        const net::MpiCommunicator& comm = file.GetCommunicator();
+        if (comm.Rank() == HEADER_READING_RANK)
+        {
+          file.Read(buffer);
+        }
+        comm.Broadcast(buffer, HEADER_READING_RANK);
+      }
+      geometryChecksum = crc32(geometryChecksum,
+                               reinterpret_cast<const Bytef*> (&buffer[0]),
+                               buffer.size());
       return buffer;
     }
 
@@ -231,23 +378,15 @@ namespace hemelb
       // We use temporary vars here, as they must be the same size as the type in the file
       // regardless of the internal type used.
       unsigned int blocksX, blocksY, blocksZ, blockSize;
-      double voxelSize;
-      util::Vector3D<double> origin;
 
       // Read in the values.
       preambleReader.readUnsignedInt(blocksX);
       preambleReader.readUnsignedInt(blocksY);
       preambleReader.readUnsignedInt(blocksZ);
       preambleReader.readUnsignedInt(blockSize);
-      preambleReader.readDouble(voxelSize);
-      for (unsigned int i = 0; i < 3; ++i)
-      {
-        preambleReader.readDouble(origin[i]);
-      }
 
-      // Read the padding unsigned int.
-      unsigned paddingValue;
-      preambleReader.readUnsignedInt(paddingValue);
+      // The block compression, which is 0 (zlib) padding in older files.
+      preambleReader.readUnsignedInt(blockCompression);
 
       return Geometry(util::Vector3D<site_t>(blocksX, blocksY, blocksZ),
                       blockSize);
@@ -282,12 +421,38 @@ namespace hemelb
       }
     }
 
+    /**
+     * Read the zstd dictionary, if the blocks are compressed with zstd, and set up the
+     * decompressor.
+     */
+    void GeometryReader::ReadDictionary()
+    {
+      std::vector<char> dictionary;
+      if (blockCompression == io::formats::geometry::ZSTD_COMPRESSION)
+      {
+        std::vector<char> record =
+            ReadOnAllTasks(io::formats::geometry::GetDictionaryRecordLength(blockCompression));
+        io::writers::xdr::XdrMemReader reader(&record[0], record.size());
+        unsigned dictionaryLength;
+        reader.readUnsignedInt(dictionaryLength);
+        if (dictionaryLength > io::formats::geometry::MaxDictionaryLength)
+        {
+          throw Exception() << "The geometry's zstd dictionary is " << dictionaryLength
+              << " bytes long, more than the " << unsigned(io::formats::geometry::MaxDictionaryLength)
+              << " bytes there is space for";
+        }
+        dictionary.assign(record.begin() + 4, record.begin() + 4 + dictionaryLength);
+      }
+      blockDecompressor.Reset(blockCompression, dictionary);
+    }
+
     /**
      * Read in the necessary blocks from the file.
      */
     void GeometryReader::ReadInBlocksWithHalo(Geometry& geometry,
                                               const std::vector<proc_t>& unitForEachBlock,
-                                              const proc_t localRank)
+                                              const proc_t localRank,
+                                              const bool keepOwnedBlocks)
     {
       // Create a list of which blocks to read in.
       timings[hemelb::reporting::Timers::readBlocksPrelim].Start();
@@ -299,6 +464,15 @@ namespace hemelb
                                                                          unitForEachBlock,
                                                                          localRank);
 
+      // Drop the blocks from an earlier read that aren't needed any more.
+      for (site_t block = 0; block < geometry.GetBlockCount(); ++block)
+      {
+        if (!readBlock[block] && !geometry.Blocks[block].Sites.empty())
+        {
+          geometry.Blocks[block].Sites = std::vector<GeometrySite>(0, GeometrySite(false));
+        }
+      }
+
       if (ShouldValidate())
       {
         log::Logger::Log<log::Debug, log::OnePerCore>("Validating block sizes");
@@ -319,61 +493,272 @@ namespace hemelb
         }
       }
 
+      if (sharedFile != NULL)
+      {
+        timings[hemelb::reporting::Timers::readBlocksPrelim].Stop();
+        ParseSharedBlocks(geometry, readBlock);
+        return;
+      }
+
       // Next we spread round the lists of which blocks each core needs access to.
       log::Logger::Log<log::Debug, log::OnePerCore>("Informing reading cores of block needs");
-      net::Net net = net::Net(computeComms);
       Needs needs(geometry.GetBlockCount(),
                   readBlock,
-                  util::NumericalFunctions::min(READING_GROUP_SIZE, computeComms.Size()),
-                  net,
+                  readingGroupSize,
+                  computeComms,
                   ShouldValidate());
 
       timings[hemelb::reporting::Timers::readBlocksPrelim].Stop();
       log::Logger::Log<log::Debug, log::OnePerCore>("Reading blocks");
       timings[hemelb::reporting::Timers::readBlocksAll].Start();
 
-      // Set the initial offset to the first block, which will be updated as we progress
-      // through the blocks.
-      MPI_Offset offset = io::formats::geometry::PreambleLength
-          + GetHeaderLength(geometry.GetBlockCount());
+      // Read all the blocks this core is responsible for at once.
+      std::vector<char> blocksReadHere = ReadBlocksForThisCore(geometry);
+
+      // Set the initial offset to the first of those blocks, which will be updated as we
+      // progress through the blocks.
+      size_t offset = 0;
+
+      // The compressed and uncompressed data of each block needed on this core, in
+      // blocksReadHere or the arenas.
+      std::vector<const char*> compressedData(geometry.GetBlockCount(), NULL);
+      std::vector<char*> uncompressedData(geometry.GetBlockCount(), NULL);
+
+      // The blocks are spread, still compressed, in batches of consecutive blocks, with one
+      // round of messages per batch. The batches end at the same blocks on every core, as some
+      // point-to-point implementations coalesce each round's messages between a pair of cores.
+      // While one batch is in flight, the previous one is decompressed and parsed, so the
+      // batches are received into the two receiving arenas by turns.
+      net::Net batchNet(computeComms);
+      site_t previousBatchStart = 0;
+      site_t batchStart = 0;
+      unsigned batchNumber = 0;
+      while (batchStart < geometry.GetBlockCount())
+      {
+        util::MonotonicArena& receivingArena = receivingArenas[batchNumber % 2];
+        receivingArena.Rewind();
 
-      // Iterate over each block.
-      for (site_t nextBlockToRead = 0; nextBlockToRead < geometry.GetBlockCount(); ++nextBlockToRead)
+        site_t batchEnd = batchStart;
+        site_t batchBytes = 0;
+        while (batchEnd < geometry.GetBlockCount() && (batchEnd == batchStart || batchBytes
+            < BYTES_PER_FORWARDING_BATCH))
+        {
+          if (fluidSitesOnEachBlock[batchEnd] > 0)
+          {
+            batchBytes += bytesPerCompressedBlock[batchEnd];
+          }
+          ++batchEnd;
+        }
+
+        for (site_t nextBlockToRead = batchStart; nextBlockToRead < batchEnd; ++nextBlockToRead)
+        {
+          char* readData = NULL;
+          if (fluidSitesOnEachBlock[nextBlockToRead] > 0
+              && GetReadingCoreForBlock(nextBlockToRead) == computeComms.Rank())
+          {
+            readData = &blocksReadHere[offset];
+            // Update the offset to be ready for the next block.
+            offset += bytesPerCompressedBlock[nextBlockToRead];
+          }
+
+          // Spread the block to all cores (nothing will be done if this core doesn't need it).
+          RequestBlock(batchNet,
+                       readData,
+                       compressedData[nextBlockToRead],
+                       receivingArena,
+                       needs.ProcessorsNeedingBlock(nextBlockToRead),
+                       nextBlockToRead,
+                       readBlock[nextBlockToRead]);
+        }
+        batchNet.Send();
+        batchNet.Receive();
+
+        if (keepOwnedBlocks)
+        {
+          KeepOwnedBlocks(unitForEachBlock, compressedData, previousBatchStart, batchStart);
+        }
+        DecompressBlocks(geometry,
+                         readBlock,
+                         compressedData,
+                         uncompressedData,
+                         previousBatchStart,
+                         batchStart);
+        ParseBlocks(geometry, readBlock, uncompressedData, previousBatchStart, batchStart);
+
+        timings[hemelb::reporting::Timers::readNet].Start();
+        batchNet.Wait();
+        timings[hemelb::reporting::Timers::readNet].Stop();
+
+        previousBatchStart = batchStart;
+        batchStart = batchEnd;
+        ++batchNumber;
+      }
+
+      if (keepOwnedBlocks)
       {
-        // Read in the block on all cores (nothing will be done if this core doesn't need the block).
-        ReadInBlock(offset,
-                    geometry,
-                    needs.ProcessorsNeedingBlock(nextBlockToRead),
-                    nextBlockToRead,
-                    readBlock[nextBlockToRead]);
+        KeepOwnedBlocks(unitForEachBlock,
+                        compressedData,
+                        previousBatchStart,
+                        geometry.GetBlockCount());
+      }
+      DecompressBlocks(geometry,
+                       readBlock,
+                       compressedData,
+                       uncompressedData,
+                       previousBatchStart,
+                       geometry.GetBlockCount());
+      ParseBlocks(geometry, readBlock, uncompressedData, previousBatchStart, geometry.GetBlockCount());
+
+      // Only the sites' links are kept between reads.
+      receivingArenas[0].Release();
+      receivingArenas[1].Release();
+      decompressingArena.Release();
+      ownedBlocksKept = keepOwnedBlocks;
+
+      timings[hemelb::reporting::Timers::readBlocksAll].Stop();
+    }
 
-        // Update the offset to be ready for the next block.
-        offset += bytesPerCompressedBlock[nextBlockToRead];
+    void GeometryReader::KeepOwnedBlocks(const std::vector<proc_t>& unitForEachBlock,
+                                         const std::vector<const char*>& compressedData,
+                                         const site_t firstBlock, const site_t endBlock)
+    {
+      for (site_t block = firstBlock; block < endBlock; ++block)
+      {
+        if (fluidSitesOnEachBlock[block] > 0 && unitForEachBlock[block] == computeComms.Rank())
+        {
+          ownedCompressedBlocks[block].assign(compressedData[block],
+                                              compressedData[block]
+                                                  + bytesPerCompressedBlock[block]);
+        }
       }
+    }
+
+    void GeometryReader::ParseSharedBlocks(Geometry& geometry, const std::vector<bool>& readBlock)
+    {
+      timings[hemelb::reporting::Timers::readBlocksAll].Start();
+
+      // Point at each needed block where it is in the shared copy.
+      std::vector<const char*> compressedData(geometry.GetBlockCount(), NULL);
+      MPI_Offset blockStart =
+          io::formats::geometry::GetBlockDataStart(geometry.GetBlockCount(), blockCompression);
+      for (site_t block = 0; block < geometry.GetBlockCount(); ++block)
+      {
+        if (blockStart + bytesPerCompressedBlock[block] > sharedFile->GetSize())
+        {
+          throw Exception() << "Geometry file ends after " << sharedFile->GetSize()
+              << " bytes, before block " << block << " does";
+        }
+        if (readBlock[block] && fluidSitesOnEachBlock[block] > 0)
+        {
+          compressedData[block] = sharedFile->GetData() + blockStart;
+        }
+        blockStart += bytesPerCompressedBlock[block];
+      }
+
+      DecompressAndParseInBatches(geometry, readBlock, compressedData);
 
       timings[hemelb::reporting::Timers::readBlocksAll].Stop();
     }
 
-    void GeometryReader::ReadInBlock(MPI_Offset offsetSoFar, Geometry& geometry,
-                                     const std::vector<proc_t>& procsWantingThisBlock,
-                                     const site_t blockNumber, const bool neededOnThisRank)
+    void GeometryReader::DecompressAndParseInBatches(Geometry& geometry,
+                                                     const std::vector<bool>& neededOnThisRank,
+                                                     const std::vector<const char*>& compressedData)
+    {
+      // Batches of about as many compressed bytes as would be forwarded at once.
+      std::vector<char*> uncompressedData(geometry.GetBlockCount(), NULL);
+      site_t batchStart = 0;
+      while (batchStart < geometry.GetBlockCount())
+      {
+        site_t batchEnd = batchStart;
+        site_t batchBytes = 0;
+        while (batchEnd < geometry.GetBlockCount() && (batchEnd == batchStart || batchBytes
+            < BYTES_PER_FORWARDING_BATCH))
+        {
+          if (compressedData[batchEnd] != NULL)
+          {
+            batchBytes += bytesPerCompressedBlock[batchEnd];
+          }
+          ++batchEnd;
+        }
+
+        DecompressBlocks(geometry,
+                         neededOnThisRank,
+                         compressedData,
+                         uncompressedData,
+                         batchStart,
+                         batchEnd);
+        ParseBlocks(geometry, neededOnThisRank, uncompressedData, batchStart, batchEnd);
+        batchStart = batchEnd;
+      }
+
+      decompressingArena.Release();
+    }
+
+    std::vector<char> GeometryReader::ReadBlocksForThisCore(const Geometry& geometry)
+    {
+      timings[hemelb::reporting::Timers::readBlock].Start();
+
+      // Find where each of our blocks is, relative to the start of the block data.
+      std::vector<int> blockLengths;
+      std::vector<MPI_Aint> blockDisplacements;
+      site_t totalBytes = 0;
+      MPI_Aint displacement = 0;
+      for (site_t block = 0; block < geometry.GetBlockCount(); ++block)
+      {
+        if (fluidSitesOnEachBlock[block] > 0 && GetReadingCoreForBlock(block) == computeComms.Rank())
+        {
+          blockLengths.push_back(bytesPerCompressedBlock[block]);
+          blockDisplacements.push_back(displacement);
+          totalBytes += bytesPerCompressedBlock[block];
+        }
+        displacement += bytesPerCompressedBlock[block];
+      }
+
+      // Set the view so that only our blocks are visible, then read them all.
+      MPI_Datatype blocksType = MPI_CHAR;
+      if (!blockLengths.empty())
+      {
+        HEMELB_MPI_CALL(MPI_Type_create_hindexed,
+                        (blockLengths.size(), &blockLengths[0], &blockDisplacements[0], MPI_CHAR, &blocksType));
+        HEMELB_MPI_CALL(MPI_Type_commit, (&blocksType));
+      }
+      file.SetView(io::formats::geometry::GetBlockDataStart(geometry.GetBlockCount(),
+                                                            blockCompression),
+                   MPI_CHAR,
+                   blocksType,
+                   "native",
+                   MPI_INFO_NULL);
+
+      std::vector<char> blocksReadHere(totalBytes);
+      file.ReadAtAll(0, blocksReadHere);
+
+      file.SetView(0, MPI_CHAR, MPI_CHAR, "native", MPI_INFO_NULL);
+      if (!blockLengths.empty())
+      {
+        HEMELB_MPI_CALL(MPI_Type_free, (&blocksType));
+      }
+
+      timings[hemelb::reporting::Timers::readBlock].Stop();
+      return blocksReadHere;
+    }
+
+    void GeometryReader::RequestBlock(net::Net& net, char* readData,
+                                      const char*& compressedBlockData,
+                                      util::MonotonicArena& receivingArena,
+                                      const std::vector<proc_t>& procsWantingThisBlock,
+                                      const site_t blockNumber, const bool neededOnThisRank)
     {
       // Easy case if there are no sites on the block.
       if (fluidSitesOnEachBlock[blockNumber] <= 0)
       {
         return;
       }
-      std::vector<char> compressedBlockData;
       proc_t readingCore = GetReadingCoreForBlock(blockNumber);
 
-      net::Net net = net::Net(computeComms);
-
       if (readingCore == computeComms.Rank())
       {
-        timings[hemelb::reporting::Timers::readBlock].Start();
-        // Read the data.
-        compressedBlockData.resize(bytesPerCompressedBlock[blockNumber]);
-        file.ReadAt(offsetSoFar, compressedBlockData);
+        // The data has already been read.
+        compressedBlockData = readData;
 
         // Spread it.
         for (std::vector<proc_t>::const_iterator receiver = procsWantingThisBlock.begin(); receiver
@@ -381,117 +766,172 @@ namespace hemelb
         {
           if (*receiver != computeComms.Rank())
           {
-
-            net.RequestSendV(compressedBlockData, *receiver);
+            net.RequestSend(readData, bytesPerCompressedBlock[blockNumber], *receiver);
           }
         }
-        timings[hemelb::reporting::Timers::readBlock].Stop();
       }
       else if (neededOnThisRank)
       {
-        compressedBlockData.resize(bytesPerCompressedBlock[blockNumber]);
-
-        net.RequestReceiveV(compressedBlockData, readingCore);
+        char* receivedData = static_cast<char*>(receivingArena.Allocate(bytesPerCompressedBlock[blockNumber],
+                                                                        1));
+        compressedBlockData = receivedData;
 
+        net.RequestReceive(receivedData, bytesPerCompressedBlock[blockNumber], readingCore);
       }
-      else
+    }
+
+    void GeometryReader::DecompressBlocks(const Geometry& geometry,
+                                          const std::vector<bool>& neededOnThisRank,
+                                          const std::vector<const char*>& compressedData,
+                                          std::vector<char*>& uncompressedData,
+                                          const site_t firstBlock, const site_t endBlock)
+    {
+      timings[hemelb::reporting::Timers::unzip].Start();
+
+      // The previous range has been parsed, so its buffers can be handed out again. They are
+      // handed out before the threads start, as the lengths are known.
+      decompressingArena.Rewind();
+      for (site_t block = firstBlock; block < endBlock; ++block)
       {
-        return;
+        if (fluidSitesOnEachBlock[block] > 0 && neededOnThisRank[block])
+        {
+          uncompressedData[block] =
+              static_cast<char*>(decompressingArena.Allocate(bytesPerUncompressedBlock[block]));
+        }
       }
-      timings[hemelb::reporting::Timers::readNet].Start();
-      net.Dispatch();
-      timings[hemelb::reporting::Timers::readNet].Stop();
-      timings[hemelb::reporting::Timers::readParse].Start();
-      if (neededOnThisRank)
-      {
-        // Create an Xdr interpreter.
-        std::vector<char> blockData = DecompressBlockData(compressedBlockData,
-                                                          bytesPerUncompressedBlock[blockNumber]);
-        io::writers::xdr::XdrMemReader lReader(&blockData.front(), blockData.size());
 
-        ParseBlock(geometry, blockNumber, lReader);
+      // Decompression errors can't be thrown out of a parallel loop, so remember the first one.
+      site_t failedBlock = -1;
 
-        // If debug-level logging, check that we've read in as many sites as anticipated.
-        if (ShouldValidate())
+#ifdef HEMELB_USE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+      for (site_t block = firstBlock; block < endBlock; ++block)
+      {
+        if (fluidSitesOnEachBlock[block] <= 0 || !neededOnThisRank[block])
         {
-          // Count the sites read,
-          site_t numSitesRead = 0;
-          for (site_t site = 0; site < geometry.GetSitesPerBlock(); ++site)
-          {
-            if (geometry.Blocks[blockNumber].Sites[site].targetProcessor != SITE_OR_BLOCK_SOLID)
-            {
-              ++numSitesRead;
-            }
-          }
-          // Compare with the sites we expected to read.
-          if (numSitesRead != fluidSitesOnEachBlock[blockNumber])
+          continue;
+        }
+
+        if (!blockDecompressor.Decompress(compressedData[block],
+                                          bytesPerCompressedBlock[block],
+                                          uncompressedData[block],
+                                          bytesPerUncompressedBlock[block]))
+        {
+#ifdef HEMELB_USE_OPENMP
+#pragma omp critical
+#endif
+          if (failedBlock < 0)
           {
-            log::Logger::Log<log::Error, log::OnePerCore>("Was expecting %i fluid sites on block %i but actually read %i",
-                                                          fluidSitesOnEachBlock[blockNumber],
-                                                          blockNumber,
-                                                          numSitesRead);
+            failedBlock = block;
           }
         }
       }
-      else if (!geometry.Blocks[blockNumber].Sites.empty())
+
+      timings[hemelb::reporting::Timers::unzip].Stop();
+
+      if (failedBlock >= 0)
       {
-        geometry.Blocks[blockNumber].Sites = std::vector<GeometrySite>(0, GeometrySite(false));
+        throw Exception() << "Decompression error for block " << failedBlock;
       }
-      timings[hemelb::reporting::Timers::readParse].Stop();
     }
 
-    std::vector<char> GeometryReader::DecompressBlockData(const std::vector<char>& compressed,
-                                                          const unsigned int uncompressedBytes)
+    void GeometryReader::ParseBlocks(Geometry& geometry, const std::vector<bool>& neededOnThisRank,
+                                     const std::vector<char*>& uncompressedData,
+                                     const site_t firstBlock, const site_t endBlock)
     {
-      timings[hemelb::reporting::Timers::unzip].Start();
-      // For zlib return codes.
-      int ret;
+      timings[hemelb::reporting::Timers::readParse].Start();
 
-      // Set up the buffer for decompressed data. We know how long the the data is
-      std::vector<char> uncompressed(uncompressedBytes);
+      // The format's singleton is made on first use, so make it before the threads race to.
+      io::formats::geometry::Get();
 
-      // Set up the inflator
-      z_stream stream;
-      stream.zalloc = Z_NULL;
-      stream.zfree = Z_NULL;
-      stream.opaque = Z_NULL;
-      stream.avail_in = compressed.size();
-      stream.next_in = reinterpret_cast<unsigned char*> (const_cast<char*> (&compressed.front()));
+      // Parsing errors can't be thrown out of a parallel loop, so remember the first one.
+      site_t failedBlock = -1;
+      std::string failure;
 
-      ret = inflateInit(&stream);
-      if (ret != Z_OK)
-        throw Exception() << "Decompression error for block";
+#ifdef HEMELB_USE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+      for (site_t blockNumber = firstBlock; blockNumber < endBlock; ++blockNumber)
+      {
+        if (fluidSitesOnEachBlock[blockNumber] <= 0)
+        {
+          continue;
+        }
 
-      stream.avail_out = uncompressed.size();
-      stream.next_out = reinterpret_cast<unsigned char*> (&uncompressed.front());
+        if (neededOnThisRank[blockNumber])
+        {
+          // Create an Xdr interpreter.
+          io::writers::xdr::XdrMemReader lReader(uncompressedData[blockNumber],
+                                                 bytesPerUncompressedBlock[blockNumber]);
 
-      ret = inflate(&stream, Z_FINISH);
-      if (ret != Z_STREAM_END)
-        throw Exception() << "Decompression error for block";
+          try
+          {
+            ParseBlock(geometry, blockNumber, lReader);
+          }
+          catch (const std::exception& e)
+          {
+#ifdef HEMELB_USE_OPENMP
+#pragma omp critical
+#endif
+            if (failedBlock < 0)
+            {
+              failedBlock = blockNumber;
+              failure = e.what();
+            }
+            continue;
+          }
 
-      uncompressed.resize(uncompressed.size() - stream.avail_out);
-      ret = inflateEnd(&stream);
-      if (ret != Z_OK)
-        throw Exception() << "Decompression error for block";
+          // If debug-level logging, check that we've read in as many sites as anticipated.
+          if (ShouldValidate())
+          {
+            // Count the sites read,
+            site_t numSitesRead = 0;
+            for (site_t site = 0; site < geometry.GetSitesPerBlock(); ++site)
+            {
+              if (geometry.Blocks[blockNumber].Sites[site].targetProcessor != SITE_OR_BLOCK_SOLID)
+              {
+                ++numSitesRead;
+              }
+            }
+            // Compare with the sites we expected to read.
+            if (numSitesRead != fluidSitesOnEachBlock[blockNumber])
+            {
+              log::Logger::Log<log::Error, log::OnePerCore>("Was expecting %i fluid sites on block %i but actually read %i",
+                                                            fluidSitesOnEachBlock[blockNumber],
+                                                            blockNumber,
+                                                            numSitesRead);
+            }
+          }
+        }
+      }
 
-      timings[hemelb::reporting::Timers::unzip].Stop();
-      return uncompressed;
+      timings[hemelb::reporting::Timers::readParse].Stop();
+
+      if (failedBlock >= 0)
+      {
+        throw Exception() << "Error parsing block " << failedBlock << ": " << failure;
+      }
     }
 
     void GeometryReader::ParseBlock(Geometry& geometry, const site_t block,
                                     io::writers::xdr::XdrReader& reader)
     {
-      // We start by clearing the sites on the block. We read the blocks twice (once before
-      // optimisation and once after), so there can be sites on the block from the previous read.
-      geometry.Blocks[block].Sites.clear();
+      // We read the blocks twice (once before optimisation and once after), so there can be
+      // sites on the block from the previous read, which are overwritten.
+      std::vector<GeometrySite>& sites = geometry.Blocks[block].Sites;
+      if (site_t(sites.size()) != geometry.GetSitesPerBlock())
+      {
+        sites.assign(geometry.GetSitesPerBlock(), GeometrySite(false, &siteArena));
+      }
 
       for (site_t localSiteIndex = 0; localSiteIndex < geometry.GetSitesPerBlock(); ++localSiteIndex)
       {
-        geometry.Blocks[block].Sites.push_back(ParseSite(reader));
+        ParseSite(reader, sites[localSiteIndex]);
       }
     }
 
-    GeometrySite GeometryReader::ParseSite(io::writers::xdr::XdrReader& reader)
+    void GeometryReader::ParseSite(io::writers::xdr::XdrReader& reader, GeometrySite& site)
     {
       // Read the fluid property.
       unsigned isFluid;
@@ -503,18 +943,23 @@ namespace hemelb
       }
 
       /// @todo #598 use constant in hemelb::io::formats::geometry
-      GeometrySite readInSite(isFluid != 0);
+      site.isFluid = isFluid != 0;
+      site.targetProcessor = site.isFluid ?
+        -1 :
+        SITE_OR_BLOCK_SOLID;
+      site.wallNormalAvailable = false;
+      site.wallNormal = util::Vector3D<float>::Zero();
+      // The room for any cut links from an earlier read is kept.
+      site.ClearLinks();
 
       // If solid, there's nothing more to do.
-      if (!readInSite.isFluid)
+      if (!site.isFluid)
       {
-        return readInSite;
+        return;
       }
 
       const io::formats::geometry::DisplacementVector& neighbourhood =
           io::formats::geometry::Get().GetNeighbourhood();
-      // Prepare the links array to have enough space.
-      readInSite.links.resize(latticeInfo.GetNumVectors() - 1);
 
       bool isGmyWallSite = false;
 
@@ -557,7 +1002,7 @@ namespace hemelb
           if (latticeInfo.GetVector(usedLatticeDirection) == neighbourhood[readDirection])
           {
             // If this link direction is necessary to the lattice in use, keep the link data.
-            readInSite.links[usedLatticeDirection - 1] = link;
+            site.SetLink(usedLatticeDirection - 1, link);
             break;
           }
         }
@@ -565,10 +1010,10 @@ namespace hemelb
 
       unsigned normalAvailable;
       reader.readUnsignedInt(normalAvailable);
-      readInSite.wallNormalAvailable = (normalAvailable
+      site.wallNormalAvailable = (normalAvailable
           == io::formats::geometry::WALL_NORMAL_AVAILABLE);
 
-      if (readInSite.wallNormalAvailable != isGmyWallSite)
+      if (site.wallNormalAvailable != isGmyWallSite)
       {
         std::string msg = isGmyWallSite
           ? "wall fluid site without"
@@ -577,20 +1022,31 @@ namespace hemelb
             << msg << " a defined wall normal currently not allowed.";
       }
 
-      if (readInSite.wallNormalAvailable)
+      if (site.wallNormalAvailable)
       {
-        reader.readFloat(readInSite.wallNormal[0]);
-        reader.readFloat(readInSite.wallNormal[1]);
-        reader.readFloat(readInSite.wallNormal[2]);
+        reader.readFloat(site.wallNormal[0]);
+        reader.readFloat(site.wallNormal[1]);
+        reader.readFloat(site.wallNormal[2]);
       }
-
-      return readInSite;
     }
 
     proc_t GeometryReader::GetReadingCoreForBlock(site_t blockNumber)
     {
-      return proc_t(blockNumber % util::NumericalFunctions::min(READING_GROUP_SIZE,
-                                                                computeComms.Size()));
+      return proc_t(blockNumber % readingGroupSize);
+    }
+
+    proc_t GeometryReader::ChooseReadingGroupSize() const
+    {
+      site_t totalBytes = 0;
+      for (std::vector<unsigned int>::const_iterator bytes = bytesPerCompressedBlock.begin(); bytes
+          != bytesPerCompressedBlock.end(); ++bytes)
+      {
+        totalBytes += *bytes;
+      }
+
+      site_t groupSize = (totalBytes + BYTES_PER_READING_CORE - 1) / BYTES_PER_READING_CORE;
+      groupSize = util::NumericalFunctions::max(groupSize, site_t(READING_GROUP_SIZE));
+      return proc_t(util::NumericalFunctions::min(groupSize, site_t(computeComms.Size())));
     }
 
     /**
@@ -601,111 +1057,121 @@ namespace hemelb
     {
       log::Logger::Log<log::Debug, log::OnePerCore>("Validating the GlobalLatticeData");
 
-      // We check the isFluid property and the link type for each direction
-
-      std::vector<proc_t> myProcForSite;
-      std::vector<unsigned> dummySiteData;
+      const unsigned salt = validationCount++;
+      const proc_t rankCount = computeComms.Size();
 
-      // We also validate that each processor has the same beliefs about each site.
+      // The id and hash of each block checked that this rank has, by the rank that checks it.
+      std::vector<std::vector<uint64_t> > hashesForEachRank(rankCount);
       for (site_t block = 0; block < geometry.GetBlockCount(); ++block)
       {
-        // Clear vectors
-        myProcForSite.clear();
-        dummySiteData.clear();
+        if (geometry.Blocks[block].Sites.empty() || !IsBlockSampled(block, salt))
+        {
+          continue;
+        }
+        std::vector<uint64_t>& hashes = hashesForEachRank[block % rankCount];
+        hashes.push_back(block);
+        hashes.push_back(HashBlock(geometry.Blocks[block]));
+      }
 
-        if (geometry.Blocks[block].Sites.size() == 0)
+      std::vector<uint64_t> sendValues;
+      std::vector<int> sendCounts(rankCount);
+      for (proc_t rank = 0; rank < rankCount; ++rank)
+      {
+        sendValues.insert(sendValues.end(),
+                          hashesForEachRank[rank].begin(),
+                          hashesForEachRank[rank].end());
+        sendCounts[rank] = hashesForEachRank[rank].size();
+      }
+      const std::vector<int> receiveCounts = computeComms.AllToAll(sendCounts);
+      const std::vector<uint64_t> received = computeComms.AllToAllV(sendValues,
+                                                                    sendCounts,
+                                                                    receiveCounts);
+
+      // Compare the hash of each block from each rank with the first one received.
+      std::map<site_t, std::pair<uint64_t, proc_t> > firstHashForEachBlock;
+      uint64_t mismatchCount = 0;
+      size_t position = 0;
+      for (proc_t rank = 0; rank < rankCount; ++rank)
+      {
+        for (int value = 0; value < receiveCounts[rank]; value += 2, position += 2)
         {
-          for (site_t localSite = 0; localSite < geometry.GetSitesPerBlock(); ++localSite)
+          const site_t block = received[position];
+          const uint64_t hash = received[position + 1];
+          std::map<site_t, std::pair<uint64_t, proc_t> >::const_iterator first =
+              firstHashForEachBlock.find(block);
+          if (first == firstHashForEachBlock.end())
           {
-            myProcForSite.push_back(SITE_OR_BLOCK_SOLID);
-            dummySiteData.push_back(std::numeric_limits<unsigned>::max());
-            for (Direction direction = 1; direction < latticeInfo.GetNumVectors(); ++direction)
-            {
-              dummySiteData.push_back(std::numeric_limits<unsigned>::max());
-            }
+            firstHashForEachBlock[block] = std::make_pair(hash, rank);
           }
-        }
-        else
-        {
-          for (site_t localSite = 0; localSite < geometry.GetSitesPerBlock(); ++localSite)
+          else if (first->second.first != hash)
           {
-            myProcForSite.push_back(geometry.Blocks[block].Sites[localSite].targetProcessor);
-
-            dummySiteData.push_back(geometry.Blocks[block].Sites[localSite].isFluid);
-
-            for (Direction direction = 1; direction < latticeInfo.GetNumVectors(); ++direction)
-            {
-              if (geometry.Blocks[block].Sites[localSite].isFluid)
-              {
-                dummySiteData.push_back(geometry.Blocks[block].Sites[localSite].links[direction - 1].type);
-              }
-              else
-              {
-                dummySiteData.push_back(std::numeric_limits<unsigned>::max());
-              }
-            }
+            log::Logger::Log<log::Critical, log::OnePerCore>("Cores %i and %i have different data for block %li.",
+                                                             ConvertTopologyRankToGlobalRank(first->second.second),
+                                                             ConvertTopologyRankToGlobalRank(rank),
+                                                             block);
+            ++mismatchCount;
           }
         }
+      }
 
-        // Reduce using a minimum to find the actual processor for each site (ignoring the
-        // invalid entries).
-        std::vector<proc_t> procForSiteRecv = computeComms.AllReduce(myProcForSite, MPI_MIN);
-        std::vector<unsigned> siteDataRecv = computeComms.AllReduce(dummySiteData, MPI_MIN);
+      const uint64_t totalMismatchCount = computeComms.AllReduce(mismatchCount, MPI_SUM);
+      if (totalMismatchCount > 0)
+      {
+        throw Exception() << "The cores have different data for " << totalMismatchCount
+            << " blocks of the geometry";
+      }
+    }
 
-        for (site_t site = 0; site < geometry.GetSitesPerBlock(); ++site)
+    uint32_t GeometryReader::HashBlock(const BlockReadResult& block) const
+    {
+      uLong hash = crc32(0L, Z_NULL, 0);
+      for (std::vector<GeometrySite>::const_iterator site = block.Sites.begin();
+          site != block.Sites.end(); ++site)
+      {
+        const int32_t siteData[2] = { site->isFluid, site->targetProcessor };
+        hash = crc32(hash, reinterpret_cast<const Bytef*>(siteData), sizeof(siteData));
+        if (!site->isFluid)
         {
-          if (procForSiteRecv[site] == ConvertTopologyRankToGlobalRank(computeComms.Rank())
-              && (myProcForSite[site] != ConvertTopologyRankToGlobalRank(computeComms.Rank())))
-          {
-            log::Logger::Log<log::Critical, log::OnePerCore>("Other cores think this core has site %li on block %li but it disagrees.",
-                                                             site,
-                                                             block);
-          }
-          else if (myProcForSite[site] != SITE_OR_BLOCK_SOLID && procForSiteRecv[site]
-              != myProcForSite[site])
-          {
-            log::Logger::Log<log::Critical, log::OnePerCore>("This core thought that core %li has site %li on block %li but others think it's on core %li.",
-                                                             myProcForSite[site],
-                                                             site,
-                                                             block,
-                                                             procForSiteRecv[site]);
-          }
+          continue;
+        }
 
-          if (geometry.Blocks[block].Sites.size() > 0)
+        for (Direction direction = 1; direction < latticeInfo.GetNumVectors(); ++direction)
+        {
+          const GeometrySiteLink link = site->GetLink(direction - 1);
+          const int32_t type = link.type;
+          hash = crc32(hash, reinterpret_cast<const Bytef*>(&type), sizeof(type));
+          if (link.type != GeometrySiteLink::NO_INTERSECTION)
           {
-            if (dummySiteData[site * latticeInfo.GetNumVectors()] != siteDataRecv[site
-                * latticeInfo.GetNumVectors()])
-            {
-              log::Logger::Log<log::Critical, log::OnePerCore>("Different fluid state was found for site %li on block %li. One: %li, Two: %li .",
-                                                               site,
-                                                               block,
-                                                               dummySiteData[site
-                                                                   * latticeInfo.GetNumVectors()],
-                                                               siteDataRecv[site
-                                                                   * latticeInfo.GetNumVectors()]);
-            }
-
-            for (Direction direction = 1; direction < latticeInfo.GetNumVectors(); ++direction)
-            {
-              if (dummySiteData[site * latticeInfo.GetNumVectors() + direction]
-                  != siteDataRecv[site * latticeInfo.GetNumVectors() + direction])
-              {
-                log::Logger::Log<log::Critical, log::OnePerCore>("Different link type was found for site %li, link %i on block %li. One: %li, Two: %li .",
-                                                                 site,
-                                                                 direction,
-                                                                 block,
-                                                                 dummySiteData[site
-                                                                     * latticeInfo.GetNumVectors()
-                                                                     + direction],
-                                                                 siteDataRecv[site
-                                                                     * latticeInfo.GetNumVectors()
-                                                                     + direction]);
-              }
-            }
-
+            const int32_t ioletId = link.ioletId;
+            hash = crc32(hash, reinterpret_cast<const Bytef*>(&ioletId), sizeof(ioletId));
+            hash = crc32(hash,
+                         reinterpret_cast<const Bytef*>(&link.distanceToIntersection),
+                         sizeof(link.distanceToIntersection));
           }
         }
+        if (site->wallNormalAvailable)
+        {
+          hash = crc32(hash, reinterpret_cast<const Bytef*>(&site->wallNormal.x), sizeof(float));
+          hash = crc32(hash, reinterpret_cast<const Bytef*>(&site->wallNormal.y), sizeof(float));
+          hash = crc32(hash, reinterpret_cast<const Bytef*>(&site->wallNormal.z), sizeof(float));
+        }
       }
+      return hash;
+    }
+
+    bool GeometryReader::IsBlockSampled(site_t blockId, unsigned salt)
+    {
+      if (VALIDATION_FRACTION >= 1.0)
+      {
+        return true;
+      }
+      // Mix the block id and the salt (with the SplitMix64 finaliser) into a number uniform
+      // in [0, 1), the same on every rank.
+      uint64_t key = uint64_t(blockId) * 0x9e3779b97f4a7c15ULL + salt;
+      key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+      key ^= key >> 31;
+      return double(key >> 11) / double(1ULL << 53) < VALIDATION_FRACTION;
     }
 
     std::vector<bool> GeometryReader::DecideWhichBlocksToReadIncludingHalo(
@@ -754,32 +1220,329 @@ namespace hemelb
     }
 
     void GeometryReader::OptimiseDomainDecomposition(Geometry& geometry,
-                                                     const std::vector<proc_t>& procForEachBlock)
+                                                     const std::vector<proc_t>& procForEachBlock,
+                                                     const std::string& decompositionToSave)
     {
       decomposition::OptimisedDecomposition optimiser(timings,
                                                       computeComms,
                                                       geometry,
                                                       latticeInfo,
                                                       procForEachBlock,
-                                                      fluidSitesOnEachBlock);
+                                                      fluidSitesOnEachBlock,
+                                                      siteWeights,
+                                                      blockCostFactors,
+                                                      balanceConstraints);
+
+      if (!decompositionToSave.empty())
+      {
+        log::Logger::Log<log::Info, log::Singleton>("Saving the decomposition to %s",
+                                                    decompositionToSave.c_str());
+        WriteDecomposition(decompositionToSave,
+                           procForEachBlock,
+                           optimiser.GetMovesCountPerCore(),
+                           optimiser.GetMovesList());
+      }
+
+      ImplementDecomposition(geometry,
+                             procForEachBlock,
+                             optimiser.GetMovesCountPerCore(),
+                             optimiser.GetMovesList());
+    }
 
+    void GeometryReader::ImplementDecomposition(Geometry& geometry,
+                                                const std::vector<proc_t>& procForEachBlock,
+                                                const std::vector<idx_t>& movesFromEachProc,
+                                                const std::vector<idx_t>& movesList)
+    {
       timings[hemelb::reporting::Timers::reRead].Start();
-      log::Logger::Log<log::Debug, log::OnePerCore>("Rereading blocks");
-      // Reread the blocks based on the ParMetis decomposition.
-      RereadBlocks(geometry,
-                   optimiser.GetMovesCountPerCore(),
-                   optimiser.GetMovesList(),
-                   procForEachBlock);
+      log::Logger::Log<log::Debug, log::OnePerCore>("Migrating blocks");
+      // Get the blocks needed for the ParMetis decomposition.
+      RereadBlocks(geometry, movesFromEachProc, movesList, procForEachBlock);
       timings[hemelb::reporting::Timers::reRead].Stop();
 
       timings[hemelb::reporting::Timers::moves].Start();
       // Implement the decomposition now that we have read the necessary data.
       log::Logger::Log<log::Debug, log::OnePerCore>("Implementing moves");
-      ImplementMoves(geometry,
-                     procForEachBlock,
-                     optimiser.GetMovesCountPerCore(),
-                     optimiser.GetMovesList());
+      ImplementMoves(geometry, procForEachBlock, movesFromEachProc, movesList);
       timings[hemelb::reporting::Timers::moves].Stop();
+
+      // Every core has every move, so remember them all for GetProcForSite.
+      procForEachMovedSite.clear();
+      for (size_t move = 0; move < movesList.size() / 3; ++move)
+      {
+        procForEachMovedSite[std::make_pair(site_t(movesList[3 * move]),
+                                            site_t(movesList[3 * move + 1]))] =
+            proc_t(movesList[3 * move + 2]);
+      }
+    }
+
+    proc_t GeometryReader::GetProcForSite(site_t block, site_t siteIndex) const
+    {
+      std::map<std::pair<site_t, site_t>, proc_t>::const_iterator moved =
+          procForEachMovedSite.find(std::make_pair(block, siteIndex));
+
+      return ConvertTopologyRankToGlobalRank(moved == procForEachMovedSite.end()
+        ? principalProcForEachBlock[block]
+        : moved->second);
+    }
+
+    size_t GeometryReader::GetArenaPeakBytes() const
+    {
+      return receivingArenas[0].GetPeakBytes() + receivingArenas[1].GetPeakBytes()
+          + decompressingArena.GetPeakBytes() + siteArena.GetPeakBytes();
+    }
+
+    void GeometryReader::WriteDecomposition(const std::string& path,
+                                            const std::vector<proc_t>& procForEachBlock,
+                                            const std::vector<idx_t>& movesFromEachProc,
+                                            const std::vector<idx_t>& movesList) const
+    {
+      if (computeComms.Rank() != 0)
+      {
+        return;
+      }
+
+      // Not being able to save it is no reason to stop the run.
+      try
+      {
+        io::writers::xdr::XdrFileWriter writer(path);
+        writer << (uint32_t) io::formats::HemeLbMagicNumber
+            << (uint32_t) io::formats::decomposition::MagicNumber
+            << (uint32_t) io::formats::decomposition::VersionNumber
+            << (uint32_t) procForEachBlock.size() << (uint32_t) movesFromEachProc.size()
+            << (uint32_t) (movesList.size() / 3);
+
+        for (std::vector<proc_t>::const_iterator proc = procForEachBlock.begin();
+            proc != procForEachBlock.end(); ++proc)
+        {
+          writer << (uint32_t) *proc;
+        }
+        for (std::vector<idx_t>::const_iterator moves = movesFromEachProc.begin();
+            moves != movesFromEachProc.end(); ++moves)
+        {
+          writer << (uint32_t) *moves;
+        }
+        for (std::vector<idx_t>::const_iterator move = movesList.begin(); move != movesList.end();
+            ++move)
+        {
+          writer << (uint32_t) *move;
+        }
+      }
+      catch (const Exception& e)
+      {
+        log::Logger::Log<log::Warning, log::OnePerCore>("Could not save the decomposition to %s: %s",
+                                                        path.c_str(),
+                                                        e.what());
+      }
+    }
+
+    std::string GeometryReader::GetCachedDecompositionPath(const std::string& cacheDirectory,
+                                                           const std::vector<site_t>& weightOnEachBlock) const
+    {
+      // Key the file by the geometry and what it was balanced with; the core count is in the
+      // name.
+      const std::vector<int>& weights = siteWeights.GetWeights();
+      uLong key = crc32(geometryChecksum,
+                        reinterpret_cast<const Bytef*> (&weights[0]),
+                        weights.size() * sizeof(int));
+      if (!weightOnEachBlock.empty())
+      {
+        key = crc32(key,
+                    reinterpret_cast<const Bytef*> (&weightOnEachBlock[0]),
+                    weightOnEachBlock.size() * sizeof(site_t));
+      }
+      if (!blockCostFactors.empty())
+      {
+        key = crc32(key,
+                    reinterpret_cast<const Bytef*> (&blockCostFactors[0]),
+                    blockCostFactors.size() * sizeof(double));
+      }
+      const double tolerances[2] = { balanceConstraints.computeTolerance,
+                                     balanceConstraints.memoryTolerance };
+      key = crc32(key, reinterpret_cast<const Bytef*> (tolerances), sizeof(tolerances));
+
+#if defined(HEMELB_PARTITIONER_HILBERT)
+      const char partitioner[] = "Hilbert";
+#else
+      const char partitioner[] = "ParMETIS";
+#endif
+      key = crc32(key, reinterpret_cast<const Bytef*> (partitioner), sizeof(partitioner));
+
+#ifdef HEMELB_NODE_AWARE_DECOMPOSITION
+      // Which cores share a node, each node being known by the lowest rank on it, as
+      // OptimisedDecomposition groups them.
+      const net::MpiCommunicator nodeComms = computeComms.SplitShared();
+      const std::vector<proc_t> leaderForEachRank =
+          computeComms.AllGather(nodeComms.AllReduce(computeComms.Rank(), MPI_MIN));
+      key = crc32(key,
+                  reinterpret_cast<const Bytef*> (&leaderForEachRank[0]),
+                  leaderForEachRank.size() * sizeof(proc_t));
+#endif
+
+      std::stringstream path;
+      path << cacheDirectory << "/" << std::hex << std::setw(8) << std::setfill('0') << key
+          << std::dec << "_" << computeComms.Size() << ".dcm";
+      return path.str();
+    }
+
+    bool GeometryReader::DecompositionExists(const std::string& path) const
+    {
+      int exists = 0;
+      if (computeComms.Rank() == 0)
+      {
+        FILE* decompositionFile = std::fopen(path.c_str(), "r");
+        if (decompositionFile != NULL)
+        {
+          exists = 1;
+          std::fclose(decompositionFile);
+        }
+      }
+      computeComms.Broadcast(exists, 0);
+      return exists != 0;
+    }
+
+    void GeometryReader::ReadDecomposition(const std::string& path, const site_t blockCount,
+                                           std::vector<proc_t>& procForEachBlock,
+                                           std::vector<idx_t>& movesFromEachProc,
+                                           std::vector<idx_t>& movesList) const
+    {
+      // The preamble, then everything after it, is read on one core and broadcast to the rest.
+      std::vector<unsigned> preamble(io::formats::decomposition::PreambleLength / 4, 0);
+      std::vector<unsigned> contents;
+
+      if (computeComms.Rank() == 0)
+      {
+        FILE* decompositionFile = std::fopen(path.c_str(), "r");
+        if (decompositionFile != NULL)
+        {
+          io::writers::xdr::XdrFileReader reader(decompositionFile);
+          for (unsigned i = 0; i < preamble.size(); ++i)
+          {
+            reader.readUnsignedInt(preamble[i]);
+          }
+          contents.resize(preamble[3] + preamble[4] + 3 * preamble[5]);
+          for (unsigned i = 0; i < contents.size(); ++i)
+          {
+            reader.readUnsignedInt(contents[i]);
+          }
+          std::fclose(decompositionFile);
+        }
+      }
+      computeComms.Broadcast(preamble, 0);
+
+      if (preamble[0] != io::formats::HemeLbMagicNumber
+          || preamble[1] != io::formats::decomposition::MagicNumber)
+      {
+        throw Exception() << "Could not read a decomposition from " << path;
+      }
+      if (preamble[2] != io::formats::decomposition::VersionNumber)
+      {
+        throw Exception() << "Decomposition version number incorrect."
+            << " Supported: " << unsigned(io::formats::decomposition::VersionNumber)
+            << " Input: " << preamble[2];
+      }
+      if (preamble[3] != blockCount || preamble[4] != (unsigned) computeComms.Size())
+      {
+        throw Exception() << "The decomposition in " << path << " is of " << preamble[3]
+            << " blocks over " << preamble[4] << " cores, not " << blockCount << " blocks over "
+            << computeComms.Size() << " cores";
+      }
+
+      contents.resize(preamble[3] + preamble[4] + 3 * preamble[5]);
+      computeComms.Broadcast(contents, 0);
+
+      std::vector<unsigned>::const_iterator next = contents.begin();
+      procForEachBlock.assign(next, next + preamble[3]);
+      next += preamble[3];
+      movesFromEachProc.assign(next, next + preamble[4]);
+      next += preamble[4];
+      movesList.assign(next, next + 3 * preamble[5]);
+    }
+
+    bool GeometryReader::ReadBlockStats(const std::string& path, const site_t blockCount,
+                                        std::vector<site_t>& weightOnEachBlock) const
+    {
+      namespace blockstats = io::formats::blockstats;
+
+      // 0 if there is no file, 1 if it matches the geometry and -1 if it doesn't.
+      int status = 0;
+      std::vector<unsigned> sitesOfType(blockCount * blockstats::CollisionTypeCount, 0);
+
+      if (computeComms.Rank() == 0)
+      {
+        FILE* statsFile = std::fopen(path.c_str(), "r");
+        if (statsFile != NULL)
+        {
+          io::writers::xdr::XdrFileReader reader(statsFile);
+          std::vector<unsigned> preamble(blockstats::PreambleLength / 4, 0);
+          for (unsigned i = 0; i < preamble.size(); ++i)
+          {
+            reader.readUnsignedInt(preamble[i]);
+          }
+          status = (preamble[0] == io::formats::HemeLbMagicNumber
+              && preamble[1] == blockstats::MagicNumber
+              && preamble[2] == blockstats::VersionNumber && preamble[3] == blockCount
+              && preamble[4] == blockstats::CollisionTypeCount
+              && preamble[5] == (geometryChecksum & 0xffffffffUL))
+            ? 1
+            : -1;
+
+          // Each block's record must agree with the header of the geometry.
+          uint64_t expectedOffset = io::formats::geometry::GetBlockDataStart(blockCount,
+                                                                             blockCompression);
+          for (site_t block = 0; status > 0 && block < blockCount; ++block)
+          {
+            unsigned fluidSites;
+            uint64_t offset;
+            bool read = reader.readUnsignedInt(fluidSites) && reader.readUnsignedLong(offset);
+            site_t typedSites = 0;
+            for (unsigned type = 0; read && type < blockstats::CollisionTypeCount; ++type)
+            {
+              unsigned& sites = sitesOfType[block * blockstats::CollisionTypeCount + type];
+              read = reader.readUnsignedInt(sites);
+              typedSites += sites;
+            }
+            if (!read || fluidSites != fluidSitesOnEachBlock[block]
+                || typedSites != fluidSitesOnEachBlock[block] || offset != expectedOffset)
+            {
+              status = -1;
+            }
+            expectedOffset += bytesPerCompressedBlock[block];
+          }
+          std::fclose(statsFile);
+        }
+      }
+
+      computeComms.Broadcast(status, 0);
+      if (status < 0)
+      {
+        log::Logger::Log<log::Warning, log::Singleton>("Ignoring %s, which isn't for this geometry",
+                                                       path.c_str());
+      }
+      if (status <= 0)
+      {
+        return false;
+      }
+      log::Logger::Log<log::Info, log::Singleton>("Balancing the initial decomposition with the block statistics in %s",
+                                                  path.c_str());
+
+      computeComms.Broadcast(sitesOfType, 0);
+      weightOnEachBlock.assign(blockCount, 0);
+      for (site_t block = 0; block < blockCount; ++block)
+      {
+        site_t weight = 0;
+        for (unsigned type = 0; type < blockstats::CollisionTypeCount; ++type)
+        {
+          weight += site_t(sitesOfType[block * blockstats::CollisionTypeCount + type])
+              * siteWeights[type];
+        }
+        if (!blockCostFactors.empty() && weight > 0)
+        {
+          weight = std::max(site_t(1), site_t(weight * blockCostFactors[block] + 0.5));
+        }
+        weightOnEachBlock[block] = weight;
+      }
+      return true;
     }
 
     // The header section of the config file contains a number of records.
@@ -819,8 +1582,125 @@ namespace hemelb
         }
       }
 
-      // Reread the blocks into the GlobalLatticeData now.
-      ReadInBlocksWithHalo(geometry, newProcForEachBlock, computeComms.Rank());
+      // Forward the blocks still compressed from the cores that read them, unless they weren't
+      // read yet (with a saved decomposition) or are in the node's shared copy of the file.
+      if (ownedBlocksKept)
+      {
+        MigrateBlocks(geometry, newProcForEachBlock, procForEachBlock);
+      }
+      else
+      {
+        ReadInBlocksWithHalo(geometry, newProcForEachBlock, computeComms.Rank());
+      }
+    }
+
+    void GeometryReader::MigrateBlocks(Geometry& geometry,
+                                       const std::vector<proc_t>& newProcForEachBlock,
+                                       const std::vector<proc_t>& oldProcForEachBlock)
+    {
+      timings[hemelb::reporting::Timers::readBlocksPrelim].Start();
+      log::Logger::Log<log::Debug, log::OnePerCore>("Determining blocks to migrate");
+      std::vector<bool> readBlock = DecideWhichBlocksToReadIncludingHalo(geometry,
+                                                                         newProcForEachBlock,
+                                                                         computeComms.Rank());
+
+      // Blocks already parsed here stay, unless they aren't needed any more. The others are
+      // asked for from their old owners, which had them for the first read.
+      std::vector<bool> fetchBlock(geometry.GetBlockCount(), false);
+      std::vector<int> requestCounts(computeComms.Size(), 0);
+      for (site_t block = 0; block < geometry.GetBlockCount(); ++block)
+      {
+        if (fluidSitesOnEachBlock[block] <= 0)
+        {
+          continue;
+        }
+        if (!readBlock[block])
+        {
+          if (!geometry.Blocks[block].Sites.empty())
+          {
+            geometry.Blocks[block].Sites = std::vector<GeometrySite>(0, GeometrySite(false));
+          }
+        }
+        else if (geometry.Blocks[block].Sites.empty())
+        {
+          fetchBlock[block] = true;
+          ++requestCounts[oldProcForEachBlock[block]];
+        }
+      }
+
+      // The blocks asked for, grouped by owner, and how many bytes each owner will send back.
+      std::vector<int> requestStarts(computeComms.Size(), 0);
+      for (proc_t core = 1; core < computeComms.Size(); ++core)
+      {
+        requestStarts[core] = requestStarts[core - 1] + requestCounts[core - 1];
+      }
+      std::vector<site_t> blocksRequested(requestStarts[computeComms.Size() - 1]
+          + requestCounts[computeComms.Size() - 1]);
+      std::vector<site_t> bytesFromEachCore(computeComms.Size(), 0);
+      for (site_t block = 0; block < geometry.GetBlockCount(); ++block)
+      {
+        if (fetchBlock[block])
+        {
+          blocksRequested[requestStarts[oldProcForEachBlock[block]]++] = block;
+          bytesFromEachCore[oldProcForEachBlock[block]] += bytesPerCompressedBlock[block];
+        }
+      }
+      timings[hemelb::reporting::Timers::readBlocksPrelim].Stop();
+
+      timings[hemelb::reporting::Timers::readNet].Start();
+      const std::vector<int> requestCountsHere = computeComms.AllToAll(requestCounts);
+      const std::vector<site_t> blocksRequestedHere = computeComms.AllToAllV(blocksRequested,
+                                                                             requestCounts,
+                                                                             requestCountsHere);
+
+      // Send each core the blocks it asked for, in the order it asked for them.
+      std::vector<char> sendData;
+      std::vector<int> sendBytes(computeComms.Size(), 0);
+      size_t request = 0;
+      for (proc_t core = 0; core < computeComms.Size(); ++core)
+      {
+        site_t bytesToCore = 0;
+        for (int count = 0; count < requestCountsHere[core]; ++count, ++request)
+        {
+          std::map<site_t, std::vector<char> >::const_iterator kept =
+              ownedCompressedBlocks.find(blocksRequestedHere[request]);
+          if (kept == ownedCompressedBlocks.end())
+          {
+            throw Exception() << "Core " << core << " asked core " << computeComms.Rank()
+                << " for block " << blocksRequestedHere[request] << ", which it doesn't own";
+          }
+          sendData.insert(sendData.end(), kept->second.begin(), kept->second.end());
+          bytesToCore += kept->second.size();
+        }
+        if (bytesToCore > std::numeric_limits<int>::max()
+            || bytesFromEachCore[core] > std::numeric_limits<int>::max())
+        {
+          throw Exception() << "Cores " << computeComms.Rank() << " and " << core
+              << " would have to exchange more than " << std::numeric_limits<int>::max()
+              << " bytes of geometry blocks at once";
+        }
+        sendBytes[core] = int(bytesToCore);
+      }
+      const std::vector<int> receiveBytes(bytesFromEachCore.begin(), bytesFromEachCore.end());
+      const std::vector<char> received = computeComms.AllToAllV(sendData, sendBytes, receiveBytes);
+      timings[hemelb::reporting::Timers::readNet].Stop();
+
+      // The kept blocks have all been forwarded.
+      sendData = std::vector<char>();
+      ownedCompressedBlocks.clear();
+      ownedBlocksKept = false;
+
+      // Each owner's blocks arrive in rank order, in the order they were asked for.
+      timings[hemelb::reporting::Timers::readBlocksAll].Start();
+      std::vector<const char*> compressedData(geometry.GetBlockCount(), NULL);
+      size_t offset = 0;
+      for (size_t fetched = 0; fetched < blocksRequested.size(); ++fetched)
+      {
+        compressedData[blocksRequested[fetched]] = &received[offset];
+        offset += bytesPerCompressedBlock[blocksRequested[fetched]];
+      }
+      DecompressAndParseInBatches(geometry, fetchBlock, compressedData);
+      timings[hemelb::reporting::Timers::readBlocksAll].Stop();
     }
 
     void GeometryReader::ImplementMoves(Geometry& geometry,
@@ -912,5 +1792,10 @@ namespace hemelb
       return false;
 #endif
     }
+
+    bool GeometryReader::ShouldValidateBlocks() const
+    {
+      return VALIDATION_FRACTION > 0.0;
+    }
   }
 }
@@ -7,6 +7,7 @@
 #ifndef HEMELB_GEOMETRY_GEOMETRYREADER_H
 #define HEMELB_GEOMETRY_GEOMETRYREADER_H
 
+#include <map>
 #include <vector>
 #include <string>
 
@@ -14,14 +15,20 @@
 #include "lb/lattices/LatticeInfo.h"
 #include "lb/LbmParameters.h"
 #include "net/mpi.h"
+#include "net/net.h"
 #include "geometry/ParmetisHeader.h"
 #include "reporting/Timers.h"
+#include "util/MonotonicArena.h"
 #include "util/Vector3D.h"
 #include "units.h"
 #include "geometry/Geometry.h"
 #include "geometry/needs/Needs.h"
+#include "geometry/decomposition/SiteWeights.h"
+#include "geometry/decomposition/BalanceConstraints.h"
 
 #include "net/MpiFile.h"
+#include "net/NodeSharedFile.h"
+#include "io/readers/BlockDecompressor.h"
 
 namespace hemelb
 {
@@ -37,7 +44,101 @@ namespace hemelb
                        reporting::Timers &timings, const net::IOCommunicator& ioComm);
         ~GeometryReader();
 
-        Geometry LoadAndDecompose(const std::string& dataFilePath);
+        /**
+         * Read the geometry file and decompose it between the cores.
+         *
+         * @param dataFilePath The geometry file.
+         * @param decompositionToLoad If not empty, a decomposition file saved by an earlier run on
+         * as many cores, to use instead of decomposing the geometry again.
+         * @param decompositionToSave If not empty, where to save the decomposition for later runs.
+         * @param decompositionCache If not empty, a directory of decompositions saved by earlier
+         * runs, keyed by everything that decomposing depends on (see GetCachedDecompositionPath).
+         * The matching one is used if it is there, and otherwise the new decomposition is saved
+         * there.
+         * @return The geometry. Its sites' links are allocated from the reader, so it must not
+         * outlive the reader.
+         */
+        Geometry LoadAndDecompose(const std::string& dataFilePath,
+                                  const std::string& decompositionToLoad = "",
+                                  const std::string& decompositionToSave = "",
+                                  const std::string& decompositionCache = "");
+
+        /**
+         * Set the weights to balance the decomposition with, instead of the compiled-in ones.
+         * @param weights
+         */
+        void SetSiteWeights(const decomposition::SiteWeights& weights)
+        {
+          siteWeights = weights;
+        }
+
+        /**
+         * Scale the weight of the sites on each block by the given factor, e.g. the measured
+         * cost of its sites relative to the average, to rebalance the domain during a run. Not
+         * used for a decomposition that is loaded rather than computed.
+         * @param factors One factor for each block.
+         */
+        void SetBlockCostFactors(const std::vector<double>& factors)
+        {
+          blockCostFactors = factors;
+        }
+
+        /**
+         * Set what ParMetis balances the optimised decomposition by, and how closely, instead
+         * of the compute cost alone. Not used for a decomposition that is loaded.
+         * @param constraints
+         */
+        void SetBalanceConstraints(const decomposition::BalanceConstraints& constraints)
+        {
+          balanceConstraints = constraints;
+        }
+
+        /**
+         * Read the whole geometry file once per node into memory the node's cores share (see
+         * net::NodeSharedFile), and parse the header and blocks from there, instead of reading
+         * the header on one core and the blocks on the reading group and spreading them. This
+         * takes a copy of the file on every node, but no core but the first on each touches the
+         * file system, and no blocks are sent between cores.
+         * @param shared
+         */
+        void SetNodeSharedRead(bool shared)
+        {
+          nodeSharedRead = shared;
+        }
+
+        /**
+         * Get the rank that a site belongs to in the decomposition, once LoadAndDecompose is done.
+         * Unlike the Geometry, this knows about every block, not just the ones read here.
+         * @param block
+         * @param siteIndex The index of the site within the block.
+         * @return The rank in HemeLB's main communicator.
+         */
+        proc_t GetProcForSite(site_t block, site_t siteIndex) const;
+
+        /**
+         * @return The most bytes held at once by the arenas the blocks are read into, i.e. the
+         * temporaries of reading, bar the compressed blocks this core reads from the file, and
+         * the sites' links.
+         */
+        size_t GetArenaPeakBytes() const;
+
+        /**
+         * @return The file in the cache for the last LoadAndDecompose, whether the decomposition
+         * was loaded from or saved to it, or empty if there was no cache.
+         */
+        const std::string& GetCachedDecompositionFile() const
+        {
+          return cachedDecompositionFile;
+        }
+
+        /**
+         * @return Whether the last LoadAndDecompose loaded the decomposition from the cache,
+         * instead of decomposing the geometry.
+         */
+        bool LoadedCachedDecomposition() const
+        {
+          return loadedCachedDecomposition;
+        }
 
       private:
         /**
@@ -56,9 +157,51 @@ namespace hemelb
 
         void ReadHeader(site_t blockCount);
 
+        void ReadDictionary();
+
+        /**
+         * Read the blocks each core owns, and a halo one block wide around them, dropping any
+         * blocks from an earlier read that are no longer needed.
+         *
+         * @param geometry [in/out] The geometry object to populate with info about the blocks.
+         * @param unitForEachBlock [in] The processor assigned to each block.
+         * @param localRank [in] Local rank number
+         * @param keepOwnedBlocks [in] Whether to keep the compressed data of the blocks owned
+         * here, so that MigrateBlocks can forward them instead of the file being read again.
+         */
         void ReadInBlocksWithHalo(Geometry& geometry,
                                   const std::vector<proc_t>& unitForEachBlock,
-                                  const proc_t localRank);
+                                  const proc_t localRank,
+                                  const bool keepOwnedBlocks = false);
+
+        /**
+         * Get the blocks needed here under a new decomposition from the cores that owned them
+         * under the one they were read for, in two MPI_Alltoallv exchanges: one of the ids of
+         * the blocks missing here, and one of their compressed data. Blocks already parsed
+         * here are kept, unless no longer needed, and the file is not read again.
+         *
+         * @param geometry [in/out] The geometry object, as read for the old decomposition.
+         * @param newProcForEachBlock [in] The processor assigned to each block now.
+         * @param oldProcForEachBlock [in] The processor each block was assigned to, and whose
+         * compressed data was kept, when the blocks were read.
+         */
+        void MigrateBlocks(Geometry& geometry,
+                           const std::vector<proc_t>& newProcForEachBlock,
+                           const std::vector<proc_t>& oldProcForEachBlock);
+
+        /**
+         * Copy the compressed data of the blocks in a range that are owned here, to be
+         * forwarded by MigrateBlocks.
+         *
+         * @param unitForEachBlock [in] The processor assigned to each block.
+         * @param compressedData [in] The compressed data of each block needed here.
+         * @param firstBlock [in] The first block of the range.
+         * @param endBlock [in] The block after the last of the range.
+         */
+        void KeepOwnedBlocks(const std::vector<proc_t>& unitForEachBlock,
+                             const std::vector<const char*>& compressedData,
+                             const site_t firstBlock,
+                             const site_t endBlock);
 
         /**
          * Compile a list of blocks to be read onto this core, including all the ones we perform
@@ -77,39 +220,114 @@ namespace hemelb
                                                                const proc_t localRank);
 
         /**
-         * Reads in a single block and ensures it is distributed to all cores that need it.
+         * Choose how many cores read the file, from its size and the number of cores. There are
+         * at least READING_GROUP_SIZE, and more for a big file, so that each reads no more than
+         * about BYTES_PER_READING_CORE.
+         *
+         * @return The number of cores in the reading group.
+         */
+        proc_t ChooseReadingGroupSize() const;
+
+        /**
+         * Read every non-empty block this core is the reading core for, with a single collective
+         * read that all cores in the topology join.
+         *
+         * @param geometry [in] Geometry object as it has been read so far
+         * @return The compressed data of those blocks, one after the other, in block order.
+         */
+        std::vector<char> ReadBlocksForThisCore(const Geometry& geometry);
+
+        /**
+         * Decompress and parse every block needed on this core straight from the node's shared
+         * copy of the file, in batches so the decompressing arena stays small.
+         *
+         * @param geometry [in/out] The geometry object to populate with info about the blocks.
+         * @param readBlock [in] Whether each block is required locally.
+         */
+        void ParseSharedBlocks(Geometry& geometry, const std::vector<bool>& readBlock);
+
+        /**
+         * Decompress and parse every block needed here, whose compressed data are all in
+         * memory, in batches of about BYTES_PER_FORWARDING_BATCH compressed bytes so the
+         * decompressing arena stays small.
          *
-         * @param offsetSoFar [in] The offset into the file to read from to get the block.
-         * @param geometry [out] The geometry object to populate with info about the block.
+         * @param geometry [in/out] The geometry object to populate with info about the blocks.
+         * @param neededOnThisRank [in] Whether each block is to be parsed here.
+         * @param compressedData [in] The compressed data of each block to be parsed.
+         */
+        void DecompressAndParseInBatches(Geometry& geometry,
+                                         const std::vector<bool>& neededOnThisRank,
+                                         const std::vector<const char*>& compressedData);
+
+        /**
+         * Request the messages to spread a block, still compressed, from its reading core to
+         * all cores that need it. Nothing is sent or received until the net is dispatched.
+         *
+         * @param net [in/out] The net to request the messages on.
+         * @param readData [in] The compressed block data, if this is its reading core.
+         * @param compressedBlockData [out] The compressed block data, once the net has been
+         * dispatched, if this core needs it or reads it: either readData or a buffer in the
+         * receiving arena.
+         * @param receivingArena [in/out] Where to put the block's data if it is received.
          * @param procsWantingThisBlock [in] A list of proc ids where info about this block is required.
          * @param blockNumber [in] The id of the block we're reading.
          * @param neededOnThisRank [in] A boolean indicating whether the block is required locally.
          */
-        void ReadInBlock(MPI_Offset offsetSoFar,
-                         Geometry& geometry,
-                         const std::vector<proc_t>& procsWantingThisBlock,
-                         const site_t blockNumber,
-                         const bool neededOnThisRank);
+        void RequestBlock(net::Net& net,
+                          char* readData,
+                          const char*& compressedBlockData,
+                          util::MonotonicArena& receivingArena,
+                          const std::vector<proc_t>& procsWantingThisBlock,
+                          const site_t blockNumber,
+                          const bool neededOnThisRank);
 
         /**
-         * Decompress the block data. Uses the known number of sites to get an
-         * upper bound on the uncompressed data to simplify the code and avoid
-         * reallocation.
-         * @param compressed
-         * @param sites
-         * @return
+         * Decompress every block in a range that is needed on this core into the decompressing
+         * arena, which is rewound first, so the previous range's data are gone. The blocks are
+         * shared between OpenMP threads when built with HEMELB_USE_OPENMP.
+         *
+         * @param geometry [in] Geometry object as it has been read so far
+         * @param neededOnThisRank [in] Whether each block is required locally.
+         * @param compressedData [in] The compressed data of each needed block.
+         * @param uncompressedData [out] The uncompressed data of each needed block.
+         * @param firstBlock [in] The first block of the range.
+         * @param endBlock [in] The block after the last of the range.
          */
-        std::vector<char> DecompressBlockData(const std::vector<char>& compressed,
-                                              const unsigned int uncompressedBytes);
+        void DecompressBlocks(const Geometry& geometry,
+                              const std::vector<bool>& neededOnThisRank,
+                              const std::vector<const char*>& compressedData,
+                              std::vector<char*>& uncompressedData,
+                              const site_t firstBlock,
+                              const site_t endBlock);
 
+        /**
+         * Parse every block in a range that is needed on this core into the geometry, sharing
+         * the blocks between OpenMP threads like DecompressBlocks.
+         *
+         * @param geometry [out] The geometry object to populate with info about the blocks.
+         * @param neededOnThisRank [in] Whether each block is required locally.
+         * @param uncompressedData [in] The uncompressed data of each needed block.
+         * @param firstBlock [in] The first block of the range.
+         * @param endBlock [in] The block after the last of the range.
+         */
+        void ParseBlocks(Geometry& geometry,
+                         const std::vector<bool>& neededOnThisRank,
+                         const std::vector<char*>& uncompressedData,
+                         const site_t firstBlock,
+                         const site_t endBlock);
+
+        /**
+         * Parse a block's sites into the geometry, reusing the sites and their links from an
+         * earlier read of the block where there is room.
+         */
         void ParseBlock(Geometry& geometry, const site_t block, io::writers::xdr::XdrReader& reader);
 
         /**
-         * Parse the next site from the XDR reader. Note that we return by copy here.
+         * Parse the next site from the XDR reader.
          * @param reader
-         * @return
+         * @param site [out] The site, overwritten.
          */
-        GeometrySite ParseSite(io::writers::xdr::XdrReader& reader);
+        void ParseSite(io::writers::xdr::XdrReader& reader, GeometrySite& site);
 
         /**
          * Calculates the number of the rank used to read in a given block.
@@ -126,10 +344,107 @@ namespace hemelb
          * @param geometry
          * @param procForEachBlock
          */
-        void OptimiseDomainDecomposition(Geometry& geometry, const std::vector<proc_t>& procForEachBlock);
+        void OptimiseDomainDecomposition(Geometry& geometry, const std::vector<proc_t>& procForEachBlock,
+                                         const std::string& decompositionToSave);
 
+        /**
+         * Reread the blocks and move the sites as decided by the domain decomposition.
+         * @param geometry
+         * @param procForEachBlock
+         * @param movesFromEachProc
+         * @param movesList
+         */
+        void ImplementDecomposition(Geometry& geometry, const std::vector<proc_t>& procForEachBlock,
+                                    const std::vector<idx_t>& movesFromEachProc,
+                                    const std::vector<idx_t>& movesList);
+
+        /**
+         * Write a decomposition to a file, in the format of io::formats::decomposition. Only the
+         * first core in the topology writes it, as every core has the whole decomposition.
+         * @param path
+         * @param procForEachBlock
+         * @param movesFromEachProc
+         * @param movesList
+         */
+        void WriteDecomposition(const std::string& path, const std::vector<proc_t>& procForEachBlock,
+                                const std::vector<idx_t>& movesFromEachProc,
+                                const std::vector<idx_t>& movesList) const;
+
+        /**
+         * Get the path in the cache directory of the decomposition of the geometry being read
+         * over the cores in the topology. The name is keyed by the geometry and by everything
+         * else that changes the decomposition: the site weights, the block weights from the
+         * block statistics and the block cost factors, the balance constraints, the partitioner
+         * and, with node-aware decomposition, which cores share a node. Collective over the
+         * cores in the topology.
+         * @param cacheDirectory
+         * @param weightOnEachBlock The weights from the block statistics, or empty if none.
+         * @return The path.
+         */
+        std::string GetCachedDecompositionPath(const std::string& cacheDirectory,
+                                               const std::vector<site_t>& weightOnEachBlock) const;
+
+        /**
+         * Check on every core in the topology whether a decomposition file exists.
+         * @param path
+         * @return
+         */
+        bool DecompositionExists(const std::string& path) const;
+
+        /**
+         * Read a decomposition written by WriteDecomposition onto every core in the topology,
+         * checking that it is for this geometry and number of cores.
+         * @param path [in]
+         * @param blockCount [in]
+         * @param procForEachBlock [out]
+         * @param movesFromEachProc [out]
+         * @param movesList [out]
+         */
+        void ReadDecomposition(const std::string& path, const site_t blockCount,
+                               std::vector<proc_t>& procForEachBlock,
+                               std::vector<idx_t>& movesFromEachProc,
+                               std::vector<idx_t>& movesList) const;
+
+        /**
+         * Read the block statistics file the setup tool may have written beside the geometry
+         * (see io::formats::blockstats) onto every core in the topology, and weigh the sites on
+         * each block by their collision types. Once the header has been read, the file is
+         * checked against it, and ignored if it is for a different geometry.
+         * @param path [in]
+         * @param blockCount [in]
+         * @param weightOnEachBlock [out] The total weight of the sites on each block.
+         * @return False if there is no usable file at the path.
+         */
+        bool ReadBlockStats(const std::string& path, const site_t blockCount,
+                            std::vector<site_t>& weightOnEachBlock) const;
+
+        /**
+         * Check that the ranks that have read each block agree on its data. Each rank hashes the
+         * sites of each block it has, and sends the hashes to a rank chosen by the block's id,
+         * which compares those from the different ranks, so there is one sparse exchange
+         * however many blocks there are. With a VALIDATION_FRACTION below 1, only a random
+         * sample of the blocks, the same on every rank and different each time, is checked.
+         * Throws if any block differs.
+         * @param geometry
+         */
         void ValidateGeometry(const Geometry& geometry);
 
+        /**
+         * The CRC-32 of the data the decomposition and the lattice are built from for each site
+         * of a block: whether each site is fluid, its processor and its links.
+         * @param block
+         * @return
+         */
+        uint32_t HashBlock(const BlockReadResult& block) const;
+
+        /**
+         * Whether a block is in the sample checked by a call to ValidateGeometry.
+         * @param blockId
+         * @param salt Different for each call.
+         * @return
+         */
+        static bool IsBlockSampled(site_t blockId, unsigned salt);
+
         /**
          * Get the length of the header section, given the number of blocks.
          *
@@ -151,26 +466,68 @@ namespace hemelb
         proc_t ConvertTopologyRankToGlobalRank(proc_t topologyRank) const;
 
         /**
-         * True if we should validate the geometry.
+         * True if we should validate the geometry and the decomposition exhaustively (with
+         * HEMELB_VALIDATE_GEOMETRY). The blocks' data is always checked unless the
+         * VALIDATION_FRACTION is 0.
          * @return
          */
         bool ShouldValidate() const;
 
+        /**
+         * True if the blocks' data should be checked between the ranks that read them.
+         * @return
+         */
+        bool ShouldValidateBlocks() const;
+
         //! The rank which reads in the header information.
         static const proc_t HEADER_READING_RANK = 0;
-        //! The number of cores (0-READING_GROUP_SIZE-1) that read files in parallel
+        //! The smallest number of cores that read files in parallel
         static const proc_t READING_GROUP_SIZE = HEMELB_READING_GROUP_SIZE;
 
+        //! The fraction of the blocks whose data is checked between ranks (see ValidateGeometry).
+        static const double VALIDATION_FRACTION;
+        //! The number of bytes of block data above which another core is added to the reading group
+        static const site_t BYTES_PER_READING_CORE = 1 << 26;
+        //! The number of bytes of compressed block data spread in each round of messages
+        static const site_t BYTES_PER_FORWARDING_BATCH = 1 << 24;
+
         //! Info about the connectivity of the lattice.
         const lb::lattices::LatticeInfo& latticeInfo;
         //! File accessed to read in the geometry data.
         net::MpiFile file;
-        //! Information about the file, to give cues and hints to MPI.
+        //! Whether to read the file through a copy shared by each node's cores.
+        bool nodeSharedRead;
+        //! The node's copy of the file, while it is being read, if reading it that way.
+        net::NodeSharedFile* sharedFile;
+        //! How far through the shared copy the header has been read.
+        MPI_Offset sharedPosition;
 
         const net::IOCommunicator& hemeLbComms; //! HemeLB's main communicator
         net::MpiCommunicator computeComms; //! Communication info for all ranks that will need a slice of the geometry (i.e. all non-steering cores)
         //! True iff this rank is participating in the domain decomposition.
         bool participateInTopology;
+        //! The number of cores (0 to readingGroupSize-1) that read the file in parallel.
+        proc_t readingGroupSize;
+        //! How the blocks are compressed, as an io::formats::geometry::BlockCompression.
+        unsigned blockCompression;
+        //! Decompresses the blocks, shared between threads.
+        io::readers::BlockDecompressor blockDecompressor;
+        //! The CRC-32 of the preamble, header and dictionary read so far.
+        unsigned long geometryChecksum;
+        //! The number of times the blocks have been checked, to sample different ones each time.
+        unsigned validationCount;
+        //! The weight of a site of each collision type in the decomposition.
+        decomposition::SiteWeights siteWeights;
+        //! The factor to scale the weight of the sites on each block by, if any.
+        std::vector<double> blockCostFactors;
+        //! What the optimised decomposition balances, and how closely.
+        decomposition::BalanceConstraints balanceConstraints;
+        //! The decomposition cache file for the last read, or empty if there was no cache.
+        std::string cachedDecompositionFile;
+        //! Whether the last read loaded its decomposition from the cache.
+        bool loadedCachedDecomposition;
+        //! The topology rank of each site moved away from its block's processor, by block and site.
+        std::map<std::pair<site_t, site_t>, proc_t> procForEachMovedSite;
 
         //! The number of fluid sites on each block in the geometry
         std::vector<site_t> fluidSitesOnEachBlock;
@@ -181,6 +538,19 @@ namespace hemelb
         //! The processor assigned to each block.
         std::vector<proc_t> principalProcForEachBlock;
 
+        //! The compressed data of each block owned here after the first read, until the
+        //! blocks have been migrated to the optimised decomposition.
+        std::map<site_t, std::vector<char> > ownedCompressedBlocks;
+        //! Whether the blocks were read with their owners keeping them, on every core.
+        bool ownedBlocksKept;
+
+        //! The compressed blocks received in the current batch and the previous one, by turns.
+        util::MonotonicArena receivingArenas[2];
+        //! The uncompressed blocks of the batch being parsed.
+        util::MonotonicArena decompressingArena;
+        //! The links of the sites read, kept until the reader is destroyed.
+        util::MonotonicArena siteArena;
+
         //! Timings object for recording the time taken for each step of the domain decomposition.
         hemelb::reporting::Timers &timings;
     };
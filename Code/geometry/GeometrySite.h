@@ -7,10 +7,12 @@
 #ifndef HEMELB_GEOMETRY_GEOMETRYSITE_H
 #define HEMELB_GEOMETRY_GEOMETRYSITE_H
 
+#include <stdint.h>
 #include <vector>
 #include "constants.h"
 #include "units.h"
 #include "geometry/GeometrySiteLink.h"
+#include "util/MonotonicArena.h"
 #include "util/Vector3D.h"
 
 namespace hemelb
@@ -23,16 +25,90 @@ namespace hemelb
      *
      * Note that this should be able to be returned by copy (as we sometimes do) so be careful about
      * using heap-allocated data in this struct.
+     *
+     * Only the links that are cut, by a wall or an iolet, are stored, in the order of their
+     * directions, with a bit for each direction saying whether it is cut. Most fluid sites are
+     * in the bulk, with no cut links, so they take no more room than solid sites. The cut links
+     * of the sites read by a GeometryReader are allocated from its arena, so those sites must
+     * not outlive the reader.
      */
     struct GeometrySite
     {
       public:
-        //! Basic constructor for solid and fluid sites.
-        GeometrySite(bool siteIsFluid) :
+        typedef std::vector<GeometrySiteLink, util::ArenaAllocator<GeometrySiteLink> > LinkVector;
+
+        /**
+         * Basic constructor for solid and fluid sites.
+         * @param siteIsFluid
+         * @param linkArena Where to allocate the links from, if not the heap.
+         */
+        GeometrySite(bool siteIsFluid, util::MonotonicArena* linkArena = NULL) :
             targetProcessor(siteIsFluid ?
               -1 :
-              SITE_OR_BLOCK_SOLID), isFluid(siteIsFluid), wallNormalAvailable(false)
+              SITE_OR_BLOCK_SOLID), isFluid(siteIsFluid), wallNormalAvailable(false), cutLinks(0),
+                links(util::ArenaAllocator<GeometrySiteLink>(linkArena))
+        {
+        }
+
+        /**
+         * @param link The index of the link: the direction in the lattice currently being used,
+         * less one (NOT necessarily the same as the lattice used by the geometry file).
+         * @return The link, with no intersection if it isn't cut.
+         */
+        GeometrySiteLink GetLink(unsigned link) const
+        {
+          return IsCut(link) ?
+            links[CutsBefore(link)] :
+            GeometrySiteLink();
+        }
+
+        /**
+         * Set a link, storing it only if it is cut.
+         * @param link The index of the link, as for GetLink.
+         * @param value
+         */
+        void SetLink(unsigned link, const GeometrySiteLink& value)
+        {
+          const bool cut = value.type != GeometrySiteLink::NO_INTERSECTION;
+          if (IsCut(link))
+          {
+            if (cut)
+            {
+              links[CutsBefore(link)] = value;
+            }
+            else
+            {
+              links.erase(links.begin() + CutsBefore(link));
+              cutLinks &= ~ (1u << link);
+            }
+          }
+          else if (cut)
+          {
+            links.insert(links.begin() + CutsBefore(link), value);
+            cutLinks |= 1u << link;
+          }
+        }
+
+        /**
+         * Make every link uncut, keeping the room for the cut links.
+         */
+        void ClearLinks()
         {
+          links.clear();
+          cutLinks = 0;
+        }
+
+        /**
+         * @return A bit for each link, by its index, set if it is cut.
+         */
+        uint32_t GetCutLinks() const
+        {
+          return cutLinks;
+        }
+
+        bool IsCut(unsigned link) const
+        {
+          return (cutLinks >> link) & 1u;
         }
 
         //! Processor on which to perform lattice-Boltzmann for the site.
@@ -42,15 +118,22 @@ namespace hemelb
         //! lattice-Boltzmann with it.
         bool isFluid;
 
-        //! A vector of the link data for each direction in the lattice currently being used
-        //! (NOT necessarily the same as the lattice used by the geometry file).
-        std::vector<GeometrySiteLink> links;
-
         //! Whether there's a approximation of the wall normal available in this fluid site.
         bool wallNormalAvailable;
 
         //! Wall normal approximation at the current fluid site.
         util::Vector3D<float> wallNormal;
+
+      private:
+        //! The number of cut links with a lower index than the given one.
+        unsigned CutsBefore(unsigned link) const
+        {
+          return __builtin_popcount(cutLinks & ( (1u << link) - 1u));
+        }
+
+        uint32_t cutLinks;
+        //! The cut links, in the order of their indices.
+        LinkVector links;
     };
   }
 }
@@ -6,36 +6,69 @@
 
 #include <map>
 #include <limits>
+#include <algorithm>
 
 #include "debug/Debugger.h"
+#include "Exception.h"
 #include "log/Logger.h"
 #include "net/IOCommunicator.h"
 #include "geometry/BlockTraverser.h"
 #include "geometry/LatticeData.h"
 #include "geometry/neighbouring/NeighbouringLatticeData.h"
 #include "util/utilityFunctions.h"
+#include "util/MortonOrder.h"
+#ifdef HEMELB_USE_OPENMP
+#include <omp.h>
+#endif
 
 namespace hemelb
 {
   namespace geometry
   {
     LatticeData::LatticeData(const lb::lattices::LatticeInfo& latticeInfo, const net::IOCommunicator& comms_) :
-        latticeInfo(latticeInfo), neighbouringData(new neighbouring::NeighbouringLatticeData(latticeInfo)), comms(comms_)
+        latticeInfo(latticeInfo), distributionsAllocated(true), midDomainStabilisedCount(0),
+            domainEdgeStabilisedCount(0), compressedSiteCount(0), firstStoredDistribution(0),
+            wallDataAtBulkSites(false), firstDomainEdgeSite(0),
+            neighbouringData(new neighbouring::NeighbouringLatticeData(latticeInfo)), comms(comms_)
     {
     }
 
     LatticeData::~LatticeData()
     {
+#ifdef HEMELB_USE_SHARED_MEMORY_HALO
+      if (nodeComms)
+      {
+        // Not HEMELB_MPI_CALL, which would throw out of the destructor.
+        const int unlocked = MPI_Win_unlock_all(haloWindow);
+        const int freed = MPI_Win_free(&haloWindow);
+        if (unlocked != MPI_SUCCESS || freed != MPI_SUCCESS)
+        {
+          log::Logger::Log<log::Warning, log::OnePerCore>("Couldn't free the shared halo's window (MPI errors %d, %d)",
+                                                           unlocked,
+                                                           freed);
+        }
+      }
+#endif
+#ifdef HEMELB_USE_INDEXED_HALO_RECEIVE
+      for (size_t neighbourId = 0; neighbourId < haloReceiveTypes.size(); neighbourId++)
+      {
+        MPI_Type_free(&haloReceiveTypes[neighbourId]);
+      }
+#endif
       delete neighbouringData;
     }
 
-    LatticeData::LatticeData(const lb::lattices::LatticeInfo& latticeInfo, const Geometry& readResult, const net::IOCommunicator& comms_) :
-        latticeInfo(latticeInfo), neighbouringData(new neighbouring::NeighbouringLatticeData(latticeInfo)), comms(comms_)
+    LatticeData::LatticeData(const lb::lattices::LatticeInfo& latticeInfo, const Geometry& readResult, const net::IOCommunicator& comms_,
+                             bool allocateDistributions, const std::vector<SiteBox>& stabilisedRegions,
+                             const std::vector<SiteBox>& compressedRegions) :
+        latticeInfo(latticeInfo), distributionsAllocated(allocateDistributions),
+            midDomainStabilisedCount(0), domainEdgeStabilisedCount(0), compressedSiteCount(0),
+            firstStoredDistribution(0), wallDataAtBulkSites(false), firstDomainEdgeSite(0), neighbouringData(new neighbouring::NeighbouringLatticeData(latticeInfo)), comms(comms_)
     {
       SetBasicDetails(readResult.GetBlockDimensions(),
                       readResult.GetBlockSize());
 
-      ProcessReadSites(readResult);
+      ProcessReadSites(readResult, stabilisedRegions, compressedRegions);
       // if debugging then output beliefs regarding geometry and neighbour list
       if (log::Logger::ShouldDisplay<log::Trace>())
       {
@@ -51,8 +84,32 @@ namespace hemelb
       }
       CollectFluidSiteDistribution();
       CollectGlobalSiteExtrema();
+#ifdef HEMELB_USE_COMPRESSED_COLD_SITES
+      if (!compressedRegions.empty())
+      {
+        const site_t totalCompressedSites = comms.AllReduce(compressedSiteCount, MPI_SUM);
+        const size_t bytesPerSite = latticeInfo.GetNumVectors() * sizeof(stored_distribn_t)
+            - CompressedDistributions::GetMemoryUsage(latticeInfo.GetNumVectors(), 1);
+        log::Logger::Log<log::Info, log::Singleton>("Keeping the distributions of the %li sites in the compressed regions compressed, saving %.1f MB",
+                                                    (long) totalCompressedSites,
+                                                    2.0 * totalCompressedSites * bytesPerSite
+                                                        / 1048576.0);
+      }
+#endif
 
       InitialiseNeighbourLookups();
+      InitialiseWallLinks();
+      InitialiseLinkPatternRanges();
+      if (!distributionsAllocated)
+      {
+        return;
+      }
+#ifdef HEMELB_USE_NEIGHBOURHOOD_COLLECTIVES
+      InitialiseNeighbourhoodComms();
+#endif
+#ifdef HEMELB_USE_SHARED_MEMORY_HALO
+      InitialiseSharedMemoryHalo();
+#endif
     }
 
     void LatticeData::SetBasicDetails(util::Vector3D<site_t> blocksIn,
@@ -63,10 +120,18 @@ namespace hemelb
       sites = blocksIn * blockSize;
       sitesPerBlockVolumeUnit = blockSize * blockSize * blockSize;
       blockCount = blockCounts.x * blockCounts.y * blockCounts.z;
+      if (sitesPerBlockVolumeUnit > (site_t(1) << SiteLocationBits))
+      {
+        throw Exception() << "Blocks of " << blockSize << " sites along each side have more sites than "
+            << "a site location can index";
+      }
     }
 
-    void LatticeData::ProcessReadSites(const Geometry & readResult)
+    void LatticeData::ProcessReadSites(const Geometry & readResult,
+                                       const std::vector<SiteBox>& stabilisedRegions,
+                                       const std::vector<SiteBox>& compressedRegions)
     {
+      blocks.clear();
       blocks.resize(GetBlockCount());
 
       totalSharedFs = 0;
@@ -159,34 +224,20 @@ namespace hemelb
             isMidDomainSite = false;
             totalSharedFs++;
 
-            // The first time, net_neigh_procs = 0, so
-            // the loop is not executed.
-            bool flag = true;
-            // Iterate over neighbouring processors until we find the one with the
-            // neighbouring site on it.
-            proc_t lNeighbouringProcs = (proc_t) ( (neighbouringProcs.size()));
-            for (proc_t mm = 0; mm < lNeighbouringProcs && flag; mm++)
+            // Count the link against the neighbouring processor, if it is one already.
+            std::unordered_map<proc_t, size_t>::const_iterator neighbourId =
+                neighbourIdForRank.find(neighbourProc);
+            if (neighbourId != neighbourIdForRank.end())
             {
-              // Check whether the rank for a particular neighbour has already been
-              // used for this processor.  If it has, set flag to zero.
-              NeighbouringProcessor* neigh_proc_p = &neighbouringProcs[mm];
-              // If ProcessorRankForEachBlockSite is equal to a neigh_proc that has alredy been listed.
-              if (neighbourProc == neigh_proc_p->Rank)
-              {
-                flag = false;
-                ++neigh_proc_p->SharedDistributionCount;
-                break;
-              }
+              ++neighbouringProcs[neighbourId->second].SharedDistributionCount;
             }
-
-            // If flag is 1, we didn't find a neighbour-proc with the neighbour-site on it
-            // so we need a new neighbouring processor.
-            if (flag)
+            else
             {
-              // Store rank of neighbour in >neigh_proc[neigh_procs]
+              // Otherwise we need a new neighbouring processor.
               NeighbouringProcessor lNewNeighbour;
               lNewNeighbour.SharedDistributionCount = 1;
               lNewNeighbour.Rank = neighbourProc;
+              neighbourIdForRank[neighbourProc] = neighbouringProcs.size();
               neighbouringProcs.push_back(lNewNeighbour);
 
               // if debugging then output decisions with reasoning for all neighbour processors
@@ -241,7 +292,7 @@ namespace hemelb
             midDomainWallNormals[l].push_back(normal);
             for (Direction direction = 1; direction < latticeInfo.GetNumVectors(); direction++)
             {
-              midDomainWallDistance[l].push_back(blockReadIn.Sites[localSiteId].links[direction - 1].distanceToIntersection);
+              midDomainWallDistance[l].push_back(blockReadIn.Sites[localSiteId].GetLink(direction - 1).distanceToIntersection);
             }
           }
           else
@@ -252,7 +303,7 @@ namespace hemelb
             domainEdgeWallNormals[l].push_back(normal);
             for (Direction direction = 1; direction < latticeInfo.GetNumVectors(); direction++)
             {
-              domainEdgeWallDistance[l].push_back(blockReadIn.Sites[localSiteId].links[direction - 1].distanceToIntersection);
+              domainEdgeWallDistance[l].push_back(blockReadIn.Sites[localSiteId].GetLink(direction - 1).distanceToIntersection);
             }
           }
 
@@ -260,6 +311,88 @@ namespace hemelb
 
       }
 
+#ifdef HEMELB_USE_SPACE_FILLING_CURVE_ORDER
+      for (unsigned collisionType = 0; collisionType < COLLISION_TYPES; collisionType++)
+      {
+        SortSitesAlongSpaceFillingCurve(midDomainBlockNumber[collisionType],
+                                        midDomainSiteNumber[collisionType],
+                                        midDomainSiteData[collisionType],
+                                        midDomainWallNormals[collisionType],
+                                        midDomainWallDistance[collisionType]);
+        SortSitesAlongSpaceFillingCurve(domainEdgeBlockNumber[collisionType],
+                                        domainEdgeSiteNumber[collisionType],
+                                        domainEdgeSiteData[collisionType],
+                                        domainEdgeWallNormals[collisionType],
+                                        domainEdgeWallDistance[collisionType]);
+      }
+#endif
+#ifdef HEMELB_SORT_SITES_BY_LINK_PATTERN
+      // Bulk fluid sites have no wall or iolet links, so there's nothing to sort them by.
+      for (unsigned collisionType = 1; collisionType < COLLISION_TYPES; collisionType++)
+      {
+        SortSitesByLinkPattern(midDomainBlockNumber[collisionType],
+                               midDomainSiteNumber[collisionType],
+                               midDomainSiteData[collisionType],
+                               midDomainWallNormals[collisionType],
+                               midDomainWallDistance[collisionType]);
+        SortSitesByLinkPattern(domainEdgeBlockNumber[collisionType],
+                               domainEdgeSiteNumber[collisionType],
+                               domainEdgeSiteData[collisionType],
+                               domainEdgeWallNormals[collisionType],
+                               domainEdgeWallDistance[collisionType]);
+      }
+#endif
+      // The inlet, outlet, wall-inlet and wall-outlet sites, grouped by iolet last so that
+      // each iolet's sites are together whatever the order within it.
+      for (unsigned collisionType = 2; collisionType < COLLISION_TYPES; collisionType++)
+      {
+        SortSitesByIolet(midDomainBlockNumber[collisionType],
+                         midDomainSiteNumber[collisionType],
+                         midDomainSiteData[collisionType],
+                         midDomainWallNormals[collisionType],
+                         midDomainWallDistance[collisionType]);
+        SortSitesByIolet(domainEdgeBlockNumber[collisionType],
+                         domainEdgeSiteNumber[collisionType],
+                         domainEdgeSiteData[collisionType],
+                         domainEdgeWallNormals[collisionType],
+                         domainEdgeWallDistance[collisionType]);
+      }
+      if (!stabilisedRegions.empty())
+      {
+        midDomainStabilisedCount = MoveSitesInRegions(stabilisedRegions,
+                                                      std::vector<SiteBox>(),
+                                                      false,
+                                                      midDomainBlockNumber[0],
+                                                      midDomainSiteNumber[0],
+                                                      midDomainSiteData[0],
+                                                      midDomainWallNormals[0],
+                                                      midDomainWallDistance[0]);
+        domainEdgeStabilisedCount = MoveSitesInRegions(stabilisedRegions,
+                                                       std::vector<SiteBox>(),
+                                                       false,
+                                                       domainEdgeBlockNumber[0],
+                                                       domainEdgeSiteNumber[0],
+                                                       domainEdgeSiteData[0],
+                                                       domainEdgeWallNormals[0],
+                                                       domainEdgeWallDistance[0]);
+      }
+#ifdef HEMELB_USE_COMPRESSED_COLD_SITES
+      // Only the mid-domain bulk sites, whose distributions are never sent, and which are all
+      // collided by the main kernel, so that they stay together at the start of the lattice.
+      if (!compressedRegions.empty())
+      {
+        compressedSiteCount = MoveSitesInRegions(compressedRegions,
+                                                 stabilisedRegions,
+                                                 true,
+                                                 midDomainBlockNumber[0],
+                                                 midDomainSiteNumber[0],
+                                                 midDomainSiteData[0],
+                                                 midDomainWallNormals[0],
+                                                 midDomainWallDistance[0]);
+        firstStoredDistribution = compressedSiteCount * latticeInfo.GetNumVectors();
+      }
+#endif
+
       PopulateWithReadData(midDomainBlockNumber,
                            midDomainSiteNumber,
                            midDomainSiteData,
@@ -272,15 +405,178 @@ namespace hemelb
                            domainEdgeWallDistance);
     }
 
-    void LatticeData::CollectFluidSiteDistribution()
+    void LatticeData::SortSitesAlongSpaceFillingCurve(std::vector<site_t>& blockNumbers,
+                                                      std::vector<site_t>& siteNumbers,
+                                                      std::vector<SiteData>& siteData,
+                                                      std::vector<util::Vector3D<float> >& wallNormals,
+                                                      std::vector<float>& wallDistance) const
     {
-      hemelb::log::Logger::Log<hemelb::log::Debug, hemelb::log::Singleton>("Gathering lattice info.");
-      fluidSitesOnEachProcessor = comms.AllGather(localFluidSites);
-      totalFluidSites = 0;
-      for (proc_t ii = 0; ii < comms.Size(); ++ii)
+      const site_t siteCount = blockNumbers.size();
+
+      // Pair each site's key with its current position, and sort. Sites with equal keys can't
+      // occur, but use the position as a tie-break so the order is fully determined.
+      std::vector<std::pair<uint64_t, site_t> > keyAndPosition(siteCount);
+      for (site_t position = 0; position < siteCount; ++position)
+      {
+        keyAndPosition[position] =
+            std::make_pair(util::GetMortonKey(GetGlobalCoords(blockNumbers[position],
+                                                              GetSiteCoordsFromSiteId(siteNumbers[position]))),
+                           position);
+      }
+      std::sort(keyAndPosition.begin(), keyAndPosition.end());
+
+      std::vector<site_t> order(siteCount);
+      for (site_t sortedPosition = 0; sortedPosition < siteCount; ++sortedPosition)
+      {
+        order[sortedPosition] = keyAndPosition[sortedPosition].second;
+      }
+      PermuteSites(order, blockNumbers, siteNumbers, siteData, wallNormals, wallDistance);
+    }
+
+    void LatticeData::SortSitesByLinkPattern(std::vector<site_t>& blockNumbers,
+                                             std::vector<site_t>& siteNumbers,
+                                             std::vector<SiteData>& siteData,
+                                             std::vector<util::Vector3D<float> >& wallNormals,
+                                             std::vector<float>& wallDistance) const
+    {
+      const site_t siteCount = blockNumbers.size();
+
+      // Using the position as the last part of the key keeps the order within each pattern.
+      std::vector<std::pair<std::pair<uint32_t, uint32_t>, site_t> > keyAndPosition(siteCount);
+      for (site_t position = 0; position < siteCount; ++position)
+      {
+        keyAndPosition[position] =
+            std::make_pair(std::make_pair(siteData[position].GetWallIntersectionData(),
+                                          siteData[position].GetIoletIntersectionData()),
+                           position);
+      }
+      std::sort(keyAndPosition.begin(), keyAndPosition.end());
+
+      std::vector<site_t> order(siteCount);
+      for (site_t sortedPosition = 0; sortedPosition < siteCount; ++sortedPosition)
       {
-        totalFluidSites += fluidSitesOnEachProcessor[ii];
+        order[sortedPosition] = keyAndPosition[sortedPosition].second;
       }
+      PermuteSites(order, blockNumbers, siteNumbers, siteData, wallNormals, wallDistance);
+    }
+
+    void LatticeData::SortSitesByIolet(std::vector<site_t>& blockNumbers,
+                                       std::vector<site_t>& siteNumbers,
+                                       std::vector<SiteData>& siteData,
+                                       std::vector<util::Vector3D<float> >& wallNormals,
+                                       std::vector<float>& wallDistance) const
+    {
+      const site_t siteCount = blockNumbers.size();
+
+      // Using the position as the last part of the key keeps the order within each iolet.
+      std::vector<std::pair<int, site_t> > keyAndPosition(siteCount);
+      for (site_t position = 0; position < siteCount; ++position)
+      {
+        keyAndPosition[position] = std::make_pair(siteData[position].GetIoletId(), position);
+      }
+      std::sort(keyAndPosition.begin(), keyAndPosition.end());
+
+      std::vector<site_t> order(siteCount);
+      for (site_t sortedPosition = 0; sortedPosition < siteCount; ++sortedPosition)
+      {
+        order[sortedPosition] = keyAndPosition[sortedPosition].second;
+      }
+      PermuteSites(order, blockNumbers, siteNumbers, siteData, wallNormals, wallDistance);
+    }
+
+    site_t LatticeData::MoveSitesInRegions(const std::vector<SiteBox>& regions,
+                                           const std::vector<SiteBox>& excludedRegions,
+                                           bool toStart, std::vector<site_t>& blockNumbers,
+                                           std::vector<site_t>& siteNumbers,
+                                           std::vector<SiteData>& siteData,
+                                           std::vector<util::Vector3D<float> >& wallNormals,
+                                           std::vector<float>& wallDistance) const
+    {
+      const site_t siteCount = blockNumbers.size();
+
+      std::vector<site_t> order;
+      order.reserve(siteCount);
+      std::vector<site_t> inRegions;
+      for (site_t position = 0; position < siteCount; ++position)
+      {
+        const util::Vector3D<site_t> location =
+            GetGlobalCoords(blockNumbers[position], GetSiteCoordsFromSiteId(siteNumbers[position]));
+        bool inAnyRegion = false;
+        for (std::vector<SiteBox>::const_iterator region = regions.begin();
+            region != regions.end() && !inAnyRegion; ++region)
+        {
+          inAnyRegion = region->Contains(location);
+        }
+        for (std::vector<SiteBox>::const_iterator region = excludedRegions.begin();
+            region != excludedRegions.end() && inAnyRegion; ++region)
+        {
+          inAnyRegion = !region->Contains(location);
+        }
+
+        if (inAnyRegion)
+        {
+          inRegions.push_back(position);
+        }
+        else
+        {
+          order.push_back(position);
+        }
+      }
+      if (toStart)
+      {
+        order.insert(order.begin(), inRegions.begin(), inRegions.end());
+      }
+      else
+      {
+        order.insert(order.end(), inRegions.begin(), inRegions.end());
+      }
+
+      PermuteSites(order, blockNumbers, siteNumbers, siteData, wallNormals, wallDistance);
+      return inRegions.size();
+    }
+
+    void LatticeData::PermuteSites(const std::vector<site_t>& order,
+                                   std::vector<site_t>& blockNumbers,
+                                   std::vector<site_t>& siteNumbers,
+                                   std::vector<SiteData>& siteData,
+                                   std::vector<util::Vector3D<float> >& wallNormals,
+                                   std::vector<float>& wallDistance) const
+    {
+      const site_t siteCount = blockNumbers.size();
+      const unsigned linksPerSite = latticeInfo.GetNumVectors() - 1;
+
+      std::vector<site_t> sortedBlockNumbers(siteCount);
+      std::vector<site_t> sortedSiteNumbers(siteCount);
+      std::vector<SiteData> sortedSiteData;
+      sortedSiteData.reserve(siteCount);
+      std::vector<util::Vector3D<float> > sortedWallNormals(siteCount);
+      std::vector<float> sortedWallDistance(wallDistance.size());
+
+      for (site_t sortedPosition = 0; sortedPosition < siteCount; ++sortedPosition)
+      {
+        const site_t position = order[sortedPosition];
+        sortedBlockNumbers[sortedPosition] = blockNumbers[position];
+        sortedSiteNumbers[sortedPosition] = siteNumbers[position];
+        sortedSiteData.push_back(siteData[position]);
+        sortedWallNormals[sortedPosition] = wallNormals[position];
+        std::copy(wallDistance.begin() + position * linksPerSite,
+                  wallDistance.begin() + (position + 1) * linksPerSite,
+                  sortedWallDistance.begin() + sortedPosition * linksPerSite);
+      }
+
+      blockNumbers.swap(sortedBlockNumbers);
+      siteNumbers.swap(sortedSiteNumbers);
+      siteData.swap(sortedSiteData);
+      wallNormals.swap(sortedWallNormals);
+      wallDistance.swap(sortedWallDistance);
+    }
+
+    void LatticeData::CollectFluidSiteDistribution()
+    {
+      hemelb::log::Logger::Log<hemelb::log::Debug, hemelb::log::Singleton>("Gathering lattice info.");
+      // Only the report needs every processor's count, so don't keep it everywhere.
+      fluidSitesOnEachProcessor = comms.Gather(localFluidSites, comms.GetIORank());
+      totalFluidSites = comms.AllReduce(localFluidSites, MPI_SUM);
     }
 
     void LatticeData::CollectGlobalSiteExtrema()
@@ -346,89 +642,306 @@ namespace hemelb
             + 1 + totalSharedDistributionsSoFar;
         totalSharedDistributionsSoFar += neighbouringProcs[neighbourId].SharedDistributionCount;
       }
+
+      // The largest index stored in the streaming tables is that of the last shared distribution.
+      const site_t distributionCount = GetLocalFluidSiteCount() * latticeInfo.GetNumVectors() + 1
+          + totalSharedDistributionsSoFar;
+      if (distributionCount > site_t(std::numeric_limits<streaming_index_t>::max()))
+      {
+        throw Exception() << "Rank " << comms.Rank() << " has " << distributionCount
+            << " distributions, too many for the streaming tables. Use more ranks or rebuild with HEMELB_USE_64BIT_STREAMING_INDICES.";
+      }
+
       InitialiseNeighbourLookup(sharedDistributionLocationForEachProc);
       InitialisePointToPointComms(sharedDistributionLocationForEachProc);
       InitialiseReceiveLookup(sharedDistributionLocationForEachProc);
+#ifdef HEMELB_USE_PULL_STREAMING
+      InitialisePullLookup();
+#endif
     }
 
-    void LatticeData::InitialiseNeighbourLookup(std::vector<std::vector<site_t> >& sharedFLocationForEachProc)
+    void LatticeData::InitialiseWallLinks()
     {
-      const proc_t localRank = comms.Rank();
-      neighbourIndices.resize(latticeInfo.GetNumVectors() * localFluidSites);
-      for (BlockTraverser blockTraverser(*this); blockTraverser.CurrentLocationValid(); blockTraverser.TraverseOne())
+      wallLinks.clear();
+      for (site_t siteIndex = 0; siteIndex < localFluidSites; ++siteIndex)
       {
-        const Block& map_block_p = blockTraverser.GetCurrentBlockData();
-        if (map_block_p.IsEmpty())
+        if (!siteData[siteIndex].IsWall())
         {
           continue;
         }
-        for (SiteTraverser siteTraverser = blockTraverser.GetSiteTraverser(); siteTraverser.CurrentLocationValid();
-            siteTraverser.TraverseOne())
+        for (Direction direction = 1; direction < latticeInfo.GetNumVectors(); ++direction)
         {
-          if (localRank != map_block_p.GetProcessorRankForSite(siteTraverser.GetCurrentIndex()))
+          if (siteData[siteIndex].HasWall(direction))
           {
-            continue;
+            WallLink link;
+            link.siteIndex = siteIndex;
+            link.direction = direction;
+            wallLinks.push_back(link);
           }
-          // Get site data, which is the number of the fluid site on this proc..
-          site_t localIndex = map_block_p.GetLocalContiguousIndexForSite(siteTraverser.GetCurrentIndex());
-          // Set neighbour location for the distribution component at the centre of
-          // this site.
-          SetNeighbourLocation(localIndex, 0, localIndex * latticeInfo.GetNumVectors() + 0);
-          for (Direction direction = 1; direction < latticeInfo.GetNumVectors(); direction++)
+        }
+      }
+    }
+
+    void LatticeData::InitialiseLinkPatternRanges()
+    {
+      linkPatternRanges.clear();
+      for (site_t siteIndex = 0; siteIndex < localFluidSites; ++siteIndex)
+      {
+        const SiteData& data = siteData[siteIndex];
+        if (linkPatternRanges.empty()
+            || linkPatternRanges.back().wallIntersection != data.GetWallIntersectionData()
+            || linkPatternRanges.back().ioletIntersection != data.GetIoletIntersectionData()
+            || linkPatternRanges.back().ioletId != data.GetIoletId())
+        {
+          LinkPatternRange range;
+          range.firstSite = siteIndex;
+          range.siteCount = 0;
+          range.wallIntersection = data.GetWallIntersectionData();
+          range.ioletIntersection = data.GetIoletIntersectionData();
+          range.ioletId = data.GetIoletId();
+          linkPatternRanges.push_back(range);
+        }
+        ++linkPatternRanges.back().siteCount;
+      }
+    }
+
+    LatticeData::LinkPatternRangeIterator LatticeData::GetLinkPatternRange(site_t siteIndex) const
+    {
+      LinkPatternRange containing;
+      containing.firstSite = siteIndex;
+      // The first run starting after the site, so the one before contains it.
+      return std::upper_bound(linkPatternRanges.begin(), linkPatternRanges.end(), containing) - 1;
+    }
+
+    LatticeData::WallLinkIterator LatticeData::GetFirstWallLink(site_t siteIndex) const
+    {
+      WallLink first;
+      first.siteIndex = siteIndex;
+      first.direction = 0;
+      return std::lower_bound(wallLinks.begin(), wallLinks.end(), first);
+    }
+
+    template<typename T>
+    void LatticeData::FirstTouch(std::vector<T, util::LatticeAllocator<T> >& array,
+                                 site_t firstSite) const
+    {
+      const site_t numVectors = latticeInfo.GetNumVectors();
+      const site_t firstIndex = firstSite * numVectors;
+#ifdef HEMELB_USE_OPENMP
+#pragma omp parallel
+#endif
+      {
+#ifdef HEMELB_USE_OPENMP
+        const site_t threadId = omp_get_thread_num();
+        const site_t threadCount = omp_get_num_threads();
+#else
+        const site_t threadId = 0;
+        const site_t threadCount = 1;
+#endif
+        // The mid-domain sites of each collision type, then the domain-edge ones.
+        site_t rangeFirstIndex = 0;
+        for (unsigned range = 0; range < 2 * COLLISION_TYPES; ++range)
+        {
+          const site_t rangeSiteCount = range < COLLISION_TYPES ?
+            GetMidDomainCollisionCount(range) :
+            GetDomainEdgeCollisionCount(range - COLLISION_TYPES);
+          site_t threadFirstIndex, threadSiteCount;
+          util::GetBlockRange(rangeFirstIndex,
+                              rangeSiteCount,
+                              threadId,
+                              threadCount,
+                              threadFirstIndex,
+                              threadSiteCount);
+          for (site_t site = std::max(threadFirstIndex, firstSite);
+              site < threadFirstIndex + threadSiteCount; ++site)
           {
-            util::Vector3D<site_t> currentLocationCoords = blockTraverser.GetCurrentLocation() * blockSize
-                + siteTraverser.GetCurrentLocation();
-            // Work out positions of neighbours.
-            util::Vector3D<site_t> neighbourCoords = currentLocationCoords
-                + util::Vector3D<site_t>(latticeInfo.GetVector(direction));
-            if (!IsValidLatticeSite(neighbourCoords))
+            for (Direction direction = 0; direction < numVectors; ++direction)
             {
-              // Set the neighbour location to the rubbish site.
-              SetNeighbourLocation(localIndex, direction, GetLocalFluidSiteCount() * latticeInfo.GetNumVectors());
-              continue;
+              array[GetDistributionIndex(site, direction) - firstIndex] = T();
             }
-            // Get the id of the processor which the neighbouring site lies on.
-            const proc_t proc_id_p = GetProcIdFromGlobalCoords(neighbourCoords);
-            if (proc_id_p == SITE_OR_BLOCK_SOLID)
+          }
+          rangeFirstIndex += rangeSiteCount;
+        }
+      }
+
+      for (site_t index = localFluidSites * numVectors - firstIndex; index < site_t(array.size());
+          ++index)
+      {
+        array[index] = T();
+      }
+    }
+
+    void LatticeData::InitialiseDistributions()
+    {
+      FirstTouch(oldDistributions, compressedSiteCount);
+      FirstTouch(newDistributions, compressedSiteCount);
+    }
+
+    void LatticeData::InitialiseNeighbourLookup(std::vector<std::vector<site_t> >& sharedFLocationForEachProc)
+    {
+      const proc_t localRank = comms.Rank();
+      const site_t rubbishSite = GetLocalFluidSiteCount() * latticeInfo.GetNumVectors();
+      neighbourIndices.resize(latticeInfo.GetNumVectors() * localFluidSites);
+      FirstTouch(neighbourIndices);
+
+      // The blocks with sites, in order, to split between the threads.
+      std::vector<site_t> blockIds;
+      for (site_t blockId = 0; blockId < site_t(blocks.size()); ++blockId)
+      {
+        if (!blocks[blockId].IsEmpty())
+        {
+          blockIds.push_back(blockId);
+        }
+      }
+
+      // The shared distributions found by each thread, by neighbouring processor.
+#ifdef HEMELB_USE_OPENMP
+      const int threadCount = omp_get_max_threads();
+#else
+      const int threadCount = 1;
+#endif
+      std::vector<std::vector<std::vector<site_t> > > sharedFLocationsForEachThread(threadCount,
+                                                                                    std::vector<std::vector<site_t> >(neighbouringProcs.size()));
+
+#ifdef HEMELB_USE_OPENMP
+#pragma omp parallel num_threads(threadCount)
+#endif
+      {
+#ifdef HEMELB_USE_OPENMP
+        const site_t threadId = omp_get_thread_num();
+#else
+        const site_t threadId = 0;
+#endif
+        std::vector<std::vector<site_t> >& sharedFLocationForEachNeighbour =
+            sharedFLocationsForEachThread[threadId];
+        site_t firstBlock, threadBlockCount;
+        util::GetBlockRange(site_t(0),
+                            site_t(blockIds.size()),
+                            threadId,
+                            site_t(threadCount),
+                            firstBlock,
+                            threadBlockCount);
+
+        for (site_t block = firstBlock; block < firstBlock + threadBlockCount; ++block)
+        {
+          const site_t blockId = blockIds[block];
+          const Block& map_block_p = GetBlock(blockId);
+
+          // The blocks around this one (and itself), by offset, or NULL off the lattice.
+          util::Vector3D<site_t> blockCoords;
+          GetBlockIJK(blockId, blockCoords);
+          const Block* blocksAround[3][3][3];
+          for (int i = 0; i < 3; ++i)
+          {
+            for (int j = 0; j < 3; ++j)
             {
-              // initialize f_id to the rubbish site.
-              SetNeighbourLocation(localIndex, direction, GetLocalFluidSiteCount() * latticeInfo.GetNumVectors());
-              continue;
+              for (int k = 0; k < 3; ++k)
+              {
+                const util::Vector3D<site_t> aroundCoords = blockCoords
+                    + util::Vector3D<site_t>(i - 1, j - 1, k - 1);
+                blocksAround[i][j][k] = IsValidBlock(aroundCoords) ?
+                  &GetBlock(GetBlockIdFromBlockCoords(aroundCoords)) :
+                  NULL;
+              }
             }
-            else
-            // If on the same proc, set f_id of the
-            // current site and direction to the
-            // site and direction that it sends to.
-            // If we check convergence, the data for
-            // each site is split into that for the
-            // current and previous cycles.
-            if (localRank == proc_id_p)
+          }
+
+          for (site_t siteId = 0; siteId < sitesPerBlockVolumeUnit; ++siteId)
+          {
+            if (localRank != map_block_p.GetProcessorRankForSite(siteId))
             {
-              // Pointer to the neighbour.
-              site_t contigSiteId = GetContiguousSiteId(neighbourCoords);
-              SetNeighbourLocation(localIndex, direction, contigSiteId * latticeInfo.GetNumVectors() + direction);
               continue;
             }
-            else
+            // Get site data, which is the number of the fluid site on this proc..
+            site_t localIndex = map_block_p.GetLocalContiguousIndexForSite(siteId);
+            // Set neighbour location for the distribution component at the centre of
+            // this site.
+            SetNeighbourLocation(localIndex, 0, GetDistributionIndex(localIndex, 0));
+            const util::Vector3D<site_t> siteCoords = GetSiteCoordsFromSiteId(siteId);
+            const util::Vector3D<site_t> currentLocationCoords = blockCoords * blockSize
+                + siteCoords;
+            for (Direction direction = 1; direction < latticeInfo.GetNumVectors(); direction++)
             {
-              // This stores some coordinates.  We
-              // still need to know the site number.
-              // neigh_proc[ n ].f_data is now
-              // set as well, since this points to
-              // f_data.  Every process has data for
-              // its neighbours which say which sites
-              // on this process are shared with the
-              // neighbour.
-              sharedFLocationForEachProc[proc_id_p].push_back(currentLocationCoords.x);
-              sharedFLocationForEachProc[proc_id_p].push_back(currentLocationCoords.y);
-              sharedFLocationForEachProc[proc_id_p].push_back(currentLocationCoords.z);
-              sharedFLocationForEachProc[proc_id_p].push_back(direction);
+              // Work out positions of neighbours.
+              const util::Vector3D<site_t> neighbourCoords = currentLocationCoords
+                  + util::Vector3D<site_t>(latticeInfo.GetVector(direction));
+              if (!IsValidLatticeSite(neighbourCoords))
+              {
+                // Set the neighbour location to the rubbish site.
+                SetNeighbourLocation(localIndex, direction, rubbishSite);
+                continue;
+              }
+
+              // Find the neighbour's block among those around, and where it is in that.
+              util::Vector3D<site_t> neighbourSiteCoords = siteCoords
+                  + util::Vector3D<site_t>(latticeInfo.GetVector(direction));
+              int offset[3];
+              for (int axis = 0; axis < 3; ++axis)
+              {
+                offset[axis] = neighbourSiteCoords[axis] < 0 ?
+                  0 :
+                  (neighbourSiteCoords[axis] >= blockSize ?
+                    2 :
+                    1);
+                neighbourSiteCoords[axis] -= (offset[axis] - 1) * blockSize;
+              }
+              const Block& neighbourBlock = *blocksAround[offset[0]][offset[1]][offset[2]];
+              const site_t neighbourSiteId =
+                  GetLocalSiteIdFromLocalSiteCoords(neighbourSiteCoords);
+
+              // Get the id of the processor which the neighbouring site lies on.
+              const proc_t proc_id_p = neighbourBlock.IsEmpty() ?
+                SITE_OR_BLOCK_SOLID :
+                neighbourBlock.GetProcessorRankForSite(neighbourSiteId);
+              if (proc_id_p == SITE_OR_BLOCK_SOLID)
+              {
+                // initialize f_id to the rubbish site.
+                SetNeighbourLocation(localIndex, direction, rubbishSite);
+              }
+              else if (localRank == proc_id_p)
+              {
+                // If on the same proc, set f_id of the current site and direction to the
+                // site and direction that it sends to.
+                site_t contigSiteId = neighbourBlock.GetLocalContiguousIndexForSite(neighbourSiteId);
+                SetNeighbourLocation(localIndex, direction, GetDistributionIndex(contigSiteId, direction));
+              }
+              else
+              {
+                // This stores some coordinates.  We
+                // still need to know the site number.
+                // neigh_proc[ n ].f_data is now
+                // set as well, since this points to
+                // f_data.  Every process has data for
+                // its neighbours which say which sites
+                // on this process are shared with the
+                // neighbour.
+                std::vector<site_t>& sharedFLocation =
+                    sharedFLocationForEachNeighbour[neighbourIdForRank.find(proc_id_p)->second];
+                sharedFLocation.push_back(currentLocationCoords.x);
+                sharedFLocation.push_back(currentLocationCoords.y);
+                sharedFLocation.push_back(currentLocationCoords.z);
+                sharedFLocation.push_back(direction);
+              }
             }
           }
         }
-
       }
 
+      // The threads' ranges of blocks are in order, so appending their lists in thread order
+      // keeps the shared distributions in block order.
+      for (size_t neighbourId = 0; neighbourId < neighbouringProcs.size(); neighbourId++)
+      {
+        std::vector<site_t>& sharedFLocation =
+            sharedFLocationForEachProc[neighbouringProcs[neighbourId].Rank];
+        for (int thread = 0; thread < threadCount; ++thread)
+        {
+          const std::vector<site_t>& threadSharedFLocation =
+              sharedFLocationsForEachThread[thread][neighbourId];
+          sharedFLocation.insert(sharedFLocation.end(),
+                                 threadSharedFLocation.begin(),
+                                 threadSharedFLocation.end());
+        }
+      }
     }
 
     void LatticeData::InitialisePointToPointComms(std::vector<std::vector<site_t> >& sharedFLocationForEachProc)
@@ -497,14 +1010,80 @@ namespace hemelb
           SetNeighbourLocation(contigSiteId, (unsigned int) ( (l)), ++f_count);
           // Set the place where we put the received distribution functions, which is
           // f_new[number of fluid site that sends, inverse direction].
-          streamingIndicesForReceivedDistributions[sharedSitesSeen] = contigSiteId * latticeInfo.GetNumVectors()
-              + latticeInfo.GetInverseIndex(l);
+          streamingIndicesForReceivedDistributions[sharedSitesSeen] =
+              GetDistributionIndex(contigSiteId, latticeInfo.GetInverseIndex(l));
           ++sharedSitesSeen;
         }
 
       }
 
+#ifdef HEMELB_USE_INDEXED_HALO_RECEIVE
+      // Rather than receive into the tail of fOld and copy from there on every step, receive
+      // each neighbour's distributions straight to where they stream to, through a datatype
+      // relative to the start of fNew.
+      haloReceiveTypes.resize(neighbouringProcs.size());
+      site_t firstOfNeighbour = 0;
+      for (size_t neighbourId = 0; neighbourId < neighbouringProcs.size(); neighbourId++)
+      {
+        const site_t count = neighbouringProcs[neighbourId].SharedDistributionCount;
+        std::vector<int> lengths(count, 1);
+        std::vector<MPI_Aint> displacements(count);
+        for (site_t received = 0; received < count; received++)
+        {
+          displacements[received] =
+              MPI_Aint(streamingIndicesForReceivedDistributions[firstOfNeighbour + received])
+                  * MPI_Aint(sizeof(stored_distribn_t));
+        }
+        HEMELB_MPI_CALL(MPI_Type_create_hindexed,
+                        ((int) count, &lengths.front(), &displacements.front(), net::MpiDataType<stored_distribn_t>(), &haloReceiveTypes[neighbourId]));
+        HEMELB_MPI_CALL(MPI_Type_commit, (&haloReceiveTypes[neighbourId]));
+        firstOfNeighbour += count;
+      }
+#endif
+    }
+
+#ifdef HEMELB_USE_PULL_STREAMING
+    void LatticeData::InitialisePullLookup()
+    {
+      const Direction numVectors = latticeInfo.GetNumVectors();
+      const site_t rubbishSite = GetLocalFluidSiteCount() * numVectors;
+      pulledIndices.resize(numVectors * localFluidSites);
+      FirstTouch(pulledIndices);
+
+      for (site_t site = 0; site < localFluidSites; ++site)
+      {
+        for (Direction direction = 0; direction < numVectors; ++direction)
+        {
+          const site_t index = GetDistributionIndex(site, direction);
+          const site_t streamedIndex = neighbourIndices[index];
+          if (streamedIndex < rubbishSite)
+          {
+            pulledIndices[streamedIndex] = index;
+          }
+          else if (streamedIndex == rubbishSite)
+          {
+            // Nothing streams back along the link, so bounce the site's own distribution back.
+            pulledIndices[GetDistributionIndex(site, latticeInfo.GetInverseIndex(direction))] =
+                index;
+          }
+        }
+      }
+
+      // CopyReceived then copies each received distribution to the same place in fNew.
+      site_t received = 0;
+      for (size_t neighbourId = 0; neighbourId < neighbouringProcs.size(); neighbourId++)
+      {
+        const NeighbouringProcessor& neighbour = neighbouringProcs[neighbourId];
+        for (site_t shared = 0; shared < neighbour.SharedDistributionCount; ++shared, ++received)
+        {
+          pulledIndices[streamingIndicesForReceivedDistributions[received]] =
+              neighbour.FirstSharedDistribution + shared;
+          streamingIndicesForReceivedDistributions[received] = neighbour.FirstSharedDistribution
+              + shared;
+        }
+      }
     }
+#endif
 
     proc_t LatticeData::GetProcIdFromGlobalCoords(const util::Vector3D<site_t>& globalSiteCoords) const
     {
@@ -645,6 +1224,28 @@ namespace hemelb
       return midDomainSiteCount;
     }
 
+    void LatticeData::StoreWallDataAtBulkSites()
+    {
+      if (wallDataAtBulkSites)
+      {
+        return;
+      }
+
+      const site_t linksPerSite = latticeInfo.GetNumVectors() - 1;
+      std::vector<distribn_t> allDistances(localFluidSites * linksPerSite);
+      std::vector<util::Vector3D<distribn_t> > allNormals(localFluidSites);
+      for (site_t siteIndex = 0; siteIndex < localFluidSites; ++siteIndex)
+      {
+        const distribn_t* distances = GetCutDistances(siteIndex);
+        std::copy(distances, distances + linksPerSite, allDistances.begin() + siteIndex * linksPerSite);
+        allNormals[siteIndex] = GetNormalToWall(siteIndex);
+      }
+
+      distanceToWall.swap(allDistances);
+      wallNormalAtSite.swap(allNormals);
+      wallDataAtBulkSites = true;
+    }
+
     void LatticeData::GetBlockIJK(site_t block, util::Vector3D<site_t>& blockCoords) const
     {
       blockCoords.z = block % blockCounts.z;
@@ -653,32 +1254,640 @@ namespace hemelb
       blockCoords.x = blockIJData / blockCounts.y;
     }
 
+    void LatticeData::TakeDistributionsFrom(const LatticeData& previous,
+                                            const std::vector<proc_t>& procForEachPreviousSite)
+    {
+      const unsigned numVectors = latticeInfo.GetNumVectors();
+      const site_t previousSiteCount = previous.GetLocalFluidSiteCount();
+
+      // Group the previous sites by the rank that has them now.
+      std::vector<int> siteCounts(comms.Size(), 0);
+      for (site_t site = 0; site < previousSiteCount; ++site)
+      {
+        ++siteCounts[procForEachPreviousSite[site]];
+      }
+
+      std::vector<int> nextPositionForEachProc(comms.Size(), 0);
+      std::vector<int> distributionCounts(comms.Size(), 0);
+      for (proc_t proc = 0; proc < comms.Size(); ++proc)
+      {
+        if (proc > 0)
+        {
+          nextPositionForEachProc[proc] = nextPositionForEachProc[proc - 1]
+              + siteCounts[proc - 1];
+        }
+        distributionCounts[proc] = siteCounts[proc] * numVectors;
+      }
+
+      std::vector<site_t> siteIds(previousSiteCount);
+      std::vector<distribn_t> distributions(previousSiteCount * numVectors);
+      for (site_t site = 0; site < previousSiteCount; ++site)
+      {
+        const int position = nextPositionForEachProc[procForEachPreviousSite[site]]++;
+        siteIds[position] =
+            previous.GetGlobalNoncontiguousSiteIdFromGlobalCoords(previous.GetGlobalSiteCoords(site));
+        previous.GetDistributions(site, &distributions[position * numVectors]);
+      }
+
+      const std::vector<site_t> receivedSiteIds = comms.AllToAllV(siteIds, siteCounts);
+      const std::vector<distribn_t> receivedDistributions = comms.AllToAllV(distributions,
+                                                                            distributionCounts);
+
+      for (size_t received = 0; received < receivedSiteIds.size(); ++received)
+      {
+        util::Vector3D<site_t> globalCoords;
+        GetGlobalCoordsFromGlobalNoncontiguousSiteId(receivedSiteIds[received], globalCoords);
+        SetDistributions(GetContiguousSiteId(globalCoords),
+                         &receivedDistributions[received * numVectors]);
+      }
+    }
+
+    void LatticeData::GetDistributionRecords(std::vector<site_t>& globalSiteIds,
+                                             std::vector<distribn_t>& distributions) const
+    {
+      const unsigned numVectors = latticeInfo.GetNumVectors();
+      globalSiteIds.resize(localFluidSites);
+      distributions.resize(localFluidSites * numVectors);
+      for (site_t site = 0; site < localFluidSites; ++site)
+      {
+        globalSiteIds[site] = GetGlobalNoncontiguousSiteIdFromGlobalCoords(GetGlobalSiteCoords(site));
+        GetDistributions(site, &distributions[site * numVectors]);
+      }
+    }
+
+    void LatticeData::GetDistributions(site_t site, distribn_t* distributions) const
+    {
+      for (Direction direction = 0; direction < latticeInfo.GetNumVectors(); ++direction)
+      {
+        distributions[direction] = GetFOldValue(GetDistributionIndex(site, direction));
+      }
+    }
+
+    void LatticeData::SetDistributions(site_t site, const distribn_t* distributions)
+    {
+#ifdef HEMELB_USE_COMPRESSED_COLD_SITES
+      if (IsCompressed(site))
+      {
+        oldCompressed.Store(site, distributions);
+        newCompressed.Store(site, distributions);
+        return;
+      }
+#endif
+      for (Direction direction = 0; direction < latticeInfo.GetNumVectors(); ++direction)
+      {
+        *GetFOld(GetDistributionIndex(site, direction)) =
+            *GetFNew(GetDistributionIndex(site, direction)) = distributions[direction];
+      }
+    }
+
+    void LatticeData::WriteSubdomain(io::writers::Writer& writer) const
+    {
+      const Direction numVectors = latticeInfo.GetNumVectors();
+
+      // The shape of the lattice and the collision-type ranges.
+      writer << (uint64_t) blockCounts.x << (uint64_t) blockCounts.y << (uint64_t) blockCounts.z
+          << (uint64_t) blockSize << (uint64_t) totalFluidSites << (uint64_t) totalSharedFs;
+      for (unsigned collisionType = 0; collisionType < COLLISION_TYPES; collisionType++)
+      {
+        writer << (uint64_t) midDomainProcCollisions[collisionType]
+            << (uint64_t) domainEdgeProcCollisions[collisionType];
+      }
+      writer << (uint64_t) midDomainStabilisedCount << (uint64_t) domainEdgeStabilisedCount;
+      for (unsigned dim = 0; dim < 3; ++dim)
+      {
+        writer << (uint64_t) globalSiteMins[dim] << (uint64_t) globalSiteMaxes[dim];
+      }
+
+      // The neighbouring processors, in the order their distributions are received.
+      writer << (uint32_t) neighbouringProcs.size();
+      for (size_t neighbourId = 0; neighbourId < neighbouringProcs.size(); neighbourId++)
+      {
+        writer << (int32_t) neighbouringProcs[neighbourId].Rank
+            << (uint64_t) neighbouringProcs[neighbourId].SharedDistributionCount
+            << (uint64_t) neighbouringProcs[neighbourId].FirstSharedDistribution;
+      }
+
+      // The links of each site and where it is.
+      for (site_t site = 0; site < localFluidSites; ++site)
+      {
+        writer << siteData[site].GetWallIntersectionData()
+            << siteData[site].GetIoletIntersectionData() << (uint32_t) siteData[site].GetSiteType()
+            << (int32_t) siteData[site].GetIoletId() << (uint64_t) siteLocations[site];
+      }
+
+      // The wall normals and distances of the sites that have them stored.
+      writer << (uint32_t) wallDataAtBulkSites << (uint64_t) wallNormalAtSite.size();
+      for (size_t site = 0; site < wallNormalAtSite.size(); ++site)
+      {
+        writer << wallNormalAtSite[site].x << wallNormalAtSite[site].y << wallNormalAtSite[site].z;
+        for (Direction direction = 1; direction < numVectors; ++direction)
+        {
+          writer << distanceToWall[site * (numVectors - 1) + direction - 1];
+        }
+      }
+
+      // The non-empty blocks, with the rank of each site and the local index of those that have
+      // one.
+      uint64_t blocksWithSites = 0;
+      for (site_t blockId = 0; blockId < site_t(blocks.size()); ++blockId)
+      {
+        if (!blocks[blockId].IsEmpty())
+        {
+          ++blocksWithSites;
+        }
+      }
+      writer << blocksWithSites;
+      for (site_t blockId = 0; blockId < site_t(blocks.size()); ++blockId)
+      {
+        const Block& block = blocks[blockId];
+        if (block.IsEmpty())
+        {
+          continue;
+        }
+        writer << (uint64_t) blockId << (uint64_t) sitesPerBlockVolumeUnit;
+        for (site_t site = 0; site < sitesPerBlockVolumeUnit; ++site)
+        {
+          const bool local = !block.SiteIsSolid(site);
+          writer << (int32_t) block.GetProcessorRankForSite(site) << (uint32_t) local;
+          if (local)
+          {
+            writer << (uint64_t) block.GetLocalContiguousIndexForSite(site);
+          }
+        }
+      }
+
+      // The streaming tables.
+      for (size_t index = 0; index < neighbourIndices.size(); ++index)
+      {
+        writer << (uint64_t) neighbourIndices[index];
+      }
+      for (site_t received = 0; received < totalSharedFs; ++received)
+      {
+        writer << (uint64_t) streamingIndicesForReceivedDistributions[received];
+      }
+#ifdef HEMELB_USE_PULL_STREAMING
+      for (size_t index = 0; index < pulledIndices.size(); ++index)
+      {
+        writer << (uint64_t) pulledIndices[index];
+      }
+#endif
+
+      // The distributions, with those received in the last halo exchange where they stream to.
+      // Those of compressed sites are written decompressed, as the replay keeps them stored.
+      for (site_t index = 0; index < GetDistributionCount(); ++index)
+      {
+        writer << (double) GetFOldValue(index);
+      }
+    }
+
+    namespace
+    {
+      // Each value of a captured subdomain must be there.
+      void CheckCaptureRead(bool read)
+      {
+        if (!read)
+        {
+          throw Exception() << "The captured subdomain is cut short";
+        }
+      }
+
+      uint64_t ReadCaptureUnsignedLong(io::writers::xdr::XdrReader& reader)
+      {
+        uint64_t value;
+        CheckCaptureRead(reader.readUnsignedLong(value));
+        return value;
+      }
+
+      unsigned ReadCaptureUnsignedInt(io::writers::xdr::XdrReader& reader)
+      {
+        unsigned value;
+        CheckCaptureRead(reader.readUnsignedInt(value));
+        return value;
+      }
+
+      int ReadCaptureInt(io::writers::xdr::XdrReader& reader)
+      {
+        int value;
+        CheckCaptureRead(reader.readInt(value));
+        return value;
+      }
+
+      double ReadCaptureDouble(io::writers::xdr::XdrReader& reader)
+      {
+        double value;
+        CheckCaptureRead(reader.readDouble(value));
+        return value;
+      }
+    }
+
+    LatticeData::LatticeData(const lb::lattices::LatticeInfo& latticeInfo,
+                             io::writers::xdr::XdrReader& reader, const net::IOCommunicator& comms_) :
+        latticeInfo(latticeInfo), distributionsAllocated(true), midDomainStabilisedCount(0),
+            domainEdgeStabilisedCount(0), compressedSiteCount(0), firstStoredDistribution(0),
+            wallDataAtBulkSites(false), firstDomainEdgeSite(0),
+            neighbouringData(new neighbouring::NeighbouringLatticeData(latticeInfo)), comms(comms_)
+    {
+      const Direction numVectors = latticeInfo.GetNumVectors();
+
+      util::Vector3D<site_t> blocksIn;
+      for (unsigned dim = 0; dim < 3; ++dim)
+      {
+        blocksIn[dim] = ReadCaptureUnsignedLong(reader);
+      }
+      const site_t blockSizeIn = ReadCaptureUnsignedLong(reader);
+      SetBasicDetails(blocksIn, blockSizeIn);
+      totalFluidSites = ReadCaptureUnsignedLong(reader);
+      totalSharedFs = ReadCaptureUnsignedLong(reader);
+
+      localFluidSites = 0;
+      for (unsigned collisionType = 0; collisionType < COLLISION_TYPES; collisionType++)
+      {
+        midDomainProcCollisions[collisionType] = ReadCaptureUnsignedLong(reader);
+        domainEdgeProcCollisions[collisionType] = ReadCaptureUnsignedLong(reader);
+        localFluidSites += midDomainProcCollisions[collisionType]
+            + domainEdgeProcCollisions[collisionType];
+      }
+      midDomainStabilisedCount = ReadCaptureUnsignedLong(reader);
+      domainEdgeStabilisedCount = ReadCaptureUnsignedLong(reader);
+      firstDomainEdgeSite = GetMidDomainSiteCount();
+      for (unsigned dim = 0; dim < 3; ++dim)
+      {
+        globalSiteMins[dim] = ReadCaptureUnsignedLong(reader);
+        globalSiteMaxes[dim] = ReadCaptureUnsignedLong(reader);
+      }
+
+      neighbouringProcs.resize(ReadCaptureUnsignedInt(reader));
+      for (size_t neighbourId = 0; neighbourId < neighbouringProcs.size(); neighbourId++)
+      {
+        neighbouringProcs[neighbourId].Rank = ReadCaptureInt(reader);
+        neighbouringProcs[neighbourId].SharedDistributionCount = ReadCaptureUnsignedLong(reader);
+        neighbouringProcs[neighbourId].FirstSharedDistribution = ReadCaptureUnsignedLong(reader);
+        neighbourIdForRank[neighbouringProcs[neighbourId].Rank] = neighbourId;
+      }
+
+      siteData.resize(localFluidSites);
+      siteLocations.resize(localFluidSites);
+      for (site_t site = 0; site < localFluidSites; ++site)
+      {
+        siteData[site].GetWallIntersectionData() = ReadCaptureUnsignedInt(reader);
+        siteData[site].GetIoletIntersectionData() = ReadCaptureUnsignedInt(reader);
+        siteData[site].GetSiteType() = (SiteType) ReadCaptureUnsignedInt(reader);
+        siteData[site].GetIoletId() = ReadCaptureInt(reader);
+        siteLocations[site] = ReadCaptureUnsignedLong(reader);
+      }
+
+      bulkSiteWallDistances.assign(numVectors - 1, distribn_t(-1.0));
+      bulkSiteWallNormal = util::Vector3D<distribn_t>(NO_VALUE);
+      wallDataAtBulkSites = ReadCaptureUnsignedInt(reader) != 0;
+      wallNormalAtSite.resize(ReadCaptureUnsignedLong(reader));
+      distanceToWall.resize(wallNormalAtSite.size() * (numVectors - 1));
+      for (size_t site = 0; site < wallNormalAtSite.size(); ++site)
+      {
+        for (unsigned dim = 0; dim < 3; ++dim)
+        {
+          wallNormalAtSite[site][dim] = ReadCaptureDouble(reader);
+        }
+        for (Direction direction = 1; direction < numVectors; ++direction)
+        {
+          distanceToWall[site * (numVectors - 1) + direction - 1] = ReadCaptureDouble(reader);
+        }
+      }
+
+      blocks.assign(GetBlockCount(), Block());
+      const uint64_t blocksWithSites = ReadCaptureUnsignedLong(reader);
+      for (uint64_t blockNumber = 0; blockNumber < blocksWithSites; ++blockNumber)
+      {
+        const site_t blockId = ReadCaptureUnsignedLong(reader);
+        const site_t blockSites = ReadCaptureUnsignedLong(reader);
+        Block& block = blocks[blockId];
+        if (blockSites > 0)
+        {
+          block = Block(blockSites);
+        }
+        for (site_t site = 0; site < blockSites; ++site)
+        {
+          block.SetProcessorRankForSite(site, ReadCaptureInt(reader));
+          if (ReadCaptureUnsignedInt(reader) != 0)
+          {
+            block.SetLocalContiguousIndexForSite(site, ReadCaptureUnsignedLong(reader));
+          }
+        }
+      }
+
+      neighbourIndices.resize(localFluidSites * numVectors);
+      for (size_t index = 0; index < neighbourIndices.size(); ++index)
+      {
+        neighbourIndices[index] = ReadCaptureUnsignedLong(reader);
+      }
+      streamingIndicesForReceivedDistributions.resize(totalSharedFs);
+      for (site_t received = 0; received < totalSharedFs; ++received)
+      {
+        streamingIndicesForReceivedDistributions[received] = ReadCaptureUnsignedLong(reader);
+      }
+#ifdef HEMELB_USE_PULL_STREAMING
+      pulledIndices.resize(localFluidSites * numVectors);
+      for (size_t index = 0; index < pulledIndices.size(); ++index)
+      {
+        pulledIndices[index] = ReadCaptureUnsignedLong(reader);
+      }
+#endif
+
+      // Touched first as a simulation's would be, so that they're placed in memory the same way.
+      oldDistributions.resize(GetDistributionCount());
+      newDistributions.resize(GetDistributionCount());
+      InitialiseDistributions();
+      for (size_t index = 0; index < oldDistributions.size(); ++index)
+      {
+        oldDistributions[index] = ReadCaptureDouble(reader);
+      }
+
+      InitialiseWallLinks();
+      InitialiseLinkPatternRanges();
+    }
+
+    void LatticeData::GetReceived(std::vector<distribn_t>& received) const
+    {
+      received.resize(totalSharedFs);
+      for (site_t i = 0; i < totalSharedFs; i++)
+      {
+        received[i] = *GetFOld(streamingIndicesForReceivedDistributions[i]);
+      }
+    }
+
+    void LatticeData::SetReceived(const std::vector<distribn_t>& received)
+    {
+      for (site_t i = 0; i < totalSharedFs; i++)
+      {
+        *GetFNew(streamingIndicesForReceivedDistributions[i]) = received[i];
+      }
+    }
+
     void LatticeData::SendAndReceive(hemelb::net::Net* net)
     {
+#ifdef HEMELB_USE_NEIGHBOURHOOD_COLLECTIVES
+      // The halo goes by StartHaloExchange instead.
+      if (neighbourhoodComms)
+      {
+        return;
+      }
+#endif
       for (std::vector<NeighbouringProcessor>::const_iterator it = neighbouringProcs.begin();
           it != neighbouringProcs.end(); ++it)
       {
+#ifdef HEMELB_USE_SHARED_MEMORY_HALO
+        // Neighbours on this node go through the shared memory window instead.
+        if (IsSharedMemoryNeighbour(it - neighbouringProcs.begin()))
+        {
+          continue;
+        }
+#endif
+#ifdef HEMELB_USE_INDEXED_HALO_RECEIVE
+        // Request the receive straight into place in FNew.
+        net->RequestReceiveDerived(GetFNew(0), haloReceiveTypes[it - neighbouringProcs.begin()], (*it).Rank);
+#else
         // Request the receive into the appropriate bit of FOld.
-        net->RequestReceive<distribn_t>(GetFOld( (*it).FirstSharedDistribution),
-                                        (int) ( ( (*it).SharedDistributionCount)),
-                                        (*it).Rank);
+        net->RequestReceive<stored_distribn_t>(GetFOld( (*it).FirstSharedDistribution),
+                                               (*it).SharedDistributionCount,
+                                               (*it).Rank);
+#endif
         // Request the send from the right bit of FNew.
-        net->RequestSend<distribn_t>(GetFNew( (*it).FirstSharedDistribution),
-                                     (int) ( ( (*it).SharedDistributionCount)),
-                                     (*it).Rank);
+        net->RequestSend<stored_distribn_t>(GetFNew( (*it).FirstSharedDistribution),
+                                            (*it).SharedDistributionCount,
+                                            (*it).Rank);
+
+      }
+    }
+
+#ifdef HEMELB_USE_NEIGHBOURHOOD_COLLECTIVES
+    void LatticeData::InitialiseNeighbourhoodComms()
+    {
+      std::vector<int> neighbours;
+      site_t displacement = 0;
+      for (std::vector<NeighbouringProcessor>::const_iterator it = neighbouringProcs.begin();
+          it != neighbouringProcs.end(); ++it)
+      {
+        neighbours.push_back(it->Rank);
+        neighbourhoodCounts.push_back((int) it->SharedDistributionCount);
+        neighbourhoodDisplacements.push_back((int) displacement);
+        displacement += it->SharedDistributionCount;
+      }
+
+#ifdef HEMELB_NEIGHBOURHOOD_REORDER
+      const bool reorder = true;
+#else
+      const bool reorder = false;
+#endif
+      // Weight the edges by the amount sent along them, so that a reordering MPI can put the
+      // ranks sharing most distributions closest together.
+      neighbourhoodComms = comms.DistGraphAdjacent(neighbours, neighbourhoodCounts, reorder);
+      neighbourhoodRequest = MPI_REQUEST_NULL;
+    }
+#endif
+
+#ifdef HEMELB_USE_SHARED_MEMORY_HALO
+    void LatticeData::InitialiseSharedMemoryHalo()
+    {
+      nodeComms = comms.SplitShared();
+
+      // Find which of the neighbours are on this node, and their ranks there.
+      const size_t neighbourCount = neighbouringProcs.size();
+      std::vector<int> ranks(neighbourCount), nodeRanks(neighbourCount);
+      for (size_t neighbourId = 0; neighbourId < neighbourCount; neighbourId++)
+      {
+        ranks[neighbourId] = neighbouringProcs[neighbourId].Rank;
+      }
+      if (neighbourCount > 0)
+      {
+        MPI_Group group, nodeGroup;
+        HEMELB_MPI_CALL(MPI_Comm_group, (comms, &group));
+        HEMELB_MPI_CALL(MPI_Comm_group, (nodeComms, &nodeGroup));
+        HEMELB_MPI_CALL(MPI_Group_translate_ranks,
+                        (group, (int) neighbourCount, &ranks.front(), nodeGroup, &nodeRanks.front()));
+        HEMELB_MPI_CALL(MPI_Group_free, (&group));
+        HEMELB_MPI_CALL(MPI_Group_free, (&nodeGroup));
+      }
+
+      // Our inbox holds the shared distributions of every neighbour on this node, for each of
+      // two time steps.
+      haloInboxOffsets.assign(neighbourCount, -1);
+      haloInboxSize = 0;
+      for (size_t neighbourId = 0; neighbourId < neighbourCount; neighbourId++)
+      {
+        if (nodeRanks[neighbourId] != MPI_UNDEFINED)
+        {
+          haloInboxOffsets[neighbourId] = haloInboxSize;
+          haloInboxSize += neighbouringProcs[neighbourId].SharedDistributionCount;
+        }
+      }
+      HEMELB_MPI_CALL(MPI_Win_allocate_shared,
+                      (2 * haloInboxSize * sizeof(stored_distribn_t), sizeof(stored_distribn_t), MPI_INFO_NULL, nodeComms, &haloInbox, &haloWindow));
+
+      // Tell each neighbour on this node where its distributions go in our inbox, and how big
+      // the inbox is.
+      std::vector<site_t> sentLayout(2 * neighbourCount), receivedLayout(2 * neighbourCount);
+      std::vector<MPI_Request> requests;
+      for (size_t neighbourId = 0; neighbourId < neighbourCount; neighbourId++)
+      {
+        if (nodeRanks[neighbourId] == MPI_UNDEFINED)
+        {
+          continue;
+        }
+        sentLayout[2 * neighbourId] = haloInboxOffsets[neighbourId];
+        sentLayout[2 * neighbourId + 1] = haloInboxSize;
+
+        requests.push_back(MPI_REQUEST_NULL);
+        HEMELB_MPI_CALL(MPI_Irecv,
+                        (&receivedLayout[2 * neighbourId], 2, net::MpiDataType<site_t>(), nodeRanks[neighbourId], 0, nodeComms, &requests.back()));
+        requests.push_back(MPI_REQUEST_NULL);
+        HEMELB_MPI_CALL(MPI_Isend,
+                        (&sentLayout[2 * neighbourId], 2, net::MpiDataType<site_t>(), nodeRanks[neighbourId], 0, nodeComms, &requests.back()));
+      }
+      if (!requests.empty())
+      {
+        HEMELB_MPI_CALL(MPI_Waitall, ((int) requests.size(), &requests.front(), MPI_STATUSES_IGNORE));
+      }
+
+      // Work out where our distributions go in each neighbour's inbox.
+      haloDestinations.assign(2 * neighbourCount, NULL);
+      for (size_t neighbourId = 0; neighbourId < neighbourCount; neighbourId++)
+      {
+        if (nodeRanks[neighbourId] == MPI_UNDEFINED)
+        {
+          continue;
+        }
+        MPI_Aint size;
+        int displacementUnit;
+        stored_distribn_t* neighbourInbox;
+        HEMELB_MPI_CALL(MPI_Win_shared_query,
+                        (haloWindow, nodeRanks[neighbourId], &size, &displacementUnit, &neighbourInbox));
+
+        const site_t offset = receivedLayout[2 * neighbourId];
+        const site_t neighbourInboxSize = receivedLayout[2 * neighbourId + 1];
+        haloDestinations[neighbourId] = neighbourInbox + offset;
+        haloDestinations[neighbourCount + neighbourId] = neighbourInbox + neighbourInboxSize + offset;
+      }
+
+      // Only MPI_Win_sync is used from here on.
+      HEMELB_MPI_CALL(MPI_Win_lock_all, (MPI_MODE_NOCHECK, haloWindow));
+      haloParity = 0;
+    }
+
+    bool LatticeData::IsSharedMemoryNeighbour(size_t neighbourId) const
+    {
+      return neighbourId < haloInboxOffsets.size() && haloInboxOffsets[neighbourId] >= 0;
+    }
+#endif
+
+    void LatticeData::StartHaloExchange()
+    {
+#ifdef HEMELB_USE_NEIGHBOURHOOD_COLLECTIVES
+      if (!neighbourhoodComms)
+      {
+        return;
+      }
+
+      // The shared distributions of all neighbours are contiguous, in neighbouringProcs order,
+      // straight after the rubbish site.
+      const site_t firstShared = GetLocalFluidSiteCount() * latticeInfo.GetNumVectors() + 1;
+      int* counts = neighbourhoodCounts.empty()
+        ? NULL
+        : &neighbourhoodCounts.front();
+      int* displacements = neighbourhoodDisplacements.empty()
+        ? NULL
+        : &neighbourhoodDisplacements.front();
+
+      HEMELB_MPI_CALL(MPI_Ineighbor_alltoallv,
+                      (&newDistributions.front() + firstShared, counts, displacements, net::MpiDataType<stored_distribn_t>(), &oldDistributions.front() + firstShared, counts, displacements, net::MpiDataType<stored_distribn_t>(), neighbourhoodComms, &neighbourhoodRequest));
+#elif defined(HEMELB_USE_SHARED_MEMORY_HALO)
+      if (!nodeComms)
+      {
+        return;
+      }
+
+      // Write straight into the inboxes of the neighbours on this node.
+      const size_t neighbourCount = neighbouringProcs.size();
+      for (size_t neighbourId = 0; neighbourId < neighbourCount; neighbourId++)
+      {
+        if (IsSharedMemoryNeighbour(neighbourId))
+        {
+          const NeighbouringProcessor& neighbour = neighbouringProcs[neighbourId];
+          const stored_distribn_t* source = GetFNew(neighbour.FirstSharedDistribution);
+          std::copy(source,
+                    source + neighbour.SharedDistributionCount,
+                    haloDestinations[haloParity * neighbourCount + neighbourId]);
+        }
+      }
+      HEMELB_MPI_CALL(MPI_Win_sync, (haloWindow));
+#endif
+    }
 
+    void LatticeData::ProgressHaloExchange()
+    {
+#ifdef HEMELB_USE_NEIGHBOURHOOD_COLLECTIVES
+      if (neighbourhoodComms)
+      {
+        int done;
+        HEMELB_MPI_CALL(MPI_Test, (&neighbourhoodRequest, &done, MPI_STATUS_IGNORE));
+      }
+#endif
+    }
+
+    void LatticeData::FinishHaloExchange()
+    {
+#ifdef HEMELB_USE_NEIGHBOURHOOD_COLLECTIVES
+      if (neighbourhoodComms)
+      {
+        HEMELB_MPI_CALL(MPI_Wait, (&neighbourhoodRequest, MPI_STATUS_IGNORE));
+      }
+#elif defined(HEMELB_USE_SHARED_MEMORY_HALO)
+      if (nodeComms)
+      {
+        // Once every rank on the node is past the barrier, all the writes to our inbox are done.
+        // The other inbox is the one written next step, so nothing overwrites this one before
+        // CopyReceived has read it.
+        HEMELB_MPI_CALL(MPI_Barrier, (nodeComms));
+        HEMELB_MPI_CALL(MPI_Win_sync, (haloWindow));
       }
+#endif
     }
 
     void LatticeData::CopyReceived()
     {
       // Copy the distribution functions received from the neighbouring
       // processors into the destination buffer "f_new".
+#ifdef HEMELB_USE_SHARED_MEMORY_HALO
+      site_t i = 0;
+      for (size_t neighbourId = 0; neighbourId < neighbouringProcs.size(); neighbourId++)
+      {
+        const NeighbouringProcessor& neighbour = neighbouringProcs[neighbourId];
+#ifdef HEMELB_USE_INDEXED_HALO_RECEIVE
+        // Distributions from other nodes have already been received into place.
+        if (!IsSharedMemoryNeighbour(neighbourId))
+        {
+          i += neighbour.SharedDistributionCount;
+          continue;
+        }
+#endif
+        const stored_distribn_t* received = IsSharedMemoryNeighbour(neighbourId)
+          ? haloInbox + haloParity * haloInboxSize + haloInboxOffsets[neighbourId]
+          : GetFOld(neighbour.FirstSharedDistribution);
+
+        for (site_t j = 0; j < neighbour.SharedDistributionCount; ++j, ++i)
+        {
+          *GetFNew(streamingIndicesForReceivedDistributions[i]) = received[j];
+        }
+      }
+      if (nodeComms)
+      {
+        haloParity = 1 - haloParity;
+      }
+#elif !defined(HEMELB_USE_INDEXED_HALO_RECEIVE)
       for (site_t i = 0; i < totalSharedFs; i++)
       {
         *GetFNew(streamingIndicesForReceivedDistributions[i]) = *GetFOld(neighbouringProcs[0].FirstSharedDistribution
             + i);
       }
+#endif
     }
 
     void LatticeData::Report(ctemplate::TemplateDictionary& dictionary)
@@ -693,6 +1902,41 @@ namespace hemelb
         proc->SetIntValue("SITES", fluidSitesOnEachProcessor[n]);
       }
     }
+
+    void LatticeData::RecordMemoryUsage(reporting::MemoryUsage& memory) const
+    {
+      // Without the distributions, what they would take.
+      memory.RecordSubsystem("distributions",
+                             distributionsAllocated ?
+                               util::VectorBytes(oldDistributions) + util::VectorBytes(newDistributions) :
+                               2 * GetStoredDistributionCount() * sizeof(stored_distribn_t));
+#ifdef HEMELB_USE_COMPRESSED_COLD_SITES
+      memory.RecordSubsystem("compressed distributions",
+                             2 * CompressedDistributions::GetMemoryUsage(latticeInfo.GetNumVectors(),
+                                                                         compressedSiteCount));
+#endif
+      memory.RecordSubsystem("neighbour indices",
+                             util::VectorBytes(neighbourIndices)
+                                 + util::VectorBytes(streamingIndicesForReceivedDistributions)
+#ifdef HEMELB_USE_PULL_STREAMING
+                                 + util::VectorBytes(pulledIndices)
+#endif
+                             );
+
+      size_t blockBytes = util::VectorBytes(blocks);
+      for (size_t block = 0; block < blocks.size(); ++block)
+      {
+        blockBytes += blocks[block].GetMemoryUsage();
+      }
+      memory.RecordSubsystem("blocks", blockBytes);
+
+      memory.RecordSubsystem("site data",
+                             util::VectorBytes(distanceToWall) + util::VectorBytes(siteLocations)
+                                 + util::VectorBytes(wallNormalAtSite) + util::VectorBytes(siteData)
+                                 + util::VectorBytes(wallLinks) + util::VectorBytes(linkPatternRanges));
+      memory.RecordSubsystem("neighbouring data", neighbouringData->GetMemoryUsage());
+    }
+
     neighbouring::NeighbouringLatticeData &LatticeData::GetNeighbouringData()
     {
       return *neighbouringData;
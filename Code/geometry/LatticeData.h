@@ -8,19 +8,29 @@
 #define HEMELB_GEOMETRY_LATTICEDATA_H
 
 #include <cstdio>
+#include <map>
+#include <unordered_map>
 #include <vector>
 
 #include "net/net.h"
 #include "constants.h"
 #include "configuration/SimConfig.h"
 #include "geometry/Block.h"
+#include "geometry/CompressedDistributions.h"
 #include "geometry/GeometryReader.h"
 #include "geometry/NeighbouringProcessor.h"
 #include "geometry/Site.h"
 #include "geometry/neighbouring/NeighbouringSite.h"
 #include "geometry/SiteData.h"
+#include "geometry/SiteBox.h"
+#include "geometry/LinkPatternRange.h"
+#include "geometry/WallLink.h"
+#include "io/writers/Writer.h"
+#include "io/writers/xdr/XdrReader.h"
+#include "reporting/MemoryUsage.h"
 #include "reporting/Reportable.h"
 #include "reporting/Timers.h"
+#include "util/LatticeAllocator.h"
 #include "util/Vector3D.h"
 
 namespace hemelb
@@ -39,7 +49,22 @@ namespace hemelb
         template<class Lattice> friend class lb::LBM; //! Let the LBM have access to internals so it can initialise the distribution arrays.
         template<class LatticeData> friend class Site; //! Let the inner classes have access to site-related data that's otherwise private.
 
-        LatticeData(const lb::lattices::LatticeInfo& latticeInfo, const Geometry& readResult, const net::IOCommunicator& comms);
+        /**
+         * @param latticeInfo
+         * @param readResult
+         * @param comms
+         * @param allocateDistributions False to set up everything but the distributions and the
+         * halo exchange of them, e.g. to see how big the lattice would be without simulating.
+         * @param stabilisedRegions The bulk sites in these boxes are put at the end of the
+         * bulk ranges, for a stabilised kernel to collide.
+         * @param compressedRegions With HEMELB_USE_COMPRESSED_COLD_SITES, the mid-domain bulk
+         * sites in these boxes, but not in the stabilised ones, are put at the start of their
+         * range and their distributions kept compressed. Otherwise they're ignored.
+         */
+        LatticeData(const lb::lattices::LatticeInfo& latticeInfo, const Geometry& readResult, const net::IOCommunicator& comms,
+                    bool allocateDistributions = true,
+                    const std::vector<SiteBox>& stabilisedRegions = std::vector<SiteBox>(),
+                    const std::vector<SiteBox>& compressedRegions = std::vector<SiteBox>());
 
         virtual ~LatticeData();
 
@@ -49,11 +74,35 @@ namespace hemelb
         inline void SwapOldAndNew()
         {
           oldDistributions.swap(newDistributions);
+#ifdef HEMELB_USE_COMPRESSED_COLD_SITES
+          oldCompressed.swap(newCompressed);
+#endif
         }
 
         void SendAndReceive(net::Net* net);
+
+        /**
+         * Copy the received distributions to where they stream to in fNew. With
+         * HEMELB_USE_INDEXED_HALO_RECEIVE, those received through the Net are already there, so
+         * only those from a shared memory inbox (if any) are copied.
+         */
         void CopyReceived();
 
+        /**
+         * Exchange whatever part of the halo doesn't go through the Net. The exchange is started
+         * once the domain edge sites have been done and finished before CopyReceived, and must be
+         * done on every rank, like a collective.
+         *
+         * With HEMELB_USE_NEIGHBOURHOOD_COLLECTIVES, this is all of it, by one
+         * MPI_Ineighbor_alltoallv per time step. With HEMELB_USE_SHARED_MEMORY_HALO, it is the
+         * part shared with neighbours on the same node, which we write straight into their
+         * inboxes in a shared memory window. Otherwise these do nothing. ProgressHaloExchange
+         * just gives MPI the chance to move the neighbourhood exchange along.
+         */
+        void StartHaloExchange();
+        void ProgressHaloExchange();
+        void FinishHaloExchange();
+
         /**
          * Get the lattice info object for the current lattice
          * @return
@@ -143,13 +192,56 @@ namespace hemelb
         bool IsValidLatticeSite(const util::Vector3D<site_t>& siteCoords) const;
 
         /**
-         * Get a pointer into the fNew array at the given index
+         * Get the index into the distribution arrays of the distribution for the given site and
+         * direction. By default distributions are stored site-major (all directions of one site
+         * are contiguous); when built with HEMELB_USE_SOA_DISTRIBUTIONS they are stored
+         * direction-major, so that one direction of consecutive sites is contiguous. In both
+         * cases the rubbish site and the shared distributions follow the local ones.
+         *
+         * @param siteIndex
+         * @param direction
+         * @return
+         */
+        template<typename LatticeType>
+        inline site_t GetDistributionIndex(site_t siteIndex, Direction direction) const
+        {
+#ifdef HEMELB_USE_SOA_DISTRIBUTIONS
+          return direction * localFluidSites + siteIndex;
+#else
+          return siteIndex * LatticeType::NUMVECTORS + direction;
+#endif
+        }
+
+        /**
+         * Non-templated version of GetDistributionIndex, for when you haven't got a lattice type
+         * handy.
+         * @param siteIndex
+         * @param direction
+         * @return
+         */
+        inline site_t GetDistributionIndex(site_t siteIndex, Direction direction) const
+        {
+#ifdef HEMELB_USE_SOA_DISTRIBUTIONS
+          return direction * localFluidSites + siteIndex;
+#else
+          return siteIndex * latticeInfo.GetNumVectors() + direction;
+#endif
+        }
+
+        /**
+         * Get a pointer into the fNew array at the given index. With
+         * HEMELB_USE_COMPRESSED_COLD_SITES, it must be of a distribution stored there, not one of
+         * the compressed sites' (see GetFNewValue).
          * @param distributionIndex
          * @return
          */
-        inline distribn_t* GetFNew(site_t distributionIndex)
+        inline stored_distribn_t* GetFNew(site_t distributionIndex)
         {
+#ifdef HEMELB_USE_COMPRESSED_COLD_SITES
+          return &newDistributions[distributionIndex - firstStoredDistribution];
+#else
           return &newDistributions[distributionIndex];
+#endif
         }
 
         /**
@@ -158,11 +250,48 @@ namespace hemelb
          * @param distributionIndex
          * @return
          */
-        inline const distribn_t* GetFNew(site_t siteNumber) const
+        inline const stored_distribn_t* GetFNew(site_t siteNumber) const
         {
+#ifdef HEMELB_USE_COMPRESSED_COLD_SITES
+          return &newDistributions[siteNumber - firstStoredDistribution];
+#else
           return &newDistributions[siteNumber];
+#endif
         }
 
+        /**
+         * Get a distribution from fNew by its index, whether it's stored there or, with
+         * HEMELB_USE_COMPRESSED_COLD_SITES, one of a compressed site's.
+         * @param distributionIndex
+         * @return
+         */
+        template<typename LatticeType>
+        inline distribn_t GetFNewValue(site_t distributionIndex) const
+        {
+#ifdef HEMELB_USE_COMPRESSED_COLD_SITES
+          if (distributionIndex < firstStoredDistribution)
+          {
+            return newCompressed.Get<LatticeType>(distributionIndex / LatticeType::NUMVECTORS,
+                                                  distributionIndex % LatticeType::NUMVECTORS);
+          }
+#endif
+          return *GetFNew(distributionIndex);
+        }
+
+#ifdef HEMELB_USE_COMPRESSED_COLD_SITES
+        /**
+         * Compress a site's post-collision distributions into fNew; the site must be one of the
+         * compressed ones.
+         * @param siteIndex
+         * @param fPostCollision
+         */
+        template<typename LatticeType>
+        inline void StoreCompressedFNew(site_t siteIndex, const distribn_t* fPostCollision)
+        {
+          newCompressed.Store<LatticeType>(siteIndex, fPostCollision);
+        }
+#endif
+
         proc_t GetProcIdFromGlobalCoords(const util::Vector3D<site_t>& globalSiteCoords) const;
 
         /**
@@ -289,13 +418,39 @@ namespace hemelb
         }
 
         /**
-         * Get the number of fluid sites on the given rank.
-         * @param proc
+         * Number of the mid-domain bulk sites that are in the stabilised regions. They are the
+         * last sites of the mid-domain bulk range.
+         * @return
+         */
+        inline site_t GetMidDomainStabilisedCount() const
+        {
+          return midDomainStabilisedCount;
+        }
+
+        /**
+         * Number of the domain-edge bulk sites that are in the stabilised regions. They are the
+         * last sites of the domain-edge bulk range.
+         * @return
+         */
+        inline site_t GetDomainEdgeStabilisedCount() const
+        {
+          return domainEdgeStabilisedCount;
+        }
+
+        /**
+         * Number of the mid-domain bulk sites whose distributions are kept compressed, those in
+         * the compressed regions with HEMELB_USE_COMPRESSED_COLD_SITES. They are the first
+         * sites of the mid-domain bulk range, so the first local sites.
          * @return
          */
-        inline site_t GetFluidSiteCountOnProc(proc_t proc) const
+        inline site_t GetCompressedSiteCount() const
         {
-          return fluidSitesOnEachProcessor[proc];
+          return compressedSiteCount;
+        }
+
+        inline bool IsCompressed(site_t siteIndex) const
+        {
+          return siteIndex < compressedSiteCount;
         }
 
         /**
@@ -325,12 +480,122 @@ namespace hemelb
           return globalSiteMaxes;
         }
 
+        typedef std::vector<WallLink>::const_iterator WallLinkIterator;
+
+        /**
+         * Get the first wall link whose site index is at least siteIndex. The wall links of the
+         * sites [first, first + count) are those from GetFirstWallLink(first) up to (but not
+         * including) GetFirstWallLink(first + count).
+         * @param siteIndex
+         * @return
+         */
+        WallLinkIterator GetFirstWallLink(site_t siteIndex) const;
+
+        typedef std::vector<LinkPatternRange>::const_iterator LinkPatternRangeIterator;
+
+        /**
+         * Get the run of sites with the same wall and iolet links, and the same iolet, that
+         * contains a site. The iolet sites of each collision type are sorted by iolet, so there
+         * is a run (or a few, one per link pattern) for each iolet in each such range. The runs
+         * of the sites [first, first + count) are those from GetLinkPatternRange(first) up to the
+         * one containing first + count - 1; the first and last may extend beyond the sites.
+         * @param siteIndex A local fluid site
+         * @return
+         */
+        LinkPatternRangeIterator GetLinkPatternRange(site_t siteIndex) const;
+
         void Report(ctemplate::TemplateDictionary& dictionary);
 
+        /**
+         * Record the bytes allocated for the distributions, the neighbour indices, the blocks,
+         * the per-site arrays and the neighbouring data.
+         * @param memory
+         */
+        void RecordMemoryUsage(reporting::MemoryUsage& memory) const;
+
+        /**
+         * @return The processors this one exchanges halo distributions with.
+         */
+        const std::vector<NeighbouringProcessor>& GetNeighbouringProcessors() const
+        {
+          return neighbouringProcs;
+        }
+
         neighbouring::NeighbouringLatticeData &GetNeighbouringData();
         neighbouring::NeighbouringLatticeData const &GetNeighbouringData() const;
 
         int GetLocalRank() const;
+
+        /**
+         * Take the distributions of every local site from the lattice as it was decomposed
+         * before the domain was rebalanced. A collective operation: each core sends the
+         * distributions of its previous sites to the cores that have them now.
+         *
+         * @param previous The lattice before rebalancing.
+         * @param procForEachPreviousSite The rank that now has each of previous's local sites.
+         */
+        void TakeDistributionsFrom(const LatticeData& previous,
+                                   const std::vector<proc_t>& procForEachPreviousSite);
+
+        /**
+         * Get the distributions of every local site, keyed by global noncontiguous site id, which
+         * doesn't depend on the decomposition.
+         *
+         * @param globalSiteIds [out] The id of each local site.
+         * @param distributions [out] The fOld distributions of each local site in turn.
+         */
+        void GetDistributionRecords(std::vector<site_t>& globalSiteIds,
+                                    std::vector<distribn_t>& distributions) const;
+
+        /**
+         * Get the fOld distributions of a local site, decompressing them if need be.
+         *
+         * @param site The local contiguous site index.
+         * @param distributions [out] The distributions in each lattice direction.
+         */
+        void GetDistributions(site_t site, distribn_t* distributions) const;
+
+        /**
+         * Set both the fOld and fNew distributions of a local site, e.g. from a checkpoint.
+         *
+         * @param site The local contiguous site index.
+         * @param distributions The distributions in each lattice direction.
+         */
+        void SetDistributions(site_t site, const distribn_t* distributions);
+
+        /**
+         * Write everything the collide-and-stream loop reads of this rank's subdomain, for a
+         * capture (see io/formats/capture.h): the collision-type ranges, site data, wall data,
+         * blocks, streaming tables and fOld. Call it between time steps, when fOld still holds
+         * the distributions received in the last halo exchange where CopyReceived put them.
+         * @param writer
+         */
+        void WriteSubdomain(io::writers::Writer& writer) const;
+
+        /**
+         * Rebuild a subdomain written by WriteSubdomain, to replay its collide-and-stream loop
+         * on a single core. The neighbouring processors are kept, for their shared distribution
+         * counts, but there is no halo exchange with them; SetReceived stands in for it.
+         * @param latticeInfo
+         * @param reader Positioned at the start of the subdomain.
+         * @param comms
+         */
+        LatticeData(const lb::lattices::LatticeInfo& latticeInfo,
+                    io::writers::xdr::XdrReader& reader, const net::IOCommunicator& comms);
+
+        /**
+         * Get the distributions received in the last halo exchange, from where CopyReceived put
+         * them, which is in fOld once the arrays have been swapped at the end of the step.
+         * @param received Set to one for each shared distribution, in the order they're received.
+         */
+        void GetReceived(std::vector<distribn_t>& received) const;
+
+        /**
+         * Put distributions in fNew where CopyReceived would put those received in the halo
+         * exchange, in place of one.
+         * @param received One for each shared distribution, in the order they're received.
+         */
+        void SetReceived(const std::vector<distribn_t>& received);
       protected:
         /**
          * The protected default constructor does nothing. It exists to allow derivation from this
@@ -342,7 +607,70 @@ namespace hemelb
         void SetBasicDetails(util::Vector3D<site_t> blocks,
                              site_t blockSize);
 
-        void ProcessReadSites(const Geometry& readResult);
+        void ProcessReadSites(const Geometry& readResult, const std::vector<SiteBox>& stabilisedRegions,
+                              const std::vector<SiteBox>& compressedRegions);
+
+        /**
+         * Reorder the sites of one collision-type range (as collected in ProcessReadSites) along
+         * the Morton space-filling curve through their global coordinates, so that sites which
+         * are neighbours in space tend to be neighbours in memory too. All of the per-site
+         * vectors are permuted in the same way.
+         */
+        void SortSitesAlongSpaceFillingCurve(std::vector<site_t>& blockNumbers,
+                                             std::vector<site_t>& siteNumbers,
+                                             std::vector<SiteData>& siteData,
+                                             std::vector<util::Vector3D<float> >& wallNormals,
+                                             std::vector<float>& wallDistance) const;
+
+        /**
+         * Reorder the sites of one iolet collision-type range so that the sites of each iolet are
+         * together, in order of iolet id, otherwise keeping their order. The runs of sites with
+         * the same links (see GetLinkPatternRange) then each belong to one iolet, so the
+         * streamers can look its values up once per run. All of the per-site vectors are
+         * permuted in the same way.
+         */
+        void SortSitesByIolet(std::vector<site_t>& blockNumbers,
+                              std::vector<site_t>& siteNumbers,
+                              std::vector<SiteData>& siteData,
+                              std::vector<util::Vector3D<float> >& wallNormals,
+                              std::vector<float>& wallDistance) const;
+
+        /**
+         * Reorder the sites of one collision-type range so that sites whose links cross the wall
+         * and the iolets in the same directions are together, otherwise keeping their order.
+         * All of the per-site vectors are permuted in the same way.
+         */
+        void SortSitesByLinkPattern(std::vector<site_t>& blockNumbers,
+                                    std::vector<site_t>& siteNumbers,
+                                    std::vector<SiteData>& siteData,
+                                    std::vector<util::Vector3D<float> >& wallNormals,
+                                    std::vector<float>& wallDistance) const;
+
+        /**
+         * Move the sites of one collision-type range that are in any of the regions, and none of
+         * the excluded regions, to its start or end, otherwise keeping their order. All of the
+         * per-site vectors are permuted in the same way.
+         * @return The number of sites moved.
+         */
+        site_t MoveSitesInRegions(const std::vector<SiteBox>& regions,
+                                  const std::vector<SiteBox>& excludedRegions, bool toStart,
+                                  std::vector<site_t>& blockNumbers,
+                                  std::vector<site_t>& siteNumbers,
+                                  std::vector<SiteData>& siteData,
+                                  std::vector<util::Vector3D<float> >& wallNormals,
+                                  std::vector<float>& wallDistance) const;
+
+        /**
+         * Put the sites of one collision-type range into a new order. All of the per-site vectors
+         * are permuted in the same way.
+         * @param order The current position of the site to go at each position
+         */
+        void PermuteSites(const std::vector<site_t>& order,
+                          std::vector<site_t>& blockNumbers,
+                          std::vector<site_t>& siteNumbers,
+                          std::vector<SiteData>& siteData,
+                          std::vector<util::Vector3D<float> >& wallNormals,
+                          std::vector<float>& wallDistance) const;
 
         void PopulateWithReadData(const std::vector<site_t> midDomainBlockNumbers[COLLISION_TYPES],
                                   const std::vector<site_t> midDomainSiteNumbers[COLLISION_TYPES],
@@ -363,22 +691,31 @@ namespace hemelb
           }
           // Data about local sites.
           localFluidSites = 0;
+          // Only the sites outside the bulk (collision type 0) ranges have wall distances and
+          // normals stored, in the same order as the sites.
+          wallDataAtBulkSites = false;
+          firstDomainEdgeSite = GetMidDomainSiteCount();
+          bulkSiteWallDistances.assign(latticeInfo.GetNumVectors() - 1, distribn_t(-1.0));
+          bulkSiteWallNormal = util::Vector3D<distribn_t>(NO_VALUE);
           // Data about contiguous local sites. First midDomain stuff, then domainEdge.
           for (unsigned collisionType = 0; collisionType < COLLISION_TYPES; collisionType++)
           {
             for (unsigned indexInType = 0; indexInType < midDomainProcCollisions[collisionType]; indexInType++)
             {
               siteData.push_back(midDomainSiteData[collisionType][indexInType]);
-              wallNormalAtSite.push_back(midDomainWallNormals[collisionType][indexInType]);
-              for (Direction direction = 1; direction < latticeInfo.GetNumVectors(); direction++)
+              if (collisionType != 0)
               {
-                distanceToWall.push_back(midDomainWallDistance[collisionType][indexInType
-                    * (latticeInfo.GetNumVectors() - 1) + direction - 1]);
+                wallNormalAtSite.push_back(midDomainWallNormals[collisionType][indexInType]);
+                for (Direction direction = 1; direction < latticeInfo.GetNumVectors(); direction++)
+                {
+                  distanceToWall.push_back(midDomainWallDistance[collisionType][indexInType
+                      * (latticeInfo.GetNumVectors() - 1) + direction - 1]);
+                }
               }
               site_t blockId = midDomainBlockNumbers[collisionType][indexInType];
               site_t siteId = midDomainSiteNumbers[collisionType][indexInType];
               blocks[blockId].SetLocalContiguousIndexForSite(siteId, localFluidSites);
-              globalSiteCoords.push_back(GetGlobalCoords(blockId, GetSiteCoordsFromSiteId(siteId)));
+              siteLocations.push_back( (blockId << SiteLocationBits) | siteId);
               localFluidSites++;
             }
 
@@ -389,32 +726,119 @@ namespace hemelb
             for (unsigned indexInType = 0; indexInType < domainEdgeProcCollisions[collisionType]; indexInType++)
             {
               siteData.push_back(domainEdgeSiteData[collisionType][indexInType]);
-              wallNormalAtSite.push_back(domainEdgeWallNormals[collisionType][indexInType]);
-              for (Direction direction = 1; direction < latticeInfo.GetNumVectors(); direction++)
+              if (collisionType != 0)
               {
-                distanceToWall.push_back(domainEdgeWallDistance[collisionType][indexInType
-                    * (latticeInfo.GetNumVectors() - 1) + direction - 1]);
+                wallNormalAtSite.push_back(domainEdgeWallNormals[collisionType][indexInType]);
+                for (Direction direction = 1; direction < latticeInfo.GetNumVectors(); direction++)
+                {
+                  distanceToWall.push_back(domainEdgeWallDistance[collisionType][indexInType
+                      * (latticeInfo.GetNumVectors() - 1) + direction - 1]);
+                }
               }
               site_t blockId = domainEdgeBlockNumbers[collisionType][indexInType];
               site_t siteId = domainEdgeSiteNumbers[collisionType][indexInType];
               blocks[blockId].SetLocalContiguousIndexForSite(siteId, localFluidSites);
-              globalSiteCoords.push_back(GetGlobalCoords(blockId, GetSiteCoordsFromSiteId(siteId)));
+              siteLocations.push_back( (blockId << SiteLocationBits) | siteId);
               localFluidSites++;
             }
 
           }
 
-          oldDistributions.resize(localFluidSites * latticeInfo.GetNumVectors() + 1 + totalSharedFs);
-          newDistributions.resize(localFluidSites * latticeInfo.GetNumVectors() + 1 + totalSharedFs);
+          if (distributionsAllocated)
+          {
+            oldDistributions.resize(GetStoredDistributionCount());
+            newDistributions.resize(GetStoredDistributionCount());
+#ifdef HEMELB_USE_COMPRESSED_COLD_SITES
+            oldCompressed = CompressedDistributions(latticeInfo, compressedSiteCount);
+            newCompressed = CompressedDistributions(latticeInfo, compressedSiteCount);
+#endif
+            InitialiseDistributions();
+          }
         }
+
+        /**
+         * @return The length of each distributions array: every local site's, then a spare one
+         * for streaming to solid sites, then the ones shared with the neighbouring processors.
+         */
+        site_t GetDistributionCount() const
+        {
+          return localFluidSites * latticeInfo.GetNumVectors() + 1 + totalSharedFs;
+        }
+
+        /**
+         * @return The length each distributions array is allocated with: all but the compressed
+         * sites' distributions, which are kept compressed instead.
+         */
+        site_t GetStoredDistributionCount() const
+        {
+          return GetDistributionCount() - firstStoredDistribution;
+        }
+
         void CollectFluidSiteDistribution();
         void CollectGlobalSiteExtrema();
 
+        /**
+         * The type used for the streaming tables (neighbourIndices and
+         * streamingIndicesForReceivedDistributions). These are read for every link during
+         * streaming and are as large as the distributions themselves, so by default they are
+         * 32-bit; HEMELB_USE_64BIT_STREAMING_INDICES is needed for ranks whose distribution arrays
+         * have more than 2^32 entries.
+         */
+#ifdef HEMELB_USE_64BIT_STREAMING_INDICES
+        typedef site_t streaming_index_t;
+#else
+        typedef uint32_t streaming_index_t;
+#endif
+
         void InitialiseNeighbourLookups();
 
+        /**
+         * Build the list of wall links from the site data. This must be called again if the site
+         * data are changed.
+         */
+        void InitialiseWallLinks();
+
+        /**
+         * Build the runs of sites with the same wall and iolet links from the site data. This
+         * must be called again if the site data are changed.
+         */
+        void InitialiseLinkPatternRanges();
+
+        /**
+         * Zero the distributions, spreading their pages over the NUMA nodes of the threads.
+         */
+        void InitialiseDistributions();
+
+        /**
+         * Zero a lattice array, indexed like the distributions, from the threads that will work
+         * on it: each collision type's sites are split between the OpenMP threads as the LB does
+         * it, so each thread's pages go on its own NUMA node. Anything after the local sites'
+         * distributions is written by the calling thread.
+         * @param array
+         * @param firstSite The site whose distributions the array starts with, e.g. the first
+         * after the compressed sites for the distributions themselves
+         */
+        template<typename T>
+        void FirstTouch(std::vector<T, util::LatticeAllocator<T> >& array, site_t firstSite = 0) const;
+
+        /**
+         * Point each local distribution at where it streams to, and list the coordinates and
+         * direction of each that streams to another processor, by that processor's rank, in
+         * block order. The blocks are split between the OpenMP threads in contiguous ranges, and
+         * the processor of each neighbouring site is looked up in the blocks around the site's
+         * own, found once per block.
+         * @param sharedFLocationForEachProc
+         */
         void InitialiseNeighbourLookup(std::vector<std::vector<site_t> >& sharedFLocationForEachProc);
         void InitialisePointToPointComms(std::vector<std::vector<site_t> >& sharedFLocationForEachProc);
         void InitialiseReceiveLookup(std::vector<std::vector<site_t> >& sharedFLocationForEachProc);
+#ifdef HEMELB_USE_PULL_STREAMING
+        /**
+         * Invert the streaming tables into pulledIndices. The received distributions are then
+         * pulled from where they were received, so are copied there in fNew, ready for the swap.
+         */
+        void InitialisePullLookup();
+#endif
 
         sitedata_t GetSiteData(site_t iSiteI, site_t iSiteJ, site_t iSiteK) const;
 
@@ -429,7 +853,7 @@ namespace hemelb
                                          const unsigned int direction,
                                          const site_t distributionIndex)
         {
-          neighbourIndices[siteIndex * latticeInfo.GetNumVectors() + direction] = distributionIndex;
+          neighbourIndices[GetDistributionIndex(siteIndex, direction)] = distributionIndex;
         }
 
         void GetBlockIJK(site_t block, util::Vector3D<site_t>& blockCoords) const;
@@ -438,7 +862,10 @@ namespace hemelb
         template<typename LatticeType>
         double GetCutDistance(site_t iSiteIndex, int iDirection) const
         {
-          return distanceToWall[iSiteIndex * (LatticeType::NUMVECTORS - 1) + iDirection - 1];
+          const site_t wallDataIndex = GetWallDataIndex(iSiteIndex);
+          return wallDataIndex < 0 ?
+            bulkSiteWallDistances[iDirection - 1] :
+            distanceToWall[wallDataIndex * (LatticeType::NUMVECTORS - 1) + iDirection - 1];
         }
 
         /**
@@ -449,18 +876,56 @@ namespace hemelb
         // Method should remain protected, intent is to access this information via Site
         inline const util::Vector3D<distribn_t>& GetNormalToWall(site_t iSiteIndex) const
         {
-          return wallNormalAtSite[iSiteIndex];
+          const site_t wallDataIndex = GetWallDataIndex(iSiteIndex);
+          return wallDataIndex < 0 ?
+            bulkSiteWallNormal :
+            wallNormalAtSite[wallDataIndex];
         }
 
+        /**
+         * Get the position of a site's wall distances and normal in distanceToWall and
+         * wallNormalAtSite, which only hold them for the sites outside the bulk collision-type
+         * ranges (unless StoreWallDataAtBulkSites has been called).
+         * @param iSiteIndex
+         * @return The position, or -1 for a site in a bulk range, whose links cross nothing
+         */
+        inline site_t GetWallDataIndex(site_t iSiteIndex) const
+        {
+          if (wallDataAtBulkSites)
+          {
+            return iSiteIndex;
+          }
+          if (iSiteIndex < firstDomainEdgeSite)
+          {
+            return iSiteIndex < midDomainProcCollisions[0] ?
+              -1 :
+              iSiteIndex - midDomainProcCollisions[0];
+          }
+          return iSiteIndex < firstDomainEdgeSite + domainEdgeProcCollisions[0] ?
+            -1 :
+            iSiteIndex - midDomainProcCollisions[0] - domainEdgeProcCollisions[0];
+        }
+
+        /**
+         * Store wall distances and normals for the bulk sites too, starting from the values they
+         * share, so that they can be changed site by site. This is for tests, which give walls
+         * to bulk sites.
+         */
+        void StoreWallDataAtBulkSites();
+
         /**
          * Get a pointer to the fOld array starting at the requested index
          * @param distributionIndex
          * @return
          */
         // Method should remain protected, intent is to access this information via Site
-        distribn_t* GetFOld(site_t distributionIndex)
+        stored_distribn_t* GetFOld(site_t distributionIndex)
         {
+#ifdef HEMELB_USE_COMPRESSED_COLD_SITES
+          return &oldDistributions[distributionIndex - firstStoredDistribution];
+#else
           return &oldDistributions[distributionIndex];
+#endif
         }
 
         /**
@@ -471,9 +936,67 @@ namespace hemelb
          * @return
          */
         // Method should remain protected, intent is to access this information via Site
-        const distribn_t* GetFOld(site_t distributionIndex) const
+        const stored_distribn_t* GetFOld(site_t distributionIndex) const
         {
+#ifdef HEMELB_USE_COMPRESSED_COLD_SITES
+          return &oldDistributions[distributionIndex - firstStoredDistribution];
+#else
           return &oldDistributions[distributionIndex];
+#endif
+        }
+
+        /**
+         * Get a distribution from fOld by its index, whether it's stored there or, with
+         * HEMELB_USE_COMPRESSED_COLD_SITES, one of a compressed site's.
+         * @param distributionIndex
+         * @return
+         */
+        // Method should remain protected, intent is to access this information via Site
+        template<typename LatticeType>
+        distribn_t GetFOldValue(site_t distributionIndex) const
+        {
+#ifdef HEMELB_USE_COMPRESSED_COLD_SITES
+          if (distributionIndex < firstStoredDistribution)
+          {
+            return oldCompressed.Get<LatticeType>(distributionIndex / LatticeType::NUMVECTORS,
+                                                  distributionIndex % LatticeType::NUMVECTORS);
+          }
+#endif
+          return *GetFOld(distributionIndex);
+        }
+
+        /**
+         * Non-templated version of GetFOldValue, for when you haven't got a lattice type handy.
+         * @param distributionIndex
+         * @return
+         */
+        distribn_t GetFOldValue(site_t distributionIndex) const
+        {
+#ifdef HEMELB_USE_COMPRESSED_COLD_SITES
+          if (distributionIndex < firstStoredDistribution)
+          {
+            return oldCompressed.Get(distributionIndex / latticeInfo.GetNumVectors(),
+                                     distributionIndex % latticeInfo.GetNumVectors());
+          }
+#endif
+          return *GetFOld(distributionIndex);
+        }
+
+        /**
+         * Where the distribution GetFOldValue gets is, to prefetch it.
+         * @param distributionIndex
+         * @return
+         */
+        template<typename LatticeType>
+        const void* GetFOldAddress(site_t distributionIndex) const
+        {
+#ifdef HEMELB_USE_COMPRESSED_COLD_SITES
+          if (distributionIndex < firstStoredDistribution)
+          {
+            return oldCompressed.GetAddress(distributionIndex / LatticeType::NUMVECTORS);
+          }
+#endif
+          return GetFOld(distributionIndex);
         }
 
         /*
@@ -486,8 +1009,23 @@ namespace hemelb
         template<typename LatticeType>
         site_t GetStreamedIndex(site_t iSiteIndex, unsigned int iDirectionIndex) const
         {
-          return neighbourIndices[iSiteIndex * LatticeType::NUMVECTORS + iDirectionIndex];
+          return neighbourIndices[GetDistributionIndex<LatticeType>(iSiteIndex, iDirectionIndex)];
+        }
+
+#ifdef HEMELB_USE_PULL_STREAMING
+        /*
+         * This returns the index in fOld of the distribution that streams to the site in the
+         * direction, as its neighbour stored it after colliding: that of the neighbour behind the
+         * site in the direction, of the same direction; a received one if the neighbour is on
+         * another processor; or, where there's no fluid neighbour, the site's own distribution
+         * in the opposite direction, bounced back.
+         */
+        template<typename LatticeType>
+        site_t GetPulledIndex(site_t iSiteIndex, unsigned int iDirectionIndex) const
+        {
+          return pulledIndices[GetDistributionIndex<LatticeType>(iSiteIndex, iDirectionIndex)];
         }
+#endif
 
         /**
          * Get the site data object for the given index.
@@ -515,30 +1053,53 @@ namespace hemelb
         // Method should remain protected, intent is to access this information via Site
         const distribn_t * GetCutDistances(site_t iSiteIndex) const
         {
-          return &distanceToWall[iSiteIndex * (latticeInfo.GetNumVectors() - 1)];
+          const site_t wallDataIndex = GetWallDataIndex(iSiteIndex);
+          return wallDataIndex < 0 ?
+            &bulkSiteWallDistances[0] :
+            &distanceToWall[wallDataIndex * (latticeInfo.GetNumVectors() - 1)];
         }
 
+        // A bulk site's values are shared with every other bulk site, so mustn't be changed
+        // through this.
         distribn_t * GetCutDistances(site_t iSiteIndex)
         {
-          return &distanceToWall[iSiteIndex * (latticeInfo.GetNumVectors() - 1)];
+          const site_t wallDataIndex = GetWallDataIndex(iSiteIndex);
+          return wallDataIndex < 0 ?
+            &bulkSiteWallDistances[0] :
+            &distanceToWall[wallDataIndex * (latticeInfo.GetNumVectors() - 1)];
         }
 
         // Method should remain protected, intent is to access this information via Site
         util::Vector3D<distribn_t>& GetNormalToWall(site_t iSiteIndex)
         {
-          return wallNormalAtSite[iSiteIndex];
+          const site_t wallDataIndex = GetWallDataIndex(iSiteIndex);
+          return wallDataIndex < 0 ?
+            bulkSiteWallNormal :
+            wallNormalAtSite[wallDataIndex];
         }
 
         /**
-         * Get the global site coordinates from a contiguous site id.
+         * Get the global site coordinates from a contiguous site id. These are worked out from
+         * the site's block and position in it each time, rather than stored.
          * @param siteIndex
          * @return
          */
-        inline const util::Vector3D<site_t>& GetGlobalSiteCoords(site_t siteIndex) const
+        inline util::Vector3D<site_t> GetGlobalSiteCoords(site_t siteIndex) const
         {
-          return globalSiteCoords[siteIndex];
+          const site_t location = siteLocations[siteIndex];
+          const site_t blockNumber = location >> SiteLocationBits;
+          const site_t siteId = location & ( (site_t(1) << SiteLocationBits) - 1);
+
+          const site_t blockIJ = blockNumber / blockCounts.z;
+          const site_t siteIJ = siteId / blockSize;
+          return util::Vector3D<site_t>( (blockIJ / blockCounts.y) * blockSize + siteIJ / blockSize,
+                                        (blockIJ % blockCounts.y) * blockSize + siteIJ % blockSize,
+                                        (blockNumber % blockCounts.z) * blockSize + siteId % blockSize);
         }
 
+        //! The bits of a site location that hold the site's index within its block.
+        static const unsigned SiteLocationBits = 16;
+
         // Variables are listed here in approximate order of initialisation.
         // Note that all data is ordered in increasing order of collision type, by
         // midDomain (all neighbours on this core) then domainEdge (some neighbours on
@@ -555,26 +1116,71 @@ namespace hemelb
         site_t blockCount;
 
         site_t totalSharedFs; //! Number of local distributions shared with neighbouring processors.
+        bool distributionsAllocated; //! Whether the distributions have been allocated, which they always are for simulating.
         std::vector<NeighbouringProcessor> neighbouringProcs; //! Info about processors with neighbouring fluid sites.
+        std::unordered_map<proc_t, size_t> neighbourIdForRank; //! The index in neighbouringProcs of each neighbouring processor's rank.
 
         site_t midDomainProcCollisions[COLLISION_TYPES]; //! Number of fluid sites with all fluid neighbours on this rank, for each collision type.
         site_t domainEdgeProcCollisions[COLLISION_TYPES]; //! Number of fluid sites with at least one fluid neighbour on another rank, for each collision type.
+        site_t midDomainStabilisedCount; //! Number of mid-domain bulk sites in the stabilised regions, at the end of their range.
+        site_t domainEdgeStabilisedCount; //! Number of domain-edge bulk sites in the stabilised regions, at the end of their range.
+        site_t compressedSiteCount; //! Number of mid-domain bulk sites whose distributions are kept compressed, at the start of their range.
+        site_t firstStoredDistribution; //! The index of the first distribution kept in the distributions arrays, after the compressed sites'.
         site_t localFluidSites; //! The number of local fluid sites.
-        std::vector<distribn_t> oldDistributions; //! The distribution values for the previous time step.
-        std::vector<distribn_t> newDistributions; //! The distribution values for the next time step.
-        std::vector<Block> blocks; //! Data where local fluid sites are stored contiguously.
-
-        std::vector<distribn_t> distanceToWall; //! Hold the distance to the wall for each fluid site.
-        std::vector<util::Vector3D<site_t> > globalSiteCoords; //! Hold the global site coordinates for each contiguous site.
-        std::vector<util::Vector3D<distribn_t> > wallNormalAtSite; //! Holds the wall normal near the fluid site, where appropriate
+        std::vector<stored_distribn_t, util::LatticeAllocator<stored_distribn_t> > oldDistributions; //! The distribution values for the previous time step.
+        std::vector<stored_distribn_t, util::LatticeAllocator<stored_distribn_t> > newDistributions; //! The distribution values for the next time step.
+#ifdef HEMELB_USE_COMPRESSED_COLD_SITES
+        CompressedDistributions oldCompressed; //! The compressed sites' distributions for the previous time step.
+        CompressedDistributions newCompressed; //! The compressed sites' distributions for the next time step.
+#endif
+        std::vector<Block> blocks; //! Every block; those with no local or neighbouring fluid sites are empty.
+
+        std::vector<distribn_t> distanceToWall; //! The distance to the wall or iolet along each link of each site outside the bulk ranges.
+        std::vector<site_t> siteLocations; //! Each site's block number, shifted up by SiteLocationBits, and index within that block.
+        std::vector<util::Vector3D<distribn_t> > wallNormalAtSite; //! The wall normal at each site outside the bulk ranges, where available.
+        bool wallDataAtBulkSites; //! Whether distanceToWall and wallNormalAtSite have entries for every site.
+        site_t firstDomainEdgeSite; //! The index of the first domain-edge site, after all of the mid-domain ones.
+        std::vector<distribn_t> bulkSiteWallDistances; //! The distances shared by all bulk sites, which are all -1.
+        util::Vector3D<distribn_t> bulkSiteWallNormal; //! The normal shared by all bulk sites, which isn't available.
         std::vector<SiteData> siteData; //! Holds the SiteData for each site.
-        std::vector<site_t> fluidSitesOnEachProcessor; //! Array containing numbers of fluid sites on each processor.
+        std::vector<site_t> fluidSitesOnEachProcessor; //! Numbers of fluid sites on each processor, only on the IO processor for the report.
         site_t totalFluidSites; //! The total number of fluid sites in the geometry.
         util::Vector3D<site_t> globalSiteMins, globalSiteMaxes; //! The minimal and maximal coordinates of any fluid sites.
-        std::vector<site_t> neighbourIndices; //! Data about neighbouring fluid sites.
-        std::vector<site_t> streamingIndicesForReceivedDistributions; //! The indices to stream to for distributions received from other processors.
+        std::vector<streaming_index_t, util::LatticeAllocator<streaming_index_t> > neighbourIndices; //! Data about neighbouring fluid sites.
+        std::vector<streaming_index_t> streamingIndicesForReceivedDistributions; //! The indices to stream to for distributions received from other processors.
+#ifdef HEMELB_USE_PULL_STREAMING
+        std::vector<streaming_index_t, util::LatticeAllocator<streaming_index_t> > pulledIndices; //! The inverse of neighbourIndices: where each distribution is pulled from.
+#endif
+        std::vector<WallLink> wallLinks; //! The links of the local fluid sites that cross the wall, ordered by site.
+        std::vector<LinkPatternRange> linkPatternRanges; //! The runs of local fluid sites with the same wall and iolet links and iolet, ordered by site.
         neighbouring::NeighbouringLatticeData *neighbouringData;
         const net::IOCommunicator& comms;
+
+#ifdef HEMELB_USE_NEIGHBOURHOOD_COLLECTIVES
+        void InitialiseNeighbourhoodComms();
+
+        net::MpiCommunicator neighbourhoodComms; //! Has an edge to each of the neighbouringProcs.
+        std::vector<int> neighbourhoodCounts; //! The number of shared distributions for each neighbour.
+        std::vector<int> neighbourhoodDisplacements; //! Where each neighbour's block starts in the shared distributions.
+        MPI_Request neighbourhoodRequest;
+#endif
+
+#ifdef HEMELB_USE_SHARED_MEMORY_HALO
+        void InitialiseSharedMemoryHalo();
+        bool IsSharedMemoryNeighbour(size_t neighbourId) const;
+
+        net::MpiCommunicator nodeComms; //! The ranks on this node.
+        MPI_Win haloWindow;
+        stored_distribn_t* haloInbox; //! Distributions from neighbours on this node, for each step parity.
+        site_t haloInboxSize; //! The size of the inbox for one step parity.
+        std::vector<site_t> haloInboxOffsets; //! For each neighbour, where it writes in our inbox or -1 if it's on another node.
+        std::vector<stored_distribn_t*> haloDestinations; //! For each step parity then neighbour, where we write in its inbox.
+        unsigned haloParity;
+#endif
+
+#ifdef HEMELB_USE_INDEXED_HALO_RECEIVE
+        std::vector<MPI_Datatype> haloReceiveTypes; //! For each neighbour, scatters its distributions from the start of fNew to where they stream to.
+#endif
     };
   }
 }
@@ -0,0 +1,48 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_GEOMETRY_LINKPATTERNRANGE_H
+#define HEMELB_GEOMETRY_LINKPATTERNRANGE_H
+
+#include "units.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    /**
+     * A run of consecutive local fluid sites whose links cross the wall and the iolets in the
+     * same directions, and that are at the same iolet. LatticeData keeps a list of these, ordered
+     * by site, covering every local site, so that the boundary streamers can work out which
+     * delegate handles each direction, and look up the iolet's values, once per run rather than
+     * once per site.
+     */
+    struct LinkPatternRange
+    {
+      public:
+        //! Contiguous index of the first site of the run.
+        site_t firstSite;
+
+        //! Number of sites in the run.
+        site_t siteCount;
+
+        //! Which links cross the wall, as in SiteData.
+        uint32_t wallIntersection;
+
+        //! Which links cross an iolet, as in SiteData.
+        uint32_t ioletIntersection;
+
+        //! The id of the iolet the sites are at, as in SiteData.
+        int ioletId;
+
+        bool operator<(const LinkPatternRange& other) const
+        {
+          return firstSite < other.firstSite;
+        }
+    };
+  }
+}
+
+#endif /* HEMELB_GEOMETRY_LINKPATTERNRANGE_H */
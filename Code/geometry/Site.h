@@ -103,6 +103,120 @@ namespace hemelb
           return latticeData.template GetStreamedIndex<LatticeType>(index, direction);
         }
 
+        /**
+         * Get the distributions at this site from the end of the previous timestep as a
+         * contiguous array of LatticeType::NUMVECTORS values. With the default site-major layout
+         * this points straight into fOld and buffer is unused; with the direction-major
+         * (HEMELB_USE_SOA_DISTRIBUTIONS) layout, single precision storage
+         * (HEMELB_USE_SINGLE_PRECISION_DISTRIBUTIONS) or compressed sites
+         * (HEMELB_USE_COMPRESSED_COLD_SITES) the values are gathered into buffer, which must hold
+         * LatticeType::NUMVECTORS values and outlive the returned pointer.
+         *
+         * @param buffer
+         * @return
+         */
+        template<typename LatticeType>
+        inline const distribn_t* GetFOld(distribn_t* buffer) const
+        {
+#ifdef HEMELB_GATHER_SITE_DISTRIBUTIONS
+          for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+          {
+            buffer[direction] =
+                latticeData.template GetFOldValue<LatticeType>(latticeData.template GetDistributionIndex<LatticeType>(index,
+                                                                                                                       direction));
+          }
+          return buffer;
+#else
+          return GetFOld<LatticeType>();
+#endif
+        }
+
+        /**
+         * Get the single distribution at this site in the given direction from the end of the
+         * previous timestep. This works for either distribution layout.
+         *
+         * @param direction
+         * @return
+         */
+        template<typename LatticeType>
+        inline distribn_t GetFOld(Direction direction) const
+        {
+          return latticeData.template GetFOldValue<LatticeType>(latticeData.template GetDistributionIndex<LatticeType>(index,
+                                                                                                                        direction));
+        }
+
+        /**
+         * Get the distribution this site sent in the given direction at the previous timestep,
+         * which is now in fOld: where it streamed to, or with pull streaming the site's own
+         * place. With push streaming it is only known to be this site's if it streamed to another
+         * local fluid site, so this returns false for the other directions.
+         *
+         * @param direction
+         * @param fOld
+         * @return
+         */
+        template<typename LatticeType>
+        inline bool GetSentFOld(Direction direction, distribn_t& fOld) const
+        {
+#ifdef HEMELB_USE_PULL_STREAMING
+          fOld = GetFOld<LatticeType>(direction);
+#else
+          const site_t streamedIndex = GetStreamedIndex<LatticeType>(direction);
+          if (streamedIndex >= latticeData.GetLocalFluidSiteCount() * LatticeType::NUMVECTORS)
+          {
+            return false;
+          }
+          fOld = latticeData.template GetFOldValue<LatticeType>(streamedIndex);
+#endif
+          return true;
+        }
+
+#ifdef HEMELB_USE_PULL_STREAMING
+        /**
+         * Get the distribution that streams to this site in the given direction, from where it
+         * was stored at the end of the previous timestep (see LatticeData::GetPulledIndex).
+         *
+         * @param direction
+         * @return
+         */
+        template<typename LatticeType>
+        inline distribn_t GetPulledFOld(Direction direction) const
+        {
+          return latticeData.template GetFOldValue<LatticeType>(latticeData.template GetPulledIndex<LatticeType>(index,
+                                                                                                                  direction));
+        }
+
+        /**
+         * Where the distribution GetPulledFOld gets is, to prefetch it.
+         *
+         * @param direction
+         * @return
+         */
+        template<typename LatticeType>
+        inline const void* GetPulledFOldAddress(Direction direction) const
+        {
+          return latticeData.template GetFOldAddress<LatticeType>(latticeData.template GetPulledIndex<LatticeType>(index,
+                                                                                                                    direction));
+        }
+#endif
+
+        // Non-templated version of the buffered GetFOld, for when you haven't got a lattice type handy
+        inline const distribn_t* GetFOld(int numvectors, distribn_t* buffer) const
+        {
+#ifdef HEMELB_GATHER_SITE_DISTRIBUTIONS
+          for (Direction direction = 0; direction < (Direction) numvectors; ++direction)
+          {
+            buffer[direction] = latticeData.GetFOldValue(latticeData.GetDistributionIndex(index, direction));
+          }
+          return buffer;
+#else
+          return latticeData.GetFOld(index * numvectors);
+#endif
+        }
+
+#ifndef HEMELB_GATHER_SITE_DISTRIBUTIONS
+        // The following are only available when all distributions of a site are contiguous
+        // distribn_t.
         template<typename LatticeType>
         inline const distribn_t* GetFOld() const
         {
@@ -114,6 +228,7 @@ namespace hemelb
         {
           return latticeData.GetFOld(index * numvectors);
         }
+#endif
 
         inline const SiteData& GetSiteData() const
         {
@@ -125,7 +240,7 @@ namespace hemelb
           return latticeData.GetSiteData(index);
         }
 
-        inline const util::Vector3D<site_t>& GetGlobalSiteCoords() const
+        inline util::Vector3D<site_t> GetGlobalSiteCoords() const
         {
           return latticeData.GetGlobalSiteCoords(index);
         }
@@ -0,0 +1,34 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_GEOMETRY_SITEBOX_H
+#define HEMELB_GEOMETRY_SITEBOX_H
+
+#include "units.h"
+#include "util/Vector3D.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    /**
+     * An axis-aligned box of sites, in the lattice coordinates of the whole geometry, including
+     * the sites on its faces.
+     */
+    struct SiteBox
+    {
+        util::Vector3D<site_t> minimum;
+        util::Vector3D<site_t> maximum;
+
+        bool Contains(const util::Vector3D<site_t>& location) const
+        {
+          return location.x >= minimum.x && location.y >= minimum.y && location.z >= minimum.z
+              && location.x <= maximum.x && location.y <= maximum.y && location.z <= maximum.z;
+        }
+    };
+  }
+}
+
+#endif /* HEMELB_GEOMETRY_SITEBOX_H */
@@ -39,11 +39,18 @@ namespace hemelb
         bool hadInlet = false;
         bool hadOutlet = false;
 
-        // Iterate over each (non-zero) direction
-        for (Direction direction = 1; direction <= readResult.links.size(); ++direction)
+        // Iterate over each (non-zero) direction whose link is cut; the others have no
+        // intersection.
+        const uint32_t cutLinks = readResult.GetCutLinks();
+        for (Direction direction = 1; (cutLinks >> (direction - 1)) != 0; ++direction)
         {
+          if (!readResult.IsCut(direction - 1))
+          {
+            continue;
+          }
+
           // Get the link
-          const GeometrySiteLink& link = readResult.links[direction - 1];
+          const GeometrySiteLink link = readResult.GetLink(direction - 1);
 
           // If it's a wall link, set the bit for this direction
           if (link.type == GeometrySiteLink::WALL_INTERSECTION)
@@ -0,0 +1,37 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_GEOMETRY_WALLLINK_H
+#define HEMELB_GEOMETRY_WALLLINK_H
+
+#include "units.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    /**
+     * A link from a local fluid site that crosses the wall. LatticeData keeps a list of these,
+     * ordered by site index and then by direction, so that the wall streamers can visit just
+     * the wall links of a range of sites.
+     */
+    struct WallLink
+    {
+      public:
+        //! Contiguous index of the fluid site.
+        site_t siteIndex;
+
+        //! Direction of the link from the site.
+        Direction direction;
+
+        bool operator<(const WallLink& other) const
+        {
+          return siteIndex < other.siteIndex || (siteIndex == other.siteIndex && direction < other.direction);
+        }
+    };
+  }
+}
+
+#endif /* HEMELB_GEOMETRY_WALLLINK_H */
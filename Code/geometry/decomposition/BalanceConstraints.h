@@ -0,0 +1,42 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_GEOMETRY_DECOMPOSITION_BALANCECONSTRAINTS_H
+#define HEMELB_GEOMETRY_DECOMPOSITION_BALANCECONSTRAINTS_H
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    namespace decomposition
+    {
+      /**
+       * What ParMetis balances the decomposition's parts by, and how much imbalance it may
+       * leave: the maximum ratio of a part's weight to the mean. The compute cost of the sites
+       * (see SiteWeights) is always balanced; the memory they take is balanced as a second
+       * constraint when it has a tolerance.
+       */
+      struct BalanceConstraints
+      {
+          BalanceConstraints() :
+              computeTolerance(1.001), memoryTolerance(0.0)
+          {
+          }
+
+          bool BalancesMemory() const
+          {
+            return memoryTolerance > 0.0;
+          }
+
+          //! The imbalance allowed in the compute cost.
+          double computeTolerance;
+          //! The imbalance allowed in the memory, or 0 not to balance it.
+          double memoryTolerance;
+      };
+    }
+  }
+}
+
+#endif /* HEMELB_GEOMETRY_DECOMPOSITION_BALANCECONSTRAINTS_H */
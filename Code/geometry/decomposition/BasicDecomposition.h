@@ -8,7 +8,6 @@
 #define HEMELB_GEOMETRY_DECOMPOSITION_BASICDECOMPOSITION_H
 
 #include "geometry/Geometry.h"
-#include "lb/lattices/LatticeInfo.h"
 #include "net/MpiCommunicator.h"
 #include "units.h"
 #include "util/Vector3D.h"
@@ -27,15 +26,15 @@ namespace hemelb
           /**
            * Constructor to populate all fields necessary for a decomposition
            *
-           * NOTE: We need the geometry and fluidSitesOnEachBlock in order to try to keep
-           * contiguous blocks together, and to skip blocks with no fluid sites.
+           * NOTE: We need the geometry and fluidSitesOnEachBlock in order to keep nearby blocks
+           * together, to balance the fluid sites, and to skip blocks with no fluid sites.
            *
            * @param geometry
            * @param communicator
-           * @param fluidSitesOnEachBlock
+           * @param fluidSitesOnEachBlock The number of fluid sites on each block, or their total
+           * weight if that is known, which is then balanced instead.
            */
           BasicDecomposition(const Geometry& geometry,
-                             const lb::lattices::LatticeInfo& latticeInfo,
                              const net::MpiCommunicator& communicator,
                              const std::vector<site_t>& fluidSitesOnEachBlock);
 
@@ -43,16 +42,13 @@ namespace hemelb
            * Does a basic decomposition of the geometry without requiring any communication;
            * produces a vector of the processor assigned to each block.
            *
-           * To make this fast and remove a need to read in the site info about blocks,
-           * we assume that neighbouring blocks with any fluid sites on have lattice links
-           * between them.
+           * The non-empty blocks are put in order along a Hilbert curve through the block
+           * coordinates, and the curve is cut into one piece per processor with about the same
+           * number of fluid sites on each. Because the curve is compact, so are the pieces, so
+           * this is already close to what ParMETIS makes of it and few sites have to move.
            *
-           *  NOTE that the old version of this code used to cope with running on multiple machines,
-           * by decomposing fluid sites over machines, then decomposing over processors within one machine.
-           * To achieve this here, one could use parmetis's "nparts" parameters to first decompose over machines, then
-           * to decompose within machines.
-           *
-           * @param rankForEachBlock A vector with the processor rank each block has been assigned to.
+           * @param procAssignedToEachBlock A vector with the processor rank each block has been
+           * assigned to, -1 for blocks without fluid sites.
            */
           void Decompose(std::vector<proc_t>& procAssignedToEachBlock);
 
@@ -65,52 +61,7 @@ namespace hemelb
           void Validate(std::vector<proc_t>& procAssignedToEachBlock);
 
         private:
-
-          /**
-           * Does the work of dividing blocks up between processors.
-           *
-           * The algorithm iterates over processors (units).
-           * We start by assigning the next unassigned block to the current unit, then growing out
-           * the region by adding new blocks, until the current unit has approximately the right
-           * number of blocks for the given numbers of blocks / units. When adding blocks, we prefer
-           * blocks that are neighbours of blocks already assigned to the current unit.
-           *
-           * @param unitForEachBlock [out] The processor id for each block
-           * @param unassignedBlocks [in] The number of blocks yet to be assigned a processor
-           * @param geometry [in] The geometry we're decomposing
-           * @param unitCount [in] The total number of processors
-           * @param fluidSitesPerBlock [in] The number of fluid sites in each block
-           */
-          void DivideBlocks(std::vector<proc_t>& unitForEachBlock,
-                            site_t unassignedBlocks,
-                            const Geometry& geometry,
-                            const proc_t unitCount,
-                            const std::vector<site_t>& fluidSitesPerBlock);
-
-          /**
-           * Attempt to expand an already connected volume of blocks assigned to one processor
-           * to add additional blocks, already connected to the volume.
-           *
-           * Returns true if the region was expanded.
-           *
-           * @param edgeBlocks
-           * @param expansionBlocks
-           * @param blockAssigned
-           * @param currentUnit
-           * @param unitForEachBlock
-           * @param blocksPerUnit
-           * @return Returns true if the region was expanded.
-           */
-          bool Expand(std::vector<BlockLocation>& expansionBlocks,
-                      std::vector<bool>& blockAssigned,
-                      std::vector<proc_t>& unitForEachBlock,
-                      site_t &blocksOnCurrentUnit,
-                      const std::vector<BlockLocation>& edgeBlocks,
-                      const proc_t currentUnit,
-                      const site_t blocksPerUnit);
-
           const Geometry& geometry; //! The geometry being decomposed.
-          const lb::lattices::LatticeInfo& latticeInfo; //! The lattice to decompose for.
           const net::MpiCommunicator& communicator; //! The communicator object being decomposed over.
           const std::vector<site_t>& fluidSitesOnEachBlock; //! The number of fluid sites on each block in the geometry.
       };
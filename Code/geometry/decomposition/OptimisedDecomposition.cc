@@ -9,6 +9,8 @@
 #include "lb/lattices/D3Q27.h"
 #include "log/Logger.h"
 #include "net/net.h"
+#include "util/HilbertOrder.h"
+#include <algorithm>
 
 namespace hemelb
 {
@@ -19,9 +21,16 @@ namespace hemelb
       OptimisedDecomposition::OptimisedDecomposition(
           reporting::Timers& timers, net::MpiCommunicator& comms, const Geometry& geometry,
           const lb::lattices::LatticeInfo& latticeInfo, const std::vector<proc_t>& procForEachBlock,
-          const std::vector<site_t>& fluidSitesOnEachBlock) :
+          const std::vector<site_t>& fluidSitesOnEachBlock, const SiteWeights& siteWeights,
+          const std::vector<double>& blockCostFactors,
+          const BalanceConstraints& balanceConstraints) :
           timers(timers), comms(comms), geometry(geometry), latticeInfo(latticeInfo),
-              procForEachBlock(procForEachBlock), fluidSitesPerBlock(fluidSitesOnEachBlock)
+              procForEachBlock(procForEachBlock), fluidSitesPerBlock(fluidSitesOnEachBlock),
+              siteWeights(siteWeights), blockCostFactors(blockCostFactors),
+              balanceConstraints(balanceConstraints),
+              constraintCount(balanceConstraints.BalancesMemory() ?
+                2 :
+                1)
       {
         timers[hemelb::reporting::Timers::InitialGeometryRead].Start(); //overall dbg timing
 
@@ -44,6 +53,7 @@ namespace hemelb
         // Populate the adjacency data arrays (for ParMetis) and validate if appropriate
         idx_t localVertexCount = vtxDistribn[comms.Rank() + 1] - vtxDistribn[comms.Rank()];
 
+#ifndef HEMELB_PARTITIONER_HILBERT
         PopulateAdjacencyData(localVertexCount);
 
         if (ShouldValidate())
@@ -52,6 +62,7 @@ namespace hemelb
         }
 
         log::Logger::Log<log::Trace, log::OnePerCore>("Adj length %i", localAdjacencies.size());
+#endif
 
         timers[hemelb::reporting::Timers::InitialGeometryRead].Stop();
 
@@ -66,7 +77,21 @@ namespace hemelb
 
         if (do_decomposition)
         {
-          CallParmetis(localVertexCount);
+          // Initialise the partition vector.
+          partitionVector = std::vector<idx_t>(localVertexCount, comms.Rank());
+
+          // Populate the vertex weight data arrays and print out the number of different fluid
+          // sites on each core
+          PopulateVertexWeightData(localVertexCount);
+
+#if defined(HEMELB_PARTITIONER_HILBERT)
+          CallHilbertPartitioner(localVertexCount);
+#elif defined(HEMELB_NODE_AWARE_DECOMPOSITION)
+          CallNodeAwareParmetis(localVertexCount);
+#else
+          CallParmetis(localVertexCount,
+                       std::vector<real_t>(comms.Size(), (real_t) (1.0) / (real_t) (comms.Size())));
+#endif
           timers[hemelb::reporting::Timers::parmetis].Stop();
           log::Logger::Log<log::Debug, log::OnePerCore>("Parmetis has finished.");
 
@@ -86,7 +111,8 @@ namespace hemelb
         timers[hemelb::reporting::Timers::PopulateOptimisationMovesList].Stop();
       }
 
-      void OptimisedDecomposition::CallParmetis(idx_t localVertexCount)
+      void OptimisedDecomposition::CallParmetis(idx_t localVertexCount,
+                                                std::vector<real_t> partWeights)
       {
         // From the ParMETIS documentation:
         // --------------------------------
@@ -110,23 +136,12 @@ namespace hemelb
         // part[ni] will contain the partition vector of the locally-stored vertices
         // comm* is a pointer to the MPI communicator of the processes involved
 
-        // Initialise the partition vector.
-        partitionVector = std::vector<idx_t>(localVertexCount, comms.Rank());
-
-        // Weight all vertices evenly.
-        //std::vector < idx_t > vertexWeight(localVertexCount, 1);
-
-        // Populate the vertex weight data arrays (for ParMetis) and print out the number of different fluid sites on each core
-        PopulateVertexWeightData(localVertexCount);
-
-        // Set the weights of each partition to be even, and to sum to 1.
-        idx_t desiredPartitionSize = comms.Size();
-
-        std::vector<real_t> domainWeights(desiredPartitionSize,
-                                          (real_t) (1.0) / ((real_t) (desiredPartitionSize)));
+        idx_t desiredPartitionSize = partWeights.size();
         // A bunch of values ParMetis needs.
-        idx_t noConstraints = 1;
-        idx_t weightFlag = 2;
+        idx_t noConstraints = constraintCount;
+        idx_t weightFlag = edgeWeights.empty() ?
+          2 :
+          3;
         idx_t numberingFlag = 0;
         idx_t edgesCut = 0;
         idx_t nDims = 3;
@@ -147,7 +162,23 @@ namespace hemelb
           // info on remappining (64)
           options[1] = 1 | 2 | 4 | 8 | 32 | 64;
         }
-        real_t tolerance = 1.001F;
+        // Each part takes the same fraction of every weight.
+        std::vector<real_t> constraintPartWeights;
+        constraintPartWeights.reserve(desiredPartitionSize * constraintCount);
+        for (idx_t part = 0; part < desiredPartitionSize; ++part)
+        {
+          constraintPartWeights.insert(constraintPartWeights.end(),
+                                       constraintCount,
+                                       partWeights[part]);
+        }
+        std::vector<real_t> tolerances(1, (real_t) balanceConstraints.computeTolerance);
+        if (balanceConstraints.BalancesMemory())
+        {
+          tolerances.push_back((real_t) balanceConstraints.memoryTolerance);
+          log::Logger::Log<log::Info, log::Singleton>("Balancing compute within %.3f and memory within %.3f",
+                                                      balanceConstraints.computeTolerance,
+                                                      balanceConstraints.memoryTolerance);
+        }
         log::Logger::Log<log::Debug, log::OnePerCore>("Calling ParMetis");
         // Reserve 1 on these vectors so that the reference to their first element
         // exists (even if it's unused).
@@ -157,18 +188,19 @@ namespace hemelb
         adjacenciesPerVertex.reserve(1);
         localAdjacencies.reserve(1);
         vertexWeights.reserve(1);
+        edgeWeights.reserve(1);
         MPI_Comm communicator = comms;
         ParMETIS_V3_PartKway(&vtxDistribn[0],
                              &adjacenciesPerVertex[0],
                              &localAdjacencies[0],
                              &vertexWeights[0],
-                             NULL,
+                             &edgeWeights[0],
                              &weightFlag,
                              &numberingFlag,
                              &noConstraints,
                              &desiredPartitionSize,
-                             &domainWeights[0],
-                             &tolerance,
+                             &constraintPartWeights[0],
+                             &tolerances[0],
                              options,
                              &edgesCut,
                              &partitionVector[0],
@@ -178,7 +210,7 @@ namespace hemelb
         if (comms.Rank() == comms.Size() - 1)
         {
           log::Logger::Log<log::Info, log::OnePerCore>("ParMetis cut %d edges.", edgesCut);
-          if (edgesCut < 1 && comms.Size() > 2)
+          if (edgesCut < 1 && desiredPartitionSize > 2)
           {
             throw Exception()
                 << "The decomposition using ParMetis returned an edge cut of 0 even though there are multiple processes. "
@@ -187,11 +219,204 @@ namespace hemelb
         }
       }
 
+      void OptimisedDecomposition::CallHilbertPartitioner(idx_t localVertexCount)
+      {
+        // Every site has a position along a Hilbert curve through the whole geometry. We cut the
+        // curve into as many pieces as there are cores, each with the same total site weight,
+        // and give each core the sites on one piece. The pieces are compact because the curve
+        // is, and no adjacency graph is needed.
+        std::vector<std::vector<proc_t> > ranks(1);
+#ifdef HEMELB_NODE_AWARE_DECOMPOSITION
+        // Give consecutive pieces to the cores on the same node, so most of the cut between
+        // them is within nodes.
+        std::vector<std::vector<proc_t> > ranksOnEachNode = GetRanksOnEachNode();
+        for (size_t node = 0; node < ranksOnEachNode.size(); ++node)
+        {
+          ranks[0].insert(ranks[0].end(), ranksOnEachNode[node].begin(), ranksOnEachNode[node].end());
+        }
+#else
+        for (proc_t rank = 0; rank < comms.Size(); ++rank)
+        {
+          ranks[0].push_back(rank);
+        }
+#endif
+        SplitAlongHilbertCurve(localVertexCount, std::vector<idx_t>(localVertexCount, 0), ranks);
+      }
+
+      void OptimisedDecomposition::CallNodeAwareParmetis(idx_t localVertexCount)
+      {
+        std::vector<std::vector<proc_t> > ranksOnEachNode = GetRanksOnEachNode();
+        const proc_t nodeCount = ranksOnEachNode.size();
+        log::Logger::Log<log::Info, log::Singleton>("Decomposing over %i nodes, then over the cores of each",
+                                                    nodeCount);
+
+        if (nodeCount == 1 || nodeCount == comms.Size())
+        {
+          // There is only one level.
+          CallParmetis(localVertexCount,
+                       std::vector<real_t>(comms.Size(), (real_t) (1.0) / (real_t) (comms.Size())));
+          return;
+        }
+
+        // First cut the graph into one part per node, weighted by the number of cores on each,
+        // so that ParMetis minimises the edges cut between nodes.
+        std::vector<real_t> nodeWeights(nodeCount);
+        for (proc_t node = 0; node < nodeCount; ++node)
+        {
+          nodeWeights[node] = (real_t) (ranksOnEachNode[node].size()) / (real_t) (comms.Size());
+        }
+        CallParmetis(localVertexCount, nodeWeights);
+
+        // Then share the sites of each node between its cores. Communication within a node is
+        // cheap, so cutting its part along the Hilbert curve is good enough.
+        const std::vector<idx_t> nodeForEachVertex(partitionVector);
+        SplitAlongHilbertCurve(localVertexCount, nodeForEachVertex, ranksOnEachNode);
+      }
+
+      std::vector<std::vector<proc_t> > OptimisedDecomposition::GetRanksOnEachNode() const
+      {
+        // Identify each node by the lowest rank on it.
+        const net::MpiCommunicator nodeComms = comms.SplitShared();
+        const proc_t nodeLeader = nodeComms.AllReduce(comms.Rank(), MPI_MIN);
+        const std::vector<proc_t> leaderForEachRank = comms.AllGather(nodeLeader);
+
+        std::map<proc_t, std::vector<proc_t> > ranksForEachLeader;
+        for (proc_t rank = 0; rank < comms.Size(); ++rank)
+        {
+          ranksForEachLeader[leaderForEachRank[rank]].push_back(rank);
+        }
+
+        std::vector<std::vector<proc_t> > ranksOnEachNode;
+        for (std::map<proc_t, std::vector<proc_t> >::const_iterator node =
+            ranksForEachLeader.begin(); node != ranksForEachLeader.end(); ++node)
+        {
+          ranksOnEachNode.push_back(node->second);
+        }
+        return ranksOnEachNode;
+      }
+
+      void OptimisedDecomposition::SplitAlongHilbertCurve(
+          idx_t localVertexCount, const std::vector<idx_t>& groupForEachVertex,
+          const std::vector<std::vector<proc_t> >& ranksForEachGroup)
+      {
+        const idx_t groupCount = ranksForEachGroup.size();
+
+        // Sort the local sites by group, then along the curve.
+        std::vector<std::pair<std::pair<idx_t, uint64_t>, idx_t> > sortedVertices(localVertexCount);
+        for (idx_t vertex = 0; vertex < localVertexCount; ++vertex)
+        {
+          util::Vector3D<site_t> coords((site_t) vertexCoordinates[3 * vertex],
+                                        (site_t) vertexCoordinates[3 * vertex + 1],
+                                        (site_t) vertexCoordinates[3 * vertex + 2]);
+          sortedVertices[vertex] = std::make_pair(std::make_pair(groupForEachVertex[vertex],
+                                                                 util::GetHilbertKey(coords)),
+                                                  vertex);
+        }
+        std::sort(sortedVertices.begin(), sortedVertices.end());
+
+        // The keys in that order, where each group starts, and the total weight of the local
+        // sites before each position.
+        std::vector<uint64_t> sortedKeys(localVertexCount);
+        std::vector<idx_t> groupStart(groupCount + 1, localVertexCount);
+        std::vector<site_t> weightBefore(localVertexCount + 1, 0);
+        for (idx_t position = localVertexCount - 1; position >= 0; --position)
+        {
+          groupStart[sortedVertices[position].first.first] = position;
+        }
+        for (idx_t group = groupCount - 1; group >= 0; --group)
+        {
+          groupStart[group] = std::min(groupStart[group], groupStart[group + 1]);
+        }
+        for (idx_t position = 0; position < localVertexCount; ++position)
+        {
+          sortedKeys[position] = sortedVertices[position].first.second;
+          weightBefore[position + 1] = weightBefore[position]
+              + vertexWeights[constraintCount * sortedVertices[position].second];
+        }
+
+        std::vector<site_t> localGroupWeights(groupCount);
+        for (idx_t group = 0; group < groupCount; ++group)
+        {
+          localGroupWeights[group] = weightBefore[groupStart[group + 1]]
+              - weightBefore[groupStart[group]];
+        }
+        const std::vector<site_t> groupWeights = comms.AllReduce(localGroupWeights, MPI_SUM);
+
+        // Each group is cut into as many pieces as it has cores. Binary search, over all cores
+        // at once, for the key at which each piece but the first of each group starts: the
+        // smallest key with at least (piece / pieces) of the group's weight before it.
+        std::vector<idx_t> groupForEachSplit;
+        std::vector<site_t> targetForEachSplit;
+        std::vector<idx_t> firstSplitForEachGroup(groupCount + 1, 0);
+        for (idx_t group = 0; group < groupCount; ++group)
+        {
+          const size_t pieces = ranksForEachGroup[group].size();
+          for (size_t piece = 1; piece < pieces; ++piece)
+          {
+            groupForEachSplit.push_back(group);
+            targetForEachSplit.push_back((site_t) ( (double) groupWeights[group] * piece / pieces));
+          }
+          firstSplitForEachGroup[group + 1] = groupForEachSplit.size();
+        }
+
+        const idx_t splitCount = groupForEachSplit.size();
+        std::vector<uint64_t> lowest(splitCount, 0);
+        std::vector<uint64_t> highest(splitCount, uint64_t(1) << 63);
+        std::vector<site_t> localWeightBelow(splitCount);
+        for (unsigned iteration = 0; splitCount > 0 && iteration < 64; ++iteration)
+        {
+          for (idx_t split = 0; split < splitCount; ++split)
+          {
+            const idx_t group = groupForEachSplit[split];
+            const uint64_t middle = lowest[split] + (highest[split] - lowest[split]) / 2;
+            localWeightBelow[split] = weightBefore[std::lower_bound(sortedKeys.begin()
+                                                                        + groupStart[group],
+                                                                    sortedKeys.begin()
+                                                                        + groupStart[group + 1],
+                                                                    middle) - sortedKeys.begin()]
+                - weightBefore[groupStart[group]];
+          }
+          const std::vector<site_t> weightBelow = comms.AllReduce(localWeightBelow, MPI_SUM);
+
+          bool converged = true;
+          for (idx_t split = 0; split < splitCount; ++split)
+          {
+            const uint64_t middle = lowest[split] + (highest[split] - lowest[split]) / 2;
+            if (weightBelow[split] >= targetForEachSplit[split])
+            {
+              highest[split] = middle;
+            }
+            else
+            {
+              lowest[split] = middle + 1;
+            }
+            converged = converged && lowest[split] >= highest[split];
+          }
+
+          if (converged)
+          {
+            break;
+          }
+        }
+
+        // Each site goes to the core for the piece of its group it falls in.
+        for (idx_t position = 0; position < localVertexCount; ++position)
+        {
+          const idx_t group = sortedVertices[position].first.first;
+          const size_t piece = std::upper_bound(lowest.begin() + firstSplitForEachGroup[group],
+                                                lowest.begin() + firstSplitForEachGroup[group + 1],
+                                                sortedKeys[position])
+              - (lowest.begin() + firstSplitForEachGroup[group]);
+          partitionVector[sortedVertices[position].second] = ranksForEachGroup[group][piece];
+        }
+      }
+
       void OptimisedDecomposition::PopulateVertexWeightData(idx_t localVertexCount)
       {
         // These counters will be used later on to count the number of each type of vertex site
         int FluidSiteCounter = 0, WallSiteCounter = 0, IOSiteCounter = 0, WallIOSiteCounter = 0;
         int localweight = 1;
+        const std::vector<int> memoryWeights = GetMemoryWeights();
 
         // For each block (counting up by lowest site id)...
         for (site_t blockI = 0; blockI < geometry.GetBlockDimensions().x; blockI++)
@@ -241,41 +466,60 @@ namespace hemelb
                     //Switch structure which identifies site type and assigns the proper weight to each vertex
 
                     SiteData siteData(blockReadResult.Sites[localSiteId]);
+                    unsigned type = 0;
 
                     switch (siteData.GetCollisionType())
                     {
                       case FLUID:
-                        localweight = hemelbSiteWeights[0];
+                        localweight = siteWeights[0];
+                        type = 0;
                         ++FluidSiteCounter;
                         break;
 
                       case WALL:
-                        localweight = hemelbSiteWeights[1];
+                        localweight = siteWeights[1];
+                        type = 1;
                         ++WallSiteCounter;
                         break;
 
                       case INLET:
-                        localweight = hemelbSiteWeights[2];
+                        localweight = siteWeights[2];
+                        type = 2;
                         ++IOSiteCounter;
                         break;
 
                       case OUTLET:
-                        localweight = hemelbSiteWeights[3];
+                        localweight = siteWeights[3];
+                        type = 3;
                         ++IOSiteCounter;
                         break;
 
                       case (INLET | WALL):
-                        localweight = hemelbSiteWeights[4];
+                        localweight = siteWeights[4];
+                        type = 4;
                         ++WallIOSiteCounter;
                         break;
 
                       case (OUTLET | WALL):
-                        localweight = hemelbSiteWeights[5];
+                        localweight = siteWeights[5];
+                        type = 5;
                         ++WallIOSiteCounter;
                         break;
                     }
 
+                    // Scale by the measured cost of the block's sites, when rebalancing.
+                    if (!blockCostFactors.empty())
+                    {
+                      localweight = std::max(1,
+                                             int(localweight * blockCostFactors[blockNumber]
+                                                 + 0.5));
+                    }
+
                     vertexWeights.push_back(localweight);
+                    if (balanceConstraints.BalancesMemory())
+                    {
+                      vertexWeights.push_back(memoryWeights[type]);
+                    }
                     vertexCoordinates.push_back(blockXCoord + localSiteI);
                     vertexCoordinates.push_back(blockYCoord + localSiteJ);
                     vertexCoordinates.push_back(blockZCoord + localSiteK);
@@ -291,9 +535,9 @@ namespace hemelb
           }
         }
 
-        int TotalCoreWeight = ( (FluidSiteCounter * hemelbSiteWeights[0])
-            + (WallSiteCounter * hemelbSiteWeights[1]) + (IOSiteCounter * hemelbSiteWeights[2])
-            + (WallIOSiteCounter * hemelbSiteWeights[4])) / hemelbSiteWeights[0];
+        int TotalCoreWeight = ( (FluidSiteCounter * siteWeights[0])
+            + (WallSiteCounter * siteWeights[1]) + (IOSiteCounter * siteWeights[2])
+            + (WallIOSiteCounter * siteWeights[4])) / siteWeights[0];
         int TotalSites = FluidSiteCounter + WallSiteCounter + WallIOSiteCounter;
 
         log::Logger::Log<log::Debug, log::OnePerCore>("There are %u Bulk Flow Sites, %u Wall Sites, %u IO Sites, %u WallIO Sites on core %u. Total: %u (Weighted %u Points)",
@@ -306,6 +550,36 @@ namespace hemelb
                                                       TotalCoreWeight);
       }
 
+      std::vector<int> OptimisedDecomposition::GetMemoryWeights() const
+      {
+#ifdef HEMELB_USE_64BIT_STREAMING_INDICES
+        const size_t indexBytes = sizeof(site_t);
+#else
+        const size_t indexBytes = sizeof(uint32_t);
+#endif
+        const size_t directions = latticeInfo.GetNumVectors();
+
+        // Every site has two sets of distributions, a streaming index for each, its location
+        // and its site data. The sites outside the bulk also have the distance to the wall
+        // along each link but the rest vector and a wall normal, and whatever their boundary
+        // conditions keep.
+        const size_t bulkBytes = 2 * directions * sizeof(stored_distribn_t)
+            + directions * indexBytes + sizeof(site_t) + sizeof(SiteData);
+        const size_t edgeBytes = (directions - 1) * sizeof(distribn_t)
+            + sizeof(util::Vector3D<distribn_t>);
+
+        std::vector<int> memoryWeights(COLLISION_TYPES);
+        for (unsigned type = 0; type < COLLISION_TYPES; ++type)
+        {
+          const size_t bytes = bulkBytes + (type == 0 ?
+            0 :
+            edgeBytes + hemelbSiteBoundaryBytes[type]);
+          memoryWeights[type] = int( (bytes + sizeof(stored_distribn_t) - 1)
+              / sizeof(stored_distribn_t));
+        }
+        return memoryWeights;
+      }
+
       void OptimisedDecomposition::PopulateSiteDistribution()
       {
         vtxDistribn.resize(comms.Size() + 1, 0);
@@ -430,6 +704,22 @@ namespace hemelb
 
                       // then add this to the list of adjacencies.
                       localAdjacencies.push_back((idx_t) (neighGlobalSiteId));
+
+                      // An edge along which a wall site reads all of its neighbour's
+                      // distributions costs that much more to cut. The weights of each edge
+                      // must be the same from either end, so both ends are considered.
+                      if (hemelbWallNeedsNeighbourSites)
+                      {
+                        const idx_t neighbourWeight = latticeInfo.GetNumVectors();
+                        edgeWeights.push_back(1
+                            + (NeedsNeighbourAlong(blockReadResult.Sites[m], l) ?
+                              neighbourWeight :
+                              0)
+                            + (NeedsNeighbourAlong(neighbourBlock.Sites[neighbourSiteId],
+                                                   latticeInfo.GetInverseIndex(l)) ?
+                              neighbourWeight :
+                              0));
+                      }
                     }
 
                     // The cumulative count of adjacencies for this vertex is equal to the total
@@ -445,6 +735,15 @@ namespace hemelb
         }
       }
 
+      bool OptimisedDecomposition::NeedsNeighbourAlong(const GeometrySite& site,
+                                                       unsigned direction) const
+      {
+        // Links are indexed by direction, less one.
+        return site.GetLink(direction - 1).type == GeometrySiteLink::NO_INTERSECTION
+            && site.GetLink(latticeInfo.GetInverseIndex(direction) - 1).type
+                == GeometrySiteLink::WALL_INTERSECTION;
+      }
+
       std::vector<idx_t> OptimisedDecomposition::CompileMoveData(
           std::map<site_t, site_t>& blockIdLookupByLastSiteIndex)
       {
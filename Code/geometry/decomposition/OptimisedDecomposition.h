@@ -15,6 +15,8 @@
 #include "net/MpiCommunicator.h"
 #include "geometry/SiteData.h"
 #include "geometry/GeometryBlock.h"
+#include "geometry/decomposition/SiteWeights.h"
+#include "geometry/decomposition/BalanceConstraints.h"
 
 namespace hemelb
 {
@@ -29,7 +31,12 @@ namespace hemelb
                                  const Geometry& geometry,
                                  const lb::lattices::LatticeInfo& latticeInfo,
                                  const std::vector<proc_t>& procForEachBlock,
-                                 const std::vector<site_t>& fluidSitesPerBlock);
+                                 const std::vector<site_t>& fluidSitesPerBlock,
+                                 const SiteWeights& siteWeights = SiteWeights(),
+                                 const std::vector<double>& blockCostFactors =
+                                     std::vector<double>(),
+                                 const BalanceConstraints& balanceConstraints =
+                                     BalanceConstraints());
 
           /**
            * Returns a vector with the number of moves coming from each core
@@ -53,11 +60,19 @@ namespace hemelb
           typedef util::Vector3D<site_t> BlockLocation;
           /**
            * Populates the vector of vertex weights with different values for each local site type.
-           * This allows ParMETIS to more efficiently decompose the system.
+           * This allows ParMETIS to more efficiently decompose the system. When the memory is
+           * balanced too, each vertex has its compute weight then its memory weight.
            *
            * @return
            */
           void PopulateVertexWeightData(idx_t localVertexCount);
+
+          /**
+           * Get the memory weight of a site of each collision type: roughly the bytes the
+           * LatticeData and the boundary conditions keep for it, in units of a distribution.
+           * @return
+           */
+          std::vector<int> GetMemoryWeights() const;
           /**
            * Populates the vertex distribution array in a ParMetis-compatible way. (off-by-1,
            * cumulative count)
@@ -79,13 +94,62 @@ namespace hemelb
            */
           void PopulateAdjacencyData(idx_t localVertexCount);
 
+          /**
+           * Whether the wall boundary condition at a site reads its neighbour in a direction: the
+           * neighbour is fluid and the site has a wall across from it.
+           *
+           * @param site
+           * @param direction
+           * @return
+           */
+          bool NeedsNeighbourAlong(const GeometrySite& site, unsigned direction) const;
+
           /**
            * Perform the call to ParMetis. Returns the result in the partition vector, other
            * parameters are input only. These can't be made const because of the API to ParMetis
            *
            * @param localVertexCount [in] The number of local fluid sites
+           * @param partWeights [in] The fraction of the total weight to put in each part
+           */
+          void CallParmetis(idx_t localVertexCount, std::vector<real_t> partWeights);
+
+          /**
+           * Partition the sites by cutting a Hilbert curve through them into pieces of equal
+           * weight, instead of calling ParMetis. Returns the result in the partition vector.
+           *
+           * @param localVertexCount [in] The number of local fluid sites
+           */
+          void CallHilbertPartitioner(idx_t localVertexCount);
+
+          /**
+           * Partition the sites in two levels: first between the nodes with ParMetis, so as to
+           * minimise the edges cut between nodes, then between the cores of each node along the
+           * Hilbert curve. Returns the result in the partition vector.
+           *
+           * @param localVertexCount [in] The number of local fluid sites
+           */
+          void CallNodeAwareParmetis(idx_t localVertexCount);
+
+          /**
+           * Get the ranks of the cores that share memory, one list per node, in order of the
+           * lowest rank on each node.
+           * @return
+           */
+          std::vector<std::vector<proc_t> > GetRanksOnEachNode() const;
+
+          /**
+           * Cut the local sites of each group into pieces of equal weight along the Hilbert curve,
+           * one piece for each of the group's ranks, and put the rank for each site in the
+           * partition vector.
+           *
+           * @param localVertexCount [in] The number of local fluid sites
+           * @param groupForEachVertex [in] The group of each local fluid site
+           * @param ranksForEachGroup [in] The ranks to share each group's sites between, in order
+           * along the curve
            */
-          void CallParmetis(idx_t localVertexCount);
+          void SplitAlongHilbertCurve(idx_t localVertexCount,
+                                      const std::vector<idx_t>& groupForEachVertex,
+                                      const std::vector<std::vector<proc_t> >& ranksForEachGroup);
 
           /**
            * Populate the list of moves from each proc that we need locally, using the
@@ -211,12 +275,17 @@ namespace hemelb
           const lb::lattices::LatticeInfo& latticeInfo; //! The lattice info to optimise for.
           const std::vector<proc_t>& procForEachBlock; //! The processor assigned to each block at the moment
           const std::vector<site_t>& fluidSitesPerBlock; //! The number of fluid sites on each block.
+          const SiteWeights siteWeights; //! The weight of a site of each collision type.
+          const std::vector<double> blockCostFactors; //! The relative cost of the sites on each block, if measured.
+          const BalanceConstraints balanceConstraints; //! What to balance the parts by, and how closely.
+          const idx_t constraintCount; //! The number of weights on each vertex.
           std::vector<idx_t> vtxDistribn; //! The vertex distribution across participating cores.
           std::vector<idx_t> firstSiteIndexPerBlock; //! The global contiguous index of the first fluid site on each block.
           std::vector<idx_t> adjacenciesPerVertex; //! The number of adjacencies for each local fluid site
-          std::vector<idx_t> vertexWeights; //! The weight of each local fluid site
+          std::vector<idx_t> vertexWeights; //! The weights of each local fluid site, constraintCount of them
           std::vector<real_t> vertexCoordinates; //! The coordinates of each local fluid site
           std::vector<idx_t> localAdjacencies; //! The list of adjacent vertex numbers for each local fluid site
+          std::vector<idx_t> edgeWeights; //! The weight of each adjacency, if the wall boundary condition needs them
           std::vector<idx_t> partitionVector; //! The results of the optimisation -- which core each fluid site should go to.
           std::vector<idx_t> allMoves; //! The list of move counts from each core
           std::vector<idx_t> movesList;
@@ -0,0 +1,125 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "geometry/decomposition/SiteWeights.h"
+#include "geometry/decomposition/DecompositionWeights.h"
+#include "log/Logger.h"
+#include "Exception.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    namespace decomposition
+    {
+      SiteWeights::SiteWeights() :
+          weights(hemelbSiteWeights, hemelbSiteWeights + COLLISION_TYPES), bulkSiteTime(0.0)
+      {
+      }
+
+      SiteWeights SiteWeights::Calibrate(const std::vector<double>& timePerType,
+                                         const std::vector<site_t>& sitesPerType,
+                                         unsigned long steps)
+      {
+        SiteWeights calibrated;
+
+        // Everything is relative to bulk sites, so without any there is nothing to go on.
+        if (sitesPerType[0] == 0 || timePerType[0] <= 0.0)
+        {
+          return calibrated;
+        }
+        const double bulkCostPerSite = timePerType[0] / sitesPerType[0];
+        if (steps > 0)
+        {
+          calibrated.bulkSiteTime = bulkCostPerSite / steps;
+        }
+
+        for (unsigned type = 0; type < COLLISION_TYPES; ++type)
+        {
+          const double relativeCost = sitesPerType[type] == 0
+            ? double(hemelbSiteWeights[type]) / hemelbSiteWeights[0]
+            : timePerType[type] / sitesPerType[type] / bulkCostPerSite;
+
+          calibrated.weights[type] = std::max(1,
+                                              int(std::floor(CalibratedBulkWeight * relativeCost
+                                                  + 0.5)));
+        }
+
+        return calibrated;
+      }
+
+      bool SiteWeights::Load(const std::string& path, const net::MpiCommunicator& comms,
+                             SiteWeights& weights)
+      {
+        // 0 if there is no file, 1 if it was read and -1 if it couldn't be understood.
+        int status = 0;
+        std::vector<int> loaded(COLLISION_TYPES, 0);
+        double loadedBulkSiteTime = 0.0;
+
+        if (comms.Rank() == 0)
+        {
+          std::ifstream weightsFile(path.c_str());
+          if (weightsFile)
+          {
+            status = 1;
+            for (unsigned type = 0; type < COLLISION_TYPES; ++type)
+            {
+              if (! (weightsFile >> loaded[type]) || loaded[type] < 1)
+              {
+                status = -1;
+                break;
+              }
+            }
+            // Files written before the bulk site time was kept don't have it.
+            if (status > 0 && ! (weightsFile >> loadedBulkSiteTime))
+            {
+              loadedBulkSiteTime = 0.0;
+            }
+          }
+        }
+
+        comms.Broadcast(status, 0);
+        if (status < 0)
+        {
+          throw Exception() << "Could not read " << COLLISION_TYPES
+              << " positive site weights from " << path;
+        }
+        if (status == 0)
+        {
+          return false;
+        }
+
+        comms.Broadcast(loaded, 0);
+        comms.Broadcast(loadedBulkSiteTime, 0);
+        weights.weights = loaded;
+        weights.bulkSiteTime = loadedBulkSiteTime;
+        return true;
+      }
+
+      void SiteWeights::Write(const std::string& path) const
+      {
+        std::ofstream weightsFile(path.c_str());
+        for (unsigned type = 0; type < COLLISION_TYPES; ++type)
+        {
+          weightsFile << weights[type] << (type + 1 < COLLISION_TYPES ? " " : "\n");
+        }
+        if (bulkSiteTime > 0.0)
+        {
+          weightsFile.precision(6);
+          weightsFile << std::scientific << bulkSiteTime << "\n";
+        }
+
+        if (!weightsFile)
+        {
+          log::Logger::Log<log::Warning, log::OnePerCore>("Could not save the site weights to %s",
+                                                          path.c_str());
+        }
+      }
+    }
+  }
+}
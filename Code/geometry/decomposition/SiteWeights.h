@@ -0,0 +1,111 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_GEOMETRY_DECOMPOSITION_SITEWEIGHTS_H
+#define HEMELB_GEOMETRY_DECOMPOSITION_SITEWEIGHTS_H
+
+#include <string>
+#include <vector>
+#include "constants.h"
+#include "net/MpiCommunicator.h"
+#include "units.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    namespace decomposition
+    {
+      /**
+       * The weight of a site of each collision type when balancing the decomposition: bulk
+       * flow, wall, inlet, outlet, wall/inlet and wall/outlet, in that order, which is the order
+       * of the collision counts in LatticeData.
+       *
+       * By default these are the compiled-in hemelbSiteWeights for HEMELB_COMPUTE_ARCHITECTURE.
+       * Instead they can be calibrated from the time each collision type actually took in a run
+       * on this machine, and kept in a file for later runs. Calibrated weights also keep the
+       * time a bulk site took to update, so that the time of a step can be predicted.
+       */
+      class SiteWeights
+      {
+        public:
+          /**
+           * The weight of a bulk site in calibrated weights. The other types' weights are in
+           * proportion to their cost per site, so this sets the resolution; it is kept small so
+           * that the total weight of a large geometry still fits in an idx_t.
+           */
+          static const int CalibratedBulkWeight = 10;
+
+          /**
+           * The compiled-in weights.
+           */
+          SiteWeights();
+
+          /**
+           * Calibrate the weights from the time spent on each collision type and the number of
+           * sites of each type, both totalled over all cores. A type without any sites keeps its
+           * compiled-in weight relative to bulk.
+           *
+           * @param timePerType The time spent colliding the sites of each type
+           * @param sitesPerType The number of sites of each type
+           * @param steps The number of time steps the time was spent on, or 0 if not known
+           * @return
+           */
+          static SiteWeights Calibrate(const std::vector<double>& timePerType,
+                                       const std::vector<site_t>& sitesPerType,
+                                       unsigned long steps = 0);
+
+          /**
+           * Load weights saved by Write, on core 0 of the communicator, and share them with the
+           * other cores.
+           *
+           * @param path
+           * @param comms
+           * @param weights [out] The loaded weights, if there were any.
+           * @return False if there is no file at the path.
+           */
+          static bool Load(const std::string& path, const net::MpiCommunicator& comms,
+                           SiteWeights& weights);
+
+          /**
+           * Save the weights as text, one per collision type, then the bulk site time if it is
+           * known. Only call this on one core.
+           *
+           * @param path
+           */
+          void Write(const std::string& path) const;
+
+          int operator[](unsigned collisionType) const
+          {
+            return weights[collisionType];
+          }
+
+          /**
+           * The weights, in collision type order.
+           * @return
+           */
+          const std::vector<int>& GetWeights() const
+          {
+            return weights;
+          }
+
+          /**
+           * The time one core took to update a bulk site for one step, when calibrated.
+           * @return In seconds, or 0 if not known
+           */
+          double GetBulkSiteTime() const
+          {
+            return bulkSiteTime;
+          }
+
+        private:
+          std::vector<int> weights;
+          double bulkSiteTime;
+      };
+    }
+  }
+}
+
+#endif /* HEMELB_GEOMETRY_DECOMPOSITION_SITEWEIGHTS_H */
@@ -1,4 +1,3 @@
-
 // This file is part of HemeLB and is Copyright (C)
 // the HemeLB team and/or their institutions, as detailed in the
 // file AUTHORS. This software is provided under the terms of the
@@ -6,119 +5,101 @@
 
 #include "geometry/needs/Needs.h"
 #include "log/Logger.h"
-#include "util/utilityFunctions.h"
 
 namespace hemelb
 {
   namespace geometry
   {
-    Needs::Needs(const site_t blockCount,
-                 const std::vector<bool>& readBlock,
-                 const proc_t readingGroupSize,
-                 net::InterfaceDelegationNet & net,
-                 bool shouldValidate_) :
-        procsWantingBlocksBuffer(blockCount), communicator(net.GetCommunicator()), readingGroupSize(readingGroupSize), shouldValidate(shouldValidate_)
+    Needs::Needs(const site_t blockCount, const std::vector<bool>& readBlock,
+                 const proc_t readingGroupSize, const net::MpiCommunicator& comms,
+                 bool shouldValidate) :
+        readingGroupSize(readingGroupSize), rank(comms.Rank())
     {
-      // Compile the blocks needed here into an array of indices, instead of an array of bools
-      std::vector<std::vector<site_t> > blocksNeededHere(readingGroupSize);
+      // The blocks needed here, grouped by the core reading them. As the reading cores are
+      // the lowest ranks, that is the order MPI_Alltoallv wants them in.
+      std::vector<int> sendCounts(comms.Size(), 0);
       for (site_t block = 0; block < blockCount; ++block)
       {
         if (readBlock[block])
         {
-          blocksNeededHere[GetReadingCoreForBlock(block)].push_back(block);
+          ++sendCounts[GetReadingCoreForBlock(block)];
         }
       }
-
-      // Share the counts of needed blocks
-      int blocksNeededSize[readingGroupSize];
-      std::vector<int> blocksNeededSizes(communicator.Size());
-
-      for (proc_t readingCore = 0; readingCore < readingGroupSize; readingCore++)
+      std::vector<int> sendStarts(comms.Size(), 0);
+      for (proc_t core = 1; core < comms.Size(); ++core)
       {
-        blocksNeededSize[readingCore] = blocksNeededHere[readingCore].size();
-        net.RequestGatherSend(blocksNeededSize[readingCore], readingCore);
-
+        sendStarts[core] = sendStarts[core - 1] + sendCounts[core - 1];
       }
-      if (communicator.Rank() < readingGroupSize)
+      const site_t needsSent = sendStarts[comms.Size() - 1] + sendCounts[comms.Size() - 1];
+      std::vector<site_t> blocksNeededHere(needsSent);
+      for (site_t block = 0; block < blockCount; ++block)
       {
-        net.RequestGatherReceive(blocksNeededSizes);
+        if (readBlock[block])
+        {
+          blocksNeededHere[sendStarts[GetReadingCoreForBlock(block)]++] = block;
+        }
       }
-      net.Dispatch();
-      // Communicate the arrays of needed blocks
 
-      for (proc_t readingCore = 0; readingCore < readingGroupSize; readingCore++)
+      // The blocks needed from here by each core, in rank order.
+      const std::vector<int> receiveCounts = comms.AllToAll(sendCounts);
+      const std::vector<site_t> blocksNeededFromHere = comms.AllToAllV(blocksNeededHere,
+                                                                       sendCounts,
+                                                                       receiveCounts);
+
+      // Transpose those into the cores needing each block read here. The blocks read here are
+      // every readingGroupSize-th, from this rank's.
+      const site_t blocksReadHere = rank < readingGroupSize ?
+        (blockCount - rank + readingGroupSize - 1) / readingGroupSize :
+        0;
+      rowStarts.assign(blocksReadHere + 1, 0);
+      for (size_t need = 0; need < blocksNeededFromHere.size(); ++need)
       {
-        net.RequestGatherVSend(blocksNeededHere[readingCore], readingCore);
+        ++rowStarts[blocksNeededFromHere[need] / readingGroupSize + 1];
       }
-
-      std::vector<site_t> blocksNeededOn;
-
-      if (communicator.Rank() < readingGroupSize)
+      for (site_t row = 0; row < blocksReadHere; ++row)
       {
-        net.RequestGatherVReceive(blocksNeededOn, blocksNeededSizes);
+        rowStarts[row + 1] += rowStarts[row];
       }
-      net.Dispatch();
-      if (communicator.Rank() < readingGroupSize)
+      procsWantingBlocks.resize(blocksNeededFromHere.size());
+      std::vector<site_t> nextInRow(rowStarts.begin(), rowStarts.end() - 1);
+      size_t need = 0;
+      for (proc_t sendingCore = 0; sendingCore < comms.Size(); ++sendingCore)
       {
-        int needsPassed = 0;
-        // Transpose the blocks needed on cores matrix
-        for (proc_t sendingCore = 0; sendingCore < communicator.Size(); sendingCore++)
+        for (int count = 0; count < receiveCounts[sendingCore]; ++count, ++need)
         {
-          for (int needForThisSendingCore = 0; needForThisSendingCore < blocksNeededSizes[sendingCore];
-              ++needForThisSendingCore)
-          {
-            procsWantingBlocksBuffer[blocksNeededOn[needsPassed]].push_back(sendingCore);
-
-            ++needsPassed;
-          }
-        } //for sendingCore
-      } //if a reading core
+          procsWantingBlocks[nextInRow[blocksNeededFromHere[need] / readingGroupSize]++] =
+              sendingCore;
+        }
+      }
 
-      // If in debug mode, also reduce the old-fashioned way, and check these are the same.
       if (shouldValidate)
       {
-        Validate(blockCount, readBlock);
+        Validate(comms, needsSent);
       }
     }
 
-    void Needs::Validate(const site_t blockCount, const std::vector<bool>& readBlock)
+    std::vector<proc_t> Needs::ProcessorsNeedingBlock(const site_t block) const
     {
-      for (site_t block = 0; block < blockCount; ++block)
+      if (GetReadingCoreForBlock(block) != rank)
       {
-        int neededHere = readBlock[block];
-        proc_t readingCore = GetReadingCoreForBlock(block);
-        std::vector<int> procsWantingThisBlockBuffer = communicator.Gather(neededHere, readingCore);
-
-        if (communicator.Rank() == readingCore)
-        {
+        return std::vector<proc_t>();
+      }
+      const site_t row = block / readingGroupSize;
+      return std::vector<proc_t>(procsWantingBlocks.begin() + rowStarts[row],
+                                 procsWantingBlocks.begin() + rowStarts[row + 1]);
+    }
 
-          for (proc_t needingProcOld = 0; needingProcOld < communicator.Size(); needingProcOld++)
-          {
-            bool found = false;
-            for (std::vector<proc_t>::iterator needingProc = procsWantingBlocksBuffer[block].begin();
-                needingProc != procsWantingBlocksBuffer[block].end(); needingProc++)
-            {
-              if (*needingProc == needingProcOld)
-              {
-                found = true;
-              }
-            }
-            if (found && (!procsWantingThisBlockBuffer[needingProcOld]))
-            {
-              log::Logger::Log<log::Critical, log::OnePerCore>("Was not expecting block %i to be needed on proc %i, but was",
-                                                            block,
-                                                            needingProcOld);
-            }
-            if ( (!found) && procsWantingThisBlockBuffer[needingProcOld] && (needingProcOld != readingCore))
-            {
-              log::Logger::Log<log::Critical, log::OnePerCore>("Was expecting block %i to be needed on proc %i, but was not",
-                                                            block,
-                                                            needingProcOld);
-            } //if problem
-          } // for old proc
-        } // if reading group
-      } // for blocks
-    } //constructor
+    void Needs::Validate(const net::MpiCommunicator& comms, const site_t needsSent) const
+    {
+      const site_t totalSent = comms.AllReduce(needsSent, MPI_SUM);
+      const site_t totalReceived = comms.AllReduce(site_t(procsWantingBlocks.size()), MPI_SUM);
+      if (totalSent != totalReceived)
+      {
+        log::Logger::Log<log::Critical, log::OnePerCore>("%li block needs were sent to the reading cores, but %li arrived",
+                                                         totalSent,
+                                                         totalReceived);
+      }
+    }
 
     proc_t Needs::GetReadingCoreForBlock(const site_t blockNumber) const
     {
@@ -1,4 +1,3 @@
-
 // This file is part of HemeLB and is Copyright (C)
 // the HemeLB team and/or their institutions, as detailed in the
 // file AUTHORS. This software is provided under the terms of the
@@ -7,44 +6,45 @@
 #ifndef HEMELB_GEOMETRY_NEEDS_NEEDS_H
 #define HEMELB_GEOMETRY_NEEDS_NEEDS_H
 #include <vector>
-#include "net/net.h"
-#include "net/IOCommunicator.h"
+#include "units.h"
+#include "net/MpiCommunicator.h"
 namespace hemelb
 {
   namespace geometry
   {
-    /*
-     JH Note: Class created to make the new needs communication strategy in #142 testable.
-     */
     /***
      *  Class defining HemeLB needs communication
      Used by geometry reader to know where to send which blocks.
+
+     Each core sends the ids of the blocks it needs to the cores that read them, all in one
+     MPI_Alltoallv, so the reading cores learn who wants each of their blocks without a
+     collective per block or per reading core. A reading core keeps the cores wanting each of
+     the blocks it reads in compressed rows: the cores for its i-th block are
+     procsWantingBlocks[rowStarts[i]] up to procsWantingBlocks[rowStarts[i + 1]], in ascending
+     order.
      */
     class Needs
     {
       public:
         /***
-         * Constructor for Needs manager.
+         * Constructor for Needs manager. Collective.
          * @param BlockCount Count of blocks
          * @param readBlock Which cores need which blocks, as an array of booleans.
          * @param readingGroupSize Number sof cores to use for reading blocks
-         * @param net Instance of Net communication class to use.
+         * @param comms The cores reading and needing the blocks.
+         * @param shouldValidate Whether to check the needs add up across the cores.
          */
-       Needs(const site_t blockCount,
-                          const std::vector<bool>& readBlock,
-                          const proc_t readingGroupSize,
-                          net::InterfaceDelegationNet &net,
-                          bool shouldValidate); // Temporarily during the refactor, constructed just to abstract the block sharing bit
+        Needs(const site_t blockCount, const std::vector<bool>& readBlock,
+              const proc_t readingGroupSize, const net::MpiCommunicator& comms,
+              bool shouldValidate);
 
         /***
-         * Which processors need a given block?
+         * Which processors need a given block? Only known on the core reading it.
          * @param block Block number to query
-         * @return Vector of ranks in the decomposition topology which need this block
+         * @return Vector of ranks in the decomposition topology which need this block, or
+         * nothing if this core doesn't read it.
          */
-        const std::vector<proc_t> & ProcessorsNeedingBlock(const site_t &block) const
-        {
-          return procsWantingBlocksBuffer[block];
-        }
+        std::vector<proc_t> ProcessorsNeedingBlock(const site_t block) const;
 
         /***
          * Which core should be responsible for reading a given block? This core does not necessarily
@@ -55,11 +55,18 @@ namespace hemelb
          */
         proc_t GetReadingCoreForBlock(const site_t blockNumber) const;
       private:
-        std::vector<std::vector<proc_t> > procsWantingBlocksBuffer;
-        const net::MpiCommunicator & communicator;
+        /***
+         * Check that as many needs arrived at the reading cores as were sent. Collective.
+         * @param comms
+         * @param needsSent The number of blocks this core needs.
+         */
+        void Validate(const net::MpiCommunicator& comms, const site_t needsSent) const;
+
         const proc_t readingGroupSize;
-        bool shouldValidate;
-        void Validate(const site_t blockCount, const std::vector<bool>& readBlock);
+        const proc_t rank;
+        //! For each block read here and one past the last, where its cores start.
+        std::vector<site_t> rowStarts;
+        std::vector<proc_t> procsWantingBlocks;
     };
   }
 }
@@ -4,8 +4,6 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
-#include <algorithm>
-
 #include "geometry/neighbouring/NeighbouringDataManager.h"
 #include "geometry/LatticeData.h"
 
@@ -16,26 +14,62 @@ namespace hemelb
   {
     namespace neighbouring
     {
+      namespace
+      {
+        /**
+         * @param directions
+         * @param numVectors
+         * @return Whether the directions include every one of the lattice's.
+         */
+        bool IsEveryDirection(uint32_t directions, unsigned numVectors)
+        {
+          const uint32_t every = (uint32_t(1) << numVectors) - 1;
+          return (directions & every) == every;
+        }
+
+        /**
+         * @param directions
+         * @param numVectors
+         * @return The number of the lattice's directions in the directions.
+         */
+        unsigned CountDirections(uint32_t directions, unsigned numVectors)
+        {
+          unsigned count = 0;
+          for (Direction direction = 0; direction < numVectors; ++direction)
+          {
+            count += (directions >> direction) & 1;
+          }
+          return count;
+        }
+      }
 
       NeighbouringDataManager::NeighbouringDataManager(
           const LatticeData & localLatticeData, NeighbouringLatticeData & neighbouringLatticeData,
           net::InterfaceDelegationNet & net) :
           localLatticeData(localLatticeData), neighbouringLatticeData(neighbouringLatticeData),
-              net(net), needsEachProcHasFromMe(net.Size()),
-              needsHaveBeenShared(false)
+              net(net), needsEachProcHasFromMe(net.Size()), localIdsEachProcNeedsFromMe(net.Size()),
+              directionsEachProcNeedsFromMe(net.Size()), needsHaveBeenShared(false)
       {
       }
       void NeighbouringDataManager::RegisterNeededSite(site_t globalId,
                                                        RequiredSiteInformation requirements)
       {
-        //ignore the requirements, we require everying.
-        if (std::find(neededSites.begin(), neededSites.end(), globalId) == neededSites.end())
+        // All the non-field-dependent information is transferred, so only the directions of
+        // the distributions are kept.
+        std::pair<util::HashMap<site_t, size_t>::iterator, bool> inserted =
+            neededSiteIndices.insert(std::make_pair(globalId, neededSites.size()));
+        if (inserted.second)
         {
           neededSites.push_back(globalId);
+          directionsForEachNeededSite.push_back(requirements.GetRequiredDirections());
+          // Make room now, so the data doesn't move while messages are being received into it.
+          neighbouringLatticeData.AddSite(globalId);
         }
         else
         {
           // Merge requirements.
+          directionsForEachNeededSite[inserted.first->second] |=
+              requirements.GetRequiredDirections();
         }
       }
 
@@ -50,11 +84,10 @@ namespace hemelb
         // on the sending and receiving procs.
         // But, the needsEachProcHasFromMe is always ordered,
         // by the same order, as the neededSites, so this should be OK.
-        for (std::vector<site_t>::iterator localNeed = neededSites.begin();
-            localNeed != neededSites.end(); localNeed++)
+        for (size_t need = 0; need < neededSites.size(); need++)
         {
-          proc_t source = ProcForSite(*localNeed);
-          NeighbouringSite site = neighbouringLatticeData.GetSite(*localNeed);
+          proc_t source = procForEachNeededSite[need];
+          NeighbouringSite site = neighbouringLatticeData.GetSite(neededSites[need]);
 
           net.RequestReceiveR(site.GetSiteData().GetWallIntersectionData(), source);
           net.RequestReceiveR(site.GetSiteData().GetIoletIntersectionData(), source);
@@ -67,15 +100,12 @@ namespace hemelb
         }
         for (proc_t other = 0; other < net.Size(); other++)
         {
-          for (std::vector<site_t>::iterator needOnProcFromMe =
-              needsEachProcHasFromMe[other].begin();
-              needOnProcFromMe != needsEachProcHasFromMe[other].end(); needOnProcFromMe++)
+          for (std::vector<site_t>::iterator localContiguousId =
+              localIdsEachProcNeedsFromMe[other].begin();
+              localContiguousId != localIdsEachProcNeedsFromMe[other].end(); localContiguousId++)
           {
-            site_t localContiguousId =
-                localLatticeData.GetLocalContiguousIdFromGlobalNoncontiguousId(*needOnProcFromMe);
-
             Site<LatticeData> site =
-                const_cast<LatticeData&>(localLatticeData).GetSite(localContiguousId);
+                const_cast<LatticeData&>(localLatticeData).GetSite(*localContiguousId);
             // have to cast away the const, because no respect for const-ness for sends in MPI
             net.RequestSendR(site.GetSiteData().GetWallIntersectionData(), other);
             net.RequestSendR(site.GetSiteData().GetIoletIntersectionData(), other);
@@ -94,6 +124,7 @@ namespace hemelb
       {
         RequestComms();
         net.Dispatch();
+        PostReceive();
       }
 
       void NeighbouringDataManager::RequestComms()
@@ -108,31 +139,100 @@ namespace hemelb
         // on the sending and receiving procs.
         // But, the needsEachProcHasFromMe is always ordered,
         // by the same order, as the neededSites, so this should be OK.
-        for (std::vector<site_t>::iterator localNeed = neededSites.begin();
-            localNeed != neededSites.end(); localNeed++)
+        //
+        // The lists walked here were made once in ShareNeeds, and the buffers don't move between
+        // steps, so every step requests exactly the same comms. The net coalesces them into one
+        // message per process, and the persistent point-to-point implementation also keeps the
+        // requests and derived datatypes for that message from one step to the next.
+        //
+        // A site needed in every direction is received straight into the neighbouring data;
+        // the distributions of one needed in only some are packed and unpacked in PostReceive.
+        const unsigned numVectors = localLatticeData.GetLatticeInfo().GetNumVectors();
+        distribn_t* nextPartialReceive =
+            partialReceiveBuffer.empty() ? NULL : &partialReceiveBuffer[0];
+        for (size_t need = 0; need < neededSites.size(); need++)
         {
-          proc_t source = ProcForSite(*localNeed);
-          NeighbouringSite site = neighbouringLatticeData.GetSite(*localNeed);
-          net.RequestReceive(site.GetFOld(localLatticeData.GetLatticeInfo().GetNumVectors()),
-                             localLatticeData.GetLatticeInfo().GetNumVectors(),
-                             source);
-
+          const uint32_t directions = directionsForEachNeededSite[need];
+          if (IsEveryDirection(directions, numVectors))
+          {
+            net.RequestReceive(neighbouringLatticeData.GetDistribution(neededSites[need]),
+                               numVectors,
+                               procForEachNeededSite[need]);
+          }
+          else if (directions != 0)
+          {
+            const unsigned count = CountDirections(directions, numVectors);
+            net.RequestReceive(nextPartialReceive, count, procForEachNeededSite[need]);
+            nextPartialReceive += count;
+          }
         }
+#ifdef HEMELB_GATHER_SITE_DISTRIBUTIONS
+        distribn_t* nextSend = sendBuffer.empty() ? NULL : &sendBuffer[0];
+#endif
+        distribn_t* nextPartialSend = partialSendBuffer.empty() ? NULL : &partialSendBuffer[0];
+        std::vector<distribn_t> fOldBuffer(numVectors);
         for (proc_t other = 0; other < net.Size(); other++)
         {
-          for (std::vector<site_t>::iterator needOnProcFromMe =
-              needsEachProcHasFromMe[other].begin();
-              needOnProcFromMe != needsEachProcHasFromMe[other].end(); needOnProcFromMe++)
+          for (size_t need = 0; need < localIdsEachProcNeedsFromMe[other].size(); need++)
           {
-            site_t localContiguousId =
-                localLatticeData.GetLocalContiguousIdFromGlobalNoncontiguousId(*needOnProcFromMe);
             Site<LatticeData> site =
-                const_cast<LatticeData&>(localLatticeData).GetSite(localContiguousId);
+                const_cast<LatticeData&>(localLatticeData).GetSite(localIdsEachProcNeedsFromMe[other][need]);
+            const uint32_t directions = directionsEachProcNeedsFromMe[other][need];
+            if (!IsEveryDirection(directions, numVectors))
+            {
+              // The buffer persists until the next call, so the send can complete asynchronously.
+              const distribn_t* fOld = site.GetFOld(numVectors, &fOldBuffer[0]);
+              distribn_t* const firstSend = nextPartialSend;
+              for (Direction direction = 0; direction < numVectors; ++direction)
+              {
+                if ( (directions >> direction) & 1)
+                {
+                  *nextPartialSend++ = fOld[direction];
+                }
+              }
+              if (nextPartialSend != firstSend)
+              {
+                net.RequestSend(firstSend, nextPartialSend - firstSend, other);
+              }
+              continue;
+            }
+
+#ifdef HEMELB_GATHER_SITE_DISTRIBUTIONS
+            // The buffer persists until the next call, so the send can complete asynchronously.
+            net.RequestSend(const_cast<distribn_t*>(site.GetFOld(numVectors, nextSend)),
+                            numVectors,
+                            other);
+            nextSend += numVectors;
+#else
             // have to cast away the const, because no respect for const-ness for sends in MPI
-            net.RequestSend(const_cast<distribn_t*>(site.GetFOld(localLatticeData.GetLatticeInfo().GetNumVectors())),
-                            localLatticeData.GetLatticeInfo().GetNumVectors(),
+            net.RequestSend(const_cast<distribn_t*>(site.GetFOld(numVectors)),
+                            numVectors,
                             other);
+#endif
+
+          }
+        }
+      }
 
+      void NeighbouringDataManager::PostReceive()
+      {
+        const unsigned numVectors = localLatticeData.GetLatticeInfo().GetNumVectors();
+        const distribn_t* nextPartialReceive =
+            partialReceiveBuffer.empty() ? NULL : &partialReceiveBuffer[0];
+        for (size_t need = 0; need < neededSites.size(); need++)
+        {
+          const uint32_t directions = directionsForEachNeededSite[need];
+          if (directions == 0 || IsEveryDirection(directions, numVectors))
+          {
+            continue;
+          }
+          distribn_t* distribution = neighbouringLatticeData.GetDistribution(neededSites[need]);
+          for (Direction direction = 0; direction < numVectors; ++direction)
+          {
+            if ( (directions >> direction) & 1)
+            {
+              distribution[direction] = *nextPartialReceive++;
+            }
           }
         }
       }
@@ -145,13 +245,15 @@ namespace hemelb
         
         // build a table of which procs needs can be achieved from which proc
         std::vector<std::vector<site_t> > needsIHaveFromEachProc(net.Size());
+        std::vector<std::vector<uint32_t> > directionsINeedFromEachProc(net.Size());
         std::vector<int> countOfNeedsIHaveFromEachProc(net.Size(), 0);
-        for (std::vector<site_t>::iterator localNeed = neededSites.begin();
-            localNeed != neededSites.end(); localNeed++)
+        procForEachNeededSite.resize(neededSites.size());
+        for (size_t need = 0; need < neededSites.size(); need++)
         {
-          needsIHaveFromEachProc[ProcForSite(*localNeed)].push_back(*localNeed);
-          countOfNeedsIHaveFromEachProc[ProcForSite(*localNeed)]++;
-
+          procForEachNeededSite[need] = ProcForSite(neededSites[need]);
+          needsIHaveFromEachProc[procForEachNeededSite[need]].push_back(neededSites[need]);
+          directionsINeedFromEachProc[procForEachNeededSite[need]].push_back(directionsForEachNeededSite[need]);
+          countOfNeedsIHaveFromEachProc[procForEachNeededSite[need]]++;
         }
 
         // every proc must send to all procs, how many it needs from that proc
@@ -168,15 +270,56 @@ namespace hemelb
 
           // now, for every proc, which I need something from,send the ids of those
           net.RequestSendV(needsIHaveFromEachProc[other], other);
+          net.RequestSendV(directionsINeedFromEachProc[other], other);
           // and, for every proc, which needs something from me, receive those ids
           needsEachProcHasFromMe[other].resize(countOfNeedsOnEachProcFromMe[other]);
           net.RequestReceiveV(needsEachProcHasFromMe[other], other);
+          directionsEachProcNeedsFromMe[other].resize(countOfNeedsOnEachProcFromMe[other]);
+          net.RequestReceiveV(directionsEachProcNeedsFromMe[other], other);
           // In principle, this bit could have been implemented as a separate GatherV onto every proc
           // However, in practice, we expect the needs to be basically local
           // so using point-to-point will be more efficient.
         }
 
         net.Dispatch();
+
+        // Look up where the sites the others need are once, rather than on every transfer.
+        const unsigned numVectors = localLatticeData.GetLatticeInfo().GetNumVectors();
+        site_t sendCount = 0;
+        site_t partialSendCount = 0;
+        for (proc_t other = 0; other < netSize; other++)
+        {
+          localIdsEachProcNeedsFromMe[other].resize(needsEachProcHasFromMe[other].size());
+          for (size_t need = 0; need < needsEachProcHasFromMe[other].size(); need++)
+          {
+            localIdsEachProcNeedsFromMe[other][need] =
+                localLatticeData.GetLocalContiguousIdFromGlobalNoncontiguousId(needsEachProcHasFromMe[other][need]);
+            const uint32_t directions = directionsEachProcNeedsFromMe[other][need];
+            if (IsEveryDirection(directions, numVectors))
+            {
+              ++sendCount;
+            }
+            else
+            {
+              partialSendCount += CountDirections(directions, numVectors);
+            }
+          }
+        }
+        site_t partialReceiveCount = 0;
+        for (size_t need = 0; need < neededSites.size(); need++)
+        {
+          if (!IsEveryDirection(directionsForEachNeededSite[need], numVectors))
+          {
+            partialReceiveCount += CountDirections(directionsForEachNeededSite[need], numVectors);
+          }
+        }
+        // Sized once, so the buffers stay put and each step's sends are the same.
+        partialSendBuffer.resize(partialSendCount);
+        partialReceiveBuffer.resize(partialReceiveCount);
+#ifdef HEMELB_GATHER_SITE_DISTRIBUTIONS
+        sendBuffer.resize(sendCount * numVectors);
+#endif
+
         needsHaveBeenShared = true;
       }
     }
@@ -12,8 +12,8 @@
 #include "geometry/neighbouring/RequiredSiteInformation.h"
 #include "net/net.h"
 #include "net/IteratedAction.h"
+#include "util/HashMap.h"
 #include <vector>
-#include <map>
 
 namespace hemelb
 {
@@ -30,11 +30,20 @@ namespace hemelb
           NeighbouringDataManager(const LatticeData & localLatticeData,
                                   NeighbouringLatticeData & neighbouringLatticeData,
                                   net::InterfaceDelegationNet & net);
-          // Initially, the required site information will not be used -- we just transfer everything.
-          // This considerably simplifies matters.
-          // Nevertheless, we provide the interface here in its final form
+          /**
+           * Register a site whose information is needed here. All the non-field-dependent
+           * information is transferred, but only the distributions in the directions required
+           * are; registering a site again requires the directions of both.
+           * @param globalId
+           * @param requirements
+           */
           void RegisterNeededSite(site_t globalId,
                                   RequiredSiteInformation requirements = RequiredSiteInformation(true));
+          /**
+           * Tell every process which of its sites this one needs, and find out which of ours
+           * the others need. The needs mustn't change afterwards: the per-process lists of what
+           * to send and receive are made here, once, so the transfers only have to walk them.
+           */
           void ShareNeeds();
           std::vector<site_t> &GetNeedsForProc(proc_t proc)
           {
@@ -44,19 +53,49 @@ namespace hemelb
           {
             return neededSites;
           }
+          /**
+           * @param proc
+           * @return The directions of the distributions proc needs of each of its needs from me,
+           * as RequiredSiteInformation::GetRequiredDirections.
+           */
+          std::vector<uint32_t> &GetDirectionsForProc(proc_t proc)
+          {
+            return directionsEachProcNeedsFromMe[proc];
+          }
           void TransferNonFieldDependentInformation();
           void TransferFieldDependentInformation();
           // NB this is virtual so that the class can be tested.
           virtual proc_t ProcForSite(site_t site);
         protected:
           void RequestComms();
+          /**
+           * Put the distributions received for the sites needed in only some directions where
+           * they belong.
+           */
+          void PostReceive();
         private:
           const LatticeData & localLatticeData;
           NeighbouringLatticeData & neighbouringLatticeData;
           net::InterfaceDelegationNet & net;
 
           std::vector<site_t> neededSites;
+          //! Where each needed site is in neededSites, by global id.
+          util::HashMap<site_t, size_t> neededSiteIndices;
+          std::vector<proc_t> procForEachNeededSite; //! The process that provides each needed site
+          std::vector<uint32_t> directionsForEachNeededSite; //! The distributions needed of each site
           std::vector<std::vector<site_t> > needsEachProcHasFromMe;
+          //! The local contiguous ids of the sites in needsEachProcHasFromMe.
+          std::vector<std::vector<site_t> > localIdsEachProcNeedsFromMe;
+          //! The distributions each process needs of each of its needs from me.
+          std::vector<std::vector<uint32_t> > directionsEachProcNeedsFromMe;
+          //! The distributions sent and received of the sites needed in only some directions,
+          //! packed, as they aren't contiguous in either place.
+          std::vector<distribn_t> partialSendBuffer;
+          std::vector<distribn_t> partialReceiveBuffer;
+#ifdef HEMELB_GATHER_SITE_DISTRIBUTIONS
+          //! Contiguous copies of the distributions we send, as they aren't contiguous distribn_t in fOld.
+          std::vector<distribn_t> sendBuffer;
+#endif
 
           bool needsHaveBeenShared;
 
@@ -7,6 +7,8 @@
 #include "geometry/neighbouring/NeighbouringLatticeData.h"
 #include "geometry/neighbouring/NeighbouringSite.h"
 #include "log/Logger.h"
+#include "util/utilityFunctions.h"
+#include <algorithm>
 namespace hemelb
 {
   namespace geometry
@@ -15,7 +17,8 @@ namespace hemelb
     {
 
       NeighbouringLatticeData::NeighbouringLatticeData(const lb::lattices::LatticeInfo& latticeInfo) :
-          distributions(), distanceToWall(), wallNormalAtSite(), siteData(), latticeInfo(latticeInfo)
+          slots(), distributions(), distanceToWall(), wallNormalAtSite(), siteData(),
+              latticeInfo(latticeInfo)
       {
       }
 
@@ -25,7 +28,9 @@ namespace hemelb
                                              const util::Vector3D<distribn_t> &normal,
                                              const SiteData & data)
       {
-        GetDistribution(index) = distribution;
+        std::copy(distribution.begin(),
+                  distribution.begin() + latticeInfo.GetNumVectors(),
+                  GetDistribution(index));
         for (unsigned int direction = 0; direction < latticeInfo.GetNumVectors() - 1; direction++)
         {
           GetCutDistances(index)[direction] = distances[direction];
@@ -34,6 +39,16 @@ namespace hemelb
         GetSiteData(index) = data;
       }
 
+      void NeighbouringLatticeData::AddSite(site_t globalIndex)
+      {
+        GetSlot(globalIndex);
+      }
+
+      bool NeighbouringLatticeData::HasSite(site_t globalIndex) const
+      {
+        return FindSlot(globalIndex) >= 0;
+      }
+
       NeighbouringSite NeighbouringLatticeData::GetSite(site_t globalIndex)
       {
         return NeighbouringSite(globalIndex, *this);
@@ -46,55 +61,80 @@ namespace hemelb
 
       const util::Vector3D<distribn_t>& NeighbouringLatticeData::GetNormalToWall(site_t globalIndex) const
       {
-        return wallNormalAtSite.find(globalIndex)->second;
+        return wallNormalAtSite[FindSlot(globalIndex)];
       }
 
       util::Vector3D<distribn_t>& NeighbouringLatticeData::GetNormalToWall(site_t globalIndex)
       {
-        return wallNormalAtSite[globalIndex];
+        return wallNormalAtSite[GetSlot(globalIndex)];
       }
 
       distribn_t* NeighbouringLatticeData::GetFOld(site_t distributionIndex)
       {
         site_t globalIndex = distributionIndex / latticeInfo.GetNumVectors();
         site_t direction = distributionIndex % latticeInfo.GetNumVectors();
-        std::vector<distribn_t> &buffer = distributions[globalIndex];
-        buffer.resize(latticeInfo.GetNumVectors());
-        return &buffer[direction];
+        return GetDistribution(globalIndex) + direction;
       }
 
-      std::vector<distribn_t>& NeighbouringLatticeData::GetDistribution(site_t globalIndex)
+      distribn_t* NeighbouringLatticeData::GetDistribution(site_t globalIndex)
       {
-        return distributions[globalIndex];
+        return &distributions[GetSlot(globalIndex) * latticeInfo.GetNumVectors()];
       }
 
       const distribn_t* NeighbouringLatticeData::GetFOld(site_t distributionIndex) const
       {
         site_t globalIndex = distributionIndex / latticeInfo.GetNumVectors();
         site_t direction = distributionIndex % latticeInfo.GetNumVectors();
-        return &distributions.find(globalIndex)->second[direction];
+        return &distributions[FindSlot(globalIndex) * latticeInfo.GetNumVectors() + direction];
       }
 
       const SiteData & NeighbouringLatticeData::GetSiteData(site_t globalIndex) const
       {
-        return siteData.find(globalIndex)->second;
+        return siteData[FindSlot(globalIndex)];
       }
 
       SiteData& NeighbouringLatticeData::GetSiteData(site_t globalIndex)
       {
-        return siteData[globalIndex];
+        return siteData[GetSlot(globalIndex)];
       }
 
       const distribn_t * NeighbouringLatticeData::GetCutDistances(site_t globalIndex) const
       {
-        return &distanceToWall.find(globalIndex)->second.front();
+        return &distanceToWall[FindSlot(globalIndex) * (latticeInfo.GetNumVectors() - 1)];
       }
 
       distribn_t* NeighbouringLatticeData::GetCutDistances(site_t globalIndex)
       {
-        std::vector<distribn_t> &buffer = distanceToWall[globalIndex];
-        buffer.resize(latticeInfo.GetNumVectors() - 1);
-        return &buffer.front();
+        return &distanceToWall[GetSlot(globalIndex) * (latticeInfo.GetNumVectors() - 1)];
+      }
+
+      site_t NeighbouringLatticeData::FindSlot(site_t globalIndex) const
+      {
+        util::HashMap<site_t, site_t>::const_iterator found = slots.find(globalIndex);
+        return found == slots.end() ?
+          -1 :
+          found->second;
+      }
+
+      site_t NeighbouringLatticeData::GetSlot(site_t globalIndex)
+      {
+        const std::pair<util::HashMap<site_t, site_t>::iterator, bool> inserted =
+            slots.insert(std::make_pair(globalIndex, site_t(siteData.size())));
+        if (inserted.second)
+        {
+          distributions.resize(distributions.size() + latticeInfo.GetNumVectors());
+          distanceToWall.resize(distanceToWall.size() + latticeInfo.GetNumVectors() - 1);
+          wallNormalAtSite.push_back(util::Vector3D<distribn_t>());
+          siteData.push_back(SiteData());
+        }
+        return inserted.first->second;
+      }
+
+      size_t NeighbouringLatticeData::GetMemoryUsage() const
+      {
+        return slots.GetMemoryUsage() + util::VectorBytes(distributions)
+            + util::VectorBytes(distanceToWall) + util::VectorBytes(wallNormalAtSite)
+            + util::VectorBytes(siteData);
       }
 
     }
@@ -6,10 +6,11 @@
 
 #ifndef HEMELB_GEOMETRY_NEIGHBOURING_NEIGHBOURINGLATTICEDATA_H
 #define HEMELB_GEOMETRY_NEIGHBOURING_NEIGHBOURINGLATTICEDATA_H
-#include <map>
+#include <vector>
 #include "geometry/Site.h"
 #include "geometry/SiteData.h"
 #include "lb/lattices/LatticeInfo.h"
+#include "util/HashMap.h"
 namespace hemelb
 {
   namespace geometry
@@ -21,6 +22,11 @@ namespace hemelb
 
       // Here, all site indices are GLOBAL index.
       // Local users must determine the global index of the site they are interested in.
+      //
+      // Each site's data is kept in a slot in contiguous arrays, found through a hash map from
+      // the global index. The non-const accessors add a slot for
+      // a site that doesn't have one yet, which can move the arrays, so pointers into them are
+      // only valid until the next site is added.
 
       class NeighbouringLatticeData
       {
@@ -39,6 +45,18 @@ namespace hemelb
                         const util::Vector3D<distribn_t> &normal,
                         const SiteData & data);
 
+          /**
+           * Make room for the given site's data, if there isn't already.
+           * @param globalIndex
+           */
+          void AddSite(site_t globalIndex);
+
+          /**
+           * @param globalIndex
+           * @return Whether there is room for the given site's data.
+           */
+          bool HasSite(site_t globalIndex) const;
+
           /**
            * Get a site object for the given index.
            * @param localIndex
@@ -62,12 +80,11 @@ namespace hemelb
           distribn_t* GetFOld(site_t distributionIndex);
 
           /**
-           * Get a vector of the fOld array for the site
-           * LatticeData assumes that the index for GetFOld is in distribution-space not site-space
+           * Get a pointer to the fOld array for the site
            * @param globalIndex
            * @return
            */
-          std::vector<distribn_t>& GetDistribution(site_t globalIndex);
+          distribn_t* GetDistribution(site_t globalIndex);
           /**
            * Get a pointer to the fOld array starting at the requested index. This version
            * of the function allows us to access the fOld array in a const way from a const
@@ -77,6 +94,24 @@ namespace hemelb
            */
           const distribn_t* GetFOld(site_t distributionIndex) const;
 
+          /**
+           * Neighbouring data always keeps the distributions of a site contiguous, whatever the
+           * layout of the local LatticeData.
+           * @param globalIndex
+           * @param direction
+           * @return
+           */
+          template<typename LatticeType>
+          site_t GetDistributionIndex(site_t globalIndex, Direction direction) const
+          {
+            return globalIndex * LatticeType::NUMVECTORS + direction;
+          }
+
+          site_t GetDistributionIndex(site_t globalIndex, Direction direction) const
+          {
+            return globalIndex * latticeInfo.GetNumVectors() + direction;
+          }
+
           /*
            * This is not defined for Neighbouring Data.
            * Data streamed across boundaries is handled by the existing mechanism.
@@ -90,7 +125,7 @@ namespace hemelb
           template<typename LatticeType>
           double GetCutDistance(site_t globalIndex, int direction) const
           {
-            return distanceToWall.find(globalIndex)->second[direction - 1];
+            return GetCutDistances(globalIndex)[direction - 1];
           }
 
           /*
@@ -109,11 +144,29 @@ namespace hemelb
           const SiteData &GetSiteData(site_t globalIndex) const;
           SiteData &GetSiteData(site_t globalIndex);
 
+          /**
+           * @return The bytes allocated for the sites' data and the index to them.
+           */
+          size_t GetMemoryUsage() const;
+
         private:
-          std::map<site_t, std::vector<distribn_t> > distributions; //! The distribution values for the previous time step
-          std::map<site_t, std::vector<distribn_t> > distanceToWall; //! Hold the distance to the wall for each fluid site and direction
-          std::map<site_t, util::Vector3D<distribn_t> > wallNormalAtSite; //! Holds the wall normal near the fluid site, where appropriate
-          std::map<site_t, SiteData> siteData; //! Holds the SiteData for each site.
+          /**
+           * @param globalIndex
+           * @return The slot of the given site, or -1 if it hasn't got one.
+           */
+          site_t FindSlot(site_t globalIndex) const;
+
+          /**
+           * @param globalIndex
+           * @return The slot of the given site, adding one if it hasn't got one.
+           */
+          site_t GetSlot(site_t globalIndex);
+
+          util::HashMap<site_t, site_t> slots; //! The slot of each site, by global index
+          std::vector<distribn_t> distributions; //! The distribution values for the previous time step, for each slot
+          std::vector<distribn_t> distanceToWall; //! Hold the distance to the wall for each slot and direction
+          std::vector<util::Vector3D<distribn_t> > wallNormalAtSite; //! Holds the wall normal near each slot's site, where appropriate
+          std::vector<SiteData> siteData; //! Holds the SiteData for each slot.
           const lb::lattices::LatticeInfo& latticeInfo;
       };
 
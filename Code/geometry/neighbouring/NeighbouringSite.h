@@ -57,6 +57,12 @@ namespace hemelb
               Site<const NeighbouringLatticeData>(localContiguousIndex, latticeData)
           {
           }
+
+          template<typename LatticeType>
+          inline const distribn_t* GetFOld() const
+          {
+            return latticeData.GetFOld(index * LatticeType::NUMVECTORS);
+          }
       };
     }
   }
@@ -12,16 +12,40 @@ namespace hemelb
   {
     namespace neighbouring
     {
+      const uint32_t RequiredSiteInformation::AllDirections;
+
       RequiredSiteInformation::RequiredSiteInformation(bool initial) :
-          choices(terms::Length, initial)
+          choices(terms::Length, initial), directions(initial ?
+            AllDirections :
+            0)
       {
       }
       void RequiredSiteInformation::Require(terms::Term term)
       {
         choices[term] = true;
       }
+      void RequiredSiteInformation::RequireDirection(Direction direction)
+      {
+        directions |= uint32_t(1) << direction;
+      }
+      uint32_t RequiredSiteInformation::GetRequiredDirections() const
+      {
+        // The macroscopic terms are all calculated from every distribution.
+        for (int choice = terms::Distribution; choice < terms::Length; choice++)
+        {
+          if (choices[choice])
+          {
+            return AllDirections;
+          }
+        }
+        return directions;
+      }
       bool RequiredSiteInformation::RequiresAny()
       {
+        if (directions != 0)
+        {
+          return true;
+        }
         for (std::vector<bool>::iterator choice = choices.begin(); choice != choices.end(); choice++)
         {
           if (*choice)
@@ -33,6 +57,10 @@ namespace hemelb
       }
       bool RequiredSiteInformation::RequiresAnyFieldDependent()
       {
+        if (directions != 0)
+        {
+          return true;
+        }
         for (int choice = terms::Distribution; choice < terms::Length; choice++)
         {
           if (choices[choice])
@@ -71,6 +99,7 @@ namespace hemelb
         {
           choices[choice]=choices[choice] || other.choices[choice];
         }
+        directions |= other.directions;
       }
       void RequiredSiteInformation::And(const RequiredSiteInformation& other)
       {
@@ -78,6 +107,7 @@ namespace hemelb
         {
          choices[choice]=choices[choice] && other.choices[choice];
         }
+        directions &= other.directions;
       }
     }
   }
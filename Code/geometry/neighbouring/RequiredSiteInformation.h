@@ -8,6 +8,8 @@
 #define HEMELB_GEOMETRY_NEIGHBOURING_REQUIREDSITEINFORMATION_H
 #include <vector>
 #include <algorithm>
+#include <stdint.h>
+#include "units.h"
 namespace hemelb
 {
   namespace geometry
@@ -33,15 +35,29 @@ namespace hemelb
       }
       /***
        * Class to represent, eventually, exactly what information is needed from a remote site.
-       * Initially, this will not be used -- we will just transfer all information.
+       * Of the field-dependent information, only the distributions in the required directions
+       * are transferred; the rest is all transferred.
        */
       class RequiredSiteInformation
       {
         public:
+          //! The direction mask for the distributions in every direction.
+          static const uint32_t AllDirections = 0xffffffffu;
+
           RequiredSiteInformation(bool initial = false);
           void Or(const RequiredSiteInformation& other);
           void And(const RequiredSiteInformation& other);
           void Require(terms::Term term);
+          /**
+           * Require the distribution in just one direction. Requiring the Distribution term,
+           * or any macroscopic one, requires them in every direction.
+           * @param direction
+           */
+          void RequireDirection(Direction direction);
+          /**
+           * @return A bit for each direction whose distribution is required, or AllDirections.
+           */
+          uint32_t GetRequiredDirections() const;
           bool RequiresAny();
           bool RequiresAnyFieldDependent();
           bool RequiresAnyNonFieldDependent();
@@ -52,6 +68,7 @@ namespace hemelb
           }
         private:
           std::vector<bool> choices;
+          uint32_t directions;
       };
     }
   }
@@ -25,6 +25,11 @@ namespace hemelb
       imageDirectory = outputDir + "/Images/";
       dataPath = outputDir + "/Extracted/";
       colloidFile = outputDir + "/ColloidOutput.xdr";
+      checkpointFile = outputDir + "/Checkpoint.dat";
+      traceFile = outputDir + "/Trace.json";
+      captureFile = outputDir + "/Capture.dat";
+      commsMatrixFile = outputDir + "/CommsMatrix.txt";
+      loadImbalanceFile = outputDir + "/LoadImbalance.csv";
 
       if (doIo)
       {
@@ -50,6 +55,32 @@ namespace hemelb
     {
       return colloidFile;
     }
+    const std::string & PathManager::GetCheckpointPath() const
+    {
+      return checkpointFile;
+    }
+    const std::string & PathManager::GetTracePath() const
+    {
+      return traceFile;
+    }
+    const std::string & PathManager::GetCapturePath() const
+    {
+      return captureFile;
+    }
+    std::string PathManager::GetFlightRecorderPath(const unsigned long timeStep) const
+    {
+      char filename[255];
+      snprintf(filename, 255, "/FlightRecorder_%08lu.dat", timeStep);
+      return outputDir + std::string(filename);
+    }
+    const std::string & PathManager::GetCommsMatrixPath() const
+    {
+      return commsMatrixFile;
+    }
+    const std::string & PathManager::GetLoadImbalancePath() const
+    {
+      return loadImbalanceFile;
+    }
     const std::string & PathManager::GetReportPath() const
     {
       return reportName;
@@ -61,9 +92,22 @@ namespace hemelb
     }
 
     hemelb::io::writers::Writer * PathManager::XdrImageWriter(const long int time) const
+    {
+      return XdrImageWriter(time, 0);
+    }
+
+    hemelb::io::writers::Writer * PathManager::XdrImageWriter(const long int time,
+                                                              const unsigned int view) const
     {
       char filename[255];
-      snprintf(filename, 255, "%08li.dat", time);
+      if (view == 0)
+      {
+        snprintf(filename, 255, "%08li.dat", time);
+      }
+      else
+      {
+        snprintf(filename, 255, "%08li_view%u.dat", time, view);
+      }
 #ifdef HEMELB_IMAGES_TO_NULL
       return (new hemelb::io::writers::null::NullWriter());
 #else
@@ -50,6 +50,38 @@ namespace hemelb
          * @return
          */
         const std::string & GetColloidPath() const;
+        /**
+         * Gets the path to the file where checkpoints of the LB state should be written
+         * @return
+         */
+        const std::string & GetCheckpointPath() const;
+        /**
+         * Gets the path to the file where the trace of the phased steps should be written
+         * @return
+         */
+        const std::string & GetTracePath() const;
+        /**
+         * Gets the path to the file where the capture of a rank's subdomain should be written
+         * @return
+         */
+        const std::string & GetCapturePath() const;
+        /**
+         * Gets the path to the file where the flight recorder's samples should be written at a
+         * time step
+         * @param timeStep
+         * @return
+         */
+        std::string GetFlightRecorderPath(const unsigned long timeStep) const;
+        /**
+         * Gets the path to the file where the matrix of communication between ranks should be written
+         * @return
+         */
+        const std::string & GetCommsMatrixPath() const;
+        /**
+         * Gets the path to the file where each rank's sites and timings should be written
+         * @return
+         */
+        const std::string & GetLoadImbalancePath() const;
         /**
          * Path to where a run report file should be created.
          * @return Reference to path to where a run report file should be created.
@@ -73,6 +105,14 @@ namespace hemelb
          */
         hemelb::io::writers::Writer * XdrImageWriter(const long int time) const;
 
+        /**
+         * Generate an xdr file writer to save one view of an image to.
+         * @param time The current time, used to generate a unique filename.
+         * @param view The view, which is also in the filename unless it is the first.
+         * @return Pointer to an XDR file writer, to be deleted by the client code.
+         */
+        hemelb::io::writers::Writer * XdrImageWriter(const long int time, const unsigned int view) const;
+
         /**
          * Return the path that property extraction output should go to.
          * @return
@@ -84,6 +124,11 @@ namespace hemelb
         std::string inputFile;
         std::string imageDirectory;
         std::string colloidFile;
+        std::string checkpointFile;
+        std::string traceFile;
+        std::string captureFile;
+        std::string commsMatrixFile;
+        std::string loadImbalanceFile;
         std::string configLeafName;
         std::string reportName;
         std::string dataPath;
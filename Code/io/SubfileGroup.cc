@@ -0,0 +1,102 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <cstdlib>
+#include <sstream>
+#include "io/SubfileGroup.h"
+#include "Exception.h"
+
+namespace hemelb
+{
+  namespace io
+  {
+    namespace
+    {
+      net::MpiCommunicator SplitIntoGroups(const net::IOCommunicator& comms, int ranksPerFile)
+      {
+        switch (ranksPerFile)
+        {
+          case SubfileGroup::OneFile:
+            return comms;
+          case SubfileGroup::PerNode:
+            return comms.SplitShared();
+          default:
+            return comms.Split(comms.Rank() / ranksPerFile, comms.Rank());
+        }
+      }
+    }
+
+    SubfileGroup::SubfileGroup(const net::IOCommunicator& comms, int ranksPerFile) :
+        comms(comms), ranksPerFile(ranksPerFile), group(0), groupCount(1),
+            groupComms(SplitIntoGroups(comms, ranksPerFile))
+    {
+      if (ranksPerFile == PerNode)
+      {
+        // Number the nodes in the order of their lowest ranks.
+        const int leader = groupComms.OnIORank() ?
+          1 :
+          0;
+        group = comms.ExScan(leader, MPI_SUM);
+        groupComms.Broadcast(group, groupComms.GetIORank());
+        groupCount = comms.AllReduce(leader, MPI_SUM);
+      }
+      else if (ranksPerFile != OneFile)
+      {
+        group = comms.Rank() / ranksPerFile;
+        groupCount = (comms.Size() + ranksPerFile - 1) / ranksPerFile;
+      }
+    }
+
+    bool SubfileGroup::ParseRanksPerFile(const std::string& text, int& ranksPerFile)
+    {
+      if (text == "node")
+      {
+        ranksPerFile = PerNode;
+        return true;
+      }
+      char* end;
+      const long ranks = std::strtol(text.c_str(), &end, 10);
+      if (text.empty() || *end != '\0' || ranks <= 0)
+      {
+        return false;
+      }
+      ranksPerFile = int(ranks);
+      return true;
+    }
+
+    std::string SubfileGroup::GetPartPath(const std::string& path, int partGroup) const
+    {
+      if (!IsSplit())
+      {
+        return path;
+      }
+      std::ostringstream partPath;
+      partPath << path << "." << partGroup;
+      return partPath.str();
+    }
+
+    SubfileIndex SubfileGroup::MakeIndex(const std::string& path, uint32_t formatMagic,
+                                         uint64_t localSites) const
+    {
+      const std::vector<uint64_t> sites = comms.Gather(localSites, comms.GetIORank());
+      const std::vector<int> groups = comms.Gather(group, comms.GetIORank());
+
+      SubfileIndex index(formatMagic);
+      if (comms.OnIORank())
+      {
+        std::vector<uint64_t> groupSites(groupCount, 0);
+        for (size_t rank = 0; rank < sites.size(); ++rank)
+        {
+          groupSites[groups[rank]] += sites[rank];
+        }
+        for (int partGroup = 0; partGroup < groupCount; ++partGroup)
+        {
+          index.AddPart(GetPartPath(path, partGroup), groupSites[partGroup]);
+        }
+      }
+      return index;
+    }
+  }
+}
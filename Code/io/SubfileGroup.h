@@ -0,0 +1,114 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_IO_SUBFILEGROUP_H
+#define HEMELB_IO_SUBFILEGROUP_H
+
+#include <string>
+#include "io/SubfileIndex.h"
+#include "net/IOCommunicator.h"
+
+namespace hemelb
+{
+  namespace io
+  {
+    /**
+     * Splits the cores into groups that each write their own part of a file, rather than all
+     * of them writing one file. On many cores, one shared file makes every write contend for
+     * the same file system locks and metadata; with a file per node, or per so many cores, the
+     * collective MPI-IO in each group only gathers to a few aggregators and the parts are
+     * written independently. A subfile index (see io/formats/subfiles.h) at the path of the
+     * whole file says where the parts are, so that the readers can stitch them together.
+     *
+     * A group's part is at the path of the whole file with the group number after it, e.g.
+     * results.xtr.3. Making a group is collective.
+     */
+    class SubfileGroup
+    {
+      public:
+        /**
+         * The ranks per file that mean one file, without any parts, or one file for each node.
+         */
+        enum
+        {
+          OneFile = 0,
+          PerNode = -1
+        };
+
+        /**
+         * @param comms All the cores writing the file.
+         * @param ranksPerFile The number of ranks in each group, in rank order, or OneFile or
+         * PerNode.
+         */
+        SubfileGroup(const net::IOCommunicator& comms, int ranksPerFile);
+
+        /**
+         * Parse the ranks per file from a configuration, "node" or the number of ranks.
+         * @param text
+         * @param ranksPerFile Set to the ranks per file, if it can be parsed.
+         * @return Whether it could be.
+         */
+        static bool ParseRanksPerFile(const std::string& text, int& ranksPerFile);
+
+        /**
+         * @return Whether the file is written in parts.
+         */
+        bool IsSplit() const
+        {
+          return ranksPerFile != OneFile;
+        }
+
+        /**
+         * @return The cores of this group, which write its part, with the lowest ranked one
+         * as the IO rank.
+         */
+        const net::IOCommunicator& GetComms() const
+        {
+          return groupComms;
+        }
+
+        int GetGroup() const
+        {
+          return group;
+        }
+
+        int GetGroupCount() const
+        {
+          return groupCount;
+        }
+
+        /**
+         * @param path The path of the whole file.
+         * @return The path of this group's part, or of the whole file if it isn't split.
+         */
+        std::string GetPartPath(const std::string& path) const
+        {
+          return GetPartPath(path, group);
+        }
+
+        /**
+         * Make the index of the parts, from the number of sites each core has written.
+         * Collective.
+         * @param path The path of the whole file.
+         * @param formatMagic The magic number of the format of the parts.
+         * @param localSites
+         * @return The index, on the IO rank of all the cores.
+         */
+        SubfileIndex MakeIndex(const std::string& path, uint32_t formatMagic,
+                               uint64_t localSites) const;
+
+      private:
+        std::string GetPartPath(const std::string& path, int partGroup) const;
+
+        const net::IOCommunicator& comms;
+        const int ranksPerFile;
+        int group;
+        int groupCount;
+        net::IOCommunicator groupComms;
+    };
+  }
+}
+
+#endif /* HEMELB_IO_SUBFILEGROUP_H */
@@ -0,0 +1,110 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <fstream>
+#include <iterator>
+#include "io/SubfileIndex.h"
+#include "io/formats/formats.h"
+#include "io/formats/subfiles.h"
+#include "io/writers/xdr/XdrFileWriter.h"
+#include "io/writers/xdr/XdrMemReader.h"
+#include "util/fileutils.h"
+#include "Exception.h"
+
+namespace hemelb
+{
+  namespace io
+  {
+    bool SubfileIndex::IsIndex(const std::string& path)
+    {
+      std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+      std::vector<char> magic(8);
+      if (!file.read(&magic[0], magic.size()))
+      {
+        return false;
+      }
+      writers::xdr::XdrMemReader reader(&magic[0], magic.size());
+      unsigned hemeLbMagic, subfilesMagic;
+      reader.readUnsignedInt(hemeLbMagic);
+      reader.readUnsignedInt(subfilesMagic);
+      return hemeLbMagic == formats::HemeLbMagicNumber
+          && subfilesMagic == formats::subfiles::MagicNumber;
+    }
+
+    SubfileIndex SubfileIndex::Read(const std::string& path)
+    {
+      std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+      std::vector<char> contents( (std::istreambuf_iterator<char>(file)),
+                                 std::istreambuf_iterator<char>());
+      if (contents.size() < formats::subfiles::PreambleLength)
+      {
+        throw Exception() << path << " is not a subfile index";
+      }
+
+      writers::xdr::XdrMemReader reader(&contents[0], contents.size());
+      unsigned hemeLbMagic, subfilesMagic, version, formatMagic, partCount;
+      reader.readUnsignedInt(hemeLbMagic);
+      reader.readUnsignedInt(subfilesMagic);
+      reader.readUnsignedInt(version);
+      reader.readUnsignedInt(formatMagic);
+      reader.readUnsignedInt(partCount);
+      if (hemeLbMagic != formats::HemeLbMagicNumber
+          || subfilesMagic != formats::subfiles::MagicNumber)
+      {
+        throw Exception() << path << " is not a subfile index";
+      }
+      if (version != formats::subfiles::VersionNumber)
+      {
+        throw Exception() << "Subfile index " << path << " has version " << version
+            << ", expected " << formats::subfiles::VersionNumber;
+      }
+
+      SubfileIndex index(formatMagic);
+      for (unsigned part = 0; part < partCount; ++part)
+      {
+        std::string name;
+        uint64_t firstSite, siteCount;
+        if (!reader.readString(name) || !reader.readUnsignedLong(firstSite)
+            || !reader.readUnsignedLong(siteCount))
+        {
+          throw Exception() << "Subfile index " << path << " ends in part " << part << " of "
+              << partCount;
+        }
+        if (firstSite != index.GetSiteCount())
+        {
+          throw Exception() << "Part " << part << " of subfile index " << path
+              << " starts at site " << firstSite << ", not " << index.GetSiteCount();
+        }
+        index.AddPart(util::NormalizePathRelativeToPath(name, path), siteCount);
+      }
+      return index;
+    }
+
+    void SubfileIndex::Write(const std::string& path) const
+    {
+      writers::xdr::XdrFileWriter writer(path);
+      writer << uint32_t(formats::HemeLbMagicNumber) << uint32_t(formats::subfiles::MagicNumber)
+          << uint32_t(formats::subfiles::VersionNumber) << uint32_t(formatMagic)
+          << uint32_t(parts.size());
+      for (std::vector<Part>::const_iterator part = parts.begin(); part != parts.end(); ++part)
+      {
+        const std::string::size_type lastSlash = part->path.rfind('/');
+        writer << (lastSlash == std::string::npos ?
+          part->path :
+          part->path.substr(lastSlash + 1)) << uint64_t(part->firstSite)
+            << uint64_t(part->siteCount);
+      }
+    }
+
+    void SubfileIndex::AddPart(const std::string& path, uint64_t siteCount)
+    {
+      Part part;
+      part.path = path;
+      part.firstSite = GetSiteCount();
+      part.siteCount = siteCount;
+      parts.push_back(part);
+    }
+  }
+}
@@ -0,0 +1,91 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_IO_SUBFILEINDEX_H
+#define HEMELB_IO_SUBFILEINDEX_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace hemelb
+{
+  namespace io
+  {
+    /**
+     * The index of a file written in parts (see io/formats/subfiles.h), for the readers of
+     * those files to find the parts by.
+     */
+    class SubfileIndex
+    {
+      public:
+        struct Part
+        {
+            std::string path;
+            uint64_t firstSite;
+            uint64_t siteCount;
+        };
+
+        /**
+         * @param formatMagic The magic number of the format of the parts.
+         */
+        explicit SubfileIndex(uint32_t formatMagic = 0) :
+            formatMagic(formatMagic)
+        {
+        }
+
+        /**
+         * Whether a file starts like a subfile index, to tell them from whole files.
+         * @param path
+         * @return
+         */
+        static bool IsIndex(const std::string& path);
+
+        /**
+         * Read an index, throwing an Exception if it is malformed. The paths of the parts are
+         * made relative to the current directory, rather than to the index.
+         * @param path
+         * @return
+         */
+        static SubfileIndex Read(const std::string& path);
+
+        /**
+         * Write the index. The parts must be in the same directory as it.
+         * @param path
+         */
+        void Write(const std::string& path) const;
+
+        /**
+         * Add a part after the others.
+         * @param path
+         * @param siteCount
+         */
+        void AddPart(const std::string& path, uint64_t siteCount);
+
+        uint32_t GetFormatMagic() const
+        {
+          return formatMagic;
+        }
+
+        const std::vector<Part>& GetParts() const
+        {
+          return parts;
+        }
+
+        uint64_t GetSiteCount() const
+        {
+          return parts.empty() ?
+            0 :
+            parts.back().firstSite + parts.back().siteCount;
+        }
+
+      private:
+        uint32_t formatMagic;
+        std::vector<Part> parts;
+    };
+  }
+}
+
+#endif /* HEMELB_IO_SUBFILEINDEX_H */
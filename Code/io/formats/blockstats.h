@@ -0,0 +1,90 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_IO_FORMATS_BLOCKSTATS_H
+#define HEMELB_IO_FORMATS_BLOCKSTATS_H
+
+namespace hemelb
+{
+  namespace io
+  {
+    namespace formats
+    {
+      /**
+       * A block statistics file sits beside a geometry file, at its path plus Extension, and
+       * describes the sites of each of its blocks, so that the geometry can be decomposed by the
+       * cost of its sites without reading or decompressing any block first. The setup tool
+       * writes it optionally, while generating the geometry.
+       *
+       * After the preamble comes a record for each block, in the order of the geometry file,
+       * made up of:
+       *  * uint - the number of fluid sites
+       *  * uhyper - the offset of the block's compressed data from the start of the geometry
+       *    file
+       *  * uint[CollisionTypeCount] - the number of fluid sites of each collision type: bulk,
+       *    wall, inlet, outlet, wall/inlet and wall/outlet, as for the site weights
+       */
+      namespace blockstats
+      {
+        /**
+         * Magic number to identify block statistics files.
+         * ASCII for 'bks' + EOF
+         */
+        enum
+        {
+          MagicNumber = 0x626b7304
+        };
+
+        /**
+         * The version number of the file format.
+         */
+        enum
+        {
+          VersionNumber = 1
+        };
+
+        /**
+         * The length of the preamble. Made up of:
+         * uint - HemeLbMagicNumber
+         * uint - BlockStatsMagicNumber
+         * uint - Format version number
+         * uint - Number of blocks in the geometry
+         * uint - Number of collision types in each record
+         * uint - CRC-32 of everything in the geometry file before the block data (preamble, header
+         *        and any dictionary), to spot a stale file
+         */
+        enum
+        {
+          PreambleLength = 24
+        };
+
+        /**
+         * The number of collision types counted for each block.
+         */
+        enum
+        {
+          CollisionTypeCount = 6
+        };
+
+        /**
+         * The length of the record for each block.
+         */
+        enum
+        {
+          BlockRecordLength = 4 + 8 + 4 * CollisionTypeCount
+        };
+
+        /**
+         * What is appended to the geometry file's path to give the block statistics file's.
+         */
+        inline const char* Extension()
+        {
+          return ".bks";
+        }
+      }
+    }
+  }
+}
+#endif /* HEMELB_IO_FORMATS_BLOCKSTATS_H */
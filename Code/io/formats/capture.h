@@ -0,0 +1,99 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_IO_FORMATS_CAPTURE_H
+#define HEMELB_IO_FORMATS_CAPTURE_H
+
+namespace hemelb
+{
+  namespace io
+  {
+    namespace formats
+    {
+      /**
+       * A capture file stores one rank's subdomain at the end of a time step: everything its
+       * collide-and-stream loop reads, so that hemelb_replay can run that loop again on a single
+       * core. Everything is XDR encoded.
+       *
+       * After the preamble come:
+       *  * string - The lattice, kernel and boundary conditions of the build that wrote it
+       *  * double - The time step length and the voxel size, which give the kernel parameters
+       *  * uint - The stress type
+       *  * The inlets, then the outlets, each as a uint count followed by, for each iolet:
+       *    * uint - PressureIolet or VelocityIolet
+       *    * double - The density at the time step
+       *    * double x 3 - The position and the normal, in lattice units
+       *    * double x 2 - Only for velocity iolets, the radius and the speed at the centre
+       *  * The subdomain, as written by geometry::LatticeData::WriteSubdomain. Its fOld holds the
+       *    distributions received in the halo exchange of the time step where they were streamed
+       *    to, which is where the replay takes the halo from.
+       */
+      namespace capture
+      {
+        /**
+         * Magic number to identify capture files.
+         * ASCII for 'cap' + EOF
+         */
+        enum
+        {
+          MagicNumber = 0x63617004
+        };
+
+        /**
+         * The version number of the file format.
+         */
+        enum
+        {
+          VersionNumber = 1
+        };
+
+        /**
+         * How the distributions of each site are laid out in the distribution arrays.
+         */
+        enum Layout
+        {
+          SiteMajorLayout = 0,
+          DirectionMajorLayout = 1
+        };
+
+        /**
+         * Added to the layout when the distributions are stored as they were after collision, for
+         * pull streaming, and the subdomain's streaming tables are followed by where each
+         * distribution is pulled from.
+         */
+        enum
+        {
+          PulledLayoutFlag = 2
+        };
+
+        /**
+         * The kinds of iolet.
+         */
+        enum IoletKind
+        {
+          PressureIolet = 0,
+          VelocityIolet = 1
+        };
+
+        /**
+         * The length of the preamble. Made up of:
+         * uint - HemeLbMagicNumber
+         * uint - CaptureMagicNumber
+         * uint - Format version number
+         * uint - Number of distributions per site
+         * uint - Layout of the distributions
+         * uint - The rank captured
+         * uint - The number of ranks in the run
+         * uint64 - The time step captured, at its end
+         */
+        enum
+        {
+          PreambleLength = 36
+        };
+      }
+    }
+  }
+}
+#endif /* HEMELB_IO_FORMATS_CAPTURE_H */
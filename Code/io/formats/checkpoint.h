@@ -0,0 +1,105 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_IO_FORMATS_CHECKPOINT_H
+#define HEMELB_IO_FORMATS_CHECKPOINT_H
+
+namespace hemelb
+{
+  namespace io
+  {
+    namespace formats
+    {
+      /**
+       * A checkpoint file stores the state of the LB, so that a run can be restarted from it on
+       * any number of cores. Everything is XDR encoded.
+       *
+       * After the preamble come the site records, in no particular order. Each is the global
+       * noncontiguous site id (uint64, see LatticeData::GetGlobalNoncontiguousSiteIdFromGlobalCoords)
+       * followed by the site's distributions in lattice direction order, encoded as given in the
+       * preamble:
+       *  * DoubleEncoding: each distribution as a double.
+       *  * NonEquilibriumFloatEncoding: the density and the three components of the momentum
+       *    (double), then the difference of each distribution from the equilibrium for that
+       *    density and momentum (float). That difference is several orders of magnitude smaller
+       *    than the distribution, so it keeps nearly all its precision in a float.
+       *
+       * After the records comes an index of them by block, so that each core can read just the
+       * records of the blocks it has, however the domain is decomposed. Each core's records are
+       * grouped by block, so a block's records are in one run for each core that had some of its
+       * sites. Each entry of the index is one run:
+       *  * uint64 - The block id
+       *  * uint64 - The index of the first record of the run
+       *  * uint64 - The number of records in the run
+       */
+      namespace checkpoint
+      {
+        /**
+         * Magic number to identify checkpoint files.
+         * ASCII for 'chk' + EOF
+         */
+        enum
+        {
+          MagicNumber = 0x63686b04
+        };
+
+        /**
+         * The version number of the file format.
+         */
+        enum
+        {
+          VersionNumber = 3
+        };
+
+        /**
+         * How the distributions in each record are encoded.
+         */
+        enum Encoding
+        {
+          DoubleEncoding = 0,
+          NonEquilibriumFloatEncoding = 1
+        };
+
+        /**
+         * The length of the preamble. Made up of:
+         * uint - HemeLbMagicNumber
+         * uint - CheckpointMagicNumber
+         * uint - Format version number
+         * uint - Number of distributions per site
+         * uint - Encoding of the distributions
+         * uint64 - The time step to restart at
+         * uint64 - Number of site records
+         * uint64 - Number of index entries
+         */
+        enum
+        {
+          PreambleLength = 44
+        };
+
+        /**
+         * The length of an entry of the block index.
+         */
+        enum
+        {
+          IndexEntryLength = 24
+        };
+
+        /**
+         * The length of a site record with the given number of distributions.
+         * @param numVectors
+         * @param encoding
+         * @return
+         */
+        inline unsigned GetRecordLength(unsigned numVectors, Encoding encoding)
+        {
+          return encoding == NonEquilibriumFloatEncoding ?
+            8 + 4 * 8 + 4 * numVectors :
+            8 + 8 * numVectors;
+        }
+      }
+    }
+  }
+}
+#endif /* HEMELB_IO_FORMATS_CHECKPOINT_H */
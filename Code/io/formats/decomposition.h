@@ -0,0 +1,60 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_IO_FORMATS_DECOMPOSITION_H
+#define HEMELB_IO_FORMATS_DECOMPOSITION_H
+
+namespace hemelb
+{
+  namespace io
+  {
+    namespace formats
+    {
+      /**
+       * A decomposition file stores the domain decomposition of a geometry file for a particular
+       * number of cores, so that a later run on as many cores can skip decomposing it again.
+       *
+       * After the preamble come, as uints:
+       *  * the initial core of each block
+       *  * the number of site moves from each core
+       *  * the block, site and destination core of each move
+       */
+      namespace decomposition
+      {
+        /**
+         * Magic number to identify decomposition files.
+         * ASCII for 'dcm' + EOF
+         */
+        enum
+        {
+          MagicNumber = 0x64636d04
+        };
+
+        /**
+         * The version number of the file format.
+         */
+        enum
+        {
+          VersionNumber = 1
+        };
+
+        /**
+         * The length of the preamble. Made up of:
+         * uint - HemeLbMagicNumber
+         * uint - DecompositionMagicNumber
+         * uint - Format version number
+         * uint - Number of blocks in the geometry
+         * uint - Number of cores decomposed over
+         * uint - Total number of moves
+         */
+        enum
+        {
+          PreambleLength = 24
+        };
+      }
+    }
+  }
+}
+#endif /* HEMELB_IO_FORMATS_DECOMPOSITION_H */
@@ -7,6 +7,8 @@
 #ifndef HEMELB_IO_FORMATS_EXTRACTION_H
 #define HEMELB_IO_FORMATS_EXTRACTION_H
 
+#include <stdint.h>
+
 namespace hemelb
 {
   namespace io
@@ -32,6 +34,78 @@ namespace hemelb
           VersionNumber = 4
         };
 
+        /**
+         * The version number of the variant of the format in which the site positions aren't
+         * repeated in every record. The body is a sequence of blocks, each starting with a uhyper.
+         * If that is SiteListMarker, the block is the position (uint x 3) of every site, which
+         * holds for the records that follow; otherwise it is the iteration number of a record,
+         * with only the field values for every site, in that order. A new site list is written
+         * at the start, and whenever the sites move between cores.
+         */
+        enum
+        {
+          SiteListVersionNumber = 5
+        };
+
+        /**
+         * Where a record's iteration number would be, marks a list of site positions.
+         */
+        const uint64_t SiteListMarker = ~uint64_t(0);
+
+        /**
+         * The version number of the variant of the format in which the field values may be
+         * stored with less precision. The field header starts with two extra uints, the
+         * Encoding of the values and a set of Flags, before the usual name, length and offset of
+         * each field. The body is as for VersionNumber, or as for SiteListVersionNumber with
+         * the SiteLists flag.
+         *
+         * 16-bit values are big-endian, with each site's values padded with zeros to a multiple
+         * of four bytes. With Fixed16Encoding, each record's iteration number is followed by two
+         * doubles for each field, a minimum and a scale, and each value is the field's offset
+         * plus minimum + scale * the stored uint16.
+         *
+         * With DeltaEncoding, the positions are always in site lists, and each record is:
+         * uhyper - The iteration number
+         * uint - 1 if the record is a keyframe, 0 if it holds deltas against the record before
+         * double x 2 x field count - The minimum and scale of each field, as for Fixed16Encoding,
+         *     which stay the same from a keyframe until the next
+         * uint - The number of chunks, one per core
+         * uint x chunks - The length in bytes of each chunk, before padding
+         * The chunks follow, each padded with zeros to a multiple of four bytes. A chunk is a
+         * zlib stream of some of the sites' values, in order, each quantised with the record's
+         * minimum and scale as for Fixed16Encoding. In a keyframe these are the quantised values
+         * themselves; otherwise they are the differences from the quantised values of the record
+         * before. Each difference d is stored as the uint32 (d << 1) ^ (d >> 31),
+         * and the chunk holds the most significant byte of every value, then the next byte of
+         * every value, and so on, so that the zeros of small differences run together.
+         */
+        enum
+        {
+          EncodedVersionNumber = 6
+        };
+
+        /**
+         * How the field values are stored.
+         */
+        enum Encoding
+        {
+          Float32Encoding = 0, //!< XDR floats
+          Float16Encoding = 1, //!< IEEE half-precision floats
+          Fixed16Encoding = 2, //!< uint16s quantising each field's range in the record
+          DeltaEncoding = 3 //!< Compressed differences between quantised records
+        };
+
+        /**
+         * Flags for the field header of an EncodedVersionNumber file.
+         */
+        enum Flags
+        {
+          SiteLists = 1, //!< The positions are in site lists, not in every record
+          //! Each site in a site list has, after its position, its wall normal (float x 3) and
+          //! the area of wall it stands for in square metres (float), zero at non-wall sites
+          SurfaceSiteLists = 2
+        };
+
         /**
          * The length of the main header. Made up of:
          * uint - HemeLbMagicNumber
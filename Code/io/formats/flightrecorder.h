@@ -0,0 +1,81 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_IO_FORMATS_FLIGHTRECORDER_H
+#define HEMELB_IO_FORMATS_FLIGHTRECORDER_H
+
+namespace hemelb
+{
+  namespace io
+  {
+    namespace formats
+    {
+      /**
+       * A flight recorder file holds the last samples of the fields a flight recorder kept (see
+       * extraction::FlightRecorder), written when the simulation went unstable or the steering
+       * client asked for them. Everything is XDR encoded.
+       *
+       * After the preamble come:
+       *  * uint64 x samples - The time step of each sample, oldest first
+       *  * A record for each fluid site, in order of the cores:
+       *    * uint x 3 - The site's lattice coordinates
+       *    * float x samples x values per site - For each sample, oldest first, the fields given
+       *      in the preamble, in the order of the Field bits: the pressure (mmHg) and the three
+       *      components of the velocity (m/s)
+       *  * A record for each fluid site in the region whose distributions were kept, in order of
+       *    the cores:
+       *    * uint x 3 - The site's lattice coordinates
+       *    * float x samples x distributions per site - For each sample, oldest first, the
+       *      site's distributions in lattice units, in lattice direction order
+       */
+      namespace flightrecorder
+      {
+        /**
+         * Magic number to identify flight recorder files.
+         * ASCII for 'flt' + EOF
+         */
+        enum
+        {
+          MagicNumber = 0x666c7404
+        };
+
+        /**
+         * The version number of the file format.
+         */
+        enum
+        {
+          VersionNumber = 1
+        };
+
+        /**
+         * The bits of the fields kept at every site.
+         */
+        enum Field
+        {
+          PressureField = 1,
+          VelocityField = 2
+        };
+
+        /**
+         * The length of the preamble. Made up of:
+         * uint - HemeLbMagicNumber
+         * uint - FlightRecorderMagicNumber
+         * uint - Format version number
+         * uint - The Field bits of the fields kept at every site
+         * uint - Number of distributions per site in the region
+         * uint - Number of samples
+         * uint64 - The time step written at
+         * uint64 - Number of sites
+         * uint64 - Number of sites in the region
+         */
+        enum
+        {
+          PreambleLength = 48
+        };
+      }
+    }
+  }
+}
+#endif /* HEMELB_IO_FORMATS_FLIGHTRECORDER_H */
@@ -8,6 +8,7 @@
 #define HEMELB_IO_FORMATS_GEOMETRY_H
 
 #include <vector>
+#include <stdint.h>
 #include "io/formats/formats.h"
 #include "util/Vector3D.h"
 
@@ -106,7 +107,7 @@ namespace hemelb
            *  * 1 uint for the version
            *  * 3 uints for the problem dimensions in blocks
            *  * 1 uint for the number of sites along one block side
-           *  * 1 uint, value 0 to pad to 32 bytes
+           *  * 1 uint for the BlockCompression, which pads to 32 bytes
            *
            *  * 8 uints = 8 * 4  = 32
            */
@@ -115,6 +116,51 @@ namespace hemelb
             PreambleLength = 32
           };
 
+          /**
+           * How the data of each block is compressed, given by the last uint of the preamble.
+           * Files from before there was a choice have 0 there as padding, and so are zlib.
+           */
+          enum BlockCompression
+          {
+            ZLIB_COMPRESSION = 0, //!< Each block is a zlib stream
+            ZSTD_COMPRESSION = 1
+          //!< Each block is a zstd frame, maybe compressed with the file's dictionary
+          };
+
+          /**
+           * The longest zstd dictionary a file can have. A zstd file has space for one after the
+           * header, as 1 uint for the dictionary's length in bytes (0 if there isn't one) then
+           * this many bytes, holding the dictionary and zero padding. The blocks' data follow.
+           */
+          enum
+          {
+            MaxDictionaryLength = 1 << 16
+          };
+
+          /**
+           * The length of the dictionary space after the header.
+           * @param compression
+           * @return
+           */
+          static inline uint64_t GetDictionaryRecordLength(unsigned compression)
+          {
+            return compression == ZSTD_COMPRESSION
+              ? 4 + MaxDictionaryLength
+              : 0;
+          }
+
+          /**
+           * Where the first block's data starts in the file.
+           * @param blockCount
+           * @param compression
+           * @return
+           */
+          static inline uint64_t GetBlockDataStart(uint64_t blockCount, unsigned compression)
+          {
+            return PreambleLength + uint64_t(HeaderRecordLength) * blockCount
+                + GetDictionaryRecordLength(compression);
+          }
+
           /**
            * The length of a single header record (i.e. you have one of these
            * per block):
@@ -0,0 +1,77 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_IO_FORMATS_IMAGE_H
+#define HEMELB_IO_FORMATS_IMAGE_H
+
+namespace hemelb
+{
+  namespace io
+  {
+    namespace formats
+    {
+      namespace image
+      {
+        /**
+         * An image file (*.dat) is, in XDR:
+         * int - The visualisation mode
+         * float x 4 - The pressure threshold minimum and maximum, the maximum velocity and the
+         *     maximum stress
+         * int x 2 - The width and height of the screen in pixels
+         * int - The number of pixels
+         * then the pixels. So is the image in a steering frame, after its width and height and the
+         * length of its pixels in bytes.
+         *
+         * With RawEncoding, the pixels are written as they are, each one a uint holding its
+         * column and row (i << 16 + j) then three uints of colour, one byte for each of the four
+         * sub-images.
+         *
+         * With DeflateEncoding, they are an encoded block, which can't be mistaken for a raw pixel
+         * as it starts with formats::HemeLbMagicNumber:
+         * uint - formats::HemeLbMagicNumber
+         * uint - MagicNumber
+         * uint - VersionNumber
+         * uint - The Encoding
+         * uint - The number of pixels
+         * uint - The length of the compressed pixels in bytes
+         * and then the compressed pixels, padded with zeros to a multiple of four bytes. These are a
+         * zlib stream of the raw pixels sorted by position, with each position replaced by its
+         * difference from the one before (from zero for the first), and split into byte planes: the
+         * first big-endian byte of every pixel, then the second byte of every pixel, and so on for
+         * all sixteen.
+         */
+        enum
+        {
+          // ASCII for 'img' + EOF
+          MagicNumber = 0x696d6704
+        };
+
+        enum
+        {
+          VersionNumber = 1
+        };
+
+        /**
+         * How the pixels of an image are stored.
+         */
+        enum Encoding
+        {
+          RawEncoding = 0, //!< As they are
+          DeflateEncoding = 1 //!< Sorted, split into byte planes and compressed
+        };
+
+        /**
+         * The length of a raw pixel in bytes.
+         */
+        enum
+        {
+          PixelLength = 16
+        };
+      }
+    }
+  }
+}
+
+#endif /* HEMELB_IO_FORMATS_IMAGE_H */
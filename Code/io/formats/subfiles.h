@@ -0,0 +1,62 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_IO_FORMATS_SUBFILES_H
+#define HEMELB_IO_FORMATS_SUBFILES_H
+
+namespace hemelb
+{
+  namespace io
+  {
+    namespace formats
+    {
+      /**
+       * A subfile index stands in for a file that was written in parts, one by each group of
+       * cores (see SubfileGroup), and says where the parts are. Each part is a whole file of
+       * the kind given in the preamble, e.g. an extraction file or a checkpoint, with just the
+       * group's sites; read one after the other, the parts have all the sites. Everything is
+       * XDR encoded.
+       *
+       * After the preamble comes an entry for each part, in group order:
+       *  * string - The part's file name, relative to the directory of the index
+       *  * uint64 - The index of the part's first site in all the parts' sites
+       *  * uint64 - The number of sites in the part
+       */
+      namespace subfiles
+      {
+        /**
+         * Magic number to identify subfile indices.
+         * ASCII for 'sub' + EOF
+         */
+        enum
+        {
+          MagicNumber = 0x73756204
+        };
+
+        /**
+         * The version number of the file format.
+         */
+        enum
+        {
+          VersionNumber = 1
+        };
+
+        /**
+         * The length of the preamble. Made up of:
+         * uint - HemeLbMagicNumber
+         * uint - SubfilesMagicNumber
+         * uint - Format version number
+         * uint - The magic number of the format of the parts
+         * uint - Number of parts
+         */
+        enum
+        {
+          PreambleLength = 20
+        };
+      }
+    }
+  }
+}
+#endif /* HEMELB_IO_FORMATS_SUBFILES_H */
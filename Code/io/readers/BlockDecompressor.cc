@@ -0,0 +1,102 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <zlib.h>
+#ifdef HEMELB_USE_ZSTD
+#include <zstd.h>
+#endif
+#include "io/readers/BlockDecompressor.h"
+#include "io/formats/geometry.h"
+#include "Exception.h"
+
+namespace hemelb
+{
+  namespace io
+  {
+    namespace readers
+    {
+      BlockDecompressor::BlockDecompressor() :
+          compression(formats::geometry::ZLIB_COMPRESSION), dictionary(NULL)
+      {
+      }
+
+      BlockDecompressor::~BlockDecompressor()
+      {
+#ifdef HEMELB_USE_ZSTD
+        ZSTD_freeDDict(static_cast<ZSTD_DDict*>(dictionary));
+#endif
+      }
+
+      void BlockDecompressor::Reset(unsigned newCompression, const std::vector<char>& newDictionary)
+      {
+#ifdef HEMELB_USE_ZSTD
+        ZSTD_freeDDict(static_cast<ZSTD_DDict*>(dictionary));
+#endif
+        dictionary = NULL;
+        compression = formats::geometry::ZLIB_COMPRESSION;
+
+        switch (newCompression)
+        {
+          case formats::geometry::ZLIB_COMPRESSION:
+            break;
+          case formats::geometry::ZSTD_COMPRESSION:
+#ifdef HEMELB_USE_ZSTD
+            if (!newDictionary.empty())
+            {
+              dictionary = ZSTD_createDDict(&newDictionary[0], newDictionary.size());
+              if (dictionary == NULL)
+              {
+                throw Exception() << "Could not load the geometry's zstd dictionary";
+              }
+            }
+            break;
+#else
+            throw Exception() << "The geometry's blocks are compressed with zstd, which needs "
+                << "a build with HEMELB_USE_ZSTD";
+#endif
+          default:
+            throw Exception() << "Unknown geometry block compression " << newCompression;
+        }
+        compression = newCompression;
+      }
+
+      bool BlockDecompressor::Decompress(const char* data, size_t length, char* uncompressed,
+                                         size_t uncompressedLength) const
+      {
+        if (uncompressedLength == 0)
+        {
+          return length == 0;
+        }
+
+#ifdef HEMELB_USE_ZSTD
+        if (compression == formats::geometry::ZSTD_COMPRESSION)
+        {
+          ZSTD_DCtx* context = ZSTD_createDCtx();
+          if (context == NULL)
+          {
+            return false;
+          }
+          const size_t written = dictionary == NULL
+            ? ZSTD_decompressDCtx(context, uncompressed, uncompressedLength, data, length)
+            : ZSTD_decompress_usingDDict(context,
+                                         uncompressed,
+                                         uncompressedLength,
+                                         data,
+                                         length,
+                                         static_cast<const ZSTD_DDict*>(dictionary));
+          ZSTD_freeDCtx(context);
+          return !ZSTD_isError(written) && written == uncompressedLength;
+        }
+#endif
+
+        uLongf written = uncompressedLength;
+        return uncompress(reinterpret_cast<Bytef*>(uncompressed),
+                          &written,
+                          reinterpret_cast<const Bytef*>(data),
+                          length) == Z_OK && written == uncompressedLength;
+      }
+    }
+  }
+}
@@ -0,0 +1,84 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_IO_READERS_BLOCKDECOMPRESSOR_H
+#define HEMELB_IO_READERS_BLOCKDECOMPRESSOR_H
+
+#include <cstddef>
+#include <vector>
+
+namespace hemelb
+{
+  namespace io
+  {
+    namespace readers
+    {
+      /**
+       * Decompresses the blocks of a geometry file, with the compression given in its preamble
+       * (io::formats::geometry::BlockCompression) and, for zstd, the dictionary that follows its
+       * header. Safe to use from several threads at once.
+       */
+      class BlockDecompressor
+      {
+        public:
+          /**
+           * Decompress zlib blocks, as in files from before there was a choice.
+           */
+          BlockDecompressor();
+
+          ~BlockDecompressor();
+
+          /**
+           * Switch to the compression of another file. Throws an Exception if the compression
+           * isn't known, or is zstd in a build without HEMELB_USE_ZSTD.
+           * @param compression
+           * @param dictionary The zstd dictionary, if there is one.
+           */
+          void Reset(unsigned compression, const std::vector<char>& dictionary);
+
+          unsigned GetCompression() const
+          {
+            return compression;
+          }
+
+          /**
+           * Decompress a block.
+           * @param data The compressed data.
+           * @param length The length of the compressed data.
+           * @param uncompressed Sized to the length of the uncompressed data beforehand, which
+           * must be known.
+           * @return False if the data couldn't be decompressed to that length.
+           */
+          bool Decompress(const char* data, size_t length, std::vector<char>& uncompressed) const
+          {
+            return uncompressed.empty() ?
+              length == 0 :
+              Decompress(data, length, &uncompressed[0], uncompressed.size());
+          }
+
+          /**
+           * Decompress a block into a buffer of its uncompressed length.
+           * @param data The compressed data.
+           * @param length The length of the compressed data.
+           * @param uncompressed Where to put the uncompressed data.
+           * @param uncompressedLength The length of the uncompressed data, which must be known.
+           * @return False if the data couldn't be decompressed to that length.
+           */
+          bool Decompress(const char* data, size_t length, char* uncompressed,
+                          size_t uncompressedLength) const;
+
+        private:
+          BlockDecompressor(const BlockDecompressor&);
+          BlockDecompressor& operator=(const BlockDecompressor&);
+
+          unsigned compression;
+          //! The digested zstd dictionary, if there is one.
+          void* dictionary;
+      };
+    }
+  }
+}
+
+#endif /* HEMELB_IO_READERS_BLOCKDECOMPRESSOR_H */
@@ -0,0 +1,378 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+#include <zlib.h>
+#include "io/readers/ExtractionFile.h"
+#include "io/formats/formats.h"
+#include "Exception.h"
+
+namespace hemelb
+{
+  namespace io
+  {
+    namespace readers
+    {
+      namespace
+      {
+        uint64_t ReadBigEndian64(const char* bytes)
+        {
+          return (uint64_t(ReadBigEndian32(bytes)) << 32) | ReadBigEndian32(bytes + 4);
+        }
+      }
+
+      ExtractionFile::ExtractionFile(const std::string& path) :
+          file(path), version(0), voxelSize(0.), siteCount(0),
+              encoding(formats::extraction::Float32Encoding), siteLists(false),
+              surfaceSiteLists(false), valuesPerSite(0), bodyOffset(0), siteStride(0),
+              siteListStride(0), recordHeaderLength(0)
+      {
+        ReadHeaders();
+        IndexRecords();
+      }
+
+      void ExtractionFile::ReadHeaders()
+      {
+        writers::xdr::XdrMemReader mainHeader =
+            file.GetReader(0, formats::extraction::MainHeaderLength);
+        unsigned hemeLbMagic, extractionMagic, fieldCount, fieldHeaderLength;
+        mainHeader.readUnsignedInt(hemeLbMagic);
+        mainHeader.readUnsignedInt(extractionMagic);
+        mainHeader.readUnsignedInt(version);
+        if (hemeLbMagic != formats::HemeLbMagicNumber
+            || extractionMagic != formats::extraction::MagicNumber)
+        {
+          throw Exception() << file.GetPath() << " is not an extraction file";
+        }
+        if (version != formats::extraction::VersionNumber
+            && version != formats::extraction::SiteListVersionNumber
+            && version != formats::extraction::EncodedVersionNumber)
+        {
+          throw Exception() << file.GetPath() << " has unsupported extraction format version "
+              << version;
+        }
+        mainHeader.readDouble(voxelSize);
+        mainHeader.readDouble(origin.x);
+        mainHeader.readDouble(origin.y);
+        mainHeader.readDouble(origin.z);
+        mainHeader.readUnsignedLong(siteCount);
+        mainHeader.readUnsignedInt(fieldCount);
+        mainHeader.readUnsignedInt(fieldHeaderLength);
+
+        writers::xdr::XdrMemReader fieldHeader =
+            file.GetReader(formats::extraction::MainHeaderLength, fieldHeaderLength);
+        siteLists = version == formats::extraction::SiteListVersionNumber;
+        if (version == formats::extraction::EncodedVersionNumber)
+        {
+          unsigned storedEncoding, flags;
+          fieldHeader.readUnsignedInt(storedEncoding);
+          fieldHeader.readUnsignedInt(flags);
+          if (storedEncoding > formats::extraction::DeltaEncoding)
+          {
+            throw Exception() << file.GetPath() << " has unknown encoding " << storedEncoding;
+          }
+          encoding = formats::extraction::Encoding(storedEncoding);
+          siteLists = (flags & formats::extraction::SiteLists) != 0;
+          surfaceSiteLists = (flags & formats::extraction::SurfaceSiteLists) != 0;
+        }
+
+        fields.resize(fieldCount);
+        for (unsigned field = 0; field < fieldCount; ++field)
+        {
+          if (!fieldHeader.readString(fields[field].name)
+              || !fieldHeader.readUnsignedInt(fields[field].length)
+              || !fieldHeader.readDouble(fields[field].offset))
+          {
+            throw Exception() << file.GetPath() << " has a truncated field header";
+          }
+          valuesPerSite += fields[field].length;
+        }
+
+        bodyOffset = formats::extraction::MainHeaderLength + fieldHeaderLength;
+        // 16-bit values are padded to a multiple of four bytes at each site.
+        const size_t valueBytes = encoding == formats::extraction::Float32Encoding
+          ? 4 * valuesPerSite
+          : 4 * ( (valuesPerSite + 1) / 2);
+        siteStride = (siteLists
+          ? 0
+          : 12) + valueBytes;
+        siteListStride = surfaceSiteLists
+          ? 28
+          : 12;
+        recordHeaderLength = 8 + (encoding == formats::extraction::Fixed16Encoding
+          ? 16 * fieldCount
+          : 0);
+      }
+
+      void ExtractionFile::IndexRecords()
+      {
+        const bool deltas = encoding == formats::extraction::DeltaEncoding;
+        bool haveSiteList = false;
+        uint64_t siteListOffset = 0;
+
+        uint64_t offset = bodyOffset;
+        while (offset < file.GetSize())
+        {
+          file.CheckRange(offset, 8, "iteration number");
+          const uint64_t timestep = ReadBigEndian64(file.GetData() + offset);
+          if (siteLists && timestep == formats::extraction::SiteListMarker)
+          {
+            const uint64_t length = 8 + siteListStride * siteCount;
+            file.CheckRange(offset, length, "site list");
+            haveSiteList = true;
+            siteListOffset = offset + 8;
+            offset += length;
+            continue;
+          }
+
+          if (siteLists && !haveSiteList)
+          {
+            throw Exception() << file.GetPath() << " has a record before any site list";
+          }
+          if (!timesteps.empty() && timestep <= timesteps.back())
+          {
+            throw Exception() << file.GetPath() << " has its records out of order at time step "
+                << timestep;
+          }
+
+          const uint64_t length = GetRecordLength(offset);
+          file.CheckRange(offset, length, "record");
+          timesteps.push_back(timestep);
+          recordOffsets.push_back(offset);
+          if (siteLists)
+          {
+            siteListOffsets.push_back(siteListOffset);
+          }
+          if (deltas)
+          {
+            keyframes.push_back(ReadBigEndian32(file.GetData() + offset + 8) != 0);
+          }
+          offset += length;
+        }
+      }
+
+      uint64_t ExtractionFile::GetRecordLength(uint64_t offset) const
+      {
+        if (encoding != formats::extraction::DeltaEncoding)
+        {
+          return recordHeaderLength + siteStride * siteCount;
+        }
+
+        // The iteration number, keyframe flag, ranges and chunk count, then the chunk lengths
+        // and the chunks, each padded to four bytes.
+        const uint64_t fixedLength = 8 + 4 + 16 * fields.size() + 4;
+        file.CheckRange(offset, fixedLength, "record header");
+        const uint32_t chunkCount = ReadBigEndian32(file.GetData() + offset + fixedLength - 4);
+        file.CheckRange(offset + fixedLength, 4 * uint64_t(chunkCount), "chunk lengths");
+
+        uint64_t length = fixedLength + 4 * uint64_t(chunkCount);
+        for (uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+        {
+          const uint32_t chunkLength = ReadBigEndian32(file.GetData() + offset + fixedLength
+              + 4 * chunk);
+          length += 4 * ( (uint64_t(chunkLength) + 3) / 4);
+        }
+        return length;
+      }
+
+      unsigned ExtractionFile::FindField(const std::string& name) const
+      {
+        for (unsigned field = 0; field < fields.size(); ++field)
+        {
+          if (fields[field].name == name)
+          {
+            return field;
+          }
+        }
+        throw Exception() << file.GetPath() << " has no field " << name;
+      }
+
+      size_t ExtractionFile::FindRecord(uint64_t timestep) const
+      {
+        const std::vector<uint64_t>::const_iterator found = std::lower_bound(timesteps.begin(),
+                                                                             timesteps.end(),
+                                                                             timestep);
+        if (found == timesteps.end() || *found != timestep)
+        {
+          throw Exception() << file.GetPath() << " has no record for time step " << timestep;
+        }
+        return found - timesteps.begin();
+      }
+
+      PositionView ExtractionFile::GetPositions(size_t record) const
+      {
+        if (siteLists)
+        {
+          return PositionView(file.GetData() + siteListOffsets[record],
+                              siteCount,
+                              siteListStride,
+                              surfaceSiteLists);
+        }
+        return PositionView(file.GetData() + recordOffsets[record] + recordHeaderLength,
+                            siteCount,
+                            siteStride,
+                            false);
+      }
+
+      FieldView ExtractionFile::GetFieldView(size_t record, unsigned field) const
+      {
+        if (encoding == formats::extraction::DeltaEncoding)
+        {
+          throw Exception() << file.GetPath()
+              << " is delta encoded, so its records have to be decoded whole";
+        }
+
+        unsigned firstValue = 0;
+        for (unsigned before = 0; before < field; ++before)
+        {
+          firstValue += fields[before].length;
+        }
+        const size_t bytesPerValue = encoding == formats::extraction::Float32Encoding
+          ? 4
+          : 2;
+        const char* const first = file.GetData() + recordOffsets[record] + recordHeaderLength
+            + (siteLists
+              ? 0
+              : 12) + bytesPerValue * firstValue;
+
+        double minimum = 0., scale = 0.;
+        if (encoding == formats::extraction::Fixed16Encoding)
+        {
+          std::vector<double> minima, scales;
+          ReadRanges(record, minima, scales);
+          minimum = minima[field];
+          scale = scales[field];
+        }
+        return FieldView(first,
+                         siteCount,
+                         siteStride,
+                         fields[field].length,
+                         encoding,
+                         fields[field].offset,
+                         minimum,
+                         scale);
+      }
+
+      void ExtractionFile::ReadRanges(size_t record, std::vector<double>& minimum,
+                                      std::vector<double>& scale) const
+      {
+        // After the iteration number, and the keyframe flag of a delta encoded record.
+        const uint64_t offset = recordOffsets[record] + (encoding
+            == formats::extraction::DeltaEncoding
+          ? 12
+          : 8);
+        writers::xdr::XdrMemReader reader = file.GetReader(offset, 16 * fields.size());
+        minimum.resize(fields.size());
+        scale.resize(fields.size());
+        for (unsigned field = 0; field < fields.size(); ++field)
+        {
+          reader.readDouble(minimum[field]);
+          reader.readDouble(scale[field]);
+        }
+      }
+
+      void ExtractionFile::DecodeRecord(size_t record, std::vector<float>& values) const
+      {
+        values.resize(siteCount * valuesPerSite);
+        if (encoding != formats::extraction::DeltaEncoding)
+        {
+          unsigned firstValue = 0;
+          for (unsigned field = 0; field < fields.size(); ++field)
+          {
+            const FieldView view = GetFieldView(record, field);
+            for (uint64_t site = 0; site < siteCount; ++site)
+            {
+              for (unsigned component = 0; component < view.GetLength(); ++component)
+              {
+                values[site * valuesPerSite + firstValue + component] =
+                    float(view.Get(site, component));
+              }
+            }
+            firstValue += view.GetLength();
+          }
+          return;
+        }
+
+        // Add up the differences from the last keyframe.
+        size_t keyframe = record;
+        while (!keyframes[keyframe])
+        {
+          if (keyframe == 0)
+          {
+            throw Exception() << file.GetPath() << " has no keyframe before record " << record;
+          }
+          --keyframe;
+        }
+        std::vector<int32_t> quantised(values.size(), 0);
+        for (size_t delta = keyframe; delta <= record; ++delta)
+        {
+          AddDeltas(delta, quantised);
+        }
+
+        std::vector<double> minimum, scale;
+        ReadRanges(record, minimum, scale);
+        std::vector<unsigned> fieldOfValue;
+        for (unsigned field = 0; field < fields.size(); ++field)
+        {
+          fieldOfValue.insert(fieldOfValue.end(), fields[field].length, field);
+        }
+        for (size_t value = 0; value < values.size(); ++value)
+        {
+          const unsigned field = fieldOfValue[value % valuesPerSite];
+          values[value] = float(fields[field].offset + minimum[field]
+              + scale[field] * quantised[value]);
+        }
+      }
+
+      void ExtractionFile::AddDeltas(size_t record, std::vector<int32_t>& quantised) const
+      {
+        const uint64_t fixedLength = 8 + 4 + 16 * fields.size() + 4;
+        const char* const header = file.GetData() + recordOffsets[record];
+        const uint32_t chunkCount = ReadBigEndian32(header + fixedLength - 4);
+        const char* chunk = header + fixedLength + 4 * chunkCount;
+
+        size_t done = 0;
+        std::vector<Bytef> planes;
+        for (uint32_t chunkNumber = 0; chunkNumber < chunkCount; ++chunkNumber)
+        {
+          const uint32_t chunkLength = ReadBigEndian32(header + fixedLength + 4 * chunkNumber);
+          if (chunkLength > 0)
+          {
+            // Each chunk holds whole values, of which there can be no more than are left.
+            planes.resize(4 * (quantised.size() - done));
+            uLongf planesLength = planes.size();
+            if (planes.empty()
+                || uncompress(&planes[0],
+                              &planesLength,
+                              reinterpret_cast<const Bytef*>(chunk),
+                              chunkLength) != Z_OK || planesLength % 4 != 0)
+            {
+              throw Exception() << file.GetPath() << " has a corrupt chunk in record " << record;
+            }
+
+            // Put the byte planes back together, and undo the zigzag.
+            const size_t count = planesLength / 4;
+            for (size_t value = 0; value < count; ++value)
+            {
+              const uint32_t zigzag = (uint32_t(planes[value]) << 24)
+                  | (uint32_t(planes[count + value]) << 16)
+                  | (uint32_t(planes[2 * count + value]) << 8) | uint32_t(planes[3 * count + value]);
+              const uint32_t difference = (zigzag >> 1) ^ (0u - (zigzag & 1));
+              quantised[done + value] = int32_t(uint32_t(quantised[done + value]) + difference);
+            }
+            done += count;
+          }
+          chunk += 4 * ( (chunkLength + 3) / 4);
+        }
+
+        if (done != quantised.size())
+        {
+          throw Exception() << file.GetPath() << " has " << done << " values in record "
+              << record << " rather than " << quantised.size();
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,189 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_IO_READERS_EXTRACTIONFILE_H
+#define HEMELB_IO_READERS_EXTRACTIONFILE_H
+
+#include <string>
+#include <vector>
+#include "io/readers/FieldView.h"
+#include "io/readers/MappedFile.h"
+
+namespace hemelb
+{
+  namespace io
+  {
+    namespace readers
+    {
+      /**
+       * Reads a property extraction file (*.xtr), of any version from 4 on, by mapping it into
+       * memory.
+       *
+       * Opening the file reads the headers and makes an index of where each record, and the
+       * site list that goes with it, starts. With the positions in every record or unchanging
+       * site lists, that only reads the iteration number at the start of each record; the
+       * records in between aren't touched. Any record can then be looked at directly, through
+       * views of its fields that decode values only as they are read. Delta encoded records
+       * depend on the records before them, so those are decoded whole by DecodeRecord.
+       */
+      class ExtractionFile
+      {
+        public:
+          /**
+           * What the field header says about a field.
+           */
+          struct FieldHeader
+          {
+              std::string name;
+              //! The number of values at each site.
+              unsigned length;
+              //! Added to every stored value.
+              double offset;
+          };
+
+          /**
+           * Map the file, and read its headers and index its records. Throws an Exception if
+           * the file is malformed.
+           * @param path
+           */
+          explicit ExtractionFile(const std::string& path);
+
+          const std::string& GetPath() const
+          {
+            return file.GetPath();
+          }
+
+          unsigned GetVersion() const
+          {
+            return version;
+          }
+
+          double GetVoxelSize() const
+          {
+            return voxelSize;
+          }
+
+          const util::Vector3D<double>& GetOrigin() const
+          {
+            return origin;
+          }
+
+          uint64_t GetSiteCount() const
+          {
+            return siteCount;
+          }
+
+          formats::extraction::Encoding GetEncoding() const
+          {
+            return encoding;
+          }
+
+          const std::vector<FieldHeader>& GetFields() const
+          {
+            return fields;
+          }
+
+          /**
+           * Returns the number of the field with the given name, throwing if there isn't one.
+           * @param name
+           * @return
+           */
+          unsigned FindField(const std::string& name) const;
+
+          size_t GetRecordCount() const
+          {
+            return timesteps.size();
+          }
+
+          uint64_t GetTimestep(size_t record) const
+          {
+            return timesteps[record];
+          }
+
+          /**
+           * Returns the number of the record for a time step, throwing if there isn't one.
+           * @param timestep
+           * @return
+           */
+          size_t FindRecord(uint64_t timestep) const;
+
+          /**
+           * Returns the positions of the sites of a record.
+           * @param record
+           * @return
+           */
+          PositionView GetPositions(size_t record) const;
+
+          /**
+           * Returns a view of one field of a record. Not for delta encoded files.
+           * @param record
+           * @param field
+           * @return
+           */
+          FieldView GetFieldView(size_t record, unsigned field) const;
+
+          /**
+           * Decode all the values of a record, with the fields' offsets added, site by site, of
+           * any encoding.
+           * @param record
+           * @param values Set to the values of every field at each site in turn.
+           */
+          void DecodeRecord(size_t record, std::vector<float>& values) const;
+
+        private:
+          void ReadHeaders();
+          void IndexRecords();
+
+          /**
+           * Returns the length in bytes of the record starting at the offset, reading its
+           * header if the records are delta encoded.
+           * @param offset
+           * @return
+           */
+          uint64_t GetRecordLength(uint64_t offset) const;
+
+          /**
+           * Read the minimum and scale of each field from the header of a quantised record.
+           */
+          void ReadRanges(size_t record, std::vector<double>& minimum,
+                          std::vector<double>& scale) const;
+
+          /**
+           * Add the stored values of a delta encoded record, which are the quantised values
+           * themselves for a keyframe, to the quantised values.
+           */
+          void AddDeltas(size_t record, std::vector<int32_t>& quantised) const;
+
+          MappedFile file;
+          unsigned version;
+          double voxelSize;
+          util::Vector3D<double> origin;
+          uint64_t siteCount;
+          formats::extraction::Encoding encoding;
+          bool siteLists;
+          bool surfaceSiteLists;
+          std::vector<FieldHeader> fields;
+          unsigned valuesPerSite;
+          //! Where the records start, after both headers.
+          uint64_t bodyOffset;
+          //! The bytes from one site's values in a record to the next's, with any position.
+          size_t siteStride;
+          //! The bytes from one site's position in a site list to the next's.
+          size_t siteListStride;
+          //! The bytes at the start of a record before the sites, for fixed length records.
+          size_t recordHeaderLength;
+
+          std::vector<uint64_t> timesteps;
+          std::vector<uint64_t> recordOffsets;
+          //! Where the positions of each record's site list start, if there are site lists.
+          std::vector<uint64_t> siteListOffsets;
+          //! Whether each delta encoded record is a keyframe.
+          std::vector<bool> keyframes;
+      };
+    }
+  }
+}
+
+#endif /* HEMELB_IO_READERS_EXTRACTIONFILE_H */
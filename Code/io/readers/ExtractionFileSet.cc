@@ -0,0 +1,122 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "io/readers/ExtractionFileSet.h"
+#include "io/SubfileIndex.h"
+#include "io/formats/extraction.h"
+#include "Exception.h"
+
+namespace hemelb
+{
+  namespace io
+  {
+    namespace readers
+    {
+      ExtractionFileSet::ExtractionFileSet(const std::string& path) :
+          siteCount(0)
+      {
+        if (!SubfileIndex::IsIndex(path))
+        {
+          parts.push_back(new ExtractionFile(path));
+          firstSites.push_back(0);
+          siteCount = parts.front()->GetSiteCount();
+          return;
+        }
+
+        const SubfileIndex index = SubfileIndex::Read(path);
+        if (index.GetFormatMagic() != formats::extraction::MagicNumber)
+        {
+          throw Exception() << path << " is not the index of an extraction file";
+        }
+        if (index.GetParts().empty())
+        {
+          throw Exception() << "Subfile index " << path << " has no parts";
+        }
+
+        try
+        {
+          for (std::vector<SubfileIndex::Part>::const_iterator part = index.GetParts().begin();
+              part != index.GetParts().end(); ++part)
+          {
+            parts.push_back(new ExtractionFile(part->path));
+            if (parts.back()->GetSiteCount() != part->siteCount)
+            {
+              throw Exception() << part->path << " has " << parts.back()->GetSiteCount()
+                  << " sites, but its index " << path << " says " << part->siteCount;
+            }
+            CheckMatchesFirstPart(*parts.back());
+            firstSites.push_back(part->firstSite);
+          }
+        }
+        catch (...)
+        {
+          for (size_t part = 0; part < parts.size(); ++part)
+          {
+            delete parts[part];
+          }
+          throw;
+        }
+        siteCount = index.GetSiteCount();
+      }
+
+      ExtractionFileSet::~ExtractionFileSet()
+      {
+        for (size_t part = 0; part < parts.size(); ++part)
+        {
+          delete parts[part];
+        }
+      }
+
+      void ExtractionFileSet::CheckMatchesFirstPart(const ExtractionFile& part) const
+      {
+        const ExtractionFile& first = GetFirstPart();
+        bool matches = part.GetVersion() == first.GetVersion()
+            && part.GetEncoding() == first.GetEncoding()
+            && part.GetFields().size() == first.GetFields().size()
+            && part.GetRecordCount() == first.GetRecordCount();
+        for (unsigned field = 0; matches && field < first.GetFields().size(); ++field)
+        {
+          matches = part.GetFields()[field].name == first.GetFields()[field].name
+              && part.GetFields()[field].length == first.GetFields()[field].length;
+        }
+        for (size_t record = 0; matches && record < first.GetRecordCount(); ++record)
+        {
+          matches = part.GetTimestep(record) == first.GetTimestep(record);
+        }
+        if (!matches)
+        {
+          throw Exception() << "Extraction file " << part.GetPath()
+              << " doesn't have the same fields and time steps as its other parts";
+        }
+      }
+
+      void ExtractionFileSet::GetPositions(size_t record,
+                                           std::vector<util::Vector3D<site_t> >& positions) const
+      {
+        positions.clear();
+        positions.reserve(siteCount);
+        for (size_t part = 0; part < parts.size(); ++part)
+        {
+          const PositionView partPositions = parts[part]->GetPositions(record);
+          for (uint64_t site = 0; site < partPositions.GetSiteCount(); ++site)
+          {
+            positions.push_back(partPositions.GetPosition(site));
+          }
+        }
+      }
+
+      void ExtractionFileSet::DecodeRecord(size_t record, std::vector<float>& values) const
+      {
+        parts.front()->DecodeRecord(record, values);
+        std::vector<float> partValues;
+        for (size_t part = 1; part < parts.size(); ++part)
+        {
+          parts[part]->DecodeRecord(record, partValues);
+          values.insert(values.end(), partValues.begin(), partValues.end());
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,104 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_IO_READERS_EXTRACTIONFILESET_H
+#define HEMELB_IO_READERS_EXTRACTIONFILESET_H
+
+#include <string>
+#include <vector>
+#include "io/readers/ExtractionFile.h"
+
+namespace hemelb
+{
+  namespace io
+  {
+    namespace readers
+    {
+      /**
+       * Reads property extraction output that is either one extraction file or written in parts
+       * with a subfile index (see io/formats/subfiles.h), as if it were one file. The parts are
+       * each mapped as an ExtractionFile, and their sites come one part after the other.
+       *
+       * The headers and records are the same in every part, so they are read from the first;
+       * the sites' positions and values are gathered from all of them.
+       */
+      class ExtractionFileSet
+      {
+        public:
+          /**
+           * Map the file, or the parts of the index, throwing an Exception if they are
+           * malformed or don't go together.
+           * @param path
+           */
+          explicit ExtractionFileSet(const std::string& path);
+
+          ~ExtractionFileSet();
+
+          size_t GetPartCount() const
+          {
+            return parts.size();
+          }
+
+          const ExtractionFile& GetPart(size_t part) const
+          {
+            return *parts[part];
+          }
+
+          /**
+           * @param part
+           * @return The index of the part's first site among all the sites.
+           */
+          uint64_t GetFirstSite(size_t part) const
+          {
+            return firstSites[part];
+          }
+
+          uint64_t GetSiteCount() const
+          {
+            return siteCount;
+          }
+
+          /**
+           * @return The first part, for the headers and records that all the parts share.
+           */
+          const ExtractionFile& GetFirstPart() const
+          {
+            return *parts.front();
+          }
+
+          /**
+           * Returns the positions of all the sites of a record.
+           * @param record
+           * @param positions
+           */
+          void GetPositions(size_t record, std::vector<util::Vector3D<site_t> >& positions) const;
+
+          /**
+           * Decode all the values of a record of every part, as ExtractionFile::DecodeRecord.
+           * @param record
+           * @param values
+           */
+          void DecodeRecord(size_t record, std::vector<float>& values) const;
+
+        private:
+          // Not copyable, as the parts belong to this.
+          ExtractionFileSet(const ExtractionFileSet&);
+          ExtractionFileSet& operator=(const ExtractionFileSet&);
+
+          /**
+           * Check that a part has the same fields and records as the first.
+           * @param part
+           */
+          void CheckMatchesFirstPart(const ExtractionFile& part) const;
+
+          std::vector<ExtractionFile*> parts;
+          std::vector<uint64_t> firstSites;
+          uint64_t siteCount;
+      };
+    }
+  }
+}
+
+#endif /* HEMELB_IO_READERS_EXTRACTIONFILESET_H */
@@ -0,0 +1,181 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_IO_READERS_FIELDVIEW_H
+#define HEMELB_IO_READERS_FIELDVIEW_H
+
+#include <cstring>
+#include "io/formats/extraction.h"
+#include "units.h"
+#include "util/HalfPrecision.h"
+
+namespace hemelb
+{
+  namespace io
+  {
+    namespace readers
+    {
+      /**
+       * Big-endian integers from memory, as XDR stores them.
+       */
+      inline uint16_t ReadBigEndian16(const char* bytes)
+      {
+        const unsigned char* const b = reinterpret_cast<const unsigned char*>(bytes);
+        return uint16_t( (b[0] << 8) | b[1]);
+      }
+
+      inline uint32_t ReadBigEndian32(const char* bytes)
+      {
+        const unsigned char* const b = reinterpret_cast<const unsigned char*>(bytes);
+        return (uint32_t(b[0]) << 24) | (uint32_t(b[1]) << 16) | (uint32_t(b[2]) << 8)
+            | uint32_t(b[3]);
+      }
+
+      inline float ReadBigEndianFloat(const char* bytes)
+      {
+        const uint32_t bits = ReadBigEndian32(bytes);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+      }
+
+      /**
+       * One field of one record of an extraction file, read straight from the mapped file.
+       * Nothing is copied or decoded until a value is asked for, so looking at a few sites of a
+       * huge record only touches the pages those sites are on.
+       */
+      class FieldView
+      {
+        public:
+          /**
+           * @param first The field's first value at the first site.
+           * @param siteCount
+           * @param siteStride The number of bytes from one site's values to the next's.
+           * @param length The number of values in the field at each site.
+           * @param encoding Float32, Float16 or Fixed16.
+           * @param offset The field's offset, which is added to every value.
+           * @param minimum The minimum of the record's quantised values, with Fixed16Encoding.
+           * @param scale The scale of the record's quantised values, with Fixed16Encoding.
+           */
+          FieldView(const char* first, uint64_t siteCount, size_t siteStride, unsigned length,
+                    formats::extraction::Encoding encoding, double offset, double minimum = 0.,
+                    double scale = 0.) :
+              first(first), siteCount(siteCount), siteStride(siteStride), length(length),
+                  encoding(encoding), offset(offset), minimum(minimum), scale(scale)
+          {
+          }
+
+          uint64_t GetSiteCount() const
+          {
+            return siteCount;
+          }
+
+          unsigned GetLength() const
+          {
+            return length;
+          }
+
+          /**
+           * Returns a value of the field at a site, including the field's offset.
+           * @param site
+           * @param component
+           * @return
+           */
+          double Get(uint64_t site, unsigned component = 0) const
+          {
+            const char* const siteValues = first + site * siteStride;
+            switch (encoding)
+            {
+              case formats::extraction::Float32Encoding:
+                return offset + ReadBigEndianFloat(siteValues + 4 * component);
+              case formats::extraction::Float16Encoding:
+                return offset + util::HalfToFloat(ReadBigEndian16(siteValues + 2 * component));
+              default:
+                return offset + minimum + scale * ReadBigEndian16(siteValues + 2 * component);
+            }
+          }
+
+        private:
+          const char* first;
+          uint64_t siteCount;
+          size_t siteStride;
+          unsigned length;
+          formats::extraction::Encoding encoding;
+          double offset;
+          double minimum;
+          double scale;
+      };
+
+      /**
+       * The grid positions of the sites of a record, read straight from the mapped file, either
+       * from the record itself or from the site list it goes with. Surface site lists also have
+       * each site's wall normal and area.
+       */
+      class PositionView
+      {
+        public:
+          /**
+           * @param first The first site's position.
+           * @param siteCount
+           * @param siteStride The number of bytes from one site's position to the next's.
+           * @param surface Whether the positions are followed by wall normals and areas.
+           */
+          PositionView(const char* first, uint64_t siteCount, size_t siteStride, bool surface) :
+              first(first), siteCount(siteCount), siteStride(siteStride), surface(surface)
+          {
+          }
+
+          uint64_t GetSiteCount() const
+          {
+            return siteCount;
+          }
+
+          bool HasWallData() const
+          {
+            return surface;
+          }
+
+          util::Vector3D<site_t> GetPosition(uint64_t site) const
+          {
+            const char* const position = first + site * siteStride;
+            return util::Vector3D<site_t>(ReadBigEndian32(position),
+                                          ReadBigEndian32(position + 4),
+                                          ReadBigEndian32(position + 8));
+          }
+
+          /**
+           * The wall normal at a site, zero away from the wall. Only for surface site lists.
+           * @param site
+           * @return
+           */
+          util::Vector3D<float> GetWallNormal(uint64_t site) const
+          {
+            const char* const normal = first + site * siteStride + 12;
+            return util::Vector3D<float>(ReadBigEndianFloat(normal),
+                                         ReadBigEndianFloat(normal + 4),
+                                         ReadBigEndianFloat(normal + 8));
+          }
+
+          /**
+           * The area of wall a site stands for, in square metres. Only for surface site lists.
+           * @param site
+           * @return
+           */
+          float GetWallArea(uint64_t site) const
+          {
+            return ReadBigEndianFloat(first + site * siteStride + 24);
+          }
+
+        private:
+          const char* first;
+          uint64_t siteCount;
+          size_t siteStride;
+          bool surface;
+      };
+    }
+  }
+}
+
+#endif /* HEMELB_IO_READERS_FIELDVIEW_H */
@@ -0,0 +1,166 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "io/readers/GeometryFile.h"
+#include "io/formats/formats.h"
+#include "io/formats/geometry.h"
+#include "Exception.h"
+
+namespace hemelb
+{
+  namespace io
+  {
+    namespace readers
+    {
+      namespace
+      {
+        /**
+         * Parse a site as it is in the file, keeping its links in the file's order.
+         * @param reader
+         * @return
+         */
+        geometry::GeometrySite ParseSite(writers::xdr::XdrReader& reader)
+        {
+          unsigned isFluid = 0;
+          reader.readUnsignedInt(isFluid);
+          geometry::GeometrySite site(isFluid == formats::geometry::FLUID);
+          if (!site.isFluid)
+          {
+            return site;
+          }
+
+          for (unsigned direction = 0; direction < formats::geometry::NumberOfDisplacements;
+              ++direction)
+          {
+            geometry::GeometrySiteLink link;
+            unsigned intersectionType;
+            reader.readUnsignedInt(intersectionType);
+            link.type = geometry::GeometrySiteLink::IntersectionType(intersectionType);
+            if (link.type == geometry::GeometrySiteLink::WALL_INTERSECTION)
+            {
+              reader.readFloat(link.distanceToIntersection);
+            }
+            else if (link.type != geometry::GeometrySiteLink::NO_INTERSECTION)
+            {
+              unsigned ioletId;
+              reader.readUnsignedInt(ioletId);
+              reader.readFloat(link.distanceToIntersection);
+              link.ioletId = ioletId;
+            }
+            site.SetLink(direction, link);
+          }
+
+          unsigned normalAvailable;
+          reader.readUnsignedInt(normalAvailable);
+          site.wallNormalAvailable = normalAvailable == formats::geometry::WALL_NORMAL_AVAILABLE;
+          if (site.wallNormalAvailable)
+          {
+            reader.readFloat(site.wallNormal.x);
+            reader.readFloat(site.wallNormal.y);
+            reader.readFloat(site.wallNormal.z);
+          }
+          return site;
+        }
+      }
+
+      GeometryFile::GeometryFile(const std::string& path) :
+          file(path), blockSize(0)
+      {
+        writers::xdr::XdrMemReader preamble =
+            file.GetReader(0, formats::geometry::PreambleLength);
+        unsigned hemeLbMagic, geometryMagic, version, blocksX, blocksY, blocksZ, sitesPerSide,
+            compression;
+        preamble.readUnsignedInt(hemeLbMagic);
+        preamble.readUnsignedInt(geometryMagic);
+        preamble.readUnsignedInt(version);
+        if (hemeLbMagic != formats::HemeLbMagicNumber
+            || geometryMagic != formats::geometry::MagicNumber)
+        {
+          throw Exception() << path << " is not a geometry file";
+        }
+        if (version != formats::geometry::VersionNumber)
+        {
+          throw Exception() << path << " has geometry format version " << version
+              << " rather than " << formats::geometry::VersionNumber;
+        }
+        preamble.readUnsignedInt(blocksX);
+        preamble.readUnsignedInt(blocksY);
+        preamble.readUnsignedInt(blocksZ);
+        preamble.readUnsignedInt(sitesPerSide);
+        preamble.readUnsignedInt(compression);
+        blockDimensions = util::Vector3D<site_t>(blocksX, blocksY, blocksZ);
+        blockSize = sitesPerSide;
+
+        // The block headers, then any zstd dictionary, then each block's data in turn.
+        const uint64_t blockCount = uint64_t(blocksX) * blocksY * blocksZ;
+        const uint64_t headerLength = formats::geometry::HeaderRecordLength * blockCount;
+        file.CheckRange(formats::geometry::PreambleLength, headerLength, "block headers");
+        const char* header = file.GetData() + formats::geometry::PreambleLength;
+        const uint64_t dataStart = formats::geometry::GetBlockDataStart(blockCount, compression);
+
+        std::vector<char> dictionary;
+        if (compression == formats::geometry::ZSTD_COMPRESSION)
+        {
+          const uint64_t dictionaryStart = formats::geometry::PreambleLength + headerLength;
+          file.CheckRange(dictionaryStart, dataStart - dictionaryStart, "zstd dictionary");
+          writers::xdr::XdrMemReader dictionaryLength = file.GetReader(dictionaryStart, 4);
+          unsigned length;
+          dictionaryLength.readUnsignedInt(length);
+          if (length > formats::geometry::MaxDictionaryLength)
+          {
+            throw Exception() << path << " has a zstd dictionary too long for its space";
+          }
+          dictionary.assign(file.GetData() + dictionaryStart + 4,
+                            file.GetData() + dictionaryStart + 4 + length);
+        }
+        decompressor.Reset(compression, dictionary);
+
+        uint64_t offset = dataStart;
+        for (uint64_t block = 0; block < blockCount; ++block)
+        {
+          writers::xdr::XdrMemReader reader(const_cast<char*>(header
+                                                + formats::geometry::HeaderRecordLength * block),
+                                            formats::geometry::HeaderRecordLength);
+          unsigned fluidSites, compressed, uncompressed;
+          reader.readUnsignedInt(fluidSites);
+          reader.readUnsignedInt(compressed);
+          reader.readUnsignedInt(uncompressed);
+          fluidSiteCounts.push_back(fluidSites);
+          compressedLengths.push_back(compressed);
+          uncompressedLengths.push_back(uncompressed);
+          blockOffsets.push_back(offset);
+          offset += compressed;
+        }
+        file.CheckRange(dataStart, offset - dataStart, "block data");
+      }
+
+      void GeometryFile::ReadBlock(site_t block, std::vector<geometry::GeometrySite>& sites) const
+      {
+        sites.clear();
+        // A block without fluid sites has no data.
+        if (fluidSiteCounts[block] == 0)
+        {
+          sites.resize(GetSitesPerBlock(), geometry::GeometrySite(false));
+          return;
+        }
+
+        std::vector<char> data(uncompressedLengths[block]);
+        if (!decompressor.Decompress(file.GetData() + blockOffsets[block],
+                                     compressedLengths[block],
+                                     data))
+        {
+          throw Exception() << file.GetPath() << " has a corrupt block " << block;
+        }
+
+        writers::xdr::XdrMemReader reader(&data[0], data.size());
+        sites.reserve(GetSitesPerBlock());
+        for (site_t site = 0; site < GetSitesPerBlock(); ++site)
+        {
+          sites.push_back(ParseSite(reader));
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,98 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_IO_READERS_GEOMETRYFILE_H
+#define HEMELB_IO_READERS_GEOMETRYFILE_H
+
+#include <string>
+#include <vector>
+#include "geometry/GeometrySite.h"
+#include "io/readers/BlockDecompressor.h"
+#include "io/readers/MappedFile.h"
+
+namespace hemelb
+{
+  namespace io
+  {
+    namespace readers
+    {
+      /**
+       * Reads a geometry file (*.gmy) by mapping it into memory, without MPI.
+       *
+       * Opening the file reads the preamble and the block headers, and works out where each
+       * block's compressed data starts, so that any block can then be decompressed on its own
+       * without reading the others.
+       */
+      class GeometryFile
+      {
+        public:
+          /**
+           * Map the file and read its headers. Throws an Exception if the file is malformed.
+           * @param path
+           */
+          explicit GeometryFile(const std::string& path);
+
+          const util::Vector3D<site_t>& GetBlockDimensions() const
+          {
+            return blockDimensions;
+          }
+
+          site_t GetBlockSize() const
+          {
+            return blockSize;
+          }
+
+          site_t GetBlockCount() const
+          {
+            return fluidSiteCounts.size();
+          }
+
+          site_t GetSitesPerBlock() const
+          {
+            return blockSize * blockSize * blockSize;
+          }
+
+          site_t GetFluidSiteCount(site_t block) const
+          {
+            return fluidSiteCounts[block];
+          }
+
+          /**
+           * Returns the number of the block at the given block coordinates, in the file's order.
+           * @param blockCoordinates
+           * @return
+           */
+          site_t GetBlockNumber(const util::Vector3D<site_t>& blockCoordinates) const
+          {
+            return (blockCoordinates.x * blockDimensions.y + blockCoordinates.y)
+                * blockDimensions.z + blockCoordinates.z;
+          }
+
+          /**
+           * Decompress and parse one block. The sites are in the file's order, with the index of
+           * the site at (i, j, k) within the block being (i * blockSize + j) * blockSize + k. The
+           * links of each fluid site are in the order of the file's neighbourhood,
+           * io::formats::geometry::GetNeighbourhood, rather than of any lattice.
+           * @param block
+           * @param sites Set to the sites of the block.
+           */
+          void ReadBlock(site_t block, std::vector<geometry::GeometrySite>& sites) const;
+
+        private:
+          MappedFile file;
+          util::Vector3D<site_t> blockDimensions;
+          site_t blockSize;
+          std::vector<unsigned> fluidSiteCounts;
+          std::vector<unsigned> compressedLengths;
+          std::vector<unsigned> uncompressedLengths;
+          //! Where each block's compressed data start.
+          std::vector<uint64_t> blockOffsets;
+          BlockDecompressor decompressor;
+      };
+    }
+  }
+}
+
+#endif /* HEMELB_IO_READERS_GEOMETRYFILE_H */
@@ -0,0 +1,79 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "io/readers/MappedFile.h"
+#include "Exception.h"
+
+namespace hemelb
+{
+  namespace io
+  {
+    namespace readers
+    {
+      MappedFile::MappedFile(const std::string& path) :
+          path(path), data(NULL), size(0)
+      {
+        const int descriptor = open(path.c_str(), O_RDONLY);
+        if (descriptor < 0)
+        {
+          throw Exception() << "Could not open " << path << ": " << std::strerror(errno);
+        }
+
+        struct stat status;
+        if (fstat(descriptor, &status) != 0)
+        {
+          const int error = errno;
+          close(descriptor);
+          throw Exception() << "Could not find the size of " << path << ": "
+              << std::strerror(error);
+        }
+        size = status.st_size;
+
+        // An empty file can't be mapped, but then there's nothing to read either.
+        if (size > 0)
+        {
+          void* mapping = mmap(NULL, size, PROT_READ, MAP_SHARED, descriptor, 0);
+          if (mapping == MAP_FAILED)
+          {
+            const int error = errno;
+            close(descriptor);
+            throw Exception() << "Could not map " << path << ": " << std::strerror(error);
+          }
+          data = static_cast<const char*>(mapping);
+        }
+        // The mapping stays valid without the descriptor.
+        close(descriptor);
+      }
+
+      MappedFile::~MappedFile()
+      {
+        if (data != NULL)
+        {
+          munmap(const_cast<char*>(data), size);
+        }
+      }
+
+      void MappedFile::CheckRange(uint64_t offset, uint64_t length, const char* what) const
+      {
+        if (offset > size || length > size - offset)
+        {
+          throw Exception() << path << " is too short for the " << what << " at byte " << offset;
+        }
+      }
+
+      writers::xdr::XdrMemReader MappedFile::GetReader(uint64_t offset, unsigned length) const
+      {
+        CheckRange(offset, length, "data");
+        return writers::xdr::XdrMemReader(const_cast<char*>(data + offset), length);
+      }
+    }
+  }
+}
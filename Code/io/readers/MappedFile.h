@@ -0,0 +1,78 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_IO_READERS_MAPPEDFILE_H
+#define HEMELB_IO_READERS_MAPPEDFILE_H
+
+#include <string>
+#include "io/writers/xdr/XdrMemReader.h"
+
+namespace hemelb
+{
+  namespace io
+  {
+    namespace readers
+    {
+      /**
+       * A whole file mapped read-only into memory, so that the operating system only reads the
+       * pages that are actually looked at. Files of any size can be mapped on a 64-bit system.
+       */
+      class MappedFile
+      {
+        public:
+          /**
+           * Map the file, throwing an Exception if it can't be.
+           * @param path
+           */
+          explicit MappedFile(const std::string& path);
+
+          ~MappedFile();
+
+          const std::string& GetPath() const
+          {
+            return path;
+          }
+
+          const char* GetData() const
+          {
+            return data;
+          }
+
+          uint64_t GetSize() const
+          {
+            return size;
+          }
+
+          /**
+           * Check that a range of bytes is inside the file, throwing an Exception if not.
+           * @param offset
+           * @param length
+           * @param what What the bytes are, for the exception.
+           */
+          void CheckRange(uint64_t offset, uint64_t length, const char* what) const;
+
+          /**
+           * Returns an XDR reader over part of the file. The reader doesn't write to the buffer,
+           * for all that it takes a non-const one.
+           * @param offset
+           * @param length
+           * @return
+           */
+          writers::xdr::XdrMemReader GetReader(uint64_t offset, unsigned length) const;
+
+        private:
+          // Not copyable, as the mapping belongs to this.
+          MappedFile(const MappedFile&);
+          MappedFile& operator=(const MappedFile&);
+
+          const std::string path;
+          const char* data;
+          uint64_t size;
+      };
+    }
+  }
+}
+
+#endif /* HEMELB_IO_READERS_MAPPEDFILE_H */
@@ -0,0 +1,160 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <cstdlib>
+#include <iostream>
+#include "io/readers/ExtractionFileSet.h"
+#include "Exception.h"
+
+using namespace hemelb;
+
+namespace
+{
+  void PrintUsage(const char* program)
+  {
+    std::cerr << "Usage: " << program << " file.xtr [timestep [field ...]]\n"
+        << "With only the file, describe it and list its time steps. With a time step, write\n"
+        << "the grid position and the given fields (by default all of them) of every site at\n"
+        << "that step, a line per site. The file can be the index of one written in parts." << std::endl;
+  }
+
+  void Describe(const io::readers::ExtractionFileSet& fileSet)
+  {
+    const io::readers::ExtractionFile& file = fileSet.GetFirstPart();
+    std::cout << "# Version " << file.GetVersion() << ", " << fileSet.GetSiteCount()
+        << " sites, voxel size " << file.GetVoxelSize() << " m, origin " << file.GetOrigin()
+        << " m\n";
+    if (fileSet.GetPartCount() > 1)
+    {
+      std::cout << "# " << fileSet.GetPartCount() << " parts:\n";
+      for (size_t part = 0; part < fileSet.GetPartCount(); ++part)
+      {
+        std::cout << "# " << fileSet.GetPart(part).GetPath() << ", "
+            << fileSet.GetPart(part).GetSiteCount() << " sites\n";
+      }
+    }
+    for (unsigned field = 0; field < file.GetFields().size(); ++field)
+    {
+      const io::readers::ExtractionFile::FieldHeader& header = file.GetFields()[field];
+      std::cout << "# Field " << header.name << ", " << header.length << " value(s), offset "
+          << header.offset << "\n";
+    }
+    std::cout << "# " << file.GetRecordCount() << " time steps:\n";
+    for (size_t record = 0; record < file.GetRecordCount(); ++record)
+    {
+      std::cout << file.GetTimestep(record) << "\n";
+    }
+  }
+
+  void SliceSites(const io::readers::ExtractionFile& file, size_t record,
+                  const std::vector<unsigned>& fields)
+  {
+    const io::readers::PositionView positions = file.GetPositions(record);
+    if (file.GetEncoding() == io::formats::extraction::DeltaEncoding)
+    {
+      // Delta encoded records can only be decoded whole.
+      std::vector<unsigned> firstValues(1, 0);
+      for (unsigned field = 0; field < file.GetFields().size(); ++field)
+      {
+        firstValues.push_back(firstValues.back() + file.GetFields()[field].length);
+      }
+      std::vector<float> values;
+      file.DecodeRecord(record, values);
+      for (uint64_t site = 0; site < file.GetSiteCount(); ++site)
+      {
+        const util::Vector3D<site_t> position = positions.GetPosition(site);
+        std::cout << position.x << " " << position.y << " " << position.z;
+        for (size_t field = 0; field < fields.size(); ++field)
+        {
+          for (unsigned value = firstValues[fields[field]]; value < firstValues[fields[field] + 1];
+              ++value)
+          {
+            std::cout << " " << values[site * firstValues.back() + value];
+          }
+        }
+        std::cout << "\n";
+      }
+      return;
+    }
+
+    std::vector<io::readers::FieldView> views;
+    for (size_t field = 0; field < fields.size(); ++field)
+    {
+      views.push_back(file.GetFieldView(record, fields[field]));
+    }
+    for (uint64_t site = 0; site < file.GetSiteCount(); ++site)
+    {
+      const util::Vector3D<site_t> position = positions.GetPosition(site);
+      std::cout << position.x << " " << position.y << " " << position.z;
+      for (size_t field = 0; field < views.size(); ++field)
+      {
+        for (unsigned component = 0; component < views[field].GetLength(); ++component)
+        {
+          std::cout << " " << views[field].Get(site, component);
+        }
+      }
+      std::cout << "\n";
+    }
+  }
+
+  void Slice(const io::readers::ExtractionFileSet& fileSet, uint64_t timestep,
+             std::vector<unsigned> fields)
+  {
+    const io::readers::ExtractionFile& file = fileSet.GetFirstPart();
+    const size_t record = file.FindRecord(timestep);
+    if (fields.empty())
+    {
+      for (unsigned field = 0; field < file.GetFields().size(); ++field)
+      {
+        fields.push_back(field);
+      }
+    }
+
+    std::cout << "# x y z";
+    for (size_t field = 0; field < fields.size(); ++field)
+    {
+      std::cout << " " << file.GetFields()[fields[field]].name;
+    }
+    std::cout << "\n";
+    std::cout.precision(8);
+
+    for (size_t part = 0; part < fileSet.GetPartCount(); ++part)
+    {
+      SliceSites(fileSet.GetPart(part), record, fields);
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 2)
+  {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  try
+  {
+    const io::readers::ExtractionFileSet fileSet(argv[1]);
+    if (argc == 2)
+    {
+      Describe(fileSet);
+      return 0;
+    }
+
+    std::vector<unsigned> fields;
+    for (int arg = 3; arg < argc; ++arg)
+    {
+      fields.push_back(fileSet.GetFirstPart().FindField(argv[arg]));
+    }
+    Slice(fileSet, std::strtoull(argv[2], NULL, 10), fields);
+  }
+  catch (const Exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
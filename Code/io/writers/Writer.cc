@@ -28,6 +28,38 @@ namespace hemelb
         return *this;
       }
 
+      namespace
+      {
+        template<typename T>
+        void WriteEach(Writer& writer, const T* values, size_t count)
+        {
+          for (size_t i = 0; i < count; ++i)
+          {
+            writer << values[i];
+          }
+        }
+      }
+
+      void Writer::WriteArray(const float* values, size_t count)
+      {
+        WriteEach(*this, values, count);
+      }
+
+      void Writer::WriteArray(const double* values, size_t count)
+      {
+        WriteEach(*this, values, count);
+      }
+
+      void Writer::WriteArray(const uint32_t* values, size_t count)
+      {
+        WriteEach(*this, values, count);
+      }
+
+      void Writer::WriteArray(const uint64_t* values, size_t count)
+      {
+        WriteEach(*this, values, count);
+      }
+
     } // namespace writer
   }
 }
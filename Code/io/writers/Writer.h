@@ -12,6 +12,7 @@
 #else
 # include <stdint.h>
 #endif
+#include <cstddef>
 #include <string>
 
 namespace hemelb
@@ -42,6 +43,13 @@ namespace hemelb
             return *this;
           }
 
+          // Write an array of values, as writing each in turn would. Writers that can do it
+          // in bulk override these.
+          virtual void WriteArray(const float* values, size_t count);
+          virtual void WriteArray(const double* values, size_t count);
+          virtual void WriteArray(const uint32_t* values, size_t count);
+          virtual void WriteArray(const uint64_t* values, size_t count);
+
           // Function to get the current position of writing in the stream.
           virtual unsigned int getCurrentStreamPosition() const = 0;
 
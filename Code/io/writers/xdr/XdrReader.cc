@@ -48,6 +48,18 @@ namespace hemelb
           return ret;
         }
 
+        bool XdrReader::readString(std::string& outString)
+        {
+          // The length, then the characters padded to a multiple of four bytes.
+          unsigned int length;
+          if (!xdr_u_int(&mXdr, &length))
+          {
+            return false;
+          }
+          outString.resize(length);
+          return length == 0 || xdr_opaque(&mXdr, &outString[0], length);
+        }
+
         unsigned int XdrReader::GetPosition()
         {
           return xdr_getpos(&mXdr);
@@ -12,6 +12,7 @@
 #else
 # include <stdint.h>
 #endif
+#include <string>
 #include <rpc/types.h>
 #include <rpc/xdr.h>
 
@@ -36,6 +37,7 @@ namespace hemelb
             bool readInt(int& outInt);
             bool readUnsignedInt(unsigned int& outUInt);
             bool readUnsignedLong(uint64_t& outULong);
+            bool readString(std::string& outString);
 
             // Get the position in the stream.
             unsigned int GetPosition();
@@ -4,6 +4,8 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <cstring>
+#include <netinet/in.h>
 #include "io/writers/xdr/XdrWriter.h"
 
 namespace hemelb
@@ -21,6 +23,84 @@ namespace hemelb
     {
       namespace xdr
       {
+        namespace
+        {
+          // XDR is big-endian, which htonl gives for each 32-bit word; a 64-bit value is its
+          // high word then its low word. Copying through integers keeps the loops simple enough
+          // for the compiler to vectorise the byte swaps.
+          inline void EncodeBigEndian(const char* value, char* encoded, size_t size)
+          {
+            if (size == 4)
+            {
+              uint32_t word;
+              std::memcpy(&word, value, 4);
+              word = htonl(word);
+              std::memcpy(encoded, &word, 4);
+            }
+            else
+            {
+              uint64_t word;
+              std::memcpy(&word, value, 8);
+              const uint32_t high = htonl(uint32_t(word >> 32));
+              const uint32_t low = htonl(uint32_t(word));
+              std::memcpy(encoded, &high, 4);
+              std::memcpy(encoded + 4, &low, 4);
+            }
+          }
+
+          /**
+           * Encode 4- or 8-byte values straight into the stream's buffer, if it has one.
+           * @return Whether it did.
+           */
+          template<typename T>
+          bool WriteInline(XDR* xdr, const T* values, size_t count)
+          {
+            char* const encoded = reinterpret_cast<char*>(xdr_inline(xdr, sizeof(T) * count));
+            if (encoded == NULL)
+            {
+              return false;
+            }
+            const char* const bytes = reinterpret_cast<const char*>(values);
+            for (size_t i = 0; i < count; ++i)
+            {
+              EncodeBigEndian(bytes + sizeof(T) * i, encoded + sizeof(T) * i, sizeof(T));
+            }
+            return true;
+          }
+        }
+
+        void XdrWriter::WriteArray(const float* values, size_t count)
+        {
+          if (!WriteInline(&mXdr, values, count))
+          {
+            Writer::WriteArray(values, count);
+          }
+        }
+
+        void XdrWriter::WriteArray(const double* values, size_t count)
+        {
+          if (!WriteInline(&mXdr, values, count))
+          {
+            Writer::WriteArray(values, count);
+          }
+        }
+
+        void XdrWriter::WriteArray(const uint32_t* values, size_t count)
+        {
+          if (!WriteInline(&mXdr, values, count))
+          {
+            Writer::WriteArray(values, count);
+          }
+        }
+
+        void XdrWriter::WriteArray(const uint64_t* values, size_t count)
+        {
+          if (!WriteInline(&mXdr, values, count))
+          {
+            Writer::WriteArray(values, count);
+          }
+        }
+
         void XdrWriter::_write(int16_t const& shortToWrite)
         {
           xdr_int16_t(&mXdr, const_cast<int16_t *> (&shortToWrite));
@@ -31,6 +31,14 @@ namespace hemelb
             void writeFieldSeparator();
             void writeRecordSeparator();
 
+            // Write arrays straight into the buffer of an in-memory stream, byte swapping whole
+            // arrays at once rather than through a call per value. Other streams write each value
+            // in turn.
+            void WriteArray(const float* values, size_t count);
+            void WriteArray(const double* values, size_t count);
+            void WriteArray(const uint32_t* values, size_t count);
+            void WriteArray(const uint64_t* values, size_t count);
+
           protected:
             XDR mXdr;
 
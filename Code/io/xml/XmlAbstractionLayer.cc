@@ -21,6 +21,18 @@ namespace hemelb
         xmlDoc = new ::TiXmlDocument();
         xmlDoc->LoadFile(path);
       }
+      Document::Document() :
+          xmlDoc(new ::TiXmlDocument())
+      {
+      }
+
+      Document* Document::FromText(const std::string& text)
+      {
+        Document* document = new Document();
+        document->xmlDoc->Parse(text.c_str());
+        return document;
+      }
+
       Document::~Document()
       {
         delete xmlDoc;
@@ -333,10 +333,20 @@ namespace hemelb
            */
           Document(const std::string path);
 
+          /**
+           * Parse XML that has already been read, e.g. by another process.
+           *
+           * @param text
+           *   the contents of an XML file
+           * @return a new document, owned by the caller
+           */
+          static Document* FromText(const std::string& text);
+
           /** destructor */
           ~Document();
           Element GetRoot();
         private:
+          Document();
           TiXmlDocument* xmlDoc;
       };
 
@@ -77,6 +77,26 @@ namespace hemelb
         typedef kernels::TRT<Lattice> Type;
     };
 
+    /**
+     * LBGK with f_neq projected onto the second-order Hermite polynomials.
+     */
+    template<class Lattice>
+    class Regularised
+    {
+      public:
+        typedef kernels::Regularised<Lattice> Type;
+    };
+
+    /**
+     * As Regularised, also taking the third-order Hermite coefficients, found recursively.
+     */
+    template<class Lattice>
+    class RecursiveRegularised
+    {
+      public:
+        typedef kernels::Regularised<Lattice, true> Type;
+    };
+
     /**
      * Non-Newtonian kernel with Carreau-Yasuda rheology model.
      */
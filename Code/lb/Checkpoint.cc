@@ -0,0 +1,493 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include "lb/Checkpoint.h"
+#include "io/formats/formats.h"
+#include "io/writers/xdr/XdrMemReader.h"
+#include "io/writers/xdr/XdrMemWriter.h"
+#include "Exception.h"
+
+namespace hemelb
+{
+  namespace lb
+  {
+    namespace
+    {
+      //! How many index entries to read at a time.
+      const uint64_t IndexEntriesPerRead = 1 << 16;
+
+      site_t GetBlockId(const geometry::LatticeData& latticeData,
+                        const util::Vector3D<site_t>& globalCoords)
+      {
+        util::Vector3D<site_t> blockCoords, siteCoords;
+        latticeData.GetBlockAndLocalSiteCoords(globalCoords, blockCoords, siteCoords);
+        return latticeData.GetBlockIdFromBlockCoords(blockCoords);
+      }
+
+      void CalculateDensityAndMomentum(const lattices::LatticeInfo& latticeInfo, const distribn_t* f,
+                                       distribn_t& density, util::Vector3D<distribn_t>& momentum)
+      {
+        density = 0.0;
+        momentum = util::Vector3D<distribn_t>::Zero();
+        for (unsigned direction = 0; direction < latticeInfo.GetNumVectors(); ++direction)
+        {
+          const util::Vector3D<int>& vector = latticeInfo.GetVector(direction);
+          density += f[direction];
+          momentum.x += vector.x * f[direction];
+          momentum.y += vector.y * f[direction];
+          momentum.z += vector.z * f[direction];
+        }
+      }
+
+      /**
+       * The equilibrium distribution for the given density and momentum, as in
+       * Lattice::CalculateFeq. Only the writer and the reader of a checkpoint need to agree on
+       * this, so it doesn't matter if a kernel uses a different equilibrium.
+       */
+      void CalculateEquilibrium(const lattices::LatticeInfo& latticeInfo, distribn_t density,
+                                const util::Vector3D<distribn_t>& momentum, distribn_t* fEq)
+      {
+        const distribn_t momentumMagnitudeSquared = momentum.GetMagnitudeSquared();
+        for (unsigned direction = 0; direction < latticeInfo.GetNumVectors(); ++direction)
+        {
+          const util::Vector3D<int>& vector = latticeInfo.GetVector(direction);
+          const distribn_t momentumDotVector = vector.x * momentum.x + vector.y * momentum.y
+              + vector.z * momentum.z;
+          fEq[direction] = latticeInfo.GetWeight(direction)
+              * (density - (3. / 2.) * momentumMagnitudeSquared / density
+                  + (9. / 2.) * momentumDotVector * momentumDotVector / density
+                  + 3. * momentumDotVector);
+        }
+      }
+    }
+
+    Checkpoint::Checkpoint(const std::string& path, const net::IOCommunicator& comms,
+                           io::formats::checkpoint::Encoding encoding, int ranksPerFile) :
+        path(path), comms(comms), encoding(encoding), group(comms, ranksPerFile),
+            partPath(group.GetPartPath(path)), temporaryPath(partPath + ".tmp"), writing(false)
+    {
+    }
+
+    Checkpoint::~Checkpoint()
+    {
+#ifdef HEMELB_USE_ASYNC_CHECKPOINTS
+      // Don't free the buffers while MPI is still writing from them.
+      if (writing)
+      {
+        MPI_Waitall(2, pendingWrites, MPI_STATUSES_IGNORE);
+      }
+#endif
+    }
+
+    void Checkpoint::Write(const geometry::LatticeData& latticeData,
+                           LatticeTimeStep restartTimeStep)
+    {
+      // The buffers are in use until the previous checkpoint is written.
+      Finish();
+
+      const unsigned numVectors = latticeData.GetLatticeInfo().GetNumVectors();
+      const unsigned recordLength = io::formats::checkpoint::GetRecordLength(numVectors, encoding);
+
+      // Each group writes a whole checkpoint of its own sites.
+      const net::IOCommunicator& partComms = group.GetComms();
+      const site_t localRecords = latticeData.GetLocalFluidSiteCount();
+      const site_t precedingRecords = partComms.ExScan(localRecords, MPI_SUM);
+      const site_t totalRecords = partComms.AllReduce(localRecords, MPI_SUM);
+
+      const site_t localEntries = EncodeRecords(latticeData, precedingRecords);
+      const site_t precedingEntries = partComms.ExScan(localEntries, MPI_SUM);
+      const site_t totalEntries = partComms.AllReduce(localEntries, MPI_SUM);
+
+      if (group.IsSplit())
+      {
+        subfileIndex = group.MakeIndex(path, io::formats::checkpoint::MagicNumber,
+                                       uint64_t(localRecords));
+      }
+
+      file = net::MpiFile::Open(partComms, temporaryPath, MPI_MODE_WRONLY | MPI_MODE_CREATE);
+      // Don't leave the tail of a longer file from an earlier attempt.
+      HEMELB_MPI_CALL(MPI_File_set_size, (file, 0));
+
+      if (partComms.OnIORank())
+      {
+        preamble.resize(io::formats::checkpoint::PreambleLength);
+        io::writers::xdr::XdrMemWriter writer(&preamble[0], preamble.size());
+        writer << uint32_t(io::formats::HemeLbMagicNumber)
+            << uint32_t(io::formats::checkpoint::MagicNumber)
+            << uint32_t(io::formats::checkpoint::VersionNumber) << uint32_t(numVectors)
+            << uint32_t(encoding) << uint64_t(restartTimeStep) << uint64_t(totalRecords)
+            << uint64_t(totalEntries);
+        file.WriteAt(0, preamble);
+      }
+
+      const MPI_Offset recordsOffset = io::formats::checkpoint::PreambleLength
+          + MPI_Offset(precedingRecords) * recordLength;
+      const MPI_Offset indexOffset = io::formats::checkpoint::PreambleLength
+          + MPI_Offset(totalRecords) * recordLength
+          + MPI_Offset(precedingEntries) * io::formats::checkpoint::IndexEntryLength;
+#ifdef HEMELB_USE_ASYNC_CHECKPOINTS
+      file.IWriteAtAll(recordsOffset, records, &pendingWrites[0]);
+      file.IWriteAtAll(indexOffset, index, &pendingWrites[1]);
+      writing = true;
+#else
+      file.WriteAtAll(recordsOffset, records);
+      file.WriteAtAll(indexOffset, index);
+      writing = true;
+      Finish();
+#endif
+    }
+
+    void Checkpoint::Finish()
+    {
+      if (!writing)
+      {
+        return;
+      }
+
+#ifdef HEMELB_USE_ASYNC_CHECKPOINTS
+      HEMELB_MPI_CALL(MPI_Waitall, (2, pendingWrites, MPI_STATUSES_IGNORE));
+#endif
+      file.Close();
+      writing = false;
+
+      if (group.GetComms().OnIORank() && std::rename(temporaryPath.c_str(), partPath.c_str()) != 0)
+      {
+        throw Exception() << "Could not move the checkpoint " << temporaryPath << " to "
+            << partPath;
+      }
+
+      if (group.IsSplit())
+      {
+        // Only point the index at the parts once they are all in place.
+        HEMELB_MPI_CALL(MPI_Barrier, (comms));
+        if (comms.OnIORank())
+        {
+          const std::string temporaryIndexPath = path + ".tmp";
+          subfileIndex.Write(temporaryIndexPath);
+          if (std::rename(temporaryIndexPath.c_str(), path.c_str()) != 0)
+          {
+            throw Exception() << "Could not move the checkpoint index " << temporaryIndexPath
+                << " to " << path;
+          }
+        }
+      }
+    }
+
+    site_t Checkpoint::EncodeRecords(const geometry::LatticeData& latticeData,
+                                     site_t firstRecord)
+    {
+      const lattices::LatticeInfo& latticeInfo = latticeData.GetLatticeInfo();
+      const unsigned numVectors = latticeInfo.GetNumVectors();
+
+      std::vector<site_t> siteIds;
+      std::vector<distribn_t> distributions;
+      latticeData.GetDistributionRecords(siteIds, distributions);
+
+      // Group the sites by block.
+      std::vector<std::pair<site_t, site_t> > blockAndSite(siteIds.size());
+      for (size_t site = 0; site < siteIds.size(); ++site)
+      {
+        util::Vector3D<site_t> globalCoords;
+        latticeData.GetGlobalCoordsFromGlobalNoncontiguousSiteId(siteIds[site], globalCoords);
+        blockAndSite[site] = std::make_pair(GetBlockId(latticeData, globalCoords), site_t(site));
+      }
+      std::sort(blockAndSite.begin(), blockAndSite.end());
+
+      records.resize(siteIds.size() * io::formats::checkpoint::GetRecordLength(numVectors, encoding));
+      index.clear();
+      if (records.empty())
+      {
+        return 0;
+      }
+
+      io::writers::xdr::XdrMemWriter writer(&records[0], records.size());
+      std::vector<distribn_t> fEq(numVectors);
+      // The block and first record of each run.
+      std::vector<std::pair<site_t, site_t> > runStarts;
+      for (size_t record = 0; record < blockAndSite.size(); ++record)
+      {
+        if (record == 0 || blockAndSite[record].first != blockAndSite[record - 1].first)
+        {
+          runStarts.push_back(std::make_pair(blockAndSite[record].first, site_t(record)));
+        }
+
+        const site_t site = blockAndSite[record].second;
+        writer << uint64_t(siteIds[site]);
+        const distribn_t* f = &distributions[site * numVectors];
+
+        if (encoding == io::formats::checkpoint::NonEquilibriumFloatEncoding)
+        {
+          distribn_t density;
+          util::Vector3D<distribn_t> momentum;
+          CalculateDensityAndMomentum(latticeInfo, f, density, momentum);
+          CalculateEquilibrium(latticeInfo, density, momentum, &fEq[0]);
+
+          writer << density << momentum.x << momentum.y << momentum.z;
+          for (unsigned direction = 0; direction < numVectors; ++direction)
+          {
+            writer << float(f[direction] - fEq[direction]);
+          }
+        }
+        else
+        {
+          for (unsigned direction = 0; direction < numVectors; ++direction)
+          {
+            writer << f[direction];
+          }
+        }
+      }
+
+      index.resize(runStarts.size() * io::formats::checkpoint::IndexEntryLength);
+      io::writers::xdr::XdrMemWriter indexWriter(&index[0], index.size());
+      for (size_t run = 0; run < runStarts.size(); ++run)
+      {
+        const site_t runEnd = run + 1 < runStarts.size() ?
+          runStarts[run + 1].second :
+          site_t(blockAndSite.size());
+        indexWriter << uint64_t(runStarts[run].first)
+            << uint64_t(firstRecord + runStarts[run].second)
+            << uint64_t(runEnd - runStarts[run].second);
+      }
+      return site_t(runStarts.size());
+    }
+
+    LatticeTimeStep Checkpoint::Read(const std::string& path, geometry::LatticeData& latticeData,
+                                     const net::IOCommunicator& comms)
+    {
+      std::vector<std::string> paths;
+      if (io::SubfileIndex::IsIndex(path))
+      {
+        const io::SubfileIndex index = io::SubfileIndex::Read(path);
+        if (index.GetFormatMagic() != io::formats::checkpoint::MagicNumber)
+        {
+          throw Exception() << path << " is not the index of a checkpoint";
+        }
+        for (std::vector<io::SubfileIndex::Part>::const_iterator part = index.GetParts().begin();
+            part != index.GetParts().end(); ++part)
+        {
+          paths.push_back(part->path);
+        }
+      }
+      else
+      {
+        paths.push_back(path);
+      }
+
+      // Any part can have records of any core's sites.
+      uint64_t restartTimeStep = 0, totalRecords = 0;
+      site_t sitesSet = 0;
+      for (size_t part = 0; part < paths.size(); ++part)
+      {
+        uint64_t partRestartTimeStep, partRecords;
+        sitesSet += ReadFile(paths[part], latticeData, comms, partRestartTimeStep, partRecords);
+        if (part > 0 && partRestartTimeStep != restartTimeStep)
+        {
+          throw Exception() << "Checkpoint " << paths[part] << " restarts at time step "
+              << partRestartTimeStep << ", but " << paths[0] << " at " << restartTimeStep;
+        }
+        restartTimeStep = partRestartTimeStep;
+        totalRecords += partRecords;
+      }
+
+      if (totalRecords != uint64_t(latticeData.GetTotalFluidSites()))
+      {
+        throw Exception() << "Checkpoint " << path << " has " << totalRecords
+            << " sites, but the geometry has " << latticeData.GetTotalFluidSites();
+      }
+      sitesSet = comms.AllReduce(sitesSet, MPI_SUM);
+      if (sitesSet != latticeData.GetTotalFluidSites())
+      {
+        throw Exception() << "Checkpoint " << path << " set " << sitesSet << " of the "
+            << latticeData.GetTotalFluidSites() << " sites";
+      }
+
+      return restartTimeStep;
+    }
+
+    site_t Checkpoint::ReadFile(const std::string& path, geometry::LatticeData& latticeData,
+                                const net::IOCommunicator& comms, uint64_t& restartTimeStep,
+                                uint64_t& totalRecords)
+    {
+      const lattices::LatticeInfo& latticeInfo = latticeData.GetLatticeInfo();
+      const unsigned numVectors = latticeInfo.GetNumVectors();
+
+      net::MpiFile file = net::MpiFile::Open(comms, path, MPI_MODE_RDONLY);
+
+      // The preamble is small enough for every core to read, so they all agree on whether to
+      // carry on.
+      std::vector<char> preamble(io::formats::checkpoint::PreambleLength);
+      file.ReadAtAll(0, preamble);
+      io::writers::xdr::XdrMemReader preambleReader(&preamble[0], preamble.size());
+      unsigned hemeLbMagic, checkpointMagic, version, fileNumVectors, fileEncoding;
+      uint64_t totalEntries;
+      preambleReader.readUnsignedInt(hemeLbMagic);
+      preambleReader.readUnsignedInt(checkpointMagic);
+      preambleReader.readUnsignedInt(version);
+      preambleReader.readUnsignedInt(fileNumVectors);
+      preambleReader.readUnsignedInt(fileEncoding);
+      preambleReader.readUnsignedLong(restartTimeStep);
+      preambleReader.readUnsignedLong(totalRecords);
+      preambleReader.readUnsignedLong(totalEntries);
+
+      if (hemeLbMagic != io::formats::HemeLbMagicNumber
+          || checkpointMagic != io::formats::checkpoint::MagicNumber)
+      {
+        throw Exception() << path << " is not a checkpoint file";
+      }
+      if (version != io::formats::checkpoint::VersionNumber)
+      {
+        throw Exception() << "Checkpoint " << path << " has version " << version << ", expected "
+            << io::formats::checkpoint::VersionNumber;
+      }
+      if (fileNumVectors != numVectors)
+      {
+        throw Exception() << "Checkpoint " << path << " has " << fileNumVectors
+            << " distributions per site, but the lattice has " << numVectors;
+      }
+      if (fileEncoding != io::formats::checkpoint::DoubleEncoding
+          && fileEncoding != io::formats::checkpoint::NonEquilibriumFloatEncoding)
+      {
+        throw Exception() << "Checkpoint " << path << " has unknown encoding " << fileEncoding;
+      }
+      const io::formats::checkpoint::Encoding encoding =
+          io::formats::checkpoint::Encoding(fileEncoding);
+      const unsigned recordLength = io::formats::checkpoint::GetRecordLength(numVectors, encoding);
+
+      // Find the runs of records of the blocks this core has sites on, going through the index
+      // a piece at a time.
+      std::set<site_t> localBlocks;
+      for (site_t site = 0; site < latticeData.GetLocalFluidSiteCount(); ++site)
+      {
+        localBlocks.insert(GetBlockId(latticeData, latticeData.GetSite(site).GetGlobalSiteCoords()));
+      }
+
+      const MPI_Offset indexOffset = io::formats::checkpoint::PreambleLength
+          + MPI_Offset(totalRecords) * recordLength;
+      std::vector<std::pair<uint64_t, uint64_t> > runs;
+      for (uint64_t firstEntry = 0; firstEntry < totalEntries; firstEntry += IndexEntriesPerRead)
+      {
+        const uint64_t entries = std::min(IndexEntriesPerRead, totalEntries - firstEntry);
+        std::vector<char> indexPiece(entries * io::formats::checkpoint::IndexEntryLength);
+        file.ReadAtAll(indexOffset + MPI_Offset(firstEntry) * io::formats::checkpoint::IndexEntryLength,
+                       indexPiece);
+
+        io::writers::xdr::XdrMemReader indexReader(&indexPiece[0], indexPiece.size());
+        for (uint64_t entry = 0; entry < entries; ++entry)
+        {
+          uint64_t blockId, runFirstRecord, runRecords;
+          indexReader.readUnsignedLong(blockId);
+          indexReader.readUnsignedLong(runFirstRecord);
+          indexReader.readUnsignedLong(runRecords);
+          if (localBlocks.count(site_t(blockId)))
+          {
+            runs.push_back(std::make_pair(runFirstRecord, runRecords));
+          }
+        }
+      }
+      std::sort(runs.begin(), runs.end());
+
+      // Read all the runs at once, through a file view made of them.
+      std::vector<int> runLengths(runs.size());
+      std::vector<MPI_Aint> runOffsets(runs.size());
+      uint64_t recordsRead = 0;
+      for (size_t run = 0; run < runs.size(); ++run)
+      {
+        runLengths[run] = int(runs[run].second * recordLength);
+        runOffsets[run] = MPI_Aint(io::formats::checkpoint::PreambleLength
+            + runs[run].first * recordLength);
+        recordsRead += runs[run].second;
+      }
+      MPI_Datatype runsType;
+      HEMELB_MPI_CALL(MPI_Type_create_hindexed,
+                      (int(runs.size()),
+                       runs.empty() ? NULL : &runLengths[0],
+                       runs.empty() ? NULL : &runOffsets[0],
+                       MPI_BYTE,
+                       &runsType));
+      HEMELB_MPI_CALL(MPI_Type_commit, (&runsType));
+      file.SetView(0, MPI_BYTE, runsType, "native", MPI_INFO_NULL);
+
+      std::vector<char> records(recordsRead * recordLength);
+      file.ReadAtAll(0, records);
+      HEMELB_MPI_CALL(MPI_Type_free, (&runsType));
+      file.Close();
+
+      // Blocks split between cores have some sites this core doesn't, which it skips.
+      site_t sitesSet = 0;
+      std::vector<distribn_t> f(numVectors);
+      if (!records.empty())
+      {
+        io::writers::xdr::XdrMemReader reader(&records[0], records.size());
+        for (uint64_t record = 0; record < recordsRead; ++record)
+        {
+          uint64_t siteId;
+          reader.readUnsignedLong(siteId);
+
+          if (encoding == io::formats::checkpoint::NonEquilibriumFloatEncoding)
+          {
+            distribn_t density;
+            util::Vector3D<distribn_t> momentum;
+            reader.readDouble(density);
+            reader.readDouble(momentum.x);
+            reader.readDouble(momentum.y);
+            reader.readDouble(momentum.z);
+            CalculateEquilibrium(latticeInfo, density, momentum, &f[0]);
+            for (unsigned direction = 0; direction < numVectors; ++direction)
+            {
+              float fNeq;
+              reader.readFloat(fNeq);
+              f[direction] += fNeq;
+            }
+          }
+          else
+          {
+            for (unsigned direction = 0; direction < numVectors; ++direction)
+            {
+              reader.readDouble(f[direction]);
+            }
+          }
+
+          util::Vector3D<site_t> globalCoords;
+          latticeData.GetGlobalCoordsFromGlobalNoncontiguousSiteId(site_t(siteId), globalCoords);
+          proc_t proc;
+          site_t site;
+          if (latticeData.GetContiguousSiteId(globalCoords, proc, site))
+          {
+            latticeData.SetDistributions(site, &f[0]);
+            ++sitesSet;
+          }
+        }
+      }
+
+      return sitesSet;
+    }
+
+    bool Checkpoint::IsCheckpoint(const std::string& path)
+    {
+      if (io::SubfileIndex::IsIndex(path))
+      {
+        return io::SubfileIndex::Read(path).GetFormatMagic()
+            == io::formats::checkpoint::MagicNumber;
+      }
+
+      std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+      std::vector<char> magic(8);
+      if (!file.read(&magic[0], magic.size()))
+      {
+        return false;
+      }
+      io::writers::xdr::XdrMemReader reader(&magic[0], magic.size());
+      unsigned hemeLbMagic, checkpointMagic;
+      reader.readUnsignedInt(hemeLbMagic);
+      reader.readUnsignedInt(checkpointMagic);
+      return hemeLbMagic == io::formats::HemeLbMagicNumber
+          && checkpointMagic == io::formats::checkpoint::MagicNumber;
+    }
+  }
+}
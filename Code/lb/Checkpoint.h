@@ -0,0 +1,145 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_LB_CHECKPOINT_H
+#define HEMELB_LB_CHECKPOINT_H
+
+#include <string>
+#include <vector>
+#include "geometry/LatticeData.h"
+#include "io/SubfileGroup.h"
+#include "io/formats/checkpoint.h"
+#include "net/IOCommunicator.h"
+#include "net/MpiFile.h"
+#include "units.h"
+
+namespace hemelb
+{
+  namespace lb
+  {
+    /**
+     * Saves the state of the LB to a checkpoint file (see io/formats/checkpoint.h) and restores
+     * it, so that a run cut short can carry on instead of starting again from the initial
+     * conditions. Every core writes its own sites' records with collective MPI-IO. The records
+     * are keyed by global site id, so a checkpoint can be restored on any number of cores.
+     *
+     * Only the distributions and the time step are saved. Everything else either follows from
+     * the time step (the iolet values, which are functions of it) or is set up again from the
+     * configuration.
+     *
+     * With HEMELB_USE_ASYNC_CHECKPOINTS, Write only takes a snapshot of the distributions and
+     * starts a nonblocking write of it; the simulation carries on while it is written, and the
+     * write is finished at the next checkpoint or by Finish.
+     *
+     * On many cores, the checkpoint can be written in parts instead, one per node or group of
+     * cores, each a whole checkpoint of the group's sites, with a subfile index at the path that
+     * says where the parts are. Read stitches them back together.
+     */
+    class Checkpoint
+    {
+      public:
+        /**
+         * @param path The file to keep the latest checkpoint in.
+         * @param comms
+         * @param encoding How to encode the distributions.
+         * @param ranksPerFile How many ranks write each part, or SubfileGroup::OneFile or
+         * SubfileGroup::PerNode.
+         */
+        Checkpoint(const std::string& path, const net::IOCommunicator& comms,
+                   io::formats::checkpoint::Encoding encoding = io::formats::checkpoint::DoubleEncoding,
+                   int ranksPerFile = io::SubfileGroup::OneFile);
+
+        /**
+         * Finishes any write in progress. Collective.
+         */
+        ~Checkpoint();
+
+        /**
+         * Write a checkpoint. Collective. It is written to a temporary file first and then moved
+         * over the path, so that a run stopped mid-write leaves the previous checkpoint whole.
+         *
+         * @param latticeData
+         * @param restartTimeStep The time step a restarted run should do first.
+         */
+        void Write(const geometry::LatticeData& latticeData, LatticeTimeStep restartTimeStep);
+
+        /**
+         * Wait for the write in progress, if there is one, and move it into place. Collective.
+         * The parts of a split checkpoint are all moved into place before its index, and each
+         * part has the restart time step, so Read can tell if a run stopped in between.
+         */
+        void Finish();
+
+        /**
+         * Read a checkpoint into the distributions of a lattice, however it is decomposed.
+         * Collective. Each core looks up the blocks it has in the checkpoint's index and reads
+         * just their records, in one collective read through a file view, so nothing is sent
+         * between cores. For a split checkpoint, that is done with each part in turn.
+         *
+         * @param path
+         * @param latticeData
+         * @param comms
+         * @return The time step to restart at.
+         */
+        static LatticeTimeStep Read(const std::string& path, geometry::LatticeData& latticeData,
+                                    const net::IOCommunicator& comms);
+
+        /**
+         * Whether a file starts like a checkpoint, or is the index of a split one, to tell
+         * checkpoints from other files that initial conditions can be read from.
+         * @param path
+         * @return
+         */
+        static bool IsCheckpoint(const std::string& path);
+
+      private:
+        /**
+         * Read the records of one checkpoint file into the local sites. Collective.
+         * @param path
+         * @param latticeData
+         * @param comms
+         * @param restartTimeStep Set to the time step to restart at.
+         * @param totalRecords Set to the number of records in the file.
+         * @return The number of local sites set.
+         */
+        static site_t ReadFile(const std::string& path, geometry::LatticeData& latticeData,
+                               const net::IOCommunicator& comms, uint64_t& restartTimeStep,
+                               uint64_t& totalRecords);
+
+        /**
+         * Encode the local sites' records, grouped by block, into the records buffer and their
+         * index entries into the index buffer.
+         * @param latticeData
+         * @param firstRecord The index in the whole checkpoint of this core's first record.
+         * @return The number of index entries.
+         */
+        site_t EncodeRecords(const geometry::LatticeData& latticeData, site_t firstRecord);
+
+        const std::string path;
+        const net::IOCommunicator& comms;
+        const io::formats::checkpoint::Encoding encoding;
+        //! The cores that write the same part as this one, all of them if it isn't split.
+        const io::SubfileGroup group;
+        //! This group's part, the whole checkpoint if it isn't split.
+        const std::string partPath;
+        const std::string temporaryPath;
+        //! The index of the parts, on the IO core.
+        io::SubfileIndex subfileIndex;
+        net::MpiFile file;
+        //! The preamble (on the IO core), local records and their index entries of the
+        //! checkpoint being written.
+        std::vector<char> preamble;
+        std::vector<char> records;
+        std::vector<char> index;
+        bool writing;
+#ifdef HEMELB_USE_ASYNC_CHECKPOINTS
+        //! The writes of the records and of the index.
+        MPI_Request pendingWrites[2];
+#endif
+    };
+  }
+}
+
+#endif /* HEMELB_LB_CHECKPOINT_H */
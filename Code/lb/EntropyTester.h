@@ -7,6 +7,7 @@
 #ifndef HEMELB_LB_ENTROPYTESTER_H
 #define HEMELB_LB_ENTROPYTESTER_H
 
+#include <vector>
 #include "net/PhasedBroadcastRegular.h"
 #include "geometry/LatticeData.h"
 #include "lb/HFunction.h"
@@ -16,39 +17,76 @@ namespace hemelb
 {
   namespace lb
   {
+    /**
+     * Checks that H, as defined by HFunction, doesn't grow over a timestep at the sites of the
+     * collision types tested (e.g. those with an entropic kernel).
+     *
+     * Only every siteStride-th such site is looked at, and the step manager should call this
+     * only on every checkPeriod-th step, so the check needn't cost two full sweeps of the
+     * lattice every step. H before the collision is kept for the sampled sites alone.
+     */
     template<class LatticeType>
     class EntropyTester : public net::PhasedBroadcastRegular<false, 1, 1, false, true>
     {
       public:
+        /**
+         * @param collisionTypes
+         * @param typesTested
+         * @param iLatDat
+         * @param net
+         * @param simState
+         * @param siteStride Only every siteStride-th site of the types tested is looked at.
+         * @param checkPeriod The number of time steps between calls from the StepManager.
+         */
         EntropyTester(int* collisionTypes,
                       unsigned int typesTested,
                       const geometry::LatticeData * iLatDat,
                       net::Net* net,
-                      SimulationState* simState) :
-            net::PhasedBroadcastRegular<false, 1, 1, false, true>(net, simState, SPREADFACTOR), mLatDat(iLatDat)
+                      SimulationState* simState,
+                      site_t siteStride = 1,
+                      unsigned long checkPeriod = 1) :
+            net::PhasedBroadcastRegular<false, 1, 1, false, true>(net, simState, SPREADFACTOR, checkPeriod),
+                mLatDat(iLatDat)
         {
+          bool collisionTypesTested[COLLISION_TYPES];
           for (unsigned int i = 0; i < COLLISION_TYPES; i++)
           {
-            mCollisionTypesTested[i] = false;
+            collisionTypesTested[i] = false;
           }
           for (unsigned int i = 0; i < typesTested; i++)
           {
-            mCollisionTypesTested[collisionTypes[i]] = true;
+            collisionTypesTested[collisionTypes[i]] = true;
           }
 
-          mHPreCollision = new double[mLatDat->GetLocalFluidSiteCount()];
+          // The sites are ordered by collision type, first the mid-domain ones then the
+          // domain-edge ones.
+          site_t offset = 0;
+          for (unsigned int collision_type = 0; collision_type < COLLISION_TYPES; collision_type++)
+          {
+            const site_t count = mLatDat->GetMidDomainCollisionCount(collision_type);
+            if (collisionTypesTested[collision_type])
+            {
+              AddSampledSites(offset, count, siteStride);
+            }
+            offset += count;
+          }
+          for (unsigned int collision_type = 0; collision_type < COLLISION_TYPES; collision_type++)
+          {
+            const site_t count = mLatDat->GetDomainEdgeCollisionCount(collision_type);
+            if (collisionTypesTested[collision_type])
+            {
+              AddSampledSites(offset, count, siteStride);
+            }
+            offset += count;
+          }
 
-          Reset();
-        }
+          mHPreCollision.resize(mSampledSites.size());
 
-        ~EntropyTester()
-        {
-          delete[] mHPreCollision;
+          Reset();
         }
 
         void PreReceive()
         {
-          site_t offset = 0;
           double dHMax = 0.0;
 
           // The order of arguments in max is important
@@ -56,37 +94,10 @@ namespace hemelb
           // nature of NaN and the structure of max, dH will be assigned as NaN if this is the case
           // This is what we want, because the EntropyTester will fail otherwise and abort when
           // it is simply sufficient to wait until StabilityTester restarts.
-
-          for (unsigned int collision_type = 0; collision_type < COLLISION_TYPES; collision_type++)
+          for (size_t sample = 0; sample < mSampledSites.size(); sample++)
           {
-            if (mCollisionTypesTested[collision_type])
-            {
-              for (site_t i = offset; i < offset + mLatDat->GetMidDomainCollisionCount(collision_type); i++)
-              {
-                const geometry::Site<const geometry::LatticeData> site = mLatDat->GetSite(i);
-
-                HFunction<LatticeType> HFunc(site.GetFOld<LatticeType>(), NULL);
-                dHMax = util::NumericalFunctions::max(dHMax, HFunc.eval() - mHPreCollision[i]);
-              }
-            }
-
-            offset += mLatDat->GetMidDomainCollisionCount(collision_type);
-          }
-
-          for (unsigned int collision_type = 0; collision_type < COLLISION_TYPES; collision_type++)
-          {
-            if (mCollisionTypesTested[collision_type])
-            {
-              for (site_t i = offset; i < offset + mLatDat->GetDomainEdgeCollisionCount(collision_type); i++)
-              {
-                const geometry::Site<const geometry::LatticeData> site = mLatDat->GetSite(i);
-
-                HFunction<LatticeType> HFunc(site.GetFOld<LatticeType>(), NULL);
-                dHMax = util::NumericalFunctions::max(dHMax, HFunc.eval() - mHPreCollision[i]);
-              }
-            }
-
-            offset += mLatDat->GetDomainEdgeCollisionCount(collision_type);
+            dHMax = util::NumericalFunctions::max(dHMax,
+                                                  EvaluateH(mSampledSites[sample]) - mHPreCollision[sample]);
           }
 
           /*
@@ -128,36 +139,9 @@ namespace hemelb
         void ProgressToParent(unsigned long splayNumber)
         {
           // Store pre-collision values.
-          site_t offset = 0;
-
-          for (unsigned int collision_type = 0; collision_type < COLLISION_TYPES; collision_type++)
-          {
-            if (mCollisionTypesTested[collision_type])
-            {
-              for (site_t i = offset; i < offset + mLatDat->GetMidDomainCollisionCount(collision_type); i++)
-              {
-                const geometry::Site<const geometry::LatticeData> site = mLatDat->GetSite(i);
-                HFunction<LatticeType> HFunc(site.GetFOld<LatticeType>(), NULL);
-                mHPreCollision[i] = HFunc.eval();
-              }
-            }
-
-            offset += mLatDat->GetMidDomainCollisionCount(collision_type);
-          }
-
-          for (unsigned int collision_type = 0; collision_type < COLLISION_TYPES; collision_type++)
+          for (size_t sample = 0; sample < mSampledSites.size(); sample++)
           {
-            if (mCollisionTypesTested[collision_type])
-            {
-              for (site_t i = offset; i < offset + mLatDat->GetDomainEdgeCollisionCount(collision_type); i++)
-              {
-                const geometry::Site<const geometry::LatticeData> site = mLatDat->GetSite(i);
-                HFunction<LatticeType> HFunc(site.GetFOld<LatticeType>(), NULL);
-                mHPreCollision[i] = HFunc.eval();
-              }
-            }
-
-            offset += mLatDat->GetDomainEdgeCollisionCount(collision_type);
+            mHPreCollision[sample] = EvaluateH(mSampledSites[sample]);
           }
 
           SendToParent<int>(&mUpwardsValue, 1);
@@ -206,6 +190,22 @@ namespace hemelb
          */
         static const unsigned int SPREADFACTOR = 10;
 
+        void AddSampledSites(site_t first, site_t count, site_t siteStride)
+        {
+          for (site_t i = first; i < first + count; i += siteStride)
+          {
+            mSampledSites.push_back(i);
+          }
+        }
+
+        double EvaluateH(site_t siteIndex) const
+        {
+          const geometry::Site<const geometry::LatticeData> site = mLatDat->GetSite(siteIndex);
+          distribn_t fOldBuffer[LatticeType::NUMVECTORS];
+          HFunction<LatticeType> HFunc(site.GetFOld<LatticeType>(fOldBuffer), NULL);
+          return HFunc.eval();
+        }
+
         const geometry::LatticeData * mLatDat;
 
         /**
@@ -217,8 +217,9 @@ namespace hemelb
          */
         int mChildrensValues[SPREADFACTOR];
 
-        bool mCollisionTypesTested[COLLISION_TYPES];
-        double* mHPreCollision;
+        //! The sites looked at, and H at each of them before the collision.
+        std::vector<site_t> mSampledSites;
+        std::vector<double> mHPreCollision;
     };
 
   }
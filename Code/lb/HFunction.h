@@ -20,22 +20,31 @@ namespace hemelb
      * The HFunction class calculates the H function as the name suggests
      * It is a class as the Newton-Raphson function in util takes in an object
      * with an overloaded () operator.
+     *
+     * Each evaluation takes one log per direction: H of f itself is worked out once, when
+     * constructed, and the derivative reuses the logs of the value. The logs are taken in a
+     * loop of their own, with nothing else in it, so that it vectorises where the maths
+     * library has vector logs.
      */
     template<class LatticeType>
     class HFunction
     {
       public:
         HFunction(const distribn_t* lF, const distribn_t* lFEq) :
-            mF(lF), mFEq(lFEq)
+            mF(lF), mFEq(lFEq), mH(0.0)
         {
-
+          for (unsigned int ii = 0; ii < LatticeType::NUMVECTORS; ++ii)
+          {
+            mH += h(mF[ii], 1.0 / LatticeType::EQMWEIGHTS[ii]);
+          }
         }
 
         void operator()(const double alpha, double &H, double &dH)
         {
           double f_alpha[LatticeType::NUMVECTORS];
+          double logs[LatticeType::NUMVECTORS];
 
-          CalculateFalphaAndHInternal(alpha, f_alpha, H);
+          CalculateFalphaAndHInternal(alpha, f_alpha, logs, H);
 
           dH = 0.0;
 
@@ -43,45 +52,51 @@ namespace hemelb
           {
             dH += (f_alpha[ii] < 0.0 ?
               -1.0 :
-              1.0) * (mFEq[ii] - mF[ii]) * (1.0 + std::log(std::fabs(f_alpha[ii]) / LatticeType::EQMWEIGHTS[ii]));
+              1.0) * (mFEq[ii] - mF[ii]) * (1.0 + logs[ii]);
           }
         }
 
         void operator()(const double alpha, double &H)
         {
           double f_alpha[LatticeType::NUMVECTORS];
+          double logs[LatticeType::NUMVECTORS];
 
-          CalculateFalphaAndHInternal(alpha, f_alpha, H);
+          CalculateFalphaAndHInternal(alpha, f_alpha, logs, H);
         }
 
         double eval()
         {
-          double lRet = 0.0;
-
-          for (unsigned int ii = 0; ii < LatticeType::NUMVECTORS; ++ii)
-          {
-            lRet += h(mF[ii], 1.0 / LatticeType::EQMWEIGHTS[ii]);
-          }
-
-          return lRet;
+          return mH;
         }
 
       private:
         const distribn_t* mF;
         const distribn_t* mFEq;
-
-        void CalculateFalphaAndHInternal(const double alpha, double* fAlpha, double &H)
+        double mH; //! H of f
+
+        /**
+         * @param alpha
+         * @param fAlpha Set to f + alpha (f_eq - f)
+         * @param logs Set to the log of |fAlpha| over the weight of each direction
+         * @param H Set to H(fAlpha) - H(f)
+         */
+        void CalculateFalphaAndHInternal(const double alpha, double* fAlpha, double* logs, double &H)
         {
           for (unsigned int ii = 0; ii < LatticeType::NUMVECTORS; ++ii)
           {
             fAlpha[ii] = mF[ii] + alpha * (mFEq[ii] - mF[ii]);
           }
 
-          H = 0.0;
+          for (unsigned int ii = 0; ii < LatticeType::NUMVECTORS; ++ii)
+          {
+            logs[ii] = std::log(std::fabs(fAlpha[ii]) * (1.0 / LatticeType::EQMWEIGHTS[ii]));
+          }
+
+          H = -mH;
 
           for (unsigned int ii = 0; ii < LatticeType::NUMVECTORS; ++ii)
           {
-            H += h(std::fabs(fAlpha[ii]), 1.0 / LatticeType::EQMWEIGHTS[ii]) - h(mF[ii], 1.0 / LatticeType::EQMWEIGHTS[ii]);
+            H += std::fabs(fAlpha[ii]) * logs[ii];
           }
         }
 
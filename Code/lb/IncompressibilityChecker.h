@@ -10,6 +10,7 @@
 #include "geometry/LatticeData.h"
 #include "lb/MacroscopicPropertyCache.h"
 #include "net/PhasedBroadcastRegular.h"
+#include "net/CollectiveAction.h"
 #include "reporting/Reportable.h"
 #include <cfloat>
 
@@ -30,6 +31,11 @@ namespace hemelb
     {
         /**
          * This class uses the phased broadcast infrastructure to keep track of the maximum density difference across the domain.
+         *
+         * The streamers find the extremes of the sites on each core as they collide them (see
+         * MacroscopicPropertyCache::SetDensityExtremesRequired), so there is no pass over the
+         * sites here. With net::CollectiveAction as the BroadcastPolicy, the StabilityTester
+         * combines them in its own collective and this just picks up the result.
          */
 
       public:
@@ -121,13 +127,15 @@ namespace hemelb
          * @param net network interface object
          * @param simState simulation state
          * @param maximumRelativeDensityDifferenceAllowed maximum density difference allowed in the domain (relative to reference density, default 5%)
+         * @param checkPeriod number of time steps between calls from the StepManager
          */
         IncompressibilityChecker(const geometry::LatticeData * latticeData,
                                  net::Net* net,
                                  SimulationState* simState,
                                  lb::MacroscopicPropertyCache& propertyCache,
                                  reporting::Timers& timings,
-                                 distribn_t maximumRelativeDensityDifferenceAllowed = 0.05);
+                                 distribn_t maximumRelativeDensityDifferenceAllowed = 0.05,
+                                 unsigned long checkPeriod = 1);
 
         /**
          * Destructor
@@ -218,6 +226,14 @@ namespace hemelb
          */
         void Effect();
 
+        /**
+         * The methods used with net::CollectiveAction instead of the tree. There is no collective
+         * to start, as the StabilityTester's carries the extremes; the result is taken from the
+         * property cache once it's there.
+         */
+        void StartReduction(const net::MpiCommunicator& comms, MPI_Request& request);
+        void PostReduce();
+
       private:
 
         /**
@@ -102,8 +102,9 @@ namespace hemelb
                                                                         SimulationState* simState,
                                                                         lb::MacroscopicPropertyCache& propertyCache,
                                                                         reporting::Timers& timings,
-                                                                        distribn_t maximumRelativeDensityDifferenceAllowed) :
-        BroadcastPolicy(net, simState, SPREADFACTOR), mLatDat(latticeData), propertyCache(propertyCache), mSimState(simState), timings(timings), maximumRelativeDensityDifferenceAllowed(maximumRelativeDensityDifferenceAllowed), globalDensityTracker(NULL)
+                                                                        distribn_t maximumRelativeDensityDifferenceAllowed,
+                                                                        unsigned long checkPeriod) :
+        BroadcastPolicy(net, simState, SPREADFACTOR, checkPeriod), mLatDat(latticeData), propertyCache(propertyCache), mSimState(simState), timings(timings), maximumRelativeDensityDifferenceAllowed(maximumRelativeDensityDifferenceAllowed), globalDensityTracker(NULL)
     {
       /*
        *  childrenDensitiesSerialised must be initialised to something sensible since ReceiveFromChildren won't
@@ -186,11 +187,12 @@ namespace hemelb
     {
       timings[hemelb::reporting::Timers::monitoring].Start();
 
-      for (site_t i = 0; i < mLatDat->GetLocalFluidSiteCount(); i++)
-      {
-        upwardsDensityTracker.UpdateDensityTracker(propertyCache.densityCache.Get(i),
-                                                   propertyCache.velocityCache.Get(i).GetMagnitude());
-      }
+      const MacroscopicPropertyCache::DensityExtremes extremes = propertyCache.GetLocalDensityExtremes();
+      distribn_t localDensities[DensityTracker::DENSITY_TRACKER_SIZE];
+      localDensities[DensityTracker::MIN_DENSITY] = extremes.minDensity;
+      localDensities[DensityTracker::MAX_DENSITY] = extremes.maxDensity;
+      localDensities[DensityTracker::MAX_VELOCITY_MAGNITUDE] = extremes.maxVelocityMagnitude;
+      upwardsDensityTracker.UpdateDensityTracker(DensityTracker(localDensities));
 
       timings[hemelb::reporting::Timers::monitoring].Stop();
     }
@@ -231,6 +233,29 @@ namespace hemelb
       globalDensityTracker = &downwardsDensityTracker;
     }
 
+    template<class BroadcastPolicy>
+    void IncompressibilityChecker<BroadcastPolicy>::StartReduction(const net::MpiCommunicator& comms,
+                                                                   MPI_Request& request)
+    {
+      // The request is left null, so completing it does nothing.
+    }
+
+    template<class BroadcastPolicy>
+    void IncompressibilityChecker<BroadcastPolicy>::PostReduce()
+    {
+      if (!propertyCache.HasGlobalDensityExtremes())
+      {
+        return;
+      }
+
+      const MacroscopicPropertyCache::DensityExtremes& extremes = propertyCache.GetGlobalDensityExtremes();
+      downwardsDensityTracker[DensityTracker::MIN_DENSITY] = extremes.minDensity;
+      downwardsDensityTracker[DensityTracker::MAX_DENSITY] = extremes.maxDensity;
+      downwardsDensityTracker[DensityTracker::MAX_VELOCITY_MAGNITUDE] = extremes.maxVelocityMagnitude;
+
+      Effect();
+    }
+
     template<class BroadcastPolicy>
     bool IncompressibilityChecker<BroadcastPolicy>::AreDensitiesAvailable() const
     {
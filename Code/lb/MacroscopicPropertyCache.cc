@@ -4,6 +4,9 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <cfloat>
+#include <algorithm>
+#include <cmath>
 #include "lb/MacroscopicPropertyCache.h"
 
 namespace hemelb
@@ -20,8 +23,18 @@ namespace hemelb
       stressTensorCache(simState, latticeData.GetLocalFluidSiteCount()),
       tractionCache(simState, latticeData.GetLocalFluidSiteCount()),
       tangentialProjectionTractionCache(simState, latticeData.GetLocalFluidSiteCount()),
-      siteCount(latticeData.GetLocalFluidSiteCount())
+      siteCount(latticeData.GetLocalFluidSiteCount()), restrictedSiteCount(0),
+      siteRestrictionEnabled(false), nonPositiveDistributionSeen(false),
+#ifdef HEMELB_USE_OPENMP
+      threadExtremes(omp_get_max_threads()),
+#else
+      threadExtremes(1),
+#endif
+      globalDensityExtremesSet(false)
     {
+      // Start with empty density extremes and relative change, but nothing required.
+      SetDensityExtremesRequired();
+      SetRelativeChangeRequired();
       ResetRequirements();
     }
 
@@ -35,12 +48,144 @@ namespace hemelb
       stressTensorCache.UnsetRefreshFlag();
       tractionCache.UnsetRefreshFlag();
       tangentialProjectionTractionCache.UnsetRefreshFlag();
+      densityExtremesRequired = false;
+      relativeChangeRequired = false;
+    }
+
+    void MacroscopicPropertyCache::SetDensityExtremesRequired()
+    {
+      for (std::vector<ThreadExtremes>::iterator extremes = threadExtremes.begin();
+          extremes != threadExtremes.end(); ++extremes)
+      {
+        extremes->minDensity = DBL_MAX;
+        extremes->maxDensity = -DBL_MAX;
+        extremes->maxVelocitySquared = 0.0;
+      }
+      densityExtremesRequired = true;
+    }
+
+    void MacroscopicPropertyCache::SetRelativeChangeRequired()
+    {
+      for (std::vector<ThreadExtremes>::iterator extremes = threadExtremes.begin();
+          extremes != threadExtremes.end(); ++extremes)
+      {
+        extremes->maxRelativeChange = 0.0;
+      }
+      relativeChangeRequired = true;
+    }
+
+    distribn_t MacroscopicPropertyCache::GetLocalMaxRelativeChange() const
+    {
+      distribn_t maxRelativeChange = 0.0;
+      for (std::vector<ThreadExtremes>::const_iterator extremes = threadExtremes.begin();
+          extremes != threadExtremes.end(); ++extremes)
+      {
+        if (! (extremes->maxRelativeChange <= maxRelativeChange))
+        {
+          maxRelativeChange = extremes->maxRelativeChange;
+        }
+      }
+      return maxRelativeChange;
+    }
+
+    MacroscopicPropertyCache::DensityExtremes MacroscopicPropertyCache::GetLocalDensityExtremes() const
+    {
+      DensityExtremes local;
+      local.minDensity = DBL_MAX;
+      local.maxDensity = -DBL_MAX;
+      distribn_t maxVelocitySquared = 0.0;
+      for (std::vector<ThreadExtremes>::const_iterator extremes = threadExtremes.begin();
+          extremes != threadExtremes.end(); ++extremes)
+      {
+        local.minDensity = std::min(local.minDensity, extremes->minDensity);
+        local.maxDensity = std::max(local.maxDensity, extremes->maxDensity);
+        maxVelocitySquared = std::max(maxVelocitySquared, extremes->maxVelocitySquared);
+      }
+      local.maxVelocityMagnitude = std::sqrt(maxVelocitySquared);
+      return local;
+    }
+
+    void MacroscopicPropertyCache::SetGlobalDensityExtremes(const DensityExtremes& extremes)
+    {
+      globalDensityExtremes = extremes;
+      globalDensityExtremesSet = true;
+    }
+
+    bool MacroscopicPropertyCache::AnyRequiresRefresh() const
+    {
+      return densityCache.RequiresRefresh() || velocityCache.RequiresRefresh()
+          || vonMisesStressCache.RequiresRefresh() || wallShearStressMagnitudeCache.RequiresRefresh()
+          || shearRateCache.RequiresRefresh() || stressTensorCache.RequiresRefresh()
+          || tractionCache.RequiresRefresh() || tangentialProjectionTractionCache.RequiresRefresh()
+          || densityExtremesRequired || relativeChangeRequired;
     }
 
     site_t MacroscopicPropertyCache::GetSiteCount() const
     {
       return siteCount;
     }
+
+    void MacroscopicPropertyCache::RestrictToSites(const std::vector<site_t>& localSiteIndices)
+    {
+      cacheIndices.assign(siteCount, -1);
+      for (site_t cacheIndex = 0; cacheIndex < (site_t) localSiteIndices.size(); ++cacheIndex)
+      {
+        cacheIndices[localSiteIndices[cacheIndex]] = cacheIndex;
+      }
+      restrictedSiteCount = localSiteIndices.size();
+
+      siteRestrictionEnabled = false;
+      SetSiteRestrictionEnabled(true);
+    }
+
+    void MacroscopicPropertyCache::SetSiteRestrictionEnabled(bool enabled)
+    {
+      if (cacheIndices.empty() || enabled == siteRestrictionEnabled)
+      {
+        return;
+      }
+
+      siteRestrictionEnabled = enabled;
+      if (enabled)
+      {
+        SetIndexMap(&cacheIndices, restrictedSiteCount);
+      }
+      else
+      {
+        SetIndexMap(NULL, siteCount);
+      }
+    }
+
+    size_t MacroscopicPropertyCache::GetMemoryUsage() const
+    {
+      return densityCache.GetMemoryUsage() + velocityCache.GetMemoryUsage()
+          + wallShearStressMagnitudeCache.GetMemoryUsage() + vonMisesStressCache.GetMemoryUsage()
+          + shearRateCache.GetMemoryUsage() + stressTensorCache.GetMemoryUsage()
+          + tractionCache.GetMemoryUsage() + tangentialProjectionTractionCache.GetMemoryUsage()
+          + cacheIndices.capacity() * sizeof(site_t);
+    }
+
+    size_t MacroscopicPropertyCache::GetMemoryUsage(site_t siteCount)
+    {
+      // Each cache keeps the time step of each value as well as the value.
+      const size_t bytesPerSite = 5 * sizeof(distribn_t) + sizeof(util::Vector3D<distribn_t>)
+          + sizeof(util::Matrix3D) + 2 * sizeof(util::Vector3D<LatticeStress>)
+          + 8 * sizeof(unsigned long);
+      return siteCount * bytesPerSite;
+    }
+
+    void MacroscopicPropertyCache::SetIndexMap(const std::vector<site_t>* indexMap,
+                                               unsigned long size)
+    {
+      densityCache.SetIndexMap(indexMap, size);
+      velocityCache.SetIndexMap(indexMap, size);
+      wallShearStressMagnitudeCache.SetIndexMap(indexMap, size);
+      vonMisesStressCache.SetIndexMap(indexMap, size);
+      shearRateCache.SetIndexMap(indexMap, size);
+      stressTensorCache.SetIndexMap(indexMap, size);
+      tractionCache.SetIndexMap(indexMap, size);
+      tangentialProjectionTractionCache.SetIndexMap(indexMap, size);
+    }
   }
 }
 
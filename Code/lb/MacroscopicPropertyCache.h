@@ -8,6 +8,9 @@
 #define HEMELB_LB_MACROSCOPICPROPERTYCACHE_H
 
 #include <vector>
+#ifdef HEMELB_USE_OPENMP
+#include <omp.h>
+#endif
 #include "geometry/LatticeData.h"
 #include "lb/SimulationState.h"
 #include "units.h"
@@ -37,12 +40,196 @@ namespace hemelb
          */
         void ResetRequirements();
 
+        /**
+         * True if any of the caches needs refreshing this timestep.
+         * @return
+         */
+        bool AnyRequiresRefresh() const;
+
+        /**
+         * Record that a streamer collided a site with a non-positive (or NaN) distribution.
+         */
+        inline void NoteNonPositiveDistribution()
+        {
+          // This may be called from several threads at once; they only ever set the flag.
+#ifdef HEMELB_USE_OPENMP
+#pragma omp atomic write
+#endif
+          nonPositiveDistributionSeen = true;
+        }
+
+        /**
+         * True if a non-positive (or NaN) distribution has been seen by the streamers since the
+         * last call to ClearNonPositiveDistributionFlag.
+         * @return
+         */
+        inline bool HasSeenNonPositiveDistribution() const
+        {
+          return nonPositiveDistributionSeen;
+        }
+
+        inline void ClearNonPositiveDistributionFlag()
+        {
+          nonPositiveDistributionSeen = false;
+        }
+
+        /**
+         * The smallest and largest density and the largest velocity magnitude over some sites.
+         */
+        struct DensityExtremes
+        {
+            distribn_t minDensity;
+            distribn_t maxDensity;
+            distribn_t maxVelocityMagnitude;
+        };
+
+        /**
+         * Have the streamers track the density extremes of the sites they collide this
+         * timestep, for the incompressibility check, starting afresh.
+         */
+        void SetDensityExtremesRequired();
+
+        inline bool DensityExtremesRequired() const
+        {
+          return densityExtremesRequired;
+        }
+
+        /**
+         * Record the density and velocity of a site collided by the calling thread.
+         * @param density
+         * @param velocity
+         */
+        inline void NoteDensityAndVelocity(distribn_t density,
+                                           const util::Vector3D<distribn_t>& velocity)
+        {
+#ifdef HEMELB_USE_OPENMP
+          ThreadExtremes& extremes = threadExtremes[omp_get_thread_num()];
+#else
+          ThreadExtremes& extremes = threadExtremes[0];
+#endif
+          if (density < extremes.minDensity)
+          {
+            extremes.minDensity = density;
+          }
+          if (density > extremes.maxDensity)
+          {
+            extremes.maxDensity = density;
+          }
+          const distribn_t velocitySquared = velocity.GetMagnitudeSquared();
+          if (velocitySquared > extremes.maxVelocitySquared)
+          {
+            extremes.maxVelocitySquared = velocitySquared;
+          }
+        }
+
+        /**
+         * Have the streamers track the largest relative change |fNew - fOld| / fOld in the
+         * distributions the sites they collide send this timestep, for the convergence check,
+         * starting afresh.
+         */
+        void SetRelativeChangeRequired();
+
+        inline bool RelativeChangeRequired() const
+        {
+          return relativeChangeRequired;
+        }
+
+        /**
+         * Record the largest relative change in a site's distributions, collided by the calling
+         * thread.
+         * @param relativeChange
+         */
+        inline void NoteRelativeChange(distribn_t relativeChange)
+        {
+#ifdef HEMELB_USE_OPENMP
+          ThreadExtremes& extremes = threadExtremes[omp_get_thread_num()];
+#else
+          ThreadExtremes& extremes = threadExtremes[0];
+#endif
+          // Written so that a NaN is kept.
+          if (! (relativeChange <= extremes.maxRelativeChange))
+          {
+            extremes.maxRelativeChange = relativeChange;
+          }
+        }
+
+        /**
+         * The largest relative change of the sites collided on this core since the last call to
+         * SetRelativeChangeRequired, or 0 without any.
+         * @return
+         */
+        distribn_t GetLocalMaxRelativeChange() const;
+
+        /**
+         * The extremes of the sites collided on this core since the last call to
+         * SetDensityExtremesRequired. Without any, the smallest density is DBL_MAX and the
+         * largest -DBL_MAX.
+         * @return
+         */
+        DensityExtremes GetLocalDensityExtremes() const;
+
+        /**
+         * The extremes over every core, which the StabilityTester finds along with the
+         * stability when it uses a collective.
+         */
+        void SetGlobalDensityExtremes(const DensityExtremes& extremes);
+
+        inline bool HasGlobalDensityExtremes() const
+        {
+          return globalDensityExtremesSet;
+        }
+
+        inline const DensityExtremes& GetGlobalDensityExtremes() const
+        {
+          return globalDensityExtremes;
+        }
+
         /**
          * Returns the number of sites cached.
          * @return
          */
         site_t GetSiteCount() const;
 
+        /**
+         * Only cache properties at the given local sites (e.g. those read by the property
+         * extraction), rather than at every local fluid site. The caches are still indexed by
+         * local site index.
+         * @param localSiteIndices
+         */
+        void RestrictToSites(const std::vector<site_t>& localSiteIndices);
+
+        /**
+         * Turn a restriction made with RestrictToSites on or off, e.g. off on the steps where
+         * something needs the properties at every site. Does nothing if there is no restriction.
+         * @param enabled
+         */
+        void SetSiteRestrictionEnabled(bool enabled);
+
+        /**
+         * Returns the bytes allocated for all the caches.
+         * @return
+         */
+        size_t GetMemoryUsage() const;
+
+        /**
+         * Returns the bytes that the caches of the given number of sites would need, without
+         * any restriction.
+         * @param siteCount
+         * @return
+         */
+        static size_t GetMemoryUsage(site_t siteCount);
+
+        /**
+         * True if the properties of the given local site are cached, so that the streamers can
+         * skip the work for the others.
+         * @param siteIndex
+         * @return
+         */
+        inline bool IsSiteCached(site_t siteIndex) const
+        {
+          return !siteRestrictionEnabled || cacheIndices[siteIndex] >= 0;
+        }
+
         /**
          * The cache of densities for each fluid site on this core.
          */
@@ -93,6 +280,45 @@ namespace hemelb
          * The number of sites.
          */
         site_t siteCount;
+
+        /**
+         * The position of each local site in the caches when they are restricted to some sites
+         * (-1 for the sites that aren't cached), and the number of sites cached then. Empty if
+         * there is no restriction.
+         */
+        std::vector<site_t> cacheIndices;
+        site_t restrictedSiteCount;
+        bool siteRestrictionEnabled;
+
+        /**
+         * Make all the caches use the given index map (see RefreshableCache::SetIndexMap).
+         */
+        void SetIndexMap(const std::vector<site_t>* indexMap, unsigned long size);
+
+        /**
+         * Whether the streamers have seen a non-positive distribution, so that the stability
+         * check doesn't need its own pass over the distributions.
+         */
+        bool nonPositiveDistributionSeen;
+
+        /**
+         * The density extremes and largest relative change found by each thread, each on its own
+         * cache line so that the threads don't contend for them.
+         */
+        struct ThreadExtremes
+        {
+            distribn_t minDensity;
+            distribn_t maxDensity;
+            distribn_t maxVelocitySquared;
+            distribn_t maxRelativeChange;
+            char padding[64 - 4 * sizeof(distribn_t)];
+        };
+        std::vector<ThreadExtremes> threadExtremes;
+        bool densityExtremesRequired;
+        bool relativeChangeRequired;
+
+        DensityExtremes globalDensityExtremes;
+        bool globalDensityExtremesSet;
     };
   }
 }
@@ -29,6 +29,11 @@ namespace hemelb
       timeStep = 1;
     }
 
+    void SimulationState::SetTimeStep(LatticeTimeStep value)
+    {
+      timeStep = value;
+    }
+
     void SimulationState::SetIsTerminating(bool value)
     {
       isTerminating = value;
@@ -80,11 +85,17 @@ namespace hemelb
       {
         case lb::Unstable:
           dictionary.AddSectionDictionary("UNSTABLE");
+          dictionary.SetValue("STABILITY", "unstable");
           break;
         case lb::StableAndConverged:
           dictionary.AddSectionDictionary("SOLUTIONCONVERGED");
+          dictionary.SetValue("STABILITY", "converged");
+          break;
+        case lb::Stable:
+          dictionary.SetValue("STABILITY", "stable");
           break;
         default:
+          dictionary.SetValue("STABILITY", "undefined");
           break;
       }
     }
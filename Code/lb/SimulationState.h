@@ -30,6 +30,11 @@ namespace hemelb
 
         void Increment();
         void Reset();
+        /**
+         * Carry on from the given time step, e.g. when restarting from a checkpoint.
+         * @param value
+         */
+        void SetTimeStep(LatticeTimeStep value);
         void SetIsTerminating(bool value);
         void SetIsRendering(bool value);
         void SetStability(Stability value);
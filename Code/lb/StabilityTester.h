@@ -8,7 +8,9 @@
 #define HEMELB_LB_STABILITYTESTER_H
 
 #include "net/PhasedBroadcastRegular.h"
+#include "net/CollectiveAction.h"
 #include "geometry/LatticeData.h"
+#include "lb/MacroscopicPropertyCache.h"
 
 namespace hemelb
 {
@@ -25,16 +27,34 @@ namespace hemelb
      * can't overlap. We go down the tree to pass the overall stability to all nodes, and we go up
      * the tree to compose the local stability for all nodes to discover whether the simulation as
      * a whole is stable.
+     *
+     * The check for non-positive distributions is done by the streamers as they collide each
+     * site (see MacroscopicPropertyCache::HasSeenNonPositiveDistribution), on the distributions
+     * each site sends this timestep. The flag stays set until it is checked, so with a
+     * checkPeriod longer than one step a non-positive distribution on the steps in between is
+     * still caught. With the "distributions" convergence criterion the streamers also find the
+     * largest relative change in the distributions they send (see
+     * MacroscopicPropertyCache::SetRelativeChangeRequired), so there is no pass over the sites
+     * at all. Only the velocity criterion makes one, over every siteStride-th site, as it needs
+     * the velocities after streaming.
+     *
+     * With net::CollectiveAction as the BroadcastPolicy, the tree is replaced by one
+     * MPI_Iallreduce. The Stability values are ordered so that their minimum over the processes
+     * is the stability of the whole simulation. The same collective takes the density extremes
+     * that the streamers gathered for the IncompressibilityChecker (see
+     * MacroscopicPropertyCache::GetLocalDensityExtremes), so that it needs none of its own.
      */
-    template<class LatticeType>
-    class StabilityTester : public net::PhasedBroadcastRegular<>
+    template<class LatticeType, class BroadcastPolicy = net::PhasedBroadcastRegular<> >
+    class StabilityTester : public BroadcastPolicy
     {
       public:
         StabilityTester(const geometry::LatticeData * iLatDat, net::Net* net,
-                        SimulationState* simState, reporting::Timers& timings,
+                        SimulationState* simState, lb::MacroscopicPropertyCache& propertyCache,
+                        reporting::Timers& timings,
                         const hemelb::configuration::SimConfig::MonitoringConfig* testerConfig) :
-            net::PhasedBroadcastRegular<>(net, simState, SPREADFACTOR), mLatDat(iLatDat),
-                mSimState(simState), timings(timings), testerConfig(testerConfig)
+            BroadcastPolicy(net, simState, SPREADFACTOR, testerConfig->checkPeriod), mLatDat(iLatDat),
+                mSimState(simState), propertyCache(propertyCache), timings(timings),
+                testerConfig(testerConfig)
         {
           Reset();
         }
@@ -48,6 +68,7 @@ namespace hemelb
           mDownwardsStability = UndefinedStability;
 
           mSimState->SetStability(UndefinedStability);
+          propertyCache.ClearNonPositiveDistributionFlag();
 
           for (unsigned int ii = 0; ii < SPREADFACTOR; ii++)
           {
@@ -62,22 +83,22 @@ namespace hemelb
          */
         void ProgressFromChildren(unsigned long splayNumber)
         {
-          ReceiveFromChildren<int>(mChildrensStability, 1);
+          this->template ReceiveFromChildren<int>(mChildrensStability, 1);
         }
 
         void ProgressFromParent(unsigned long splayNumber)
         {
-          ReceiveFromParent<int>(&mDownwardsStability, 1);
+          this->template ReceiveFromParent<int>(&mDownwardsStability, 1);
         }
 
         void ProgressToChildren(unsigned long splayNumber)
         {
-          SendToChildren<int>(&mDownwardsStability, 1);
+          this->template SendToChildren<int>(&mDownwardsStability, 1);
         }
 
         void ProgressToParent(unsigned long splayNumber)
         {
-          SendToParent<int>(&mUpwardsStability, 1);
+          this->template SendToParent<int>(&mUpwardsStability, 1);
         }
 
         /**
@@ -97,30 +118,36 @@ namespace hemelb
           {
             bool unconvergedSitePresent = false;
 
-            for (site_t i = 0; i < mLatDat->GetLocalFluidSiteCount(); i++)
+            // The streamers have already checked every distribution they collided.
+            if (propertyCache.HasSeenNonPositiveDistribution())
             {
-              for (unsigned int l = 0; l < LatticeType::NUMVECTORS; l++)
-              {
-                distribn_t value = *mLatDat->GetFNew(i * LatticeType::NUMVECTORS + l);
+              mUpwardsStability = Unstable;
+              propertyCache.ClearNonPositiveDistributionFlag();
+            }
 
-                // Note that by testing for value > 0.0, we also catch stray NaNs.
-                if (! (value > 0.0))
+            if (mUpwardsStability != Unstable && testerConfig->doConvergenceCheck
+                && testerConfig->convergenceOnDistributions)
+            {
+              // The streamers found the largest relative change as they collided, too.
+              unconvergedSitePresent = ! (propertyCache.GetLocalMaxRelativeChange()
+                  <= testerConfig->convergenceRelativeTolerance);
+            }
+            else if (mUpwardsStability != Unstable && testerConfig->doConvergenceCheck)
+            {
+              for (site_t i = 0; i < mLatDat->GetLocalFluidSiteCount(); i += testerConfig->siteStride)
+              {
+                distribn_t fNew[LatticeType::NUMVECTORS];
+                distribn_t fOldBuffer[LatticeType::NUMVECTORS];
+                for (unsigned int l = 0; l < LatticeType::NUMVECTORS; l++)
                 {
-                  mUpwardsStability = Unstable;
-                  break;
+                  fNew[l] =
+                      mLatDat->GetFNewValue<LatticeType>(mLatDat->GetDistributionIndex<LatticeType>(i,
+                                                                                                  l));
                 }
-              }
-              ///@todo: If we refactor the previous loop out, we can get away with a single break statement
-              if (mUpwardsStability == Unstable)
-              {
-                break;
-              }
 
-              if (testerConfig->doConvergenceCheck)
-              {
                 distribn_t relativeDifference =
-                    ComputeRelativeDifference(mLatDat->GetFNew(i * LatticeType::NUMVECTORS),
-                                              mLatDat->GetSite(i).GetFOld<LatticeType>());
+                    ComputeRelativeDifference(fNew,
+                                              mLatDat->GetSite(i).GetFOld<LatticeType>(fOldBuffer));
 
                 if (relativeDifference > testerConfig->convergenceRelativeTolerance)
                 {
@@ -254,7 +281,8 @@ namespace hemelb
               // With the current configuration the root node of the tree won't own any fluid sites. Its
               // state only depends on children nodes not on local state.
               if (anyConverged
-                  && (mUpwardsStability == StableAndConverged || GetParent() == NOPARENT))
+                  && (mUpwardsStability == StableAndConverged
+                      || this->GetParent() == BroadcastPolicy::NOPARENT))
               {
                 mUpwardsStability = StableAndConverged;
               }
@@ -277,12 +305,61 @@ namespace hemelb
           mSimState->SetStability((Stability) mDownwardsStability);
         }
 
+        /**
+         * The methods used with net::CollectiveAction instead of the tree. Assess the stability
+         * of this node then start taking the minimum over all of them, along with the density
+         * extremes. Everything is negated as needed so that one MPI_MAX combines it all.
+         */
+        void StartReduction(const net::MpiCommunicator& comms, MPI_Request& request)
+        {
+          PostSendToParent(0);
+
+          timings[hemelb::reporting::Timers::monitoring].Start();
+          const MacroscopicPropertyCache::DensityExtremes extremes =
+              propertyCache.GetLocalDensityExtremes();
+          localMaxima[STABILITY] = -mUpwardsStability;
+          localMaxima[MIN_DENSITY] = -extremes.minDensity;
+          localMaxima[MAX_DENSITY] = extremes.maxDensity;
+          localMaxima[MAX_VELOCITY_MAGNITUDE] = extremes.maxVelocityMagnitude;
+
+          HEMELB_MPI_CALL(MPI_Iallreduce,
+                          (localMaxima, globalMaxima, REDUCTION_SIZE, net::MpiDataType<distribn_t>(), MPI_MAX, comms, &request));
+          timings[hemelb::reporting::Timers::monitoring].Stop();
+        }
+
+        void PostReduce()
+        {
+          mDownwardsStability = (int) -globalMaxima[STABILITY];
+
+          // Only pass the extremes on if some process collided a site while tracking them.
+          MacroscopicPropertyCache::DensityExtremes extremes;
+          extremes.minDensity = -globalMaxima[MIN_DENSITY];
+          extremes.maxDensity = globalMaxima[MAX_DENSITY];
+          extremes.maxVelocityMagnitude = globalMaxima[MAX_VELOCITY_MAGNITUDE];
+          if (extremes.minDensity <= extremes.maxDensity)
+          {
+            propertyCache.SetGlobalDensityExtremes(extremes);
+          }
+
+          Effect();
+        }
+
       private:
         /**
          * Slightly arbitrary spread factor for the tree.
          */
         static const unsigned int SPREADFACTOR = 10;
 
+        //! The places of the values in the collective's buffers.
+        enum ReductionIndices
+        {
+          STABILITY = 0,
+          MIN_DENSITY,
+          MAX_DENSITY,
+          MAX_VELOCITY_MAGNITUDE,
+          REDUCTION_SIZE
+        };
+
         const geometry::LatticeData * mLatDat;
 
         /**
@@ -302,11 +379,19 @@ namespace hemelb
          */
         lb::SimulationState* mSimState;
 
+        //! Where the streamers record whether they've seen a non-positive distribution, and
+        //! the density extremes.
+        lb::MacroscopicPropertyCache& propertyCache;
+
         /** Timing object. */
         reporting::Timers& timings;
 
         /** Object containing the user-provided configuration for this class */
         const hemelb::configuration::SimConfig::MonitoringConfig* testerConfig;
+
+        /** The values of this node and of the whole domain, as passed to the collective. */
+        distribn_t localMaxima[REDUCTION_SIZE];
+        distribn_t globalMaxima[REDUCTION_SIZE];
     };
   }
 }
@@ -0,0 +1,92 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+#include <cmath>
+#include "lb/SteadyStateAccelerator.h"
+#include "log/Logger.h"
+
+namespace hemelb
+{
+  namespace lb
+  {
+    const double SteadyStateAccelerator::MaximumAdaptiveFactor = 10.0;
+
+    SteadyStateAccelerator::SteadyStateAccelerator(geometry::LatticeData& latticeData,
+                                                   const SimulationState& simState,
+                                                   const net::MpiCommunicator& comms,
+                                                   reporting::Timers& timings,
+                                                   unsigned long period, double factor) :
+        latticeData(latticeData), simState(simState), comms(comms), timings(timings),
+            period(period), factor(factor), previousChange(-1.0), lastFactor(0.0)
+    {
+    }
+
+    void SteadyStateAccelerator::PostReceive()
+    {
+      if (simState.GetTimeStep() % period != 0)
+      {
+        return;
+      }
+
+      timings[reporting::Timers::monitoring].Start();
+      // The local sites' distributions come first, however they're laid out. Any compressed
+      // sites are the first sites, and are left to converge by themselves.
+      const site_t first = latticeData.GetCompressedSiteCount()
+          * latticeData.GetLatticeInfo().GetNumVectors();
+      const site_t count = latticeData.GetLocalFluidSiteCount()
+          * latticeData.GetLatticeInfo().GetNumVectors() - first;
+      Extrapolate(count > 0 ?
+                    latticeData.GetFNew(first) :
+                    NULL,
+                  count);
+      timings[reporting::Timers::monitoring].Stop();
+    }
+
+    void SteadyStateAccelerator::Extrapolate(stored_distribn_t* distributions, site_t count)
+    {
+      // The first time, there's nothing to extrapolate from yet.
+      if (previousChange < 0.0)
+      {
+        snapshot.assign(distributions, distributions + count);
+        previousChange = 0.0;
+        return;
+      }
+
+      double stepFactor = factor;
+      if (factor == 0.0)
+      {
+        double localChange = 0.0;
+        for (site_t index = 0; index < count; ++index)
+        {
+          const double change = distributions[index] - snapshot[index];
+          localChange += change * change;
+        }
+        const double change = comms.AllReduce(localChange, MPI_SUM);
+
+        // Only while the change is shrinking is it a decaying mode to skip.
+        stepFactor = 0.0;
+        if (previousChange > 0.0 && change < previousChange)
+        {
+          const double ratio = std::sqrt(change / previousChange);
+          stepFactor = std::min(ratio / (1.0 - ratio), MaximumAdaptiveFactor);
+        }
+        previousChange = change;
+      }
+
+      for (site_t index = 0; index < count; ++index)
+      {
+        const double current = distributions[index];
+        const double extrapolated = current + stepFactor * (current - snapshot[index]);
+        distributions[index] = extrapolated;
+        snapshot[index] = extrapolated;
+      }
+      lastFactor = stepFactor;
+
+      log::Logger::Log<log::Debug, log::Singleton>("Extrapolated towards the steady state with factor %f",
+                                                    stepFactor);
+    }
+  }
+}
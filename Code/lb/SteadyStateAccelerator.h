@@ -0,0 +1,93 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_LB_STEADYSTATEACCELERATOR_H
+#define HEMELB_LB_STEADYSTATEACCELERATOR_H
+
+#include <vector>
+#include "geometry/LatticeData.h"
+#include "lb/SimulationState.h"
+#include "net/IteratedAction.h"
+#include "net/MpiCommunicator.h"
+#include "reporting/Timers.h"
+
+namespace hemelb
+{
+  namespace lb
+  {
+    /**
+     * Speeds a run with steady boundary conditions towards its steady state, by extrapolating
+     * the distributions every so many steps along the way they have changed since the last
+     * time: f += factor * (f - f_then). Near the steady state, the slowest mode left decays by
+     * much the same ratio each period, so the rest of its decay can be skipped.
+     *
+     * The factor is either given, or found each period from the ratio r of the change over the
+     * period to the change over the one before, over all the sites: r / (1 - r) takes the mode
+     * straight to the steady state (Aitken's extrapolation). It is found with one all-reduce
+     * per period, and it is limited, and nothing is extrapolated while the change isn't
+     * shrinking.
+     *
+     * Only the local sites' distributions are extrapolated, once the streaming of the step has
+     * finished, so it has to be registered after the LBM. The StabilityTester's convergence
+     * check then judges when the run has converged, as without it.
+     */
+    class SteadyStateAccelerator : public net::IteratedAction
+    {
+      public:
+        /**
+         * @param latticeData
+         * @param simState
+         * @param comms
+         * @param timings
+         * @param period The number of steps between extrapolations.
+         * @param factor The extrapolation factor, or 0 to find it each period.
+         */
+        SteadyStateAccelerator(geometry::LatticeData& latticeData, const SimulationState& simState,
+                               const net::MpiCommunicator& comms, reporting::Timers& timings,
+                               unsigned long period, double factor);
+
+        /**
+         * Extrapolate the distributions the step has just made, if it is time to.
+         */
+        void PostReceive();
+
+        /**
+         * The factor of the last extrapolation.
+         * @return
+         */
+        double GetLastFactor() const
+        {
+          return lastFactor;
+        }
+
+        //! The largest factor found for an adaptive extrapolation.
+        static const double MaximumAdaptiveFactor;
+
+      private:
+        /**
+         * Extrapolate the given distributions along their change since the last snapshot, and
+         * take a new snapshot of them.
+         * @param distributions
+         * @param count
+         */
+        void Extrapolate(stored_distribn_t* distributions, site_t count);
+
+        geometry::LatticeData& latticeData;
+        const SimulationState& simState;
+        const net::MpiCommunicator& comms;
+        reporting::Timers& timings;
+        const unsigned long period;
+        const double factor;
+        //! The local distributions at the last extrapolation.
+        std::vector<double> snapshot;
+        //! The squared change over all the sites in the last period, or -1 before the first
+        //! snapshot.
+        double previousChange;
+        double lastFactor;
+    };
+  }
+}
+
+#endif /* HEMELB_LB_STEADYSTATEACCELERATOR_H */
@@ -0,0 +1,229 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "lb/SubdomainCapture.h"
+#include <cstdio>
+#include "Exception.h"
+#include "io/formats/formats.h"
+#include "io/writers/xdr/XdrFileReader.h"
+#include "io/writers/xdr/XdrFileWriter.h"
+#include "lb/iolets/InOutLetCosine.h"
+#include "lb/iolets/InOutLetParabolicVelocity.h"
+
+#define HEMELB_CAPTURE_QUOTE(name) #name
+#define HEMELB_CAPTURE_NAME(name) HEMELB_CAPTURE_QUOTE(name)
+
+namespace hemelb
+{
+  namespace lb
+  {
+    namespace
+    {
+      unsigned GetBuildLayout()
+      {
+#ifdef HEMELB_USE_SOA_DISTRIBUTIONS
+        unsigned layout = io::formats::capture::DirectionMajorLayout;
+#else
+        unsigned layout = io::formats::capture::SiteMajorLayout;
+#endif
+#ifdef HEMELB_USE_PULL_STREAMING
+        layout |= io::formats::capture::PulledLayoutFlag;
+#endif
+        return layout;
+      }
+    }
+
+    std::string SubdomainCapture::GetBuildConfiguration()
+    {
+      return std::string(HEMELB_CAPTURE_NAME(HEMELB_LATTICE)) + " "
+          + HEMELB_CAPTURE_NAME(HEMELB_KERNEL) + " " + HEMELB_CAPTURE_NAME(HEMELB_WALL_BOUNDARY)
+          + " " + HEMELB_CAPTURE_NAME(HEMELB_INLET_BOUNDARY) + " "
+          + HEMELB_CAPTURE_NAME(HEMELB_OUTLET_BOUNDARY) + " "
+          + HEMELB_CAPTURE_NAME(HEMELB_WALL_INLET_BOUNDARY) + " "
+          + HEMELB_CAPTURE_NAME(HEMELB_WALL_OUTLET_BOUNDARY);
+    }
+
+    void SubdomainCapture::Write(const std::string& path, const geometry::LatticeData& latticeData,
+                                 const LbmParameters& lbmParams,
+                                 iolets::BoundaryValues& inletValues,
+                                 iolets::BoundaryValues& outletValues, LatticeTimeStep timeStep,
+                                 const net::IOCommunicator& comms)
+    {
+      io::writers::xdr::XdrFileWriter writer(path);
+      writer << (uint32_t) io::formats::HemeLbMagicNumber
+          << (uint32_t) io::formats::capture::MagicNumber
+          << (uint32_t) io::formats::capture::VersionNumber
+          << (uint32_t) latticeData.GetLatticeInfo().GetNumVectors() << (uint32_t) GetBuildLayout()
+          << (uint32_t) comms.Rank() << (uint32_t) comms.Size() << (uint64_t) timeStep;
+
+      writer << GetBuildConfiguration() << lbmParams.GetTimeStep() << lbmParams.GetVoxelSize()
+          << (uint32_t) lbmParams.StressType;
+      WriteIolets(writer, inletValues);
+      WriteIolets(writer, outletValues);
+      latticeData.WriteSubdomain(writer);
+    }
+
+    void SubdomainCapture::WriteIolets(io::writers::Writer& writer,
+                                       iolets::BoundaryValues& ioletValues)
+    {
+      // All of them, as the sites refer to them by their global ids.
+      writer << (uint32_t) ioletValues.GetIoletCount();
+      for (unsigned ioletId = 0; ioletId < ioletValues.GetIoletCount(); ++ioletId)
+      {
+        iolets::InOutLet* iolet = ioletValues.GetIolet(ioletId);
+        const iolets::InOutLetVelocity* velocityIolet =
+            dynamic_cast<const iolets::InOutLetVelocity*>(iolet);
+
+        writer << (uint32_t) (velocityIolet == NULL ?
+          io::formats::capture::PressureIolet :
+          io::formats::capture::VelocityIolet) << ioletValues.GetBoundaryDensity(ioletId);
+        writer << iolet->GetPosition().x << iolet->GetPosition().y << iolet->GetPosition().z;
+        writer << iolet->GetNormal().x << iolet->GetNormal().y << iolet->GetNormal().z;
+        if (velocityIolet != NULL)
+        {
+          const LatticeVelocity centreVelocity =
+              velocityIolet->GetVelocity(iolet->GetPosition(), ioletValues.GetTimeStep());
+          writer << velocityIolet->GetRadius() << centreVelocity.Dot(iolet->GetNormal());
+        }
+      }
+    }
+
+    SubdomainCapture::SubdomainCapture(const std::string& path,
+                                       const lattices::LatticeInfo& latticeInfo,
+                                       const net::IOCommunicator& comms) :
+        lbmParams(NULL), latticeData(NULL)
+    {
+      FILE* captureFile = std::fopen(path.c_str(), "r");
+      if (captureFile == NULL)
+      {
+        throw Exception() << "Could not open the capture " << path;
+      }
+      io::writers::xdr::XdrFileReader reader(captureFile);
+
+      unsigned hemeLbMagic = 0, captureMagic = 0, version = 0, fileNumVectors = 0, layout = 0;
+      unsigned fileRank = 0, fileRankCount = 0;
+      uint64_t fileTimeStep = 0;
+      reader.readUnsignedInt(hemeLbMagic);
+      reader.readUnsignedInt(captureMagic);
+      reader.readUnsignedInt(version);
+      reader.readUnsignedInt(fileNumVectors);
+      reader.readUnsignedInt(layout);
+      reader.readUnsignedInt(fileRank);
+      reader.readUnsignedInt(fileRankCount);
+      reader.readUnsignedLong(fileTimeStep);
+
+      if (hemeLbMagic != io::formats::HemeLbMagicNumber
+          || captureMagic != io::formats::capture::MagicNumber)
+      {
+        std::fclose(captureFile);
+        throw Exception() << path << " is not a capture file";
+      }
+      if (version != io::formats::capture::VersionNumber)
+      {
+        std::fclose(captureFile);
+        throw Exception() << "Capture " << path << " has version " << version << ", expected "
+            << unsigned(io::formats::capture::VersionNumber);
+      }
+      // The distribution arrays are read as they were, so must be laid out the same way.
+      if (fileNumVectors != latticeInfo.GetNumVectors() || layout != GetBuildLayout())
+      {
+        std::fclose(captureFile);
+        throw Exception() << "Capture " << path << " is of a lattice with " << fileNumVectors
+            << " directions in layout " << layout << ", but this build has "
+            << latticeInfo.GetNumVectors() << " in layout " << GetBuildLayout();
+      }
+      timeStep = fileTimeStep;
+      rank = fileRank;
+      rankCount = fileRankCount;
+
+      double timeStepLength = 0.0, voxelSize = 0.0;
+      unsigned stressType = 0;
+      reader.readString(configuration);
+      reader.readDouble(timeStepLength);
+      reader.readDouble(voxelSize);
+      reader.readUnsignedInt(stressType);
+      lbmParams = new LbmParameters(timeStepLength, voxelSize);
+      lbmParams->StressType = (StressTypes) stressType;
+
+      try
+      {
+        ReadIolets(reader, inlets);
+        ReadIolets(reader, outlets);
+        latticeData = new geometry::LatticeData(latticeInfo, reader, comms);
+      }
+      catch (const Exception& e)
+      {
+        std::fclose(captureFile);
+        throw Exception() << "Could not read the capture " << path << ": " << e.what();
+      }
+      std::fclose(captureFile);
+    }
+
+    void SubdomainCapture::ReadIolets(io::writers::xdr::XdrReader& reader,
+                                      std::vector<iolets::InOutLet*>& iolets)
+    {
+      unsigned ioletCount = 0;
+      reader.readUnsignedInt(ioletCount);
+      for (unsigned ioletId = 0; ioletId < ioletCount; ++ioletId)
+      {
+        unsigned kind = 0;
+        LatticeDensity density = 0.0;
+        LatticePosition position;
+        util::Vector3D<Dimensionless> normal;
+        bool read = reader.readUnsignedInt(kind) && reader.readDouble(density);
+        for (unsigned dim = 0; dim < 3; ++dim)
+        {
+          read = read && reader.readDouble(position[dim]);
+        }
+        for (unsigned dim = 0; dim < 3; ++dim)
+        {
+          read = read && reader.readDouble(normal[dim]);
+        }
+
+        iolets::InOutLet* iolet;
+        if (kind == io::formats::capture::VelocityIolet)
+        {
+          LatticeDistance radius = 0.0;
+          LatticeSpeed speed = 0.0;
+          read = read && reader.readDouble(radius) && reader.readDouble(speed);
+          iolets::InOutLetParabolicVelocity* velocityIolet =
+              new iolets::InOutLetParabolicVelocity();
+          velocityIolet->SetRadius(radius);
+          velocityIolet->SetMaxSpeed(speed);
+          iolet = velocityIolet;
+        }
+        else
+        {
+          iolets::InOutLetCosine* pressureIolet = new iolets::InOutLetCosine();
+          pressureIolet->SetDensityMean(density);
+          pressureIolet->SetDensityAmp(0.0);
+          iolet = pressureIolet;
+        }
+        iolet->SetPosition(position);
+        iolet->SetNormal(normal);
+        iolets.push_back(iolet);
+
+        if (!read)
+        {
+          throw Exception() << "The captured iolets are cut short";
+        }
+      }
+    }
+
+    SubdomainCapture::~SubdomainCapture()
+    {
+      for (size_t ioletId = 0; ioletId < inlets.size(); ++ioletId)
+      {
+        delete inlets[ioletId];
+      }
+      for (size_t ioletId = 0; ioletId < outlets.size(); ++ioletId)
+      {
+        delete outlets[ioletId];
+      }
+      delete latticeData;
+      delete lbmParams;
+    }
+  }
+}
@@ -0,0 +1,126 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_LB_SUBDOMAINCAPTURE_H
+#define HEMELB_LB_SUBDOMAINCAPTURE_H
+
+#include <string>
+#include <vector>
+#include "geometry/LatticeData.h"
+#include "io/formats/capture.h"
+#include "io/writers/Writer.h"
+#include "io/writers/xdr/XdrReader.h"
+#include "lb/LbmParameters.h"
+#include "lb/iolets/BoundaryValues.h"
+#include "net/IOCommunicator.h"
+#include "units.h"
+
+namespace hemelb
+{
+  namespace lb
+  {
+    /**
+     * A capture of one rank's subdomain at the end of a time step (see io/formats/capture.h),
+     * for hemelb_replay to run the subdomain's collide-and-stream loop again on a workstation,
+     * where it can be profiled, with the halo fed from the distributions received at that step.
+     *
+     * The capture holds what the loop reads: the lattice, the kernel parameters and the value of
+     * each iolet at the time step. Read back, the pressure iolets are cosine iolets with no
+     * amplitude and the velocity iolets parabolic ones with a fixed peak speed, so they keep
+     * those values however many steps are replayed.
+     */
+    class SubdomainCapture
+    {
+      public:
+        /**
+         * Write a capture of this rank's subdomain. Only the rank captured calls this.
+         * @param path
+         * @param latticeData
+         * @param lbmParams
+         * @param inletValues
+         * @param outletValues
+         * @param timeStep The time step just done.
+         * @param comms
+         */
+        static void Write(const std::string& path, const geometry::LatticeData& latticeData,
+                          const LbmParameters& lbmParams, iolets::BoundaryValues& inletValues,
+                          iolets::BoundaryValues& outletValues, LatticeTimeStep timeStep,
+                          const net::IOCommunicator& comms);
+
+        /**
+         * Read a capture, to replay on this core.
+         * @param path
+         * @param latticeInfo The lattice of this build, which must be the capture's.
+         * @param comms
+         */
+        SubdomainCapture(const std::string& path, const lattices::LatticeInfo& latticeInfo,
+                         const net::IOCommunicator& comms);
+
+        ~SubdomainCapture();
+
+        /**
+         * @return The lattice, kernel and boundary conditions this build was configured with,
+         * as stored in its captures.
+         */
+        static std::string GetBuildConfiguration();
+
+        LatticeTimeStep GetTimeStep() const
+        {
+          return timeStep;
+        }
+
+        proc_t GetRank() const
+        {
+          return rank;
+        }
+
+        proc_t GetRankCount() const
+        {
+          return rankCount;
+        }
+
+        const std::string& GetConfiguration() const
+        {
+          return configuration;
+        }
+
+        const LbmParameters& GetLbmParameters() const
+        {
+          return *lbmParams;
+        }
+
+        geometry::LatticeData& GetLatticeData()
+        {
+          return *latticeData;
+        }
+
+        const std::vector<iolets::InOutLet*>& GetInlets() const
+        {
+          return inlets;
+        }
+
+        const std::vector<iolets::InOutLet*>& GetOutlets() const
+        {
+          return outlets;
+        }
+
+      private:
+        static void WriteIolets(io::writers::Writer& writer, iolets::BoundaryValues& ioletValues);
+        static void ReadIolets(io::writers::xdr::XdrReader& reader,
+                               std::vector<iolets::InOutLet*>& iolets);
+
+        LatticeTimeStep timeStep;
+        proc_t rank;
+        proc_t rankCount;
+        std::string configuration;
+        LbmParameters* lbmParams;
+        geometry::LatticeData* latticeData;
+        std::vector<iolets::InOutLet*> inlets;
+        std::vector<iolets::InOutLet*> outlets;
+    };
+  }
+}
+
+#endif /* HEMELB_LB_SUBDOMAINCAPTURE_H */
@@ -0,0 +1,370 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_LB_WARMSTART_H
+#define HEMELB_LB_WARMSTART_H
+
+#include <cmath>
+#include <map>
+#include <string>
+#include <vector>
+#include "constants.h"
+#include "Exception.h"
+#include "geometry/LatticeData.h"
+#include "io/readers/ExtractionFile.h"
+#include "util/UnitConverter.h"
+#include "units.h"
+
+namespace hemelb
+{
+  namespace lb
+  {
+    /**
+     * Starts a run from the flow of an earlier, coarser run of the same geometry, instead of
+     * from rest, to skip most of the transient. The coarse run writes property output with the
+     * pressure and velocity (and ideally the stress tensor) of every site; each fine site is
+     * then given the equilibrium for the density and velocity interpolated there, plus the
+     * non-equilibrium part that gives the interpolated deviatoric stress.
+     *
+     * Positions are matched in physical units, so the coarse run may have any voxel size and
+     * origin, and a run of a neighbouring case on the same lattice can be started from too.
+     * The values are interpolated trilinearly from the coarse sites at the corners of the
+     * coarse voxel each fine site is in, reweighted over the corners that are fluid. Fine sites
+     * with no fluid corner (only possible very near the walls) keep their initial conditions.
+     *
+     * Each core only reads the values at the coarse sites near its own, which only touches the
+     * parts of the mapped file they are in. Delta encoded records have to be decoded whole.
+     */
+    template<class LatticeType>
+    class WarmStart
+    {
+      public:
+        /**
+         * Read the coarse flow near this core's sites.
+         * @param path A property output file of the coarse run
+         * @param timestep The time step of the record to start from, or -1 for the last one
+         * @param latticeData The fine lattice
+         * @param unitConverter The fine lattice's
+         * @param tau The fine lattice's relaxation time
+         * @param pressureField The names of the fields in the file
+         * @param velocityField
+         * @param stressTensorField The stress tensor is left out if the file hasn't a field of
+         * this name
+         */
+        WarmStart(const std::string& path, long timestep, const geometry::LatticeData& latticeData,
+                  const util::UnitConverter& unitConverter, distribn_t tau,
+                  const std::string& pressureField = "pressure",
+                  const std::string& velocityField = "velocity",
+                  const std::string& stressTensorField = "stresstensor") :
+            file(path), hasStress(false)
+        {
+          if (file.GetRecordCount() == 0)
+          {
+            throw Exception() << "Warm start file " << path << " has no records";
+          }
+          const size_t record = timestep < 0 ?
+            file.GetRecordCount() - 1 :
+            file.FindRecord(timestep);
+
+          // Where the pressure, velocity and stress are among each site's values.
+          const std::vector<io::readers::ExtractionFile::FieldHeader>& fields = file.GetFields();
+          std::vector<unsigned> fieldOffsets(fields.size() + 1, 0);
+          for (unsigned field = 0; field < fields.size(); ++field)
+          {
+            fieldOffsets[field + 1] = fieldOffsets[field] + fields[field].length;
+          }
+          unsigned wanted[3] = { file.FindField(pressureField), file.FindField(velocityField), 0 };
+          for (unsigned field = 0; field < fields.size(); ++field)
+          {
+            if (fields[field].name == stressTensorField)
+            {
+              hasStress = true;
+              wanted[2] = field;
+            }
+          }
+          const unsigned wantedCount = hasStress ?
+            3 :
+            2;
+          const unsigned valuesPerSite = fieldOffsets.back();
+          const unsigned wantedLengths[3] = { 1, 3, 6 };
+          for (unsigned field = 0; field < wantedCount; ++field)
+          {
+            if (fields[wanted[field]].length != wantedLengths[field])
+            {
+              throw Exception() << "Field " << fields[wanted[field]].name << " of warm start file "
+                  << path << " has " << fields[wanted[field]].length << " values per site, not "
+                  << wantedLengths[field];
+            }
+          }
+
+          coarseVoxelSize = file.GetVoxelSize();
+          coarseOrigin = file.GetOrigin();
+
+          // Only keep the coarse sites around this core's own.
+          coarseMin = util::Vector3D<site_t>::MaxLimit();
+          util::Vector3D<site_t> coarseMax = util::Vector3D<site_t>::MinLimit();
+          for (site_t site = 0; site < latticeData.GetLocalFluidSiteCount(); ++site)
+          {
+            const util::Vector3D<distribn_t> coarsePosition =
+                GetCoarsePosition(unitConverter.ConvertPositionToPhysicalUnits(LatticePosition(latticeData.GetSite(site).GetGlobalSiteCoords())));
+            const util::Vector3D<site_t> corner(std::floor(coarsePosition.x),
+                                                std::floor(coarsePosition.y),
+                                                std::floor(coarsePosition.z));
+            coarseMin.UpdatePointwiseMin(corner);
+            coarseMax.UpdatePointwiseMax(corner + util::Vector3D<site_t>(1));
+          }
+          coarseExtent = coarseMax - coarseMin + util::Vector3D<site_t>(1);
+
+          // Other encodings can be read at just the nearby sites, which only touches the parts of
+          // the file they are in; delta encoded records have to be decoded whole.
+          const bool decodeWhole = file.GetEncoding() == io::formats::extraction::DeltaEncoding;
+          std::vector<float> decoded;
+          std::vector<io::readers::FieldView> views;
+          if (decodeWhole)
+          {
+            file.DecodeRecord(record, decoded);
+          }
+          else
+          {
+            for (unsigned field = 0; field < wantedCount; ++field)
+            {
+              views.push_back(file.GetFieldView(record, wanted[field]));
+            }
+          }
+          const io::readers::PositionView positions = file.GetPositions(record);
+
+          const distribn_t stressToPi = 1.0 / (1.0 - 1.0 / (2.0 * tau));
+          for (uint64_t coarseSite = 0; coarseSite < positions.GetSiteCount(); ++coarseSite)
+          {
+            const util::Vector3D<site_t> position = positions.GetPosition(coarseSite);
+            if (!IsNearby(position))
+            {
+              continue;
+            }
+
+            // The pressure, the velocity and then the stress.
+            distribn_t siteValues[10];
+            unsigned value = 0;
+            for (unsigned field = 0; field < wantedCount; ++field)
+            {
+              for (unsigned component = 0; component < wantedLengths[field]; ++component, ++value)
+              {
+                siteValues[value] = decodeWhole ?
+                  decoded[coarseSite * valuesPerSite + fieldOffsets[wanted[field]] + component] :
+                  views[field].Get(coarseSite, component);
+              }
+            }
+
+            CoarseSite coarse;
+            coarse.density = unitConverter.ConvertPressureToLatticeUnits(siteValues[0]) / Cs2;
+            coarse.velocity =
+                unitConverter.ConvertVelocityToLatticeUnits(util::Vector3D<distribn_t>(siteValues[1],
+                                                                                       siteValues[2],
+                                                                                       siteValues[3]));
+            for (unsigned component = 0; component < 6; ++component)
+            {
+              coarse.piNeq[component] = 0.0;
+            }
+            if (hasStress)
+            {
+              // The upper triangle, row by row, of the full stress in physical units. Keep the
+              // deviatoric part, in the fine lattice's units, as the non-equilibrium momentum
+              // flux it comes from (see Lattice::CalculateStressTensor).
+              const distribn_t* stress = siteValues + 4;
+              const distribn_t meanNormalStress = (stress[0] + stress[3] + stress[5]) / 3.0;
+              for (unsigned component = 0; component < 6; ++component)
+              {
+                const bool diagonal = component == 0 || component == 3 || component == 5;
+                coarse.piNeq[component] = stressToPi
+                    * unitConverter.ConvertStressToLatticeUnits(stress[component] - (diagonal ?
+                      meanNormalStress :
+                      0.0));
+              }
+            }
+            coarseSites[GetKey(position)] = coarse;
+          }
+        }
+
+        /**
+         * @return Whether the file has the stress tensor, so the non-equilibrium parts are set
+         */
+        bool HasStress() const
+        {
+          return hasStress;
+        }
+
+        /**
+         * Set the distributions of this core's sites from the coarse flow.
+         * @param latticeData
+         * @param unitConverter The fine lattice's
+         * @return The number of sites with no coarse flow to set them from
+         */
+        site_t Apply(geometry::LatticeData& latticeData,
+                     const util::UnitConverter& unitConverter) const
+        {
+          site_t missed = 0;
+          for (site_t site = 0; site < latticeData.GetLocalFluidSiteCount(); ++site)
+          {
+            const util::Vector3D<distribn_t> coarsePosition =
+                GetCoarsePosition(unitConverter.ConvertPositionToPhysicalUnits(LatticePosition(latticeData.GetSite(site).GetGlobalSiteCoords())));
+            const util::Vector3D<site_t> corner(std::floor(coarsePosition.x),
+                                                std::floor(coarsePosition.y),
+                                                std::floor(coarsePosition.z));
+            const util::Vector3D<distribn_t> fraction = coarsePosition
+                - util::Vector3D<distribn_t>(corner.x, corner.y, corner.z);
+
+            CoarseSite interpolated;
+            interpolated.density = 0.0;
+            interpolated.velocity = util::Vector3D<distribn_t>::Zero();
+            for (unsigned component = 0; component < 6; ++component)
+            {
+              interpolated.piNeq[component] = 0.0;
+            }
+            distribn_t totalWeight = 0.0;
+            for (unsigned vertex = 0; vertex < 8; ++vertex)
+            {
+              const util::Vector3D<site_t> offset(vertex & 1, (vertex >> 1) & 1, (vertex >> 2) & 1);
+              if (!IsNearby(corner + offset))
+              {
+                continue;
+              }
+              const typename std::map<site_t, CoarseSite>::const_iterator coarse =
+                  coarseSites.find(GetKey(corner + offset));
+              if (coarse == coarseSites.end())
+              {
+                continue;
+              }
+              const distribn_t weight = (offset.x ?
+                fraction.x :
+                1.0 - fraction.x) * (offset.y ?
+                fraction.y :
+                1.0 - fraction.y) * (offset.z ?
+                fraction.z :
+                1.0 - fraction.z);
+              interpolated.density += weight * coarse->second.density;
+              interpolated.velocity += coarse->second.velocity * weight;
+              for (unsigned component = 0; component < 6; ++component)
+              {
+                interpolated.piNeq[component] += weight * coarse->second.piNeq[component];
+              }
+              totalWeight += weight;
+            }
+
+            if (totalWeight <= 0.0)
+            {
+              ++missed;
+              continue;
+            }
+            interpolated.density /= totalWeight;
+            interpolated.velocity /= totalWeight;
+            for (unsigned component = 0; component < 6; ++component)
+            {
+              interpolated.piNeq[component] /= totalWeight;
+            }
+
+            distribn_t f[LatticeType::NUMVECTORS];
+            CalculateDistributions(interpolated.density,
+                                   interpolated.velocity,
+                                   interpolated.piNeq,
+                                   f);
+            latticeData.SetDistributions(site, f);
+          }
+          return missed;
+        }
+
+        /**
+         * The distributions with the given density and velocity and non-equilibrium momentum
+         * flux: f_i = f_i^eq + w_i / (2 cs^4) (c_i c_i - cs^2 I) : Pi^neq.
+         * @param density
+         * @param velocity
+         * @param piNeq The upper triangle, row by row, of Pi^neq
+         * @param f
+         */
+        static void CalculateDistributions(distribn_t density,
+                                           const util::Vector3D<distribn_t>& velocity,
+                                           const distribn_t piNeq[6], distribn_t f[])
+        {
+          LatticeType::CalculateFeq(density,
+                                    density * velocity.x,
+                                    density * velocity.y,
+                                    density * velocity.z,
+                                    f);
+          for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+          {
+            const distribn_t c[3] = { distribn_t(LatticeType::CX[direction]),
+                                      distribn_t(LatticeType::CY[direction]),
+                                      distribn_t(LatticeType::CZ[direction]) };
+            distribn_t contraction = 0.0;
+            unsigned component = 0;
+            for (unsigned row = 0; row < 3; ++row)
+            {
+              for (unsigned column = row; column < 3; ++column, ++component)
+              {
+                const distribn_t q = c[row] * c[column] - (row == column ?
+                  Cs2 :
+                  0.0);
+                // The lower triangle's entries are the same as the upper's.
+                contraction += (row == column ?
+                  1.0 :
+                  2.0) * q * piNeq[component];
+              }
+            }
+            f[direction] += LatticeType::EQMWEIGHTS[direction] * contraction / (2.0 * Cs2 * Cs2);
+          }
+        }
+
+      private:
+        struct CoarseSite
+        {
+            distribn_t density;
+            util::Vector3D<distribn_t> velocity;
+            distribn_t piNeq[6];
+        };
+
+        /**
+         * @param position In physical units
+         * @return The position in the coarse lattice, in coarse voxels
+         */
+        util::Vector3D<distribn_t> GetCoarsePosition(const PhysicalPosition& position) const
+        {
+          return (position - coarseOrigin) / coarseVoxelSize;
+        }
+
+        /**
+         * @param position In the coarse lattice
+         * @return Whether the position is in the box around this core's sites
+         */
+        bool IsNearby(const util::Vector3D<site_t>& position) const
+        {
+          const util::Vector3D<site_t> relative = position - coarseMin;
+          return relative.x >= 0 && relative.y >= 0 && relative.z >= 0
+              && relative.x < coarseExtent.x && relative.y < coarseExtent.y
+              && relative.z < coarseExtent.z;
+        }
+
+        /**
+         * @param position In the coarse lattice, and nearby
+         * @return The index of the position in the box around this core's sites
+         */
+        site_t GetKey(const util::Vector3D<site_t>& position) const
+        {
+          const util::Vector3D<site_t> relative = position - coarseMin;
+          return (relative.x * coarseExtent.y + relative.y) * coarseExtent.z + relative.z;
+        }
+
+        io::readers::ExtractionFile file;
+        bool hasStress;
+        PhysicalDistance coarseVoxelSize;
+        PhysicalPosition coarseOrigin;
+        //! The box of the coarse lattice around this core's sites.
+        util::Vector3D<site_t> coarseMin;
+        util::Vector3D<site_t> coarseExtent;
+        //! The coarse flow in the fine lattice's units, by its key in the box.
+        std::map<site_t, CoarseSite> coarseSites;
+    };
+  }
+}
+
+#endif /* HEMELB_LB_WARMSTART_H */
@@ -0,0 +1,310 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_LB_WORKSTEALINGSCHEDULER_H
+#define HEMELB_LB_WORKSTEALINGSCHEDULER_H
+
+#include <algorithm>
+#include <vector>
+#include "units.h"
+#include "util/utilityFunctions.h"
+#ifdef HEMELB_USE_OPENMP
+#include <omp.h>
+#endif
+
+namespace hemelb
+{
+  namespace lb
+  {
+    /**
+     * A piece of a range of sites of one collision type, to be done by one thread.
+     */
+    struct WorkChunk
+    {
+        unsigned collisionType;
+        site_t firstIndex;
+        site_t siteCount;
+        //! The estimated cost, in site weights.
+        double cost;
+        //! How long the chunk took, once it has been done.
+        double time;
+    };
+
+    /**
+     * Shares the site ranges of a phase of the LBM between the OpenMP threads, when the sites'
+     * costs are too uneven for a static split of each range: wall and iolet sites can cost
+     * many times what bulk sites do, so threads that get them finish last.
+     *
+     * Each range is cut into chunks of a few cache-fulls of sites, each with a cost estimated
+     * from the weight of its collision type. The chunks of all the ranges are dealt to the
+     * threads in order, in contiguous runs of about equal estimated cost, so each thread mostly
+     * walks through memory in order. A thread does its own chunks from the front, and once it
+     * has run out steals chunks from the back of other threads', so the threads finish
+     * together even when the estimates are off. Without HEMELB_USE_OPENMP, the chunks are just
+     * done in order.
+     */
+    class WorkStealingScheduler
+    {
+      public:
+        WorkStealingScheduler() :
+            threadCount(1), stolenCount(0)
+        {
+        }
+
+        ~WorkStealingScheduler()
+        {
+          DestroyQueues();
+        }
+
+        /**
+         * Forget the chunks, ready to add the ranges of another phase.
+         */
+        void Clear()
+        {
+          chunks.clear();
+        }
+
+        /**
+         * Add a range of sites, cut into chunks of up to the given number of sites.
+         *
+         * @param collisionType
+         * @param firstIndex
+         * @param siteCount
+         * @param chunkSites The most sites in a chunk, or 0 not to cut the range, for streamers
+         * that can't have their range split between threads.
+         * @param siteCost The estimated cost of each site.
+         */
+        void AddRange(unsigned collisionType, site_t firstIndex, site_t siteCount,
+                      site_t chunkSites, double siteCost)
+        {
+          if (chunkSites == 0)
+          {
+            chunkSites = siteCount;
+          }
+          const site_t end = firstIndex + siteCount;
+          for (site_t chunkFirst = firstIndex; chunkFirst < end; chunkFirst += chunkSites)
+          {
+            WorkChunk chunk;
+            chunk.collisionType = collisionType;
+            chunk.firstIndex = chunkFirst;
+            chunk.siteCount = std::min(chunkSites, end - chunkFirst);
+            chunk.cost = siteCost * chunk.siteCount;
+            chunk.time = 0.0;
+            chunks.push_back(chunk);
+          }
+        }
+
+        /**
+         * Do all the chunks, timing each, with the calling thread and any OpenMP threads.
+         *
+         * @param worker Called as worker(chunk) for each chunk, on whichever thread does it,
+         * then as worker.AfterMasterChunk() on the master thread after each of its own chunks.
+         */
+        template<typename Worker>
+        void Run(Worker& worker)
+        {
+#ifdef HEMELB_USE_OPENMP
+          DealChunks(omp_get_max_threads());
+          stolenCount = 0;
+#pragma omp parallel
+          {
+#pragma omp master
+            threadCount = omp_get_num_threads();
+            RunThread(worker, omp_get_thread_num());
+          }
+#else
+          threadCount = 1;
+          for (std::vector<WorkChunk>::iterator chunk = chunks.begin(); chunk != chunks.end(); ++chunk)
+          {
+            DoChunk(worker, *chunk);
+            worker.AfterMasterChunk();
+          }
+#endif
+        }
+
+        /**
+         * @return The chunks, with the time each took if they have been run.
+         */
+        const std::vector<WorkChunk>& GetChunks() const
+        {
+          return chunks;
+        }
+
+        /**
+         * @return The number of threads that did the chunks in the last Run.
+         */
+        int GetThreadCount() const
+        {
+          return threadCount;
+        }
+
+        /**
+         * @return The number of chunks stolen from another thread in the last Run.
+         */
+        unsigned GetStolenCount() const
+        {
+          return stolenCount;
+        }
+
+      private:
+        WorkStealingScheduler(const WorkStealingScheduler&);
+        WorkStealingScheduler& operator=(const WorkStealingScheduler&);
+
+        template<typename Worker>
+        void DoChunk(Worker& worker, WorkChunk& chunk)
+        {
+          const double start = Now();
+          worker(chunk);
+          chunk.time = Now() - start;
+        }
+
+        static double Now()
+        {
+#ifdef HEMELB_USE_OPENMP
+          // Not util::myClock, which is MPI_Wtime: under MPI_THREAD_FUNNELED only the master
+          // thread may call MPI.
+          return omp_get_wtime();
+#else
+          return util::myClock();
+#endif
+        }
+
+#ifdef HEMELB_USE_OPENMP
+        /**
+         * A thread's chunks, [head, tail) of all the chunks, padded so that the threads don't
+         * share a cache line.
+         */
+        struct ThreadQueue
+        {
+            site_t head;
+            site_t tail;
+            omp_lock_t lock;
+            char padding[64];
+        };
+
+        /**
+         * Give each queue a contiguous run of the chunks of about equal estimated cost.
+         */
+        void DealChunks(int queueCount)
+        {
+          if (int(queues.size()) != queueCount)
+          {
+            DestroyQueues();
+            queues.resize(queueCount);
+            for (std::vector<ThreadQueue>::iterator queue = queues.begin(); queue != queues.end();
+                ++queue)
+            {
+              omp_init_lock(&queue->lock);
+            }
+          }
+
+          double totalCost = 0.0;
+          for (std::vector<WorkChunk>::const_iterator chunk = chunks.begin(); chunk != chunks.end();
+              ++chunk)
+          {
+            totalCost += chunk->cost;
+          }
+
+          site_t next = 0;
+          double costSoFar = 0.0;
+          for (int queue = 0; queue < queueCount; ++queue)
+          {
+            const double costTarget = totalCost * (queue + 1) / queueCount;
+            queues[queue].head = next;
+            while (next < site_t(chunks.size())
+                && (queue == queueCount - 1 || costSoFar + chunks[next].cost / 2.0 <= costTarget))
+            {
+              costSoFar += chunks[next].cost;
+              ++next;
+            }
+            queues[queue].tail = next;
+          }
+        }
+
+        template<typename Worker>
+        void RunThread(Worker& worker, int thread)
+        {
+          const int queueCount = int(queues.size());
+          site_t chunk;
+          // A thread beyond the queues, if OpenMP gave us more than it said, only steals.
+          while (thread < queueCount && TakeFront(queues[thread], chunk))
+          {
+            DoChunk(worker, chunks[chunk]);
+            if (thread == 0)
+            {
+              worker.AfterMasterChunk();
+            }
+          }
+
+          bool stole = true;
+          while (stole)
+          {
+            stole = false;
+            for (int victim = 1; victim <= queueCount; ++victim)
+            {
+              if (TakeBack(queues[ (thread + victim) % queueCount], chunk))
+              {
+#pragma omp atomic
+                ++stolenCount;
+                DoChunk(worker, chunks[chunk]);
+                if (thread == 0)
+                {
+                  worker.AfterMasterChunk();
+                }
+                stole = true;
+                break;
+              }
+            }
+          }
+        }
+
+        static bool TakeFront(ThreadQueue& queue, site_t& chunk)
+        {
+          omp_set_lock(&queue.lock);
+          const bool any = queue.head < queue.tail;
+          if (any)
+          {
+            chunk = queue.head++;
+          }
+          omp_unset_lock(&queue.lock);
+          return any;
+        }
+
+        static bool TakeBack(ThreadQueue& queue, site_t& chunk)
+        {
+          omp_set_lock(&queue.lock);
+          const bool any = queue.head < queue.tail;
+          if (any)
+          {
+            chunk = --queue.tail;
+          }
+          omp_unset_lock(&queue.lock);
+          return any;
+        }
+
+        void DestroyQueues()
+        {
+          for (std::vector<ThreadQueue>::iterator queue = queues.begin(); queue != queues.end(); ++queue)
+          {
+            omp_destroy_lock(&queue->lock);
+          }
+          queues.clear();
+        }
+
+        std::vector<ThreadQueue> queues;
+#else
+        void DestroyQueues()
+        {
+        }
+#endif
+
+        std::vector<WorkChunk> chunks;
+        int threadCount;
+        unsigned stolenCount;
+    };
+  }
+}
+
+#endif /* HEMELB_LB_WORKSTEALINGSCHEDULER_H */
@@ -24,7 +24,8 @@ namespace hemelb
                                      const net::MpiCommunicator& comms,
                                      const util::UnitConverter& units) :
         net::IteratedAction(), ioletType(ioletType), totalIoletCount(incoming_iolets.size()), localIoletCount(0),
-            state(simulationState), unitConverter(units), bcComms(comms)
+            state(simulationState), unitConverter(units), bcComms(comms),
+            commsInProgress(false)
       {
         std::vector<int> *procsList = new std::vector<int>[totalIoletCount];
 
@@ -34,13 +35,19 @@ namespace hemelb
           // First create a copy of all iolets
           iolets::InOutLet* iolet = (incoming_iolets[ioletIndex])->Clone();
 
-          iolet->Initialise(&unitConverter);
+          iolet->Initialise(&unitConverter, bcComms);
 
           iolets.push_back(iolet);
 
           bool isIOletOnThisProc = IsIOletOnThisProc(ioletType, latticeData, ioletIndex);
           hemelb::log::Logger::Log<hemelb::log::Debug, hemelb::log::OnePerCore>("BOUNDARYVALUES.CC - isioletonthisproc? : %d", isIOletOnThisProc);
-          procsList[ioletIndex] = GatherProcList(isIOletOnThisProc);
+
+          // Iolets that every process can evaluate itself need neither the process list nor comms.
+          const bool needsComms = !iolet->IsDensityLocallyComputable();
+          if (needsComms)
+          {
+            procsList[ioletIndex] = GatherProcList(isIOletOnThisProc);
+          }
 
           // With information on whether a proc has an IOlet and the list of procs for each IOlte
           // on the BC task we can create the comms
@@ -51,9 +58,10 @@ namespace hemelb
 //            hemelb::log::Logger::Log<hemelb::log::Warning, hemelb::log::OnePerCore>("BOUNDARYVALUES.H - ioletIndex: %d", ioletIndex);
 
 //            if (iolet->IsCommsRequired()) //DEREK: POTENTIAL MULTISCALE ISSUE (this if-statement)
-//            {
+            if (needsComms)
+            {
               iolet->SetComms(new BoundaryComms(state, procsList[ioletIndex], bcComms, isIOletOnThisProc));
-//            }
+            }
           }
         }
 
@@ -127,40 +135,75 @@ namespace hemelb
 
       void BoundaryValues::RequestComms()
       {
-        for (int i = 0; i < localIoletCount; i++)
+        // Every process holds all the iolets, so all of them agree on which need comms and
+        // take part in the broadcast.
+        communicatedIolets.clear();
+        unsigned valueCount = 0;
+        for (int i = 0; i < totalIoletCount; i++)
         {
-          HandleComms(GetLocalIolet(i));
+          if (iolets[i]->IsCommsRequired())
+          {
+            communicatedIolets.push_back(iolets[i]);
+            valueCount += iolets[i]->GetCommsValueCount();
+          }
         }
-      }
 
-      void BoundaryValues::HandleComms(iolets::InOutLet* iolet)
-      {
+        if (valueCount == 0)
+        {
+          return;
+        }
 
-        if (iolet->IsCommsRequired())
+        commsBuffer.resize(valueCount);
+        if (bcComms.IsCurrentProcTheBCProc())
         {
-          iolet->DoComms(bcComms, state->GetTimeStep());
+          distribn_t* values = &commsBuffer[0];
+          for (std::vector<iolets::InOutLet*>::const_iterator iolet = communicatedIolets.begin();
+              iolet != communicatedIolets.end(); ++iolet)
+          {
+            (*iolet)->PackCommsValues(values);
+            values += (*iolet)->GetCommsValueCount();
+          }
         }
 
+        HEMELB_MPI_CALL(
+            MPI_Ibcast, (
+                &commsBuffer[0],
+                valueCount,
+                net::MpiDataType<distribn_t>(),
+                bcComms.GetBCProcRank(),
+                bcComms,
+                &commsRequest
+            ));
+        commsInProgress = true;
       }
 
       void BoundaryValues::EndIteration()
       {
-        for (int i = 0; i < localIoletCount; i++)
-        {
-          if (GetLocalIolet(i)->IsCommsRequired())
-          {
-            GetLocalIolet(i)->GetComms()->FinishSend();
-          }
-        }
+        // Don't move on to the next step until the broadcast is done, so that the buffer
+        // isn't overwritten.
+        FinishReceive();
       }
 
       void BoundaryValues::FinishReceive()
       {
-        for (int i = 0; i < localIoletCount; i++)
+        if (!commsInProgress)
         {
-          if (GetLocalIolet(i)->IsCommsRequired())
+          return;
+        }
+
+        HEMELB_MPI_CALL(
+            MPI_Wait, (&commsRequest, MPI_STATUS_IGNORE)
+        );
+        commsInProgress = false;
+
+        if (!bcComms.IsCurrentProcTheBCProc())
+        {
+          const distribn_t* values = &commsBuffer[0];
+          for (std::vector<iolets::InOutLet*>::const_iterator iolet = communicatedIolets.begin();
+              iolet != communicatedIolets.end(); ++iolet)
           {
-            GetLocalIolet(i)->GetComms()->Wait();
+            (*iolet)->UnpackCommsValues(values);
+            values += (*iolet)->GetCommsValueCount();
           }
         }
       }
@@ -170,12 +213,8 @@ namespace hemelb
         for (int i = 0; i < localIoletCount; i++)
         {
           GetLocalIolet(i)->Reset(*state);
-          if (GetLocalIolet(i)->IsCommsRequired())
-          {
-            GetLocalIolet(i)->GetComms()->WaitAllComms();
-
-          }
         }
+        FinishReceive();
       }
 
       // This assumes the program has already waited for comms to finish before
@@ -51,6 +51,17 @@ namespace hemelb
           {
             return localIoletCount;
           }
+          /**
+           * All the iolets of this type, by the id their sites have, whether local or not.
+           */
+          unsigned int GetIoletCount() const
+          {
+            return totalIoletCount;
+          }
+          iolets::InOutLet* GetIolet(unsigned int index)
+          {
+            return iolets[index];
+          }
           inline unsigned int GetTimeStep() const
           {
             return state->GetTimeStep();
@@ -63,7 +74,6 @@ namespace hemelb
         private:
           bool IsIOletOnThisProc(geometry::SiteType ioletType, geometry::LatticeData* latticeData, int boundaryId);
           std::vector<int> GatherProcList(bool hasBoundary);
-          void HandleComms(iolets::InOutLet* iolet);
           geometry::SiteType ioletType;
           int totalIoletCount;
           // Number of IOlets and vector of their indices for communication purposes
@@ -75,6 +85,13 @@ namespace hemelb
           SimulationState* state;
           const util::UnitConverter& unitConverter;
           BoundaryCommunicator bcComms;
+
+          // The values of all iolets needing comms this step, shared from the BC proc with a
+          // single non-blocking broadcast (see RequestComms / FinishReceive).
+          std::vector<iolets::InOutLet*> communicatedIolets;
+          std::vector<distribn_t> commsBuffer;
+          MPI_Request commsRequest;
+          bool commsInProgress;
       }
       ;
     }
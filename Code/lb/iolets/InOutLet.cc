@@ -11,11 +11,6 @@ namespace hemelb
   {
     namespace iolets
     {
-      void InOutLet::DoComms(const BoundaryCommunicator& bcComms, const LatticeTimeStep timeStep)
-      {
-        // pass
-      }
-
       namespace
       {
         unsigned SmallestMagnitudeComponent(const LatticeVector r)
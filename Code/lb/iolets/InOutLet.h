@@ -10,6 +10,7 @@
 #include "util/Vector3D.h"
 #include "util/UnitConverter.h"
 #include "lb/SimulationState.h"
+#include "net/MpiCommunicator.h"
 
 namespace hemelb
 {
@@ -89,6 +90,16 @@ namespace hemelb
           {
             return false;
           }
+          /***
+           * Whether every process can evaluate this iolet's density from the time step alone
+           * (e.g. cosine or file iolets). Such iolets get no BoundaryComms and are never
+           * communicated; iolets whose values arrive from elsewhere must override this.
+           * @return true if the density is a function of time only.
+           */
+          virtual bool IsDensityLocallyComputable() const
+          {
+            return true;
+          }
           void SetComms(BoundaryComms * boundaryComms)
           {
             comms = boundaryComms;
@@ -98,10 +109,28 @@ namespace hemelb
             return comms;
           }
           /***
-           * Carry out communication necessary
-           * @param isIoProcess Is the process the master process?
+           * The number of values this iolet shares from the BC proc when IsCommsRequired() is true.
+           * BoundaryValues packs the values of all such iolets into one buffer per step.
+           * @return the number of values written by PackCommsValues.
+           */
+          virtual unsigned GetCommsValueCount() const
+          {
+            return 0;
+          }
+          /***
+           * Write the values to share into the buffer (called on the BC proc only).
+           * @param values Space for GetCommsValueCount() values.
+           */
+          virtual void PackCommsValues(distribn_t* values) const
+          {
+          }
+          /***
+           * Read the shared values back (called on every process except the BC proc).
+           * @param values The GetCommsValueCount() values written by PackCommsValues.
            */
-          virtual void DoComms(const BoundaryCommunicator& bcComms, const LatticeTimeStep timeStep);
+          virtual void UnpackCommsValues(const distribn_t* values)
+          {
+          }
 
           /***
            * Set up the Iolet.
@@ -111,6 +140,18 @@ namespace hemelb
           {
           }
 
+          /***
+           * Set up the Iolet, with the processes of the simulation to share any files it reads
+           * between.
+           * @param units a UnitConverter instance.
+           * @param comms
+           */
+          virtual void Initialise(const util::UnitConverter* unitConverter,
+                                  const net::MpiCommunicator& comms)
+          {
+            Initialise(unitConverter);
+          }
+
           /***
            * Get the minimum density, in lattice units
            * @return minimum density, in lattice units
@@ -5,10 +5,13 @@
 // license in the file LICENSE.
 
 #include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <sstream>
 
 #include "lb/iolets/InOutLetFile.h"
 #include "log/Logger.h"
+#include "net/MpiFile.h"
 #include "util/fileutils.h"
 #include "util/utilityFunctions.h"
 #include "util/utilityStructs.h"
@@ -41,11 +44,18 @@ namespace hemelb
       {
         units = unitConverter;
       }
+
+      void InOutLetFile::Initialise(const util::UnitConverter* unitConverter,
+                                    const net::MpiCommunicator& comms)
+      {
+        Initialise(unitConverter);
+        pressureFileContents = net::MpiFile::ReadOnOneRank(comms, pressureFilePath);
+      }
       // This reads in a file and interpolates between points to generate a cycle
       // IMPORTANT: to allow reading in data taken at irregular intervals the user
       // needs to make sure that the last point in the file coincides with the first
       // point of a new cycle for a continuous trace.
-      void InOutLetFile::CalculateTable(LatticeTimeStep totalTimeSteps, PhysicalTime timeStepLength)
+      void InOutLetFile::CalculateTable(PhysicalTime timeStepLength)
       {
         // First read in values from file
         // Used to be complex code here to keep a vector unique, but this is just achieved by using a map.
@@ -53,8 +63,15 @@ namespace hemelb
 
         double timeTemp, valueTemp;
 
-        util::check_file(pressureFilePath.c_str());
-        std::ifstream datafile(pressureFilePath.c_str());
+        if (pressureFileContents.empty())
+        {
+          util::check_file(pressureFilePath.c_str());
+          std::ifstream datafile(pressureFilePath.c_str());
+          std::ostringstream contents;
+          contents << datafile.rdbuf();
+          pressureFileContents = contents.str();
+        }
+        std::istringstream datafile(pressureFileContents);
         log::Logger::Log<log::Debug, log::OnePerCore>("Reading iolet values from file:");
         while (datafile.good())
         {
@@ -62,8 +79,6 @@ namespace hemelb
           log::Logger::Log<log::Trace, log::OnePerCore>("Time: %f Value: %f", timeTemp, valueTemp);
           timeValuePairs[timeTemp] = valueTemp;
         }
-
-        datafile.close();
         // the default iterator for maps traverses in key order, so no sort is needed.
 
         std::vector<double> times(0);
@@ -76,23 +91,6 @@ namespace hemelb
         for (std::map<PhysicalTime, PhysicalPressure>::iterator entry = timeValuePairs.begin(); entry
             != timeValuePairs.end(); entry++)
         {
-          /* If the time value stretches beyond the end of the simulation, then insert an interpolated end value and exit the loop. */
-          if(entry->first > totalTimeSteps*timeStepLength) {
-
-            PhysicalTime time_diff = totalTimeSteps*timeStepLength - times.back();
-
-            PhysicalTime time_diff_ratio = time_diff / (entry->first - times.back());
-            PhysicalPressure pres_diff = entry->second - values.back();
-
-            PhysicalSpeed final_pressure = values.back() + time_diff_ratio * pres_diff;
-
-            times.push_back(totalTimeSteps*timeStepLength);
-            pMin = util::NumericalFunctions::min(pMin, final_pressure);
-            pMax = util::NumericalFunctions::max(pMax, final_pressure);
-            values.push_back(final_pressure);
-            break;
-          }
-
           pMin = util::NumericalFunctions::min(pMin, entry->second);
           pMax = util::NumericalFunctions::max(pMax, entry->second);
           times.push_back(entry->first);
@@ -105,17 +103,14 @@ namespace hemelb
         if (values.back() != values.front())
           throw Exception() << "Last point's value does not match the first point's value in " <<pressureFilePath;
 
-        /* If the time values in the input file end BEFORE the planned end of the simulation, then loop the profile afterwards (using %TimeStepsInInletPressureProfile). */
-        int TimeStepsInInletPressureProfile = times.back() / timeStepLength;
-        //throw Exception() << "Finding Time steps: " << times.back() << " " << timeStepLength << " " << TimeStepsInInletPressureProfile;
-
-        // extend the table to one past the total time steps, so that the table is valid in the end-state, where the zero indexed time step is equal to the limit.
-        densityTable.resize(totalTimeSteps + 1);
-        // Now convert these vectors into arrays using linear interpolation
-        for (unsigned int timeStep = 0; timeStep <= totalTimeSteps; timeStep++)
+        // The trace is one cycle, repeated for as long as the simulation runs, so the table need
+        // only hold one cycle, however long the run.
+        const LatticeTimeStep stepsPerCycle = CalculateStepsPerCycle(times, timeStepLength, pressureFilePath);
+        densityTable.resize(stepsPerCycle);
+        for (LatticeTimeStep timeStep = 0; timeStep < stepsPerCycle; timeStep++)
         {
           double point = times.front() + (static_cast<double> (timeStep)
-              / static_cast<double> (totalTimeSteps)) * (times.back() - times.front());
+              / static_cast<double> (stepsPerCycle)) * (times.back() - times.front());
 
           double pressure = util::NumericalFunctions::LinearInterpolate(times, values, point);
 
@@ -123,6 +118,21 @@ namespace hemelb
         }
       }
 
+      LatticeTimeStep CalculateStepsPerCycle(const std::vector<PhysicalTime>& times,
+                                             PhysicalTime timeStepLength, const std::string& path)
+      {
+        const PhysicalTime period = times.back() - times.front();
+        const LatticeTimeStep stepsPerCycle =
+            std::max<LatticeTimeStep>(1, LatticeTimeStep(period / timeStepLength + 0.5));
+        if (std::abs(stepsPerCycle * timeStepLength - period) > 1e-6 * period)
+        {
+          log::Logger::Log<log::Warning, log::OnePerCore>("The cycle of %s is not a whole number of time steps, so it will repeat every %lu steps",
+                                                          path.c_str(),
+                                                          (unsigned long) stepsPerCycle);
+        }
+        return stepsPerCycle;
+      }
+
     }
   }
 }
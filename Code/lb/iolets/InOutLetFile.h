@@ -33,7 +33,7 @@ namespace hemelb
           virtual InOutLet* Clone() const;
           virtual void Reset(SimulationState &state)
           {
-            CalculateTable(state.GetTotalTimeSteps(), state.GetTimeStepLength());
+            CalculateTable(state.GetTimeStepLength());
           }
 
           const std::string& GetFilePath()
@@ -55,11 +55,21 @@ namespace hemelb
           }
           LatticeDensity GetDensity(LatticeTimeStep timeStep) const
           {
-            return densityTable[timeStep];
+            return densityTable[timeStep % densityTable.size()];
           }
           virtual void Initialise(const util::UnitConverter* unitConverter);
+          /**
+           * Also read the file, on one process of comms only.
+           * @param unitConverter
+           * @param comms
+           */
+          virtual void Initialise(const util::UnitConverter* unitConverter,
+                                  const net::MpiCommunicator& comms);
         private:
-          void CalculateTable(LatticeTimeStep totalTimeSteps, PhysicalTime timeStepLength);
+          void CalculateTable(PhysicalTime timeStepLength);
+          //! The file's contents, if it has been read in Initialise, or else empty.
+          std::string pressureFileContents;
+          //! The density at each time step of one cycle of the trace.
           std::vector<LatticeDensity> densityTable;
           LatticeDensity densityMin;
           LatticeDensity densityMax;
@@ -67,6 +77,18 @@ namespace hemelb
           const util::UnitConverter* units;
       };
 
+      /**
+       * The number of time steps in one cycle of a trace read from a file, which runs from the
+       * first time to the last. A cycle that isn't a whole number of time steps is rounded to
+       * the nearest, with a warning.
+       * @param times The times of the trace, in order.
+       * @param timeStepLength
+       * @param path The file, for the warning.
+       * @return At least one.
+       */
+      LatticeTimeStep CalculateStepsPerCycle(const std::vector<PhysicalTime>& times,
+                                             PhysicalTime timeStepLength, const std::string& path);
+
     }
   }
 }
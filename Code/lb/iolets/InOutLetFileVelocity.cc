@@ -4,13 +4,17 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 #include "lb/iolets/InOutLetFileVelocity.h"
+#include "lb/iolets/InOutLetFile.h"
 #include <algorithm>
 #include <fstream>
+#include <sstream>
 #include "log/Logger.h"
 #include "util/fileutils.h"
 #include "util/utilityFunctions.h"
 #include "util/utilityStructs.h"
 #include "configuration/SimConfig.h"
+#include "net/MpiCommunicator.h"
+#include "net/MpiFile.h"
 #include <cmath>
 #include <algorithm>
 
@@ -31,7 +35,7 @@ namespace hemelb
         return copy;
       }
 
-      void InOutLetFileVelocity::CalculateTable(LatticeTimeStep totalTimeSteps, PhysicalTime timeStepLength)
+      void InOutLetFileVelocity::CalculateTable(PhysicalTime timeStepLength)
       {
         // First read in values from file
         // Used to be complex code here to keep a vector unique, but this is just achieved by using a map.
@@ -39,8 +43,15 @@ namespace hemelb
 
         double timeTemp, valueTemp;
 
-        util::check_file(velocityFilePath.c_str());
-        std::ifstream datafile(velocityFilePath.c_str());
+        if (velocityFileContents.empty())
+        {
+          util::check_file(velocityFilePath.c_str());
+          std::ifstream datafile(velocityFilePath.c_str());
+          std::ostringstream contents;
+          contents << datafile.rdbuf();
+          velocityFileContents = contents.str();
+        }
+        std::istringstream datafile(velocityFileContents);
         log::Logger::Log<log::Debug, log::OnePerCore>("Reading iolet values from file:");
         while (datafile.good())
         {
@@ -48,58 +59,32 @@ namespace hemelb
           log::Logger::Log<log::Trace, log::OnePerCore>("Time: %f Value: %f", timeTemp, valueTemp);
           timeValuePairs[timeTemp] = valueTemp;
         }
-
-        datafile.close();
         // the default iterator for maps traverses in key order, so no sort is needed.
 
         std::vector<PhysicalTime> times(0);
         std::vector<PhysicalSpeed> values(0);
 
         // Must convert into vectors since LinearInterpolate works on a pair of vectors
-        // Determine min and max pressure on the way
-//        PhysicalPressure pMin = timeValuePairs.begin()->second;
-//        PhysicalPressure pMax = timeValuePairs.begin()->second;
         for (std::map<PhysicalTime, PhysicalSpeed>::iterator entry = timeValuePairs.begin();
             entry != timeValuePairs.end(); entry++)
         {
-
-          /* If the time value in the input file stretches BEYOND the end of the simulation, then insert an interpolated end value and exit the loop. */
-          if(entry->first > totalTimeSteps*timeStepLength) {
-  
-            PhysicalTime time_diff = totalTimeSteps*timeStepLength - times.back();
-
-            PhysicalTime time_diff_ratio = time_diff / (entry->first - times.back());
-            PhysicalSpeed vel_diff = entry->second - values.back();
-
-            PhysicalSpeed final_velocity = values.back() + time_diff_ratio * vel_diff;
-
-            times.push_back(totalTimeSteps*timeStepLength);
-            values.push_back(final_velocity);
-            break;
-          }
-
           times.push_back(entry->first);
           values.push_back(entry->second);
         }
-//        densityMin = units->ConvertPressureToLatticeUnits(pMin) / Cs2;
-//        densityMax = units->ConvertPressureToLatticeUnits(pMax) / Cs2;
-
-        /* If the time values in the input file end BEFORE the planned end of the simulation, then loop the profile afterwards (using %TimeStepsInInletVelocityProfile). */
-        int TimeStepsInInletVelocityProfile = times.back() / timeStepLength;
 
         // Check if last point's value matches the first
         if (values.back() != values.front())
           throw Exception() << "Last point's value does not match the first point's value in "
               << velocityFilePath;
 
-        // extend the table to one past the total time steps, so that the table is valid in the end-state, where the zero indexed time step is equal to the limit.
-        velocityTable.resize(totalTimeSteps + 1);
-        // Now convert these vectors into arrays using linear interpolation
-        for (unsigned int timeStep = 0; timeStep <= totalTimeSteps; timeStep++)
+        // The trace is one cycle, repeated for as long as the simulation runs, so the table need
+        // only hold one cycle, however long the run.
+        const LatticeTimeStep stepsPerCycle = CalculateStepsPerCycle(times, timeStepLength, velocityFilePath);
+        velocityTable.resize(stepsPerCycle);
+        for (LatticeTimeStep timeStep = 0; timeStep < stepsPerCycle; timeStep++)
         {
-          // The "% TimeStepsInInletVelocityProfile" here is to prevent profile stretching (it will loop instead).
           double point = times.front()
-              + (static_cast<double>(timeStep % TimeStepsInInletVelocityProfile) / static_cast<double>(totalTimeSteps))
+              + (static_cast<double>(timeStep) / static_cast<double>(stepsPerCycle))
                   * (times.back() - times.front());
 
           PhysicalSpeed vel = util::NumericalFunctions::LinearInterpolate(times, values, point);
@@ -123,7 +108,7 @@ namespace hemelb
           assert(rSqOverASq <= 1.0);
 
           // Get the max velocity
-          LatticeSpeed max = velocityTable[t];
+          LatticeSpeed max = velocityTable[t % velocityTable.size()];
 
           // Brackets to ensure that the scalar multiplies are done before vector * scalar.
           return normal * (max * (1. - rSqOverASq));
@@ -153,10 +138,7 @@ namespace hemelb
 
           int xyz_directions[3] = { 1, 1, 1 };
 
-          std::vector<int> xyz;
-          xyz.push_back(0);
-          xyz.push_back(0);
-          xyz.push_back(0);
+          int xyz[3] = { 0, 0, 0 };
 
           double xyz_residual[3] = {0.0, 0.0, 0.0};
           /* The residual values increase by the normal values at every time step. When they hit >1.0, then
@@ -202,9 +184,10 @@ namespace hemelb
 
           while (iterations < 3)
           {
-            if (weights_table.count(xyz) > 0)
+            double weight;
+            if (FindWeight(xyz, weight))
             {
-              v_tot = normal * weights_table.at(xyz) * velocityTable[t];
+              v_tot = normal * weight * velocityTable[t % velocityTable.size()];
               //log::Logger::Log<log::Warning, log::OnePerCore>("%f %f %f %f",
               //                                                              x.x,
               //                                                              x.y,
@@ -275,16 +258,23 @@ namespace hemelb
           /* Lists the sites which should be in the wall, outside of the main inlet.
            * If you are unsure, you can increase the log level of this, run HemeLb
            * for 1 time step, and plot these points out. */
-          log::Logger::Log<log::Trace, log::OnePerCore>("%f %f %f", x.x, x.y, x.z);
+          HEMELB_LOG(Trace, OnePerCore, "%f %f %f", x.x, x.y, x.z);
           return normal * 0.0;
         }
 
       }
 
       void InOutLetFileVelocity::Initialise(const util::UnitConverter* unitConverter)
+      {
+        Initialise(unitConverter, net::MpiCommunicator::World());
+      }
+
+      void InOutLetFileVelocity::Initialise(const util::UnitConverter* unitConverter,
+                                            const net::MpiCommunicator& comms)
       {
         log::Logger::Log<log::Warning, log::OnePerCore>("Initializing vInlet.");
         units = unitConverter;
+        velocityFileContents = net::MpiFile::ReadOnOneRank(comms, velocityFilePath);
 
         useWeightsFromFile = false;
         #ifdef HEMELB_USE_VELOCITY_WEIGHTS_FILE
@@ -293,41 +283,77 @@ namespace hemelb
 
         if(useWeightsFromFile) {
           //if the new velocity approximation is enabled, then we want to create a lookup table here.
-          const std::string in_name = velocityFilePath + ".weights.txt";
-          util::check_file(in_name.c_str());
+          ReadWeightsFile(comms);
+        }
+      }
 
+      bool InOutLetFileVelocity::FindWeight(const int xyz[3], double& weight) const
+      {
+        WeightsTable::const_iterator entry =
+            weights_table.find(util::Vector3D<int>(xyz[0], xyz[1], xyz[2]));
+        if (entry == weights_table.end())
+        {
+          return false;
+        }
+        weight = entry->second;
+        return true;
+      }
+
+      void InOutLetFileVelocity::ReadWeightsFile(const net::MpiCommunicator& comms)
+      {
+        const std::string in_name = velocityFilePath + ".weights.txt";
+        util::check_file(in_name.c_str());
+
+        // Only one rank parses the (possibly large) text file; the others get the values from it.
+        const int readingRank = 0;
+
+        std::vector<int> coordinates;
+        std::vector<double> weights;
+        if (comms.Rank() == readingRank)
+        {
           /* Load and read file. */
           std::fstream myfile;
           myfile.open(in_name.c_str(), std::ios_base::in);
-          log::Logger::Log<log::Warning, log::OnePerCore>("Loading weights file: %s",
-                                                        in_name.c_str());
+          log::Logger::Log<log::Warning, log::Singleton>("Loading weights file: %s", in_name.c_str());
 
-          std::string input_line;
           /* input files are in ASCII, in format:
            *
            * coord_x coord_y coord_z weights_value
            *
            * */
-          while (myfile.good()) //(std::getline(myfile, input_line))
+          int x, y, z;
+          double v;
+          while (myfile >> x >> y >> z >> v)
           {
-            int x, y, z;
-            double v;
-            myfile >> x >> y >> z >> v;
-
-            std::vector<int> xyz;
-            xyz.push_back(x);
-            xyz.push_back(y);
-            xyz.push_back(z);
-            weights_table[xyz] = v;
-
-            log::Logger::Log<log::Trace, log::OnePerCore>("%lld %lld %lld %f",
-            x,
-            y,
-            z,
-            weights_table[xyz]);
+            coordinates.push_back(x);
+            coordinates.push_back(y);
+            coordinates.push_back(z);
+            weights.push_back(v);
+
+            log::Logger::Log<log::Trace, log::OnePerCore>("%d %d %d %f", x, y, z, v);
           }
           myfile.close();
         }
+
+        unsigned long weightCount = weights.size();
+        comms.Broadcast(weightCount, readingRank);
+        coordinates.resize(3 * weightCount);
+        weights.resize(weightCount);
+        if (weightCount > 0)
+        {
+          comms.Broadcast(coordinates, readingRank);
+          comms.Broadcast(weights, readingRank);
+        }
+
+        // Where the file lists the same point more than once, the last value wins.
+        weights_table.clear();
+        weights_table.reserve(weightCount);
+        for (unsigned long index = 0; index < weightCount; ++index)
+        {
+          weights_table[util::Vector3D<int>(coordinates[3 * index],
+                                            coordinates[3 * index + 1],
+                                            coordinates[3 * index + 2])] = weights[index];
+        }
       }
 
     }
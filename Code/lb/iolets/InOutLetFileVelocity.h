@@ -7,6 +7,7 @@
 #define HEMELB_LB_IOLETS_INOUTLETFILEVELOCITY_H
 
 #include "lb/iolets/InOutLetVelocity.h"
+#include "util/HashMap.h"
 
 namespace hemelb
 {
@@ -23,7 +24,7 @@ namespace hemelb
           InOutLet* Clone() const;
           void Reset(SimulationState &state)
           {
-            CalculateTable(state.GetTotalTimeSteps(), state.GetTimeStepLength());
+            CalculateTable(state.GetTimeStepLength());
           }
 
           const std::string& GetFilePath()
@@ -40,17 +41,37 @@ namespace hemelb
                                                                   const LatticeTimeStep t) const;*/
 
           void Initialise(const util::UnitConverter* unitConverter);
+          void Initialise(const util::UnitConverter* unitConverter,
+                          const net::MpiCommunicator& comms);
 
           bool useWeightsFromFile;
 
         private:
           std::string velocityFilePath;
+          //! The velocity file's contents, if it has been read in Initialise, or else empty.
+          std::string velocityFileContents;
           std::string velocityWeightsFilePath;
-          void CalculateTable(LatticeTimeStep totalTimeSteps, PhysicalTime timeStepLength);
+          void CalculateTable(PhysicalTime timeStepLength);
+          //! The speed on the centreline at each time step of one cycle of the trace.
           std::vector<LatticeSpeed> velocityTable;
           const util::UnitConverter* units;
 
-          std::map<std::vector<int>, double> weights_table;
+          /**
+           * The velocity weights read from the weights file, by grid coordinates.
+           */
+          typedef util::HashMap<util::Vector3D<int>, double> WeightsTable;
+          WeightsTable weights_table;
+
+          /**
+           * Look up the weight at the given grid coordinates.
+           * @return false if there is no weight for those coordinates.
+           */
+          bool FindWeight(const int xyz[3], double& weight) const;
+
+          /**
+           * Read the weights file on one rank, share it with the others and build weights_table.
+           */
+          void ReadWeightsFile(const net::MpiCommunicator& comms);
 
           //double calcVTot(std::vector<double> v);
 
@@ -24,7 +24,8 @@ namespace hemelb
             pressure(this, multiscale_constants::HEMELB_MULTISCALE_REFERENCE_PRESSURE),
             minPressure(this, multiscale_constants::HEMELB_MULTISCALE_REFERENCE_PRESSURE),
             maxPressure(this, multiscale_constants::HEMELB_MULTISCALE_REFERENCE_PRESSURE),
-            velocity(this, multiscale_constants::HEMELB_MULTISCALE_REFERENCE_VELOCITY)
+            velocity(this, multiscale_constants::HEMELB_MULTISCALE_REFERENCE_VELOCITY),
+            couplingInterval(1), couplingInterpolation(LinearInterpolation), coupledValueCount(0)
       {
       }
       /***
@@ -36,7 +37,9 @@ namespace hemelb
       InOutLetMultiscale::InOutLetMultiscale(const InOutLetMultiscale &other) :
         Intercommunicand(other), label(other.label), units(other.units), commsRequired(false),
             pressure(this, other.maxPressure.GetPayload()), minPressure(this, other.minPressure.GetPayload()),
-            maxPressure(this, other.maxPressure.GetPayload()), velocity(this, other.GetVelocity())
+            maxPressure(this, other.maxPressure.GetPayload()), velocity(this, other.GetVelocity()),
+            couplingInterval(other.couplingInterval),
+            couplingInterpolation(other.couplingInterpolation), coupledValueCount(0)
       {
       }
 
@@ -62,6 +65,11 @@ namespace hemelb
       {
         return true;
       }
+      bool InOutLetMultiscale::IsDensityLocallyComputable() const
+      {
+        // The pressure comes from the coupled code via the BC proc.
+        return false;
+      }
       int InOutLetMultiscale::GetNumberOfFieldPoints() const
       {
         return numberOfFieldPoints;
@@ -69,7 +77,41 @@ namespace hemelb
       LatticeDensity InOutLetMultiscale::GetDensity(unsigned long timeStep) const
       {
         /* TODO: Fix pressure and GetPressure values (using PressureMax() for now). */
-        return units->ConvertPressureToLatticeUnits(maxPressure.GetPayload()) / Cs2;
+        if (couplingInterval <= 1 || coupledValueCount < 2)
+        {
+          return units->ConvertPressureToLatticeUnits(maxPressure.GetPayload()) / Cs2;
+        }
+
+        // How far we are through the interval since the last value came, from the value before it
+        // (at 0) to the last one (at 1).
+        const PhysicalPressure* const values = coupledPressures + CoupledHistoryLength - coupledValueCount;
+        const unsigned last = coupledValueCount - 1;
+        const LatticeTimeStep lastTimeStep = coupledTimeSteps[CoupledHistoryLength - 1];
+        const LatticeTimeStep interval = lastTimeStep - coupledTimeSteps[CoupledHistoryLength - 2];
+        double fraction = timeStep <= lastTimeStep ?
+          0.0 :
+          double(timeStep - lastTimeStep) / double(interval);
+        if (fraction > 1.0)
+        {
+          fraction = 1.0;
+        }
+
+        PhysicalPressure pressure;
+        if (couplingInterpolation == CubicInterpolation && coupledValueCount == 3)
+        {
+          // Hermite spline from values[1] to values[2], with slopes by central and backward
+          // differences.
+          const PhysicalPressure startSlope = (values[2] - values[0]) / 2.0;
+          const PhysicalPressure endSlope = values[2] - values[1];
+          const double f2 = fraction * fraction, f3 = f2 * fraction;
+          pressure = (2.0 * f3 - 3.0 * f2 + 1.0) * values[1] + (f3 - 2.0 * f2 + fraction) * startSlope
+              + (-2.0 * f3 + 3.0 * f2) * values[2] + (f3 - f2) * endSlope;
+        }
+        else
+        {
+          pressure = values[last - 1] + fraction * (values[last] - values[last - 1]);
+        }
+        return units->ConvertPressureToLatticeUnits(pressure) / Cs2;
       }
       LatticeDensity InOutLetMultiscale::GetDensityMin() const
       {
@@ -98,6 +140,36 @@ namespace hemelb
         return velocity;
       }
 
+      unsigned long InOutLetMultiscale::GetCouplingInterval() const
+      {
+        return couplingInterval;
+      }
+
+      void InOutLetMultiscale::SetCouplingInterval(unsigned long interval)
+      {
+        couplingInterval = interval;
+      }
+
+      void InOutLetMultiscale::SetCouplingInterpolation(CouplingInterpolation interpolation)
+      {
+        couplingInterpolation = interpolation;
+      }
+
+      void InOutLetMultiscale::RecordCoupledValues(LatticeTimeStep timeStep)
+      {
+        for (unsigned i = 0; i + 1 < CoupledHistoryLength; ++i)
+        {
+          coupledPressures[i] = coupledPressures[i + 1];
+          coupledTimeSteps[i] = coupledTimeSteps[i + 1];
+        }
+        coupledPressures[CoupledHistoryLength - 1] = maxPressure.GetPayload();
+        coupledTimeSteps[CoupledHistoryLength - 1] = timeStep;
+        if (coupledValueCount < CoupledHistoryLength)
+        {
+          ++coupledValueCount;
+        }
+      }
+
       // This should be const, and we should have a setter.
       // But the way SimConfig is set up prevents this.
       std::string & InOutLetMultiscale::GetLabel()
@@ -118,50 +190,28 @@ namespace hemelb
       }
 
       /* Distribution of internal pressure values */
-      void InOutLetMultiscale::DoComms(const BoundaryCommunicator& bcComms, LatticeTimeStep time_step)
-      {
-        bool isIoProc = bcComms.IsCurrentProcTheBCProc();
-        hemelb::log::Logger::Log<hemelb::log::Debug, hemelb::log::OnePerCore>("DoComms in IoletMultiscale triggered: %s",
-                                                                              isIoProc
-                                                                                ? "true"
-                                                                                : "false");
-        double pressure_array[3];
-        //TODO: Change these operators on SharedValue.
-        pressure_array[0] = pressure.GetPayload();
-        pressure_array[1] = minPressure.GetPayload();
-        pressure_array[2] = maxPressure.GetPayload();
-
-        net::Net commsNet(bcComms);
-
-        const std::vector<int>& procList = comms->GetListOfProcs(); //TODO: CHECK + IMPROVE!
-
-        // If this proc is to do IO, send the pressure array list to all cores that require it.
-        if (isIoProc && procList[0] != bcComms.GetBCProcRank())
-        {
-          for (std::vector<int>::const_iterator it = procList.begin(); it != procList.end(); it++)
-          {
-            commsNet.RequestSend(pressure_array, 3, *it);
-          }
-        }
-        // Otherwise, receive the pressure array list from the core.
-        else if (procList[0] != bcComms.GetBCProcRank())
-        {
-          commsNet.RequestReceive(pressure_array, 3, bcComms.GetBCProcRank());
-        }
+      unsigned InOutLetMultiscale::GetCommsValueCount() const
+      {
+        return 3;
+      }
 
-        // Perform the send / receive.
-        commsNet.Dispatch();
+      void InOutLetMultiscale::PackCommsValues(distribn_t* values) const
+      {
+        //TODO: Change these operators on SharedValue.
+        values[0] = pressure.GetPayload();
+        values[1] = minPressure.GetPayload();
+        values[2] = maxPressure.GetPayload();
+      }
 
-        if (!isIoProc)
-        {
-          pressure.SetPayload(static_cast<PhysicalPressure> (pressure_array[0]));
-          minPressure.SetPayload(static_cast<PhysicalPressure> (pressure_array[1]));
-          maxPressure.SetPayload(static_cast<PhysicalPressure> (pressure_array[2]));
-          hemelb::log::Logger::Log<hemelb::log::Debug, hemelb::log::OnePerCore>("Received: %f %f %f",
-                                                                                pressure.GetPayload(),
-                                                                                minPressure.GetPayload(),
-                                                                                maxPressure.GetPayload());
-        }
+      void InOutLetMultiscale::UnpackCommsValues(const distribn_t* values)
+      {
+        pressure.SetPayload(static_cast<PhysicalPressure> (values[0]));
+        minPressure.SetPayload(static_cast<PhysicalPressure> (values[1]));
+        maxPressure.SetPayload(static_cast<PhysicalPressure> (values[2]));
+        hemelb::log::Logger::Log<hemelb::log::Debug, hemelb::log::OnePerCore>("Received: %f %f %f",
+                                                                              pressure.GetPayload(),
+                                                                              minPressure.GetPayload(),
+                                                                              maxPressure.GetPayload());
       }
     }
   }
@@ -37,11 +37,26 @@ namespace hemelb
        * ExchangeAreaSize is the size of the area which is used to exchange information with with the outside world. It is
        * set to '1' for 1-dimensional iolets, to the surface area (in lattice sites) of the InOutLet for 2-dimensional iolets,
        * and to an even higher value should we wish to go for overlapping exchange regions.
+       *
+       * The pressure may be exchanged only every few time steps (the coupling interval). Each value
+       * received is recorded with RecordCoupledValues, and on the steps in between the density is
+       * interpolated, linearly or with a cubic through the previous values too, from the
+       * second-to-last value received to the last one. So the boundary lags the coupled model by one
+       * interval, but changes smoothly rather than in steps.
        */
       class InOutLetMultiscale : public multiscale::Intercommunicand,
                                  public InOutLet
       {
         public:
+          /**
+           * How the density is found on the time steps between exchanges.
+           */
+          enum CouplingInterpolation
+          {
+            LinearInterpolation, //!< Along a line through the last two values received
+            CubicInterpolation //!< Along a cubic Hermite spline, with slopes from the last three values
+          };
+
           InOutLetMultiscale();
           InOutLetMultiscale(const InOutLetMultiscale &other);
           virtual ~InOutLetMultiscale();
@@ -49,6 +64,7 @@ namespace hemelb
           virtual void Initialise(const util::UnitConverter* unitConverter);
           virtual void Reset(SimulationState &state);
           virtual bool IsRegistrationRequired() const;
+          virtual bool IsDensityLocallyComputable() const;
 
           virtual int GetNumberOfFieldPoints() const;
           // returns the number of field points that are exchanged with the coupled code.
@@ -66,6 +82,19 @@ namespace hemelb
           multiscale::SharedValue<PhysicalPressure> & GetPressureReference();
           multiscale::SharedValue<PhysicalVelocity> & GetVelocityReference();
 
+          /**
+           * The number of time steps between exchanges with the coupled model.
+           */
+          unsigned long GetCouplingInterval() const;
+          void SetCouplingInterval(unsigned long interval);
+          void SetCouplingInterpolation(CouplingInterpolation interpolation);
+
+          /**
+           * Record the values just received from the coupled model, for interpolating between.
+           * @param timeStep The (0-indexed) time step they were received on.
+           */
+          void RecordCoupledValues(LatticeTimeStep timeStep);
+
           template<class Intercommunicator> void Register(Intercommunicator &intercomms,
                                                           typename Intercommunicator::IntercommunicandTypeT &type)
           {
@@ -86,7 +115,9 @@ namespace hemelb
 
           virtual bool IsCommsRequired() const;
           virtual void SetCommsRequired(bool b);
-          void DoComms(const BoundaryCommunicator& bcComms, const LatticeTimeStep timeStep);
+          virtual unsigned GetCommsValueCount() const;
+          virtual void PackCommsValues(distribn_t* values) const;
+          virtual void UnpackCommsValues(const distribn_t* values);
 
         private:
           std::string label;
@@ -97,6 +128,14 @@ namespace hemelb
           multiscale::SharedValue<PhysicalPressure> minPressure;
           multiscale::SharedValue<PhysicalPressure> maxPressure;
           mutable multiscale::SharedValue<PhysicalVelocity> velocity;
+
+          unsigned long couplingInterval;
+          CouplingInterpolation couplingInterpolation;
+          //! The last few pressures received, oldest first, and the time steps they came on.
+          static const unsigned CoupledHistoryLength = 3;
+          PhysicalPressure coupledPressures[CoupledHistoryLength];
+          LatticeTimeStep coupledTimeSteps[CoupledHistoryLength];
+          unsigned coupledValueCount;
       };
     }
   }
@@ -17,6 +17,12 @@ namespace hemelb
       const InOutLetWomersleyVelocity::Complex InOutLetWomersleyVelocity::iPowThreeHalves =
           pow(i, 1.5);
 
+      InOutLetWomersleyVelocity::InOutLetWomersleyVelocity() :
+        InOutLetVelocity(), pressureGradientAmplitude(0), period(0), womersleyNumber(0)
+      {
+        SetWomersleyNumber(0);
+      }
+
       InOutLet* InOutLetWomersleyVelocity::Clone() const
       {
         InOutLet* copy = new InOutLetWomersleyVelocity(*this);
@@ -33,15 +39,32 @@ namespace hemelb
         double omega = 2.0 * PI / period;
         LatticeDensity density = 1.0;
 
-        Complex besselNumer = util::BesselJ0ComplexArgument(iPowThreeHalves * womersleyNumber * r
-            / radius);
-        Complex besselDenom = util::BesselJ0ComplexArgument(iPowThreeHalves * womersleyNumber);
         LatticeSpeed velocityMagnitude = std::real(pressureGradientAmplitude / (density * omega)
-            * (1.0 - besselNumer / besselDenom) * exp(i * omega * double(t)));
+            * GetRadialProfile(r / radius) * exp(i * omega * double(t)));
 
         return normal * -velocityMagnitude;
       }
 
+      InOutLetWomersleyVelocity::Complex InOutLetWomersleyVelocity::EvaluateRadialProfile(double normalisedRadius) const
+      {
+        return 1.0 - util::BesselJ0ComplexArgument(iPowThreeHalves * womersleyNumber * normalisedRadius)
+            / besselDenominator;
+      }
+
+      InOutLetWomersleyVelocity::Complex InOutLetWomersleyVelocity::GetRadialProfile(double normalisedRadius) const
+      {
+        // Written this way round so that a NaN radius is also evaluated directly.
+        if (! (normalisedRadius < 1.0))
+        {
+          return EvaluateRadialProfile(normalisedRadius);
+        }
+
+        const double tablePosition = normalisedRadius * RADIAL_PROFILE_INTERVALS;
+        const unsigned lower = (unsigned) tablePosition;
+        const double fraction = tablePosition - lower;
+        return (1.0 - fraction) * radialProfile[lower] + fraction * radialProfile[lower + 1];
+      }
+
       const LatticePressureGradient& InOutLetWomersleyVelocity::GetPressureGradientAmplitude() const
       {
         return pressureGradientAmplitude;
@@ -70,6 +93,13 @@ namespace hemelb
       void InOutLetWomersleyVelocity::SetWomersleyNumber(const Dimensionless& womNumber)
       {
         womersleyNumber = womNumber;
+
+        besselDenominator = util::BesselJ0ComplexArgument(iPowThreeHalves * womersleyNumber);
+        radialProfile.resize(RADIAL_PROFILE_INTERVALS + 1);
+        for (unsigned point = 0; point <= RADIAL_PROFILE_INTERVALS; ++point)
+        {
+          radialProfile[point] = EvaluateRadialProfile(double(point) / RADIAL_PROFILE_INTERVALS);
+        }
       }
     }
   }
@@ -8,6 +8,7 @@
 #define HEMELB_LB_IOLETS_INOUTLETWOMERSLEYVELOCITY_H
 #include "lb/iolets/InOutLetVelocity.h"
 #include <complex>
+#include <vector>
 
 namespace hemelb
 {
@@ -28,10 +29,15 @@ namespace hemelb
        *
        * If combined with a pressure iolet at the other end of the cylinder, it must be set to
        * zero pressure
+       *
+       * The radial part of the solution only depends on r/R and the Womersley number, so it is
+       * tabulated whenever the Womersley number is set rather than evaluating two Bessel series
+       * for every call of GetVelocity.
        */
       class InOutLetWomersleyVelocity : public InOutLetVelocity
       {
         public:
+          InOutLetWomersleyVelocity();
 
           /**
            * Returns a copy of the current iolet. The caller is responsible for freeing that memory.
@@ -95,9 +101,31 @@ namespace hemelb
           typedef std::complex<double> Complex;
           static const Complex i;
           static const Complex iPowThreeHalves;
+
+          /**
+           * Evaluate 1 - J0(i^(3/2) * womersleyNumber * r / R) / J0(i^(3/2) * womersleyNumber)
+           * directly, using the cached denominator.
+           * @param normalisedRadius r / R
+           * @return
+           */
+          Complex EvaluateRadialProfile(double normalisedRadius) const;
+
+          /**
+           * Get the radial profile at r / R, interpolating linearly in the table for points
+           * inside the iolet and evaluating it directly otherwise.
+           * @param normalisedRadius r / R
+           * @return
+           */
+          Complex GetRadialProfile(double normalisedRadius) const;
+
+          //! Number of intervals of the radial profile table over 0 <= r / R <= 1.
+          static const unsigned RADIAL_PROFILE_INTERVALS = 4096;
+
           LatticePressureGradient pressureGradientAmplitude; ///< See class documentation
           LatticeTime period; ///< See class documentation
           double womersleyNumber; ///< See class documentation
+          Complex besselDenominator; ///< J0(i^(3/2) * womersleyNumber)
+          std::vector<Complex> radialProfile; ///< EvaluateRadialProfile at RADIAL_PROFILE_INTERVALS + 1 evenly spaced points
       };
     }
   }
@@ -10,6 +10,7 @@
 #include <cstdlib>
 #include "constants.h"
 #include "lb/iolets/BoundaryValues.h"
+#include "lb/lattices/Lattice.h"
 #include "lb/kernels/rheologyModels/RheologyModels.h"
 #include "geometry/neighbouring/NeighbouringDataManager.h"
 
@@ -55,10 +56,11 @@ namespace hemelb
           template<class rheologyModel, class LatticeImpl> friend class LBGKNN;
           template<class LatticeImpl> friend class MRT;
           template<class LatticeImpl> friend class TRT;
+          template<class LatticeImpl, bool tThirdOrder> friend class Regularised;
 
         protected:
           HydroVarsBase(const distribn_t* const f) :
-            f(f)
+            f(f), fNeqMomentKnown(false)
           {
           }
 
@@ -107,13 +109,30 @@ namespace hemelb
             fPostCollision[direction] = value;
           }
 
-          inline const FVector<LatticeType>& GetFPostCollision()
+          inline const FVector<LatticeType>& GetFPostCollision() const
           {
             return fPostCollision;
           }
 
+          /**
+           * The second moment of f_neq, if the kernel found it in colliding (see Regularised), so
+           * that the stress properties can be made from it without another pass.
+           * @param moment Set to the moment, if known.
+           * @return Whether it was known.
+           */
+          inline bool GetKnownFNeqMoment(lattices::SecondMoment& moment) const
+          {
+            if (fNeqMomentKnown)
+            {
+              moment = fNeqMoment;
+            }
+            return fNeqMomentKnown;
+          }
+
         protected:
           FVector<LatticeType> f_eq, f_neq, fPostCollision;
+          bool fNeqMomentKnown;
+          lattices::SecondMoment fNeqMoment;
       };
 
       template<typename KernelImpl>
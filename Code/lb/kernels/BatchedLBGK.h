@@ -0,0 +1,267 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_LB_KERNELS_BATCHEDLBGK_H
+#define HEMELB_LB_KERNELS_BATCHEDLBGK_H
+
+#if defined(HEMELB_BULK_SIMD_AVX2) || defined(HEMELB_BULK_SIMD_AVX512)
+  #include <immintrin.h>
+#endif
+
+#include "constants.h"
+#include "lb/LbmParameters.h"
+
+namespace hemelb
+{
+  namespace lb
+  {
+    namespace kernels
+    {
+      /**
+       * SiteBatch: a vector holding one value for each of the sites in a batch, with one site
+       * per SIMD lane. The instruction set is chosen at build time with HEMELB_BULK_SIMD; if none
+       * is chosen, a plain array is used so that the batched code still builds (and is tested)
+       * everywhere.
+       */
+#if defined(HEMELB_BULK_SIMD_AVX512)
+      struct SiteBatch
+      {
+          static const unsigned WIDTH = 8;
+          __m512d v;
+
+          static inline SiteBatch Load(const distribn_t* values)
+          {
+            SiteBatch ans;
+            ans.v = _mm512_load_pd(values);
+            return ans;
+          }
+          static inline SiteBatch Broadcast(distribn_t value)
+          {
+            SiteBatch ans;
+            ans.v = _mm512_set1_pd(value);
+            return ans;
+          }
+          inline void Store(distribn_t* values) const
+          {
+            _mm512_store_pd(values, v);
+          }
+          inline SiteBatch operator+(const SiteBatch& other) const
+          {
+            SiteBatch ans;
+            ans.v = _mm512_add_pd(v, other.v);
+            return ans;
+          }
+          inline SiteBatch operator-(const SiteBatch& other) const
+          {
+            SiteBatch ans;
+            ans.v = _mm512_sub_pd(v, other.v);
+            return ans;
+          }
+          inline SiteBatch operator*(const SiteBatch& other) const
+          {
+            SiteBatch ans;
+            ans.v = _mm512_mul_pd(v, other.v);
+            return ans;
+          }
+          inline SiteBatch operator/(const SiteBatch& other) const
+          {
+            SiteBatch ans;
+            ans.v = _mm512_div_pd(v, other.v);
+            return ans;
+          }
+      };
+#elif defined(HEMELB_BULK_SIMD_AVX2)
+      struct SiteBatch
+      {
+          static const unsigned WIDTH = 4;
+          __m256d v;
+
+          static inline SiteBatch Load(const distribn_t* values)
+          {
+            SiteBatch ans;
+            ans.v = _mm256_load_pd(values);
+            return ans;
+          }
+          static inline SiteBatch Broadcast(distribn_t value)
+          {
+            SiteBatch ans;
+            ans.v = _mm256_set1_pd(value);
+            return ans;
+          }
+          inline void Store(distribn_t* values) const
+          {
+            _mm256_store_pd(values, v);
+          }
+          inline SiteBatch operator+(const SiteBatch& other) const
+          {
+            SiteBatch ans;
+            ans.v = _mm256_add_pd(v, other.v);
+            return ans;
+          }
+          inline SiteBatch operator-(const SiteBatch& other) const
+          {
+            SiteBatch ans;
+            ans.v = _mm256_sub_pd(v, other.v);
+            return ans;
+          }
+          inline SiteBatch operator*(const SiteBatch& other) const
+          {
+            SiteBatch ans;
+            ans.v = _mm256_mul_pd(v, other.v);
+            return ans;
+          }
+          inline SiteBatch operator/(const SiteBatch& other) const
+          {
+            SiteBatch ans;
+            ans.v = _mm256_div_pd(v, other.v);
+            return ans;
+          }
+      };
+#else
+      struct SiteBatch
+      {
+          static const unsigned WIDTH = 4;
+          distribn_t v[WIDTH];
+
+          static inline SiteBatch Load(const distribn_t* values)
+          {
+            SiteBatch ans;
+            for (unsigned lane = 0; lane < WIDTH; ++lane)
+              ans.v[lane] = values[lane];
+            return ans;
+          }
+          static inline SiteBatch Broadcast(distribn_t value)
+          {
+            SiteBatch ans;
+            for (unsigned lane = 0; lane < WIDTH; ++lane)
+              ans.v[lane] = value;
+            return ans;
+          }
+          inline void Store(distribn_t* values) const
+          {
+            for (unsigned lane = 0; lane < WIDTH; ++lane)
+              values[lane] = v[lane];
+          }
+          inline SiteBatch operator+(const SiteBatch& other) const
+          {
+            SiteBatch ans;
+            for (unsigned lane = 0; lane < WIDTH; ++lane)
+              ans.v[lane] = v[lane] + other.v[lane];
+            return ans;
+          }
+          inline SiteBatch operator-(const SiteBatch& other) const
+          {
+            SiteBatch ans;
+            for (unsigned lane = 0; lane < WIDTH; ++lane)
+              ans.v[lane] = v[lane] - other.v[lane];
+            return ans;
+          }
+          inline SiteBatch operator*(const SiteBatch& other) const
+          {
+            SiteBatch ans;
+            for (unsigned lane = 0; lane < WIDTH; ++lane)
+              ans.v[lane] = v[lane] * other.v[lane];
+            return ans;
+          }
+          inline SiteBatch operator/(const SiteBatch& other) const
+          {
+            SiteBatch ans;
+            for (unsigned lane = 0; lane < WIDTH; ++lane)
+              ans.v[lane] = v[lane] / other.v[lane];
+            return ans;
+          }
+      };
+#endif
+
+      /**
+       * BatchedHydroVars: the hydrodynamic variables of SiteBatch::WIDTH sites. Arrays over
+       * directions are stored direction-major, i.e. value [direction * WIDTH + lane] belongs to
+       * the site in that lane.
+       */
+      template<class LatticeType>
+      struct BatchedHydroVars
+      {
+          static const unsigned WIDTH = SiteBatch::WIDTH;
+
+          distribn_t f[LatticeType::NUMVECTORS * WIDTH] __attribute__((aligned(64)));
+          distribn_t f_eq[LatticeType::NUMVECTORS * WIDTH] __attribute__((aligned(64)));
+          distribn_t fPostCollision[LatticeType::NUMVECTORS * WIDTH] __attribute__((aligned(64)));
+          distribn_t density[WIDTH] __attribute__((aligned(64)));
+          distribn_t momentumX[WIDTH] __attribute__((aligned(64)));
+          distribn_t momentumY[WIDTH] __attribute__((aligned(64)));
+          distribn_t momentumZ[WIDTH] __attribute__((aligned(64)));
+      };
+
+      /**
+       * BatchedLBGK: the LBGK single-relaxation time kernel applied to a batch of sites at once,
+       * with one site per SIMD lane. It gives the same results as LBGK (up to rounding) but
+       * has no per-site state, so it is only used for bulk sites.
+       */
+      template<class LatticeType>
+      class BatchedLBGK
+      {
+        public:
+          typedef BatchedHydroVars<LatticeType> BatchHydroVars;
+          static const unsigned WIDTH = SiteBatch::WIDTH;
+
+          static inline void CalculateDensityMomentumFeq(BatchHydroVars& hydroVars)
+          {
+            SiteBatch density = SiteBatch::Broadcast(0.0);
+            SiteBatch momentumX = SiteBatch::Broadcast(0.0);
+            SiteBatch momentumY = SiteBatch::Broadcast(0.0);
+            SiteBatch momentumZ = SiteBatch::Broadcast(0.0);
+
+            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+            {
+              const SiteBatch f = SiteBatch::Load(&hydroVars.f[direction * WIDTH]);
+              density = density + f;
+              momentumX = momentumX + SiteBatch::Broadcast(LatticeType::CXD[direction]) * f;
+              momentumY = momentumY + SiteBatch::Broadcast(LatticeType::CYD[direction]) * f;
+              momentumZ = momentumZ + SiteBatch::Broadcast(LatticeType::CZD[direction]) * f;
+            }
+
+            density.Store(hydroVars.density);
+            momentumX.Store(hydroVars.momentumX);
+            momentumY.Store(hydroVars.momentumY);
+            momentumZ.Store(hydroVars.momentumZ);
+
+            const SiteBatch density_1 = SiteBatch::Broadcast(1.0) / density;
+            const SiteBatch momentumMagnitudeSquared = momentumX * momentumX + momentumY * momentumY
+                + momentumZ * momentumZ;
+            const SiteBatch densityTerm = density
+                - SiteBatch::Broadcast(3. / 2.) * momentumMagnitudeSquared * density_1;
+            const SiteBatch nineHalvesOfDensity_1 = SiteBatch::Broadcast(9. / 2.) * density_1;
+            const SiteBatch three = SiteBatch::Broadcast(3.);
+
+            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+            {
+              const SiteBatch mom_dot_ei = SiteBatch::Broadcast(LatticeType::CXD[direction]) * momentumX
+                  + SiteBatch::Broadcast(LatticeType::CYD[direction]) * momentumY
+                  + SiteBatch::Broadcast(LatticeType::CZD[direction]) * momentumZ;
+
+              const SiteBatch f_eq = SiteBatch::Broadcast(LatticeType::EQMWEIGHTS[direction])
+                  * (densityTerm + nineHalvesOfDensity_1 * mom_dot_ei * mom_dot_ei + three * mom_dot_ei);
+              f_eq.Store(&hydroVars.f_eq[direction * WIDTH]);
+            }
+          }
+
+          static inline void Collide(const LbmParameters* const lbmParams, BatchHydroVars& hydroVars)
+          {
+            const SiteBatch omega = SiteBatch::Broadcast(lbmParams->GetOmega());
+
+            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+            {
+              const SiteBatch f = SiteBatch::Load(&hydroVars.f[direction * WIDTH]);
+              const SiteBatch f_neq = f - SiteBatch::Load(&hydroVars.f_eq[direction * WIDTH]);
+              (f + f_neq * omega).Store(&hydroVars.fPostCollision[direction * WIDTH]);
+            }
+          }
+      };
+    }
+  }
+}
+
+#endif /* HEMELB_LB_KERNELS_BATCHEDLBGK_H */
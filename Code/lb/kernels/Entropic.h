@@ -108,16 +108,34 @@ namespace hemelb
             }
             else
             {
-              // Happens a lot near equilibrium. In this limit we return LBGK to avoid unnecessary calculations
-              // Should really be a small number to accommodate round off and truncations errors, but only 0.0
-              // causes problems as it causes a NaN when bracketing in Brent.
-              if (deviation == 0.0)
+              // Happens a lot near equilibrium. In this limit we return LBGK to avoid unnecessary calculations.
+              // The root is 2 less something of the order of the deviation, and it multiplies f_neq, so below
+              // NearEquilibriumDeviation the collision is out by less than its square, which is round off.
+              // So any site that close skips the root search altogether (which also keeps a deviation of
+              // 0.0 away from Brent, where the bracket would be infinite).
+              if (deviation < NearEquilibriumDeviation)
               {
                 return 2.0;
               }
 
               HFunction<LatticeType> HFunc(hydroVars.f, hydroVars.f_eq.f);
 
+              // The site's alpha changes little from step to step, so a few Newton-Raphson steps from the
+              // previous one usually find the root for far fewer evaluations than bracketing it for Brent.
+              // The bracket excludes the trivial root at 0, which Newton-Raphson might otherwise find.
+              double alpha;
+              if (hemelb::util::NumericalMethods::NewtonRaphson(&HFunc,
+                                                                 prevAlpha < 2.0 * tau ?
+                                                                   2.0 :
+                                                                   prevAlpha,
+                                                                 1.0E-6,
+                                                                 WarmStartIterations,
+                                                                 alpha) && alpha > 2.0 * tau
+                  && alpha < 2.0 * tau / deviation)
+              {
+                return alpha;
+              }
+
               // The bracket is very large, but it should guarantee that a root is enclosed
               double alphaLower = 2.0 * (tau), HLower;
               double alphaHigher = 2.0 * (tau) / deviation, HHigher;
@@ -145,11 +163,24 @@ namespace hemelb
 
           }
 
+          /**
+           * Largest deviation from equilibrium, relative to f, for which alpha is taken to be 2.
+           */
+          static const double NearEquilibriumDeviation;
+
+          /**
+           * Newton-Raphson steps from the previous alpha to try before bracketing the root.
+           */
+          static const unsigned WarmStartIterations = 4;
+
           /**
            * Stores the value of alpha (the relaxation parameter) from the previous iteration.
            */
           distribn_t* oldAlpha;
       };
+
+      template<typename LatticeType>
+      const double Entropic<LatticeType>::NearEquilibriumDeviation = 1.0E-6;
     }
   }
 }
@@ -12,6 +12,7 @@
 #include "lb/kernels/LBGK.h"
 #include "lb/kernels/LBGKNN.h"
 #include "lb/kernels/MRT.h"
+#include "lb/kernels/Regularised.h"
 #include "lb/kernels/TRT.h"
 
 #endif /* HEMELB_LB_KERNELS_KERNELS_H */
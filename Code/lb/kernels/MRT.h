@@ -29,9 +29,6 @@ namespace hemelb
               HydroVarsBase<typename MomentBasis::Lattice>(f)
           {
           }
-
-          /** Equilibrium velocity distribution in the momentum space. */
-          distribn_t m_neq[MomentBasis::NUM_KINETIC_MOMENTS];
       };
 
       /**
@@ -46,6 +43,10 @@ namespace hemelb
        *  versions of {m,f}.
        *
        *  (M * M^T)^{-1} and \hat{S} are diagonal matrices.
+       *
+       *  The basis and the relaxation rates are fixed until the kernel is reset, so the whole
+       *  operator M^T * (M * M^T)^{-1} * \hat{S} * M is worked out once then, as a dense
+       *  NUMVECTORS x NUMVECTORS matrix, and each collision is a single product of it with f_neq.
        */
       template<class MomentBasis>
       class MRT : public BaseKernel<MRT<MomentBasis>, typename MomentBasis::Lattice>
@@ -55,17 +56,6 @@ namespace hemelb
           MRT(InitParams& initParams)
           {
             InitState(initParams);
-
-            // Pre-compute the reduced moment basis divided by the basis times basis transposed.
-            for (Direction direction = 0; direction < MomentBasis::Lattice::NUMVECTORS; ++direction)
-            {
-              for (unsigned momentIndex = 0; momentIndex < MomentBasis::NUM_KINETIC_MOMENTS; momentIndex++)
-              {
-                normalisedReducedMomentBasis[momentIndex][direction] =
-                    MomentBasis::REDUCED_MOMENT_BASIS[momentIndex][direction]
-                        / MomentBasis::BASIS_TIMES_BASIS_TRANSPOSED[momentIndex];
-              }
-            }
           }
 
           inline void DoCalculateDensityMomentumFeq(HydroVars<MRT>& hydroVars, site_t index)
@@ -84,9 +74,6 @@ namespace hemelb
             {
               hydroVars.f_neq.f[ii] = hydroVars.f[ii] - hydroVars.f_eq.f[ii];
             }
-
-            /** @todo #222 consider computing m_neq directly in the momentum space. See d'Humieres 2002. */
-            MomentBasis::ProjectVelsIntoMomentSpace(hydroVars.f_neq.f, hydroVars.m_neq);
           }
 
           inline void DoCalculateFeq(HydroVars<MRT>& hydroVars, site_t index)
@@ -101,25 +88,25 @@ namespace hemelb
             {
               hydroVars.f_neq.f[ii] = hydroVars.f[ii] - hydroVars.f_eq.f[ii];
             }
-
-            /** @todo #222 consider computing m_neq directly in the moment space. See d'Humieres 2002. */
-            MomentBasis::ProjectVelsIntoMomentSpace(hydroVars.f_neq.f, hydroVars.m_neq);
           }
 
           inline void DoCollide(const LbmParameters* const lbmParams, HydroVars<MRT>& hydroVars)
           {
-            for (Direction direction = 0; direction < MomentBasis::Lattice::NUMVECTORS; ++direction)
+            // Accumulate a column of the operator at a time, so the inner loop runs over the
+            // directions collided into, independently, and vectorises without reordering sums.
+            distribn_t collision[MomentBasis::Lattice::NUMVECTORS] = { };
+            for (Direction source = 0; source < MomentBasis::Lattice::NUMVECTORS; ++source)
             {
-              /** @todo #222 many optimisations possible (and necessary!).
-               *  - Compute the loop below as a matrix product in DoCalculate*, alternatively we could consider reimplementing DoCollide to work with whole arrays (consider libraries boost::ublas or Armadillo)
-               */
-              distribn_t collision = 0.;
-              for (unsigned momentIndex = 0; momentIndex < MomentBasis::NUM_KINETIC_MOMENTS; momentIndex++)
+              const distribn_t fNeq = hydroVars.f_neq.f[source];
+              for (Direction direction = 0; direction < MomentBasis::Lattice::NUMVECTORS; ++direction)
               {
-                collision += collisionMatrix[momentIndex] * normalisedReducedMomentBasis[momentIndex][direction]
-                    * hydroVars.m_neq[momentIndex];
+                collision[direction] += collisionOperator[source][direction] * fNeq;
               }
-              hydroVars.SetFPostCollision(direction, hydroVars.f[direction] - collision);
+            }
+
+            for (Direction direction = 0; direction < MomentBasis::Lattice::NUMVECTORS; ++direction)
+            {
+              hydroVars.SetFPostCollision(direction, hydroVars.f[direction] - collision[direction]);
             }
           }
 
@@ -136,13 +123,18 @@ namespace hemelb
           {
             assert(newRelaxationParameters.size() == MomentBasis::NUM_KINETIC_MOMENTS);
             collisionMatrix = newRelaxationParameters;
+            BuildCollisionOperator();
           }
 
         private:
           /** MRT collision matrix (\hat{S}, diagonal). It corresponds to the inverse of the relaxation time for each mode. */
           std::vector<distribn_t> collisionMatrix;
 
-          double normalisedReducedMomentBasis[MomentBasis::NUM_KINETIC_MOMENTS][MomentBasis::Lattice::NUMVECTORS];
+          /**
+           *  M^T * (M * M^T)^{-1} * \hat{S} * M, transposed: collisionOperator[j][i] is how much
+           *  f_neq in direction j changes f in direction i.
+           */
+          distribn_t collisionOperator[MomentBasis::Lattice::NUMVECTORS][MomentBasis::Lattice::NUMVECTORS];
 
           /**
            *  Helper method to set/update member variables. Called from the constructor and Reset()
@@ -152,6 +144,28 @@ namespace hemelb
           void InitState(const InitParams& initParams)
           {
             MomentBasis::SetUpCollisionMatrix(collisionMatrix, initParams.lbmParams->GetTau());
+            BuildCollisionOperator();
+          }
+
+          /**
+           *  Work out the collision operator from the basis and the current collision matrix.
+           */
+          void BuildCollisionOperator()
+          {
+            for (Direction source = 0; source < MomentBasis::Lattice::NUMVECTORS; ++source)
+            {
+              for (Direction direction = 0; direction < MomentBasis::Lattice::NUMVECTORS; ++direction)
+              {
+                distribn_t element = 0.;
+                for (unsigned momentIndex = 0; momentIndex < MomentBasis::NUM_KINETIC_MOMENTS; momentIndex++)
+                {
+                  element += collisionMatrix[momentIndex] * MomentBasis::REDUCED_MOMENT_BASIS[momentIndex][direction]
+                      / MomentBasis::BASIS_TIMES_BASIS_TRANSPOSED[momentIndex]
+                      * MomentBasis::REDUCED_MOMENT_BASIS[momentIndex][source];
+                }
+                collisionOperator[source][direction] = element;
+              }
+            }
           }
 
       };
@@ -0,0 +1,139 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_LB_KERNELS_REGULARISED_H
+#define HEMELB_LB_KERNELS_REGULARISED_H
+
+#include <cstdlib>
+#include "lb/kernels/BaseKernel.h"
+
+namespace hemelb
+{
+  namespace lb
+  {
+    namespace kernels
+    {
+      /**
+       * Regularised: a single-relaxation time kernel that, before relaxing, replaces f_neq by
+       * its projection onto the second-order Hermite polynomials (Latt & Chopard 2006),
+       *
+       *    f_neq_i = w_i / (2 cs^4) H2_i : Pi_neq,   H2_i = c_i c_i - cs^2 I,
+       *
+       * where Pi_neq is the second moment of f_neq. The higher-order, non-hydrodynamic parts of
+       * f_neq, which LBGK leaves to relax at 1 / tau and which make it unstable as tau nears
+       * 0.5, are dropped, so coarser lattices can be run at the same viscosity.
+       *
+       * With tThirdOrder, the projection also takes the third-order Hermite coefficients,
+       * found recursively from the second-order ones as a3_neq = u Pi_neq + (the two other
+       * permutations) (Malaspinas 2015). Those of them the lattice can't hold drop out, as their
+       * Hermite polynomials are zero on every direction.
+       *
+       * The projection keeps the density, momentum and Pi_neq, so the stress properties are the
+       * same as from LBGK's f_neq. Pi_neq is kept in the hydrodynamic variables for the property
+       * cache to make them from.
+       */
+      template<class LatticeType, bool tThirdOrder = false>
+      class Regularised : public BaseKernel<Regularised<LatticeType, tThirdOrder>, LatticeType>
+      {
+        public:
+          Regularised(InitParams& initParams)
+          {
+          }
+
+          inline void DoCalculateDensityMomentumFeq(HydroVars<Regularised>& hydroVars, site_t index)
+          {
+            LatticeType::CalculateDensityMomentumFEq(hydroVars.f,
+                                                     hydroVars.density,
+                                                     hydroVars.momentum.x,
+                                                     hydroVars.momentum.y,
+                                                     hydroVars.momentum.z,
+                                                     hydroVars.velocity.x,
+                                                     hydroVars.velocity.y,
+                                                     hydroVars.velocity.z,
+                                                     hydroVars.f_eq.f);
+
+            for (unsigned int ii = 0; ii < LatticeType::NUMVECTORS; ++ii)
+            {
+              hydroVars.f_neq.f[ii] = hydroVars.f[ii] - hydroVars.f_eq.f[ii];
+            }
+          }
+
+          inline void DoCalculateFeq(HydroVars<Regularised>& hydroVars, site_t index)
+          {
+            LatticeType::CalculateFeq(hydroVars.density,
+                                      hydroVars.momentum.x,
+                                      hydroVars.momentum.y,
+                                      hydroVars.momentum.z,
+                                      hydroVars.f_eq.f);
+
+            for (unsigned int ii = 0; ii < LatticeType::NUMVECTORS; ++ii)
+            {
+              hydroVars.f_neq.f[ii] = hydroVars.f[ii] - hydroVars.f_eq.f[ii];
+            }
+          }
+
+          inline void DoCollide(const LbmParameters* const lbmParams,
+                                HydroVars<Regularised>& hydroVars)
+          {
+            const lattices::SecondMoment& pi = hydroVars.fNeqMoment =
+                LatticeType::CalculateSecondMoment(hydroVars.f_neq.f);
+            hydroVars.fNeqMomentKnown = true;
+
+            const distribn_t cs2Trace = (pi.xx + pi.yy + pi.zz) / 3.0;
+            // w_i / (2 cs^4) = w_i / (6 cs^6) = 4.5 w_i, relaxed by 1 - 1 / tau.
+            const distribn_t scale = 4.5 * (1.0 + lbmParams->GetOmega());
+
+            // Pi_neq u and 3 u, for the third-order terms.
+            const util::Vector3D<distribn_t>& u = hydroVars.velocity;
+            const distribn_t piUX = pi.xx * u.x + pi.xy * u.y + pi.xz * u.z;
+            const distribn_t piUY = pi.xy * u.x + pi.yy * u.y + pi.yz * u.z;
+            const distribn_t piUZ = pi.xz * u.x + pi.yz * u.y + pi.zz * u.z;
+            const distribn_t threeUX = 3.0 * u.x, threeUY = 3.0 * u.y, threeUZ = 3.0 * u.z;
+
+            HEMELB_UNROLL_DIRECTIONS
+            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+            {
+              const int cx = LatticeType::CX[direction];
+              const int cy = LatticeType::CY[direction];
+              const int cz = LatticeType::CZ[direction];
+
+              // H2_i : Pi_neq = c_i . Pi_neq . c_i - cs^2 tr(Pi_neq)
+              distribn_t projection = -cs2Trace;
+              LatticeType::AddTimesComponent(projection, pi.xx, cx * cx);
+              LatticeType::AddTimesComponent(projection, pi.yy, cy * cy);
+              LatticeType::AddTimesComponent(projection, pi.zz, cz * cz);
+              LatticeType::AddTimesComponent(projection, 2.0 * pi.xy, cx * cy);
+              LatticeType::AddTimesComponent(projection, 2.0 * pi.xz, cx * cz);
+              LatticeType::AddTimesComponent(projection, 2.0 * pi.yz, cy * cz);
+
+              if (tThirdOrder)
+              {
+                // H3_i : a3_neq = 3 (c_i . u) (H2_i : Pi_neq) - 2 c_i . Pi_neq u, with the same
+                // weight as the second-order term
+                distribn_t onePlusThreeCDotU = 1.0;
+                distribn_t twoCDotPiU = 0.0;
+                LatticeType::AddTimesComponent(onePlusThreeCDotU, threeUX, cx);
+                LatticeType::AddTimesComponent(onePlusThreeCDotU, threeUY, cy);
+                LatticeType::AddTimesComponent(onePlusThreeCDotU, threeUZ, cz);
+                LatticeType::AddTimesComponent(twoCDotPiU, 2.0 * piUX, cx);
+                LatticeType::AddTimesComponent(twoCDotPiU, 2.0 * piUY, cy);
+                LatticeType::AddTimesComponent(twoCDotPiU, 2.0 * piUZ, cz);
+                projection = projection * onePlusThreeCDotU - twoCDotPiU;
+              }
+
+              hydroVars.SetFPostCollision(direction,
+                                          hydroVars.f_eq.f[direction]
+                                              + scale * LatticeType::EQMWEIGHTS[direction]
+                                                  * projection);
+            }
+          }
+
+      };
+
+    }
+  }
+}
+
+#endif /* HEMELB_LB_KERNELS_REGULARISED_H */
@@ -22,29 +22,51 @@ namespace hemelb
     {
       /**
        * TRT: This class implements a two-relaxation time kernel.
+       *
+       * The collision relaxes the parts of f_neq symmetric and antisymmetric under swapping
+       * opposite directions at different rates, so it works through the directions a pair of
+       * opposites at a time. Every lattice we have numbers the rest direction 0 and puts each
+       * direction next to its opposite, so the pairs are (1, 2), (3, 4), ... and the pair loop
+       * has a fixed trip count and indices known at compile time. For a lattice numbered
+       * otherwise, the pairs are looked up.
        */
       template<class LatticeType>
       class TRT : public BaseKernel<TRT<LatticeType>, LatticeType>
       {
-          // Store the directions as pairs of opposites
-          // (Note that the zero vector is it's own opposite)
+          static const unsigned NUMPAIRS = (LatticeType::NUMVECTORS - 1) / 2;
+
+          // Store the directions as pairs of opposites, not including the zero vector
+          // (which is it's own opposite)
           typedef std::pair<Direction, Direction> Opposites;
-          typedef std::vector<Opposites> OppList;
-          OppList directionPairs;
+          Opposites directionPairs[NUMPAIRS];
           Direction iZero;
+          //! Whether the rest direction is 0 and each pair is (2p + 1, 2p + 2)
+          bool adjacentOpposites;
+
+          //! Half the relaxation rates of the symmetric and antisymmetric parts
+          distribn_t halfOmegaPlus;
+          distribn_t halfOmegaMinus;
 
         public:
-          TRT(InitParams& initParams)
+          TRT(InitParams& initParams) :
+              iZero(0), adjacentOpposites(true)
           {
+            SetRelaxationRates(initParams.lbmParams);
+
+            unsigned pair = 0;
             for (Direction i = 0; i < LatticeType::NUMVECTORS; ++i)
             {
               Direction iBar = LatticeType::INVERSEDIRECTIONS[i];
               if (i == iBar)
                 iZero = i;
-
-              if (iBar >= i)
-                directionPairs.push_back(std::make_pair(i, iBar));
+              else if (iBar > i)
+              {
+                directionPairs[pair] = std::make_pair(i, iBar);
+                adjacentOpposites = adjacentOpposites && i == 2 * pair + 1 && iBar == 2 * pair + 2;
+                ++pair;
+              }
             }
+            adjacentOpposites = adjacentOpposites && iZero == 0;
           }
 
           inline void DoCalculateDensityMomentumFeq(HydroVars<TRT<LatticeType> >& hydroVars, site_t index)
@@ -80,6 +102,40 @@ namespace hemelb
           }
 
           inline void DoCollide(const LbmParameters* const lbmParams, HydroVars<TRT>& hydroVars)
+          {
+            // Special case the null velocity.
+            hydroVars.SetFPostCollision(iZero,
+                                        hydroVars.f[iZero] + 2.0 * halfOmegaPlus * hydroVars.f_neq.f[iZero]);
+
+            // Now deal with the non-zero
+            if (adjacentOpposites)
+            {
+              for (unsigned pair = 0; pair < NUMPAIRS; ++pair)
+              {
+                CollidePair(hydroVars, 2 * pair + 1, 2 * pair + 2);
+              }
+            }
+            else
+            {
+              for (unsigned pair = 0; pair < NUMPAIRS; ++pair)
+              {
+                CollidePair(hydroVars, directionPairs[pair].first, directionPairs[pair].second);
+              }
+            }
+          }
+
+        private:
+          inline void CollidePair(HydroVars<TRT>& hydroVars, const Direction i, const Direction iBar) const
+          {
+            const distribn_t fNeq = hydroVars.f_neq.f[i];
+            const distribn_t fNeqBar = hydroVars.f_neq.f[iBar];
+            const distribn_t sym = halfOmegaPlus * (fNeq + fNeqBar);
+            const distribn_t asym = halfOmegaMinus * (fNeq - fNeqBar);
+            hydroVars.SetFPostCollision(i, hydroVars.f[i] + sym + asym);
+            hydroVars.SetFPostCollision(iBar, hydroVars.f[iBar] + sym - asym);
+          }
+
+          void SetRelaxationRates(const LbmParameters* const lbmParams)
           {
             // Note HemeLB defines omega = -1/ tau
             // Magic number determines the other relaxation time
@@ -89,27 +145,9 @@ namespace hemelb
             const distribn_t Lambda = 3.0 / 16.0;
 
             const distribn_t tau_plus = lbmParams->GetTau();
-            const distribn_t omega_plus = lbmParams->GetOmega();
             const distribn_t tau_minus = 0.5 + Lambda / (tau_plus - 0.5);
-            const distribn_t omega_minus =  -1.0 / tau_minus;
-
-            // Special case the null velocity.
-            hydroVars.SetFPostCollision(iZero,
-                                        hydroVars.f[iZero] + omega_plus * hydroVars.f_neq.f[iZero]);
-
-            // Now deal with the non-zero
-            for (OppList::const_iterator oppIt = directionPairs.begin();
-                oppIt != directionPairs.end();
-                ++oppIt)
-            {
-              const Direction& i = oppIt->first;
-              const Direction& iBar = oppIt->second;
-
-              distribn_t sym = 0.5 * omega_plus * (hydroVars.f_neq.f[i] + hydroVars.f_neq.f[iBar]);
-              distribn_t asym = 0.5 * omega_minus * (hydroVars.f_neq.f[i] - hydroVars.f_neq.f[iBar]);
-              hydroVars.SetFPostCollision(i, hydroVars.f[i] + sym + asym);
-              hydroVars.SetFPostCollision(iBar, hydroVars.f[iBar] + sym - asym);
-            }
+            halfOmegaPlus = 0.5 * lbmParams->GetOmega();
+            halfOmegaMinus = 0.5 * (-1.0 / tau_minus);
           }
 
       };
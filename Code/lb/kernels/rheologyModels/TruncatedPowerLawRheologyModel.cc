@@ -6,6 +6,7 @@
 
 #include "lb/kernels/rheologyModels/TruncatedPowerLawRheologyModel.h"
 #include "util/utilityFunctions.h"
+#include <cmath>
 
 namespace hemelb
 {
@@ -20,7 +21,10 @@ namespace hemelb
         {
           // Don't allow shear rates outside [GAMMA_ZERO, GAMMA_INF]
           double gamma = util::NumericalFunctions::enforceBounds(iShearRate, GAMMA_ZERO, GAMMA_INF);
-          double eta = M_CONSTANT * pow(gamma, N_CONSTANT - 1);
+          // With n = 1/2, gamma^(n-1) is a reciprocal square root, which is much cheaper than pow.
+          double eta = M_CONSTANT * (N_CONSTANT == 0.5 ?
+            1.0 / sqrt(gamma) :
+            pow(gamma, N_CONSTANT - 1));
 
           // TODO Investigate whether we should be using BLOOD_DENSITY_Kg_per_m3*iDensity
           double nu = eta / BLOOD_DENSITY_Kg_per_m3;
@@ -15,19 +15,18 @@ namespace hemelb
       template<>
       lb::lattices::LatticeInfo* lb::lattices::Lattice<D3Q15>::singletonInfo = NULL;
            
-      const int D3Q15::CX[] = { 0, 1, -1, 0, 0, 0, 0, 1, -1, 1, -1, 1, -1, 1, -1 };
-      const int D3Q15::CY[] = { 0, 0, 0, 1, -1, 0, 0, 1, -1, 1, -1, -1, 1, -1, 1 };
-      const int D3Q15::CZ[] = { 0, 0, 0, 0, 0, 1, -1, 1, -1, -1, 1, 1, -1, -1, 1 };
+      constexpr int D3Q15::CX[];
+      constexpr int D3Q15::CY[];
+      constexpr int D3Q15::CZ[];
       const int* D3Q15::discreteVelocityVectors[] = { CX, CY, CZ };
 
-      const distribn_t D3Q15::CXD[] = { 0.0, 1.0, -1.0, 0.0,  0.0, 0.0,  0.0, 1.0, -1.0,  1.0, -1.0,  1.0, -1.0,  1.0, -1.0};
-      const distribn_t D3Q15::CYD[] = { 0.0, 0.0,  0.0, 1.0, -1.0, 0.0,  0.0, 1.0, -1.0,  1.0, -1.0, -1.0,  1.0, -1.0,  1.0};
-      const distribn_t D3Q15::CZD[] = { 0.0, 0.0,  0.0, 0.0,  0.0, 1.0, -1.0, 1.0, -1.0, -1.0,  1.0,  1.0, -1.0, -1.0,  1.0};            
+      constexpr distribn_t D3Q15::CXD[];
+      constexpr distribn_t D3Q15::CYD[];
+      constexpr distribn_t D3Q15::CZD[];
       
-      const distribn_t D3Q15::EQMWEIGHTS[] = { 2.0 / 9.0, 1.0 / 9.0, 1.0 / 9.0, 1.0 / 9.0, 1.0 / 9.0, 1.0 / 9.0, 1.0
-          / 9.0, 1.0 / 72.0, 1.0 / 72.0, 1.0 / 72.0, 1.0 / 72.0, 1.0 / 72.0, 1.0 / 72.0, 1.0 / 72.0, 1.0 / 72.0 };
+      constexpr distribn_t D3Q15::EQMWEIGHTS[];
 
-      const Direction D3Q15::INVERSEDIRECTIONS[] = { 0, 2, 1, 4, 3, 6, 5, 8, 7, 10, 9, 12, 11, 14, 13 };
+      constexpr Direction D3Q15::INVERSEDIRECTIONS[];
     }
   }
 }
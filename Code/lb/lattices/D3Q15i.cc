@@ -14,21 +14,18 @@ namespace hemelb
       template<>
       lb::lattices::LatticeInfo* lb::lattices::Lattice<D3Q15i>::singletonInfo = NULL;
 
-      const int D3Q15i::CX[] = { 0, 1, -1, 0, 0, 0, 0, 1, -1, 1, -1, 1, -1, 1, -1 };
-      const int D3Q15i::CY[] = { 0, 0, 0, 1, -1, 0, 0, 1, -1, 1, -1, -1, 1, -1, 1 };
-      const int D3Q15i::CZ[] = { 0, 0, 0, 0, 0, 1, -1, 1, -1, -1, 1, 1, -1, -1, 1 };
+      constexpr int D3Q15i::CX[];
+      constexpr int D3Q15i::CY[];
+      constexpr int D3Q15i::CZ[];
       const int* D3Q15i::discreteVelocityVectors[] = { CX, CY, CZ };
       
-      const distribn_t D3Q15i::CXD[] = { 0.0, 1.0, -1.0, 0.0,  0.0, 0.0,  0.0, 1.0, -1.0,  1.0, -1.0,  1.0, -1.0,  1.0, -1.0 };
-      const distribn_t D3Q15i::CYD[] = { 0.0, 0.0,  0.0, 1.0, -1.0, 0.0,  0.0, 1.0, -1.0,  1.0, -1.0, -1.0,  1.0, -1.0,  1.0 };
-      const distribn_t D3Q15i::CZD[] = { 0.0, 0.0,  0.0, 0.0,  0.0, 1.0, -1.0, 1.0, -1.0, -1.0,  1.0,  1.0, -1.0, -1.0,  1.0 };
+      constexpr distribn_t D3Q15i::CXD[];
+      constexpr distribn_t D3Q15i::CYD[];
+      constexpr distribn_t D3Q15i::CZD[];
 
-      const distribn_t D3Q15i::EQMWEIGHTS[] = { 2.0 / 9.0, 1.0 / 9.0, 1.0 / 9.0, 1.0 / 9.0, 1.0 / 9.0, 1.0 / 9.0, 1.0
-                                                    / 9.0,
-                                                1.0 / 72.0, 1.0 / 72.0, 1.0 / 72.0, 1.0 / 72.0, 1.0 / 72.0, 1.0 / 72.0,
-                                                1.0 / 72.0, 1.0 / 72.0 };
+      constexpr distribn_t D3Q15i::EQMWEIGHTS[];
 
-      const Direction D3Q15i::INVERSEDIRECTIONS[] = { 0, 2, 1, 4, 3, 6, 5, 8, 7, 10, 9, 12, 11, 14, 13 };
+      constexpr Direction D3Q15i::INVERSEDIRECTIONS[];
     } /* namespace lattices */
   } /* namespace lb */
 } /* namespace hemelb */
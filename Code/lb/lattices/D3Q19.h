@@ -22,22 +22,35 @@ namespace hemelb
           static const Direction NUMVECTORS = 19;
 
           // The x, y and z components of each of the discrete velocity vectors
-          static const int CX[NUMVECTORS];
-          static const int CY[NUMVECTORS];
-          static const int CZ[NUMVECTORS];
+          static constexpr int CX[NUMVECTORS] =
+              { 0, 1, -1, 0, 0, 0, 0, 1, -1, 1, -1, 1, -1, 1, -1, 0, 0, 0, 0 };
+          static constexpr int CY[NUMVECTORS] =
+              { 0, 0, 0, 1, -1, 0, 0, 1, -1, -1, 1, 0, 0, 0, 0, 1, -1, 1, -1 };
+          static constexpr int CZ[NUMVECTORS] =
+              { 0, 0, 0, 0, 0, 1, -1, 0, 0, 0, 0, 1, -1, -1, 1, 1, -1, -1, 1 };
           
           // the same in double (in order to prevent int->double conversions), and aligned to 16B
-          static const distribn_t CXD[NUMVECTORS] __attribute__((aligned(16)));
-          static const distribn_t CYD[NUMVECTORS] __attribute__((aligned(16)));
-          static const distribn_t CZD[NUMVECTORS] __attribute__((aligned(16)));
+          static constexpr distribn_t CXD[NUMVECTORS] __attribute__((aligned(16))) =
+              { 0.0, 1.0, -1.0, 0.0, 0.0, 0.0, 0.0, 1.0, -1.0, 1.0, -1.0, 1.0, -1.0, 1.0, -1.0, 0.0, 0.0,
+                0.0, 0.0 };
+          static constexpr distribn_t CYD[NUMVECTORS] __attribute__((aligned(16))) =
+              { 0.0, 0.0, 0.0, 1.0, -1.0, 0.0, 0.0, 1.0, -1.0, -1.0, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0, -1.0,
+                1.0, -1.0 };
+          static constexpr distribn_t CZD[NUMVECTORS] __attribute__((aligned(16))) =
+              { 0.0, 0.0, 0.0, 0.0, 0.0, 1.0, -1.0, 0.0, 0.0, 0.0, 0.0, 1.0, -1.0, -1.0, 1.0, 1.0, -1.0,
+                -1.0, 1.0 };
 
           
           static const int* discreteVelocityVectors[3];
 
-          static const double EQMWEIGHTS[NUMVECTORS] __attribute__((aligned(16)));
+          static constexpr distribn_t EQMWEIGHTS[NUMVECTORS] __attribute__((aligned(16))) =
+              { 1.0 / 3.0, 1.0 / 18.0, 1.0 / 18.0, 1.0 / 18.0, 1.0 / 18.0, 1.0 / 18.0, 1.0 / 18.0,
+                1.0 / 36.0, 1.0 / 36.0, 1.0 / 36.0, 1.0 / 36.0, 1.0 / 36.0, 1.0 / 36.0, 1.0 / 36.0,
+                1.0 / 36.0, 1.0 / 36.0, 1.0 / 36.0, 1.0 / 36.0, 1.0 / 36.0 };
 
           // The index of the inverse direction of each discrete velocity vector
-          static const Direction INVERSEDIRECTIONS[NUMVECTORS];
+          static constexpr Direction INVERSEDIRECTIONS[NUMVECTORS] =
+              { 0, 2, 1, 4, 3, 6, 5, 8, 7, 10, 9, 12, 11, 14, 13, 16, 15, 18, 17 };
       };
     }
   }
@@ -28,10 +28,13 @@ namespace hemelb
             const distribn_t momentumMagnitudeSquared = momentum_x * momentum_x + momentum_y * momentum_y
                 + momentum_z * momentum_z;
 
+            HEMELB_UNROLL_DIRECTIONS
             for (Direction i = 0; i < DmQn::NUMVECTORS; ++i)
             {
-              const distribn_t mom_dot_ei = DmQn::CX[i] * momentum_x + DmQn::CY[i] * momentum_y
-                  + DmQn::CZ[i] * momentum_z;
+              const distribn_t mom_dot_ei = Lattice<DmQn>::DotWithVelocity(i,
+                                                                           momentum_x,
+                                                                           momentum_y,
+                                                                           momentum_z);
 
               f_eq[i] = DmQn::EQMWEIGHTS[i]
                   * (density - (3. / 2.) * momentumMagnitudeSquared + (9. / 2.) * mom_dot_ei * mom_dot_ei
@@ -18,17 +18,81 @@
 #include "util/Vector3D.h"
 #include "util/Matrix3D.h"
 
+/**
+ * Fully unrolls the loop over the directions that follows. The lattices' velocities and weights
+ * are constexpr, so in the unrolled loop the compiler knows them and can fold them away. Compilers
+ * leave loops of more than a few iterations rolled without being asked.
+ */
+#if defined(__clang__)
+#define HEMELB_UNROLL_DIRECTIONS _Pragma("clang loop unroll(full)")
+#elif defined(__GNUC__) && __GNUC__ >= 8
+#define HEMELB_UNROLL_DIRECTIONS _Pragma("GCC unroll 32")
+#else
+#define HEMELB_UNROLL_DIRECTIONS
+#endif
+
 namespace hemelb
 {
   namespace lb
   {
     namespace lattices
     {
+      /**
+       * The six distinct components of the second moment of a distribution,
+       * sum_l f_l c_li c_lj (see Lattice::CalculatePiTensor). Every stress property is made from
+       * the second moment of f_neq, so a site's is found once and shared between them.
+       */
+      struct SecondMoment
+      {
+          distribn_t xx, yy, zz, xy, xz, yz;
+      };
+
       template<class DmQn>
       class Lattice
       {
         public:
-          
+          /**
+           * Adds a value times a velocity component, or a product of them, to a sum. These are
+           * all -1, 0 or 1, so in a loop over the directions that has been unrolled, where the
+           * compiler knows the component, this is just an add, a subtract or nothing. (The
+           * compiler may not take a multiply by 0.0 out itself, as the product might be -0.0 or
+           * NaN.)
+           * @param sum
+           * @param value
+           * @param component
+           */
+          inline static void AddTimesComponent(distribn_t& sum, distribn_t value, int component)
+          {
+            if (component > 0)
+            {
+              sum += value;
+            }
+            else if (component < 0)
+            {
+              sum -= value;
+            }
+          }
+
+          /**
+           * @param direction
+           * @param x
+           * @param y
+           * @param z
+           * @return The dot product of the direction's velocity with the vector (x, y, z), as a
+           * sparse sum once the direction is known.
+           */
+          inline static distribn_t DotWithVelocity(Direction direction, distribn_t x, distribn_t y,
+                                                   distribn_t z)
+          {
+            // Adding to -0.0 gives back exactly what was added, so the compiler can drop the
+            // first add; it can't for 0.0.
+            distribn_t dot = -0.0;
+            AddTimesComponent(dot, x, DmQn::CX[direction]);
+            AddTimesComponent(dot, y, DmQn::CY[direction]);
+            AddTimesComponent(dot, z, DmQn::CZ[direction]);
+            return dot;
+          }
+
          #ifdef HEMELB_USE_SSE3
           /**
            * Calculates density and momentum using SSE3 intrinsics.
@@ -123,12 +187,13 @@ namespace hemelb
           {
             density = momentum_x = momentum_y = momentum_z = 0.0;
 
+            HEMELB_UNROLL_DIRECTIONS
             for (Direction direction = 0; direction < DmQn::NUMVECTORS; ++direction)
             {
               density += f[direction];
-              momentum_x += DmQn::CX[direction] * f[direction];
-              momentum_y += DmQn::CY[direction] * f[direction];
-              momentum_z += DmQn::CZ[direction] * f[direction];
+              AddTimesComponent(momentum_x, f[direction], DmQn::CX[direction]);
+              AddTimesComponent(momentum_y, f[direction], DmQn::CY[direction]);
+              AddTimesComponent(momentum_z, f[direction], DmQn::CZ[direction]);
             }
           }
           #endif                   
@@ -249,10 +314,10 @@ namespace hemelb
             const distribn_t momentumMagnitudeSquared = momentum_x * momentum_x + momentum_y * momentum_y
                 + momentum_z * momentum_z;
 
+            HEMELB_UNROLL_DIRECTIONS
             for (Direction i = 0; i < DmQn::NUMVECTORS; ++i)
             {
-              const distribn_t mom_dot_ei = DmQn::CX[i] * momentum_x
-                  + DmQn::CY[i] * momentum_y + DmQn::CZ[i] * momentum_z;
+              const distribn_t mom_dot_ei = DotWithVelocity(i, momentum_x, momentum_y, momentum_z);
 
               f_eq[i] = DmQn::EQMWEIGHTS[i]
                   * (density - (3. / 2.) * momentumMagnitudeSquared * density_1
@@ -286,44 +351,52 @@ namespace hemelb
             CalculateFeq(density, momentum_x, momentum_y, momentum_z, f_eq);
           }
 
+          /**
+           * The six distinct components of the second moment of f, in a single pass over the
+           * directions.
+           * @param f
+           * @return
+           */
+          inline static SecondMoment CalculateSecondMoment(const distribn_t f[])
+          {
+            SecondMoment moment = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+
+            HEMELB_UNROLL_DIRECTIONS
+            for (Direction direction = 0; direction < DmQn::NUMVECTORS; ++direction)
+            {
+              const int cx = DmQn::CX[direction];
+              const int cy = DmQn::CY[direction];
+              const int cz = DmQn::CZ[direction];
+              AddTimesComponent(moment.xx, f[direction], cx * cx);
+              AddTimesComponent(moment.yy, f[direction], cy * cy);
+              AddTimesComponent(moment.zz, f[direction], cz * cz);
+              AddTimesComponent(moment.xy, f[direction], cx * cy);
+              AddTimesComponent(moment.xz, f[direction], cx * cz);
+              AddTimesComponent(moment.yz, f[direction], cy * cz);
+            }
+            return moment;
+          }
+
           // von Mises stress computation given the non-equilibrium distribution functions.
           inline static void CalculateVonMisesStress(const distribn_t f[],
                                                      distribn_t &stress,
                                                      const double iStressParameter)
           {
-            // Recall that sigma_ij = Sum_l f(l) * C_il * C_jl
-
-            // First calculate sigma_xx - sigma_yy.
-            // Using standard form of sigma_ij, sigma_xx - sigma_yy
-            //   = Sum_l f(l) * (Cx(l) * Cx(l) - Cy(l) * Cy(l))
-            // We calculate sigma_yy - sigma_zz and sigma_xx and sigma_zz
-            // in the same way.
-            distribn_t sigma_xx_yy = 0.0;
-            distribn_t sigma_yy_zz = 0.0;
-            distribn_t sigma_xx_zz = 0.0;
-
-            // We will also require sigma_xy, sigma_yz and sigma_xz, calculated in the usual
-            // way.
-            distribn_t sigma_xy = 0.0;
-            distribn_t sigma_xz = 0.0;
-            distribn_t sigma_yz = 0.0;
+            CalculateVonMisesStress(CalculateSecondMoment(f), stress, iStressParameter);
+          }
 
-            for (Direction direction = 0; direction < DmQn::NUMVECTORS; ++direction)
-            {
-              sigma_xx_yy += f[direction]
-                  * (DmQn::CX[direction] * DmQn::CX[direction] - DmQn::CY[direction] * DmQn::CY[direction]);
-              sigma_yy_zz += f[direction]
-                  * (DmQn::CY[direction] * DmQn::CY[direction] - DmQn::CZ[direction] * DmQn::CZ[direction]);
-              sigma_xx_zz += f[direction]
-                  * (DmQn::CX[direction] * DmQn::CX[direction] - DmQn::CZ[direction] * DmQn::CZ[direction]);
-
-              sigma_xy += f[direction] * DmQn::CX[direction] * DmQn::CY[direction];
-              sigma_xz += f[direction] * DmQn::CX[direction] * DmQn::CZ[direction];
-              sigma_yz += f[direction] * DmQn::CY[direction] * DmQn::CZ[direction];
-            }
+          // von Mises stress computation given the second moment of the non-equilibrium
+          // distribution functions, sigma_ij = Sum_l f(l) * C_il * C_jl.
+          inline static void CalculateVonMisesStress(const SecondMoment& sigma,
+                                                     distribn_t &stress,
+                                                     const double iStressParameter)
+          {
+            const distribn_t sigma_xx_yy = sigma.xx - sigma.yy;
+            const distribn_t sigma_yy_zz = sigma.yy - sigma.zz;
+            const distribn_t sigma_xx_zz = sigma.xx - sigma.zz;
 
             distribn_t a = sigma_xx_yy * sigma_xx_yy + sigma_yy_zz * sigma_yy_zz + sigma_xx_zz * sigma_xx_zz;
-            distribn_t b = sigma_xy * sigma_xy + sigma_xz * sigma_xz + sigma_yz * sigma_yz;
+            distribn_t b = sigma.xy * sigma.xy + sigma.xz * sigma.xz + sigma.yz * sigma.yz;
 
             stress = iStressParameter * sqrt(a + 6.0 * b);
           }
@@ -346,11 +419,13 @@ namespace hemelb
                                                        const util::Vector3D<Dimensionless>& wallNormal,
                                                        util::Vector3D<LatticeStress>& traction)
           {
-            util::Matrix3D sigma;
-            CalculateStressTensor(density, tau, fNonEquilibrium, sigma);
-
-            // Multiply the stress tensor by the surface normal
-            sigma.timesVector(wallNormal, traction);
+            CalculateStressProperties(density,
+                                      tau,
+                                      CalculateSecondMoment(fNonEquilibrium),
+                                      wallNormal,
+                                      NULL,
+                                      &traction,
+                                      NULL);
           }
 
           /**
@@ -373,12 +448,13 @@ namespace hemelb
                                                                    const util::Vector3D<Dimensionless>& wallNormal,
                                                                    util::Vector3D<LatticeStress>& tractionTangentialComponent)
           {
-            util::Vector3D<LatticeStress> traction;
-            CalculateTractionOnAPoint(density, tau, fNonEquilibrium, wallNormal, traction);
-
-            LatticeStress magnitudeNormalProjectionTraction = traction.Dot(wallNormal);
-
-            tractionTangentialComponent = traction - wallNormal * magnitudeNormalProjectionTraction;
+            CalculateStressProperties(density,
+                                      tau,
+                                      CalculateSecondMoment(fNonEquilibrium),
+                                      wallNormal,
+                                      NULL,
+                                      NULL,
+                                      &tractionTangentialComponent);
           }
 
           /**
@@ -407,16 +483,87 @@ namespace hemelb
                                                    const distribn_t fNonEquilibrium[],
                                                    util::Matrix3D& stressTensor)
           {
-            // Initialises the stress tensor to the deviatoric part, i.e. -\Pi^{(neq)}
-            stressTensor = CalculatePiTensor(fNonEquilibrium);
-            stressTensor *= 1 - 1 / (2 * tau);
-
-            // Add the pressure component to the stress tensor. The reference pressure given
-            // by the REFERENCE_PRESSURE_mmHg constant is mapped to rho=1. Here we subtract 1
-            // and when the tensor is turned into physical units REFERENCE_PRESSURE_mmHg will
-            // be added.
-            LatticePressure pressure = (density - 1) * Cs2;
-            stressTensor.addDiagonal(pressure);
+            CalculateStressProperties(density,
+                                      tau,
+                                      CalculateSecondMoment(fNonEquilibrium),
+                                      util::Vector3D<Dimensionless>::Zero(),
+                                      &stressTensor,
+                                      NULL,
+                                      NULL);
+          }
+
+          /**
+           * Calculate any of the full stress tensor, the traction vector and its projection on
+           * the wall's tangential plane (see CalculateStressTensor, CalculateTractionOnAPoint and
+           * CalculateTangentialProjectionTraction) together, from the second moment of f_neq,
+           * without going through temporary matrices. Pass NULL for those not wanted.
+           *
+           * @param density density at a given site
+           * @param tau relaxation time
+           * @param piNonEquilibrium second moment of the non equilibrium distribution function
+           * @param wallNormal wall normal at a given point; ignored if no traction is wanted
+           * @param stressTensor full stress tensor at a given site
+           * @param traction traction vector at a given point
+           * @param tractionTangentialComponent tangential projection of the traction vector
+           */
+          inline static void CalculateStressProperties(const distribn_t density,
+                                                       const distribn_t tau,
+                                                       const SecondMoment& piNonEquilibrium,
+                                                       const util::Vector3D<Dimensionless>& wallNormal,
+                                                       util::Matrix3D* stressTensor,
+                                                       util::Vector3D<LatticeStress>* traction,
+                                                       util::Vector3D<LatticeStress>* tractionTangentialComponent)
+          {
+            // The deviatoric part, i.e. -\Pi^{(neq)}, plus the pressure component on the
+            // diagonal. The reference pressure given by the REFERENCE_PRESSURE_mmHg constant is
+            // mapped to rho=1. Here we subtract 1 and when the tensor is turned into physical
+            // units REFERENCE_PRESSURE_mmHg will be added.
+            const distribn_t factor = 1 - 1 / (2 * tau);
+            const LatticePressure pressure = (density - 1) * Cs2;
+            const LatticeStress xx = piNonEquilibrium.xx * factor + pressure;
+            const LatticeStress yy = piNonEquilibrium.yy * factor + pressure;
+            const LatticeStress zz = piNonEquilibrium.zz * factor + pressure;
+            const LatticeStress xy = piNonEquilibrium.xy * factor;
+            const LatticeStress xz = piNonEquilibrium.xz * factor;
+            const LatticeStress yz = piNonEquilibrium.yz * factor;
+
+            if (stressTensor != NULL)
+            {
+              (*stressTensor)[0][0] = xx;
+              (*stressTensor)[0][1] = xy;
+              (*stressTensor)[0][2] = xz;
+              (*stressTensor)[1][0] = xy;
+              (*stressTensor)[1][1] = yy;
+              (*stressTensor)[1][2] = yz;
+              (*stressTensor)[2][0] = xz;
+              (*stressTensor)[2][1] = yz;
+              (*stressTensor)[2][2] = zz;
+            }
+
+            if (traction == NULL && tractionTangentialComponent == NULL)
+            {
+              return;
+            }
+
+            // Multiply the stress tensor by the surface normal
+            const LatticeStress tx = xx * wallNormal.x + xy * wallNormal.y + xz * wallNormal.z;
+            const LatticeStress ty = xy * wallNormal.x + yy * wallNormal.y + yz * wallNormal.z;
+            const LatticeStress tz = xz * wallNormal.x + yz * wallNormal.y + zz * wallNormal.z;
+            if (traction != NULL)
+            {
+              traction->x = tx;
+              traction->y = ty;
+              traction->z = tz;
+            }
+
+            if (tractionTangentialComponent != NULL)
+            {
+              const LatticeStress magnitudeNormalProjectionTraction = tx * wallNormal.x
+                  + ty * wallNormal.y + tz * wallNormal.z;
+              tractionTangentialComponent->x = tx - wallNormal.x * magnitudeNormalProjectionTraction;
+              tractionTangentialComponent->y = ty - wallNormal.y * magnitudeNormalProjectionTraction;
+              tractionTangentialComponent->z = tz - wallNormal.z * magnitudeNormalProjectionTraction;
+            }
           }
 
           /**
@@ -435,35 +582,31 @@ namespace hemelb
                                                                distribn_t &stress,
                                                                const double &iStressParameter)
           {
-            // sigma_ij is the force
-            // per unit area in
-            // direction i on the
-            // plane with the normal
-            // in direction j
-            distribn_t stress_vector[] = { 0.0, 0.0, 0.0 }; // Force per unit area in
-            // direction i on the
-            // plane perpendicular to
-            // the surface normal
-            distribn_t square_stress_vector = 0.0;
-            distribn_t normal_stress = 0.0; // Magnitude of force per
-            // unit area normal to the
-            // surface
+            CalculateWallShearStressMagnitude(CalculateSecondMoment(f), nor, stress, iStressParameter);
+          }
 
+          /**
+           * As above, given the second moment of the non equilibrium distribution function.
+           */
+          inline static void CalculateWallShearStressMagnitude(const SecondMoment& pi,
+                                                               const util::Vector3D<double>& nor,
+                                                               distribn_t &stress,
+                                                               const double &iStressParameter)
+          {
             // Multiplying the second moment of the non equilibrium function by temp gives the non equilibrium part
             // of the moment flux tensor pi.
-            distribn_t temp = iStressParameter * (-sqrt(2.0));
+            const distribn_t temp = iStressParameter * (-sqrt(2.0));
 
-            // Computes the second moment of the equilibrium function f.
-            util::Matrix3D pi = CalculatePiTensor(f);
+            // Force per unit area in direction i on the plane perpendicular to the surface normal
+            const distribn_t stress_x = (pi.xx * nor.x + pi.xy * nor.y + pi.xz * nor.z) * temp;
+            const distribn_t stress_y = (pi.xy * nor.x + pi.yy * nor.y + pi.yz * nor.z) * temp;
+            const distribn_t stress_z = (pi.xz * nor.x + pi.yz * nor.y + pi.zz * nor.z) * temp;
 
-            for (unsigned i = 0; i < 3; i++)
-            {
-              for (unsigned j = 0; j < 3; j++)
-                stress_vector[i] += pi[i][j] * nor[j] * temp;
+            const distribn_t square_stress_vector = stress_x * stress_x + stress_y * stress_y
+                + stress_z * stress_z;
+            // Magnitude of force per unit area normal to the surface
+            const distribn_t normal_stress = stress_x * nor.x + stress_y * nor.y + stress_z * nor.z;
 
-              square_stress_vector += stress_vector[i] * stress_vector[i];
-              normal_stress += stress_vector[i] * nor[i];
-            }
             // shear_stress^2 + normal_stress^2 = stress_vector^2
             stress = sqrt(square_stress_vector - normal_stress * normal_stress);
           }
@@ -506,29 +649,31 @@ namespace hemelb
             return ret;
           }
 
+          /**
+           * The shear rate, sqrt(2 S:S), of the strain rate tensor
+           * S_ij = -1 / (2 tau rho Cs2) sum_l f_neq_l c_li c_lj. The six independent components of
+           * the sum are accumulated in a single pass over the directions.
+           */
           inline static distribn_t CalculateShearRate(const distribn_t &iTau,
                                                       const distribn_t iFNeq[],
                                                       const distribn_t &iDensity)
           {
-            distribn_t shear_rate = 0.0;
-            distribn_t strain_rate_tensor_i_j;
-
-            // Take advantage of strain rate tensor symmetry
-            for (unsigned row = 0; row < 3; row++)
-            {
-              strain_rate_tensor_i_j = CalculateStrainRateTensorComponent(row, row, iTau, iFNeq, iDensity);
-              shear_rate += strain_rate_tensor_i_j * strain_rate_tensor_i_j;
-
-              for (unsigned column = row+1; column < 3; column++)
-              {
-                strain_rate_tensor_i_j = CalculateStrainRateTensorComponent(row, column, iTau, iFNeq, iDensity);
-                shear_rate += 2*strain_rate_tensor_i_j * strain_rate_tensor_i_j;
-              }
-            }
+            return CalculateShearRate(iTau, CalculateSecondMoment(iFNeq), iDensity);
+          }
 
-            shear_rate = sqrt(2*shear_rate);
+          /**
+           * As above, given the second moment of f_neq.
+           */
+          inline static distribn_t CalculateShearRate(const distribn_t &iTau,
+                                                      const SecondMoment& moment,
+                                                      const distribn_t &iDensity)
+          {
+            const distribn_t prefactor = -1.0 / (2.0 * iTau * iDensity * Cs2);
+            const distribn_t strainRateSquared = prefactor * prefactor
+                * (moment.xx * moment.xx + moment.yy * moment.yy + moment.zz * moment.zz
+                    + 2.0 * (moment.xy * moment.xy + moment.xz * moment.xz + moment.yz * moment.yz));
 
-            return shear_rate;
+            return sqrt(2.0 * strainRateSquared);
           }
 
           // Entropic ELBM has an analytical form for FEq
@@ -647,7 +792,10 @@ namespace hemelb
                 inverseVectorIndices[direction] = DmQn::INVERSEDIRECTIONS[direction];
               }
 
-              singletonInfo = new LatticeInfo(DmQn::NUMVECTORS, vectors, inverseVectorIndices);
+              singletonInfo = new LatticeInfo(DmQn::NUMVECTORS,
+                                             vectors,
+                                             inverseVectorIndices,
+                                             DmQn::EQMWEIGHTS);
             }
 
             return *singletonInfo;
@@ -659,27 +807,6 @@ namespace hemelb
           }
 
         private:
-          inline static distribn_t CalculateStrainRateTensorComponent(const unsigned &iRow,
-                                                                      const unsigned &iColumn,
-                                                                      const distribn_t &iTau,
-                                                                      const distribn_t iFNeq[],
-                                                                      const distribn_t &iDensity)
-          {
-            distribn_t strain_rate_tensor_i_j = 0.0;
-
-            for (Direction vec_index = 0; vec_index < DmQn::NUMVECTORS; vec_index++)
-            {
-              strain_rate_tensor_i_j +=
-                  iFNeq[vec_index]
-                      * (DmQn::discreteVelocityVectors[iRow][vec_index]
-                          * DmQn::discreteVelocityVectors[iColumn][vec_index]);
-            }
-
-            strain_rate_tensor_i_j *= -1.0 / (2.0 * iTau * iDensity * Cs2);
-
-            return strain_rate_tensor_i_j;
-          }
-
           /**
            * Calculate high order of zeta as defined by equation 10 in Chikatamarla et al (PRL, 97, 010201 (2006)
            * @param velocity
@@ -17,7 +17,9 @@
 #include "configuration/SimConfig.h"
 #include "reporting/Timers.h"
 #include "lb/BuildSystemInterface.h"
+#include "lb/WorkStealingScheduler.h"
 #include <typeinfo>
+#include <algorithm>
 
 namespace hemelb
 {
@@ -37,7 +39,7 @@ namespace hemelb
         // Use the kernel specified through the build system. This will select one of the above classes.
         typedef typename HEMELB_KERNEL<LatticeType>::Type LB_KERNEL;
 
-        typedef streamers::SimpleCollideAndStream<collisions::Normal<LB_KERNEL> > tMidFluidCollision;
+        typedef typename streamers::BulkCollideAndStream<collisions::Normal<LB_KERNEL> >::Type tMidFluidCollision;
         // Use the wall boundary condition specified through the build system.
         typedef typename HEMELB_WALL_BOUNDARY<collisions::Normal<LB_KERNEL> >::Type tWallCollision;
         // Use the inlet BC specified by the build system
@@ -47,6 +49,14 @@ namespace hemelb
         // And again but for sites that are both in-/outlet and wall
         typedef typename HEMELB_WALL_INLET_BOUNDARY<collisions::Normal<LB_KERNEL> >::Type tInletWallCollision;
         typedef typename HEMELB_WALL_OUTLET_BOUNDARY<collisions::Normal<LB_KERNEL> >::Type tOutletWallCollision;
+#ifdef HEMELB_STABILISED_KERNEL
+        // A second kernel, for the bulk sites in the stabilised regions of the configuration.
+        typedef typename streamers::BulkCollideAndStream<
+            collisions::Normal<typename HEMELB_STABILISED_KERNEL<LatticeType>::Type> >::Type tStabilisedMidFluidCollision;
+#else
+        // There are no stabilised sites, so this is never used.
+        typedef tMidFluidCollision tStabilisedMidFluidCollision;
+#endif
 
       public:
         /**
@@ -80,6 +90,19 @@ namespace hemelb
           return outletCount;
         }
 
+        /**
+         * The time this core has spent streaming and colliding the sites of a collision type,
+         * in the order of LatticeData's collision counts, over all the steps so far. The timers
+         * are kept by the Timers, so this includes the time of any LBM before a rebalance.
+         * @param collisionType
+         * @return
+         */
+        double GetCollisionTime(unsigned collisionType) const
+        {
+          return timings[reporting::Timers::CollisionTimer(collisionType, false)].Get()
+              + timings[reporting::Timers::CollisionTimer(collisionType, true)].Get();
+        }
+
         /**
          * Second constructor.
          *
@@ -102,6 +125,16 @@ namespace hemelb
         hemelb::lb::LbmParameters *GetLbmParams();
         lb::MacroscopicPropertyCache& GetPropertyCache();
 
+        /**
+         * Set the weight of a site of each collision type, which the work-stealing scheduler
+         * uses to estimate the cost of its chunks. By default, the compiled-in weights.
+         * @param weights In collision type order
+         */
+        void SetSiteWeights(const std::vector<int>& weights)
+        {
+          siteWeights = weights;
+        }
+
       private:
         void SetInitialConditions();
 
@@ -125,11 +158,163 @@ namespace hemelb
         tOutletCollision* mOutletCollision;
         tInletWallCollision* mInletWallCollision;
         tOutletWallCollision* mOutletWallCollision;
+        tStabilisedMidFluidCollision* mStabilisedMidFluidCollision;
+
+        /**
+         * Stream and collide a range of sites of the given collision type, timing it as that
+         * type. When built with HEMELB_USE_OPENMP, the range is split into contiguous blocks, one
+         * per thread, provided the streamer allows it.
+         */
+        template<typename Collision>
+        void StreamAndCollide(Collision* collision, const unsigned collisionType,
+                              const site_t iFirstIndex, const site_t iSiteCount)
+        {
+          CollisionTimer(collisionType, iFirstIndex).Start();
+#ifdef HEMELB_USE_OPENMP
+          if (streamers::IsThreadSafe<Collision>::value)
+          {
+#pragma omp parallel
+            {
+              site_t threadFirstIndex, threadSiteCount;
+              GetThreadSiteRange(iFirstIndex, iSiteCount, threadFirstIndex, threadSiteCount);
+              StreamAndCollideRange(collision, threadFirstIndex, threadSiteCount);
+            }
+          }
+          else
+#endif
+          {
+            StreamAndCollideRange(collision, iFirstIndex, iSiteCount);
+          }
+          CollisionTimer(collisionType, iFirstIndex).Stop();
+        }
+
+        /**
+         * As StreamAndCollide, but for the mid-domain sites that overlap the halo exchange. If
+         * HEMELB_OVERLAP_CHUNK_SITES is set, the range is done in chunks of that many sites, and
+         * MPI gets the chance to move the exchange along between chunks.
+         */
+        template<typename Collision>
+        void StreamAndCollideOverlapped(Collision* collision, const unsigned collisionType,
+                                        const site_t iFirstIndex, const site_t iSiteCount)
+        {
+#if HEMELB_OVERLAP_CHUNK_SITES > 0
+          const site_t end = iFirstIndex + iSiteCount;
+          for (site_t chunkFirstIndex = iFirstIndex; chunkFirstIndex < end; chunkFirstIndex +=
+              HEMELB_OVERLAP_CHUNK_SITES)
+          {
+            StreamAndCollide(collision,
+                             collisionType,
+                             chunkFirstIndex,
+                             std::min(site_t(HEMELB_OVERLAP_CHUNK_SITES), end - chunkFirstIndex));
+            mNet->Progress();
+            mLatDat->ProgressHaloExchange();
+          }
+#else
+          StreamAndCollide(collision, collisionType, iFirstIndex, iSiteCount);
+#endif
+        }
+
+        /**
+         * The number of bulk sites at the end of the mid-domain or domain-edge bulk range, by
+         * where the range starts, that the stabilised kernel does.
+         */
+        site_t StabilisedCount(const site_t iFirstIndex) const
+        {
+          return iFirstIndex >= mLatDat->GetMidDomainSiteCount() ?
+            mLatDat->GetDomainEdgeStabilisedCount() :
+            mLatDat->GetMidDomainStabilisedCount();
+        }
+
+        /**
+         * As StreamAndCollide, for a whole bulk range, with the sites at its end that are in
+         * the stabilised regions done by the stabilised kernel.
+         */
+        void StreamAndCollideBulk(const site_t iFirstIndex, const site_t iSiteCount)
+        {
+          const site_t stabilisedCount = StabilisedCount(iFirstIndex);
+          StreamAndCollide(mMidFluidCollision, 0, iFirstIndex, iSiteCount - stabilisedCount);
+          if (stabilisedCount > 0)
+          {
+            StreamAndCollide(mStabilisedMidFluidCollision,
+                             0,
+                             iFirstIndex + iSiteCount - stabilisedCount,
+                             stabilisedCount);
+          }
+        }
+
+        void StreamAndCollideBulkOverlapped(const site_t iFirstIndex, const site_t iSiteCount)
+        {
+          const site_t stabilisedCount = StabilisedCount(iFirstIndex);
+          StreamAndCollideOverlapped(mMidFluidCollision, 0, iFirstIndex, iSiteCount - stabilisedCount);
+          if (stabilisedCount > 0)
+          {
+            StreamAndCollideOverlapped(mStabilisedMidFluidCollision,
+                                       0,
+                                       iFirstIndex + iSiteCount - stabilisedCount,
+                                       stabilisedCount);
+          }
+        }
+
+        void PostStepBulk(const site_t iFirstIndex, const site_t iSiteCount)
+        {
+          const site_t stabilisedCount = StabilisedCount(iFirstIndex);
+          PostStep(mMidFluidCollision, 0, iFirstIndex, iSiteCount - stabilisedCount);
+          if (stabilisedCount > 0)
+          {
+            PostStep(mStabilisedMidFluidCollision,
+                     0,
+                     iFirstIndex + iSiteCount - stabilisedCount,
+                     stabilisedCount);
+          }
+        }
+
+        template<typename Collision>
+        void PostStep(Collision* collision, const unsigned collisionType, const site_t iFirstIndex,
+                      const site_t iSiteCount)
+        {
+          CollisionTimer(collisionType, iFirstIndex).Start();
+#ifdef HEMELB_USE_OPENMP
+          if (streamers::IsThreadSafe<Collision>::value)
+          {
+#pragma omp parallel
+            {
+              site_t threadFirstIndex, threadSiteCount;
+              GetThreadSiteRange(iFirstIndex, iSiteCount, threadFirstIndex, threadSiteCount);
+              PostStepRange(collision, threadFirstIndex, threadSiteCount);
+            }
+          }
+          else
+#endif
+          {
+            PostStepRange(collision, iFirstIndex, iSiteCount);
+          }
+          CollisionTimer(collisionType, iFirstIndex).Stop();
+        }
+
+        /**
+         * The timer for sites of a collision type, mid-domain or domain-edge by where the range
+         * of sites starts.
+         */
+        reporting::Timer& CollisionTimer(const unsigned collisionType, const site_t iFirstIndex)
+        {
+          return timings[reporting::Timers::CollisionTimer(collisionType,
+                                                           iFirstIndex >= mLatDat->GetMidDomainSiteCount())];
+        }
+
+#ifdef HEMELB_USE_OPENMP
+        /**
+         * Get the block of [iFirstIndex, iFirstIndex + iSiteCount) that the calling thread of
+         * the current parallel region should do. Blocks are contiguous and as even as possible.
+         */
+        static void GetThreadSiteRange(const site_t iFirstIndex, const site_t iSiteCount,
+                                       site_t& threadFirstIndex, site_t& threadSiteCount);
+#endif
 
         template<typename Collision>
-        void StreamAndCollide(Collision* collision, const site_t iFirstIndex, const site_t iSiteCount)
+        void StreamAndCollideRange(Collision* collision, const site_t iFirstIndex, const site_t iSiteCount)
         {
-          if (mVisControl->IsRendering())
+          // Only instantiate the property code for the steps that need some property.
+          if (propertyCache.AnyRequiresRefresh())
           {
             collision->template StreamAndCollide<true> (iFirstIndex, iSiteCount, &mParams, mLatDat, propertyCache);
           }
@@ -140,9 +325,9 @@ namespace hemelb
         }
 
         template<typename Collision>
-        void PostStep(Collision* collision, const site_t iFirstIndex, const site_t iSiteCount)
+        void PostStepRange(Collision* collision, const site_t iFirstIndex, const site_t iSiteCount)
         {
-          if (mVisControl->IsRendering())
+          if (propertyCache.AnyRequiresRefresh())
           {
             collision->template DoPostStep<true> (iFirstIndex, iSiteCount, &mParams, mLatDat, propertyCache);
           }
@@ -152,6 +337,118 @@ namespace hemelb
           }
         }
 
+#ifdef HEMELB_USE_WORK_STEALING
+        /**
+         * Streams and collides the chunks of the scheduler, and lets MPI move the halo exchange
+         * along after each chunk of the master thread's, if asked to.
+         */
+        struct ChunkStreamer
+        {
+            LBM* lbm;
+            bool progressHaloExchange;
+
+            void operator()(const WorkChunk& chunk) const
+            {
+              lbm->StreamAndCollideChunk(chunk);
+            }
+
+            void AfterMasterChunk() const
+            {
+              if (progressHaloExchange)
+              {
+                lbm->mNet->Progress();
+                lbm->mLatDat->ProgressHaloExchange();
+              }
+            }
+        };
+
+        struct ChunkPostStepper
+        {
+            LBM* lbm;
+
+            void operator()(const WorkChunk& chunk) const
+            {
+              lbm->PostStepChunk(chunk);
+            }
+
+            void AfterMasterChunk() const
+            {
+            }
+        };
+
+        /**
+         * Add a range of sites of a collision type to the scheduler, in chunks unless its
+         * streamer can't be split between threads, and move the offset past them.
+         */
+        template<typename Collision>
+        void ScheduleRange(Collision* collision, const unsigned collisionType, site_t& offset,
+                           const site_t siteCount)
+        {
+          scheduler.AddRange(collisionType,
+                             offset,
+                             siteCount,
+                             streamers::IsThreadSafe<Collision>::value ?
+                               chunkSites :
+                               0,
+                             siteWeights[collisionType]);
+          offset += siteCount;
+        }
+
+        /**
+         * Add the ranges of all the collision types, starting from the given index, with the
+         * counts for the mid-domain or domain-edge sites.
+         */
+        void ScheduleAllTypes(site_t offset, bool domainEdge);
+
+        /**
+         * Run the chunks scheduled, then share the time each chunk took between the threads
+         * and add it to the timer of its collision type.
+         */
+        template<typename Worker>
+        void RunScheduled(Worker& worker)
+        {
+          scheduler.Run(worker);
+          const std::vector<WorkChunk>& chunks = scheduler.GetChunks();
+          std::vector<double> timePerTimer(reporting::Timers::numberOfTimers, 0.0);
+          for (std::vector<WorkChunk>::const_iterator chunk = chunks.begin(); chunk != chunks.end(); ++chunk)
+          {
+            timePerTimer[reporting::Timers::CollisionTimer(chunk->collisionType,
+                                                           chunk->firstIndex
+                                                               >= mLatDat->GetMidDomainSiteCount())] +=
+                chunk->time;
+          }
+          for (unsigned timer = 0; timer < reporting::Timers::numberOfTimers; ++timer)
+          {
+            if (timePerTimer[timer] > 0.0)
+            {
+              timings[timer].Set(timings[timer].Get() + timePerTimer[timer] / scheduler.GetThreadCount());
+            }
+          }
+          scheduler.Clear();
+        }
+
+        /**
+         * Whether a bulk chunk is one for the stabilised kernel.
+         */
+        bool IsStabilised(const WorkChunk& chunk) const
+        {
+          return chunk.firstIndex >= mLatDat->GetMidDomainSiteCount() ?
+            chunk.firstIndex >= mLatDat->GetMidDomainSiteCount() + mLatDat->GetDomainEdgeCollisionCount(0)
+                - mLatDat->GetDomainEdgeStabilisedCount() :
+            chunk.firstIndex >= mLatDat->GetMidDomainCollisionCount(0) - mLatDat->GetMidDomainStabilisedCount();
+        }
+
+        void StreamAndCollideChunk(const WorkChunk& chunk);
+        void PostStepChunk(const WorkChunk& chunk);
+
+        WorkStealingScheduler scheduler;
+        //! The most sites in a chunk, about HEMELB_WORK_CHUNK_BYTES of distributions.
+        site_t chunkSites;
+#endif
+
+        //! The weight of a site of each collision type.
+        std::vector<int> siteWeights;
+
         unsigned int inletCount;
         unsigned int outletCount;
 
@@ -7,8 +7,14 @@
 #ifndef HEMELB_LB_LB_HPP
 #define HEMELB_LB_LB_HPP
 
+#ifdef HEMELB_USE_OPENMP
+#include <omp.h>
+#endif
+
 #include "io/writers/xdr/XdrMemWriter.h"
+#include "util/utilityFunctions.h"
 #include "lb/lb.h"
+#include "geometry/decomposition/SiteWeights.h"
 
 namespace hemelb
 {
@@ -34,11 +40,18 @@ namespace hemelb
                           SimulationState* simState,
                           reporting::Timers &atimings,
                           geometry::neighbouring::NeighbouringDataManager *neighbouringDataManager) :
-      mSimConfig(iSimulationConfig), mNet(net), mLatDat(latDat), mState(simState), 
+      mStabilisedMidFluidCollision(NULL), mSimConfig(iSimulationConfig), mNet(net), mLatDat(latDat), mState(simState), 
           mParams(iSimulationConfig->GetTimeStepLength(), iSimulationConfig->GetVoxelSize()), timings(atimings),
           propertyCache(*simState, *latDat), neighbouringDataManager(neighbouringDataManager)
     {
       ReadParameters();
+      siteWeights = geometry::decomposition::SiteWeights().GetWeights();
+#ifdef HEMELB_USE_WORK_STEALING
+      // Each site reads and writes its distributions and reads where they stream to.
+      chunkSites = std::max(site_t(1),
+                            site_t(HEMELB_WORK_CHUNK_BYTES
+                                / (LatticeType::NUMVECTORS * (2 * sizeof(distribn_t) + sizeof(site_t)))));
+#endif
     }
 
     template<class LatticeType>
@@ -104,6 +117,10 @@ namespace hemelb
       unsigned collId;
       InitInitParamsSiteRanges(initParams, collId);
       mMidFluidCollision = new tMidFluidCollision(initParams);
+#ifdef HEMELB_STABILISED_KERNEL
+      // Over the same ranges; it only gets the sites at their ends.
+      mStabilisedMidFluidCollision = new tStabilisedMidFluidCollision(initParams);
+#endif
 
       AdvanceInitParamsSiteRanges(initParams, collId);
       mWallCollision = new tWallCollision(initParams);
@@ -181,13 +198,7 @@ namespace hemelb
 
         LatticeType::CalculateFeq(density, 0.0, 0.0, 0.0, f_eq);
 
-        distribn_t* f_old_p = mLatDat->GetFOld(i * LatticeType::NUMVECTORS);
-        distribn_t* f_new_p = mLatDat->GetFNew(i * LatticeType::NUMVECTORS);
-
-        for (unsigned int l = 0; l < LatticeType::NUMVECTORS; l++)
-        {
-          f_new_p[l] = f_old_p[l] = f_eq[l];
-        }
+        mLatDat->SetDistributions(i, f_eq);
       }
     }
 
@@ -219,26 +230,38 @@ namespace hemelb
        */
       site_t offset = mLatDat->GetMidDomainSiteCount();
 
-      StreamAndCollide(mMidFluidCollision, offset, mLatDat->GetDomainEdgeCollisionCount(0));
+#ifdef HEMELB_USE_WORK_STEALING
+      mInletValues->FinishReceive();
+      mOutletValues->FinishReceive();
+      ScheduleAllTypes(offset, true);
+      ChunkStreamer streamer = { this, false };
+      RunScheduled(streamer);
+#else
+      StreamAndCollideBulk(offset, mLatDat->GetDomainEdgeCollisionCount(0));
       offset += mLatDat->GetDomainEdgeCollisionCount(0);
 
-      StreamAndCollide(mWallCollision, offset, mLatDat->GetDomainEdgeCollisionCount(1));
+      StreamAndCollide(mWallCollision, 1, offset, mLatDat->GetDomainEdgeCollisionCount(1));
       offset += mLatDat->GetDomainEdgeCollisionCount(1);
 
       mInletValues->FinishReceive();
-      StreamAndCollide(mInletCollision, offset, mLatDat->GetDomainEdgeCollisionCount(2));
+      StreamAndCollide(mInletCollision, 2, offset, mLatDat->GetDomainEdgeCollisionCount(2));
       offset += mLatDat->GetDomainEdgeCollisionCount(2);
 
       mOutletValues->FinishReceive();
-      StreamAndCollide(mOutletCollision, offset, mLatDat->GetDomainEdgeCollisionCount(3));
+      StreamAndCollide(mOutletCollision, 3, offset, mLatDat->GetDomainEdgeCollisionCount(3));
       offset += mLatDat->GetDomainEdgeCollisionCount(3);
 
-      StreamAndCollide(mInletWallCollision, offset, mLatDat->GetDomainEdgeCollisionCount(4));
+      StreamAndCollide(mInletWallCollision, 4, offset, mLatDat->GetDomainEdgeCollisionCount(4));
       offset += mLatDat->GetDomainEdgeCollisionCount(4);
 
-      StreamAndCollide(mOutletWallCollision, offset, mLatDat->GetDomainEdgeCollisionCount(5));
+      StreamAndCollide(mOutletWallCollision, 5, offset, mLatDat->GetDomainEdgeCollisionCount(5));
+#endif
 
       timings[hemelb::reporting::Timers::lb_calc].Stop();
+
+      // Everything to be sent is now in place.
+      mLatDat->StartHaloExchange();
+
       timings[hemelb::reporting::Timers::lb].Stop();
     }
 
@@ -258,22 +281,30 @@ namespace hemelb
        */
       site_t offset = 0;
 
-      StreamAndCollide(mMidFluidCollision, offset, mLatDat->GetMidDomainCollisionCount(0));
+#ifdef HEMELB_USE_WORK_STEALING
+      // The master thread lets MPI move the exchange along between its chunks, if
+      // HEMELB_OVERLAP_CHUNK_SITES asks for that.
+      ScheduleAllTypes(offset, false);
+      ChunkStreamer streamer = { this, HEMELB_OVERLAP_CHUNK_SITES > 0 };
+      RunScheduled(streamer);
+#else
+      StreamAndCollideBulkOverlapped(offset, mLatDat->GetMidDomainCollisionCount(0));
       offset += mLatDat->GetMidDomainCollisionCount(0);
 
-      StreamAndCollide(mWallCollision, offset, mLatDat->GetMidDomainCollisionCount(1));
+      StreamAndCollideOverlapped(mWallCollision, 1, offset, mLatDat->GetMidDomainCollisionCount(1));
       offset += mLatDat->GetMidDomainCollisionCount(1);
 
-      StreamAndCollide(mInletCollision, offset, mLatDat->GetMidDomainCollisionCount(2));
+      StreamAndCollideOverlapped(mInletCollision, 2, offset, mLatDat->GetMidDomainCollisionCount(2));
       offset += mLatDat->GetMidDomainCollisionCount(2);
 
-      StreamAndCollide(mOutletCollision, offset, mLatDat->GetMidDomainCollisionCount(3));
+      StreamAndCollideOverlapped(mOutletCollision, 3, offset, mLatDat->GetMidDomainCollisionCount(3));
       offset += mLatDat->GetMidDomainCollisionCount(3);
 
-      StreamAndCollide(mInletWallCollision, offset, mLatDat->GetMidDomainCollisionCount(4));
+      StreamAndCollideOverlapped(mInletWallCollision, 4, offset, mLatDat->GetMidDomainCollisionCount(4));
       offset += mLatDat->GetMidDomainCollisionCount(4);
 
-      StreamAndCollide(mOutletWallCollision, offset, mLatDat->GetMidDomainCollisionCount(5));
+      StreamAndCollideOverlapped(mOutletWallCollision, 5, offset, mLatDat->GetMidDomainCollisionCount(5));
+#endif
 
       timings[hemelb::reporting::Timers::lb_calc].Stop();
       timings[hemelb::reporting::Timers::lb].Stop();
@@ -287,6 +318,7 @@ namespace hemelb
       // Copy the distribution functions received from the neighbouring
       // processors into the destination buffer "f_new".
       // This is done here, after receiving the sent distributions from neighbours.
+      mLatDat->FinishHaloExchange();
       mLatDat->CopyReceived();
 
       // Do any cleanup steps necessary on boundary nodes
@@ -294,42 +326,51 @@ namespace hemelb
 
       timings[hemelb::reporting::Timers::lb_calc].Start();
 
+#ifdef HEMELB_USE_WORK_STEALING
+      // Separately, so that a streamer that can't be split never has two ranges at once.
+      ChunkPostStepper postStepper = { this };
+      ScheduleAllTypes(offset, true);
+      RunScheduled(postStepper);
+      ScheduleAllTypes(0, false);
+      RunScheduled(postStepper);
+#else
       //TODO yup, this is horrible. If you read this, please improve the following code.
-      PostStep(mMidFluidCollision, offset, mLatDat->GetDomainEdgeCollisionCount(0));
+      PostStepBulk(offset, mLatDat->GetDomainEdgeCollisionCount(0));
       offset += mLatDat->GetDomainEdgeCollisionCount(0);
 
-      PostStep(mWallCollision, offset, mLatDat->GetDomainEdgeCollisionCount(1));
+      PostStep(mWallCollision, 1, offset, mLatDat->GetDomainEdgeCollisionCount(1));
       offset += mLatDat->GetDomainEdgeCollisionCount(1);
 
-      PostStep(mInletCollision, offset, mLatDat->GetDomainEdgeCollisionCount(2));
+      PostStep(mInletCollision, 2, offset, mLatDat->GetDomainEdgeCollisionCount(2));
       offset += mLatDat->GetDomainEdgeCollisionCount(2);
 
-      PostStep(mOutletCollision, offset, mLatDat->GetDomainEdgeCollisionCount(3));
+      PostStep(mOutletCollision, 3, offset, mLatDat->GetDomainEdgeCollisionCount(3));
       offset += mLatDat->GetDomainEdgeCollisionCount(3);
 
-      PostStep(mInletWallCollision, offset, mLatDat->GetDomainEdgeCollisionCount(4));
+      PostStep(mInletWallCollision, 4, offset, mLatDat->GetDomainEdgeCollisionCount(4));
       offset += mLatDat->GetDomainEdgeCollisionCount(4);
 
-      PostStep(mOutletWallCollision, offset, mLatDat->GetDomainEdgeCollisionCount(5));
+      PostStep(mOutletWallCollision, 5, offset, mLatDat->GetDomainEdgeCollisionCount(5));
 
       offset = 0;
 
-      PostStep(mMidFluidCollision, offset, mLatDat->GetMidDomainCollisionCount(0));
+      PostStepBulk(offset, mLatDat->GetMidDomainCollisionCount(0));
       offset += mLatDat->GetMidDomainCollisionCount(0);
 
-      PostStep(mWallCollision, offset, mLatDat->GetMidDomainCollisionCount(1));
+      PostStep(mWallCollision, 1, offset, mLatDat->GetMidDomainCollisionCount(1));
       offset += mLatDat->GetMidDomainCollisionCount(1);
 
-      PostStep(mInletCollision, offset, mLatDat->GetMidDomainCollisionCount(2));
+      PostStep(mInletCollision, 2, offset, mLatDat->GetMidDomainCollisionCount(2));
       offset += mLatDat->GetMidDomainCollisionCount(2);
 
-      PostStep(mOutletCollision, offset, mLatDat->GetMidDomainCollisionCount(3));
+      PostStep(mOutletCollision, 3, offset, mLatDat->GetMidDomainCollisionCount(3));
       offset += mLatDat->GetMidDomainCollisionCount(3);
 
-      PostStep(mInletWallCollision, offset, mLatDat->GetMidDomainCollisionCount(4));
+      PostStep(mInletWallCollision, 4, offset, mLatDat->GetMidDomainCollisionCount(4));
       offset += mLatDat->GetMidDomainCollisionCount(4);
 
-      PostStep(mOutletWallCollision, offset, mLatDat->GetMidDomainCollisionCount(5));
+      PostStep(mOutletWallCollision, 5, offset, mLatDat->GetMidDomainCollisionCount(5));
+#endif
 
       timings[hemelb::reporting::Timers::lb_calc].Stop();
       timings[hemelb::reporting::Timers::lb].Stop();
@@ -353,6 +394,7 @@ namespace hemelb
     {
       // Delete the collision and stream objects we've been using
       delete mMidFluidCollision;
+      delete mStabilisedMidFluidCollision;
       delete mWallCollision;
       delete mInletCollision;
       delete mOutletCollision;
@@ -360,6 +402,111 @@ namespace hemelb
       delete mOutletWallCollision;
     }
 
+#ifdef HEMELB_USE_OPENMP
+    template<class LatticeType>
+    void LBM<LatticeType>::GetThreadSiteRange(const site_t iFirstIndex, const site_t iSiteCount,
+                                              site_t& threadFirstIndex, site_t& threadSiteCount)
+    {
+      util::GetBlockRange(iFirstIndex,
+                          iSiteCount,
+                          site_t(omp_get_thread_num()),
+                          site_t(omp_get_num_threads()),
+                          threadFirstIndex,
+                          threadSiteCount);
+    }
+#endif
+
+#ifdef HEMELB_USE_WORK_STEALING
+    template<class LatticeType>
+    void LBM<LatticeType>::ScheduleAllTypes(site_t offset, bool domainEdge)
+    {
+      site_t counts[COLLISION_TYPES];
+      for (unsigned collisionType = 0; collisionType < COLLISION_TYPES; ++collisionType)
+      {
+        counts[collisionType] = domainEdge ?
+          mLatDat->GetDomainEdgeCollisionCount(collisionType) :
+          mLatDat->GetMidDomainCollisionCount(collisionType);
+      }
+      const site_t stabilisedCount = domainEdge ?
+        mLatDat->GetDomainEdgeStabilisedCount() :
+        mLatDat->GetMidDomainStabilisedCount();
+
+      ScheduleRange(mMidFluidCollision, 0, offset, counts[0] - stabilisedCount);
+      ScheduleRange(mStabilisedMidFluidCollision, 0, offset, stabilisedCount);
+      ScheduleRange(mWallCollision, 1, offset, counts[1]);
+      ScheduleRange(mInletCollision, 2, offset, counts[2]);
+      ScheduleRange(mOutletCollision, 3, offset, counts[3]);
+      ScheduleRange(mInletWallCollision, 4, offset, counts[4]);
+      ScheduleRange(mOutletWallCollision, 5, offset, counts[5]);
+    }
+
+    template<class LatticeType>
+    void LBM<LatticeType>::StreamAndCollideChunk(const WorkChunk& chunk)
+    {
+      switch (chunk.collisionType)
+      {
+        case 0:
+          if (IsStabilised(chunk))
+          {
+            StreamAndCollideRange(mStabilisedMidFluidCollision, chunk.firstIndex, chunk.siteCount);
+          }
+          else
+          {
+            StreamAndCollideRange(mMidFluidCollision, chunk.firstIndex, chunk.siteCount);
+          }
+          break;
+        case 1:
+          StreamAndCollideRange(mWallCollision, chunk.firstIndex, chunk.siteCount);
+          break;
+        case 2:
+          StreamAndCollideRange(mInletCollision, chunk.firstIndex, chunk.siteCount);
+          break;
+        case 3:
+          StreamAndCollideRange(mOutletCollision, chunk.firstIndex, chunk.siteCount);
+          break;
+        case 4:
+          StreamAndCollideRange(mInletWallCollision, chunk.firstIndex, chunk.siteCount);
+          break;
+        case 5:
+          StreamAndCollideRange(mOutletWallCollision, chunk.firstIndex, chunk.siteCount);
+          break;
+      }
+    }
+
+    template<class LatticeType>
+    void LBM<LatticeType>::PostStepChunk(const WorkChunk& chunk)
+    {
+      switch (chunk.collisionType)
+      {
+        case 0:
+          if (IsStabilised(chunk))
+          {
+            PostStepRange(mStabilisedMidFluidCollision, chunk.firstIndex, chunk.siteCount);
+          }
+          else
+          {
+            PostStepRange(mMidFluidCollision, chunk.firstIndex, chunk.siteCount);
+          }
+          break;
+        case 1:
+          PostStepRange(mWallCollision, chunk.firstIndex, chunk.siteCount);
+          break;
+        case 2:
+          PostStepRange(mInletCollision, chunk.firstIndex, chunk.siteCount);
+          break;
+        case 3:
+          PostStepRange(mOutletCollision, chunk.firstIndex, chunk.siteCount);
+          break;
+        case 4:
+          PostStepRange(mInletWallCollision, chunk.firstIndex, chunk.siteCount);
+          break;
+        case 5:
+          PostStepRange(mOutletWallCollision, chunk.firstIndex, chunk.siteCount);
+          break;
+      }
+    }
+#endif
+
     template<class LatticeType>
     void LBM<LatticeType>::ReadParameters()
     {
@@ -26,9 +26,9 @@ namespace hemelb
        * BaseStreamer: inheritable base class for the streaming operator. The public interface
        * here defines the complete interface usable by external code.
        *  - Constructor(InitParams&)
-       *  - <bool tDoRayTracing> StreamAndCollide(const site_t, const site_t, const LbmParameters*,
+       *  - <bool tUpdateCaches> StreamAndCollide(const site_t, const site_t, const LbmParameters*,
        *      geometry::LatticeData*, hemelb::vis::Control*)
-       *  - <bool tDoRayTracing> PostStep(const site_t, const site_t, const LbmParameters*,
+       *  - <bool tUpdateCaches> PostStep(const site_t, const site_t, const LbmParameters*,
        *      geometry::LatticeData*, hemelb::vis::Control*)
        *  - Reset(kernels::InitParams* init)
        *
@@ -36,9 +36,9 @@ namespace hemelb
        * using the CRTP).
        *  - typedef for CollisionType, the type of the collider operation.
        *  - Constructor(InitParams&)
-       *  - <bool tDoRayTracing> DoStreamAndCollide(const site_t, const site_t, const LbmParameters*,
+       *  - <bool tUpdateCaches> DoStreamAndCollide(const site_t, const site_t, const LbmParameters*,
        *      geometry::LatticeData*, hemelb::vis::Control*)
-       *  - <bool tDoRayTracing> DoPostStep(const site_t, const site_t, const LbmParameters*,
+       *  - <bool tUpdateCaches> DoPostStep(const site_t, const site_t, const LbmParameters*,
        *      geometry::LatticeData*, hemelb::vis::Control*)
        *  - DoReset(kernels::InitParams* init)
        *
@@ -49,26 +49,30 @@ namespace hemelb
        * SimpleCollideAndStreamDelegate and wall link streaming to BFLDelagate,
        * which uses SimpleBounceBackDelegate in the cases where it can't handle
        * because two opposite links are both wall links).
+       *
+       * tUpdateCaches says whether to fill in the MacroscopicPropertyCache from the collisions.
+       * Only the steps that need some property should be instantiated with it true, so that the
+       * collide loop of every other step has no property code in it at all.
        */
       template<typename StreamerImpl>
       class BaseStreamer
       {
         public:
-          template<bool tDoRayTracing>
+          template<bool tUpdateCaches>
           inline void StreamAndCollide(const site_t firstIndex,
                                        const site_t siteCount,
                                        const LbmParameters* lbmParams,
                                        geometry::LatticeData* latDat,
                                        lb::MacroscopicPropertyCache& propertyCache)
           {
-            static_cast<StreamerImpl*> (this)->template DoStreamAndCollide<tDoRayTracing> (firstIndex,
+            static_cast<StreamerImpl*> (this)->template DoStreamAndCollide<tUpdateCaches> (firstIndex,
                                                                                            siteCount,
                                                                                            lbmParams,
                                                                                            latDat,
                                                                                            propertyCache);
           }
 
-          template<bool tDoRayTracing>
+          template<bool tUpdateCaches>
           inline void PostStep(const site_t firstIndex,
                                const site_t siteCount,
                                const LbmParameters* lbmParams,
@@ -77,7 +81,7 @@ namespace hemelb
           {
             // The template parameter is required because we're using the CRTP to call a
             // metaprogrammed method of the implementation class.
-            static_cast<StreamerImpl*> (this)->template DoPostStep<tDoRayTracing> (firstIndex,
+            static_cast<StreamerImpl*> (this)->template DoPostStep<tUpdateCaches> (firstIndex,
                                                                                    siteCount,
                                                                                    lbmParams,
                                                                                    latDat,
@@ -85,12 +89,60 @@ namespace hemelb
           }
 
         protected:
-          template<bool tDoRayTracing, class LatticeType>
+          template<bool tUpdateCaches, class LatticeType>
           inline static void UpdateMinsAndMaxes(const geometry::Site<geometry::LatticeData>& site,
                                                 const kernels::HydroVarsBase<LatticeType>& hydroVars,
                                                 const LbmParameters* lbmParams,
                                                 lb::MacroscopicPropertyCache& propertyCache)
           {
+            // Check the distributions the site sends for stability while they're in cache, so
+            // that the StabilityTester doesn't have to go over them again. Note that by testing
+            // for value > 0.0, we also catch stray NaNs.
+            bool allPositive = true;
+            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+            {
+              allPositive &= (hydroVars.GetFPostCollision()[direction] > 0.0);
+            }
+            if (!allPositive)
+            {
+              propertyCache.NoteNonPositiveDistribution();
+            }
+
+            if (!tUpdateCaches)
+            {
+              return;
+            }
+
+            if (propertyCache.RelativeChangeRequired())
+            {
+              distribn_t maxRelativeChange = 0.0;
+              for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+              {
+                distribn_t fOld;
+                if (site.GetSentFOld<LatticeType>(direction, fOld))
+                {
+                  const distribn_t relativeChange =
+                      std::fabs(hydroVars.GetFPostCollision()[direction] - fOld) / fOld;
+                  if (! (relativeChange <= maxRelativeChange))
+                  {
+                    maxRelativeChange = relativeChange;
+                  }
+                }
+              }
+              propertyCache.NoteRelativeChange(maxRelativeChange);
+            }
+
+            // The density extremes are over every site, whichever sites are cached.
+            if (propertyCache.DensityExtremesRequired())
+            {
+              propertyCache.NoteDensityAndVelocity(hydroVars.density, hydroVars.velocity);
+            }
+
+            if (!propertyCache.IsSiteCached(site.GetIndex()))
+            {
+              return;
+            }
+
             if (propertyCache.densityCache.RequiresRefresh())
             {
               propertyCache.densityCache.Put(site.GetIndex(), hydroVars.density);
@@ -101,6 +153,26 @@ namespace hemelb
               propertyCache.velocityCache.Put(site.GetIndex(), hydroVars.velocity);
             }
 
+            const bool tensorRequired = propertyCache.stressTensorCache.RequiresRefresh();
+            const bool tractionRequired = propertyCache.tractionCache.RequiresRefresh();
+            const bool tangentialRequired =
+                propertyCache.tangentialProjectionTractionCache.RequiresRefresh();
+            if (! (propertyCache.wallShearStressMagnitudeCache.RequiresRefresh()
+                || propertyCache.vonMisesStressCache.RequiresRefresh()
+                || propertyCache.shearRateCache.RequiresRefresh() || tensorRequired || tractionRequired
+                || tangentialRequired))
+            {
+              return;
+            }
+
+            // All the stress properties come from the second moment of f_neq, so find it once,
+            // unless the kernel already has.
+            lattices::SecondMoment moment;
+            if (!hydroVars.GetKnownFNeqMoment(moment))
+            {
+              moment = LatticeType::CalculateSecondMoment(hydroVars.GetFNeq().f);
+            }
+
             if (propertyCache.wallShearStressMagnitudeCache.RequiresRefresh())
             {
               distribn_t stress;
@@ -111,8 +183,7 @@ namespace hemelb
               }
               else
               {
-                LatticeType::CalculateWallShearStressMagnitude(hydroVars.density,
-                                                               hydroVars.GetFNeq().f,
+                LatticeType::CalculateWallShearStressMagnitude(moment,
                                                                site.GetWallNormal(),
                                                                stress,
                                                                lbmParams->GetStressParameter());
@@ -124,78 +195,76 @@ namespace hemelb
             if (propertyCache.vonMisesStressCache.RequiresRefresh())
             {
               distribn_t stress;
-              StreamerImpl::CollisionType::CKernel::LatticeType::CalculateVonMisesStress(hydroVars.GetFNeq().f,
-                                                                                         stress,
-                                                                                         lbmParams->GetStressParameter());
+              LatticeType::CalculateVonMisesStress(moment, stress, lbmParams->GetStressParameter());
 
               propertyCache.vonMisesStressCache.Put(site.GetIndex(), stress);
             }
 
             if (propertyCache.shearRateCache.RequiresRefresh())
             {
-              distribn_t shear_rate =
-                  StreamerImpl::CollisionType::CKernel::LatticeType::CalculateShearRate(hydroVars.tau,
-                                                                                        hydroVars.GetFNeq().f,
-                                                                                        hydroVars.density);
+              distribn_t shear_rate = LatticeType::CalculateShearRate(hydroVars.tau,
+                                                                      moment,
+                                                                      hydroVars.density);
 
               propertyCache.shearRateCache.Put(site.GetIndex(), shear_rate);
             }
 
-            if (propertyCache.stressTensorCache.RequiresRefresh())
+            if (tensorRequired || tractionRequired || tangentialRequired)
             {
               util::Matrix3D stressTensor;
-              StreamerImpl::CollisionType::CKernel::LatticeType::CalculateStressTensor(hydroVars.density,
-                                                                                       hydroVars.tau,
-                                                                                       hydroVars.GetFNeq().f,
-                                                                                       stressTensor);
-
-              propertyCache.stressTensorCache.Put(site.GetIndex(), stressTensor);
-
-            }
-
-            if (propertyCache.tractionCache.RequiresRefresh())
-            {
               util::Vector3D<LatticeStress> tractionOnAPoint(0);
+              util::Vector3D<LatticeStress> tangentialProjectionTractionOnAPoint(0);
 
               /*
                * Wall normals are only available at the sites marked as being at the domain edge.
-               * For the sites in the fluid bulk, the traction vector will be 0.
+               * For the sites in the fluid bulk, the traction vectors will be 0.
                */
-              if (site.IsWall())
+              const bool wall = site.IsWall();
+              LatticeType::CalculateStressProperties(hydroVars.density,
+                                                     hydroVars.tau,
+                                                     moment,
+                                                     wall ?
+                                                       site.GetWallNormal() :
+                                                       util::Vector3D<Dimensionless>::Zero(),
+                                                     tensorRequired ?
+                                                       &stressTensor :
+                                                       NULL,
+                                                     tractionRequired && wall ?
+                                                       &tractionOnAPoint :
+                                                       NULL,
+                                                     tangentialRequired && wall ?
+                                                       &tangentialProjectionTractionOnAPoint :
+                                                       NULL);
+
+              if (tensorRequired)
               {
-                LatticeType::CalculateTractionOnAPoint(hydroVars.density,
-                                                       hydroVars.tau,
-                                                       hydroVars.GetFNeq().f,
-                                                       site.GetWallNormal(),
-                                                       tractionOnAPoint);
+                propertyCache.stressTensorCache.Put(site.GetIndex(), stressTensor);
               }
-
-              propertyCache.tractionCache.Put(site.GetIndex(), tractionOnAPoint);
-
-            }
-
-            if (propertyCache.tangentialProjectionTractionCache.RequiresRefresh())
-            {
-              util::Vector3D<LatticeStress> tangentialProjectionTractionOnAPoint(0);
-
-              /*
-               * Wall normals are only available at the sites marked as being at the domain edge.
-               * For the sites in the fluid bulk, the traction vector will be 0.
-               */
-              if (site.IsWall())
+              if (tractionRequired)
               {
-                LatticeType::CalculateTangentialProjectionTraction(hydroVars.density,
-                                                                   hydroVars.tau,
-                                                                   hydroVars.GetFNeq().f,
-                                                                   site.GetWallNormal(),
-                                                                   tangentialProjectionTractionOnAPoint);
+                propertyCache.tractionCache.Put(site.GetIndex(), tractionOnAPoint);
+              }
+              if (tangentialRequired)
+              {
+                propertyCache.tangentialProjectionTractionCache.Put(site.GetIndex(),
+                                                                    tangentialProjectionTractionOnAPoint);
               }
-
-              propertyCache.tangentialProjectionTractionCache.Put(site.GetIndex(), tangentialProjectionTractionOnAPoint);
-
             }
           }
       };
+
+      /**
+       * IsThreadSafe: whether the LBM may split a site range between threads and call
+       * StreamAndCollide/PostStep on the pieces concurrently (only used when built with
+       * HEMELB_USE_OPENMP). This holds for streamers that only write to the distributions and
+       * cache entries of the sites they are given; streamers with shared per-site bookkeeping
+       * must specialise it to false.
+       */
+      template<typename Streamer>
+      struct IsThreadSafe
+      {
+          static const bool value = true;
+      };
     }
   }
 }
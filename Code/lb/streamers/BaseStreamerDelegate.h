@@ -70,6 +70,25 @@ namespace hemelb
           {
           }
 
+          /**
+           * Called before streaming the links of a run of sites at the same iolet (see
+           * geometry::LatticeData::GetLinkPatternRange), so that an iolet delegate can look up
+           * that iolet's values once for the whole run.
+           * @param ioletId
+           */
+          inline void SetIolet(int ioletId)
+          {
+          }
+
+          // With HEMELB_USE_PULL_STREAMING, wall and iolet delegates must also implement
+          //   void PullLink(const LbmParameters*, geometry::LatticeData*,
+          //                 const geometry::Site<geometry::LatticeData>&, distribn_t* f,
+          //                 const Direction&)
+          // to set, in the distributions f pulled to the site, the one that streams back to it
+          // across the link from it along the direction. f has that direction's distribution
+          // from the last collision, bounced back, to start with. It isn't given a default here,
+          // so that the delegates that can't pull don't build in pull mode.
+
           /**
            * Perform any post-step operations for the link from site along direction
            *
@@ -48,7 +48,8 @@ namespace hemelb
                                  const Direction& direction)
           {
             site_t invDirection = LatticeType::INVERSEDIRECTIONS[direction];
-            site_t bbDestination = (site.GetIndex() * LatticeType::NUMVECTORS) + invDirection;
+            site_t bbDestination = latticeData->GetDistributionIndex<LatticeType>(site.GetIndex(),
+                                                                                  invDirection);
             distribn_t q = site.GetWallDistance<LatticeType> (direction);
 
             if (site.HasWall(invDirection) || q < 0.5)
@@ -73,7 +74,6 @@ namespace hemelb
                                    const geometry::Site<geometry::LatticeData>& site,
                                    const Direction& direction)
           {
-            distribn_t* fNew = latticeData->GetFNew(site.GetIndex() * LatticeType::NUMVECTORS);
             site_t invDirection = LatticeType::INVERSEDIRECTIONS[direction];
             distribn_t q = site.GetWallDistance<LatticeType> (direction);
             // If there is no fluid site in the opposite direction, fall back to simple
@@ -88,7 +88,13 @@ namespace hemelb
               // Note that:
               // - fNew[direction] is the newly-arrived fPostColl[direction] from the neighbouring site
               // - fNew[invDirection] is the above-bounced-back fPostColl[direction] for this site.
-              fNew[invDirection] = 2.0 * q * fNew[invDirection] + (1.0 - 2.0 * q) * fNew[direction];
+              stored_distribn_t& fNewInv =
+                  *latticeData->GetFNew(latticeData->GetDistributionIndex<LatticeType>(site.GetIndex(),
+                                                                                       invDirection));
+              const distribn_t fNewDir =
+                  *latticeData->GetFNew(latticeData->GetDistributionIndex<LatticeType>(site.GetIndex(),
+                                                                                       direction));
+              fNewInv = 2.0 * q * fNewInv + (1.0 - 2.0 * q) * fNewDir;
             }
           }
       };
@@ -217,7 +217,8 @@ namespace hemelb
                 else
                 {
                   // There is a neighbour site to use for standard GZS to calculate u_w2.
-                  const distribn_t *neighbourFOld = GetNeighbourFOld(site, i, latDat);
+                  distribn_t neighbourFOldBuffer[LatticeType::NUMVECTORS];
+                  const distribn_t *neighbourFOld = GetNeighbourFOld(site, i, latDat, neighbourFOldBuffer);
                   // Now calculate this field information.
                   LatticeVelocity neighbourVelocity;
                   distribn_t neighbourFEq[LatticeType::NUMVECTORS];
@@ -287,15 +288,16 @@ namespace hemelb
             // Perform collision
             collider.Collide(lbmParams, hydroVarsWall);
             // stream
-            distribn_t* fNew = latDat->GetFNew(site.GetIndex() * LatticeType::NUMVECTORS);
-            fNew[i] = hydroVarsWall.GetFPostCollision()[i];
+            *latDat->GetFNew(latDat->GetDistributionIndex<LatticeType>(site.GetIndex(), i)) =
+                hydroVarsWall.GetFPostCollision()[i];
 
           }
 
         private:
           const distribn_t *GetNeighbourFOld(const geometry::Site<geometry::LatticeData>& site,
                                              const Direction& i,
-                                             geometry::LatticeData* const latDat)
+                                             geometry::LatticeData* const latDat,
+                                             distribn_t* buffer)
           {
             const distribn_t* neighbourFOld;
             // Find the neighbour's global location and which proc it's on.
@@ -307,7 +309,7 @@ namespace hemelb
               // If it's local, get a Site object for it.
               geometry::Site<geometry::LatticeData> nextSiteOut =
                   latDat->GetSite(latDat->GetContiguousSiteId(neighbourGlobalLocation));
-              neighbourFOld = nextSiteOut.GetFOld<LatticeType> ();
+              neighbourFOld = nextSiteOut.GetFOld<LatticeType> (buffer);
             }
             else
             {
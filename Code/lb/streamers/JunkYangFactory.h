@@ -12,6 +12,9 @@
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/numeric/ublas/lu.hpp>
 #include <boost/numeric/ublas/io.hpp>
+#include <algorithm>
+#include <map>
+#include <vector>
 
 namespace hemelb
 {
@@ -46,49 +49,65 @@ namespace hemelb
                   ioletLinkDelegate(collider, initParams), THETA(0.7),
                   latticeData(*initParams.latDat)
           {
+            // Find the distinct solvers needed, then lay them out grouped by link pattern.
+            std::map<SolverKey, std::size_t> solverIndices;
             for (std::vector<std::pair<site_t, site_t> >::iterator rangeIt =
                 initParams.siteRanges.begin(); rangeIt != initParams.siteRanges.end(); ++rangeIt)
             {
               for (site_t siteIdx = rangeIt->first; siteIdx < rangeIt->second; ++siteIdx)
               {
-                geometry::Site<const geometry::LatticeData> localSite =
-                    latticeData.GetSite(siteIdx);
                 // Only consider walls - the initParams .siteRanges should take care of that for us, but check anyway
-                if (localSite.IsWall())
+                if (latticeData.GetSite(siteIdx).IsWall())
                 {
-                  ConstructVelocitySets(siteIdx);
-                  AssembleKMatrix(siteIdx);
-                  AssembleLMatrix(siteIdx);
+                  solverIndices[GetSolverKey(siteIdx)] = 0;
                 }
               }
             }
-            FactoriseLMatrices();
-          }
+            for (typename std::map<SolverKey, std::size_t>::iterator solverIt =
+                solverIndices.begin(); solverIt != solverIndices.end(); ++solverIt)
+            {
+              solverIt->second = solvers.size();
+              AddSolver(solverIt->first);
+            }
 
-          ~JunkYangFactory()
-          {
-            // Free dynamically allocated permutation matrices.
-            for (std::map<site_t, ublas::permutation_matrix<std::size_t>*>::iterator iter =
-                luPermutationMatrices.begin(); iter != luPermutationMatrices.end(); ++iter)
+            for (std::vector<std::pair<site_t, site_t> >::iterator rangeIt =
+                initParams.siteRanges.begin(); rangeIt != initParams.siteRanges.end(); ++rangeIt)
             {
-              delete iter->second;
+              for (site_t siteIdx = rangeIt->first; siteIdx < rangeIt->second; ++siteIdx)
+              {
+                if (latticeData.GetSite(siteIdx).IsWall())
+                {
+                  WallSite wallSite;
+                  wallSite.siteIndex = siteIdx;
+                  wallSite.solver = solverIndices[GetSolverKey(siteIdx)];
+                  wallSite.partialSolution = partialSolutions.size();
+                  partialSolutions.resize(partialSolutions.size()
+                      + solvers[wallSite.solver].incomingCount);
+                  wallSites.push_back(wallSite);
+                }
+              }
             }
+            std::sort(wallSites.begin(), wallSites.end());
           }
 
-          template<bool tDoRayTracing>
+          template<bool tUpdateCaches>
           inline void DoStreamAndCollide(const site_t firstIndex, const site_t siteCount,
                                          const LbmParameters* lbmParams,
                                          geometry::LatticeData* latticeData,
                                          lb::MacroscopicPropertyCache& propertyCache)
           {
-            for (site_t siteIndex = firstIndex; siteIndex < (firstIndex + siteCount); siteIndex++)
+            typename std::vector<WallSite>::const_iterator wallSite = FindWallSite(firstIndex);
+            for (site_t siteIndex = firstIndex; siteIndex < (firstIndex + siteCount);
+                siteIndex++, ++wallSite)
             {
               assert(latticeData->GetSite(siteIndex).IsWall());
-              assert(lMatrices.find(siteIndex) != lMatrices.end());
+              assert(wallSite != wallSites.end() && wallSite->siteIndex == siteIndex);
 
               geometry::Site<geometry::LatticeData> site = latticeData->GetSite(siteIndex);
 
-              kernels::HydroVars<typename CollisionType::CKernel> hydroVars(site.GetFOld<LatticeType>());
+              distribn_t fOldBuffer[LatticeType::NUMVECTORS];
+              const distribn_t* fOld = site.GetFOld<LatticeType>(fOldBuffer);
+              kernels::HydroVars<typename CollisionType::CKernel> hydroVars(fOld);
 
               ///< @todo #126 This value of tau will be updated by some kernels within the collider code (e.g. LBGKNN). It would be nicer if tau is handled in a single place.
               hydroVars.tau = lbmParams->GetTau();
@@ -98,6 +117,10 @@ namespace hemelb
               collider.CalculatePreCollision(hydroVars, site);
               collider.Collide(lbmParams, hydroVars);
 
+              if (site.GetSiteData().GetIoletIntersectionData() != 0)
+              {
+                ioletLinkDelegate.SetIolet(site.GetIoletId());
+              }
               for (unsigned int direction = 0; direction < LatticeType::NUMVECTORS; direction++)
               {
                 if (site.HasWall(direction))
@@ -114,36 +137,34 @@ namespace hemelb
                 }
               }
 
-              // The following for loops prepare the data required by DoPostStep
-
-              // TODO: Ideally, this should be done in the loop over directions above
-              // but the f's are permuted by the below making it tricky.
-              unsigned index = 0;
-              for (std::set<Direction>::const_iterator incomingVelocityIter =
-                  incomingVelocities[siteIndex].begin();
-                  incomingVelocityIter != incomingVelocities[siteIndex].end();
-                  ++incomingVelocityIter, ++index)
+              // Everything in the solution but the outgoing distributions streamed to this site,
+              // L^-1 (f*_inverse - K sigma), is known now, so only keep that for DoPostStep.
+              const kernels::FVector<LatticeType>& fPostCollision = hydroVars.GetFPostCollision();
+              distribn_t sigma[LatticeType::NUMVECTORS];
+              for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
               {
-                int inverseDirection = LatticeType::INVERSEDIRECTIONS[*incomingVelocityIter];
-
-                fPostCollision[siteIndex](index) =
-                    hydroVars.GetFPostCollision()[*incomingVelocityIter];
-                fPostCollisionInverseDir[siteIndex](index) =
-                    hydroVars.GetFPostCollision()[inverseDirection];
-                fOld[siteIndex](index) = site.GetFOld<LatticeType>()[*incomingVelocityIter];
+                sigma[direction] = fPostCollision[direction] - (1 - THETA) * fOld[direction];
               }
 
-              for (std::set<Direction>::const_iterator outgoingVelocityIter =
-                  outgoingVelocities[siteIndex].begin();
-                  outgoingVelocityIter != outgoingVelocities[siteIndex].end();
-                  ++outgoingVelocityIter, ++index)
+              const Solver& solver = solvers[wallSite->solver];
+              const distribn_t* row = &solverPool[solver.offset];
+              distribn_t* partialSolution = &partialSolutions[wallSite->partialSolution];
+              for (unsigned i = 0; i < solver.incomingCount; ++i, row += solver.RowLength())
               {
-                fPostCollision[siteIndex](index) =
-                    hydroVars.GetFPostCollision()[*outgoingVelocityIter];
-                fOld[siteIndex](index) = site.GetFOld<LatticeType>()[*outgoingVelocityIter];
+                distribn_t value = 0.0;
+                for (unsigned j = 0; j < solver.incomingCount; ++j)
+                {
+                  value += row[j] * fPostCollision[LatticeType::INVERSEDIRECTIONS[solver.directions[j]]];
+                }
+                const distribn_t* lInverseK = row + solver.incomingCount;
+                for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+                {
+                  value -= lInverseK[direction] * sigma[direction];
+                }
+                partialSolution[i] = value;
               }
 
-              BaseStreamer<JunkYangFactory>::template UpdateMinsAndMaxes<tDoRayTracing>(site,
+              BaseStreamer<JunkYangFactory>::template UpdateMinsAndMaxes<tUpdateCaches>(site,
                                                                                         hydroVars,
                                                                                         lbmParams,
                                                                                         propertyCache);
@@ -151,49 +172,50 @@ namespace hemelb
 
           }
 
-          template<bool tDoRayTracing>
+          template<bool tUpdateCaches>
           inline void DoPostStep(const site_t firstIndex, const site_t siteCount,
                                  const LbmParameters* lbmParams, geometry::LatticeData* latticeData,
                                  lb::MacroscopicPropertyCache& propertyCache)
           {
-            for (site_t siteIndex = firstIndex; siteIndex < (firstIndex + siteCount); siteIndex++)
+            typename std::vector<WallSite>::const_iterator wallSite = FindWallSite(firstIndex);
+            for (site_t siteIndex = firstIndex; siteIndex < (firstIndex + siteCount);
+                siteIndex++, ++wallSite)
             {
               assert(latticeData->GetSite(siteIndex).IsWall());
-              assert(lMatrices.find(siteIndex) != lMatrices.end());
-              assert(luPermutationMatrices.find(siteIndex) != luPermutationMatrices.end());
-
-              ublas::vector<distribn_t> rVector;
-              AssembleRVector(siteIndex, rVector);
-
-              // assemble RHS
-              ublas::vector<distribn_t> systemRHS = fPostCollisionInverseDir[siteIndex] - rVector;
-
-              // lu_substitue will overwrite the RHS with the solution
-              ublas::vector<distribn_t> &systemSolution = systemRHS;
-              lu_substitute(lMatrices[siteIndex],
-                            *luPermutationMatrices[siteIndex],
-                            systemSolution);
-
-              // Update the distribution function for incoming velocities with the solution of the linear system
-              unsigned index = 0;
-              for (std::set<Direction>::const_iterator incomingVelocityIter =
-                  incomingVelocities[siteIndex].begin();
-                  incomingVelocityIter != incomingVelocities[siteIndex].end();
-                  ++incomingVelocityIter, ++index)
+              assert(wallSite != wallSites.end() && wallSite->siteIndex == siteIndex);
+
+              const Solver& solver = solvers[wallSite->solver];
+              const distribn_t* row = &solverPool[solver.offset];
+              const distribn_t* partialSolution = &partialSolutions[wallSite->partialSolution];
+              const stored_distribn_t* fNew =
+                  latticeData->GetFNew(latticeData->GetDistributionIndex<LatticeType>(siteIndex, 0));
+
+              // Finish the solution with the outgoing distributions, which have now been streamed
+              // to this site, and update the distribution function for incoming velocities with it.
+              distribn_t solution[LatticeType::NUMVECTORS];
+              for (unsigned i = 0; i < solver.incomingCount; ++i, row += solver.RowLength())
               {
-                * (latticeData->GetFNew(siteIndex * LatticeType::NUMVECTORS + *incomingVelocityIter)) =
-                    systemSolution[index];
+                const distribn_t* lInverseK = row + solver.incomingCount;
+                distribn_t value = 0.0;
+                for (unsigned j = solver.incomingCount; j < LatticeType::NUMVECTORS; ++j)
+                {
+                  value += lInverseK[solver.directions[j]] * fNew[solver.directions[j]];
+                }
+                solution[i] = partialSolution[i] - THETA * value;
+              }
+              for (unsigned i = 0; i < solver.incomingCount; ++i)
+              {
+                * (latticeData->GetFNew(latticeData->GetDistributionIndex<LatticeType>(siteIndex,
+                                                                                      solver.directions[i]))) =
+                    solution[i];
               }
 
               geometry::Site<geometry::LatticeData> site = latticeData->GetSite(siteIndex);
-              for (std::set<Direction>::const_iterator outgoingVelocityIter =
-                  outgoingVelocities[siteIndex].begin();
-                  outgoingVelocityIter != outgoingVelocities[siteIndex].end();
-                  ++outgoingVelocityIter)
+              for (unsigned j = solver.incomingCount; j < LatticeType::NUMVECTORS; ++j)
               {
-                if (site.HasIolet(*outgoingVelocityIter))
+                if (site.HasIolet(solver.directions[j]))
                 {
-                  ioletLinkDelegate.PostStepLink(latticeData, site, *outgoingVelocityIter);
+                  ioletLinkDelegate.PostStepLink(latticeData, site, solver.directions[j]);
                 }
 
               }
@@ -216,266 +238,184 @@ namespace hemelb
           //! Reference to the lattice object used for initialisation
           const geometry::LatticeData& latticeData;
 
-          //! Sets of incoming velocities (those with an inverse direction crossing a wall boundary)
-          std::map<site_t, std::set<Direction> > incomingVelocities;
-          //! Sets of outgoing velocities (the complement of incomingVelocities)
-          std::map<site_t, std::set<Direction> > outgoingVelocities;
-
-          //! Map containing the K matrices used to assemble both the left-hand- and the right-hand-side of the linear systems for each site
-          std::map<site_t, ublas::matrix<distribn_t> > kMatrices;
-          //! Map containing the linear system left-hand-sides for each site
-          std::map<site_t, ublas::matrix<distribn_t> > lMatrices;
           /**
-           * Map containing the permutations generated by the LU factorisation of each linear system. The permutaation matrices are dinamically allocated
-           * because there isn't a default constructor for ublas::permutation_matrix (unlike other ublas data structures) and the size is not known until
-           * run time.
+           * The cut distance of each incoming velocity (those with an inverse direction crossing
+           * a wall boundary) and -1 for each outgoing one. Sites with the same key have the same
+           * linear system. Keys compare by the link pattern first.
            */
-          std::map<site_t, ublas::permutation_matrix<std::size_t>*> luPermutationMatrices;
-
-          //! Map of postcollision distributions with incoming/outgoing ordering.
-          std::map<site_t, ublas::c_vector<distribn_t, LatticeType::NUMVECTORS> > fPostCollision;
-          //! Map of postcollision distributions for the inverse directions of those in the incoming set of velocities.
-          std::map<site_t, ublas::vector<distribn_t> > fPostCollisionInverseDir;
-          //! Map of distributions in the previous time step with incoming/outgoing ordering.
-          std::map<site_t, ublas::c_vector<distribn_t, LatticeType::NUMVECTORS> > fOld;
+          typedef std::pair<unsigned, std::vector<distribn_t> > SolverKey;
 
           /**
-           * Construct the incoming/outgoing velocity sets for site siteLocalIndex
+           * The solution of a site's linear system, L x = f*_inverse - r, is
            *
-           * @param contiguousSiteIndex Contiguous site index (for this core)
+           *   x = L^-1 f*_inverse - L^-1 K sigma - THETA L^-1 K_outgoing f_outgoing
+           *
+           * so rather than factorising L, keep L^-1 and L^-1 K, packed into one row of the
+           * pool for each incoming velocity: the incomingCount entries of L^-1 then the
+           * NUMVECTORS of L^-1 K, by direction.
            */
-          inline void ConstructVelocitySets(site_t contiguousSiteIndex)
+          struct Solver
           {
-            geometry::Site<const geometry::LatticeData> site =
-                latticeData.GetSite(contiguousSiteIndex);
+              //! The incoming velocities, then the outgoing ones
+              Direction directions[LatticeType::NUMVECTORS];
+              unsigned incomingCount;
+              //! Where the rows start in the pool
+              std::size_t offset;
 
-            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; direction++)
-            {
-              int inverseDirection = LatticeType::INVERSEDIRECTIONS[direction];
-              if (site.HasWall(inverseDirection))
+              unsigned RowLength() const
               {
-                incomingVelocities[contiguousSiteIndex].insert(direction);
+                return incomingCount + LatticeType::NUMVECTORS;
               }
-              else
+          };
+
+          struct WallSite
+          {
+              site_t siteIndex;
+              std::size_t solver;
+              //! Where the site's part-solution, one per incoming velocity, is
+              std::size_t partialSolution;
+
+              bool operator<(const WallSite& other) const
               {
-                outgoingVelocities[contiguousSiteIndex].insert(direction);
+                return siteIndex < other.siteIndex;
               }
-            }
-            fPostCollisionInverseDir[contiguousSiteIndex].resize(incomingVelocities[contiguousSiteIndex].size());
+          };
+
+          //! The distinct solvers, in order of key, and their rows, contiguous
+          std::vector<Solver> solvers;
+          std::vector<distribn_t> solverPool;
+          //! The wall sites, in order of index, and their part-solutions, contiguous
+          std::vector<WallSite> wallSites;
+          std::vector<distribn_t> partialSolutions;
+
+          typename std::vector<WallSite>::const_iterator FindWallSite(site_t siteIndex) const
+          {
+            WallSite key;
+            key.siteIndex = siteIndex;
+            return std::lower_bound(wallSites.begin(), wallSites.end(), key);
           }
 
           /**
-           * Assemble the K matrix for site contiguousSiteIndex.
-           *
-           * K is a rectangular matrix (num_incoming_vels x LatticeType::NUMVECTORS). Our
-           * implementation places the columns corresponding to the set of incoming velocities
-           * first followed by those corresponding to outgoing velocities. This makes easier
-           * handling the subblocks with uBLAS.
-           *
            * @param contiguousSiteIndex Contiguous site index (for this core)
+           * @return The key of the site's linear system
            */
-          inline void AssembleKMatrix(site_t contiguousSiteIndex)
+          SolverKey GetSolverKey(site_t contiguousSiteIndex) const
           {
             geometry::Site<const geometry::LatticeData> site =
                 latticeData.GetSite(contiguousSiteIndex);
 
-            unsigned incomingVelsSetSize = incomingVelocities[contiguousSiteIndex].size();
-
-            kMatrices[contiguousSiteIndex].resize(incomingVelsSetSize, LatticeType::NUMVECTORS);
-
-            /*
-             *  Assemble K(:, 0:num_incoming_velocities-1)
-             */
-            unsigned rowIndex = 0;
-            for (std::set<Direction>::const_iterator rowIndexIncomingVelocity =
-                incomingVelocities[contiguousSiteIndex].begin();
-                rowIndexIncomingVelocity != incomingVelocities[contiguousSiteIndex].end();
-                ++rowIndexIncomingVelocity, ++rowIndex)
+            SolverKey key(0, std::vector<distribn_t>(LatticeType::NUMVECTORS, -1.0));
+            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; direction++)
             {
-              // |c_i|^2, where c_i is the i-th velocity vector
-              const int rowRowdirectionsInnProd = LatticeType::CX[*rowIndexIncomingVelocity]
-                  * LatticeType::CX[*rowIndexIncomingVelocity]
-                  + LatticeType::CY[*rowIndexIncomingVelocity]
-                      * LatticeType::CY[*rowIndexIncomingVelocity]
-                  + LatticeType::CZ[*rowIndexIncomingVelocity]
-                      * LatticeType::CZ[*rowIndexIncomingVelocity];
-
-              unsigned columnIndex = 0;
-              for (std::set<Direction>::const_iterator columnIndexIncomingVelocity =
-                  incomingVelocities[contiguousSiteIndex].begin();
-                  columnIndexIncomingVelocity != incomingVelocities[contiguousSiteIndex].end();
-                  ++columnIndexIncomingVelocity, ++columnIndex)
-              {
-                // |c_i|^2, where c_i is the i-th velocity vector
-                const int colColdirectionsInnProd = LatticeType::CX[*columnIndexIncomingVelocity]
-                    * LatticeType::CX[*columnIndexIncomingVelocity]
-                    + LatticeType::CY[*columnIndexIncomingVelocity]
-                        * LatticeType::CY[*columnIndexIncomingVelocity]
-                    + LatticeType::CZ[*columnIndexIncomingVelocity]
-                        * LatticeType::CZ[*columnIndexIncomingVelocity];
-
-                // (c_i \dot c_j)^2, where c_{i,j} are the {i,j}-th velocity vectors
-                const int rowColdirectionsInnProd = LatticeType::CX[*rowIndexIncomingVelocity]
-                    * LatticeType::CX[*columnIndexIncomingVelocity]
-                    + LatticeType::CY[*rowIndexIncomingVelocity]
-                        * LatticeType::CY[*columnIndexIncomingVelocity]
-                    + LatticeType::CZ[*rowIndexIncomingVelocity]
-                        * LatticeType::CZ[*columnIndexIncomingVelocity];
-
-                assert(site.template GetWallDistance<LatticeType> (LatticeType::INVERSEDIRECTIONS[(Direction) *rowIndexIncomingVelocity]) >= 0);
-                assert(site.template GetWallDistance<LatticeType> (LatticeType::INVERSEDIRECTIONS[(Direction) *rowIndexIncomingVelocity]) < 1);
-
-                kMatrices[contiguousSiteIndex](rowIndex, columnIndex) =
-                    (-3.0 / 2.0)
-                        * (3.0
-                            - 6
-                                * site.template GetWallDistance<LatticeType>(LatticeType::INVERSEDIRECTIONS[(Direction) *rowIndexIncomingVelocity]))
-                        * LatticeType::EQMWEIGHTS[*rowIndexIncomingVelocity]
-                        * ( (rowColdirectionsInnProd * rowColdirectionsInnProd)
-                            - (rowRowdirectionsInnProd / 3.0)
-                            - LatticeType::discreteVelocityVectors[ALPHA][*rowIndexIncomingVelocity]
-                                * LatticeType::discreteVelocityVectors[ALPHA][*rowIndexIncomingVelocity]
-                                * (colColdirectionsInnProd - (DIMENSION / 3.0)));
-
-                assert(fabs(kMatrices[contiguousSiteIndex](rowIndex, columnIndex)) < 1e3);
-              }
-
-              /*
-               * Assemble K(:, num_incoming_velocities:num_incoming_velocities+num_outgoing_velocities-1)
-               */
-              for (std::set<Direction>::const_iterator columnIndexOutgoingVelocity =
-                  outgoingVelocities[contiguousSiteIndex].begin();
-                  columnIndexOutgoingVelocity != outgoingVelocities[contiguousSiteIndex].end();
-                  ++columnIndexOutgoingVelocity, ++columnIndex)
+              int inverseDirection = LatticeType::INVERSEDIRECTIONS[direction];
+              if (site.HasWall(inverseDirection))
               {
-                // |c_i|^2, where c_i is the i-th velocity vector
-                const int colColdirectionsInnProd = LatticeType::CX[*columnIndexOutgoingVelocity]
-                    * LatticeType::CX[*columnIndexOutgoingVelocity]
-                    + LatticeType::CY[*columnIndexOutgoingVelocity]
-                        * LatticeType::CY[*columnIndexOutgoingVelocity]
-                    + LatticeType::CZ[*columnIndexOutgoingVelocity]
-                        * LatticeType::CZ[*columnIndexOutgoingVelocity];
-
-                // (c_i \dot c_j)^2, where c_{i,j} are the {i,j}-th velocity vectors
-                const int rowColdirectionsInnProd = LatticeType::CX[*rowIndexIncomingVelocity]
-                    * LatticeType::CX[*columnIndexOutgoingVelocity]
-                    + LatticeType::CY[*rowIndexIncomingVelocity]
-                        * LatticeType::CY[*columnIndexOutgoingVelocity]
-                    + LatticeType::CZ[*rowIndexIncomingVelocity]
-                        * LatticeType::CZ[*columnIndexOutgoingVelocity];
-
-                assert(site.template GetWallDistance<LatticeType> (LatticeType::INVERSEDIRECTIONS[(Direction) *rowIndexIncomingVelocity]) >= 0);
-                assert(site.template GetWallDistance<LatticeType> (LatticeType::INVERSEDIRECTIONS[(Direction) *rowIndexIncomingVelocity]) < 1);
-
-                kMatrices[contiguousSiteIndex](rowIndex, columnIndex) =
-                    (-3.0 / 2.0)
-                        * (3.0
-                            - 6
-                                * site.template GetWallDistance<LatticeType>(LatticeType::INVERSEDIRECTIONS[(Direction) *rowIndexIncomingVelocity]))
-                        * LatticeType::EQMWEIGHTS[*rowIndexIncomingVelocity]
-                        * ( (rowColdirectionsInnProd * rowColdirectionsInnProd)
-                            - (rowRowdirectionsInnProd / 3.0)
-                            - LatticeType::discreteVelocityVectors[ALPHA][*rowIndexIncomingVelocity]
-                                * LatticeType::discreteVelocityVectors[ALPHA][*rowIndexIncomingVelocity]
-                                * (colColdirectionsInnProd - (DIMENSION / 3.0)));
-
-                assert(fabs(kMatrices[contiguousSiteIndex](rowIndex, columnIndex)) < 1e3);
+                key.first |= 1U << direction;
+                key.second[direction] =
+                    site.template GetWallDistance<LatticeType>(inverseDirection);
+                assert(key.second[direction] >= 0);
+                assert(key.second[direction] < 1);
               }
-
             }
+            return key;
           }
 
           /**
-           * Assemble the L matrix for site contiguousSiteIndex. L is a square matrix (num_incoming_vels x num_incoming_vels)
+           * An element of the K matrix, which is a rectangular matrix (num_incoming_vels x
+           * LatticeType::NUMVECTORS).
            *
-           * @param contiguousSiteIndex Contiguous site index (for this core)
+           * @param row An incoming velocity
+           * @param column Any velocity
+           * @param wallDistance The cut distance along the inverse of the row's velocity
+           * @return
            */
-          inline void AssembleLMatrix(site_t siteLocalIndex)
+          static distribn_t KMatrixElement(Direction row, Direction column,
+                                           distribn_t wallDistance)
           {
-            unsigned incomingVelsSetSize = incomingVelocities[siteLocalIndex].size();
-
-            lMatrices[siteLocalIndex] = ublas::identity_matrix<distribn_t>(incomingVelsSetSize)
-                + THETA
-                    * ublas::subrange(kMatrices[siteLocalIndex],
-                                      0,
-                                      incomingVelsSetSize,
-                                      0,
-                                      incomingVelsSetSize);
+            // |c_i|^2, where c_i is the i-th velocity vector
+            const int rowRowdirectionsInnProd = LatticeType::CX[row] * LatticeType::CX[row]
+                + LatticeType::CY[row] * LatticeType::CY[row]
+                + LatticeType::CZ[row] * LatticeType::CZ[row];
+            const int colColdirectionsInnProd = LatticeType::CX[column] * LatticeType::CX[column]
+                + LatticeType::CY[column] * LatticeType::CY[column]
+                + LatticeType::CZ[column] * LatticeType::CZ[column];
+            // (c_i \dot c_j)^2, where c_{i,j} are the {i,j}-th velocity vectors
+            const int rowColdirectionsInnProd = LatticeType::CX[row] * LatticeType::CX[column]
+                + LatticeType::CY[row] * LatticeType::CY[column]
+                + LatticeType::CZ[row] * LatticeType::CZ[column];
+
+            return (-3.0 / 2.0) * (3.0 - 6 * wallDistance) * LatticeType::EQMWEIGHTS[row]
+                * ( (rowColdirectionsInnProd * rowColdirectionsInnProd)
+                    - (rowRowdirectionsInnProd / 3.0)
+                    - LatticeType::discreteVelocityVectors[ALPHA][row]
+                        * LatticeType::discreteVelocityVectors[ALPHA][row]
+                        * (colColdirectionsInnProd - (DIMENSION / 3.0)));
           }
 
           /**
-           * Compute the LU factorisation of all the L matrices
+           * Assemble the K and L = I + THETA K(:, incoming) matrices of a linear system, and add
+           * L^-1 and L^-1 K to the pool.
+           *
+           * @param key
            */
-          inline void FactoriseLMatrices()
+          void AddSolver(const SolverKey& key)
           {
-            for (std::map<site_t, ublas::matrix<distribn_t> >::iterator iter = lMatrices.begin();
-                iter != lMatrices.end(); ++iter)
+            Solver solver;
+            solver.incomingCount = 0;
+            unsigned outgoingIndex = LatticeType::NUMVECTORS;
+            for (Direction direction = LatticeType::NUMVECTORS; direction-- > 0;)
             {
-              luPermutationMatrices[iter->first] =
-                  new ublas::permutation_matrix<std::size_t>(incomingVelocities[iter->first].size());
-              int ret = lu_factorize(iter->second, *luPermutationMatrices[iter->first]);
-              // If this assertion trips, lMatrices[siteLocalIndex] is singular.
-              assert(ret == 0);
+              if (key.second[direction] < 0)
+              {
+                solver.directions[--outgoingIndex] = direction;
+              }
             }
-          }
-
-          /**
-           * Assemble the sigma vector required to assemble the system RHS. We are not including
-           * the forcing term used in the paper to drive the flow. This might become necessary
-           * for biocolloids.
-           *
-           * @param contiguousSiteIndex Contiguous site index (for this core)
-           * @param sigmaVector sigma vector
-           */
-          inline void AssembleSigmaVector(
-              const site_t contiguousSiteIndex,
-              ublas::c_vector<distribn_t, LatticeType::NUMVECTORS>& sigmaVector) // const
-          {
-            assert(fPostCollision.find(contiguousSiteIndex) != fPostCollision.end());
-            assert(fOld.find(contiguousSiteIndex) != fOld.end());
-            sigmaVector = fPostCollision[contiguousSiteIndex]
-                - (1 - THETA) * fOld[contiguousSiteIndex];
-          }
+            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; direction++)
+            {
+              if (key.second[direction] >= 0)
+              {
+                solver.directions[solver.incomingCount++] = direction;
+              }
+            }
+            solver.offset = solverPool.size();
+            const unsigned incomingCount = solver.incomingCount;
 
-          /**
-           * Assemble the r vector required to assemble the system RHS
-           *
-           * @param contiguousSiteIndex Contiguous site index (for this core)
-           * @param rVector r vector
-           */
-          inline void AssembleRVector(const site_t contiguousSiteIndex,
-                                      ublas::vector<distribn_t>& rVector) //const
-          {
-            ublas::c_vector<distribn_t, LatticeType::NUMVECTORS> sigmaVector;
-            AssembleSigmaVector(contiguousSiteIndex, sigmaVector);
-
-            unsigned incomingVelsSetSize = incomingVelocities[contiguousSiteIndex].size();
-            unsigned outgoingVelsSetSize = outgoingVelocities[contiguousSiteIndex].size();
-
-            ublas::vector<distribn_t> fNew(outgoingVelsSetSize);
-
-            /*
-             *  Assemble a vector with the updated values of the distribution function for the outgoing velocities,
-             *  which have already been streamed
-             */
-            assert(fNew.size() == outgoingVelocities[contiguousSiteIndex].size());
-            unsigned index = 0;
-            for (std::set<Direction>::const_iterator outgoingDirIter =
-                outgoingVelocities[contiguousSiteIndex].begin();
-                outgoingDirIter != outgoingVelocities[contiguousSiteIndex].end();
-                ++outgoingDirIter, ++index)
+            // The right-hand sides are [I | K], so the solutions are [L^-1 | L^-1 K].
+            ublas::matrix<distribn_t> lMatrix(incomingCount, incomingCount);
+            ublas::matrix<distribn_t> solution(incomingCount, solver.RowLength());
+            for (unsigned i = 0; i < incomingCount; ++i)
             {
-              fNew[index] = *latticeData.GetFNew(contiguousSiteIndex * LatticeType::NUMVECTORS
-                  + *outgoingDirIter);
+              const Direction row = solver.directions[i];
+              for (unsigned j = 0; j < incomingCount; ++j)
+              {
+                lMatrix(i, j) = (i == j ?
+                  1.0 :
+                  0.0) + THETA * KMatrixElement(row, solver.directions[j], key.second[row]);
+                solution(i, j) = (i == j ?
+                  1.0 :
+                  0.0);
+              }
+              for (Direction column = 0; column < LatticeType::NUMVECTORS; ++column)
+              {
+                solution(i, incomingCount + column) = KMatrixElement(row, column, key.second[row]);
+                assert(fabs(solution(i, incomingCount + column)) < 1e3);
+              }
             }
 
-            rVector = THETA
-                * ublas::prod(ublas::subrange(kMatrices[contiguousSiteIndex],
-                                              0,
-                                              incomingVelsSetSize,
-                                              incomingVelsSetSize,
-                                              LatticeType::NUMVECTORS),
-                              fNew) + ublas::prod(kMatrices[contiguousSiteIndex], sigmaVector);
+            ublas::permutation_matrix<std::size_t> permutation(incomingCount);
+            int ret = lu_factorize(lMatrix, permutation);
+            // If this assertion trips, the L matrix is singular.
+            assert(ret == 0);
+            lu_substitute(lMatrix, permutation, solution);
+
+            for (unsigned i = 0; i < incomingCount; ++i)
+            {
+              for (unsigned j = 0; j < solver.RowLength(); ++j)
+              {
+                solverPool.push_back(solution(i, j));
+              }
+            }
+            solvers.push_back(solver);
           }
       };
 
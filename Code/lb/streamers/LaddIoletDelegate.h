@@ -25,10 +25,20 @@ namespace hemelb
 
           LaddIoletDelegate(CollisionType& delegatorCollider, kernels::InitParams& initParams) :
               SimpleBounceBackDelegate<CollisionType>(delegatorCollider, initParams),
-                  bValues(initParams.boundaryObject)
+                  bValues(initParams.boundaryObject), iolet(NULL), timeStep(0)
           {
           }
 
+          /**
+           * Look up the iolet the next sites are at, and the time step.
+           * @param ioletId
+           */
+          inline void SetIolet(int ioletId)
+          {
+            iolet = dynamic_cast<iolets::InOutLetVelocity*>(bValues->GetLocalIolet(ioletId));
+            timeStep = bValues->GetTimeStep();
+          }
+
           inline void StreamLink(const LbmParameters* lbmParams,
                                  geometry::LatticeData* const latticeData,
                                  const geometry::Site<geometry::LatticeData>& site,
@@ -45,9 +55,7 @@ namespace hemelb
             // where u is the velocity of the boundary half way along the
             // link and a1_i = w_1 / cs2
 
-            int boundaryId = site.GetIoletId();
-            iolets::InOutLetVelocity* iolet =
-                dynamic_cast<iolets::InOutLetVelocity*>(bValues->GetLocalIolet(boundaryId));
+            // The iolet was looked up in SetIolet.
             LatticePosition sitePos(site.GetGlobalSiteCoords());
 
             LatticePosition halfWay(sitePos);
@@ -55,7 +63,7 @@ namespace hemelb
             halfWay.y += 0.5 * LatticeType::CY[ii];
             halfWay.z += 0.5 * LatticeType::CZ[ii];
 
-            LatticeVelocity wallMom(iolet->GetVelocity(halfWay, bValues->GetTimeStep()));
+            LatticeVelocity wallMom(iolet->GetVelocity(halfWay, timeStep));
             //TODO: Add site.GetGlobalSiteCoords() as a first argument?
 
             if (CollisionType::CKernel::LatticeType::IsLatticeCompressible())
@@ -67,12 +75,15 @@ namespace hemelb
                 * (wallMom.x * LatticeType::CX[ii] + wallMom.y * LatticeType::CY[ii]
                     + wallMom.z * LatticeType::CZ[ii]) / Cs2;
 
-            * (latticeData->GetFNew(SimpleBounceBackDelegate<CollisionImpl>::GetBBIndex(site.GetIndex(),
+            * (latticeData->GetFNew(SimpleBounceBackDelegate<CollisionImpl>::GetBBIndex(latticeData,
+                                                                                        site.GetIndex(),
                                                                                         ii))) =
                 hydroVars.GetFPostCollision()[ii] - correction;
           }
         private:
           iolets::BoundaryValues* bValues;
+          iolets::InOutLetVelocity* iolet;
+          LatticeTimeStep timeStep;
       };
 
     }
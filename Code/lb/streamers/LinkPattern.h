@@ -0,0 +1,68 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_LB_STREAMERS_LINKPATTERN_H
+#define HEMELB_LB_STREAMERS_LINKPATTERN_H
+
+#include "units.h"
+
+namespace hemelb
+{
+  namespace lb
+  {
+    namespace streamers
+    {
+      /**
+       * The directions of a run of sites with the same links (see
+       * geometry::LatticeData::GetLinkPatternRange), split by which delegate streams them, so
+       * that a streamer can loop over each list for every site of the run instead of testing
+       * every direction of every site.
+       *
+       * A direction whose link crosses both an iolet and the wall is an iolet direction.
+       */
+      template<class LatticeType>
+      class LinkPattern
+      {
+        public:
+          /**
+           * @param wallIntersection The wall links to separate out, as in SiteData, or 0 for none
+           * @param ioletIntersection The iolet links to separate out, as in SiteData, or 0 for none
+           */
+          LinkPattern(uint32_t wallIntersection, uint32_t ioletIntersection) :
+              bulkCount(0), wallCount(0), ioletCount(0)
+          {
+            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+            {
+              // Direction 0 has no link, so no bit.
+              const uint32_t mask = direction == 0 ?
+                0 :
+                1U << (direction - 1);
+              if ( (ioletIntersection & mask) != 0)
+              {
+                ioletDirections[ioletCount++] = direction;
+              }
+              else if ( (wallIntersection & mask) != 0)
+              {
+                wallDirections[wallCount++] = direction;
+              }
+              else
+              {
+                bulkDirections[bulkCount++] = direction;
+              }
+            }
+          }
+
+          Direction bulkDirections[LatticeType::NUMVECTORS];
+          Direction wallDirections[LatticeType::NUMVECTORS];
+          Direction ioletDirections[LatticeType::NUMVECTORS];
+          unsigned bulkCount;
+          unsigned wallCount;
+          unsigned ioletCount;
+      };
+    }
+  }
+}
+
+#endif /* HEMELB_LB_STREAMERS_LINKPATTERN_H */
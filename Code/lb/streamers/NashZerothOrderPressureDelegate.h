@@ -23,24 +23,28 @@ namespace hemelb
           typedef typename CollisionType::CKernel::LatticeType LatticeType;
 
           NashZerothOrderPressureDelegate(CollisionType& delegatorCollider, kernels::InitParams& initParams) :
-            collider(delegatorCollider), iolet(*initParams.boundaryObject)
+            collider(delegatorCollider), iolet(*initParams.boundaryObject), ghostDensity(0.0)
           {
           }
 
+          /**
+           * Look up the density and normal of the iolet the next sites are at.
+           * @param ioletId
+           */
+          inline void SetIolet(int ioletId)
+          {
+            ghostDensity = iolet.GetBoundaryDensity(ioletId);
+            ioletNormal = iolet.GetLocalIolet(ioletId)->GetNormal();
+          }
+
           inline void StreamLink(const LbmParameters* lbmParams,
                                  geometry::LatticeData* const latticeData,
                                  const geometry::Site<geometry::LatticeData>& site,
                                  kernels::HydroVars<typename CollisionType::CKernel>& hydroVars,
                                  const Direction& direction)
           {
-            int boundaryId = site.GetIoletId();
-
-            // Set the density at the "ghost" site to be the density of the iolet.
-            distribn_t ghostDensity = iolet.GetBoundaryDensity(boundaryId);
-
-            // Calculate the velocity at the ghost site, as the component normal to the iolet.
-            util::Vector3D<float> ioletNormal = iolet.GetLocalIolet(boundaryId)->GetNormal();
-
+            // The density at the "ghost" site is the density of the iolet, and the velocity
+            // there the component of the site's normal to the iolet, both set up in SetIolet.
             // Note that the division by density compensates for the fact that v_x etc have momentum
             // not velocity.
             distribn_t component = (hydroVars.momentum / hydroVars.density).Dot(ioletNormal);
@@ -49,7 +53,8 @@ namespace hemelb
             // TODO having to give 0 as an argument is also ugly.
             // TODO it's ugly that we have to give hydroVars a nonsense distribution vector
             // that doesn't get used.
-            kernels::HydroVars<typename CollisionType::CKernel> ghostHydrovars(site.GetFOld<LatticeType> ());
+            distribn_t fOldBuffer[LatticeType::NUMVECTORS];
+            kernels::HydroVars<typename CollisionType::CKernel> ghostHydrovars(site.GetFOld<LatticeType> (fOldBuffer));
 
             ghostHydrovars.density = ghostDensity;
             ghostHydrovars.momentum = ioletNormal * component * ghostDensity;
@@ -58,12 +63,50 @@ namespace hemelb
 
             Direction unstreamed = LatticeType::INVERSEDIRECTIONS[direction];
 
-            *latticeData->GetFNew(site.GetIndex() * LatticeType::NUMVECTORS + unstreamed)
+            *latticeData->GetFNew(latticeData->GetDistributionIndex<LatticeType>(site.GetIndex(), unstreamed))
                 = ghostHydrovars.GetFEq()[unstreamed];
           }
+#ifdef HEMELB_USE_PULL_STREAMING
+          /**
+           * As StreamLink, setting the distribution in f that streams back to the site across the
+           * link instead. The site's velocity is that of its distributions as stored after the last
+           * collision, the one StreamLink would have used in the last step, while the density at
+           * the ghost site is the iolet's now.
+           */
+          inline void PullLink(const LbmParameters* lbmParams,
+                               geometry::LatticeData* const latticeData,
+                               const geometry::Site<geometry::LatticeData>& site,
+                               distribn_t* f,
+                               const Direction& direction)
+          {
+            distribn_t fOldBuffer[LatticeType::NUMVECTORS];
+            kernels::HydroVars<typename CollisionType::CKernel> ghostHydrovars(site.GetFOld<LatticeType> (fOldBuffer));
+            distribn_t density;
+            util::Vector3D<distribn_t> momentum;
+            LatticeType::CalculateDensityAndMomentum(ghostHydrovars.f,
+                                                     density,
+                                                     momentum.x,
+                                                     momentum.y,
+                                                     momentum.z);
+
+            distribn_t component = (momentum / density).Dot(ioletNormal);
+
+            ghostHydrovars.density = ghostDensity;
+            ghostHydrovars.momentum = ioletNormal * component * ghostDensity;
+
+            collider.kernel.CalculateFeq(ghostHydrovars, 0);
+
+            Direction unstreamed = LatticeType::INVERSEDIRECTIONS[direction];
+            f[unstreamed] = ghostHydrovars.GetFEq()[unstreamed];
+          }
+#endif
+
         protected:
           CollisionType& collider;
           iolets::BoundaryValues& iolet;
+          //! The density and normal of the iolet the sites are at, from SetIolet.
+          distribn_t ghostDensity;
+          util::Vector3D<float> ioletNormal;
       };
     }
   }
@@ -24,9 +24,11 @@ namespace hemelb
           typedef CollisionImpl CollisionType;
           typedef typename CollisionType::CKernel::LatticeType LatticeType;
 
-          static inline site_t GetBBIndex(site_t siteIndex, int direction)
+          static inline site_t GetBBIndex(const geometry::LatticeData* latticeData,
+                                          site_t siteIndex, int direction)
           {
-            return (siteIndex * LatticeType::NUMVECTORS) + LatticeType::INVERSEDIRECTIONS[direction];
+            return latticeData->GetDistributionIndex<LatticeType>(siteIndex,
+                                                                  LatticeType::INVERSEDIRECTIONS[direction]);
           }
 
           SimpleBounceBackDelegate(CollisionType& delegatorCollider, kernels::InitParams& initParams)
@@ -40,9 +42,20 @@ namespace hemelb
                                  const Direction& direction)
           {
             // Propagate the outgoing post-collisional f into the opposite direction.
-            * (latticeData->GetFNew(GetBBIndex(site.GetIndex(), direction))) = hydroVars.GetFPostCollision()[direction];
+            * (latticeData->GetFNew(GetBBIndex(latticeData, site.GetIndex(), direction))) = hydroVars.GetFPostCollision()[direction];
           }
 
+#ifdef HEMELB_USE_PULL_STREAMING
+          inline void PullLink(const LbmParameters* lbmParams,
+                               geometry::LatticeData* const latticeData,
+                               const geometry::Site<geometry::LatticeData>& site,
+                               distribn_t* f,
+                               const Direction& direction)
+          {
+            // The pulled distribution is already the one bounced back.
+          }
+#endif
+
       };
 
     }
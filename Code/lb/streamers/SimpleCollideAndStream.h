@@ -37,18 +37,35 @@ namespace hemelb
 
           }
 
-          template<bool tDoRayTracing>
+          void SetPrefetchDistance(site_t distance)
+          {
+            bulkLinkDelegate.SetPrefetchDistance(distance);
+          }
+
+          template<bool tUpdateCaches>
           inline void DoStreamAndCollide(const site_t firstIndex,
                                          const site_t siteCount,
                                          const LbmParameters* lbmParams,
                                          geometry::LatticeData* latDat,
                                          lb::MacroscopicPropertyCache& propertyCache)
           {
-            for (site_t siteIndex = firstIndex; siteIndex < (firstIndex + siteCount); siteIndex++)
+            const site_t endIndex = firstIndex + siteCount;
+#ifdef HEMELB_USE_PULL_STREAMING
+            const bool domainEdge = firstIndex >= latDat->GetMidDomainSiteCount();
+#endif
+            for (site_t siteIndex = firstIndex; siteIndex < endIndex; siteIndex++)
             {
+              bulkLinkDelegate.PrefetchStreamedLinks(latDat, siteIndex, endIndex);
+
               geometry::Site<geometry::LatticeData> site = latDat->GetSite(siteIndex);
 
-              const distribn_t* lFOld = site.GetFOld<LatticeType> ();
+              distribn_t fOldBuffer[LatticeType::NUMVECTORS];
+#ifdef HEMELB_USE_PULL_STREAMING
+              bulkLinkDelegate.PullLinks(site, fOldBuffer);
+              const distribn_t* lFOld = fOldBuffer;
+#else
+              const distribn_t* lFOld = site.GetFOld<LatticeType> (fOldBuffer);
+#endif
 
               kernels::HydroVars<typename CollisionType::CKernel> hydroVars(lFOld);
 
@@ -59,19 +76,23 @@ namespace hemelb
 
               collider.Collide(lbmParams, hydroVars);
 
+#ifdef HEMELB_USE_PULL_STREAMING
+              bulkLinkDelegate.StoreLinks(latDat, site, hydroVars.GetFPostCollision().f, domainEdge);
+#else
               for (unsigned int ii = 0; ii < LatticeType::NUMVECTORS; ii++)
               {
                 bulkLinkDelegate.StreamLink(lbmParams, latDat, site, hydroVars, ii);
               }
+#endif
 
-              BaseStreamer<SimpleCollideAndStream>::template UpdateMinsAndMaxes<tDoRayTracing>(site,
+              BaseStreamer<SimpleCollideAndStream>::template UpdateMinsAndMaxes<tUpdateCaches>(site,
                                                                                                hydroVars,
                                                                                                lbmParams,
                                                                                                propertyCache);
             }
           }
 
-          template<bool tDoRayTracing>
+          template<bool tUpdateCaches>
           inline void DoPostStep(const site_t iFirstIndex,
                                  const site_t iSiteCount,
                                  const LbmParameters* iLbmParams,
@@ -21,10 +21,53 @@ namespace hemelb
           typedef CollisionImpl CollisionType;
           typedef typename CollisionType::CKernel::LatticeType LatticeType;
 
-          SimpleCollideAndStreamDelegate(CollisionType& delegatorCollider, kernels::InitParams& initParams)
+          SimpleCollideAndStreamDelegate(CollisionType& delegatorCollider, kernels::InitParams& initParams) :
+              prefetchDistance(HEMELB_STREAMING_PREFETCH_DISTANCE)
           {
           }
 
+          /**
+           * How many sites ahead of the one being streamed PrefetchStreamedLinks fetches the
+           * cache lines it will stream to; 0 not to prefetch. HEMELB_STREAMING_PREFETCH_DISTANCE
+           * by default. hemelb_bench -p times a range of distances, to tune it for a machine.
+           */
+          site_t GetPrefetchDistance() const
+          {
+            return prefetchDistance;
+          }
+
+          void SetPrefetchDistance(site_t distance)
+          {
+            prefetchDistance = distance;
+          }
+
+          /**
+           * Prefetch, for writing, the distributions that the site prefetch distance ahead of
+           * siteIndex will stream to, if it's before endIndex. The neighbour indices are read in
+           * order, but the stores through them are scattered over the lattice where the hardware
+           * prefetchers can't follow them. With pull streaming it's the loads that are
+           * scattered, so the distributions the site will pull are prefetched for reading.
+           */
+          inline void PrefetchStreamedLinks(geometry::LatticeData* const latticeData,
+                                            const site_t siteIndex, const site_t endIndex) const
+          {
+#if defined(__GNUC__)
+            const site_t aheadIndex = siteIndex + prefetchDistance;
+            if (prefetchDistance > 0 && aheadIndex < endIndex)
+            {
+              const geometry::Site<geometry::LatticeData> aheadSite = latticeData->GetSite(aheadIndex);
+              for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+              {
+#ifdef HEMELB_USE_PULL_STREAMING
+                __builtin_prefetch(aheadSite.GetPulledFOldAddress<LatticeType>(direction), 0);
+#else
+                __builtin_prefetch(latticeData->GetFNew(aheadSite.GetStreamedIndex<LatticeType>(direction)), 1);
+#endif
+              }
+            }
+#endif
+          }
+
           inline void StreamLink(const LbmParameters* lbmParams,
                                  geometry::LatticeData* const latticeData,
                                  const geometry::Site<geometry::LatticeData>& site,
@@ -35,6 +78,75 @@ namespace hemelb
                 = hydroVars.GetFPostCollision()[direction];
           }
 
+#ifdef HEMELB_USE_PULL_STREAMING
+          /**
+           * Pull streaming: gather the distributions streaming to the site, as its neighbours
+           * stored them after colliding in the last step, into f.
+           */
+          inline void PullLinks(const geometry::Site<geometry::LatticeData>& site, distribn_t* f) const
+          {
+            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+            {
+              f[direction] = site.GetPulledFOld<LatticeType>(direction);
+            }
+          }
+
+          /**
+           * Pull streaming: store the site's post-collision distribution in the direction in its
+           * own place, for the neighbour it streams to to pull. Only domain-edge sites have
+           * neighbours on other processors, whose distributions are also stored to be sent.
+           */
+          inline void StoreLink(geometry::LatticeData* const latticeData,
+                                const geometry::Site<geometry::LatticeData>& site,
+                                const distribn_t fPostCollision, const Direction& direction,
+                                const bool domainEdge)
+          {
+            *latticeData->GetFNew(latticeData->GetDistributionIndex<LatticeType>(site.GetIndex(),
+                                                                                 direction)) =
+                fPostCollision;
+            if (domainEdge)
+            {
+              const site_t streamedIndex = site.GetStreamedIndex<LatticeType>(direction);
+              if (streamedIndex > latticeData->GetLocalFluidSiteCount() * LatticeType::NUMVECTORS)
+              {
+                *latticeData->GetFNew(streamedIndex) = fPostCollision;
+              }
+            }
+          }
+
+          /**
+           * Pull streaming: StoreLink in every direction or, with
+           * HEMELB_USE_COMPRESSED_COLD_SITES, compress them if the site is one of the compressed
+           * ones, which are never at the domain edge.
+           * @param fPostCollision The site's post-collision distributions
+           * @param stride How far apart they are in fPostCollision, e.g. the width of a batch
+           */
+          inline void StoreLinks(geometry::LatticeData* const latticeData,
+                                 const geometry::Site<geometry::LatticeData>& site,
+                                 const distribn_t* fPostCollision, const bool domainEdge,
+                                 const unsigned stride = 1)
+          {
+#ifdef HEMELB_USE_COMPRESSED_COLD_SITES
+            if (latticeData->IsCompressed(site.GetIndex()))
+            {
+              distribn_t f[LatticeType::NUMVECTORS];
+              for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+              {
+                f[direction] = fPostCollision[direction * stride];
+              }
+              latticeData->StoreCompressedFNew<LatticeType>(site.GetIndex(), f);
+              return;
+            }
+#endif
+            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+            {
+              StoreLink(latticeData, site, fPostCollision[direction * stride], direction, domainEdge);
+            }
+          }
+#endif
+
+        private:
+          site_t prefetchDistance;
       };
 
     }
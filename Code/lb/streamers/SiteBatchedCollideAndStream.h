@@ -0,0 +1,229 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_LB_STREAMERS_SITEBATCHEDCOLLIDEANDSTREAM_H
+#define HEMELB_LB_STREAMERS_SITEBATCHEDCOLLIDEANDSTREAM_H
+
+#include "lb/streamers/BaseStreamer.h"
+#include "lb/streamers/SimpleCollideAndStream.h"
+#include "lb/kernels/BatchedLBGK.h"
+#include "lb/kernels/LBGK.h"
+#include "lb/collisions/Normal.h"
+
+namespace hemelb
+{
+  namespace lb
+  {
+    namespace streamers
+    {
+      /**
+       * SiteBatchedCollideAndStream: does the same as SimpleCollideAndStream for LBGK collisions,
+       * but collides BatchedLBGK::WIDTH sites at once using the batched kernel. Any sites left
+       * over at the end of a range are done one at a time.
+       */
+      template<typename CollisionImpl>
+      class SiteBatchedCollideAndStream : public BaseStreamer<SiteBatchedCollideAndStream<CollisionImpl> >
+      {
+        public:
+          typedef CollisionImpl CollisionType;
+
+        private:
+          typedef typename CollisionType::CKernel::LatticeType LatticeType;
+          typedef kernels::BatchedLBGK<LatticeType> BatchKernel;
+          static const unsigned WIDTH = BatchKernel::WIDTH;
+
+          CollisionType collider;
+          SimpleCollideAndStreamDelegate<CollisionType> bulkLinkDelegate;
+
+        public:
+          SiteBatchedCollideAndStream(kernels::InitParams& initParams) :
+            collider(initParams), bulkLinkDelegate(collider, initParams)
+          {
+
+          }
+
+          void SetPrefetchDistance(site_t distance)
+          {
+            bulkLinkDelegate.SetPrefetchDistance(distance);
+          }
+
+          template<bool tUpdateCaches>
+          inline void DoStreamAndCollide(const site_t firstIndex,
+                                         const site_t siteCount,
+                                         const LbmParameters* lbmParams,
+                                         geometry::LatticeData* latDat,
+                                         lb::MacroscopicPropertyCache& propertyCache)
+          {
+            const site_t endIndex = firstIndex + siteCount;
+            const site_t batchedEnd = endIndex - (siteCount % WIDTH);
+#ifdef HEMELB_USE_PULL_STREAMING
+            const bool domainEdge = firstIndex >= latDat->GetMidDomainSiteCount();
+#endif
+            typename BatchKernel::BatchHydroVars batch;
+
+            for (site_t batchStart = firstIndex; batchStart < batchedEnd; batchStart += WIDTH)
+            {
+              for (unsigned lane = 0; lane < WIDTH; ++lane)
+              {
+                const geometry::Site<geometry::LatticeData> site = latDat->GetSite(batchStart + lane);
+                for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+                {
+#ifdef HEMELB_USE_PULL_STREAMING
+                  batch.f[direction * WIDTH + lane] = site.GetPulledFOld<LatticeType>(direction);
+#else
+                  batch.f[direction * WIDTH + lane] = site.GetFOld<LatticeType>(direction);
+#endif
+                }
+              }
+
+              BatchKernel::CalculateDensityMomentumFeq(batch);
+              BatchKernel::Collide(lbmParams, batch);
+
+              // As in UpdateMinsAndMaxes, check for stability while the values are in cache.
+              bool allPositive = true;
+              for (unsigned index = 0; index < LatticeType::NUMVECTORS * WIDTH; ++index)
+              {
+                allPositive &= (batch.fPostCollision[index] > 0.0);
+              }
+              if (!allPositive)
+              {
+                propertyCache.NoteNonPositiveDistribution();
+              }
+
+              for (unsigned lane = 0; lane < WIDTH; ++lane)
+              {
+                bulkLinkDelegate.PrefetchStreamedLinks(latDat, batchStart + lane, endIndex);
+
+                geometry::Site<geometry::LatticeData> site = latDat->GetSite(batchStart + lane);
+#ifdef HEMELB_USE_PULL_STREAMING
+                bulkLinkDelegate.StoreLinks(latDat, site, batch.fPostCollision + lane, domainEdge, WIDTH);
+#else
+                for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+                {
+                  *latDat->GetFNew(site.GetStreamedIndex<LatticeType>(direction)) =
+                      batch.fPostCollision[direction * WIDTH + lane];
+                }
+#endif
+
+                if (tUpdateCaches
+                    && (propertyCache.DensityExtremesRequired() || propertyCache.RelativeChangeRequired()
+                        || propertyCache.IsSiteCached(batchStart + lane)))
+                {
+                  UpdateMinsAndMaxesForLane<tUpdateCaches>(site, batch, lane, lbmParams, propertyCache);
+                }
+              }
+            }
+
+            for (site_t siteIndex = batchedEnd; siteIndex < endIndex; siteIndex++)
+            {
+              bulkLinkDelegate.PrefetchStreamedLinks(latDat, siteIndex, endIndex);
+
+              geometry::Site<geometry::LatticeData> site = latDat->GetSite(siteIndex);
+
+              distribn_t fOldBuffer[LatticeType::NUMVECTORS];
+#ifdef HEMELB_USE_PULL_STREAMING
+              bulkLinkDelegate.PullLinks(site, fOldBuffer);
+              kernels::HydroVars<typename CollisionType::CKernel> hydroVars(fOldBuffer);
+#else
+              kernels::HydroVars<typename CollisionType::CKernel> hydroVars(site.GetFOld<LatticeType>(fOldBuffer));
+#endif
+
+              hydroVars.tau = lbmParams->GetTau();
+
+              collider.CalculatePreCollision(hydroVars, site);
+
+              collider.Collide(lbmParams, hydroVars);
+
+#ifdef HEMELB_USE_PULL_STREAMING
+              bulkLinkDelegate.StoreLinks(latDat, site, hydroVars.GetFPostCollision().f, domainEdge);
+#else
+              for (unsigned int ii = 0; ii < LatticeType::NUMVECTORS; ii++)
+              {
+                bulkLinkDelegate.StreamLink(lbmParams, latDat, site, hydroVars, ii);
+              }
+#endif
+
+              BaseStreamer<SiteBatchedCollideAndStream>::template UpdateMinsAndMaxes<tUpdateCaches>(site,
+                                                                                                    hydroVars,
+                                                                                                    lbmParams,
+                                                                                                    propertyCache);
+            }
+          }
+
+          template<bool tUpdateCaches>
+          inline void DoPostStep(const site_t iFirstIndex,
+                                 const site_t iSiteCount,
+                                 const LbmParameters* iLbmParams,
+                                 geometry::LatticeData* bLatDat,
+                                 lb::MacroscopicPropertyCache& propertyCache)
+          {
+
+          }
+
+        private:
+          /**
+           * Unpack one lane of the batch into a HydroVars object so that the property cache can
+           * be filled in exactly as for the unbatched streamers.
+           */
+          template<bool tUpdateCaches>
+          inline void UpdateMinsAndMaxesForLane(const geometry::Site<geometry::LatticeData>& site,
+                                                const typename BatchKernel::BatchHydroVars& batch,
+                                                unsigned lane,
+                                                const LbmParameters* lbmParams,
+                                                lb::MacroscopicPropertyCache& propertyCache)
+          {
+            distribn_t f[LatticeType::NUMVECTORS];
+            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+            {
+              f[direction] = batch.f[direction * WIDTH + lane];
+            }
+
+            kernels::HydroVars<typename CollisionType::CKernel> hydroVars(f);
+            hydroVars.tau = lbmParams->GetTau();
+            hydroVars.density = batch.density[lane];
+            hydroVars.momentum = util::Vector3D<distribn_t>(batch.momentumX[lane],
+                                                            batch.momentumY[lane],
+                                                            batch.momentumZ[lane]);
+            hydroVars.velocity = hydroVars.momentum / hydroVars.density;
+
+            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+            {
+              const distribn_t f_eq = batch.f_eq[direction * WIDTH + lane];
+              hydroVars.SetFEq(direction, f_eq);
+              hydroVars.SetFNeq(direction, f[direction] - f_eq);
+              hydroVars.SetFPostCollision(direction, batch.fPostCollision[direction * WIDTH + lane]);
+            }
+
+            BaseStreamer<SiteBatchedCollideAndStream>::template UpdateMinsAndMaxes<tUpdateCaches>(site,
+                                                                                                  hydroVars,
+                                                                                                  lbmParams,
+                                                                                                  propertyCache);
+          }
+      };
+
+      /**
+       * BulkCollideAndStream: the streamer used for mid-fluid sites. This is
+       * SimpleCollideAndStream unless the build selects a HEMELB_BULK_SIMD instruction set, in
+       * which case LBGK collisions are done in site batches.
+       */
+      template<typename CollisionImpl>
+      struct BulkCollideAndStream
+      {
+          typedef SimpleCollideAndStream<CollisionImpl> Type;
+      };
+
+#if defined(HEMELB_BULK_SIMD_AVX2) || defined(HEMELB_BULK_SIMD_AVX512)
+      template<typename LatticeType>
+      struct BulkCollideAndStream<collisions::Normal<kernels::LBGK<LatticeType> > >
+      {
+          typedef SiteBatchedCollideAndStream<collisions::Normal<kernels::LBGK<LatticeType> > > Type;
+      };
+#endif
+    }
+  }
+}
+
+#endif /* HEMELB_LB_STREAMERS_SITEBATCHEDCOLLIDEANDSTREAM_H */
@@ -8,7 +8,9 @@
 #define HEMELB_LB_STREAMERS_STREAMERTYPEFACTORY_H
 
 #include "lb/kernels/BaseKernel.h"
+#include <algorithm>
 #include "lb/streamers/BaseStreamer.h"
+#include "lb/streamers/LinkPattern.h"
 #include "lb/streamers/SimpleCollideAndStreamDelegate.h"
 
 namespace hemelb
@@ -45,64 +47,90 @@ namespace hemelb
 
           }
 
-          template<bool tDoRayTracing>
+          template<bool tUpdateCaches>
           inline void DoStreamAndCollide(const site_t firstIndex,
                                          const site_t siteCount,
                                          const LbmParameters* lbmParams,
                                          geometry::LatticeData* latDat,
                                          lb::MacroscopicPropertyCache& propertyCache)
           {
-            for (site_t siteIndex = firstIndex; siteIndex < (firstIndex + siteCount); siteIndex++)
+            const site_t endIndex = firstIndex + siteCount;
+#ifdef HEMELB_USE_PULL_STREAMING
+            const bool domainEdge = firstIndex >= latDat->GetMidDomainSiteCount();
+#endif
+            for (site_t siteIndex = firstIndex; siteIndex < endIndex;)
             {
-              geometry::Site<geometry::LatticeData> site = latDat->GetSite(siteIndex);
+              // Every site of the run has the same links, so sort its directions once.
+              const geometry::LinkPatternRange& run = *latDat->GetLinkPatternRange(siteIndex);
+              const LinkPattern<LatticeType> links(run.wallIntersection, 0);
+              const site_t runEnd = std::min(endIndex, run.firstSite + run.siteCount);
 
-              const distribn_t* fOld = site.GetFOld<LatticeType> ();
+              for (; siteIndex < runEnd; siteIndex++)
+              {
+                geometry::Site<geometry::LatticeData> site = latDat->GetSite(siteIndex);
 
-              kernels::HydroVars<typename CollisionType::CKernel> hydroVars(fOld);
+                distribn_t fOldBuffer[LatticeType::NUMVECTORS];
+#ifdef HEMELB_USE_PULL_STREAMING
+                bulkLinkDelegate.PullLinks(site, fOldBuffer);
+                for (unsigned link = 0; link < links.wallCount; ++link)
+                {
+                  wallLinkDelegate.PullLink(lbmParams, latDat, site, fOldBuffer, links.wallDirections[link]);
+                }
+                const distribn_t* fOld = fOldBuffer;
+#else
+                const distribn_t* fOld = site.GetFOld<LatticeType> (fOldBuffer);
+#endif
 
-              ///< @todo #126 This value of tau will be updated by some kernels within the collider code (e.g. LBGKNN). It would be nicer if tau is handled in a single place.
-              hydroVars.tau = lbmParams->GetTau();
+                kernels::HydroVars<typename CollisionType::CKernel> hydroVars(fOld);
 
-              collider.CalculatePreCollision(hydroVars, site);
+                ///< @todo #126 This value of tau will be updated by some kernels within the collider code (e.g. LBGKNN). It would be nicer if tau is handled in a single place.
+                hydroVars.tau = lbmParams->GetTau();
 
-              collider.Collide(lbmParams, hydroVars);
+                collider.CalculatePreCollision(hydroVars, site);
 
-              for (Direction ii = 0; ii < LatticeType::NUMVECTORS; ii++)
-              {
-                if (site.HasWall(ii))
+                collider.Collide(lbmParams, hydroVars);
+
+#ifdef HEMELB_USE_PULL_STREAMING
+                for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
                 {
-                  wallLinkDelegate.StreamLink(lbmParams, latDat, site, hydroVars, ii);
+                  bulkLinkDelegate.StoreLink(latDat, site, hydroVars.GetFPostCollision()[direction], direction, domainEdge);
                 }
-                else
+#else
+                for (unsigned link = 0; link < links.wallCount; ++link)
                 {
-                  bulkLinkDelegate.StreamLink(lbmParams, latDat, site, hydroVars, ii);
+                  wallLinkDelegate.StreamLink(lbmParams, latDat, site, hydroVars, links.wallDirections[link]);
                 }
-              }
 
-              //TODO: Necessary to specify sub-class?
-              BaseStreamer<WallStreamerTypeFactory>::template UpdateMinsAndMaxes<tDoRayTracing>(site,
-                                                                                                hydroVars,
-                                                                                                lbmParams,
-                                                                                                propertyCache);
+                for (unsigned link = 0; link < links.bulkCount; ++link)
+                {
+                  bulkLinkDelegate.StreamLink(lbmParams, latDat, site, hydroVars, links.bulkDirections[link]);
+                }
+#endif
+
+                //TODO: Necessary to specify sub-class?
+                BaseStreamer<WallStreamerTypeFactory>::template UpdateMinsAndMaxes<tUpdateCaches>(site,
+                                                                                                  hydroVars,
+                                                                                                  lbmParams,
+                                                                                                  propertyCache);
+              }
             }
           }
-          template<bool tDoRayTracing>
+          template<bool tUpdateCaches>
           inline void DoPostStep(const site_t firstIndex,
                                  const site_t siteCount,
                                  const LbmParameters* lbmParameters,
                                  geometry::LatticeData* latticeData,
                                  lb::MacroscopicPropertyCache& propertyCache)
           {
-            for (site_t siteIndex = firstIndex; siteIndex < (firstIndex + siteCount); siteIndex++)
+            // Only the wall links need any work, so go straight to them rather than checking every
+            // direction of every site.
+            const geometry::LatticeData::WallLinkIterator end =
+                latticeData->GetFirstWallLink(firstIndex + siteCount);
+            for (geometry::LatticeData::WallLinkIterator wallLink =
+                latticeData->GetFirstWallLink(firstIndex); wallLink != end; ++wallLink)
             {
-              geometry::Site<geometry::LatticeData> site = latticeData->GetSite(siteIndex);
-              for (unsigned int direction = 0; direction < LatticeType::NUMVECTORS; direction++)
-              {
-                if (site.HasWall(direction))
-                {
-                  wallLinkDelegate.PostStepLink(latticeData, site, direction);
-                }
-              }
+              geometry::Site<geometry::LatticeData> site = latticeData->GetSite(wallLink->siteIndex);
+              wallLinkDelegate.PostStepLink(latticeData, site, wallLink->direction);
             }
           }
 
@@ -136,48 +164,80 @@ namespace hemelb
 
           }
 
-          template<bool tDoRayTracing>
+          template<bool tUpdateCaches>
           inline void DoStreamAndCollide(const site_t firstIndex,
                                          const site_t siteCount,
                                          const LbmParameters* lbmParams,
                                          geometry::LatticeData* latDat,
                                          lb::MacroscopicPropertyCache& propertyCache)
           {
-            for (site_t siteIndex = firstIndex; siteIndex < (firstIndex + siteCount); siteIndex++)
+            const site_t endIndex = firstIndex + siteCount;
+#ifdef HEMELB_USE_PULL_STREAMING
+            const bool domainEdge = firstIndex >= latDat->GetMidDomainSiteCount();
+#endif
+            for (site_t siteIndex = firstIndex; siteIndex < endIndex;)
             {
-              geometry::Site<geometry::LatticeData> site = latDat->GetSite(siteIndex);
+              // Every site of the run has the same links and iolet, so sort its directions and
+              // look up the iolet once.
+              const geometry::LinkPatternRange& run = *latDat->GetLinkPatternRange(siteIndex);
+              const LinkPattern<LatticeType> links(0, run.ioletIntersection);
+              const site_t runEnd = std::min(endIndex, run.firstSite + run.siteCount);
+              if (links.ioletCount > 0)
+              {
+                ioletLinkDelegate.SetIolet(run.ioletId);
+              }
 
-              const distribn_t* fOld = site.GetFOld<LatticeType> ();
+              for (; siteIndex < runEnd; siteIndex++)
+              {
+                geometry::Site<geometry::LatticeData> site = latDat->GetSite(siteIndex);
 
-              kernels::HydroVars<typename CollisionType::CKernel> hydroVars(fOld);
+                distribn_t fOldBuffer[LatticeType::NUMVECTORS];
+#ifdef HEMELB_USE_PULL_STREAMING
+                bulkLinkDelegate.PullLinks(site, fOldBuffer);
+                for (unsigned link = 0; link < links.ioletCount; ++link)
+                {
+                  ioletLinkDelegate.PullLink(lbmParams, latDat, site, fOldBuffer, links.ioletDirections[link]);
+                }
+                const distribn_t* fOld = fOldBuffer;
+#else
+                const distribn_t* fOld = site.GetFOld<LatticeType> (fOldBuffer);
+#endif
 
-              ///< @todo #126 This value of tau will be updated by some kernels within the collider code (e.g. LBGKNN). It would be nicer if tau is handled in a single place.
-              hydroVars.tau = lbmParams->GetTau();
+                kernels::HydroVars<typename CollisionType::CKernel> hydroVars(fOld);
 
-              collider.CalculatePreCollision(hydroVars, site);
+                ///< @todo #126 This value of tau will be updated by some kernels within the collider code (e.g. LBGKNN). It would be nicer if tau is handled in a single place.
+                hydroVars.tau = lbmParams->GetTau();
 
-              collider.Collide(lbmParams, hydroVars);
+                collider.CalculatePreCollision(hydroVars, site);
 
-              for (Direction ii = 0; ii < LatticeType::NUMVECTORS; ii++)
-              {
-                if (site.HasIolet(ii))
+                collider.Collide(lbmParams, hydroVars);
+
+#ifdef HEMELB_USE_PULL_STREAMING
+                for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
                 {
-                  ioletLinkDelegate.StreamLink(lbmParams, latDat, site, hydroVars, ii);
+                  bulkLinkDelegate.StoreLink(latDat, site, hydroVars.GetFPostCollision()[direction], direction, domainEdge);
                 }
-                else
+#else
+                for (unsigned link = 0; link < links.ioletCount; ++link)
                 {
-                  bulkLinkDelegate.StreamLink(lbmParams, latDat, site, hydroVars, ii);
+                  ioletLinkDelegate.StreamLink(lbmParams, latDat, site, hydroVars, links.ioletDirections[link]);
                 }
-              }
 
-              //TODO: Necessary to specify sub-class?
-              BaseStreamer<IoletStreamerTypeFactory>::template UpdateMinsAndMaxes<tDoRayTracing>(site,
-                                                                                                 hydroVars,
-                                                                                                 lbmParams,
-                                                                                                 propertyCache);
+                for (unsigned link = 0; link < links.bulkCount; ++link)
+                {
+                  bulkLinkDelegate.StreamLink(lbmParams, latDat, site, hydroVars, links.bulkDirections[link]);
+                }
+#endif
+
+                //TODO: Necessary to specify sub-class?
+                BaseStreamer<IoletStreamerTypeFactory>::template UpdateMinsAndMaxes<tUpdateCaches>(site,
+                                                                                                   hydroVars,
+                                                                                                   lbmParams,
+                                                                                                   propertyCache);
+              }
             }
           }
-          template<bool tDoRayTracing>
+          template<bool tUpdateCaches>
           inline void DoPostStep(const site_t firstIndex,
                                  const site_t siteCount,
                                  const LbmParameters* lbmParameters,
@@ -230,53 +290,90 @@ namespace hemelb
 
           }
 
-          template<bool tDoRayTracing>
+          template<bool tUpdateCaches>
           inline void DoStreamAndCollide(const site_t firstIndex,
                                          const site_t siteCount,
                                          const LbmParameters* lbmParams,
                                          geometry::LatticeData* latDat,
                                          lb::MacroscopicPropertyCache& propertyCache)
           {
-            for (site_t siteIndex = firstIndex; siteIndex < (firstIndex + siteCount); siteIndex++)
+            const site_t endIndex = firstIndex + siteCount;
+#ifdef HEMELB_USE_PULL_STREAMING
+            const bool domainEdge = firstIndex >= latDat->GetMidDomainSiteCount();
+#endif
+            for (site_t siteIndex = firstIndex; siteIndex < endIndex;)
             {
-              geometry::Site<geometry::LatticeData> site = latDat->GetSite(siteIndex);
+              // Every site of the run has the same links and iolet, so sort its directions and
+              // look up the iolet once.
+              const geometry::LinkPatternRange& run = *latDat->GetLinkPatternRange(siteIndex);
+              const LinkPattern<LatticeType> links(run.wallIntersection, run.ioletIntersection);
+              const site_t runEnd = std::min(endIndex, run.firstSite + run.siteCount);
+              if (links.ioletCount > 0)
+              {
+                ioletLinkDelegate.SetIolet(run.ioletId);
+              }
+
+              for (; siteIndex < runEnd; siteIndex++)
+              {
+                geometry::Site<geometry::LatticeData> site = latDat->GetSite(siteIndex);
 
-              const distribn_t* fOld = site.GetFOld<LatticeType> ();
+                distribn_t fOldBuffer[LatticeType::NUMVECTORS];
+#ifdef HEMELB_USE_PULL_STREAMING
+                bulkLinkDelegate.PullLinks(site, fOldBuffer);
+                for (unsigned link = 0; link < links.ioletCount; ++link)
+                {
+                  ioletLinkDelegate.PullLink(lbmParams, latDat, site, fOldBuffer, links.ioletDirections[link]);
+                }
+                for (unsigned link = 0; link < links.wallCount; ++link)
+                {
+                  wallLinkDelegate.PullLink(lbmParams, latDat, site, fOldBuffer, links.wallDirections[link]);
+                }
+                const distribn_t* fOld = fOldBuffer;
+#else
+                const distribn_t* fOld = site.GetFOld<LatticeType> (fOldBuffer);
+#endif
 
-              kernels::HydroVars<typename CollisionType::CKernel> hydroVars(fOld);
+                kernels::HydroVars<typename CollisionType::CKernel> hydroVars(fOld);
 
-              ///< @todo #126 This value of tau will be updated by some kernels within the collider code (e.g. LBGKNN). It would be nicer if tau is handled in a single place.
-              hydroVars.tau = lbmParams->GetTau();
+                ///< @todo #126 This value of tau will be updated by some kernels within the collider code (e.g. LBGKNN). It would be nicer if tau is handled in a single place.
+                hydroVars.tau = lbmParams->GetTau();
 
-              collider.CalculatePreCollision(hydroVars, site);
+                collider.CalculatePreCollision(hydroVars, site);
 
-              collider.Collide(lbmParams, hydroVars);
+                collider.Collide(lbmParams, hydroVars);
 
-              for (Direction ii = 0; ii < LatticeType::NUMVECTORS; ii++)
-              {
-                if (site.HasIolet(ii))
+#ifdef HEMELB_USE_PULL_STREAMING
+                for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
                 {
-                  ioletLinkDelegate.StreamLink(lbmParams, latDat, site, hydroVars, ii);
+                  bulkLinkDelegate.StoreLink(latDat, site, hydroVars.GetFPostCollision()[direction], direction, domainEdge);
                 }
-                else if (site.HasWall(ii))
+#else
+                for (unsigned link = 0; link < links.ioletCount; ++link)
                 {
-                  wallLinkDelegate.StreamLink(lbmParams, latDat, site, hydroVars, ii);
+                  ioletLinkDelegate.StreamLink(lbmParams, latDat, site, hydroVars, links.ioletDirections[link]);
                 }
-                else
+
+                for (unsigned link = 0; link < links.wallCount; ++link)
                 {
-                  bulkLinkDelegate.StreamLink(lbmParams, latDat, site, hydroVars, ii);
+                  wallLinkDelegate.StreamLink(lbmParams, latDat, site, hydroVars, links.wallDirections[link]);
                 }
-              }
 
-              //TODO: Necessary to specify sub-class?
-              BaseStreamer<WallIoletStreamerTypeFactory>::template UpdateMinsAndMaxes<tDoRayTracing>(site,
-                                                                                                     hydroVars,
-                                                                                                     lbmParams,
-                                                                                                     propertyCache);
+                for (unsigned link = 0; link < links.bulkCount; ++link)
+                {
+                  bulkLinkDelegate.StreamLink(lbmParams, latDat, site, hydroVars, links.bulkDirections[link]);
+                }
+#endif
+
+                //TODO: Necessary to specify sub-class?
+                BaseStreamer<WallIoletStreamerTypeFactory>::template UpdateMinsAndMaxes<tUpdateCaches>(site,
+                                                                                                       hydroVars,
+                                                                                                       lbmParams,
+                                                                                                       propertyCache);
+              }
             }
           }
 
-          template<bool tDoRayTracing>
+          template<bool tUpdateCaches>
           inline void DoPostStep(const site_t firstIndex,
                                  const site_t siteCount,
                                  const LbmParameters* lbmParams,
@@ -9,6 +9,7 @@
 
 #include "lb/streamers/SimpleBounceBack.h"
 #include "lb/streamers/SimpleCollideAndStream.h"
+#include "lb/streamers/SiteBatchedCollideAndStream.h"
 #include "lb/streamers/BouzidiFirdaousLallemand.h"
 #include "lb/streamers/GuoZhengShi.h"
 #include "lb/streamers/JunkYang.h"
@@ -11,7 +11,7 @@
 
 #include "units.h"
 #include "util/Vector3D.h"
-#include "util/FlatMap.h"
+#include "util/HashMap.h"
 #include "lb/iolets/InOutLet.h"
 #include "lb/lattices/LatticeInfo.h"
 #include "lb/kernels/BaseKernel.h"
@@ -28,7 +28,8 @@ namespace hemelb
        */
       struct RSHV
       {
-          typedef util::FlatMap<site_t, RSHV>::Type Map;
+          // Global non-contiguous id of the site
+          site_t globalIdx;
           // Time step at which this was last updated
           LatticeTimeStep t;
           // Density at that time
@@ -64,25 +65,71 @@ namespace hemelb
           {
 
           }
+
+          /**
+           * Get the index in the cache of a real site's hydrodynamic variables, adding an entry
+           * for it if there isn't one. Entries are only ever appended, so indices stay valid.
+           * @param globalIdx
+           * @param posIolet The site's position in iolet coordinates
+           * @return
+           */
+          std::size_t GetCacheIndex(site_t globalIdx, const LatticePosition& posIolet)
+          {
+            util::HashMap<site_t, std::size_t>::iterator indexPtr =
+                hydroVarsCacheIndices.find(globalIdx);
+            if (indexPtr != hydroVarsCacheIndices.end())
+              return indexPtr->second;
+
+            RSHV hv;
+            hv.globalIdx = globalIdx;
+            hv.t = 0;
+            hv.rho = 1.0;
+            hv.u = LatticeVelocity::Zero();
+            hv.posIolet = posIolet;
+            hydroVarsCache.push_back(hv);
+            hydroVarsCacheIndices.insert(std::make_pair(globalIdx, hydroVarsCache.size() - 1));
+            return hydroVarsCache.size() - 1;
+          }
+
+          /**
+           * @param globalIdx
+           * @return The cached hydrodynamic variables of a real site, or NULL if it has none
+           */
+          RSHV* FindCachedHydroVars(site_t globalIdx)
+          {
+            util::HashMap<site_t, std::size_t>::iterator indexPtr =
+                hydroVarsCacheIndices.find(globalIdx);
+            return indexPtr == hydroVarsCacheIndices.end() ?
+              NULL :
+              &hydroVarsCache[indexPtr->second];
+          }
+
           typename VirtualSite<LatticeType>::Map vSites;
-          RSHV::Map hydroVarsCache;
+          // The real sites' hydrodynamic variables, contiguous, in the order they were added.
+          std::vector<RSHV> hydroVarsCache;
+          // Where each real site is in the cache, by global id; only needed while setting up.
+          util::HashMap<site_t, std::size_t> hydroVarsCacheIndices;
       };
 
       template<class LatticeType>
       class VirtualSite
       {
         public:
-          typedef std::map<site_t, VirtualSite<LatticeType> > Map;
+          typedef util::HashMap<site_t, VirtualSite<LatticeType> > Map;
 
           VirtualSite& operator=(const VirtualSite& rhs)
           {
             neighbourDirections = rhs.neighbourDirections;
             neighbourGlobalIds = rhs.neighbourGlobalIds;
+            neighbourCacheIndices = rhs.neighbourCacheIndices;
             q = rhs.q;
             sumQiSq = rhs.sumQiSq;
             for (unsigned i = 0; i < 3; ++i)
               for (unsigned j = 0; j < 3; ++j)
                 velocityMatrixInv[i][j] = rhs.velocityMatrixInv[i][j];
+            ioletDensityWeight = rhs.ioletDensityWeight;
+            densityWeights = rhs.densityWeights;
+            velocityWeights = rhs.velocityWeights;
             hv = rhs.hv;
             return *this;
           }
@@ -96,6 +143,7 @@ namespace hemelb
                       const LatticeVector& location) :
             sumQiSq(0.)
           {
+            hv.globalIdx = initParams.latDat->GetGlobalNoncontiguousSiteIdFromGlobalCoords(location);
             hv.t = 0;
             hv.rho = 1.;
             hv.u = LatticeVelocity::Zero();
@@ -104,6 +152,7 @@ namespace hemelb
             lattices::LatticeInfo& lattice = LatticeType::GetLatticeInfo();
 
             distribn_t velocityMatrix[3][3] = { { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0, 0 } };
+            std::vector<LatticePosition> neighbourPositions;
 
             // For each site index in the neighbourhood
             for (Direction i = 0; i < lattice.GetNumVectors(); ++i)
@@ -175,16 +224,8 @@ namespace hemelb
               velocityMatrix[2][2] += 1;
 
               // Ensure there's an entry in the hydroVars cache for the site.
-              RSHV::Map::iterator neighPtr = extra.hydroVarsCache.find(neighGlobalIdx);
-              if (neighPtr == extra.hydroVarsCache.end())
-              {
-                RSHV neighHV;
-                neighHV.t = 0;
-                neighHV.rho = 1.0;
-                neighHV.u = LatticeVelocity::Zero();
-                neighHV.posIolet = xIolet;
-                extra.hydroVarsCache.insert(RSHV::Map::value_type(neighGlobalIdx, neighHV));
-              }
+              neighbourCacheIndices.push_back(extra.GetCacheIndex(neighGlobalIdx, xIolet));
+              neighbourPositions.push_back(xIolet);
 
               if (neighbourSiteHomeProc == initParams.latDat->GetLocalRank())
               {
@@ -224,6 +265,7 @@ namespace hemelb
                   velocityMatrixInv[i][j] = 0.;
               velocityMatrixInv[2][2] = 1.0 / velocityMatrix[2][2];
             }
+            CalculateWeights(neighbourPositions);
           }
 
           static distribn_t Matrix3DInverse(const distribn_t m[3][3], distribn_t out[3][3])
@@ -255,12 +297,48 @@ namespace hemelb
             sumQiSq += qNew * qNew;
           }
 
+          /**
+           * Both fits are linear in the neighbours' values and the cut distances and positions
+           * don't change, so work out once how much each neighbour contributes.
+           *
+           * The density is
+           *   rho_iolet SUM_i q[i] / SUM_i q[i]^2 - SUM_i q[i] (1 - q[i]) rho[i] / SUM_i q[i]^2
+           * and the normal velocity at the virtual site, (x, y, 1) . M_inv . Y, is
+           *   SUM_i ((x, y, 1) . M_inv . (x[i], y[i], 1)) u[i]
+           *
+           * @param neighbourPositions The neighbours' positions in iolet coordinates
+           */
+          void CalculateWeights(const std::vector<LatticePosition>& neighbourPositions)
+          {
+            distribn_t rowOfInverse[3];
+            for (unsigned j = 0; j < 3; ++j)
+              rowOfInverse[j] = hv.posIolet.x * velocityMatrixInv[0][j]
+                  + hv.posIolet.y * velocityMatrixInv[1][j] + velocityMatrixInv[2][j];
+
+            ioletDensityWeight = 0.;
+            densityWeights.resize(q.size());
+            velocityWeights.resize(q.size());
+            for (unsigned i = 0; i < q.size(); ++i)
+            {
+              ioletDensityWeight += q[i] / sumQiSq;
+              densityWeights[i] = -q[i] * (1.0 - q[i]) / sumQiSq;
+              velocityWeights[i] = rowOfInverse[0] * neighbourPositions[i].x
+                  + rowOfInverse[1] * neighbourPositions[i].y + rowOfInverse[2];
+            }
+          }
+
           std::vector<Direction> neighbourDirections;
           std::vector<site_t> neighbourGlobalIds;
+          // Where each neighbour's hydrodynamic variables are in the iolet's cache
+          std::vector<std::size_t> neighbourCacheIndices;
 
           std::vector<LatticeDistance> q;
           distribn_t sumQiSq;
           distribn_t velocityMatrixInv[3][3];
+          // The contributions of the iolet density and of each neighbour to the fitted values
+          distribn_t ioletDensityWeight;
+          std::vector<distribn_t> densityWeights;
+          std::vector<distribn_t> velocityWeights;
           VSHV<LatticeType> hv;
 
       };
@@ -14,7 +14,9 @@
 #include "lb/streamers/VirtualSite.h"
 #include "log/Logger.h"
 #include "util/FlatMap.h"
-#include <map>
+#ifdef HEMELB_DUMP_VIRTUAL_SITES
+#include <fstream>
+#endif
 
 #include "debug/Debugger.h"
 
@@ -43,21 +45,37 @@ namespace hemelb
           iolets::BoundaryValues* bValues;
           const geometry::neighbouring::NeighbouringLatticeData& neighbouringLatticeData;
 
-          // These will store a map from localIdx => (iolet, vsite, direction) triples
+          // These will store a map from localIdx => (iolet, vsite, direction) triples. The
+          // virtual site is given by its place in the iolet's vSites, as adding to those (which
+          // the other streamer for the iolet may do) can move them.
           struct IoletVSiteDirection
           {
-              IoletVSiteDirection(InOutLet*iolet_, VirtualSite<LatticeType>* vsite_, Direction i_) :
+              IoletVSiteDirection(InOutLet*iolet_, std::size_t vsite_, Direction i_) :
                 iolet(iolet_), vsite(vsite_), direction(i_)
               {
               }
               InOutLet* iolet;
-              VirtualSite<LatticeType>* vsite;
+              std::size_t vsite;
               Direction direction;
           };
           typedef typename util::FlatMultiMap<site_t, IoletVSiteDirection>::Type
               VSiteByLocalIdxMultiMap;
           VSiteByLocalIdxMultiMap vsByLocalIdx;
 
+          // And from localIdx => where the site's own hydro vars are cached, for the sites this
+          // streamer collides.
+          struct CachedHydroVarsEntry
+          {
+              CachedHydroVarsEntry(VSExtra<LatticeType>* extra_, std::size_t index_) :
+                extra(extra_), index(index_)
+              {
+              }
+              VSExtra<LatticeType>* extra;
+              std::size_t index;
+          };
+          typedef typename util::FlatMap<site_t, CachedHydroVarsEntry>::Type CacheEntryByLocalIdxMap;
+          CacheEntryByLocalIdxMap cacheEntryByLocalIdx;
+
         public:
           VirtualSiteIolet(kernels::InitParams& initParams) :
             collider(initParams), bulkLinkDelegate(collider, initParams),
@@ -86,7 +104,8 @@ namespace hemelb
 
                 if (site.GetSiteType() != bValues->GetIoletType())
                 {
-                  std::cout << "  Site is not of correct iolet type " << siteIdx << std::endl;
+                  log::Logger::Log<log::Warning, log::OnePerCore>("Site %li is not of the correct iolet type",
+                                                                  siteIdx);
                   continue;
                 }
                 const LatticeVector siteLocation = site.GetGlobalSiteCoords();
@@ -97,6 +116,15 @@ namespace hemelb
                 // Get the extra data for this iolet
                 VSExtra<LatticeType>* extra = GetExtra(&iolet);
 
+                // Give the site its place in the cache now, so colliding it needn't look it up.
+                const site_t globalIdx =
+                    initParams.latDat->GetGlobalNoncontiguousSiteIdFromGlobalCoords(siteLocation);
+                const std::size_t cacheIndex =
+                    extra->GetCacheIndex(globalIdx, extra->WorldToIolet(siteLocation));
+                cacheEntryByLocalIdx.insert(typename CacheEntryByLocalIdxMap::value_type(siteIdx,
+                                                                                         CachedHydroVarsEntry(extra,
+                                                                                                              cacheIndex)));
+
                 // For each site index in the neighbourhood
                 for (Direction i = 0; i < LatticeType::NUMVECTORS; ++i)
                 {
@@ -125,9 +153,10 @@ namespace hemelb
                   }
 
                   // Add the (possibly newly created) virtual site to the map by local index.
+                  const std::size_t vSiteIndex = vNeigh - extra->vSites.begin();
                   vsByLocalIdx.insert(typename VSiteByLocalIdxMultiMap::value_type(siteIdx,
                                                                                    IoletVSiteDirection(&iolet,
-                                                                                                       & (vNeigh->second),
+                                                                                                       vSiteIndex,
                                                                                                        lattice.GetInverseIndex(i))));
                 }
               }
@@ -140,17 +169,21 @@ namespace hemelb
            * links will be done in the post-step as we must ensure that all
            * the data is available to construct virtual sites.
            */
-          template<bool tDoRayTracing>
+          template<bool tUpdateCaches>
           inline void DoStreamAndCollide(const site_t firstIndex, const site_t siteCount,
                                          const LbmParameters* lbmParams,
                                          geometry::LatticeData* latDat,
                                          lb::MacroscopicPropertyCache& propertyCache)
           {
+            typename CacheEntryByLocalIdxMap::const_iterator cacheEntry =
+                cacheEntryByLocalIdx.lower_bound(firstIndex);
+
             for (site_t siteIndex = firstIndex; siteIndex < (firstIndex + siteCount); siteIndex++)
             {
               geometry::Site<geometry::LatticeData> site = latDat->GetSite(siteIndex);
 
-              const distribn_t* fOld = site.GetFOld<LatticeType> ();
+              distribn_t fOldBuffer[LatticeType::NUMVECTORS];
+              const distribn_t* fOld = site.GetFOld<LatticeType> (fOldBuffer);
 
               kernels::HydroVars<typename CollisionType::CKernel> hydroVars(fOld);
 
@@ -179,27 +212,24 @@ namespace hemelb
               /*
                * Store the density and velocity for later use.
                */
-              // Get the iolet
-              InOutLet* iolet = bValues->GetLocalIolet(site.GetIoletId());
-
-              // Get the extra data for this iolet
-              VSExtra<LatticeType>* extra = GetExtra(iolet);
-              site_t globalIdx =
-                  latDat->GetGlobalNoncontiguousSiteIdFromGlobalCoords(site.GetGlobalSiteCoords());
-              RSHV& cachedHV = extra->hydroVarsCache[globalIdx];
-              cachedHV.t = bValues->GetTimeStep();
-              cachedHV.rho = hydroVars.density;
-              cachedHV.u = hydroVars.velocity;
+              if (cacheEntry != cacheEntryByLocalIdx.end() && cacheEntry->first == siteIndex)
+              {
+                RSHV& cachedHV = cacheEntry->second.extra->hydroVarsCache[cacheEntry->second.index];
+                cachedHV.t = bValues->GetTimeStep();
+                cachedHV.rho = hydroVars.density;
+                cachedHV.u = hydroVars.velocity;
+                ++cacheEntry;
+              }
 
               // TODO: Necessary to specify sub-class?
-              BaseStreamer<VirtualSiteIolet>::template UpdateMinsAndMaxes<tDoRayTracing>(site,
+              BaseStreamer<VirtualSiteIolet>::template UpdateMinsAndMaxes<tUpdateCaches>(site,
                                                                                          hydroVars,
                                                                                          lbmParams,
                                                                                          propertyCache);
             }
           }
 
-          template<bool tDoRayTracing>
+          template<bool tUpdateCaches>
           inline void DoPostStep(const site_t firstIndex, const site_t siteCount,
                                  const LbmParameters* lbmParams, geometry::LatticeData* latDat,
                                  lb::MacroscopicPropertyCache& propertyCache)
@@ -213,22 +243,28 @@ namespace hemelb
                 != endVSites; ++vSiteIt)
             {
               site_t siteIdx = vSiteIt->first;
-              // vSiteIt->second == (Iolet*, VirtualSite*, Direction)
+              // vSiteIt->second == (Iolet*, VirtualSite index, Direction)
               InOutLet* iolet = vSiteIt->second.iolet;
               // Get the extra data for this iolet
               VSExtra<LatticeType>* extra = GetExtra(iolet);
-              VSiteType* vSite = vSiteIt->second.vsite;
+              VSiteType* vSite = & (extra->vSites.begin() + vSiteIt->second.vsite)->second;
 
               // Compute the distributions for the vSite if needed
               CalculateVirtualSiteDistributions(*latDat, *iolet, extra->hydroVarsCache, *vSite, t);
               // Stream this direction
               Direction i = vSiteIt->second.direction;
-              * (latDat->GetFNew(siteIdx * LatticeType::NUMVECTORS + i)) = vSite->hv.fPostColl[i];
+              * (latDat->GetFNew(latDat->GetDistributionIndex<LatticeType>(siteIdx, i))) =
+                  vSite->hv.fPostColl[i];
               //* (latticeData->GetFNew(GetBBIndex(site.GetIndex(), direction))) = hydroVars.GetFPostCollision()[direction];
               //return (siteIndex * LatticeType::NUMVECTORS) + LatticeType::INVERSEDIRECTIONS[direction];
             }
           }
 
+#ifdef HEMELB_DUMP_VIRTUAL_SITES
+          /**
+           * Write the cache, the virtual sites and the maps to them to files in the working
+           * directory, for debugging. Only compiled in with HEMELB_DUMP_VIRTUAL_SITES defined.
+           */
           static void DumpTables(const VirtualSiteIolet* ioletStreamer,
                                  const VirtualSiteIolet* ioletWallStreamer,
                                  const geometry::LatticeData* latDat)
@@ -238,10 +274,10 @@ namespace hemelb
 
             std::ofstream hvCache("hvCache");
             hvCache << "# local global x y z" << std::endl;
-            for (RSHV::Map::const_iterator hvIt = extra->hydroVarsCache.begin(); hvIt
+            for (std::vector<RSHV>::const_iterator hvIt = extra->hydroVarsCache.begin(); hvIt
                 != extra->hydroVarsCache.end(); ++hvIt)
             {
-              site_t global = hvIt->first;
+              site_t global = hvIt->globalIdx;
               LatticeVector pos;
               latDat->GetGlobalCoordsFromGlobalNoncontiguousSiteId(global, pos);
               site_t local = latDat->GetContiguousSiteId(pos);
@@ -251,7 +287,7 @@ namespace hemelb
             hvCache.close();
 
             std::ofstream vSites("vSites");
-            vSites << "# global x y z vSitePtr" << std::endl;
+            vSites << "# global x y z vSiteIdx" << std::endl;
             for (typename VirtualSite<LatticeType>::Map::const_iterator vsIt =
                 extra->vSites.begin(); vsIt != extra->vSites.end(); ++vsIt)
             {
@@ -260,7 +296,8 @@ namespace hemelb
               const VSiteType& vs = vsIt->second;
 
               latDat->GetGlobalCoordsFromGlobalNoncontiguousSiteId(global, pos);
-              vSites << global << " " << pos.x << " " << pos.y << " " << pos.z << " " << &vs;
+              vSites << global << " " << pos.x << " " << pos.y << " " << pos.z << " "
+                  << (vsIt - extra->vSites.begin());
               for (unsigned i = 0; i < vs.neighbourGlobalIds.size(); ++i)
               {
                 vSites << " " << vs.neighbourGlobalIds[i];
@@ -270,7 +307,7 @@ namespace hemelb
             vSites.close();
 
             std::ofstream outletMap("outletMap");
-            outletMap << "# local global x y z vSitePtr direction" << std::endl;
+            outletMap << "# local global x y z vSiteIdx direction" << std::endl;
             for (typename VSiteByLocalIdxMultiMap::const_iterator entry =
                 ioletStreamer->vsByLocalIdx.begin(); entry != ioletStreamer->vsByLocalIdx.end(); ++entry)
             {
@@ -284,7 +321,7 @@ namespace hemelb
             outletMap.close();
 
             std::ofstream outletWallMap("outletWallMap");
-            outletWallMap << "# local global x y z vSitePtr direction" << std::endl;
+            outletWallMap << "# local global x y z vSiteIdx direction" << std::endl;
             for (typename VSiteByLocalIdxMultiMap::const_iterator entry =
                 ioletWallStreamer->vsByLocalIdx.begin(); entry
                 != ioletWallStreamer->vsByLocalIdx.end(); ++entry)
@@ -298,6 +335,7 @@ namespace hemelb
                   << std::endl;
             }
           }
+#endif
 
         private:
           static VSExtra<LatticeType>* GetExtra(InOutLet* iolet)
@@ -314,7 +352,8 @@ namespace hemelb
           }
 
           void CalculateVirtualSiteDistributions(const geometry::LatticeData& latDat,
-                                                 const InOutLet& iolet, RSHV::Map& hydroVarsCache,
+                                                 const InOutLet& iolet,
+                                                 std::vector<RSHV>& hydroVarsCache,
                                                  VSiteType& vSite, const LatticeTimeStep t)
           {
             if (vSite.hv.t != t)
@@ -341,6 +380,10 @@ namespace hemelb
            *
            * rho_virtual = SUM_i ( q[i] (rho_iolet - (1 - q[i]) * rho[i]) ) / SUM _i (q[i]^2)
            *
+           * which, with the weights precomputed by the virtual site, is
+           *
+           * rho_virtual = w_iolet rho_iolet + SUM_i w[i] rho[i]
+           *
            * @param latDat
            * @param iolet
            * @param hydroVarsCache
@@ -350,21 +393,15 @@ namespace hemelb
            */
           LatticeDensity CalculateVirtualSiteDensity(const geometry::LatticeData& latDat,
                                                      const InOutLet& iolet,
-                                                     RSHV::Map& hydroVarsCache,
+                                                     std::vector<RSHV>& hydroVarsCache,
                                                      const VSiteType& vSite, const LatticeTimeStep t)
           {
-            LatticeDensity rho = 0.;
-            LatticeDensity rho_iolet = iolet.GetDensity(t);
-            for (unsigned i = 0; i < vSite.neighbourGlobalIds.size(); ++i)
+            LatticeDensity rho = vSite.ioletDensityWeight * iolet.GetDensity(t);
+            for (unsigned i = 0; i < vSite.neighbourCacheIndices.size(); ++i)
             {
-
-              LatticeDensity rho_site_i = GetHV(latDat,
-                                                hydroVarsCache,
-                                                vSite.neighbourGlobalIds[i],
-                                                t).rho;
-              rho += vSite.q[i] * (rho_iolet - (1.0 - vSite.q[i]) * rho_site_i);
+              rho += vSite.densityWeights[i]
+                  * GetHV(latDat, hydroVarsCache[vSite.neighbourCacheIndices[i]], t).rho;
             }
-            rho /= vSite.sumQiSq;
             return rho;
           }
           /**
@@ -383,7 +420,7 @@ namespace hemelb
            */
           LatticeVelocity CalculateVirtualSiteVelocity(const geometry::LatticeData& latDat,
                                                        const InOutLet& iolet,
-                                                       RSHV::Map& hydroVarsCache,
+                                                       std::vector<RSHV>& hydroVarsCache,
                                                        const VSiteType& vSite, const LatticeTimeStep t)
           {
             /*
@@ -414,41 +451,26 @@ namespace hemelb
              *  (( 0, 0,   0),
              *   ( 0, 0,   0),
              *   ( 0, 0, 1/N)
+             *
+             * The fitted value at the virtual site, (x, y, 1) . M_inv . Y, is linear in the u[i]
+             * so the virtual site has precomputed the weight of each.
              */
 
-            // Compute y, by summing over neighbouring fluid sites.
-            distribn_t sums[3] = { 0, 0, 0 };
-            // {sumXU, sumYU, sumU}
-            for (unsigned i = 0; i < vSite.neighbourGlobalIds.size(); ++i)
+            // Compute the magnitude of the velocity.
+            LatticeSpeed ansNorm = 0.;
+            for (unsigned i = 0; i < vSite.neighbourCacheIndices.size(); ++i)
             {
-              RSHV& hv = GetHV(latDat, hydroVarsCache, vSite.neighbourGlobalIds[i], t);
-              LatticeSpeed uNorm = hv.u.Dot(iolet.GetNormal());
-              sums[0] += hv.posIolet.x * uNorm;
-              sums[1] += hv.posIolet.y * uNorm;
-              sums[2] += uNorm;
+              RSHV& hv = GetHV(latDat, hydroVarsCache[vSite.neighbourCacheIndices[i]], t);
+              ansNorm += vSite.velocityWeights[i] * hv.u.Dot(iolet.GetNormal());
             }
 
-            // {A, B, C}
-            distribn_t coeffs[3] = { 0, 0, 0 };
-
-            // Do the matrix multiply to get the fitted coefficients.
-            for (unsigned i = 0; i < 3; ++i)
-              for (unsigned j = 0; j < 3; ++j)
-                coeffs[i] += vSite.velocityMatrixInv[i][j] * sums[j];
-
-            // Compute the magnitude of the velocity.
-            LatticeSpeed ansNorm = coeffs[0] * vSite.hv.posIolet.x + coeffs[1]
-                * vSite.hv.posIolet.y + coeffs[2];
-
             // multiply by the iolet normal and we're done!
             return iolet.GetNormal() * ansNorm;
 
           }
 
-          RSHV& GetHV(const geometry::LatticeData& latDat, RSHV::Map& hydroVarsCache,
-                      const site_t globalIdx, const LatticeTimeStep t)
+          RSHV& GetHV(const geometry::LatticeData& latDat, RSHV& ans, const LatticeTimeStep t)
           {
-            RSHV& ans = hydroVarsCache.at(globalIdx);
             /* Local sites have their entry in the cache set during collision
              * so they are guaranteed to be up to date. Neighbouring sites may
              * not be, but all the communication needed has been done. If the
@@ -458,7 +480,7 @@ namespace hemelb
               return ans;
 
             geometry::neighbouring::ConstNeighbouringSite neigh =
-                latDat.GetNeighbouringData().GetSite(globalIdx);
+                latDat.GetNeighbouringData().GetSite(ans.globalIdx);
             const distribn_t* fOld = neigh.GetFOld<LatticeType> ();
             LatticeType::CalculateDensityAndMomentum(fOld, ans.rho, ans.u.x, ans.u.y, ans.u.z);
             if (LatticeType::IsLatticeCompressible())
@@ -469,6 +491,16 @@ namespace hemelb
             return ans;
           }
       };
+
+      /**
+       * The virtual site map and hydro vars cache are shared between all the sites, so don't
+       * thread this streamer.
+       */
+      template<class CollisionImpl>
+      struct IsThreadSafe<VirtualSiteIolet<CollisionImpl> >
+      {
+          static const bool value = false;
+      };
     }
   }
 }
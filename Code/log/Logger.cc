@@ -9,6 +9,8 @@
 #include <iomanip>
 #include <cstdio>
 #include <cstdarg>
+#include <cstdlib>
+#include <mutex>
 #include <sys/time.h>
 #include <sys/resource.h>
 
@@ -20,10 +22,19 @@ namespace hemelb
 {
   namespace log
   {
-    const LogLevel Logger::currentLogLevel = HEMELB_LOG_LEVEL;
+    const LogLevel Logger::currentLogLevel;
     // Use negative value to indicate uninitialised.
     int Logger::thisRank = -1;
     double Logger::startTime = -1.0;
+    std::string Logger::buffered;
+
+    namespace
+    {
+      //! How many bytes of Debug and Trace messages to gather before writing them out.
+      const size_t BufferCapacity = 1 << 16;
+      //! Guards the buffer and the order of the output, as other threads log too.
+      std::mutex outputMutex;
+    }
 
     void Logger::Init()
     {
@@ -36,11 +47,59 @@ namespace hemelb
           thisRank = net::MpiCommunicator::World().Rank();
         }
         startTime = util::myClock();
+        std::atexit(&Logger::Flush);
+      }
+    }
+
+    void Logger::Flush()
+    {
+      std::lock_guard<std::mutex> lock(outputMutex);
+      WriteBuffered();
+    }
+
+    void Logger::WriteBuffered()
+    {
+      if (!buffered.empty())
+      {
+        std::fwrite(buffered.data(), 1, buffered.size(), stdout);
+        buffered.clear();
       }
     }
 
+    void Logger::Buffer(const std::string& format, std::va_list args)
+    {
+      // Find the length first, then write the message straight onto the end of the buffer.
+      std::va_list lengthArgs;
+      va_copy(lengthArgs, args);
+      const int length = std::vsnprintf(NULL, 0, format.c_str(), lengthArgs);
+      va_end(lengthArgs);
+      if (length <= 0)
+      {
+        return;
+      }
+
+      std::lock_guard<std::mutex> lock(outputMutex);
+      const size_t start = buffered.size();
+      buffered.resize(start + length + 1);
+      std::vsnprintf(&buffered[start], length + 1, format.c_str(), args);
+      buffered.resize(start + length);
+
+      if (buffered.size() >= BufferCapacity)
+      {
+        WriteBuffered();
+      }
+    }
+
+    void Logger::Print(const std::string& format, std::va_list args)
+    {
+      // After the buffered messages, to keep this core's messages in order.
+      std::lock_guard<std::mutex> lock(outputMutex);
+      WriteBuffered();
+      std::vprintf(format.c_str(), args);
+    }
+
     template<>
-    void Logger::LogInternal<OnePerCore>(std::string format, std::va_list args)
+    void Logger::LogInternal<OnePerCore>(LogLevel level, std::string format, std::va_list args)
     {
       std::stringstream output;
 
@@ -61,11 +120,18 @@ namespace hemelb
 
       std::string overFormat(output.str());
 
-      std::vprintf(overFormat.c_str(), args);
+      if (level >= Debug)
+      {
+        Buffer(overFormat, args);
+      }
+      else
+      {
+        Print(overFormat, args);
+      }
     }
 
     template<>
-    void Logger::LogInternal<Singleton>(std::string format, std::va_list args)
+    void Logger::LogInternal<Singleton>(LogLevel level, std::string format, std::va_list args)
     {
       if (thisRank == 0)
       {
@@ -73,7 +139,15 @@ namespace hemelb
         std::sprintf(lead, "![%.1fs]", util::myClock() - startTime);
 
         std::string newFormat = std::string(lead);
-        std::vprintf(newFormat.append(format).append("\n").c_str(), args);
+        newFormat.append(format).append("\n");
+        if (level >= Debug)
+        {
+          Buffer(newFormat, args);
+        }
+        else
+        {
+          Print(newFormat, args);
+        }
       }
     }
 
@@ -37,6 +37,15 @@ namespace hemelb
       OnePerCore
     };
 
+    /**
+     * Writes log messages up to the level HEMELB_LOG_LEVEL, which is fixed at compile time, so
+     * a check of a more detailed level is a constant that the compiler removes.
+     *
+     * Messages at the Debug and Trace levels from each core are gathered in a buffer, written
+     * out when it fills, when a less detailed message is logged, on Flush and at exit; so turning
+     * them on for diagnosis doesn't mean a write for every message. Any thread may log: the
+     * buffer and the output are guarded by a mutex.
+     */
     class Logger
     {
       public:
@@ -55,21 +64,59 @@ namespace hemelb
           {
             va_list args;
             va_start(args, format);
-            LogInternal<logType> (format, args);
+            LogInternal<logType> (queryLogLevel, format, args);
             va_end(args);
           }
         }
 
+        /**
+         * Write out the buffered Debug and Trace messages of this core.
+         */
+        static void Flush();
+
       private:
         template<LogType>
-        static void LogInternal(std::string format, va_list args);
+        static void LogInternal(LogLevel level, std::string format, va_list args);
+
+        /**
+         * Append a message to the buffer, writing the buffer out if it is full.
+         */
+        static void Buffer(const std::string& format, va_list args);
+
+        /**
+         * Write out the buffer, then the message.
+         */
+        static void Print(const std::string& format, va_list args);
 
-        static const LogLevel currentLogLevel;
+        /**
+         * Write out the buffer; the caller holds the mutex.
+         */
+        static void WriteBuffered();
+
+        static const LogLevel currentLogLevel = HEMELB_LOG_LEVEL;
         static int thisRank;
         static double startTime;
+        //! The Debug and Trace messages not yet written out.
+        static std::string buffered;
     };
 
   }
 }
 
+/**
+ * Log a message, like Logger::Log, but only if its level is compiled in: above HEMELB_LOG_LEVEL
+ * the call and the evaluation of its arguments are removed altogether. For hot loops.
+ * @param level The LogLevel, e.g. Trace
+ * @param type The LogType, e.g. OnePerCore
+ * @param ... The format string and its arguments
+ */
+#define HEMELB_LOG(level, type, ...) \
+  do \
+  { \
+    if (::hemelb::log::Logger::ShouldDisplay< ::hemelb::log::level>()) \
+    { \
+      ::hemelb::log::Logger::Log< ::hemelb::log::level, ::hemelb::log::type>(__VA_ARGS__); \
+    } \
+  } while (false)
+
 #endif /* HEMELB_LOG_LOGGER_H */
@@ -8,6 +8,87 @@
 #include "net/IOCommunicator.h"
 #include "configuration/CommandLine.h"
 #include "SimulationMaster.h"
+#include "util/fileutils.h"
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+  /**
+   * Run the simulations of an ensemble on equal groups of the cores, each group doing every
+   * groups-th simulation in turn. The simulations are of the same geometry, so it is
+   * decomposed once, by the first group's first simulation, and the rest load that
+   * decomposition instead of decomposing it again.
+   */
+  void RunEnsemble(hemelb::configuration::CommandLine& options,
+                   const hemelb::net::MpiCommunicator& commWorld)
+  {
+    const std::vector<std::string> inputFiles = hemelb::util::ReadPathList(options.GetEnsembleFile());
+    const int groups = options.GetEnsembleGroups();
+    if (commWorld.Size() % groups != 0 || groups > int(inputFiles.size()))
+    {
+      throw hemelb::configuration::CommandLine::OptionError() << "Can't split "
+          << commWorld.Size() << " cores into " << groups << " equal groups for "
+          << inputFiles.size() << " simulations";
+    }
+    const int groupSize = commWorld.Size() / groups;
+    const int group = commWorld.Rank() / groupSize;
+    const hemelb::net::IOCommunicator groupComms(commWorld.Split(group, commWorld.Rank()));
+
+    // Each simulation writes to a numbered folder in the output folder, if one was given, or
+    // else to the one guessed from its input file.
+    const std::string& outputDir = options.GetOutputDir();
+    if (!outputDir.empty() && commWorld.Rank() == 0
+        && !hemelb::util::DoesDirectoryExist(outputDir.c_str()))
+    {
+      std::string directory = outputDir;
+      hemelb::util::MakeDirAllRXW(directory);
+    }
+
+    const bool shareDecomposition = options.GetDecompositionToLoad().empty();
+    const std::string sharedDecomposition = shareDecomposition ?
+      (outputDir.empty() ?
+        options.GetEnsembleFile() :
+        outputDir + "/Ensemble") + ".dcm" :
+      options.GetDecompositionToLoad();
+
+    for (size_t member = group; member < inputFiles.size(); member += groups)
+    {
+      const bool decomposes = shareDecomposition && member == 0;
+      // The other groups wait for the decomposition before starting their first simulation.
+      if (shareDecomposition && int(member) == group && group != 0)
+      {
+        HEMELB_MPI_CALL(MPI_Barrier, (commWorld));
+      }
+
+      std::stringstream memberOutputDir;
+      if (!outputDir.empty())
+      {
+        memberOutputDir << outputDir << "/" << member;
+      }
+      hemelb::configuration::CommandLine memberOptions =
+          options.ForEnsembleMember(inputFiles[member],
+                                    memberOutputDir.str(),
+                                    decomposes ?
+                                      "" :
+                                      sharedDecomposition,
+                                    decomposes ?
+                                      sharedDecomposition :
+                                      "");
+      hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Running ensemble member %lu: %s",
+                                                                          (unsigned long) member,
+                                                                          inputFiles[member].c_str());
+      SimulationMaster master = SimulationMaster(memberOptions, groupComms);
+
+      if (decomposes)
+      {
+        HEMELB_MPI_CALL(MPI_Barrier, (commWorld));
+      }
+      master.RunSimulation();
+    }
+  }
+}
 
 int main(int argc, char *argv[])
 {
@@ -31,11 +112,18 @@ int main(int argc, char *argv[])
       // Start the debugger (if requested)
       hemelb::debug::Debugger::Init(options.GetDebug(), argv[0], commWorld);
 
-      // Prepare main simulation object...
-      SimulationMaster master = SimulationMaster(options, hemelbCommunicator);
+      if (!options.GetEnsembleFile().empty())
+      {
+        RunEnsemble(options, commWorld);
+      }
+      else
+      {
+        // Prepare main simulation object...
+        SimulationMaster master = SimulationMaster(options, hemelbCommunicator);
 
-      // ..and run it.
-      master.RunSimulation();
+        // ..and run it.
+        master.RunSimulation();
+      }
     }
 
     // Interpose this catch to print usage before propagating the error.
@@ -10,6 +10,8 @@
 #include "configuration/CommandLine.h"
 #include "multiscale/MultiscaleSimulationMaster.h"
 #include "multiscale/mpwide/MPWideIntercommunicator.h"
+#include "multiscale/local/LocalIntercommunicator.h"
+#include "multiscale/local/CoupledModelLibrary.h"
 
 int main(int argc, char *argv[])
 {
@@ -29,6 +31,30 @@ int main(int argc, char *argv[])
       // Parse command line
       hemelb::configuration::CommandLine options = hemelb::configuration::CommandLine(argc, argv);
 
+      // A model loaded into this process is run on the IO rank and shares the iolets' values
+      // with it directly.
+      if (!options.GetCoupledModelLibrary().empty())
+      {
+        hemelb::multiscale::CoupledModelLibrary* library = NULL;
+        if (hemelbCommunicator.OnIORank())
+        {
+          library = new hemelb::multiscale::CoupledModelLibrary(options.GetCoupledModelLibrary());
+        }
+        hemelb::multiscale::LocalIntercommunicator intercomms(library == NULL ?
+          NULL :
+          &library->GetModel());
+
+        hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::OnePerCore>("Constructing MultiscaleSimulationMaster()");
+        hemelb::multiscale::MultiscaleSimulationMaster<hemelb::multiscale::LocalIntercommunicator> lMaster(options,
+                                                                                                           hemelbCommunicator,
+                                                                                                           intercomms);
+
+        hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::OnePerCore>("Runing simulation()");
+        lMaster.RunSimulation();
+        delete library;
+        return (0);
+      }
+
       // Prepare some multiscale/MPWide stuff
 
       // Work out the location of the input file.
@@ -52,11 +78,13 @@ int main(int argc, char *argv[])
       hemelb::multiscale::MPWideIntercommunicator intercomms(hemelbCommunicator.OnIORank(),
                                                              sharedValueBuffer,
                                                              lbOrchestration,
-                                                             mpwideConfigDir.append("MPWSettings.cfg"));
+                                                             mpwideConfigDir.append("MPWSettings.cfg"),
+                                                             options.GetMultiscaleLag());
 
       //TODO: Add an IntercommunicatorImplementation?
       hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::OnePerCore>("Constructing MultiscaleSimulationMaster()");
       hemelb::multiscale::MultiscaleSimulationMaster<hemelb::multiscale::MPWideIntercommunicator> lMaster(options,
+                                                                                                          hemelbCommunicator,
                                                                                                           intercomms);
 
       hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::OnePerCore>("Runing simulation()");
@@ -26,11 +26,20 @@ namespace hemelb
                                    const net::IOCommunicator& ioComm,
                                    Intercommunicator & aintercomms) :
             SimulationMaster(options, ioComm), intercomms(aintercomms),
-                multiscaleIoletType("inoutlet")
+                multiscaleIoletType("inoutlet"), couplingInterval(0)
         {
           // We only have one shared object type so far, an iolet.
           lb::iolets::InOutLetMultiscale::DefineType(multiscaleIoletType);
 
+          // Every core reads all the iolets, so agrees on exchanging as often as the iolet with the
+          // shortest coupling interval needs.
+          SetCouplingInterval(simConfig->GetInlets());
+          SetCouplingInterval(simConfig->GetOutlets());
+          if (couplingInterval == 0)
+          {
+            couplingInterval = 1;
+          }
+
           hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::OnePerCore>("CONSTRUCTOR: inlet and outlet count: %d and %d",
                                                                                inletValues->GetLocalIoletCount(),
                                                                                outletValues->GetLocalIoletCount());
@@ -214,6 +223,13 @@ namespace hemelb
 
         void DoTimeStep()
         {
+          // Between exchanges, the iolets interpolate between the values they last received.
+          if (GetState()->Get0IndexedTimeStep() % couplingInterval != 0)
+          {
+            SimulationMaster::DoTimeStep();
+            return;
+          }
+
           bool advance = intercomms.DoMultiscale(GetState()->GetTime());
           hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("At time step %i, should advance %i, time %f",
                                                                               GetState()->GetTimeStep(),
@@ -222,9 +238,9 @@ namespace hemelb
 
           if (advance)
           {
-            /* NOTE: Following triggers DoComms in each InOutLetMultiscale.
-             * IoLetMS is aggressive with this, and DoComms will actually
-             * complete all the communications, not just initiate them.
+            /* NOTE: Following shares the values of each InOutLetMultiscale.
+             * IoLetMS is aggressive with this, and we wait for the
+             * communications to complete here, not just initiate them.
              * This is to prevent any inconsistent state in the coupling
              * (it's hard enough to get the physics right with a consistent
              * state ;)). */
@@ -246,8 +262,12 @@ namespace hemelb
 
             inletValues->RequestComms();
             outletValues->RequestComms();
+            inletValues->FinishReceive();
+            outletValues->FinishReceive();
             SetCommsRequired(inletValues, false);
             SetCommsRequired(outletValues, false);
+            RecordCoupledValues(inletValues);
+            RecordCoupledValues(outletValues);
 
             for (unsigned int i = 0; i < inletValues->GetLocalIoletCount(); i++)
             {
@@ -283,6 +303,39 @@ namespace hemelb
         typename Intercommunicator::IntercommunicandTypeT multiscaleIoletType;
 
       private:
+        /**
+         * The number of time steps between exchanges with the coupled model.
+         */
+        unsigned long couplingInterval;
+
+        /* Reduces the coupling interval to that of any shorter multiscale iolet in the list. */
+        void SetCouplingInterval(const std::vector<lb::iolets::InOutLet*>& iolets)
+        {
+          for (unsigned int i = 0; i < iolets.size(); i++)
+          {
+            if (iolets[i]->IsRegistrationRequired())
+            {
+              unsigned long interval =
+                  static_cast<lb::iolets::InOutLetMultiscale*>(iolets[i])->GetCouplingInterval();
+              if (couplingInterval == 0 || interval < couplingInterval)
+              {
+                couplingInterval = interval;
+              }
+            }
+          }
+        }
+
+        /* Has the local multiscale iolets record the values just exchanged, to interpolate from. */
+        void RecordCoupledValues(hemelb::lb::iolets::BoundaryValues* ioletValues)
+        {
+          for (unsigned int i = 0; i < ioletValues->GetLocalIoletCount(); i++)
+          {
+            if (ioletValues->GetLocalIolet(i)->IsRegistrationRequired())
+            {
+              static_cast<lb::iolets::InOutLetMultiscale*>(ioletValues->GetLocalIolet(i))->RecordCoupledValues(GetState()->Get0IndexedTimeStep());
+            }
+          }
+        }
 
         /* Loops over iolets to set the need for communications. */
         void SetCommsRequired(hemelb::lb::iolets::BoundaryValues* ioletValues, bool b)
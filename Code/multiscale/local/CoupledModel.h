@@ -0,0 +1,62 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_MULTISCALE_LOCAL_COUPLEDMODEL_H
+#define HEMELB_MULTISCALE_LOCAL_COUPLEDMODEL_H
+
+#include <map>
+#include <string>
+
+namespace hemelb
+{
+  namespace multiscale
+  {
+    /***
+     * The values HemeLB shares with a co-located model, keyed by "<intercommunicand label>_<field
+     * label>" as in the other intercommunicators, e.g. "boundary1_pressure". Each points at the
+     * shared value itself, so the model reads and sets them in place.
+     */
+    typedef std::map<std::string, double*> LocalSharedValues;
+
+    /***
+     * A coupled model, such as a 1D or 0D model of the vessels beyond the iolets, that runs in the
+     * same process as HemeLB. It is linked in, or loaded from a library by CoupledModelLibrary, and
+     * called by the LocalIntercommunicator in place of an exchange with a remote model.
+     */
+    class CoupledModel
+    {
+      public:
+        virtual ~CoupledModel()
+        {
+        }
+
+        /***
+         * Called once, before the first time step.
+         * @param values The shared values, which stay valid for the rest of the simulation. The
+         * model should set the ones it owns to its initial conditions.
+         */
+        virtual void ShareInitialConditions(const LocalSharedValues& values) = 0;
+
+        /***
+         * Run the model on to the given time, reading HemeLB's latest values and setting its own
+         * in the shared values.
+         * @param time HemeLB's current time, in seconds.
+         */
+        virtual void AdvanceTo(double time) = 0;
+    };
+
+    /***
+     * The function a coupled model library exports, under the name in
+     * CoupledModelLibrary::FactorySymbol, to create its model. The caller deletes the model before
+     * unloading the library.
+     */
+    extern "C"
+    {
+      typedef CoupledModel* (*CoupledModelFactory)();
+    }
+  }
+}
+
+#endif // HEMELB_MULTISCALE_LOCAL_COUPLEDMODEL_H
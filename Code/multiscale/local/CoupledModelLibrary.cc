@@ -0,0 +1,53 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <dlfcn.h>
+#include "multiscale/local/CoupledModelLibrary.h"
+#include "log/Logger.h"
+#include "Exception.h"
+
+namespace hemelb
+{
+  namespace multiscale
+  {
+    const char* const CoupledModelLibrary::FactorySymbol = "HemeLBCreateCoupledModel";
+
+    CoupledModelLibrary::CoupledModelLibrary(const std::string& path) :
+        handle(dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL)), model(NULL)
+    {
+      if (handle == NULL)
+      {
+        throw Exception() << "Could not load the coupled model library " << path << ": "
+            << dlerror();
+      }
+
+      // dlsym gives an object pointer, which POSIX guarantees can hold a function's address.
+      void* symbol = dlsym(handle, FactorySymbol);
+      if (symbol == NULL)
+      {
+        const char* error = dlerror();
+        dlclose(handle);
+        throw Exception() << "The coupled model library " << path << " has no " << FactorySymbol
+            << ": " << error;
+      }
+      CoupledModelFactory create = reinterpret_cast<CoupledModelFactory>(symbol);
+
+      model = create();
+      if (model == NULL)
+      {
+        dlclose(handle);
+        throw Exception() << "The coupled model library " << path << " did not create a model";
+      }
+      log::Logger::Log<log::Info, log::OnePerCore>("Loaded the coupled model from %s", path.c_str());
+    }
+
+    CoupledModelLibrary::~CoupledModelLibrary()
+    {
+      // The model's code is in the library, so it has to go first.
+      delete model;
+      dlclose(handle);
+    }
+  }
+}
@@ -0,0 +1,48 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_MULTISCALE_LOCAL_COUPLEDMODELLIBRARY_H
+#define HEMELB_MULTISCALE_LOCAL_COUPLEDMODELLIBRARY_H
+
+#include <string>
+#include "multiscale/local/CoupledModel.h"
+
+namespace hemelb
+{
+  namespace multiscale
+  {
+    /***
+     * A coupled model loaded from a shared library, which exports a CoupledModelFactory as
+     * FactorySymbol. The model lives as long as this does.
+     */
+    class CoupledModelLibrary
+    {
+      public:
+        static const char* const FactorySymbol;
+
+        /***
+         * Load the library and create its model, throwing if either fails.
+         * @param path The path of the shared library.
+         */
+        CoupledModelLibrary(const std::string& path);
+        ~CoupledModelLibrary();
+
+        CoupledModel& GetModel()
+        {
+          return *model;
+        }
+
+      private:
+        // Not copyable, as it owns the library handle.
+        CoupledModelLibrary(const CoupledModelLibrary&);
+        CoupledModelLibrary& operator=(const CoupledModelLibrary&);
+
+        void* handle;
+        CoupledModel* model;
+    };
+  }
+}
+
+#endif // HEMELB_MULTISCALE_LOCAL_COUPLEDMODELLIBRARY_H
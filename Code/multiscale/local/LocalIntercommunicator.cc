@@ -0,0 +1,69 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "multiscale/local/LocalIntercommunicator.h"
+#include "multiscale/SharedValue.h"
+#include "log/Logger.h"
+#include "Exception.h"
+
+namespace hemelb
+{
+  namespace multiscale
+  {
+    LocalIntercommunicator::LocalIntercommunicator(CoupledModel* model) :
+        model(model)
+    {
+    }
+
+    void LocalIntercommunicator::ShareInitialConditions()
+    {
+      if (model == NULL)
+      {
+        return;
+      }
+
+      FindSharedValues();
+      log::Logger::Log<log::Debug, log::OnePerCore>("Sharing %lu values with the co-located model",
+                                                    (unsigned long) sharedValues.size());
+      model->ShareInitialConditions(sharedValues);
+    }
+
+    bool LocalIntercommunicator::DoMultiscale(double newTime)
+    {
+      if (model != NULL)
+      {
+        model->AdvanceTo(newTime);
+      }
+      return true;
+    }
+
+    void LocalIntercommunicator::FindSharedValues()
+    {
+      sharedValues.clear();
+      for (ContentsType::iterator icandProperties = registeredObjects.begin();
+          icandProperties != registeredObjects.end(); icandProperties++)
+      {
+        Intercommunicand& icandContained = *icandProperties->first;
+        IntercommunicandTypeT& icandType = *icandProperties->second.first;
+        const std::string& icandLabel = icandProperties->second.second;
+
+        for (unsigned int sharedFieldIndex = 0;
+            sharedFieldIndex < icandContained.SharedValues().size(); sharedFieldIndex++)
+        {
+          const std::string& fieldLabel = icandType.Fields()[sharedFieldIndex].first;
+          if (icandType.Fields()[sharedFieldIndex].second != RuntimeTypeTraits::GetType<double>())
+          {
+            throw Exception() << "Only double values can be shared with a co-located model, not "
+                << icandLabel << "_" << fieldLabel;
+          }
+
+          double& value =
+              static_cast<SharedValue<double>&>(*icandContained.SharedValues()[sharedFieldIndex]);
+          sharedValues[icandLabel + "_" + fieldLabel] = &value;
+        }
+      }
+    }
+  }
+}
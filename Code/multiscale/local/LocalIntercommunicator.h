@@ -0,0 +1,74 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_MULTISCALE_LOCAL_LOCALINTERCOMMUNICATOR_H
+#define HEMELB_MULTISCALE_LOCAL_LOCALINTERCOMMUNICATOR_H
+
+#include "multiscale/Intercommunicator.h"
+#include "multiscale/local/CoupledModel.h"
+#include "net/mpi.h"
+
+namespace hemelb
+{
+  namespace multiscale
+  {
+    /***
+     * Type traits structure, using the HemeLB implementation of MPI_Datatype traits.
+     */
+    struct LocalRuntimeType
+    {
+        typedef MPI_Datatype RuntimeType;
+        template<class T> static RuntimeType GetType()
+        {
+          return net::MpiDataTypeTraits<T>::GetMpiDataType();
+        }
+    };
+
+    /**
+     Intercommunicator for a coupled model that runs in the same process as HemeLB, on the comms
+     rank, rather than at the other end of an MPWide connection.
+
+     The model is handed pointers to the registered shared values once, when the initial
+     conditions are shared, and from then on reads and sets them in place. So there is no
+     packing, unpacking or exchange of sizes, and a step of the coupling costs a call to the
+     model. Only double shared values can be shared this way.
+
+     The model is run on to HemeLB's time at every exchange, so HemeLB never waits for it and
+     always advances.
+     */
+    class LocalIntercommunicator : public Intercommunicator<LocalRuntimeType>
+    {
+      public:
+        /**
+         * @param model The co-located model, or NULL on the ranks that don't run it.
+         */
+        LocalIntercommunicator(CoupledModel* model);
+
+        /** This is run at the start of the HemeLB simulation. */
+        void ShareInitialConditions();
+        /** This is run at the start of every time step in the main HemeLB simulation. */
+        bool DoMultiscale(double newTime);
+
+        /**
+         * The shared values the model was given, empty on the ranks without it.
+         */
+        const LocalSharedValues& GetSharedValues() const
+        {
+          return sharedValues;
+        }
+
+      private:
+        /**
+         * Point at every registered shared value, by its label.
+         */
+        void FindSharedValues();
+
+        CoupledModel* model;
+        LocalSharedValues sharedValues;
+    };
+  }
+}
+
+#endif // HEMELB_MULTISCALE_LOCAL_LOCALINTERCOMMUNICATOR_H
@@ -13,6 +13,7 @@
 
 #include "multiscale/mpwide/MPWideIntercommunicator.h"
 #include "net/IOCommunicator.h"
+#include "Exception.h"
 #include <MPWide.h>
 #include <cstring>
 
@@ -26,11 +27,21 @@ namespace hemelb
     MPWideIntercommunicator::MPWideIntercommunicator(bool isCommsRank,
                                                      std::map<std::string, double> & buffer,
                                                      std::map<std::string, bool> &orchestration,
-                                                     std::string configFilePathIn) :
+                                                     std::string configFilePathIn,
+                                                     unsigned long maximumLag) :
         isCommsProc(isCommsRank),
             configFilePath(configFilePathIn), recv_icand_data_size(0), send_icand_data_size(0),
-            doubleContents(buffer), currentTime(0), orchestration(orchestration), channelCount(0)
+            doubleContents(buffer), currentTime(0), orchestration(orchestration), channelCount(0),
+            maximumLag(maximumLag), exchangeInProgress(false), stepsSinceExchangePosted(0),
+            exchangeArrived(false)
     {
+      pthread_mutex_init(&exchangeLock, NULL);
+    }
+
+    MPWideIntercommunicator::~MPWideIntercommunicator()
+    {
+      FinishExchange();
+      pthread_mutex_destroy(&exchangeLock);
     }
 
     void MPWideIntercommunicator::Initialize()
@@ -78,6 +89,7 @@ namespace hemelb
       }
 
       // Update the time and perform an initial exchange with the multiscale.
+      FinishExchange();
       doubleContents["shared_time"] = 0.0;
       ExchangeWithMultiscale();
     }
@@ -85,20 +97,110 @@ namespace hemelb
     /* This is run at the start of every time step in the main HemeLB simulation. */
     bool MPWideIntercommunicator::DoMultiscale(double new_time)
     {
-      // 1. Update the shared time, if we should take a time step.
+      if (maximumLag == 0 || !isCommsProc)
+      {
+        // 1. Update the shared time, if we should take a time step.
+        bool shouldAdvance = ShouldAdvance();
+        if (shouldAdvance)
+        {
+          UpdateSharedTime(new_time);
+        }
+
+        // 2. Exchange ICands with the other code.
+        ExchangeWithMultiscale();
+
+        // 3. Return the bool telling HemeLB whether to perform a timestep.
+        return shouldAdvance;
+      }
+
+      // 1. Apply the values of the exchange in flight, if they have arrived or we can't run
+      // any further ahead of them.
+      if (exchangeInProgress && (stepsSinceExchangePosted >= maximumLag || ExchangeArrived()))
+      {
+        FinishExchange();
+      }
+
+      // 2. Update the shared time, if we should take a time step.
       bool shouldAdvance = ShouldAdvance();
       if (shouldAdvance)
       {
         UpdateSharedTime(new_time);
       }
 
-      // 2. Exchange ICands with the other code.
-      ExchangeWithMultiscale();
+      // 3. Post the next exchange with the other code, if the last one has been applied.
+      if (!exchangeInProgress)
+      {
+        StartExchange();
+      }
+
+      // 4. There's nothing to overlap the exchange with if we're not advancing, so wait for it.
+      if (shouldAdvance)
+      {
+        ++stepsSinceExchangePosted;
+      }
+      else
+      {
+        FinishExchange();
+      }
 
-      // 3. Return the bool telling HemeLB whether to perform a timestep.
       return shouldAdvance;
     }
 
+    void MPWideIntercommunicator::StartExchange()
+    {
+      hemelb::log::Logger::Log<hemelb::log::Debug, hemelb::log::OnePerCore>("Posting exchange with multiscale");
+      SerializeRegisteredObjects(&ICandSendDataPacked.front(), registeredObjects);
+
+      exchangeArrived = false;
+      const int error = pthread_create(&exchangeThread,
+                                       NULL,
+                                       &MPWideIntercommunicator::ExchangeInBackground,
+                                       this);
+      if (error != 0)
+      {
+        throw Exception() << "Could not start the multiscale exchange thread: " << std::strerror(error);
+      }
+      exchangeInProgress = true;
+      stepsSinceExchangePosted = 0;
+    }
+
+    void* MPWideIntercommunicator::ExchangeInBackground(void* intercommunicator)
+    {
+      MPWideIntercommunicator* self = static_cast<MPWideIntercommunicator*>(intercommunicator);
+
+      // Only the packed buffers are touched here; the main thread leaves them alone until the
+      // exchange is finished.
+      self->ExchangePackages(&self->ICandSendDataPacked.front(), &self->ICandRecvDataPacked.front());
+
+      pthread_mutex_lock(&self->exchangeLock);
+      self->exchangeArrived = true;
+      pthread_mutex_unlock(&self->exchangeLock);
+      return NULL;
+    }
+
+    bool MPWideIntercommunicator::ExchangeArrived()
+    {
+      pthread_mutex_lock(&exchangeLock);
+      const bool arrived = exchangeArrived;
+      pthread_mutex_unlock(&exchangeLock);
+      return arrived;
+    }
+
+    void MPWideIntercommunicator::FinishExchange()
+    {
+      if (!exchangeInProgress)
+      {
+        return;
+      }
+
+      pthread_join(exchangeThread, NULL);
+      exchangeInProgress = false;
+
+      hemelb::log::Logger::Log<hemelb::log::Debug, hemelb::log::OnePerCore>("Applying multiscale exchange posted %lu steps ago",
+                                                                            stepsSinceExchangePosted);
+      UnpackReceivedData(registeredObjects, &ICandRecvDataPacked.front());
+    }
+
     void MPWideIntercommunicator::ExchangeWithMultiscale()
     {
       // 1. Pack/Serialize local shared data.
@@ -8,6 +8,7 @@
 #define HEMELB_MULTISCALE_MPWIDE_MPWIDEINTERCOMMUNICATOR_H
 
 #include <unistd.h>
+#include <pthread.h>
 #include <cstdio>
 #include <algorithm>
 #include <functional>
@@ -50,6 +51,12 @@ namespace hemelb
      different in size however if they contain vectors individually.
      + We currently think this limitation actually encourages writing proper ICands.
 
+     With a maximum lag of zero, every exchange is completed before the time step goes on. With
+     a lag of n, the comms proc posts the exchange on a background thread and the simulation carries
+     on with the previous boundary values; the received values are applied at the first step after
+     they arrive, and at the latest n steps after the exchange was posted, when the step waits for
+     them. The next exchange is posted once those values have been applied.
+
      This is a very dumb example of an intercommunicator. It stores communicated examples in a string-keyed buffer
      By sharing the same buffer between multiple intercommunicator interfaces, one can mock the behaviour of
      interprocess communication.
@@ -60,7 +67,10 @@ namespace hemelb
         MPWideIntercommunicator(bool isCommsRank,
                                 std::map<std::string, double> & buffer,
                                 std::map<std::string, bool> &orchestration,
-                                std::string configFilePathIn);
+                                std::string configFilePathIn,
+                                unsigned long maximumLag = 0);
+
+        ~MPWideIntercommunicator();
         /** This is run at the start of the HemeLB simulation. */
         void ShareInitialConditions();
         /** This is run at the start of every time step in the main HemeLB simulation. */
@@ -87,6 +97,27 @@ namespace hemelb
          */
         void ExchangeWithMultiscale();
 
+        /**
+         * Serializes the shared data and posts its exchange on a background thread.
+         */
+        void StartExchange();
+
+        /**
+         * True if the exchange on the background thread has finished.
+         */
+        bool ExchangeArrived();
+
+        /**
+         * Waits for the exchange on the background thread, if there is one, and unpacks what it
+         * received.
+         */
+        void FinishExchange();
+
+        /**
+         * The body of the background thread, exchanging the packages of an intercommunicator.
+         */
+        static void* ExchangeInBackground(void* intercommunicator);
+
         /**
          * True if we should advance the current time.
          * @return
@@ -192,6 +223,29 @@ namespace hemelb
          */
         std::vector<int> channels;
 
+        /**
+         * The most time steps to take with the previous boundary values while an exchange is
+         * in flight, or 0 to complete every exchange before carrying on.
+         */
+        unsigned long maximumLag;
+
+        /**
+         * True while an exchange posted on the background thread is yet to be unpacked.
+         */
+        bool exchangeInProgress;
+
+        /**
+         * Time steps taken since the exchange in progress was posted.
+         */
+        unsigned long stepsSinceExchangePosted;
+
+        /**
+         * Set by the background thread when its exchange is done, guarded by exchangeLock.
+         */
+        bool exchangeArrived;
+        pthread_mutex_t exchangeLock;
+        pthread_t exchangeThread;
+
         /**
          * True if MPWide has been initialised.
          */
@@ -18,6 +18,8 @@
 #include "util/utilityFunctions.h"
 #include "util/Vector3D.h"
 #include "net/IOCommunicator.h"
+#include "net/CommsStatistics.h"
+#include "net/ProgressThread.h"
 namespace hemelb
 {
   namespace net
@@ -31,12 +33,37 @@ namespace hemelb
     }
 
     BaseNet::BaseNet(const MpiCommunicator &commObject) :
-        BytesSent(0), SyncPointsCounted(0), communicator(commObject)
+        BytesSent(0), SyncPointsCounted(0), communicator(commObject), statistics(NULL),
+            commsOutstanding(false)
     {
     }
 
+    BaseNet::~BaseNet()
+    {
+      NoteCommsFinished();
+    }
+
+    void BaseNet::NoteCommsStarted()
+    {
+      if (!commsOutstanding)
+      {
+        commsOutstanding = true;
+        ProgressThread::CommsStarted();
+      }
+    }
+
+    void BaseNet::NoteCommsFinished()
+    {
+      if (commsOutstanding)
+      {
+        commsOutstanding = false;
+        ProgressThread::CommsFinished();
+      }
+    }
+
     void BaseNet::Receive()
     {
+      NoteCommsStarted();
       ReceiveGathers();
       ReceiveGatherVs();
       ReceiveAllToAll();
@@ -46,7 +73,7 @@ namespace hemelb
 
     void BaseNet::Send()
     {
-
+      NoteCommsStarted();
       SendGathers();
       SendGatherVs();
       SendAllToAll();
@@ -57,22 +84,56 @@ namespace hemelb
     void BaseNet::Wait()
     {
       SyncPointsCounted++; //DTMP: counter for monitoring purposes.
+      const double waitBegin = statistics != NULL ? util::myClock() : 0.0;
 
       WaitGathers();
       WaitGatherVs();
       WaitPointToPoint();
       WaitAllToAll();
+      NoteCommsFinished();
+
+      if (statistics != NULL)
+      {
+        statistics->RecordWait(util::myClock() - waitBegin);
+      }
 
       displacementsBuffer.clear();
       countsBuffer.clear();
     }
 
+    void BaseNet::Progress()
+    {
+      ProgressPointToPoint();
+    }
+
     std::vector<int> & BaseNet::GetDisplacementsBuffer()
     {
       displacementsBuffer.push_back(std::vector<int>());
       return displacementsBuffer.back();
     }
 
+    void BaseNet::RecordSend(int count, proc_t rank, MPI_Datatype type)
+    {
+      if (statistics != NULL)
+      {
+        // A large count's type can be more than an int's worth of bytes.
+        MPI_Count typeSize;
+        MPI_Type_size_x(type, &typeSize);
+        statistics->RecordSend(rank, (unsigned long long) count * typeSize);
+      }
+    }
+
+    void BaseNet::RecordReceive(int count, proc_t rank, MPI_Datatype type)
+    {
+      if (statistics != NULL)
+      {
+        // A large count's type can be more than an int's worth of bytes.
+        MPI_Count typeSize;
+        MPI_Type_size_x(type, &typeSize);
+        statistics->RecordReceive(rank, (unsigned long long) count * typeSize);
+      }
+    }
+
     std::vector<int> & BaseNet::GetCountsBuffer()
     {
       countsBuffer.push_back(std::vector<int>());
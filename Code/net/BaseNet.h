@@ -20,16 +20,14 @@ namespace hemelb
 {
   namespace net
   {
+    class CommsStatistics;
 
     class BaseNet
     {
       public:
         BaseNet(const MpiCommunicator &communicator);
 
-        virtual ~BaseNet()
-        {
-        }
-        ;
+        virtual ~BaseNet();
 
         //DTMP: monitoring variables
         long long int BytesSent;
@@ -39,11 +37,26 @@ namespace hemelb
         void Send();
         virtual void Wait();
 
+        /***
+         * Let MPI get on with the comms started by Receive and Send, without waiting for them,
+         * e.g. between chunks of the computation that they overlap.
+         */
+        void Progress();
+
         /***
          * Carry out a complete send-receive-wait
          */
         void Dispatch();
 
+        /***
+         * Count the point-to-point messages requested and the time spent waiting for them
+         * @param statistics Where to count them, or NULL to stop counting
+         */
+        void SetStatistics(CommsStatistics* statistics)
+        {
+          this->statistics = statistics;
+        }
+
         inline const MpiCommunicator &GetCommunicator() const
         {
           return communicator;
@@ -73,6 +86,8 @@ namespace hemelb
         virtual void WaitGatherVs()=0;
         virtual void WaitAllToAll()=0;
 
+        virtual void ProgressPointToPoint()=0;
+
         // Interfaces exposing MPI_Datatype, not intended for client class use
         virtual void RequestSendImpl(void* pointer, int count, proc_t rank, MPI_Datatype type)=0;
         virtual void RequestReceiveImpl(void* pointer, int count, proc_t rank, MPI_Datatype type)=0;
@@ -95,7 +110,14 @@ namespace hemelb
         std::vector<int> & GetDisplacementsBuffer();
         std::vector<int> & GetCountsBuffer();
 
+        /***
+         * Count a point-to-point message with the statistics, if any
+         */
+        void RecordSend(int count, proc_t rank, MPI_Datatype type);
+        void RecordReceive(int count, proc_t rank, MPI_Datatype type);
+
         const MpiCommunicator &communicator;
+        CommsStatistics* statistics;
       private:
         /***
          * Buffers which can be used to store displacements and counts for cleaning up interfaces
@@ -103,6 +125,14 @@ namespace hemelb
          */
         std::vector<std::vector<int> > displacementsBuffer;
         std::vector<std::vector<int> > countsBuffer;
+
+        /***
+         * Tell the progress thread, if there is one, when this net's comms start and finish
+         */
+        void NoteCommsStarted();
+        void NoteCommsFinished();
+        //! Whether this net is between a Send or Receive and the Wait
+        bool commsOutstanding;
     };
   }
 }
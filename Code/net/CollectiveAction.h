@@ -0,0 +1,114 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_NET_COLLECTIVEACTION_H
+#define HEMELB_NET_COLLECTIVEACTION_H
+
+#include "net/IteratedAction.h"
+#include "net/net.h"
+#include "lb/SimulationState.h"
+
+namespace hemelb
+{
+  namespace net
+  {
+    /**
+     * CollectiveAction - an alternative to PhasedBroadcastRegular for the monitoring classes,
+     * where the values from every process are combined by one nonblocking collective (e.g.
+     * MPI_Iallreduce) instead of being passed up and down a tree over several iterations.
+     *
+     * The collective is started in EndIteration, once the time step is done, and completed in
+     * the EndIteration stepsToComplete iterations later, when the next one is started. So the
+     * result lags the local values by stepsToComplete calls, and the MPI library has that long
+     * to finish it in the background.
+     *
+     * It can be used as the BroadcastPolicy of a class written for PhasedBroadcastRegular, which
+     * then has to implement StartReduction and PostReduce as well as the tree methods.
+     */
+    template<unsigned stepsToComplete = 1>
+    class CollectiveAction : public IteratedAction
+    {
+      public:
+        /**
+         * Constructor with the same arguments as PhasedBroadcastRegular's, so that this can
+         * stand in for it. There is no tree, so the spread factor is ignored.
+         *
+         * @param iNet
+         * @param iSimState
+         * @param spreadFactor
+         * @param callPeriod The number of time steps between calls, if the StepManager only calls
+         * this on every callPeriod-th step.
+         */
+        CollectiveAction(Net * iNet, const lb::SimulationState * iSimState, unsigned int spreadFactor,
+                         unsigned long callPeriod = 1) :
+            mSimState(iSimState), mNet(iNet), request(MPI_REQUEST_NULL), startTimeStep(0),
+                callPeriod(callPeriod), reductionInProgress(false)
+        {
+
+        }
+
+        /**
+         * A collective still in progress has to be completed before MPI is finalised. Every
+         * process is at the same step, so they all wait for the same one.
+         */
+        virtual ~CollectiveAction()
+        {
+          if (reductionInProgress)
+          {
+            MPI_Wait(&request, MPI_STATUS_IGNORE);
+          }
+        }
+
+        /**
+         * Complete the collective in progress, if it is due, and start the next one.
+         */
+        void EndIteration()
+        {
+          if (reductionInProgress)
+          {
+            if (mSimState->Get0IndexedTimeStep() - startTimeStep < stepsToComplete * callPeriod)
+            {
+              // Not due yet; just give MPI the chance to move it along.
+              int done;
+              HEMELB_MPI_CALL(MPI_Test, (&request, &done, MPI_STATUS_IGNORE));
+              return;
+            }
+
+            HEMELB_MPI_CALL(MPI_Wait, (&request, MPI_STATUS_IGNORE));
+            reductionInProgress = false;
+            PostReduce();
+          }
+
+          StartReduction(mNet->GetCommunicator(), request);
+          startTimeStep = mSimState->Get0IndexedTimeStep();
+          reductionInProgress = true;
+        }
+
+      protected:
+        /**
+         * Overridable function to work out the values of this process and start the collective
+         * that combines them, on the given communicator and with the given request. The buffers
+         * passed to the collective must not be touched until PostReduce.
+         */
+        virtual void StartReduction(const MpiCommunicator& comms, MPI_Request& request) = 0;
+
+        /**
+         * Overridable function to use the combined values, once the collective is complete.
+         */
+        virtual void PostReduce() = 0;
+
+        const lb::SimulationState * mSimState;
+        Net * mNet;
+
+      private:
+        MPI_Request request;
+        LatticeTimeStep startTimeStep;
+        unsigned long callPeriod;
+        bool reductionInProgress;
+    };
+  }
+}
+
+#endif /* HEMELB_NET_COLLECTIVEACTION_H */
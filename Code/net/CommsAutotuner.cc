@@ -0,0 +1,122 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "net/CommsAutotuner.h"
+#include <algorithm>
+#include "net/mixins/mixins.h"
+#include "util/utilityFunctions.h"
+#include "log/Logger.h"
+
+namespace hemelb
+{
+  namespace net
+  {
+    namespace
+    {
+      /**
+       * A net with every point-to-point implementation, whatever the build's nets have.
+       */
+      class TuningNet : public SelectablePointPoint,
+                        public InterfaceDelegationNet,
+                        public SeparatedAllToAll,
+                        public SeparatedGathers
+      {
+        public:
+          TuningNet(const MpiCommunicator& communicator) :
+              BaseNet(communicator), StoringNet(communicator), SelectablePointPoint(communicator),
+                  InterfaceDelegationNet(communicator), SeparatedAllToAll(communicator),
+                  SeparatedGathers(communicator)
+          {
+          }
+      };
+
+      const CommsStrategy::PointPoint candidates[] = { CommsStrategy::PointPointCoalesce,
+                                                        CommsStrategy::PointPointSeparated,
+                                                        CommsStrategy::PointPointPersistent };
+    }
+
+    CommsAutotuner::CommsAutotuner(const MpiCommunicator& comms) :
+        comms(comms)
+    {
+    }
+
+    CommsStrategy::PointPoint CommsAutotuner::Tune(const std::map<proc_t, site_t>& distributionsForEachNeighbour,
+                                                   unsigned exchanges)
+    {
+      std::map<proc_t, std::vector<distribn_t> > sendBuffers;
+      std::map<proc_t, std::vector<distribn_t> > receiveBuffers;
+      for (std::map<proc_t, site_t>::const_iterator neighbour = distributionsForEachNeighbour.begin();
+          neighbour != distributionsForEachNeighbour.end(); ++neighbour)
+      {
+        if (neighbour->second > 0)
+        {
+          sendBuffers[neighbour->first].assign(neighbour->second, 1.0);
+          receiveBuffers[neighbour->first].resize(neighbour->second);
+        }
+      }
+
+      TuningNet net(comms);
+      timings.clear();
+      CommsStrategy::PointPoint fastest = candidates[0];
+      double fastestTime = 0.0;
+      for (size_t candidate = 0; candidate < sizeof(candidates) / sizeof(candidates[0]); ++candidate)
+      {
+        net.SetPointPointStrategy(candidates[candidate]);
+        double start = 0.0;
+        for (unsigned exchange = 0; exchange < WARM_UP_EXCHANGES + exchanges; ++exchange)
+        {
+          if (exchange == WARM_UP_EXCHANGES)
+          {
+            HEMELB_MPI_CALL(MPI_Barrier, (comms));
+            start = util::myClock();
+          }
+          for (std::map<proc_t, std::vector<distribn_t> >::iterator buffer = sendBuffers.begin();
+              buffer != sendBuffers.end(); ++buffer)
+          {
+            net.RequestReceiveV(receiveBuffers[buffer->first], buffer->first);
+            net.RequestSendV(buffer->second, buffer->first);
+          }
+          net.Dispatch();
+        }
+        const double time = comms.AllReduce(util::myClock() - start, MPI_MAX)
+            / std::max(exchanges, 1u);
+        timings.push_back(std::make_pair(candidates[candidate], time));
+        log::Logger::Log<log::Debug, log::Singleton>("Halo exchange by %s point to point comms took %.3g s",
+                                                     CommsStrategy::GetName(candidates[candidate]),
+                                                     time);
+        if (candidate == 0 || time < fastestTime)
+        {
+          fastest = candidates[candidate];
+          fastestTime = time;
+        }
+      }
+      return fastest;
+    }
+
+    void CommsAutotuner::Report(ctemplate::TemplateDictionary& dictionary)
+    {
+      ctemplate::TemplateDictionary *section = dictionary.AddSectionDictionary("COMMS_STRATEGY");
+      section->SetValue("POINTPOINT", CommsStrategy::GetName(strategy.pointPoint));
+      section->SetValue("GATHERS", CommsStrategy::GetName(strategy.gathers));
+      section->SetValue("ALLTOALL", CommsStrategy::GetName(strategy.allToAll));
+      section->SetValue("SEPARATE_CONCERNS", strategy.separateConcerns ?
+        "true" :
+        "false");
+      section->SetValue("SELECTABLE", CommsStrategy::IsSelectable() ?
+        "true" :
+        "false");
+      section->SetValue("AUTOTUNED", timings.empty() ?
+        "false" :
+        "true");
+      for (size_t candidate = 0; candidate < timings.size(); ++candidate)
+      {
+        ctemplate::TemplateDictionary *candidateSection =
+            section->AddSectionDictionary("COMMS_CANDIDATE");
+        candidateSection->SetValue("NAME", CommsStrategy::GetName(timings[candidate].first));
+        candidateSection->SetFormattedValue("TIME", "%.6g", timings[candidate].second);
+      }
+    }
+  }
+}
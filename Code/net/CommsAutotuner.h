@@ -0,0 +1,74 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_NET_COMMSAUTOTUNER_H
+#define HEMELB_NET_COMMSAUTOTUNER_H
+
+#include <map>
+#include <vector>
+#include "constants.h"
+#include "net/CommsStrategy.h"
+#include "net/MpiCommunicator.h"
+#include "reporting/Reportable.h"
+
+namespace hemelb
+{
+  namespace net
+  {
+    /**
+     * Picks the fastest point-to-point comms for a halo exchange by timing each candidate
+     * implementation on a few exchanges of the same pattern - the same neighbours, with the
+     * same number of distributions each way - and reports the comms strategy the run used,
+     * with the times of the candidates if it was tuned.
+     *
+     * The immediate point-to-point comms aren't a candidate: their sends are synchronous, so
+     * neighbours that both send to each other first would never finish.
+     */
+    class CommsAutotuner : public reporting::Reportable
+    {
+      public:
+        CommsAutotuner(const MpiCommunicator& comms);
+
+        /**
+         * Time each candidate on the halo exchange. Collective.
+         * @param distributionsForEachNeighbour The number of distributions exchanged with each
+         * neighbouring rank, each way
+         * @param exchanges The exchanges to time each candidate on, after a couple to warm up
+         * @return The candidate the slowest rank took the least time with, the same on every rank
+         */
+        CommsStrategy::PointPoint Tune(const std::map<proc_t, site_t>& distributionsForEachNeighbour,
+                                       unsigned exchanges);
+
+        /**
+         * @return The slowest rank's mean time for an exchange with each candidate, in the order
+         * they were tried, or none if not tuned
+         */
+        const std::vector<std::pair<CommsStrategy::PointPoint, double> >& GetTimings() const
+        {
+          return timings;
+        }
+
+        /**
+         * Record the strategy the run used, to report.
+         */
+        void SetStrategy(const CommsStrategy& used)
+        {
+          strategy = used;
+        }
+
+        void Report(ctemplate::TemplateDictionary& dictionary);
+
+      private:
+        //! Exchanges before the timed ones, to set up the MPI types and persistent requests
+        static const unsigned WARM_UP_EXCHANGES = 2;
+
+        const MpiCommunicator& comms;
+        CommsStrategy strategy;
+        std::vector<std::pair<CommsStrategy::PointPoint, double> > timings;
+    };
+  }
+}
+
+#endif // HEMELB_NET_COMMSAUTOTUNER_H
@@ -0,0 +1,202 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "net/CommsStatistics.h"
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+#include "net/phased/StepTracer.h"
+
+namespace hemelb
+{
+  namespace net
+  {
+    CommsStatistics::CommsStatistics(const IOCommunicator& comms) :
+        comms(comms), currentConcern(NULL), totalWaitTime(0.0)
+    {
+    }
+
+    void CommsStatistics::RecordSend(proc_t peer, unsigned long long bytes)
+    {
+      Counts& peerCounts = peers[peer];
+      peerCounts.sentMessages++;
+      peerCounts.sentBytes += bytes;
+      Counts& concernCounts = concerns[currentConcern];
+      concernCounts.sentMessages++;
+      concernCounts.sentBytes += bytes;
+      pendingPeers.insert(peer);
+      pendingConcerns.insert(currentConcern);
+    }
+
+    void CommsStatistics::RecordReceive(proc_t peer, unsigned long long bytes)
+    {
+      Counts& peerCounts = peers[peer];
+      peerCounts.receivedMessages++;
+      peerCounts.receivedBytes += bytes;
+      Counts& concernCounts = concerns[currentConcern];
+      concernCounts.receivedMessages++;
+      concernCounts.receivedBytes += bytes;
+      pendingPeers.insert(peer);
+      pendingConcerns.insert(currentConcern);
+    }
+
+    void CommsStatistics::RecordWait(double seconds)
+    {
+      totalWaitTime += seconds;
+      for (std::set<proc_t>::const_iterator peer = pendingPeers.begin(); peer != pendingPeers.end();
+          ++peer)
+      {
+        peers[*peer].waitTime += seconds;
+      }
+      for (std::set<const char*>::const_iterator concern = pendingConcerns.begin();
+          concern != pendingConcerns.end(); ++concern)
+      {
+        concerns[*concern].waitTime += seconds;
+      }
+      pendingPeers.clear();
+      pendingConcerns.clear();
+    }
+
+    void CommsStatistics::Reduce(const std::string& matrixPath)
+    {
+      // Seven numbers for each peer: this rank, the peer and its counts.
+      const unsigned valuesPerRow = 7;
+      std::vector<double> rows;
+      Counts total;
+      for (std::map<proc_t, Counts>::const_iterator peer = peers.begin(); peer != peers.end(); ++peer)
+      {
+        const Counts& counts = peer->second;
+        rows.push_back(comms.Rank());
+        rows.push_back(peer->first);
+        rows.push_back(counts.sentMessages);
+        rows.push_back(counts.sentBytes);
+        rows.push_back(counts.receivedMessages);
+        rows.push_back(counts.receivedBytes);
+        rows.push_back(counts.waitTime);
+        total.sentMessages += counts.sentMessages;
+        total.sentBytes += counts.sentBytes;
+        total.receivedBytes += counts.receivedBytes;
+      }
+      const std::vector<double> allRows = comms.GatherV(rows, comms.GetIORank());
+
+      // One tab-separated line for each concern, since their names vary in length.
+      std::ostringstream concernLines;
+      for (std::map<const char*, Counts>::const_iterator concern = concerns.begin();
+          concern != concerns.end(); ++concern)
+      {
+        const Counts& counts = concern->second;
+        concernLines << (concern->first == NULL ?
+          std::string("none") :
+          phased::StepTracer::GetConcernName(concern->first)) << '\t' << counts.sentMessages
+            << '\t' << counts.sentBytes << '\t' << counts.receivedMessages << '\t'
+            << counts.receivedBytes << '\t' << counts.waitTime << '\n';
+      }
+      const std::string localLines = concernLines.str();
+      const std::vector<char> allLines = comms.GatherV(std::vector<char>(localLines.begin(),
+                                                                         localLines.end()),
+                                                       comms.GetIORank());
+
+      const std::vector<double> sentBytes = comms.Gather(double(total.sentBytes), comms.GetIORank());
+      const std::vector<double> sentMessages = comms.Gather(double(total.sentMessages),
+                                                            comms.GetIORank());
+      const std::vector<double> receivedBytes = comms.Gather(double(total.receivedBytes),
+                                                             comms.GetIORank());
+      const std::vector<double> neighbours = comms.Gather(double(peers.size()), comms.GetIORank());
+      const std::vector<double> waitTimes = comms.Gather(totalWaitTime, comms.GetIORank());
+
+      if (!comms.OnIORank())
+      {
+        return;
+      }
+
+      Summarise("sent_bytes", sentBytes);
+      Summarise("sent_messages", sentMessages);
+      Summarise("received_bytes", receivedBytes);
+      Summarise("neighbours", neighbours);
+      Summarise("wait_time", waitTimes);
+
+      std::istringstream lines(std::string(allLines.begin(), allLines.end()));
+      std::string name;
+      while (std::getline(lines, name, '\t'))
+      {
+        Counts counts;
+        lines >> counts.sentMessages >> counts.sentBytes >> counts.receivedMessages
+            >> counts.receivedBytes >> counts.waitTime;
+        lines.ignore();
+        Counts& totals = totalsForEachConcern[name];
+        totals.sentMessages += counts.sentMessages;
+        totals.sentBytes += counts.sentBytes;
+        totals.receivedMessages += counts.receivedMessages;
+        totals.receivedBytes += counts.receivedBytes;
+        totals.waitTime += counts.waitTime;
+      }
+
+      if (matrixPath.empty())
+      {
+        return;
+      }
+      FILE* matrix = std::fopen(matrixPath.c_str(), "w");
+      if (matrix == NULL)
+      {
+        return;
+      }
+      std::fprintf(matrix,
+                   "# rank peer sent_messages sent_bytes received_messages received_bytes wait_seconds\n");
+      for (size_t row = 0; row < allRows.size(); row += valuesPerRow)
+      {
+        std::fprintf(matrix,
+                     "%.0f %.0f %.0f %.0f %.0f %.0f %.6f\n",
+                     allRows[row],
+                     allRows[row + 1],
+                     allRows[row + 2],
+                     allRows[row + 3],
+                     allRows[row + 4],
+                     allRows[row + 5],
+                     allRows[row + 6]);
+      }
+      std::fclose(matrix);
+    }
+
+    void CommsStatistics::Summarise(const char* name, const std::vector<double>& values)
+    {
+      double total = 0.0;
+      for (std::vector<double>::const_iterator value = values.begin(); value != values.end(); ++value)
+      {
+        total += *value;
+      }
+      std::vector<double>& quantity = summary[name];
+      quantity.clear();
+      quantity.push_back(*std::min_element(values.begin(), values.end()));
+      quantity.push_back(total / values.size());
+      quantity.push_back(*std::max_element(values.begin(), values.end()));
+      quantity.push_back(total);
+    }
+
+    void CommsStatistics::Report(ctemplate::TemplateDictionary& dictionary)
+    {
+      for (std::map<std::string, std::vector<double> >::const_iterator quantity = summary.begin();
+          quantity != summary.end(); ++quantity)
+      {
+        ctemplate::TemplateDictionary *section = dictionary.AddSectionDictionary("COMMS_QUANTITY");
+        section->SetValue("NAME", quantity->first);
+        section->SetFormattedValue("MIN", "%.6g", quantity->second[0]);
+        section->SetFormattedValue("MEAN", "%.6g", quantity->second[1]);
+        section->SetFormattedValue("MAX", "%.6g", quantity->second[2]);
+        section->SetFormattedValue("TOTAL", "%.6g", quantity->second[3]);
+      }
+      for (std::map<std::string, Counts>::const_iterator concern = totalsForEachConcern.begin();
+          concern != totalsForEachConcern.end(); ++concern)
+      {
+        ctemplate::TemplateDictionary *section = dictionary.AddSectionDictionary("COMMS_CONCERN");
+        section->SetValue("NAME", concern->first);
+        section->SetFormattedValue("SENT_MESSAGES", "%lu", concern->second.sentMessages);
+        section->SetFormattedValue("SENT_BYTES", "%llu", concern->second.sentBytes);
+        section->SetFormattedValue("RECEIVED_MESSAGES", "%lu", concern->second.receivedMessages);
+        section->SetFormattedValue("RECEIVED_BYTES", "%llu", concern->second.receivedBytes);
+        section->SetFormattedValue("WAIT", "%.3g", concern->second.waitTime);
+      }
+    }
+  }
+}
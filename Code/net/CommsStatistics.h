@@ -0,0 +1,114 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_NET_COMMSSTATISTICS_H
+#define HEMELB_NET_COMMSSTATISTICS_H
+
+#include <map>
+#include <set>
+#include <string>
+#include "constants.h"
+#include "net/IOCommunicator.h"
+#include "reporting/Reportable.h"
+
+namespace hemelb
+{
+  namespace net
+  {
+    /**
+     * Counts the point-to-point messages a net sends to and receives from each peer rank, and
+     * for each concern of the step manager, with their sizes and the time spent waiting for
+     * them. This shows which pairs of ranks, and which concerns, the halo traffic is between.
+     *
+     * A net's Wait completes every message requested since the last one, so the time it takes
+     * is added to each peer and concern with a message in it.
+     *
+     * The messages counted are the ones requested of the net. The coalescing point-to-point
+     * implementations send all those to a peer in a Dispatch as one, so fewer go over the wire.
+     *
+     * At the end of the run Reduce gathers the counts of every rank to the I/O rank, which
+     * writes them as a communication matrix and reports a summary.
+     */
+    class CommsStatistics : public reporting::Reportable
+    {
+      public:
+        struct Counts
+        {
+            unsigned long sentMessages;
+            unsigned long long sentBytes;
+            unsigned long receivedMessages;
+            unsigned long long receivedBytes;
+            double waitTime;
+
+            Counts() :
+                sentMessages(0), sentBytes(0), receivedMessages(0), receivedBytes(0), waitTime(0.0)
+            {
+            }
+        };
+
+        CommsStatistics(const IOCommunicator& comms);
+
+        /**
+         * Attribute the messages requested from now on to a concern.
+         * @param concernType The mangled type name of the concern, or NULL for none
+         */
+        void SetCurrentConcern(const char* concernType)
+        {
+          currentConcern = concernType;
+        }
+
+        void RecordSend(proc_t peer, unsigned long long bytes);
+        void RecordReceive(proc_t peer, unsigned long long bytes);
+
+        /**
+         * Record the time a Wait took, completing every message recorded since the last.
+         */
+        void RecordWait(double seconds);
+
+        const std::map<proc_t, Counts>& GetPeerCounts() const
+        {
+          return peers;
+        }
+
+        /**
+         * @return The counts for each concern, by mangled type name (NULL for none)
+         */
+        const std::map<const char*, Counts>& GetConcernCounts() const
+        {
+          return concerns;
+        }
+
+        /**
+         * Gather the counts of every rank to the I/O rank, which writes the communication
+         * matrix there and keeps the summary to report. Collective.
+         * @param matrixPath The file to write the matrix to, one line for each pair of ranks
+         * that communicated, or empty not to write it
+         */
+        void Reduce(const std::string& matrixPath);
+
+        void Report(ctemplate::TemplateDictionary& dictionary);
+
+      private:
+        void Summarise(const char* name, const std::vector<double>& values);
+
+        const IOCommunicator& comms;
+        const char* currentConcern;
+        std::map<proc_t, Counts> peers;
+        std::map<const char*, Counts> concerns;
+
+        /** The peers and concerns with a message since the last Wait */
+        std::set<proc_t> pendingPeers;
+        std::set<const char*> pendingConcerns;
+        double totalWaitTime;
+
+        /** Set on the I/O rank by Reduce: min, mean, max and total over the ranks of each
+         *  summarised quantity, and the counts of each concern over every rank */
+        std::map<std::string, std::vector<double> > summary;
+        std::map<std::string, Counts> totalsForEachConcern;
+    };
+  }
+}
+
+#endif // HEMELB_NET_COMMSSTATISTICS_H
@@ -0,0 +1,116 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "net/CommsStrategy.h"
+#include "net/mixins/mixins.h"
+#include "net/BuildInfo.h"
+
+namespace hemelb
+{
+  namespace net
+  {
+    namespace
+    {
+      CommsStrategy& DefaultStrategy()
+      {
+        static CommsStrategy strategy;
+        return strategy;
+      }
+    }
+
+    CommsStrategy::CommsStrategy() :
+        pointPoint(PointPointCoalesce), gathers(CollectiveSeparated),
+            allToAll(CollectiveSeparated), separateConcerns(separate_communications)
+    {
+      // The RMA comms can only be built in, and leave the point-to-point comms as they are.
+      ParsePointPoint(configured_point_point_impl, pointPoint);
+      ParseCollective(configured_gathers_impl, gathers);
+      ParseCollective(configured_alltoall_impl, allToAll);
+    }
+
+    bool CommsStrategy::IsSelectable()
+    {
+#ifdef HEMELB_RUNTIME_COMMS_SELECTION
+      return true;
+#else
+      return false;
+#endif
+    }
+
+    const CommsStrategy& CommsStrategy::GetDefault()
+    {
+      return DefaultStrategy();
+    }
+
+    void CommsStrategy::SetDefault(const CommsStrategy& strategy)
+    {
+      DefaultStrategy() = strategy;
+    }
+
+    bool CommsStrategy::ParsePointPoint(const std::string& text, PointPoint& pointPoint)
+    {
+      if (text == "Coalesce")
+      {
+        pointPoint = PointPointCoalesce;
+      }
+      else if (text == "Separated")
+      {
+        pointPoint = PointPointSeparated;
+      }
+      else if (text == "Immediate")
+      {
+        pointPoint = PointPointImmediate;
+      }
+      else if (text == "Persistent")
+      {
+        pointPoint = PointPointPersistent;
+      }
+      else
+      {
+        return false;
+      }
+      return true;
+    }
+
+    bool CommsStrategy::ParseCollective(const std::string& text, Collective& collective)
+    {
+      if (text == "Separated")
+      {
+        collective = CollectiveSeparated;
+      }
+      else if (text == "ViaPointPoint")
+      {
+        collective = CollectiveViaPointPoint;
+      }
+      else
+      {
+        return false;
+      }
+      return true;
+    }
+
+    const char* CommsStrategy::GetName(PointPoint pointPoint)
+    {
+      switch (pointPoint)
+      {
+        case PointPointSeparated:
+          return "Separated";
+        case PointPointImmediate:
+          return "Immediate";
+        case PointPointPersistent:
+          return "Persistent";
+        default:
+          return "Coalesce";
+      }
+    }
+
+    const char* CommsStrategy::GetName(Collective collective)
+    {
+      return collective == CollectiveViaPointPoint ?
+        "ViaPointPoint" :
+        "Separated";
+    }
+  }
+}
@@ -0,0 +1,81 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_NET_COMMSSTRATEGY_H
+#define HEMELB_NET_COMMSSTRATEGY_H
+
+#include <string>
+
+namespace hemelb
+{
+  namespace net
+  {
+    /**
+     * Which of the comms implementations of net/mixins a net uses. With
+     * HEMELB_RUNTIME_COMMS_SELECTION, nets are built with all of them (apart from the RMA
+     * point-to-point comms, as making its window is collective) and each can be switched between
+     * Dispatches; without it, the implementations are fixed when HemeLB is configured.
+     */
+    struct CommsStrategy
+    {
+        enum PointPoint
+        {
+          PointPointCoalesce,
+          PointPointSeparated,
+          PointPointImmediate,
+          PointPointPersistent
+        };
+
+        enum Collective
+        {
+          CollectiveSeparated,
+          CollectiveViaPointPoint
+        };
+
+        /**
+         * The implementations HemeLB was configured with.
+         */
+        CommsStrategy();
+
+        PointPoint pointPoint;
+        Collective gathers;
+        Collective allToAll;
+        //! Whether the step manager gives each concern its own Send, Receive and Wait
+        bool separateConcerns;
+
+        /**
+         * @return Whether nets can switch implementation at run time.
+         */
+        static bool IsSelectable();
+
+        /**
+         * The strategy new nets start with, the configured one until it is changed.
+         */
+        static const CommsStrategy& GetDefault();
+        static void SetDefault(const CommsStrategy& strategy);
+
+        /**
+         * Parse the name of a point-to-point implementation, as in HEMELB_POINTPOINT_IMPLEMENTATION.
+         * @param text
+         * @param pointPoint Set to the implementation, if it can be parsed.
+         * @return Whether it could be.
+         */
+        static bool ParsePointPoint(const std::string& text, PointPoint& pointPoint);
+
+        /**
+         * Parse the name of a gathers or all-to-all implementation, "Separated" or "ViaPointPoint".
+         * @param text
+         * @param collective Set to the implementation, if it can be parsed.
+         * @return Whether it could be.
+         */
+        static bool ParseCollective(const std::string& text, Collective& collective);
+
+        static const char* GetName(PointPoint pointPoint);
+        static const char* GetName(Collective collective);
+    };
+  }
+}
+
+#endif /* HEMELB_NET_COMMSSTRATEGY_H */
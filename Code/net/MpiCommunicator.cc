@@ -111,5 +111,36 @@ namespace hemelb
       HEMELB_MPI_CALL(MPI_Comm_dup, (*commPtr, &newComm));
       return MpiCommunicator(newComm, true);
     }
+
+    MpiCommunicator MpiCommunicator::SplitShared() const
+    {
+      MPI_Comm newComm;
+      HEMELB_MPI_CALL(MPI_Comm_split_type, (*commPtr, MPI_COMM_TYPE_SHARED, Rank(), MPI_INFO_NULL, &newComm));
+      return MpiCommunicator(newComm, true);
+    }
+
+    MpiCommunicator MpiCommunicator::Split(int colour, int key) const
+    {
+      MPI_Comm newComm;
+      HEMELB_MPI_CALL(MPI_Comm_split, (*commPtr, colour, key, &newComm));
+      return MpiCommunicator(newComm, true);
+    }
+
+    MpiCommunicator MpiCommunicator::DistGraphAdjacent(const std::vector<int>& neighbours,
+                                                       const std::vector<int>& weights, bool reorder) const
+    {
+      const int degree = neighbours.size();
+      int* ranks = degree
+        ? const_cast<int*>(&neighbours.front())
+        : NULL;
+      int* rankWeights = degree
+        ? const_cast<int*>(&weights.front())
+        : MPI_WEIGHTS_EMPTY;
+
+      MPI_Comm newComm;
+      HEMELB_MPI_CALL(MPI_Dist_graph_create_adjacent,
+                      (*commPtr, degree, ranks, rankWeights, degree, ranks, rankWeights, MPI_INFO_NULL, reorder, &newComm));
+      return MpiCommunicator(newComm, true);
+    }
   }
 }
@@ -88,6 +88,34 @@ namespace hemelb
          */
         MpiCommunicator Duplicate() const;
 
+        /**
+         * Creates a communicator of the processes on this communicator that can share memory with
+         * this process (i.e. are on the same node) - see MPI_COMM_SPLIT_TYPE
+         * @return New communicator.
+         */
+        MpiCommunicator SplitShared() const;
+
+        /**
+         * Creates a communicator of the processes on this communicator that give the same colour
+         * - see MPI_COMM_SPLIT
+         * @param colour
+         * @param key Orders the processes in the new communicator.
+         * @return New communicator.
+         */
+        MpiCommunicator Split(int colour, int key) const;
+
+        /**
+         * Creates a communicator with a distributed graph topology in which this process
+         * exchanges data with the same neighbours in both directions - see
+         * MPI_DIST_GRAPH_CREATE_ADJACENT
+         * @param neighbours Ranks (on this communicator) of the neighbours.
+         * @param weights The amount of data exchanged with each neighbour.
+         * @param reorder Whether MPI may renumber the processes.
+         * @return New communicator.
+         */
+        MpiCommunicator DistGraphAdjacent(const std::vector<int>& neighbours, const std::vector<int>& weights,
+                                          bool reorder) const;
+
         template <typename T>
         void Broadcast(T& val, const int root) const;
         template <typename T>
@@ -103,14 +131,52 @@ namespace hemelb
         template <typename T>
         std::vector<T> Reduce(const std::vector<T>& vals, const MPI_Op& op, const int root) const;
 
+        /**
+         * Exclusive scan: the reduction by op of the values on all lower ranks. MPI leaves the
+         * result undefined on rank 0, so there this returns T() (the identity for MPI_SUM).
+         * @param val
+         * @param op
+         * @return
+         */
+        template <typename T>
+        T ExScan(const T& val, const MPI_Op& op) const;
+
         template <typename T>
         std::vector<T> Gather(const T& val, const int root) const;
 
+        /**
+         * Gather a variable number of values from each process onto the root.
+         * @param vals This process's values.
+         * @param root
+         * @return On the root, the values from each process one after the other in rank order;
+         * elsewhere, nothing.
+         */
+        template <typename T>
+        std::vector<T> GatherV(const std::vector<T>& vals, const int root) const;
+
         template <typename T>
         std::vector<T> AllGather(const T& val) const;
 
         template <typename T>
         std::vector<T> AllToAll(const std::vector<T>& vals) const;
+        /**
+         * Send a variable number of values to each process, and receive whatever each sends.
+         * @param vals The values for each process, one after the other in rank order.
+         * @param sendCounts The number of values for each process.
+         * @return The values from each process, one after the other in rank order.
+         */
+        template <typename T>
+        std::vector<T> AllToAllV(const std::vector<T>& vals, const std::vector<int>& sendCounts) const;
+        /**
+         * As above, when the number of values each process sends here is already known.
+         * @param vals
+         * @param sendCounts
+         * @param receiveCounts The number of values from each process.
+         * @return
+         */
+        template <typename T>
+        std::vector<T> AllToAllV(const std::vector<T>& vals, const std::vector<int>& sendCounts,
+                                 const std::vector<int>& receiveCounts) const;
 
         template <typename T>
         void Send(const T& val, int dest, int tag=0) const;
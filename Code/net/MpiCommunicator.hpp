@@ -6,6 +6,7 @@
 #ifndef HEMELB_NET_MPICOMMUNICATOR_HPP
 #define HEMELB_NET_MPICOMMUNICATOR_HPP
 
+#include <limits>
 #include "net/MpiDataType.h"
 #include "net/MpiConstness.h"
 
@@ -24,9 +25,10 @@ namespace hemelb
     template<typename T>
     void MpiCommunicator::Broadcast(std::vector<T>& vals, const int root) const
     {
+      LargeCount elements(vals.size(), MpiDataType<T>());
       HEMELB_MPI_CALL(
           MPI_Bcast,
-          (&vals[0], vals.size(), MpiDataType<T>(), root, *this)
+          (&vals[0], elements.Count(), elements.Type(), root, *this)
       );
     }
 
@@ -84,6 +86,17 @@ namespace hemelb
       return ans;
     }
 
+    template<typename T>
+    T MpiCommunicator::ExScan(const T& val, const MPI_Op& op) const
+    {
+      T ans = T();
+      HEMELB_MPI_CALL(
+          MPI_Exscan,
+          (MpiConstCast(&val), &ans, 1, MpiDataType<T>(), op, *this)
+      );
+      return Rank() == 0 ? T() : ans;
+    }
+
     template<typename T>
     std::vector<T> MpiCommunicator::Gather(const T& val, const int root) const
     {
@@ -105,6 +118,32 @@ namespace hemelb
       return ans;
     }
 
+    template<typename T>
+    std::vector<T> MpiCommunicator::GatherV(const std::vector<T>& vals, const int root) const
+    {
+      const std::vector<int> counts = Gather(int(vals.size()), root);
+
+      std::vector<T> ans;
+      std::vector<int> displacements;
+      if (Rank() == root)
+      {
+        displacements.assign(Size(), 0);
+        for (int rank = 1; rank < Size(); ++rank)
+        {
+          displacements[rank] = displacements[rank - 1] + counts[rank - 1];
+        }
+        ans.resize(displacements[Size() - 1] + counts[Size() - 1]);
+      }
+      HEMELB_MPI_CALL(
+          MPI_Gatherv,
+          (MpiConstCast(vals.empty() ? NULL : &vals[0]), vals.size(), MpiDataType<T>(),
+           ans.empty() ? NULL : &ans[0], counts.empty() ? NULL : MpiConstCast(&counts[0]),
+           displacements.empty() ? NULL : MpiConstCast(&displacements[0]), MpiDataType<T>(),
+           root, *this)
+      );
+      return ans;
+    }
+
     template<typename T>
     std::vector<T> MpiCommunicator::AllGather(const T& val) const
     {
@@ -133,6 +172,84 @@ namespace hemelb
       return ans;
     }
 
+    template <typename T>
+    std::vector<T> MpiCommunicator::AllToAllV(const std::vector<T>& vals,
+                                              const std::vector<int>& sendCounts) const
+    {
+      return AllToAllV(vals, sendCounts, AllToAll(sendCounts));
+    }
+
+    template <typename T>
+    std::vector<T> MpiCommunicator::AllToAllV(const std::vector<T>& vals,
+                                              const std::vector<int>& sendCounts,
+                                              const std::vector<int>& receiveCounts) const
+    {
+      size_t sendTotal = 0, receiveTotal = 0;
+      for (int rank = 0; rank < Size(); ++rank)
+      {
+        sendTotal += sendCounts[rank];
+        receiveTotal += receiveCounts[rank];
+      }
+      std::vector<T> ans(receiveTotal);
+
+      // MPI_Alltoallv's displacements are ints, so beyond their range each process is sent its
+      // values point-to-point instead.
+      if (sendTotal > size_t(std::numeric_limits<int>::max())
+          || receiveTotal > size_t(std::numeric_limits<int>::max()))
+      {
+        std::vector<MPI_Request> requests;
+        size_t offset = 0;
+        for (int rank = 0; rank < Size(); offset += receiveCounts[rank], ++rank)
+        {
+          if (receiveCounts[rank] > 0)
+          {
+            requests.push_back(MPI_REQUEST_NULL);
+            HEMELB_MPI_CALL(
+                MPI_Irecv,
+                (&ans[offset], receiveCounts[rank], MpiDataType<T>(), rank, 0, *this, &requests.back())
+            );
+          }
+        }
+        offset = 0;
+        for (int rank = 0; rank < Size(); offset += sendCounts[rank], ++rank)
+        {
+          if (sendCounts[rank] > 0)
+          {
+            requests.push_back(MPI_REQUEST_NULL);
+            HEMELB_MPI_CALL(
+                MPI_Isend,
+                (MpiConstCast(&vals[offset]), sendCounts[rank], MpiDataType<T>(), rank, 0, *this, &requests.back())
+            );
+          }
+        }
+        if (!requests.empty())
+        {
+          HEMELB_MPI_CALL(
+              MPI_Waitall,
+              (int(requests.size()), &requests[0], MPI_STATUSES_IGNORE)
+          );
+        }
+        return ans;
+      }
+
+      std::vector<int> sendDisplacements(Size(), 0), receiveDisplacements(Size(), 0);
+      for (int rank = 1; rank < Size(); ++rank)
+      {
+        sendDisplacements[rank] = sendDisplacements[rank - 1] + sendCounts[rank - 1];
+        receiveDisplacements[rank] = receiveDisplacements[rank - 1] + receiveCounts[rank - 1];
+      }
+
+      HEMELB_MPI_CALL(
+          MPI_Alltoallv,
+          (MpiConstCast(vals.empty() ? NULL : &vals[0]), MpiConstCast(&sendCounts[0]),
+           MpiConstCast(&sendDisplacements[0]), MpiDataType<T>(),
+           ans.empty() ? NULL : &ans[0], MpiConstCast(&receiveCounts[0]),
+           MpiConstCast(&receiveDisplacements[0]), MpiDataType<T>(),
+           *this)
+      );
+      return ans;
+    }
+
     template <typename T>
     void MpiCommunicator::Send(const T& val, int dest, int tag) const
     {
@@ -144,9 +261,10 @@ namespace hemelb
     template <typename T>
     void MpiCommunicator::Send(const std::vector<T>& vals, int dest, int tag) const
     {
+      LargeCount elements(vals.size(), MpiDataType<T>());
       HEMELB_MPI_CALL(
           MPI_Send,
-          (MpiConstCast(&vals[0]), vals.size(), MpiDataType<T>(), dest, tag, *this)
+          (MpiConstCast(&vals[0]), elements.Count(), elements.Type(), dest, tag, *this)
       );
     }
 
@@ -161,9 +279,10 @@ namespace hemelb
     template <typename T>
     void MpiCommunicator::Receive(std::vector<T>& vals, int src, int tag, MPI_Status* stat) const
     {
+      LargeCount elements(vals.size(), MpiDataType<T>());
       HEMELB_MPI_CALL(
           MPI_Recv,
-          (&vals, vals.size(), MpiDataType<T>(), src, tag, *this, stat)
+          (&vals[0], elements.Count(), elements.Type(), src, tag, *this, stat)
       );
     }
   }
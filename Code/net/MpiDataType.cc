@@ -5,6 +5,9 @@
 // license in the file LICENSE.
 
 #include "net/MpiDataType.h"
+#include <limits>
+#include <map>
+#include "net/MpiError.h"
 
 namespace hemelb
 {
@@ -85,5 +88,53 @@ namespace hemelb
     {
       return MPI_WCHAR;
     }
+
+    LargeCount::LargeCount(size_t elements, MPI_Datatype elementType) :
+        count(int(elements)), type(elementType)
+    {
+      if (elements <= size_t(std::numeric_limits<int>::max()))
+      {
+        return;
+      }
+
+      typedef std::map<std::pair<MPI_Datatype, size_t>, MPI_Datatype> ChunkedTypes;
+      static ChunkedTypes chunkedTypes;
+
+      const std::pair<MPI_Datatype, size_t> key(elementType, elements);
+      ChunkedTypes::const_iterator made = chunkedTypes.find(key);
+      if (made == chunkedTypes.end())
+      {
+        made = chunkedTypes.insert(std::make_pair(key, MakeChunkedType(elements, elementType))).first;
+      }
+      count = 1;
+      type = made->second;
+    }
+
+    MPI_Datatype LargeCount::MakeChunkedType(size_t elements, MPI_Datatype elementType)
+    {
+      const size_t chunkElements = std::numeric_limits<int>::max();
+      const size_t chunks = elements / chunkElements;
+      const size_t remainder = elements % chunkElements;
+
+      MPI_Datatype chunk, allChunks;
+      HEMELB_MPI_CALL(MPI_Type_contiguous, (int(chunkElements), elementType, &chunk));
+      HEMELB_MPI_CALL(MPI_Type_contiguous, (int(chunks), chunk, &allChunks));
+      HEMELB_MPI_CALL(MPI_Type_free, (&chunk));
+
+      MPI_Datatype chunked = allChunks;
+      if (remainder > 0)
+      {
+        // The remainder follows straight on from the whole chunks.
+        MPI_Aint lowerBound, extent;
+        HEMELB_MPI_CALL(MPI_Type_get_extent, (elementType, &lowerBound, &extent));
+        int blockLengths[2] = { 1, int(remainder) };
+        MPI_Aint displacements[2] = { 0, MPI_Aint(chunks * chunkElements) * extent };
+        MPI_Datatype types[2] = { allChunks, elementType };
+        HEMELB_MPI_CALL(MPI_Type_create_struct, (2, blockLengths, displacements, types, &chunked));
+        HEMELB_MPI_CALL(MPI_Type_free, (&allChunks));
+      }
+      HEMELB_MPI_CALL(MPI_Type_commit, (&chunked));
+      return chunked;
+    }
   }
 }
@@ -8,6 +8,7 @@
 #define HEMELB_NET_MPIDATATYPE_H
 
 #include <mpi.h>
+#include <cstddef>
 #if HEMELB_HAVE_CSTDINT
 # include <cstdint>
 #else
@@ -160,6 +161,37 @@ namespace hemelb
     template<>
     MPI_Datatype MpiDataTypeTraits<wchar_t>::RegisterMpiDataType();
 
+    /**
+     * The count and datatype to give MPI for any number of elements of a type. Up to an int's
+     * range that's just the number and the type; beyond it, it's one element of a type made of
+     * whole chunks of the elements and the remainder, so messages and file accesses of more than
+     * 2 GiB go in one call rather than overflowing.
+     *
+     * The made types are kept for each type and number of elements, so the same message always
+     * has the same type (as the persistent point-to-point comms rely on), and live as long as MPI.
+     */
+    class LargeCount
+    {
+      public:
+        LargeCount(size_t elements, MPI_Datatype elementType);
+
+        int Count() const
+        {
+          return count;
+        }
+
+        MPI_Datatype Type() const
+        {
+          return type;
+        }
+
+      private:
+        static MPI_Datatype MakeChunkedType(size_t elements, MPI_Datatype elementType);
+
+        int count;
+        MPI_Datatype type;
+    };
+
   }
 }
 #endif // HEMELB_NET_MPIDATATYPE_H
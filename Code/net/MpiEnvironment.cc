@@ -8,6 +8,8 @@
 #include "net/MpiEnvironment.h"
 #include "net/MpiError.h"
 #include "net/MpiCommunicator.h"
+#include "net/ProgressThread.h"
+#include "log/Logger.h"
 
 namespace hemelb
 {
@@ -19,9 +21,39 @@ namespace hemelb
     {
       if (!Initialized())
       {
+#if defined(HEMELB_USE_MPI_PROGRESS_THREAD)
+        // The progress thread polls MPI while the master thread makes its own calls. If the
+        // library can't allow that, the simulation runs without the thread.
+        int provided;
+        HEMELB_MPI_CALL(MPI_Init_thread, (&argc, &argv, MPI_THREAD_MULTIPLE, &provided));
+#elif defined(HEMELB_USE_OPENMP) || defined(HEMELB_USE_ASYNC_RENDERING)
+        // Only the master thread makes MPI calls; the threads are confined to the LB kernels and
+        // the ray tracer.
+        int provided;
+        HEMELB_MPI_CALL(MPI_Init_thread, (&argc, &argv, MPI_THREAD_FUNNELED, &provided));
+        if (provided < MPI_THREAD_FUNNELED)
+        {
+          log::Logger::Init();
+          log::Logger::Log<log::Warning, log::Singleton>("The MPI library only provides thread support level %d, short of the MPI_THREAD_FUNNELED that running threads needs",
+                                                         provided);
+        }
+#else
         HEMELB_MPI_CALL(MPI_Init, (&argc, &argv));
+#endif
         HEMELB_MPI_CALL(MPI_Comm_set_errhandler, (MPI_COMM_WORLD, MPI_ERRORS_RETURN));
         doesOwnMpi = true;
+#ifdef HEMELB_USE_MPI_PROGRESS_THREAD
+        if (provided == MPI_THREAD_MULTIPLE)
+        {
+          ProgressThread::Start();
+        }
+        else
+        {
+          log::Logger::Init();
+          log::Logger::Log<log::Warning, log::Singleton>("The MPI library only provides thread support level %d, short of the MPI_THREAD_MULTIPLE that the MPI progress thread needs, so running without it",
+                                                         provided);
+        }
+#endif
       }
     }
 
@@ -29,6 +61,7 @@ namespace hemelb
     {
       if (doesOwnMpi)
       {
+        ProgressThread::Stop();
         HEMELB_MPI_CALL(MPI_Finalize, ());
       }
     }
@@ -4,9 +4,12 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <fstream>
+#include <sstream>
 #include "net/MpiFile.h"
 #include "net/MpiCommunicator.h"
 #include "net/MpiConstness.h"
+#include "Exception.h"
 
 namespace hemelb
 {
@@ -20,6 +23,8 @@ namespace hemelb
         delete fh;
       }
     }
+    unsigned long long MpiFile::bytesWritten = 0;
+
     MpiFile::MpiFile() : comm(NULL)
     {
 
@@ -42,6 +47,22 @@ namespace hemelb
       return MpiFile(comm, ans);
     }
 
+    MpiFile MpiFile::Open(const MpiCommunicator& comm, const std::string& filename, int mode,
+                          const std::map<std::string, std::string>& hints)
+    {
+      MPI_Info info;
+      HEMELB_MPI_CALL(MPI_Info_create, (&info));
+      for (std::map<std::string, std::string>::const_iterator hint = hints.begin(); hint != hints.end();
+          ++hint)
+      {
+        HEMELB_MPI_CALL(MPI_Info_set,
+                        (info, MpiConstCast(hint->first.c_str()), MpiConstCast(hint->second.c_str())));
+      }
+      MpiFile file = Open(comm, filename, mode, info);
+      HEMELB_MPI_CALL(MPI_Info_free, (&info));
+      return file;
+    }
+
 
     void MpiFile::Close()
     {
@@ -68,6 +89,44 @@ namespace hemelb
           (*filePtr, disp, etype, filetype, MpiConstCast(datarep.c_str()), info)
       );
     }
+
+    unsigned long long MpiFile::GetBytesWritten()
+    {
+      return bytesWritten;
+    }
+
+    std::string MpiFile::ReadOnOneRank(const MpiCommunicator& comm, const std::string& filename,
+                                       int root)
+    {
+      std::string contents;
+      // The length, or -1 if the file couldn't be read, so that every process throws.
+      int64_t length = -1;
+      if (comm.Rank() == root)
+      {
+        std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+        if (file)
+        {
+          std::ostringstream buffer;
+          buffer << file.rdbuf();
+          contents = buffer.str();
+          length = file.bad() ?
+            -1 :
+            int64_t(contents.size());
+        }
+      }
+      comm.Broadcast(length, root);
+      if (length < 0)
+      {
+        throw Exception() << "Could not read " << filename;
+      }
+
+      std::vector<char> bytes(contents.begin(), contents.end());
+      bytes.resize(length);
+      if (length > 0)
+      {
+        comm.Broadcast(bytes, root);
+      }
+      return std::string(bytes.begin(), bytes.end());
+    }
   }
 }
-
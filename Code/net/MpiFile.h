@@ -7,6 +7,8 @@
 #ifndef HEMELB_NET_MPIFILE_H
 #define HEMELB_NET_MPIFILE_H
 
+#include <map>
+#include <string>
 #include <boost/shared_ptr.hpp>
 #include "net/MpiError.h"
 #include "net/MpiCommunicator.h"
@@ -31,6 +33,19 @@ namespace hemelb
         static MpiFile Open(const MpiCommunicator& comm, const std::string& filename, int mode,
                             const MPI_Info info = MPI_INFO_NULL);
 
+        /**
+         * Opens a file with MPI_File_open, passing the given hints to the MPI-IO layer (e.g.
+         * ROMIO's cb_nodes or Lustre's striping_factor). MPI ignores any it doesn't understand.
+         * A collective operation on comm.
+         * @param comm
+         * @param filename
+         * @param mode
+         * @param hints Hint values by key
+         * @return
+         */
+        static MpiFile Open(const MpiCommunicator& comm, const std::string& filename, int mode,
+                            const std::map<std::string, std::string>& hints);
+
         /**
          * Closes the file with MPI_File_close.
          * Note this is a collective operation.
@@ -51,16 +66,54 @@ namespace hemelb
         void Read(std::vector<T>& buffer, MPI_Status* stat = MPI_STATUS_IGNORE);
         template<typename T>
         void ReadAt(MPI_Offset offset, std::vector<T>& buffer, MPI_Status* stat = MPI_STATUS_IGNORE);
+        /**
+         * Collective version of ReadAt, which all processes with the file open must call. A
+         * process with nothing to read passes an empty buffer.
+         */
+        template<typename T>
+        void ReadAtAll(MPI_Offset offset, std::vector<T>& buffer, MPI_Status* stat = MPI_STATUS_IGNORE);
 
         template<typename T>
         void Write(const std::vector<T>& buffer, MPI_Status* stat = MPI_STATUS_IGNORE);
         template<typename T>
         void WriteAt(MPI_Offset offset, const std::vector<T>& buffer, MPI_Status* stat = MPI_STATUS_IGNORE);
+        /**
+         * Collective version of WriteAt, which all processes with the file open must call. A
+         * process with nothing to write passes an empty buffer.
+         */
+        template<typename T>
+        void WriteAtAll(MPI_Offset offset, const std::vector<T>& buffer, MPI_Status* stat = MPI_STATUS_IGNORE);
+        /**
+         * Nonblocking version of WriteAtAll (MPI_File_iwrite_at_all, from MPI 3.1). The buffer
+         * mustn't change until the request is complete.
+         */
+        template<typename T>
+        void IWriteAtAll(MPI_Offset offset, const std::vector<T>& buffer, MPI_Request* request);
+
+        /**
+         * The bytes this process has asked to write to any MpiFile so far.
+         * @return
+         */
+        static unsigned long long GetBytesWritten();
+
+        /**
+         * Read a whole small input file, such as the configuration or an iolet's table, on one
+         * process and broadcast it to the others, so only that one touches the file system. A
+         * collective operation on comm. Throws an Exception on every process if the file can't
+         * be read.
+         * @param comm
+         * @param filename
+         * @param root The process to read on.
+         * @return The file's contents.
+         */
+        static std::string ReadOnOneRank(const MpiCommunicator& comm, const std::string& filename,
+                                         int root = 0);
       protected:
         MpiFile(const MpiCommunicator& parentComm, MPI_File fh);
 
         const MpiCommunicator* comm;
         boost::shared_ptr<MPI_File> filePtr;
+        static unsigned long long bytesWritten;
     };
 
   }
@@ -8,6 +8,7 @@
 #define HEMELB_NET_MPIFILE_HPP
 
 #include "net/MpiFile.h"
+#include "net/MpiDataType.h"
 
 namespace hemelb
 {
@@ -17,37 +18,72 @@ namespace hemelb
     template<typename T>
     void MpiFile::Read(std::vector<T>& buffer, MPI_Status* stat)
     {
+      LargeCount elements(buffer.size(), MpiDataType<T>());
       HEMELB_MPI_CALL(
           MPI_File_read,
-          (*filePtr, &buffer[0], buffer.size(), MpiDataType<T>(), stat)
+          (*filePtr, &buffer[0], elements.Count(), elements.Type(), stat)
       );
     }
     template<typename T>
     void MpiFile::ReadAt(MPI_Offset offset, std::vector<T>& buffer, MPI_Status* stat)
     {
+      LargeCount elements(buffer.size(), MpiDataType<T>());
       HEMELB_MPI_CALL(
           MPI_File_read_at,
-          (*filePtr, offset, &buffer[0], buffer.size(), MpiDataType<T>(), stat)
+          (*filePtr, offset, &buffer[0], elements.Count(), elements.Type(), stat)
+      );
+    }
+    template<typename T>
+    void MpiFile::ReadAtAll(MPI_Offset offset, std::vector<T>& buffer, MPI_Status* stat)
+    {
+      LargeCount elements(buffer.size(), MpiDataType<T>());
+      HEMELB_MPI_CALL(
+          MPI_File_read_at_all,
+          (*filePtr, offset, buffer.empty() ? NULL : &buffer[0], elements.Count(), elements.Type(), stat)
       );
     }
 
     template<typename T>
     void MpiFile::Write(const std::vector<T>& buffer, MPI_Status* stat)
     {
+      bytesWritten += buffer.size() * sizeof(T);
+      LargeCount elements(buffer.size(), MpiDataType<T>());
       HEMELB_MPI_CALL(
           MPI_File_write,
-          (*filePtr, MpiConstCast(&buffer[0]), buffer.size(), MpiDataType<T>(), stat)
+          (*filePtr, MpiConstCast(&buffer[0]), elements.Count(), elements.Type(), stat)
       );
     }
     template<typename T>
     void MpiFile::WriteAt(MPI_Offset offset, const std::vector<T>& buffer, MPI_Status* stat)
     {
+      bytesWritten += buffer.size() * sizeof(T);
+      LargeCount elements(buffer.size(), MpiDataType<T>());
       HEMELB_MPI_CALL(
           MPI_File_write_at,
-          (*filePtr, offset, MpiConstCast(&buffer[0]), buffer.size(), MpiDataType<T>(), stat)
+          (*filePtr, offset, MpiConstCast(&buffer[0]), elements.Count(), elements.Type(), stat)
       );
 
     }
+    template<typename T>
+    void MpiFile::WriteAtAll(MPI_Offset offset, const std::vector<T>& buffer, MPI_Status* stat)
+    {
+      bytesWritten += buffer.size() * sizeof(T);
+      LargeCount elements(buffer.size(), MpiDataType<T>());
+      HEMELB_MPI_CALL(
+          MPI_File_write_at_all,
+          (*filePtr, offset, buffer.empty() ? NULL : MpiConstCast(&buffer[0]), elements.Count(), elements.Type(), stat)
+      );
+    }
+    template<typename T>
+    void MpiFile::IWriteAtAll(MPI_Offset offset, const std::vector<T>& buffer, MPI_Request* request)
+    {
+      bytesWritten += buffer.size() * sizeof(T);
+      LargeCount elements(buffer.size(), MpiDataType<T>());
+      HEMELB_MPI_CALL(
+          MPI_File_iwrite_at_all,
+          (*filePtr, offset, buffer.empty() ? NULL : MpiConstCast(&buffer[0]), elements.Count(), elements.Type(), request)
+      );
+    }
 
   }
 }
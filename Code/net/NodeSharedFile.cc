@@ -0,0 +1,110 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+#include <vector>
+#include "net/NodeSharedFile.h"
+#include "net/MpiFile.h"
+#include "log/Logger.h"
+
+namespace hemelb
+{
+  namespace net
+  {
+    const MPI_Offset NodeSharedFile::BYTES_PER_TRANSFER;
+
+    NodeSharedFile::NodeSharedFile(const MpiCommunicator& comms, const std::string& path) :
+        nodeComms(comms.SplitShared()), window(MPI_WIN_NULL), data(NULL), size(0)
+    {
+      const bool leader = nodeComms.Rank() == 0;
+      const MpiCommunicator leaderComms = comms.Split(leader ?
+                                                        0 :
+                                                        MPI_UNDEFINED,
+                                                      comms.Rank());
+      int64_t fileSize = 0;
+      if (leader)
+      {
+        MpiFile file = MpiFile::Open(leaderComms, path, MPI_MODE_RDONLY);
+        HEMELB_MPI_CALL(MPI_File_get_size, (file, &size));
+        file.Close();
+        fileSize = size;
+      }
+      nodeComms.Broadcast(fileSize, 0);
+      size = fileSize;
+
+      // The leader allocates all of the memory, and the others find where it is.
+      HEMELB_MPI_CALL(MPI_Win_allocate_shared,
+                      (leader ? MPI_Aint(size) : 0, 1, MPI_INFO_NULL, nodeComms, &data, &window));
+      if (!leader)
+      {
+        MPI_Aint leaderSize;
+        int displacementUnit;
+        HEMELB_MPI_CALL(MPI_Win_shared_query, (window, 0, &leaderSize, &displacementUnit, &data));
+      }
+      HEMELB_MPI_CALL(MPI_Win_lock_all, (MPI_MODE_NOCHECK, window));
+
+      if (leader)
+      {
+        ReadOnLeaders(leaderComms, path);
+      }
+
+      // Make the leader's writes visible to the rest of the node.
+      HEMELB_MPI_CALL(MPI_Win_sync, (window));
+      HEMELB_MPI_CALL(MPI_Barrier, (nodeComms));
+      HEMELB_MPI_CALL(MPI_Win_sync, (window));
+    }
+
+    NodeSharedFile::~NodeSharedFile()
+    {
+      // Not HEMELB_MPI_CALL, which would throw out of the destructor.
+      const int unlocked = MPI_Win_unlock_all(window);
+      const int freed = MPI_Win_free(&window);
+      if (unlocked != MPI_SUCCESS || freed != MPI_SUCCESS)
+      {
+        log::Logger::Log<log::Warning, log::OnePerCore>("Couldn't free the node-shared file's window (MPI errors %d, %d)",
+                                                         unlocked,
+                                                         freed);
+      }
+    }
+
+    void NodeSharedFile::ReadOnLeaders(const MpiCommunicator& leaderComms, const std::string& path)
+    {
+      const int leaderCount = leaderComms.Size();
+      std::vector<MPI_Offset> sliceStarts(leaderCount + 1);
+      MPI_Offset longestSlice = 0;
+      for (int slice = 0; slice <= leaderCount; ++slice)
+      {
+        sliceStarts[slice] = size * slice / leaderCount;
+        if (slice > 0)
+        {
+          longestSlice = std::max(longestSlice, sliceStarts[slice] - sliceStarts[slice - 1]);
+        }
+      }
+
+      // Every leader makes as many collective reads as the one with the longest slice.
+      MpiFile file = MpiFile::Open(leaderComms, path, MPI_MODE_RDONLY);
+      const int self = leaderComms.Rank();
+      for (MPI_Offset done = 0; done < longestSlice; done += BYTES_PER_TRANSFER)
+      {
+        const MPI_Offset start = std::min(sliceStarts[self] + done, sliceStarts[self + 1]);
+        const MPI_Offset end = std::min(start + BYTES_PER_TRANSFER, sliceStarts[self + 1]);
+        HEMELB_MPI_CALL(MPI_File_read_at_all,
+                        (file, start, data + start, int(end - start), MPI_CHAR, MPI_STATUS_IGNORE));
+      }
+      file.Close();
+
+      for (int slice = 0; slice < leaderCount; ++slice)
+      {
+        for (MPI_Offset start = sliceStarts[slice]; start < sliceStarts[slice + 1];
+            start += BYTES_PER_TRANSFER)
+        {
+          const MPI_Offset end = std::min(start + BYTES_PER_TRANSFER, sliceStarts[slice + 1]);
+          HEMELB_MPI_CALL(MPI_Bcast,
+                          (data + start, int(end - start), MPI_CHAR, slice, leaderComms));
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,71 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_NET_NODESHAREDFILE_H
+#define HEMELB_NET_NODESHAREDFILE_H
+
+#include <string>
+#include "net/MpiCommunicator.h"
+
+namespace hemelb
+{
+  namespace net
+  {
+    /**
+     * A whole file read into memory that all the cores on a node share (see
+     * MPI_WIN_ALLOCATE_SHARED), so that only one core per node is a client of the file system.
+     *
+     * The lowest ranked core on each node opens the file, and those cores each read an equal
+     * slice of it with one collective read, then broadcast their slices to each other. The other
+     * cores on the node never touch the file. Making and destroying one is collective.
+     */
+    class NodeSharedFile
+    {
+      public:
+        /**
+         * Read the file. Collective over the communicator.
+         * @param comms
+         * @param path
+         */
+        NodeSharedFile(const MpiCommunicator& comms, const std::string& path);
+
+        /**
+         * Free the shared memory. Collective.
+         */
+        ~NodeSharedFile();
+
+        const char* GetData() const
+        {
+          return data;
+        }
+
+        MPI_Offset GetSize() const
+        {
+          return size;
+        }
+
+      private:
+        NodeSharedFile(const NodeSharedFile&);
+        NodeSharedFile& operator=(const NodeSharedFile&);
+
+        //! The most bytes to read or broadcast at once, to keep the counts within an int.
+        static const MPI_Offset BYTES_PER_TRANSFER = 1 << 30;
+
+        /**
+         * Read the file on the lowest ranked core of each node, into the shared memory.
+         * @param leaderComms The lowest ranked core of each node.
+         * @param path
+         */
+        void ReadOnLeaders(const MpiCommunicator& leaderComms, const std::string& path);
+
+        MpiCommunicator nodeComms;
+        MPI_Win window;
+        char* data;
+        MPI_Offset size;
+    };
+  }
+}
+
+#endif /* HEMELB_NET_NODESHAREDFILE_H */
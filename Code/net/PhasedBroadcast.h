@@ -56,7 +56,8 @@ namespace hemelb
      *
      * This class is made general using template parameters:
      *
-     * initialAction = if true, an extra iteration occurs at the start of each broadcast cycle
+     * initialAction = if true, extra iterations (one unless the constructor is told otherwise)
+     *   occur at the start of each broadcast cycle
      * splay = the number of consecutive iterations communication between a pair of nodes needs to
      *   go on for. Useful if the passed data is an array of variable length; one node can spend an
      *   iteration telling the other how many elements will be passed then the next iteration
@@ -72,8 +73,10 @@ namespace hemelb
       public:
         PhasedBroadcast(Net * iNet,
                         const lb::SimulationState * iSimState,
-                        unsigned int spreadFactor) :
-                          mSimState(iSimState), mMyDepth(0), mTreeDepth(0), mNet(iNet)
+                        unsigned int spreadFactor,
+                        unsigned long initialActionLength = 1) :
+                          mSimState(iSimState), mMyDepth(0), mTreeDepth(0),
+                              mInitialActionLength(initialActionLength), mNet(iNet)
         {
           // Calculate the correct values for the depth variables.
           proc_t noSeenToThisDepth = 1;
@@ -210,7 +213,7 @@ namespace hemelb
         unsigned long GetRoundTripLength() const
         {
           unsigned long delayTime = initialAction
-            ? 1
+            ? mInitialActionLength
             : 0;
 
           unsigned long multiplier = (down
@@ -230,7 +233,7 @@ namespace hemelb
         unsigned long GetFirstDescending() const
         {
           return (initialAction
-            ? 1
+            ? mInitialActionLength
             : 0);
         }
 
@@ -390,6 +393,11 @@ namespace hemelb
         unsigned int mMyDepth;
         unsigned int mTreeDepth;
 
+        /**
+         * The number of iterations given to the initial action before communication begins.
+         */
+        unsigned long mInitialActionLength;
+
         /**
          * This node's parent rank.
          */
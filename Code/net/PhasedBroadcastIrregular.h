@@ -34,12 +34,15 @@ namespace hemelb
          * @param iNet
          * @param iSimState
          * @param spreadFactor
+         * @param initialActionLength The number of iterations from the initial action to the
+         *     start of communication.
          * @return
          */
         PhasedBroadcastIrregular(Net * iNet,
                                  const lb::SimulationState * iSimState,
-                                 unsigned int spreadFactor) :
-          base(iNet, iSimState, spreadFactor)
+                                 unsigned int spreadFactor,
+                                 unsigned long initialActionLength = 1) :
+          base(iNet, iSimState, spreadFactor, initialActionLength)
         {
           performInstantBroadcast = false;
         }
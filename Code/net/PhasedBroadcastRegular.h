@@ -27,10 +27,13 @@ namespace hemelb
          * @param iNet
          * @param iSimState
          * @param spreadFactor
+         * @param callPeriod The number of time steps between calls, if the StepManager only calls
+         * this on every callPeriod-th step. The broadcast moves on by one iteration per call.
          * @return
          */
-        PhasedBroadcastRegular(Net * iNet, const lb::SimulationState * iSimState, unsigned int spreadFactor) :
-            base(iNet, iSimState, spreadFactor)
+        PhasedBroadcastRegular(Net * iNet, const lb::SimulationState * iSimState, unsigned int spreadFactor,
+                               unsigned long callPeriod = 1) :
+            base(iNet, iSimState, spreadFactor), callPeriod(callPeriod)
         {
 
         }
@@ -176,7 +179,7 @@ namespace hemelb
         {
           if (base::GetTreeDepth() > 0)
           {
-            unsigned long stepsPassed = base::mSimState->Get0IndexedTimeStep();
+            unsigned long stepsPassed = base::mSimState->Get0IndexedTimeStep() / callPeriod;
 
             return stepsPassed % base::GetRoundTripLength();
           }
@@ -286,6 +289,12 @@ namespace hemelb
         {
 
         }
+
+      private:
+        /**
+         * The number of time steps between calls.
+         */
+        unsigned long callPeriod;
     };
   }
 }
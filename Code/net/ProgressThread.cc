@@ -0,0 +1,147 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <cstring>
+#include "net/ProgressThread.h"
+#include "net/mpi.h"
+#include "Exception.h"
+
+#ifdef HEMELB_USE_MPI_PROGRESS_THREAD
+#include <atomic>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace hemelb
+{
+  namespace net
+  {
+#ifdef HEMELB_USE_MPI_PROGRESS_THREAD
+    namespace
+    {
+      pthread_t thread;
+      pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+      pthread_cond_t commsStarted = PTHREAD_COND_INITIALIZER;
+      //! The thread's own communicator, so its probes can't match the nets' messages.
+      MPI_Comm progressComm = MPI_COMM_NULL;
+      bool running = false;
+      std::atomic<bool> stopping(false);
+      //! The number of nets between their Send or Receive and their Wait.
+      std::atomic<int> outstanding(0);
+      //! Only written by the thread.
+      std::atomic<double> drivingTime(0.0);
+
+      void* DriveProgress(void*)
+      {
+        while (true)
+        {
+          pthread_mutex_lock(&mutex);
+          while (outstanding.load() == 0 && !stopping.load())
+          {
+            pthread_cond_wait(&commsStarted, &mutex);
+          }
+          pthread_mutex_unlock(&mutex);
+          if (stopping.load())
+          {
+            return NULL;
+          }
+
+          const double start = MPI_Wtime();
+          while (outstanding.load() > 0 && !stopping.load())
+          {
+            int flag;
+            MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, progressComm, &flag, MPI_STATUS_IGNORE);
+            sched_yield();
+          }
+          drivingTime.store(drivingTime.load() + MPI_Wtime() - start);
+        }
+      }
+    }
+
+    void ProgressThread::Start()
+    {
+      if (running)
+      {
+        return;
+      }
+      MPI_Comm_dup(MPI_COMM_WORLD, &progressComm);
+      stopping.store(false);
+      const int error = pthread_create(&thread, NULL, &DriveProgress, NULL);
+      if (error != 0)
+      {
+        MPI_Comm_free(&progressComm);
+        throw Exception() << "Could not start the MPI progress thread: " << std::strerror(error);
+      }
+      running = true;
+    }
+
+    void ProgressThread::Stop()
+    {
+      if (!running)
+      {
+        return;
+      }
+      pthread_mutex_lock(&mutex);
+      stopping.store(true);
+      pthread_cond_signal(&commsStarted);
+      pthread_mutex_unlock(&mutex);
+      pthread_join(thread, NULL);
+      MPI_Comm_free(&progressComm);
+      running = false;
+    }
+
+    bool ProgressThread::IsRunning()
+    {
+      return running;
+    }
+
+    void ProgressThread::CommsStarted()
+    {
+      if (outstanding.fetch_add(1) == 0 && running)
+      {
+        pthread_mutex_lock(&mutex);
+        pthread_cond_signal(&commsStarted);
+        pthread_mutex_unlock(&mutex);
+      }
+    }
+
+    void ProgressThread::CommsFinished()
+    {
+      outstanding.fetch_sub(1);
+    }
+
+    double ProgressThread::GetDrivingTime()
+    {
+      return drivingTime.load();
+    }
+#else
+    void ProgressThread::Start()
+    {
+    }
+
+    void ProgressThread::Stop()
+    {
+    }
+
+    bool ProgressThread::IsRunning()
+    {
+      return false;
+    }
+
+    void ProgressThread::CommsStarted()
+    {
+    }
+
+    void ProgressThread::CommsFinished()
+    {
+    }
+
+    double ProgressThread::GetDrivingTime()
+    {
+      return 0.0;
+    }
+#endif
+  }
+}
@@ -0,0 +1,63 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_NET_PROGRESSTHREAD_H
+#define HEMELB_NET_PROGRESSTHREAD_H
+
+namespace hemelb
+{
+  namespace net
+  {
+    /**
+     * A background thread that keeps MPI progressing the comms of the nets while the master
+     * thread computes, for MPI implementations that only move messages on inside MPI calls.
+     *
+     * The thread sleeps until some net has comms outstanding, i.e. between its Send or Receive
+     * and its Wait, and then polls MPI with MPI_Iprobe on a communicator of its own until they
+     * have all been waited for. It never touches the nets' requests, so the master thread is
+     * free to carry on with them, but it does need MPI_THREAD_MULTIPLE. The time it spends
+     * polling is kept, so it can be compared with the time spent waiting.
+     *
+     * Only compiled in with HEMELB_USE_MPI_PROGRESS_THREAD, when the MpiEnvironment starts and
+     * stops it; otherwise everything here does nothing.
+     */
+    class ProgressThread
+    {
+      public:
+        /**
+         * Start the thread. Collective over MPI_COMM_WORLD, and only to be called once MPI has
+         * been initialised with MPI_THREAD_MULTIPLE.
+         */
+        static void Start();
+
+        /**
+         * Stop the thread and wait for it to finish. Collective over MPI_COMM_WORLD.
+         */
+        static void Stop();
+
+        /**
+         * @return Whether the thread is running.
+         */
+        static bool IsRunning();
+
+        /**
+         * Note that a net has started comms, waking the thread if none were outstanding.
+         */
+        static void CommsStarted();
+
+        /**
+         * Note that a net has waited for the comms it started.
+         */
+        static void CommsFinished();
+
+        /**
+         * @return The time the thread has spent polling MPI, in seconds.
+         */
+        static double GetDrivingTime();
+    };
+  }
+}
+
+#endif // HEMELB_NET_PROGRESSTHREAD_H
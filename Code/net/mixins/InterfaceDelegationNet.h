@@ -126,15 +126,29 @@ namespace hemelb
         }
 
         template<class T>
-        void RequestSend(T* pointer, int count, proc_t rank)
+        void RequestSend(T* pointer, size_t count, proc_t rank)
         {
-          RequestSendImpl(pointer, count, rank, MpiDataType<T>());
+          LargeCount elements(count, MpiDataType<T>());
+          RequestSendImpl(pointer, elements.Count(), rank, elements.Type());
         }
 
         template<class T>
-        void RequestReceive(T* pointer, int count, proc_t rank)
+        void RequestReceive(T* pointer, size_t count, proc_t rank)
         {
-          RequestReceiveImpl(pointer, count, rank, MpiDataType<T>());
+          LargeCount elements(count, MpiDataType<T>());
+          RequestReceiveImpl(pointer, elements.Count(), rank, elements.Type());
+        }
+
+        /***
+         * Receive a single element of a derived datatype, e.g. one that scatters the message
+         * straight to where it belongs. The type must stay committed until the comms are done.
+         * @param pointer
+         * @param type
+         * @param rank
+         */
+        void RequestReceiveDerived(void* pointer, MPI_Datatype type, proc_t rank)
+        {
+          RequestReceiveImpl(pointer, 1, rank, type);
         }
 
         /*
@@ -18,6 +18,7 @@ namespace hemelb
       if (count > 0)
       {
         sendProcessorComms[rank].push_back(SimpleRequest(pointer, count, type, rank));
+        RecordSend(count, rank, type);
       }
     }
 
@@ -26,6 +27,7 @@ namespace hemelb
       if (count > 0)
       {
         receiveProcessorComms[rank].push_back(SimpleRequest(pointer, count, type, rank));
+        RecordReceive(count, rank, type);
       }
     }
 
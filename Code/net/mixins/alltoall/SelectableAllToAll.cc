@@ -0,0 +1,53 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "net/mixins/alltoall/SelectableAllToAll.h"
+namespace hemelb
+{
+  namespace net
+  {
+    SelectableAllToAll::SelectableAllToAll(const MpiCommunicator& comms) :
+        BaseNet(comms), StoringNet(comms), SeparatedAllToAll(comms), ViaPointPointAllToAll(comms),
+            allToAllStrategy(CommsStrategy::GetDefault().allToAll)
+    {
+    }
+
+    void SelectableAllToAll::ReceiveAllToAll()
+    {
+      if (allToAllStrategy == CommsStrategy::CollectiveViaPointPoint)
+      {
+        ViaPointPointAllToAll::ReceiveAllToAll();
+      }
+      else
+      {
+        SeparatedAllToAll::ReceiveAllToAll();
+      }
+    }
+
+    void SelectableAllToAll::SendAllToAll()
+    {
+      if (allToAllStrategy == CommsStrategy::CollectiveViaPointPoint)
+      {
+        ViaPointPointAllToAll::SendAllToAll();
+      }
+      else
+      {
+        SeparatedAllToAll::SendAllToAll();
+      }
+    }
+
+    void SelectableAllToAll::WaitAllToAll()
+    {
+      if (allToAllStrategy == CommsStrategy::CollectiveViaPointPoint)
+      {
+        ViaPointPointAllToAll::WaitAllToAll();
+      }
+      else
+      {
+        SeparatedAllToAll::WaitAllToAll();
+      }
+    }
+  }
+}
@@ -0,0 +1,45 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_NET_MIXINS_ALLTOALL_SELECTABLEALLTOALL_H
+#define HEMELB_NET_MIXINS_ALLTOALL_SELECTABLEALLTOALL_H
+
+#include "net/CommsStrategy.h"
+#include "net/mixins/alltoall/SeparatedAllToAll.h"
+#include "net/mixins/alltoall/ViaPointPointAllToAll.h"
+
+namespace hemelb{
+  namespace net{
+    /***
+     * All-to-alls by MPI collectives or via point-point calls, as chosen at run time.
+     */
+    class SelectableAllToAll : public SeparatedAllToAll, public ViaPointPointAllToAll
+    {
+    public:
+      /***
+       * Starts with the all-to-alls of the default comms strategy.
+       */
+      SelectableAllToAll(const MpiCommunicator& comms);
+      /***
+       * Change the implementation, between Dispatches.
+       */
+      void SetAllToAllStrategy(CommsStrategy::Collective strategy)
+      {
+        allToAllStrategy = strategy;
+      }
+      CommsStrategy::Collective GetAllToAllStrategy() const
+      {
+        return allToAllStrategy;
+      }
+    protected:
+      void ReceiveAllToAll();
+      void SendAllToAll();
+      void WaitAllToAll();
+    private:
+      CommsStrategy::Collective allToAllStrategy;
+    };
+  }
+}
+#endif
@@ -16,7 +16,7 @@ namespace hemelb{
     {
     public:
       ViaPointPointAllToAll(const MpiCommunicator& comms);
-    private:
+    protected:
       void ReceiveAllToAll();
       void SendAllToAll();
       void WaitAllToAll(){}
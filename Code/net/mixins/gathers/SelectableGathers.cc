@@ -0,0 +1,89 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "net/mixins/gathers/SelectableGathers.h"
+namespace hemelb
+{
+  namespace net
+  {
+    SelectableGathers::SelectableGathers(const MpiCommunicator& comms) :
+        BaseNet(comms), StoringNet(comms), SeparatedGathers(comms), ViaPointPointGathers(comms),
+            gathersStrategy(CommsStrategy::GetDefault().gathers)
+    {
+    }
+
+    void SelectableGathers::ReceiveGathers()
+    {
+      if (gathersStrategy == CommsStrategy::CollectiveViaPointPoint)
+      {
+        ViaPointPointGathers::ReceiveGathers();
+      }
+      else
+      {
+        SeparatedGathers::ReceiveGathers();
+      }
+    }
+
+    void SelectableGathers::SendGathers()
+    {
+      if (gathersStrategy == CommsStrategy::CollectiveViaPointPoint)
+      {
+        ViaPointPointGathers::SendGathers();
+      }
+      else
+      {
+        SeparatedGathers::SendGathers();
+      }
+    }
+
+    void SelectableGathers::ReceiveGatherVs()
+    {
+      if (gathersStrategy == CommsStrategy::CollectiveViaPointPoint)
+      {
+        ViaPointPointGathers::ReceiveGatherVs();
+      }
+      else
+      {
+        SeparatedGathers::ReceiveGatherVs();
+      }
+    }
+
+    void SelectableGathers::SendGatherVs()
+    {
+      if (gathersStrategy == CommsStrategy::CollectiveViaPointPoint)
+      {
+        ViaPointPointGathers::SendGatherVs();
+      }
+      else
+      {
+        SeparatedGathers::SendGatherVs();
+      }
+    }
+
+    void SelectableGathers::WaitGathers()
+    {
+      if (gathersStrategy == CommsStrategy::CollectiveViaPointPoint)
+      {
+        ViaPointPointGathers::WaitGathers();
+      }
+      else
+      {
+        SeparatedGathers::WaitGathers();
+      }
+    }
+
+    void SelectableGathers::WaitGatherVs()
+    {
+      if (gathersStrategy == CommsStrategy::CollectiveViaPointPoint)
+      {
+        ViaPointPointGathers::WaitGatherVs();
+      }
+      else
+      {
+        SeparatedGathers::WaitGatherVs();
+      }
+    }
+  }
+}
@@ -0,0 +1,48 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_NET_MIXINS_GATHERS_SELECTABLEGATHERS_H
+#define HEMELB_NET_MIXINS_GATHERS_SELECTABLEGATHERS_H
+
+#include "net/CommsStrategy.h"
+#include "net/mixins/gathers/SeparatedGathers.h"
+#include "net/mixins/gathers/ViaPointPointGathers.h"
+
+namespace hemelb{
+  namespace net{
+    /***
+     * Gathers by MPI collectives or via point-point calls, as chosen at run time.
+     */
+    class SelectableGathers : public SeparatedGathers, public ViaPointPointGathers
+    {
+    public:
+      /***
+       * Starts with the gathers of the default comms strategy.
+       */
+      SelectableGathers(const MpiCommunicator& comms);
+      /***
+       * Change the implementation, between Dispatches.
+       */
+      void SetGathersStrategy(CommsStrategy::Collective strategy)
+      {
+        gathersStrategy = strategy;
+      }
+      CommsStrategy::Collective GetGathersStrategy() const
+      {
+        return gathersStrategy;
+      }
+    protected:
+      void ReceiveGathers();
+      void SendGathers();
+      void ReceiveGatherVs();
+      void SendGatherVs();
+      void WaitGathers();
+      void WaitGatherVs();
+    private:
+      CommsStrategy::Collective gathersStrategy;
+    };
+  }
+}
+#endif
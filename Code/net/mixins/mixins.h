@@ -9,11 +9,16 @@
 
 #include "net/mixins/pointpoint/CoalescePointPoint.h"
 #include "net/mixins/pointpoint/ImmediatePointPoint.h"
+#include "net/mixins/pointpoint/PersistentPointPoint.h"
+#include "net/mixins/pointpoint/RmaPointPoint.h"
 #include "net/mixins/pointpoint/SeparatedPointPoint.h"
+#include "net/mixins/pointpoint/SelectablePointPoint.h"
 #include "net/mixins/StoringNet.h"
 #include "net/mixins/gathers/SeparatedGathers.h"
 #include "net/mixins/InterfaceDelegationNet.h"
 #include "net/mixins/gathers/ViaPointPointGathers.h"
+#include "net/mixins/gathers/SelectableGathers.h"
 #include "net/mixins/alltoall/SeparatedAllToAll.h"
 #include "net/mixins/alltoall/ViaPointPointAllToAll.h"
+#include "net/mixins/alltoall/SelectableAllToAll.h"
 #endif
@@ -16,7 +16,7 @@ namespace hemelb
     {
       if (requests.size() < count)
       {
-        requests.resize(count, MPI_Request());
+        requests.resize(count, MPI_REQUEST_NULL);
         statuses.resize(count, MPI_Status());
       }
     }
@@ -83,8 +83,8 @@ namespace hemelb
       for (std::map<proc_t, ProcComms>::iterator it = sendProcessorComms.begin(); it != sendProcessorComms.end(); ++it)
       {
 
-        int TypeSizeStorage = 0; //DTMP:byte size tracking
-        MPI_Type_size(it->second.Type, &TypeSizeStorage); //DTMP:
+        MPI_Count TypeSizeStorage = 0; //DTMP:byte size tracking
+        MPI_Type_size_x(it->second.Type, &TypeSizeStorage); //DTMP:
         BytesSent += TypeSizeStorage; //DTMP:
 
         MPI_Isend(it->second.front().Pointer,
@@ -99,6 +99,20 @@ namespace hemelb
       }
     }
 
+    void CoalescePointPoint::ProgressPointToPoint()
+    {
+      // Requests not yet started are null, and MPI_Testall leaves them all alone unless they
+      // have all finished.
+      if (sendReceivePrepped)
+      {
+        int done;
+        MPI_Testall((int) (sendProcessorComms.size() + receiveProcessorComms.size()),
+                    &requests[0],
+                    &done,
+                    MPI_STATUSES_IGNORE);
+      }
+    }
+
     /*!
      Free the allocated data.
      */
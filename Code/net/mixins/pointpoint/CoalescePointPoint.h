@@ -12,6 +12,13 @@ namespace hemelb
 {
   namespace net
   {
+    /**
+     * Point to point comms with one message each way to each neighbour per Dispatch. All the
+     * requests for a neighbour, from whichever concern of the step manager made them, are
+     * combined into one MPI struct datatype over their buffers, so nothing is copied. Concerns
+     * registered in the same phase of the step manager, sharing a net, therefore share their
+     * messages.
+     */
     class CoalescePointPoint : public virtual StoringNet
     {
 
@@ -27,6 +34,7 @@ namespace hemelb
       protected:
         void ReceivePointToPoint();
         void SendPointToPoint();
+        void ProgressPointToPoint();
 
       private:
         void EnsureEnoughRequests(size_t count);
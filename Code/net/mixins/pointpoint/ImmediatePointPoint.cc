@@ -13,6 +13,7 @@ namespace hemelb
   {
     void ImmediatePointPoint::RequestSendImpl(void* pointer, int count, proc_t rank, MPI_Datatype type)
     {
+      RecordSend(count, rank, type);
       HEMELB_MPI_CALL(
           MPI_Ssend,
           (pointer, count, type, rank, 10, communicator)
@@ -20,6 +21,7 @@ namespace hemelb
     }
     void ImmediatePointPoint::RequestReceiveImpl(void* pointer, int count, proc_t rank, MPI_Datatype type)
     {
+      RecordReceive(count, rank, type);
       HEMELB_MPI_CALL(
           MPI_Recv,
           (pointer, count, type, rank, 10, communicator, MPI_STATUS_IGNORE)
@@ -36,6 +38,11 @@ namespace hemelb
 
     }
 
+    void ImmediatePointPoint::ProgressPointToPoint()
+    {
+
+    }
+
     /*!
      Free the allocated data.
      */
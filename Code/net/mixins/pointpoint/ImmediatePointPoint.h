@@ -32,6 +32,7 @@ namespace hemelb
       protected:
         void ReceivePointToPoint(); //PASS
         void SendPointToPoint(); //PASS
+        void ProgressPointToPoint(); //PASS
 
     };
   }
@@ -0,0 +1,194 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "net/mixins/pointpoint/PersistentPointPoint.h"
+
+namespace hemelb
+{
+  namespace net
+  {
+    namespace
+    {
+      void AppendToKey(std::vector<uintptr_t>& key, const std::map<proc_t, ProcComms>& comms)
+      {
+        key.push_back(comms.size());
+        for (std::map<proc_t, ProcComms>::const_iterator it = comms.begin(); it != comms.end(); ++it)
+        {
+          key.push_back(it->first);
+          key.push_back(it->second.size());
+          for (ProcComms::const_iterator request = it->second.begin(); request != it->second.end();
+              ++request)
+          {
+            key.push_back(reinterpret_cast<uintptr_t>(request->Pointer));
+            key.push_back(request->Count);
+            key.push_back(MPI_Type_c2f(request->Type));
+          }
+        }
+      }
+    }
+
+    PersistentPointPoint::PatternKey PersistentPointPoint::GetCurrentKey() const
+    {
+      PatternKey key;
+      AppendToKey(key, receiveProcessorComms);
+      AppendToKey(key, sendProcessorComms);
+      return key;
+    }
+
+    void PersistentPointPoint::CreatePattern(Pattern& pattern)
+    {
+      pattern.receiveCount = receiveProcessorComms.size();
+      pattern.bytesSent = 0;
+      pattern.requests.resize(receiveProcessorComms.size() + sendProcessorComms.size());
+
+      size_t m = 0;
+      for (std::map<proc_t, ProcComms>::iterator it = receiveProcessorComms.begin(); it != receiveProcessorComms.end();
+          ++it)
+      {
+        it->second.CreateMPIType();
+        pattern.types.push_back(it->second.Type);
+
+        MPI_Recv_init(it->second.front().Pointer,
+                      1,
+                      it->second.Type,
+                      it->first,
+                      10,
+                      communicator,
+                      &pattern.requests[m]);
+        ++m;
+      }
+
+      for (std::map<proc_t, ProcComms>::iterator it = sendProcessorComms.begin(); it != sendProcessorComms.end(); ++it)
+      {
+        it->second.CreateMPIType();
+        pattern.types.push_back(it->second.Type);
+
+        MPI_Count typeSize = 0;
+        MPI_Type_size_x(it->second.Type, &typeSize);
+        pattern.bytesSent += typeSize;
+
+        MPI_Send_init(it->second.front().Pointer,
+                      1,
+                      it->second.Type,
+                      it->first,
+                      10,
+                      communicator,
+                      &pattern.requests[m]);
+        ++m;
+      }
+    }
+
+    // Finds (or makes) the persistent requests for the comms requested so far.
+    void PersistentPointPoint::EnsurePreparedToSendReceive()
+    {
+      if (current != NULL)
+      {
+        return;
+      }
+
+      const PatternKey key = GetCurrentKey();
+      std::map<PatternKey, Pattern>::iterator found = patterns.find(key);
+      if (found == patterns.end())
+      {
+        if (patterns.size() >= MAX_PATTERNS)
+        {
+          FreePatterns();
+        }
+        found = patterns.insert(std::make_pair(key, Pattern())).first;
+        CreatePattern(found->second);
+      }
+
+      current = &found->second;
+      receivesStarted = false;
+      sendsStarted = false;
+    }
+
+    void PersistentPointPoint::ReceivePointToPoint()
+    {
+      EnsurePreparedToSendReceive();
+      if (!receivesStarted && current->receiveCount > 0)
+      {
+        MPI_Startall((int) current->receiveCount, &current->requests[0]);
+      }
+      receivesStarted = true;
+    }
+
+    void PersistentPointPoint::SendPointToPoint()
+    {
+      EnsurePreparedToSendReceive();
+      const size_t sendCount = current->requests.size() - current->receiveCount;
+      if (!sendsStarted && sendCount > 0)
+      {
+        MPI_Startall((int) sendCount, &current->requests[current->receiveCount]);
+        BytesSent += current->bytesSent;
+      }
+      sendsStarted = true;
+    }
+
+    void PersistentPointPoint::ProgressPointToPoint()
+    {
+      if (current != NULL)
+      {
+        int done;
+        if (receivesStarted && current->receiveCount > 0)
+        {
+          MPI_Testall((int) current->receiveCount, &current->requests[0], &done, MPI_STATUSES_IGNORE);
+        }
+        const size_t sendCount = current->requests.size() - current->receiveCount;
+        if (sendsStarted && sendCount > 0)
+        {
+          MPI_Testall((int) sendCount, &current->requests[current->receiveCount], &done, MPI_STATUSES_IGNORE);
+        }
+      }
+    }
+
+    void PersistentPointPoint::WaitPointToPoint()
+    {
+      if (current != NULL)
+      {
+        // Only wait on what was started, so that a Wait without a Send or Receive is harmless.
+        if (receivesStarted && current->receiveCount > 0)
+        {
+          MPI_Waitall((int) current->receiveCount, &current->requests[0], MPI_STATUSES_IGNORE);
+        }
+        const size_t sendCount = current->requests.size() - current->receiveCount;
+        if (sendsStarted && sendCount > 0)
+        {
+          MPI_Waitall((int) sendCount, &current->requests[current->receiveCount], MPI_STATUSES_IGNORE);
+        }
+        current = NULL;
+      }
+
+      // The datatypes belong to the pattern now, so don't free them here.
+      receiveProcessorComms.clear();
+      sendProcessorComms.clear();
+    }
+
+    void PersistentPointPoint::FreePatterns()
+    {
+      for (std::map<PatternKey, Pattern>::iterator it = patterns.begin(); it != patterns.end(); ++it)
+      {
+        for (size_t request = 0; request < it->second.requests.size(); ++request)
+        {
+          MPI_Request_free(&it->second.requests[request]);
+        }
+        for (size_t type = 0; type < it->second.types.size(); ++type)
+        {
+          MPI_Type_free(&it->second.types[type]);
+        }
+      }
+      patterns.clear();
+    }
+
+    /*!
+     Free the allocated data.
+     */
+    PersistentPointPoint::~PersistentPointPoint()
+    {
+      FreePatterns();
+    }
+  }
+}
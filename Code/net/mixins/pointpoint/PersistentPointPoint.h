@@ -0,0 +1,76 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_NET_MIXINS_POINTPOINT_PERSISTENTPOINTPOINT_H
+#define HEMELB_NET_MIXINS_POINTPOINT_PERSISTENTPOINTPOINT_H
+#include <stdint.h>
+#include "net/BaseNet.h"
+#include "net/mixins/StoringNet.h"
+namespace hemelb
+{
+  namespace net
+  {
+    /**
+     * Point to point comms coalesced per neighbour as in CoalescePointPoint, but using
+     * persistent requests. The requests (and datatypes) for each pattern of comms - the ranks,
+     * buffers, counts and types of all the sends and receives of a Dispatch - are made once
+     * and then just started on every later Dispatch with the same pattern. The halo exchange
+     * of the lattice is the same every time step, so it only pays for the set-up once.
+     */
+    class PersistentPointPoint : public virtual StoringNet
+    {
+
+      public:
+        PersistentPointPoint(const MpiCommunicator& comms) :
+            BaseNet(comms), StoringNet(comms), current(NULL)
+        {
+        }
+        ~PersistentPointPoint();
+
+        void WaitPointToPoint();
+
+      protected:
+        void ReceivePointToPoint();
+        void SendPointToPoint();
+        void ProgressPointToPoint();
+
+      private:
+        /**
+         * Everything about the comms requested for one Dispatch, to look up the
+         * persistent requests by.
+         */
+        typedef std::vector<uintptr_t> PatternKey;
+
+        struct Pattern
+        {
+            // Receive requests first, then send requests.
+            std::vector<MPI_Request> requests;
+            std::vector<MPI_Datatype> types;
+            size_t receiveCount;
+            long long int bytesSent;
+        };
+
+        /**
+         * The most patterns to keep. Comms whose buffers move around between Dispatches never
+         * hit the same pattern twice, so we start again rather than keep collecting them.
+         */
+        static const size_t MAX_PATTERNS = 16;
+
+        void EnsurePreparedToSendReceive();
+        PatternKey GetCurrentKey() const;
+        void CreatePattern(Pattern& pattern);
+        void FreePatterns();
+
+        std::map<PatternKey, Pattern> patterns;
+        // The pattern for the Dispatch in progress, or NULL between Dispatches.
+        Pattern* current;
+        bool receivesStarted;
+        bool sendsStarted;
+    };
+  }
+}
+
+#endif
@@ -0,0 +1,342 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <cstring>
+#include "net/mixins/pointpoint/RmaPointPoint.h"
+#include "Exception.h"
+
+namespace hemelb
+{
+  namespace net
+  {
+    namespace
+    {
+      size_t RequestBytes(const SimpleRequest& request)
+      {
+        MPI_Count typeSize = 0;
+        MPI_Type_size_x(request.Type, &typeSize);
+        return size_t(typeSize) * request.Count;
+      }
+
+      size_t CountBytes(const ProcComms& comms)
+      {
+        size_t bytes = 0;
+        for (ProcComms::const_iterator request = comms.begin(); request != comms.end(); ++request)
+        {
+          bytes += RequestBytes(*request);
+        }
+        return bytes;
+      }
+
+      // Whether an array of the type is just its bytes, with no gaps, so can be copied as such.
+      bool IsContiguous(MPI_Datatype type)
+      {
+        MPI_Count typeSize = 0;
+        MPI_Type_size_x(type, &typeSize);
+        MPI_Aint lowerBound, extent, trueLowerBound, trueExtent;
+        MPI_Type_get_extent(type, &lowerBound, &extent);
+        MPI_Type_get_true_extent(type, &trueLowerBound, &trueExtent);
+        return lowerBound == 0 && trueLowerBound == 0 && extent == typeSize
+            && trueExtent == typeSize;
+      }
+    }
+
+    RmaPointPoint::RmaPointPoint(const MpiCommunicator& comms) :
+        BaseNet(comms), StoringNet(comms), window(MPI_WIN_NULL), communicatorGroup(MPI_GROUP_NULL),
+            originGroup(MPI_GROUP_EMPTY), targetGroup(MPI_GROUP_EMPTY), prepared(false),
+            sendsStarted(false)
+    {
+      if (communicator)
+      {
+        MPI_Win_create_dynamic(MPI_INFO_NULL, communicator, &window);
+        MPI_Comm_group(communicator, &communicatorGroup);
+      }
+    }
+
+    /*!
+     Free the window and groups.
+     */
+    RmaPointPoint::~RmaPointPoint()
+    {
+      if (window != MPI_WIN_NULL)
+      {
+        DetachRegions();
+        MPI_Win_free(&window);
+        MPI_Group_free(&communicatorGroup);
+      }
+      SetGroup(originGroup, originRanks, std::vector<proc_t>());
+      SetGroup(targetGroup, targetRanks, std::vector<proc_t>());
+    }
+
+    void RmaPointPoint::DetachRegions()
+    {
+      for (std::map<proc_t, std::vector<char> >::iterator region = regions.begin();
+          region != regions.end(); ++region)
+      {
+        if (!region->second.empty())
+        {
+          MPI_Win_detach(window, &region->second[0]);
+        }
+      }
+      regions.clear();
+    }
+
+    // Remakes the group of the given ranks, if they have changed.
+    void RmaPointPoint::SetGroup(MPI_Group& group, std::vector<proc_t>& ranks,
+                                 const std::vector<proc_t>& newRanks)
+    {
+      if (newRanks == ranks)
+      {
+        return;
+      }
+      if (group != MPI_GROUP_EMPTY)
+      {
+        MPI_Group_free(&group);
+      }
+      ranks = newRanks;
+      if (ranks.empty())
+      {
+        group = MPI_GROUP_EMPTY;
+      }
+      else
+      {
+        MPI_Group_incl(communicatorGroup, (int) ranks.size(), &ranks[0], &group);
+      }
+    }
+
+    // Makes sure each sender knows where to put into this task, and each receiver where to put
+    // into it, then exposes this task's regions to its senders.
+    void RmaPointPoint::EnsurePreparedToSendReceive()
+    {
+      if (prepared)
+      {
+        return;
+      }
+      prepared = true;
+
+      // Tell the senders about any regions that have to change size. Each message is the
+      // region's address and size.
+      std::vector<MPI_Aint> regionMessages;
+      regionMessages.reserve(2 * receiveProcessorComms.size());
+      std::vector<MPI_Request> requests;
+      std::vector<proc_t> newOrigins;
+      for (std::map<proc_t, ProcComms>::iterator it = receiveProcessorComms.begin();
+          it != receiveProcessorComms.end(); ++it)
+      {
+        const size_t bytes = CountBytes(it->second);
+        if (bytes == 0)
+        {
+          continue;
+        }
+        newOrigins.push_back(it->first);
+
+        std::vector<char>& region = regions[it->first];
+        if (region.size() != bytes)
+        {
+          if (!region.empty())
+          {
+            MPI_Win_detach(window, &region[0]);
+          }
+          std::vector<char>(bytes).swap(region);
+          MPI_Win_attach(window, &region[0], bytes);
+
+          MPI_Aint address;
+          MPI_Get_address(&region[0], &address);
+          regionMessages.push_back(address);
+          regionMessages.push_back(MPI_Aint(bytes));
+          requests.push_back(MPI_REQUEST_NULL);
+          MPI_Isend(&regionMessages[regionMessages.size() - 2],
+                    2,
+                    MPI_AINT,
+                    it->first,
+                    REGION_TAG,
+                    communicator,
+                    &requests.back());
+        }
+      }
+
+      // Hear about the regions at the receivers that have changed, which are those we now send
+      // a different number of bytes to.
+      std::vector<proc_t> newTargets;
+      for (std::map<proc_t, ProcComms>::iterator it = sendProcessorComms.begin();
+          it != sendProcessorComms.end(); ++it)
+      {
+        const size_t bytes = CountBytes(it->second);
+        if (bytes == 0)
+        {
+          continue;
+        }
+        newTargets.push_back(it->first);
+
+        Target& target = targets[it->first];
+        if (target.bytes != bytes)
+        {
+          MPI_Aint regionMessage[2];
+          MPI_Recv(regionMessage, 2, MPI_AINT, it->first, REGION_TAG, communicator, MPI_STATUS_IGNORE);
+          if (size_t(regionMessage[1]) != bytes)
+          {
+            throw Exception() << "Task " << it->first << " receives " << regionMessage[1]
+                << " bytes from task " << communicator.Rank() << ", which sends it " << bytes;
+          }
+          target.bytes = bytes;
+          target.address = regionMessage[0];
+        }
+      }
+
+      if (!requests.empty())
+      {
+        MPI_Waitall((int) requests.size(), &requests[0], MPI_STATUSES_IGNORE);
+      }
+
+      SetGroup(originGroup, originRanks, newOrigins);
+      SetGroup(targetGroup, targetRanks, newTargets);
+
+      // Only the regions are exposed, so senders can put into them before the receive buffers
+      // are ready.
+      if (!originRanks.empty())
+      {
+        MPI_Win_post(originGroup, 0, window);
+      }
+    }
+
+    void RmaPointPoint::ReceivePointToPoint()
+    {
+      EnsurePreparedToSendReceive();
+    }
+
+    void RmaPointPoint::SendPointToPoint()
+    {
+      EnsurePreparedToSendReceive();
+      if (sendsStarted || targetRanks.empty())
+      {
+        return;
+      }
+      sendsStarted = true;
+      MPI_Win_start(targetGroup, 0, window);
+
+      // Pack the non-contiguous sends up front, as the buffer mustn't move while they are put.
+      size_t packedBytes = 0;
+      for (std::map<proc_t, ProcComms>::iterator it = sendProcessorComms.begin();
+          it != sendProcessorComms.end(); ++it)
+      {
+        for (ProcComms::iterator request = it->second.begin(); request != it->second.end(); ++request)
+        {
+          if (!IsContiguous(request->Type))
+          {
+            int requestPackedBytes = 0;
+            MPI_Pack_size(request->Count, request->Type, communicator, &requestPackedBytes);
+            packedBytes += requestPackedBytes;
+          }
+        }
+      }
+      packed.resize(packedBytes);
+
+      int packPosition = 0;
+      for (std::map<proc_t, ProcComms>::iterator it = sendProcessorComms.begin();
+          it != sendProcessorComms.end(); ++it)
+      {
+        const Target& target = targets[it->first];
+        MPI_Aint offset = 0;
+        for (ProcComms::iterator request = it->second.begin(); request != it->second.end(); ++request)
+        {
+          const size_t bytes = RequestBytes(*request);
+          if (bytes == 0)
+          {
+            continue;
+          }
+
+          void* origin = request->Pointer;
+          if (!IsContiguous(request->Type))
+          {
+            const int packStart = packPosition;
+            MPI_Pack(request->Pointer,
+                     request->Count,
+                     request->Type,
+                     &packed[0],
+                     (int) packed.size(),
+                     &packPosition,
+                     communicator);
+            // The region holds the data as the receiver will unpack it, which is only the
+            // same as the packed data if the packing adds nothing.
+            if (size_t(packPosition - packStart) != bytes)
+            {
+              throw Exception() << "Can't put " << bytes << " bytes that pack to "
+                  << (packPosition - packStart);
+            }
+            origin = &packed[packStart];
+          }
+
+          LargeCount byteCount(bytes, MPI_BYTE);
+          MPI_Put(origin,
+                  byteCount.Count(),
+                  byteCount.Type(),
+                  it->first,
+                  target.address + offset,
+                  byteCount.Count(),
+                  byteCount.Type(),
+                  window);
+          offset += bytes;
+        }
+        BytesSent += target.bytes;
+      }
+    }
+
+    void RmaPointPoint::ProgressPointToPoint()
+    {
+      // The epochs are only closed in Wait, and there's nothing to test before then.
+    }
+
+    void RmaPointPoint::WaitPointToPoint()
+    {
+      if (prepared)
+      {
+        if (sendsStarted)
+        {
+          MPI_Win_complete(window);
+        }
+        if (!originRanks.empty())
+        {
+          MPI_Win_wait(window);
+        }
+
+        for (std::map<proc_t, ProcComms>::iterator it = receiveProcessorComms.begin();
+            it != receiveProcessorComms.end(); ++it)
+        {
+          if (CountBytes(it->second) == 0)
+          {
+            continue;
+          }
+          std::vector<char>& region = regions[it->first];
+          int position = 0;
+          for (ProcComms::iterator request = it->second.begin(); request != it->second.end();
+              ++request)
+          {
+            if (IsContiguous(request->Type))
+            {
+              const size_t bytes = RequestBytes(*request);
+              std::memcpy(request->Pointer, &region[position], bytes);
+              position += (int) bytes;
+            }
+            else
+            {
+              MPI_Unpack(&region[0],
+                         (int) region.size(),
+                         &position,
+                         request->Pointer,
+                         request->Count,
+                         request->Type,
+                         communicator);
+            }
+          }
+        }
+        prepared = false;
+        sendsStarted = false;
+      }
+
+      receiveProcessorComms.clear();
+      sendProcessorComms.clear();
+    }
+  }
+}
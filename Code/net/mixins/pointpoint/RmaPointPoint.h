@@ -0,0 +1,82 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_NET_MIXINS_POINTPOINT_RMAPOINTPOINT_H
+#define HEMELB_NET_MIXINS_POINTPOINT_RMAPOINTPOINT_H
+#include <vector>
+#include "net/BaseNet.h"
+#include "net/mixins/StoringNet.h"
+namespace hemelb
+{
+  namespace net
+  {
+    /**
+     * Point to point comms by remote memory access: each task puts what it sends straight
+     * into a region of the receiving task's memory, in an epoch of the window over those
+     * regions, and there is no matching of messages at the receiving end.
+     *
+     * Each task keeps a region for each task it receives from, big enough for everything
+     * received from it in a Dispatch. The region's address is only sent to the sender when
+     * the number of bytes between the two changes, so the halo exchange of the lattice, which
+     * is the same every time step, only exchanges addresses on the first. The regions are
+     * copied into the receive buffers in Wait, as callers are free to move those between
+     * Dispatches. Because the byte counts must agree at both ends, everything received from a
+     * task in a Dispatch must be the same size as everything it sent.
+     *
+     * Making and destroying the net are collective over its communicator.
+     */
+    class RmaPointPoint : public virtual StoringNet
+    {
+
+      public:
+        RmaPointPoint(const MpiCommunicator& comms);
+        ~RmaPointPoint();
+
+        void WaitPointToPoint();
+
+      protected:
+        void ReceivePointToPoint();
+        void SendPointToPoint();
+        void ProgressPointToPoint();
+
+      private:
+        //! Where to put what is sent to a task.
+        struct Target
+        {
+            Target() :
+                bytes(0), address(0)
+            {
+            }
+            size_t bytes;
+            MPI_Aint address;
+        };
+
+        //! The tag for the messages that tell senders about a changed region.
+        static const int REGION_TAG = 21;
+
+        void EnsurePreparedToSendReceive();
+        void SetGroup(MPI_Group& group, std::vector<proc_t>& ranks,
+                      const std::vector<proc_t>& newRanks);
+        void DetachRegions();
+
+        MPI_Win window;
+        MPI_Group communicatorGroup;
+        //! The region that each task sending to this one puts into.
+        std::map<proc_t, std::vector<char> > regions;
+        std::map<proc_t, Target> targets;
+        //! Non-contiguous sends, packed for putting.
+        std::vector<char> packed;
+        //! The tasks that put into this one, and that this one puts into, in this Dispatch.
+        std::vector<proc_t> originRanks;
+        std::vector<proc_t> targetRanks;
+        MPI_Group originGroup;
+        MPI_Group targetGroup;
+        bool prepared;
+        bool sendsStarted;
+    };
+  }
+}
+
+#endif
@@ -0,0 +1,117 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "net/mixins/pointpoint/SelectablePointPoint.h"
+
+namespace hemelb
+{
+  namespace net
+  {
+    SelectablePointPoint::SelectablePointPoint(const MpiCommunicator& comms) :
+        BaseNet(comms), StoringNet(comms), CoalescePointPoint(comms), SeparatedPointPoint(comms),
+            ImmediatePointPoint(comms), PersistentPointPoint(comms),
+            pointPointStrategy(CommsStrategy::GetDefault().pointPoint)
+    {
+    }
+
+    void SelectablePointPoint::RequestSendImpl(void* pointer, int count, proc_t rank,
+                                               MPI_Datatype type)
+    {
+      if (pointPointStrategy == CommsStrategy::PointPointImmediate)
+      {
+        ImmediatePointPoint::RequestSendImpl(pointer, count, rank, type);
+      }
+      else
+      {
+        StoringNet::RequestSendImpl(pointer, count, rank, type);
+      }
+    }
+
+    void SelectablePointPoint::RequestReceiveImpl(void* pointer, int count, proc_t rank,
+                                                  MPI_Datatype type)
+    {
+      if (pointPointStrategy == CommsStrategy::PointPointImmediate)
+      {
+        ImmediatePointPoint::RequestReceiveImpl(pointer, count, rank, type);
+      }
+      else
+      {
+        StoringNet::RequestReceiveImpl(pointer, count, rank, type);
+      }
+    }
+
+    void SelectablePointPoint::ReceivePointToPoint()
+    {
+      switch (pointPointStrategy)
+      {
+        case CommsStrategy::PointPointSeparated:
+          SeparatedPointPoint::ReceivePointToPoint();
+          break;
+        case CommsStrategy::PointPointImmediate:
+          ImmediatePointPoint::ReceivePointToPoint();
+          break;
+        case CommsStrategy::PointPointPersistent:
+          PersistentPointPoint::ReceivePointToPoint();
+          break;
+        default:
+          CoalescePointPoint::ReceivePointToPoint();
+      }
+    }
+
+    void SelectablePointPoint::SendPointToPoint()
+    {
+      switch (pointPointStrategy)
+      {
+        case CommsStrategy::PointPointSeparated:
+          SeparatedPointPoint::SendPointToPoint();
+          break;
+        case CommsStrategy::PointPointImmediate:
+          ImmediatePointPoint::SendPointToPoint();
+          break;
+        case CommsStrategy::PointPointPersistent:
+          PersistentPointPoint::SendPointToPoint();
+          break;
+        default:
+          CoalescePointPoint::SendPointToPoint();
+      }
+    }
+
+    void SelectablePointPoint::ProgressPointToPoint()
+    {
+      switch (pointPointStrategy)
+      {
+        case CommsStrategy::PointPointSeparated:
+          SeparatedPointPoint::ProgressPointToPoint();
+          break;
+        case CommsStrategy::PointPointImmediate:
+          ImmediatePointPoint::ProgressPointToPoint();
+          break;
+        case CommsStrategy::PointPointPersistent:
+          PersistentPointPoint::ProgressPointToPoint();
+          break;
+        default:
+          CoalescePointPoint::ProgressPointToPoint();
+      }
+    }
+
+    void SelectablePointPoint::WaitPointToPoint()
+    {
+      switch (pointPointStrategy)
+      {
+        case CommsStrategy::PointPointSeparated:
+          SeparatedPointPoint::WaitPointToPoint();
+          break;
+        case CommsStrategy::PointPointImmediate:
+          ImmediatePointPoint::WaitPointToPoint();
+          break;
+        case CommsStrategy::PointPointPersistent:
+          PersistentPointPoint::WaitPointToPoint();
+          break;
+        default:
+          CoalescePointPoint::WaitPointToPoint();
+      }
+    }
+  }
+}
@@ -0,0 +1,62 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_NET_MIXINS_POINTPOINT_SELECTABLEPOINTPOINT_H
+#define HEMELB_NET_MIXINS_POINTPOINT_SELECTABLEPOINTPOINT_H
+#include "net/CommsStrategy.h"
+#include "net/mixins/pointpoint/CoalescePointPoint.h"
+#include "net/mixins/pointpoint/SeparatedPointPoint.h"
+#include "net/mixins/pointpoint/ImmediatePointPoint.h"
+#include "net/mixins/pointpoint/PersistentPointPoint.h"
+namespace hemelb
+{
+  namespace net
+  {
+    /**
+     * Point to point comms by whichever of the coalesced, separated, immediate or persistent
+     * implementations is chosen, at run time. They all work from the requests the StoringNet
+     * has stored, and leave none of them stored after a Wait, so the choice can be changed
+     * between Dispatches.
+     */
+    class SelectablePointPoint : public CoalescePointPoint,
+                                 public SeparatedPointPoint,
+                                 public ImmediatePointPoint,
+                                 public PersistentPointPoint
+    {
+
+      public:
+        /**
+         * Starts with the point-to-point comms of the default comms strategy.
+         */
+        SelectablePointPoint(const MpiCommunicator& comms);
+
+        /**
+         * Change the implementation, between Dispatches.
+         */
+        void SetPointPointStrategy(CommsStrategy::PointPoint strategy)
+        {
+          pointPointStrategy = strategy;
+        }
+        CommsStrategy::PointPoint GetPointPointStrategy() const
+        {
+          return pointPointStrategy;
+        }
+
+        void WaitPointToPoint();
+        virtual void RequestSendImpl(void* pointer, int count, proc_t rank, MPI_Datatype type);
+        virtual void RequestReceiveImpl(void* pointer, int count, proc_t rank, MPI_Datatype type);
+
+      protected:
+        void ReceivePointToPoint();
+        void SendPointToPoint();
+        void ProgressPointToPoint();
+
+      private:
+        CommsStrategy::PointPoint pointPointStrategy;
+    };
+  }
+}
+
+#endif
@@ -16,7 +16,7 @@ namespace hemelb
     {
       if (requests.size() < count)
       {
-        requests.resize(count, MPI_Request());
+        requests.resize(count, MPI_REQUEST_NULL);
         statuses.resize(count, MPI_Status());
       }
     }
@@ -94,6 +94,17 @@ namespace hemelb
       }
     }
 
+    void SeparatedPointPoint::ProgressPointToPoint()
+    {
+      // Requests not yet started are null, and MPI_Testall leaves them all alone unless they
+      // have all finished.
+      if (sendReceivePrepped)
+      {
+        int done;
+        MPI_Testall(static_cast<int>(count_sends + count_receives), &requests[0], &done, MPI_STATUSES_IGNORE);
+      }
+    }
+
     /*!
      Free the allocated data.
      */
@@ -28,6 +28,7 @@ namespace hemelb
       protected:
         void ReceivePointToPoint();
         void SendPointToPoint();
+        void ProgressPointToPoint();
 
       private:
         void EnsureEnoughRequests(size_t count);
@@ -10,6 +10,7 @@
 #include "net/BaseNet.h"
 #include "net/mixins/mixins.h"
 #include "net/BuildInfo.h"
+#include "net/CommsStrategy.h"
 namespace hemelb
 {
   namespace net
@@ -26,6 +27,19 @@ namespace hemelb
                 GathersImpl(communicator)
         {
         }
+
+        /**
+         * Use the given comms implementations from the next Dispatch on, if they can be chosen
+         * at run time; otherwise they are the ones HemeLB was configured with.
+         */
+        void SetStrategy(const CommsStrategy& strategy)
+        {
+#ifdef HEMELB_RUNTIME_COMMS_SELECTION
+          SetPointPointStrategy(strategy.pointPoint);
+          SetGathersStrategy(strategy.gathers);
+          SetAllToAllStrategy(strategy.allToAll);
+#endif
+        }
     };
   }
 }
@@ -5,7 +5,10 @@
 // license in the file LICENSE.
 
 #include "net/phased/StepManager.h"
+#include "net/CommsStatistics.h"
+#include "Exception.h"
 #include <algorithm>
+#include <typeinfo>
 
 namespace hemelb
 {
@@ -15,23 +18,108 @@ namespace hemelb
     {
 
       StepManager::StepManager(Phase phases, reporting::Timers *timers, bool separate_concerns) :
-          registry(phases), concerns(), timers(timers), separate_concerns(separate_concerns)
+          registry(phases), concerns(), timers(timers), tracer(NULL), commsStatistics(NULL), separate_concerns(separate_concerns),
+              iteration(0), dependencyScheduling(false), scheduleStale(true)
       {
       }
 
-      void StepManager::Register(Phase phase, steps::Step step, Concern & concern, MethodLabel method)
+      void StepManager::Register(Phase phase, steps::Step step, Concern & concern, MethodLabel method,
+                                 unsigned long period)
       {
         if (step == steps::BeginAll || step == steps::EndAll)
         {
           phase = 0; // special actions are always recorded in the phase zero registry
         }
-        registry[phase][step].push_back(Action(concern, method));
+        registry[phase][step].push_back(Action(concern, method, period));
         if (std::find(concerns.begin(),concerns.end(),&concern)==concerns.end()){
           concerns.push_back(&concern);
         }
+        scheduleStale = true;
       }
 
-      void StepManager::RegisterIteratedActorSteps(Concern &concern, Phase phase)
+      void StepManager::DeclareDependency(Concern &concern, Concern &dependency)
+      {
+        dependencies[&concern].push_back(&dependency);
+        scheduleStale = true;
+      }
+
+      void StepManager::UpdateSchedule()
+      {
+        if (!scheduleStale)
+        {
+          return;
+        }
+
+        // Repeatedly take the first concern, in order of registration, whose dependencies have
+        // all been taken. Dependencies on concerns that aren't registered are ignored.
+        std::set<Concern*> scheduled;
+        scheduleOrder.clear();
+        while (scheduleOrder.size() < concerns.size())
+        {
+          bool progressed = false;
+          for (std::vector<Concern*>::iterator concern = concerns.begin(); concern != concerns.end(); concern++)
+          {
+            if (scheduled.count(*concern))
+            {
+              continue;
+            }
+            bool ready = true;
+            std::vector<Concern*> &needs = dependencies[*concern];
+            for (std::vector<Concern*>::iterator need = needs.begin(); need != needs.end(); need++)
+            {
+              if (!scheduled.count(*need) && std::find(concerns.begin(), concerns.end(), *need) != concerns.end())
+              {
+                ready = false;
+                break;
+              }
+            }
+            if (ready)
+            {
+              scheduleOrder.push_back(*concern);
+              scheduled.insert(*concern);
+              progressed = true;
+              break;
+            }
+          }
+          if (!progressed)
+          {
+            throw Exception() << "The dependencies declared between the step manager's concerns form a cycle";
+          }
+        }
+
+        // The concerns that communicate in a phase wait for it, and so does everything that
+        // depends on them.
+        waitingConcerns.assign(registry.size(), std::set<Concern*>());
+        for (Phase phase = 0; phase < registry.size(); phase++)
+        {
+          std::set<Concern*> &waiting = waitingConcerns[phase];
+          const steps::Step commsSteps[] = { steps::Receive, steps::Send, steps::Wait };
+          for (unsigned int commsStep = 0; commsStep < 3; commsStep++)
+          {
+            std::vector<Action> &actions = registry[phase][commsSteps[commsStep]];
+            for (std::vector<Action>::iterator action = actions.begin(); action != actions.end(); action++)
+            {
+              waiting.insert(action->concern);
+            }
+          }
+          for (std::vector<Concern*>::iterator concern = scheduleOrder.begin(); concern != scheduleOrder.end();
+              concern++)
+          {
+            std::vector<Concern*> &needs = dependencies[*concern];
+            for (std::vector<Concern*>::iterator need = needs.begin(); need != needs.end(); need++)
+            {
+              if (waiting.count(*need))
+              {
+                waiting.insert(*concern);
+                break;
+              }
+            }
+          }
+        }
+        scheduleStale = false;
+      }
+
+      void StepManager::RegisterIteratedActorSteps(Concern &concern, Phase phase, unsigned long period)
       {
         for (int step = steps::BeginPhase; step <= steps::EndAll; step++)
         {
@@ -40,7 +128,7 @@ namespace hemelb
             continue;
           }
           // C++ makes it completely annoying to iterate over values in an enum
-          Register(phase, static_cast<steps::Step>(step), concern, step);
+          Register(phase, static_cast<steps::Step>(step), concern, step, period);
         }
       }
 
@@ -118,6 +206,42 @@ namespace hemelb
         }
       }
 
+      void StepManager::CallActionsForPhaseByDependencies(Phase phase)
+      {
+        UpdateSchedule();
+        const std::set<Concern*> &waiting = waitingConcerns[phase];
+        for (int step = steps::BeginPhase; step <= steps::EndPhase; step++)
+        {
+          if (step == steps::Receive || step == steps::Send || step == steps::Wait)
+          {
+            CallActionsForStep(static_cast<steps::Step>(step), phase);
+            continue;
+          }
+
+          for (std::vector<Concern*>::iterator concern = scheduleOrder.begin(); concern != scheduleOrder.end();
+              concern++)
+          {
+            if (step != steps::EndPhase || waiting.count(*concern))
+            {
+              CallActionsForStepForConcern(static_cast<steps::Step>(step), *concern, phase);
+            }
+          }
+
+          // The concerns that don't need this phase's communication finish while it's going on.
+          if (step == steps::PreWait)
+          {
+            for (std::vector<Concern*>::iterator concern = scheduleOrder.begin(); concern != scheduleOrder.end();
+                concern++)
+            {
+              if (!waiting.count(*concern))
+              {
+                CallActionsForStepForConcern(steps::EndPhase, *concern, phase);
+              }
+            }
+          }
+        }
+      }
+
       void StepManager::CallSpecialAction(steps::Step step)
       {
         // special actions are always recorded in the phase zero registry
@@ -136,26 +260,51 @@ namespace hemelb
 
       void StepManager::CallActions()
       {
-        if (separate_concerns)
+        if (dependencyScheduling)
+        {
+          CallSpecialAction(steps::BeginAll);
+          for (Phase phase = 0; phase < registry.size(); phase++)
+          {
+            CallActionsForPhaseByDependencies(phase);
+          }
+          CallSpecialAction(steps::EndAll);
+        }
+        else if (separate_concerns)
         {
           CallActionsSeparatedConcerns();
-          return;
         }
-        CallSpecialAction(steps::BeginAll);
-        for (Phase phase = 0; phase < registry.size(); phase++)
+        else
         {
-          CallActionsForPhase(phase);
+          CallSpecialAction(steps::BeginAll);
+          for (Phase phase = 0; phase < registry.size(); phase++)
+          {
+            CallActionsForPhase(phase);
+          }
+          CallSpecialAction(steps::EndAll);
         }
-        CallSpecialAction(steps::EndAll);
+        if (commsStatistics != NULL)
+        {
+          commsStatistics->SetCurrentConcern(NULL);
+        }
+        ++iteration;
       }
 
       void StepManager::CallActionsForStep(steps::Step step, Phase phase)
       {
         StartTimer(step);
+        const bool tracing = tracer != NULL && tracer->IsRecording();
+        const double stepBegin = tracing ? tracer->Now() : 0.0;
         std::vector<Action> &actionsForStep = registry[phase][step];
         for (std::vector<Action>::iterator action = actionsForStep.begin(); action != actionsForStep.end(); action++)
         {
-          action->Call();
+          if (action->IsDue(iteration))
+          {
+            CallAction(*action, step, phase, tracing);
+          }
+        }
+        if (tracing)
+        {
+          tracer->Record(phase, step, NULL, stepBegin, tracer->Now());
         }
         StopTimer(step);
       }
@@ -163,17 +312,34 @@ namespace hemelb
       void StepManager::CallActionsForStepForConcern(steps::Step step,  Concern * concern, Phase phase)
       {
         StartTimer(step);
+        const bool tracing = tracer != NULL && tracer->IsRecording();
         std::vector<Action> &actionsForStep = registry[phase][step];
         for (std::vector<Action>::iterator action = actionsForStep.begin(); action != actionsForStep.end(); action++)
         {
-          if (action->concern == concern)
+          if (action->concern == concern && action->IsDue(iteration))
           {
-            action->Call();
+            CallAction(*action, step, phase, tracing);
           }
         }
         StopTimer(step);
       }
 
+      void StepManager::CallAction(Action &action, steps::Step step, Phase phase, bool tracing)
+      {
+        if (commsStatistics != NULL)
+        {
+          commsStatistics->SetCurrentConcern(typeid(*action.concern).name());
+        }
+        if (!tracing)
+        {
+          action.Call();
+          return;
+        }
+        const double begin = tracer->Now();
+        action.Call();
+        tracer->Record(phase, step, action.concern, begin, tracer->Now());
+      }
+
       void StepManager::StartTimer(steps::Step step)
       {
         if (!timers)
@@ -14,12 +14,15 @@
 #include "net/IteratedAction.h"
 #include "net/phased/Concern.h"
 #include "net/phased/steps.h"
+#include "net/phased/StepTracer.h"
 
 #include "log/Logger.h"
 namespace hemelb
 {
   namespace net
   {
+    class CommsStatistics;
+
     namespace phased
     {
       /***
@@ -31,6 +34,13 @@ namespace hemelb
        * There may be several sequences of asynchronous communication during a single
        * iteration of the SimulationMaster, by registering several phases, each with
        * it's own pre/post send-receive steps, etc.
+       *
+       * With dependency scheduling turned on, the concerns declare which others they take
+       * data from (DeclareDependency). In each step of a phase, a concern's actions are then called after
+       * those of the concerns it depends on, rather than in order of registration. A concern
+       * that depends, directly or not, on no concern doing the communication of a phase has its
+       * EndPhase actions called in PreWait, so that they overlap with the communication
+       * instead of waiting for it.
        */
       class StepManager
       {
@@ -51,18 +61,23 @@ namespace hemelb
               Concern * concern;
               MethodLabel method;
               std::string name;
-              Action(Concern &concern, MethodLabel method) :
-                  concern(&concern), method(method)
+              unsigned long period; ///< The action is only called on every period-th iteration
+              Action(Concern &concern, MethodLabel method, unsigned long period = 1) :
+                  concern(&concern), method(method), period(period)
               {
               }
               Action(const Action & action) :
-                  concern(action.concern), method(action.method)
+                  concern(action.concern), method(action.method), period(action.period)
               {
               }
               bool Call()
               {
                 return concern->CallAction(method);
               }
+              bool IsDue(unsigned long iteration) const
+              {
+                return iteration % period == 0;
+              }
           };
 
           typedef std::map<steps::Step, std::vector<Action> > Registry;
@@ -80,16 +95,19 @@ namespace hemelb
            * @param step Step where an action should be called
            * @param concern Concern on which the method should be called
            * @param method label, indicating which method of the concern should be registered
+           * @param period Only call the action on every period-th iteration (call of CallActions)
            */
-          void Register(Phase phase, steps::Step step, Concern & concern, MethodLabel method);
+          void Register(Phase phase, steps::Step step, Concern & concern, MethodLabel method,
+                        unsigned long period = 1);
 
           /***
            * Register a concern for all of the steps typically used by an action,
            * syntactic sugar for the individual registrations
            * @param concern Concern which should be called, typically an IteratedActor
            * @param phase Phase for which this IteratedActor should be called.
+           * @param period Only call the actor on every period-th iteration, starting with the first.
            */
-          void RegisterIteratedActorSteps(Concern &concern, Phase phase = 0);
+          void RegisterIteratedActorSteps(Concern &concern, Phase phase = 0, unsigned long period = 1);
 
           /***
            * Register a concern for all of the steps typically used to send/receive communications
@@ -105,6 +123,31 @@ namespace hemelb
            */
           void RegisterCommsForAllPhases(Concern &concern);
 
+          /***
+           * Declare that a concern uses data from another, so that with dependency scheduling
+           * its actions in each step come after the other's, and wait for the communication
+           * if the other's do.
+           * @param concern
+           * @param dependency
+           */
+          void DeclareDependency(Concern &concern, Concern &dependency);
+
+          /***
+           * Turn the scheduling of actions by the declared dependencies on or off. Off, the
+           * actions are called in order of registration.
+           * @param enabled
+           */
+          void SetDependencyScheduling(bool enabled)
+          {
+            dependencyScheduling = enabled;
+          }
+
+          /***
+           * Call the actions for the given phase, ordered by the declared dependencies
+           * @param phase
+           */
+          void CallActionsForPhaseByDependencies(Phase phase = 0);
+
           /***
            * Call the actions, concern by concern, for the given phase
            * @param phase
@@ -160,13 +203,68 @@ namespace hemelb
            */
           unsigned int ActionCount() const;
 
+          /***
+           * Get the number of completed calls of CallActions, against which action periods are
+           * counted
+           * @return number of iterations so far
+           */
+          unsigned long GetIteration() const
+          {
+            return iteration;
+          }
+
+          /***
+           * Carry on counting from the given iteration, so that a manager made part way through
+           * a run (after restoring a checkpoint or rebalancing) calls its periodic actions on the
+           * same time steps as one that had run from the start
+           * @param iteration
+           */
+          void SetIteration(unsigned long iteration)
+          {
+            this->iteration = iteration;
+          }
+
+          /***
+           * Record the steps, and each concern's actions in them, to the tracer while it is
+           * recording
+           * @param tracer The tracer, or NULL to stop tracing
+           */
+          void SetTracer(StepTracer* tracer)
+          {
+            this->tracer = tracer;
+          }
+
+          /***
+           * Attribute the messages each concern's actions request to that concern
+           * @param statistics The statistics the net counts its messages with, or NULL
+           */
+          void SetCommsStatistics(CommsStatistics* statistics)
+          {
+            commsStatistics = statistics;
+          }
+
         private:
           std::vector<Registry> registry; // one registry for each phase
           std::vector<Concern*> concerns; // can't be a set as must be order-stable
           reporting::Timers *timers;
+          StepTracer *tracer;
+          CommsStatistics *commsStatistics;
           void StartTimer(steps::Step step);
           void StopTimer(steps::Step step);
+          /** Call the action, recording it to the tracer if tracing, and attributing its messages to its concern */
+          void CallAction(Action &action, steps::Step step, Phase phase, bool tracing);
           const bool separate_concerns;
+          unsigned long iteration;
+
+          bool dependencyScheduling;
+          std::map<Concern*, std::vector<Concern*> > dependencies;
+          /** The concerns in an order that puts each after those it depends on */
+          std::vector<Concern*> scheduleOrder;
+          /** For each phase, the concerns that have to wait for its communication */
+          std::vector<std::set<Concern*> > waitingConcerns;
+          bool scheduleStale;
+          /** Work out the scheduleOrder and waitingConcerns, if they're stale */
+          void UpdateSchedule();
 
       };
     }
@@ -0,0 +1,145 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "net/phased/StepTracer.h"
+#include <cstdio>
+#include <fstream>
+#ifdef __GNUG__
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+#include "net/MpiError.h"
+#include "util/utilityFunctions.h"
+
+namespace hemelb
+{
+  namespace net
+  {
+    namespace phased
+    {
+      StepTracer::StepTracer(const MpiCommunicator& comms, unsigned long firstTimeStep,
+                             unsigned long lastTimeStep, size_t capacity) :
+          comms(comms), firstTimeStep(firstTimeStep), lastTimeStep(lastTimeStep), events(capacity),
+              next(0), recorded(0), currentTimeStep(0), recording(false)
+      {
+        HEMELB_MPI_CALL(MPI_Barrier, (comms));
+        origin = util::myClock();
+      }
+
+      double StepTracer::Now() const
+      {
+        return util::myClock() - origin;
+      }
+
+      size_t StepTracer::GetEventCount() const
+      {
+        return recorded < events.size() ?
+          recorded :
+          events.size();
+      }
+
+      size_t StepTracer::GetDroppedCount() const
+      {
+        return recorded - GetEventCount();
+      }
+
+      const StepTracer::Event& StepTracer::GetEvent(size_t index) const
+      {
+        // Until the buffer has wrapped, the oldest event is the first.
+        const size_t oldest = recorded < events.size() ?
+          0 :
+          next;
+        return events[ (oldest + index) % events.size()];
+      }
+
+      const char* StepTracer::GetStepName(steps::Step step)
+      {
+        static const char* names[] = { "BeginAll", "BeginPhase", "Receive", "PreSend", "Send",
+                                       "PreWait", "Wait", "EndPhase", "EndAll" };
+        return names[step - steps::BeginAll];
+      }
+
+      std::string StepTracer::GetConcernName(const char* concernType)
+      {
+#ifdef __GNUG__
+        int status;
+        char* demangled = abi::__cxa_demangle(concernType, NULL, NULL, &status);
+        if (status == 0)
+        {
+          std::string name(demangled);
+          std::free(demangled);
+          return name;
+        }
+#endif
+        return concernType;
+      }
+
+      std::string StepTracer::GetChromeTraceEvents(int rank) const
+      {
+        std::string json;
+        char buffer[512];
+        for (size_t index = 0; index < GetEventCount(); ++index)
+        {
+          const Event& event = GetEvent(index);
+          // Whole steps are named after the step; a concern's actions after the concern, in the
+          // category of the step.
+          const std::string name = event.concernType == NULL ?
+            GetStepName(event.step) :
+            GetConcernName(event.concernType);
+          std::snprintf(buffer,
+                        sizeof(buffer),
+                        "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%u,\"args\":{\"timestep\":%lu}}",
+                        json.empty() ? "" : ",\n",
+                        name.c_str(),
+                        event.concernType == NULL ? "step" : GetStepName(event.step),
+                        event.begin * 1e6,
+                        (event.end - event.begin) * 1e6,
+                        rank,
+                        event.phase,
+                        event.timeStep);
+          json += buffer;
+        }
+        return json;
+      }
+
+      void StepTracer::Write(const std::string& path) const
+      {
+        const std::string local = GetChromeTraceEvents(comms.Rank());
+        const std::vector<char> all = comms.GatherV(std::vector<char>(local.begin(), local.end()),
+                                                     0);
+        const std::vector<int> lengths = comms.Gather(int(local.size()), 0);
+        const std::vector<size_t> dropped = comms.Gather(GetDroppedCount(), 0);
+        if (comms.Rank() != 0)
+        {
+          return;
+        }
+
+        std::ofstream trace(path.c_str());
+        trace << "{\"traceEvents\":[\n";
+        bool first = true;
+        size_t offset = 0;
+        for (int rank = 0; rank < comms.Size(); ++rank)
+        {
+          // Name each process after its rank, noting whether it lost the start of the window.
+          trace << (first ? "" : ",\n") << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << rank
+              << ",\"args\":{\"name\":\"rank " << rank << "\"}}";
+          if (dropped[rank] > 0)
+          {
+            trace << ",\n{\"name\":\"dropped_events\",\"ph\":\"M\",\"pid\":" << rank
+                << ",\"args\":{\"count\":" << dropped[rank] << "}}";
+          }
+          first = false;
+          if (lengths[rank] > 0)
+          {
+            trace << ",\n";
+            trace.write(&all[offset], lengths[rank]);
+            offset += lengths[rank];
+          }
+        }
+        trace << "\n],\"displayTimeUnit\":\"ms\"}\n";
+      }
+    }
+  }
+}
@@ -0,0 +1,156 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_NET_PHASED_STEPTRACER_H
+#define HEMELB_NET_PHASED_STEPTRACER_H
+#include <string>
+#include <typeinfo>
+#include <vector>
+#include "net/MpiCommunicator.h"
+#include "net/phased/Concern.h"
+#include "net/phased/steps.h"
+
+namespace hemelb
+{
+  namespace net
+  {
+    namespace phased
+    {
+      /***
+       * Records when each step of the StepManager, and each concern's action within it, began
+       * and ended, for a window of time steps. Unlike the reporting::Timers, which only keep
+       * totals, this shows on which rank, in which step and in which concern time goes, so
+       * imbalance and waits can be seen step by step.
+       *
+       * Events go into a fixed size ring buffer, so a window too long for it keeps its latest
+       * events. At the end of the run the events of every rank are written to one file in the
+       * Chrome trace event format, which chrome://tracing, Perfetto and similar tools display as
+       * a timeline with a row for each phase of each rank.
+       */
+      class StepTracer
+      {
+        public:
+          /***
+           * One step, or one concern's action within a step, on this rank.
+           */
+          struct Event
+          {
+            unsigned long timeStep;
+            unsigned int phase;
+            steps::Step step;
+            const char* concernType; ///< mangled type name of the concern, NULL for the whole step
+            double begin; ///< seconds since the tracer was constructed
+            double end;
+          };
+
+          static const size_t DefaultCapacity = 1 << 18;
+
+          /***
+           * Construct a tracer; collective over comms, so the ranks share a time origin.
+           * @param comms The communicator the simulation runs on
+           * @param firstTimeStep The first time step to record
+           * @param lastTimeStep The last time step to record
+           * @param capacity The most events to keep on each rank
+           */
+          StepTracer(const MpiCommunicator& comms, unsigned long firstTimeStep,
+                     unsigned long lastTimeStep, size_t capacity = DefaultCapacity);
+
+          /***
+           * Note the time step about to be done, starting or stopping recording.
+           */
+          void BeginTimeStep(unsigned long timeStep)
+          {
+            currentTimeStep = timeStep;
+            recording = timeStep >= firstTimeStep && timeStep <= lastTimeStep;
+          }
+
+          /***
+           * @return Whether events of the current time step are recorded
+           */
+          bool IsRecording() const
+          {
+            return recording;
+          }
+
+          /***
+           * @return The time, on the clock events are recorded against
+           */
+          double Now() const;
+
+          /***
+           * Record an event of the current time step, overwriting the oldest if the buffer is full.
+           * @param concern The concern whose action this was, or NULL for the whole step
+           */
+          void Record(unsigned int phase, steps::Step step, const Concern* concern, double begin,
+                      double end)
+          {
+            Event& event = events[next];
+            event.timeStep = currentTimeStep;
+            event.phase = phase;
+            event.step = step;
+            event.concernType = concern == NULL ?
+              NULL :
+              typeid(*concern).name();
+            event.begin = begin;
+            event.end = end;
+            next = (next + 1) % events.size();
+            ++recorded;
+          }
+
+          /***
+           * @return The number of events kept, at most the capacity
+           */
+          size_t GetEventCount() const;
+
+          /***
+           * @return The number of events overwritten because the buffer was full
+           */
+          size_t GetDroppedCount() const;
+
+          /***
+           * @param index From 0 for the oldest kept event
+           * @return The event
+           */
+          const Event& GetEvent(size_t index) const;
+
+          /***
+           * Write this rank's events as Chrome trace events, separated by commas.
+           * @param rank The process id the events are shown under
+           */
+          std::string GetChromeTraceEvents(int rank) const;
+
+          /***
+           * Gather the events of every rank to rank 0 and write them there as a Chrome trace
+           * file. Collective over the tracer's communicator.
+           * @param path The file to write
+           */
+          void Write(const std::string& path) const;
+
+          /***
+           * @return The name of a step, as shown in the trace
+           */
+          static const char* GetStepName(steps::Step step);
+
+          /***
+           * @param concernType The mangled name of a concern's type
+           * @return The name of the concern's type, as shown in the trace
+           */
+          static std::string GetConcernName(const char* concernType);
+
+        private:
+          const MpiCommunicator& comms;
+          const unsigned long firstTimeStep;
+          const unsigned long lastTimeStep;
+          std::vector<Event> events;
+          size_t next; ///< where the next event goes in the ring buffer
+          size_t recorded; ///< events ever recorded, including those overwritten
+          unsigned long currentTimeStep;
+          bool recording;
+          double origin;
+      };
+    }
+  }
+}
+#endif //ONCE
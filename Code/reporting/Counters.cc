@@ -0,0 +1,148 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "reporting/Counters.h"
+
+#ifdef HEMELB_USE_PERF_COUNTERS
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "log/Logger.h"
+
+namespace hemelb
+{
+  namespace reporting
+  {
+    namespace
+    {
+      const unsigned long long events[numberOfCounters] = { PERF_COUNT_HW_CPU_CYCLES,
+                                                            PERF_COUNT_HW_INSTRUCTIONS,
+                                                            PERF_COUNT_HW_CACHE_MISSES };
+
+      int OpenCounter(unsigned long long event, int groupLeader)
+      {
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.config = event;
+        attributes.disabled = groupLeader < 0;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_GROUP;
+        // This thread, on whichever CPU it runs.
+        return syscall(__NR_perf_event_open, &attributes, 0, -1, groupLeader, 0);
+      }
+    }
+
+    PerfEventCounterPolicy::PerfEventCounterPolicy()
+    {
+      for (unsigned counter = 0; counter < numberOfCounters; ++counter)
+      {
+        descriptors[counter] = -1;
+        start[counter] = 0;
+        counts[counter] = 0.0;
+      }
+    }
+
+    PerfEventCounterPolicy::PerfEventCounterPolicy(const PerfEventCounterPolicy& other)
+    {
+      for (unsigned counter = 0; counter < numberOfCounters; ++counter)
+      {
+        descriptors[counter] = -1;
+        start[counter] = 0;
+        counts[counter] = other.counts[counter];
+      }
+    }
+
+    PerfEventCounterPolicy& PerfEventCounterPolicy::operator=(const PerfEventCounterPolicy& other)
+    {
+      if (this != &other)
+      {
+        CloseCounters();
+        for (unsigned counter = 0; counter < numberOfCounters; ++counter)
+        {
+          counts[counter] = other.counts[counter];
+        }
+      }
+      return *this;
+    }
+
+    PerfEventCounterPolicy::~PerfEventCounterPolicy()
+    {
+      CloseCounters();
+    }
+
+    void PerfEventCounterPolicy::EnableCounters()
+    {
+      if (HasCounts())
+      {
+        return;
+      }
+      for (unsigned counter = 0; counter < numberOfCounters; ++counter)
+      {
+        descriptors[counter] = OpenCounter(events[counter], descriptors[0]);
+        if (descriptors[counter] < 0)
+        {
+          log::Logger::Log<log::Warning, log::Singleton>("Couldn't open hardware performance counter %u, so not counting",
+                                                         counter);
+          CloseCounters();
+          return;
+        }
+      }
+      ioctl(descriptors[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    void PerfEventCounterPolicy::StartCounting()
+    {
+      if (HasCounts())
+      {
+        ReadCounters(start);
+      }
+    }
+
+    void PerfEventCounterPolicy::StopCounting()
+    {
+      unsigned long long now[numberOfCounters];
+      if (HasCounts() && ReadCounters(now))
+      {
+        for (unsigned counter = 0; counter < numberOfCounters; ++counter)
+        {
+          counts[counter] += double(now[counter] - start[counter]);
+        }
+      }
+    }
+
+    bool PerfEventCounterPolicy::ReadCounters(unsigned long long values[numberOfCounters]) const
+    {
+      // With PERF_FORMAT_GROUP, the number of counters then each value, in order of opening.
+      unsigned long long group[1 + numberOfCounters];
+      if (read(descriptors[0], group, sizeof(group)) != (ssize_t) sizeof(group))
+      {
+        return false;
+      }
+      for (unsigned counter = 0; counter < numberOfCounters; ++counter)
+      {
+        values[counter] = group[1 + counter];
+      }
+      return true;
+    }
+
+    void PerfEventCounterPolicy::CloseCounters()
+    {
+      for (unsigned counter = 0; counter < numberOfCounters; ++counter)
+      {
+        if (descriptors[counter] >= 0)
+        {
+          close(descriptors[counter]);
+          descriptors[counter] = -1;
+        }
+      }
+    }
+  }
+}
+#endif
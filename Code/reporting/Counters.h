@@ -0,0 +1,108 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_REPORTING_COUNTERS_H
+#define HEMELB_REPORTING_COUNTERS_H
+
+namespace hemelb
+{
+  namespace reporting
+  {
+    /**
+     * The hardware events counted by a counter policy.
+     */
+    enum CounterName
+    {
+      cycles = 0, //!< Core clock cycles
+      instructions, //!< Instructions retired
+      cacheMisses, //!< Last level cache misses, each a cache line read from memory
+      numberOfCounters
+    };
+
+    /**
+     * Bytes moved from memory by each last level cache miss.
+     */
+    static const double CacheLineBytes = 64.0;
+
+    /**
+     * Counter policy for a timer that counts nothing; the default.
+     */
+    class NoCounterPolicy
+    {
+      public:
+        static const bool Counting = false;
+
+        void EnableCounters()
+        {
+        }
+        bool HasCounts() const
+        {
+          return false;
+        }
+        double GetCount(CounterName counter) const
+        {
+          return 0.0;
+        }
+      protected:
+        void StartCounting()
+        {
+        }
+        void StopCounting()
+        {
+        }
+    };
+
+#ifdef HEMELB_USE_PERF_COUNTERS
+    /**
+     * Counter policy for a timer that counts hardware events with Linux perf_event while the
+     * timer runs. Counters are only opened for the timers they are enabled for, since each
+     * takes file descriptors and, on most processors, there are only a few hardware counters.
+     *
+     * Only the thread that enables the counters is counted. If they can't be opened, e.g.
+     * because /proc/sys/kernel/perf_event_paranoid forbids it, the timer just doesn't count.
+     */
+    class PerfEventCounterPolicy
+    {
+      public:
+        static const bool Counting = true;
+
+        PerfEventCounterPolicy();
+        /**
+         * A copy starts with no counters open.
+         */
+        PerfEventCounterPolicy(const PerfEventCounterPolicy& other);
+        PerfEventCounterPolicy& operator=(const PerfEventCounterPolicy& other);
+        ~PerfEventCounterPolicy();
+
+        /**
+         * Open the counters, for the calling thread.
+         */
+        void EnableCounters();
+        bool HasCounts() const
+        {
+          return descriptors[0] >= 0;
+        }
+        double GetCount(CounterName counter) const
+        {
+          return counts[counter];
+        }
+      protected:
+        void StartCounting();
+        void StopCounting();
+      private:
+        bool ReadCounters(unsigned long long values[numberOfCounters]) const;
+        void CloseCounters();
+
+        int descriptors[numberOfCounters]; //! The counters, the first leading the group
+        unsigned long long start[numberOfCounters]; //! The counts when the timer was last started
+        double counts[numberOfCounters]; //! Running totals
+    };
+    typedef PerfEventCounterPolicy HemeLBCounterPolicy;
+#else
+    typedef NoCounterPolicy HemeLBCounterPolicy;
+#endif
+  }
+}
+#endif // HEMELB_REPORTING_COUNTERS_H
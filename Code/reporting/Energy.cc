@@ -0,0 +1,208 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "reporting/Energy.h"
+
+#ifdef HEMELB_USE_ENERGY_COUNTERS
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "log/Logger.h"
+
+namespace hemelb
+{
+  namespace reporting
+  {
+    namespace
+    {
+      const char* const PowercapDirectory = "/sys/class/powercap/";
+
+      /**
+       * The node's RAPL counters, each read into a running total of joules that carries on
+       * past the counter wrapping round.
+       */
+      class RaplCounters
+      {
+        public:
+          RaplCounters() :
+              opened(false)
+          {
+          }
+
+          ~RaplCounters()
+          {
+            for (size_t zone = 0; zone < zones.size(); ++zone)
+            {
+              close(zones[zone].descriptor);
+            }
+          }
+
+          /**
+           * Open the package and DRAM zones, the first time only.
+           * @return Whether there are any to read
+           */
+          bool Open()
+          {
+            if (opened)
+            {
+              return !zones.empty();
+            }
+            opened = true;
+
+            DIR* directory = opendir(PowercapDirectory);
+            if (directory == NULL)
+            {
+              log::Logger::Log<log::Warning, log::Singleton>("No %s, so not measuring energy",
+                                                             PowercapDirectory);
+              return false;
+            }
+            // Packages are intel-rapl:N and their DRAM intel-rapl:N:M, named in the zone's name
+            // file; the package's other sub-zones are parts of it, so not counted again.
+            for (dirent* entry = readdir(directory); entry != NULL; entry = readdir(directory))
+            {
+              const std::string zoneName(entry->d_name);
+              if (zoneName.compare(0, 11, "intel-rapl:") != 0)
+              {
+                continue;
+              }
+              const std::string path = PowercapDirectory + zoneName + "/";
+              std::string name;
+              std::ifstream(path + "name") >> name;
+              Zone zone;
+              if (name.compare(0, 7, "package") == 0)
+              {
+                zone.domain = packageEnergy;
+              }
+              else if (name == "dram")
+              {
+                zone.domain = dramEnergy;
+              }
+              else
+              {
+                continue;
+              }
+              zone.range = 0;
+              std::ifstream(path + "max_energy_range_uj") >> zone.range;
+              zone.descriptor = open( (path + "energy_uj").c_str(), O_RDONLY);
+              if (zone.descriptor < 0 || !ReadMicrojoules(zone.descriptor, zone.last))
+              {
+                log::Logger::Log<log::Warning, log::Singleton>("Couldn't read %senergy_uj, so not measuring energy",
+                                                               path.c_str());
+                if (zone.descriptor >= 0)
+                {
+                  close(zone.descriptor);
+                }
+                continue;
+              }
+              zone.total = 0.0;
+              zones.push_back(zone);
+            }
+            closedir(directory);
+            return !zones.empty();
+          }
+
+          /**
+           * Read the running totals.
+           * @param joules Of each domain, summed over its zones
+           */
+          void Read(double joules[numberOfEnergyDomains])
+          {
+            for (unsigned domain = 0; domain < numberOfEnergyDomains; ++domain)
+            {
+              joules[domain] = 0.0;
+            }
+            for (size_t zone = 0; zone < zones.size(); ++zone)
+            {
+              Zone& counter = zones[zone];
+              unsigned long long now;
+              if (ReadMicrojoules(counter.descriptor, now))
+              {
+                const unsigned long long used = now >= counter.last ?
+                  now - counter.last :
+                  now + counter.range - counter.last;
+                counter.total += 1e-6 * used;
+                counter.last = now;
+              }
+              joules[counter.domain] += counter.total;
+            }
+          }
+
+        private:
+          struct Zone
+          {
+              EnergyDomain domain;
+              int descriptor;
+              unsigned long long range; //! Microjoules at which the counter wraps round
+              unsigned long long last; //! Microjoules at the last read
+              double total; //! Joules since the counter was opened
+          };
+
+          static bool ReadMicrojoules(int descriptor, unsigned long long& microjoules)
+          {
+            char text[32];
+            const ssize_t length = pread(descriptor, text, sizeof(text) - 1, 0);
+            if (length <= 0)
+            {
+              return false;
+            }
+            text[length] = '\0';
+            microjoules = std::strtoull(text, NULL, 10);
+            return true;
+          }
+
+          bool opened;
+          std::vector<Zone> zones;
+      };
+
+      RaplCounters& Counters()
+      {
+        static RaplCounters counters;
+        return counters;
+      }
+    }
+
+    RaplEnergyPolicy::RaplEnergyPolicy() :
+        enabled(false)
+    {
+      for (unsigned domain = 0; domain < numberOfEnergyDomains; ++domain)
+      {
+        start[domain] = 0.0;
+        energy[domain] = 0.0;
+      }
+    }
+
+    void RaplEnergyPolicy::EnableMeters()
+    {
+      enabled = Counters().Open();
+    }
+
+    void RaplEnergyPolicy::StartMetering()
+    {
+      if (enabled)
+      {
+        Counters().Read(start);
+      }
+    }
+
+    void RaplEnergyPolicy::StopMetering()
+    {
+      if (enabled)
+      {
+        double now[numberOfEnergyDomains];
+        Counters().Read(now);
+        for (unsigned domain = 0; domain < numberOfEnergyDomains; ++domain)
+        {
+          energy[domain] += now[domain] - start[domain];
+        }
+      }
+    }
+  }
+}
+#endif
@@ -0,0 +1,100 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_REPORTING_ENERGY_H
+#define HEMELB_REPORTING_ENERGY_H
+
+namespace hemelb
+{
+  namespace reporting
+  {
+    /**
+     * The parts of a node whose energy an energy policy measures.
+     */
+    enum EnergyDomain
+    {
+      packageEnergy = 0, //!< The processor packages: cores, caches and memory controllers
+      dramEnergy, //!< The memory attached to them
+      numberOfEnergyDomains
+    };
+
+    /**
+     * Energy policy for a timer that measures nothing; the default.
+     */
+    class NoEnergyPolicy
+    {
+      public:
+        static const bool Measuring = false;
+
+        void EnableMeters()
+        {
+        }
+        bool HasEnergy() const
+        {
+          return false;
+        }
+        double GetEnergy(EnergyDomain domain) const
+        {
+          return 0.0;
+        }
+      protected:
+        void StartMetering()
+        {
+        }
+        void StopMetering()
+        {
+        }
+    };
+
+#ifdef HEMELB_USE_ENERGY_COUNTERS
+    /**
+     * Energy policy for a timer that measures the energy the node uses while the timer runs,
+     * from the RAPL counters Linux exposes under /sys/class/powercap, summed over the packages.
+     *
+     * The counters are of the whole node, so only one process per node should enable the
+     * meters. The counters wrap round every few minutes at full power; the meters are read
+     * through one set of counters per process that keeps running totals, so as long as a
+     * metered timer is started or stopped more often than that, e.g. the LB calculation's every
+     * step, a timer that runs for longer still gets the right energy. If the counters can't be
+     * read, e.g. because only root may read energy_uj, the timer just doesn't measure.
+     */
+    class RaplEnergyPolicy
+    {
+      public:
+        static const bool Measuring = true;
+
+        RaplEnergyPolicy();
+
+        /**
+         * Open the node's counters, if no timer has yet, and measure with them.
+         */
+        void EnableMeters();
+        bool HasEnergy() const
+        {
+          return enabled;
+        }
+        /**
+         * @param domain
+         * @return The joules used while the timer ran
+         */
+        double GetEnergy(EnergyDomain domain) const
+        {
+          return energy[domain];
+        }
+      protected:
+        void StartMetering();
+        void StopMetering();
+      private:
+        bool enabled;
+        double start[numberOfEnergyDomains]; //! The running totals when the timer was last started
+        double energy[numberOfEnergyDomains]; //! Joules so far
+    };
+    typedef RaplEnergyPolicy HemeLBEnergyPolicy;
+#else
+    typedef NoEnergyPolicy HemeLBEnergyPolicy;
+#endif
+  }
+}
+#endif // HEMELB_REPORTING_ENERGY_H
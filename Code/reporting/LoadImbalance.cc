@@ -0,0 +1,226 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "reporting/LoadImbalance.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+
+namespace hemelb
+{
+  namespace reporting
+  {
+    const char* LoadImbalance::quantityNames[LoadImbalance::numberOfQuantities] = { "sites", "work",
+                                                                                    "collision",
+                                                                                    "mpi_wait",
+                                                                                    "extraction",
+                                                                                    "lb" };
+
+    namespace
+    {
+      /**
+       * The nearest-rank percentile of sorted values.
+       */
+      double Percentile(const std::vector<double>& sorted, double fraction)
+      {
+        size_t rank = (size_t) std::ceil(fraction * sorted.size());
+        return sorted[rank == 0 ?
+          0 :
+          rank - 1];
+      }
+
+      bool SlowerFirst(const std::pair<double, proc_t>& left, const std::pair<double, proc_t>& right)
+      {
+        return left.first > right.first || (left.first == right.first && left.second < right.second);
+      }
+    }
+
+    LoadImbalance::LoadImbalance(const net::IOCommunicator& comms, unsigned slowRanksToReport) :
+        comms(comms), slowRanksToReport(slowRanksToReport)
+    {
+    }
+
+    void LoadImbalance::Reduce(const std::vector<site_t>& sitesPerType,
+                               const std::vector<int>& weights, const Timers& timings,
+                               const std::string& path)
+    {
+      double localQuantities[numberOfQuantities] = { 0.0 };
+      for (unsigned type = 0; type < COLLISION_TYPES; ++type)
+      {
+        localQuantities[sites] += sitesPerType[type];
+        localQuantities[work] += double(sitesPerType[type]) * weights[type];
+      }
+      localQuantities[collision] = timings[Timers::lb_calc].Get();
+      localQuantities[mpiWait] = timings[Timers::mpiWait].Get();
+      localQuantities[extraction] = timings[Timers::extractionWriting].Get();
+      localQuantities[lb] = timings[Timers::lb].Get();
+
+      const std::vector<site_t> allSites = comms.GatherV(sitesPerType, comms.GetIORank());
+      const std::vector<double> allQuantities =
+          comms.GatherV(std::vector<double>(localQuantities, localQuantities + numberOfQuantities),
+                        comms.GetIORank());
+      if (!comms.OnIORank())
+      {
+        return;
+      }
+
+      const proc_t ranks = comms.Size();
+      distributions.clear();
+      for (unsigned quantity = 0; quantity < numberOfQuantities; ++quantity)
+      {
+        std::vector<double> values(ranks);
+        for (proc_t rank = 0; rank < ranks; ++rank)
+        {
+          values[rank] = allQuantities[rank * numberOfQuantities + quantity];
+        }
+        distributions.push_back(Summarise(values));
+      }
+      slowRanks = FindSlowRanks(allSites, allQuantities, slowRanksToReport);
+
+      if (path.empty())
+      {
+        return;
+      }
+      FILE* csv = std::fopen(path.c_str(), "w");
+      if (csv == NULL)
+      {
+        return;
+      }
+      std::fprintf(csv, "rank");
+      for (unsigned type = 0; type < COLLISION_TYPES; ++type)
+      {
+        std::fprintf(csv, ",sites_type_%u", type);
+      }
+      for (unsigned quantity = 0; quantity < numberOfQuantities; ++quantity)
+      {
+        std::fprintf(csv, ",%s", quantityNames[quantity]);
+      }
+      std::fprintf(csv, "\n");
+      for (proc_t rank = 0; rank < ranks; ++rank)
+      {
+        std::fprintf(csv, "%d", rank);
+        for (unsigned type = 0; type < COLLISION_TYPES; ++type)
+        {
+          std::fprintf(csv, ",%ld", (long) allSites[rank * COLLISION_TYPES + type]);
+        }
+        for (unsigned quantity = 0; quantity < numberOfQuantities; ++quantity)
+        {
+          std::fprintf(csv, ",%.6g", allQuantities[rank * numberOfQuantities + quantity]);
+        }
+        std::fprintf(csv, "\n");
+      }
+      std::fclose(csv);
+    }
+
+    LoadImbalance::Distribution LoadImbalance::Summarise(const std::vector<double>& values)
+    {
+      std::vector<double> sorted(values);
+      std::sort(sorted.begin(), sorted.end());
+      double total = 0.0;
+      for (std::vector<double>::const_iterator value = sorted.begin(); value != sorted.end(); ++value)
+      {
+        total += *value;
+      }
+
+      Distribution distribution;
+      distribution.min = sorted.front();
+      distribution.p50 = Percentile(sorted, 0.5);
+      distribution.p90 = Percentile(sorted, 0.9);
+      distribution.p99 = Percentile(sorted, 0.99);
+      distribution.max = sorted.back();
+      distribution.mean = total / sorted.size();
+      distribution.imbalance = distribution.mean > 0.0 ?
+        distribution.max / distribution.mean :
+        1.0;
+      return distribution;
+    }
+
+    std::vector<LoadImbalance::SlowRank> LoadImbalance::FindSlowRanks(const std::vector<site_t>& sitesPerType,
+                                                                      const std::vector<double>& quantities,
+                                                                      unsigned count)
+    {
+      const proc_t ranks = quantities.size() / numberOfQuantities;
+      std::vector<std::pair<double, proc_t> > byTime;
+      std::vector<double> timePerWork;
+      double totalWork = 0.0;
+      for (proc_t rank = 0; rank < ranks; ++rank)
+      {
+        const double* rankQuantities = &quantities[rank * numberOfQuantities];
+        byTime.push_back(std::make_pair(rankQuantities[collision], rank));
+        totalWork += rankQuantities[work];
+        if (rankQuantities[work] > 0.0)
+        {
+          timePerWork.push_back(rankQuantities[collision] / rankQuantities[work]);
+        }
+      }
+      std::sort(byTime.begin(), byTime.end(), SlowerFirst);
+      std::sort(timePerWork.begin(), timePerWork.end());
+      const double meanWork = totalWork / ranks;
+      const double medianTimePerWork = timePerWork.empty() ?
+        0.0 :
+        Percentile(timePerWork, 0.5);
+
+      std::vector<SlowRank> slowest;
+      for (proc_t index = 0; index < ranks && index < (proc_t) count; ++index)
+      {
+        SlowRank slow;
+        slow.rank = byTime[index].second;
+        const double* rankQuantities = &quantities[slow.rank * numberOfQuantities];
+        slow.collisionTime = rankQuantities[collision];
+        slow.mpiWaitTime = rankQuantities[mpiWait];
+        slow.sitesPerType.assign(sitesPerType.begin() + slow.rank * COLLISION_TYPES,
+                                 sitesPerType.begin() + (slow.rank + 1) * COLLISION_TYPES);
+        slow.workRatio = meanWork > 0.0 ?
+          rankQuantities[work] / meanWork :
+          1.0;
+        slow.speedRatio = rankQuantities[work] > 0.0 && medianTimePerWork > 0.0 ?
+          (slow.collisionTime / rankQuantities[work]) / medianTimePerWork :
+          1.0;
+        slow.slowNode = slow.speedRatio > std::max(slow.workRatio, 1.0);
+        slowest.push_back(slow);
+      }
+      return slowest;
+    }
+
+    void LoadImbalance::Report(ctemplate::TemplateDictionary& dictionary)
+    {
+      for (unsigned quantity = 0; quantity < distributions.size(); ++quantity)
+      {
+        const Distribution& distribution = distributions[quantity];
+        ctemplate::TemplateDictionary *section = dictionary.AddSectionDictionary("IMBALANCE");
+        section->SetValue("NAME", quantityNames[quantity]);
+        section->SetFormattedValue("MIN", "%.3g", distribution.min);
+        section->SetFormattedValue("P50", "%.3g", distribution.p50);
+        section->SetFormattedValue("P90", "%.3g", distribution.p90);
+        section->SetFormattedValue("P99", "%.3g", distribution.p99);
+        section->SetFormattedValue("MAX", "%.3g", distribution.max);
+        section->SetFormattedValue("MEAN", "%.3g", distribution.mean);
+        section->SetFormattedValue("FACTOR", "%.3f", distribution.imbalance);
+      }
+      for (std::vector<SlowRank>::const_iterator slow = slowRanks.begin(); slow != slowRanks.end();
+          ++slow)
+      {
+        ctemplate::TemplateDictionary *section = dictionary.AddSectionDictionary("SLOW_RANK");
+        section->SetIntValue("RANK", slow->rank);
+        section->SetFormattedValue("COLLISION", "%.3g", slow->collisionTime);
+        section->SetFormattedValue("MPI_WAIT", "%.3g", slow->mpiWaitTime);
+        std::ostringstream composition;
+        for (unsigned type = 0; type < slow->sitesPerType.size(); ++type)
+        {
+          composition << (type == 0 ?
+            "" :
+            " ") << slow->sitesPerType[type];
+        }
+        section->SetValue("SITES", composition.str());
+        section->SetFormattedValue("WORK_RATIO", "%.3f", slow->workRatio);
+        section->SetFormattedValue("SPEED_RATIO", "%.3f", slow->speedRatio);
+        section->SetValue("CAUSE", slow->slowNode ?
+          "slow_node" :
+          "decomposition");
+      }
+    }
+  }
+}
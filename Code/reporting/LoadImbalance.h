@@ -0,0 +1,137 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_REPORTING_LOADIMBALANCE_H
+#define HEMELB_REPORTING_LOADIMBALANCE_H
+
+#include <string>
+#include <vector>
+#include "constants.h"
+#include "net/IOCommunicator.h"
+#include "reporting/Reportable.h"
+#include "reporting/Timers.h"
+
+namespace hemelb
+{
+  namespace reporting
+  {
+    /**
+     * Shows how evenly the work of a run was spread over the ranks. The Timers only keep the
+     * min, mean and max of each timer; this keeps every rank's sites of each collision type and
+     * its time in the quantities that depend on the decomposition, writes them as a CSV file
+     * with a line per rank, and reports percentiles and an imbalance factor (max over mean) of
+     * each.
+     *
+     * It also reports the slowest ranks by collision time, with their sites. Each rank's work is
+     * its sites weighted by the decomposition's site weights: a slow rank with much more work
+     * than the mean was given too much by the decomposition, whereas one that took much longer
+     * than the median for its work is slow itself.
+     */
+    class LoadImbalance : public Reportable
+    {
+      public:
+        /**
+         * The quantities summarised over the ranks, in the order of the CSV columns after the
+         * sites of each collision type.
+         */
+        enum Quantity
+        {
+          sites = 0,
+          work,
+          collision,
+          mpiWait,
+          extraction,
+          lb,
+          numberOfQuantities
+        };
+
+        static const char* quantityNames[numberOfQuantities];
+
+        /**
+         * Summary of a quantity over the ranks.
+         */
+        struct Distribution
+        {
+            double min;
+            double p50;
+            double p90;
+            double p99;
+            double max;
+            double mean;
+            double imbalance; ///< max / mean, 1 when perfectly balanced
+        };
+
+        /**
+         * One of the slowest ranks.
+         */
+        struct SlowRank
+        {
+            proc_t rank;
+            double collisionTime;
+            double mpiWaitTime;
+            std::vector<site_t> sitesPerType;
+            double workRatio; ///< this rank's work over the mean
+            double speedRatio; ///< this rank's collision time per work over the median
+            bool slowNode; ///< whether it is slower than the median, and more than it has extra work
+        };
+
+        /**
+         * @param comms
+         * @param slowRanksToReport How many of the slowest ranks to report
+         */
+        LoadImbalance(const net::IOCommunicator& comms, unsigned slowRanksToReport = 5);
+
+        /**
+         * Gather every rank's sites and times to the I/O rank, which writes them to a CSV file
+         * and keeps the summary to report. Collective; call after the timers have stopped.
+         * @param sitesPerType This rank's sites of each collision type
+         * @param weights The weight of a site of each collision type
+         * @param timings This rank's timers
+         * @param path The CSV file to write, or empty not to write one
+         */
+        void Reduce(const std::vector<site_t>& sitesPerType, const std::vector<int>& weights,
+                    const Timers& timings, const std::string& path);
+
+        /**
+         * Summarise the values of a quantity, one for each rank.
+         * @param values Not empty
+         * @return
+         */
+        static Distribution Summarise(const std::vector<double>& values);
+
+        /**
+         * Find the slowest ranks by collision time and say why each is slow.
+         * @param sitesPerType The sites of each collision type, COLLISION_TYPES for each rank
+         * @param quantities The quantities of each rank, numberOfQuantities for each rank
+         * @param count At most how many ranks to return
+         * @return The slowest ranks, slowest first
+         */
+        static std::vector<SlowRank> FindSlowRanks(const std::vector<site_t>& sitesPerType,
+                                                   const std::vector<double>& quantities,
+                                                   unsigned count);
+
+        const std::vector<Distribution>& GetDistributions() const
+        {
+          return distributions;
+        }
+
+        const std::vector<SlowRank>& GetSlowRanks() const
+        {
+          return slowRanks;
+        }
+
+        void Report(ctemplate::TemplateDictionary& dictionary);
+
+      private:
+        const net::IOCommunicator& comms;
+        const unsigned slowRanksToReport;
+        /** Set on the I/O rank by Reduce */
+        std::vector<Distribution> distributions;
+        std::vector<SlowRank> slowRanks;
+    };
+  }
+}
+
+#endif /* HEMELB_REPORTING_LOADIMBALANCE_H */
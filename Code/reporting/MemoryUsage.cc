@@ -0,0 +1,97 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "reporting/MemoryUsage.h"
+#include "reporting/Performance.h"
+
+namespace hemelb
+{
+  namespace reporting
+  {
+    MemoryUsage::MemoryUsage(const net::IOCommunicator& comms) :
+        comms(comms)
+    {
+    }
+
+    void MemoryUsage::RecordSubsystem(const std::string& subsystem, size_t bytes)
+    {
+      Find(subsystems, subsystem).total += double(bytes);
+    }
+
+    void MemoryUsage::RecordStage(const std::string& stage)
+    {
+      // The peak only grows, so a stage done again (e.g. on rebalancing) keeps its latest.
+      Find(stages, stage).total = Performance::GetPeakMemory();
+    }
+
+    MemoryUsage::Record& MemoryUsage::Find(std::vector<Record>& records, const std::string& name)
+    {
+      for (std::vector<Record>::iterator record = records.begin(); record != records.end();
+          ++record)
+      {
+        if (record->name == name)
+        {
+          return *record;
+        }
+      }
+      Record record = { name, 0.0, 0.0, 0.0, 0.0 };
+      records.push_back(record);
+      return records.back();
+    }
+
+    void MemoryUsage::Reduce()
+    {
+      Reduce(subsystems);
+      Reduce(stages);
+    }
+
+    void MemoryUsage::Reduce(std::vector<Record>& records) const
+    {
+      std::vector<double> local(records.size());
+      for (size_t record = 0; record < records.size(); ++record)
+      {
+        local[record] = records[record].total;
+      }
+      const std::vector<double> mins = comms.Reduce(local, MPI_MIN, comms.GetIORank());
+      const std::vector<double> maxes = comms.Reduce(local, MPI_MAX, comms.GetIORank());
+      const std::vector<double> totals = comms.Reduce(local, MPI_SUM, comms.GetIORank());
+      if (!comms.OnIORank())
+      {
+        return;
+      }
+
+      for (size_t record = 0; record < records.size(); ++record)
+      {
+        records[record].min = mins[record];
+        records[record].max = maxes[record];
+        records[record].total = totals[record];
+        records[record].mean = totals[record] / comms.Size();
+      }
+    }
+
+    void MemoryUsage::Report(ctemplate::TemplateDictionary& dictionary)
+    {
+      for (std::vector<Record>::const_iterator record = subsystems.begin();
+          record != subsystems.end(); ++record)
+      {
+        ctemplate::TemplateDictionary *subsystem = dictionary.AddSectionDictionary("MEMORY_SUBSYSTEM");
+        subsystem->SetValue("NAME", record->name);
+        subsystem->SetFormattedValue("MIN", "%.0f", record->min);
+        subsystem->SetFormattedValue("MEAN", "%.0f", record->mean);
+        subsystem->SetFormattedValue("MAX", "%.0f", record->max);
+        subsystem->SetFormattedValue("TOTAL", "%.0f", record->total);
+      }
+      for (std::vector<Record>::const_iterator record = stages.begin(); record != stages.end();
+          ++record)
+      {
+        ctemplate::TemplateDictionary *stage = dictionary.AddSectionDictionary("MEMORY_STAGE");
+        stage->SetValue("NAME", record->name);
+        stage->SetFormattedValue("MIN", "%.0f", record->min);
+        stage->SetFormattedValue("MEAN", "%.0f", record->mean);
+        stage->SetFormattedValue("MAX", "%.0f", record->max);
+      }
+    }
+  }
+}
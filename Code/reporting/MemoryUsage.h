@@ -0,0 +1,96 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_REPORTING_MEMORYUSAGE_H
+#define HEMELB_REPORTING_MEMORYUSAGE_H
+
+#include <string>
+#include <vector>
+#include "net/IOCommunicator.h"
+#include "reporting/Reportable.h"
+
+namespace hemelb
+{
+  namespace reporting
+  {
+    /**
+     * Where the memory of a run goes. The big data structures record the bytes they have
+     * allocated, by subsystem, and the initialisation records the peak resident set of the
+     * process after each of its stages, so that the stage whose temporaries set the high-water
+     * mark shows up too. Each is reported as its min, mean and max over the ranks, and its total.
+     *
+     * Every rank must record the same subsystems and stages, in the same order.
+     */
+    class MemoryUsage : public Reportable
+    {
+      public:
+        /**
+         * The summary over the ranks of one recorded quantity.
+         */
+        struct Record
+        {
+            std::string name;
+            double min;
+            double mean;
+            double max;
+            double total;
+        };
+
+        MemoryUsage(const net::IOCommunicator& comms);
+
+        /**
+         * Record the bytes allocated by a subsystem on this rank, adding them to any recorded
+         * for it already.
+         * @param subsystem
+         * @param bytes
+         */
+        void RecordSubsystem(const std::string& subsystem, size_t bytes);
+
+        /**
+         * Record the peak resident set of this process at the end of an initialisation stage.
+         * @param stage
+         */
+        void RecordStage(const std::string& stage);
+
+        /**
+         * Summarise every rank's records on the I/O rank. Collective.
+         */
+        void Reduce();
+
+        /**
+         * @return The summaries of the subsystems' bytes, set on the I/O rank by Reduce
+         */
+        const std::vector<Record>& GetSubsystems() const
+        {
+          return subsystems;
+        }
+
+        /**
+         * @return The summaries of the stages' peak resident set in kilobytes, set on the I/O
+         * rank by Reduce
+         */
+        const std::vector<Record>& GetStages() const
+        {
+          return stages;
+        }
+
+        void Report(ctemplate::TemplateDictionary& dictionary);
+
+      private:
+        /**
+         * @return The record of the given name, added if there isn't one yet
+         */
+        static Record& Find(std::vector<Record>& records, const std::string& name);
+        void Reduce(std::vector<Record>& records) const;
+
+        const net::IOCommunicator& comms;
+        /** This rank's value in the total of each, until Reduce */
+        std::vector<Record> subsystems;
+        std::vector<Record> stages;
+    };
+  }
+}
+
+#endif /* HEMELB_REPORTING_MEMORYUSAGE_H */
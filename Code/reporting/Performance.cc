@@ -0,0 +1,85 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "reporting/Performance.h"
+#ifdef HAVE_RUSAGE
+#include <sys/resource.h>
+#endif
+#include "net/MpiFile.h"
+
+namespace hemelb
+{
+  namespace reporting
+  {
+    Performance::Performance(const net::IOCommunicator& comms) :
+        comms(comms), mlups(0.0), lbMlups(0.0), sitesPerSecondPerRank(0.0), bytesWritten(0.0),
+            writeRate(0.0), maxMemory(0.0), meanMemory(0.0), simulationJoules(0.0),
+            joulesPerMlu(0.0)
+    {
+    }
+
+    double Performance::GetPeakMemory()
+    {
+#ifdef HAVE_RUSAGE
+      rusage usage;
+      getrusage(RUSAGE_SELF, &usage);
+      return usage.ru_maxrss;
+#else
+      return 0.0;
+#endif
+    }
+
+    void Performance::Reduce(site_t fluidSites, unsigned long steps, const Timers& timings)
+    {
+      const double localMemory = GetPeakMemory();
+      bytesWritten = comms.Reduce(double(net::MpiFile::GetBytesWritten()), MPI_SUM, comms.GetIORank());
+      maxMemory = comms.Reduce(localMemory, MPI_MAX, comms.GetIORank());
+      meanMemory = comms.Reduce(localMemory, MPI_SUM, comms.GetIORank()) / comms.Size();
+      if (!comms.OnIORank())
+      {
+        return;
+      }
+
+      const double updates = double(fluidSites) * steps;
+      const double simulationTime = timings.Maxes()[Timers::simulation];
+      const double lbTime = timings.Maxes()[Timers::lb_calc];
+      mlups = simulationTime > 0.0 ?
+        updates / simulationTime / 1e6 :
+        0.0;
+      lbMlups = lbTime > 0.0 ?
+        updates / lbTime / 1e6 :
+        0.0;
+      sitesPerSecondPerRank = mlups * 1e6 / comms.Size();
+
+      // Writes are collective, so the slowest rank's time is how long they held the run up.
+      const double writeTime = timings.Maxes()[Timers::extractionWriting]
+          + timings.Maxes()[Timers::checkpoint];
+      writeRate = writeTime > 0.0 ?
+        bytesWritten / writeTime :
+        0.0;
+
+      // Summed over the nodes that measured it, which are all of them if any are.
+      simulationJoules = timings.EnergyTotal(Timers::simulation, packageEnergy)
+          + timings.EnergyTotal(Timers::simulation, dramEnergy);
+      joulesPerMlu = updates > 0.0 ?
+        simulationJoules / (updates / 1e6) :
+        0.0;
+    }
+
+    void Performance::Report(ctemplate::TemplateDictionary& dictionary)
+    {
+      ctemplate::TemplateDictionary *performance = dictionary.AddSectionDictionary("PERFORMANCE");
+      performance->SetFormattedValue("MLUPS", "%.6g", mlups);
+      performance->SetFormattedValue("LB_MLUPS", "%.6g", lbMlups);
+      performance->SetFormattedValue("SITES_PER_SECOND_PER_RANK", "%.6g", sitesPerSecondPerRank);
+      performance->SetFormattedValue("BYTES_WRITTEN", "%.0f", bytesWritten);
+      performance->SetFormattedValue("WRITE_BYTES_PER_SECOND", "%.6g", writeRate);
+      performance->SetFormattedValue("MAX_MEMORY_KB", "%.0f", maxMemory);
+      performance->SetFormattedValue("MEAN_MEMORY_KB", "%.0f", meanMemory);
+      performance->SetFormattedValue("ENERGY_JOULES", "%.6g", simulationJoules);
+      performance->SetFormattedValue("JOULES_PER_MLU", "%.6g", joulesPerMlu);
+    }
+  }
+}
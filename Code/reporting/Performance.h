@@ -0,0 +1,94 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_REPORTING_PERFORMANCE_H
+#define HEMELB_REPORTING_PERFORMANCE_H
+
+#include "constants.h"
+#include "net/IOCommunicator.h"
+#include "reporting/Reportable.h"
+#include "reporting/Timers.h"
+
+namespace hemelb
+{
+  namespace reporting
+  {
+    /**
+     * Throughput derived from the timers and the size of the problem, the bytes written, the
+     * memory used and the energy to solution, so runs on different geometries and core counts
+     * can be compared.
+     */
+    class Performance : public Reportable
+    {
+      public:
+        Performance(const net::IOCommunicator& comms);
+
+        /**
+         * Work out the throughput of the run and gather the bytes written and memory used by
+         * every process to the I/O rank. Collective; call after the timers have been reduced.
+         * @param fluidSites The fluid sites of the whole geometry
+         * @param steps The time steps done
+         * @param timings The timers, reduced
+         */
+        void Reduce(site_t fluidSites, unsigned long steps, const Timers& timings);
+
+        /**
+         * @return Millions of lattice site updates per second of the whole simulation
+         */
+        double GetMlups() const
+        {
+          return mlups;
+        }
+
+        /**
+         * @return Millions of lattice site updates per second of the slowest rank's LB calculation
+         */
+        double GetLbMlups() const
+        {
+          return lbMlups;
+        }
+
+        /**
+         * @return Joules the nodes used per million lattice site updates over the simulation, or
+         * 0 if the energy wasn't measured
+         */
+        double GetJoulesPerMlu() const
+        {
+          return joulesPerMlu;
+        }
+
+        /**
+         * @return The largest resident set of any process, in kilobytes, or 0 if unknown
+         */
+        double GetMaxMemory() const
+        {
+          return maxMemory;
+        }
+
+        /**
+         * The largest resident set this process has had.
+         * @return In kilobytes, or 0 if unknown
+         */
+        static double GetPeakMemory();
+
+        void Report(ctemplate::TemplateDictionary& dictionary);
+
+      private:
+        const net::IOCommunicator& comms;
+        /** Set on the I/O rank by Reduce */
+        double mlups;
+        double lbMlups;
+        double sitesPerSecondPerRank;
+        double bytesWritten;
+        double writeRate;
+        double maxMemory;
+        double meanMemory;
+        double simulationJoules;
+        double joulesPerMlu;
+    };
+  }
+}
+
+#endif /* HEMELB_REPORTING_PERFORMANCE_H */
@@ -0,0 +1,37 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "reporting/Policies.h"
+
+namespace hemelb
+{
+  namespace reporting
+  {
+    // A few milliseconds at start up gets the tick length to well within a part in a thousand.
+    const double CycleCounterClockPolicy::secondsPerTick = CycleCounterClockPolicy::Calibrate(0.01);
+
+    double CycleCounterClockPolicy::Calibrate(double seconds)
+    {
+#ifdef HEMELB_HAVE_RDTSC
+      const unsigned long long wait = (unsigned long long) (seconds * 1e9);
+      const unsigned long long startNs = MonotonicNanoseconds();
+      const unsigned long long startTicks = __rdtsc();
+      unsigned long long endNs;
+      do
+      {
+        endNs = MonotonicNanoseconds();
+      }
+      while (endNs - startNs < wait);
+      const unsigned long long endTicks = __rdtsc();
+
+      return endTicks > startTicks ?
+        double(endNs - startNs) * 1e-9 / double(endTicks - startTicks) :
+        1e-9;
+#else
+      return 1e-9;
+#endif
+    }
+  }
+}
@@ -0,0 +1,100 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "reporting/Prediction.h"
+
+namespace hemelb
+{
+  namespace reporting
+  {
+    const char* Prediction::quantityNames[Prediction::numberOfQuantities] = { "sites", "work",
+                                                                              "step_time",
+                                                                              "memory" };
+
+    Prediction::Prediction(const net::IOCommunicator& comms) :
+        comms(comms), calibrated(false), totalSites(0.0)
+    {
+    }
+
+    double Prediction::StepTime(const std::vector<site_t>& sitesPerType,
+                                const std::vector<int>& weights, double bulkSiteTime)
+    {
+      // The weights are relative to a bulk site's.
+      double bulkSites = 0.0;
+      for (unsigned type = 0; type < COLLISION_TYPES; ++type)
+      {
+        bulkSites += double(sitesPerType[type]) * weights[type] / weights[0];
+      }
+      return bulkSites * bulkSiteTime;
+    }
+
+    void Prediction::Reduce(const std::vector<site_t>& sitesPerType,
+                            const std::vector<int>& weights, double bulkSiteTime, double bytes)
+    {
+      calibrated = bulkSiteTime > 0.0;
+
+      double localQuantities[numberOfQuantities] = { 0.0 };
+      for (unsigned type = 0; type < COLLISION_TYPES; ++type)
+      {
+        localQuantities[sites] += sitesPerType[type];
+        localQuantities[work] += double(sitesPerType[type]) * weights[type];
+      }
+      localQuantities[stepTime] = StepTime(sitesPerType, weights, bulkSiteTime);
+      localQuantities[memory] = bytes;
+
+      const std::vector<double> allQuantities =
+          comms.GatherV(std::vector<double>(localQuantities, localQuantities + numberOfQuantities),
+                        comms.GetIORank());
+      if (!comms.OnIORank())
+      {
+        return;
+      }
+
+      const proc_t ranks = comms.Size();
+      distributions.clear();
+      for (unsigned quantity = 0; quantity < numberOfQuantities; ++quantity)
+      {
+        std::vector<double> values(ranks);
+        for (proc_t rank = 0; rank < ranks; ++rank)
+        {
+          values[rank] = allQuantities[rank * numberOfQuantities + quantity];
+        }
+        distributions.push_back(LoadImbalance::Summarise(values));
+      }
+      totalSites = distributions[sites].mean * ranks;
+    }
+
+    double Prediction::GetMlups() const
+    {
+      return GetStepTime() > 0.0 ?
+        totalSites / GetStepTime() / 1e6 :
+        0.0;
+    }
+
+    void Prediction::Report(ctemplate::TemplateDictionary& dictionary)
+    {
+      ctemplate::TemplateDictionary *prediction = dictionary.AddSectionDictionary("PREDICTION");
+      prediction->SetValue("CALIBRATED", calibrated ?
+        "true" :
+        "false");
+      prediction->SetFormattedValue("STEP_TIME", "%.6g", GetStepTime());
+      prediction->SetFormattedValue("MLUPS", "%.6g", GetMlups());
+      for (unsigned quantity = 0; quantity < distributions.size(); ++quantity)
+      {
+        const LoadImbalance::Distribution& distribution = distributions[quantity];
+        ctemplate::TemplateDictionary *row =
+            prediction->AddSectionDictionary("PREDICTED_QUANTITY");
+        row->SetValue("NAME", quantityNames[quantity]);
+        row->SetFormattedValue("MIN", "%.6g", distribution.min);
+        row->SetFormattedValue("P50", "%.6g", distribution.p50);
+        row->SetFormattedValue("P90", "%.6g", distribution.p90);
+        row->SetFormattedValue("P99", "%.6g", distribution.p99);
+        row->SetFormattedValue("MAX", "%.6g", distribution.max);
+        row->SetFormattedValue("MEAN", "%.6g", distribution.mean);
+        row->SetFormattedValue("FACTOR", "%.3f", distribution.imbalance);
+      }
+    }
+  }
+}
@@ -0,0 +1,108 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_REPORTING_PREDICTION_H
+#define HEMELB_REPORTING_PREDICTION_H
+
+#include <vector>
+#include "constants.h"
+#include "net/IOCommunicator.h"
+#include "reporting/LoadImbalance.h"
+#include "reporting/Reportable.h"
+
+namespace hemelb
+{
+  namespace reporting
+  {
+    /**
+     * What a run would need, worked out from the decomposition before simulating anything: the
+     * memory, the work and the time of a step on each rank. The time of a step is the slowest
+     * rank's sites weighted by the site weights, times how long a bulk site took in the run
+     * the weights were calibrated by; without calibrated weights it can't be predicted.
+     */
+    class Prediction : public Reportable
+    {
+      public:
+        /**
+         * The quantities predicted for each rank.
+         */
+        enum Quantity
+        {
+          sites = 0,
+          work,
+          stepTime,
+          memory,
+          numberOfQuantities
+        };
+
+        static const char* quantityNames[numberOfQuantities];
+
+        Prediction(const net::IOCommunicator& comms);
+
+        /**
+         * Gather every rank's prediction to the I/O rank, which keeps the summary to report.
+         * Collective.
+         * @param sitesPerType This rank's sites of each collision type
+         * @param weights The weight of a site of each collision type
+         * @param bulkSiteTime The time to update a bulk site for a step, or 0 if not known
+         * @param bytes The memory this rank would need
+         */
+        void Reduce(const std::vector<site_t>& sitesPerType, const std::vector<int>& weights,
+                    double bulkSiteTime, double bytes);
+
+        /**
+         * The time a rank would take to update its sites for one step.
+         * @param sitesPerType The rank's sites of each collision type
+         * @param weights The weight of a site of each collision type
+         * @param bulkSiteTime The time to update a bulk site for a step
+         * @return
+         */
+        static double StepTime(const std::vector<site_t>& sitesPerType,
+                               const std::vector<int>& weights, double bulkSiteTime);
+
+        /**
+         * @return The summary of each quantity over the ranks, set on the I/O rank by Reduce
+         */
+        const std::vector<LoadImbalance::Distribution>& GetDistributions() const
+        {
+          return distributions;
+        }
+
+        /**
+         * @return Whether the step time could be predicted
+         */
+        bool IsCalibrated() const
+        {
+          return calibrated;
+        }
+
+        /**
+         * @return The time of a step, that of the slowest rank
+         */
+        double GetStepTime() const
+        {
+          return distributions.empty() ?
+            0.0 :
+            distributions[stepTime].max;
+        }
+
+        /**
+         * @return Millions of lattice site updates per second at the predicted step time
+         */
+        double GetMlups() const;
+
+        void Report(ctemplate::TemplateDictionary& dictionary);
+
+      private:
+        const net::IOCommunicator& comms;
+        bool calibrated;
+        /** Set on the I/O rank by Reduce */
+        double totalSites;
+        std::vector<LoadImbalance::Distribution> distributions;
+    };
+  }
+}
+
+#endif /* HEMELB_REPORTING_PREDICTION_H */
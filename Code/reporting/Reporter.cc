@@ -5,6 +5,7 @@
 // license in the file LICENSE.
 
 #include "reporting/Reporter.h"
+#include <algorithm>
 
 namespace hemelb
 {
@@ -26,6 +27,19 @@ namespace hemelb
       reportableObjects.push_back(reportable);
     }
 
+    void Reporter::ReplaceReportable(Reportable* previous, Reportable* replacement)
+    {
+      std::replace(reportableObjects.begin(), reportableObjects.end(), previous, replacement);
+    }
+
+    void Reporter::RemoveReportable(Reportable* reportable)
+    {
+      reportableObjects.erase(std::remove(reportableObjects.begin(),
+                                          reportableObjects.end(),
+                                          reportable),
+                              reportableObjects.end());
+    }
+
     void Reporter::Write(const std::string &ctemplate, const std::string &as)
     {
       std::string output;
@@ -43,6 +43,18 @@ namespace hemelb
         void Image(); //! Inform the reporter that an image has been saved.
 
         void AddReportable(Reportable* reportable);
+        /**
+         * Report on a new object instead of one that has been replaced, e.g. the lattice data
+         * once the domain has been rebalanced.
+         * @param previous
+         * @param replacement
+         */
+        void ReplaceReportable(Reportable* previous, Reportable* replacement);
+        /**
+         * Stop reporting on an object, e.g. a checker the next simulation of a server doesn't have.
+         * @param reportable
+         */
+        void RemoveReportable(Reportable* reportable);
 
         void WriteXML()
         {
@@ -52,11 +64,20 @@ namespace hemelb
         {
           Write(resources::Resource("report.txt.ctp").Path(), "report.txt");
         }
+        /**
+         * Write the report as JSON, for collecting the performance of many runs. Its
+         * schema_version is increased whenever a field is renamed or removed.
+         */
+        void WriteJSON()
+        {
+          Write(resources::Resource("report.json.ctp").Path(), "report.json");
+        }
         void FillDictionary();
         void Write()
         {
           WriteXML();
           WriteTxt();
+          WriteJSON();
         }
         ctemplate::TemplateDictionary const & GetDictionary()
         {
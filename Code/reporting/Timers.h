@@ -11,6 +11,8 @@
 #include "reporting/Reportable.h"
 #include "util/utilityFunctions.h"
 #include "reporting/Policies.h"
+#include "reporting/Counters.h"
+#include "reporting/Energy.h"
 namespace hemelb
 {
   namespace reporting
@@ -18,9 +20,12 @@ namespace hemelb
     /**
      * Timer which manages performance measurement for a single aspect of the code
      * @tparam ClockPolicy Policy defining how to get the current time
+     * @tparam CounterPolicy Policy defining which hardware events to count while timing, if any
+     * @tparam EnergyPolicy Policy defining how to measure the energy used while timing, if at all
      */
-    template<class ClockPolicy>
-    class TimerBase : public ClockPolicy
+    template<class ClockPolicy, class CounterPolicy = NoCounterPolicy,
+        class EnergyPolicy = NoEnergyPolicy>
+    class TimerBase : public ClockPolicy, public CounterPolicy, public EnergyPolicy
     {
       public:
         /**
@@ -53,12 +58,16 @@ namespace hemelb
         void Start()
         {
           start = ClockPolicy::CurrentTime();
+          CounterPolicy::StartCounting();
+          EnergyPolicy::StartMetering();
         }
         /**
          * Stop the timer.
          */
         void Stop()
         {
+          EnergyPolicy::StopMetering();
+          CounterPolicy::StopCounting();
           time += ClockPolicy::CurrentTime() - start;
         }
       private:
@@ -70,12 +79,15 @@ namespace hemelb
      * Class which manages a set of timers timing aspects of a HemeLB run
      * @tparam ClockPolicy How to get the current time
      * @tparam CommsPolicy How to share information between processes
+     * @tparam CounterPolicy Which hardware events to count, for the timers in countedTimers
+     * @tparam EnergyPolicy How to measure the energy used, for the timers in meteredTimers
      */
-    template<class ClockPolicy, class CommsPolicy>
+    template<class ClockPolicy, class CommsPolicy, class CounterPolicy = NoCounterPolicy,
+        class EnergyPolicy = NoEnergyPolicy>
     class TimersBase : public CommsPolicy, public Reportable
     {
       public:
-        typedef TimerBase<ClockPolicy> Timer;
+        typedef TimerBase<ClockPolicy, CounterPolicy, EnergyPolicy> Timer;
         /**
          * The set of possible timers
          */
@@ -85,7 +97,7 @@ namespace hemelb
           initialDecomposition, //!< Initial seed decomposition
           domainDecomposition, //!< Time spent in parmetis domain decomposition
           fileRead, //!< Time spent in reading the geometry description file
-          reRead, //!< Time spend in re-reading the geometry after second decomposition
+          reRead, //!< Time spent getting the geometry blocks needed after second decomposition
           unzip, //!< Time spend in un-zipping
           moves, //!< Time spent moving things around post-parmetis
           parmetis, //!< Time spent in Parmetis
@@ -117,6 +129,22 @@ namespace hemelb
           colloidUpdateCalculations,
           colloidOutput,
           extractionWriting,
+          rebalance, //!< Time spent redistributing the sites between processes during the run
+          checkpoint, //!< Time spent writing and reading checkpoints
+          midDomainMidFluid, //!< Time in lb_calc on mid-domain sites of each collision type...
+          midDomainWall,
+          midDomainInlet,
+          midDomainOutlet,
+          midDomainInletWall,
+          midDomainOutletWall,
+          domainEdgeMidFluid, //!< ...and on domain-edge sites of each type, in the same order
+          domainEdgeWall,
+          domainEdgeInlet,
+          domainEdgeOutlet,
+          domainEdgeInletWall,
+          domainEdgeOutletWall,
+          mpiProgress, //!< Time the MPI progress thread spent driving the comms
+          inSitu, //!< Time spent in the in situ visualisation backend
           last
         //!< last, this has to be the last element of the enumeration so it can be used to track cardinality
         };
@@ -127,10 +155,54 @@ namespace hemelb
          */
         static const std::string timerNames[TimersBase::numberOfTimers];
 
+        /**
+         * The timers that count hardware events, if the CounterPolicy counts any: those of the
+         * computation whose speed depends on the machine's memory bandwidth and cores.
+         */
+        static const TimerName countedTimers[3];
+
+        /**
+         * The timers that measure the energy the node uses, if the EnergyPolicy measures it: the
+         * whole simulation and the phases within it. Only the first process on each node
+         * measures, as the energy is the node's.
+         */
+        static const TimerName meteredTimers[5];
+
+        /**
+         * The timer for the LB calculation on sites of a collision type.
+         * @param collisionType In the order of LatticeData's collision counts
+         * @param domainEdge Whether the sites are domain-edge rather than mid-domain ones
+         * @return
+         */
+        static TimerName CollisionTimer(unsigned collisionType, bool domainEdge)
+        {
+          return TimerName( (domainEdge ?
+            domainEdgeMidFluid :
+            midDomainMidFluid) + collisionType);
+        }
+
         TimersBase(const net::IOCommunicator& comms) :
           CommsPolicy(comms),
-            timers(numberOfTimers), maxes(numberOfTimers), mins(numberOfTimers), means(numberOfTimers)
+            timers(numberOfTimers), maxes(numberOfTimers), mins(numberOfTimers), means(numberOfTimers),
+            counterTotals(CounterPolicy::Counting ? numberOfTimers * (numberOfCounters + 1) : 0),
+            energyTotals(EnergyPolicy::Measuring ?
+              numberOfTimers * (numberOfEnergyDomains + 2) :
+              0)
         {
+          if (CounterPolicy::Counting)
+          {
+            for (unsigned int ii = 0; ii < sizeof(countedTimers) / sizeof(countedTimers[0]); ii++)
+            {
+              timers[countedTimers[ii]].EnableCounters();
+            }
+          }
+          if (EnergyPolicy::Measuring && CommsPolicy::LeadsNode())
+          {
+            for (unsigned int ii = 0; ii < sizeof(meteredTimers) / sizeof(meteredTimers[0]); ii++)
+            {
+              timers[meteredTimers[ii]].EnableMeters();
+            }
+          }
         }
         /**
          * Max across all processes.
@@ -195,6 +267,68 @@ namespace hemelb
         {
           return timers[t];
         }
+        /**
+         * Following the sharing of timing data between processes, the count of a hardware event
+         * for a timer, summed over the processes that counted it.
+         * @param t the timer name
+         * @param counter the event
+         * @return the total count, or zero if no process counted
+         */
+        double CounterTotal(TimerName t, CounterName counter) const
+        {
+          return counterTotals.empty() ?
+            0.0 :
+            counterTotals[t * (numberOfCounters + 1) + counter];
+        }
+        /**
+         * Following the sharing of timing data between processes, the time a timer ran for on
+         * the processes that counted its hardware events, summed over those processes.
+         * @param t the timer name
+         * @return the total time, or zero if no process counted
+         */
+        double CountedTime(TimerName t) const
+        {
+          return counterTotals.empty() ?
+            0.0 :
+            counterTotals[t * (numberOfCounters + 1) + numberOfCounters];
+        }
+        /**
+         * Following the sharing of timing data between processes, the energy a domain of the
+         * nodes used while a timer ran, summed over the nodes that measured it.
+         * @param t the timer name
+         * @param domain
+         * @return the total in joules, or zero if no node measured
+         */
+        double EnergyTotal(TimerName t, EnergyDomain domain) const
+        {
+          return energyTotals.empty() ?
+            0.0 :
+            energyTotals[t * (numberOfEnergyDomains + 2) + domain];
+        }
+        /**
+         * Following the sharing of timing data between processes, the number of nodes that
+         * measured the energy used while a timer ran.
+         * @param t the timer name
+         * @return the number of nodes
+         */
+        double MeteredNodes(TimerName t) const
+        {
+          return energyTotals.empty() ?
+            0.0 :
+            energyTotals[t * (numberOfEnergyDomains + 2) + numberOfEnergyDomains];
+        }
+        /**
+         * Following the sharing of timing data between processes, the time a timer ran for on
+         * the processes that measured its energy, summed over those processes.
+         * @param t the timer name
+         * @return the total time, or zero if no node measured
+         */
+        double MeteredTime(TimerName t) const
+        {
+          return energyTotals.empty() ?
+            0.0 :
+            energyTotals[t * (numberOfEnergyDomains + 2) + numberOfEnergyDomains + 1];
+        }
         /**
          * Share timing information across timers
          */
@@ -207,12 +341,32 @@ namespace hemelb
         std::vector<double> maxes; //! Max across processes
         std::vector<double> mins; //! Min across processes
         std::vector<double> means; //! Average across processes
+        //! For each timer, each event's count then the time counted, summed over processes
+        std::vector<double> counterTotals;
+        //! For each timer, each domain's joules, the nodes measuring and the time measured,
+        //! summed over nodes
+        std::vector<double> energyTotals;
     };
-    typedef TimerBase<HemeLBClockPolicy> Timer;
-    typedef TimersBase<HemeLBClockPolicy, MPICommsPolicy> Timers;
+    typedef TimerBase<HemeLBClockPolicy, HemeLBCounterPolicy, HemeLBEnergyPolicy> Timer;
+    typedef TimersBase<HemeLBClockPolicy, MPICommsPolicy, HemeLBCounterPolicy, HemeLBEnergyPolicy> Timers;
+
+    template<class ClockPolicy, class CommsPolicy, class CounterPolicy, class EnergyPolicy>
+    const typename TimersBase<ClockPolicy, CommsPolicy, CounterPolicy, EnergyPolicy>::TimerName TimersBase<
+        ClockPolicy, CommsPolicy, CounterPolicy, EnergyPolicy>::countedTimers[3] = { TimersBase::lb_calc,
+                                                                                     TimersBase::monitoring,
+                                                                                     TimersBase::visualisation };
+
+    template<class ClockPolicy, class CommsPolicy, class CounterPolicy, class EnergyPolicy>
+    const typename TimersBase<ClockPolicy, CommsPolicy, CounterPolicy, EnergyPolicy>::TimerName TimersBase<
+        ClockPolicy, CommsPolicy, CounterPolicy, EnergyPolicy>::meteredTimers[5] = { TimersBase::simulation,
+                                                                                     TimersBase::lb_calc,
+                                                                                     TimersBase::mpiWait,
+                                                                                     TimersBase::extractionWriting,
+                                                                                     TimersBase::checkpoint };
 
-    template<class ClockPolicy, class CommsPolicy>
-    const std::string TimersBase<ClockPolicy, CommsPolicy>::timerNames[TimersBase<ClockPolicy, CommsPolicy>::numberOfTimers] =
+    template<class ClockPolicy, class CommsPolicy, class CounterPolicy, class EnergyPolicy>
+    const std::string TimersBase<ClockPolicy, CommsPolicy, CounterPolicy, EnergyPolicy>::timerNames[TimersBase<
+        ClockPolicy, CommsPolicy, CounterPolicy, EnergyPolicy>::numberOfTimers] =
 
     { "Total", "Seed Decomposition", "Domain Decomposition", "File Read", "Re Read", "Unzip", "Moves", "Parmetis",
       "Lattice Data initialisation", "Lattice Boltzmann", "LB calc only", "Visualisation", "Monitoring", "MPI Send",
@@ -221,7 +375,11 @@ namespace hemelb
       "Move Counts Sending", "Move Data Sending", "Populating moves list for decomposition optimisation",
       "Initial geometry reading", "Colloid initialisation", "Colloid position communication",
       "Colloid velocity communication", "Colloid force calculations", "Colloid calculations for updating",
-      "Colloid outputting", "Extraction writing" };
+      "Colloid outputting", "Extraction writing", "Rebalancing", "Checkpointing", "Mid-domain mid-fluid",
+      "Mid-domain wall", "Mid-domain inlet", "Mid-domain outlet", "Mid-domain inlet wall",
+      "Mid-domain outlet wall", "Domain-edge mid-fluid", "Domain-edge wall", "Domain-edge inlet",
+      "Domain-edge outlet", "Domain-edge inlet wall", "Domain-edge outlet wall", "MPI progress thread",
+      "In situ visualisation" };
   }
 
 }
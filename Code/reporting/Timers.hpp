@@ -13,8 +13,8 @@ namespace hemelb
 {
   namespace reporting
   {
-    template<class ClockPolicy, class CommsPolicy>
-    void TimersBase<ClockPolicy, CommsPolicy>::Reduce()
+    template<class ClockPolicy, class CommsPolicy, class CounterPolicy, class EnergyPolicy>
+    void TimersBase<ClockPolicy, CommsPolicy, CounterPolicy, EnergyPolicy>::Reduce()
     {
       double timings[numberOfTimers];
       for (unsigned int ii = 0; ii < numberOfTimers; ii++)
@@ -44,10 +44,57 @@ namespace hemelb
       {
         means[ii] /= double(CommsPolicy::GetProcessorCount());
       }
+
+      if (CounterPolicy::Counting)
+      {
+        std::vector<double> counts(counterTotals.size(), 0.0);
+        for (unsigned int ii = 0; ii < numberOfTimers; ii++)
+        {
+          if (timers[ii].HasCounts())
+          {
+            for (unsigned int counter = 0; counter < numberOfCounters; counter++)
+            {
+              counts[ii * (numberOfCounters + 1) + counter] =
+                  timers[ii].GetCount(CounterName(counter));
+            }
+            counts[ii * (numberOfCounters + 1) + numberOfCounters] = timers[ii].Get();
+          }
+        }
+        CommsPolicy::Reduce(&counts[0],
+                            &counterTotals[0],
+                            counts.size(),
+                            net::MpiDataType<double>(),
+                            MPI_SUM,
+                            0);
+      }
+
+      if (EnergyPolicy::Measuring)
+      {
+        std::vector<double> energies(energyTotals.size(), 0.0);
+        for (unsigned int ii = 0; ii < numberOfTimers; ii++)
+        {
+          if (timers[ii].HasEnergy())
+          {
+            double* timerEnergies = &energies[ii * (numberOfEnergyDomains + 2)];
+            for (unsigned int domain = 0; domain < numberOfEnergyDomains; domain++)
+            {
+              timerEnergies[domain] = timers[ii].GetEnergy(EnergyDomain(domain));
+            }
+            timerEnergies[numberOfEnergyDomains] = 1.0;
+            timerEnergies[numberOfEnergyDomains + 1] = timers[ii].Get();
+          }
+        }
+        CommsPolicy::Reduce(&energies[0],
+                            &energyTotals[0],
+                            energies.size(),
+                            net::MpiDataType<double>(),
+                            MPI_SUM,
+                            0);
+      }
     }
 
-    template<class ClockPolicy, class CommsPolicy>
-    void TimersBase<ClockPolicy, CommsPolicy>::Report(ctemplate::TemplateDictionary& dictionary)
+    template<class ClockPolicy, class CommsPolicy, class CounterPolicy, class EnergyPolicy>
+    void TimersBase<ClockPolicy, CommsPolicy, CounterPolicy, EnergyPolicy>::Report(ctemplate::TemplateDictionary& dictionary)
     {
       dictionary.SetIntValue("THREADS", CommsPolicy::GetProcessorCount());
 
@@ -60,6 +107,53 @@ namespace hemelb
         timer->SetFormattedValue("MEAN", "%.3g", Means()[ii]);
         timer->SetFormattedValue("MAX", "%.3g", Maxes()[ii]);
       }
+
+      for (unsigned int ii = 0; ii < sizeof(countedTimers) / sizeof(countedTimers[0]); ii++)
+      {
+        const TimerName counted = countedTimers[ii];
+        const double time = CountedTime(counted);
+        const double cycleCount = CounterTotal(counted, cycles);
+        if (time <= 0.0 || cycleCount <= 0.0)
+        {
+          continue;
+        }
+        // Every cache miss reads a line from memory, so this is a lower bound on the traffic.
+        const double instructionCount = CounterTotal(counted, instructions);
+        const double bytes = CounterTotal(counted, cacheMisses) * CacheLineBytes;
+        ctemplate::TemplateDictionary *counter = dictionary.AddSectionDictionary("COUNTER");
+        counter->SetValue("NAME", timerNames[counted]);
+        counter->SetFormattedValue("CYCLES", "%.4g", cycleCount);
+        counter->SetFormattedValue("INSTRUCTIONS", "%.4g", instructionCount);
+        counter->SetFormattedValue("CACHE_MISSES", "%.4g", CounterTotal(counted, cacheMisses));
+        counter->SetFormattedValue("IPC", "%.3g", instructionCount / cycleCount);
+        counter->SetFormattedValue("GBPS", "%.3g", bytes / time / 1e9);
+        counter->SetFormattedValue("INSTRUCTIONS_PER_BYTE", "%.3g", bytes > 0.0 ?
+          instructionCount / bytes :
+          0.0);
+      }
+
+      for (unsigned int ii = 0; ii < sizeof(meteredTimers) / sizeof(meteredTimers[0]); ii++)
+      {
+        const TimerName metered = meteredTimers[ii];
+        const double nodes = MeteredNodes(metered);
+        if (nodes <= 0.0)
+        {
+          continue;
+        }
+        // Both the energy and the time are summed over the nodes, so this is a node's mean power.
+        const double package = EnergyTotal(metered, packageEnergy);
+        const double dram = EnergyTotal(metered, dramEnergy);
+        const double time = MeteredTime(metered);
+        ctemplate::TemplateDictionary *energy = dictionary.AddSectionDictionary("ENERGY");
+        energy->SetValue("NAME", timerNames[metered]);
+        energy->SetFormattedValue("NODES", "%.0f", nodes);
+        energy->SetFormattedValue("PACKAGE_JOULES", "%.4g", package);
+        energy->SetFormattedValue("DRAM_JOULES", "%.4g", dram);
+        energy->SetFormattedValue("JOULES_PER_NODE", "%.4g", (package + dram) / nodes);
+        energy->SetFormattedValue("WATTS_PER_NODE", "%.4g", time > 0.0 ?
+          (package + dram) / time :
+          0.0);
+      }
     }
 
   }
@@ -21,8 +21,25 @@ namespace hemelb
         ClientConnection(int iSteeringSessionId, reporting::Timers & timings);
         ~ClientConnection();
 
+        /**
+         * The socket to the client, accepting a new connection without waiting if there isn't
+         * one, or -1 if there is still no client.
+         * @return
+         */
         int GetWorkingSocket();
 
+        /**
+         * The socket to the client, or -1 if there isn't a working one, without trying to accept
+         * a new connection.
+         * @return
+         */
+        int GetCurrentSocket();
+
+        /**
+         * Block until a client connects.
+         */
+        void WaitForClient();
+
         void ReportBroken(int iSocketNum);
 
       private:
@@ -54,11 +54,15 @@ namespace hemelb
         // Sent data:
         // 2 * int (pixelsX, pixelsY)
         // 1 * int (bytes of pixel data)
-        // pixel data (variable, up to COLOURED_PIXELS_MAX * bytes_per_pixel_data)
+        // pixel data (variable, up to COLOURED_PIXELS_MAX * bytes_per_pixel_data, or a little
+        // more for incompressible encoded pixels)
         // SimulationParameters::paramsSizeB (metadata - mouse pressure and stress etc)
         static const unsigned int XdrIntLength = 4;
+        static const unsigned int encodingOverhead = vis::Screen::COLOURED_PIXELS_MAX
+            * bytes_per_pixel_data / 1024 + 64;
         static const unsigned int maxSendSize = 2 * XdrIntLength + 1 * XdrIntLength
-            + vis::Screen::COLOURED_PIXELS_MAX * bytes_per_pixel_data + SimulationParameters::paramsSizeB;
+            + vis::Screen::COLOURED_PIXELS_MAX * bytes_per_pixel_data + encodingOverhead
+            + SimulationParameters::paramsSizeB;
     };
   }
 }
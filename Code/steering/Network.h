@@ -7,45 +7,102 @@
 #ifndef HEMELB_STEERING_NETWORK_H
 #define HEMELB_STEERING_NETWORK_H
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <string>
+#include <thread>
 
 #include "steering/ClientConnection.h"
-#include "net/IteratedAction.h"
+#include "steering/basic/SimulationParameters.h"
 
 namespace hemelb
 {
   namespace steering
   {
 
-    class Network : public net::IteratedAction
+    /**
+     * The connection to the steering client, on the IO rank.
+     *
+     * Frames are handed to a sender thread through a short queue, so sending never holds up the
+     * simulation: if the client falls behind, the stalest queued frame is dropped to make way for
+     * the newest, with any mouse pick it carried passed on to the next image. The sender
+     * thread also accepts new client connections, and all socket I/O is non-blocking.
+     */
+    class Network
     {
       public:
         Network(int iSteeringSessionId, reporting::Timers & timings);
+        ~Network();
 
         // Receive a bytestream of known length from a socket into a buffer.
         bool recv_all(char *buf, const int length);
 
-        // Send all bytes from a buffer of known length over a socket.
-        bool send_all(const char *buf, const int length);
+        /**
+         * Queue a frame to be sent to the client: the image, then the simulation parameters,
+         * which are packed when the frame is sent.
+         *
+         * @param image
+         * @param length The length of the image in bytes.
+         * @param params
+         */
+        void QueueFrame(const char* image, const int length, const SimulationParameters& params);
 
         /**
-         * Use the time between MPI send and MPI receives being completed to perform the
-         * Network sends.
+         * Queue a frame to be sent to the client as it is, such as a frame of field data.
+         *
+         * @param data
+         * @param length The length of the frame in bytes.
          */
-        void PreReceive();
+        void QueueFrame(const char* data, const int length);
 
         bool IsConnected();
 
       private:
+        /**
+         * A frame waiting to be sent.
+         */
+        struct Frame
+        {
+            std::string image;
+            //! Whether the simulation parameters follow the image.
+            bool hasParams;
+            SimulationParameters params;
+        };
+
+        //! The most frames kept waiting while one is sent.
+        static const unsigned MaxQueuedFrames = 2;
+        //! How long the sender waits, in milliseconds, for a frame or the socket before looking
+        //! for a client or checking whether it should stop.
+        static const int PollIntervalMs = 100;
+
+        /**
+         * Add a frame to the queue, dropping the stalest if it is full.
+         */
+        void Enqueue(const char* data, const int length, bool hasParams, const SimulationParameters& params);
+
         void Break(int socket);
 
         long sendInternal(const char* data, long length, int socket);
 
+        /**
+         * The sender thread's loop: take frames from the queue and send them until the network
+         * is destroyed.
+         */
+        void SendFrames();
+
         ClientConnection clientConnection;
 
-        // Buffers to keep the data from partial sends and receives.
+        // Buffers to keep the data from partial sends and receives. The send buffer is only used
+        // by the sender thread, the receive buffer only by the simulation.
         std::string sendBuf;
         std::string recvBuf;
+
+        std::deque<Frame> frames;
+        bool stopping;
+        std::mutex framesMutex;
+        std::condition_variable framesQueued;
+        std::thread sender;
     };
 
   }
@@ -0,0 +1,113 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_STEERING_REGIONSTREAMER_H
+#define HEMELB_STEERING_REGIONSTREAMER_H
+
+#include <vector>
+#include "extraction/IterableDataSource.h"
+#include "lb/MacroscopicPropertyCache.h"
+#include "lb/SimulationState.h"
+#include "net/IOCommunicator.h"
+#include "net/IteratedAction.h"
+#include "steering/Network.h"
+
+namespace hemelb
+{
+  namespace steering
+  {
+    /**
+     * Streams the pressure and velocity of the sites in a box, chosen by the steering client, to
+     * the client every so many steps.
+     *
+     * The box, a stride and a period are steering parameters, so every core sees them change on
+     * the same step. Each core then picks its own sites in the box, with a
+     * extraction::BoxGeometrySelector, keeping only those whose coordinates are all multiples of
+     * the stride; nothing is communicated until the values are gathered onto the IO core, which
+     * hands them to the Network as a frame of its own.
+     *
+     * A field frame is, in XDR:
+     * int - FieldFrameMarker, where an image frame has its width
+     * int - The time step
+     * int - The number of sites
+     * then for each site, in order of the cores, three ints of its lattice coordinates and four
+     * floats: the pressure (mmHg) and the velocity (m/s).
+     */
+    class RegionStreamer : public net::IteratedAction
+    {
+      public:
+        enum
+        {
+          FieldFrameMarker = -1
+        };
+
+        /**
+         * @param simulationState
+         * @param dataSource
+         * @param ioComms
+         * @param network The steering network, only needed on the IO core.
+         */
+        RegionStreamer(const lb::SimulationState& simulationState,
+                       extraction::IterableDataSource& dataSource,
+                       const net::IOCommunicator& ioComms, Network* network);
+
+        /**
+         * Set the region to stream. Must be called with the same values on every core on the
+         * same step.
+         *
+         * @param minimum The corner of the box with the lowest coordinates, in metres.
+         * @param maximum The corner of the box with the highest coordinates, in metres.
+         * @param stride Only sites whose coordinates are all multiples of this are streamed.
+         * @param period The number of steps between frames, or zero to stop streaming.
+         */
+        void SetRegion(const util::Vector3D<float>& minimum, const util::Vector3D<float>& maximum,
+                       unsigned stride, unsigned long period);
+
+        /**
+         * Set which properties will be required this iteration, deciding whether to stream on it.
+         * @param propertyCache
+         */
+        void SetRequiredProperties(lb::MacroscopicPropertyCache& propertyCache);
+
+        /**
+         * True if the region is streamed on this iteration, as decided by SetRequiredProperties.
+         * @return
+         */
+        bool StreamsThisIteration() const;
+
+        /**
+         * Gather the region's values and send them, if it's streamed on this iteration.
+         * Collective.
+         */
+        void EndIteration();
+
+      private:
+        /**
+         * The number of values gathered for each site: its coordinates, pressure and velocity.
+         */
+        static const unsigned ValuesPerSite = 7;
+
+        /**
+         * Find the indices, in the data source's order, of the local sites to stream.
+         */
+        void SelectLocalSites();
+
+        const lb::SimulationState& simulationState;
+        extraction::IterableDataSource& dataSource;
+        const net::IOCommunicator& comms;
+        Network* network;
+        util::Vector3D<float> minimum;
+        util::Vector3D<float> maximum;
+        unsigned stride;
+        unsigned long period;
+        //! Whether the region has changed since the local sites were last selected.
+        bool selectionDue;
+        bool streamingThisIteration;
+        std::vector<site_t> localSites;
+    };
+  }
+}
+
+#endif /* HEMELB_STEERING_REGIONSTREAMER_H */
@@ -14,6 +14,7 @@
 #include "vis/DomainStats.h"
 #include "vis/Control.h"
 #include "steering/ImageSendComponent.h"
+#include "steering/RegionStreamer.h"
 
 namespace hemelb
 {
@@ -42,7 +43,19 @@ namespace hemelb
       StreaklinePerSimulation = 18,
       StreaklineLength = 19,
       MaxFramerate=20,
-      SetDoRendering = 21
+      RegionMinimumX = 21,
+      RegionMinimumY = 22,
+      RegionMinimumZ = 23,
+      RegionMaximumX = 24,
+      RegionMaximumY = 25,
+      RegionMaximumZ = 26,
+      RegionStride = 27,
+      RegionPeriod = 28,
+      RestartRequest = 29,
+      RestartConfiguration = 30,
+      RestartWarm = 31,
+      FlightRecorderRequest = 32,
+      SetDoRendering = 33
     };
 
     /**
@@ -58,6 +71,7 @@ namespace hemelb
         SteeringComponent(Network* iNetwork,
                           vis::Control* iVisControl,
                           steering::ImageSendComponent* imageSendComponent,
+                          RegionStreamer* regionStreamer,
                           net::Net * iNet,
                           lb::SimulationState * iSimState,
                           configuration::SimConfig* iSimConfig,
@@ -72,6 +86,35 @@ namespace hemelb
          */
         void ClearValues();
 
+        /**
+         * The number of restarts the client has asked a simulation server for so far; a new
+         * request is one greater than the restarts done.
+         */
+        unsigned long GetRestartRequest() const;
+
+        /**
+         * The index, in the server's list of input files, of the configuration to restart with.
+         */
+        unsigned GetRestartConfiguration() const;
+
+        /**
+         * Whether to restart from the flow as it is, rather than the initial conditions.
+         */
+        bool IsWarmRestart() const;
+
+        /**
+         * The number of times the client has asked for the flight recorder's samples so far; a
+         * new request is one greater than the number written.
+         */
+        unsigned long GetFlightRecorderRequest() const;
+
+        /**
+         * Between the runs of a simulation server, keep reading from the client until it asks
+         * for a restart beyond those done, or to terminate, and then give every process its
+         * parameters. Collective.
+         */
+        void WaitWhileIdle(const net::IOCommunicator& comms, unsigned long restartsDone);
+
         bool readyForNextImage;
         bool updatedMouseCoords;
 
@@ -85,8 +128,10 @@ namespace hemelb
       private:
         void AssignValues();
 
-        const static int STEERABLE_PARAMETERS = 21;
+        const static int STEERABLE_PARAMETERS = 33;
         const static unsigned int SPREADFACTOR = 10;
+        /** How long the top node sleeps between reads of an idle server's client */
+        const static unsigned int IDLE_POLL_MICROSECONDS = 100000;
 
         bool isConnected;
 
@@ -94,6 +139,7 @@ namespace hemelb
         lb::SimulationState* mSimState;
         vis::Control* mVisControl;
         steering::ImageSendComponent* imageSendComponent;
+        RegionStreamer* regionStreamer;
         float privateSteeringParams[STEERABLE_PARAMETERS + 1];
         const util::UnitConverter* mUnits;
         configuration::SimConfig* simConfig;
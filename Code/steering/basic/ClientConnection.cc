@@ -11,6 +11,7 @@
 #include <csignal>
 #include <fcntl.h>
 #include <netinet/in.h>
+#include <poll.h>
 
 #include "debug/Debugger.h"
 #include "log/Logger.h"
@@ -75,6 +76,19 @@ namespace hemelb
         perror("listen");
         exit(1);
       }
+
+      // Make the socket non-blocking, so that we can look for a new client without waiting.
+      {
+        int flags = fcntl(mListeningSocket, F_GETFL, 0);
+        if (flags == -1)
+        {
+          flags = 0;
+        }
+        if (fcntl(mListeningSocket, F_SETFL, flags | O_NONBLOCK) < 0)
+        {
+          perror("flags");
+        }
+      }
     }
 
     ClientConnection::~ClientConnection()
@@ -97,45 +111,22 @@ namespace hemelb
 
         int lOldSocket = mCurrentSocket;
 
-        // Make the socket non-blocking, just while we try to accept on it, then set
-        // it back to what it was before.
+        // Try to accept a socket (from the non-blocking socket)
+        mCurrentSocket = accept(mListeningSocket, (struct sockaddr *) &clientAddress, &socketSize);
+
+        // We've got a socket - make that socket non-blocking too.
+        if (mCurrentSocket > 0)
         {
-          int flags = fcntl(mListeningSocket, F_GETFL, 0);
+          log::Logger::Log<log::Info, log::Singleton>("Steering client connected");
+          int flags = fcntl(mCurrentSocket, F_GETFL, 0);
           if (flags == -1)
           {
             flags = 0;
           }
-#ifndef HEMELB_WAIT_ON_CONNECT
-          if (fcntl(mListeningSocket, F_SETFL, flags | O_NONBLOCK) < 0)
+          if (fcntl(mCurrentSocket, F_SETFL, flags | O_NONBLOCK) < 0)
           {
             perror("flags");
           }
-#else
-          log::Logger::Log<log::Info, log::Singleton>("Waiting for steering client connection");
-          timers[reporting::Timers::steeringWait].Start();
-
-#endif
-          // Try to accept a socket (from the non-blocking socket)
-          mCurrentSocket
-              = accept(mListeningSocket, (struct sockaddr *) &clientAddress, &socketSize);
-#ifdef HEMELB_WAIT_ON_CONNECT
-          timers[reporting::Timers::steeringWait].Stop();
-          log::Logger::Log<log::Debug, log::Singleton>("Continuing after receiving steering connection.");
-#endif
-          // We've got a socket - make that socket non-blocking too.
-          if (mCurrentSocket > 0)
-          {
-            log::Logger::Log<log::Info, log::Singleton>("Steering client connected");
-            flags = fcntl(mCurrentSocket, F_GETFL, 0);
-            if (flags == -1)
-            {
-              flags = 0;
-            }
-            if (fcntl(mCurrentSocket, F_SETFL, flags | O_NONBLOCK) < 0)
-            {
-              perror("flags");
-            }
-          }
         }
 
         // If we had a socket before, close it.
@@ -153,6 +144,34 @@ namespace hemelb
       return lRet;
     }
 
+    int ClientConnection::GetCurrentSocket()
+    {
+      // Lock the mutex and release it when this goes out of scope
+      std::lock_guard<std::mutex> lock(mIsBusy);
+
+      return mIsBroken ?
+        -1 :
+        mCurrentSocket;
+    }
+
+    void ClientConnection::WaitForClient()
+    {
+      log::Logger::Log<log::Info, log::Singleton>("Waiting for steering client connection");
+      timers[reporting::Timers::steeringWait].Start();
+
+      while (GetWorkingSocket() < 0)
+      {
+        // Sleep until there is a connection to accept.
+        struct pollfd listening;
+        listening.fd = mListeningSocket;
+        listening.events = POLLIN;
+        poll(&listening, 1, -1);
+      }
+
+      timers[reporting::Timers::steeringWait].Stop();
+      log::Logger::Log<log::Debug, log::Singleton>("Continuing after receiving steering connection.");
+    }
+
     void ClientConnection::ReportBroken(int iSocketNum)
     {
       // Lock the mutex and release it when this goes out of scope
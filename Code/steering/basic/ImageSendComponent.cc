@@ -57,32 +57,39 @@ namespace hemelb
       // Write the dimensions of the image, in terms of pixel count.
       imageWriter << mVisControl->GetPixelsX() << mVisControl->GetPixelsY();
 
+      // Encode the pixels, so as to know their length.
+      std::vector<uint32_t> pixelWords;
+      mVisControl->EncodePixels(*pix,
+                                mVisControl->domainStats,
+                                mVisControl->visSettings,
+                                mVisControl->visSettings.networkImageEncoding,
+                                pixelWords);
+
       // Write the length of the pixel data
-      imageWriter << (int) (pix->GetPixelCount() * bytes_per_pixel_data);
+      imageWriter << (int) (pixelWords.size() * sizeof(uint32_t));
 
       // Write the pixels themselves
-      mVisControl->WritePixels(&imageWriter, *pix, mVisControl->domainStats, mVisControl->visSettings);
-
-      // Write the numerical data from the simulation, wanted by the client.
+      if (!pixelWords.empty())
       {
-        SimulationParameters sim;
+        imageWriter.WriteArray(&pixelWords[0], pixelWords.size());
+      }
 
-        sim.timeStep = (int) mSimState->GetTimeStep();
-        sim.time = mSimState->GetTime();
-        sim.nInlets = inletCount;
+      // The numerical data from the simulation, wanted by the client.
+      SimulationParameters sim;
 
-        sim.mousePressure = mVisControl->visSettings.mouse_pressure;
-        sim.mouseStress = mVisControl->visSettings.mouse_stress;
+      sim.timeStep = (int) mSimState->GetTimeStep();
+      sim.time = mSimState->GetTime();
+      sim.nInlets = inletCount;
 
-        mVisControl->visSettings.mouse_pressure = -1.0;
-        mVisControl->visSettings.mouse_stress = -1.0;
+      sim.mousePressure = mVisControl->visSettings.mouse_pressure;
+      sim.mouseStress = mVisControl->visSettings.mouse_stress;
 
-        sim.pack(&imageWriter);
-      }
+      mVisControl->visSettings.mouse_pressure = -1.0;
+      mVisControl->visSettings.mouse_stress = -1.0;
 
-      // Send to the client.
-      log::Logger::Log<log::Debug, log::Singleton>("Sending network image at timestep %d",mSimState->GetTimeStep());
-      mNetwork->send_all(xdrSendBuffer, imageWriter.getCurrentStreamPosition() - initialPosition);
+      // Hand the frame to the network's sender thread.
+      log::Logger::Log<log::Debug, log::Singleton>("Queueing network image at timestep %d",mSimState->GetTimeStep());
+      mNetwork->QueueFrame(xdrSendBuffer, imageWriter.getCurrentStreamPosition() - initialPosition, sim);
     }
 
     bool ImageSendComponent::ShouldRenderNewNetworkImage()
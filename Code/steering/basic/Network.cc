@@ -11,12 +11,15 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <sys/wait.h>
+#include <poll.h>
 #include <csignal>
 #include <sys/stat.h>
 #include <cstdio>
 #include <cstring>
+#include <chrono>
 
 #include "debug/Debugger.h"
+#include "io/writers/xdr/XdrMemWriter.h"
 #include "log/Logger.h"
 #include "steering/Network.h"
 #include "util/utilityFunctions.h"
@@ -25,10 +28,28 @@ namespace hemelb
 {
   namespace steering
   {
+    const unsigned Network::MaxQueuedFrames;
+    const int Network::PollIntervalMs;
+
     Network::Network(int steeringSessionId, reporting::Timers & timings) :
-      clientConnection(steeringSessionId, timings)
+      clientConnection(steeringSessionId, timings), stopping(false)
     {
+#ifdef HEMELB_WAIT_ON_CONNECT
+      // Only the first connection is waited for; later ones are accepted by the sender thread as
+      // the simulation runs.
+      clientConnection.WaitForClient();
+#endif
+      sender = std::thread(&Network::SendFrames, this);
+    }
 
+    Network::~Network()
+    {
+      {
+        std::lock_guard<std::mutex> lock(framesMutex);
+        stopping = true;
+      }
+      framesQueued.notify_one();
+      sender.join();
     }
 
     /**
@@ -41,8 +62,8 @@ namespace hemelb
      */
     bool Network::recv_all(char *buf, const int length)
     {
-      // Get a socket
-      int socketToClient = clientConnection.GetWorkingSocket();
+      // Get the socket, which the sender thread accepts.
+      int socketToClient = clientConnection.GetCurrentSocket();
 
       if (socketToClient < 0)
       {
@@ -75,6 +96,7 @@ namespace hemelb
             log::Logger::Log<log::Warning, log::Singleton>("Steering component: broken network pipe... (%s)",
                                                            strerror(errno));
             Break(socketToClient);
+            recvBuf.clear();
           }
           else
           {
@@ -117,99 +139,142 @@ namespace hemelb
       return true;
     }
 
-    void Network::PreReceive()
+    void Network::QueueFrame(const char* image, const int length, const SimulationParameters& params)
+    {
+      Enqueue(image, length, true, params);
+    }
+
+    void Network::QueueFrame(const char* data, const int length)
     {
-      // Calling send_all will attempt to flush the send buffer.
-      send_all(NULL, 0);
+      Enqueue(data, length, false, SimulationParameters());
+    }
+
+    void Network::Enqueue(const char* data, const int length, bool hasParams, const SimulationParameters& params)
+    {
+      {
+        std::lock_guard<std::mutex> lock(framesMutex);
+
+        frames.push_back(Frame());
+        frames.back().image.assign(data, length);
+        frames.back().hasParams = hasParams;
+        frames.back().params = params;
+
+        // If the client can't keep up, drop the stalest frame, but keep any mouse pick it carried
+        // for the client by passing it on to the next image, if that doesn't have one of its own.
+        if (frames.size() > MaxQueuedFrames)
+        {
+          const Frame& stale = frames.front();
+          if (stale.hasParams)
+          {
+            for (std::deque<Frame>::iterator next = frames.begin() + 1; next != frames.end(); ++next)
+            {
+              if (next->hasParams)
+              {
+                if (next->params.mousePressure == -1.0 && next->params.mouseStress == -1.0)
+                {
+                  next->params.mousePressure = stale.params.mousePressure;
+                  next->params.mouseStress = stale.params.mouseStress;
+                }
+                break;
+              }
+            }
+          }
+          frames.pop_front();
+
+          log::Logger::Log<log::Trace, log::Singleton>("Steering component dropped a stale frame");
+        }
+      }
+      framesQueued.notify_one();
     }
 
     bool Network::IsConnected()
     {
-      int res = clientConnection.GetWorkingSocket();
+      int res = clientConnection.GetCurrentSocket();
       return res > 0;
     }
 
-    /**
-     * Send all bytes from a buffer of known length over a socket.
-     *
-     * @param sockid
-     * @param buf
-     * @param length
-     * @return Returns the number of bytes sent or -1 on failure.
-     */
-    bool Network::send_all(const char *buf, const int length)
+    void Network::SendFrames()
     {
-      // Get a socket.
-      int socketToClient = clientConnection.GetWorkingSocket();
+      std::unique_lock<std::mutex> lock(framesMutex);
+      // The socket the frame being sent was started on.
+      int frameSocket = -1;
 
-      // If there's no such socket, we don't have a connection. Nothing to do.
-      if (socketToClient < 0)
+      while (!stopping)
       {
-        return false;
-      }
-      log::Logger::Log<log::Trace, log::Singleton>("Steering component will try to send %d new bytes and a buffer of %d",
-                                                   length,
-                                                   sendBuf.length());
-      // If we have buffered strings to be sent, send those first.
-      if (sendBuf.length() > 0)
-      {
-        long sent = sendInternal(sendBuf.c_str(), sendBuf.length(), socketToClient);
-
-        // Broken socket?
-        if (sent < 0)
+        // Take the next frame once the last one has gone.
+        if (sendBuf.empty() && !frames.empty())
         {
-          return false;
+          Frame& frame = frames.front();
+          sendBuf.swap(frame.image);
+          if (frame.hasParams)
+          {
+            char paramsBuffer[SimulationParameters::paramsSizeB];
+            io::writers::xdr::XdrMemWriter paramsWriter(paramsBuffer, SimulationParameters::paramsSizeB);
+            frame.params.pack(&paramsWriter);
+            sendBuf.append(paramsBuffer, paramsWriter.getCurrentStreamPosition());
+          }
+          frames.pop_front();
+          frameSocket = -1;
         }
 
-        // Did sending block? We'll try again next time.
-        if (sent < (long) sendBuf.length())
+        // With nothing to send, look for a client if there isn't one and wait for a frame.
+        if (sendBuf.empty())
         {
-          sendBuf.erase(0, sent);
+          lock.unlock();
+          clientConnection.GetWorkingSocket();
+          lock.lock();
 
-          // If the sending blocks, just ignore this most recent frame. This way, we stop the
-          // memory usage of the steering process spiralling, and keep current the images delivered
-          // to the client.
-          // What we *would* do is sendBuf.append(buf, length);
+          if (frames.empty() && !stopping)
+          {
+            framesQueued.wait_for(lock, std::chrono::milliseconds(PollIntervalMs));
+          }
+          continue;
+        }
+
+        // Send as much as the socket will take without the queue locked, so that the simulation
+        // can keep queueing frames meanwhile.
+        lock.unlock();
 
-          log::Logger::Log<log::Trace, log::Singleton>("Steering component could not send all buffer, managed %d bytes",
-                                                       sent);
-          return true;
+        int socketToClient = clientConnection.GetWorkingSocket();
+        if (socketToClient < 0 || (frameSocket >= 0 && frameSocket != socketToClient))
+        {
+          // The client has gone; the rest of this frame is no use to the next one.
+          sendBuf.clear();
         }
-        // If not, we sent the whole buffer.
         else
         {
-          sendBuf.clear();
+          frameSocket = socketToClient;
+
+          struct pollfd client;
+          client.fd = socketToClient;
+          client.events = POLLOUT;
+
+          if (poll(&client, 1, PollIntervalMs) > 0)
+          {
+            long sent = sendInternal(sendBuf.c_str(), sendBuf.length(), socketToClient);
+
+            // Broken socket?
+            if (sent < 0)
+            {
+              sendBuf.clear();
+            }
+            else
+            {
+              sendBuf.erase(0, sent);
+              log::Logger::Log<log::Trace, log::Singleton>("Steering component sent %d bytes, %d left of the frame",
+                                                           sent,
+                                                           sendBuf.length());
+            }
+          }
         }
-      }
-      log::Logger::Log<log::Trace, log::Singleton>("Steering component sent all the buffer, sending new data");
-      // If we sent the whole buffer, try to send the new data.
-      long sent_bytes = sendInternal(buf, length, socketToClient);
 
-      // Is the socket broken?
-      if (sent_bytes < 0)
-      {
-        log::Logger::Log<log::Trace, log::Singleton>("Steering component socket broke sending new bytes");
-        return false;
-      }
-      // Did the socket block? Still return true, because we'll try again next time.
-      else if (sent_bytes < length)
-      {
-        log::Logger::Log<log::Trace, log::Singleton>("Steering component socket blocked after sending %d bytes, adding %d bytes to buffer",
-                                                     sent_bytes,
-                                                     length - sent_bytes);
-        sendBuf.append(buf + sent_bytes, length - sent_bytes);
+        lock.lock();
       }
-
-      // Otherwise we sent the whole thing.
-      return true;
     }
 
     void Network::Break(int socket)
     {
       clientConnection.ReportBroken(socket);
-
-      recvBuf.clear();
-      sendBuf.clear();
     }
 
     /**
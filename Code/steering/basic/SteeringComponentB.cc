@@ -4,7 +4,10 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <algorithm>
 #include <cerrno>
+#include <unistd.h>
+#include <vector>
 
 #include "steering/SteeringComponent.h"
 #include "steering/Network.h"
@@ -18,13 +21,14 @@ namespace hemelb
     SteeringComponent::SteeringComponent(Network* iNetwork,
                                          vis::Control* iVisControl,
                                          steering::ImageSendComponent* imageSendComponent,
+                                         RegionStreamer* regionStreamer,
                                          net::Net * iNet,
                                          lb::SimulationState * iSimState,
                                          configuration::SimConfig* iSimConfig,
                                          const util::UnitConverter* iUnits) :
         net::PhasedBroadcastRegular<false, 1, 0, true, false>(iNet, iSimState, SPREADFACTOR),
         mNetwork(iNetwork), mSimState(iSimState), mVisControl(iVisControl), imageSendComponent(imageSendComponent),
-        mUnits(iUnits),simConfig(iSimConfig)
+        regionStreamer(regionStreamer), mUnits(iUnits),simConfig(iSimConfig)
     {
       ClearValues();
       AssignValues();
@@ -66,6 +70,8 @@ namespace hemelb
 
       if (!isConnected)
       {
+        // Nobody to stream the region to.
+        privateSteeringParams[RegionPeriod] = 0.0F;
         return;
       }
 
@@ -105,5 +111,33 @@ namespace hemelb
       // At the moment, it definitely does.
       AssignValues();
     }
+
+    void SteeringComponent::WaitWhileIdle(const net::IOCommunicator& comms,
+                                          unsigned long restartsDone)
+    {
+      log::Logger::Log<log::Info, log::Singleton>("Waiting for the steering client to ask for restart %lu",
+                                                  restartsDone + 1);
+      int waiting = 1;
+      while (waiting)
+      {
+        if (comms.OnIORank())
+        {
+          TopNodeAction();
+          waiting = GetRestartRequest() <= restartsDone
+              && 1 != (int) privateSteeringParams[SetIsTerminal];
+          if (waiting)
+          {
+            usleep(IDLE_POLL_MICROSECONDS);
+          }
+        }
+        comms.Broadcast(waiting, comms.GetIORank());
+      }
+
+      // Not through the phased broadcast, as there are no time steps to spread it over.
+      std::vector<float> params(privateSteeringParams,
+                                privateSteeringParams + STEERABLE_PARAMETERS + 1);
+      comms.Broadcast(params, comms.GetIORank());
+      std::copy(params.begin(), params.end(), privateSteeringParams);
+    }
   }
 }
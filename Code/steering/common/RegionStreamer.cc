@@ -0,0 +1,131 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "steering/RegionStreamer.h"
+#include "extraction/BoxGeometrySelector.h"
+#include "io/writers/xdr/XdrMemWriter.h"
+#include "log/Logger.h"
+
+namespace hemelb
+{
+  namespace steering
+  {
+    RegionStreamer::RegionStreamer(const lb::SimulationState& simulationState,
+                                   extraction::IterableDataSource& dataSource,
+                                   const net::IOCommunicator& ioComms, Network* network) :
+        simulationState(simulationState), dataSource(dataSource), comms(ioComms), network(network),
+            stride(1), period(0), selectionDue(false), streamingThisIteration(false)
+    {
+    }
+
+    void RegionStreamer::SetRegion(const util::Vector3D<float>& newMinimum,
+                                   const util::Vector3D<float>& newMaximum, unsigned newStride,
+                                   unsigned long newPeriod)
+    {
+      if (newStride < 1)
+      {
+        newStride = 1;
+      }
+
+      // The steering parameters are sent on every step, so only select the sites again when the
+      // region has actually changed.
+      if (! (newMinimum == minimum) || ! (newMaximum == maximum) || newStride != stride)
+      {
+        minimum = newMinimum;
+        maximum = newMaximum;
+        stride = newStride;
+        selectionDue = true;
+      }
+      period = newPeriod;
+    }
+
+    void RegionStreamer::SetRequiredProperties(lb::MacroscopicPropertyCache& propertyCache)
+    {
+      streamingThisIteration = period > 0 && simulationState.GetTimeStep() % period == 0;
+      if (streamingThisIteration)
+      {
+        propertyCache.densityCache.SetRefreshFlag();
+        propertyCache.velocityCache.SetRefreshFlag();
+      }
+    }
+
+    bool RegionStreamer::StreamsThisIteration() const
+    {
+      return streamingThisIteration;
+    }
+
+    void RegionStreamer::SelectLocalSites()
+    {
+      extraction::BoxGeometrySelector box(minimum, maximum);
+
+      localSites.clear();
+      site_t siteIndex = 0;
+      dataSource.Reset();
+      while (dataSource.ReadNext())
+      {
+        const util::Vector3D<site_t> position = dataSource.GetPosition();
+        if (position.x % stride == 0 && position.y % stride == 0 && position.z % stride == 0
+            && box.Include(dataSource, position))
+        {
+          localSites.push_back(siteIndex);
+        }
+        ++siteIndex;
+      }
+      selectionDue = false;
+    }
+
+    void RegionStreamer::EndIteration()
+    {
+      if (!streamingThisIteration)
+      {
+        return;
+      }
+
+      if (selectionDue)
+      {
+        SelectLocalSites();
+      }
+
+      std::vector<float> values;
+      values.reserve(localSites.size() * ValuesPerSite);
+      for (size_t site = 0; site < localSites.size(); ++site)
+      {
+        dataSource.ReadAt(localSites[site]);
+        const util::Vector3D<site_t> position = dataSource.GetPosition();
+        const util::Vector3D<extraction::FloatingType> velocity = dataSource.GetVelocity();
+        values.push_back(position.x);
+        values.push_back(position.y);
+        values.push_back(position.z);
+        values.push_back(dataSource.GetPressure());
+        values.push_back(velocity.x);
+        values.push_back(velocity.y);
+        values.push_back(velocity.z);
+      }
+
+      const std::vector<float> allValues = comms.GatherV(values, comms.GetIORank());
+      if (!comms.OnIORank())
+      {
+        return;
+      }
+
+      // Three ints of header, then three ints and four floats for each site.
+      const int siteCount = allValues.size() / ValuesPerSite;
+      std::vector<char> frame(3 * 4 + siteCount * ValuesPerSite * 4);
+      io::writers::xdr::XdrMemWriter frameWriter(&frame[0], frame.size());
+      frameWriter << int(FieldFrameMarker) << int(simulationState.GetTimeStep()) << siteCount;
+      for (int site = 0; site < siteCount; ++site)
+      {
+        const float* siteValues = &allValues[site * ValuesPerSite];
+        frameWriter << int(siteValues[0]) << int(siteValues[1]) << int(siteValues[2]);
+        frameWriter.WriteArray(siteValues + 3, ValuesPerSite - 3);
+      }
+
+      log::Logger::Log<log::Debug, log::Singleton>("Queueing %d region sites at timestep %d",
+                                                    siteCount,
+                                                    simulationState.GetTimeStep());
+      network->QueueFrame(&frame[0], frameWriter.getCurrentStreamPosition());
+    }
+  }
+}
@@ -4,6 +4,7 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <algorithm>
 #include "steering/SteeringComponent.h"
 
 namespace hemelb
@@ -12,6 +13,9 @@ namespace hemelb
   {
     void SteeringComponent::AssignValues()
     {
+      // Don't change the settings under a render in the background.
+      mVisControl->FinishRendering();
+
       mVisControl->visSettings.ctr_x += privateSteeringParams[SceneCentreX];
       mVisControl->visSettings.ctr_y += privateSteeringParams[SceneCentreY];
       mVisControl->visSettings.ctr_z += privateSteeringParams[SceneCentreZ];
@@ -88,6 +92,17 @@ namespace hemelb
       {
         imageSendComponent->SetMaxFramerate(privateSteeringParams[MaxFramerate]);
       }
+      if (regionStreamer != NULL)
+      {
+        regionStreamer->SetRegion(util::Vector3D<float>(privateSteeringParams[RegionMinimumX],
+                                                        privateSteeringParams[RegionMinimumY],
+                                                        privateSteeringParams[RegionMinimumZ]),
+                                  util::Vector3D<float>(privateSteeringParams[RegionMaximumX],
+                                                        privateSteeringParams[RegionMaximumY],
+                                                        privateSteeringParams[RegionMaximumZ]),
+                                  (unsigned) std::max(1.0F, privateSteeringParams[RegionStride]),
+                                  (unsigned long) std::max(0.0F, privateSteeringParams[RegionPeriod]));
+      }
       mVisControl->domainStats.density_threshold_min = lattice_density_min;
       mVisControl->domainStats.density_threshold_minmax_inv = 1.0F / (lattice_density_max - lattice_density_min);
       mVisControl->domainStats.velocity_threshold_max_inv = 1.0F / lattice_velocity_max;
@@ -146,8 +161,46 @@ namespace hemelb
 
       privateSteeringParams[MaxFramerate] = 25.0F;
 
+      // The region of interest to stream, its stride and the steps between frames (none yet).
+      privateSteeringParams[RegionMinimumX] = 0.0F;
+      privateSteeringParams[RegionMinimumY] = 0.0F;
+      privateSteeringParams[RegionMinimumZ] = 0.0F;
+      privateSteeringParams[RegionMaximumX] = 0.0F;
+      privateSteeringParams[RegionMaximumY] = 0.0F;
+      privateSteeringParams[RegionMaximumZ] = 0.0F;
+      privateSteeringParams[RegionStride] = 1.0F;
+      privateSteeringParams[RegionPeriod] = 0.0F;
+
+      // No restarts asked for, of the first configuration, from the initial conditions.
+      privateSteeringParams[RestartRequest] = 0.0F;
+      privateSteeringParams[RestartConfiguration] = 0.0F;
+      privateSteeringParams[RestartWarm] = 0.0F;
+
+      // No samples of the flight recorder asked for.
+      privateSteeringParams[FlightRecorderRequest] = 0.0F;
+
       // Value of DoRendering
       privateSteeringParams[SetDoRendering] = 0.0F;
     }
+
+    unsigned long SteeringComponent::GetRestartRequest() const
+    {
+      return (unsigned long) std::max(0.0F, privateSteeringParams[RestartRequest]);
+    }
+
+    unsigned SteeringComponent::GetRestartConfiguration() const
+    {
+      return (unsigned) std::max(0.0F, privateSteeringParams[RestartConfiguration]);
+    }
+
+    bool SteeringComponent::IsWarmRestart() const
+    {
+      return 1 == (int) privateSteeringParams[RestartWarm];
+    }
+
+    unsigned long SteeringComponent::GetFlightRecorderRequest() const
+    {
+      return (unsigned long) std::max(0.0F, privateSteeringParams[FlightRecorderRequest]);
+    }
   }
 }
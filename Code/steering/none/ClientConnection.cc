@@ -38,6 +38,15 @@ namespace hemelb
       return -1;
     }
 
+    int ClientConnection::GetCurrentSocket()
+    {
+      return -1;
+    }
+
+    void ClientConnection::WaitForClient()
+    {
+    }
+
     void ClientConnection::ReportBroken(int iSocketNum)
     {
     }
@@ -25,11 +25,15 @@ namespace hemelb
   namespace steering
   {
     Network::Network(int steeringSessionId, reporting::Timers & timings) :
-      clientConnection(steeringSessionId, timings)
+      clientConnection(steeringSessionId, timings), stopping(false)
     {
 
     }
 
+    Network::~Network()
+    {
+    }
+
     /**
      * Do nothing.
      *
@@ -43,26 +47,38 @@ namespace hemelb
       return false;
     }
 
-    void Network::PreReceive()
+    bool Network::IsConnected()
     {
+      return false;
     }
 
-    bool Network::IsConnected()
+    /**
+     * Do nothing.
+     *
+     * @param image
+     * @param length
+     * @param params
+     */
+    void Network::QueueFrame(const char* image, const int length, const SimulationParameters& params)
     {
-      return false;
     }
 
     /**
      * Do nothing.
      *
-     * @param sockid
-     * @param buf
+     * @param data
      * @param length
-     * @return Returns the number of bytes sent or -1 on failure.
      */
-    bool Network::send_all(const char *buf, const int length)
+    void Network::QueueFrame(const char* data, const int length)
+    {
+    }
+
+    void Network::Enqueue(const char* data, const int length, bool hasParams, const SimulationParameters& params)
+    {
+    }
+
+    void Network::SendFrames()
     {
-      return false;
     }
 
     void Network::Break(int socket)
@@ -5,6 +5,7 @@
 // license in the file LICENSE.
 
 #include "steering/SteeringComponent.h"
+#include "log/Logger.h"
 
 namespace hemelb
 {
@@ -24,12 +25,13 @@ namespace hemelb
     SteeringComponent::SteeringComponent(Network* network,
                                          vis::Control* iVisControl,
                                          steering::ImageSendComponent* imageSendComponent,
+                                         RegionStreamer* regionStreamer,
                                          net::Net * iNet,
                                          lb::SimulationState * iSimState,
                                          configuration::SimConfig* iSimConfig,
                                          const util::UnitConverter* iUnits) :
         net::PhasedBroadcastRegular<false, 1, 0, true, false>(iNet, iSimState, SPREADFACTOR),
-        mSimState(iSimState), mVisControl(iVisControl), imageSendComponent(imageSendComponent), mUnits(iUnits), simConfig(iSimConfig)
+        mSimState(iSimState), mVisControl(iVisControl), imageSendComponent(imageSendComponent), regionStreamer(regionStreamer), mUnits(iUnits), simConfig(iSimConfig)
     {
       ClearValues();
       AssignValues();
@@ -58,5 +60,12 @@ namespace hemelb
     {
       AssignValues();
     }
+
+    void SteeringComponent::WaitWhileIdle(const net::IOCommunicator& comms,
+                                          unsigned long restartsDone)
+    {
+      // Nobody can ask for a restart.
+      log::Logger::Log<log::Warning, log::Singleton>("Not serving further simulations, as HemeLB was built without steering");
+    }
   }
 }
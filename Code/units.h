@@ -26,6 +26,20 @@ namespace hemelb
   typedef int64_t site_t;
   typedef int proc_t;
   typedef double distribn_t;
+  // The type the lattice stores the distributions as. They are always loaded into distribn_t
+  // to be calculated with.
+#ifdef HEMELB_USE_SINGLE_PRECISION_DISTRIBUTIONS
+  typedef float stored_distribn_t;
+#else
+  typedef distribn_t stored_distribn_t;
+#endif
+  // With either, or with some sites' distributions kept compressed, a site's distributions
+  // aren't an array of distribn_t in the lattice, so must be gathered into a buffer to be read
+  // as one.
+#if defined(HEMELB_USE_SOA_DISTRIBUTIONS) || defined(HEMELB_USE_SINGLE_PRECISION_DISTRIBUTIONS) \
+    || defined(HEMELB_USE_COMPRESSED_COLD_SITES)
+#define HEMELB_GATHER_SITE_DISTRIBUTIONS
+#endif
   typedef unsigned Direction;
   typedef uint64_t sitedata_t;
 
@@ -119,7 +119,7 @@ namespace hemelb
                     link.distanceToIntersection = randomDistance;
                   }
 
-                  site.links.push_back(link);
+                  site.SetLink(direction - 1, link);
 
                 }
 
@@ -174,6 +174,8 @@ namespace hemelb
           TestSiteData mutableSiteData(siteData[site]);
           mutableSiteData.SetHasWall(direction);
           siteData[site] = geometry::SiteData(mutableSiteData);
+          InitialiseWallLinks();
+          InitialiseLinkPatternRanges();
         }
 
         /***
@@ -184,6 +186,7 @@ namespace hemelb
           TestSiteData mutableSiteData(siteData[site]);
           mutableSiteData.SetHasIolet(direction);
           siteData[site] = geometry::SiteData(mutableSiteData);
+          InitialiseLinkPatternRanges();
         }
 
         /***
@@ -194,6 +197,7 @@ namespace hemelb
           TestSiteData mutableSiteData(siteData[site]);
           mutableSiteData.SetIoletId(id);
           siteData[site] = geometry::SiteData(mutableSiteData);
+          InitialiseLinkPatternRanges();
         }
 
         /***
@@ -223,7 +227,7 @@ namespace hemelb
         {
           for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
           {
-            *GetFOld(site * LatticeType::NUMVECTORS + direction) = fOldIn[direction];
+            *GetFOld(GetDistributionIndex<LatticeType>(site, direction)) = fOldIn[direction];
           }
         }
 
@@ -231,7 +235,8 @@ namespace hemelb
         FourCubeLatticeData(hemelb::geometry::Geometry& readResult, const net::IOCommunicator& comms) :
           hemelb::geometry::LatticeData(lb::lattices::D3Q15::GetLatticeInfo(), readResult, comms)
         {
-
+          // Tests give walls and iolets to bulk sites, which then need their own distances.
+          StoreWallDataAtBulkSites();
         }
     };
   }
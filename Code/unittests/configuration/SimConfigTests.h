@@ -53,6 +53,14 @@ namespace hemelb
             CPPUNIT_ASSERT(!monConfig->doIncompressibilityCheck);
             CPPUNIT_ASSERT(!monConfig->convergenceTerminate);
             CPPUNIT_ASSERT_DOUBLES_EQUAL(0., monConfig->convergenceRelativeTolerance, 1e-6);
+            CPPUNIT_ASSERT_EQUAL(0lu, monConfig->accelerationPeriod);
+            CPPUNIT_ASSERT_EQUAL(1lu, monConfig->checkPeriod);
+            CPPUNIT_ASSERT_EQUAL(site_t(1), monConfig->siteStride);
+            CPPUNIT_ASSERT(config->GetStabilisedRegions().empty());
+            CPPUNIT_ASSERT(config->GetCompressedRegions().empty());
+            CPPUNIT_ASSERT(!config->GetBalanceConstraints().BalancesMemory());
+            CPPUNIT_ASSERT(config->GetFlowDiagnostics() == NULL);
+            CPPUNIT_ASSERT(config->GetImageViews().empty());
           }
 
           void Test_0_2_1_Read()
@@ -73,6 +81,45 @@ namespace hemelb
             CPPUNIT_ASSERT_EQUAL(1e-9, monConfig->convergenceRelativeTolerance);
             CPPUNIT_ASSERT_EQUAL(monConfig->convergenceVariable, extraction::OutputField::Velocity);
             CPPUNIT_ASSERT_EQUAL(0.01, monConfig->convergenceReferenceValue); // 1 m/s * (delta_t / delta_x) = 0.01
+            CPPUNIT_ASSERT_EQUAL(1000lu, monConfig->accelerationPeriod);
+            CPPUNIT_ASSERT_EQUAL(1.5, monConfig->accelerationFactor);
+            CPPUNIT_ASSERT_EQUAL(10lu, monConfig->checkPeriod);
+            CPPUNIT_ASSERT_EQUAL(site_t(2), monConfig->siteStride);
+
+            const hemelb::extraction::FlowDiagnosticsFile* diagnostics = config->GetFlowDiagnostics();
+            CPPUNIT_ASSERT(diagnostics != NULL);
+            CPPUNIT_ASSERT_EQUAL(std::string("flow.csv"), diagnostics->filename);
+            CPPUNIT_ASSERT_EQUAL(50lu, diagnostics->period);
+            CPPUNIT_ASSERT_EQUAL(size_t(1), diagnostics->wallRegions.size());
+            CPPUNIT_ASSERT_EQUAL(std::string("sac"), diagnostics->wallRegions[0].name);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.03, diagnostics->wallRegions[0].maximum.z, 1e-9);
+
+            // Only the sites inside the box are in the region.
+            const std::vector<geometry::SiteBox>& regions = config->GetStabilisedRegions();
+            CPPUNIT_ASSERT_EQUAL(size_t(1), regions.size());
+            CPPUNIT_ASSERT_EQUAL(util::Vector3D<site_t>(1, 0, 0), regions[0].minimum);
+            CPPUNIT_ASSERT_EQUAL(util::Vector3D<site_t>(10, 10, 5), regions[0].maximum);
+            CPPUNIT_ASSERT(regions[0].Contains(util::Vector3D<site_t>(10, 0, 5)));
+            CPPUNIT_ASSERT(!regions[0].Contains(util::Vector3D<site_t>(0, 0, 0)));
+            const std::vector<geometry::SiteBox>& compressed = config->GetCompressedRegions();
+            CPPUNIT_ASSERT_EQUAL(size_t(1), compressed.size());
+            CPPUNIT_ASSERT_EQUAL(util::Vector3D<site_t>(1, 10, 0), compressed[0].minimum);
+            CPPUNIT_ASSERT_EQUAL(util::Vector3D<site_t>(10, 20, 10), compressed[0].maximum);
+
+            const geometry::decomposition::BalanceConstraints& balance =
+                config->GetBalanceConstraints();
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1.01, balance.computeTolerance, 1e-12);
+            CPPUNIT_ASSERT(balance.BalancesMemory());
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1.1, balance.memoryTolerance, 1e-12);
+
+            const std::vector<SimConfig::ImageView>& views = config->GetImageViews();
+            CPPUNIT_ASSERT_EQUAL(size_t(1), views.size());
+            CPPUNIT_ASSERT_EQUAL(256, views[0].pixelsX);
+            CPPUNIT_ASSERT_EQUAL(128, views[0].pixelsY);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(90.0, views[0].longitude, 1e-6);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(10.0, views[0].latitude, 1e-6);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, views[0].zoom, 1e-6);
+            CPPUNIT_ASSERT_EQUAL(vis::VisSettings::ISOSURFACESANDGLYPHS, views[0].mode);
           }
 
           void TestXMLFileContent()
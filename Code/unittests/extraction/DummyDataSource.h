@@ -73,6 +73,12 @@ namespace hemelb
             return location < siteCount;
           }
 
+          bool ReadAt(site_t index)
+          {
+            location = index;
+            return location < siteCount;
+          }
+
           hemelb::util::Vector3D<site_t> GetPosition() const
           {
             return gridPositions[location];
@@ -134,14 +140,43 @@ namespace hemelb
           {
             return true;
           }
+          /**
+           * The sites on the faces of the cube are the wall sites.
+           */
           bool IsWallSite(const util::Vector3D<site_t>& location) const
           {
-            /// @todo: #375 This method is not covered by any test. I'm leaving it unimplemented.
-            assert(false);
-
+            for (unsigned axis = 0; axis < 3; ++axis)
+            {
+              if (location[axis] == 0 || location[axis] == 3)
+              {
+                return true;
+              }
+            }
             return false;
           }
 
+          /**
+           * The normal points out of each face of the cube the site is on.
+           */
+          util::Vector3D<distribn_t> GetWallNormal() const
+          {
+            util::Vector3D<distribn_t> normal(0.);
+            for (unsigned axis = 0; axis < 3; ++axis)
+            {
+              if (gridPositions[location][axis] == 0)
+              {
+                normal[axis] = -1.;
+              }
+              else if (gridPositions[location][axis] == 3)
+              {
+                normal[axis] = 1.;
+              }
+            }
+            return normal.GetMagnitudeSquared() > 0.
+              ? normal / normal.GetMagnitude()
+              : normal;
+          }
+
         private:
           helpers::RandomSource randomNumberGenerator;
           const site_t siteCount;
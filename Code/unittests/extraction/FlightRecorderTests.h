@@ -0,0 +1,234 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_EXTRACTION_FLIGHTRECORDERTESTS_H
+#define HEMELB_UNITTESTS_EXTRACTION_FLIGHTRECORDERTESTS_H
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include <cppunit/TestFixture.h>
+#include "extraction/FlightRecorder.h"
+#include "extraction/LbDataSourceIterator.h"
+#include "io/formats/formats.h"
+#include "io/formats/flightrecorder.h"
+#include "io/writers/xdr/XdrFileReader.h"
+#include "unittests/helpers/FourCubeBasedTestFixture.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace extraction
+    {
+      namespace flightrecorder = hemelb::io::formats::flightrecorder;
+
+      class FlightRecorderTests : public helpers::FourCubeBasedTestFixture
+      {
+          CPPUNIT_TEST_SUITE (FlightRecorderTests);
+          CPPUNIT_TEST (TestKeepsLatestSamples);
+          CPPUNIT_TEST (TestFewerSamplesThanCapacity);CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void setUp()
+          {
+            helpers::FourCubeBasedTestFixture::setUp();
+            propertyCache = new lb::MacroscopicPropertyCache(*simState, *latDat);
+            source = new hemelb::extraction::LbDataSourceIterator(*propertyCache,
+                                                                  *latDat,
+                                                                  0,
+                                                                  *unitConverter);
+            region.minimum = util::Vector3D<site_t>(1, 1, 1);
+            region.maximum = util::Vector3D<site_t>(2, 2, 2);
+            regionSites.clear();
+            for (site_t site = 0; site < numSites; ++site)
+            {
+              if (region.Contains(latDat->GetSite(site).GetGlobalSiteCoords()))
+              {
+                regionSites.push_back(site);
+              }
+            }
+            // Keep two samples, taken every other step.
+            recorder = new hemelb::extraction::FlightRecorder(*simState,
+                                                              *source,
+                                                              *latDat,
+                                                              Comms(),
+                                                              2,
+                                                              2,
+                                                              flightrecorder::PressureField
+                                                                  | flightrecorder::VelocityField,
+                                                              region);
+          }
+
+          void tearDown()
+          {
+            delete recorder;
+            delete source;
+            delete propertyCache;
+            helpers::FourCubeBasedTestFixture::tearDown();
+          }
+
+          void TestKeepsLatestSamples()
+          {
+            const std::vector<LatticeTimeStep> sampled = Run(7);
+            CPPUNIT_ASSERT_EQUAL(size_t(3), sampled.size());
+            recorder->Write(fileName);
+            CheckFile(std::vector<LatticeTimeStep>(sampled.end() - 2, sampled.end()));
+          }
+
+          void TestFewerSamplesThanCapacity()
+          {
+            const std::vector<LatticeTimeStep> sampled = Run(2);
+            CPPUNIT_ASSERT_EQUAL(size_t(1), sampled.size());
+            recorder->Write(fileName);
+            CheckFile(sampled);
+          }
+
+        private:
+          /**
+           * Run a number of steps, each with a different pressure, returning those sampled on.
+           */
+          std::vector<LatticeTimeStep> Run(unsigned steps)
+          {
+            std::vector<LatticeTimeStep> sampled;
+            for (unsigned step = 0; step < steps; ++step)
+            {
+              for (site_t site = 0; site < numSites; ++site)
+              {
+                propertyCache->densityCache.Put(site, GetDensity(site, simState->GetTimeStep()));
+                propertyCache->velocityCache.Put(site,
+                                                 util::Vector3D<distribn_t>(0.01, -0.02, 0.0001 * site));
+              }
+              recorder->SetRequiredProperties(*propertyCache);
+              if (recorder->SamplesThisIteration())
+              {
+                sampled.push_back(simState->GetTimeStep());
+              }
+              recorder->EndIteration();
+              simState->Increment();
+            }
+            return sampled;
+          }
+
+          distribn_t GetDensity(site_t site, LatticeTimeStep timeStep) const
+          {
+            return 1.0 + 0.001 * site + 0.01 * timeStep;
+          }
+
+          void CheckFile(const std::vector<LatticeTimeStep>& expectedSteps)
+          {
+            FILE* file = std::fopen(fileName, "r");
+            CPPUNIT_ASSERT(file != NULL);
+            hemelb::io::writers::xdr::XdrFileReader reader(file);
+
+            unsigned value;
+            uint64_t longValue;
+            reader.readUnsignedInt(value);
+            CPPUNIT_ASSERT_EQUAL(unsigned(hemelb::io::formats::HemeLbMagicNumber), value);
+            reader.readUnsignedInt(value);
+            CPPUNIT_ASSERT_EQUAL(unsigned(flightrecorder::MagicNumber), value);
+            reader.readUnsignedInt(value);
+            CPPUNIT_ASSERT_EQUAL(unsigned(flightrecorder::VersionNumber), value);
+            reader.readUnsignedInt(value);
+            CPPUNIT_ASSERT_EQUAL(unsigned(flightrecorder::PressureField
+                                     | flightrecorder::VelocityField),
+                                 value);
+            const unsigned numVectors = latDat->GetLatticeInfo().GetNumVectors();
+            reader.readUnsignedInt(value);
+            CPPUNIT_ASSERT_EQUAL(numVectors, value);
+            reader.readUnsignedInt(value);
+            CPPUNIT_ASSERT_EQUAL(unsigned(expectedSteps.size()), value);
+            reader.readUnsignedLong(longValue);
+            CPPUNIT_ASSERT_EQUAL(uint64_t(simState->GetTimeStep()), longValue);
+            reader.readUnsignedLong(longValue);
+            CPPUNIT_ASSERT_EQUAL(uint64_t(numSites), longValue);
+            reader.readUnsignedLong(longValue);
+            CPPUNIT_ASSERT_EQUAL(uint64_t(regionSites.size()), longValue);
+
+            // The samples' time steps, oldest first.
+            for (size_t sample = 0; sample < expectedSteps.size(); ++sample)
+            {
+              reader.readUnsignedLong(longValue);
+              CPPUNIT_ASSERT_EQUAL(uint64_t(expectedSteps[sample]), longValue);
+            }
+
+            // Each site's coordinates and, for each sample, its pressure and velocity.
+            for (site_t site = 0; site < numSites; ++site)
+            {
+              CheckPosition(reader, site);
+              for (size_t sample = 0; sample < expectedSteps.size(); ++sample)
+              {
+                float pressure, velocity[3];
+                reader.readFloat(pressure);
+                for (unsigned component = 0; component < 3; ++component)
+                {
+                  reader.readFloat(velocity[component]);
+                }
+                const double expected =
+                    unitConverter->ConvertPressureToPhysicalUnits(GetDensity(site,
+                                                                             expectedSteps[sample])
+                        * Cs2);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, pressure, 1e-5 * std::abs(expected));
+                source->ReadAt(site);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(source->GetVelocity().z,
+                                             velocity[2],
+                                             1e-5 * std::abs(source->GetVelocity().z) + 1e-12);
+              }
+            }
+
+            // Each region site's coordinates and, for each sample, its distributions.
+            std::vector<distribn_t> fOld(numVectors);
+            for (size_t regionSite = 0; regionSite < regionSites.size(); ++regionSite)
+            {
+              CheckPosition(reader, regionSites[regionSite]);
+              const distribn_t* f = latDat->GetSite(regionSites[regionSite]).GetFOld(numVectors,
+                                                                                     &fOld[0]);
+              for (size_t sample = 0; sample < expectedSteps.size(); ++sample)
+              {
+                for (unsigned direction = 0; direction < numVectors; ++direction)
+                {
+                  float distribution;
+                  reader.readFloat(distribution);
+                  CPPUNIT_ASSERT_DOUBLES_EQUAL(f[direction],
+                                               distribution,
+                                               1e-6 * std::abs(f[direction]));
+                }
+              }
+            }
+
+            // And nothing more.
+            float extra;
+            CPPUNIT_ASSERT(!reader.readFloat(extra));
+            std::fclose(file);
+          }
+
+          void CheckPosition(hemelb::io::writers::xdr::XdrFileReader& reader, site_t site)
+          {
+            const util::Vector3D<site_t> position = latDat->GetSite(site).GetGlobalSiteCoords();
+            unsigned coordinates[3];
+            for (unsigned axis = 0; axis < 3; ++axis)
+            {
+              reader.readUnsignedInt(coordinates[axis]);
+            }
+            CPPUNIT_ASSERT_EQUAL(unsigned(position.x), coordinates[0]);
+            CPPUNIT_ASSERT_EQUAL(unsigned(position.y), coordinates[1]);
+            CPPUNIT_ASSERT_EQUAL(unsigned(position.z), coordinates[2]);
+          }
+
+          static const char* const fileName;
+          lb::MacroscopicPropertyCache* propertyCache;
+          hemelb::extraction::LbDataSourceIterator* source;
+          hemelb::extraction::FlightRecorder* recorder;
+          geometry::SiteBox region;
+          std::vector<site_t> regionSites;
+      };
+
+      const char* const FlightRecorderTests::fileName = "flight_recorder.dat";
+      CPPUNIT_TEST_SUITE_REGISTRATION (FlightRecorderTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_EXTRACTION_FLIGHTRECORDERTESTS_H */
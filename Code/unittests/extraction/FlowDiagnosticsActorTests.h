@@ -0,0 +1,178 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_EXTRACTION_FLOWDIAGNOSTICSACTORTESTS_H
+#define HEMELB_UNITTESTS_EXTRACTION_FLOWDIAGNOSTICSACTORTESTS_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cppunit/TestFixture.h>
+#include "extraction/FlowDiagnosticsActor.h"
+#include "extraction/LbDataSourceIterator.h"
+#include "lb/iolets/InOutLetCosine.h"
+#include "unittests/helpers/FourCubeBasedTestFixture.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace extraction
+    {
+      class FlowDiagnosticsActorTests : public helpers::FourCubeBasedTestFixture
+      {
+          CPPUNIT_TEST_SUITE (FlowDiagnosticsActorTests);
+          CPPUNIT_TEST (TestIolets);
+          CPPUNIT_TEST (TestWallRegion);
+          CPPUNIT_TEST (TestPeriod);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void setUp()
+          {
+            helpers::FourCubeBasedTestFixture::setUp();
+            std::remove(fileName);
+            propertyCache = new lb::MacroscopicPropertyCache(*simState, *latDat);
+            for (site_t site = 0; site < numSites; ++site)
+            {
+              propertyCache->densityCache.Put(site, 1.0);
+              propertyCache->velocityCache.Put(site, util::Vector3D<distribn_t>(0.001, 0.002, 0.01));
+              propertyCache->wallShearStressMagnitudeCache.Put(site, 0.0002);
+            }
+            source = new hemelb::extraction::LbDataSourceIterator(*propertyCache,
+                                                                  *latDat,
+                                                                  0,
+                                                                  *unitConverter);
+            timings = new reporting::Timers(Comms());
+
+            // The four cube's inlet is at its lowest z and its outlet at its highest.
+            inlet = new lb::iolets::InOutLetCosine();
+            inlet->SetNormal(util::Vector3D<Dimensionless>(0, 0, 1));
+            outlet = new lb::iolets::InOutLetCosine();
+            outlet->SetNormal(util::Vector3D<Dimensionless>(0, 0, -1));
+            inlets.push_back(inlet);
+            outlets.push_back(outlet);
+
+            spec.filename = fileName;
+            spec.period = 2;
+            hemelb::extraction::FlowDiagnosticsFile::WallRegion region;
+            region.name = "all";
+            region.minimum = PhysicalPosition(-1.);
+            region.maximum = PhysicalPosition(1.);
+            spec.wallRegions.push_back(region);
+
+            diagnostics = new hemelb::extraction::FlowDiagnosticsActor(*simState,
+                                                                       &spec,
+                                                                       *source,
+                                                                       *latDat,
+                                                                       inlets,
+                                                                       outlets,
+                                                                       *timings,
+                                                                       Comms());
+          }
+
+          void tearDown()
+          {
+            delete diagnostics;
+            delete inlet;
+            delete outlet;
+            delete timings;
+            delete source;
+            delete propertyCache;
+            std::remove(fileName);
+            helpers::FourCubeBasedTestFixture::tearDown();
+          }
+
+          void TestIolets()
+          {
+            Sample();
+            diagnostics->Flush();
+            const std::vector<std::vector<double> > lines = ReadLines();
+            CPPUNIT_ASSERT_EQUAL(size_t(1), lines.size());
+            // The step and time, two values for each iolet and two for the region.
+            CPPUNIT_ASSERT_EQUAL(size_t(8), lines[0].size());
+
+            // A layer of 4 x 4 sites, each an axis link across the iolet, so a voxel face of it.
+            source->ReadAt(0);
+            const double voxelArea = source->GetVoxelSize() * source->GetVoxelSize();
+            const double flowRate = 16 * voxelArea * source->GetVelocity().z;
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(flowRate, lines[0][2], 1e-6 * flowRate);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(source->GetPressure(), lines[0][3], 1e-5);
+            // Along the outlet's normal, which points back into the fluid.
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(-flowRate, lines[0][4], 1e-6 * flowRate);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(source->GetPressure(), lines[0][5], 1e-5);
+          }
+
+          void TestWallRegion()
+          {
+            Sample();
+            diagnostics->Flush();
+            const std::vector<std::vector<double> > lines = ReadLines();
+            source->ReadAt(0);
+            CPPUNIT_ASSERT(lines[0][6] > 0.);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(source->GetShearStress(), lines[0][7], 1e-9);
+          }
+
+          void TestPeriod()
+          {
+            // Only every other step, and each line once the next step has finished it.
+            Sample();
+            CPPUNIT_ASSERT_EQUAL(size_t(0), ReadLines().size());
+            Sample();
+            const std::vector<std::vector<double> > lines = ReadLines();
+            CPPUNIT_ASSERT_EQUAL(size_t(1), lines.size());
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(2., lines[0][0], 1e-12);
+            diagnostics->Flush();
+            CPPUNIT_ASSERT_EQUAL(size_t(1), ReadLines().size());
+          }
+
+        private:
+          void Sample()
+          {
+            simState->Increment();
+            diagnostics->EndIteration();
+          }
+
+          std::vector<std::vector<double> > ReadLines() const
+          {
+            std::vector<std::vector<double> > lines;
+            std::ifstream file(fileName);
+            std::string line;
+            // Skip the column names.
+            std::getline(file, line);
+            while (std::getline(file, line))
+            {
+              std::istringstream values(line);
+              lines.push_back(std::vector<double>());
+              std::string value;
+              while (std::getline(values, value, ','))
+              {
+                lines.back().push_back(std::atof(value.c_str()));
+              }
+            }
+            return lines;
+          }
+
+          lb::MacroscopicPropertyCache* propertyCache;
+          hemelb::extraction::LbDataSourceIterator* source;
+          reporting::Timers* timings;
+          lb::iolets::InOutLetCosine* inlet;
+          lb::iolets::InOutLetCosine* outlet;
+          std::vector<lb::iolets::InOutLet*> inlets;
+          std::vector<lb::iolets::InOutLet*> outlets;
+          hemelb::extraction::FlowDiagnosticsFile spec;
+          hemelb::extraction::FlowDiagnosticsActor* diagnostics;
+          static const char* fileName;
+      };
+      const char* FlowDiagnosticsActorTests::fileName = "flow.csv";
+      CPPUNIT_TEST_SUITE_REGISTRATION (FlowDiagnosticsActorTests);
+    }
+  }
+}
+
+#endif // HEMELB_UNITTESTS_EXTRACTION_FLOWDIAGNOSTICSACTORTESTS_H
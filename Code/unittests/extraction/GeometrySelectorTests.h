@@ -16,6 +16,7 @@
 #include "extraction/StraightLineGeometrySelector.h"
 #include "extraction/PlaneGeometrySelector.h"
 #include "extraction/WholeGeometrySelector.h"
+#include "extraction/BoxGeometrySelector.h"
 #include "extraction/GeometrySurfaceSelector.h"
 #include "unittests/FourCubeLatticeData.h"
 #include "unittests/helpers/HasCommsTestFixture.h"
@@ -32,6 +33,7 @@ namespace hemelb
           CPPUNIT_TEST ( TestStraightLineGeometrySelector);
           CPPUNIT_TEST ( TestPlaneGeometrySelector);
           CPPUNIT_TEST ( TestWholeGeometrySelector);
+          CPPUNIT_TEST ( TestBoxGeometrySelector);
           CPPUNIT_TEST ( TestGeometrySurfaceSelector);
           CPPUNIT_TEST ( TestSurfacePointSelector);
           CPPUNIT_TEST ( TestSurfacePointSelectorMultipleHits);CPPUNIT_TEST_SUITE_END();
@@ -47,6 +49,8 @@ namespace hemelb
                 planeRadius(distribn_t(CubeSize) * VoxelSize / 3.0),
                 lineEndPoint1(CentreCoordinate * VoxelSize),
                 lineEndPoint2( (CubeSize + 1) * VoxelSize),
+                boxMinimum(1.5 * VoxelSize, 2.5 * VoxelSize, 0),
+                boxMaximum(4.5 * VoxelSize, 3.5 * VoxelSize, (CubeSize + 1) * VoxelSize),
                 surfacePoint( (CubeSize + 1) * VoxelSize),
 
                 surfacePointMultipleHits( (CubeSize + 1) * VoxelSize,
@@ -78,6 +82,7 @@ namespace hemelb
                                                                 planeRadius);
             straightLineGeometrySelector
                 = new hemelb::extraction::StraightLineGeometrySelector(lineEndPoint1, lineEndPoint2);
+            boxGeometrySelector = new hemelb::extraction::BoxGeometrySelector(boxMinimum, boxMaximum);
             wholeGeometrySelector = new hemelb::extraction::WholeGeometrySelector();
 
             geometrySurfaceSelector = new hemelb::extraction::GeometrySurfaceSelector();
@@ -93,6 +98,7 @@ namespace hemelb
             delete planeGeometrySelectorWithRadius;
             delete straightLineGeometrySelector;
             delete wholeGeometrySelector;
+            delete boxGeometrySelector;
             delete geometrySurfaceSelector;
 
             delete dataSourceIterator;
@@ -191,6 +197,23 @@ namespace hemelb
             CPPUNIT_ASSERT_EQUAL(CubeSize * CubeSize * CubeSize, count);
           }
 
+          void TestBoxGeometrySelector()
+          {
+            TestOutOfGeometrySites(boxGeometrySelector);
+
+            // The box takes in x from 2 to 4 and y of 3 only, and the whole of the cube in z.
+            std::vector<util::Vector3D<site_t> > includedCoords;
+            for (site_t xCoord = 2; xCoord <= 4; ++xCoord)
+            {
+              for (site_t zCoord = 1; zCoord <= CubeSize; ++zCoord)
+              {
+                includedCoords.push_back(util::Vector3D<site_t>(xCoord, 3, zCoord));
+              }
+            }
+
+            TestExpectedIncludedSites(boxGeometrySelector, includedCoords);
+          }
+
           void TestGeometrySurfaceSelector()
           {
             TestOutOfGeometrySites(geometrySurfaceSelector);
@@ -309,6 +332,8 @@ namespace hemelb
           const distribn_t planeRadius;
           const util::Vector3D<distribn_t> lineEndPoint1;
           const util::Vector3D<distribn_t> lineEndPoint2;
+          const util::Vector3D<distribn_t> boxMinimum;
+          const util::Vector3D<distribn_t> boxMaximum;
           const util::Vector3D<distribn_t> surfacePoint;
           const util::Vector3D<distribn_t> surfacePointMultipleHits;
 
@@ -322,6 +347,7 @@ namespace hemelb
           hemelb::extraction::PlaneGeometrySelector* planeGeometrySelectorWithRadius;
           hemelb::extraction::StraightLineGeometrySelector* straightLineGeometrySelector;
           hemelb::extraction::WholeGeometrySelector* wholeGeometrySelector;
+          hemelb::extraction::BoxGeometrySelector* boxGeometrySelector;
           hemelb::extraction::GeometrySurfaceSelector* geometrySurfaceSelector;
           hemelb::extraction::SurfacePointSelector* surfacePointSelector;
           hemelb::extraction::SurfacePointSelector* surfacePointSelectorMultipleHits;
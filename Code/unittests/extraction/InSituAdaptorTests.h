@@ -0,0 +1,133 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_EXTRACTION_INSITUADAPTORTESTS_H
+#define HEMELB_UNITTESTS_EXTRACTION_INSITUADAPTORTESTS_H
+
+#include <cppunit/TestFixture.h>
+#include "extraction/InSituAdaptor.h"
+#include "unittests/helpers/FourCubeBasedTestFixture.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace extraction
+    {
+      /**
+       * Remembers what it was last given.
+       */
+      class RecordingBackend : public hemelb::extraction::InSituBackend
+      {
+        public:
+          RecordingBackend() :
+              executions(0), timeStep(0)
+          {
+          }
+
+          void Execute(LatticeTimeStep step, PhysicalTime time,
+                       const hemelb::extraction::InSituMesh& executedMesh)
+          {
+            ++executions;
+            timeStep = step;
+            mesh = executedMesh;
+          }
+
+          unsigned executions;
+          LatticeTimeStep timeStep;
+          hemelb::extraction::InSituMesh mesh;
+      };
+
+      class InSituAdaptorTests : public helpers::FourCubeBasedTestFixture
+      {
+          CPPUNIT_TEST_SUITE (InSituAdaptorTests);
+          CPPUNIT_TEST (TestMesh);
+          CPPUNIT_TEST (TestPeriod);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void setUp()
+          {
+            helpers::FourCubeBasedTestFixture::setUp();
+            propertyCache = new lb::MacroscopicPropertyCache(*simState, *latDat);
+            timings = new reporting::Timers(Comms());
+            backend = new RecordingBackend();
+            adaptor = new hemelb::extraction::InSituAdaptor(*simState,
+                                                            *latDat,
+                                                            *propertyCache,
+                                                            *unitConverter,
+                                                            backend,
+                                                            2,
+                                                            *timings);
+          }
+
+          void tearDown()
+          {
+            delete adaptor;
+            delete timings;
+            delete propertyCache;
+            helpers::FourCubeBasedTestFixture::tearDown();
+          }
+
+          void TestMesh()
+          {
+            adaptor->SetRequiredProperties(*propertyCache);
+            for (site_t site = 0; site < numSites; ++site)
+            {
+              propertyCache->densityCache.Put(site, 1.0 + site);
+              propertyCache->velocityCache.Put(site, util::Vector3D<distribn_t>(0.0, 0.0, site));
+            }
+            adaptor->EndIteration();
+
+            CPPUNIT_ASSERT_EQUAL(1u, backend->executions);
+            const hemelb::extraction::InSituMesh& mesh = backend->mesh;
+            CPPUNIT_ASSERT_EQUAL(numSites, mesh.pointCount);
+
+            const site_t lastSite = numSites - 1;
+            const LatticePosition lastPosition(latDat->GetSite(lastSite).GetGlobalSiteCoords());
+            const PhysicalPosition expected =
+                unitConverter->ConvertPositionToPhysicalUnits(lastPosition);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.x, mesh.coordinates[3 * lastSite], 1e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.z, mesh.coordinates[3 * lastSite + 2], 1e-12);
+
+            // The fields are the cache's own arrays.
+            CPPUNIT_ASSERT_EQUAL(size_t(2), mesh.fields.size());
+            CPPUNIT_ASSERT(mesh.fields[0].data == &propertyCache->densityCache.Get(0));
+            CPPUNIT_ASSERT_EQUAL(1u, mesh.fields[0].components);
+            CPPUNIT_ASSERT_EQUAL(3u, mesh.fields[1].components);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(double(lastSite),
+                                         mesh.fields[1].data[3 * lastSite + 2],
+                                         1e-12);
+          }
+
+          void TestPeriod()
+          {
+            CPPUNIT_ASSERT(adaptor->RunsThisIteration());
+            simState->Increment();
+            CPPUNIT_ASSERT(!adaptor->RunsThisIteration());
+            propertyCache->ResetRequirements();
+            adaptor->SetRequiredProperties(*propertyCache);
+            CPPUNIT_ASSERT(!propertyCache->densityCache.RequiresRefresh());
+
+            simState->Increment();
+            CPPUNIT_ASSERT(adaptor->RunsThisIteration());
+            adaptor->SetRequiredProperties(*propertyCache);
+            CPPUNIT_ASSERT(propertyCache->densityCache.RequiresRefresh());
+            CPPUNIT_ASSERT(propertyCache->velocityCache.RequiresRefresh());
+          }
+
+        private:
+          lb::MacroscopicPropertyCache* propertyCache;
+          reporting::Timers* timings;
+          RecordingBackend* backend;
+          hemelb::extraction::InSituAdaptor* adaptor;
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (InSituAdaptorTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_EXTRACTION_INSITUADAPTORTESTS_H */
@@ -0,0 +1,122 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_EXTRACTION_LBDATASOURCEITERATORTESTS_H
+#define HEMELB_UNITTESTS_EXTRACTION_LBDATASOURCEITERATORTESTS_H
+
+#include <vector>
+#include <cppunit/TestFixture.h>
+#include "extraction/LbDataSourceIterator.h"
+#include "unittests/helpers/FourCubeBasedTestFixture.h"
+#include "Exception.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace extraction
+    {
+      using hemelb::extraction::OutputField;
+
+      class LbDataSourceIteratorTests : public helpers::FourCubeBasedTestFixture
+      {
+          CPPUNIT_TEST_SUITE (LbDataSourceIteratorTests);
+          CPPUNIT_TEST (TestScalarFieldsMatchGetters);
+          CPPUNIT_TEST (TestVectorFieldsMatchGetters);
+          CPPUNIT_TEST (TestUnavailableField);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void setUp()
+          {
+            helpers::FourCubeBasedTestFixture::setUp();
+            propertyCache = new lb::MacroscopicPropertyCache(*simState, *latDat);
+            for (site_t site = 0; site < numSites; ++site)
+            {
+              propertyCache->densityCache.Put(site, 1.0 + 0.001 * site);
+              propertyCache->velocityCache.Put(site,
+                                               util::Vector3D<distribn_t>(0.01, -0.02, 0.0001 * site));
+              propertyCache->wallShearStressMagnitudeCache.Put(site, 0.0002 * site);
+              propertyCache->tractionCache.Put(site, util::Vector3D<LatticeStress>(0.001 * site));
+            }
+            source = new hemelb::extraction::LbDataSourceIterator(*propertyCache,
+                                                                  *latDat,
+                                                                  0,
+                                                                  *unitConverter);
+
+            // Out of order, and with a repeat.
+            sites.push_back(7);
+            sites.push_back(0);
+            sites.push_back(numSites - 1);
+            sites.push_back(7);
+          }
+
+          void tearDown()
+          {
+            delete source;
+            delete propertyCache;
+            helpers::FourCubeBasedTestFixture::tearDown();
+          }
+
+          void TestScalarFieldsMatchGetters()
+          {
+            std::vector<hemelb::extraction::FloatingType> pressures, shearStresses;
+            source->GetField(OutputField::Pressure, sites, pressures);
+            source->GetField(OutputField::ShearStress, sites, shearStresses);
+            CPPUNIT_ASSERT_EQUAL(sites.size(), pressures.size());
+            CPPUNIT_ASSERT_EQUAL(sites.size(), shearStresses.size());
+
+            for (size_t site = 0; site < sites.size(); ++site)
+            {
+              source->ReadAt(sites[site]);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(source->GetPressure(), pressures[site], 1e-9);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(source->GetShearStress(), shearStresses[site], 1e-12);
+            }
+          }
+
+          void TestVectorFieldsMatchGetters()
+          {
+            std::vector<hemelb::extraction::FloatingType> velocities, tractions;
+            source->GetField(OutputField::Velocity, sites, velocities);
+            source->GetField(OutputField::Traction, sites, tractions);
+            CPPUNIT_ASSERT_EQUAL(3 * sites.size(), velocities.size());
+            CPPUNIT_ASSERT_EQUAL(3 * sites.size(), tractions.size());
+
+            for (size_t site = 0; site < sites.size(); ++site)
+            {
+              source->ReadAt(sites[site]);
+              const util::Vector3D<hemelb::extraction::FloatingType> velocity = source->GetVelocity();
+              const util::Vector3D<PhysicalStress> traction = source->GetTraction();
+              for (unsigned axis = 0; axis < 3; ++axis)
+              {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(velocity[axis], velocities[3 * site + axis], 1e-12);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(traction[axis], tractions[3 * site + axis], 1e-9);
+              }
+            }
+          }
+
+          void TestUnavailableField()
+          {
+            CPPUNIT_ASSERT_EQUAL(0u,
+                                 hemelb::extraction::IterableDataSource::GetFieldComponentCount(OutputField::MpiRank));
+            CPPUNIT_ASSERT_EQUAL(6u,
+                                 hemelb::extraction::IterableDataSource::GetFieldComponentCount(OutputField::StressTensor));
+            std::vector<hemelb::extraction::FloatingType> values;
+            CPPUNIT_ASSERT_THROW(source->GetField(OutputField::AveragedVelocity, sites, values),
+                                 Exception);
+          }
+
+        private:
+          lb::MacroscopicPropertyCache* propertyCache;
+          hemelb::extraction::LbDataSourceIterator* source;
+          std::vector<site_t> sites;
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (LbDataSourceIteratorTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_EXTRACTION_LBDATASOURCEITERATORTESTS_H */
@@ -9,6 +9,9 @@
 
 #include <string>
 #include <cstdio>
+#include <cmath>
+#include <vector>
+#include <zlib.h>
 
 #include <cppunit/TestFixture.h>
 
@@ -17,7 +20,12 @@
 #include "extraction/PropertyOutputFile.h"
 #include "extraction/OutputField.h"
 #include "extraction/WholeGeometrySelector.h"
+#include "extraction/PlaneGeometrySelector.h"
 
+#include "util/HalfPrecision.h"
+#ifdef HEMELB_USE_HDF5
+#include <hdf5.h>
+#endif
 #include "unittests/helpers/HasCommsTestFixture.h"
 #include "unittests/extraction/DummyDataSource.h"
 
@@ -31,7 +39,21 @@ namespace hemelb
       {
           CPPUNIT_TEST_SUITE (LocalPropertyOutputTests);
           CPPUNIT_TEST (TestStringWrittenLength);
-          CPPUNIT_TEST (TestWrite);CPPUNIT_TEST_SUITE_END();
+          CPPUNIT_TEST (TestWrite);
+          CPPUNIT_TEST (TestSetDataSource);
+          CPPUNIT_TEST (TestWritePositionsOnce);
+          CPPUNIT_TEST (TestSelectedSites);
+          CPPUNIT_TEST (TestAccumulatedFields);
+          CPPUNIT_TEST (TestHalfPrecision);
+          CPPUNIT_TEST (TestFixedPoint);
+          CPPUNIT_TEST (TestStrideDecimation);
+          CPPUNIT_TEST (TestBlockAverageDecimation);
+          CPPUNIT_TEST (TestDeltaEncoding);
+          CPPUNIT_TEST (TestSurfaceSiteList);
+#ifdef HEMELB_USE_HDF5
+          CPPUNIT_TEST (TestHdf5);
+#endif
+          CPPUNIT_TEST_SUITE_END();
 
         public:
           void setUp()
@@ -188,12 +210,564 @@ namespace hemelb
             CheckDataWriting(simpleDataSource, 100, writtenFile);
           }
 
+          void TestSetDataSource()
+          {
+            propertyWriter = new hemelb::extraction::LocalPropertyOutput(*simpleDataSource, &simpleOutFile, Comms());
+            writtenFile = std::fopen(simpleOutFile.filename.c_str(), "r");
+            CPPUNIT_ASSERT(writtenFile != NULL);
+
+            simpleDataSource->FillFields();
+            propertyWriter->Write(0);
+
+            // Carry on writing to the same file from another source, as after rebalancing.
+            DummyDataSource rebalancedDataSource;
+            propertyWriter->SetDataSource(rebalancedDataSource);
+            rebalancedDataSource.FillFields();
+            propertyWriter->Write(100);
+
+            // The second record follows the headers and the first, of 8 + 28 bytes per site.
+            std::fseek(writtenFile,
+                       hemelb::io::formats::extraction::MainHeaderLength + fieldHeaderLength + 8
+                           + 28 * 64,
+                       SEEK_SET);
+            CheckDataWriting(&rebalancedDataSource, 100, writtenFile);
+          }
+
+          void TestWritePositionsOnce()
+          {
+            simpleOutFile.positionsOnce = true;
+            propertyWriter = new hemelb::extraction::LocalPropertyOutput(*simpleDataSource, &simpleOutFile, Comms());
+            writtenFile = std::fopen(simpleOutFile.filename.c_str(), "r");
+            CPPUNIT_ASSERT(writtenFile != NULL);
+
+            simpleDataSource->FillFields();
+            propertyWriter->Write(0);
+            simpleDataSource->FillFields();
+            propertyWriter->Write(100);
+
+            // The version number is the last byte of the third word.
+            std::fread(writtenMainHeader, 1, hemelb::io::formats::extraction::MainHeaderLength, writtenFile);
+            CPPUNIT_ASSERT_EQUAL(char(hemelb::io::formats::extraction::SiteListVersionNumber), writtenMainHeader[11]);
+
+            // After the headers, the positions come once, marked as such...
+            std::fseek(writtenFile,
+                       hemelb::io::formats::extraction::MainHeaderLength + fieldHeaderLength,
+                       SEEK_SET);
+            const size_t siteListSize = 8 + 12 * 64;
+            std::vector<char> siteList(siteListSize);
+            CPPUNIT_ASSERT_EQUAL(siteListSize, std::fread(&siteList[0], 1, siteListSize, writtenFile));
+            hemelb::io::writers::xdr::XdrMemReader reader(&siteList[0], siteListSize);
+            uint64_t marker;
+            reader.readUnsignedLong(marker);
+            CPPUNIT_ASSERT_EQUAL(hemelb::io::formats::extraction::SiteListMarker, marker);
+            simpleDataSource->Reset();
+            while (simpleDataSource->ReadNext())
+            {
+              CheckPosition(simpleDataSource->GetPosition(), reader);
+            }
+
+            // ... and then only the fields in each record, of 8 + 16 bytes per site.
+            std::fseek(writtenFile,
+                       hemelb::io::formats::extraction::MainHeaderLength + fieldHeaderLength
+                           + siteListSize + 8 + 16 * 64,
+                       SEEK_SET);
+            CheckDataWriting(simpleDataSource, 100, writtenFile, false);
+          }
+
+          void TestSelectedSites()
+          {
+            // The plane through the sites with x == 1 in lattice units.
+            delete simpleOutFile.geometry;
+            simpleOutFile.geometry =
+                new hemelb::extraction::PlaneGeometrySelector(simpleDataSource->GetOrigin()
+                                                                  + util::Vector3D<float>(float(simpleDataSource->GetVoxelSize()),
+                                                                                          0,
+                                                                                          0),
+                                                              util::Vector3D<float>(1, 0, 0));
+            propertyWriter = new hemelb::extraction::LocalPropertyOutput(*simpleDataSource, &simpleOutFile, Comms());
+
+            // The dummy source has x in its outermost loop, so those are sites 16 to 31.
+            const std::vector<site_t>& selectedSites = propertyWriter->GetSelectedSites();
+            CPPUNIT_ASSERT_EQUAL(size_t(16), selectedSites.size());
+            for (site_t site = 0; site < 16; ++site)
+            {
+              CPPUNIT_ASSERT_EQUAL(16 + site, selectedSites[site]);
+            }
+
+            // Only those sites are written.
+            writtenFile = std::fopen(simpleOutFile.filename.c_str(), "r");
+            CPPUNIT_ASSERT(writtenFile != NULL);
+            simpleDataSource->FillFields();
+            propertyWriter->Write(0);
+            std::fseek(writtenFile, 0, SEEK_END);
+            CPPUNIT_ASSERT_EQUAL(long(hemelb::io::formats::extraction::MainHeaderLength + fieldHeaderLength
+                                     + 8 + 28 * 16),
+                                 std::ftell(writtenFile));
+          }
+
+          void TestAccumulatedFields()
+          {
+            simpleOutFile.fields.clear();
+            hemelb::extraction::OutputField averagedVelocity;
+            averagedVelocity.name = "AveragedVelocity";
+            averagedVelocity.type = hemelb::extraction::OutputField::AveragedVelocity;
+            simpleOutFile.fields.push_back(averagedVelocity);
+            hemelb::extraction::OutputField velocityRms;
+            velocityRms.name = "VelocityRms";
+            velocityRms.type = hemelb::extraction::OutputField::VelocityRms;
+            simpleOutFile.fields.push_back(velocityRms);
+            simpleOutFile.samplePeriod = 50;
+
+            propertyWriter = new hemelb::extraction::LocalPropertyOutput(*simpleDataSource, &simpleOutFile, Comms());
+            writtenFile = std::fopen(simpleOutFile.filename.c_str(), "r");
+            CPPUNIT_ASSERT(writtenFile != NULL);
+
+            CPPUNIT_ASSERT(propertyWriter->ShouldSample(50));
+            CPPUNIT_ASSERT(!propertyWriter->ShouldSample(51));
+
+            // Sample two sets of velocities, keeping them to check against.
+            std::vector<util::Vector3D<double> > firstVelocities;
+            simpleDataSource->FillFields();
+            propertyWriter->Sample(50);
+            simpleDataSource->Reset();
+            while (simpleDataSource->ReadNext())
+            {
+              firstVelocities.push_back(simpleDataSource->GetVelocity());
+            }
+            simpleDataSource->FillFields();
+            propertyWriter->Sample(51);
+            propertyWriter->Sample(100);
+            propertyWriter->Write(100);
+
+            // Each site has its grid position, the average and the RMS velocity.
+            const size_t expectedSize = 8 + 36 * 64;
+            std::fseek(writtenFile, -long(expectedSize), SEEK_END);
+            std::vector<char> record(expectedSize);
+            CPPUNIT_ASSERT_EQUAL(expectedSize, std::fread(&record[0], 1, expectedSize, writtenFile));
+            hemelb::io::writers::xdr::XdrMemReader reader(&record[0], expectedSize);
+            uint64_t timestep;
+            reader.readUnsignedLong(timestep);
+            CPPUNIT_ASSERT_EQUAL(uint64_t(100), timestep);
+
+            size_t site = 0;
+            simpleDataSource->Reset();
+            while (simpleDataSource->ReadNext())
+            {
+              CheckPosition(simpleDataSource->GetPosition(), reader);
+              const util::Vector3D<double> first = firstVelocities[site++];
+              const util::Vector3D<double> second = simpleDataSource->GetVelocity();
+
+              float written;
+              for (unsigned component = 0; component < 3; ++component)
+              {
+                reader.readFloat(written);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5 * (first[component] + second[component]),
+                                             (double) written,
+                                             epsilon);
+              }
+              // With two samples, the RMS fluctuation is half their difference.
+              for (unsigned component = 0; component < 3; ++component)
+              {
+                reader.readFloat(written);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5 * std::abs(first[component] - second[component]),
+                                             (double) written,
+                                             epsilon);
+              }
+            }
+          }
+
+          void TestHalfPrecision()
+          {
+            CheckEncodedWriting(hemelb::io::formats::extraction::Float16Encoding);
+          }
+
+          void TestFixedPoint()
+          {
+            CheckEncodedWriting(hemelb::io::formats::extraction::Fixed16Encoding);
+          }
+
+          void TestStrideDecimation()
+          {
+            simpleOutFile.decimation = hemelb::extraction::PropertyOutputFile::StrideDecimation;
+            simpleOutFile.decimationFactor = 2;
+            propertyWriter = new hemelb::extraction::LocalPropertyOutput(*simpleDataSource, &simpleOutFile, Comms());
+
+            // Only the sites with even coordinates, 16 x + 4 y + z in the dummy source.
+            const site_t expectedSites[8] = { 0, 2, 8, 10, 32, 34, 40, 42 };
+            const std::vector<site_t>& selectedSites = propertyWriter->GetSelectedSites();
+            CPPUNIT_ASSERT_EQUAL(size_t(8), selectedSites.size());
+            for (unsigned site = 0; site < 8; ++site)
+            {
+              CPPUNIT_ASSERT_EQUAL(expectedSites[site], selectedSites[site]);
+            }
+
+            writtenFile = std::fopen(simpleOutFile.filename.c_str(), "r");
+            CPPUNIT_ASSERT(writtenFile != NULL);
+            simpleDataSource->FillFields();
+            propertyWriter->Write(0);
+            std::fseek(writtenFile, 0, SEEK_END);
+            CPPUNIT_ASSERT_EQUAL(long(hemelb::io::formats::extraction::MainHeaderLength + fieldHeaderLength
+                                     + 8 + 28 * 8),
+                                 std::ftell(writtenFile));
+          }
+
+          void TestBlockAverageDecimation()
+          {
+            simpleOutFile.decimation = hemelb::extraction::PropertyOutputFile::BlockAverageDecimation;
+            simpleOutFile.decimationFactor = 2;
+            propertyWriter = new hemelb::extraction::LocalPropertyOutput(*simpleDataSource, &simpleOutFile, Comms());
+            writtenFile = std::fopen(simpleOutFile.filename.c_str(), "r");
+            CPPUNIT_ASSERT(writtenFile != NULL);
+            simpleDataSource->FillFields();
+            propertyWriter->Write(0);
+
+            // The mean pressure and x velocity over each block of 2 x 2 x 2 sites.
+            double pressure[8] = { 0., 0., 0., 0., 0., 0., 0., 0. };
+            double velocityX[8] = { 0., 0., 0., 0., 0., 0., 0., 0. };
+            simpleDataSource->Reset();
+            while (simpleDataSource->ReadNext())
+            {
+              const LatticeVector position = simpleDataSource->GetPosition();
+              const unsigned block = position.x / 2 + 2 * (position.y / 2) + 4 * (position.z / 2);
+              pressure[block] += (simpleDataSource->GetPressure() - REFERENCE_PRESSURE_mmHg) / 8.;
+              velocityX[block] += simpleDataSource->GetVelocity().x / 8.;
+            }
+
+            // After the headers and the iteration number, a site for each block, at its lowest
+            // corner, in Morton order.
+            std::fseek(writtenFile,
+                       hemelb::io::formats::extraction::MainHeaderLength + fieldHeaderLength,
+                       SEEK_SET);
+            const size_t expectedSize = 8 + 28 * 8;
+            std::vector<char> record(expectedSize);
+            CPPUNIT_ASSERT_EQUAL(expectedSize, std::fread(&record[0], 1, expectedSize, writtenFile));
+            CPPUNIT_ASSERT(std::fgetc(writtenFile) == EOF);
+            hemelb::io::writers::xdr::XdrMemReader reader(&record[0], expectedSize);
+            uint64_t timestep;
+            reader.readUnsignedLong(timestep);
+            for (unsigned block = 0; block < 8; ++block)
+            {
+              CheckPosition(LatticeVector(2 * (block & 1), 2 * ( (block >> 1) & 1), 2 * (block >> 2)),
+                            reader);
+              float value;
+              reader.readFloat(value);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(pressure[block], (double) value, epsilon);
+              reader.readFloat(value);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(velocityX[block], (double) value, epsilon);
+              reader.readFloat(value);
+              reader.readFloat(value);
+            }
+          }
+
+          void TestDeltaEncoding()
+          {
+            simpleOutFile.encoding = hemelb::io::formats::extraction::DeltaEncoding;
+            simpleOutFile.positionsOnce = true;
+            simpleOutFile.keyframePeriod = 2;
+            propertyWriter = new hemelb::extraction::LocalPropertyOutput(*simpleDataSource, &simpleOutFile, Comms());
+            writtenFile = std::fopen(simpleOutFile.filename.c_str(), "r");
+            CPPUNIT_ASSERT(writtenFile != NULL);
+
+            // The same values three times: a keyframe, then nothing but zero differences, then
+            // a keyframe again as the period is up.
+            simpleDataSource->FillFields();
+            propertyWriter->Write(0);
+            propertyWriter->Write(100);
+            propertyWriter->Write(200);
+
+            std::fseek(writtenFile,
+                       hemelb::io::formats::extraction::MainHeaderLength + fieldHeaderLength + 8
+                           + 8 + 12 * 64,
+                       SEEK_SET);
+            const bool expectedKeyframes[3] = { true, false, true };
+            for (unsigned record = 0; record < 3; ++record)
+            {
+              // The iteration number, keyframe flag, two fields' ranges, one chunk and its length.
+              const size_t headerLength = 8 + 4 + 32 + 4 + 4;
+              std::vector<char> header(headerLength);
+              CPPUNIT_ASSERT_EQUAL(headerLength, std::fread(&header[0], 1, headerLength, writtenFile));
+              hemelb::io::writers::xdr::XdrMemReader reader(&header[0], headerLength);
+              uint64_t timestep;
+              reader.readUnsignedLong(timestep);
+              CPPUNIT_ASSERT_EQUAL(uint64_t(100 * record), timestep);
+              unsigned keyframe;
+              reader.readUnsignedInt(keyframe);
+              CPPUNIT_ASSERT_EQUAL(expectedKeyframes[record], keyframe == 1);
+              double minimum[2], scale[2];
+              for (unsigned field = 0; field < 2; ++field)
+              {
+                reader.readDouble(minimum[field]);
+                reader.readDouble(scale[field]);
+              }
+              unsigned chunks, chunkLength;
+              reader.readUnsignedInt(chunks);
+              CPPUNIT_ASSERT_EQUAL(1u, chunks);
+              reader.readUnsignedInt(chunkLength);
+
+              std::vector<Bytef> chunk(4 * ( (chunkLength + 3) / 4));
+              CPPUNIT_ASSERT_EQUAL(chunk.size(), std::fread(&chunk[0], 1, chunk.size(), writtenFile));
+              std::vector<Bytef> planes(4 * 4 * 64);
+              uLongf planesLength = planes.size();
+              CPPUNIT_ASSERT_EQUAL(Z_OK, uncompress(&planes[0], &planesLength, &chunk[0], chunkLength));
+              CPPUNIT_ASSERT_EQUAL(uLongf(planes.size()), planesLength);
+
+              simpleDataSource->Reset();
+              for (unsigned site = 0; simpleDataSource->ReadNext(); ++site)
+              {
+                const double expected[4] = { simpleDataSource->GetPressure() - REFERENCE_PRESSURE_mmHg,
+                                             simpleDataSource->GetVelocity().x,
+                                             simpleDataSource->GetVelocity().y,
+                                             simpleDataSource->GetVelocity().z };
+                for (unsigned value = 0; value < 4; ++value)
+                {
+                  const unsigned index = 4 * site + value;
+                  const uint32_t zigzag = (uint32_t(planes[index]) << 24)
+                      | (uint32_t(planes[256 + index]) << 16) | (uint32_t(planes[512 + index]) << 8)
+                      | uint32_t(planes[768 + index]);
+                  const int32_t stored = int32_t(zigzag >> 1) ^ -int32_t(zigzag & 1);
+                  if (!expectedKeyframes[record])
+                  {
+                    CPPUNIT_ASSERT_EQUAL(0, stored);
+                    continue;
+                  }
+                  const unsigned field = value == 0 ? 0 : 1;
+                  CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[value],
+                                               minimum[field] + scale[field] * stored,
+                                               0.5 * scale[field] + 1e-6 * std::abs(expected[value]));
+                }
+              }
+            }
+            CPPUNIT_ASSERT(std::fgetc(writtenFile) == EOF);
+          }
+
+          void TestSurfaceSiteList()
+          {
+            simpleOutFile.positionsOnce = true;
+            simpleOutFile.surfaceSiteLists = true;
+            propertyWriter = new hemelb::extraction::LocalPropertyOutput(*simpleDataSource, &simpleOutFile, Comms());
+            writtenFile = std::fopen(simpleOutFile.filename.c_str(), "r");
+            CPPUNIT_ASSERT(writtenFile != NULL);
+            simpleDataSource->FillFields();
+            propertyWriter->Write(0);
+
+            // The fields are unencoded, but the flags say the site list is a surface one.
+            const size_t headersLength = hemelb::io::formats::extraction::MainHeaderLength
+                + fieldHeaderLength + 8;
+            std::vector<char> headers(headersLength);
+            CPPUNIT_ASSERT_EQUAL(headersLength, std::fread(&headers[0], 1, headersLength, writtenFile));
+            hemelb::io::writers::xdr::XdrMemReader
+                fieldHeaderReader(&headers[hemelb::io::formats::extraction::MainHeaderLength], 8);
+            unsigned encoding, flags;
+            fieldHeaderReader.readUnsignedInt(encoding);
+            fieldHeaderReader.readUnsignedInt(flags);
+            CPPUNIT_ASSERT_EQUAL(unsigned(hemelb::io::formats::extraction::Float32Encoding), encoding);
+            CPPUNIT_ASSERT_EQUAL(unsigned(hemelb::io::formats::extraction::SiteLists
+                                     | hemelb::io::formats::extraction::SurfaceSiteLists),
+                                 flags);
+
+            // Each site has its position, then its wall normal and area.
+            const size_t siteListSize = 8 + 28 * 64;
+            std::vector<char> siteList(siteListSize);
+            CPPUNIT_ASSERT_EQUAL(siteListSize, std::fread(&siteList[0], 1, siteListSize, writtenFile));
+            hemelb::io::writers::xdr::XdrMemReader reader(&siteList[0], siteListSize);
+            uint64_t marker;
+            reader.readUnsignedLong(marker);
+            CPPUNIT_ASSERT_EQUAL(hemelb::io::formats::extraction::SiteListMarker, marker);
+            const double voxelArea = simpleDataSource->GetVoxelSize() * simpleDataSource->GetVoxelSize();
+            simpleDataSource->Reset();
+            while (simpleDataSource->ReadNext())
+            {
+              const LatticeVector position = simpleDataSource->GetPosition();
+              CheckPosition(position, reader);
+
+              float normal[3], area;
+              reader.readFloat(normal[0]);
+              reader.readFloat(normal[1]);
+              reader.readFloat(normal[2]);
+              reader.readFloat(area);
+              if (!simpleDataSource->IsWallSite(position))
+              {
+                // The eight sites inside the cube aren't on the wall.
+                CPPUNIT_ASSERT_EQUAL(0.f, area);
+                continue;
+              }
+
+              // A face site stands for a whole voxel face, and an edge or corner site for less,
+              // as the wall there is slanted across several sites.
+              const util::Vector3D<distribn_t> expectedNormal = simpleDataSource->GetWallNormal();
+              for (unsigned axis = 0; axis < 3; ++axis)
+              {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(expectedNormal[axis], (double) normal[axis], epsilon);
+              }
+              const double linksCut = std::abs(expectedNormal.x) + std::abs(expectedNormal.y)
+                  + std::abs(expectedNormal.z);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(voxelArea / linksCut, (double) area, 1e-6 * voxelArea);
+            }
+          }
+
+#ifdef HEMELB_USE_HDF5
+          void TestHdf5()
+          {
+            simpleOutFile.format = hemelb::extraction::PropertyOutputFile::Hdf5Format;
+            propertyWriter = new hemelb::extraction::LocalPropertyOutput(*simpleDataSource, &simpleOutFile, Comms());
+            simpleDataSource->FillFields();
+            propertyWriter->Write(100);
+            delete propertyWriter;
+            propertyWriter = NULL;
+
+            const std::string xdmfName = simpleOutFile.filename + ".xmf";
+            writtenFile = std::fopen(xdmfName.c_str(), "r");
+            CPPUNIT_ASSERT(writtenFile != NULL);
+
+            const hid_t file = H5Fopen(simpleOutFile.filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+            CPPUNIT_ASSERT(file >= 0);
+
+            // The sites' positions, in the order of the data source...
+            std::vector<uint32_t> grid(3 * 64);
+            const hid_t gridSet = H5Dopen2(file, "/sites/0/grid", H5P_DEFAULT);
+            CPPUNIT_ASSERT(H5Dread(gridSet, H5T_NATIVE_UINT32, H5S_ALL, H5S_ALL, H5P_DEFAULT, &grid[0]) >= 0);
+            H5Dclose(gridSet);
+
+            // ... and each field in a dataset of its own, with its offset.
+            std::vector<float> pressure(64);
+            const hid_t pressureSet = H5Dopen2(file, "/steps/100/Pressure", H5P_DEFAULT);
+            CPPUNIT_ASSERT(H5Dread(pressureSet, H5T_NATIVE_FLOAT, H5S_ALL, H5S_ALL, H5P_DEFAULT, &pressure[0]) >= 0);
+            double offset;
+            const hid_t offsetAttribute = H5Aopen(pressureSet, "offset", H5P_DEFAULT);
+            H5Aread(offsetAttribute, H5T_NATIVE_DOUBLE, &offset);
+            H5Aclose(offsetAttribute);
+            H5Dclose(pressureSet);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(REFERENCE_PRESSURE_mmHg, offset, epsilon);
+
+            std::vector<float> velocity(3 * 64);
+            const hid_t velocitySet = H5Dopen2(file, "/steps/100/Velocity", H5P_DEFAULT);
+            CPPUNIT_ASSERT(H5Dread(velocitySet, H5T_NATIVE_FLOAT, H5S_ALL, H5S_ALL, H5P_DEFAULT, &velocity[0]) >= 0);
+            H5Dclose(velocitySet);
+            H5Fclose(file);
+
+            simpleDataSource->Reset();
+            for (unsigned site = 0; simpleDataSource->ReadNext(); ++site)
+            {
+              const hemelb::util::Vector3D<site_t> position = simpleDataSource->GetPosition();
+              CPPUNIT_ASSERT_EQUAL(uint32_t(position.x), grid[3 * site]);
+              CPPUNIT_ASSERT_EQUAL(uint32_t(position.y), grid[3 * site + 1]);
+              CPPUNIT_ASSERT_EQUAL(uint32_t(position.z), grid[3 * site + 2]);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(simpleDataSource->GetPressure() - REFERENCE_PRESSURE_mmHg,
+                                           (double) pressure[site],
+                                           epsilon);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(simpleDataSource->GetVelocity().x,
+                                           (double) velocity[3 * site],
+                                           epsilon);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(simpleDataSource->GetVelocity().z,
+                                           (double) velocity[3 * site + 2],
+                                           epsilon);
+            }
+            std::remove(xdmfName.c_str());
+          }
+#endif
+
         private:
-          void CheckDataWriting(DummyDataSource* datasource, uint64_t timestep, FILE* file)
+          void CheckEncodedWriting(hemelb::io::formats::extraction::Encoding encoding)
+          {
+            simpleOutFile.encoding = encoding;
+            propertyWriter = new hemelb::extraction::LocalPropertyOutput(*simpleDataSource, &simpleOutFile, Comms());
+            writtenFile = std::fopen(simpleOutFile.filename.c_str(), "r");
+            CPPUNIT_ASSERT(writtenFile != NULL);
+            simpleDataSource->FillFields();
+            propertyWriter->Write(100);
+
+            // The headers are as usual, but for the version, and the encoding and flags before the
+            // fields.
+            const size_t headersLength = hemelb::io::formats::extraction::MainHeaderLength
+                + fieldHeaderLength + 8;
+            std::vector<char> headers(headersLength);
+            CPPUNIT_ASSERT_EQUAL(headersLength, std::fread(&headers[0], 1, headersLength, writtenFile));
+            CPPUNIT_ASSERT_EQUAL(char(hemelb::io::formats::extraction::EncodedVersionNumber), headers[11]);
+            hemelb::io::writers::xdr::XdrMemReader
+                fieldHeaderReader(&headers[hemelb::io::formats::extraction::MainHeaderLength], 8);
+            unsigned writtenEncoding, flags;
+            fieldHeaderReader.readUnsignedInt(writtenEncoding);
+            fieldHeaderReader.readUnsignedInt(flags);
+            CPPUNIT_ASSERT_EQUAL(unsigned(encoding), writtenEncoding);
+            CPPUNIT_ASSERT_EQUAL(0u, flags);
+
+            // The iteration number, the range of each field if quantised, and then 20 bytes per
+            // site: the position, and the pressure and velocity in 16 bits each.
+            const bool fixed = encoding == hemelb::io::formats::extraction::Fixed16Encoding;
+            const size_t expectedSize = 8 + (fixed ? 32 : 0) + 20 * 64;
+            std::vector<char> record(expectedSize);
+            CPPUNIT_ASSERT_EQUAL(expectedSize, std::fread(&record[0], 1, expectedSize, writtenFile));
+            CPPUNIT_ASSERT(std::fgetc(writtenFile) == EOF);
+            hemelb::io::writers::xdr::XdrMemReader reader(&record[0], expectedSize);
+            uint64_t timestep;
+            reader.readUnsignedLong(timestep);
+            CPPUNIT_ASSERT_EQUAL(uint64_t(100), timestep);
+            double minimum[2] = { 0., 0. };
+            double scale[2] = { 0., 0. };
+            if (fixed)
+            {
+              for (unsigned field = 0; field < 2; ++field)
+              {
+                reader.readDouble(minimum[field]);
+                reader.readDouble(scale[field]);
+                CPPUNIT_ASSERT(scale[field] > 0.);
+              }
+            }
+
+            simpleDataSource->Reset();
+            while (simpleDataSource->ReadNext())
+            {
+              CheckPosition(simpleDataSource->GetPosition(), reader);
+
+              const double expected[4] = { simpleDataSource->GetPressure() - REFERENCE_PRESSURE_mmHg,
+                                           simpleDataSource->GetVelocity().x,
+                                           simpleDataSource->GetVelocity().y,
+                                           simpleDataSource->GetVelocity().z };
+              unsigned pair;
+              uint16_t stored[4];
+              for (unsigned value = 0; value < 4; value += 2)
+              {
+                reader.readUnsignedInt(pair);
+                stored[value] = uint16_t(pair >> 16);
+                stored[value + 1] = uint16_t(pair & 0xffff);
+              }
+
+              for (unsigned value = 0; value < 4; ++value)
+              {
+                const unsigned field = value == 0 ? 0 : 1;
+                if (fixed)
+                {
+                  // Within half a level, give or take the rounding to float.
+                  CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[value],
+                                               minimum[field] + scale[field] * stored[value],
+                                               0.5 * scale[field] + 1e-6 * std::abs(expected[value]));
+                }
+                else
+                {
+                  CPPUNIT_ASSERT_EQUAL(util::FloatToHalf(float(expected[value])), stored[value]);
+                }
+              }
+            }
+          }
+
+          void CheckPosition(const LatticeVector& grid, hemelb::io::writers::xdr::XdrMemReader& reader)
+          {
+            unsigned x, y, z;
+            reader.readUnsignedInt(x);
+            reader.readUnsignedInt(y);
+            reader.readUnsignedInt(z);
+
+            CPPUNIT_ASSERT_EQUAL((unsigned) grid.x, x);
+            CPPUNIT_ASSERT_EQUAL((unsigned) grid.y, y);
+            CPPUNIT_ASSERT_EQUAL((unsigned) grid.z, z);
+          }
+
+          void CheckDataWriting(DummyDataSource* datasource, uint64_t timestep, FILE* file,
+                                bool withPositions = true)
           {
             // The file should have an entry for each lattice point, consisting
             // of 3D grid coords, pressure (with an offset of 80) and 3D velocity.
-            // This gives 3*4 + 4 + 3*4 = 28 bytes per site.
+            // This gives 3*4 + 4 + 3*4 = 28 bytes per site, or 16 without the coords.
             long siteCount = 0;
             datasource->Reset();
             while (datasource->ReadNext())
@@ -202,7 +776,7 @@ namespace hemelb
             }
 
             // We also have the iteration number, a long
-            size_t expectedSize = 8 + 28 * siteCount;
+            size_t expectedSize = 8 + (withPositions ? 28 : 16) * siteCount;
 
             // Attempt to read one extra byte, to make sure we aren't under-reading
             char* contentsBuffer = new char[expectedSize];
@@ -224,15 +798,10 @@ namespace hemelb
             while (datasource->ReadNext())
             {
               // Read the grid, which should be the same
-              LatticeVector grid = datasource->GetPosition();
-              unsigned x, y, z;
-              reader.readUnsignedInt(x);
-              reader.readUnsignedInt(y);
-              reader.readUnsignedInt(z);
-
-              CPPUNIT_ASSERT_EQUAL((unsigned) grid.x, x);
-              CPPUNIT_ASSERT_EQUAL((unsigned) grid.y, y);
-              CPPUNIT_ASSERT_EQUAL((unsigned) grid.z, z);
+              if (withPositions)
+              {
+                CheckPosition(datasource->GetPosition(), reader);
+              }
 
               // Read the pressure, which should be an offset of the
               // reference pressure away.
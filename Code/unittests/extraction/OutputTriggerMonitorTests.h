@@ -0,0 +1,108 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_EXTRACTION_OUTPUTTRIGGERMONITORTESTS_H
+#define HEMELB_UNITTESTS_EXTRACTION_OUTPUTTRIGGERMONITORTESTS_H
+
+#include <vector>
+#include <cppunit/TestFixture.h>
+#include "extraction/OutputTriggerMonitor.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace extraction
+    {
+      using hemelb::extraction::OutputTrigger;
+      using hemelb::extraction::OutputTriggerMonitor;
+
+      class OutputTriggerMonitorTests : public CppUnit::TestFixture
+      {
+          CPPUNIT_TEST_SUITE (OutputTriggerMonitorTests);
+          CPPUNIT_TEST (TestAbove);
+          CPPUNIT_TEST (TestRelativeChange);
+          CPPUNIT_TEST (TestPeak);
+          CPPUNIT_TEST (TestHoldoff);
+          CPPUNIT_TEST (TestOtherQuantity);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void TestAbove()
+          {
+            OutputTriggerMonitor monitor(Triggers(OutputTrigger::Above, 1.0, 0));
+            // Only on crossing the threshold, not while staying above it.
+            const double values[] = { 0.5, 0.9, 1.2, 1.5, 0.8, 1.1 };
+            const bool fires[] = { false, false, true, false, false, true };
+            Check(monitor, values, fires, 6);
+          }
+
+          void TestRelativeChange()
+          {
+            OutputTriggerMonitor monitor(Triggers(OutputTrigger::RelativeChange, 0.5, 0));
+            const double values[] = { 1.0, 1.2, 2.0, 2.1, 0.9 };
+            const bool fires[] = { false, false, true, false, true };
+            Check(monitor, values, fires, 5);
+          }
+
+          void TestPeak()
+          {
+            OutputTriggerMonitor monitor(Triggers(OutputTrigger::Peak, 1.0, 0));
+            // The first peak is too low; the second is seen once the value falls from it.
+            const double values[] = { 0.2, 0.8, 0.5, 0.9, 1.4, 1.3, 1.2 };
+            const bool fires[] = { false, false, false, false, false, true, false };
+            Check(monitor, values, fires, 7);
+          }
+
+          void TestHoldoff()
+          {
+            OutputTriggerMonitor monitor(Triggers(OutputTrigger::RelativeChange, 0.5, 30));
+            // Steps 10 apart, so the second big change comes too soon after the first.
+            const double values[] = { 1.0, 2.0, 4.0, 4.0, 8.0 };
+            const bool fires[] = { false, true, false, false, true };
+            Check(monitor, values, fires, 5);
+          }
+
+          void TestOtherQuantity()
+          {
+            OutputTriggerMonitor monitor(Triggers(OutputTrigger::Above, 1.0, 0));
+            monitor.Update(OutputTrigger::MaxDensityDifference, 0.0, 0);
+            monitor.Update(OutputTrigger::MaxDensityDifference, 2.0, 10);
+            CPPUNIT_ASSERT(!monitor.HasFired(10));
+          }
+
+        private:
+          std::vector<OutputTrigger> Triggers(OutputTrigger::Condition condition,
+                                              double threshold, unsigned long holdoff)
+          {
+            OutputTrigger trigger;
+            trigger.quantity = OutputTrigger::MaxVelocity;
+            trigger.condition = condition;
+            trigger.threshold = threshold;
+            trigger.holdoff = holdoff;
+            return std::vector<OutputTrigger>(1, trigger);
+          }
+
+          /**
+           * Give the monitor the values every 10 steps, checking it fires on the right ones.
+           */
+          void Check(OutputTriggerMonitor& monitor, const double* values, const bool* fires,
+                     unsigned count)
+          {
+            for (unsigned value = 0; value < count; ++value)
+            {
+              const unsigned long step = 10 * value;
+              monitor.Update(OutputTrigger::MaxVelocity, values[value], step);
+              CPPUNIT_ASSERT_EQUAL(fires[value], monitor.HasFired(step));
+            }
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (OutputTriggerMonitorTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_EXTRACTION_OUTPUTTRIGGERMONITORTESTS_H */
@@ -0,0 +1,163 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_EXTRACTION_PROBEACTORTESTS_H
+#define HEMELB_UNITTESTS_EXTRACTION_PROBEACTORTESTS_H
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cppunit/TestFixture.h>
+#include "extraction/ProbeActor.h"
+#include "unittests/helpers/HasCommsTestFixture.h"
+#include "unittests/extraction/DummyDataSource.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace extraction
+    {
+      class ProbeActorTests : public helpers::HasCommsTestFixture
+      {
+          CPPUNIT_TEST_SUITE (ProbeActorTests);
+          CPPUNIT_TEST (TestInterpolation);
+          CPPUNIT_TEST (TestMissingCorners);
+          CPPUNIT_TEST (TestGatherPeriod);CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void setUp()
+          {
+            helpers::HasCommsTestFixture::setUp();
+            std::remove(fileName);
+            dataSource = new DummyDataSource();
+            simState = new lb::SimulationState(0.0001, 1000);
+            timings = new reporting::Timers(Comms());
+            spec.filename = fileName;
+            spec.gatherPeriod = 2;
+            // Part way between the sites (1, 2, 0) and (2, 3, 1).
+            spec.points.push_back(GetPhysicalPosition(1.25, 2.5, 0.75));
+            // Beyond the last site (3, 3, 3), so that it is the only one of the stencil.
+            spec.points.push_back(GetPhysicalPosition(3.5, 3.5, 3.5));
+            probes = new hemelb::extraction::ProbeActor(*simState, &spec, *dataSource, *timings, Comms());
+          }
+
+          void tearDown()
+          {
+            delete probes;
+            delete timings;
+            delete simState;
+            delete dataSource;
+            std::remove(fileName);
+            helpers::HasCommsTestFixture::tearDown();
+          }
+
+          void TestInterpolation()
+          {
+            dataSource->FillFields();
+            const double expected = Interpolate(1, 2, 0, 0.25, 0.5, 0.75);
+            Sample();
+            Sample();
+
+            const std::vector<std::vector<double> > lines = ReadLines();
+            CPPUNIT_ASSERT_EQUAL(size_t(2), lines.size());
+            // The time step, then the pressure and velocity of each probe.
+            CPPUNIT_ASSERT_EQUAL(size_t(9), lines[0].size());
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(double(simState->GetTimeStep() - 1), lines[0][0], 1e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, lines[0][1], 1e-5);
+          }
+
+          void TestMissingCorners()
+          {
+            dataSource->FillFields();
+            dataSource->ReadAt(63);
+            const double pressure = dataSource->GetPressure();
+            const double velocityZ = dataSource->GetVelocity().z;
+            Sample();
+            Sample();
+
+            const std::vector<std::vector<double> > lines = ReadLines();
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(pressure, lines[0][5], 1e-5);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(velocityZ, lines[0][8], 1e-5);
+          }
+
+          void TestGatherPeriod()
+          {
+            // Nothing is written until the gather period is up, or the probes are flushed.
+            dataSource->FillFields();
+            Sample();
+            CPPUNIT_ASSERT_EQUAL(size_t(0), ReadLines().size());
+            probes->Flush();
+            CPPUNIT_ASSERT_EQUAL(size_t(1), ReadLines().size());
+          }
+
+        private:
+          PhysicalPosition GetPhysicalPosition(double x, double y, double z) const
+          {
+            return PhysicalPosition(dataSource->GetOrigin().x + x * dataSource->GetVoxelSize(),
+                                    dataSource->GetOrigin().y + y * dataSource->GetVoxelSize(),
+                                    dataSource->GetOrigin().z + z * dataSource->GetVoxelSize());
+          }
+
+          /**
+           * The trilinear interpolation of the pressure in the cell with the given low corner.
+           */
+          double Interpolate(site_t i, site_t j, site_t k, double x, double y, double z)
+          {
+            double value = 0.;
+            for (unsigned corner = 0; corner < 8; ++corner)
+            {
+              const unsigned di = corner & 1, dj = (corner >> 1) & 1, dk = (corner >> 2) & 1;
+              dataSource->ReadAt(16 * (i + di) + 4 * (j + dj) + k + dk);
+              value += (di ? x : 1. - x) * (dj ? y : 1. - y) * (dk ? z : 1. - z)
+                  * dataSource->GetPressure();
+            }
+            return value;
+          }
+
+          void Sample()
+          {
+            simState->Increment();
+            probes->EndIteration();
+          }
+
+          std::vector<std::vector<double> > ReadLines() const
+          {
+            std::vector<std::vector<double> > lines;
+            std::ifstream file(fileName);
+            std::string line;
+            while (std::getline(file, line))
+            {
+              if (line.empty() || line[0] == '#')
+              {
+                continue;
+              }
+              std::istringstream values(line);
+              lines.push_back(std::vector<double>());
+              double value;
+              while (values >> value)
+              {
+                lines.back().push_back(value);
+              }
+            }
+            return lines;
+          }
+
+          DummyDataSource* dataSource;
+          lb::SimulationState* simState;
+          reporting::Timers* timings;
+          hemelb::extraction::ProbeOutputFile spec;
+          hemelb::extraction::ProbeActor* probes;
+          static const char* fileName;
+      };
+      const char* ProbeActorTests::fileName = "probes.txt";
+      CPPUNIT_TEST_SUITE_REGISTRATION (ProbeActorTests);
+    }
+  }
+}
+
+#endif // HEMELB_UNITTESTS_EXTRACTION_PROBEACTORTESTS_H
@@ -0,0 +1,108 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_EXTRACTION_SITEFIELDVALUESTESTS_H
+#define HEMELB_UNITTESTS_EXTRACTION_SITEFIELDVALUESTESTS_H
+
+#include <vector>
+#include <cppunit/TestFixture.h>
+#include "extraction/SiteFieldValues.h"
+#include "unittests/extraction/DummyDataSource.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace extraction
+    {
+      using hemelb::extraction::OutputField;
+      using hemelb::extraction::FloatingType;
+
+      /**
+       * Counts the fields got from it.
+       */
+      class CountingDataSource : public DummyDataSource
+      {
+        public:
+          CountingDataSource() :
+              fieldsGot(0)
+          {
+          }
+
+          void GetField(OutputField::FieldType field, const std::vector<site_t>& sites,
+                        std::vector<FloatingType>& values)
+          {
+            ++fieldsGot;
+            DummyDataSource::GetField(field, sites, values);
+          }
+
+          unsigned fieldsGot;
+      };
+
+      class SiteFieldValuesTests : public CppUnit::TestFixture
+      {
+          CPPUNIT_TEST_SUITE (SiteFieldValuesTests);
+          CPPUNIT_TEST (TestSubsetMatchesDataSource);
+          CPPUNIT_TEST (TestEachFieldGotOnce);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void setUp()
+          {
+            source.FillFields();
+            for (site_t site = 0; site < 64; site += 3)
+            {
+              allSites.push_back(site);
+            }
+            for (site_t site = 6; site < 64; site += 9)
+            {
+              someSites.push_back(site);
+            }
+          }
+
+          void TestSubsetMatchesDataSource()
+          {
+            hemelb::extraction::SiteFieldValues fields(source, allSites);
+            std::vector<FloatingType> shared, direct;
+            fields.Get(OutputField::Velocity, someSites, shared);
+            source.GetField(OutputField::Velocity, someSites, direct);
+            CPPUNIT_ASSERT_EQUAL(direct.size(), shared.size());
+            for (size_t value = 0; value < direct.size(); ++value)
+            {
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(direct[value], shared[value], 1e-12);
+            }
+
+            fields.Get(OutputField::Pressure, allSites, shared);
+            source.GetField(OutputField::Pressure, allSites, direct);
+            CPPUNIT_ASSERT_EQUAL(direct.size(), shared.size());
+            for (size_t value = 0; value < direct.size(); ++value)
+            {
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(direct[value], shared[value], 1e-12);
+            }
+          }
+
+          void TestEachFieldGotOnce()
+          {
+            hemelb::extraction::SiteFieldValues fields(source, allSites);
+            std::vector<FloatingType> values;
+            fields.Get(OutputField::Pressure, someSites, values);
+            fields.Get(OutputField::Pressure, allSites, values);
+            CPPUNIT_ASSERT_EQUAL(1u, source.fieldsGot);
+            fields.Get(OutputField::Velocity, someSites, values);
+            CPPUNIT_ASSERT_EQUAL(2u, source.fieldsGot);
+          }
+
+        private:
+          CountingDataSource source;
+          std::vector<site_t> allSites;
+          std::vector<site_t> someSites;
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (SiteFieldValuesTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_EXTRACTION_SITEFIELDVALUESTESTS_H */
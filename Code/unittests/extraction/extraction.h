@@ -9,5 +9,12 @@
 
 #include "unittests/extraction/GeometrySelectorTests.h"
 #include "unittests/extraction/LocalPropertyOutputTests.h"
+#include "unittests/extraction/ProbeActorTests.h"
+#include "unittests/extraction/InSituAdaptorTests.h"
+#include "unittests/extraction/LbDataSourceIteratorTests.h"
+#include "unittests/extraction/FlowDiagnosticsActorTests.h"
+#include "unittests/extraction/SiteFieldValuesTests.h"
+#include "unittests/extraction/OutputTriggerMonitorTests.h"
+#include "unittests/extraction/FlightRecorderTests.h"
 
 #endif /* HEMELB_UNITTESTS_EXTRACTION_EXTRACTION_H */
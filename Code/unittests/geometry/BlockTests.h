@@ -0,0 +1,148 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_GEOMETRY_BLOCKTESTS_H
+#define HEMELB_UNITTESTS_GEOMETRY_BLOCKTESTS_H
+#include <cppunit/TestFixture.h>
+#include "geometry/Block.h"
+#include "constants.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace geometry
+    {
+      using namespace hemelb::geometry;
+
+      class BlockTests : public CppUnit::TestFixture
+      {
+          CPPUNIT_TEST_SUITE ( BlockTests);
+          CPPUNIT_TEST ( TestEmpty);
+          CPPUNIT_TEST ( TestRanks);
+          CPPUNIT_TEST ( TestContiguousIndices);
+          CPPUNIT_TEST ( TestSparseContiguousIndices);
+          CPPUNIT_TEST ( TestFullContiguousIndices);CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void TestEmpty()
+          {
+            CPPUNIT_ASSERT(Block().IsEmpty());
+            CPPUNIT_ASSERT(!Block(8).IsEmpty());
+          }
+
+          void TestRanks()
+          {
+            Block block(8);
+            for (site_t site = 0; site < 8; ++site)
+            {
+              CPPUNIT_ASSERT_EQUAL(SITE_OR_BLOCK_SOLID, block.GetProcessorRankForSite(site));
+            }
+
+            // All the fluid sites on one rank...
+            block.SetProcessorRankForSite(1, 3);
+            block.SetProcessorRankForSite(2, 3);
+            block.SetProcessorRankForSite(5, SITE_OR_BLOCK_SOLID);
+            CPPUNIT_ASSERT_EQUAL(SITE_OR_BLOCK_SOLID, block.GetProcessorRankForSite(0));
+            CPPUNIT_ASSERT_EQUAL(3, block.GetProcessorRankForSite(1));
+            CPPUNIT_ASSERT_EQUAL(3, block.GetProcessorRankForSite(2));
+            CPPUNIT_ASSERT_EQUAL(SITE_OR_BLOCK_SOLID, block.GetProcessorRankForSite(5));
+
+            // ... then on another.
+            block.SetProcessorRankForSite(6, 4);
+            CPPUNIT_ASSERT_EQUAL(SITE_OR_BLOCK_SOLID, block.GetProcessorRankForSite(0));
+            CPPUNIT_ASSERT_EQUAL(3, block.GetProcessorRankForSite(1));
+            CPPUNIT_ASSERT_EQUAL(3, block.GetProcessorRankForSite(2));
+            CPPUNIT_ASSERT_EQUAL(4, block.GetProcessorRankForSite(6));
+            block.SetProcessorRankForSite(2, SITE_OR_BLOCK_SOLID);
+            CPPUNIT_ASSERT_EQUAL(SITE_OR_BLOCK_SOLID, block.GetProcessorRankForSite(2));
+          }
+
+          void TestContiguousIndices()
+          {
+            Block block(8);
+            CPPUNIT_ASSERT(block.SiteIsSolid(3));
+
+            block.SetLocalContiguousIndexForSite(3, 42);
+            CPPUNIT_ASSERT(!block.SiteIsSolid(3));
+            CPPUNIT_ASSERT_EQUAL(site_t(42), block.GetLocalContiguousIndexForSite(3));
+            CPPUNIT_ASSERT(block.SiteIsSolid(4));
+          }
+
+          void TestSparseContiguousIndices()
+          {
+            // Mostly solid, with fluid sites in different words of the mask.
+            const site_t sites = 512;
+            Block block(sites);
+            const site_t fluidSites[] = { 3, 70, 71, 200, 511 };
+            for (unsigned fluid = 0; fluid < 5; ++fluid)
+            {
+              block.SetProcessorRankForSite(fluidSites[fluid], 2);
+            }
+            // Given in a different order than the sites.
+            for (unsigned fluid = 0; fluid < 5; ++fluid)
+            {
+              block.SetLocalContiguousIndexForSite(fluidSites[4 - fluid], 10 + fluid);
+            }
+            for (unsigned fluid = 0; fluid < 5; ++fluid)
+            {
+              CPPUNIT_ASSERT_EQUAL(site_t(14 - fluid),
+                                   block.GetLocalContiguousIndexForSite(fluidSites[fluid]));
+            }
+            CPPUNIT_ASSERT(block.SiteIsSolid(0));
+            CPPUNIT_ASSERT(block.SiteIsSolid(72));
+            CPPUNIT_ASSERT(block.SiteIsSolid(510));
+
+            // Far less than an index for every site.
+            CPPUNIT_ASSERT(block.GetMemoryUsage() < sites * sizeof(site_t) / 8);
+
+            // A site becoming solid or fluid keeps the others' indices.
+            block.SetProcessorRankForSite(70, SITE_OR_BLOCK_SOLID);
+            block.SetProcessorRankForSite(4, 2);
+            CPPUNIT_ASSERT(block.SiteIsSolid(70));
+            CPPUNIT_ASSERT(block.SiteIsSolid(4));
+            CPPUNIT_ASSERT_EQUAL(site_t(14), block.GetLocalContiguousIndexForSite(3));
+            CPPUNIT_ASSERT_EQUAL(site_t(12), block.GetLocalContiguousIndexForSite(71));
+            CPPUNIT_ASSERT_EQUAL(site_t(10), block.GetLocalContiguousIndexForSite(511));
+            block.SetLocalContiguousIndexForSite(4, 20);
+            CPPUNIT_ASSERT_EQUAL(site_t(20), block.GetLocalContiguousIndexForSite(4));
+            CPPUNIT_ASSERT_EQUAL(site_t(11), block.GetLocalContiguousIndexForSite(200));
+          }
+
+          void TestFullContiguousIndices()
+          {
+            Block block(8);
+            for (site_t site = 0; site < 8; ++site)
+            {
+              block.SetProcessorRankForSite(site, site < 4 ?
+                1 :
+                2);
+            }
+            // Only the sites on one rank are local.
+            for (site_t site = 0; site < 4; ++site)
+            {
+              block.SetLocalContiguousIndexForSite(site, 100 + site);
+            }
+            for (site_t site = 0; site < 4; ++site)
+            {
+              CPPUNIT_ASSERT_EQUAL(site_t(100 + site), block.GetLocalContiguousIndexForSite(site));
+              CPPUNIT_ASSERT(block.SiteIsSolid(site + 4));
+              CPPUNIT_ASSERT_EQUAL(2, block.GetProcessorRankForSite(site + 4));
+            }
+
+            // Then one of the others goes solid, so the block isn't full any more.
+            block.SetProcessorRankForSite(5, SITE_OR_BLOCK_SOLID);
+            CPPUNIT_ASSERT_EQUAL(site_t(103), block.GetLocalContiguousIndexForSite(3));
+            CPPUNIT_ASSERT_EQUAL(SITE_OR_BLOCK_SOLID, block.GetProcessorRankForSite(5));
+            CPPUNIT_ASSERT_EQUAL(2, block.GetProcessorRankForSite(6));
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION ( BlockTests);
+    }
+  }
+}
+
+#endif // HEMELB_UNITTESTS_GEOMETRY_BLOCKTESTS_H
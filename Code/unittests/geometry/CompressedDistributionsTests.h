@@ -0,0 +1,117 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_GEOMETRY_COMPRESSEDDISTRIBUTIONSTESTS_H
+#define HEMELB_UNITTESTS_GEOMETRY_COMPRESSEDDISTRIBUTIONSTESTS_H
+#include <algorithm>
+#include <cmath>
+#include <cppunit/TestFixture.h>
+#include "geometry/CompressedDistributions.h"
+#include "lb/lattices/D3Q19.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace geometry
+    {
+      using namespace hemelb::geometry;
+
+      class CompressedDistributionsTests : public CppUnit::TestFixture
+      {
+          CPPUNIT_TEST_SUITE ( CompressedDistributionsTests);
+          CPPUNIT_TEST ( TestStartsAtRest);
+          CPPUNIT_TEST ( TestEquilibriumIsExact);
+          CPPUNIT_TEST ( TestRoundTrip);
+          CPPUNIT_TEST ( TestMemoryUsage);CPPUNIT_TEST_SUITE_END();
+
+          typedef lb::lattices::D3Q19 LatticeType;
+
+        public:
+          void TestStartsAtRest()
+          {
+            CompressedDistributions compressed(LatticeType::GetLatticeInfo(), 2);
+            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+            {
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(LatticeType::EQMWEIGHTS[direction],
+                                           compressed.Get<LatticeType>(1, direction),
+                                           1e-15);
+            }
+          }
+
+          void TestEquilibriumIsExact()
+          {
+            // Moments that floats hold exactly, so only the equilibrium's own rounding is left.
+            distribn_t f[LatticeType::NUMVECTORS];
+            LatticeType::CalculateFeq(1.0 + 1.0 / 1024.0, 1.0 / 256.0, -1.0 / 512.0, 0.0, f);
+            CompressedDistributions compressed(LatticeType::GetLatticeInfo(), 1);
+            compressed.Store<LatticeType>(0, f);
+            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+            {
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(f[direction],
+                                           compressed.Get<LatticeType>(0, direction),
+                                           1e-15);
+            }
+          }
+
+          void TestRoundTrip()
+          {
+            // A slow flow off equilibrium, at the second of two sites.
+            distribn_t f[LatticeType::NUMVECTORS];
+            LatticeType::CalculateFeq(1.002, 0.001, 0.0005, -0.0003, f);
+            distribn_t largestDifference = 0.0;
+            for (Direction direction = 1; direction < LatticeType::NUMVECTORS; direction += 2)
+            {
+              const distribn_t difference = 1e-5 * (direction % 5) - 2e-5;
+              f[direction] += difference;
+              f[direction + 1] -= difference;
+              largestDifference = std::max(largestDifference, std::abs(difference));
+            }
+
+            CompressedDistributions compressed(LatticeType::GetLatticeInfo(), 2);
+            compressed.Store<LatticeType>(1, f);
+            distribn_t decompressed[LatticeType::NUMVECTORS];
+            compressed.Get<LatticeType>(1, decompressed);
+
+            // Within half a quantum of the differences, and the rounding of the moments.
+            const distribn_t tolerance = largestDifference / 32766.0 + 1e-9;
+            distribn_t density = 0.0, decompressedDensity = 0.0;
+            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+            {
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(f[direction], decompressed[direction], tolerance);
+              CPPUNIT_ASSERT_EQUAL(decompressed[direction], compressed.Get(1, direction));
+              density += f[direction];
+              decompressedDensity += decompressed[direction];
+            }
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(density,
+                                         decompressedDensity,
+                                         LatticeType::NUMVECTORS * tolerance);
+
+            // The non-templated version stores the same, and the other site is untouched.
+            CompressedDistributions other(LatticeType::GetLatticeInfo(), 2);
+            other.Store(1, f);
+            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+            {
+              CPPUNIT_ASSERT_EQUAL(decompressed[direction], other.Get<LatticeType>(1, direction));
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(LatticeType::EQMWEIGHTS[direction],
+                                           other.Get<LatticeType>(0, direction),
+                                           1e-15);
+            }
+          }
+
+          void TestMemoryUsage()
+          {
+            CompressedDistributions compressed(LatticeType::GetLatticeInfo(), 10);
+            CPPUNIT_ASSERT_EQUAL(size_t(10 * (5 * 4 + 19 * 2)), compressed.GetMemoryUsage());
+            CPPUNIT_ASSERT_EQUAL(size_t(0), CompressedDistributions().GetMemoryUsage());
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION ( CompressedDistributionsTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_GEOMETRY_COMPRESSEDDISTRIBUTIONSTESTS_H */
@@ -8,6 +8,14 @@
 #define HEMELB_UNITTESTS_GEOMETRY_GEOMETRYREADERTESTS_H
 #include "geometry/LatticeData.h"
 #include <cppunit/TestFixture.h>
+#include <fstream>
+#include <iterator>
+#include <zlib.h>
+#include "io/formats/blockstats.h"
+#include "io/formats/formats.h"
+#include "io/formats/geometry.h"
+#include "io/writers/xdr/XdrFileWriter.h"
+#include "io/writers/xdr/XdrMemReader.h"
 #include "lb/lattices/D3Q15.h"
 #include "resources/Resource.h"
 #include "unittests/FourCubeLatticeData.h"
@@ -27,7 +35,10 @@ namespace hemelb
       {
           CPPUNIT_TEST_SUITE ( GeometryReaderTests);
           CPPUNIT_TEST ( TestRead);
-          CPPUNIT_TEST ( TestSameAsFourCube);CPPUNIT_TEST_SUITE_END();
+          CPPUNIT_TEST ( TestSameAsFourCube);
+          CPPUNIT_TEST ( TestSavedDecomposition);
+          CPPUNIT_TEST ( TestDecompositionCache);
+          CPPUNIT_TEST ( TestBlockStats);CPPUNIT_TEST_SUITE_END();
 
         public:
 
@@ -111,7 +122,164 @@ namespace hemelb
 
           }
 
+          void TestSavedDecomposition()
+          {
+            LADD_FAIL();
+            Geometry decomposed = reader->LoadAndDecompose(simConfig->GetDataFilePath(),
+                                                           "",
+                                                           "four_cube.dcm");
+
+            GeometryReader loadingReader(false,
+                                         hemelb::lb::lattices::D3Q15::GetLatticeInfo(),
+                                         *timings,
+                                         Comms());
+            Geometry loaded = loadingReader.LoadAndDecompose(simConfig->GetDataFilePath(),
+                                                             "four_cube.dcm");
+
+            AssertSameDecomposition(*reader, decomposed, loadingReader, loaded);
+          }
+
+          void TestDecompositionCache()
+          {
+            LADD_FAIL();
+            // The first read fills the cache and the second uses it.
+            Geometry decomposed = reader->LoadAndDecompose(simConfig->GetDataFilePath(), "", "", ".");
+            CPPUNIT_ASSERT(!reader->LoadedCachedDecomposition());
+            CPPUNIT_ASSERT(!reader->GetCachedDecompositionFile().empty());
+            // Only the first core writes it.
+            if (Comms().Rank() == 0)
+            {
+              AssertPresent(reader->GetCachedDecompositionFile());
+            }
+
+            GeometryReader cachedReader(false,
+                                        hemelb::lb::lattices::D3Q15::GetLatticeInfo(),
+                                        *timings,
+                                        Comms());
+            Geometry cached = cachedReader.LoadAndDecompose(simConfig->GetDataFilePath(), "", "", ".");
+            CPPUNIT_ASSERT(cachedReader.LoadedCachedDecomposition());
+            CPPUNIT_ASSERT_EQUAL(reader->GetCachedDecompositionFile(),
+                                 cachedReader.GetCachedDecompositionFile());
+
+            AssertSameDecomposition(*reader, decomposed, cachedReader, cached);
+          }
+
+          void TestBlockStats()
+          {
+            LADD_FAIL();
+            Geometry plain = reader->LoadAndDecompose(simConfig->GetDataFilePath());
+
+            // Statistics that match the geometry are used, and a stale file is ignored, neither
+            // changing the sites that are read.
+            for (int stale = 0; stale < 2; ++stale)
+            {
+              // Only the first core reads the file.
+              if (Comms().Rank() == 0)
+              {
+                WriteBlockStats(simConfig->GetDataFilePath(), stale != 0);
+              }
+
+              GeometryReader statsReader(false,
+                                         hemelb::lb::lattices::D3Q15::GetLatticeInfo(),
+                                         *timings,
+                                         Comms());
+              Geometry withStats = statsReader.LoadAndDecompose(simConfig->GetDataFilePath());
+
+              CPPUNIT_ASSERT_EQUAL(plain.Blocks[0].Sites.size(), withStats.Blocks[0].Sites.size());
+              for (site_t site = 0; site < (site_t) plain.Blocks[0].Sites.size(); ++site)
+              {
+                CPPUNIT_ASSERT_EQUAL(plain.Blocks[0].Sites[site].isFluid,
+                                     withStats.Blocks[0].Sites[site].isFluid);
+              }
+            }
+          }
+
         private:
+          /**
+           * Assert that two reads of the same geometry decomposed it alike: every site of every
+           * block on the same rank, and the same sites read here with the same target.
+           */
+          void AssertSameDecomposition(const GeometryReader& expectedReader,
+                                       const Geometry& expected,
+                                       const GeometryReader& actualReader,
+                                       const Geometry& actual)
+          {
+            CPPUNIT_ASSERT_EQUAL(expected.GetBlockCount(), actual.GetBlockCount());
+            for (site_t block = 0; block < expected.GetBlockCount(); ++block)
+            {
+              for (site_t site = 0; site < expected.GetSitesPerBlock(); ++site)
+              {
+                CPPUNIT_ASSERT_EQUAL(expectedReader.GetProcForSite(block, site),
+                                     actualReader.GetProcForSite(block, site));
+              }
+
+              const std::vector<GeometrySite>& expectedSites = expected.Blocks[block].Sites;
+              const std::vector<GeometrySite>& actualSites = actual.Blocks[block].Sites;
+              CPPUNIT_ASSERT_EQUAL(expectedSites.size(), actualSites.size());
+              for (size_t site = 0; site < expectedSites.size(); ++site)
+              {
+                CPPUNIT_ASSERT_EQUAL(expectedSites[site].targetProcessor,
+                                     actualSites[site].targetProcessor);
+              }
+            }
+          }
+
+          /**
+           * Write block statistics for a geometry file as the setup tool would, counting every
+           * fluid site as bulk, or with the wrong checksum if stale.
+           */
+          void WriteBlockStats(const std::string& gmyPath, bool stale)
+          {
+            namespace formats = hemelb::io::formats;
+            std::ifstream gmy(gmyPath.c_str(), std::ios::binary);
+            std::vector<char> contents( (std::istreambuf_iterator<char>(gmy)),
+                                       std::istreambuf_iterator<char>());
+
+            hemelb::io::writers::xdr::XdrMemReader preambleReader(&contents[0],
+                                                                  formats::geometry::PreambleLength);
+            unsigned word, blockCount = 1;
+            for (unsigned i = 0; i < 3; ++i)
+            {
+              preambleReader.readUnsignedInt(word);
+            }
+            for (unsigned i = 0; i < 3; ++i)
+            {
+              preambleReader.readUnsignedInt(word);
+              blockCount *= word;
+            }
+
+            const unsigned headerEnd = formats::geometry::PreambleLength
+                + formats::geometry::HeaderRecordLength * blockCount;
+            uLong checksum = crc32(0L, Z_NULL, 0);
+            checksum = crc32(checksum, reinterpret_cast<const Bytef*>(&contents[0]), headerEnd);
+
+            hemelb::io::writers::xdr::XdrFileWriter writer(gmyPath
+                + formats::blockstats::Extension());
+            writer << (unsigned) formats::HemeLbMagicNumber
+                << (unsigned) formats::blockstats::MagicNumber
+                << (unsigned) formats::blockstats::VersionNumber << blockCount
+                << (unsigned) formats::blockstats::CollisionTypeCount
+                << (unsigned) (stale ? checksum + 1 : checksum);
+
+            hemelb::io::writers::xdr::XdrMemReader headerReader(&contents[formats::geometry::PreambleLength],
+                                                                headerEnd
+                                                                    - formats::geometry::PreambleLength);
+            uint64_t offset = headerEnd;
+            for (unsigned block = 0; block < blockCount; ++block)
+            {
+              unsigned fluidSites, bytes, uncompressedBytes;
+              headerReader.readUnsignedInt(fluidSites);
+              headerReader.readUnsignedInt(bytes);
+              headerReader.readUnsignedInt(uncompressedBytes);
+              writer << fluidSites << offset << fluidSites;
+              for (unsigned type = 1; type < formats::blockstats::CollisionTypeCount; ++type)
+              {
+                writer << 0U;
+              }
+              offset += bytes;
+            }
+          }
+
           GeometryReader *reader;
           LatticeData* lattice;
           configuration::SimConfig * simConfig;
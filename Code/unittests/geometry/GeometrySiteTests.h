@@ -0,0 +1,76 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_GEOMETRY_GEOMETRYSITETESTS_H
+#define HEMELB_UNITTESTS_GEOMETRY_GEOMETRYSITETESTS_H
+#include <cppunit/TestFixture.h>
+#include "geometry/GeometrySite.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace geometry
+    {
+      class GeometrySiteTests : public CppUnit::TestFixture
+      {
+          CPPUNIT_TEST_SUITE(GeometrySiteTests);
+          CPPUNIT_TEST(TestUncutLinks);
+          CPPUNIT_TEST(TestCutLinks);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void TestUncutLinks()
+          {
+            hemelb::geometry::GeometrySite site(true);
+            CPPUNIT_ASSERT_EQUAL(uint32_t(0), site.GetCutLinks());
+            CPPUNIT_ASSERT_EQUAL(hemelb::geometry::GeometrySiteLink::NO_INTERSECTION,
+                                 site.GetLink(7).type);
+
+            // Setting an uncut link stores nothing.
+            site.SetLink(3, hemelb::geometry::GeometrySiteLink());
+            CPPUNIT_ASSERT_EQUAL(uint32_t(0), site.GetCutLinks());
+          }
+
+          void TestCutLinks()
+          {
+            hemelb::geometry::GeometrySite site(true);
+            hemelb::geometry::GeometrySiteLink wall;
+            wall.type = hemelb::geometry::GeometrySiteLink::WALL_INTERSECTION;
+            wall.distanceToIntersection = 0.25;
+            hemelb::geometry::GeometrySiteLink inlet;
+            inlet.type = hemelb::geometry::GeometrySiteLink::INLET_INTERSECTION;
+            inlet.distanceToIntersection = 0.75;
+            inlet.ioletId = 2;
+
+            // Set out of order, as the file's neighbourhood can be.
+            site.SetLink(9, wall);
+            site.SetLink(1, inlet);
+            CPPUNIT_ASSERT_EQUAL(uint32_t( (1 << 1) | (1 << 9)), site.GetCutLinks());
+            CPPUNIT_ASSERT(site.IsCut(9));
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25, site.GetLink(9).distanceToIntersection, 1e-6);
+            CPPUNIT_ASSERT_EQUAL(2, site.GetLink(1).ioletId);
+            CPPUNIT_ASSERT_EQUAL(hemelb::geometry::GeometrySiteLink::NO_INTERSECTION,
+                                 site.GetLink(5).type);
+
+            // Overwriting, then uncutting, a link.
+            site.SetLink(1, wall);
+            CPPUNIT_ASSERT_EQUAL(hemelb::geometry::GeometrySiteLink::WALL_INTERSECTION,
+                                 site.GetLink(1).type);
+            site.SetLink(1, hemelb::geometry::GeometrySiteLink());
+            CPPUNIT_ASSERT(!site.IsCut(1));
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25, site.GetLink(9).distanceToIntersection, 1e-6);
+
+            site.ClearLinks();
+            CPPUNIT_ASSERT_EQUAL(uint32_t(0), site.GetCutLinks());
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION(GeometrySiteTests);
+    }
+  }
+}
+
+#endif // HEMELB_UNITTESTS_GEOMETRY_GEOMETRYSITETESTS_H
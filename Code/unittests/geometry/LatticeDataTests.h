@@ -7,7 +7,10 @@
 #ifndef HEMELB_UNITTESTS_GEOMETRY_LATTICEDATATESTS_H
 #define HEMELB_UNITTESTS_GEOMETRY_LATTICEDATATESTS_H
 
+#include <vector>
 #include "geometry/LatticeData.h"
+#include "io/writers/xdr/XdrMemReader.h"
+#include "io/writers/xdr/XdrMemWriter.h"
 
 namespace hemelb
 {
@@ -23,6 +26,10 @@ namespace hemelb
           CPPUNIT_TEST ( TestConstruct);
           CPPUNIT_TEST ( TestConvertGlobalId);
           CPPUNIT_TEST ( TestGetProcFromGlobalId);
+          CPPUNIT_TEST ( TestStreamedIndicesMatchDistributionIndices);
+          CPPUNIT_TEST ( TestWallLinksMatchSiteData);
+          CPPUNIT_TEST ( TestLinkPatternRangesMatchSiteData);
+          CPPUNIT_TEST ( TestCaptureSubdomain);
 
           CPPUNIT_TEST_SUITE_END();
 
@@ -68,6 +75,132 @@ namespace hemelb
             CPPUNIT_ASSERT_EQUAL(latDat->ProcProvidingSiteByGlobalNoncontiguousId(43), 0);
           }
 
+          void TestStreamedIndicesMatchDistributionIndices()
+          {
+            // Whichever layout the distributions use, streaming to a local neighbour must land on
+            // that neighbour's distribution in the same direction, and everything else on the
+            // rubbish site.
+            typedef lb::lattices::D3Q15 Lattice;
+            const site_t rubbishIndex = latDat->GetLocalFluidSiteCount() * Lattice::NUMVECTORS;
+
+            for (site_t siteIndex = 0; siteIndex < latDat->GetLocalFluidSiteCount(); ++siteIndex)
+            {
+              const Site<LatticeData> site = latDat->GetSite(siteIndex);
+              for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+              {
+                const util::Vector3D<site_t> neighbourCoords = site.GetGlobalSiteCoords()
+                    + util::Vector3D<site_t>(Lattice::CX[direction],
+                                             Lattice::CY[direction],
+                                             Lattice::CZ[direction]);
+                site_t expected = rubbishIndex;
+                if (latDat->IsValidLatticeSite(neighbourCoords)
+                    && latDat->GetProcIdFromGlobalCoords(neighbourCoords) == 0)
+                {
+                  expected = latDat->GetDistributionIndex<Lattice>(latDat->GetContiguousSiteId(neighbourCoords),
+                                                                   direction);
+                }
+                CPPUNIT_ASSERT_EQUAL(expected, site.GetStreamedIndex<Lattice>(direction));
+              }
+            }
+          }
+
+          void TestWallLinksMatchSiteData()
+          {
+            typedef lb::lattices::D3Q15 Lattice;
+
+            // Add a wall link to a site in the middle, so that the list has to be rebuilt.
+            const site_t pokedSite = latDat->GetLocalFluidSiteCount() / 2;
+            latDat->SetHasWall(pokedSite, 3);
+
+            LatticeData::WallLinkIterator wallLink = latDat->GetFirstWallLink(0);
+            for (site_t siteIndex = 0; siteIndex < latDat->GetLocalFluidSiteCount(); ++siteIndex)
+            {
+              CPPUNIT_ASSERT(wallLink == latDat->GetFirstWallLink(siteIndex));
+
+              const Site<LatticeData> site = latDat->GetSite(siteIndex);
+              for (Direction direction = 1; direction < Lattice::NUMVECTORS; ++direction)
+              {
+                if (site.HasWall(direction))
+                {
+                  CPPUNIT_ASSERT_EQUAL(siteIndex, wallLink->siteIndex);
+                  CPPUNIT_ASSERT_EQUAL(direction, wallLink->direction);
+                  ++wallLink;
+                }
+              }
+            }
+            CPPUNIT_ASSERT(wallLink == latDat->GetFirstWallLink(latDat->GetLocalFluidSiteCount()));
+            CPPUNIT_ASSERT(latDat->GetSite(pokedSite).HasWall(3));
+          }
+
+          void TestLinkPatternRangesMatchSiteData()
+          {
+            // Change the links of a site in the middle, so that the runs have to be rebuilt.
+            const site_t pokedSite = latDat->GetLocalFluidSiteCount() / 2;
+            latDat->SetHasIolet(pokedSite, 5);
+            latDat->SetIoletId(pokedSite + 1, 7);
+
+            site_t expectedFirstSite = 0;
+            for (LatticeData::LinkPatternRangeIterator run = latDat->GetLinkPatternRange(0);
+                expectedFirstSite < latDat->GetLocalFluidSiteCount(); ++run)
+            {
+              CPPUNIT_ASSERT_EQUAL(expectedFirstSite, run->firstSite);
+              CPPUNIT_ASSERT(run->siteCount > 0);
+              for (site_t siteIndex = run->firstSite; siteIndex < run->firstSite + run->siteCount;
+                  ++siteIndex)
+              {
+                CPPUNIT_ASSERT(run == latDat->GetLinkPatternRange(siteIndex));
+                const Site<LatticeData> site = latDat->GetSite(siteIndex);
+                CPPUNIT_ASSERT_EQUAL(run->wallIntersection, site.GetSiteData().GetWallIntersectionData());
+                CPPUNIT_ASSERT_EQUAL(run->ioletIntersection, site.GetSiteData().GetIoletIntersectionData());
+                CPPUNIT_ASSERT_EQUAL(run->ioletId, site.GetIoletId());
+              }
+              expectedFirstSite += run->siteCount;
+            }
+            CPPUNIT_ASSERT(latDat->GetSite(pokedSite).HasIolet(5));
+          }
+
+          void TestCaptureSubdomain()
+          {
+            typedef lb::lattices::D3Q15 Lattice;
+            for (site_t index = 0; index < latDat->GetLocalFluidSiteCount() * Lattice::NUMVECTORS;
+                ++index)
+            {
+              *latDat->GetFNew(index) = 0.01 * index;
+            }
+            latDat->SwapOldAndNew();
+
+            std::vector<char> buffer(1 << 20);
+            {
+              hemelb::io::writers::xdr::XdrMemWriter writer(&buffer[0], buffer.size());
+              latDat->WriteSubdomain(writer);
+            }
+            hemelb::io::writers::xdr::XdrMemReader reader(&buffer[0], buffer.size());
+            LatticeData replayed(Lattice::GetLatticeInfo(), reader, Comms());
+
+            CPPUNIT_ASSERT_EQUAL(latDat->GetLocalFluidSiteCount(), replayed.GetLocalFluidSiteCount());
+            CPPUNIT_ASSERT_EQUAL(latDat->GetMidDomainSiteCount(), replayed.GetMidDomainSiteCount());
+            for (unsigned collisionType = 0; collisionType < COLLISION_TYPES; ++collisionType)
+            {
+              CPPUNIT_ASSERT_EQUAL(latDat->GetMidDomainCollisionCount(collisionType),
+                                   replayed.GetMidDomainCollisionCount(collisionType));
+            }
+            for (site_t siteIndex = 0; siteIndex < latDat->GetLocalFluidSiteCount(); ++siteIndex)
+            {
+              const Site<LatticeData> site = latDat->GetSite(siteIndex);
+              const Site<LatticeData> replayedSite = replayed.GetSite(siteIndex);
+              CPPUNIT_ASSERT_EQUAL(site.GetGlobalSiteCoords(), replayedSite.GetGlobalSiteCoords());
+              CPPUNIT_ASSERT_EQUAL(site.GetSiteData().GetWallIntersectionData(),
+                                   replayedSite.GetSiteData().GetWallIntersectionData());
+              for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+              {
+                CPPUNIT_ASSERT_EQUAL(site.GetStreamedIndex<Lattice>(direction),
+                                     replayedSite.GetStreamedIndex<Lattice>(direction));
+                CPPUNIT_ASSERT_EQUAL(site.GetFOld<Lattice>(direction),
+                                     replayedSite.GetFOld<Lattice>(direction));
+              }
+            }
+          }
+
         private:
       };
       CPPUNIT_TEST_SUITE_REGISTRATION ( NeighbouringLatticeDataTests);
@@ -0,0 +1,105 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_GEOMETRY_SITEWEIGHTSTESTS_H
+#define HEMELB_UNITTESTS_GEOMETRY_SITEWEIGHTSTESTS_H
+#include <cppunit/TestFixture.h>
+#include "geometry/decomposition/SiteWeights.h"
+#include "geometry/decomposition/DecompositionWeights.h"
+#include "unittests/helpers/FolderTestFixture.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace geometry
+    {
+      using namespace hemelb::geometry::decomposition;
+
+      class SiteWeightsTests : public FolderTestFixture
+      {
+          CPPUNIT_TEST_SUITE ( SiteWeightsTests);
+          CPPUNIT_TEST ( TestCompiledWeights);
+          CPPUNIT_TEST ( TestCalibrate);
+          CPPUNIT_TEST ( TestCalibrateBulkSiteTime);
+          CPPUNIT_TEST ( TestCalibrateWithoutBulkSites);
+          CPPUNIT_TEST ( TestWriteAndLoad);CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void TestCompiledWeights()
+          {
+            SiteWeights weights;
+            for (unsigned type = 0; type < COLLISION_TYPES; ++type)
+            {
+              CPPUNIT_ASSERT_EQUAL(hemelbSiteWeights[type], weights[type]);
+            }
+          }
+
+          void TestCalibrate()
+          {
+            // Bulk sites take 1s per 1000 sites; walls twice that, inlets 3.5 times and the
+            // wall/inlets a hundredth. There are no outlet sites.
+            double times[COLLISION_TYPES] = { 10.0, 2.0, 0.35, 0.0, 0.001, 0.0 };
+            site_t sites[COLLISION_TYPES] = { 10000, 1000, 100, 0, 100, 0 };
+
+            SiteWeights weights =
+                SiteWeights::Calibrate(std::vector<double>(times, times + COLLISION_TYPES),
+                                       std::vector<site_t>(sites, sites + COLLISION_TYPES));
+
+            CPPUNIT_ASSERT_EQUAL(SiteWeights::CalibratedBulkWeight, weights[0]);
+            CPPUNIT_ASSERT_EQUAL(2 * SiteWeights::CalibratedBulkWeight, weights[1]);
+            CPPUNIT_ASSERT_EQUAL(35, weights[2]);
+            // Types without sites keep their compiled weight relative to bulk...
+            CPPUNIT_ASSERT_EQUAL(int(SiteWeights::CalibratedBulkWeight * hemelbSiteWeights[3]
+                                     / double(hemelbSiteWeights[0]) + 0.5),
+                                 weights[3]);
+            // ... and no weight is below 1.
+            CPPUNIT_ASSERT_EQUAL(1, weights[4]);
+            // Without the number of steps, there's no telling how long a site took.
+            CPPUNIT_ASSERT_EQUAL(0.0, weights.GetBulkSiteTime());
+          }
+
+          void TestCalibrateBulkSiteTime()
+          {
+            // 10000 bulk sites for 100 steps in 10s.
+            SiteWeights weights = SiteWeights::Calibrate(std::vector<double>(COLLISION_TYPES, 10.0),
+                                                         std::vector<site_t>(COLLISION_TYPES, 10000),
+                                                         100);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1e-5, weights.GetBulkSiteTime(), 1e-15);
+          }
+
+          void TestCalibrateWithoutBulkSites()
+          {
+            SiteWeights weights = SiteWeights::Calibrate(std::vector<double>(COLLISION_TYPES, 1.0),
+                                                         std::vector<site_t>(COLLISION_TYPES, 0));
+            CPPUNIT_ASSERT(weights.GetWeights() == SiteWeights().GetWeights());
+          }
+
+          void TestWriteAndLoad()
+          {
+            double times[COLLISION_TYPES] = { 1.0, 3.0, 5.0, 5.0, 7.0, 7.0 };
+            SiteWeights written =
+                SiteWeights::Calibrate(std::vector<double>(times, times + COLLISION_TYPES),
+                                       std::vector<site_t>(COLLISION_TYPES, 100),
+                                       1000);
+            if (Comms().Rank() == 0)
+            {
+              written.Write("weights.txt");
+            }
+
+            SiteWeights loaded;
+            CPPUNIT_ASSERT(!SiteWeights::Load("missing.txt", Comms(), loaded));
+            CPPUNIT_ASSERT(SiteWeights::Load("weights.txt", Comms(), loaded));
+            CPPUNIT_ASSERT(written.GetWeights() == loaded.GetWeights());
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(written.GetBulkSiteTime(), loaded.GetBulkSiteTime(), 1e-10);
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION ( SiteWeightsTests);
+    }
+  }
+}
+
+#endif // HEMELB_UNITTESTS_GEOMETRY_SITEWEIGHTSTESTS_H
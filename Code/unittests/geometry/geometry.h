@@ -9,6 +9,10 @@
 
 #include "unittests/geometry/GeometryReaderTests.h"
 #include "unittests/geometry/NeedsTests.h"
+#include "unittests/geometry/SiteWeightsTests.h"
+#include "unittests/geometry/BlockTests.h"
+#include "unittests/geometry/CompressedDistributionsTests.h"
+#include "unittests/geometry/GeometrySiteTests.h"
 #include "unittests/geometry/LatticeDataTests.h"
 #include "unittests/geometry/neighbouring/neighbouring.h"
 
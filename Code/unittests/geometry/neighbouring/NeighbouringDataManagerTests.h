@@ -30,6 +30,7 @@ namespace hemelb
             CPPUNIT_TEST ( TestShareConstantDataOneProc);
             CPPUNIT_TEST ( TestShareFieldDataOneProc);
             CPPUNIT_TEST ( TestShareFieldDataOneProcViaIterableAction);
+            CPPUNIT_TEST ( TestShareFieldDataSomeDirectionsOneProc);
 
             CPPUNIT_TEST_SUITE_END();
 
@@ -107,6 +108,13 @@ namespace hemelb
               needsShouldBeReceivedFromSelf.push_back(43); //fixture
               netMock->RequireSend(&needsShouldBeSentToSelf.front(), 1, 0, "NeedToSelf");
               netMock->RequireReceive(&needsShouldBeSentToSelf.front(), 1, 0, "NeedFromSelf");
+              std::vector<uint32_t> directionsShouldBeSentToSelf(1,
+                                                                 RequiredSiteInformation::AllDirections);
+              netMock->RequireSend(&directionsShouldBeSentToSelf.front(), 1, 0, "DirectionsToSelf");
+              netMock->RequireReceive(&directionsShouldBeSentToSelf.front(),
+                                      1,
+                                      0,
+                                      "DirectionsFromSelf");
 
               manager->ShareNeeds();
               netMock->ExpectationsAllCompleted();
@@ -132,6 +140,13 @@ namespace hemelb
               needsShouldBeReceivedFromSelf.push_back(43); //fixture
               netMock->RequireSend(&needsShouldBeSentToSelf.front(), 1, 0, "NeedToSelf");
               netMock->RequireReceive(&needsShouldBeSentToSelf.front(), 1, 0, "NeedFromSelf");
+              std::vector<uint32_t> directionsShouldBeSentToSelf(1,
+                                                                 RequiredSiteInformation::AllDirections);
+              netMock->RequireSend(&directionsShouldBeSentToSelf.front(), 1, 0, "DirectionsToSelf");
+              netMock->RequireReceive(&directionsShouldBeSentToSelf.front(),
+                                      1,
+                                      0,
+                                      "DirectionsFromSelf");
 
               manager->RegisterNeededSite(43);
               manager->ShareNeeds();
@@ -212,6 +227,13 @@ namespace hemelb
               needsShouldBeReceivedFromSelf.push_back(targetGlobalOneDIdx); //fixture
               netMock->RequireSend(&needsShouldBeSentToSelf.front(), 1, 0, "NeedToSelf");
               netMock->RequireReceive(&needsShouldBeSentToSelf.front(), 1, 0, "NeedFromSelf");
+              std::vector<uint32_t> directionsShouldBeSentToSelf(1,
+                                                                 RequiredSiteInformation::AllDirections);
+              netMock->RequireSend(&directionsShouldBeSentToSelf.front(), 1, 0, "DirectionsToSelf");
+              netMock->RequireReceive(&directionsShouldBeSentToSelf.front(),
+                                      1,
+                                      0,
+                                      "DirectionsFromSelf");
 
               manager->RegisterNeededSite(targetGlobalOneDIdx);
               manager->ShareNeeds();
@@ -222,7 +244,8 @@ namespace hemelb
 
               // It should arrive in the NeighbouringDataManager, from the values sent from the localLatticeData
 
-              netMock->RequireSend(const_cast<distribn_t*> (exampleSite.GetFOld<lb::lattices::D3Q15> ()),
+              distribn_t exampleFOld[lb::lattices::D3Q15::NUMVECTORS];
+              netMock->RequireSend(const_cast<distribn_t*> (exampleSite.GetFOld<lb::lattices::D3Q15> (exampleFOld)),
                                    lb::lattices::D3Q15::NUMVECTORS,
                                    0,
                                    "IntersectionDataToSelf");
@@ -263,6 +286,13 @@ namespace hemelb
               needsShouldBeReceivedFromSelf.push_back(targetGlobalOneDIdx); //fixture
               netMock->RequireSend(&needsShouldBeSentToSelf.front(), 1, 0, "NeedToSelf");
               netMock->RequireReceive(&needsShouldBeSentToSelf.front(), 1, 0, "NeedFromSelf");
+              std::vector<uint32_t> directionsShouldBeSentToSelf(1,
+                                                                 RequiredSiteInformation::AllDirections);
+              netMock->RequireSend(&directionsShouldBeSentToSelf.front(), 1, 0, "DirectionsToSelf");
+              netMock->RequireReceive(&directionsShouldBeSentToSelf.front(),
+                                      1,
+                                      0,
+                                      "DirectionsFromSelf");
 
               manager->RegisterNeededSite(targetGlobalOneDIdx);
               manager->ShareNeeds();
@@ -272,7 +302,8 @@ namespace hemelb
               Site < LatticeData > exampleSite = latDat->GetSite(targetLocalIdx);
               // It should arrive in the NeighbouringDataManager, from the values sent from the localLatticeData
 
-              netMock->RequireSend(const_cast<distribn_t*> (exampleSite.GetFOld<lb::lattices::D3Q15> ()),
+              distribn_t exampleFOld[lb::lattices::D3Q15::NUMVECTORS];
+              netMock->RequireSend(const_cast<distribn_t*> (exampleSite.GetFOld<lb::lattices::D3Q15> (exampleFOld)),
                                    lb::lattices::D3Q15::NUMVECTORS,
                                    0,
                                    "IntersectionDataToSelf");
@@ -297,6 +328,55 @@ namespace hemelb
               }
             }
 
+            void TestShareFieldDataSomeDirectionsOneProc()
+            {
+              site_t targetGlobalOneDIdx = 43;
+              site_t targetLocalIdx = latDat->GetLocalContiguousIdFromGlobalNoncontiguousId(targetGlobalOneDIdx);
+
+              // Only the distributions in directions 1 and 4 are needed.
+              RequiredSiteInformation requirements;
+              requirements.RequireDirection(1);
+              requirements.RequireDirection(4);
+
+              std::vector<int> countOfNeedsToZeroFromZero(1, 1);
+              std::vector<int> countOfNeedsFromZeroToZero(1, 1);
+              netMock->RequireSend(&countOfNeedsToZeroFromZero.front(), 1, 0, "CountToSelf");
+              netMock->RequireReceive(&countOfNeedsFromZeroToZero.front(), 1, 0, "CountFromSelf");
+              std::vector<site_t> needsShouldBeSentToSelf(1, targetGlobalOneDIdx);
+              netMock->RequireSend(&needsShouldBeSentToSelf.front(), 1, 0, "NeedToSelf");
+              netMock->RequireReceive(&needsShouldBeSentToSelf.front(), 1, 0, "NeedFromSelf");
+              std::vector<uint32_t> directionsShouldBeSentToSelf(1, (1 << 1) | (1 << 4));
+              netMock->RequireSend(&directionsShouldBeSentToSelf.front(), 1, 0, "DirectionsToSelf");
+              netMock->RequireReceive(&directionsShouldBeSentToSelf.front(),
+                                      1,
+                                      0,
+                                      "DirectionsFromSelf");
+
+              manager->RegisterNeededSite(targetGlobalOneDIdx, requirements);
+              manager->ShareNeeds();
+              netMock->ExpectationsAllCompleted();
+              CPPUNIT_ASSERT_EQUAL(uint32_t( (1 << 1) | (1 << 4)),
+                                   manager->GetDirectionsForProc(0).front());
+
+              // Just those two are sent, packed, and received into the neighbouring data.
+              Site < LatticeData > exampleSite = latDat->GetSite(targetLocalIdx);
+              std::vector<distribn_t> sentFOld;
+              sentFOld.push_back(exampleSite.GetFOld<lb::lattices::D3Q15>(1));
+              sentFOld.push_back(exampleSite.GetFOld<lb::lattices::D3Q15>(4));
+              netMock->RequireSend(&sentFOld[0], 2, 0, "SomeDistributionsToSelf");
+              std::vector<distribn_t> receivedFOld;
+              receivedFOld.push_back(53.0);
+              receivedFOld.push_back(54.0);
+              netMock->RequireReceive(&receivedFOld[0], 2, 0, "SomeDistributionsFromSelf");
+
+              manager->TransferFieldDependentInformation();
+              netMock->ExpectationsAllCompleted();
+
+              NeighbouringSite transferredSite = data->GetSite(targetGlobalOneDIdx);
+              CPPUNIT_ASSERT_EQUAL(53.0, transferredSite.GetFOld<lb::lattices::D3Q15> ()[1]);
+              CPPUNIT_ASSERT_EQUAL(54.0, transferredSite.GetFOld<lb::lattices::D3Q15> ()[4]);
+            }
+
           private:
             NeighbouringDataManager *manager;
             NeighbouringLatticeData *data;
@@ -28,6 +28,7 @@ namespace hemelb
             CPPUNIT_TEST (TestInsertAndRetrieveNormal);
             CPPUNIT_TEST (TestInsertAndRetrieveDistributions);
             CPPUNIT_TEST (TestNeighbouringSite);
+            CPPUNIT_TEST (TestManySites);
 
             CPPUNIT_TEST_SUITE_END();
 
@@ -86,14 +87,14 @@ namespace hemelb
               std::vector<distribn_t> distribution;
               for (unsigned int direction = 0; direction < lb::lattices::D3Q15::NUMVECTORS; direction++)
               {
-                distribution.push_back(exampleSite->GetFOld<lb::lattices::D3Q15>()[direction]);
+                distribution.push_back(exampleSite->GetFOld<lb::lattices::D3Q15>(direction));
               }
 
-              data->GetDistribution(dummyId) = distribution;
+              std::copy(distribution.begin(), distribution.end(), data->GetDistribution(dummyId));
 
               for (unsigned int direction = 0; direction < lb::lattices::D3Q15::NUMVECTORS; direction++)
               {
-                CPPUNIT_ASSERT_EQUAL(exampleSite->GetFOld<lb::lattices::D3Q15>()[direction],
+                CPPUNIT_ASSERT_EQUAL(exampleSite->GetFOld<lb::lattices::D3Q15>(direction),
                                      data->GetFOld(dummyId * lb::lattices::D3Q15::NUMVECTORS)[direction]);
               }
             }
@@ -110,7 +111,7 @@ namespace hemelb
               std::vector<distribn_t> distribution;
               for (unsigned int direction = 0; direction < lb::lattices::D3Q15::NUMVECTORS; direction++)
               {
-                distribution.push_back(exampleSite->GetFOld<lb::lattices::D3Q15>()[direction]);
+                distribution.push_back(exampleSite->GetFOld<lb::lattices::D3Q15>(direction));
               }
               data->SaveSite(dummyId,
                              distribution,
@@ -129,11 +130,33 @@ namespace hemelb
               CPPUNIT_ASSERT_EQUAL(exampleSite->GetWallNormal(), neighbouringSite.GetWallNormal());
               for (unsigned int direction = 0; direction < lb::lattices::D3Q15::NUMVECTORS; direction++)
               {
-                CPPUNIT_ASSERT_EQUAL(exampleSite->GetFOld<lb::lattices::D3Q15>()[direction],
+                CPPUNIT_ASSERT_EQUAL(exampleSite->GetFOld<lb::lattices::D3Q15>(direction),
                                      neighbouringSite.GetFOld<lb::lattices::D3Q15>()[direction]);
               }
             }
 
+            void TestManySites()
+            {
+              // Enough sites, with scattered ids, to make the index grow several times.
+              const site_t sites = 1000;
+              for (site_t site = 0; site < sites; ++site)
+              {
+                const site_t globalId = site * 7919;
+                CPPUNIT_ASSERT(!data->HasSite(globalId));
+                data->GetDistribution(globalId)[2] = site;
+                data->GetCutDistances(globalId)[0] = -site;
+              }
+
+              for (site_t site = 0; site < sites; ++site)
+              {
+                const site_t globalId = site * 7919;
+                CPPUNIT_ASSERT(data->HasSite(globalId));
+                CPPUNIT_ASSERT_EQUAL(distribn_t(site), *data->GetFOld(globalId * lb::lattices::D3Q15::NUMVECTORS + 2));
+                CPPUNIT_ASSERT_EQUAL(distribn_t(-site), data->GetCutDistance<lb::lattices::D3Q15>(globalId, 1));
+              }
+              CPPUNIT_ASSERT(!data->HasSite(1));
+            }
+
           private:
             NeighbouringLatticeData *data;
             Site<LatticeData> *exampleSite;
@@ -26,6 +26,7 @@ namespace hemelb
             CPPUNIT_TEST (TestAnyNonFieldDependent);
             CPPUNIT_TEST (TestAnyFieldDependent);
             CPPUNIT_TEST (TestAnyMacroscopic);
+            CPPUNIT_TEST (TestDirections);
 
             CPPUNIT_TEST_SUITE_END();
 
@@ -91,6 +92,27 @@ namespace hemelb
               CPPUNIT_ASSERT(requirements->RequiresAnyMacroscopic());
             }
 
+            void TestDirections()
+            {
+              CPPUNIT_ASSERT_EQUAL(uint32_t(0), requirements->GetRequiredDirections());
+              requirements->RequireDirection(1);
+              requirements->RequireDirection(4);
+              CPPUNIT_ASSERT_EQUAL(uint32_t(0x12), requirements->GetRequiredDirections());
+              CPPUNIT_ASSERT(requirements->RequiresAnyFieldDependent());
+
+              RequiredSiteInformation other;
+              other.RequireDirection(2);
+              requirements->Or(other);
+              CPPUNIT_ASSERT_EQUAL(uint32_t(0x16), requirements->GetRequiredDirections());
+
+              // Any macroscopic term needs every distribution.
+              requirements->Require(terms::Density);
+              CPPUNIT_ASSERT_EQUAL(RequiredSiteInformation::AllDirections,
+                                   requirements->GetRequiredDirections());
+              CPPUNIT_ASSERT_EQUAL(RequiredSiteInformation::AllDirections,
+                                   RequiredSiteInformation(true).GetRequiredDirections());
+            }
+
           private:
             RequiredSiteInformation *requirements;
         };
@@ -0,0 +1,114 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_IO_BLOCKDECOMPRESSORTESTS_H
+#define HEMELB_UNITTESTS_IO_BLOCKDECOMPRESSORTESTS_H
+
+#include <vector>
+#include <zlib.h>
+#ifdef HEMELB_USE_ZSTD
+#include <zstd.h>
+#endif
+#include <cppunit/TestFixture.h>
+#include "io/formats/geometry.h"
+#include "io/readers/BlockDecompressor.h"
+#include "Exception.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace io
+    {
+      /**
+       * Decompresses blocks as the setup tool compresses them.
+       */
+      class BlockDecompressorTests : public CppUnit::TestFixture
+      {
+          CPPUNIT_TEST_SUITE(BlockDecompressorTests);
+          CPPUNIT_TEST(TestZlib);
+          CPPUNIT_TEST(TestWrongLength);
+          CPPUNIT_TEST(TestUnknownCompression);
+#ifdef HEMELB_USE_ZSTD
+          CPPUNIT_TEST(TestZstd);
+#endif
+          CPPUNIT_TEST_SUITE_END();
+        public:
+          void setUp()
+          {
+            block.resize(1000);
+            for (size_t i = 0; i < block.size(); ++i)
+            {
+              block[i] = char(i % 7);
+            }
+          }
+
+          void TestZlib()
+          {
+            std::vector<char> compressed = CompressWithZlib();
+            hemelb::io::readers::BlockDecompressor decompressor;
+            std::vector<char> uncompressed(block.size());
+            CPPUNIT_ASSERT(decompressor.Decompress(&compressed[0], compressed.size(), uncompressed));
+            CPPUNIT_ASSERT(uncompressed == block);
+          }
+
+          void TestWrongLength()
+          {
+            std::vector<char> compressed = CompressWithZlib();
+            hemelb::io::readers::BlockDecompressor decompressor;
+            std::vector<char> uncompressed(block.size() + 1);
+            CPPUNIT_ASSERT(!decompressor.Decompress(&compressed[0], compressed.size(), uncompressed));
+          }
+
+          void TestUnknownCompression()
+          {
+            hemelb::io::readers::BlockDecompressor decompressor;
+            CPPUNIT_ASSERT_THROW(decompressor.Reset(2, std::vector<char>()), Exception);
+#ifndef HEMELB_USE_ZSTD
+            CPPUNIT_ASSERT_THROW(decompressor.Reset(hemelb::io::formats::geometry::ZSTD_COMPRESSION,
+                                                    std::vector<char>()), Exception);
+#endif
+          }
+
+#ifdef HEMELB_USE_ZSTD
+          void TestZstd()
+          {
+            std::vector<char> compressed(ZSTD_compressBound(block.size()));
+            compressed.resize(ZSTD_compress(&compressed[0],
+                                            compressed.size(),
+                                            &block[0],
+                                            block.size(),
+                                            19));
+            hemelb::io::readers::BlockDecompressor decompressor;
+            decompressor.Reset(hemelb::io::formats::geometry::ZSTD_COMPRESSION, std::vector<char>());
+            std::vector<char> uncompressed(block.size());
+            CPPUNIT_ASSERT(decompressor.Decompress(&compressed[0], compressed.size(), uncompressed));
+            CPPUNIT_ASSERT(uncompressed == block);
+          }
+#endif
+
+        private:
+          std::vector<char> CompressWithZlib()
+          {
+            uLongf length = compressBound(block.size());
+            std::vector<char> compressed(length);
+            compress2(reinterpret_cast<Bytef*>(&compressed[0]),
+                      &length,
+                      reinterpret_cast<const Bytef*>(&block[0]),
+                      block.size(),
+                      9);
+            compressed.resize(length);
+            return compressed;
+          }
+
+          std::vector<char> block;
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION(BlockDecompressorTests);
+    }
+  }
+}
+
+#endif // HEMELB_UNITTESTS_IO_BLOCKDECOMPRESSORTESTS_H
@@ -0,0 +1,387 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_IO_EXTRACTIONFILETESTS_H
+#define HEMELB_UNITTESTS_IO_EXTRACTIONFILETESTS_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include <cppunit/TestFixture.h>
+#include "io/formats/formats.h"
+#include "io/SubfileIndex.h"
+#include "io/readers/ExtractionFileSet.h"
+#include "io/writers/xdr/XdrMemWriter.h"
+#include "Exception.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace io
+    {
+      namespace extraction = hemelb::io::formats::extraction;
+
+      /**
+       * Reads small extraction files, put together byte by byte, through the mapped reader.
+       */
+      class ExtractionFileTests : public CppUnit::TestFixture
+      {
+          CPPUNIT_TEST_SUITE(ExtractionFileTests);
+          CPPUNIT_TEST(TestPositionsInRecords);
+          CPPUNIT_TEST(TestSiteLists);
+          CPPUNIT_TEST(TestFixedPoint);
+          CPPUNIT_TEST(TestDeltaEncoding);
+          CPPUNIT_TEST(TestTruncated);
+          CPPUNIT_TEST(TestSubfileParts);
+          CPPUNIT_TEST(TestSubfilePartsMismatched);
+          CPPUNIT_TEST_SUITE_END();
+        public:
+          void tearDown()
+          {
+            std::remove(fileName);
+            std::remove(GetPartPath(0).c_str());
+            std::remove(GetPartPath(1).c_str());
+          }
+
+          void TestPositionsInRecords()
+          {
+            std::vector<char> bytes;
+            PutHeaders(bytes, extraction::VersionNumber);
+            for (uint64_t timestep = 100; timestep <= 200; timestep += 100)
+            {
+              Put(bytes, timestep);
+              for (uint32_t site = 0; site < 2; ++site)
+              {
+                Put(bytes, site);
+                Put(bytes, 2 * site);
+                Put(bytes, 3 * site);
+                PutValues(bytes, timestep, site);
+              }
+            }
+            WriteFile(bytes);
+
+            const hemelb::io::readers::ExtractionFile file(fileName);
+            CPPUNIT_ASSERT_EQUAL(unsigned(extraction::VersionNumber), file.GetVersion());
+            CPPUNIT_ASSERT_EQUAL(uint64_t(2), file.GetSiteCount());
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5e-3, file.GetVoxelSize(), 1e-12);
+            CPPUNIT_ASSERT_EQUAL(size_t(2), file.GetFields().size());
+            CPPUNIT_ASSERT_EQUAL(std::string("velocity"), file.GetFields()[1].name);
+            CPPUNIT_ASSERT_EQUAL(size_t(2), file.GetRecordCount());
+            CPPUNIT_ASSERT_EQUAL(size_t(1), file.FindRecord(200));
+
+            const hemelb::io::readers::PositionView positions = file.GetPositions(1);
+            CPPUNIT_ASSERT_EQUAL(site_t(2), positions.GetPosition(1).y);
+            CPPUNIT_ASSERT_EQUAL(site_t(3), positions.GetPosition(1).z);
+            CheckValues(file, 1, 200);
+          }
+
+          void TestSiteLists()
+          {
+            // The sites move between the two records.
+            std::vector<char> bytes;
+            PutHeaders(bytes, extraction::SiteListVersionNumber);
+            for (uint64_t timestep = 100; timestep <= 200; timestep += 100)
+            {
+              Put(bytes, extraction::SiteListMarker);
+              for (uint32_t site = 0; site < 2; ++site)
+              {
+                Put(bytes, uint32_t(site + timestep));
+                Put(bytes, 0u);
+                Put(bytes, 0u);
+              }
+              Put(bytes, timestep);
+              PutValues(bytes, timestep, 0);
+              PutValues(bytes, timestep, 1);
+            }
+            WriteFile(bytes);
+
+            const hemelb::io::readers::ExtractionFile file(fileName);
+            CPPUNIT_ASSERT_EQUAL(size_t(2), file.GetRecordCount());
+            CPPUNIT_ASSERT_EQUAL(site_t(101), file.GetPositions(0).GetPosition(1).x);
+            CPPUNIT_ASSERT_EQUAL(site_t(201), file.GetPositions(1).GetPosition(1).x);
+            CheckValues(file, 0, 100);
+            CheckValues(file, 1, 200);
+            CPPUNIT_ASSERT_THROW(file.FindRecord(150), hemelb::Exception);
+          }
+
+          void TestFixedPoint()
+          {
+            std::vector<char> bytes;
+            PutHeaders(bytes, extraction::EncodedVersionNumber, extraction::Fixed16Encoding);
+            Put(bytes, uint64_t(100));
+            // The minimum and scale of each field.
+            Put(bytes, -1.0);
+            Put(bytes, 0.5);
+            Put(bytes, 2.0);
+            Put(bytes, 0.25);
+            for (uint32_t site = 0; site < 2; ++site)
+            {
+              Put(bytes, site);
+              Put(bytes, 0u);
+              Put(bytes, 0u);
+              // Four 16-bit values, two to a word.
+              Put(bytes, (site << 16) | 1u);
+              Put(bytes, (2u << 16) | 3u);
+            }
+            WriteFile(bytes);
+
+            const hemelb::io::readers::ExtractionFile file(fileName);
+            CPPUNIT_ASSERT_EQUAL(extraction::Fixed16Encoding, file.GetEncoding());
+            const hemelb::io::readers::FieldView pressure = file.GetFieldView(0, 0);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(80. - 1.0 + 0.5, pressure.Get(1), 1e-12);
+            const hemelb::io::readers::FieldView velocity = file.GetFieldView(0, 1);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0 + 0.25 * 3, velocity.Get(1, 2), 1e-12);
+          }
+
+          void TestDeltaEncoding()
+          {
+            // A keyframe, then the differences from it.
+            const int32_t keyframe[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+            const int32_t deltas[8] = { 1, -1, 0, 0, 0, 0, 0, -7 };
+            std::vector<char> bytes;
+            PutHeaders(bytes, extraction::EncodedVersionNumber, extraction::DeltaEncoding,
+                       extraction::SiteLists);
+            Put(bytes, extraction::SiteListMarker);
+            for (uint32_t site = 0; site < 6; ++site)
+            {
+              Put(bytes, site);
+            }
+            PutDeltaRecord(bytes, 100, true, keyframe);
+            PutDeltaRecord(bytes, 200, false, deltas);
+            WriteFile(bytes);
+
+            const hemelb::io::readers::ExtractionFile file(fileName);
+            CPPUNIT_ASSERT_EQUAL(size_t(2), file.GetRecordCount());
+            CPPUNIT_ASSERT_THROW(file.GetFieldView(1, 0), hemelb::Exception);
+            std::vector<float> values;
+            file.DecodeRecord(1, values);
+            CPPUNIT_ASSERT_EQUAL(size_t(8), values.size());
+            // The pressure has an offset of 80, a minimum of 1 and a scale of 0.5...
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(80. + 1. + 0.5 * 1, values[0], 1e-5);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(80. + 1. + 0.5 * 4, values[4], 1e-5);
+            // ... and the velocity none, a minimum of -1 and a scale of 2.
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(-1. + 2. * 0, values[1], 1e-5);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(-1. + 2. * 0, values[7], 1e-5);
+          }
+
+          void TestTruncated()
+          {
+            std::vector<char> bytes;
+            PutHeaders(bytes, extraction::VersionNumber);
+            Put(bytes, uint64_t(100));
+            Put(bytes, 0u);
+            WriteFile(bytes);
+            CPPUNIT_ASSERT_THROW(hemelb::io::readers::ExtractionFile file(fileName),
+                                 hemelb::Exception);
+          }
+
+          void TestSubfileParts()
+          {
+            hemelb::io::SubfileIndex index(extraction::MagicNumber);
+            for (unsigned part = 0; part < 2; ++part)
+            {
+              std::vector<char> bytes;
+              PutHeaders(bytes, extraction::VersionNumber);
+              Put(bytes, uint64_t(100));
+              for (uint32_t site = 0; site < 2; ++site)
+              {
+                Put(bytes, 2 * part + site);
+                Put(bytes, 0u);
+                Put(bytes, 0u);
+                PutValues(bytes, 100, 2 * part + site);
+              }
+              WriteFile(bytes, GetPartPath(part));
+              index.AddPart(GetPartPath(part), 2);
+            }
+            index.Write(fileName);
+
+            // A whole file is a set of one part.
+            const hemelb::io::readers::ExtractionFileSet onePart(GetPartPath(1));
+            CPPUNIT_ASSERT_EQUAL(size_t(1), onePart.GetPartCount());
+            CPPUNIT_ASSERT_EQUAL(uint64_t(2), onePart.GetSiteCount());
+
+            const hemelb::io::readers::ExtractionFileSet fileSet(fileName);
+            CPPUNIT_ASSERT_EQUAL(size_t(2), fileSet.GetPartCount());
+            CPPUNIT_ASSERT_EQUAL(uint64_t(4), fileSet.GetSiteCount());
+            CPPUNIT_ASSERT_EQUAL(uint64_t(2), fileSet.GetFirstSite(1));
+            CPPUNIT_ASSERT_EQUAL(size_t(0), fileSet.GetFirstPart().FindRecord(100));
+
+            std::vector<util::Vector3D<site_t> > positions;
+            fileSet.GetPositions(0, positions);
+            CPPUNIT_ASSERT_EQUAL(size_t(4), positions.size());
+            CPPUNIT_ASSERT_EQUAL(site_t(3), positions[3].x);
+
+            std::vector<float> values;
+            fileSet.DecodeRecord(0, values);
+            CPPUNIT_ASSERT_EQUAL(size_t(16), values.size());
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(80. + GetValue(100, 2, 0), values[8], 1e-3);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(GetValue(100, 3, 3), values[15], 1e-3);
+          }
+
+          void TestSubfilePartsMismatched()
+          {
+            // The second part has another time step.
+            hemelb::io::SubfileIndex index(extraction::MagicNumber);
+            for (unsigned part = 0; part < 2; ++part)
+            {
+              std::vector<char> bytes;
+              PutHeaders(bytes, extraction::VersionNumber);
+              Put(bytes, uint64_t(100 + part));
+              for (uint32_t site = 0; site < 2; ++site)
+              {
+                Put(bytes, site);
+                Put(bytes, 0u);
+                Put(bytes, 0u);
+                PutValues(bytes, 100, site);
+              }
+              WriteFile(bytes, GetPartPath(part));
+              index.AddPart(GetPartPath(part), 2);
+            }
+            index.Write(fileName);
+            CPPUNIT_ASSERT_THROW(hemelb::io::readers::ExtractionFileSet fileSet(fileName),
+                                 hemelb::Exception);
+          }
+
+        private:
+          static std::string GetPartPath(unsigned part)
+          {
+            return std::string(fileName) + (part == 0 ?
+              ".0" :
+              ".1");
+          }
+
+          template<typename T>
+          void Put(std::vector<char>& bytes, const T& value)
+          {
+            char encoded[64];
+            hemelb::io::writers::xdr::XdrMemWriter writer(encoded, sizeof(encoded));
+            writer << value;
+            bytes.insert(bytes.end(), encoded, encoded + writer.getCurrentStreamPosition());
+          }
+
+          /**
+           * The headers of a file of two sites with a pressure and a velocity field.
+           */
+          void PutHeaders(std::vector<char>& bytes, unsigned version,
+                          extraction::Encoding encoding = extraction::Float32Encoding,
+                          unsigned flags = 0)
+          {
+            std::vector<char> fieldHeader;
+            if (version == extraction::EncodedVersionNumber)
+            {
+              Put(fieldHeader, uint32_t(encoding));
+              Put(fieldHeader, uint32_t(flags));
+            }
+            Put(fieldHeader, std::string("pressure"));
+            Put(fieldHeader, 1u);
+            Put(fieldHeader, 80.);
+            Put(fieldHeader, std::string("velocity"));
+            Put(fieldHeader, 3u);
+            Put(fieldHeader, 0.);
+
+            Put(bytes, uint32_t(hemelb::io::formats::HemeLbMagicNumber));
+            Put(bytes, uint32_t(extraction::MagicNumber));
+            Put(bytes, uint32_t(version));
+            Put(bytes, 0.5e-3);
+            Put(bytes, 0.1);
+            Put(bytes, 0.2);
+            Put(bytes, 0.3);
+            Put(bytes, uint64_t(2));
+            Put(bytes, 2u);
+            Put(bytes, uint32_t(fieldHeader.size()));
+            bytes.insert(bytes.end(), fieldHeader.begin(), fieldHeader.end());
+          }
+
+          float GetValue(uint64_t timestep, unsigned site, unsigned value)
+          {
+            return float(timestep + 10 * site + value);
+          }
+
+          void PutValues(std::vector<char>& bytes, uint64_t timestep, unsigned site)
+          {
+            for (unsigned value = 0; value < 4; ++value)
+            {
+              Put(bytes, GetValue(timestep, site, value));
+            }
+          }
+
+          void CheckValues(const hemelb::io::readers::ExtractionFile& file, size_t record,
+                           uint64_t timestep)
+          {
+            CPPUNIT_ASSERT_EQUAL(timestep, file.GetTimestep(record));
+            const hemelb::io::readers::FieldView pressure = file.GetFieldView(record, 0);
+            const hemelb::io::readers::FieldView velocity = file.GetFieldView(record, 1);
+            CPPUNIT_ASSERT_EQUAL(3u, velocity.GetLength());
+            for (unsigned site = 0; site < 2; ++site)
+            {
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(80. + GetValue(timestep, site, 0), pressure.Get(site), 1e-3);
+              for (unsigned component = 0; component < 3; ++component)
+              {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(GetValue(timestep, site, component + 1),
+                                             velocity.Get(site, component),
+                                             1e-3);
+              }
+            }
+
+            std::vector<float> values;
+            file.DecodeRecord(record, values);
+            CPPUNIT_ASSERT_EQUAL(size_t(8), values.size());
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(GetValue(timestep, 1, 3), values[7], 1e-3);
+          }
+
+          /**
+           * A delta encoded record, with all the values in one chunk.
+           */
+          void PutDeltaRecord(std::vector<char>& bytes, uint64_t timestep, bool keyframe,
+                              const int32_t* stored)
+          {
+            std::vector<Bytef> planes(32);
+            for (unsigned value = 0; value < 8; ++value)
+            {
+              const uint32_t zigzag = (uint32_t(stored[value]) << 1)
+                  ^ uint32_t(stored[value] >> 31);
+              for (unsigned plane = 0; plane < 4; ++plane)
+              {
+                planes[8 * plane + value] = Bytef(zigzag >> (24 - 8 * plane));
+              }
+            }
+            std::vector<Bytef> chunk(compressBound(planes.size()));
+            uLongf chunkLength = chunk.size();
+            CPPUNIT_ASSERT_EQUAL(Z_OK, compress(&chunk[0], &chunkLength, &planes[0], planes.size()));
+            chunk.resize(4 * ( (chunkLength + 3) / 4), 0);
+
+            Put(bytes, timestep);
+            Put(bytes, uint32_t(keyframe
+              ? 1
+              : 0));
+            Put(bytes, 1.);
+            Put(bytes, 0.5);
+            Put(bytes, -1.);
+            Put(bytes, 2.);
+            Put(bytes, 1u);
+            Put(bytes, uint32_t(chunkLength));
+            bytes.insert(bytes.end(), chunk.begin(), chunk.end());
+          }
+
+          void WriteFile(const std::vector<char>& bytes, const std::string& path = fileName)
+          {
+            std::FILE* file = std::fopen(path.c_str(), "wb");
+            CPPUNIT_ASSERT(file != NULL);
+            std::fwrite(&bytes[0], 1, bytes.size(), file);
+            std::fclose(file);
+          }
+
+          static const char* fileName;
+      };
+
+      const char* ExtractionFileTests::fileName = "readers_test.xtr";
+      CPPUNIT_TEST_SUITE_REGISTRATION(ExtractionFileTests);
+    }
+  }
+}
+
+#endif // HEMELB_UNITTESTS_IO_EXTRACTIONFILETESTS_H
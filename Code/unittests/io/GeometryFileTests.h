@@ -0,0 +1,88 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_IO_GEOMETRYFILETESTS_H
+#define HEMELB_UNITTESTS_IO_GEOMETRYFILETESTS_H
+
+#include <vector>
+#include <cppunit/TestFixture.h>
+#include "io/readers/GeometryFile.h"
+#include "resources/Resource.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace io
+    {
+      /**
+       * Reads the four cube geometry through the mapped reader.
+       */
+      class GeometryFileTests : public CppUnit::TestFixture
+      {
+          CPPUNIT_TEST_SUITE(GeometryFileTests);
+          CPPUNIT_TEST(TestHeaders);
+          CPPUNIT_TEST(TestReadBlock);
+          CPPUNIT_TEST_SUITE_END();
+        public:
+          void setUp()
+          {
+            file = new hemelb::io::readers::GeometryFile(resources::Resource("four_cube.gmy").Path());
+          }
+
+          void tearDown()
+          {
+            delete file;
+          }
+
+          void TestHeaders()
+          {
+            // A single block of six sites a side, with the four cube of fluid in the middle.
+            CPPUNIT_ASSERT_EQUAL(util::Vector3D<site_t>(1, 1, 1), file->GetBlockDimensions());
+            CPPUNIT_ASSERT_EQUAL(site_t(6), file->GetBlockSize());
+            CPPUNIT_ASSERT_EQUAL(site_t(1), file->GetBlockCount());
+            CPPUNIT_ASSERT_EQUAL(site_t(64), file->GetFluidSiteCount(0));
+          }
+
+          void TestReadBlock()
+          {
+            std::vector<geometry::GeometrySite> sites;
+            file->ReadBlock(0, sites);
+            CPPUNIT_ASSERT_EQUAL(size_t(216), sites.size());
+
+            site_t fluidSites = 0;
+            for (size_t site = 0; site < sites.size(); ++site)
+            {
+              if (sites[site].isFluid)
+              {
+                ++fluidSites;
+              }
+            }
+            CPPUNIT_ASSERT_EQUAL(site_t(64), fluidSites);
+            CPPUNIT_ASSERT(!sites[0].isFluid);
+
+            // The corner site at (1, 1, 1) has the inlet half way along its link to (0, 0, 0),
+            // the first of the file's neighbourhood.
+            const geometry::GeometrySite& corner = sites[(1 * 6 + 1) * 6 + 1];
+            CPPUNIT_ASSERT(corner.isFluid);
+            CPPUNIT_ASSERT(corner.IsCut(0));
+            CPPUNIT_ASSERT_EQUAL(geometry::GeometrySiteLink::INLET_INTERSECTION,
+                                 corner.GetLink(0).type);
+            CPPUNIT_ASSERT_EQUAL(0, corner.GetLink(0).ioletId);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, corner.GetLink(0).distanceToIntersection, 1e-6);
+            CPPUNIT_ASSERT(corner.wallNormalAvailable);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(-1.0, corner.wallNormal.y, 1e-6);
+          }
+
+        private:
+          hemelb::io::readers::GeometryFile* file;
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION(GeometryFileTests);
+    }
+  }
+}
+
+#endif // HEMELB_UNITTESTS_IO_GEOMETRYFILETESTS_H
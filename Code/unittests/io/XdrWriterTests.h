@@ -0,0 +1,81 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_IO_XDRWRITERTESTS_H
+#define HEMELB_UNITTESTS_IO_XDRWRITERTESTS_H
+
+#include <cstring>
+#include <vector>
+#include <cppunit/TestFixture.h>
+#include "io/writers/xdr/XdrMemWriter.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace io
+    {
+      using namespace hemelb::io::writers::xdr;
+
+      class XdrWriterTests : public CppUnit::TestFixture
+      {
+          CPPUNIT_TEST_SUITE(XdrWriterTests);
+          CPPUNIT_TEST(TestFloatArray);
+          CPPUNIT_TEST(TestDoubleArray);
+          CPPUNIT_TEST(TestUnsignedArrays);
+          CPPUNIT_TEST_SUITE_END();
+        public:
+          void TestFloatArray()
+          {
+            const float values[5] = { 1.5f, -2.25f, 0.f, 3.0e-20f, 7.0e30f };
+            CheckMatchesValueByValue(values, 5);
+          }
+
+          void TestDoubleArray()
+          {
+            const double values[3] = { 1.0 / 3.0, -2.5e100, 42. };
+            CheckMatchesValueByValue(values, 3);
+          }
+
+          void TestUnsignedArrays()
+          {
+            const uint32_t shorts[3] = { 0x01020304u, 0xffffffffu, 7u };
+            CheckMatchesValueByValue(shorts, 3);
+            const uint64_t longs[2] = { 0x0102030405060708ull, 9ull };
+            CheckMatchesValueByValue(longs, 2);
+          }
+
+        private:
+          /**
+           * Check that writing an array gives the same bytes as writing each value in turn,
+           * and advances the stream as far.
+           */
+          template<typename T>
+          void CheckMatchesValueByValue(const T* values, size_t count)
+          {
+            const unsigned length = sizeof(T) * count;
+            std::vector<char> bulk(length + 4, 0), each(length + 4, 0);
+            XdrMemWriter bulkWriter(&bulk[0], bulk.size());
+            XdrMemWriter eachWriter(&each[0], each.size());
+
+            bulkWriter.WriteArray(values, count);
+            for (size_t i = 0; i < count; ++i)
+            {
+              eachWriter << values[i];
+            }
+
+            CPPUNIT_ASSERT_EQUAL(eachWriter.getCurrentStreamPosition(),
+                                 bulkWriter.getCurrentStreamPosition());
+            CPPUNIT_ASSERT_EQUAL(length, bulkWriter.getCurrentStreamPosition());
+            CPPUNIT_ASSERT(std::memcmp(&bulk[0], &each[0], bulk.size()) == 0);
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION(XdrWriterTests);
+    }
+  }
+}
+
+#endif // HEMELB_UNITTESTS_IO_XDRWRITERTESTS_H
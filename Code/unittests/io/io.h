@@ -7,7 +7,11 @@
 #ifndef HEMELB_UNITTESTS_IO_IO_H
 #define HEMELB_UNITTESTS_IO_IO_H
 
+#include "unittests/io/BlockDecompressorTests.h"
+#include "unittests/io/ExtractionFileTests.h"
+#include "unittests/io/GeometryFileTests.h"
 #include "unittests/io/PathManagerTests.h"
+#include "unittests/io/XdrWriterTests.h"
 #include "unittests/io/xml.h"
 
 #endif //ONCE
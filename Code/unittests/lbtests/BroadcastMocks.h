@@ -35,7 +35,8 @@ namespace hemelb
     {
 
       public:
-        BroadcastMockRootNode(net::Net * net, const lb::SimulationState * simState, unsigned int spreadFactor);
+        BroadcastMockRootNode(net::Net * net, const lb::SimulationState * simState, unsigned int spreadFactor,
+                              unsigned long callPeriod = 1);
 
         virtual ~BroadcastMockRootNode();
 
@@ -67,8 +68,9 @@ namespace hemelb
 
     BroadcastMockRootNode::BroadcastMockRootNode(net::Net * net,
                                                  const lb::SimulationState * simState,
-                                                 unsigned int spreadFactor) :
-        net::PhasedBroadcastRegular<>(net, simState, spreadFactor), spreadFactor(spreadFactor), callCounter(0)
+                                                 unsigned int spreadFactor,
+                                                 unsigned long callPeriod) :
+        net::PhasedBroadcastRegular<>(net, simState, spreadFactor, callPeriod), spreadFactor(spreadFactor), callCounter(0)
     {
     }
 
@@ -159,7 +161,8 @@ namespace hemelb
     {
 
       public:
-        BroadcastMockLeafNode(net::Net * net, const lb::SimulationState * simState, unsigned int spreadFactor);
+        BroadcastMockLeafNode(net::Net * net, const lb::SimulationState * simState, unsigned int spreadFactor,
+                              unsigned long callPeriod = 1);
 
         virtual ~BroadcastMockLeafNode();
 
@@ -208,8 +211,9 @@ namespace hemelb
 
     BroadcastMockLeafNode::BroadcastMockLeafNode(net::Net * net,
                                                  const lb::SimulationState * simState,
-                                                 unsigned int spreadFactor) :
-        net::PhasedBroadcastRegular<>(net, simState, spreadFactor), /*spreadFactor(spreadFactor),*/ iterationCounter(0)
+                                                 unsigned int spreadFactor,
+                                                 unsigned long callPeriod) :
+        net::PhasedBroadcastRegular<>(net, simState, spreadFactor, callPeriod), /*spreadFactor(spreadFactor),*/ iterationCounter(0)
     {
     }
 
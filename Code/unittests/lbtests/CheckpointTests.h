@@ -0,0 +1,127 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_LBTESTS_CHECKPOINTTESTS_H
+#define HEMELB_UNITTESTS_LBTESTS_CHECKPOINTTESTS_H
+
+#include <cppunit/TestFixture.h>
+#include <fstream>
+#include "lb/Checkpoint.h"
+#include "unittests/helpers/FourCubeBasedTestFixture.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace lbtests
+    {
+      class CheckpointTests : public helpers::FourCubeBasedTestFixture
+      {
+          CPPUNIT_TEST_SUITE ( CheckpointTests);
+          CPPUNIT_TEST ( TestWriteAndRead);
+          CPPUNIT_TEST ( TestNonEquilibriumFloatEncoding);
+          CPPUNIT_TEST ( TestNotACheckpoint);CPPUNIT_TEST_SUITE_END();
+
+          typedef lb::lattices::D3Q15 Lattice;
+
+        public:
+          void TestWriteAndRead()
+          {
+            // Give each distribution a value particular to its site and direction.
+            for (site_t site = 0; site < numSites; ++site)
+            {
+              distribn_t fOld[Lattice::NUMVECTORS];
+              for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+              {
+                fOld[direction] = GetExpectedValue(site, direction);
+              }
+              latDat->SetFOld<Lattice>(site, fOld);
+            }
+
+            lb::Checkpoint checkpoint("checkpoint.dat", Comms());
+            checkpoint.Write(*latDat, 42);
+            checkpoint.Finish();
+
+            for (site_t site = 0; site < numSites; ++site)
+            {
+              distribn_t fOld[Lattice::NUMVECTORS] = { };
+              latDat->SetFOld<Lattice>(site, fOld);
+            }
+
+            CPPUNIT_ASSERT_EQUAL(LatticeTimeStep(42),
+                                 lb::Checkpoint::Read("checkpoint.dat", *latDat, Comms()));
+
+            // Both fOld and fNew are restored.
+            for (site_t site = 0; site < numSites; ++site)
+            {
+              for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+              {
+                CPPUNIT_ASSERT_EQUAL(GetExpectedValue(site, direction),
+                                     latDat->GetSite(site).GetFOld<Lattice>(direction));
+                CPPUNIT_ASSERT_EQUAL(GetExpectedValue(site, direction),
+                                     distribn_t(*latDat->GetFNew(latDat->GetDistributionIndex(site, direction))));
+              }
+            }
+          }
+
+          void TestNonEquilibriumFloatEncoding()
+          {
+            // Distributions near equilibrium, as in a real flow.
+            std::vector<distribn_t> expected(numSites * Lattice::NUMVECTORS);
+            for (site_t site = 0; site < numSites; ++site)
+            {
+              distribn_t* fOld = &expected[site * Lattice::NUMVECTORS];
+              Lattice::CalculateFeq(1.0 + 0.001 * site, 0.01, -0.002 * site, 0.003, fOld);
+              for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+              {
+                fOld[direction] += 1e-4 * (direction % 3) - 1e-5 * site;
+              }
+              latDat->SetFOld<Lattice>(site, fOld);
+            }
+
+            lb::Checkpoint checkpoint("checkpoint.dat",
+                                      Comms(),
+                                      io::formats::checkpoint::NonEquilibriumFloatEncoding);
+            checkpoint.Write(*latDat, 7);
+            checkpoint.Finish();
+
+            CPPUNIT_ASSERT_EQUAL(LatticeTimeStep(7),
+                                 lb::Checkpoint::Read("checkpoint.dat", *latDat, Comms()));
+
+            // Only the small non-equilibrium part loses precision.
+            for (site_t site = 0; site < numSites; ++site)
+            {
+              for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+              {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[site * Lattice::NUMVECTORS + direction],
+                                             latDat->GetSite(site).GetFOld<Lattice>(direction),
+                                             1e-10);
+              }
+            }
+          }
+
+          void TestNotACheckpoint()
+          {
+            std::ofstream notACheckpoint("not_a_checkpoint.dat");
+            notACheckpoint << "This is not a checkpoint, but it is long enough to have a preamble.";
+            notACheckpoint.close();
+
+            CPPUNIT_ASSERT_THROW(lb::Checkpoint::Read("not_a_checkpoint.dat", *latDat, Comms()),
+                                 Exception);
+          }
+
+        private:
+          distribn_t GetExpectedValue(site_t site, Direction direction)
+          {
+            return 100.0 * site + direction + 0.25;
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION ( CheckpointTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_LBTESTS_CHECKPOINTTESTS_H */
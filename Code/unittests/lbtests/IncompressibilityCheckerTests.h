@@ -36,8 +36,7 @@ namespace hemelb
             LbTestsHelper::InitialiseAnisotropicTestData<lb::lattices::D3Q15>(latDat);
             cache = new lb::MacroscopicPropertyCache(*simState, *latDat);
 
-            cache->densityCache.SetRefreshFlag();
-            cache->velocityCache.SetRefreshFlag();
+            cache->SetDensityExtremesRequired();
             lbtests::LbTestsHelper::UpdatePropertyCache<lb::lattices::D3Q15>(*latDat, *cache, *simState);
 
             // These are the smallest and largest density values in FourCubeLatticeData by default
@@ -63,7 +62,7 @@ namespace hemelb
 
           void AdvanceActorOneTimeStep(net::IteratedAction& actor)
           {
-            cache->densityCache.SetRefreshFlag();
+            cache->SetDensityExtremesRequired();
             LbTestsHelper::UpdatePropertyCache<lb::lattices::D3Q15>(*latDat, *cache, *simState);
 
             actor.RequestComms();
@@ -36,10 +36,18 @@ namespace hemelb
           CPPUNIT_TEST_SUITE ( KernelTests);
           CPPUNIT_TEST ( TestAnsumaliEntropicCalculationsAndCollision);
           CPPUNIT_TEST ( TestChikatamarlaEntropicCalculationsAndCollision);
+          CPPUNIT_TEST ( TestEntropicNearEquilibriumCollision);
+          CPPUNIT_TEST ( TestEntropicWarmStartAgreesWithBrent);
+          CPPUNIT_TEST ( TestEntropicBelowThresholdAgreesWithBrent);
+          CPPUNIT_TEST ( TestHFunctionDerivative);
           CPPUNIT_TEST ( TestLBGKCalculationsAndCollision);
           CPPUNIT_TEST ( TestLBGKNNCalculationsAndCollision);
+          CPPUNIT_TEST ( TestTRTCollision);
+          CPPUNIT_TEST ( TestRegularisedCollision);
+          CPPUNIT_TEST ( TestRegularisedEqualsLBGKOnHermiteFNeq);
           CPPUNIT_TEST ( TestMRTConstantRelaxationTimeEqualsLBGK);
-          CPPUNIT_TEST ( TestD3Q19MRTConstantRelaxationTimeEqualsLBGK);CPPUNIT_TEST_SUITE_END();
+          CPPUNIT_TEST ( TestD3Q19MRTConstantRelaxationTimeEqualsLBGK);
+          CPPUNIT_TEST ( TestD3Q19MRTCollisionInMomentSpace);CPPUNIT_TEST_SUITE_END();
         public:
           void setUp()
           {
@@ -158,6 +166,183 @@ namespace hemelb
             }
           }
 
+          void TestEntropicNearEquilibriumCollision()
+          {
+            typedef lb::lattices::D3Q15 Lattice;
+            lb::kernels::EntropicAnsumali<Lattice> entropic(initParams);
+
+            // Perturb an equilibrium by a part in a thousand, so alpha is found by the warm-started
+            // Newton-Raphson or Brent rather than the far-from-equilibrium branch.
+            distribn_t f_original[Lattice::NUMVECTORS];
+            Lattice::CalculateEntropicFeqAnsumali(1.0, 0.01, 0.02, 0.03, f_original);
+            for (unsigned int ii = 0; ii < Lattice::NUMVECTORS; ++ii)
+            {
+              f_original[ii] *= 1.0 + 1e-3 * ((int) (ii % 3) - 1);
+            }
+
+            // The second collision starts from the alpha the first one found.
+            for (unsigned int collision = 0; collision < 2; ++collision)
+            {
+              lb::kernels::HydroVars<lb::kernels::EntropicAnsumali<Lattice> > hydroVars(f_original);
+              entropic.CalculateDensityMomentumFeq(hydroVars, 0);
+              entropic.DoCollide(lbmParams, hydroVars);
+
+              distribn_t expectedPostCollision[Lattice::NUMVECTORS];
+              LbTestsHelper::CalculateEntropicCollision<Lattice>(f_original,
+                                                                 hydroVars.GetFEq().f,
+                                                                 lbmParams->GetTau(),
+                                                                 lbmParams->GetBeta(),
+                                                                 expectedPostCollision);
+
+              for (unsigned int ii = 0; ii < Lattice::NUMVECTORS; ++ii)
+              {
+                std::stringstream message;
+                message << "Near equilibrium post-collision " << ii << ", collision " << collision;
+                CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(message.str(),
+                                                     expectedPostCollision[ii],
+                                                     hydroVars.GetFPostCollision()[ii],
+                                                     1e-10);
+              }
+            }
+          }
+
+          void TestEntropicWarmStartAgreesWithBrent()
+          {
+            typedef lb::lattices::D3Q15 Lattice;
+            const distribn_t tau = lbmParams->GetTau();
+
+            // Near equilibrium the kernel tries a few Newton-Raphson steps from the site's previous
+            // alpha before bracketing the root for Brent; both must find the same root. Each site is
+            // collided a step earlier, a little further from equilibrium, to give it that alpha.
+            const distribn_t perturbations[] = { 1e-3, 3e-4, 1e-4 };
+            for (unsigned int perturbation = 0; perturbation < 3; ++perturbation)
+            {
+              lb::kernels::EntropicAnsumali<Lattice> entropic(initParams);
+              distribn_t f_previous[Lattice::NUMVECTORS];
+              InitialisePerturbedEquilibrium<Lattice>(1.1 * perturbations[perturbation], f_previous);
+              lb::kernels::HydroVars<lb::kernels::EntropicAnsumali<Lattice> > previousHydroVars(f_previous);
+              entropic.CalculateDensityMomentumFeq(previousHydroVars, 0);
+              lb::HFunction<Lattice> previousHFunc(f_previous, previousHydroVars.GetFEq().f);
+              const double previousAlpha = util::NumericalMethods::NewtonRaphson(&previousHFunc,
+                                                                                 2.0,
+                                                                                 1.0E-6);
+              entropic.DoCollide(lbmParams, previousHydroVars);
+
+              distribn_t f_original[Lattice::NUMVECTORS];
+              InitialisePerturbedEquilibrium<Lattice>(perturbations[perturbation], f_original);
+              lb::kernels::HydroVars<lb::kernels::EntropicAnsumali<Lattice> > hydroVars(f_original);
+              entropic.CalculateDensityMomentumFeq(hydroVars, 0);
+              lb::HFunction<Lattice> HFunc(f_original, hydroVars.GetFEq().f);
+
+              // So close to equilibrium H is tiny about the root, so the kernel's tolerance in H would
+              // stop Brent well short of 1e-6 in alpha; bracket it down to that instead.
+              double brentAlpha;
+              CPPUNIT_ASSERT(CalculateBrentAlpha<Lattice>(f_original,
+                                                          hydroVars.GetFEq().f,
+                                                          tau,
+                                                          brentAlpha,
+                                                          0.0));
+
+              std::stringstream message;
+              message << "Perturbation " << perturbations[perturbation];
+
+              double warmStartedAlpha;
+              CPPUNIT_ASSERT_MESSAGE(message.str(),
+                                     util::NumericalMethods::NewtonRaphson(&HFunc,
+                                                                           previousAlpha,
+                                                                           1.0E-6,
+                                                                           4,
+                                                                           warmStartedAlpha));
+              CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(message.str(), brentAlpha, warmStartedAlpha, 1e-6);
+
+              // And the kernel's collision is the one Brent's alpha gives, to within what the 1e-6
+              // accuracy in alpha makes of f_neq.
+              entropic.DoCollide(lbmParams, hydroVars);
+              for (unsigned int ii = 0; ii < Lattice::NUMVECTORS; ++ii)
+              {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(message.str(),
+                                                     f_original[ii]
+                                                         + brentAlpha * lbmParams->GetBeta()
+                                                             * (f_original[ii] - hydroVars.GetFEq()[ii]),
+                                                     hydroVars.GetFPostCollision()[ii],
+                                                     1e-9);
+              }
+            }
+          }
+
+          void TestEntropicBelowThresholdAgreesWithBrent()
+          {
+            typedef lb::lattices::D3Q15 Lattice;
+            const distribn_t tau = lbmParams->GetTau();
+
+            // Below a deviation of 1e-6 the kernel takes alpha to be 2 without a root search. H is
+            // then round off all along the bracket, so Brent stopped wherever it first found it small
+            // (or found no root, when alpha was 2 anyway): the two collisions need only agree to
+            // within the deviation the threshold allows, a part in a million of f.
+            const distribn_t perturbations[] = { 5e-7, 1e-8, 0.0 };
+            for (unsigned int perturbation = 0; perturbation < 3; ++perturbation)
+            {
+              lb::kernels::EntropicAnsumali<Lattice> entropic(initParams);
+              distribn_t f_original[Lattice::NUMVECTORS];
+              InitialisePerturbedEquilibrium<Lattice>(perturbations[perturbation], f_original);
+
+              lb::kernels::HydroVars<lb::kernels::EntropicAnsumali<Lattice> > hydroVars(f_original);
+              entropic.CalculateDensityMomentumFeq(hydroVars, 0);
+
+              double brentAlpha;
+              if (!CalculateBrentAlpha<Lattice>(f_original, hydroVars.GetFEq().f, tau, brentAlpha))
+              {
+                brentAlpha = 2.0;
+              }
+
+              entropic.DoCollide(lbmParams, hydroVars);
+              for (unsigned int ii = 0; ii < Lattice::NUMVECTORS; ++ii)
+              {
+                const distribn_t fNeq = f_original[ii] - hydroVars.GetFEq()[ii];
+                std::stringstream message;
+                message << "Perturbation " << perturbations[perturbation] << ", post-collision " << ii;
+                CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(message.str(),
+                                                     f_original[ii] + 2.0 * lbmParams->GetBeta() * fNeq,
+                                                     hydroVars.GetFPostCollision()[ii],
+                                                     1e-15);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(message.str(),
+                                                     f_original[ii] + brentAlpha * lbmParams->GetBeta() * fNeq,
+                                                     hydroVars.GetFPostCollision()[ii],
+                                                     1e-6 * f_original[ii]);
+              }
+            }
+          }
+
+          void TestHFunctionDerivative()
+          {
+            typedef lb::lattices::D3Q15 Lattice;
+            distribn_t f[Lattice::NUMVECTORS];
+            distribn_t f_eq[Lattice::NUMVECTORS];
+            LbTestsHelper::InitialiseAnisotropicTestData<Lattice>(0, f);
+            Lattice::CalculateEntropicFeqAnsumali(12.0, 0.4, 0.5, 0.6, f_eq);
+
+            lb::HFunction<Lattice> HFunc(f, f_eq);
+
+            // At alpha = 0, f_alpha is f, so the difference in H is nothing.
+            double H, dH;
+            HFunc(0.0, H);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, H, 1e-12);
+
+            distribn_t expectedH = 0.0;
+            for (unsigned int ii = 0; ii < Lattice::NUMVECTORS; ++ii)
+            {
+              expectedH += f[ii] * std::log(f[ii] / Lattice::EQMWEIGHTS[ii]);
+            }
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(expectedH, HFunc.eval(), 1e-10);
+
+            const double alpha = 1.3, step = 1e-6;
+            double HBelow, HAbove;
+            HFunc(alpha - step, HBelow);
+            HFunc(alpha + step, HAbove);
+            HFunc(alpha, H, dH);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL( (HAbove - HBelow) / (2.0 * step), dH, 1e-6);
+          }
+
           void TestChikatamarlaEntropicCalculationsAndCollision()
           {
             lb::kernels::EntropicChik<lb::lattices::D3Q15> kernel(initParams);
@@ -566,6 +751,93 @@ namespace hemelb
             }
           }
 
+          void TestTRTCollision()
+          {
+            typedef lb::lattices::D3Q19 Lattice;
+            lb::kernels::TRT<Lattice> trt(initParams);
+
+            distribn_t f_original[Lattice::NUMVECTORS];
+            LbTestsHelper::InitialiseAnisotropicTestData<Lattice>(0, f_original);
+            lb::kernels::HydroVars<lb::kernels::TRT<Lattice> > hydroVars(f_original);
+            trt.CalculateDensityMomentumFeq(hydroVars, 0);
+            trt.DoCollide(lbmParams, hydroVars);
+
+            // Relax the parts of f_neq symmetric and antisymmetric under swapping each direction
+            // with its opposite, as looked up, at their own rates.
+            const distribn_t tauMinus = 0.5 + (3.0 / 16.0) / (lbmParams->GetTau() - 0.5);
+            for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+            {
+              const distribn_t fNeq = hydroVars.GetFNeq().f[direction];
+              const distribn_t fNeqBar = hydroVars.GetFNeq().f[Lattice::INVERSEDIRECTIONS[direction]];
+              const distribn_t expected = f_original[direction]
+                  + 0.5 * lbmParams->GetOmega() * (fNeq + fNeqBar) - 0.5 / tauMinus * (fNeq - fNeqBar);
+
+              std::stringstream message;
+              message << "Post-collision " << direction;
+              CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(message.str(),
+                                                   expected,
+                                                   hydroVars.GetFPostCollision()[direction],
+                                                   1e-10);
+            }
+          }
+
+          void TestRegularisedCollision()
+          {
+            CheckRegularisedCollision<false>("Regularised");
+            CheckRegularisedCollision<true>("RecursiveRegularised");
+          }
+
+          void TestRegularisedEqualsLBGKOnHermiteFNeq()
+          {
+            typedef lb::lattices::D3Q15 Lattice;
+            lb::kernels::Regularised<Lattice> regularised(initParams);
+
+            // A distribution whose f_neq is already the projection of a second moment onto the
+            // second-order Hermite polynomials, which regularising leaves alone.
+            const distribn_t velocity[3] = { 0.01, -0.02, 0.015 };
+            distribn_t f_original[Lattice::NUMVECTORS];
+            LbTestsHelper::CalculateLBGKEqmF<Lattice>(1.1,
+                                                      1.1 * velocity[0],
+                                                      1.1 * velocity[1],
+                                                      1.1 * velocity[2],
+                                                      f_original);
+            const distribn_t pi[3][3] = { { 1e-3, 2e-4, -3e-4 }, { 2e-4, -5e-4, 1e-4 }, { -3e-4,
+                1e-4, 2e-4 } };
+            for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+            {
+              const int c[3] = { Lattice::CX[direction], Lattice::CY[direction], Lattice::CZ[direction] };
+              distribn_t projection = 0.0;
+              for (int ii = 0; ii < 3; ++ii)
+              {
+                projection -= pi[ii][ii] / 3.0;
+                for (int jj = 0; jj < 3; ++jj)
+                {
+                  projection += c[ii] * c[jj] * pi[ii][jj];
+                }
+              }
+              f_original[direction] += 4.5 * Lattice::EQMWEIGHTS[direction] * projection;
+            }
+
+            lb::kernels::HydroVars<lb::kernels::Regularised<Lattice> > hydroVars(f_original);
+            regularised.CalculateDensityMomentumFeq(hydroVars, 0);
+            regularised.DoCollide(lbmParams, hydroVars);
+
+            distribn_t expectedPostCollision[Lattice::NUMVECTORS];
+            LbTestsHelper::CalculateLBGKCollision<Lattice>(f_original,
+                                                           hydroVars.GetFEq().f,
+                                                           lbmParams->GetOmega(),
+                                                           expectedPostCollision);
+            for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+            {
+              std::stringstream message;
+              message << "Post-collision " << direction;
+              CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(message.str(),
+                                                   expectedPostCollision[direction],
+                                                   hydroVars.GetFPostCollision()[direction],
+                                                   1e-10);
+            }
+          }
+
           void TestMRTConstantRelaxationTimeEqualsLBGK()
           {
             lb::kernels::MRT<lb::kernels::momentBasis::DHumieresD3Q15MRTBasis> mrtLbgkEquivalentKernel(initParams);
@@ -699,6 +971,161 @@ namespace hemelb
                                                    allowedError);
             }
           }
+
+          void TestD3Q19MRTCollisionInMomentSpace()
+          {
+            typedef lb::kernels::momentBasis::DHumieresD3Q19MRTBasis Basis;
+            typedef lb::lattices::D3Q19 Lattice;
+            // With d'Humieres' relaxation rates, which differ between the modes.
+            lb::kernels::MRT<Basis> mrtKernel(initParams);
+
+            distribn_t f_original[Lattice::NUMVECTORS];
+            LbTestsHelper::InitialiseAnisotropicTestData<Lattice>(0, f_original);
+            lb::kernels::HydroVars<lb::kernels::MRT<Basis> > hydroVars(f_original);
+            mrtKernel.CalculateDensityMomentumFeq(hydroVars, 0);
+            mrtKernel.DoCollide(lbmParams, hydroVars);
+
+            // Relax each moment of f_neq by its own rate and project back.
+            std::vector<distribn_t> collisionMatrix;
+            Basis::SetUpCollisionMatrix(collisionMatrix, lbmParams->GetTau());
+            distribn_t m_neq[Basis::NUM_KINETIC_MOMENTS];
+            Basis::ProjectVelsIntoMomentSpace(hydroVars.GetFNeq().f, m_neq);
+
+            for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+            {
+              distribn_t collision = 0.;
+              for (unsigned momentIndex = 0; momentIndex < Basis::NUM_KINETIC_MOMENTS; momentIndex++)
+              {
+                collision += collisionMatrix[momentIndex] * Basis::REDUCED_MOMENT_BASIS[momentIndex][direction]
+                    / Basis::BASIS_TIMES_BASIS_TRANSPOSED[momentIndex] * m_neq[momentIndex];
+              }
+
+              std::stringstream message;
+              message << "Post-collision " << direction;
+              CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(message.str(),
+                                                   f_original[direction] - collision,
+                                                   hydroVars.GetFPostCollision()[direction],
+                                                   1e-10);
+            }
+          }
+
+        private:
+          /**
+           * Set f to the equilibrium at rest with each direction scaled by 1, 1 + perturbation or
+           * 1 - perturbation. At rest the Ansumali equilibrium is the exact minimum of H, so the root
+           * for alpha is 2 to within the perturbation, however small.
+           */
+          template<typename Lattice>
+          static void InitialisePerturbedEquilibrium(distribn_t perturbation,
+                                                     distribn_t f[Lattice::NUMVECTORS])
+          {
+            Lattice::CalculateEntropicFeqAnsumali(1.0, 0.0, 0.0, 0.0, f);
+            for (unsigned int ii = 0; ii < Lattice::NUMVECTORS; ++ii)
+            {
+              f[ii] *= 1.0 + perturbation * ((int) (ii % 3) - 1);
+            }
+          }
+
+          /**
+           * Find alpha as the entropic kernel did before it warm started or skipped the root search
+           * near equilibrium: by Brent's method over [2 tau, 2 tau / deviation]. Returns false if
+           * that bracket doesn't enclose a root. Brent stops once alpha is within 1e-6 or H within
+           * HAccuracy of the root.
+           */
+          template<typename Lattice>
+          static bool CalculateBrentAlpha(const distribn_t f[Lattice::NUMVECTORS],
+                                          const distribn_t f_eq[Lattice::NUMVECTORS],
+                                          distribn_t tau,
+                                          double& alpha,
+                                          double HAccuracy = 1.0E-12)
+          {
+            double deviation = 0.0;
+            for (unsigned int ii = 0; ii < Lattice::NUMVECTORS; ++ii)
+            {
+              deviation = std::max(std::fabs( (f_eq[ii] - f[ii]) / f[ii]), deviation);
+            }
+            if (deviation == 0.0)
+            {
+              return false;
+            }
+
+            lb::HFunction<Lattice> HFunc(f, f_eq);
+            double alphaLower = 2.0 * tau, HLower;
+            double alphaHigher = 2.0 * tau / deviation, HHigher;
+            HFunc(alphaLower, HLower);
+            HFunc(alphaHigher, HHigher);
+            if (HLower * HHigher >= 0.0)
+            {
+              return false;
+            }
+
+            alpha = util::NumericalMethods::Brent(&HFunc,
+                                                  alphaLower,
+                                                  HLower,
+                                                  alphaHigher,
+                                                  HHigher,
+                                                  1.0E-6,
+                                                  HAccuracy);
+            return true;
+          }
+
+          /**
+           * Check that a regularised collision keeps the density and momentum, relaxes the second
+           * moment of f_neq as LBGK does, and reports that moment for the stress properties.
+           */
+          template<bool tThirdOrder>
+          void CheckRegularisedCollision(const std::string& name)
+          {
+            typedef lb::lattices::D3Q19 Lattice;
+            typedef lb::kernels::Regularised<Lattice, tThirdOrder> Kernel;
+            Kernel regularised(initParams);
+
+            distribn_t f_original[Lattice::NUMVECTORS];
+            LbTestsHelper::InitialiseAnisotropicTestData<Lattice>(0, f_original);
+            lb::kernels::HydroVars<Kernel> hydroVars(f_original);
+            regularised.CalculateDensityMomentumFeq(hydroVars, 0);
+
+            lb::lattices::SecondMoment moment;
+            CPPUNIT_ASSERT_MESSAGE(name + ", moment before collision",
+                                   !hydroVars.GetKnownFNeqMoment(moment));
+            regularised.DoCollide(lbmParams, hydroVars);
+
+            distribn_t density, momentum[3];
+            LbTestsHelper::CalculateRhoMomentum<Lattice>(hydroVars.GetFPostCollision().f,
+                                                         density,
+                                                         momentum);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(name + ", density", hydroVars.density, density, 1e-10);
+            for (int ii = 0; ii < 3; ++ii)
+            {
+              CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(name + ", momentum",
+                                                   hydroVars.momentum[ii],
+                                                   momentum[ii],
+                                                   1e-10);
+            }
+
+            const lb::lattices::SecondMoment expected =
+                Lattice::CalculateSecondMoment(hydroVars.GetFNeq().f);
+            CPPUNIT_ASSERT_MESSAGE(name + ", moment after collision",
+                                   hydroVars.GetKnownFNeqMoment(moment));
+            CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(name + ", moment xx", expected.xx, moment.xx, 1e-10);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(name + ", moment yz", expected.yz, moment.yz, 1e-10);
+
+            distribn_t fNeqPostCollision[Lattice::NUMVECTORS];
+            for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+            {
+              fNeqPostCollision[direction] = hydroVars.GetFPostCollision()[direction]
+                  - hydroVars.GetFEq()[direction];
+            }
+            const lb::lattices::SecondMoment relaxed =
+                Lattice::CalculateSecondMoment(fNeqPostCollision);
+            const distribn_t factor = 1.0 + lbmParams->GetOmega();
+            CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(name + ", relaxed xx", factor * expected.xx, relaxed.xx, 1e-10);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(name + ", relaxed yy", factor * expected.yy, relaxed.yy, 1e-10);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(name + ", relaxed zz", factor * expected.zz, relaxed.zz, 1e-10);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(name + ", relaxed xy", factor * expected.xy, relaxed.xy, 1e-10);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(name + ", relaxed xz", factor * expected.xz, relaxed.xz, 1e-10);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(name + ", relaxed yz", factor * expected.yz, relaxed.yz, 1e-10);
+          }
       };
       CPPUNIT_TEST_SUITE_REGISTRATION ( KernelTests);
     }
@@ -263,7 +263,6 @@ namespace hemelb
              * * CalculateVonMisesStress (probably needs a manually calculated test)
              * * CalculateShearStress (as above)
              * * CalculatePiTensor(as above)
-             * * CalculateShearRate (as above)
              *
              */
 
@@ -299,6 +298,37 @@ namespace hemelb
 
             }
 
+            /*
+             inline static distribn_t CalculateShearRate(const distribn_t &iTau,
+             const distribn_t iFNeq[],
+             const distribn_t &iDensity)
+             */
+            {
+              // Against sqrt(2 S:S), with the strain rate tensor S worked out from the full Pi tensor.
+              std::vector<distribn_t> nonEquilibriumF(LatticeType::NUMVECTORS);
+              for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+              {
+                nonEquilibriumF[direction] = 0.01 * ((int) (direction % 5) - 2) + 0.001 * direction;
+              }
+              LatticeDensity density = 1.1;
+              distribn_t tau = 0.75;
+
+              util::Matrix3D pi = LatticeType::CalculatePiTensor(nonEquilibriumF.data());
+              double strainRateSquared = 0.0;
+              for (unsigned rowIndex = 0; rowIndex < 3; ++rowIndex)
+              {
+                for (unsigned columnIndex = 0; columnIndex < 3; ++columnIndex)
+                {
+                  const double strainRate = -pi[rowIndex][columnIndex] / (2.0 * tau * density * Cs2);
+                  strainRateSquared += strainRate * strainRate;
+                }
+              }
+
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(sqrt(2.0 * strainRateSquared),
+                                           LatticeType::CalculateShearRate(tau, nonEquilibriumF.data(), density),
+                                           1e-12);
+            }
+
             /*
              inline static void CalculateStressTensor(const distribn_t density,
              const distribn_t tau,
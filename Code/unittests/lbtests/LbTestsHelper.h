@@ -213,11 +213,11 @@ namespace hemelb
           {
             for (site_t site = 0; site < latDat.GetLocalFluidSiteCount(); ++site)
             {
-              distribn_t density, feq[Lattice::NUMVECTORS];
+              distribn_t density, feq[Lattice::NUMVECTORS], fOld[Lattice::NUMVECTORS];
               util::Vector3D<distribn_t> momentum;
               util::Vector3D<distribn_t> velocity;
 
-              Lattice::CalculateDensityMomentumFEq(latDat.GetSite(site).GetFOld<Lattice> (),
+              Lattice::CalculateDensityMomentumFEq(latDat.GetSite(site).GetFOld<Lattice> (fOld),
                                                    density,
                                                    momentum[0],
                                                    momentum[1],
@@ -235,6 +235,10 @@ namespace hemelb
               {
                 cache.velocityCache.Put(site, velocity);
               }
+              if (cache.DensityExtremesRequired())
+              {
+                cache.NoteDensityAndVelocity(density, velocity);
+              }
 
               // TODO stress cache filling not yet implemented.
             }
@@ -0,0 +1,133 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_LBTESTS_STEADYSTATEACCELERATORTESTS_H
+#define HEMELB_UNITTESTS_LBTESTS_STEADYSTATEACCELERATORTESTS_H
+
+#include <cppunit/TestFixture.h>
+#include "lb/SteadyStateAccelerator.h"
+#include "unittests/helpers/FourCubeBasedTestFixture.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace lbtests
+    {
+      class SteadyStateAcceleratorTests : public helpers::FourCubeBasedTestFixture
+      {
+          CPPUNIT_TEST_SUITE (SteadyStateAcceleratorTests);
+          CPPUNIT_TEST (TestGivenFactor);
+          CPPUNIT_TEST (TestAdaptiveFactor);
+          CPPUNIT_TEST (TestOnlyEveryPeriod);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void setUp()
+          {
+            helpers::FourCubeBasedTestFixture::setUp();
+            timings = new hemelb::reporting::Timers(Comms());
+          }
+
+          void tearDown()
+          {
+            delete timings;
+            helpers::FourCubeBasedTestFixture::tearDown();
+          }
+
+          void TestGivenFactor()
+          {
+            lb::SteadyStateAccelerator accelerator(*latDat, *simState, Comms(), *timings, 1, 0.5);
+
+            // The first time only takes the snapshot.
+            SetDistributions(1.0);
+            accelerator.PostReceive();
+            AssertDistributions(1.0);
+
+            simState->Increment();
+            SetDistributions(1.1);
+            accelerator.PostReceive();
+            AssertDistributions(1.15);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, accelerator.GetLastFactor(), 1e-12);
+
+            // From the extrapolated distributions.
+            simState->Increment();
+            SetDistributions(1.25);
+            accelerator.PostReceive();
+            AssertDistributions(1.3);
+          }
+
+          void TestAdaptiveFactor()
+          {
+            lb::SteadyStateAccelerator accelerator(*latDat, *simState, Comms(), *timings, 1, 0.0);
+
+            SetDistributions(1.0);
+            accelerator.PostReceive();
+
+            // There's no previous change to compare with yet.
+            simState->Increment();
+            SetDistributions(1.1);
+            accelerator.PostReceive();
+            AssertDistributions(1.1);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, accelerator.GetLastFactor(), 1e-12);
+
+            // The change has halved, so the rest of the series 1, 1.1, 1.15, 1.175... is skipped.
+            simState->Increment();
+            SetDistributions(1.15);
+            accelerator.PostReceive();
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, accelerator.GetLastFactor(), 1e-6);
+            AssertDistributions(1.2);
+
+            // Nothing is extrapolated while the change grows.
+            simState->Increment();
+            SetDistributions(1.3);
+            accelerator.PostReceive();
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, accelerator.GetLastFactor(), 1e-12);
+            AssertDistributions(1.3);
+          }
+
+          void TestOnlyEveryPeriod()
+          {
+            lb::SteadyStateAccelerator accelerator(*latDat, *simState, Comms(), *timings, 2, 1.0);
+
+            for (unsigned step = 0; step < 4; ++step)
+            {
+              SetDistributions(1.0 + 0.1 * simState->GetTimeStep());
+              accelerator.PostReceive();
+              simState->Increment();
+            }
+
+            // Extrapolated on the 4th step only, from the 2nd.
+            AssertDistributions(1.6);
+          }
+
+        private:
+          void SetDistributions(distribn_t value)
+          {
+            const site_t count = numSites * latDat->GetLatticeInfo().GetNumVectors();
+            for (site_t index = 0; index < count; ++index)
+            {
+              *latDat->GetFNew(index) = value;
+            }
+          }
+
+          void AssertDistributions(distribn_t expected)
+          {
+            const site_t count = numSites * latDat->GetLatticeInfo().GetNumVectors();
+            for (site_t index = 0; index < count; ++index)
+            {
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, distribn_t(*latDat->GetFNew(index)), 1e-6);
+            }
+          }
+
+          hemelb::reporting::Timers* timings;
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (SteadyStateAcceleratorTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_LBTESTS_STEADYSTATEACCELERATORTESTS_H */
@@ -8,7 +8,10 @@
 #define HEMELB_UNITTESTS_LBTESTS_STREAMERTESTS_H
 
 #include <cppunit/TestFixture.h>
+#include <algorithm>
+#include <cfloat>
 #include <iostream>
+#include <limits>
 #include <sstream>
 
 #include "lb/streamers/Streamers.h"
@@ -34,13 +37,27 @@ namespace hemelb
       class StreamerTests : public helpers::FourCubeBasedTestFixture
       {
           CPPUNIT_TEST_SUITE ( StreamerTests);
+          CPPUNIT_TEST ( TestSiteBatchedCollideAndStream);
+          CPPUNIT_TEST ( TestRestrictedPropertyCache);
+          CPPUNIT_TEST ( TestCachesOnlyUpdatedWhenAsked);
+          CPPUNIT_TEST ( TestRelativeChangeNoted);
+#ifdef HEMELB_USE_PULL_STREAMING
+          CPPUNIT_TEST ( TestPullSameAsPush);
+          CPPUNIT_TEST ( TestPullSameAsPushWithBounceBack);
+#else
+          // These expect the distributions to be pushed to their neighbours, and the curved
+          // wall and Junk&Yang streamers can't pull.
           CPPUNIT_TEST ( TestSimpleCollideAndStream);
+          CPPUNIT_TEST ( TestNonPositiveDistributionNoted);
+          CPPUNIT_TEST ( TestDensityExtremes);
           CPPUNIT_TEST ( TestBouzidiFirdaousLallemand);
           CPPUNIT_TEST ( TestSimpleBounceBack);
           CPPUNIT_TEST ( TestGuoZhengShi);
           CPPUNIT_TEST ( TestNashZerothOrderPressureIolet);
           CPPUNIT_TEST ( TestNashZerothOrderPressureBB);
-          CPPUNIT_TEST ( TestJunkYangEquivalentToBounceBack);CPPUNIT_TEST_SUITE_END();
+          CPPUNIT_TEST ( TestJunkYangEquivalentToBounceBack);
+#endif
+          CPPUNIT_TEST_SUITE_END();
         public:
 
           void setUp()
@@ -60,6 +77,7 @@ namespace hemelb
             FourCubeBasedTestFixture::tearDown();
           }
 
+#ifndef HEMELB_USE_PULL_STREAMING
           void TestSimpleCollideAndStream()
           {
             lb::streamers::SimpleCollideAndStream<lb::collisions::Normal<lb::kernels::LBGK<
@@ -83,7 +101,7 @@ namespace hemelb
               geometry::Site < geometry::LatticeData > streamedSite
                   = latDat->GetSite(streamedToSite);
 
-              distribn_t* streamedToFNew = latDat->GetFNew(lb::lattices::D3Q15::NUMVECTORS
+              stored_distribn_t* streamedToFNew = latDat->GetFNew(lb::lattices::D3Q15::NUMVECTORS
                   * streamedToSite);
 
               for (unsigned int streamedDirection = 0; streamedDirection
@@ -122,6 +140,288 @@ namespace hemelb
               }
             }
           }
+#endif
+
+          void TestRestrictedPropertyCache()
+          {
+            typedef lb::lattices::D3Q15 Lattice;
+            typedef lb::collisions::Normal<lb::kernels::LBGK<Lattice> > Collision;
+            lb::streamers::SimpleCollideAndStream<Collision> simpleCollideAndStream(initParams);
+            const site_t siteCount = latDat->GetLocalFluidSiteCount();
+
+            LbTestsHelper::InitialiseAnisotropicTestData<Lattice>(latDat);
+            propertyCache->densityCache.SetRefreshFlag();
+            simpleCollideAndStream.StreamAndCollide<true> (0, siteCount, lbmParams, latDat, *propertyCache);
+            std::vector<distribn_t> expectedDensity;
+            for (site_t site = 0; site < siteCount; ++site)
+            {
+              expectedDensity.push_back(propertyCache->densityCache.Get(site));
+            }
+
+            // Only cache a couple of sites; they should get the same values as before.
+            std::vector<site_t> cachedSites;
+            cachedSites.push_back(3);
+            cachedSites.push_back(siteCount - 1);
+            propertyCache->RestrictToSites(cachedSites);
+            CPPUNIT_ASSERT(propertyCache->IsSiteCached(3));
+            CPPUNIT_ASSERT(!propertyCache->IsSiteCached(4));
+
+            propertyCache->densityCache.SetRefreshFlag();
+            simpleCollideAndStream.StreamAndCollide<true> (0, siteCount, lbmParams, latDat, *propertyCache);
+            for (unsigned index = 0; index < cachedSites.size(); ++index)
+            {
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(expectedDensity[cachedSites[index]],
+                                           propertyCache->densityCache.Get(cachedSites[index]),
+                                           allowedError);
+            }
+            // A site that isn't cached gives the default, not whatever is before the cache.
+            CPPUNIT_ASSERT_EQUAL(distribn_t(0.0), propertyCache->densityCache.Get(4));
+
+            // Lifting the restriction should cache every site again.
+            propertyCache->SetSiteRestrictionEnabled(false);
+            CPPUNIT_ASSERT(propertyCache->IsSiteCached(4));
+            simpleCollideAndStream.StreamAndCollide<true> (0, siteCount, lbmParams, latDat, *propertyCache);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(expectedDensity[4], propertyCache->densityCache.Get(4), allowedError);
+          }
+
+          void TestCachesOnlyUpdatedWhenAsked()
+          {
+            typedef lb::lattices::D3Q15 Lattice;
+            typedef lb::collisions::Normal<lb::kernels::LBGK<Lattice> > Collision;
+            lb::streamers::SimpleCollideAndStream<Collision> simpleCollideAndStream(initParams);
+            const site_t siteCount = latDat->GetLocalFluidSiteCount();
+
+            LbTestsHelper::InitialiseAnisotropicTestData<Lattice>(latDat);
+            propertyCache->densityCache.SetRefreshFlag();
+            propertyCache->densityCache.Put(3, -1.0);
+
+            // Without tUpdateCaches the collisions leave the caches alone, even if they need
+            // refreshing...
+            simpleCollideAndStream.StreamAndCollide<false> (0, siteCount, lbmParams, latDat, *propertyCache);
+            CPPUNIT_ASSERT_EQUAL(-1.0, propertyCache->densityCache.Get(3));
+
+            // ...and with it they fill them in.
+            simpleCollideAndStream.StreamAndCollide<true> (0, siteCount, lbmParams, latDat, *propertyCache);
+            CPPUNIT_ASSERT(propertyCache->densityCache.Get(3) > 0.0);
+          }
+
+          void TestRelativeChangeNoted()
+          {
+            typedef lb::lattices::D3Q15 Lattice;
+            typedef lb::collisions::Normal<lb::kernels::LBGK<Lattice> > Collision;
+            lb::streamers::SimpleCollideAndStream<Collision> simpleCollideAndStream(initParams);
+            const site_t siteCount = latDat->GetLocalFluidSiteCount();
+
+            // Every site at the same equilibrium at rest sends what it did before.
+            distribn_t fEq[Lattice::NUMVECTORS];
+            Lattice::CalculateFeq(1.0, 0.0, 0.0, 0.0, fEq);
+            for (site_t site = 0; site < siteCount; ++site)
+            {
+              latDat->SetFOld<Lattice>(site, fEq);
+            }
+            propertyCache->SetRelativeChangeRequired();
+            simpleCollideAndStream.StreamAndCollide<true> (0, siteCount, lbmParams, latDat, *propertyCache);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, propertyCache->GetLocalMaxRelativeChange(), allowedError);
+
+            // Raise the density at one site by a part in a thousand, so that it sends that much more
+            // than it did. With push streaming that's compared with what's where it streams to.
+            // With pull streaming it's compared with its own, which here has been raised too, so
+            // only its neighbours, which pull some of the raise, see a change.
+            const site_t chosenSite = 21;
+            const distribn_t change = 1e-3;
+            distribn_t fRaised[Lattice::NUMVECTORS];
+            for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+            {
+              fRaised[direction] = (1.0 + change) * fEq[direction];
+            }
+            latDat->SetFOld<Lattice>(chosenSite, fRaised);
+            propertyCache->SetRelativeChangeRequired();
+            simpleCollideAndStream.StreamAndCollide<true> (0, siteCount, lbmParams, latDat, *propertyCache);
+#ifdef HEMELB_USE_PULL_STREAMING
+            CPPUNIT_ASSERT(propertyCache->GetLocalMaxRelativeChange() > allowedError);
+#else
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(change, propertyCache->GetLocalMaxRelativeChange(), allowedError);
+#endif
+
+            // It's only tracked when asked for, and then afresh.
+            propertyCache->ResetRequirements();
+            propertyCache->SetRelativeChangeRequired();
+            propertyCache->ResetRequirements();
+            simpleCollideAndStream.StreamAndCollide<true> (0, siteCount, lbmParams, latDat, *propertyCache);
+            CPPUNIT_ASSERT_EQUAL(0.0, propertyCache->GetLocalMaxRelativeChange());
+          }
+
+#ifndef HEMELB_USE_PULL_STREAMING
+          void TestDensityExtremes()
+          {
+            typedef lb::lattices::D3Q15 Lattice;
+            typedef lb::collisions::Normal<lb::kernels::LBGK<Lattice> > Collision;
+            lb::streamers::SimpleCollideAndStream<Collision> simpleCollideAndStream(initParams);
+            const site_t siteCount = latDat->GetLocalFluidSiteCount();
+
+            LbTestsHelper::InitialiseAnisotropicTestData<Lattice>(latDat);
+            distribn_t minDensity = DBL_MAX;
+            distribn_t maxDensity = -DBL_MAX;
+            distribn_t maxVelocity = 0.0;
+            for (site_t site = 0; site < siteCount; ++site)
+            {
+              distribn_t fOld[Lattice::NUMVECTORS];
+              distribn_t density;
+              util::Vector3D<distribn_t> momentum;
+              Lattice::CalculateDensityAndMomentum(latDat->GetSite(site).GetFOld<Lattice>(fOld),
+                                                   density,
+                                                   momentum[0],
+                                                   momentum[1],
+                                                   momentum[2]);
+              minDensity = std::min(minDensity, density);
+              maxDensity = std::max(maxDensity, density);
+              maxVelocity = std::max(maxVelocity, momentum.GetMagnitude() / density);
+            }
+
+            // The extremes are over every site, even if only some are cached.
+            std::vector<site_t> cachedSites(1, 3);
+            propertyCache->RestrictToSites(cachedSites);
+            propertyCache->SetDensityExtremesRequired();
+            simpleCollideAndStream.StreamAndCollide<true> (0, siteCount, lbmParams, latDat, *propertyCache);
+
+            const lb::MacroscopicPropertyCache::DensityExtremes extremes =
+                propertyCache->GetLocalDensityExtremes();
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(minDensity, extremes.minDensity, allowedError);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(maxDensity, extremes.maxDensity, allowedError);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(maxVelocity, extremes.maxVelocityMagnitude, allowedError);
+
+            // Asking again starts afresh.
+            propertyCache->SetDensityExtremesRequired();
+            CPPUNIT_ASSERT_EQUAL(DBL_MAX, propertyCache->GetLocalDensityExtremes().minDensity);
+          }
+#endif
+
+          void TestSiteBatchedCollideAndStream()
+          {
+            typedef lb::lattices::D3Q15 Lattice;
+            typedef lb::collisions::Normal<lb::kernels::LBGK<Lattice> > Collision;
+            lb::streamers::SimpleCollideAndStream<Collision> simpleCollideAndStream(initParams);
+            lb::streamers::SiteBatchedCollideAndStream<Collision> batchedCollideAndStream(initParams);
+
+            // Use a range that isn't a whole number of batches, so the leftover sites are
+            // tested too.
+            const site_t firstSite = 1;
+            const site_t siteCount = latDat->GetLocalFluidSiteCount() - 2;
+            const site_t distributionCount = latDat->GetLocalFluidSiteCount() * Lattice::NUMVECTORS;
+
+            LbTestsHelper::InitialiseAnisotropicTestData<Lattice>(latDat);
+            propertyCache->densityCache.SetRefreshFlag();
+            propertyCache->velocityCache.SetRefreshFlag();
+
+            simpleCollideAndStream.StreamAndCollide<true> (firstSite,
+                                                           siteCount,
+                                                           lbmParams,
+                                                           latDat,
+                                                           *propertyCache);
+
+            std::vector<distribn_t> expectedFNew(latDat->GetFNew(0), latDat->GetFNew(0) + distributionCount);
+            std::vector<distribn_t> expectedDensity;
+            std::vector<util::Vector3D<distribn_t> > expectedVelocity;
+            for (site_t site = firstSite; site < firstSite + siteCount; ++site)
+            {
+              expectedDensity.push_back(propertyCache->densityCache.Get(site));
+              expectedVelocity.push_back(propertyCache->velocityCache.Get(site));
+            }
+
+            std::fill(latDat->GetFNew(0), latDat->GetFNew(0) + distributionCount, 0.0);
+
+            batchedCollideAndStream.StreamAndCollide<true> (firstSite,
+                                                            siteCount,
+                                                            lbmParams,
+                                                            latDat,
+                                                            *propertyCache);
+
+            for (site_t index = 0; index < distributionCount; ++index)
+            {
+              CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("SiteBatchedCollideAndStream, fNew",
+                                                   expectedFNew[index],
+                                                   *latDat->GetFNew(index),
+                                                   allowedError);
+            }
+            for (site_t site = firstSite; site < firstSite + siteCount; ++site)
+            {
+              CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("SiteBatchedCollideAndStream, density",
+                                                   expectedDensity[site - firstSite],
+                                                   propertyCache->densityCache.Get(site),
+                                                   allowedError);
+              for (unsigned dimension = 0; dimension < 3; ++dimension)
+              {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("SiteBatchedCollideAndStream, velocity",
+                                                     expectedVelocity[site - firstSite][dimension],
+                                                     propertyCache->velocityCache.Get(site)[dimension],
+                                                     allowedError);
+              }
+            }
+          }
+
+#ifndef HEMELB_USE_PULL_STREAMING
+          void TestNonPositiveDistributionNoted()
+          {
+            typedef lb::lattices::D3Q15 Lattice;
+            lb::streamers::SimpleCollideAndStream<lb::collisions::Normal<lb::kernels::LBGK<Lattice> > >
+                simpleCollideAndStream(initParams);
+
+            // Start everywhere at an equilibrium with a little flow.
+            distribn_t fEq[Lattice::NUMVECTORS];
+            Lattice::CalculateFeq(1.0, 0.01, 0.02, 0.03, fEq);
+            for (site_t site = 0; site < latDat->GetLocalFluidSiteCount(); ++site)
+            {
+              latDat->SetFOld<Lattice>(site, fEq);
+            }
+            simpleCollideAndStream.StreamAndCollide<false> (0,
+                                                            latDat->GetLocalFluidSiteCount(),
+                                                            lbmParams,
+                                                            latDat,
+                                                            *propertyCache);
+            CPPUNIT_ASSERT(!propertyCache->HasSeenNonPositiveDistribution());
+
+            // Make the flow at one site so fast that, although its distributions are all
+            // positive, some it sends are negative, and collide just that site. It's the values
+            // sent that are checked, so this is caught on this step rather than the next.
+            const site_t chosenSite = 10;
+            distribn_t fOld[Lattice::NUMVECTORS];
+            std::copy(fEq, fEq + Lattice::NUMVECTORS, fOld);
+            fOld[1] *= 50.0;
+            latDat->SetFOld<Lattice>(chosenSite, fOld);
+
+            lb::kernels::LBGK<Lattice> lbgk(initParams);
+            lb::kernels::HydroVars<lb::kernels::LBGK<Lattice> > hydroVars(fOld);
+            lbgk.CalculateDensityMomentumFeq(hydroVars, chosenSite);
+            lbgk.Collide(lbmParams, hydroVars);
+            bool anyNegative = false;
+            for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+            {
+              CPPUNIT_ASSERT(fOld[direction] > 0.0);
+              anyNegative |= hydroVars.GetFPostCollision()[direction] < 0.0;
+            }
+            CPPUNIT_ASSERT(anyNegative);
+
+            simpleCollideAndStream.StreamAndCollide<false> (chosenSite,
+                                                            1,
+                                                            lbmParams,
+                                                            latDat,
+                                                            *propertyCache);
+            CPPUNIT_ASSERT(propertyCache->HasSeenNonPositiveDistribution());
+
+            propertyCache->ClearNonPositiveDistributionFlag();
+            CPPUNIT_ASSERT(!propertyCache->HasSeenNonPositiveDistribution());
+
+            // A NaN is caught too.
+            std::copy(fEq, fEq + Lattice::NUMVECTORS, fOld);
+            fOld[3] = std::numeric_limits<distribn_t>::quiet_NaN();
+            latDat->SetFOld<Lattice>(chosenSite, fOld);
+            simpleCollideAndStream.StreamAndCollide<false> (chosenSite,
+                                                            1,
+                                                            lbmParams,
+                                                            latDat,
+                                                            *propertyCache);
+            CPPUNIT_ASSERT(propertyCache->HasSeenNonPositiveDistribution());
+          }
 
           void TestBouzidiFirdaousLallemand()
           {
@@ -149,7 +449,7 @@ namespace hemelb
               const geometry::Site<geometry::LatticeData> streamedSite =
                   latDat->GetSite(streamedToSite);
 
-              distribn_t* streamedToFNew = latDat->GetFNew(lb::lattices::D3Q15::NUMVECTORS
+              stored_distribn_t* streamedToFNew = latDat->GetFNew(lb::lattices::D3Q15::NUMVECTORS
                   * streamedToSite);
 
               for (unsigned int streamedDirection = 0; streamedDirection
@@ -363,7 +663,7 @@ namespace hemelb
               site_t streamedToSite = firstWallSite + wallSiteLocalIndex;
               const geometry::Site<geometry::LatticeData> streamedSite =
                   latDat->GetSite(streamedToSite);
-              distribn_t* streamedToFNew = latDat->GetFNew(lb::lattices::D3Q15::NUMVECTORS
+              stored_distribn_t* streamedToFNew = latDat->GetFNew(lb::lattices::D3Q15::NUMVECTORS
                   * streamedToSite);
 
               for (unsigned int streamedDirection = 0; streamedDirection
@@ -702,7 +1002,7 @@ namespace hemelb
               site_t streamedToSite = firstWallSite + wallSiteLocalIndex;
               const geometry::Site<geometry::LatticeData> streamedSite =
                   latDat->GetSite(streamedToSite);
-              distribn_t* streamedToFNew = latDat->GetFNew(lb::lattices::D3Q15::NUMVECTORS
+              stored_distribn_t* streamedToFNew = latDat->GetFNew(lb::lattices::D3Q15::NUMVECTORS
                   * streamedToSite);
 
               for (unsigned int streamedDirection = 0; streamedDirection
@@ -1014,8 +1314,95 @@ namespace hemelb
               }
             }
           }
+#endif
+
+#ifdef HEMELB_USE_PULL_STREAMING
+          void TestPullSameAsPush()
+          {
+            typedef lb::collisions::Normal<lb::kernels::LBGK<lb::lattices::D3Q15> > Collision;
+            lb::streamers::SimpleCollideAndStream<Collision> simpleCollideAndStream(initParams);
+            AssertPullSameAsPush(simpleCollideAndStream, false);
+          }
+
+          void TestPullSameAsPushWithBounceBack()
+          {
+            typedef lb::collisions::Normal<lb::kernels::LBGK<lb::lattices::D3Q15> > Collision;
+            lb::streamers::SimpleBounceBack<Collision>::Type simpleBounceBack(initParams);
+            AssertPullSameAsPush(simpleBounceBack, true);
+          }
+#endif
 
         private:
+#ifdef HEMELB_USE_PULL_STREAMING
+          /**
+           * Collide and stream the whole lattice once by pulling, and check that each site then
+           * pulls what pushing would have streamed to it. The push step starts from what the
+           * sites pull from the initial fOld, and the streamed distributions are worked out
+           * here as in TestSimpleCollideAndStream.
+           * @param streamer
+           * @param bounceBack Whether the streamer bounces the distributions back off the walls.
+           */
+          template<typename StreamerType>
+          void AssertPullSameAsPush(StreamerType& streamer, bool bounceBack)
+          {
+            typedef lb::lattices::D3Q15 Lattice;
+            const site_t siteCount = latDat->GetLocalFluidSiteCount();
+            const site_t distributionCount = siteCount * Lattice::NUMVECTORS;
+
+            LbTestsHelper::InitialiseAnisotropicTestData<Lattice>(latDat);
+
+            // What pushing would leave in fNew, and whether anything is streamed there.
+            std::vector<distribn_t> pushedFNew(distributionCount, 0.0);
+            std::vector<bool> pushed(distributionCount, false);
+            for (site_t siteIndex = 0; siteIndex < siteCount; ++siteIndex)
+            {
+              geometry::Site<geometry::LatticeData> site = latDat->GetSite(siteIndex);
+              distribn_t fOld[Lattice::NUMVECTORS];
+              for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+              {
+                fOld[direction] = site.GetPulledFOld<Lattice>(direction);
+              }
+              lb::kernels::HydroVars<lb::kernels::LBGK<Lattice> > hydroVars(fOld);
+              normalCollision->CalculatePreCollision(hydroVars, site);
+              normalCollision->Collide(lbmParams, hydroVars);
+
+              for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+              {
+                site_t streamedIndex = site.GetStreamedIndex<Lattice>(direction);
+                if (bounceBack && site.HasWall(direction))
+                {
+                  streamedIndex = latDat->GetDistributionIndex<Lattice>(siteIndex,
+                                                                        Lattice::INVERSEDIRECTIONS[direction]);
+                }
+                if (streamedIndex < distributionCount)
+                {
+                  pushedFNew[streamedIndex] = hydroVars.GetFPostCollision()[direction];
+                  pushed[streamedIndex] = true;
+                }
+              }
+            }
+
+            streamer.template StreamAndCollide<false> (0, siteCount, lbmParams, latDat, *propertyCache);
+            latDat->SwapOldAndNew();
+
+            for (site_t siteIndex = 0; siteIndex < siteCount; ++siteIndex)
+            {
+              geometry::Site<geometry::LatticeData> site = latDat->GetSite(siteIndex);
+              for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+              {
+                const site_t index = latDat->GetDistributionIndex<Lattice>(siteIndex, direction);
+                if (pushed[index])
+                {
+                  CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Pull streaming, pulled fOld",
+                                                       pushedFNew[index],
+                                                       site.GetPulledFOld<Lattice>(direction),
+                                                       allowedError);
+                }
+              }
+            }
+          }
+#endif
+
           lb::MacroscopicPropertyCache* propertyCache;
           lb::collisions::Normal<lb::kernels::LBGK<lb::lattices::D3Q15> >* normalCollision;
       };
@@ -8,6 +8,7 @@
 #define HEMELB_UNITTESTS_LBTESTS_VIRTUALSITEIOLETSTREAMERTESTS_H
 
 #include <cppunit/TestFixture.h>
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
@@ -255,6 +256,17 @@ namespace hemelb
               }
             }
 
+            // With every q = 0.5, rho_virtual = 2 rho_iolet - 0.2 SUM_i rho[i]
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, vSite.ioletDensityWeight, allowedError);
+            // and a uniform velocity must be fitted exactly.
+            distribn_t sumVelocityWeights = 0.;
+            for (unsigned i = 0; i < vSite.neighbourCacheIndices.size(); ++i)
+            {
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(-0.2, vSite.densityWeights[i], allowedError);
+              sumVelocityWeights += vSite.velocityWeights[i];
+            }
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, sumVelocityWeights, allowedError);
+
             // Now check that appropriate entries have been added to the hydroCache
             CheckPointInCache(extra, LatticeVector(1, 1, 4), LatticePosition(1.5, -1.5, 0.5));
             CheckPointInCache(extra, LatticeVector(1, 3, 4), LatticePosition(1.5, 0.5, 0.5));
@@ -292,16 +304,15 @@ namespace hemelb
                 //                site_t localIdx = latDat->GetLocalContiguousIdFromGlobalNoncontiguousId(globalIdx);
                 //                geometry::Site < geometry::LatticeData > site = latDat->GetSite(localIdx);
 
-                RSHV::Map::iterator hvPtr = extra->hydroVarsCache.find(globalIdx);
-                CPPUNIT_ASSERT(hvPtr != extra->hydroVarsCache.end());
+                CPPUNIT_ASSERT(extra->FindCachedHydroVars(globalIdx) != NULL);
               }
             }
 
             // And the reverse is true: every cache entry should be a site at the outlet plane
-            for (RSHV::Map::iterator hvPtr = extra->hydroVarsCache.begin(); hvPtr
+            for (std::vector<RSHV>::iterator hvPtr = extra->hydroVarsCache.begin(); hvPtr
                 != extra->hydroVarsCache.end(); ++hvPtr)
             {
-              site_t globalIdx = hvPtr->first;
+              site_t globalIdx = hvPtr->globalIdx;
               LatticeVector pos;
               latDat->GetGlobalCoordsFromGlobalNoncontiguousSiteId(globalIdx, pos);
               CPPUNIT_ASSERT(hemelb::util::NumericalFunctions::IsInRange<LatticeCoordinate>(pos.x,
@@ -440,13 +451,13 @@ namespace hemelb
           {
             VSExtra<Lattice> * extra =
                 dynamic_cast<VSExtra<Lattice>*> (iolets->GetLocalIolet(0)->GetExtraData());
-            for (RSHV::Map::iterator hvPtr = extra->hydroVarsCache.begin(); hvPtr
+            for (std::vector<RSHV>::iterator hvPtr = extra->hydroVarsCache.begin(); hvPtr
                 != extra->hydroVarsCache.end(); ++hvPtr)
             {
-              site_t siteGlobalIdx = hvPtr->first;
+              site_t siteGlobalIdx = hvPtr->globalIdx;
               LatticeVector sitePos;
               latDat->GetGlobalCoordsFromGlobalNoncontiguousSiteId(siteGlobalIdx, sitePos);
-              RSHV& hv = hvPtr->second;
+              RSHV& hv = *hvPtr;
               CPPUNIT_ASSERT_EQUAL(expectedT, hv.t);
               CPPUNIT_ASSERT_DOUBLES_EQUAL(GetDensity(sitePos), hv.rho, allowedError);
               LatticeVelocity u = GetVelocity(sitePos);
@@ -461,12 +472,12 @@ namespace hemelb
           {
             site_t expectedGlobalIdx =
                 latDat->GetGlobalNoncontiguousSiteIdFromGlobalCoords(expectedPt);
-            RSHV::Map::iterator hvPtr = extra.hydroVarsCache.find(expectedGlobalIdx);
+            RSHV* hvPtr = extra.FindCachedHydroVars(expectedGlobalIdx);
 
-            CPPUNIT_ASSERT(hvPtr != extra.hydroVarsCache.end());
+            CPPUNIT_ASSERT(hvPtr != NULL);
             for (unsigned i = 0; i < 3; ++i)
               CPPUNIT_ASSERT_DOUBLES_EQUAL(expectedIoletPos[i],
-                                           hvPtr->second.posIolet[i],
+                                           hvPtr->posIolet[i],
                                            allowedError);
 
           }
@@ -494,11 +505,13 @@ namespace hemelb
                   LatticeVector pos(i, j, k);
                   site_t siteIdx = latDat->GetContiguousSiteId(pos);
                   //geometry::Site < geometry::LatticeData > site = latDat->GetSite(siteIdx);
-                  distribn_t* fOld = latDat->GetFNew(siteIdx * Lattice::NUMVECTORS);
+                  stored_distribn_t* fOld = latDat->GetFNew(siteIdx * Lattice::NUMVECTORS);
                   LatticeDensity rho = GetDensity(pos);
                   LatticeVelocity u = GetVelocity(pos);
                   u *= rho;
-                  Lattice::CalculateFeq(rho, u.x, u.y, u.z, fOld);
+                  distribn_t fEq[Lattice::NUMVECTORS];
+                  Lattice::CalculateFeq(rho, u.x, u.y, u.z, fEq);
+                  std::copy(fEq, fEq + Lattice::NUMVECTORS, fOld);
                 }
               }
             }
@@ -0,0 +1,103 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_LBTESTS_WARMSTARTTESTS_H
+#define HEMELB_UNITTESTS_LBTESTS_WARMSTARTTESTS_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include "lb/WarmStart.h"
+#include "lb/lattices/D3Q15.h"
+#include "lb/lattices/D3Q19.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace lbtests
+    {
+      /**
+       * Class to test the distributions that the warm start sets from the coarse flow.
+       */
+      class WarmStartTests : public CppUnit::TestFixture
+      {
+          CPPUNIT_TEST_SUITE (WarmStartTests);
+          CPPUNIT_TEST (TestD3Q15);
+          CPPUNIT_TEST (TestD3Q19);CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void TestD3Q15()
+          {
+            TestMoments<lb::lattices::D3Q15>();
+          }
+
+          void TestD3Q19()
+          {
+            TestMoments<lb::lattices::D3Q19>();
+          }
+
+        private:
+          /**
+           * The distributions should have the density and momentum they were made from, and
+           * their non-equilibrium parts should have the given momentum flux and no mass.
+           */
+          template<class LatticeType>
+          void TestMoments()
+          {
+            const distribn_t density = 1.02;
+            const util::Vector3D<distribn_t> velocity(0.01, -0.02, 0.005);
+            // Traceless, as a deviatoric stress is.
+            const distribn_t piNeq[6] = { 1e-3, 2e-4, -3e-4, -4e-4, 5e-4, -6e-4 };
+
+            distribn_t f[LatticeType::NUMVECTORS];
+            distribn_t fEq[LatticeType::NUMVECTORS];
+            lb::WarmStart<LatticeType>::CalculateDistributions(density, velocity, piNeq, f);
+            LatticeType::CalculateFeq(density,
+                                      density * velocity.x,
+                                      density * velocity.y,
+                                      density * velocity.z,
+                                      fEq);
+
+            distribn_t sum = 0.0, neqSum = 0.0;
+            util::Vector3D<distribn_t> momentum = util::Vector3D<distribn_t>::Zero();
+            distribn_t flux[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+            {
+              const distribn_t c[3] = { distribn_t(LatticeType::CX[direction]),
+                                        distribn_t(LatticeType::CY[direction]),
+                                        distribn_t(LatticeType::CZ[direction]) };
+              const distribn_t fNeq = f[direction] - fEq[direction];
+              sum += f[direction];
+              neqSum += fNeq;
+              momentum += util::Vector3D<distribn_t>(c[0], c[1], c[2]) * f[direction];
+              unsigned component = 0;
+              for (unsigned row = 0; row < 3; ++row)
+              {
+                for (unsigned column = row; column < 3; ++column, ++component)
+                {
+                  flux[component] += fNeq * c[row] * c[column];
+                }
+              }
+            }
+
+            const distribn_t epsilon = 1e-12;
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(density, sum, epsilon);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, neqSum, epsilon);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(density * velocity.x, momentum.x, epsilon);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(density * velocity.y, momentum.y, epsilon);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(density * velocity.z, momentum.z, epsilon);
+            for (unsigned component = 0; component < 6; ++component)
+            {
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(piNeq[component], flux[component], epsilon);
+            }
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (WarmStartTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_LBTESTS_WARMSTARTTESTS_H */
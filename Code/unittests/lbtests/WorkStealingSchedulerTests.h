@@ -0,0 +1,102 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_LBTESTS_WORKSTEALINGSCHEDULERTESTS_H
+#define HEMELB_UNITTESTS_LBTESTS_WORKSTEALINGSCHEDULERTESTS_H
+
+#include <vector>
+#include <cppunit/TestFixture.h>
+#include "lb/WorkStealingScheduler.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace lbtests
+    {
+      /**
+       * Counts the sites of each chunk it is given, and the master thread's chunks.
+       */
+      struct CountingWorker
+      {
+          CountingWorker(site_t siteCount) :
+              visits(siteCount, 0), masterChunks(0)
+          {
+          }
+
+          void operator()(const lb::WorkChunk& chunk)
+          {
+            for (site_t site = chunk.firstIndex; site < chunk.firstIndex + chunk.siteCount; ++site)
+            {
+#pragma omp atomic
+              ++visits[site];
+            }
+          }
+
+          void AfterMasterChunk()
+          {
+            ++masterChunks;
+          }
+
+          std::vector<int> visits;
+          unsigned masterChunks;
+      };
+
+      class WorkStealingSchedulerTests : public CppUnit::TestFixture
+      {
+          CPPUNIT_TEST_SUITE (WorkStealingSchedulerTests);
+          CPPUNIT_TEST (TestChunking);
+          CPPUNIT_TEST (TestEverySiteDoneOnce);CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void TestChunking()
+          {
+            lb::WorkStealingScheduler scheduler;
+            scheduler.AddRange(0, 0, 10, 4, 1.0);
+            // A range that can't be split is one chunk.
+            scheduler.AddRange(2, 10, 7, 0, 5.0);
+
+            const std::vector<lb::WorkChunk>& chunks = scheduler.GetChunks();
+            CPPUNIT_ASSERT_EQUAL(size_t(4), chunks.size());
+            CPPUNIT_ASSERT_EQUAL(site_t(8), chunks[2].firstIndex);
+            CPPUNIT_ASSERT_EQUAL(site_t(2), chunks[2].siteCount);
+            CPPUNIT_ASSERT_EQUAL(2.0, chunks[2].cost);
+            CPPUNIT_ASSERT_EQUAL(2u, chunks[3].collisionType);
+            CPPUNIT_ASSERT_EQUAL(site_t(7), chunks[3].siteCount);
+            CPPUNIT_ASSERT_EQUAL(35.0, chunks[3].cost);
+
+            scheduler.Clear();
+            CPPUNIT_ASSERT(scheduler.GetChunks().empty());
+          }
+
+          void TestEverySiteDoneOnce()
+          {
+            lb::WorkStealingScheduler scheduler;
+            // Cheap bulk sites, then a few expensive wall sites.
+            scheduler.AddRange(0, 0, 1000, 16, 1.0);
+            scheduler.AddRange(1, 1000, 100, 16, 40.0);
+
+            CountingWorker worker(1100);
+            // Twice, to reuse the queues.
+            for (int run = 0; run < 2; ++run)
+            {
+              scheduler.Run(worker);
+            }
+
+            for (site_t site = 0; site < 1100; ++site)
+            {
+              CPPUNIT_ASSERT_EQUAL(2, worker.visits[site]);
+            }
+            CPPUNIT_ASSERT(worker.masterChunks > 0);
+            CPPUNIT_ASSERT(scheduler.GetThreadCount() >= 1);
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (WorkStealingSchedulerTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_LBTESTS_WORKSTEALINGSCHEDULERTESTS_H */
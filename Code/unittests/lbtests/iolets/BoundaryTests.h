@@ -45,6 +45,9 @@ namespace hemelb
                                           Comms(),
                                           *unitConverter);
               CPPUNIT_ASSERT_DOUBLES_EQUAL(targetStartDensity, inlets->GetBoundaryDensity(0), 1e-9);
+              // A cosine inlet is evaluated locally, so it should not have been given any comms.
+              CPPUNIT_ASSERT(inlets->GetLocalIolet(0)->IsDensityLocallyComputable());
+              CPPUNIT_ASSERT(inlets->GetLocalIolet(0)->GetComms() == NULL);
               delete inlets;
             }
             void TestUpdate()
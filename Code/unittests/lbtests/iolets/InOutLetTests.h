@@ -11,6 +11,7 @@
 
 #include "unittests/helpers/FolderTestFixture.h"
 #include "lb/iolets/InOutLets.h"
+#include "util/Bessel.h"
 #include "resources/Resource.h"
 #include "debug/Debugger.h"
 
@@ -52,7 +53,10 @@ namespace hemelb
             CPPUNIT_TEST(TestIoletCoordinates);
             CPPUNIT_TEST(TestParabolicVelocityConstruct);
             CPPUNIT_TEST(TestWomersleyVelocityConstruct);
+            CPPUNIT_TEST(TestWomersleyVelocityRadialProfile);
             CPPUNIT_TEST(TestFileVelocityConstruct);
+            CPPUNIT_TEST(TestMultiscaleCommsValues);
+            CPPUNIT_TEST(TestMultiscaleCouplingInterpolation);
             CPPUNIT_TEST_SUITE_END();
           public:
             void setUp()
@@ -163,6 +167,13 @@ namespace hemelb
               CPPUNIT_ASSERT_DOUBLES_EQUAL(targetMidDensity,
                                            file->GetDensity(state.GetTotalTimeSteps() / 2),
                                            1e-6);
+              // The trace is one cycle of the simulation's length, and repeats after it.
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(targetStartDensity,
+                                           file->GetDensity(state.GetTotalTimeSteps()),
+                                           1e-6);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(targetMidDensity,
+                                           file->GetDensity(3 * state.GetTotalTimeSteps() / 2),
+                                           1e-6);
               FolderTestFixture::tearDown();
             }
 
@@ -275,6 +286,42 @@ namespace hemelb
 
             }
 
+            void TestWomersleyVelocityRadialProfile()
+            {
+              UncheckedSimConfig config(Resource("config_new_velocity_inlets.xml").Path());
+              womersVel = static_cast<InOutLetWomersleyVelocity*>(config.GetInlets()[0]);
+              const util::UnitConverter& converter = config.GetUnitConverter();
+              womersVel->Initialise(&converter);
+
+              // The tabulated radial profile must agree with evaluating the Bessel functions
+              // directly, between the table points and outside the iolet too. The tolerance is
+              // relative to the velocity scale, since the profile itself goes to zero at the wall.
+              typedef std::complex<double> Complex;
+              const Complex iPowThreeHalves = pow(Complex(0, 1), 1.5);
+              const double omega = 2.0 * PI / womersVel->GetPeriod();
+              const LatticeSpeed tolerance = 1e-6 * womersVel->GetPressureGradientAmplitude() / omega;
+              const LatticeTimeStep time = 3;
+              const double normalisedRadii[] = { 0.0, 0.123456, 0.5, 0.777777, 0.999, 1.0, 1.05 };
+
+              for (unsigned ii = 0; ii < sizeof(normalisedRadii) / sizeof(double); ++ii)
+              {
+                const double r = normalisedRadii[ii] * womersVel->GetRadius();
+                const LatticePosition x = womersVel->GetPosition() + LatticePosition(r, 0, 0);
+
+                const Complex profile = 1.0
+                    - hemelb::util::BesselJ0ComplexArgument(iPowThreeHalves * womersVel->GetWomersleyNumber()
+                        * normalisedRadii[ii])
+                        / hemelb::util::BesselJ0ComplexArgument(iPowThreeHalves * womersVel->GetWomersleyNumber());
+                const LatticeSpeed expected = -std::real(womersVel->GetPressureGradientAmplitude() / omega
+                    * profile * exp(Complex(0, 1) * omega * double(time)));
+
+                LatticeVelocity velocity(womersVel->GetVelocity(x, time));
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, velocity[0], 1e-12);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, velocity[1], 1e-12);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, velocity[2], tolerance);
+              }
+            }
+
             void TestFileVelocityConstruct()
             {
               // We have to move to a tempdir, as the path specified in the xml file is a relative path
@@ -331,6 +378,16 @@ namespace hemelb
                 CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0075, physVelPointEqui[2], 1e-9);
               }
 
+              // The trace is a four second cycle, so seven seconds in is like three.
+              {
+                LatticeVelocity velInSecondCycle(fileVel->GetVelocity(pointAtCentrelineLatticeUnits,
+                                                                      converter.ConvertTimeToLatticeUnits(7.0)));
+                PhysicalVelocity physVelInSecondCycle =
+                    converter.ConvertVelocityToPhysicalUnits(velInSecondCycle);
+
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(0.01, physVelInSecondCycle[2], 1e-9);
+              }
+
               FolderTestFixture::tearDown();
             }
 
@@ -392,6 +449,73 @@ namespace hemelb
 
             }
 
+            void TestMultiscaleCommsValues()
+            {
+              // What the BC proc packs should come out the same on the receiving side.
+              InOutLetMultiscale sender;
+              sender.GetPressureReference().SetPayload(81.0);
+
+              std::vector<distribn_t> values(sender.GetCommsValueCount());
+              CPPUNIT_ASSERT_EQUAL(3u, sender.GetCommsValueCount());
+              sender.PackCommsValues(&values[0]);
+
+              InOutLetMultiscale receiver;
+              receiver.UnpackCommsValues(&values[0]);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(81.0, receiver.GetPressure(), 1e-12);
+
+              // Iolets that aren't communicated share nothing.
+              InOutLetCosine localIolet;
+              CPPUNIT_ASSERT_EQUAL(0u, localIolet.GetCommsValueCount());
+            }
+
+            void TestMultiscaleCouplingInterpolation()
+            {
+              UncheckedSimConfig config(Resource("config.xml").Path());
+              const util::UnitConverter& converter = config.GetUnitConverter();
+
+              InOutLetMultiscale iolet;
+              iolet.Initialise(&converter);
+              iolet.SetCouplingInterval(10);
+
+              // Receive 80, 82 and 90 mmHg at steps 0, 10 and 20.
+              const PhysicalPressure received[] = { 80.0, 82.0, 90.0 };
+              for (unsigned i = 0; i < 3; ++i)
+              {
+                distribn_t values[3] = { received[i], received[i], received[i] };
+                iolet.UnpackCommsValues(values);
+                iolet.RecordCoupledValues(10 * i);
+              }
+
+              // Linear: one interval behind, from 82 at step 20 to 90 at step 30 and after.
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(converter.ConvertPressureToLatticeUnits(82.0) / Cs2,
+                                           iolet.GetDensity(20),
+                                           1e-9);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(converter.ConvertPressureToLatticeUnits(86.0) / Cs2,
+                                           iolet.GetDensity(25),
+                                           1e-9);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(converter.ConvertPressureToLatticeUnits(90.0) / Cs2,
+                                           iolet.GetDensity(35),
+                                           1e-9);
+
+              // Cubic: the same ends, with slopes (90-80)/2 and 90-82 per interval between them.
+              iolet.SetCouplingInterpolation(InOutLetMultiscale::CubicInterpolation);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(converter.ConvertPressureToLatticeUnits(82.0) / Cs2,
+                                           iolet.GetDensity(20),
+                                           1e-9);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(converter.ConvertPressureToLatticeUnits(85.625) / Cs2,
+                                           iolet.GetDensity(25),
+                                           1e-9);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(converter.ConvertPressureToLatticeUnits(90.0) / Cs2,
+                                           iolet.GetDensity(30),
+                                           1e-9);
+
+              // With no interval, the last value received is used as it is.
+              iolet.SetCouplingInterval(1);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(converter.ConvertPressureToLatticeUnits(90.0) / Cs2,
+                                           iolet.GetDensity(25),
+                                           1e-9);
+            }
+
             InOutLetCosine *cosine;
             InOutLetFile *file;
             InOutLetParabolicVelocity* p_vel;
@@ -16,5 +16,9 @@
 #include "unittests/lbtests/iolets/BoundaryTests.h"
 #include "unittests/lbtests/iolets/InOutLetTests.h"
 #include "unittests/lbtests/VirtualSiteIoletStreamerTests.h"
+#include "unittests/lbtests/CheckpointTests.h"
+#include "unittests/lbtests/WarmStartTests.h"
+#include "unittests/lbtests/WorkStealingSchedulerTests.h"
+#include "unittests/lbtests/SteadyStateAcceleratorTests.h"
 
 #endif /* HEMELB_UNITTESTS_LBTESTS_LBTESTS_H */
@@ -24,6 +24,7 @@
 #include "unittests/multiscale/multiscale.h"
 #ifdef HEMELB_BUILD_MULTISCALE
   #include "unittests/multiscale/mpwide/mpwide.h"
+  #include "unittests/multiscale/local/local.h"
 #endif
 #include "unittests/util/util.h"
 #include <unistd.h>
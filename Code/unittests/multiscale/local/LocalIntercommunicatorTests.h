@@ -0,0 +1,151 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_MULTISCALE_LOCAL_LOCALINTERCOMMUNICATORTESTS_H
+#define HEMELB_UNITTESTS_MULTISCALE_LOCAL_LOCALINTERCOMMUNICATORTESTS_H
+
+#include <cppunit/TestFixture.h>
+#include "multiscale/local/LocalIntercommunicator.h"
+#include "unittests/multiscale/MockIntercommunicand.h"
+#include "Exception.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace multiscale
+    {
+      namespace local
+      {
+        /***
+         * A tank of water run in the same process, in steps of half a second. It sets the pressure
+         * at boundary2, which drops with the velocity HemeLB sets at boundary1.
+         */
+        class MockTankModel : public CoupledModel
+        {
+          public:
+            MockTankModel() :
+                inletVelocity(NULL), outletPressure(NULL), time(0.), steps(0)
+            {
+            }
+
+            void ShareInitialConditions(const LocalSharedValues& values)
+            {
+              inletVelocity = values.find("boundary1_velocity")->second;
+              outletPressure = values.find("boundary2_pressure")->second;
+              *outletPressure = 1.0;
+            }
+
+            void AdvanceTo(double hemeTime)
+            {
+              while (time < hemeTime)
+              {
+                *outletPressure -= 0.1 * *inletVelocity;
+                time += 0.5;
+                ++steps;
+              }
+            }
+
+            double* inletVelocity;
+            double* outletPressure;
+            double time;
+            unsigned steps;
+        };
+
+        class LocalIntercommunicatorTests : public CppUnit::TestFixture
+        {
+            CPPUNIT_TEST_SUITE (LocalIntercommunicatorTests);
+            CPPUNIT_TEST (TestSharedInPlace);
+            CPPUNIT_TEST (TestAdvance);
+            CPPUNIT_TEST (TestWithoutModel);
+            CPPUNIT_TEST (TestOnlyDoubles);
+            CPPUNIT_TEST_SUITE_END();
+
+          public:
+            void setUp()
+            {
+              inOutLetType = new LocalIntercommunicator::IntercommunicandTypeT("inoutlet");
+              inOutLetType->RegisterSharedValue<double>("pressure");
+              inOutLetType->RegisterSharedValue<double>("velocity");
+              inlet = new MockIntercommunicand(2.0, 0.5);
+              outlet = new MockIntercommunicand(0.0, 0.5);
+            }
+
+            void tearDown()
+            {
+              delete outlet;
+              delete inlet;
+              delete inOutLetType;
+            }
+
+            void TestSharedInPlace()
+            {
+              MockTankModel model;
+              LocalIntercommunicator intercomms(&model);
+              intercomms.RegisterIntercommunicand(*inOutLetType, *inlet, "boundary1");
+              intercomms.RegisterIntercommunicand(*inOutLetType, *outlet, "boundary2");
+              intercomms.ShareInitialConditions();
+
+              CPPUNIT_ASSERT_EQUAL(size_t(4), intercomms.GetSharedValues().size());
+              // The model's initial condition is set on the iolet itself...
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, outlet->GetPressure(), 1e-12);
+              // ... and HemeLB's values are seen by the model as soon as they're set.
+              inlet->SetVelocity(3.0);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, *model.inletVelocity, 1e-12);
+            }
+
+            void TestAdvance()
+            {
+              MockTankModel model;
+              LocalIntercommunicator intercomms(&model);
+              intercomms.RegisterIntercommunicand(*inOutLetType, *inlet, "boundary1");
+              intercomms.RegisterIntercommunicand(*inOutLetType, *outlet, "boundary2");
+              intercomms.ShareInitialConditions();
+
+              // HemeLB always advances, with the model caught up to its time.
+              for (unsigned step = 0; step <= 10; ++step)
+              {
+                CPPUNIT_ASSERT(intercomms.DoMultiscale(0.2 * step));
+                CPPUNIT_ASSERT(model.time >= 0.2 * step);
+              }
+              CPPUNIT_ASSERT_EQUAL(4u, model.steps);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0 - 4 * 0.1 * 0.5, outlet->GetPressure(), 1e-12);
+            }
+
+            void TestWithoutModel()
+            {
+              // As on the ranks other than the one running the model.
+              LocalIntercommunicator intercomms(NULL);
+              intercomms.RegisterIntercommunicand(*inOutLetType, *inlet, "boundary1");
+              intercomms.ShareInitialConditions();
+              CPPUNIT_ASSERT(intercomms.GetSharedValues().empty());
+              CPPUNIT_ASSERT(intercomms.DoMultiscale(1.0));
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, inlet->GetPressure(), 1e-12);
+            }
+
+            void TestOnlyDoubles()
+            {
+              MockTankModel model;
+              LocalIntercommunicator intercomms(&model);
+              LocalIntercommunicator::IntercommunicandTypeT intType("counts");
+              intType.RegisterSharedValue<int>("pressure");
+              intType.RegisterSharedValue<int>("velocity");
+              intercomms.RegisterIntercommunicand(intType, *inlet, "boundary1");
+              CPPUNIT_ASSERT_THROW(intercomms.ShareInitialConditions(), hemelb::Exception);
+            }
+
+          private:
+            LocalIntercommunicator::IntercommunicandTypeT* inOutLetType;
+            MockIntercommunicand* inlet;
+            MockIntercommunicand* outlet;
+        };
+
+        CPPUNIT_TEST_SUITE_REGISTRATION (LocalIntercommunicatorTests);
+      }
+    }
+  }
+}
+
+#endif // HEMELB_UNITTESTS_MULTISCALE_LOCAL_LOCALINTERCOMMUNICATORTESTS_H
@@ -0,0 +1,11 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_MULTISCALE_LOCAL_LOCAL_H
+#define HEMELB_UNITTESTS_MULTISCALE_LOCAL_LOCAL_H
+
+#include "unittests/multiscale/local/LocalIntercommunicatorTests.h"
+
+#endif // HEMELB_UNITTESTS_MULTISCALE_LOCAL_LOCAL_H
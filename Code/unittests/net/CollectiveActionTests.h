@@ -0,0 +1,90 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_NET_COLLECTIVEACTIONTESTS_H
+#define HEMELB_UNITTESTS_NET_COLLECTIVEACTIONTESTS_H
+
+#include <cppunit/TestFixture.h>
+#include "net/CollectiveAction.h"
+#include "unittests/helpers/HasCommsTestFixture.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace net
+    {
+      using namespace hemelb::net;
+
+      /**
+       * Sums the number of the step on which each reduction is started over all the processes.
+       */
+      class StepSummer : public CollectiveAction<2>
+      {
+        public:
+          StepSummer(Net* net, const lb::SimulationState* simState) :
+              CollectiveAction<2>(net, simState, 10), reductionCount(0), result(-1), localStep(0), sum(0)
+          {
+          }
+
+          int reductionCount;
+          int result;
+
+        protected:
+          void StartReduction(const MpiCommunicator& comms, MPI_Request& request)
+          {
+            localStep = (int) mSimState->Get0IndexedTimeStep();
+            HEMELB_MPI_CALL(MPI_Iallreduce, (&localStep, &sum, 1, MpiDataType<int>(), MPI_SUM, comms, &request));
+          }
+
+          void PostReduce()
+          {
+            ++reductionCount;
+            result = sum;
+          }
+
+        private:
+          int localStep;
+          int sum;
+      };
+
+      class CollectiveActionTests : public helpers::HasCommsTestFixture
+      {
+          CPPUNIT_TEST_SUITE (CollectiveActionTests);
+          CPPUNIT_TEST (TestCompletedStepsLater);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void TestCompletedStepsLater()
+          {
+            Net net(Comms());
+            lb::SimulationState state(0.0001, 1000);
+            StepSummer summer(&net, &state);
+
+            // Started at step 0 and completed at step 2, when the next one is started.
+            summer.EndIteration();
+            state.Increment();
+            summer.EndIteration();
+            CPPUNIT_ASSERT_EQUAL(0, summer.reductionCount);
+
+            state.Increment();
+            summer.EndIteration();
+            CPPUNIT_ASSERT_EQUAL(1, summer.reductionCount);
+            CPPUNIT_ASSERT_EQUAL(0, summer.result);
+
+            state.Increment();
+            state.Increment();
+            summer.EndIteration();
+            CPPUNIT_ASSERT_EQUAL(2, summer.reductionCount);
+            CPPUNIT_ASSERT_EQUAL(2 * Comms().Size(), summer.result);
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (CollectiveActionTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_NET_COLLECTIVEACTIONTESTS_H */
@@ -0,0 +1,133 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_NET_COMMSSTATISTICSTESTS_H
+#define HEMELB_UNITTESTS_NET_COMMSSTATISTICSTESTS_H
+
+#include <cppunit/TestFixture.h>
+#include <sstream>
+#include <typeinfo>
+#include <ctemplate/template.h>
+#include "net/net.h"
+#include "net/CommsStatistics.h"
+#include "unittests/helpers/HasCommsTestFixture.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace net
+    {
+      using namespace hemelb::net;
+
+      class CommsStatisticsTests : public helpers::HasCommsTestFixture
+      {
+          CPPUNIT_TEST_SUITE (CommsStatisticsTests);
+          CPPUNIT_TEST (TestCountsForEachPeerAndConcern);
+          CPPUNIT_TEST (TestWaitGoesToPendingMessages);
+          CPPUNIT_TEST (TestNetRecordsItsMessages);
+          CPPUNIT_TEST (TestReduce);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void TestCountsForEachPeerAndConcern()
+          {
+            CommsStatistics statistics(Comms());
+            const char* concern = typeid(CommsStatisticsTests).name();
+
+            statistics.RecordSend(1, 80);
+            statistics.SetCurrentConcern(concern);
+            statistics.RecordSend(1, 16);
+            statistics.RecordReceive(2, 24);
+            statistics.RecordReceive(2, 8);
+
+            const CommsStatistics::Counts& one = statistics.GetPeerCounts().find(1)->second;
+            CPPUNIT_ASSERT_EQUAL(2lu, one.sentMessages);
+            CPPUNIT_ASSERT_EQUAL(96llu, one.sentBytes);
+            CPPUNIT_ASSERT_EQUAL(0lu, one.receivedMessages);
+            const CommsStatistics::Counts& two = statistics.GetPeerCounts().find(2)->second;
+            CPPUNIT_ASSERT_EQUAL(2lu, two.receivedMessages);
+            CPPUNIT_ASSERT_EQUAL(32llu, two.receivedBytes);
+
+            CPPUNIT_ASSERT_EQUAL((size_t) 2, statistics.GetConcernCounts().size());
+            const CommsStatistics::Counts& none = statistics.GetConcernCounts().find(NULL)->second;
+            CPPUNIT_ASSERT_EQUAL(1lu, none.sentMessages);
+            CPPUNIT_ASSERT_EQUAL(80llu, none.sentBytes);
+            const CommsStatistics::Counts& ours = statistics.GetConcernCounts().find(concern)->second;
+            CPPUNIT_ASSERT_EQUAL(1lu, ours.sentMessages);
+            CPPUNIT_ASSERT_EQUAL(2lu, ours.receivedMessages);
+            CPPUNIT_ASSERT_EQUAL(32llu, ours.receivedBytes);
+          }
+
+          void TestWaitGoesToPendingMessages()
+          {
+            CommsStatistics statistics(Comms());
+            statistics.RecordSend(1, 8);
+            statistics.RecordReceive(2, 8);
+            statistics.RecordWait(0.5);
+            statistics.RecordSend(2, 8);
+            statistics.RecordWait(0.25);
+            // Nothing pending, so this wait is for no peer.
+            statistics.RecordWait(1.0);
+
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, statistics.GetPeerCounts().find(1)->second.waitTime, 1e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.75, statistics.GetPeerCounts().find(2)->second.waitTime, 1e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.75,
+                                         statistics.GetConcernCounts().find(NULL)->second.waitTime,
+                                         1e-12);
+          }
+
+          void TestNetRecordsItsMessages()
+          {
+            Net net(Comms());
+            CommsStatistics statistics(Comms());
+            net.SetStatistics(&statistics);
+            const proc_t self = Comms().Rank();
+            std::vector<double> payload(3, 1.5);
+            std::vector<double> received(3, 0.0);
+
+            net.RequestSendV(payload, self);
+            net.RequestReceiveV(received, self);
+            net.Dispatch();
+
+            CPPUNIT_ASSERT_EQUAL(1.5, received[2]);
+            const CommsStatistics::Counts& counts = statistics.GetPeerCounts().find(self)->second;
+            CPPUNIT_ASSERT_EQUAL(1lu, counts.sentMessages);
+            CPPUNIT_ASSERT_EQUAL(1lu, counts.receivedMessages);
+            CPPUNIT_ASSERT_EQUAL(3 * sizeof(double), (size_t) counts.sentBytes);
+            CPPUNIT_ASSERT_EQUAL(3 * sizeof(double), (size_t) counts.receivedBytes);
+            CPPUNIT_ASSERT(counts.waitTime >= 0.0);
+          }
+
+          void TestReduce()
+          {
+            CommsStatistics statistics(Comms());
+            statistics.RecordSend(Comms().Rank(), 8);
+            statistics.Reduce("");
+
+            if (Comms().OnIORank())
+            {
+              ctemplate::TemplateDictionary dictionary("test");
+              statistics.Report(dictionary);
+              const std::string concerns = "{{#COMMS_CONCERN}}{{NAME}}:{{SENT_MESSAGES}} {{/COMMS_CONCERN}}";
+              ctemplate::StringToTemplateCache("TestForCommsConcern", concerns, ctemplate::DO_NOT_STRIP);
+              std::string result;
+              CPPUNIT_ASSERT(ctemplate::ExpandTemplate("TestForCommsConcern",
+                                                       ctemplate::DO_NOT_STRIP,
+                                                       &dictionary,
+                                                       &result));
+              std::stringstream expectation;
+              expectation << "none:" << Comms().Size() << " ";
+              CPPUNIT_ASSERT_EQUAL(expectation.str(), result);
+            }
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (CommsStatisticsTests);
+    }
+  }
+}
+
+#endif // HEMELB_UNITTESTS_NET_COMMSSTATISTICSTESTS_H
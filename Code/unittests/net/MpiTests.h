@@ -7,6 +7,7 @@
 #ifndef HEMELB_UNITTESTS_NET_MPITESTS_H
 #define HEMELB_UNITTESTS_NET_MPITESTS_H
 
+#include <limits>
 #include <cppunit/TestFixture.h>
 #include "net/mpi.h"
 
@@ -27,6 +28,10 @@ namespace hemelb
         public:
         CPPUNIT_TEST_SUITE (MpiTests);
         CPPUNIT_TEST (TestMpiComm);
+        CPPUNIT_TEST (TestDistGraphAdjacent);
+        CPPUNIT_TEST (TestExScan);
+        CPPUNIT_TEST (TestGatherV);
+        CPPUNIT_TEST (TestLargeCount);
         CPPUNIT_TEST_SUITE_END();
 
           void TestMpiComm()
@@ -57,6 +62,103 @@ namespace hemelb
               CPPUNIT_ASSERT(commWorld2 != commWorld);
             }
           }
+
+          void TestDistGraphAdjacent()
+          {
+            MpiCommunicator commWorld = MpiCommunicator::World();
+
+            // With one task, the only neighbour we can have is ourself.
+            std::vector<int> neighbours(1, commWorld.Rank());
+            std::vector<int> weights(1, 2);
+            MpiCommunicator graph = commWorld.DistGraphAdjacent(neighbours, weights, false);
+            CPPUNIT_ASSERT(graph);
+            CPPUNIT_ASSERT(graph != commWorld);
+
+            int inDegree, outDegree, weighted;
+            MPI_Dist_graph_neighbors_count(graph, &inDegree, &outDegree, &weighted);
+            CPPUNIT_ASSERT_EQUAL(1, inDegree);
+            CPPUNIT_ASSERT_EQUAL(1, outDegree);
+            CPPUNIT_ASSERT(weighted);
+
+            double sent[2] = { 1.5, -2.0 };
+            double received[2] = { 0.0, 0.0 };
+            int counts[1] = { 2 };
+            int displacements[1] = { 0 };
+            MPI_Request request;
+            MPI_Ineighbor_alltoallv(sent, counts, displacements, MPI_DOUBLE, received, counts, displacements,
+                                    MPI_DOUBLE, graph, &request);
+            MPI_Wait(&request, MPI_STATUS_IGNORE);
+            CPPUNIT_ASSERT_EQUAL(1.5, received[0]);
+            CPPUNIT_ASSERT_EQUAL(-2.0, received[1]);
+
+            // No neighbours at all is fine too.
+            MpiCommunicator lonely = commWorld.DistGraphAdjacent(std::vector<int>(), std::vector<int>(), true);
+            CPPUNIT_ASSERT(lonely);
+          }
+
+          void TestExScan()
+          {
+            MpiCommunicator commWorld = MpiCommunicator::World();
+
+            // The sum of the ranks below this one.
+            const uint64_t expected = uint64_t(commWorld.Rank()) * (commWorld.Rank() - 1) / 2;
+            CPPUNIT_ASSERT_EQUAL(expected, commWorld.ExScan(uint64_t(commWorld.Rank()), MPI_SUM));
+          }
+
+          void TestGatherV()
+          {
+            MpiCommunicator commWorld = MpiCommunicator::World();
+
+            // Each rank sends as many values as its rank plus one, all equal to its rank.
+            std::vector<float> sent(commWorld.Rank() + 1, float(commWorld.Rank()));
+            std::vector<float> gathered = commWorld.GatherV(sent, 0);
+
+            if (commWorld.Rank() != 0)
+            {
+              CPPUNIT_ASSERT(gathered.empty());
+              return;
+            }
+
+            CPPUNIT_ASSERT_EQUAL(size_t(commWorld.Size() * (commWorld.Size() + 1) / 2), gathered.size());
+            size_t value = 0;
+            for (int rank = 0; rank < commWorld.Size(); ++rank)
+            {
+              for (int count = 0; count <= rank; ++count, ++value)
+              {
+                CPPUNIT_ASSERT_EQUAL(float(rank), gathered[value]);
+              }
+            }
+          }
+
+          void TestLargeCount()
+          {
+            // Counts in an int's range are passed as they are.
+            LargeCount small(1000, MPI_DOUBLE);
+            CPPUNIT_ASSERT_EQUAL(1000, small.Count());
+            CPPUNIT_ASSERT(small.Type() == MPI_DOUBLE);
+
+            // Beyond it, they're one of a type covering all the elements, with the whole chunks
+            // and the remainder straight after each other.
+            const size_t elements = size_t(std::numeric_limits<int>::max()) * 2 + 5;
+            LargeCount large(elements, MPI_DOUBLE);
+            CPPUNIT_ASSERT_EQUAL(1, large.Count());
+            MPI_Count size;
+            MPI_Type_size_x(large.Type(), &size);
+            CPPUNIT_ASSERT_EQUAL(MPI_Count(elements * sizeof(double)), size);
+            MPI_Count lowerBound, extent;
+            MPI_Type_get_extent_x(large.Type(), &lowerBound, &extent);
+            CPPUNIT_ASSERT_EQUAL(MPI_Count(0), lowerBound);
+            CPPUNIT_ASSERT_EQUAL(size, extent);
+
+            // The same message always gets the same type.
+            LargeCount again(elements, MPI_DOUBLE);
+            CPPUNIT_ASSERT(again.Type() == large.Type());
+            LargeCount exact(size_t(std::numeric_limits<int>::max()) * 2, MPI_DOUBLE);
+            CPPUNIT_ASSERT(exact.Type() != large.Type());
+            MPI_Type_size_x(exact.Type(), &size);
+            CPPUNIT_ASSERT_EQUAL(MPI_Count(size_t(std::numeric_limits<int>::max()) * 2 * sizeof(double)),
+                                 size);
+          }
       };
       CPPUNIT_TEST_SUITE_REGISTRATION (MpiTests);
     }
@@ -0,0 +1,135 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_NET_PERSISTENTPOINTPOINTTESTS_H
+#define HEMELB_UNITTESTS_NET_PERSISTENTPOINTPOINTTESTS_H
+
+#include <cppunit/TestFixture.h>
+#include "net/mixins/mixins.h"
+#include "unittests/helpers/HasCommsTestFixture.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace net
+    {
+      using namespace hemelb::net;
+
+      class PersistentNet : public PersistentPointPoint,
+                            public InterfaceDelegationNet,
+                            public SeparatedAllToAll,
+                            public SeparatedGathers
+      {
+        public:
+          PersistentNet(const MpiCommunicator &communicator) :
+              BaseNet(communicator), StoringNet(communicator), PersistentPointPoint(communicator),
+                  InterfaceDelegationNet(communicator), SeparatedAllToAll(communicator),
+                  SeparatedGathers(communicator)
+          {
+          }
+      };
+
+      /**
+       * Tests of the persistent point-to-point comms. With a single task we can only talk to
+       * ourselves, but that still goes through the persistent requests.
+       */
+      class PersistentPointPointTests : public helpers::HasCommsTestFixture
+      {
+          CPPUNIT_TEST_SUITE (PersistentPointPointTests);
+          CPPUNIT_TEST (TestRepeatedPattern);
+          CPPUNIT_TEST (TestChangingPattern);
+          CPPUNIT_TEST (TestProgress);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void TestRepeatedPattern()
+          {
+            PersistentNet net(Comms());
+            const proc_t self = Comms().Rank();
+            int payload;
+            int received;
+
+            // The same buffers every time, so the requests made for the first Dispatch should
+            // be reused, picking up the new values.
+            for (int iteration = 0; iteration < 3; ++iteration)
+            {
+              payload = 10 + iteration;
+              received = -1;
+              net.RequestSendR(payload, self);
+              net.RequestReceiveR(received, self);
+              net.Dispatch();
+              CPPUNIT_ASSERT_EQUAL(10 + iteration, received);
+            }
+          }
+
+          void TestChangingPattern()
+          {
+            PersistentNet net(Comms());
+            const proc_t self = Comms().Rank();
+            std::vector<double> payload(3, 1.5);
+            std::vector<double> received(3, 0.0);
+            double otherPayload = 4.0;
+            double otherReceived = 0.0;
+
+            net.RequestSendV(payload, self);
+            net.RequestReceiveV(received, self);
+            net.Dispatch();
+            CPPUNIT_ASSERT_EQUAL(1.5, received[2]);
+
+            // A different pattern on the next Dispatch...
+            net.RequestSendR(otherPayload, self);
+            net.RequestReceiveR(otherReceived, self);
+            net.Dispatch();
+            CPPUNIT_ASSERT_EQUAL(4.0, otherReceived);
+
+            // ...and then back to the first one.
+            payload[2] = 2.5;
+            net.RequestSendV(payload, self);
+            net.RequestReceiveV(received, self);
+            net.Dispatch();
+            CPPUNIT_ASSERT_EQUAL(2.5, received[2]);
+
+            // A Dispatch with nothing to do is fine too.
+            net.Dispatch();
+          }
+
+          void TestProgress()
+          {
+            PersistentNet net(Comms());
+            const proc_t self = Comms().Rank();
+            int payload;
+            int received;
+
+            // Progress before anything has been requested does nothing.
+            net.Progress();
+
+            // Requests that Progress finishes must still be fine to Wait for, and to start
+            // again on the next step.
+            for (int iteration = 0; iteration < 2; ++iteration)
+            {
+              payload = 20 + iteration;
+              received = -1;
+              net.RequestSendR(payload, self);
+              net.RequestReceiveR(received, self);
+              net.Receive();
+              net.Send();
+              for (int chunk = 0; chunk < 4; ++chunk)
+              {
+                net.Progress();
+              }
+              net.Wait();
+              CPPUNIT_ASSERT_EQUAL(20 + iteration, received);
+            }
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (PersistentPointPointTests);
+    }
+  }
+}
+
+#endif
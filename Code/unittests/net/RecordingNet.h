@@ -147,6 +147,13 @@ namespace hemelb
             }
           }
 
+          /**
+           * Nothing to progress, as nothing is really sent.
+           */
+          void ProgressPointToPoint()
+          {
+          }
+
           /**
            * Mock-wait - clears the message queue
            */
@@ -0,0 +1,155 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_NET_RMAPOINTPOINTTESTS_H
+#define HEMELB_UNITTESTS_NET_RMAPOINTPOINTTESTS_H
+
+#include <cppunit/TestFixture.h>
+#include "net/mixins/mixins.h"
+#include "unittests/helpers/HasCommsTestFixture.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace net
+    {
+      using namespace hemelb::net;
+
+      class RmaNet : public RmaPointPoint,
+                     public InterfaceDelegationNet,
+                     public SeparatedAllToAll,
+                     public SeparatedGathers
+      {
+        public:
+          RmaNet(const MpiCommunicator &communicator) :
+              BaseNet(communicator), StoringNet(communicator), RmaPointPoint(communicator),
+                  InterfaceDelegationNet(communicator), SeparatedAllToAll(communicator),
+                  SeparatedGathers(communicator)
+          {
+          }
+      };
+
+      /**
+       * Tests of the one-sided point-to-point comms. With a single task we can only put into
+       * our own window, but that still goes through the epochs and the regions.
+       */
+      class RmaPointPointTests : public helpers::HasCommsTestFixture
+      {
+          CPPUNIT_TEST_SUITE (RmaPointPointTests);
+          CPPUNIT_TEST (TestRepeatedPattern);
+          CPPUNIT_TEST (TestChangingSize);
+          CPPUNIT_TEST (TestNonContiguous);
+          CPPUNIT_TEST (TestProgress);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void TestRepeatedPattern()
+          {
+            RmaNet net(Comms());
+            const proc_t self = Comms().Rank();
+            int payload;
+            int received[3];
+
+            // The region made for the first Dispatch should be reused, even though the
+            // receive buffer moves between Dispatches.
+            for (int iteration = 0; iteration < 3; ++iteration)
+            {
+              payload = 10 + iteration;
+              received[iteration] = -1;
+              net.RequestSendR(payload, self);
+              net.RequestReceiveR(received[iteration], self);
+              net.Dispatch();
+              CPPUNIT_ASSERT_EQUAL(10 + iteration, received[iteration]);
+            }
+          }
+
+          void TestChangingSize()
+          {
+            RmaNet net(Comms());
+            const proc_t self = Comms().Rank();
+            std::vector<double> payload(3, 1.5);
+            std::vector<double> received(3, 0.0);
+            double otherPayload = 4.0;
+            double otherReceived = 0.0;
+
+            net.RequestSendV(payload, self);
+            net.RequestReceiveV(received, self);
+            net.Dispatch();
+            CPPUNIT_ASSERT_EQUAL(1.5, received[2]);
+
+            // A different size on the next Dispatch...
+            net.RequestSendR(otherPayload, self);
+            net.RequestReceiveR(otherReceived, self);
+            net.Dispatch();
+            CPPUNIT_ASSERT_EQUAL(4.0, otherReceived);
+
+            // ...and then back to the first one.
+            payload[2] = 2.5;
+            net.RequestSendV(payload, self);
+            net.RequestReceiveV(received, self);
+            net.Dispatch();
+            CPPUNIT_ASSERT_EQUAL(2.5, received[2]);
+
+            // A Dispatch with nothing to do is fine too.
+            net.Dispatch();
+          }
+
+          void TestNonContiguous()
+          {
+            RmaNet net(Comms());
+            const proc_t self = Comms().Rank();
+            MPI_Datatype everyOther;
+            MPI_Type_vector(3, 1, 2, MPI_INT, &everyOther);
+            MPI_Type_commit(&everyOther);
+
+            int payload[3] = { 0, 2, 4 };
+            int received[6] = { -1, -1, -1, -1, -1, -1 };
+            int lastPayload = 6;
+            int lastReceived = -1;
+            // Unpacked and copied data, one after the other in the same region.
+            net.RequestSend(payload, 3, self);
+            net.RequestSendR(lastPayload, self);
+            net.RequestReceiveDerived(received, everyOther, self);
+            net.RequestReceiveR(lastReceived, self);
+            net.Dispatch();
+
+            CPPUNIT_ASSERT_EQUAL(4, received[4]);
+            CPPUNIT_ASSERT_EQUAL(-1, received[5]);
+            CPPUNIT_ASSERT_EQUAL(6, lastReceived);
+            MPI_Type_free(&everyOther);
+          }
+
+          void TestProgress()
+          {
+            RmaNet net(Comms());
+            const proc_t self = Comms().Rank();
+            int payload;
+            int received;
+
+            // Progress before anything has been requested does nothing.
+            net.Progress();
+
+            for (int iteration = 0; iteration < 2; ++iteration)
+            {
+              payload = 20 + iteration;
+              received = -1;
+              net.RequestSendR(payload, self);
+              net.RequestReceiveR(received, self);
+              net.Receive();
+              net.Send();
+              net.Progress();
+              net.Wait();
+              CPPUNIT_ASSERT_EQUAL(20 + iteration, received);
+            }
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (RmaPointPointTests);
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,157 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_NET_SELECTABLEPOINTPOINTTESTS_H
+#define HEMELB_UNITTESTS_NET_SELECTABLEPOINTPOINTTESTS_H
+
+#include <cppunit/TestFixture.h>
+#include "net/mixins/mixins.h"
+#include "net/CommsAutotuner.h"
+#include "unittests/helpers/HasCommsTestFixture.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace net
+    {
+      using namespace hemelb::net;
+
+      class SelectableNet : public SelectablePointPoint,
+                            public InterfaceDelegationNet,
+                            public SelectableAllToAll,
+                            public SelectableGathers
+      {
+        public:
+          SelectableNet(const MpiCommunicator &communicator) :
+              BaseNet(communicator), StoringNet(communicator), SelectablePointPoint(communicator),
+                  InterfaceDelegationNet(communicator), SelectableAllToAll(communicator),
+                  SelectableGathers(communicator)
+          {
+          }
+      };
+
+      /**
+       * Tests of the comms chosen at run time. With a single task we can only talk to ourselves,
+       * but that still goes through whichever implementation is chosen.
+       */
+      class SelectablePointPointTests : public helpers::HasCommsTestFixture
+      {
+          CPPUNIT_TEST_SUITE (SelectablePointPointTests);
+          CPPUNIT_TEST (TestParse);
+          CPPUNIT_TEST (TestSwitchBetweenDispatches);
+          CPPUNIT_TEST (TestSwitchCollectives);
+          CPPUNIT_TEST (TestAutotune);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void TestParse()
+          {
+            CommsStrategy::PointPoint pointPoint;
+            CPPUNIT_ASSERT(CommsStrategy::ParsePointPoint("Persistent", pointPoint));
+            CPPUNIT_ASSERT_EQUAL(CommsStrategy::PointPointPersistent, pointPoint);
+            CPPUNIT_ASSERT(CommsStrategy::ParsePointPoint("Coalesce", pointPoint));
+            CPPUNIT_ASSERT_EQUAL(CommsStrategy::PointPointCoalesce, pointPoint);
+            // Rma can't be switched to, as its window is made collectively.
+            CPPUNIT_ASSERT(!CommsStrategy::ParsePointPoint("Rma", pointPoint));
+            CPPUNIT_ASSERT(!CommsStrategy::ParsePointPoint("persistent", pointPoint));
+            CPPUNIT_ASSERT_EQUAL(std::string("Persistent"),
+                                 std::string(CommsStrategy::GetName(CommsStrategy::PointPointPersistent)));
+
+            CommsStrategy::Collective collective;
+            CPPUNIT_ASSERT(CommsStrategy::ParseCollective("ViaPointPoint", collective));
+            CPPUNIT_ASSERT_EQUAL(CommsStrategy::CollectiveViaPointPoint, collective);
+            CPPUNIT_ASSERT(!CommsStrategy::ParseCollective("Coalesce", collective));
+          }
+
+          void TestSwitchBetweenDispatches()
+          {
+            SelectableNet net(Comms());
+            const proc_t self = Comms().Rank();
+            std::vector<double> payload(3, 0.0);
+            std::vector<double> received(3, 0.0);
+            // Not the immediate comms, whose synchronous send to ourselves would never finish.
+            const CommsStrategy::PointPoint strategies[] = { CommsStrategy::PointPointCoalesce,
+                                                             CommsStrategy::PointPointSeparated,
+                                                             CommsStrategy::PointPointPersistent,
+                                                             CommsStrategy::PointPointCoalesce };
+
+            // Each Dispatch with a different implementation, and back to the first.
+            for (unsigned strategy = 0; strategy < 4; ++strategy)
+            {
+              net.SetPointPointStrategy(strategies[strategy]);
+              CPPUNIT_ASSERT_EQUAL(strategies[strategy], net.GetPointPointStrategy());
+              payload[2] = 1.5 + strategy;
+              net.RequestSendV(payload, self);
+              net.RequestReceiveV(received, self);
+              net.Dispatch();
+              CPPUNIT_ASSERT_EQUAL(1.5 + strategy, received[2]);
+            }
+          }
+
+          void TestSwitchCollectives()
+          {
+            SelectableNet net(Comms());
+            const proc_t self = Comms().Rank();
+            std::vector<int> gathered(Comms().Size(), -1);
+            int value = 7;
+            // The gathers via point-to-point need the receives to be made after the sends, as the
+            // separated point-to-point comms allow.
+            net.SetPointPointStrategy(CommsStrategy::PointPointSeparated);
+
+            const CommsStrategy::Collective strategies[] = { CommsStrategy::CollectiveSeparated,
+                                                             CommsStrategy::CollectiveViaPointPoint };
+            for (unsigned strategy = 0; strategy < 2; ++strategy)
+            {
+              net.SetGathersStrategy(strategies[strategy]);
+              net.SetAllToAllStrategy(strategies[strategy]);
+              value = 7 + strategy;
+              net.RequestGatherSend(value, 0);
+              if (self == 0)
+              {
+                net.RequestGatherReceive(gathered);
+              }
+              net.Dispatch();
+              if (self == 0)
+              {
+                CPPUNIT_ASSERT_EQUAL(int(7 + strategy), gathered[0]);
+              }
+            }
+          }
+
+          void TestAutotune()
+          {
+            CommsAutotuner autotuner(Comms());
+            CPPUNIT_ASSERT(autotuner.GetTimings().empty());
+
+            std::map<proc_t, site_t> distributionsForEachNeighbour;
+            distributionsForEachNeighbour[Comms().Rank()] = 100;
+            CommsStrategy::PointPoint fastest = autotuner.Tune(distributionsForEachNeighbour, 3);
+
+            // Every candidate but the immediate comms is tried, and the fastest chosen.
+            CPPUNIT_ASSERT_EQUAL(size_t(3), autotuner.GetTimings().size());
+            CPPUNIT_ASSERT(fastest != CommsStrategy::PointPointImmediate);
+            for (unsigned candidate = 0; candidate < autotuner.GetTimings().size(); ++candidate)
+            {
+              CPPUNIT_ASSERT(autotuner.GetTimings()[candidate].second >= 0.0);
+              if (autotuner.GetTimings()[candidate].first == fastest)
+              {
+                for (unsigned other = 0; other < autotuner.GetTimings().size(); ++other)
+                {
+                  CPPUNIT_ASSERT(autotuner.GetTimings()[candidate].second
+                      <= autotuner.GetTimings()[other].second);
+                }
+              }
+            }
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (SelectablePointPointTests);
+    }
+  }
+}
+
+#endif
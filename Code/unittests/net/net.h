@@ -9,5 +9,10 @@
 
 #include "unittests/net/phased/phased.h"
 #include "unittests/net/MpiTests.h"
+#include "unittests/net/PersistentPointPointTests.h"
+#include "unittests/net/SelectablePointPointTests.h"
+#include "unittests/net/RmaPointPointTests.h"
+#include "unittests/net/CollectiveActionTests.h"
+#include "unittests/net/CommsStatisticsTests.h"
 
 #endif
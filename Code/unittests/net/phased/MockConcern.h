@@ -6,6 +6,8 @@
 
 #ifndef HEMELB_UNITTESTS_NET_PHASED_MOCKCONCERN_H
 #define HEMELB_UNITTESTS_NET_PHASED_MOCKCONCERN_H
+#include <string>
+#include <vector>
 #include "net/phased/Concern.h"
 namespace hemelb
 {
@@ -19,8 +21,13 @@ namespace hemelb
         class MockConcern : public Concern
         {
           public:
-            MockConcern(const std::string &name) :
-                calls(), name(name)
+            /**
+             * @param name
+             * @param order If given, the name is added to it on each call, to check the order
+             * of the calls to several concerns.
+             */
+            MockConcern(const std::string &name, std::vector<std::string> *order = NULL) :
+                calls(), name(name), order(order)
             {
             }
 
@@ -28,6 +35,10 @@ namespace hemelb
             {
               // this is where a real concern would switch on the action, and call the appropriate method
               calls.push_back(action);
+              if (order != NULL)
+              {
+                order->push_back(name);
+              }
               return true;
             }
 
@@ -39,6 +50,7 @@ namespace hemelb
           private:
             std::vector<int> calls;
             std::string name;
+            std::vector<std::string> *order;
         };
       }
     }
@@ -46,6 +46,11 @@ namespace hemelb
             CPPUNIT_TEST (TestCallAllActionsManyPhases);
             CPPUNIT_TEST (TestCallAllActionsPhaseByPhase);
 
+            CPPUNIT_TEST (TestCallPeriodicActor);
+            CPPUNIT_TEST (TestDependencyOrder);
+            CPPUNIT_TEST (TestIndependentConcernOverlapsComms);
+            CPPUNIT_TEST (TestDependencyCycle);
+
             CPPUNIT_TEST_SUITE_END();
 
           public:
@@ -270,6 +275,88 @@ namespace hemelb
               netMock->ExpectationsAllCompleted();
             }
 
+            void TestCallPeriodicActor()
+            {
+              action = new MockIteratedAction("mockOne");
+              action2 = new MockIteratedAction("mockTwo");
+
+              stepManager->RegisterIteratedActorSteps(*action, 0, 3);
+              stepManager->RegisterIteratedActorSteps(*action2, 0);
+
+              // The periodic actor is called on the first iteration and every third one after that.
+              for (unsigned int iteration = 0; iteration < 4; iteration++)
+              {
+                stepManager->CallActions();
+              }
+              CPPUNIT_ASSERT_EQUAL(4lu, stepManager->GetIteration());
+
+              std::string oneIteration("RequestComms, PreSend, PreReceive, PostReceive, EndIteration, ");
+              CPPUNIT_ASSERT_EQUAL(oneIteration + oneIteration, action->CallsSoFar());
+              CPPUNIT_ASSERT_EQUAL(oneIteration + oneIteration + oneIteration + oneIteration,
+                                   action2->CallsSoFar());
+            }
+
+            void TestDependencyOrder()
+            {
+              std::vector<std::string> order;
+              MockConcern second("second", &order);
+              MockConcern first("first", &order);
+
+              stepManager->Register(0, steps::PreSend, second, 0);
+              stepManager->Register(0, steps::PreSend, first, 0);
+              stepManager->DeclareDependency(second, first);
+
+              // Without dependency scheduling, the order of registration is kept.
+              stepManager->CallActions();
+              stepManager->SetDependencyScheduling(true);
+              stepManager->CallActions();
+
+              std::vector<std::string> expected;
+              expected.push_back("second");
+              expected.push_back("first");
+              expected.push_back("first");
+              expected.push_back("second");
+              CPPUNIT_ASSERT(expected == order);
+            }
+
+            void TestIndependentConcernOverlapsComms()
+            {
+              std::vector<std::string> order;
+              MockConcern comms("comms", &order);
+              MockConcern independent("independent", &order);
+              MockConcern dependent("dependent", &order);
+
+              stepManager->RegisterCommsSteps(comms, 0);
+              stepManager->Register(0, steps::EndPhase, dependent, 0);
+              stepManager->Register(0, steps::EndPhase, independent, 0);
+              stepManager->DeclareDependency(dependent, comms);
+              stepManager->SetDependencyScheduling(true);
+              stepManager->CallActions();
+
+              // The independent concern finishes before the communication is waited for.
+              std::vector<std::string> expected;
+              expected.push_back("comms");
+              expected.push_back("comms");
+              expected.push_back("independent");
+              expected.push_back("comms");
+              expected.push_back("dependent");
+              CPPUNIT_ASSERT(expected == order);
+              CPPUNIT_ASSERT_EQUAL(steps::Wait, static_cast<steps::Step>(comms.ActionsCalled().back()));
+            }
+
+            void TestDependencyCycle()
+            {
+              MockConcern first("first");
+              MockConcern second("second");
+
+              stepManager->Register(0, steps::PreSend, first, 0);
+              stepManager->Register(0, steps::PreSend, second, 0);
+              stepManager->DeclareDependency(first, second);
+              stepManager->DeclareDependency(second, first);
+              stepManager->SetDependencyScheduling(true);
+              CPPUNIT_ASSERT_THROW(stepManager->CallActions(), hemelb::Exception);
+            }
+
             void TestCallAllActionsManyPhases()
             {
 
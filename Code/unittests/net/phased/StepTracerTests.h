@@ -0,0 +1,110 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_NET_PHASED_STEPTRACERTESTS_H
+#define HEMELB_UNITTESTS_NET_PHASED_STEPTRACERTESTS_H
+#include "net/phased/StepManager.h"
+#include "net/phased/StepTracer.h"
+#include "unittests/helpers/HasCommsTestFixture.h"
+#include "unittests/net/phased/MockConcern.h"
+#include "unittests/net/phased/MockIteratedAction.h"
+#include <cppunit/TestFixture.h>
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace net
+    {
+      namespace phased
+      {
+        using namespace hemelb::net::phased;
+        class StepTracerTests : public helpers::HasCommsTestFixture
+        {
+            CPPUNIT_TEST_SUITE (StepTracerTests);
+            CPPUNIT_TEST (TestRecordsOnlyTheWindow);
+            CPPUNIT_TEST (TestRingBufferKeepsLatest);
+            CPPUNIT_TEST (TestChromeTraceEvents);
+            CPPUNIT_TEST_SUITE_END();
+
+          public:
+            void TestRecordsOnlyTheWindow()
+            {
+              StepManager stepManager(1);
+              StepTracer tracer(Comms(), 2, 3);
+              MockIteratedAction action("mockOne");
+              stepManager.RegisterIteratedActorSteps(action);
+              stepManager.SetTracer(&tracer);
+
+              for (unsigned long timeStep = 1; timeStep <= 4; timeStep++)
+              {
+                tracer.BeginTimeStep(timeStep);
+                stepManager.CallActions();
+              }
+
+              // Each time step has nine steps, from BeginAll to EndAll, and the actor acts in five.
+              CPPUNIT_ASSERT_EQUAL((size_t) 28, tracer.GetEventCount());
+              CPPUNIT_ASSERT_EQUAL((size_t) 0, tracer.GetDroppedCount());
+              for (size_t index = 0; index < tracer.GetEventCount(); index++)
+              {
+                const StepTracer::Event& event = tracer.GetEvent(index);
+                CPPUNIT_ASSERT_EQUAL(index < 14 ? 2lu : 3lu, event.timeStep);
+                CPPUNIT_ASSERT(event.begin <= event.end);
+              }
+
+              // The first step is BeginAll, in which the actor doesn't act; then comes BeginPhase,
+              // in which it does, recorded before the step that contains it.
+              CPPUNIT_ASSERT_EQUAL(steps::BeginAll, tracer.GetEvent(0).step);
+              CPPUNIT_ASSERT(tracer.GetEvent(0).concernType == NULL);
+              CPPUNIT_ASSERT_EQUAL(steps::BeginPhase, tracer.GetEvent(1).step);
+              CPPUNIT_ASSERT(tracer.GetEvent(1).concernType != NULL);
+              CPPUNIT_ASSERT_EQUAL(steps::BeginPhase, tracer.GetEvent(2).step);
+              CPPUNIT_ASSERT(tracer.GetEvent(2).concernType == NULL);
+              CPPUNIT_ASSERT(tracer.GetEvent(2).begin <= tracer.GetEvent(1).begin);
+              CPPUNIT_ASSERT(tracer.GetEvent(1).end <= tracer.GetEvent(2).end);
+            }
+
+            void TestRingBufferKeepsLatest()
+            {
+              StepTracer tracer(Comms(), 1, 1, 4);
+              tracer.BeginTimeStep(1);
+              for (int event = 0; event < 6; event++)
+              {
+                tracer.Record(0, steps::PreSend, NULL, event, event + 0.5);
+              }
+
+              CPPUNIT_ASSERT_EQUAL((size_t) 4, tracer.GetEventCount());
+              CPPUNIT_ASSERT_EQUAL((size_t) 2, tracer.GetDroppedCount());
+              for (size_t index = 0; index < 4; index++)
+              {
+                CPPUNIT_ASSERT_EQUAL(index + 2.0, tracer.GetEvent(index).begin);
+              }
+            }
+
+            void TestChromeTraceEvents()
+            {
+              StepTracer tracer(Comms(), 5, 5);
+              MockConcern concern("mockTwo");
+              tracer.BeginTimeStep(5);
+              tracer.Record(1, steps::Wait, &concern, 0.001, 0.003);
+              tracer.Record(1, steps::Wait, NULL, 0.0, 0.004);
+
+              const std::string events = tracer.GetChromeTraceEvents(7);
+              CPPUNIT_ASSERT(StepTracer::GetConcernName(typeid(concern).name()).find("MockConcern")
+                  != std::string::npos);
+              CPPUNIT_ASSERT(events.find("MockConcern\",\"cat\":\"Wait\",\"ph\":\"X\",\"ts\":1000.000,\"dur\":2000.000,\"pid\":7,\"tid\":1,\"args\":{\"timestep\":5}}")
+                  != std::string::npos);
+              CPPUNIT_ASSERT(events.find("{\"name\":\"Wait\",\"cat\":\"step\",\"ph\":\"X\",\"ts\":0.000,\"dur\":4000.000")
+                  != std::string::npos);
+            }
+        };
+
+        CPPUNIT_TEST_SUITE_REGISTRATION (StepTracerTests);
+      }
+    }
+  }
+}
+
+#endif // HEMELB_UNITTESTS_NET_PHASED_STEPTRACERTESTS_H
@@ -9,5 +9,6 @@
 
 #include "unittests/net/phased/StepManagerTests.h"
 #include "unittests/net/phased/ConcernTests.h"
+#include "unittests/net/phased/StepTracerTests.h"
 
 #endif //ONCE
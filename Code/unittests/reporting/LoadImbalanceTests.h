@@ -0,0 +1,103 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_REPORTING_LOADIMBALANCETESTS_H
+#define HEMELB_UNITTESTS_REPORTING_LOADIMBALANCETESTS_H
+
+#include <cppunit/TestFixture.h>
+#include "reporting/LoadImbalance.h"
+#include "unittests/helpers/HasCommsTestFixture.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace reporting
+    {
+      using namespace hemelb::reporting;
+      class LoadImbalanceTests : public helpers::HasCommsTestFixture
+      {
+          CPPUNIT_TEST_SUITE(LoadImbalanceTests);
+          CPPUNIT_TEST(TestSummarise);
+          CPPUNIT_TEST(TestSlowRanks);
+          CPPUNIT_TEST(TestReduce);
+          CPPUNIT_TEST_SUITE_END();
+        public:
+          void TestSummarise()
+          {
+            std::vector<double> values;
+            for (int value = 10; value >= 1; --value)
+            {
+              values.push_back(value);
+            }
+            LoadImbalance::Distribution distribution = LoadImbalance::Summarise(values);
+            CPPUNIT_ASSERT_EQUAL(1.0, distribution.min);
+            CPPUNIT_ASSERT_EQUAL(5.0, distribution.p50);
+            CPPUNIT_ASSERT_EQUAL(9.0, distribution.p90);
+            CPPUNIT_ASSERT_EQUAL(10.0, distribution.p99);
+            CPPUNIT_ASSERT_EQUAL(10.0, distribution.max);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(5.5, distribution.mean, 1e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(10.0 / 5.5, distribution.imbalance, 1e-12);
+          }
+
+          void TestSlowRanks()
+          {
+            // Four ranks: rank 1 has twice the work of the others and takes twice as long;
+            // rank 2 has the same work as ranks 0 and 3 but takes three times as long.
+            std::vector<site_t> sitesPerType(4 * COLLISION_TYPES, 0);
+            std::vector<double> quantities(4 * LoadImbalance::numberOfQuantities, 0.0);
+            const double work[] = { 100.0, 200.0, 100.0, 100.0 };
+            const double time[] = { 1.0, 2.0, 3.0, 1.0 };
+            for (unsigned rank = 0; rank < 4; ++rank)
+            {
+              sitesPerType[rank * COLLISION_TYPES] = site_t(work[rank]);
+              quantities[rank * LoadImbalance::numberOfQuantities + LoadImbalance::sites] = work[rank];
+              quantities[rank * LoadImbalance::numberOfQuantities + LoadImbalance::work] = work[rank];
+              quantities[rank * LoadImbalance::numberOfQuantities + LoadImbalance::collision] = time[rank];
+            }
+
+            std::vector<LoadImbalance::SlowRank> slowest = LoadImbalance::FindSlowRanks(sitesPerType,
+                                                                                        quantities,
+                                                                                        2);
+            CPPUNIT_ASSERT_EQUAL((size_t) 2, slowest.size());
+            CPPUNIT_ASSERT_EQUAL(2, slowest[0].rank);
+            CPPUNIT_ASSERT(slowest[0].slowNode);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.8, slowest[0].workRatio, 1e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, slowest[0].speedRatio, 1e-12);
+            CPPUNIT_ASSERT_EQUAL(1, slowest[1].rank);
+            CPPUNIT_ASSERT(!slowest[1].slowNode);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1.6, slowest[1].workRatio, 1e-12);
+            CPPUNIT_ASSERT_EQUAL((site_t) 200, slowest[1].sitesPerType[0]);
+          }
+
+          void TestReduce()
+          {
+            LoadImbalance imbalance(Comms());
+            Timers timings(Comms());
+            timings[Timers::lb_calc].Set(2.0);
+            std::vector<site_t> sitesPerType(COLLISION_TYPES, 1);
+            std::vector<int> weights(COLLISION_TYPES, 2);
+            imbalance.Reduce(sitesPerType, weights, timings, "");
+
+            if (Comms().OnIORank())
+            {
+              const LoadImbalance::Distribution& sites =
+                  imbalance.GetDistributions()[LoadImbalance::sites];
+              CPPUNIT_ASSERT_EQUAL(double(COLLISION_TYPES), sites.max);
+              CPPUNIT_ASSERT_EQUAL(1.0, sites.imbalance);
+              CPPUNIT_ASSERT_EQUAL(2.0 * COLLISION_TYPES,
+                                   imbalance.GetDistributions()[LoadImbalance::work].min);
+              CPPUNIT_ASSERT_EQUAL(2.0, imbalance.GetDistributions()[LoadImbalance::collision].p50);
+              CPPUNIT_ASSERT(!imbalance.GetSlowRanks().empty());
+            }
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION(LoadImbalanceTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_REPORTING_LOADIMBALANCETESTS_H */
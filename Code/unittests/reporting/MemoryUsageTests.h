@@ -0,0 +1,93 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_REPORTING_MEMORYUSAGETESTS_H
+#define HEMELB_UNITTESTS_REPORTING_MEMORYUSAGETESTS_H
+
+#include <cppunit/TestFixture.h>
+#include "reporting/MemoryUsage.h"
+#include "reporting/Performance.h"
+#include "util/utilityFunctions.h"
+#include "unittests/helpers/HasCommsTestFixture.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace reporting
+    {
+      using namespace hemelb::reporting;
+      class MemoryUsageTests : public helpers::HasCommsTestFixture
+      {
+          CPPUNIT_TEST_SUITE(MemoryUsageTests);
+          CPPUNIT_TEST(TestVectorBytes);
+          CPPUNIT_TEST(TestSubsystems);
+          CPPUNIT_TEST(TestStages);
+          CPPUNIT_TEST_SUITE_END();
+        public:
+          void TestVectorBytes()
+          {
+            std::vector<double> doubles;
+            doubles.reserve(10);
+            doubles.push_back(1.0);
+            CPPUNIT_ASSERT_EQUAL(10 * sizeof(double), util::VectorBytes(doubles));
+
+            std::vector<bool> bools;
+            CPPUNIT_ASSERT_EQUAL(size_t(0), util::VectorBytes(bools));
+          }
+
+          void TestSubsystems()
+          {
+            MemoryUsage memory(Comms());
+            memory.RecordSubsystem("distributions", 1000 * (Comms().Rank() + 1));
+            memory.RecordSubsystem("blocks", 10);
+            // Recording a subsystem again adds to it.
+            memory.RecordSubsystem("distributions", 24);
+            memory.Reduce();
+
+            if (Comms().OnIORank())
+            {
+              const std::vector<MemoryUsage::Record>& subsystems = memory.GetSubsystems();
+              const double ranks = Comms().Size();
+              CPPUNIT_ASSERT_EQUAL(size_t(2), subsystems.size());
+              CPPUNIT_ASSERT_EQUAL(std::string("distributions"), subsystems[0].name);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(1024.0, subsystems[0].min, 1e-9);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(1000.0 * ranks + 24.0, subsystems[0].max, 1e-9);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(1000.0 * ranks * (ranks + 1) / 2 + 24.0 * ranks,
+                                           subsystems[0].total,
+                                           1e-9);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(subsystems[0].total / ranks, subsystems[0].mean, 1e-9);
+              CPPUNIT_ASSERT_EQUAL(std::string("blocks"), subsystems[1].name);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(10.0 * ranks, subsystems[1].total, 1e-9);
+            }
+          }
+
+          void TestStages()
+          {
+            MemoryUsage memory(Comms());
+            memory.RecordStage("reading");
+            memory.RecordStage("lattice data");
+            memory.RecordStage("reading");
+            memory.Reduce();
+
+            if (Comms().OnIORank())
+            {
+              const std::vector<MemoryUsage::Record>& stages = memory.GetStages();
+              CPPUNIT_ASSERT_EQUAL(size_t(2), stages.size());
+              CPPUNIT_ASSERT_EQUAL(std::string("reading"), stages[0].name);
+              CPPUNIT_ASSERT(stages[0].min <= stages[0].mean);
+              CPPUNIT_ASSERT(stages[0].mean <= stages[0].max);
+              // The peak only grows.
+              CPPUNIT_ASSERT(stages[1].max <= stages[0].max);
+            }
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION(MemoryUsageTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_REPORTING_MEMORYUSAGETESTS_H */
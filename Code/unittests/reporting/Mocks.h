@@ -30,6 +30,95 @@ namespace hemelb
           double fakeTime;
       };
 
+      /**
+       * Counts a hundred cycles, two hundred instructions and three hundred cache misses each
+       * time an enabled timer runs.
+       */
+      class CounterMock
+      {
+        public:
+          static const bool Counting = true;
+
+          CounterMock() :
+              enabled(false), running(false), intervals(0)
+          {
+          }
+          void EnableCounters()
+          {
+            enabled = true;
+          }
+          bool HasCounts() const
+          {
+            return enabled;
+          }
+          double GetCount(hemelb::reporting::CounterName counter) const
+          {
+            return 100.0 * (counter + 1) * intervals;
+          }
+        protected:
+          void StartCounting()
+          {
+            running = enabled;
+          }
+          void StopCounting()
+          {
+            if (running)
+            {
+              intervals++;
+            }
+            running = false;
+          }
+        private:
+          bool enabled;
+          bool running;
+          unsigned int intervals;
+      };
+
+      /**
+       * Measures ten joules of package and two of DRAM energy each time an enabled timer runs.
+       */
+      class EnergyMock
+      {
+        public:
+          static const bool Measuring = true;
+
+          EnergyMock() :
+              enabled(false), running(false), intervals(0)
+          {
+          }
+          void EnableMeters()
+          {
+            enabled = true;
+          }
+          bool HasEnergy() const
+          {
+            return enabled;
+          }
+          double GetEnergy(hemelb::reporting::EnergyDomain domain) const
+          {
+            return (domain == hemelb::reporting::packageEnergy ?
+              10.0 :
+              2.0) * intervals;
+          }
+        protected:
+          void StartMetering()
+          {
+            running = enabled;
+          }
+          void StopMetering()
+          {
+            if (running)
+            {
+              intervals++;
+            }
+            running = false;
+          }
+        private:
+          bool enabled;
+          bool running;
+          unsigned int intervals;
+      };
+
       class MPICommsMock
       {
         public:
@@ -59,6 +148,10 @@ namespace hemelb
           {
             return 5;
           }
+          bool LeadsNode() const
+          {
+            return true;
+          }
         private:
           unsigned int calls;
       };
@@ -0,0 +1,50 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_REPORTING_PERFORMANCETESTS_H
+#define HEMELB_UNITTESTS_REPORTING_PERFORMANCETESTS_H
+
+#include <cppunit/TestFixture.h>
+#include "reporting/Performance.h"
+#include "unittests/helpers/HasCommsTestFixture.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace reporting
+    {
+      using namespace hemelb::reporting;
+      class PerformanceTests : public helpers::HasCommsTestFixture
+      {
+          CPPUNIT_TEST_SUITE(PerformanceTests);
+          CPPUNIT_TEST(TestThroughput);
+          CPPUNIT_TEST_SUITE_END();
+        public:
+          void TestThroughput()
+          {
+            Timers timings(Comms());
+            timings[Timers::simulation].Set(2.0);
+            timings[Timers::lb_calc].Set(0.5);
+            timings.Reduce();
+
+            Performance performance(Comms());
+            performance.Reduce(4000, 100, timings);
+            if (Comms().OnIORank())
+            {
+              // 4000 sites for 100 steps is 0.4 million updates.
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(0.2, performance.GetMlups(), 1e-12);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(0.8, performance.GetLbMlups(), 1e-12);
+              CPPUNIT_ASSERT(performance.GetMaxMemory() >= Performance::GetPeakMemory());
+            }
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION(PerformanceTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_REPORTING_PERFORMANCETESTS_H */
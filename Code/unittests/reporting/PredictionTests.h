@@ -0,0 +1,87 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_REPORTING_PREDICTIONTESTS_H
+#define HEMELB_UNITTESTS_REPORTING_PREDICTIONTESTS_H
+
+#include <cppunit/TestFixture.h>
+#include "reporting/Prediction.h"
+#include "unittests/helpers/HasCommsTestFixture.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace reporting
+    {
+      using namespace hemelb::reporting;
+      class PredictionTests : public helpers::HasCommsTestFixture
+      {
+          CPPUNIT_TEST_SUITE(PredictionTests);
+          CPPUNIT_TEST(TestStepTime);
+          CPPUNIT_TEST(TestReduce);
+          CPPUNIT_TEST(TestUncalibrated);
+          CPPUNIT_TEST_SUITE_END();
+        public:
+          void TestStepTime()
+          {
+            // 100 bulk sites and 10 wall sites that each cost as much as 2 bulk ones.
+            std::vector<site_t> sites(COLLISION_TYPES, 0);
+            sites[0] = 100;
+            sites[1] = 10;
+            std::vector<int> weights(COLLISION_TYPES, 10);
+            weights[1] = 20;
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(120e-6, Prediction::StepTime(sites, weights, 1e-6), 1e-15);
+          }
+
+          void TestReduce()
+          {
+            // Each rank has 1000 bulk sites more than the last.
+            std::vector<site_t> sites(COLLISION_TYPES, 0);
+            sites[0] = 1000 * (Comms().Rank() + 1);
+            std::vector<int> weights(COLLISION_TYPES, 1);
+
+            Prediction prediction(Comms());
+            prediction.Reduce(sites, weights, 1e-6, 1e6);
+            if (Comms().OnIORank())
+            {
+              const double ranks = Comms().Size();
+              CPPUNIT_ASSERT(prediction.IsCalibrated());
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(1e-3 * ranks, prediction.GetStepTime(), 1e-12);
+              // The slowest rank sets the pace for all the sites.
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(1000.0 * ranks * (ranks + 1) / 2 / (1e-3 * ranks) / 1e6,
+                                           prediction.GetMlups(),
+                                           1e-9);
+              const LoadImbalance::Distribution& work =
+                  prediction.GetDistributions()[Prediction::work];
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0 * ranks / (ranks + 1), work.imbalance, 1e-9);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(1e6,
+                                           prediction.GetDistributions()[Prediction::memory].max,
+                                           1e-9);
+            }
+          }
+
+          void TestUncalibrated()
+          {
+            Prediction prediction(Comms());
+            prediction.Reduce(std::vector<site_t>(COLLISION_TYPES, 10),
+                              std::vector<int>(COLLISION_TYPES, 1),
+                              0.0,
+                              0.0);
+            if (Comms().OnIORank())
+            {
+              CPPUNIT_ASSERT(!prediction.IsCalibrated());
+              CPPUNIT_ASSERT_EQUAL(0.0, prediction.GetStepTime());
+              CPPUNIT_ASSERT_EQUAL(0.0, prediction.GetMlups());
+            }
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION(PredictionTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_REPORTING_PREDICTIONTESTS_H */
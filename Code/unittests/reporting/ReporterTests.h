@@ -45,7 +45,7 @@ namespace hemelb
             lbtests::LbTestsHelper::InitialiseAnisotropicTestData<lb::lattices::D3Q15>(latticeData);
             latticeData->SwapOldAndNew(); //Needed since InitialiseAnisotropicTestData only initialises FOld
             cache = new lb::MacroscopicPropertyCache(*state, *latticeData);
-            cache->densityCache.SetRefreshFlag();
+            cache->SetDensityExtremesRequired();
             lbtests::LbTestsHelper::UpdatePropertyCache<lb::lattices::D3Q15>(*latticeData, *cache, *state);
             incompChecker = new IncompressibilityCheckerMock(latticeData, net, state, *cache, *realTimers, 10.0);
             reporter = new Reporter("mock_path", "exampleinputfile");
@@ -108,6 +108,16 @@ namespace hemelb
             AssertValue("64", "SITES");
             AssertValue("1", "BLOCKS");
             AssertValue("216", "SITESPERBLOCK");
+            AssertValue("stable", "STABILITY");
+
+            // The JSON report expands, with its schema version first.
+            std::string json;
+            CPPUNIT_ASSERT(ctemplate::ExpandTemplate(resources::Resource("report.json.ctp").Path(),
+                                                     ctemplate::STRIP_BLANK_LINES,
+                                                     &reporter->GetDictionary(),
+                                                     &json));
+            CPPUNIT_ASSERT_EQUAL((size_t) 0, json.find("{\n  \"schema_version\": 1,"));
+            CPPUNIT_ASSERT(json.find("\"sites_per_block\": 216,") != std::string::npos);
           }
 
         private:
@@ -27,6 +27,9 @@ namespace hemelb
           CPPUNIT_TEST(TestStartStop);
           CPPUNIT_TEST(TestSetTime);
           CPPUNIT_TEST(TestMultipleStartStop);
+          CPPUNIT_TEST(TestCounting);
+          CPPUNIT_TEST(TestMetering);
+          CPPUNIT_TEST(TestCycleCounterClock);
           CPPUNIT_TEST_SUITE_END();
         public:
           void setUp()
@@ -66,6 +69,62 @@ namespace hemelb
             timer->Stop(); // clock mock at 20.0
             CPPUNIT_ASSERT_DOUBLES_EQUAL(25.0, timer->Get(), 1e-6);
           }
+          void TestCounting()
+          {
+            TimerBase<ClockMock, CounterMock> counting;
+            counting.Start();
+            counting.Stop();
+            CPPUNIT_ASSERT(!counting.HasCounts());
+            CPPUNIT_ASSERT_EQUAL(0.0, counting.GetCount(cycles));
+
+            counting.EnableCounters();
+            counting.Start();
+            counting.Stop();
+            counting.Start();
+            counting.Stop();
+            CPPUNIT_ASSERT(counting.HasCounts());
+            CPPUNIT_ASSERT_EQUAL(200.0, counting.GetCount(cycles));
+            CPPUNIT_ASSERT_EQUAL(600.0, counting.GetCount(cacheMisses));
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(30.0, counting.Get(), 1e-6);
+          }
+
+          void TestMetering()
+          {
+            TimerBase<ClockMock, NoCounterPolicy, EnergyMock> metering;
+            metering.Start();
+            metering.Stop();
+            CPPUNIT_ASSERT(!metering.HasEnergy());
+            CPPUNIT_ASSERT_EQUAL(0.0, metering.GetEnergy(packageEnergy));
+
+            metering.EnableMeters();
+            metering.Start();
+            metering.Stop();
+            metering.Start();
+            metering.Stop();
+            CPPUNIT_ASSERT(metering.HasEnergy());
+            CPPUNIT_ASSERT_EQUAL(20.0, metering.GetEnergy(packageEnergy));
+            CPPUNIT_ASSERT_EQUAL(4.0, metering.GetEnergy(dramEnergy));
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(30.0, metering.Get(), 1e-6);
+          }
+
+          void TestCycleCounterClock()
+          {
+            CPPUNIT_ASSERT(CycleCounterClockPolicy::GetSecondsPerTick() > 0.0);
+            // No processor we run on ticks slower than 1 MHz or faster than 100 GHz.
+            CPPUNIT_ASSERT(CycleCounterClockPolicy::GetSecondsPerTick() < 1e-6);
+            CPPUNIT_ASSERT(CycleCounterClockPolicy::GetSecondsPerTick() > 1e-11);
+
+            // It should agree with the wall clock over a period long against either's resolution.
+            TimerBase<CycleCounterClockPolicy> cycles;
+            const double wallStart = util::myClock();
+            cycles.Start();
+            while (util::myClock() - wallStart < 0.05)
+            {
+            }
+            cycles.Stop();
+            const double wallTime = util::myClock() - wallStart;
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(wallTime, cycles.Get(), 0.1 * wallTime);
+          }
 
         private:
           TimerBase<ClockMock> *timer;
@@ -79,6 +138,9 @@ namespace hemelb
           CPPUNIT_TEST(TestInitialization);
           CPPUNIT_TEST(TestTimersSeparate);
           CPPUNIT_TEST(TestReduce);
+          CPPUNIT_TEST(TestCountedTimers);
+          CPPUNIT_TEST(TestMeteredTimers);
+          CPPUNIT_TEST(TestCollisionTimers);
           CPPUNIT_TEST_SUITE_END();
         public:
           void setUp()
@@ -136,6 +198,49 @@ namespace hemelb
             }
           }
 
+          void TestCountedTimers()
+          {
+            typedef TimersBase<ClockMock, MPICommsMock, CounterMock> CountingTimers;
+            CountingTimers counting(Comms());
+            for (unsigned int i = 0; i < Timers::numberOfTimers; i++)
+            {
+              const bool counted = i == Timers::lb_calc || i == Timers::monitoring
+                  || i == Timers::visualisation;
+              CPPUNIT_ASSERT_EQUAL(counted, counting[i].HasCounts());
+            }
+            // Nothing is reported until Reduce has shared the counts.
+            CPPUNIT_ASSERT_EQUAL(0.0, counting.CounterTotal(CountingTimers::lb_calc, cycles));
+            CPPUNIT_ASSERT_EQUAL(0.0, counting.CountedTime(CountingTimers::lb_calc));
+          }
+
+          void TestMeteredTimers()
+          {
+            typedef TimersBase<ClockMock, MPICommsMock, NoCounterPolicy, EnergyMock> MeteringTimers;
+            MeteringTimers metering(Comms());
+            for (unsigned int i = 0; i < Timers::numberOfTimers; i++)
+            {
+              const bool metered = i == Timers::simulation || i == Timers::lb_calc
+                  || i == Timers::mpiWait || i == Timers::extractionWriting
+                  || i == Timers::checkpoint;
+              CPPUNIT_ASSERT_EQUAL(metered, metering[i].HasEnergy());
+            }
+            // Nothing is reported until Reduce has shared the energy.
+            CPPUNIT_ASSERT_EQUAL(0.0, metering.EnergyTotal(MeteringTimers::simulation, packageEnergy));
+            CPPUNIT_ASSERT_EQUAL(0.0, metering.MeteredNodes(MeteringTimers::simulation));
+          }
+
+          void TestCollisionTimers()
+          {
+            CPPUNIT_ASSERT_EQUAL(Timers::midDomainMidFluid, Timers::CollisionTimer(0, false));
+            CPPUNIT_ASSERT_EQUAL(Timers::midDomainOutletWall, Timers::CollisionTimer(5, false));
+            CPPUNIT_ASSERT_EQUAL(Timers::domainEdgeMidFluid, Timers::CollisionTimer(0, true));
+            CPPUNIT_ASSERT_EQUAL(Timers::domainEdgeWall, Timers::CollisionTimer(1, true));
+            CPPUNIT_ASSERT_EQUAL(Timers::domainEdgeOutletWall,
+                                 Timers::CollisionTimer(COLLISION_TYPES - 1, true));
+            CPPUNIT_ASSERT_EQUAL(std::string("Domain-edge inlet wall"),
+                                 Timers::timerNames[Timers::domainEdgeInletWall]);
+          }
+
         private:
           TimersBase<ClockMock, MPICommsMock> *timers;
       };
@@ -9,5 +9,9 @@
 
 #include "unittests/reporting/TimerTests.h"
 #include "unittests/reporting/ReporterTests.h"
+#include "unittests/reporting/LoadImbalanceTests.h"
+#include "unittests/reporting/PerformanceTests.h"
+#include "unittests/reporting/MemoryUsageTests.h"
+#include "unittests/reporting/PredictionTests.h"
 
 #endif /* HEMELB_UNITTESTS_REPORTING_REPORTING_H */
@@ -0,0 +1,91 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_UTIL_HALFPRECISIONTESTS_H
+#define HEMELB_UNITTESTS_UTIL_HALFPRECISIONTESTS_H
+
+#include <limits>
+#include <cppunit/TestFixture.h>
+#include "util/HalfPrecision.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace util
+    {
+      using namespace hemelb::util;
+
+      class HalfPrecisionTests : public CppUnit::TestFixture
+      {
+          CPPUNIT_TEST_SUITE(HalfPrecisionTests);
+          CPPUNIT_TEST(TestExactValues);
+          CPPUNIT_TEST(TestRounding);
+          CPPUNIT_TEST(TestLimits);
+          CPPUNIT_TEST(TestRoundTrip);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void TestExactValues()
+          {
+            CPPUNIT_ASSERT_EQUAL((uint16_t) 0x0000, FloatToHalf(0.0f));
+            CPPUNIT_ASSERT_EQUAL((uint16_t) 0x8000, FloatToHalf(-0.0f));
+            CPPUNIT_ASSERT_EQUAL((uint16_t) 0x3c00, FloatToHalf(1.0f));
+            CPPUNIT_ASSERT_EQUAL((uint16_t) 0xc000, FloatToHalf(-2.0f));
+            CPPUNIT_ASSERT_EQUAL((uint16_t) 0x3555, FloatToHalf(0.333251953125f));
+            CPPUNIT_ASSERT_EQUAL((uint16_t) 0x7bff, FloatToHalf(65504.0f));
+            // The smallest normal and subnormal halves.
+            CPPUNIT_ASSERT_EQUAL((uint16_t) 0x0400, FloatToHalf(std::ldexp(1.0f, -14)));
+            CPPUNIT_ASSERT_EQUAL((uint16_t) 0x0001, FloatToHalf(std::ldexp(1.0f, -24)));
+          }
+
+          void TestRounding()
+          {
+            // Halfway between 1 and the next half, 1 + 2^-10, goes to the even one...
+            CPPUNIT_ASSERT_EQUAL((uint16_t) 0x3c00, FloatToHalf(1.0f + std::ldexp(1.0f, -11)));
+            // ... as does halfway between that and the one after.
+            CPPUNIT_ASSERT_EQUAL((uint16_t) 0x3c02, FloatToHalf(1.0f + 3 * std::ldexp(1.0f, -11)));
+            // Anything above halfway goes up.
+            CPPUNIT_ASSERT_EQUAL((uint16_t) 0x3c01,
+                                 FloatToHalf(1.0f + std::ldexp(1.0f, -11) + std::ldexp(1.0f, -20)));
+            // Rounding up can carry into the exponent.
+            CPPUNIT_ASSERT_EQUAL((uint16_t) 0x4000, FloatToHalf(2.0f - std::ldexp(1.0f, -12)));
+            // Half the smallest subnormal rounds to the even zero, anything more to it.
+            CPPUNIT_ASSERT_EQUAL((uint16_t) 0x0000, FloatToHalf(std::ldexp(1.0f, -25)));
+            CPPUNIT_ASSERT_EQUAL((uint16_t) 0x0001, FloatToHalf(std::ldexp(1.5f, -25)));
+          }
+
+          void TestLimits()
+          {
+            CPPUNIT_ASSERT_EQUAL((uint16_t) 0x7c00, FloatToHalf(65520.0f));
+            CPPUNIT_ASSERT_EQUAL((uint16_t) 0xfc00, FloatToHalf(-1e10f));
+            CPPUNIT_ASSERT_EQUAL((uint16_t) 0x7c00,
+                                 FloatToHalf(std::numeric_limits<float>::infinity()));
+            const uint16_t nan = FloatToHalf(std::numeric_limits<float>::quiet_NaN());
+            CPPUNIT_ASSERT( (nan & 0x7c00) == 0x7c00 && (nan & 0x3ff) != 0);
+          }
+
+          void TestRoundTrip()
+          {
+            // Every finite half converts to a float and back unchanged.
+            for (uint32_t half = 0; half < 0x10000; ++half)
+            {
+              if ( (half & 0x7c00) != 0x7c00)
+              {
+                CPPUNIT_ASSERT_EQUAL((uint16_t) half, FloatToHalf(HalfToFloat((uint16_t) half)));
+              }
+            }
+            CPPUNIT_ASSERT_EQUAL(1.0f, HalfToFloat(0x3c00));
+            CPPUNIT_ASSERT_EQUAL(std::ldexp(1.0f, -24), HalfToFloat(0x0001));
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION(HalfPrecisionTests);
+
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_UTIL_HALFPRECISIONTESTS_H */
@@ -0,0 +1,115 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_UTIL_HASHMAPTESTS_H
+#define HEMELB_UNITTESTS_UTIL_HASHMAPTESTS_H
+
+#include <vector>
+#include <cppunit/TestFixture.h>
+#include "util/HashMap.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace util
+    {
+      using namespace hemelb::util;
+
+      class HashMapTests : public CppUnit::TestFixture
+      {
+          CPPUNIT_TEST_SUITE(HashMapTests);
+          CPPUNIT_TEST(TestInsertAndFind);
+          CPPUNIT_TEST(TestGrowth);
+          CPPUNIT_TEST(TestVectorKeys);
+          CPPUNIT_TEST(TestAssign);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void TestInsertAndFind()
+          {
+            HashMap<site_t, int> map;
+            CPPUNIT_ASSERT(map.empty());
+            CPPUNIT_ASSERT(map.find(3) == map.end());
+
+            CPPUNIT_ASSERT(map.insert(std::make_pair(site_t(3), 30)).second);
+            CPPUNIT_ASSERT(map.insert(std::make_pair(site_t(-1), 10)).second);
+            // A second insert of the same key keeps the first value.
+            std::pair<HashMap<site_t, int>::iterator, bool> again =
+                map.insert(std::make_pair(site_t(3), 31));
+            CPPUNIT_ASSERT(!again.second);
+            CPPUNIT_ASSERT_EQUAL(30, again.first->second);
+
+            map[7] = 70;
+            CPPUNIT_ASSERT_EQUAL(size_t(3), map.size());
+            CPPUNIT_ASSERT_EQUAL(10, map.find(-1)->second);
+            CPPUNIT_ASSERT_EQUAL(size_t(1), map.count(7));
+            CPPUNIT_ASSERT_EQUAL(size_t(0), map.count(8));
+
+            // Iteration is in the order of insertion.
+            CPPUNIT_ASSERT_EQUAL(site_t(3), map.begin()->first);
+            CPPUNIT_ASSERT_EQUAL(site_t(7), (map.end() - 1)->first);
+
+            map.clear();
+            CPPUNIT_ASSERT(map.empty());
+            CPPUNIT_ASSERT(map.find(3) == map.end());
+          }
+
+          void TestGrowth()
+          {
+            // Consecutive ids, as neighbouring sites have, well past the first index size.
+            HashMap<site_t, site_t> map;
+            for (site_t id = 0; id < 10000; ++id)
+            {
+              map[id * 64] = id;
+            }
+            CPPUNIT_ASSERT_EQUAL(size_t(10000), map.size());
+            for (site_t id = 0; id < 10000; ++id)
+            {
+              CPPUNIT_ASSERT_EQUAL(id, map.find(id * 64)->second);
+              CPPUNIT_ASSERT(map.find(id * 64 + 1) == map.end());
+            }
+          }
+
+          void TestVectorKeys()
+          {
+            HashMap<Vector3D<int>, double> map;
+            map[Vector3D<int>(1, 2, 3)] = 1.0;
+            map[Vector3D<int>(3, 2, 1)] = 2.0;
+            map[Vector3D<int>(-1, 0, 0)] = 3.0;
+            CPPUNIT_ASSERT_EQUAL(1.0, map.find(Vector3D<int>(1, 2, 3))->second);
+            CPPUNIT_ASSERT_EQUAL(2.0, map.find(Vector3D<int>(3, 2, 1))->second);
+            CPPUNIT_ASSERT_EQUAL(3.0, map.find(Vector3D<int>(-1, 0, 0))->second);
+            CPPUNIT_ASSERT(map.find(Vector3D<int>(2, 1, 3)) == map.end());
+          }
+
+          void TestAssign()
+          {
+            std::vector<std::pair<site_t, int> > entries;
+            for (int i = 0; i < 100; ++i)
+            {
+              entries.push_back(std::make_pair(site_t(i % 50), i));
+            }
+            HashMap<site_t, int> map;
+            map[1000] = 0;
+            map.assign(entries.begin(), entries.end());
+            CPPUNIT_ASSERT_EQUAL(size_t(50), map.size());
+            CPPUNIT_ASSERT(map.find(1000) == map.end());
+            CPPUNIT_ASSERT_EQUAL(10, map.find(10)->second);
+
+            // Room was made for them all at once, so reserving as many again moves nothing.
+            const std::pair<site_t, int>* first = & *map.begin();
+            map.reserve(50);
+            CPPUNIT_ASSERT(first == & *map.begin());
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION(HashMapTests);
+
+    }
+  }
+}
+
+#endif // HEMELB_UNITTESTS_UTIL_HASHMAPTESTS_H
@@ -0,0 +1,76 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_UTIL_HILBERTORDERTESTS_H
+#define HEMELB_UNITTESTS_UTIL_HILBERTORDERTESTS_H
+
+#include <cppunit/TestFixture.h>
+#include <cstdlib>
+#include <vector>
+#include "util/HilbertOrder.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace util
+    {
+      using namespace hemelb::util;
+
+      class HilbertOrderTests : public CppUnit::TestFixture
+      {
+          CPPUNIT_TEST_SUITE(HilbertOrderTests);
+          CPPUNIT_TEST(TestOrigin);
+          CPPUNIT_TEST(TestFillsCubeContinuously);
+          CPPUNIT_TEST(TestEnd);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void TestOrigin()
+          {
+            CPPUNIT_ASSERT_EQUAL((uint64_t) 0, GetHilbertKey(Vector3D<site_t>(0, 0, 0)));
+          }
+
+          void TestFillsCubeContinuously()
+          {
+            // The first 8^3 positions are the 8x8x8 cube at the origin, each next to the last.
+            const site_t side = 8;
+            std::vector<Vector3D<site_t> > sitesInOrder(side * side * side, Vector3D<site_t>(-1));
+            for (site_t i = 0; i < side; ++i)
+            {
+              for (site_t j = 0; j < side; ++j)
+              {
+                for (site_t k = 0; k < side; ++k)
+                {
+                  uint64_t key = GetHilbertKey(Vector3D<site_t>(i, j, k));
+                  CPPUNIT_ASSERT(key < sitesInOrder.size());
+                  CPPUNIT_ASSERT_EQUAL((site_t) -1, sitesInOrder[key].x);
+                  sitesInOrder[key] = Vector3D<site_t>(i, j, k);
+                }
+              }
+            }
+
+            for (size_t key = 1; key < sitesInOrder.size(); ++key)
+            {
+              Vector3D<site_t> step = sitesInOrder[key] - sitesInOrder[key - 1];
+              CPPUNIT_ASSERT_EQUAL((site_t) 1, std::abs(step.x) + std::abs(step.y) + std::abs(step.z));
+            }
+          }
+
+          void TestEnd()
+          {
+            const site_t largest = (1 << 21) - 1;
+            CPPUNIT_ASSERT_EQUAL((uint64_t) 0x7fffffffffffffffULL,
+                                 GetHilbertKey(Vector3D<site_t>(largest, 0, 0)));
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION(HilbertOrderTests);
+
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_UTIL_HILBERTORDERTESTS_H */
@@ -0,0 +1,84 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_UTIL_LATTICEALLOCATORTESTS_H
+#define HEMELB_UNITTESTS_UTIL_LATTICEALLOCATORTESTS_H
+
+#include <vector>
+#include <cppunit/TestFixture.h>
+#include "util/LatticeAllocator.h"
+#include "util/utilityFunctions.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace util
+    {
+      using namespace hemelb::util;
+
+      class LatticeAllocatorTests : public CppUnit::TestFixture
+      {
+          CPPUNIT_TEST_SUITE(LatticeAllocatorTests);
+          CPPUNIT_TEST(TestSmallAndLargeArrays);
+          CPPUNIT_TEST(TestBlockRanges);
+          CPPUNIT_TEST_SUITE_END();
+
+          typedef std::vector<double, LatticeAllocator<double> > Array;
+
+        public:
+          void TestSmallAndLargeArrays()
+          {
+            // Smaller and larger than a huge page, which are allocated differently when built
+            // with huge pages.
+            const std::size_t sizes[] = { 10, 3 * HugePageSize / sizeof(double) + 1 };
+            for (unsigned test = 0; test < 2; ++test)
+            {
+              Array array(sizes[test], 2.0);
+              CPPUNIT_ASSERT_EQUAL(2.0, array.back());
+              for (std::size_t index = 0; index < array.size(); ++index)
+              {
+                array[index] = double(index);
+              }
+
+              // Growing keeps the values.
+              array.resize(2 * sizes[test]);
+              CPPUNIT_ASSERT_EQUAL(double(sizes[test] - 1), array[sizes[test] - 1]);
+
+              Array copy(array);
+              CPPUNIT_ASSERT(copy == array);
+              copy.swap(array);
+              CPPUNIT_ASSERT_EQUAL(double(sizes[test] / 2), array[sizes[test] / 2]);
+            }
+          }
+
+          void TestBlockRanges()
+          {
+            // 10 split into 4: 3, 3, 2, 2, following on from each other.
+            const long expectedSizes[] = { 3, 3, 2, 2 };
+            long expectedFirst = 5;
+            for (long block = 0; block < 4; ++block)
+            {
+              long blockFirst, blockSize;
+              GetBlockRange(5L, 10L, block, 4L, blockFirst, blockSize);
+              CPPUNIT_ASSERT_EQUAL(expectedFirst, blockFirst);
+              CPPUNIT_ASSERT_EQUAL(expectedSizes[block], blockSize);
+              expectedFirst += blockSize;
+            }
+
+            // More blocks than there are to split leaves the last ones empty.
+            long blockFirst, blockSize;
+            GetBlockRange(0L, 2L, 3L, 4L, blockFirst, blockSize);
+            CPPUNIT_ASSERT_EQUAL(0L, blockSize);
+            CPPUNIT_ASSERT_EQUAL(2L, blockFirst);
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION(LatticeAllocatorTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_UTIL_LATTICEALLOCATORTESTS_H */
@@ -0,0 +1,96 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_UTIL_MONOTONICARENATESTS_H
+#define HEMELB_UNITTESTS_UTIL_MONOTONICARENATESTS_H
+
+#include <vector>
+#include <cppunit/TestFixture.h>
+#include "util/MonotonicArena.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace util
+    {
+      class MonotonicArenaTests : public CppUnit::TestFixture
+      {
+          CPPUNIT_TEST_SUITE(MonotonicArenaTests);
+          CPPUNIT_TEST(TestAllocate);
+          CPPUNIT_TEST(TestRewindAndRelease);
+          CPPUNIT_TEST(TestAllocator);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void TestAllocate()
+          {
+            hemelb::util::MonotonicArena arena(256);
+            CPPUNIT_ASSERT_EQUAL(size_t(0), arena.GetHeldBytes());
+
+            char* first = static_cast<char*>(arena.Allocate(3, 1));
+            double* second = static_cast<double*>(arena.Allocate(sizeof(double), alignof(double)));
+            CPPUNIT_ASSERT_EQUAL(size_t(0), reinterpret_cast<size_t>(second) % alignof(double));
+            // Both come from the first slab, one after the other.
+            CPPUNIT_ASSERT(reinterpret_cast<char*>(second) > first);
+            CPPUNIT_ASSERT(reinterpret_cast<char*>(second) < first + 256);
+            CPPUNIT_ASSERT_EQUAL(size_t(256), arena.GetHeldBytes());
+
+            // A big allocation gets a slab to itself.
+            arena.Allocate(1000, 1);
+            CPPUNIT_ASSERT(arena.GetHeldBytes() >= size_t(1256));
+          }
+
+          void TestRewindAndRelease()
+          {
+            hemelb::util::MonotonicArena arena(256);
+            void* first = arena.Allocate(200, 1);
+            arena.Allocate(200, 1);
+            const size_t held = arena.GetHeldBytes();
+            CPPUNIT_ASSERT_EQUAL(size_t(512), held);
+
+            // Rewinding hands out the same slabs again.
+            arena.Rewind();
+            CPPUNIT_ASSERT(first == arena.Allocate(200, 1));
+            arena.Allocate(200, 1);
+            CPPUNIT_ASSERT_EQUAL(held, arena.GetHeldBytes());
+
+            arena.Release();
+            CPPUNIT_ASSERT_EQUAL(size_t(0), arena.GetHeldBytes());
+            CPPUNIT_ASSERT_EQUAL(held, arena.GetPeakBytes());
+          }
+
+          void TestAllocator()
+          {
+            hemelb::util::MonotonicArena arena;
+            typedef std::vector<int, hemelb::util::ArenaAllocator<int> > ArenaVector;
+
+            const hemelb::util::ArenaAllocator<int> allocator(&arena);
+            ArenaVector fromArena(allocator);
+            for (int value = 0; value < 100; ++value)
+            {
+              fromArena.push_back(value);
+            }
+            CPPUNIT_ASSERT_EQUAL(99, fromArena.back());
+            CPPUNIT_ASSERT(arena.GetHeldBytes() > 0);
+
+            // Without an arena, the vector uses the heap.
+            ArenaVector fromHeap(10, 1);
+            CPPUNIT_ASSERT(fromHeap.get_allocator().GetArena() == NULL);
+
+            // Assigning takes the arena along with the elements.
+            fromHeap = fromArena;
+            CPPUNIT_ASSERT(fromHeap.get_allocator().GetArena() == &arena);
+            CPPUNIT_ASSERT_EQUAL(size_t(100), fromHeap.size());
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION(MonotonicArenaTests);
+
+    }
+  }
+}
+
+#endif // HEMELB_UNITTESTS_UTIL_MONOTONICARENATESTS_H
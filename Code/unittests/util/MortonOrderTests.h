@@ -0,0 +1,63 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_UTIL_MORTONORDERTESTS_H
+#define HEMELB_UNITTESTS_UTIL_MORTONORDERTESTS_H
+
+#include <cppunit/TestFixture.h>
+#include "util/MortonOrder.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace util
+    {
+      using namespace hemelb::util;
+
+      class MortonOrderTests : public CppUnit::TestFixture
+      {
+          CPPUNIT_TEST_SUITE(MortonOrderTests);
+          CPPUNIT_TEST(TestUnitVectors);
+          CPPUNIT_TEST(TestInterleaving);
+          CPPUNIT_TEST(TestLargestCoordinate);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void TestUnitVectors()
+          {
+            CPPUNIT_ASSERT_EQUAL((uint64_t) 0, GetMortonKey(Vector3D<site_t>(0, 0, 0)));
+            CPPUNIT_ASSERT_EQUAL((uint64_t) 1, GetMortonKey(Vector3D<site_t>(1, 0, 0)));
+            CPPUNIT_ASSERT_EQUAL((uint64_t) 2, GetMortonKey(Vector3D<site_t>(0, 1, 0)));
+            CPPUNIT_ASSERT_EQUAL((uint64_t) 4, GetMortonKey(Vector3D<site_t>(0, 0, 1)));
+            CPPUNIT_ASSERT_EQUAL((uint64_t) 7, GetMortonKey(Vector3D<site_t>(1, 1, 1)));
+          }
+
+          void TestInterleaving()
+          {
+            // x = 0b101, y = 0b011, z = 0b110 interleave (z y x per triple, most significant
+            // first) to 0b 101 110 011.
+            CPPUNIT_ASSERT_EQUAL((uint64_t) 0x173, GetMortonKey(Vector3D<site_t>(5, 3, 6)));
+
+            // Each 2x2x2 cube is visited before moving on to the next.
+            CPPUNIT_ASSERT(GetMortonKey(Vector3D<site_t>(1, 1, 1)) < GetMortonKey(Vector3D<site_t>(2, 0, 0)));
+          }
+
+          void TestLargestCoordinate()
+          {
+            const site_t largest = (1 << 21) - 1;
+            CPPUNIT_ASSERT_EQUAL((uint64_t) 0x7fffffffffffffffULL,
+                                 GetMortonKey(Vector3D<site_t>(largest, largest, largest)));
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION(MortonOrderTests);
+
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_UTIL_MORTONORDERTESTS_H */
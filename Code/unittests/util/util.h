@@ -11,5 +11,11 @@
 #include "unittests/util/Matrix3DTests.h"
 #include "unittests/util/UnitConverterTests.h"
 #include "unittests/util/BesselTests.h"
+#include "unittests/util/MortonOrderTests.h"
+#include "unittests/util/HilbertOrderTests.h"
+#include "unittests/util/HalfPrecisionTests.h"
+#include "unittests/util/LatticeAllocatorTests.h"
+#include "unittests/util/HashMapTests.h"
+#include "unittests/util/MonotonicArenaTests.h"
 
 #endif
@@ -0,0 +1,136 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_VISTESTS_BINARYSWAPSCHEDULETESTS_H
+#define HEMELB_UNITTESTS_VISTESTS_BINARYSWAPSCHEDULETESTS_H
+
+#include <vector>
+#include <cppunit/TestFixture.h>
+#include "vis/BinarySwapSchedule.h"
+#include "vis/PixelSet.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace vistests
+    {
+      class BinarySwapScheduleTests : public CppUnit::TestFixture
+      {
+          CPPUNIT_TEST_SUITE( BinarySwapScheduleTests);
+          CPPUNIT_TEST( TestFolding);
+          CPPUNIT_TEST( TestExchangesArePaired);
+          CPPUNIT_TEST( TestStripsCoverImage);
+          CPPUNIT_TEST( TestMovePixelsOutsideColumns);
+          CPPUNIT_TEST_SUITE_END();
+        public:
+          void TestFolding()
+          {
+            // Six ranks, of which 1 to 5 composite: 1 to 4 hold strips and 5 folds into 1.
+            CPPUNIT_ASSERT(!vis::BinarySwapSchedule(0, 1, 6, 100).HoldsStrip());
+            CPPUNIT_ASSERT_EQUAL(proc_t(4), vis::BinarySwapSchedule(0, 1, 6, 100).GetStripHolderCount());
+
+            const vis::BinarySwapSchedule folded(5, 1, 6, 100);
+            CPPUNIT_ASSERT(folded.SendsWholeRendering());
+            CPPUNIT_ASSERT_EQUAL(proc_t(1), folded.GetFoldTarget());
+            CPPUNIT_ASSERT(!folded.HoldsStrip());
+            CPPUNIT_ASSERT(folded.GetExchanges().empty());
+
+            const vis::BinarySwapSchedule target(1, 1, 6, 100);
+            CPPUNIT_ASSERT(target.ReceivesWholeRendering());
+            CPPUNIT_ASSERT_EQUAL(proc_t(5), target.GetFoldSource());
+            CPPUNIT_ASSERT_EQUAL(size_t(2), target.GetExchanges().size());
+            CPPUNIT_ASSERT(!vis::BinarySwapSchedule(2, 1, 6, 100).ReceivesWholeRendering());
+
+            // With a single compositing rank there is nothing to swap.
+            const vis::BinarySwapSchedule alone(1, 1, 2, 100);
+            CPPUNIT_ASSERT(alone.HoldsStrip());
+            CPPUNIT_ASSERT(alone.GetExchanges().empty());
+          }
+
+          void TestExchangesArePaired()
+          {
+            for (proc_t size = 2; size < 20; ++size)
+            {
+              for (proc_t rank = 1; rank < size; ++rank)
+              {
+                const vis::BinarySwapSchedule schedule(rank, 1, size, 37);
+                for (size_t round = 0; round < schedule.GetExchanges().size(); ++round)
+                {
+                  const vis::BinarySwapSchedule::Exchange& exchange = schedule.GetExchanges()[round];
+                  const vis::BinarySwapSchedule partner(exchange.partner, 1, size, 37);
+                  CPPUNIT_ASSERT_EQUAL(schedule.GetExchanges().size(), partner.GetExchanges().size());
+
+                  // The partners swap with each other and split the same strip between them.
+                  const vis::BinarySwapSchedule::Exchange& other = partner.GetExchanges()[round];
+                  CPPUNIT_ASSERT_EQUAL(rank, other.partner);
+                  CPPUNIT_ASSERT(exchange.endColumn == other.firstColumn
+                      || other.endColumn == exchange.firstColumn);
+                }
+              }
+            }
+          }
+
+          void TestStripsCoverImage()
+          {
+            for (proc_t size = 2; size < 20; ++size)
+            {
+              std::vector<int> owners(37, 0);
+              for (proc_t rank = 1; rank < size; ++rank)
+              {
+                const vis::BinarySwapSchedule schedule(rank, 1, size, 37);
+                if (!schedule.HoldsStrip())
+                {
+                  continue;
+                }
+
+                int firstColumn = 0;
+                int endColumn = 37;
+                if (!schedule.GetExchanges().empty())
+                {
+                  firstColumn = schedule.GetExchanges().back().firstColumn;
+                  endColumn = schedule.GetExchanges().back().endColumn;
+                }
+                for (int column = firstColumn; column < endColumn; ++column)
+                {
+                  ++owners[column];
+                }
+              }
+
+              for (int column = 0; column < 37; ++column)
+              {
+                CPPUNIT_ASSERT_EQUAL(1, owners[column]);
+              }
+            }
+          }
+
+          void TestMovePixelsOutsideColumns()
+          {
+            vis::PixelSet<vis::BasicPixel> kept, moved;
+            for (int i = 0; i < 10; ++i)
+            {
+              kept.AddPixel(vis::BasicPixel(i, 9 - i));
+            }
+
+            kept.MovePixelsOutsideColumns(3, 7, moved);
+            CPPUNIT_ASSERT_EQUAL(size_t(4), kept.GetPixelCount());
+            CPPUNIT_ASSERT_EQUAL(size_t(6), moved.GetPixelCount());
+            for (vis::PixelSet<vis::BasicPixel>::const_iterator pixel = kept.begin();
+                pixel != kept.end(); ++pixel)
+            {
+              CPPUNIT_ASSERT(pixel->GetI() >= 3 && pixel->GetI() < 7);
+            }
+
+            // The kept pixels can still be combined with by position.
+            kept.AddPixel(vis::BasicPixel(4, 5));
+            CPPUNIT_ASSERT_EQUAL(size_t(4), kept.GetPixelCount());
+          }
+      };
+      CPPUNIT_TEST_SUITE_REGISTRATION( BinarySwapScheduleTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_VISTESTS_BINARYSWAPSCHEDULETESTS_H */
@@ -0,0 +1,112 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_VISTESTS_COLOURPALETTETESTS_H
+#define HEMELB_UNITTESTS_VISTESTS_COLOURPALETTETESTS_H
+
+#include <cstdlib>
+#include <cppunit/TestFixture.h>
+#include "vis/ColourPalette.h"
+#include "vis/rayTracer/RayDataNormal.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace vistests
+    {
+      using namespace hemelb::vis;
+
+      class ColourPaletteTests : public CppUnit::TestFixture
+      {
+          CPPUNIT_TEST_SUITE (ColourPaletteTests);
+          CPPUNIT_TEST (TestTableMatchesPalette);
+          CPPUNIT_TEST (TestClamping);
+          CPPUNIT_TEST (TestCombinedRayColour);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void TestTableMatchesPalette()
+          {
+            for (int step = 0; step <= 1000; ++step)
+            {
+              const float value = step / 1000.0F;
+              float exact[3];
+              ColourPalette::Evaluate(value, exact);
+              unsigned char tabulated[3];
+              ColourPalette::PickColour(value, tabulated);
+              for (int channel = 0; channel < 3; ++channel)
+              {
+                CPPUNIT_ASSERT(std::abs(int(tabulated[channel]) - int(255.0F * exact[channel])) <= 1);
+              }
+            }
+          }
+
+          void TestClamping()
+          {
+            AssertColour(-1.0F, 0, 0, 255);
+            AssertColour(0.5F, 0, 255, 0);
+            AssertColour(2.0F, 255, 0, 0);
+          }
+
+          void TestCombinedRayColour()
+          {
+            VisSettings settings;
+            settings.mStressType = lb::VonMises;
+            settings.maximumDrawDistance = 10.0F;
+            DomainStats stats;
+            stats.velocity_threshold_max_inv = 0.5;
+            stats.stress_threshold_max_inv = 1.0;
+            stats.density_threshold_min = 0.0;
+            stats.density_threshold_minmax_inv = 1.0;
+
+            // Two segments of the same ray, on different cores.
+            raytracer::SiteData_t slow = { 1.0F, 0.2F, 0.1F };
+            raytracer::SiteData_t fast = { 1.0F, 1.8F, 0.9F };
+            const util::Vector3D<float> direction(0.0F, 0.0F, 1.0F);
+            raytracer::RayDataNormal near(3, 4), far(3, 4);
+            near.UpdateDataForNormalFluidSite(slow, direction, 1.0F, 1.0F, stats, settings);
+            far.UpdateDataForNormalFluidSite(fast, direction, 3.0F, 5.0F, stats, settings);
+            near.Combine(far);
+
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(4.0F, near.GetCumulativeLengthInFluid(), 1e-6);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0F, near.GetLengthBeforeRayFirstCluster(), 1e-6);
+
+            // The colours are of the length-weighted averages, scaled by the domain's maxima.
+            unsigned char colour[3], expected[3];
+            near.GetVelocityColour(colour, settings, stats);
+            ColourPalette::PickColour( (0.2F * 1.0F + 1.8F * 3.0F) / 4.0F * 0.5F, expected);
+            AssertSameColour(expected, colour);
+
+            near.GetStressColour(colour, settings, stats);
+            ColourPalette::PickColour( (0.1F * 1.0F + 0.9F * 3.0F) / 4.0F, expected);
+            AssertSameColour(expected, colour);
+          }
+
+        private:
+          void AssertColour(float value, int red, int green, int blue)
+          {
+            unsigned char colour[3];
+            ColourPalette::PickColour(value, colour);
+            CPPUNIT_ASSERT_EQUAL(red, int(colour[0]));
+            CPPUNIT_ASSERT_EQUAL(green, int(colour[1]));
+            CPPUNIT_ASSERT_EQUAL(blue, int(colour[2]));
+          }
+
+          void AssertSameColour(const unsigned char expected[3], const unsigned char actual[3])
+          {
+            for (int channel = 0; channel < 3; ++channel)
+            {
+              CPPUNIT_ASSERT_EQUAL(int(expected[channel]), int(actual[channel]));
+            }
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (ColourPaletteTests);
+    }
+  }
+}
+
+#endif // HEMELB_UNITTESTS_VISTESTS_COLOURPALETTETESTS_H
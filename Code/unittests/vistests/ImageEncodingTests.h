@@ -0,0 +1,92 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_VISTESTS_IMAGEENCODINGTESTS_H
+#define HEMELB_UNITTESTS_VISTESTS_IMAGEENCODINGTESTS_H
+
+#include <vector>
+#include <cppunit/TestFixture.h>
+#include "io/formats/formats.h"
+#include "io/formats/image.h"
+#include "vis/ImageEncoding.h"
+#include "Exception.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace vistests
+    {
+      class ImageEncodingTests : public CppUnit::TestFixture
+      {
+          CPPUNIT_TEST_SUITE( ImageEncodingTests);
+          CPPUNIT_TEST( TestRoundTrip);
+          CPPUNIT_TEST( TestEmptyImage);
+          CPPUNIT_TEST( TestCorruptBlock);
+          CPPUNIT_TEST_SUITE_END();
+        public:
+          void TestRoundTrip()
+          {
+            // A 64 x 64 patch of pixels, in the scattered order compositing leaves them.
+            std::vector<uint32_t> pixels;
+            for (unsigned pixel = 0; pixel < 4096; ++pixel)
+            {
+              const unsigned scattered = (pixel * 1237) % 4096;
+              const uint32_t i = 100 + scattered / 64;
+              const uint32_t j = 200 + scattered % 64;
+              pixels.push_back( (i << 16) + j);
+              pixels.push_back(0x10203040 + i);
+              pixels.push_back(0x50607080 + j);
+              pixels.push_back(0xffffffff);
+            }
+            std::vector<uint32_t> original = pixels;
+
+            std::vector<uint32_t> encoded;
+            vis::DeflatePixels(pixels, encoded);
+            CPPUNIT_ASSERT_EQUAL(uint32_t(io::formats::HemeLbMagicNumber), encoded[0]);
+            CPPUNIT_ASSERT_EQUAL(uint32_t(io::formats::image::MagicNumber), encoded[1]);
+            CPPUNIT_ASSERT_EQUAL(uint32_t(io::formats::image::DeflateEncoding), encoded[3]);
+            CPPUNIT_ASSERT_EQUAL(uint32_t(4096), encoded[4]);
+            CPPUNIT_ASSERT(encoded.size() * 10 < original.size());
+
+            // The pixels are left sorted by position.
+            for (size_t pixel = 1; pixel < 4096; ++pixel)
+            {
+              CPPUNIT_ASSERT(pixels[4 * (pixel - 1)] < pixels[4 * pixel]);
+            }
+
+            std::vector<uint32_t> decoded;
+            vis::InflatePixels(encoded, decoded);
+            CPPUNIT_ASSERT(decoded == pixels);
+          }
+
+          void TestEmptyImage()
+          {
+            std::vector<uint32_t> pixels, encoded, decoded(4, 1);
+            vis::DeflatePixels(pixels, encoded);
+            CPPUNIT_ASSERT_EQUAL(size_t(6), encoded.size());
+            vis::InflatePixels(encoded, decoded);
+            CPPUNIT_ASSERT(decoded.empty());
+          }
+
+          void TestCorruptBlock()
+          {
+            std::vector<uint32_t> pixels(4, 7), encoded, decoded;
+            vis::DeflatePixels(pixels, encoded);
+            encoded.resize(encoded.size() - 1);
+            CPPUNIT_ASSERT_THROW(vis::InflatePixels(encoded, decoded), Exception);
+
+            pixels.assign(4, 7);
+            vis::DeflatePixels(pixels, encoded);
+            encoded[0] = 0;
+            CPPUNIT_ASSERT_THROW(vis::InflatePixels(encoded, decoded), Exception);
+          }
+      };
+      CPPUNIT_TEST_SUITE_REGISTRATION( ImageEncodingTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_VISTESTS_IMAGEENCODINGTESTS_H */
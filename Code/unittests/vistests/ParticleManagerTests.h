@@ -0,0 +1,87 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_VISTESTS_PARTICLEMANAGERTESTS_H
+#define HEMELB_UNITTESTS_VISTESTS_PARTICLEMANAGERTESTS_H
+
+#include <map>
+#include <cppunit/TestFixture.h>
+#include "vis/streaklineDrawer/ParticleManager.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace vistests
+    {
+      class ParticleManagerTests : public CppUnit::TestFixture
+      {
+          CPPUNIT_TEST_SUITE( ParticleManagerTests);
+          CPPUNIT_TEST( TestDeleteMarkedParticles);
+          CPPUNIT_TEST( TestMovement);
+          CPPUNIT_TEST_SUITE_END();
+
+          typedef vis::streaklinedrawer::Particle Particle;
+
+        public:
+          void setUp()
+          {
+            manager = new vis::streaklinedrawer::ParticleManager(neighbours);
+            for (unsigned particle = 0; particle < 6; ++particle)
+            {
+              manager->AddParticle(Particle(float(particle), 2.F, 3.F, particle));
+            }
+          }
+
+          void tearDown()
+          {
+            delete manager;
+          }
+
+          void TestDeleteMarkedParticles()
+          {
+            // Marking leaves the indices alone until the deletion.
+            manager->MarkForDeletion(0);
+            manager->MarkForDeletion(3);
+            manager->MarkForDeletion(5);
+            CPPUNIT_ASSERT_EQUAL(size_t(6), manager->GetNumberOfLocalParticles());
+
+            manager->DeleteMarkedParticles();
+            CPPUNIT_ASSERT_EQUAL(size_t(3), manager->GetNumberOfLocalParticles());
+
+            // The rest keep their order.
+            const unsigned kept[] = { 1, 2, 4 };
+            for (size_t particle = 0; particle < 3; ++particle)
+            {
+              CPPUNIT_ASSERT_EQUAL(kept[particle], manager->GetInletId(particle));
+              CPPUNIT_ASSERT_EQUAL(float(kept[particle]), manager->GetPositions()[particle].x);
+            }
+
+            // Nothing is deleted twice.
+            manager->DeleteMarkedParticles();
+            CPPUNIT_ASSERT_EQUAL(size_t(3), manager->GetNumberOfLocalParticles());
+          }
+
+          void TestMovement()
+          {
+            manager->SetVelocity(1, util::Vector3D<float>(0.5F, 0.F, -0.25F), 0.6F);
+            manager->ProcessParticleMovement();
+
+            CPPUNIT_ASSERT_EQUAL(util::Vector3D<float>(1.5F, 2.F, 2.75F), manager->GetPositions()[1]);
+            CPPUNIT_ASSERT_EQUAL(util::Vector3D<float>(2.F, 2.F, 3.F), manager->GetPositions()[2]);
+            CPPUNIT_ASSERT_EQUAL(0.6F, manager->GetParticle(1).vel);
+          }
+
+        private:
+          std::map<proc_t, vis::streaklinedrawer::NeighbouringProcessor> neighbours;
+          vis::streaklinedrawer::ParticleManager* manager;
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION( ParticleManagerTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_VISTESTS_PARTICLEMANAGERTESTS_H */
@@ -0,0 +1,155 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_VISTESTS_PIXELSETTESTS_H
+#define HEMELB_UNITTESTS_VISTESTS_PIXELSETTESTS_H
+
+#include <set>
+#include <cppunit/TestFixture.h>
+#include "vis/PixelSet.h"
+#include "vis/streaklineDrawer/StreakPixel.h"
+#include "unittests/helpers/HasCommsTestFixture.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace vistests
+    {
+      /**
+       * Tests of the tiled pixel sets.
+       */
+      class PixelSetTests : public helpers::HasCommsTestFixture
+      {
+          CPPUNIT_TEST_SUITE (PixelSetTests);
+          CPPUNIT_TEST (TestAddAndIterate);
+          CPPUNIT_TEST (TestCombine);
+          CPPUNIT_TEST (TestMoveWholeTiles);
+          CPPUNIT_TEST (TestSendReceive);
+          CPPUNIT_TEST_SUITE_END();
+
+          typedef vis::PixelSet<vis::BasicPixel> BasicSet;
+
+        public:
+          void TestAddAndIterate()
+          {
+            BasicSet pixels;
+            // Pixels in three tiles, one off the screen, and one added twice.
+            pixels.AddPixel(vis::BasicPixel(0, 0));
+            pixels.AddPixel(vis::BasicPixel(31, 31));
+            pixels.AddPixel(vis::BasicPixel(32, 5));
+            pixels.AddPixel(vis::BasicPixel(-1, 3));
+            pixels.AddPixel(vis::BasicPixel(31, 31));
+            CPPUNIT_ASSERT_EQUAL(size_t(4), pixels.GetPixelCount());
+            CPPUNIT_ASSERT_EQUAL(size_t(3), pixels.GetTileCount());
+
+            std::set<std::pair<int, int> > expected;
+            expected.insert(std::make_pair(0, 0));
+            expected.insert(std::make_pair(31, 31));
+            expected.insert(std::make_pair(32, 5));
+            expected.insert(std::make_pair(-1, 3));
+            CPPUNIT_ASSERT(expected == Positions(pixels));
+
+            pixels.Clear();
+            CPPUNIT_ASSERT_EQUAL(size_t(0), pixels.GetPixelCount());
+            CPPUNIT_ASSERT(pixels.begin() == pixels.end());
+          }
+
+          void TestCombine()
+          {
+            vis::PixelSet<vis::streaklinedrawer::StreakPixel> near, far;
+            near.AddPixel(vis::streaklinedrawer::StreakPixel(3, 4, 0.5F, 1.0F, 7));
+            near.AddPixel(vis::streaklinedrawer::StreakPixel(40, 4, 0.5F, 1.0F, 7));
+            far.AddPixel(vis::streaklinedrawer::StreakPixel(3, 4, 0.25F, 2.0F, 8));
+            far.AddPixel(vis::streaklinedrawer::StreakPixel(5, 4, 0.25F, 2.0F, 8));
+
+            near.Combine(far);
+            CPPUNIT_ASSERT_EQUAL(size_t(3), near.GetPixelCount());
+            CPPUNIT_ASSERT_EQUAL(size_t(2), near.GetTileCount());
+            for (vis::PixelSet<vis::streaklinedrawer::StreakPixel>::const_iterator pixel =
+                near.begin(); pixel != near.end(); ++pixel)
+            {
+              if (pixel->GetI() == 3)
+              {
+                // The nearer pixel wins.
+                CPPUNIT_ASSERT_EQUAL(0.5F, pixel->GetParticleVelocity());
+              }
+              else if (pixel->GetI() == 5)
+              {
+                CPPUNIT_ASSERT_EQUAL(0.25F, pixel->GetParticleVelocity());
+              }
+            }
+          }
+
+          void TestMoveWholeTiles()
+          {
+            BasicSet kept, moved;
+            for (int i = 0; i < 128; i += 3)
+            {
+              kept.AddPixel(vis::BasicPixel(i, i % 50));
+            }
+            const size_t total = kept.GetPixelCount();
+
+            // The range starts and ends at tile edges, so no tile is split.
+            kept.MovePixelsOutsideColumns(32, 64, moved);
+            CPPUNIT_ASSERT_EQUAL(total, kept.GetPixelCount() + moved.GetPixelCount());
+            CPPUNIT_ASSERT_EQUAL(size_t(11), kept.GetPixelCount());
+            for (BasicSet::const_iterator pixel = kept.begin(); pixel != kept.end(); ++pixel)
+            {
+              CPPUNIT_ASSERT(pixel->GetI() >= 32 && pixel->GetI() < 64);
+            }
+            for (BasicSet::const_iterator pixel = moved.begin(); pixel != moved.end(); ++pixel)
+            {
+              CPPUNIT_ASSERT(pixel->GetI() < 32 || pixel->GetI() >= 64);
+            }
+
+            // Moving them back combines them with the others by position.
+            kept.Combine(moved);
+            CPPUNIT_ASSERT_EQUAL(total, kept.GetPixelCount());
+          }
+
+          void TestSendReceive()
+          {
+            net::Net net(Comms());
+            const proc_t self = Comms().Rank();
+            BasicSet sent, received;
+            sent.AddPixel(vis::BasicPixel(1, 2));
+            sent.AddPixel(vis::BasicPixel(100, 200));
+
+            sent.SendQuantity(&net, self);
+            received.ReceiveQuantity(&net, self);
+            net.Dispatch();
+            sent.SendPixels(&net, self);
+            received.ReceivePixels(&net, self);
+            net.Dispatch();
+
+            CPPUNIT_ASSERT_EQUAL(size_t(2), received.GetPixelCount());
+            CPPUNIT_ASSERT(Positions(sent) == Positions(received));
+
+            // The received tiles can be added to.
+            received.AddPixel(vis::BasicPixel(1, 3));
+            received.AddPixel(vis::BasicPixel(100, 200));
+            CPPUNIT_ASSERT_EQUAL(size_t(3), received.GetPixelCount());
+            CPPUNIT_ASSERT_EQUAL(size_t(2), received.GetTileCount());
+          }
+
+        private:
+          static std::set<std::pair<int, int> > Positions(const BasicSet& pixels)
+          {
+            std::set<std::pair<int, int> > positions;
+            for (BasicSet::const_iterator pixel = pixels.begin(); pixel != pixels.end(); ++pixel)
+            {
+              positions.insert(std::make_pair(pixel->GetI(), pixel->GetJ()));
+            }
+            return positions;
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (PixelSetTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_VISTESTS_PIXELSETTESTS_H */
@@ -8,5 +8,10 @@
 #define HEMELB_UNITTESTS_VISTESTS_VISTESTS_H
 
 #include "unittests/vistests/HslToRgbConvertorTests.h"
+#include "unittests/vistests/ColourPaletteTests.h"
+#include "unittests/vistests/BinarySwapScheduleTests.h"
+#include "unittests/vistests/PixelSetTests.h"
+#include "unittests/vistests/ImageEncodingTests.h"
+#include "unittests/vistests/ParticleManagerTests.h"
 
 #endif /* HEMELB_UNITTESTS_VISTESTS_VISTESTS_H */
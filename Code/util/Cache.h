@@ -38,6 +38,16 @@ namespace hemelb
          * @param item
          */
         void Put(unsigned long index, const CacheType item);
+        /**
+         * Gets the bytes allocated for the cached objects.
+         * @return
+         */
+        size_t GetMemoryUsage() const;
+        /**
+         * Gets the cached objects, one after the other, or NULL if none are held.
+         * @return
+         */
+        const CacheType* GetData() const;
 
       protected:
         /**
@@ -46,6 +56,11 @@ namespace hemelb
          * @param size
          */
         void Reserve(unsigned long size);
+
+        /**
+         * Frees the memory used by the cache, until it is next reserved.
+         */
+        void Release();
       private:
         /**
          * The actual cached items.
@@ -30,11 +30,31 @@ namespace hemelb
       items[index] = item;
     }
 
+    template<typename CacheType>
+    size_t Cache<CacheType>::GetMemoryUsage() const
+    {
+      return items.capacity() * sizeof(CacheType);
+    }
+
+    template<typename CacheType>
+    const CacheType* Cache<CacheType>::GetData() const
+    {
+      return items.empty()
+        ? NULL
+        : &items[0];
+    }
+
     template<typename CacheType>
     void Cache<CacheType>::Reserve(unsigned long size)
     {
       items.resize(size);
     }
+
+    template<typename CacheType>
+    void Cache<CacheType>::Release()
+    {
+      std::vector<CacheType>().swap(items);
+    }
   }
 }
 
@@ -48,6 +48,12 @@ namespace hemelb
          */
         void Put(unsigned long index, const CacheType& item);
 
+        /**
+         * Gets the bytes allocated for the cached objects and their update times.
+         * @return
+         */
+        size_t GetMemoryUsage() const;
+
       protected:
         /**
          * Reserves enough space for the cache.
@@ -56,6 +62,11 @@ namespace hemelb
          */
         void Reserve(unsigned long size);
 
+        /**
+         * Frees the memory used by the cache, until it is next reserved.
+         */
+        void Release();
+
         /**
          * The state of the simulation, for accessing the timestep id.
          */
@@ -43,6 +43,12 @@ namespace hemelb
       Cache<CacheType>::Put(index, item);
     }
 
+    template<typename CacheType>
+    size_t CheckingCache<CacheType>::GetMemoryUsage() const
+    {
+      return Cache<CacheType>::GetMemoryUsage() + lastUpdate.capacity() * sizeof(unsigned long);
+    }
+
     template<typename CacheType>
     void CheckingCache<CacheType>::Reserve(unsigned long size)
     {
@@ -50,6 +56,13 @@ namespace hemelb
       Cache<CacheType>::Reserve(size);
     }
 
+    template<typename CacheType>
+    void CheckingCache<CacheType>::Release()
+    {
+      std::vector<unsigned long>().swap(lastUpdate);
+      Cache<CacheType>::Release();
+    }
+
   }
 }
 
@@ -0,0 +1,112 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UTIL_HALFPRECISION_H
+#define HEMELB_UTIL_HALFPRECISION_H
+
+#include <cmath>
+#include <cstring>
+#include "units.h"
+
+namespace hemelb
+{
+  namespace util
+  {
+    /**
+     * Convert a float to the bits of the nearest IEEE 754 half-precision (binary16) number,
+     * rounding ties to even. Values too large for a half become infinite, and NaNs stay NaN.
+     * @param value
+     * @return
+     */
+    inline uint16_t FloatToHalf(float value)
+    {
+      uint32_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+      const uint16_t sign = uint16_t( (bits >> 16) & 0x8000);
+      const uint32_t magnitude = bits & 0x7fffffff;
+
+      // Infinity or NaN (keeping it a quiet NaN).
+      if (magnitude >= 0x7f800000)
+      {
+        return sign | 0x7c00 | (magnitude > 0x7f800000
+          ? 0x200
+          : 0);
+      }
+      // At least 2^16, which is beyond the largest half, 65504, even after rounding.
+      if (magnitude >= 0x47800000)
+      {
+        return sign | 0x7c00;
+      }
+
+      uint32_t half;
+      uint32_t remainder;
+      uint32_t halfway;
+      if (magnitude < 0x38800000)
+      {
+        // Below 2^-14, the smallest normal half, so subnormal or zero. Anything under 2^-25 is
+        // less than half the smallest subnormal.
+        if (magnitude < 0x33000000)
+        {
+          return sign;
+        }
+        const uint32_t mantissa = (magnitude & 0x7fffff) | 0x800000;
+        const unsigned shift = 126 - (magnitude >> 23);
+        half = mantissa >> shift;
+        remainder = mantissa & ( (1u << shift) - 1);
+        halfway = 1u << (shift - 1);
+      }
+      else
+      {
+        // Rebias the exponent from 127 to 15 and drop 13 bits of the mantissa. A carry out of
+        // the mantissa when rounding correctly moves up the exponent.
+        half = (magnitude >> 13) - (112 << 10);
+        remainder = magnitude & 0x1fff;
+        halfway = 0x1000;
+      }
+
+      if (remainder > halfway || (remainder == halfway && (half & 1)))
+      {
+        ++half;
+      }
+      return sign | uint16_t(half);
+    }
+
+    /**
+     * Convert the bits of an IEEE 754 half-precision number to a float, which holds it exactly.
+     * @param half
+     * @return
+     */
+    inline float HalfToFloat(uint16_t half)
+    {
+      const uint32_t sign = uint32_t(half & 0x8000) << 16;
+      const uint32_t exponent = (half >> 10) & 0x1f;
+      const uint32_t mantissa = half & 0x3ff;
+
+      uint32_t bits;
+      if (exponent == 0x1f)
+      {
+        bits = sign | 0x7f800000 | (mantissa << 13);
+      }
+      else if (exponent != 0)
+      {
+        bits = sign | ( (exponent + 112) << 23) | (mantissa << 13);
+      }
+      else
+      {
+        // Zero or subnormal, mantissa x 2^-24.
+        const float subnormal = std::ldexp(float(mantissa), -24);
+        return sign
+          ? -subnormal
+          : subnormal;
+      }
+
+      float value;
+      std::memcpy(&value, &bits, sizeof(value));
+      return value;
+    }
+  }
+}
+
+#endif /* HEMELB_UTIL_HALFPRECISION_H */
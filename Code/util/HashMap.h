@@ -0,0 +1,266 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+#ifndef HEMELB_UTIL_HASHMAP_H
+#define HEMELB_UTIL_HASHMAP_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "util/Vector3D.h"
+#include "util/utilityFunctions.h"
+
+namespace hemelb
+{
+  namespace util
+  {
+    /**
+     * The hash HashMap uses for a key. HashMap mixes the bits itself, so this need only turn
+     * the key into an integer that differs between keys. Integer keys are their own hash.
+     */
+    template<class Key>
+    struct Hash
+    {
+        uint64_t operator()(Key key) const
+        {
+          return uint64_t(key);
+        }
+    };
+
+    /**
+     * Integer vectors, such as site coordinates, hash their three components together.
+     */
+    template<class T>
+    struct Hash<Vector3D<T> >
+    {
+        uint64_t operator()(const Vector3D<T>& key) const
+        {
+          return (uint64_t(key.x) * 0x9E3779B97F4A7C15ULL + uint64_t(key.y)) * 0x9E3779B97F4A7C15ULL
+              + uint64_t(key.z);
+        }
+    };
+
+    /**
+     * An unordered map with the part of the std::map interface that the lookup tables use, but
+     * without an allocation for each entry.
+     *
+     * The entries are kept contiguous, in the order they were inserted, and iteration goes over
+     * them in that order. They are found through an open-addressing index, with linear probing,
+     * that is kept at most half full. As with a std::vector, inserting can move the entries, so
+     * iterators and pointers to them are only valid until the next insert, unless there is
+     * room reserved. Entries can't be erased, only cleared all at once.
+     */
+    template<class Key, class T, class HashType = Hash<Key> >
+    class HashMap
+    {
+      public:
+        typedef Key key_type;
+        typedef T mapped_type;
+        typedef std::pair<Key, T> value_type;
+        typedef typename std::vector<value_type>::iterator iterator;
+        typedef typename std::vector<value_type>::const_iterator const_iterator;
+
+        HashMap() :
+            index(MinIndexSize, Empty), indexBits(MinIndexBits)
+        {
+        }
+
+        /**
+         * Make room for the given number of entries, so that inserting that many won't move the
+         * entries or rebuild the index.
+         * @param count
+         */
+        void reserve(size_t count)
+        {
+          entries.reserve(count);
+          unsigned bits = indexBits;
+          while ( (size_t(1) << bits) < 2 * count)
+          {
+            ++bits;
+          }
+          if (bits != indexBits)
+          {
+            Rebuild(bits);
+          }
+        }
+
+        /**
+         * Replace the contents with the given entries, building the index once. Where keys are
+         * repeated, the first entry is kept.
+         * @param first
+         * @param last
+         */
+        template<class InputIterator>
+        void assign(InputIterator first, InputIterator last)
+        {
+          clear();
+          std::vector<value_type> given(first, last);
+          reserve(given.size());
+          for (typename std::vector<value_type>::const_iterator entry = given.begin();
+              entry != given.end(); ++entry)
+          {
+            insert(*entry);
+          }
+        }
+
+        void clear()
+        {
+          entries.clear();
+          index.assign(MinIndexSize, Empty);
+          indexBits = MinIndexBits;
+        }
+
+        size_t size() const
+        {
+          return entries.size();
+        }
+
+        bool empty() const
+        {
+          return entries.empty();
+        }
+
+        iterator begin()
+        {
+          return entries.begin();
+        }
+
+        iterator end()
+        {
+          return entries.end();
+        }
+
+        const_iterator begin() const
+        {
+          return entries.begin();
+        }
+
+        const_iterator end() const
+        {
+          return entries.end();
+        }
+
+        iterator find(const Key& key)
+        {
+          const size_t found = Find(key);
+          return found == Empty ?
+            entries.end() :
+            entries.begin() + found;
+        }
+
+        const_iterator find(const Key& key) const
+        {
+          const size_t found = Find(key);
+          return found == Empty ?
+            entries.end() :
+            entries.begin() + found;
+        }
+
+        size_t count(const Key& key) const
+        {
+          return Find(key) == Empty ?
+            0 :
+            1;
+        }
+
+        /**
+         * Insert an entry, if there isn't one with its key already.
+         * @param entry
+         * @return Where the entry with the key is, and whether it was inserted.
+         */
+        std::pair<iterator, bool> insert(const value_type& entry)
+        {
+          const size_t found = Find(entry.first);
+          if (found != Empty)
+          {
+            return std::make_pair(entries.begin() + found, false);
+          }
+
+          if (2 * (entries.size() + 1) > index.size())
+          {
+            Rebuild(indexBits + 1);
+          }
+          index[FreePlace(entry.first)] = entries.size();
+          entries.push_back(entry);
+          return std::make_pair(entries.end() - 1, true);
+        }
+
+        T& operator[](const Key& key)
+        {
+          return insert(value_type(key, T())).first->second;
+        }
+
+        /**
+         * @return The bytes allocated for the entries and the index.
+         */
+        size_t GetMemoryUsage() const
+        {
+          return VectorBytes(entries) + VectorBytes(index);
+        }
+
+      private:
+        enum
+        {
+          MinIndexBits = 4,
+          MinIndexSize = 1 << MinIndexBits
+        };
+        static const size_t Empty = size_t(-1);
+
+        /**
+         * Fibonacci hashing: the top bits of the product are well mixed even for keys that are
+         * close together, as neighbouring sites' ids are.
+         * @param key
+         * @return Where the probing for the key starts.
+         */
+        size_t StartPlace(const Key& key) const
+        {
+          return size_t( (HashType()(key) * 0x9E3779B97F4A7C15ULL) >> (64 - indexBits));
+        }
+
+        size_t Find(const Key& key) const
+        {
+          const size_t mask = index.size() - 1;
+          for (size_t place = StartPlace(key); index[place] != Empty; place = (place + 1) & mask)
+          {
+            if (entries[index[place]].first == key)
+            {
+              return index[place];
+            }
+          }
+          return Empty;
+        }
+
+        size_t FreePlace(const Key& key) const
+        {
+          const size_t mask = index.size() - 1;
+          size_t place = StartPlace(key);
+          while (index[place] != Empty)
+          {
+            place = (place + 1) & mask;
+          }
+          return place;
+        }
+
+        void Rebuild(unsigned bits)
+        {
+          indexBits = bits;
+          index.assign(size_t(1) << bits, Empty);
+          for (size_t entry = 0; entry < entries.size(); ++entry)
+          {
+            index[FreePlace(entries[entry].first)] = entry;
+          }
+        }
+
+        std::vector<value_type> entries; //! The entries, in the order they were inserted
+        std::vector<size_t> index; //! The entry at each place in the index, or Empty
+        unsigned indexBits; //! The size of the index is 2 to this power
+    };
+
+    template<class Key, class T, class HashType>
+    const size_t HashMap<Key, T, HashType>::Empty;
+  }
+}
+
+#endif // HEMELB_UTIL_HASHMAP_H
@@ -0,0 +1,76 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UTIL_HILBERTORDER_H
+#define HEMELB_UTIL_HILBERTORDER_H
+
+#include "units.h"
+#include "util/MortonOrder.h"
+#include "util/Vector3D.h"
+
+namespace hemelb
+{
+  namespace util
+  {
+    /**
+     * Get the position of the given (non-negative) coordinates along a 3D Hilbert curve through
+     * a cube of side 2^21. Unlike the Morton curve, consecutive positions are always adjacent
+     * sites, so any range of positions is a compact, connected region. The curve starts at the
+     * origin, and its first 8^n positions fill the cube of side 2^n there. Only the lowest 21
+     * bits of each coordinate are used.
+     *
+     * Uses J. Skilling's transform, "Programming the Hilbert curve", AIP Conf. Proc. 707 (2004).
+     * @param coords
+     * @return
+     */
+    inline uint64_t GetHilbertKey(const Vector3D<site_t>& coords)
+    {
+      const uint64_t highestBit = uint64_t(1) << 20;
+      uint64_t x[3] = { uint64_t(coords.x) & 0x1fffff, uint64_t(coords.y) & 0x1fffff,
+                        uint64_t(coords.z) & 0x1fffff };
+
+      // Undo the rotations and reflections of each level of the curve.
+      for (uint64_t q = highestBit; q > 1; q >>= 1)
+      {
+        const uint64_t p = q - 1;
+        for (unsigned i = 0; i < 3; ++i)
+        {
+          if (x[i] & q)
+          {
+            x[0] ^= p;
+          }
+          else
+          {
+            const uint64_t t = (x[0] ^ x[i]) & p;
+            x[0] ^= t;
+            x[i] ^= t;
+          }
+        }
+      }
+
+      // Gray-encode.
+      x[1] ^= x[0];
+      x[2] ^= x[1];
+      uint64_t t = 0;
+      for (uint64_t q = highestBit; q > 1; q >>= 1)
+      {
+        if (x[2] & q)
+        {
+          t ^= q - 1;
+        }
+      }
+      for (unsigned i = 0; i < 3; ++i)
+      {
+        x[i] ^= t;
+      }
+
+      // The key is the transposed bits interleaved, x[0] most significant in each triple.
+      return (SpreadBitsByThree(x[0]) << 2) | (SpreadBitsByThree(x[1]) << 1)
+          | SpreadBitsByThree(x[2]);
+    }
+  }
+}
+
+#endif /* HEMELB_UTIL_HILBERTORDER_H */
@@ -0,0 +1,185 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UTIL_LATTICEALLOCATOR_H
+#define HEMELB_UTIL_LATTICEALLOCATOR_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#ifdef HEMELB_USE_HUGE_PAGES
+#include <sys/mman.h>
+#endif
+
+#ifndef HEMELB_HUGE_PAGE_SIZE
+#define HEMELB_HUGE_PAGE_SIZE 2097152
+#endif
+
+namespace hemelb
+{
+  namespace util
+  {
+    /**
+     * The bytes the lattice allocator rounds large arrays up to, and aligns them on.
+     */
+    static const std::size_t HugePageSize = HEMELB_HUGE_PAGE_SIZE;
+
+    /**
+     * Allocator for the large per-site arrays of the lattice, such as the distributions.
+     *
+     * Default construction leaves the elements uninitialised, so resizing a vector doesn't
+     * touch its memory. Linux puts each page on the NUMA node of the thread that first writes
+     * to it, so the owner should first write to the elements from the threads that will work
+     * on them (see LatticeData::InitialiseDistributions).
+     *
+     * With HEMELB_USE_HUGE_PAGES, arrays of at least HugePageSize bytes are mapped directly and
+     * backed by huge pages, to cut the TLB misses of streaming through the neighbour indices.
+     * Pages of HugePageSize are asked for from hugetlbfs (MAP_HUGETLB), which needs them to
+     * have been reserved, e.g. in /proc/sys/vm/nr_hugepages; if none are free, the memory is
+     * mapped normally and transparent huge pages are asked for with madvise instead.
+     */
+    template<typename T>
+    class LatticeAllocator
+    {
+      public:
+        typedef T value_type;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+
+        template<typename U>
+        struct rebind
+        {
+            typedef LatticeAllocator<U> other;
+        };
+
+        LatticeAllocator()
+        {
+        }
+
+        template<typename U>
+        LatticeAllocator(const LatticeAllocator<U>&)
+        {
+        }
+
+        T* allocate(std::size_t count)
+        {
+          if (count == 0)
+          {
+            return NULL;
+          }
+#ifdef HEMELB_USE_HUGE_PAGES
+          if (IsMapped(count))
+          {
+            const std::size_t bytes = MappedBytes(count);
+            void* memory = MAP_FAILED;
+#ifdef MAP_HUGETLB
+            int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#if defined(MAP_HUGE_SHIFT) && HEMELB_HUGE_PAGE_SIZE == 1073741824
+            flags |= 30 << MAP_HUGE_SHIFT;
+#endif
+            memory = mmap(NULL, bytes, PROT_READ | PROT_WRITE, flags, -1, 0);
+#endif
+            if (memory == MAP_FAILED)
+            {
+              memory = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+              if (memory == MAP_FAILED)
+              {
+                throw std::bad_alloc();
+              }
+#ifdef MADV_HUGEPAGE
+              madvise(memory, bytes, MADV_HUGEPAGE);
+#endif
+            }
+            return static_cast<T*>(memory);
+          }
+#endif
+          void* memory = std::malloc(count * sizeof(T));
+          if (memory == NULL)
+          {
+            throw std::bad_alloc();
+          }
+          return static_cast<T*>(memory);
+        }
+
+        void deallocate(T* memory, std::size_t count)
+        {
+          if (memory == NULL)
+          {
+            return;
+          }
+#ifdef HEMELB_USE_HUGE_PAGES
+          if (IsMapped(count))
+          {
+            munmap(memory, MappedBytes(count));
+            return;
+          }
+#endif
+          std::free(memory);
+        }
+
+        std::size_t max_size() const
+        {
+          return std::size_t(-1) / sizeof(T);
+        }
+
+        /**
+         * Default construction, which leaves built-in types uninitialised.
+         */
+        template<typename U>
+        void construct(U* element)
+        {
+          ::new (static_cast<void*>(element)) U;
+        }
+
+        template<typename U, typename ... Args>
+        void construct(U* element, Args&&... args)
+        {
+          ::new (static_cast<void*>(element)) U(std::forward<Args>(args)...);
+        }
+
+        template<typename U>
+        void destroy(U* element)
+        {
+          element->~U();
+        }
+
+      private:
+#ifdef HEMELB_USE_HUGE_PAGES
+        static bool IsMapped(std::size_t count)
+        {
+          return count * sizeof(T) >= HugePageSize;
+        }
+
+        /**
+         * Whole huge pages, which is what munmap needs of hugetlbfs mappings.
+         */
+        static std::size_t MappedBytes(std::size_t count)
+        {
+          return (count * sizeof(T) + HugePageSize - 1) / HugePageSize * HugePageSize;
+        }
+#endif
+    };
+
+    // The allocator has no state, so any one can free what another allocated.
+    template<typename T, typename U>
+    bool operator==(const LatticeAllocator<T>&, const LatticeAllocator<U>&)
+    {
+      return true;
+    }
+
+    template<typename T, typename U>
+    bool operator!=(const LatticeAllocator<T>&, const LatticeAllocator<U>&)
+    {
+      return false;
+    }
+  }
+}
+
+#endif // HEMELB_UTIL_LATTICEALLOCATOR_H
@@ -0,0 +1,283 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UTIL_MONOTONICARENA_H
+#define HEMELB_UTIL_MONOTONICARENA_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#ifdef HEMELB_USE_OPENMP
+#include <omp.h>
+#endif
+
+namespace hemelb
+{
+  namespace util
+  {
+    /**
+     * Hands out memory for the many small, short-lived arrays of a phase such as reading the
+     * geometry, by bumping a pointer through large slabs. Nothing is freed until the whole
+     * arena is rewound or released, so there is no per-array allocator call to contend on or
+     * to fragment the heap.
+     *
+     * Rewinding forgets what has been handed out but keeps the slabs to hand out again, for
+     * buffers that are refilled over and over; releasing gives the slabs back. The arena keeps
+     * the most it has ever held, for reporting. With HEMELB_USE_OPENMP, several threads can
+     * allocate at once.
+     */
+    class MonotonicArena
+    {
+      public:
+        /**
+         * @param slabBytes The size of the slabs, bar those for allocations bigger than this.
+         */
+        explicit MonotonicArena(std::size_t slabBytes = DefaultSlabBytes) :
+            slabBytes(slabBytes), currentSlab(0), usedInSlab(0), heldBytes(0), peakBytes(0)
+        {
+#ifdef HEMELB_USE_OPENMP
+          omp_init_lock(&lock);
+#endif
+        }
+
+        ~MonotonicArena()
+        {
+          Release();
+#ifdef HEMELB_USE_OPENMP
+          omp_destroy_lock(&lock);
+#endif
+        }
+
+        /**
+         * @param bytes
+         * @param alignment A power of two.
+         * @return Memory for the given number of bytes, valid until the arena is rewound or
+         * released.
+         */
+        void* Allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t))
+        {
+#ifdef HEMELB_USE_OPENMP
+          omp_set_lock(&lock);
+#endif
+          std::size_t start = Align(usedInSlab, alignment);
+          if (currentSlab == slabs.size() || start + bytes > slabs[currentSlab].size)
+          {
+            // Slabs kept from before a rewind are reused in order, if they are big enough.
+            const std::size_t next = currentSlab == slabs.size() ?
+              currentSlab :
+              currentSlab + 1;
+            if (next == slabs.size() || bytes + alignment > slabs[next].size)
+            {
+              AddSlab(next, bytes + alignment);
+            }
+            currentSlab = next;
+            start = 0;
+          }
+          // The slabs are aligned for any type, so aligning the offset aligns the address.
+          usedInSlab = start + bytes;
+          void* memory = slabs[currentSlab].memory + start;
+#ifdef HEMELB_USE_OPENMP
+          omp_unset_lock(&lock);
+#endif
+          return memory;
+        }
+
+        /**
+         * Forget everything handed out, keeping the slabs to hand out again. Not to be called
+         * while other threads are allocating.
+         */
+        void Rewind()
+        {
+          currentSlab = 0;
+          usedInSlab = 0;
+        }
+
+        /**
+         * Forget everything handed out and free the slabs.
+         */
+        void Release()
+        {
+          for (std::vector<Slab>::iterator slab = slabs.begin(); slab != slabs.end(); ++slab)
+          {
+            std::free(slab->memory);
+          }
+          slabs.clear();
+          heldBytes = 0;
+          Rewind();
+        }
+
+        /**
+         * @return The bytes of the slabs held now.
+         */
+        std::size_t GetHeldBytes() const
+        {
+          return heldBytes;
+        }
+
+        /**
+         * @return The most bytes of slabs held at once, even if since released.
+         */
+        std::size_t GetPeakBytes() const
+        {
+          return peakBytes;
+        }
+
+        //! The size of the slabs by default.
+        static const std::size_t DefaultSlabBytes = 1 << 20;
+
+      private:
+        struct Slab
+        {
+            char* memory;
+            std::size_t size;
+        };
+
+        MonotonicArena(const MonotonicArena&);
+        MonotonicArena& operator=(const MonotonicArena&);
+
+        static std::size_t Align(std::size_t offset, std::size_t alignment)
+        {
+          return (offset + alignment - 1) & ~ (alignment - 1);
+        }
+
+        /**
+         * Add a slab at the given place among the slabs, big enough for the given bytes.
+         */
+        void AddSlab(std::size_t place, std::size_t bytes)
+        {
+          Slab slab;
+          slab.size = bytes > slabBytes ?
+            bytes :
+            slabBytes;
+          slab.memory = static_cast<char*>(std::malloc(slab.size));
+          if (slab.memory == NULL)
+          {
+#ifdef HEMELB_USE_OPENMP
+            omp_unset_lock(&lock);
+#endif
+            throw std::bad_alloc();
+          }
+          slabs.insert(slabs.begin() + place, slab);
+          heldBytes += slab.size;
+          if (heldBytes > peakBytes)
+          {
+            peakBytes = heldBytes;
+          }
+        }
+
+        const std::size_t slabBytes;
+        //! The slabs, those before currentSlab full and those after it free.
+        std::vector<Slab> slabs;
+        //! The slab being handed out from, or the number of slabs if there are none.
+        std::size_t currentSlab;
+        //! The bytes handed out from the current slab.
+        std::size_t usedInSlab;
+        std::size_t heldBytes;
+        std::size_t peakBytes;
+#ifdef HEMELB_USE_OPENMP
+        omp_lock_t lock;
+#endif
+    };
+
+    /**
+     * Standard allocator that takes memory from a MonotonicArena, or from the heap if it has
+     * none. Freeing memory from the arena does nothing; it is all freed with the arena, so the
+     * containers must not outlive it. Containers take their allocator with them when assigned,
+     * so that they keep freeing memory the way it was allocated.
+     */
+    template<typename T>
+    class ArenaAllocator
+    {
+      public:
+        typedef T value_type;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef std::true_type propagate_on_container_copy_assignment;
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type propagate_on_container_swap;
+
+        template<typename U>
+        struct rebind
+        {
+            typedef ArenaAllocator<U> other;
+        };
+
+        ArenaAllocator(MonotonicArena* arena = NULL) :
+            arena(arena)
+        {
+        }
+
+        template<typename U>
+        ArenaAllocator(const ArenaAllocator<U>& other) :
+            arena(other.GetArena())
+        {
+        }
+
+        T* allocate(std::size_t count)
+        {
+          if (arena != NULL)
+          {
+            return static_cast<T*>(arena->Allocate(count * sizeof(T), alignof(T)));
+          }
+          return static_cast<T*>(::operator new(count * sizeof(T)));
+        }
+
+        void deallocate(T* memory, std::size_t)
+        {
+          if (arena == NULL)
+          {
+            ::operator delete(memory);
+          }
+        }
+
+        std::size_t max_size() const
+        {
+          return std::size_t(-1) / sizeof(T);
+        }
+
+        template<typename U, typename ... Args>
+        void construct(U* element, Args&&... args)
+        {
+          ::new (static_cast<void*>(element)) U(std::forward<Args>(args)...);
+        }
+
+        template<typename U>
+        void destroy(U* element)
+        {
+          element->~U();
+        }
+
+        MonotonicArena* GetArena() const
+        {
+          return arena;
+        }
+
+      private:
+        MonotonicArena* arena;
+    };
+
+    // Memory can only be freed by an allocator with the same arena, or none.
+    template<typename T, typename U>
+    bool operator==(const ArenaAllocator<T>& left, const ArenaAllocator<U>& right)
+    {
+      return left.GetArena() == right.GetArena();
+    }
+
+    template<typename T, typename U>
+    bool operator!=(const ArenaAllocator<T>& left, const ArenaAllocator<U>& right)
+    {
+      return left.GetArena() != right.GetArena();
+    }
+  }
+}
+
+#endif // HEMELB_UTIL_MONOTONICARENA_H
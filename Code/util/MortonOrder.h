@@ -0,0 +1,50 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UTIL_MORTONORDER_H
+#define HEMELB_UTIL_MORTONORDER_H
+
+#include "units.h"
+#include "util/Vector3D.h"
+
+namespace hemelb
+{
+  namespace util
+  {
+    /**
+     * Spread the lowest 21 bits of value out so that there are two zero bits between each of
+     * them.
+     * @param value
+     * @return
+     */
+    inline uint64_t SpreadBitsByThree(uint64_t value)
+    {
+      value &= 0x1fffff;
+      value = (value | value << 32) & 0x1f00000000ffffULL;
+      value = (value | value << 16) & 0x1f0000ff0000ffULL;
+      value = (value | value << 8) & 0x100f00f00f00f00fULL;
+      value = (value | value << 4) & 0x10c30c30c30c30c3ULL;
+      value = (value | value << 2) & 0x1249249249249249ULL;
+      return value;
+    }
+
+    /**
+     * Get the position of the given (non-negative) coordinates along the Morton (Z-order)
+     * space-filling curve, i.e. the bits of the coordinates interleaved, x lowest. Sorting by
+     * this key keeps sites that are close in space close together. Only the lowest 21 bits of
+     * each coordinate are used.
+     * @param coords
+     * @return
+     */
+    inline uint64_t GetMortonKey(const Vector3D<site_t>& coords)
+    {
+      return SpreadBitsByThree(coords.x) | (SpreadBitsByThree(coords.y) << 1)
+          | (SpreadBitsByThree(coords.z) << 2);
+    }
+  }
+}
+
+#endif /* HEMELB_UTIL_MORTONORDER_H */
@@ -45,6 +45,41 @@ namespace hemelb
          */
         bool RequiresRefresh() const;
 
+        /**
+         * Change which indices the cache holds. A cached index is stored at position
+         * (*indexMap)[index]; indices mapped to a negative position aren't stored at all, and
+         * Put ignores them. With a NULL map every index is stored at its own position. Any
+         * cached values are discarded.
+         * @param indexMap
+         * @param size The number of positions the cache needs.
+         */
+        void SetIndexMap(const std::vector<site_t>* indexMap, unsigned long size);
+
+        /**
+         * Obtain an object from the cache. The index should be cached (see SetIndexMap); if it
+         * isn't, this gives a default-constructed object.
+         * NOTE: This covers the method in the base class, to go through the index map.
+         * @param index
+         * @return
+         */
+        const CacheType& Get(unsigned long index) const;
+
+        /**
+         * Inserts the given object into the cache at the given index, if that index is cached.
+         * NOTE: This covers the method in the base class, to go through the index map.
+         * @param index
+         * @param item
+         */
+        void Put(unsigned long index, const CacheType& item);
+
+        /**
+         * Gets the cached objects, in index order, for reading them without copying.
+         * NOTE: This covers the method in the base class, as the objects are only in index order
+         * without an index map.
+         * @return The objects, or NULL if there is an index map or none are held.
+         */
+        const CacheType* GetData() const;
+
       private:
         /**
          * Boolean to indicate whether the cache needs refreshing.
@@ -54,6 +89,10 @@ namespace hemelb
          * The size of cache that may be required.
          */
         unsigned long cacheSize;
+        /**
+         * The position in the cache of each index, or NULL if every index is at its own.
+         */
+        const std::vector<site_t>* indexMap;
     };
   }
 }
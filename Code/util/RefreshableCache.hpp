@@ -21,7 +21,8 @@ namespace hemelb
      */
     template<typename CacheType>
     RefreshableCache<CacheType>::RefreshableCache(const lb::SimulationState& simulationState, unsigned long size) :
-        CheckingCache<CacheType>(simulationState, size), requiresRefreshing(false), cacheSize(size)
+        CheckingCache<CacheType>(simulationState, size), requiresRefreshing(false), cacheSize(size),
+            indexMap(NULL)
     {
 
     }
@@ -44,6 +45,61 @@ namespace hemelb
     {
       return requiresRefreshing;
     }
+
+    template<typename CacheType>
+    void RefreshableCache<CacheType>::SetIndexMap(const std::vector<site_t>* newIndexMap,
+                                                  unsigned long size)
+    {
+      indexMap = newIndexMap;
+      cacheSize = size;
+      // Release first, so that shrinking the cache gives the memory back.
+      CheckingCache<CacheType>::Release();
+      CheckingCache<CacheType>::Reserve(cacheSize);
+    }
+
+    template<typename CacheType>
+    const CacheType& RefreshableCache<CacheType>::Get(unsigned long index) const
+    {
+      if (indexMap == NULL)
+      {
+        return CheckingCache<CacheType>::Get(index);
+      }
+      const site_t position = (*indexMap)[index];
+      if (position < 0)
+      {
+        // Not cached, so there's nothing to give but a default-constructed value.
+        if (log::Logger::ShouldDisplay<log::Debug>())
+        {
+          log::Logger::Log<log::Warning, log::OnePerCore>("The cache doesn't hold index %lu", index);
+        }
+        static const CacheType uncached = CacheType();
+        return uncached;
+      }
+      return CheckingCache<CacheType>::Get(position);
+    }
+
+    template<typename CacheType>
+    void RefreshableCache<CacheType>::Put(unsigned long index, const CacheType& item)
+    {
+      if (indexMap == NULL)
+      {
+        CheckingCache<CacheType>::Put(index, item);
+      }
+      else if ( (*indexMap)[index] >= 0)
+      {
+        CheckingCache<CacheType>::Put((*indexMap)[index], item);
+      }
+    }
+
+    template<typename CacheType>
+    const CacheType* RefreshableCache<CacheType>::GetData() const
+    {
+      if (indexMap != NULL)
+      {
+        return NULL;
+      }
+      return CheckingCache<CacheType>::GetData();
+    }
   }
 }
 
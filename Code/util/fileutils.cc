@@ -16,6 +16,7 @@
 #include <sstream>
 #include "log/Logger.h"
 #include "util/fileutils.h"
+#include "Exception.h"
 
 namespace hemelb
 {
@@ -204,5 +205,26 @@ namespace hemelb
       return baseDir + inPath;
     }
 
+    std::vector<std::string> ReadPathList(const std::string& listPath)
+    {
+      std::ifstream list(listPath.c_str());
+      if (!list)
+      {
+        throw Exception() << "Could not open the list of files " << listPath;
+      }
+      std::vector<std::string> paths;
+      std::string line;
+      while (std::getline(list, line))
+      {
+        std::istringstream words(line);
+        std::string path;
+        if (words >> path && path[0] != '#')
+        {
+          paths.push_back(NormalizePathRelativeToPath(path, listPath));
+        }
+      }
+      return paths;
+    }
+
   }
 }
@@ -9,6 +9,7 @@
 
 #include <dirent.h>
 #include <string>
+#include <vector>
 
 // Define a suitable type for the system we're on
 // (scandir has slightly different definitions on different
@@ -47,6 +48,10 @@ namespace hemelb
     // the containing directory).
     std::string NormalizePathRelativeToPath(std::string inPath, std::string basePath);
 
+    // Read a list of files, one per line and relative to the list. Blank lines and lines
+    // starting with # are skipped.
+    std::vector<std::string> ReadPathList(const std::string& listPath);
+
     std::string GetTemporaryDir();
 
     void ChangeDirectory(const char * target);
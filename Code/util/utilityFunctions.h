@@ -170,6 +170,33 @@ namespace hemelb
           return x;
         }
 
+        /*
+         * As NewtonRaphson, but gives up after maxIterations and says whether it converged, so
+         * that a caller with a good initial guess can try it before a slower, safer method.
+         */
+        template<class F>
+        static bool NewtonRaphson(F* func, double x0, double alphaAcc, unsigned maxIterations,
+                                  double& root)
+        {
+          double f, df;
+          root = x0;
+
+          for (unsigned i = 0; i < maxIterations; i++)
+          {
+            (*func)(root, f, df);
+
+            const double dx = f / df;
+            root -= dx;
+
+            if (std::fabs(dx) < alphaAcc)
+            {
+              return true;
+            }
+          }
+
+          return false;
+        }
+
         /*
          * Finds root using Brent's method. Needs to be given a bracket enclosing the root.
          * The caller must check if a root is enclosed so that he can specify the result in that case
@@ -278,8 +305,37 @@ namespace hemelb
         }
     };
 
+    // Splits [first, first + count) into blockCount contiguous blocks, as even as possible with
+    // the first (count % blockCount) one longer, and gets the range of the given block.
+    template<typename Index>
+    void GetBlockRange(Index first, Index count, Index block, Index blockCount, Index& blockFirst,
+                       Index& blockSize)
+    {
+      const Index baseSize = count / blockCount;
+      const Index remainder = count % blockCount;
+      blockSize = baseSize + (block < remainder ?
+        1 :
+        0);
+      blockFirst = first + block * baseSize + (block < remainder ?
+        block :
+        remainder);
+    }
+
     // Returns the number of seconds to 6dp elapsed since the Epoch
     double myClock();
+
+    // Returns the bytes allocated for the elements of a vector, including unused capacity
+    template<typename T, typename Allocator>
+    size_t VectorBytes(const std::vector<T, Allocator>& vector)
+    {
+      return vector.capacity() * sizeof(T);
+    }
+
+    // As above, but vector<bool> packs its elements into bits
+    inline size_t VectorBytes(const std::vector<bool>& vector)
+    {
+      return (vector.capacity() + 7) / 8;
+    }
   }
 }
 
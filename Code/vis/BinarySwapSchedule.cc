@@ -0,0 +1,67 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "vis/BinarySwapSchedule.h"
+
+namespace hemelb
+{
+  namespace vis
+  {
+    BinarySwapSchedule::BinarySwapSchedule(proc_t rank, proc_t firstRank, proc_t size, int columns) :
+        foldTarget(-1), foldSource(-1), holdsStrip(false), stripHolderCount(0)
+    {
+      const proc_t participants = size - firstRank;
+      if (participants < 1)
+      {
+        return;
+      }
+
+      stripHolderCount = 1;
+      while ( (stripHolderCount << 1) <= participants)
+      {
+        stripHolderCount <<= 1;
+      }
+
+      if (rank < firstRank)
+      {
+        return;
+      }
+
+      const proc_t index = rank - firstRank;
+      if (index >= stripHolderCount)
+      {
+        foldTarget = rank - stripHolderCount;
+        return;
+      }
+
+      holdsStrip = true;
+      if (index + stripHolderCount < participants)
+      {
+        foldSource = rank + stripHolderCount;
+      }
+
+      int firstColumn = 0;
+      int endColumn = columns;
+      for (proc_t bit = 1; bit < stripHolderCount; bit <<= 1)
+      {
+        const int middleColumn = firstColumn + (endColumn - firstColumn) / 2;
+        if ( (index & bit) == 0)
+        {
+          endColumn = middleColumn;
+        }
+        else
+        {
+          firstColumn = middleColumn;
+        }
+
+        Exchange exchange;
+        exchange.partner = firstRank + (index ^ bit);
+        exchange.firstColumn = firstColumn;
+        exchange.endColumn = endColumn;
+        exchanges.push_back(exchange);
+      }
+    }
+  }
+}
@@ -0,0 +1,118 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_VIS_BINARYSWAPSCHEDULE_H
+#define HEMELB_VIS_BINARYSWAPSCHEDULE_H
+
+#include <vector>
+#include "units.h"
+
+namespace hemelb
+{
+  namespace vis
+  {
+    /**
+     * The exchanges one rank makes to composite an image by binary swap.
+     *
+     * The ranks from the first compositing rank upwards take part. If there are more of them than
+     * the largest power of two that fits, those beyond it first send their whole rendering to the
+     * rank that power of two below them, and drop out. The rest then go through a round per bit
+     * of their index, lowest first: in each round a rank swaps with the rank whose index differs
+     * by that bit, keeping one half of the columns it is responsible for (the lower half if the
+     * bit is clear in its index) and sending the pixels in the other half to its partner. Every
+     * round each rank sends and receives at most half of what it did the round before, and
+     * afterwards each holds the finished pixels of its own strip of columns, disjoint from the
+     * others, to be gathered onto the IO rank.
+     */
+    class BinarySwapSchedule
+    {
+      public:
+        /**
+         * A swap with one partner.
+         */
+        struct Exchange
+        {
+            proc_t partner;
+            //! The first column of the strip kept after the exchange.
+            int firstColumn;
+            //! One past the last column of the strip kept after the exchange.
+            int endColumn;
+        };
+
+        /**
+         * @param rank This rank.
+         * @param firstRank The first rank that takes part in compositing.
+         * @param size The number of ranks.
+         * @param columns The width of the image in pixels.
+         */
+        BinarySwapSchedule(proc_t rank, proc_t firstRank, proc_t size, int columns);
+
+        /**
+         * Whether this rank sends its whole rendering to another before the rounds begin.
+         * @return
+         */
+        bool SendsWholeRendering() const
+        {
+          return foldTarget >= 0;
+        }
+
+        proc_t GetFoldTarget() const
+        {
+          return foldTarget;
+        }
+
+        /**
+         * Whether this rank receives the whole rendering of another before the rounds begin.
+         * @return
+         */
+        bool ReceivesWholeRendering() const
+        {
+          return foldSource >= 0;
+        }
+
+        proc_t GetFoldSource() const
+        {
+          return foldSource;
+        }
+
+        /**
+         * The exchanges of each round, in order. Empty for ranks that don't hold a strip.
+         * @return
+         */
+        const std::vector<Exchange>& GetExchanges() const
+        {
+          return exchanges;
+        }
+
+        /**
+         * Whether this rank ends up holding a strip of the image.
+         * @return
+         */
+        bool HoldsStrip() const
+        {
+          return holdsStrip;
+        }
+
+        /**
+         * The ranks that end up holding a strip of the image, which are contiguous from the first
+         * compositing rank.
+         * @return
+         */
+        proc_t GetStripHolderCount() const
+        {
+          return stripHolderCount;
+        }
+
+      private:
+        proc_t foldTarget;
+        proc_t foldSource;
+        bool holdsStrip;
+        proc_t stripHolderCount;
+        std::vector<Exchange> exchanges;
+    };
+  }
+}
+
+#endif /* HEMELB_VIS_BINARYSWAPSCHEDULE_H */
@@ -0,0 +1,61 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <cmath>
+
+#include "util/utilityFunctions.h"
+#include "vis/ColourPalette.h"
+
+namespace hemelb
+{
+  namespace vis
+  {
+    ColourPalette::ColourPalette()
+    {
+      for (int entry = 0; entry < TableSize; ++entry)
+      {
+        float colour[3];
+        Evaluate(float(entry) / float(TableSize - 1), colour);
+        for (int channel = 0; channel < 3; ++channel)
+        {
+          colours[entry][channel] = (unsigned char) util::NumericalFunctions::enforceBounds(int(255.0F
+                                                                                                * colour[channel]),
+                                                                                            0,
+                                                                                            255);
+        }
+      }
+    }
+
+    const ColourPalette& ColourPalette::Table()
+    {
+      // Built on first use, which C++11 makes safe for the rendering thread too.
+      static const ColourPalette table;
+      return table;
+    }
+
+    void ColourPalette::PickColour(float value, unsigned char colour[3])
+    {
+      // Comparisons that are false for NaN leave it at the bottom of the palette.
+      const int entry = value > 0.F ?
+        value < 1.F ?
+          int(value * float(TableSize - 1) + 0.5F) :
+          TableSize - 1 :
+        0;
+      const unsigned char* const tabulated = Table().colours[entry];
+      colour[0] = tabulated[0];
+      colour[1] = tabulated[1];
+      colour[2] = tabulated[2];
+    }
+
+    void ColourPalette::Evaluate(float value, float colour[3])
+    {
+      colour[0] = util::NumericalFunctions::enforceBounds<float>(4.F * value - 2.F, 0.F, 1.F);
+      colour[1] = util::NumericalFunctions::enforceBounds<float>(2.F - 4.F * (float) std::fabs(value - 0.5F),
+                                                                 0.F,
+                                                                 1.F);
+      colour[2] = util::NumericalFunctions::enforceBounds<float>(2.F - 4.F * value, 0.F, 1.F);
+    }
+  }
+}
@@ -0,0 +1,49 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_VIS_COLOURPALETTE_H
+#define HEMELB_VIS_COLOURPALETTE_H
+
+namespace hemelb
+{
+  namespace vis
+  {
+    /**
+     * The blue-green-red palette the images colour scalar quantities with, as a lookup table.
+     * The rays carry the quantities they have accumulated and are only coloured once the image
+     * has been composited, so each pixel is looked up once, rather than every voxel of every ray
+     * being mapped.
+     */
+    class ColourPalette
+    {
+      public:
+        /**
+         * The colour of a value, which is clamped to between 0 and 1.
+         * @param value
+         * @param colour The red, green and blue, between 0 and 255.
+         */
+        static void PickColour(float value, unsigned char colour[3]);
+
+        /**
+         * The palette's own colour of a value, as the table samples it.
+         * @param value
+         * @param colour The red, green and blue, between 0 and 1.
+         */
+        static void Evaluate(float value, float colour[3]);
+
+        //! The number of values the table has colours for, evenly spaced from 0 to 1.
+        static const int TableSize = 1024;
+
+      private:
+        ColourPalette();
+
+        static const ColourPalette& Table();
+
+        unsigned char colours[TableSize][3];
+    };
+  }
+}
+
+#endif /* HEMELB_VIS_COLOURPALETTE_H */
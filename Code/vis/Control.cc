@@ -4,15 +4,19 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <algorithm>
 #include <vector>
 #include <cmath>
+#include <cstring>
 #include <limits>
 
+#include "Exception.h"
 #include "log/Logger.h"
 #include "util/utilityFunctions.h"
 #include "vis/Control.h"
 #include "vis/rayTracer/RayTracer.h"
 #include "vis/GlyphDrawer.h"
+#include "vis/ImageEncoding.h"
 
 #include "io/writers/xdr/XdrFileWriter.h"
 
@@ -27,8 +31,21 @@ namespace hemelb
                      const lb::MacroscopicPropertyCache& propertyCache,
                      geometry::LatticeData* iLatDat,
                      reporting::Timer &atimer) :
+#ifdef HEMELB_USE_ASYNC_RENDERING
+        net::PhasedBroadcastIrregular<true, 2, 0, false, true>(netIn,
+                                                               simState,
+                                                               SPREADFACTOR,
+                                                               ASYNC_RENDER_ITERATIONS),
+        propertyCache(propertyCache), latticeData(iLatDat), normalRayTracer(NULL),
+            myGlypher(NULL), myStreaker(NULL), timer(atimer),
+            renderedState(simState->GetTimeStepLength(), simState->GetTotalTimeSteps()),
+            renderedProperties(renderedState, *iLatDat), renderInProgress(false),
+            renderStartIteration(0), renderedRays(NULL), renderedGlyphs(NULL), renderedStreaks(NULL)
+#else
         net::PhasedBroadcastIrregular<true, 2, 0, false, true>(netIn, simState, SPREADFACTOR),
-        propertyCache(propertyCache), latticeData(iLatDat), timer(atimer)
+        propertyCache(propertyCache), latticeData(iLatDat), normalRayTracer(NULL),
+            myGlypher(NULL), myStreaker(NULL), timer(atimer)
+#endif
     {
 
       visSettings.mStressType = iStressType;
@@ -43,6 +60,20 @@ namespace hemelb
       visSettings.mouse_x = -1;
       visSettings.mouse_y = -1;
 
+      visSettings.imageEncoding = io::formats::image::RawEncoding;
+      visSettings.networkImageEncoding = io::formats::image::RawEncoding;
+      visSettings.progressiveStride = 1;
+
+      projection.pixelsX = 0;
+      projection.pixelsY = 0;
+      projection.longitude = 0.F;
+      projection.latitude = 0.F;
+      projection.zoom = 0.F;
+      screenStride = 1;
+      detailStride = 1;
+      fullDetailRequested = false;
+      allViewsRequested = false;
+
       initLayers();
     }
 
@@ -91,6 +122,25 @@ namespace hemelb
       visSettings.ctr_y = 0.5F * (float) (latticeData->GetBlockSize() * (mins[1] + maxes[1]));
       visSettings.ctr_z = 0.5F * (float) (latticeData->GetBlockSize() * (mins[2] + maxes[2]));
 
+      // Note that rtInit does stuff to this->ctr_x (because this has
+      // to be global)
+      visSettings.ctr_x -= vis->half_dim[0];
+      visSettings.ctr_y -= vis->half_dim[1];
+      visSettings.ctr_z -= vis->half_dim[2];
+    }
+
+    unsigned long Control::Start()
+    {
+      if (normalRayTracer == NULL)
+      {
+        CreateDrawers();
+      }
+      return base::Start();
+    }
+
+    void Control::CreateDrawers()
+    {
+      timer.Start();
       normalRayTracer =
           new raytracer::RayTracer<raytracer::ClusterWithWallNormals, raytracer::RayDataNormal>(latticeData,
                                                                                                 &domainStats,
@@ -105,11 +155,13 @@ namespace hemelb
 #else
       myStreaker = NULL;
 #endif
-      // Note that rtInit does stuff to this->ctr_x (because this has
-      // to be global)
-      visSettings.ctr_x -= vis->half_dim[0];
-      visSettings.ctr_y -= vis->half_dim[1];
-      visSettings.ctr_z -= vis->half_dim[2];
+      timer.Stop();
+    }
+
+    bool Control::Projection::operator==(const Projection& other) const
+    {
+      return pixelsX == other.pixelsX && pixelsY == other.pixelsY && centre == other.centre
+          && longitude == other.longitude && latitude == other.latitude && zoom == other.zoom;
     }
 
     void Control::SetProjection(const int &iPixels_x,
@@ -120,35 +172,196 @@ namespace hemelb
                                 const float &iLongitude,
                                 const float &iLatitude,
                                 const float &iZoom)
+    {
+      FinishRendering();
+
+      Projection requested;
+      requested.pixelsX = iPixels_x;
+      requested.pixelsY = iPixels_y;
+      requested.centre = util::Vector3D<float>(iLocal_ctr_x, iLocal_ctr_y, iLocal_ctr_z);
+      requested.longitude = iLongitude;
+      requested.latitude = iLatitude;
+      requested.zoom = iZoom;
+
+      if (! (requested == projection))
+      {
+        detailStride = visSettings.progressiveStride;
+      }
+      projection = requested;
+
+      ApplyProjection(detailStride);
+    }
+
+    void Control::ApplyProjection(unsigned int stride)
     {
       float rad = 5.F * vis->system_size;
-      float dist = 0.5F * rad;
 
       //For now set the maximum draw distance to twice the radius;
       visSettings.maximumDrawDistance = 2.0F * rad;
 
-      util::Vector3D<float> centre = util::Vector3D<float>(iLocal_ctr_x, iLocal_ctr_y, iLocal_ctr_z);
+      PointView(projection, stride, viewpoint, screen);
+      screenStride = stride;
+    }
 
-      viewpoint.SetViewpointPosition(iLongitude * (float) DEG_TO_RAD,
-                                     iLatitude * (float) DEG_TO_RAD,
-                                     centre,
+    void Control::PointView(const Projection& projection,
+                            unsigned int stride,
+                            Viewpoint& viewpoint,
+                            Screen& screen) const
+    {
+      float rad = 5.F * vis->system_size;
+      float dist = 0.5F * rad;
+
+      viewpoint.SetViewpointPosition(projection.longitude * (float) DEG_TO_RAD,
+                                     projection.latitude * (float) DEG_TO_RAD,
+                                     projection.centre,
                                      rad,
                                      dist);
 
-      screen.Set( (0.5F * vis->system_size) / iZoom,
-                 (0.5F * vis->system_size) / iZoom,
-                 iPixels_x,
-                 iPixels_y,
+      // The coarse screen covers whole blocks of the image, so may reach a little past its edges.
+      const int coarsePixelsX = (projection.pixelsX + stride - 1) / stride;
+      const int coarsePixelsY = (projection.pixelsY + stride - 1) / stride;
+      const float overhangX = projection.pixelsX > 0 ?
+        float(coarsePixelsX * stride) / float(projection.pixelsX) :
+        1.F;
+      const float overhangY = projection.pixelsY > 0 ?
+        float(coarsePixelsY * stride) / float(projection.pixelsY) :
+        1.F;
+
+      screen.Set(overhangX * (0.5F * vis->system_size) / projection.zoom,
+                 overhangY * (0.5F * vis->system_size) / projection.zoom,
+                 coarsePixelsX,
+                 coarsePixelsY,
                  rad,
                  &viewpoint);
     }
 
+    unsigned int Control::AddView(int pixelsX,
+                                  int pixelsY,
+                                  float longitude,
+                                  float latitude,
+                                  float zoom,
+                                  VisSettings::Mode mode)
+    {
+      FinishRendering();
+
+      View view;
+      view.projection.pixelsX = pixelsX;
+      view.projection.pixelsY = pixelsY;
+      view.projection.centre = util::Vector3D<float>(visSettings.ctr_x, visSettings.ctr_y, visSettings.ctr_z);
+      view.projection.longitude = longitude;
+      view.projection.latitude = latitude;
+      view.projection.zoom = zoom;
+      view.mode = mode;
+      views.push_back(view);
+      PointView(views.back().projection, 1, views.back().viewpoint, views.back().screen);
+
+      return (unsigned int) views.size();
+    }
+
+    unsigned int Control::GetViewCount() const
+    {
+      return 1 + (unsigned int) views.size();
+    }
+
+    VisSettings Control::GetViewSettings(unsigned int view) const
+    {
+      VisSettings settings = visSettings;
+      if (view > 0)
+      {
+        settings.mode = views[view - 1].mode;
+      }
+      return settings;
+    }
+
+    void Control::RequestAllViews()
+    {
+      allViewsRequested = true;
+    }
+
+    void Control::ChooseViews(unsigned long startIteration)
+    {
+      raytracer::ViewTile steered;
+      steered.viewpoint = &viewpoint;
+      steered.screen = &screen;
+      steered.firstColumn = 0;
+      renderTiles.assign(1, steered);
+
+      if (allViewsRequested && !views.empty())
+      {
+        // Each view starts on a new column of tiles of the pixel sets, so none are shared.
+        const int tileSize = PixelSet<ResultPixel>::TILE_SIZE;
+        std::vector<int>& columns = viewColumnsByStartIt[startIteration];
+        columns.clear();
+        int column = screen.GetPixelsX();
+        for (std::vector<View>::const_iterator view = views.begin(); view != views.end(); ++view)
+        {
+          column = (column + tileSize - 1) / tileSize * tileSize;
+          raytracer::ViewTile tile;
+          tile.viewpoint = &view->viewpoint;
+          tile.screen = &view->screen;
+          tile.firstColumn = column;
+          renderTiles.push_back(tile);
+          columns.push_back(column);
+          column += view->screen.GetPixelsX();
+        }
+      }
+      allViewsRequested = false;
+    }
+
+    PixelSet<raytracer::RayDataNormal>* Control::RenderRays(const lb::MacroscopicPropertyCache& properties)
+    {
+      return normalRayTracer->Render(properties, renderTiles);
+    }
+
+    void Control::ChooseDetail(unsigned long startIteration)
+    {
+      const unsigned int stride = fullDetailRequested ?
+        1 :
+        detailStride;
+      fullDetailRequested = false;
+
+      if (stride != screenStride)
+      {
+        ApplyProjection(stride);
+      }
+      stridesByStartIt[startIteration] = stride;
+
+      detailStride = util::NumericalFunctions::max(1U, detailStride / 2);
+    }
+
+    void Control::RequestFullDetail()
+    {
+      fullDetailRequested = true;
+    }
+
+    void Control::ExpandCoarsePixels(PixelSet<ResultPixel>& pixels, unsigned int stride) const
+    {
+      const std::vector<ResultPixel> coarsePixels(pixels.begin(), pixels.end());
+      pixels.Clear();
+
+      for (std::vector<ResultPixel>::const_iterator pixel = coarsePixels.begin(); pixel != coarsePixels.end();
+          ++pixel)
+      {
+        const int endI = util::NumericalFunctions::min(int( (pixel->GetI() + 1) * stride), projection.pixelsX);
+        const int endJ = util::NumericalFunctions::min(int( (pixel->GetJ() + 1) * stride), projection.pixelsY);
+        for (int i = pixel->GetI() * stride; i < endI; ++i)
+        {
+          for (int j = pixel->GetJ() * stride; j < endJ; ++j)
+          {
+            pixels.AddPixel(ResultPixel(*pixel, i, j));
+          }
+        }
+      }
+    }
+
     void Control::SetSomeParams(const float iBrightness,
                                 const distribn_t iDensityThresholdMin,
                                 const distribn_t iDensityThresholdMinMaxInv,
                                 const distribn_t iVelocityThresholdMaxInv,
                                 const distribn_t iStressThresholdMaxInv)
     {
+      FinishRendering();
+
       visSettings.brightness = iBrightness;
       domainStats.density_threshold_min = iDensityThresholdMin;
 
@@ -159,45 +372,143 @@ namespace hemelb
 
     void Control::UpdateImageSize(int pixels_x, int pixels_y)
     {
-      screen.Resize(pixels_x, pixels_y);
+      FinishRendering();
+
+      projection.pixelsX = pixels_x;
+      projection.pixelsY = pixels_y;
+      screen.Resize( (pixels_x + screenStride - 1) / screenStride, (pixels_y + screenStride - 1) / screenStride);
     }
 
     void Control::Render(unsigned long startIteration)
     {
       log::Logger::Log<log::Debug, log::OnePerCore>("Rendering.");
 
-      PixelSet<raytracer::RayDataNormal>* ray = normalRayTracer->Render(propertyCache);
+      ChooseDetail(startIteration);
+      ChooseViews(startIteration);
 
-      PixelSet<BasicPixel> *glyph = NULL;
+      PixelSet<raytracer::RayDataNormal>* ray = RenderRays(propertyCache);
+      PixelSet<BasicPixel>* glyph = RenderGlyphs(propertyCache);
+      PixelSet<streaklinedrawer::StreakPixel>* streak = RenderStreaklines();
 
+      localResultsByStartIt.insert(std::pair<unsigned long, Rendering>(startIteration, Rendering(glyph, ray, streak)));
+    }
+
+    PixelSet<BasicPixel>* Control::RenderGlyphs(const lb::MacroscopicPropertyCache& properties)
+    {
       if (visSettings.mode == VisSettings::ISOSURFACESANDGLYPHS)
       {
-        glyph = myGlypher->Render(propertyCache);
+        return myGlypher->Render(properties);
+      }
+
+      PixelSet<BasicPixel>* glyph = myGlypher->GetUnusedPixelSet();
+      glyph->Clear();
+      return glyph;
+    }
+
+    PixelSet<streaklinedrawer::StreakPixel>* Control::RenderStreaklines()
+    {
+      if (myStreaker != NULL
+          && (visSettings.mStressType == lb::ShearStress || visSettings.mode == VisSettings::WALLANDSTREAKLINES))
+      {
+        return myStreaker->Render();
+      }
+
+      return NULL;
+    }
+
+#ifdef HEMELB_USE_ASYNC_RENDERING
+    void Control::StartRendering(unsigned long startIteration)
+    {
+      // There's only one snapshot.
+      FinishRendering();
+
+      log::Logger::Log<log::Debug, log::OnePerCore>("Starting to render in the background.");
+
+      ChooseDetail(startIteration);
+      ChooseViews(startIteration);
+
+      // Only copy what the ray tracer and glyph drawer read.
+      renderedState.SetTimeStep(mSimState->GetTimeStep());
+      renderedProperties.densityCache.SetRefreshFlag();
+      renderedProperties.velocityCache.SetRefreshFlag();
+      const bool wallShearStress = visSettings.mStressType == lb::ShearStress;
+      if (wallShearStress)
+      {
+        renderedProperties.wallShearStressMagnitudeCache.SetRefreshFlag();
       }
       else
       {
-        glyph = myGlypher->GetUnusedPixelSet();
-        glyph->Clear();
+        renderedProperties.vonMisesStressCache.SetRefreshFlag();
       }
 
-      PixelSet<streaklinedrawer::StreakPixel> *streak = NULL;
+      for (site_t site = 0; site < latticeData->GetLocalFluidSiteCount(); ++site)
+      {
+        renderedProperties.densityCache.Put(site, propertyCache.densityCache.Get(site));
+        renderedProperties.velocityCache.Put(site, propertyCache.velocityCache.Get(site));
+        if (wallShearStress)
+        {
+          renderedProperties.wallShearStressMagnitudeCache.Put(site,
+                                                               propertyCache.wallShearStressMagnitudeCache.Get(site));
+        }
+        else
+        {
+          renderedProperties.vonMisesStressCache.Put(site, propertyCache.vonMisesStressCache.Get(site));
+        }
+      }
 
-      if (myStreaker != NULL
-          && (visSettings.mStressType == lb::ShearStress || visSettings.mode == VisSettings::WALLANDSTREAKLINES))
+      renderStartIteration = startIteration;
+      renderedStreaks = RenderStreaklines();
+
+      const int error = pthread_create(&renderThread, NULL, &Control::RenderInBackground, this);
+      if (error != 0)
       {
-        streak = myStreaker->Render();
+        throw Exception() << "Could not start the rendering thread: " << std::strerror(error);
       }
+      renderInProgress = true;
+    }
 
-      localResultsByStartIt.insert(std::pair<unsigned long, Rendering>(startIteration, Rendering(glyph, ray, streak)));
+    void* Control::RenderInBackground(void* control)
+    {
+      Control* self = static_cast<Control*>(control);
+
+      self->renderedRays = self->RenderRays(self->renderedProperties);
+      self->renderedGlyphs = self->RenderGlyphs(self->renderedProperties);
+
+      return NULL;
+    }
+#endif
+
+    void Control::FinishRendering()
+    {
+#ifdef HEMELB_USE_ASYNC_RENDERING
+      if (!renderInProgress)
+      {
+        return;
+      }
+
+      pthread_join(renderThread, NULL);
+      renderInProgress = false;
+
+      localResultsByStartIt.insert(std::pair<unsigned long, Rendering>(renderStartIteration,
+                                                                      Rendering(renderedGlyphs,
+                                                                                renderedRays,
+                                                                                renderedStreaks)));
+
+      log::Logger::Log<log::Debug, log::OnePerCore>("Background render finished.");
+#endif
     }
 
     void Control::InitialAction(unsigned long startIteration)
     {
       timer.Start();
 
+#ifdef HEMELB_USE_ASYNC_RENDERING
+      StartRendering(startIteration);
+#else
       Render(startIteration);
 
       log::Logger::Log<log::Debug, log::OnePerCore>("Render stored for phased imaging.");
+#endif
 
       timer.Stop();
     }
@@ -205,40 +516,82 @@ namespace hemelb
     void Control::WriteImage(io::writers::Writer* writer,
                              const PixelSet<ResultPixel>& imagePixels,
                              const DomainStats& domainStats,
-                             const VisSettings& visSettings) const
+                             const VisSettings& visSettings,
+                             unsigned int view) const
     {
       *writer << (int) visSettings.mode;
 
       *writer << domainStats.physical_pressure_threshold_min << domainStats.physical_pressure_threshold_max
           << domainStats.physical_velocity_threshold_max << domainStats.physical_stress_threshold_max;
 
-      *writer << screen.GetPixelsX();
-      *writer << screen.GetPixelsY();
+      *writer << GetPixelsX(view);
+      *writer << GetPixelsY(view);
       *writer << (int) imagePixels.GetPixelCount();
 
-      WritePixels(writer, imagePixels, domainStats, visSettings);
+      WritePixels(writer, imagePixels, domainStats, visSettings, visSettings.imageEncoding);
     }
 
-    int Control::GetPixelsX() const
+    size_t Control::GetMemoryUsage() const
     {
-      return screen.GetPixelsX();
+      return normalRayTracer == NULL ?
+        0 :
+        normalRayTracer->GetMemoryUsage();
+    }
+
+    int Control::GetPixelsX(unsigned int view) const
+    {
+      if (view > 0)
+      {
+        return views[view - 1].projection.pixelsX;
+      }
+      // While rendering progressively, the screen is coarser than the image.
+      return screenStride == 1 ?
+        screen.GetPixelsX() :
+        projection.pixelsX;
     }
 
-    int Control::GetPixelsY() const
+    int Control::GetPixelsY(unsigned int view) const
     {
-      return screen.GetPixelsY();
+      if (view > 0)
+      {
+        return views[view - 1].projection.pixelsY;
+      }
+      return screenStride == 1 ?
+        screen.GetPixelsY() :
+        projection.pixelsY;
     }
 
     void Control::WritePixels(io::writers::Writer* writer,
                               const PixelSet<ResultPixel>& imagePixels,
                               const DomainStats& domainStats,
-                              const VisSettings& visSettings) const
+                              const VisSettings& visSettings,
+                              io::formats::image::Encoding encoding) const
+    {
+      std::vector<uint32_t> words;
+      EncodePixels(imagePixels, domainStats, visSettings, encoding, words);
+
+      if (!words.empty())
+      {
+        writer->WriteArray(&words[0], words.size());
+      }
+    }
+
+    void Control::EncodePixels(const PixelSet<ResultPixel>& imagePixels,
+                               const DomainStats& domainStats,
+                               const VisSettings& visSettings,
+                               io::formats::image::Encoding encoding,
+                               std::vector<uint32_t>& words) const
     {
       const int bits_per_char = sizeof(char) * 8;
 
-      for (unsigned int i = 0; i < imagePixels.GetPixelCount(); i++)
+      // Each pixel is its index then three words of colour data; the images are XDR, which has
+      // no record separators, so the pixels are written in one run.
+      words.resize(4 * imagePixels.GetPixelCount());
+      unsigned int i = 0;
+      for (PixelSet<ResultPixel>::const_iterator pixelIt = imagePixels.begin();
+          pixelIt != imagePixels.end(); ++pixelIt, ++i)
       {
-        const ResultPixel& pixel = imagePixels.GetPixels()[i];
+        const ResultPixel& pixel = *pixelIt;
 
         // Use a ray-tracer function to get the necessary pixel data.
         unsigned index;
@@ -246,29 +599,29 @@ namespace hemelb
 
         pixel.WritePixel(&index, rgb_data, domainStats, visSettings);
 
-        *writer << (uint32_t) index;
-
-        unsigned pix_data[3];
-        pix_data[0] = (rgb_data[0] << (3 * bits_per_char)) + (rgb_data[1] << (2 * bits_per_char))
-            + (rgb_data[2] << bits_per_char) + rgb_data[3];
-
-        pix_data[1] = (rgb_data[4] << (3 * bits_per_char)) + (rgb_data[5] << (2 * bits_per_char))
-            + (rgb_data[6] << bits_per_char) + rgb_data[7];
+        uint32_t* const pix_data = &words[4 * i];
+        pix_data[0] = index;
 
-        pix_data[2] = (rgb_data[8] << (3 * bits_per_char)) + (rgb_data[9] << (2 * bits_per_char))
-            + (rgb_data[10] << bits_per_char) + rgb_data[11];
-
-        for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
         {
-          *writer << (uint32_t) pix_data[i];
+          const unsigned char* const rgb = rgb_data + 4 * j;
+          pix_data[j + 1] = (rgb[0] << (3 * bits_per_char)) + (rgb[1] << (2 * bits_per_char))
+              + (rgb[2] << bits_per_char) + rgb[3];
         }
-        *writer << io::writers::Writer::eol;
+      }
+
+      if (encoding == io::formats::image::DeflateEncoding)
+      {
+        std::vector<uint32_t> encoded;
+        DeflatePixels(words, encoded);
+        words.swap(encoded);
       }
     }
 
     void Control::ProgressFromChildren(unsigned long startIteration, unsigned long splayNumber)
     {
       timer.Start();
+      FinishRendering();
 
       if (splayNumber == 0)
       {
@@ -311,6 +664,7 @@ namespace hemelb
     void Control::ProgressToParent(unsigned long startIteration, unsigned long splayNumber)
     {
       timer.Start();
+      FinishRendering();
 
       Rendering& rendering = (*localResultsByStartIt.find(startIteration)).second;
       if (splayNumber == 0)
@@ -332,6 +686,7 @@ namespace hemelb
     void Control::PostReceiveFromChildren(unsigned long startIteration, unsigned long splayNumber)
     {
       timer.Start();
+      FinishRendering();
 
       // The first time round, ensure that we have enough memory to receive the image data that
       // will come next time.
@@ -370,6 +725,8 @@ namespace hemelb
 
     void Control::PostSendToParent(unsigned long startIteration, unsigned long splayNumber)
     {
+      FinishRendering();
+
       if (splayNumber == 1)
       {
         Rendering& rendering = (*localResultsByStartIt.find(startIteration)).second;
@@ -387,6 +744,7 @@ namespace hemelb
     void Control::ClearOut(unsigned long startIt)
     {
       timer.Start();
+      FinishRendering();
 
       bool found;
 
@@ -449,42 +807,200 @@ namespace hemelb
       }
       while (found);
 
+      stridesByStartIt.erase(stridesByStartIt.begin(), stridesByStartIt.upper_bound(startIt));
+      viewColumnsByStartIt.erase(viewColumnsByStartIt.begin(), viewColumnsByStartIt.upper_bound(startIt));
+
       timer.Stop();
     }
 
-    const PixelSet<ResultPixel>* Control::GetResult(unsigned long startIt)
+    const PixelSet<ResultPixel>* Control::GetResult(unsigned long startIt, unsigned int view)
     {
+      FinishRendering();
+
       log::Logger::Log<log::Trace, log::OnePerCore>("Getting image results from it %lu", startIt);
 
-      if (renderingsByStartIt.count(startIt) != 0)
+      if (renderingsByStartIt.count(startIt) == 0)
       {
-        return (*renderingsByStartIt.find(startIt)).second;
+        if (localResultsByStartIt.count(startIt) == 0)
+        {
+          return NULL;
+        }
+        SplitViews(startIt);
       }
 
-      if (localResultsByStartIt.count(startIt) != 0)
+      std::multimap<unsigned long, PixelSet<ResultPixel>*>::const_iterator result =
+          renderingsByStartIt.lower_bound(startIt);
+      for (unsigned int skipped = 0; skipped < view; ++skipped)
       {
-        Rendering finalRender = (*localResultsByStartIt.find(startIt)).second;
-        PixelSet<ResultPixel> *result = GetUnusedPixelSet();
+        ++result;
+        if (result == renderingsByStartIt.end() || result->first != startIt)
+        {
+          return NULL;
+        }
+      }
+      return result->second;
+    }
+
+    void Control::SplitViews(unsigned long startIt)
+    {
+      Rendering finalRender = (*localResultsByStartIt.find(startIt)).second;
+      PixelSet<ResultPixel> *whole = GetUnusedPixelSet();
 
-        finalRender.PopulateResultSet(result);
+      finalRender.PopulateResultSet(whole);
+
+      std::vector<PixelSet<ResultPixel>*> viewPixels(1, whole);
+      const std::map<unsigned long, std::vector<int> >::const_iterator columns = viewColumnsByStartIt.find(startIt);
+      if (columns != viewColumnsByStartIt.end())
+      {
+        // Move each view's pixels back to its own columns.
+        const std::vector<int>& firstColumns = columns->second;
+        viewPixels[0] = GetUnusedPixelSet();
+        for (size_t view = 0; view < firstColumns.size(); ++view)
+        {
+          viewPixels.push_back(GetUnusedPixelSet());
+        }
+        for (PixelSet<ResultPixel>::const_iterator pixel = whole->begin(); pixel != whole->end(); ++pixel)
+        {
+          const size_t view = std::upper_bound(firstColumns.begin(), firstColumns.end(), pixel->GetI())
+              - firstColumns.begin();
+          viewPixels[view]->AddPixel(view == 0 ?
+            *pixel :
+            ResultPixel(*pixel, pixel->GetI() - firstColumns[view - 1], pixel->GetJ()));
+        }
+        whole->Release();
+      }
 
-        renderingsByStartIt.insert(std::pair<unsigned long, PixelSet<ResultPixel>*>(startIt, result));
-        return result;
+      const std::map<unsigned long, unsigned int>::const_iterator stride = stridesByStartIt.find(startIt);
+      if (stride != stridesByStartIt.end() && stride->second > 1)
+      {
+        ExpandCoarsePixels(*viewPixels[0], stride->second);
       }
-      else
+
+      for (size_t view = 0; view < viewPixels.size(); ++view)
       {
-        return NULL;
+        renderingsByStartIt.insert(std::pair<unsigned long, PixelSet<ResultPixel>*>(startIt, viewPixels[view]));
       }
     }
 
     void Control::InstantBroadcast(unsigned long startIteration)
     {
       timer.Start();
+      FinishRendering();
 
       log::Logger::Log<log::Debug, log::OnePerCore>("Performing instant imaging.");
 
       Render(startIteration);
 
+#ifdef HEMELB_USE_BINARY_SWAP_COMPOSITING
+      CompositeByBinarySwap(startIteration);
+#else
+      CompositeUpTree(startIteration);
+#endif
+
+      timer.Stop();
+    }
+
+    Rendering Control::GetUnusedRendering()
+    {
+      return Rendering(myGlypher->GetUnusedPixelSet(),
+                       normalRayTracer->GetUnusedPixelSet(),
+                       myStreaker == NULL ?
+                         NULL :
+                         myStreaker->GetUnusedPixelSet());
+    }
+
+    void Control::CompositeByBinarySwap(unsigned long startIteration)
+    {
+      const net::MpiCommunicator& netComm = this->mNet->GetCommunicator();
+      net::Net tempNet(netComm);
+
+      // As with the tree, the IO rank takes no part until the end.
+      const raytracer::ViewTile& lastTile = renderTiles.back();
+      const BinarySwapSchedule schedule(netComm.Rank(),
+                                        1,
+                                        netComm.Size(),
+                                        lastTile.firstColumn + lastTile.screen->GetPixelsX());
+      Rendering& localBuffer = (*localResultsByStartIt.find(startIteration)).second;
+
+      if (schedule.SendsWholeRendering())
+      {
+        localBuffer.SendPixelCounts(&tempNet, schedule.GetFoldTarget());
+        tempNet.Dispatch();
+        localBuffer.SendPixelData(&tempNet, schedule.GetFoldTarget());
+        tempNet.Dispatch();
+      }
+      else if (schedule.ReceivesWholeRendering())
+      {
+        Rendering received = GetUnusedRendering();
+        received.ReceivePixelCounts(&tempNet, schedule.GetFoldSource());
+        tempNet.Dispatch();
+        received.ReceivePixelData(&tempNet, schedule.GetFoldSource());
+        tempNet.Dispatch();
+
+        localBuffer.Combine(received);
+        received.ReleaseAll();
+      }
+
+      const std::vector<BinarySwapSchedule::Exchange>& exchanges = schedule.GetExchanges();
+      for (std::vector<BinarySwapSchedule::Exchange>::const_iterator exchange = exchanges.begin();
+          exchange != exchanges.end(); ++exchange)
+      {
+        Rendering sent = GetUnusedRendering();
+        Rendering received = GetUnusedRendering();
+        localBuffer.MovePixelsOutsideColumns(exchange->firstColumn, exchange->endColumn, sent);
+
+        sent.SendPixelCounts(&tempNet, exchange->partner);
+        received.ReceivePixelCounts(&tempNet, exchange->partner);
+        tempNet.Dispatch();
+
+        sent.SendPixelData(&tempNet, exchange->partner);
+        received.ReceivePixelData(&tempNet, exchange->partner);
+        tempNet.Dispatch();
+
+        localBuffer.Combine(received);
+        sent.ReleaseAll();
+        received.ReleaseAll();
+      }
+
+      log::Logger::Log<log::Debug, log::OnePerCore>("Gathering composited image strips.");
+
+      // The strips are disjoint, so gathering them onto the IO rank needs no more merging than
+      // appending them to its own pixels.
+      if (schedule.HoldsStrip())
+      {
+        localBuffer.SendPixelCounts(&tempNet, 0);
+        tempNet.Dispatch();
+        localBuffer.SendPixelData(&tempNet, 0);
+        tempNet.Dispatch();
+      }
+      else if (netComm.Rank() == 0)
+      {
+        std::vector<Rendering> strips;
+        for (proc_t holder = 0; holder < schedule.GetStripHolderCount(); ++holder)
+        {
+          strips.push_back(GetUnusedRendering());
+          strips.back().ReceivePixelCounts(&tempNet, 1 + holder);
+        }
+        tempNet.Dispatch();
+
+        for (proc_t holder = 0; holder < schedule.GetStripHolderCount(); ++holder)
+        {
+          strips[holder].ReceivePixelData(&tempNet, 1 + holder);
+        }
+        tempNet.Dispatch();
+
+        for (proc_t holder = 0; holder < schedule.GetStripHolderCount(); ++holder)
+        {
+          localBuffer.Combine(strips[holder]);
+          strips[holder].ReleaseAll();
+        }
+
+        log::Logger::Log<log::Trace, log::OnePerCore>("Inserting image at it %lu.", startIteration);
+      }
+    }
+
+    void Control::CompositeUpTree(unsigned long startIteration)
+    {
       /*
        * We do several iterations.
        *
@@ -578,8 +1094,6 @@ namespace hemelb
       {
         receiveBuffer.ReleaseAll();
       }
-
-      timer.Stop();
     }
 
     void Control::SetMouseParams(double iPhysicalPressure, double iPhysicalStress)
@@ -595,9 +1109,7 @@ namespace hemelb
         return false;
       }
 
-      const std::vector<ResultPixel>& screenPix = result->GetPixels();
-
-      for (std::vector<ResultPixel>::const_iterator it = screenPix.begin(); it != screenPix.end(); ++it)
+      for (PixelSet<ResultPixel>::const_iterator it = result->begin(); it != result->end(); ++it)
       {
         if ( (*it).GetRayPixel() != NULL && (*it).GetI() == visSettings.mouse_x && (*it).GetJ() == visSettings.mouse_y)
         {
@@ -623,6 +1135,8 @@ namespace hemelb
 
     Control::~Control()
     {
+      FinishRendering();
+
       delete myStreaker;
       delete vis;
       delete myGlypher;
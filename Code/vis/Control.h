@@ -8,15 +8,20 @@
 #define HEMELB_VIS_CONTROL_H
 
 #include <stack>
+#ifdef HEMELB_USE_ASYNC_RENDERING
+#include <pthread.h>
+#endif
 
 #include "geometry/LatticeData.h"
 
 #include "lb/LbmParameters.h"
+#include "lb/MacroscopicPropertyCache.h"
 #include "lb/SimulationState.h"
 
 #include "net/net.h"
 #include "net/PhasedBroadcastIrregular.h"
 
+#include "vis/BinarySwapSchedule.h"
 #include "vis/DomainStats.h"
 #include "vis/GlyphDrawer.h"
 #include "vis/rayTracer/ClusterWithWallNormals.h"
@@ -46,6 +51,19 @@ namespace hemelb
      * themselves. No overlap is possible between communications at different depths as the pixels
      * must be merged before they can be passed on. We don't need to pass info top-down, we only
      * pass image components upwards towards the top node.
+     *
+     * With HEMELB_USE_ASYNC_RENDERING, the initial action only copies the properties the drawers
+     * need into a snapshot and starts ray tracing it on a background thread, and communication
+     * starts ASYNC_RENDER_ITERATIONS later, so the LB carries on stepping while the image is
+     * rendered. The thread makes no MPI calls. It is joined before anything the render uses is
+     * changed or its pixels are needed. The time it saves depends on there being a core free
+     * for it, e.g. a hyperthread.
+     *
+     * Besides the steered view, further views can be added to be rendered in the same pass, e.g.
+     * to write images of a run from several angles. The views are drawn side by side into one
+     * wide image, so every core samples the properties and sets up the traversal of each of its
+     * clusters once for all of them, and the one compositing exchange carries them all. The
+     * image is only split into the views on the IO rank.
      */
     class Control : public net::PhasedBroadcastIrregular<true, 2, 0, false, true>,
                     private PixelSetStore<PixelSet<ResultPixel> >
@@ -65,6 +83,11 @@ namespace hemelb
                            const distribn_t iVelocityThresholdMaxInv,
                            const distribn_t iStressThresholdMaxInv);
 
+        /**
+         * Set the view. If it has moved since the last call, the next images are rendered
+         * progressively: the first with a screen visSettings.progressiveStride times coarser than
+         * the image, and each after that twice as fine as the last, until they're in full detail.
+         */
         void SetProjection(const int &pixels_x,
                            const int &pixels_y,
                            const float &ctr_x,
@@ -81,21 +104,112 @@ namespace hemelb
         void UpdateImageSize(int pixels_x, int pixels_y);
         void SetMouseParams(double iPhysicalPressure, double iPhysicalStress);
 
-        const PixelSet<ResultPixel>* GetResult(unsigned long startIteration);
+        /**
+         * Add a view to be rendered along with the steered one, looking at the same centre. It is
+         * only rendered for images after RequestAllViews, and always in full detail. Its glyphs
+         * and streaklines aren't drawn, as those drawers are set up for the steered view.
+         * @param pixelsX
+         * @param pixelsY
+         * @param longitude In degrees
+         * @param latitude In degrees
+         * @param zoom
+         * @param mode How its pixels are coloured.
+         * @return The number of the view; the steered view is 0.
+         */
+        unsigned int AddView(int pixelsX,
+                             int pixelsY,
+                             float longitude,
+                             float latitude,
+                             float zoom,
+                             VisSettings::Mode mode);
+
+        /**
+         * @return The number of views, including the steered one.
+         */
+        unsigned int GetViewCount() const;
+
+        /**
+         * The settings to write a view's images with.
+         * @param view
+         * @return
+         */
+        VisSettings GetViewSettings(unsigned int view) const;
+
+        /**
+         * Get the pixels of a view of an image, on the IO rank.
+         * @param startIteration
+         * @param view
+         * @return The pixels, or NULL if the image or the view of it wasn't rendered.
+         */
+        const PixelSet<ResultPixel>* GetResult(unsigned long startIteration, unsigned int view = 0);
 
+        /**
+         * Write the pixels of an image, encoded as given.
+         * @param writer
+         * @param imagePixels
+         * @param domainStats
+         * @param visSettings
+         * @param encoding
+         */
         void WritePixels(io::writers::Writer* writer,
                          const PixelSet<ResultPixel>& imagePixels,
                          const DomainStats& domainStats,
-                         const VisSettings& visSettings) const;
+                         const VisSettings& visSettings,
+                         io::formats::image::Encoding encoding) const;
+
+        /**
+         * Get the words that WritePixels would write.
+         * @param imagePixels
+         * @param domainStats
+         * @param visSettings
+         * @param encoding
+         * @param words
+         */
+        void EncodePixels(const PixelSet<ResultPixel>& imagePixels,
+                          const DomainStats& domainStats,
+                          const VisSettings& visSettings,
+                          io::formats::image::Encoding encoding,
+                          std::vector<uint32_t>& words) const;
         void WriteImage(io::writers::Writer* writer,
                         const PixelSet<ResultPixel>& imagePixels,
                         const DomainStats& domainStats,
-                        const VisSettings& visSettings) const;
+                        const VisSettings& visSettings,
+                        unsigned int view = 0) const;
 
         bool IsRendering() const;
 
-        int GetPixelsX() const;
-        int GetPixelsY() const;
+        /**
+         * Start an image. The drawers, and the ray tracer's clusters, are only made for the
+         * first image, so a run that never renders doesn't pay for them. Like the base's, this
+         * must be called on every core at the same time step.
+         * @return The time step the image will be finished on.
+         */
+        unsigned long Start();
+
+        /**
+         * Render the next image in full detail, however recently the view moved, e.g. because it
+         * is to be written to disk.
+         */
+        void RequestFullDetail();
+
+        /**
+         * Render the next image from the added views too, not only the steered one.
+         */
+        void RequestAllViews();
+
+        /**
+         * Wait for any render in the background to finish. Anything that changes the settings
+         * the drawers use from outside should call this first.
+         */
+        void FinishRendering();
+
+        int GetPixelsX(unsigned int view = 0) const;
+        int GetPixelsY(unsigned int view = 0) const;
+
+        /**
+         * @return The bytes allocated for the ray tracer's clusters, if it has been made.
+         */
+        size_t GetMemoryUsage() const;
 
         Viewpoint viewpoint;
         DomainStats domainStats;
@@ -119,17 +233,158 @@ namespace hemelb
         // This is mainly constrained by the memory available per core.
         static const unsigned int SPREADFACTOR = 2;
 
+#ifdef HEMELB_USE_ASYNC_RENDERING
+        // The time steps a background render has before its pixels are sent on.
+        static const unsigned int ASYNC_RENDER_ITERATIONS = 4;
+#endif
+
         struct Vis
         {
             util::Vector3D<float> half_dim;
             float system_size;
         };
 
+        /**
+         * The view last asked for by SetProjection.
+         */
+        struct Projection
+        {
+            int pixelsX, pixelsY;
+            util::Vector3D<float> centre;
+            float longitude, latitude, zoom;
+
+            bool operator==(const Projection& other) const;
+        };
+
+        /**
+         * A view added to the steered one.
+         */
+        struct View
+        {
+            Projection projection;
+            VisSettings::Mode mode;
+            Viewpoint viewpoint;
+            Screen screen;
+        };
+
         void initLayers();
+
+        /**
+         * Make the ray tracer, glyph drawer and streakline drawer.
+         */
+        void CreateDrawers();
         void Render(unsigned long startIteration);
 
+        /**
+         * Point the viewpoint and screen along the projection, with a screen of one pixel for
+         * every stride x stride pixels of the image.
+         * @param stride
+         */
+        void ApplyProjection(unsigned int stride);
+
+        /**
+         * Point a viewpoint and screen along a projection, with a screen of one pixel for every
+         * stride x stride pixels of the image.
+         * @param projection
+         * @param stride
+         * @param viewpoint
+         * @param screen
+         */
+        void PointView(const Projection& projection,
+                       unsigned int stride,
+                       Viewpoint& viewpoint,
+                       Screen& screen) const;
+
+        /**
+         * Choose the views of the image starting now and lay them out side by side.
+         * @param startIteration
+         */
+        void ChooseViews(unsigned long startIteration);
+
+        /**
+         * Ray trace the views of the image being rendered, from the given properties.
+         * @param properties
+         * @return
+         */
+        PixelSet<raytracer::RayDataNormal>* RenderRays(const lb::MacroscopicPropertyCache& properties);
+
+        /**
+         * Split the composited pixels of an image into those of each of its views and keep them.
+         * @param startIteration
+         */
+        void SplitViews(unsigned long startIteration);
+
+        /**
+         * Choose the detail of the image starting now, set the screen to it, and refine the
+         * detail for the image after.
+         * @param startIteration
+         */
+        void ChooseDetail(unsigned long startIteration);
+
+        /**
+         * Turn the pixels of an image rendered with a coarse screen into the pixels of the whole
+         * image, by repeating each over the block of pixels it stands for.
+         * @param pixels
+         * @param stride
+         */
+        void ExpandCoarsePixels(PixelSet<ResultPixel>& pixels, unsigned int stride) const;
+
+        /**
+         * Draw the glyphs, if the mode has them, from the given properties.
+         * @param properties
+         * @return
+         */
+        PixelSet<BasicPixel>* RenderGlyphs(const lb::MacroscopicPropertyCache& properties);
+
+        /**
+         * Draw the streaklines, if they're being drawn.
+         * @return
+         */
+        PixelSet<streaklinedrawer::StreakPixel>* RenderStreaklines();
+
+#ifdef HEMELB_USE_ASYNC_RENDERING
+        /**
+         * Take a snapshot of the properties and start ray tracing it on the background thread.
+         * Streaklines are drawn straight away, as that communicates.
+         * @param startIteration
+         */
+        void StartRendering(unsigned long startIteration);
+
+        /**
+         * The background thread's work.
+         * @param control
+         * @return
+         */
+        static void* RenderInBackground(void* control);
+#endif
+
+        /**
+         * Get a rendering with unused pixel sets from each of the drawers.
+         * @return
+         */
+        Rendering GetUnusedRendering();
+
+        /**
+         * Composite the instant image by binary swap between the ranks other than the IO rank,
+         * then gather the strips of the image they end up with onto the IO rank.
+         * @param startIteration
+         */
+        void CompositeByBinarySwap(unsigned long startIteration);
+
+        /**
+         * Composite the instant image up a binary tree of ranks, merging at every level, then pass
+         * it from rank 1 to the IO rank.
+         * @param startIteration
+         */
+        void CompositeUpTree(unsigned long startIteration);
+
         mapType localResultsByStartIt;
+        //! The stride of the screen each image was rendered with.
+        std::map<unsigned long, unsigned int> stridesByStartIt;
+        //! The column each added view rendered in an image starts at.
+        std::map<unsigned long, std::vector<int> > viewColumnsByStartIt;
         multimapType childrenResultsByStartIt;
+        //! The pixels of each view of an image, in order.
         std::multimap<unsigned long, PixelSet<ResultPixel>*> renderingsByStartIt;
 
         /**
@@ -140,12 +395,35 @@ namespace hemelb
         geometry::LatticeData* latticeData;
         Screen screen;
         Vis* vis;
+        Projection projection;
+        //! The stride the screen is set to, and the stride of the next image.
+        unsigned int screenStride;
+        unsigned int detailStride;
+        bool fullDetailRequested;
+        std::vector<View> views;
+        bool allViewsRequested;
+        //! The views being rendered, laid out side by side.
+        std::vector<raytracer::ViewTile> renderTiles;
         raytracer::RayTracer<raytracer::ClusterWithWallNormals, raytracer::RayDataNormal>
             *normalRayTracer;
         GlyphDrawer *myGlypher;
         streaklinedrawer::StreaklineDrawer *myStreaker;
 
         reporting::Timer &timer;
+
+#ifdef HEMELB_USE_ASYNC_RENDERING
+        //! The properties as they were at the start of the render in the background, with the time
+        //! step they're from.
+        lb::SimulationState renderedState;
+        lb::MacroscopicPropertyCache renderedProperties;
+        pthread_t renderThread;
+        bool renderInProgress;
+        //! The render in progress.
+        unsigned long renderStartIteration;
+        PixelSet<raytracer::RayDataNormal>* renderedRays;
+        PixelSet<BasicPixel>* renderedGlyphs;
+        PixelSet<streaklinedrawer::StreakPixel>* renderedStreaks;
+#endif
     };
   }
 }
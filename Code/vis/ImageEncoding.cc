@@ -0,0 +1,159 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+#include <zlib.h>
+#include "vis/ImageEncoding.h"
+#include "io/formats/formats.h"
+#include "io/formats/image.h"
+#include "Exception.h"
+
+namespace hemelb
+{
+  namespace vis
+  {
+    namespace
+    {
+      const unsigned WordsPerPixel = io::formats::image::PixelLength / 4;
+      const unsigned HeaderWords = 6;
+
+      struct PixelOrder
+      {
+          const std::vector<uint32_t>& pixels;
+          explicit PixelOrder(const std::vector<uint32_t>& pixels) :
+              pixels(pixels)
+          {
+          }
+          bool operator()(size_t left, size_t right) const
+          {
+            return pixels[WordsPerPixel * left] < pixels[WordsPerPixel * right];
+          }
+      };
+    }
+
+    void DeflatePixels(std::vector<uint32_t>& pixels, std::vector<uint32_t>& encoded)
+    {
+      const size_t pixelCount = pixels.size() / WordsPerPixel;
+
+      // Sort by position, so that the differences between positions are mostly small.
+      std::vector<size_t> order(pixelCount);
+      for (size_t pixel = 0; pixel < pixelCount; ++pixel)
+      {
+        order[pixel] = pixel;
+      }
+      std::sort(order.begin(), order.end(), PixelOrder(pixels));
+      std::vector<uint32_t> sorted(pixels.size());
+      for (size_t pixel = 0; pixel < pixelCount; ++pixel)
+      {
+        std::copy(pixels.begin() + WordsPerPixel * order[pixel],
+                  pixels.begin() + WordsPerPixel * (order[pixel] + 1),
+                  sorted.begin() + WordsPerPixel * pixel);
+      }
+      pixels.swap(sorted);
+
+      std::vector<Bytef> planes(io::formats::image::PixelLength * pixelCount);
+      uint32_t previousPosition = 0;
+      for (size_t pixel = 0; pixel < pixelCount; ++pixel)
+      {
+        for (unsigned word = 0; word < WordsPerPixel; ++word)
+        {
+          uint32_t value = pixels[WordsPerPixel * pixel + word];
+          if (word == 0)
+          {
+            value -= previousPosition;
+            previousPosition = pixels[WordsPerPixel * pixel];
+          }
+          for (unsigned byte = 0; byte < 4; ++byte)
+          {
+            planes[ (4 * word + byte) * pixelCount + pixel] = Bytef(value >> (24 - 8 * byte));
+          }
+        }
+      }
+
+      // Favour speed, as this is on the IO rank in the middle of the run.
+      std::vector<Bytef> compressed;
+      uLongf compressedLength = 0;
+      if (pixelCount > 0)
+      {
+        compressedLength = compressBound(planes.size());
+        compressed.resize(compressedLength);
+        if (compress2(&compressed[0], &compressedLength, &planes[0], planes.size(), Z_BEST_SPEED)
+            != Z_OK)
+        {
+          throw Exception() << "Failed to compress an image of " << pixelCount << " pixels";
+        }
+      }
+
+      encoded.assign(HeaderWords + (compressedLength + 3) / 4, 0);
+      encoded[0] = io::formats::HemeLbMagicNumber;
+      encoded[1] = io::formats::image::MagicNumber;
+      encoded[2] = io::formats::image::VersionNumber;
+      encoded[3] = io::formats::image::DeflateEncoding;
+      encoded[4] = pixelCount;
+      encoded[5] = compressedLength;
+      // The words are written big-endian, so packing the bytes the same way writes them in order.
+      for (uLongf byte = 0; byte < compressedLength; ++byte)
+      {
+        encoded[HeaderWords + byte / 4] |= uint32_t(compressed[byte]) << (24 - 8 * (byte % 4));
+      }
+    }
+
+    void InflatePixels(const std::vector<uint32_t>& encoded, std::vector<uint32_t>& pixels)
+    {
+      if (encoded.size() < HeaderWords || encoded[0] != io::formats::HemeLbMagicNumber
+          || encoded[1] != io::formats::image::MagicNumber)
+      {
+        throw Exception() << "Not an encoded image";
+      }
+      if (encoded[2] != io::formats::image::VersionNumber
+          || encoded[3] != io::formats::image::DeflateEncoding)
+      {
+        throw Exception() << "Unsupported image version " << encoded[2] << " or encoding "
+            << encoded[3];
+      }
+      const size_t pixelCount = encoded[4];
+      const uLongf compressedLength = encoded[5];
+      if (encoded.size() < HeaderWords + (compressedLength + 3) / 4)
+      {
+        throw Exception() << "Truncated encoded image";
+      }
+
+      std::vector<Bytef> compressed(compressedLength);
+      for (uLongf byte = 0; byte < compressedLength; ++byte)
+      {
+        compressed[byte] = Bytef(encoded[HeaderWords + byte / 4] >> (24 - 8 * (byte % 4)));
+      }
+
+      std::vector<Bytef> planes(io::formats::image::PixelLength * pixelCount);
+      uLongf planesLength = planes.size();
+      if (pixelCount > 0
+          && (uncompress(&planes[0], &planesLength, &compressed[0], compressedLength) != Z_OK
+              || planesLength != planes.size()))
+      {
+        throw Exception() << "Corrupt encoded image";
+      }
+
+      pixels.assign(WordsPerPixel * pixelCount, 0);
+      uint32_t position = 0;
+      for (size_t pixel = 0; pixel < pixelCount; ++pixel)
+      {
+        for (unsigned word = 0; word < WordsPerPixel; ++word)
+        {
+          uint32_t value = 0;
+          for (unsigned byte = 0; byte < 4; ++byte)
+          {
+            value = (value << 8) | planes[ (4 * word + byte) * pixelCount + pixel];
+          }
+          if (word == 0)
+          {
+            position += value;
+            value = position;
+          }
+          pixels[WordsPerPixel * pixel + word] = value;
+        }
+      }
+    }
+  }
+}
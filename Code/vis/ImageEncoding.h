@@ -0,0 +1,33 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_VIS_IMAGEENCODING_H
+#define HEMELB_VIS_IMAGEENCODING_H
+
+#include <vector>
+#include <stdint.h>
+
+namespace hemelb
+{
+  namespace vis
+  {
+    /**
+     * Compress raw pixels, as described for io::formats::image::DeflateEncoding.
+     * @param pixels The raw pixels, four words each. Sorted by position in place.
+     * @param encoded Set to the encoded block, as words in the order they are to be written.
+     */
+    void DeflatePixels(std::vector<uint32_t>& pixels, std::vector<uint32_t>& encoded);
+
+    /**
+     * Recover the raw pixels, sorted by position, from an encoded block. Throws an Exception if
+     * the block is malformed.
+     * @param encoded
+     * @param pixels
+     */
+    void InflatePixels(const std::vector<uint32_t>& encoded, std::vector<uint32_t>& pixels);
+  }
+}
+
+#endif /* HEMELB_VIS_IMAGEENCODING_H */
@@ -1,4 +1,3 @@
-
 // This file is part of HemeLB and is Copyright (C)
 // the HemeLB team and/or their institutions, as detailed in the
 // file AUTHORS. This software is provided under the terms of the
@@ -7,8 +6,10 @@
 #ifndef HEMELB_VIS_PIXELSET_H
 #define HEMELB_VIS_PIXELSET_H
 
-#include <vector>
+#include <iterator>
 #include <map>
+#include <vector>
+#include <stdint.h>
 
 #include "log/Logger.h"
 #include "net/mpi.h"
@@ -21,19 +22,116 @@ namespace hemelb
   namespace vis
   {
     /**
-     * Base pixel set implementation, including the functionality that allows storing of pixels
-     * in a vector for speedy MPI usage, but also storing a map of pixels -> Pixel* for efficient
-     * lookup in O(N) time.
+     * A set of pixels, stored densely in square tiles of the screen, each with a mask of which of
+     * its pixels are set. Only the tiles with a pixel set are held.
+     *
+     * Combining two sets goes tile by tile: the masks say which pixels are in both, and so have
+     * to be combined, and which only in the other, and so are copied, a word of the mask at a
+     * time. The tiles of a set are also what is sent between processes, as three contiguous
+     * arrays of the tiles' positions, masks and pixels, however dense the image.
      */
     template<typename PixelType>
     class PixelSet
     {
       public:
+        //! The width and height of a tile, in pixels.
+        static const int TILE_SIZE = 32;
+        static const int TILE_PIXELS = TILE_SIZE * TILE_SIZE;
+        static const int MASK_WORDS = TILE_PIXELS / 32;
+
+        /**
+         * Goes through the set pixels, tile by tile.
+         */
+        class const_iterator : public std::iterator<std::forward_iterator_tag, PixelType,
+            std::ptrdiff_t, const PixelType*, const PixelType&>
+        {
+          public:
+            const_iterator() :
+                set(NULL), tile(0), pixel(0)
+            {
+            }
+
+            const PixelType& operator*() const
+            {
+              return set->pixels[tile * TILE_PIXELS + pixel];
+            }
+
+            const PixelType* operator->() const
+            {
+              return &**this;
+            }
+
+            const_iterator& operator++()
+            {
+              ++pixel;
+              SkipUnset();
+              return *this;
+            }
+
+            const_iterator operator++(int)
+            {
+              const_iterator previous(*this);
+              ++*this;
+              return previous;
+            }
+
+            bool operator==(const const_iterator& other) const
+            {
+              return tile == other.tile && pixel == other.pixel;
+            }
+
+            bool operator!=(const const_iterator& other) const
+            {
+              return ! (*this == other);
+            }
+
+          private:
+            friend class PixelSet<PixelType>;
+
+            const_iterator(const PixelSet<PixelType>* set, size_t tile) :
+                set(set), tile(tile), pixel(0)
+            {
+              SkipUnset();
+            }
+
+            // Move on to the next set pixel, if this one isn't.
+            void SkipUnset()
+            {
+              while (tile < set->GetTileCount())
+              {
+                while (pixel < TILE_PIXELS)
+                {
+                  const uint32_t word = set->masks[tile * MASK_WORDS + pixel / 32] >> (pixel % 32);
+                  if (word == 0)
+                  {
+                    pixel = (pixel / 32 + 1) * 32;
+                  }
+                  else if (word & 1)
+                  {
+                    return;
+                  }
+                  else
+                  {
+                    ++pixel;
+                  }
+                }
+                ++tile;
+                pixel = 0;
+              }
+            }
+
+            const PixelSet<PixelType>* set;
+            size_t tile;
+            int pixel;
+        };
 
         PixelSet()
         {
           inUse = false;
           count = 0;
+          pixelCount = 0;
+          lastTile = 0;
+          lookupStale = false;
         }
 
         ~PixelSet()
@@ -42,32 +140,93 @@ namespace hemelb
 
         void Combine(const PixelSet<PixelType> &other)
         {
-          typename std::vector<PixelType>::const_iterator otherPixels = other.pixels.begin();
-
-          while (otherPixels != other.pixels.end())
+          for (size_t otherTile = 0; otherTile < other.GetTileCount(); ++otherTile)
           {
-            AddPixel(*otherPixels);
-            otherPixels++;
+            CombineTile(other, otherTile);
           }
         }
 
         void AddPixel(const PixelType& newPixel)
         {
-          BasicPixel location = BasicPixel(newPixel.GetI(), newPixel.GetJ());
+          const int tileI = TileOf(newPixel.GetI());
+          const int tileJ = TileOf(newPixel.GetJ());
+          const size_t tile = FindOrAddTile(tileI, tileJ);
+          const int pixel = (newPixel.GetI() - tileI * TILE_SIZE) * TILE_SIZE
+              + (newPixel.GetJ() - tileJ * TILE_SIZE);
 
-          if (pixelLookup.count(location) > 0)
+          uint32_t& word = masks[tile * MASK_WORDS + pixel / 32];
+          const uint32_t bit = uint32_t(1) << (pixel % 32);
+          if (word & bit)
           {
-            pixels[pixelLookup[location]].Combine(newPixel);
+            pixels[tile * TILE_PIXELS + pixel].Combine(newPixel);
           }
           else
           {
-            pixels.push_back(PixelType(newPixel));
-            pixelLookup.insert(std::pair<BasicPixel, unsigned int>(location,
-                                                                   (unsigned int) (pixels.size()
-                                                                       - 1)));
+            pixels[tile * TILE_PIXELS + pixel] = newPixel;
+            word |= bit;
+            if (pixelCount >= 0)
+            {
+              ++pixelCount;
+            }
           }
         }
 
+        /**
+         * Move the pixels outside a range of columns into another set, keeping those inside it.
+         * Whole tiles are moved or kept, and only the tiles across an end of the range are split.
+         * @param firstColumn The first column kept.
+         * @param endColumn One past the last column kept.
+         * @param outside Has the pixels outside the range added to it.
+         */
+        void MovePixelsOutsideColumns(int firstColumn, int endColumn, PixelSet<PixelType>& outside)
+        {
+          GetPixelCount();
+          size_t kept = 0;
+          for (size_t tile = 0; tile < GetTileCount(); ++tile)
+          {
+            const int tileFirstColumn = tileCoordinates[2 * tile] * TILE_SIZE;
+            if (tileFirstColumn >= firstColumn && tileFirstColumn + TILE_SIZE <= endColumn)
+            {
+              MoveTile(tile, kept++);
+              continue;
+            }
+            if (tileFirstColumn + TILE_SIZE <= firstColumn || tileFirstColumn >= endColumn)
+            {
+              outside.CombineTile(*this, tile);
+              pixelCount -= CountTilePixels(tile);
+              continue;
+            }
+
+            // Split the tile by columns, which are runs of TILE_SIZE pixels.
+            for (int column = 0; column < TILE_SIZE; ++column)
+            {
+              const int screenColumn = tileFirstColumn + column;
+              if (screenColumn >= firstColumn && screenColumn < endColumn)
+              {
+                continue;
+              }
+              for (int pixel = column * TILE_SIZE; pixel < (column + 1) * TILE_SIZE; ++pixel)
+              {
+                uint32_t& word = masks[tile * MASK_WORDS + pixel / 32];
+                const uint32_t bit = uint32_t(1) << (pixel % 32);
+                if (word & bit)
+                {
+                  outside.AddPixel(pixels[tile * TILE_PIXELS + pixel]);
+                  word &= ~bit;
+                  --pixelCount;
+                }
+              }
+            }
+            if (CountTilePixels(tile) > 0)
+            {
+              MoveTile(tile, kept++);
+            }
+          }
+          Resize(kept);
+          lastTile = 0;
+          lookupStale = true;
+        }
+
         bool IsInUse() const
         {
           return inUse;
@@ -85,8 +244,8 @@ namespace hemelb
 
         void SendQuantity(net::Net* net, proc_t destination)
         {
-          count = (int) pixels.size();
-          log::Logger::Log<log::Trace, log::OnePerCore>("Sending pixel count of %i", count);
+          count = (int) GetTileCount();
+          log::Logger::Log<log::Trace, log::OnePerCore>("Sending tile count of %i", count);
           net->RequestSendR(count, destination);
         }
 
@@ -97,11 +256,13 @@ namespace hemelb
 
         void SendPixels(net::Net* net, proc_t destination)
         {
-          if (pixels.size() > 0)
+          if (GetTileCount() > 0)
           {
-            log::Logger::Log<log::Trace, log::OnePerCore>("Sending %i pixels to proc %i",
-                                                          (int) pixels.size(),
+            log::Logger::Log<log::Trace, log::OnePerCore>("Sending %i tiles to proc %i",
+                                                          (int) GetTileCount(),
                                                           (int) destination);
+            net->RequestSendV(tileCoordinates, destination);
+            net->RequestSendV(masks, destination);
             net->RequestSendV(pixels, destination);
           }
         }
@@ -110,34 +271,206 @@ namespace hemelb
         {
           if (count > 0)
           {
-            // First make sure the vector will be large enough to hold the incoming pixels.
-            log::Logger::Log<log::Trace, log::OnePerCore>("Receiving %i pixels from proc %i",
+            // First make sure the vectors will be large enough to hold the incoming tiles.
+            log::Logger::Log<log::Trace, log::OnePerCore>("Receiving %i tiles from proc %i",
                                                           count,
                                                           (int) source);
-            pixels.resize(count);
+            Resize(count);
+            net->RequestReceiveV(tileCoordinates, source);
+            net->RequestReceiveV(masks, source);
             net->RequestReceiveV(pixels, source);
+            // The pixels are only counted when they are needed, as they won't have arrived yet.
+            pixelCount = -1;
+            lastTile = 0;
+            lookupStale = true;
           }
         }
 
         size_t GetPixelCount() const
         {
-          return pixels.size();
+          if (pixelCount < 0)
+          {
+            pixelCount = 0;
+            for (size_t tile = 0; tile < GetTileCount(); ++tile)
+            {
+              pixelCount += CountTilePixels(tile);
+            }
+          }
+          return pixelCount;
+        }
+
+        size_t GetTileCount() const
+        {
+          return tileCoordinates.size() / 2;
+        }
+
+        const_iterator begin() const
+        {
+          return const_iterator(this, 0);
         }
 
-        const std::vector<PixelType>& GetPixels() const
+        const_iterator end() const
         {
-          return pixels;
+          return const_iterator(this, GetTileCount());
         }
 
         void Clear()
         {
-          pixelLookup.clear();
-          pixels.clear();
+          // The tiles' memory is kept for the next rendering.
+          Resize(0);
+          tileLookup.clear();
+          pixelCount = 0;
+          lastTile = 0;
+          lookupStale = false;
         }
 
       private:
-        std::map<BasicPixel, unsigned int> pixelLookup;
+        // The tile a row or column is in, rounding down for any that are off the screen.
+        static int TileOf(int coordinate)
+        {
+          return coordinate >= 0
+            ? coordinate / TILE_SIZE
+            : - ( (-coordinate - 1) / TILE_SIZE) - 1;
+        }
+
+        static int CountBits(uint32_t word)
+        {
+          int bits = 0;
+          for (; word != 0; word &= word - 1)
+          {
+            ++bits;
+          }
+          return bits;
+        }
+
+        int CountTilePixels(size_t tile) const
+        {
+          int tilePixels = 0;
+          for (int word = 0; word < MASK_WORDS; ++word)
+          {
+            tilePixels += CountBits(masks[tile * MASK_WORDS + word]);
+          }
+          return tilePixels;
+        }
+
+        void Resize(size_t tileCount)
+        {
+          tileCoordinates.resize(2 * tileCount);
+          masks.resize(MASK_WORDS * tileCount);
+          pixels.resize(TILE_PIXELS * tileCount);
+        }
+
+        size_t FindOrAddTile(int tileI, int tileJ)
+        {
+          // The renderers add pixels near each other, so the last tile is tried first.
+          if (lastTile < GetTileCount() && tileCoordinates[2 * lastTile] == tileI
+              && tileCoordinates[2 * lastTile + 1] == tileJ)
+          {
+            return lastTile;
+          }
+
+          // The lookup is out of date once the tiles have been received or moved.
+          if (lookupStale)
+          {
+            tileLookup.clear();
+            for (size_t tile = 0; tile < GetTileCount(); ++tile)
+            {
+              tileLookup[std::make_pair(tileCoordinates[2 * tile], tileCoordinates[2 * tile + 1])] =
+                  tile;
+            }
+            lookupStale = false;
+          }
+
+          const std::pair<int, int> position(tileI, tileJ);
+          const typename std::map<std::pair<int, int>, size_t>::const_iterator found =
+              tileLookup.find(position);
+          if (found != tileLookup.end())
+          {
+            lastTile = found->second;
+            return lastTile;
+          }
+
+          lastTile = GetTileCount();
+          Resize(lastTile + 1);
+          tileCoordinates[2 * lastTile] = tileI;
+          tileCoordinates[2 * lastTile + 1] = tileJ;
+          for (int word = 0; word < MASK_WORDS; ++word)
+          {
+            masks[lastTile * MASK_WORDS + word] = 0;
+          }
+          tileLookup[position] = lastTile;
+          return lastTile;
+        }
+
+        // Combine a tile of another set into this one, a word of the masks at a time.
+        void CombineTile(const PixelSet<PixelType>& other, size_t otherTile)
+        {
+          const size_t tile = FindOrAddTile(other.tileCoordinates[2 * otherTile],
+                                            other.tileCoordinates[2 * otherTile + 1]);
+          PixelType* const tilePixels = &pixels[tile * TILE_PIXELS];
+          const PixelType* const otherPixels = &other.pixels[otherTile * TILE_PIXELS];
+          for (int word = 0; word < MASK_WORDS; ++word)
+          {
+            uint32_t& mask = masks[tile * MASK_WORDS + word];
+            const uint32_t otherMask = other.masks[otherTile * MASK_WORDS + word];
+            if (otherMask == 0)
+            {
+              continue;
+            }
+            const uint32_t both = mask & otherMask;
+            const uint32_t otherOnly = otherMask & ~mask;
+            for (int bit = 0; bit < 32; ++bit)
+            {
+              const int pixel = word * 32 + bit;
+              if (both & (uint32_t(1) << bit))
+              {
+                tilePixels[pixel].Combine(otherPixels[pixel]);
+              }
+              else if (otherOnly & (uint32_t(1) << bit))
+              {
+                tilePixels[pixel] = otherPixels[pixel];
+              }
+            }
+            mask |= otherMask;
+            if (pixelCount >= 0)
+            {
+              pixelCount += CountBits(otherOnly);
+            }
+          }
+        }
+
+        // Move a tile to an earlier place, while compacting the tiles.
+        void MoveTile(size_t from, size_t to)
+        {
+          if (from == to)
+          {
+            return;
+          }
+          tileCoordinates[2 * to] = tileCoordinates[2 * from];
+          tileCoordinates[2 * to + 1] = tileCoordinates[2 * from + 1];
+          for (int word = 0; word < MASK_WORDS; ++word)
+          {
+            masks[to * MASK_WORDS + word] = masks[from * MASK_WORDS + word];
+          }
+          for (int pixel = 0; pixel < TILE_PIXELS; ++pixel)
+          {
+            pixels[to * TILE_PIXELS + pixel] = pixels[from * TILE_PIXELS + pixel];
+          }
+        }
+
+        //! The column and row, in tiles, of each tile.
+        std::vector<int> tileCoordinates;
+        //! Which of each tile's pixels are set, a bit per pixel in the order of the pixels.
+        std::vector<uint32_t> masks;
+        //! The pixels of each tile, column by column. Only those set in the masks mean anything.
         std::vector<PixelType> pixels;
+        //! Where each tile is, by its column and row.
+        std::map<std::pair<int, int>, size_t> tileLookup;
+        bool lookupStale;
+        //! The tile the last pixel went in.
+        size_t lastTile;
+        //! The number of set pixels, or -1 if they have to be counted.
+        mutable long pixelCount;
         int count;
         bool inUse;
     };
@@ -116,21 +116,37 @@ namespace hemelb
       }
     }
 
+    void Rendering::MovePixelsOutsideColumns(int firstColumn, int endColumn, Rendering& outside)
+    {
+      if (glyphResult != NULL)
+      {
+        glyphResult->MovePixelsOutsideColumns(firstColumn, endColumn, *outside.glyphResult);
+      }
+      if (rayResult != NULL)
+      {
+        rayResult->MovePixelsOutsideColumns(firstColumn, endColumn, *outside.rayResult);
+      }
+      if (streakResult != NULL)
+      {
+        streakResult->MovePixelsOutsideColumns(firstColumn, endColumn, *outside.streakResult);
+      }
+    }
+
     void Rendering::PopulateResultSet(PixelSet<ResultPixel>* resultSet)
     {
       if (glyphResult != NULL)
       {
-        AddPixelsToResultSet(resultSet, glyphResult->GetPixels());
+        AddPixelsToResultSet(resultSet, *glyphResult);
       }
 
       if (rayResult != NULL)
       {
-        AddPixelsToResultSet(resultSet, rayResult->GetPixels());
+        AddPixelsToResultSet(resultSet, *rayResult);
       }
 
       if (streakResult != NULL)
       {
-        AddPixelsToResultSet(resultSet, streakResult->GetPixels());
+        AddPixelsToResultSet(resultSet, *streakResult);
       }
     }
   }
@@ -37,14 +37,23 @@ namespace hemelb
 
         void SendPixelData(net::Net* inNet, proc_t destination);
         void Combine(const Rendering& other);
+
+        /**
+         * Move the pixels outside a range of columns into another rendering, keeping those inside
+         * it.
+         * @param firstColumn
+         * @param endColumn
+         * @param outside
+         */
+        void MovePixelsOutsideColumns(int firstColumn, int endColumn, Rendering& outside);
         void PopulateResultSet(PixelSet<ResultPixel>* resultSet);
 
       private:
         template<typename pixelType>
         void AddPixelsToResultSet(PixelSet<ResultPixel>* resultSet,
-                                  const std::vector<pixelType>& inPixels)
+                                  const PixelSet<pixelType>& inPixels)
         {
-          for (typename std::vector<pixelType>::const_iterator it = inPixels.begin(); it
+          for (typename PixelSet<pixelType>::const_iterator it = inPixels.begin(); it
               != inPixels.end(); it++)
           {
             resultSet ->AddPixel(ResultPixel(&*it));
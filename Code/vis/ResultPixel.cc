@@ -10,6 +10,12 @@ namespace hemelb
 {
   namespace vis
   {
+    ResultPixel::ResultPixel() :
+      BasicPixel(), hasGlyph(false), normalRayPixel(NULL), streakPixel(NULL)
+    {
+
+    }
+
     ResultPixel::ResultPixel(const BasicPixel* glyph) :
       BasicPixel(glyph->GetI(), glyph->GetJ()), hasGlyph(true), normalRayPixel(NULL), streakPixel(NULL)
     {
@@ -28,6 +34,13 @@ namespace hemelb
 
     }
 
+    ResultPixel::ResultPixel(const ResultPixel& pixel, int iIn, int jIn) :
+      BasicPixel(iIn, jIn), hasGlyph(pixel.hasGlyph), normalRayPixel(pixel.normalRayPixel),
+          streakPixel(pixel.streakPixel)
+    {
+
+    }
+
     const raytracer::RayDataNormal* ResultPixel::GetRayPixel() const
     {
       return normalRayPixel;
@@ -72,14 +85,8 @@ namespace hemelb
         }
         else if (stress < (float) NO_VALUE)
         {
-          float stress_col[3];
-          PickColour(stress, stress_col);
-
           // store wall shear stress colour
-          MakePixelColour(int(255.0F * stress_col[0]),
-                          int(255.0F * stress_col[1]),
-                          int(255.0F * stress_col[2]),
-                          &rgb_data[3]);
+          ColourPalette::PickColour(stress, &rgb_data[3]);
         }
         else
         {
@@ -104,8 +111,8 @@ namespace hemelb
       if (visSettings.mStressType != lb::ShearStress && visSettings.mode == VisSettings::ISOSURFACES)
       {
         float density_col[3], stress_col[3];
-        PickColour(density, density_col);
-        PickColour(stress, stress_col);
+        ColourPalette::Evaluate(density, density_col);
+        ColourPalette::Evaluate(stress, stress_col);
 
         // store wall pressure colour
         MakePixelColour(int(255.0F * density_col[0]),
@@ -123,8 +130,8 @@ namespace hemelb
       else if (visSettings.mStressType != lb::ShearStress && visSettings.mode == VisSettings::ISOSURFACESANDGLYPHS)
       {
         float density_col[3], stress_col[3];
-        PickColour(density, density_col);
-        PickColour(stress, stress_col);
+        ColourPalette::Evaluate(density, density_col);
+        ColourPalette::Evaluate(stress, stress_col);
 
         if (normalRayPixel != NULL)
         {
@@ -163,14 +170,9 @@ namespace hemelb
       else if (streakPixel != NULL)
       {
         float scaled_vel = (float) (streakPixel->GetParticleVelocity() * iDomainStats.velocity_threshold_max_inv);
-        float particle_col[3];
-        PickColour(scaled_vel, particle_col);
 
         // store particle colour
-        MakePixelColour(int(255.0F * particle_col[0]),
-                        int(255.0F * particle_col[1]),
-                        int(255.0F * particle_col[2]),
-                        &rgb_data[6]);
+        ColourPalette::PickColour(scaled_vel, &rgb_data[6]);
 
         for (int ii = 9; ii < 12; ++ii)
         {
@@ -196,13 +198,6 @@ namespace hemelb
       }
     }
 
-    void ResultPixel::PickColour(float value, float colour[3])
-    {
-      colour[0] = util::NumericalFunctions::enforceBounds<float>(4.F * value - 2.F, 0.F, 1.F);
-      colour[1] = util::NumericalFunctions::enforceBounds<float>(2.F - 4.F * (float) fabs(value - 0.5F), 0.F, 1.F);
-      colour[2] = util::NumericalFunctions::enforceBounds<float>(2.F - 4.F * value, 0.F, 1.F);
-    }
-
     void ResultPixel::MakePixelColour(int rawRed, int rawGreen, int rawBlue, unsigned char* dest)
     {
       dest[0] = (unsigned char) util::NumericalFunctions::enforceBounds(rawRed, 0, 255);
@@ -11,6 +11,7 @@
 
 #include "util/utilityFunctions.h"
 #include "vis/BasicPixel.h"
+#include "vis/ColourPalette.h"
 #include "vis/rayTracer/RayDataNormal.h"
 #include "vis/streaklineDrawer/StreakPixel.h"
 #include "vis/VisSettings.h"
@@ -23,12 +24,25 @@ namespace hemelb
     class ResultPixel : public BasicPixel
     {
       public:
+        /**
+         * An empty pixel, as the unset pixels of a PixelSet's tiles are.
+         */
+        ResultPixel();
+
         ResultPixel(const BasicPixel* glyph);
 
         ResultPixel(const raytracer::RayDataNormal* ray);
 
         ResultPixel(const streaklinedrawer::StreakPixel* streak);
 
+        /**
+         * A copy of a pixel at another position.
+         * @param pixel
+         * @param iIn
+         * @param jIn
+         */
+        ResultPixel(const ResultPixel& pixel, int iIn, int jIn);
+
         const raytracer::RayDataNormal* GetRayPixel() const;
 
         void Combine(const ResultPixel& other);
@@ -45,8 +59,6 @@ namespace hemelb
 
       private:
 
-        static void PickColour(float value, float colour[3]);
-
         static void MakePixelColour(int rawRed, int rawGreen, int rawBlue, unsigned char* dest);
 
         bool hasGlyph;
@@ -7,6 +7,7 @@
 #ifndef HEMELB_VIS_VISSETTINGS_H
 #define HEMELB_VIS_VISSETTINGS_H
 
+#include "io/formats/image.h"
 #include "lb/LbmParameters.h"
 
 namespace hemelb
@@ -41,6 +42,14 @@ namespace hemelb
         lb::StressTypes mStressType;
 
         int mouse_x, mouse_y;
+
+        //! How the pixels of images written to disk and sent to the steering client are stored.
+        io::formats::image::Encoding imageEncoding;
+        io::formats::image::Encoding networkImageEncoding;
+
+        //! The pixel stride of the first image rendered after the view moves. Each image after
+        //! that halves it until the view is at full detail. 1 renders every image in full.
+        unsigned int progressiveStride;
     };
   }
 }
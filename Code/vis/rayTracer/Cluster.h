@@ -60,6 +60,15 @@ namespace hemelb
             return Derived::DoNeedsWallNormals();
           }
 
+          /**
+           * The bytes used by the cluster, including any data it allocates.
+           * @return
+           */
+          size_t GetMemoryUsage() const
+          {
+            return sizeof(Derived) + ((const Derived*) (this))->DoGetAllocatedBytes();
+          }
+
           const std::vector<util::Vector3D<float> > GetCorners() const
           {
             std::vector<util::Vector3D<float> > lCorners;
@@ -94,6 +103,17 @@ namespace hemelb
             return false;
           }
 
+          /**
+           * The bytes of data allocated by the cluster.
+           *
+           * This can be overridden by deriving classes.
+           * @return
+           */
+          size_t DoGetAllocatedBytes() const
+          {
+            return 0;
+          }
+
           unsigned short GetBlocksX() const
           {
             return blocksX;
@@ -69,6 +69,22 @@ namespace hemelb
             return mClusters;
           }
 
+          /**
+           * The bytes allocated for the clusters and the builder's record of them.
+           * @return
+           */
+          size_t GetMemoryUsage() const
+          {
+            size_t bytes = (mClusters.capacity() - mClusters.size()) * sizeof(ClusterType)
+                + util::VectorBytes(mClusterBlockMins)
+                + mLatticeData->GetBlockCount() * sizeof(short int);
+            for (unsigned int clusterId = 0; clusterId < mClusters.size(); clusterId++)
+            {
+              bytes += mClusters[clusterId].GetMemoryUsage();
+            }
+            return bytes;
+          }
+
         private:
           // Locates all the clusters in the lattice structure and the
           void LocateClusters()
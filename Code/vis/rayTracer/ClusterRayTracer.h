@@ -10,16 +10,21 @@
 #include <cmath> 
 #include <iostream>
 #include <limits>
+#include <vector>
+#ifdef HEMELB_USE_SSE3
+  #include <immintrin.h>
+#endif
 
 #include "geometry/SiteTraverser.h"
-#include "lb/MacroscopicPropertyCache.h"
 #include "util/utilityFunctions.h"
 #include "util/Vector3D.h"
 #include "vis/DomainStats.h"
 #include "vis/PixelSet.h"
 #include "vis/rayTracer/Cluster.h"
 #include "vis/rayTracer/ClusterTraverser.h"
+#include "vis/rayTracer/ClusterView.h"
 #include "vis/rayTracer/Ray.h"
+#include "vis/rayTracer/SiteData.h"
 #include "vis/Screen.h"
 
 namespace hemelb
@@ -32,23 +37,40 @@ namespace hemelb
       class ClusterRayTracer
       {
         public:
+          /**
+           * The number of rays cast together, from neighbouring pixels in a column of the
+           * sub-image.
+           */
+          static const int RaysPerPacket = 4;
+
+          /**
+           * @param iViewpoint
+           * @param iScreen
+           * @param iDomainStats
+           * @param iVisSettings
+           * @param iLatticeData
+           * @param iSiteData The values to render at each local fluid site.
+           * @param iFirstColumn The column of the image the screen's first column is drawn in.
+           */
           ClusterRayTracer(const Viewpoint& iViewpoint,
-                           Screen& iScreen,
+                           const Screen& iScreen,
                            const DomainStats& iDomainStats,
                            const VisSettings& iVisSettings,
                            const hemelb::geometry::LatticeData& iLatticeData,
-                           const lb::MacroscopicPropertyCache& propertyCache) :
-              viewpoint(iViewpoint), screen(iScreen), domainStats(iDomainStats), visSettings(iVisSettings), latticeData(iLatticeData), propertyCache(propertyCache)
+                           const std::vector<SiteData_t>& iSiteData,
+                           int iFirstColumn = 0) :
+              viewpoint(iViewpoint), screen(iScreen), domainStats(iDomainStats), visSettings(iVisSettings), latticeData(iLatticeData), siteData(iSiteData), firstColumn(iFirstColumn)
           {
-            // TODO: This is absolutely horrible, but neccessary until RayDataNormal is
-            // removed. 
-            RayDataNormal::mDomainStats = &iDomainStats;
           }
 
-          void RenderCluster(const ClusterType& iCluster, PixelSet<RayDataType>& pixels)
+          /**
+           * Work out which rays from the viewpoint hit the cluster, and where.
+           * @param iCluster
+           * @param oView
+           */
+          void CalculateClusterView(const ClusterType& iCluster, ClusterView& oView)
           {
-            mLowerSiteCordinatesOfClusterRelativeToViewpoint = iCluster.GetLeastSiteOnLeastBlockInImage()
-                - viewpoint.GetViewpointLocation();
+            oView.clear();
 
             //Calculate the projection of the cluster on the screen
             //refered to as the subimage
@@ -65,27 +87,146 @@ namespace hemelb
 
             CalculateVectorsToClusterSpanAndLowerLeftPixel(iCluster);
 
-            CastRaysForEachPixel(iCluster, pixels);
+            FindRaysHittingCluster(oView);
+          }
+
+          /**
+           * Trace the rays that hit the cluster through it, adding a pixel for each that collects
+           * data.
+           * @param iCluster
+           * @param iView The rays that hit the cluster, from CalculateClusterView for the current
+           * viewpoint and screen.
+           * @param pixels
+           */
+          void RenderCluster(const ClusterType& iCluster, const ClusterView& iView, PixelSet<RayDataType>& pixels)
+          {
+            mLowerSiteCordinatesOfClusterRelativeToViewpoint = iCluster.GetLeastSiteOnLeastBlockInImage()
+                - viewpoint.GetViewpointLocation();
+
+            for (ClusterView::const_iterator lViewRay = iView.begin(); lViewRay != iView.end(); ++lViewRay)
+            {
+              Ray<RayDataType> lRay(lViewRay->direction, firstColumn + lViewRay->pixel.x, lViewRay->pixel.y);
+              CastRay(iCluster, lRay, lViewRay->maximumRayUnits, lViewRay->minimumRayUnits);
+
+              //Make sure the ray hasn't reached infinity
+              if (!lRay.CollectedNoData())
+              {
+                pixels.AddPixel(lRay.GetRayData());
+              }
+            }
           }
 
         private:
-          void GetRayUnitsFromViewpointToCluster(const Ray<RayDataType> & iRay,
+          /**
+           * Normalise the directions of a packet of rays and work out, for each, how many ray
+           * units get it into the cluster and after how many it is out again. A ray misses the
+           * cluster when the latter is less than the former.
+           * @param ioDirections
+           * @param oMaximumRayUnits
+           * @param oMinimumRayUnits
+           */
+#ifdef HEMELB_USE_SSE3
+          void GetRayUnitsFromViewpointToCluster(util::Vector3D<float> (&ioDirections)[RaysPerPacket],
+                                                 float (&oMaximumRayUnits)[RaysPerPacket],
+                                                 float (&oMinimumRayUnits)[RaysPerPacket])
+          {
+            __m128 x = _mm_setr_ps(ioDirections[0].x, ioDirections[1].x, ioDirections[2].x, ioDirections[3].x);
+            __m128 y = _mm_setr_ps(ioDirections[0].y, ioDirections[1].y, ioDirections[2].y, ioDirections[3].y);
+            __m128 z = _mm_setr_ps(ioDirections[0].z, ioDirections[1].z, ioDirections[2].z, ioDirections[3].z);
+
+            const __m128 magnitude = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)),
+                                                            _mm_mul_ps(z, z)));
+            x = _mm_div_ps(x, magnitude);
+            y = _mm_div_ps(y, magnitude);
+            z = _mm_div_ps(z, magnitude);
+
+            float normalised[3][RaysPerPacket];
+            _mm_storeu_ps(normalised[0], x);
+            _mm_storeu_ps(normalised[1], y);
+            _mm_storeu_ps(normalised[2], z);
+            for (int ray = 0; ray < RaysPerPacket; ++ray)
+            {
+              ioDirections[ray] = util::Vector3D<float>(normalised[0][ray], normalised[1][ray], normalised[2][ray]);
+            }
+
+            __m128 maximumRayUnits = _mm_set1_ps(std::numeric_limits<float>::max());
+            __m128 minimumRayUnits = _mm_set1_ps(-std::numeric_limits<float>::max());
+            UpdateRayUnitsForAxis(x, mViewpointCentreToMaxSite.x, mViewpointCentreToMinSite.x, maximumRayUnits, minimumRayUnits);
+            UpdateRayUnitsForAxis(y, mViewpointCentreToMaxSite.y, mViewpointCentreToMinSite.y, maximumRayUnits, minimumRayUnits);
+            UpdateRayUnitsForAxis(z, mViewpointCentreToMaxSite.z, mViewpointCentreToMinSite.z, maximumRayUnits, minimumRayUnits);
+
+            _mm_storeu_ps(oMaximumRayUnits, maximumRayUnits);
+            _mm_storeu_ps(oMinimumRayUnits, minimumRayUnits);
+          }
+
+          /**
+           * Narrow the ray units spent in the cluster by a packet of rays to those spent between
+           * the cluster's faces perpendicular to one axis. Rays parallel to those faces can leave
+           * the cluster at any distance along this axis and are treated as entering at zero.
+           * @param iDirection
+           * @param iViewpointCentreToMaxSite
+           * @param iViewpointCentreToMinSite
+           * @param ioMaximumRayUnits
+           * @param ioMinimumRayUnits
+           */
+          static void UpdateRayUnitsForAxis(const __m128 iDirection,
+                                            const float iViewpointCentreToMaxSite,
+                                            const float iViewpointCentreToMinSite,
+                                            __m128& ioMaximumRayUnits,
+                                            __m128& ioMinimumRayUnits)
+          {
+            const __m128 inverseDirection = _mm_div_ps(_mm_set1_ps(1.0F), iDirection);
+            const __m128 toMaxSite = _mm_mul_ps(_mm_set1_ps(iViewpointCentreToMaxSite), inverseDirection);
+            const __m128 toMinSite = _mm_mul_ps(_mm_set1_ps(iViewpointCentreToMinSite), inverseDirection);
+
+            const __m128 increasing = _mm_cmpgt_ps(iDirection, _mm_setzero_ps());
+            const __m128 decreasing = _mm_cmplt_ps(iDirection, _mm_setzero_ps());
+            const __m128 parallel = _mm_andnot_ps(_mm_or_ps(increasing, decreasing), _mm_castsi128_ps(_mm_set1_epi32(-1)));
+
+            const __m128 exitRayUnits = _mm_or_ps(_mm_or_ps(_mm_and_ps(increasing, toMaxSite),
+                                                            _mm_and_ps(decreasing, toMinSite)),
+                                                  _mm_and_ps(parallel, _mm_set1_ps(std::numeric_limits<float>::max())));
+            // Parallel lanes are left as zero by the masks.
+            const __m128 entryRayUnits = _mm_or_ps(_mm_and_ps(increasing, toMinSite), _mm_and_ps(decreasing, toMaxSite));
+
+            //We want the minimum number of exit units - since at this point the ray is
+            //completely out, and the maximum of entry units - since only then is it completely in
+            ioMaximumRayUnits = _mm_min_ps(ioMaximumRayUnits, exitRayUnits);
+            ioMinimumRayUnits = _mm_max_ps(ioMinimumRayUnits, entryRayUnits);
+          }
+#else
+          void GetRayUnitsFromViewpointToCluster(util::Vector3D<float> (&ioDirections)[RaysPerPacket],
+                                                 float (&oMaximumRayUnits)[RaysPerPacket],
+                                                 float (&oMinimumRayUnits)[RaysPerPacket])
+          {
+            for (int ray = 0; ray < RaysPerPacket; ++ray)
+            {
+              ioDirections[ray].Normalise();
+              GetRayUnitsFromViewpointToCluster(ioDirections[ray], oMaximumRayUnits[ray], oMinimumRayUnits[ray]);
+            }
+          }
+#endif
+
+          void GetRayUnitsFromViewpointToCluster(const util::Vector3D<float>& iDirection,
                                                  float & oMaximumRayUnits,
                                                  float & oMinimumRayUnits)
           {
-            // (Remember that iRay.mDirection is normalised)
+            // (Remember that iDirection is normalised)
+            const util::Vector3D<float> lInverseDirection(1.0F / iDirection.x,
+                                                          1.0F / iDirection.y,
+                                                          1.0F / iDirection.z);
             float lMaxUnitRaysBasedOnX;
             float lMinUnitRaysBasedOnX;
-            if (iRay.GetDirection().x > 0.0F)
+            if (iDirection.x > 0.0F)
             {
-              lMaxUnitRaysBasedOnX = mViewpointCentreToMaxSite.x * iRay.GetInverseDirection().x;
+              lMaxUnitRaysBasedOnX = mViewpointCentreToMaxSite.x * lInverseDirection.x;
 
-              lMinUnitRaysBasedOnX = mViewpointCentreToMinSite.x * iRay.GetInverseDirection().x;
+              lMinUnitRaysBasedOnX = mViewpointCentreToMinSite.x * lInverseDirection.x;
             }
-            else if (iRay.GetDirection().x < 0.0F)
+            else if (iDirection.x < 0.0F)
             {
-              lMaxUnitRaysBasedOnX = mViewpointCentreToMinSite.x * iRay.GetInverseDirection().x;
-              lMinUnitRaysBasedOnX = mViewpointCentreToMaxSite.x * iRay.GetInverseDirection().x;
+              lMaxUnitRaysBasedOnX = mViewpointCentreToMinSite.x * lInverseDirection.x;
+              lMinUnitRaysBasedOnX = mViewpointCentreToMaxSite.x * lInverseDirection.x;
             }
             else
             {
@@ -95,16 +236,16 @@ namespace hemelb
 
             float lMaxUnitRaysBasedOnY;
             float lMinUnitRaysBasedOnY;
-            if (iRay.GetDirection().y > 0.0F)
+            if (iDirection.y > 0.0F)
             {
-              lMaxUnitRaysBasedOnY = mViewpointCentreToMaxSite.y * iRay.GetInverseDirection().y;
+              lMaxUnitRaysBasedOnY = mViewpointCentreToMaxSite.y * lInverseDirection.y;
 
-              lMinUnitRaysBasedOnY = mViewpointCentreToMinSite.y * iRay.GetInverseDirection().y;
+              lMinUnitRaysBasedOnY = mViewpointCentreToMinSite.y * lInverseDirection.y;
             }
-            else if (iRay.GetDirection().y < 0.0F)
+            else if (iDirection.y < 0.0F)
             {
-              lMaxUnitRaysBasedOnY = mViewpointCentreToMinSite.y * iRay.GetInverseDirection().y;
-              lMinUnitRaysBasedOnY = mViewpointCentreToMaxSite.y * iRay.GetInverseDirection().y;
+              lMaxUnitRaysBasedOnY = mViewpointCentreToMinSite.y * lInverseDirection.y;
+              lMinUnitRaysBasedOnY = mViewpointCentreToMaxSite.y * lInverseDirection.y;
             }
             else
             {
@@ -114,16 +255,16 @@ namespace hemelb
 
             float lMaxUnitRaysBasedOnZ;
             float lMinUnitRaysBasedOnZ;
-            if (iRay.GetDirection().z > 0.0F)
+            if (iDirection.z > 0.0F)
             {
-              lMaxUnitRaysBasedOnZ = mViewpointCentreToMaxSite.z * iRay.GetInverseDirection().z;
+              lMaxUnitRaysBasedOnZ = mViewpointCentreToMaxSite.z * lInverseDirection.z;
 
-              lMinUnitRaysBasedOnZ = mViewpointCentreToMinSite.z * iRay.GetInverseDirection().z;
+              lMinUnitRaysBasedOnZ = mViewpointCentreToMinSite.z * lInverseDirection.z;
             }
-            else if (iRay.GetDirection().z < 0.0F)
+            else if (iDirection.z < 0.0F)
             {
-              lMaxUnitRaysBasedOnZ = mViewpointCentreToMinSite.z * iRay.GetInverseDirection().z;
-              lMinUnitRaysBasedOnZ = mViewpointCentreToMaxSite.z * iRay.GetInverseDirection().z;
+              lMaxUnitRaysBasedOnZ = mViewpointCentreToMinSite.z * lInverseDirection.z;
+              lMinUnitRaysBasedOnZ = mViewpointCentreToMaxSite.z * lInverseDirection.z;
             }
             else
             {
@@ -148,14 +289,6 @@ namespace hemelb
                        float iMaximumRayUnits,
                        float iMinimumRayUnits)
           {
-            //It's possible for the ray to totally miss the cluster
-            //This is because the sub-image is square while the cluster
-            // projection won't be in most circumstances
-            if (iMaximumRayUnits < iMinimumRayUnits)
-            {
-              return;
-            }
-
             ioRay.SetRayLengthTraversedToCluster(iMinimumRayUnits);
 
             util::Vector3D<float> fromLowerSiteToFirstRayClusterIntersection = ioRay.GetDirection() * iMinimumRayUnits
@@ -233,54 +366,64 @@ namespace hemelb
                 + screen.GetPixelUnitVectorProjectionY() * (float) lowerLeftPixelCoordinatesOfSubImage.y;
           }
 
-          void CastRaysForEachPixel(const ClusterType& iCluster, PixelSet<RayDataType>& pixels)
+          void FindRaysHittingCluster(ClusterView& oView)
           {
             XYCoordinates<int> lPixel;
 
-            //Loop over all the pixels
+            //Loop over all the pixels, a packet of rays up each column at a time
             util::Vector3D<float> lCameraToBottomRow = fromCameraToBottomLeftPixelOfSubImage;
             for (lPixel.x = lowerLeftPixelCoordinatesOfSubImage.x; lPixel.x <= upperRightPixelCoordinatesOfSubImage.x;
                 ++lPixel.x)
             {
               util::Vector3D<float> lCameraToPixel = lCameraToBottomRow;
               for (lPixel.y = lowerLeftPixelCoordinatesOfSubImage.y; lPixel.y <= upperRightPixelCoordinatesOfSubImage.y;
-                  ++lPixel.y)
+                  lPixel.y += RaysPerPacket)
               {
-                CastRayForPixel(iCluster, lPixel, lCameraToPixel, pixels);
-
-                lCameraToPixel += screen.GetPixelUnitVectorProjectionY();
-              }
-
-              lCameraToBottomRow += screen.GetPixelUnitVectorProjectionX();
-            }
-          }
+                // The last packet of a column may run off the top of the sub-image; the rays
+                // beyond it are worked out but not cast.
+                util::Vector3D<float> lDirections[RaysPerPacket];
+                for (int ray = 0; ray < RaysPerPacket; ++ray)
+                {
+                  lDirections[ray] = lCameraToPixel;
+                  lCameraToPixel += screen.GetPixelUnitVectorProjectionY();
+                }
 
-          virtual void CastRayForPixel(const ClusterType& iCluster,
-                                       const XYCoordinates<int>& iPixelCoordinates,
-                                       const util::Vector3D<float>& iRayDirection,
-                                       PixelSet<RayDataType>& pixels)
-          {
-            Ray<RayDataType> lRay(iRayDirection, iPixelCoordinates.x, iPixelCoordinates.y);
+                //These tell us how many ray units get each ray into the cluster
+                //and after how many ray units it is out
+                float lMaximumRayUnits[RaysPerPacket];
+                float lMinimumRayUnits[RaysPerPacket];
+                GetRayUnitsFromViewpointToCluster(lDirections, lMaximumRayUnits, lMinimumRayUnits);
 
-            //These tell us how many ray units get us into the cluster
-            //and after how many ray units we are out
-            float lMaximumRayUnits;
-            float lMinimumRayUnits;
-            GetRayUnitsFromViewpointToCluster(lRay, lMaximumRayUnits, lMinimumRayUnits);
+                const int raysInPacket =
+                    util::NumericalFunctions::min(RaysPerPacket,
+                                                  upperRightPixelCoordinatesOfSubImage.y - lPixel.y + 1);
+                for (int ray = 0; ray < raysInPacket; ++ray)
+                {
+                  //It's possible for the ray to totally miss the cluster
+                  //This is because the sub-image is square while the cluster
+                  // projection won't be in most circumstances
+                  if (lMaximumRayUnits[ray] < lMinimumRayUnits[ray])
+                  {
+                    continue;
+                  }
 
-            CastRay(iCluster, lRay, lMaximumRayUnits, lMinimumRayUnits);
+                  ClusterViewRay lViewRay;
+                  lViewRay.pixel = XYCoordinates<int>(lPixel.x, lPixel.y + ray);
+                  lViewRay.direction = lDirections[ray];
+                  lViewRay.minimumRayUnits = lMinimumRayUnits[ray];
+                  lViewRay.maximumRayUnits = lMaximumRayUnits[ray];
+                  oView.push_back(lViewRay);
+                }
+              }
 
-            //Make sure the ray hasn't reached infinity
-            if (!lRay.CollectedNoData())
-            {
-              pixels.AddPixel(lRay.GetRayData());
+              lCameraToBottomRow += screen.GetPixelUnitVectorProjectionX();
             }
           }
 
           void TraverseRayThroughBlock(const util::Vector3D<float>& fromFirstRayClusterIntersectionToLowerSiteOfCurrentBlock,
                                        const util::Vector3D<float>& iLocationInBlock,
                                        const ClusterType& iCluster,
-                                       const util::Vector3D<site_t>& blockLocation,
+                                       const geometry::Block& block,
                                        const site_t blockNumberOnCluster,
                                        float euclideanClusterLengthTraversedByRay,
                                        Ray<RayDataType>& ioRay)
@@ -308,53 +451,33 @@ namespace hemelb
               // Find out how far the ray can move
               const float manhattanRayLengthThroughVoxel = rayUnitsUntilNextSite.GetByDirection(directionOfLeastTravel);
 
-              const geometry::Block& block = latticeData.GetBlock(latticeData.GetBlockIdFromBlockCoords(blockLocation));
-
-              if (!block.IsEmpty()) // Ensure fluid site
+              if (!block.SiteIsSolid(siteTraverser.GetCurrentIndex()))
               {
-                if (!block.SiteIsSolid(siteTraverser.GetCurrentIndex()))
-                {
-                  const site_t localContiguousId =
-                      block.GetLocalContiguousIndexForSite(siteTraverser.GetCurrentIndex());
-
-                  SiteData_t siteData;
-                  siteData.density = propertyCache.densityCache.Get(localContiguousId);
-                  siteData.velocity = propertyCache.velocityCache.Get(localContiguousId).GetMagnitude();
+                const site_t localContiguousId =
+                    block.GetLocalContiguousIndexForSite(siteTraverser.GetCurrentIndex());
 
-                  if (visSettings.mStressType == lb::ShearStress)
-                  {
-                    siteData.stress = propertyCache.wallShearStressMagnitudeCache.Get(localContiguousId);
-                  }
-                  else
-                  {
-                    siteData.stress = propertyCache.vonMisesStressCache.Get(localContiguousId);
-                  }
+                const SiteData_t& lSiteData = siteData[localContiguousId];
 
-                  const util::Vector3D<double>* lWallData = iCluster.GetWallData(blockNumberOnCluster,
-                                                                                 siteTraverser.GetCurrentIndex());
+                const util::Vector3D<double>* lWallData = iCluster.GetWallData(blockNumberOnCluster,
+                                                                               siteTraverser.GetCurrentIndex());
 
-                  if (lWallData == NULL || lWallData->x == NO_VALUE)
-                  {
-                    ioRay.UpdateDataForNormalFluidSite(siteData,
-                                                       manhattanRayLengthThroughVoxel
-                                                           - euclideanClusterLengthTraversedByRay, // Manhattan Ray-length through the voxel
-                                                       euclideanClusterLengthTraversedByRay, // euclidean ray units spent in cluster
-                                                       domainStats,
-                                                       visSettings);
-                  }
-                  else
-                  {
-                    ioRay.UpdateDataForWallSite(siteData,
-                                                manhattanRayLengthThroughVoxel - euclideanClusterLengthTraversedByRay,
-                                                euclideanClusterLengthTraversedByRay,
-                                                domainStats,
-                                                visSettings,
-                                                lWallData);
-                  }
+                if (lWallData == NULL || lWallData->x == NO_VALUE)
+                {
+                  ioRay.UpdateDataForNormalFluidSite(lSiteData,
+                                                     manhattanRayLengthThroughVoxel
+                                                         - euclideanClusterLengthTraversedByRay, // Manhattan Ray-length through the voxel
+                                                     euclideanClusterLengthTraversedByRay, // euclidean ray units spent in cluster
+                                                     domainStats,
+                                                     visSettings);
                 }
                 else
                 {
-                  ioRay.ProcessSolidSite();
+                  ioRay.UpdateDataForWallSite(lSiteData,
+                                              manhattanRayLengthThroughVoxel - euclideanClusterLengthTraversedByRay,
+                                              euclideanClusterLengthTraversedByRay,
+                                              domainStats,
+                                              visSettings,
+                                              lWallData);
                 }
               }
               else
@@ -574,13 +697,26 @@ namespace hemelb
               util::Vector3D<float> siteLocationWithinBlock = (ioRay.GetDirection()) * siteUnitsTraversed
                   - fromFirstIntersectionToLowerSiteOfCurrentBlock;
 
-              TraverseRayThroughBlock(fromFirstIntersectionToLowerSiteOfCurrentBlock,
-                                      siteLocationWithinBlock,
-                                      iCluster,
-                                      iCluster.GetMinBlockLocation() + clusterTraverser.GetCurrentLocation(),
-                                      clusterTraverser.GetCurrentIndex(),
-                                      siteUnitsTraversed,
-                                      ioRay);
+              const geometry::Block& block =
+                  latticeData.GetBlock(latticeData.GetBlockIdFromBlockCoords(iCluster.GetMinBlockLocation()
+                      + clusterTraverser.GetCurrentLocation()));
+
+              // Every site of an empty block is solid, which leaves the ray the same however
+              // many of them it passes through, so there is no need to trace it site by site.
+              if (block.IsEmpty())
+              {
+                ioRay.ProcessSolidSite();
+              }
+              else
+              {
+                TraverseRayThroughBlock(fromFirstIntersectionToLowerSiteOfCurrentBlock,
+                                        siteLocationWithinBlock,
+                                        iCluster,
+                                        block,
+                                        clusterTraverser.GetCurrentIndex(),
+                                        siteUnitsTraversed,
+                                        ioRay);
+              }
 
               // The direction of least travel is the direction of
               // the next block that will be hit by the ray
@@ -737,9 +873,10 @@ namespace hemelb
           const VisSettings& visSettings;
           const hemelb::geometry::LatticeData& latticeData;
           /**
-           * The cache of macroscopic fluid properties at each local fluid site.
+           * The density, speed and stress at each local fluid site, sampled once for every view.
            */
-          const lb::MacroscopicPropertyCache& propertyCache;
+          const std::vector<SiteData_t>& siteData;
+          const int firstColumn;
 
           util::Vector3D<float> fromCameraToBottomLeftPixelOfSubImage;
 
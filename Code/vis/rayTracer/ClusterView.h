@@ -0,0 +1,43 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_VIS_RAYTRACER_CLUSTERVIEW_H
+#define HEMELB_VIS_RAYTRACER_CLUSTERVIEW_H
+
+#include <vector>
+#include "util/Vector3D.h"
+#include "vis/XYCoordinates.h"
+
+namespace hemelb
+{
+  namespace vis
+  {
+    namespace raytracer
+    {
+      /**
+       * A ray from the viewpoint through a pixel that hits a cluster.
+       */
+      struct ClusterViewRay
+      {
+          XYCoordinates<int> pixel;
+          //! The normalised direction of the ray.
+          util::Vector3D<float> direction;
+          //! The ray units from the viewpoint to where the ray enters the cluster.
+          float minimumRayUnits;
+          //! The ray units from the viewpoint to where the ray leaves the cluster.
+          float maximumRayUnits;
+      };
+
+      /**
+       * The rays that hit a cluster. These depend only on the viewpoint and the screen, not on
+       * the flow, so they can be reused to render the cluster again for as long as those stay the
+       * same.
+       */
+      typedef std::vector<ClusterViewRay> ClusterView;
+    }
+  }
+}
+
+#endif /* HEMELB_VIS_RAYTRACER_CLUSTERVIEW_H */
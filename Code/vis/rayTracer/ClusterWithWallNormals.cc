@@ -6,6 +6,7 @@
 
 #include "geometry/LatticeData.h"
 #include "vis/rayTracer/ClusterWithWallNormals.h"
+#include "util/utilityFunctions.h"
 
 namespace hemelb
 {
@@ -59,6 +60,16 @@ namespace hemelb
       {
         return true;
       }
+
+      size_t ClusterWithWallNormals::DoGetAllocatedBytes() const
+      {
+        size_t bytes = util::VectorBytes(WallNormals);
+        for (size_t block = 0; block < WallNormals.size(); ++block)
+        {
+          bytes += util::VectorBytes(WallNormals[block]);
+        }
+        return bytes;
+      }
     }
   }
 }
@@ -33,6 +33,8 @@ namespace hemelb
 
           static bool DoNeedsWallNormals();
 
+          size_t DoGetAllocatedBytes() const;
+
         private:
           std::vector<std::vector<const util::Vector3D<double>*> > WallNormals;
       };
@@ -178,14 +178,6 @@ namespace hemelb
         protected:
           static const float mLongestDistanceInVoxelInverse;
 
-          static void PickColour(float value, float colour[3])
-          {
-            colour[0] = util::NumericalFunctions::enforceBounds<float>(4.F * value - 2.F, 0.F, 1.F);
-            colour[1]
-                = util::NumericalFunctions::enforceBounds<float>(2.F - 4.F * (float) fabs(value - 0.5F), 0.F, 1.F);
-            colour[2] = util::NumericalFunctions::enforceBounds<float>(2.F - 4.F * value, 0.F, 1.F);
-          }
-
           float mLengthBeforeRayFirstCluster;
           float mCumulativeLengthInFluid;
 
@@ -137,7 +137,7 @@ namespace hemelb
             if (iVisSettings.mStressType == lb::VonMises)
             {
               //Update the volume rendering of the von Mises stress flow field
-              mStressSum = iSiteData.stress * iRayLengthInVoxel;
+              mStressSum += iSiteData.stress * iRayLengthInVoxel;
             }
           }
 
@@ -7,6 +7,7 @@
 #include <iostream>
 
 #include "util/Vector3D.h"
+#include "vis/ColourPalette.h"
 #include "vis/DomainStats.h"
 #include "vis/rayTracer/RayDataNormal.h"
 
@@ -18,15 +19,8 @@ namespace hemelb
     {
 
       RayDataNormal::RayDataNormal(int i, int j) :
-        RayData<RayDataNormal> (i, j)
+        RayData<RayDataNormal> (i, j), mVelocitySum(0.0F), mStressSum(0.0F)
       {
-        mVelR = 0.0F;
-        mVelG = 0.0F;
-        mVelB = 0.0F;
-
-        mStressR = 0.0F;
-        mStressG = 0.0F;
-        mStressB = 0.0F;
       }
 
       RayDataNormal::RayDataNormal()
@@ -40,21 +34,13 @@ namespace hemelb
                                                          const float iRayLengthInVoxel,
                                                          const VisSettings& iVisSettings)
       {
-        float lPalette[3];
-
-        // update the volume rendering of the velocity flow field
-        PickColour(iSiteData.velocity * (float) mDomainStats->velocity_threshold_max_inv, lPalette);
-
-        UpdateVelocityColour(iRayLengthInVoxel, lPalette);
+        // the volume rendering of the velocity flow field
+        mVelocitySum += iSiteData.velocity * iRayLengthInVoxel;
 
         if (iVisSettings.mStressType != lb::ShearStress)
         {
-          // update the volume rendering of the von Mises stress flow field
-          float lScaledStress = iSiteData.stress * (float) mDomainStats->stress_threshold_max_inv;
-
-          PickColour(lScaledStress, lPalette);
-
-          UpdateStressColour(iRayLengthInVoxel, lPalette);
+          // the volume rendering of the von Mises stress flow field
+          mStressSum += iSiteData.stress * iRayLengthInVoxel;
         }
       }
 
@@ -71,52 +57,24 @@ namespace hemelb
                                               const float iNormalisedDistanceToFirstCluster,
                                               const DomainStats& iDomainStats) const
       {
-        MakeColourComponent(mVelR * 255.0F, oColour[0]);
-        MakeColourComponent(mVelG * 255.0F, oColour[1]);
-        MakeColourComponent(mVelB * 255.0F, oColour[2]);
+        ColourPalette::PickColour(mVelocitySum / GetCumulativeLengthInFluid()
+                                      * (float) iDomainStats.velocity_threshold_max_inv,
+                                  oColour);
       }
 
       void RayDataNormal::DoGetStressColour(unsigned char oColour[3],
                                             const float iNormalisedDistanceToFirstCluster,
                                             const DomainStats& iDomainStats) const
       {
-        MakeColourComponent(mStressR, oColour[0]);
-        MakeColourComponent(mStressG, oColour[1]);
-        MakeColourComponent(mStressB, oColour[2]);
-      }
-
-      void RayDataNormal::MakeColourComponent(float value, unsigned char& colour) const
-      {
-        colour
-            = util::NumericalFunctions::enforceBounds<unsigned char>((unsigned char) (value
-                                                                         / GetCumulativeLengthInFluid()),
-                                                                     0,
-                                                                     255);
+        ColourPalette::PickColour(mStressSum / GetCumulativeLengthInFluid()
+                                      * (float) iDomainStats.stress_threshold_max_inv,
+                                  oColour);
       }
 
       void RayDataNormal::DoCombine(const RayDataNormal& iOtherRayData)
       {
-        mVelR += iOtherRayData.mVelR;
-        mVelG += iOtherRayData.mVelG;
-        mVelB += iOtherRayData.mVelB;
-
-        mStressR += iOtherRayData.mStressR;
-        mStressG += iOtherRayData.mStressG;
-        mStressB += iOtherRayData.mStressB;
-      }
-
-      void RayDataNormal::UpdateVelocityColour(float iDt, const float iPalette[3])
-      {
-        mVelR += iDt * iPalette[0];
-        mVelG += iDt * iPalette[1];
-        mVelB += iDt * iPalette[2];
-      }
-
-      void RayDataNormal::UpdateStressColour(float iDt, const float iPalette[3])
-      {
-        mStressR += iDt * iPalette[0];
-        mStressG += iDt * iPalette[1];
-        mStressB += iDt * iPalette[2];
+        mVelocitySum += iOtherRayData.mVelocitySum;
+        mStressSum += iOtherRayData.mStressSum;
       }
 
       void RayDataNormal::DoProcessTangentingVessel()
@@ -125,7 +83,7 @@ namespace hemelb
 
       MPI_Datatype RayDataNormal::GetMPIType()
       {
-        HEMELB_MPI_TYPE_BEGIN(type, RayDataNormal, 12);
+        HEMELB_MPI_TYPE_BEGIN(type, RayDataNormal, 8);
 
         HEMELB_MPI_TYPE_ADD_MEMBER(i);
         HEMELB_MPI_TYPE_ADD_MEMBER(j);
@@ -133,18 +91,12 @@ namespace hemelb
         HEMELB_MPI_TYPE_ADD_MEMBER(mCumulativeLengthInFluid);
         HEMELB_MPI_TYPE_ADD_MEMBER(mDensityAtNearestPoint);
         HEMELB_MPI_TYPE_ADD_MEMBER(mStressAtNearestPoint);
-        HEMELB_MPI_TYPE_ADD_MEMBER(mVelR);
-        HEMELB_MPI_TYPE_ADD_MEMBER(mVelG);
-        HEMELB_MPI_TYPE_ADD_MEMBER(mVelB);
-        HEMELB_MPI_TYPE_ADD_MEMBER(mStressR);
-        HEMELB_MPI_TYPE_ADD_MEMBER(mStressG);
-        HEMELB_MPI_TYPE_ADD_MEMBER(mStressB);
+        HEMELB_MPI_TYPE_ADD_MEMBER(mVelocitySum);
+        HEMELB_MPI_TYPE_ADD_MEMBER(mStressSum);
 
         HEMELB_MPI_TYPE_END(type, RayDataNormal);
         return type;
       }
-
-      const DomainStats* RayDataNormal::mDomainStats = NULL;
     }
   }
 
@@ -19,7 +19,12 @@ namespace hemelb
   {
     namespace raytracer
     {
-      // NB functions prefixed Do should only be called by the base class
+      /**
+       * RayDataNormal - sums the velocity and stress along the ray, weighted by the length of
+       * the ray in each voxel. Only these sums are combined between cores; the pixel is coloured
+       * from their averages once the image is complete.
+       * NB functions prefixed Do should only be called by the base class
+       */
       class RayDataNormal : public RayData<RayDataNormal>
       {
         public:
@@ -57,18 +62,9 @@ namespace hemelb
 
           static MPI_Datatype GetMPIType();
 
-          // We need this because RayDataNormal uses it for every voxel update
-          static const DomainStats* mDomainStats;
-
         private:
-          void UpdateVelocityColour(float iDt, const float iPalette[3]);
-
-          void UpdateStressColour(float iDt, const float iPalette[3]);
-
-          void MakeColourComponent(float value, unsigned char& colour) const;
-
-          float mVelR, mVelG, mVelB;
-          float mStressR, mStressG, mStressB;
+          float mVelocitySum;
+          float mStressSum;
       };
     }
   }
@@ -18,6 +18,7 @@
 #include "debug/Debugger.h"
 #include "geometry/LatticeData.h"
 #include "lb/LbmParameters.h"
+#include "lb/MacroscopicPropertyCache.h"
 #include "log/Logger.h"
 #include "net/IOCommunicator.h"
 #include "util/utilityFunctions.h" 
@@ -32,6 +33,7 @@
 #include "vis/rayTracer/Cluster.h"
 #include "vis/rayTracer/ClusterBuilder.h"
 #include "vis/rayTracer/ClusterRayTracer.h"
+#include "vis/rayTracer/ClusterView.h"
 #include "vis/rayTracer/Ray.h"
 #include "vis/rayTracer/RayTracer.h"
 #include "vis/rayTracer/SiteData.h"
@@ -42,6 +44,16 @@ namespace hemelb
   {
     namespace raytracer
     {
+      /**
+       * A view to render, into the columns of the image from firstColumn on.
+       */
+      struct ViewTile
+      {
+          const Viewpoint* viewpoint;
+          const Screen* screen;
+          int firstColumn;
+      };
+
       template<typename ClusterType, typename RayDataType>
       class RayTracer : public PixelSetStore<PixelSet<RayDataType> >
       {
@@ -64,27 +76,167 @@ namespace hemelb
 
           // Render the current state into an image.
           PixelSet<RayDataType>* Render(const lb::MacroscopicPropertyCache& propertyCache)
+          {
+            ViewTile tile;
+            tile.viewpoint = mViewpoint;
+            tile.screen = mScreen;
+            tile.firstColumn = 0;
+            return Render(propertyCache, std::vector<ViewTile>(1, tile));
+          }
+
+          /**
+           * Render the current state from several views at once, side by side in one image. The
+           * properties are sampled once for all of them, and each cluster is rendered from every
+           * view while its sites are to hand.
+           * @param propertyCache
+           * @param tiles The views, which should not overlap.
+           * @return
+           */
+          PixelSet<RayDataType>* Render(const lb::MacroscopicPropertyCache& propertyCache,
+                                        const std::vector<ViewTile>& tiles)
           {
             PixelSet<RayDataType>* pixels =
                 PixelSetStore<PixelSet<RayDataType> >::GetUnusedPixelSet();
             pixels->Clear();
 
-            ClusterRayTracer<ClusterType, RayDataType> lClusterRayTracer(*mViewpoint,
-                                                                         *mScreen,
-                                                                         *mDomainStats,
-                                                                         *mVisSettings,
-                                                                         *mLatDat,
-                                                                         propertyCache);
+            SampleSites(propertyCache);
+
+            const std::vector<ClusterType>& clusters = mClusterBuilder.GetClusters();
+            if (mViews.size() < tiles.size())
+            {
+              mViews.resize(tiles.size());
+            }
 
-            for (unsigned int clusterId = 0; clusterId < mClusterBuilder.GetClusters().size(); clusterId++)
+            // Which rays hit each cluster only changes with the viewpoint and screen, so while
+            // those stay the same (e.g. a steered camera left still) only the traversal is redone.
+            for (unsigned int tile = 0; tile < tiles.size(); tile++)
             {
-              lClusterRayTracer.RenderCluster(mClusterBuilder.GetClusters()[clusterId], *pixels);
+              CachedView& view = mViews[tile];
+              if (!view.Shows(tiles[tile]))
+              {
+                ClusterRayTracer<ClusterType, RayDataType> lClusterRayTracer(*tiles[tile].viewpoint,
+                                                                             *tiles[tile].screen,
+                                                                             *mDomainStats,
+                                                                             *mVisSettings,
+                                                                             *mLatDat,
+                                                                             mSiteData);
+                view.clusterViews.resize(clusters.size());
+                for (unsigned int clusterId = 0; clusterId < clusters.size(); clusterId++)
+                {
+                  lClusterRayTracer.CalculateClusterView(clusters[clusterId],
+                                                         view.clusterViews[clusterId]);
+                }
+                view.Remember(tiles[tile]);
+              }
+            }
+
+            for (unsigned int clusterId = 0; clusterId < clusters.size(); clusterId++)
+            {
+              for (unsigned int tile = 0; tile < tiles.size(); tile++)
+              {
+                ClusterRayTracer<ClusterType, RayDataType> lClusterRayTracer(*tiles[tile].viewpoint,
+                                                                             *tiles[tile].screen,
+                                                                             *mDomainStats,
+                                                                             *mVisSettings,
+                                                                             *mLatDat,
+                                                                             mSiteData,
+                                                                             tiles[tile].firstColumn);
+                lClusterRayTracer.RenderCluster(clusters[clusterId],
+                                                mViews[tile].clusterViews[clusterId],
+                                                *pixels);
+              }
             }
 
             return pixels;
           }
 
+          /**
+           * The bytes allocated for the clusters, the sampled properties and the rays that hit
+           * the clusters.
+           * @return
+           */
+          size_t GetMemoryUsage() const
+          {
+            size_t bytes = mClusterBuilder.GetMemoryUsage() + util::VectorBytes(mSiteData)
+                + util::VectorBytes(mViews);
+            for (unsigned int view = 0; view < mViews.size(); view++)
+            {
+              bytes += util::VectorBytes(mViews[view].clusterViews);
+              for (unsigned int clusterId = 0; clusterId < mViews[view].clusterViews.size(); clusterId++)
+              {
+                bytes += util::VectorBytes(mViews[view].clusterViews[clusterId]);
+              }
+            }
+            return bytes;
+          }
+
         private:
+          /**
+           * The rays that hit each cluster from a view, with the viewpoint and screen they were
+           * worked out for.
+           */
+          struct CachedView
+          {
+              CachedView() :
+                  valid(false), pixelsX(0), pixelsY(0)
+              {
+              }
+
+              /**
+               * Whether the rays are still those of a view's viewpoint and screen.
+               * @param tile
+               * @return
+               */
+              bool Shows(const ViewTile& tile) const
+              {
+                return valid && viewpointLocation == tile.viewpoint->GetViewpointLocation()
+                    && cameraToBottomLeftOfScreen == tile.screen->GetCameraToBottomLeftOfScreenVector()
+                    && pixelUnitVectorProjectionX == tile.screen->GetPixelUnitVectorProjectionX()
+                    && pixelUnitVectorProjectionY == tile.screen->GetPixelUnitVectorProjectionY()
+                    && pixelsX == tile.screen->GetPixelsX() && pixelsY == tile.screen->GetPixelsY();
+              }
+
+              void Remember(const ViewTile& tile)
+              {
+                viewpointLocation = tile.viewpoint->GetViewpointLocation();
+                cameraToBottomLeftOfScreen = tile.screen->GetCameraToBottomLeftOfScreenVector();
+                pixelUnitVectorProjectionX = tile.screen->GetPixelUnitVectorProjectionX();
+                pixelUnitVectorProjectionY = tile.screen->GetPixelUnitVectorProjectionY();
+                pixelsX = tile.screen->GetPixelsX();
+                pixelsY = tile.screen->GetPixelsY();
+                valid = true;
+              }
+
+              std::vector<ClusterView> clusterViews;
+              bool valid;
+              util::Vector3D<float> viewpointLocation;
+              util::Vector3D<float> cameraToBottomLeftOfScreen;
+              util::Vector3D<float> pixelUnitVectorProjectionX;
+              util::Vector3D<float> pixelUnitVectorProjectionY;
+              int pixelsX;
+              int pixelsY;
+          };
+
+          /**
+           * Read what the rays show at each local fluid site out of the property cache, working
+           * out the speed once however many rays, from however many views, pass through it.
+           * @param propertyCache
+           */
+          void SampleSites(const lb::MacroscopicPropertyCache& propertyCache)
+          {
+            mSiteData.resize(mLatDat->GetLocalFluidSiteCount());
+            const bool wallShearStress = mVisSettings->mStressType == lb::ShearStress;
+            for (site_t site = 0; site < mLatDat->GetLocalFluidSiteCount(); ++site)
+            {
+              SiteData_t& siteData = mSiteData[site];
+              siteData.density = propertyCache.densityCache.Get(site);
+              siteData.velocity = propertyCache.velocityCache.Get(site).GetMagnitude();
+              siteData.stress = wallShearStress ?
+                propertyCache.wallShearStressMagnitudeCache.Get(site) :
+                propertyCache.vonMisesStressCache.Get(site);
+            }
+          }
+
           ClusterBuilder<ClusterType> mClusterBuilder;
           const geometry::LatticeData* mLatDat;
 
@@ -92,6 +244,10 @@ namespace hemelb
           Screen* mScreen;
           Viewpoint* mViewpoint;
           VisSettings* mVisSettings;
+
+          std::vector<SiteData_t> mSiteData;
+          //! For each view rendered, the rays that hit each cluster.
+          std::vector<CachedView> mViews;
       };
     }
   }
@@ -4,6 +4,7 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <cassert>
 #include <cmath>
 
 #include "vis/streaklineDrawer/ParticleManager.h"
@@ -15,78 +16,114 @@ namespace hemelb
     namespace streaklinedrawer
     {
       ParticleManager::ParticleManager(std::map<proc_t, NeighbouringProcessor>& iNeighbouringProcessors) :
-        neighbouringProcessors(iNeighbouringProcessors)
+        anyMarked(false), neighbouringProcessors(iNeighbouringProcessors)
       {
       }
 
       void ParticleManager::AddParticle(const Particle& iParticle)
       {
-        particles.push_back(iParticle);
+        positions.push_back(iParticle.position);
+        velocities.push_back(iParticle.velocity);
+        speeds.push_back(iParticle.vel);
+        inletIds.push_back(iParticle.inletID);
+        marked.push_back(false);
       }
 
-      std::vector<Particle>& ParticleManager::GetParticles()
+      Particle ParticleManager::GetParticle(size_t index) const
       {
-        return particles;
+        Particle particle;
+        particle.position = positions[index];
+        particle.velocity = velocities[index];
+        particle.vel = speeds[index];
+        particle.inletID = inletIds[index];
+        return particle;
       }
 
       size_t ParticleManager::GetNumberOfLocalParticles() const
       {
-        return particles.size();
+        return positions.size();
       }
 
-      void ParticleManager::DeleteParticle(site_t iIndex)
+      void ParticleManager::MarkForDeletion(size_t index)
       {
-        assert(particles.size() > static_cast<size_t> (iIndex));
+        assert(positions.size() > index);
 
-        //Move the particle at the end to position
-        particles[iIndex] = particles.back();
+        marked[index] = true;
+        anyMarked = true;
+      }
+
+      void ParticleManager::DeleteMarkedParticles()
+      {
+        if (!anyMarked)
+        {
+          return;
+        }
+
+        size_t kept = 0;
+        for (size_t particle = 0; particle < positions.size(); ++particle)
+        {
+          if (marked[particle])
+          {
+            continue;
+          }
+
+          if (kept != particle)
+          {
+            positions[kept] = positions[particle];
+            velocities[kept] = velocities[particle];
+            speeds[kept] = speeds[particle];
+            inletIds[kept] = inletIds[particle];
+          }
+          ++kept;
+        }
 
-        //Delete the now duplicated particle at the end
-        particles.pop_back();
+        positions.resize(kept);
+        velocities.resize(kept);
+        speeds.resize(kept);
+        inletIds.resize(kept);
+        marked.assign(kept, false);
+        anyMarked = false;
       }
 
       void ParticleManager::DeleteAll()
       {
-        particles.clear();
+        positions.clear();
+        velocities.clear();
+        speeds.clear();
+        inletIds.clear();
+        marked.clear();
+        anyMarked = false;
       }
 
       void ParticleManager::ProcessParticleMovement()
       {
-        for (unsigned int i = 0; i < GetNumberOfLocalParticles(); i++)
+        for (size_t i = 0; i < positions.size(); i++)
         {
           // particle coords updating (dt = 1)
-          particles[i].position += particles[i].velocity;
+          positions[i] += velocities[i];
         }
       }
 
       // Communicate the particles' current state to other processors.
       void ParticleManager::CommunicateParticles(net::Net& streakNet,
                                                  const geometry::LatticeData& latticeData,
-                                                 VelocityField& velocityField)
+                                                 const VelocityField& velocityField)
       {
-        unsigned int particles_temp = GetNumberOfLocalParticles();
-
         proc_t thisRank = streakNet.Rank();
 
-        for (int n = (int) (particles_temp - 1); n >= 0; n--)
+        for (size_t n = 0; n < GetNumberOfLocalParticles(); n++)
         {
-          VelocitySiteData* siteVelocityData =
-              velocityField.GetVelocitySiteData(latticeData,
-                                                util::Vector3D<site_t>(particles[n].position));
+          const proc_t procId = velocityField.GetProcIdForSite(latticeData, util::Vector3D<site_t>(positions[n]));
 
-          // TODO can we get rid of the first test?
-          if (siteVelocityData == NULL || siteVelocityData->proc_id == -1)
-          {
-            continue;
-          }
-          else if (thisRank == siteVelocityData->proc_id)
+          if (procId == SITE_OR_BLOCK_SOLID || thisRank == procId)
           {
             continue;
           }
 
-          neighbouringProcessors[siteVelocityData->proc_id].AddParticleToSend(particles[n]);
-          DeleteParticle(n);
+          neighbouringProcessors[procId].AddParticleToSend(GetParticle(n));
+          MarkForDeletion(n);
         }
+        DeleteMarkedParticles();
 
         for (std::map<proc_t, NeighbouringProcessor>::iterator proc =
             neighbouringProcessors.begin(); proc != neighbouringProcessors.end(); ++proc)
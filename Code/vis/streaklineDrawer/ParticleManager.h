@@ -27,6 +27,12 @@ namespace hemelb
   {
     namespace streaklinedrawer
     {
+      /**
+       * Keeps the particles of this rank as a structure of arrays, so that moving and
+       * interpolating them streams through just the fields that are needed. Particles are
+       * deleted by marking them then compacting the arrays in one pass, which keeps the rest in
+       * order.
+       */
       class ParticleManager
       {
         public:
@@ -35,21 +41,65 @@ namespace hemelb
 
           // Functions for manipulating the particle store
           void AddParticle(const Particle& iParticle);
-          std::vector<Particle>& GetParticles();
+          Particle GetParticle(size_t index) const;
           size_t GetNumberOfLocalParticles() const;
-          void DeleteParticle(site_t iIndex);
           void DeleteAll();
 
+          const std::vector<util::Vector3D<float> >& GetPositions() const
+          {
+            return positions;
+          }
+
+          float GetSpeed(size_t index) const
+          {
+            return speeds[index];
+          }
+
+          unsigned int GetInletId(size_t index) const
+          {
+            return inletIds[index];
+          }
+
+          /**
+           * Set the velocity a particle moves with and the speed it is drawn with.
+           * @param index
+           * @param velocity
+           * @param speed
+           */
+          void SetVelocity(size_t index, const util::Vector3D<float>& velocity, float speed)
+          {
+            velocities[index] = velocity;
+            speeds[index] = speed;
+          }
+
+          /**
+           * Mark a particle to be deleted by the next call to DeleteMarkedParticles. The indices
+           * of all the particles stay the same until then.
+           * @param index
+           */
+          void MarkForDeletion(size_t index);
+
+          /**
+           * Delete the marked particles, moving the rest down to fill the gaps.
+           */
+          void DeleteMarkedParticles();
+
           // Function for updating the particles' positions.
           void ProcessParticleMovement();
 
           // Function for moving the particles between cores.
           void CommunicateParticles(net::Net& streakNet,
                                     const geometry::LatticeData& iLatDat,
-                                    VelocityField& iVelocityField);
+                                    const VelocityField& iVelocityField);
 
         private:
-          std::vector<Particle> particles;
+          std::vector<util::Vector3D<float> > positions;
+          std::vector<util::Vector3D<float> > velocities;
+          std::vector<float> speeds;
+          std::vector<unsigned int> inletIds;
+          //! Whether each particle is marked for deletion.
+          std::vector<bool> marked;
+          bool anyMarked;
           std::map<proc_t, NeighbouringProcessor>& neighbouringProcessors;
 
       };
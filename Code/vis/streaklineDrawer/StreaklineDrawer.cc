@@ -78,10 +78,7 @@ namespace hemelb
         // Communicate this with other processors.
         CommunicateSiteIds();
 
-        // Recalculate velocities at the sites requested from this rank.
-        UpdateVelocityFieldForCommunicatedSites();
-
-        // Communicate the velocities back to the sites that requested them.
+        // Communicate the velocities, read from the property cache, back to the sites that requested them.
         CommunicateVelocities();
 
         // Update our local velocity field is sufficient to update all particles and prune
@@ -101,14 +98,14 @@ namespace hemelb
         int pixels_x = screen.GetPixelsX();
         int pixels_y = screen.GetPixelsY();
 
-        const std::vector<Particle>& particles = particleManager.GetParticles();
+        const std::vector<util::Vector3D<float> >& positions = particleManager.GetPositions();
 
         PixelSet<StreakPixel>* set = GetUnusedPixelSet();
         set->Clear();
 
-        for (unsigned int n = 0; n < particles.size(); n++)
+        for (size_t n = 0; n < positions.size(); n++)
         {
-          util::Vector3D<float> p1 = particles[n].position - util::Vector3D<float>(latDat.GetSiteDimensions() / 2);
+          util::Vector3D<float> p1 = positions[n] - util::Vector3D<float>(latDat.GetSiteDimensions() / 2);
 
           util::Vector3D<float> p2 = viewpoint.Project(p1);
 
@@ -116,7 +113,7 @@ namespace hemelb
 
           if (! (x.x < 0 || x.x >= pixels_x || x.y < 0 || x.y >= pixels_y))
           {
-            StreakPixel pixel(x.x, x.y, particles[n].vel, p2.z, particles[n].inletID);
+            StreakPixel pixel(x.x, x.y, particleManager.GetSpeed(n), p2.z, particleManager.GetInletId(n));
             set->AddPixel(pixel);
           }
         }
@@ -188,26 +185,23 @@ namespace hemelb
 
       void StreaklineDrawer::WorkOutVelocityDataNeededForParticles()
       {
-        std::vector<Particle> &particles = particleManager.GetParticles();
+        const std::vector<util::Vector3D<float> >& positions = particleManager.GetPositions();
 
-        // Note that we iterate through the array back to front because at the end of this
-        // loop we delete a particle. Iterating back to front ensures that we end up
-        // visiting each particle.
-        for (int n = (int) particles.size() - 1; n >= 0; --n)
+        for (size_t n = 0; n < positions.size(); ++n)
         {
-          Particle& particle = particles[n];
+          const util::Vector3D<float>& position = positions[n];
 
           for (int unitGridI = 0; unitGridI <= 1; ++unitGridI)
           {
-            site_t neighbourI = (site_t) particle.position.x + unitGridI;
+            site_t neighbourI = (site_t) position.x + unitGridI;
 
             for (int unitGridJ = 0; unitGridJ <= 1; ++unitGridJ)
             {
-              site_t neighbourJ = (site_t) particle.position.y + unitGridJ;
+              site_t neighbourJ = (site_t) position.y + unitGridJ;
 
               for (int unitGridK = 0; unitGridK <= 1; ++unitGridK)
               {
-                site_t neighbourK = (site_t) particle.position.z + unitGridK;
+                site_t neighbourK = (site_t) position.z + unitGridK;
 
                 proc_t sourceProcessor;
 
@@ -227,57 +221,30 @@ namespace hemelb
 
       void StreaklineDrawer::UpdateVelocityFieldForAllParticlesAndPrune()
       {
-        std::vector<Particle> &particles = particleManager.GetParticles();
+        std::vector<util::Vector3D<float> > interpolatedVelocities;
+        velocityField.InterpolateVelocities(particleManager.GetPositions(), latDat, interpolatedVelocities);
 
-        // Note that we iterate through the array back to front because at the end of this
-        // loop we delete a particle. Iterating back to front ensures that we end up
-        // visiting each particle.
-        for (int n = (int) particles.size() - 1; n >= 0; --n)
+        for (size_t n = 0; n < interpolatedVelocities.size(); ++n)
         {
-          util::Vector3D<float> localVelocityField[2][2][2];
-
-          velocityField.GetVelocityFieldAroundPoint(util::Vector3D<site_t>(particles[n].position),
-                                                    latDat,
-                                                    localVelocityField);
-
-          util::Vector3D<float> interp_v = velocityField.InterpolateVelocityForPoint(particles[n].position,
-                                                                                     localVelocityField);
+          const util::Vector3D<float>& interp_v = interpolatedVelocities[n];
 
           float vel = interp_v.Dot(interp_v);
 
           if (vel > 1.0F)
           {
-            particles[n].vel = 1.0F;
-            particles[n].velocity = interp_v * float(1.0 / sqrtf(vel));
+            particleManager.SetVelocity(n, interp_v * float(1.0 / sqrtf(vel)), 1.0F);
           }
           else if (vel > 1.0e-8)
           {
-            particles[n].vel = sqrtf(vel);
-            particles[n].velocity = interp_v;
+            particleManager.SetVelocity(n, interp_v, sqrtf(vel));
           }
           else
           {
-            particleManager.DeleteParticle(n);
+            particleManager.MarkForDeletion(n);
           }
         }
-      }
-
-      void StreaklineDrawer::UpdateVelocityFieldForCommunicatedSites()
-      {
-        for (std::map<proc_t, NeighbouringProcessor>::const_iterator neighProc = neighbouringProcessors.begin();
-            neighProc != neighbouringProcessors.end(); ++neighProc)
-        {
-          const NeighbouringProcessor& proc = (*neighProc).second;
-
-          for (site_t sendingVelocityIndex = 0; sendingVelocityIndex < proc.GetNumberOfSitesRequestedByNeighbour();
-              sendingVelocityIndex++)
-          {
-            const util::Vector3D<site_t>& siteCoords =
-                proc.GetSiteCoordsBeingRequestedByNeighbour(sendingVelocityIndex);
 
-            velocityField.UpdateLocalField(siteCoords, latDat);
-          }
-        }
+        particleManager.DeleteMarkedParticles();
       }
 
       // Communicate site ids to other processors.
@@ -319,9 +286,7 @@ namespace hemelb
           {
             const util::Vector3D<site_t> siteCoords = neighbourProc.GetSiteCoordsBeingRequestedByNeighbour(n);
 
-            const VelocitySiteData* velocityDataForSite = velocityField.GetVelocitySiteData(latDat, siteCoords);
-
-            neighbourProc.SetVelocityFieldToSend(n, velocityDataForSite->velocity);
+            neighbourProc.SetVelocityFieldToSend(n, velocityField.GetLocalVelocity(latDat, siteCoords));
           }
         }
 
@@ -335,7 +300,7 @@ namespace hemelb
           for (site_t n = 0; n < neighbourProc.GetNumberOfSitesRequestedByThisCore(); n++)
           {
             const util::Vector3D<site_t> &coords = neighbourProc.GetSendingSiteCoorinates(n);
-            velocityField.GetVelocitySiteData(latDat, coords)->velocity = neighbourProc.GetReceivedVelocityField(n);
+            velocityField.SetHaloVelocity(latDat, coords, neighbourProc.GetReceivedVelocityField(n));
           }
         }
 
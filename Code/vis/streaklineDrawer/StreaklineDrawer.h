@@ -59,7 +59,6 @@ namespace hemelb
         private:
           // Function for updating the velocity field and the particles in it.
           void UpdateVelocityFieldForAllParticlesAndPrune();
-          void UpdateVelocityFieldForCommunicatedSites();
 
           // Private functions for the creation / deletion of particles.
           void ChooseSeedParticles();
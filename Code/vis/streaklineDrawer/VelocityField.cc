@@ -4,6 +4,7 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <algorithm>
 #include <cmath>
 #include <vector>
 #include <cassert>
@@ -28,8 +29,6 @@ namespace hemelb
 
       void VelocityField::BuildVelocityField(const geometry::LatticeData& latDat)
       {
-        velocityField.resize(latDat.GetBlockCount());
-
         // Iterate over each block with some sites on this rank.
         geometry::BlockTraverser blockTraverser(latDat);
         do
@@ -88,27 +87,20 @@ namespace hemelb
               {
                 for (site_t neighbourK = startK; neighbourK <= endK; neighbourK++)
                 {
+                  const util::Vector3D<site_t> neighbour(neighbourI, neighbourJ, neighbourK);
+
                   // Get the rank that the neighbour lives on.
-                  const proc_t neigh_proc_id = latDat.GetProcIdFromGlobalCoords(util::Vector3D<site_t>(neighbourI,
-                                                                                                       neighbourJ,
-                                                                                                       neighbourK));
+                  const proc_t neigh_proc_id = latDat.GetProcIdFromGlobalCoords(neighbour);
 
-                  // If we have data for it, we should initialise a block in the velocity field
-                  // for the neighbour site.
-                  if (neigh_proc_id == SITE_OR_BLOCK_SOLID)
+                  // Solid sites have no velocity, and the velocity at sites on this rank comes
+                  // straight from the property cache.
+                  if (neigh_proc_id == SITE_OR_BLOCK_SOLID || localRank == neigh_proc_id)
                   {
                     continue;
                   }
 
-                  InitializeVelocityFieldBlock(latDat,
-                                               util::Vector3D<site_t>(neighbourI, neighbourJ, neighbourK),
-                                               neigh_proc_id);
-
-                  // If the neighbour is on this rank, ignore it.
-                  if (localRank == neigh_proc_id)
-                  {
-                    continue;
-                  }
+                  haloSites[latDat.GetGlobalNoncontiguousSiteIdFromGlobalCoords(neighbour)].proc_id =
+                      neigh_proc_id;
 
                   if (neighbouringProcessors.count(neigh_proc_id) == 0)
                   {
@@ -122,92 +114,83 @@ namespace hemelb
           while (siteTraverser.TraverseOne());
         }
         while (blockTraverser.TraverseOne());
-
-        // Iterate over the blocks, updating the value of the counter variable wherever
-        // there is velocity field data.
-        for (site_t block = 0; block < latDat.GetBlockCount(); block++)
-        {
-          if (velocityField[block].empty())
-          {
-            continue;
-          }
-
-          if (latDat.GetBlock(block).IsEmpty())
-          {
-            continue;
-          }
-
-          // Update the site id on each velocity field unit as required.
-          for (site_t localSiteId = 0; localSiteId < latDat.GetSitesPerBlockVolumeUnit(); localSiteId++)
-          {
-            velocityField[block][localSiteId].site_id =
-                latDat.GetBlock(block).GetLocalContiguousIndexForSite(localSiteId);
-          }
-        }
-      }
-
-      bool VelocityField::BlockContainsData(size_t blockNumber) const
-      {
-        return !velocityField[blockNumber].empty();
       }
 
-      VelocitySiteData& VelocityField::GetSiteData(site_t blockNumber, site_t siteNumber)
-      {
-        return velocityField[blockNumber][siteNumber];
-      }
-
-      // Returns the velocity site data for a given index, or NULL if the index isn't valid / has
-      // no data.
-      VelocitySiteData* VelocityField::GetVelocitySiteData(const geometry::LatticeData& latDat,
-                                                           const util::Vector3D<site_t>& location)
+      proc_t VelocityField::GetProcIdForSite(const geometry::LatticeData& latDat,
+                                             const util::Vector3D<site_t>& location) const
       {
         if (!latDat.IsValidLatticeSite(location))
         {
-          return NULL;
+          return SITE_OR_BLOCK_SOLID;
         }
 
-        util::Vector3D<site_t> blockCoords, siteCoords;
-        latDat.GetBlockAndLocalSiteCoords(location, blockCoords, siteCoords);
+        const proc_t procId = latDat.GetProcIdFromGlobalCoords(location);
+        if (procId == localRank)
+        {
+          return procId;
+        }
 
-        site_t block_id = latDat.GetBlockIdFromBlockCoords(blockCoords);
+        std::map<site_t, VelocitySiteData>::const_iterator haloSite =
+            haloSites.find(latDat.GetGlobalNoncontiguousSiteIdFromGlobalCoords(location));
+        return haloSite == haloSites.end() ?
+          SITE_OR_BLOCK_SOLID :
+          haloSite->second.proc_id;
+      }
 
-        if (!BlockContainsData(static_cast<size_t>(block_id)))
+      util::Vector3D<float> VelocityField::GetLocalVelocity(const geometry::LatticeData& latDat,
+                                                            const util::Vector3D<site_t>& location) const
+      {
+        if (log::Logger::ShouldDisplay<log::Debug>())
         {
-          return NULL;
+          if (localRank != latDat.GetProcIdFromGlobalCoords(location))
+          {
+            log::Logger::Log<log::Warning, log::OnePerCore>("Got a request for velocity data "
+                                                          "that actually seems to be on rank %i",
+                                                          latDat.GetProcIdFromGlobalCoords(location));
+          }
         }
 
-        site_t site_id = latDat.GetLocalSiteIdFromLocalSiteCoords(siteCoords);
+        return util::Vector3D<float>(propertyCache.velocityCache.Get(latDat.GetContiguousSiteId(location)));
+      }
 
-        return &GetSiteData(block_id, site_id);
+      void VelocityField::SetHaloVelocity(const geometry::LatticeData& latDat,
+                                          const util::Vector3D<site_t>& location,
+                                          const util::Vector3D<float>& velocity)
+      {
+        haloSites[latDat.GetGlobalNoncontiguousSiteIdFromGlobalCoords(location)].velocity = velocity;
       }
 
-      // Function to initialise the velocity field at given coordinates.
-      void VelocityField::InitializeVelocityFieldBlock(const geometry::LatticeData& latDat,
-                                                       const util::Vector3D<site_t> location,
-                                                       const proc_t proc_id)
+      util::Vector3D<float> VelocityField::GetSiteVelocity(const geometry::LatticeData& latDat,
+                                                           const geometry::Block& block,
+                                                           site_t localSiteId,
+                                                           const util::Vector3D<site_t>& location) const
       {
-        util::Vector3D<site_t> blockCoords, siteCoords;
-        latDat.GetBlockAndLocalSiteCoords(location, blockCoords, siteCoords);
+        const proc_t procId = block.GetProcessorRankForSite(localSiteId);
 
-        site_t blockId = latDat.GetBlockIdFromBlockCoords(blockCoords);
+        if (procId == localRank)
+        {
+          return util::Vector3D<float>(propertyCache.velocityCache.Get(block.GetLocalContiguousIndexForSite(localSiteId)));
+        }
 
-        if (!BlockContainsData(blockId))
+        if (procId != SITE_OR_BLOCK_SOLID)
         {
-          for (site_t localSiteId = 0; localSiteId < latDat.GetSitesPerBlockVolumeUnit(); ++localSiteId)
+          std::map<site_t, VelocitySiteData>::const_iterator haloSite =
+              haloSites.find(latDat.GetGlobalNoncontiguousSiteIdFromGlobalCoords(location));
+          if (haloSite != haloSites.end())
           {
-            velocityField[blockId].push_back(VelocitySiteData());
+            return haloSite->second.velocity;
           }
         }
 
-        site_t localSiteId = latDat.GetLocalSiteIdFromLocalSiteCoords(siteCoords);
-        velocityField[blockId][localSiteId].proc_id = proc_id;
+        // it is a solid site, or too far from this rank to matter, and the velocity is
+        // assumed to be zero
+        return util::Vector3D<float>::Zero();
       }
 
       // Populate the matrix v with all the velocity field data at each index.
-      // Returns true if this the area resides entirely on this core.
       void VelocityField::GetVelocityFieldAroundPoint(const util::Vector3D<site_t> location,
                                                       const geometry::LatticeData& latDat,
-                                                      util::Vector3D<float> localVelocityField[2][2][2])
+                                                      util::Vector3D<float> localVelocityField[2][2][2]) const
       {
         for (int unitGridI = 0; unitGridI <= 1; ++unitGridI)
         {
@@ -231,25 +214,18 @@ namespace hemelb
                 continue;
               }
 
-              VelocitySiteData *vel_site_data_p = GetVelocitySiteData(latDat,
-                                                                      util::Vector3D<site_t>(neighbourI,
-                                                                                             neighbourJ,
-                                                                                             neighbourK));
+              util::Vector3D<site_t> blockCoords, siteCoords;
+              latDat.GetBlockAndLocalSiteCoords(neighbour, blockCoords, siteCoords);
+              const geometry::Block& block = latDat.GetBlock(latDat.GetBlockIdFromBlockCoords(blockCoords));
 
-              if (vel_site_data_p == NULL || vel_site_data_p->proc_id == -1)
+              if (block.IsEmpty())
               {
-                // it is a solid site and the velocity is
-                // assumed to be zero
                 localVelocityField[unitGridI][unitGridJ][unitGridK] = util::Vector3D<float>::Zero();
                 continue;
               }
 
-              if (vel_site_data_p->counter != counter)
-              {
-                UpdateLocalField(vel_site_data_p, latDat);
-              }
-
-              localVelocityField[unitGridI][unitGridJ][unitGridK] = vel_site_data_p->velocity;
+              localVelocityField[unitGridI][unitGridJ][unitGridK] =
+                  GetSiteVelocity(latDat, block, latDat.GetLocalSiteIdFromLocalSiteCoords(siteCoords), neighbour);
             }
           }
         }
@@ -264,49 +240,20 @@ namespace hemelb
           return false;
         }
 
-        VelocitySiteData *vel_site_data_p = GetVelocitySiteData(latDat, location);
+        std::map<site_t, VelocitySiteData>::iterator haloSite =
+            haloSites.find(latDat.GetGlobalNoncontiguousSiteIdFromGlobalCoords(location));
 
-        if (vel_site_data_p == NULL || vel_site_data_p->proc_id == -1 || vel_site_data_p->proc_id == localRank
-            || vel_site_data_p->counter == counter)
+        if (haloSite == haloSites.end() || haloSite->second.counter == counter)
         {
           return false;
         }
 
-        vel_site_data_p->counter = counter;
-        *sourceProcessor = vel_site_data_p->proc_id;
+        haloSite->second.counter = counter;
+        *sourceProcessor = haloSite->second.proc_id;
 
         return true;
       }
 
-      void VelocityField::UpdateLocalField(const util::Vector3D<site_t>& position, const geometry::LatticeData& latDat)
-      {
-        VelocitySiteData *localVelocitySiteData = GetVelocitySiteData(latDat, position);
-
-        if (log::Logger::ShouldDisplay<log::Debug>())
-        {
-          if (localRank != localVelocitySiteData->proc_id)
-          {
-            log::Logger::Log<log::Warning, log::OnePerCore>("Got a request for velocity data "
-                                                          "that actually seems to be on rank %i",
-                                                          localVelocitySiteData->proc_id);
-          }
-        }
-
-        UpdateLocalField(localVelocitySiteData, latDat);
-      }
-
-      void VelocityField::UpdateLocalField(VelocitySiteData* localVelocitySiteData, const geometry::LatticeData& latDat)
-      {
-        // the local counter is set equal to the global one
-        // and the local velocity is calculated
-        localVelocitySiteData->counter = counter;
-
-        const util::Vector3D<distribn_t>& velocity = propertyCache.velocityCache.Get(localVelocitySiteData->site_id);
-        localVelocitySiteData->velocity.x = (float) velocity.x;
-        localVelocitySiteData->velocity.y = (float) velocity.y;
-        localVelocitySiteData->velocity.z = (float) velocity.z;
-      }
-
       // Interpolates a velocity field to get the velocity at the position of a particle.
       util::Vector3D<float> VelocityField::InterpolateVelocityForPoint(const util::Vector3D<float> point,
                                                                        const util::Vector3D<float> localVelocityField[2][2][2]) const
@@ -337,6 +284,73 @@ namespace hemelb
         return yInterpolatedVelocity[0] * (1.F - dx) + yInterpolatedVelocity[1] * dx;
       }
 
+      void VelocityField::InterpolateVelocities(const std::vector<util::Vector3D<float> >& points,
+                                                const geometry::LatticeData& latDat,
+                                                std::vector<util::Vector3D<float> >& velocities) const
+      {
+        const site_t blockSize = latDat.GetBlockSize();
+
+        std::vector<PointInBlock> pointsInBlocks(points.size());
+        for (size_t point = 0; point < points.size(); ++point)
+        {
+          PointInBlock& pointInBlock = pointsInBlocks[point];
+          pointInBlock.point = point;
+          pointInBlock.block = -1;
+          pointInBlock.site = -1;
+
+          const util::Vector3D<site_t> location(points[point]);
+          if (!latDat.IsValidLatticeSite(location))
+          {
+            continue;
+          }
+
+          util::Vector3D<site_t> blockCoords, siteCoords;
+          latDat.GetBlockAndLocalSiteCoords(location, blockCoords, siteCoords);
+          pointInBlock.block = latDat.GetBlockIdFromBlockCoords(blockCoords);
+          if (siteCoords.x < blockSize - 1 && siteCoords.y < blockSize - 1 && siteCoords.z < blockSize - 1)
+          {
+            pointInBlock.site = latDat.GetLocalSiteIdFromLocalSiteCoords(siteCoords);
+          }
+        }
+        std::sort(pointsInBlocks.begin(), pointsInBlocks.end());
+
+        velocities.resize(points.size());
+        util::Vector3D<float> localVelocityField[2][2][2];
+        for (std::vector<PointInBlock>::const_iterator pointInBlock = pointsInBlocks.begin();
+            pointInBlock != pointsInBlocks.end(); ++pointInBlock)
+        {
+          const util::Vector3D<float>& point = points[pointInBlock->point];
+
+          if (pointInBlock->site < 0)
+          {
+            GetVelocityFieldAroundPoint(util::Vector3D<site_t>(point), latDat, localVelocityField);
+          }
+          else
+          {
+            const geometry::Block& block = latDat.GetBlock(pointInBlock->block);
+            const util::Vector3D<site_t> lowestCorner(point);
+            for (int unitGridI = 0; unitGridI <= 1; ++unitGridI)
+            {
+              for (int unitGridJ = 0; unitGridJ <= 1; ++unitGridJ)
+              {
+                for (int unitGridK = 0; unitGridK <= 1; ++unitGridK)
+                {
+                  localVelocityField[unitGridI][unitGridJ][unitGridK] = block.IsEmpty() ?
+                    util::Vector3D<float>::Zero() :
+                    GetSiteVelocity(latDat,
+                                    block,
+                                    pointInBlock->site + (unitGridI * blockSize + unitGridJ) * blockSize
+                                        + unitGridK,
+                                    lowestCorner + util::Vector3D<site_t>(unitGridI, unitGridJ, unitGridK));
+                }
+              }
+            }
+          }
+
+          velocities[pointInBlock->point] = InterpolateVelocityForPoint(point, localVelocityField);
+        }
+      }
+
       void VelocityField::InvalidateAllCalculatedVelocities()
       {
         ++counter;
@@ -26,6 +26,11 @@ namespace hemelb
   {
     namespace streaklinedrawer
     {
+      /**
+       * The velocity field the streakline particles move through. The velocity at sites on this
+       * rank is read straight from the property cache; only the halo of sites on neighbouring
+       * ranks around them is stored here, for the velocities they send each step.
+       */
       class VelocityField
       {
         public:
@@ -35,42 +40,95 @@ namespace hemelb
 
           void BuildVelocityField(const geometry::LatticeData& latDat);
 
-          bool BlockContainsData(size_t iBlockNumber) const;
-
-          VelocitySiteData* GetVelocitySiteData(const geometry::LatticeData& latDat,
-                                                const util::Vector3D<site_t>& location);
+          /**
+           * The rank the site at a location lives on, if it is on this rank or in its halo, or
+           * SITE_OR_BLOCK_SOLID otherwise.
+           * @param latDat
+           * @param location
+           * @return
+           */
+          proc_t GetProcIdForSite(const geometry::LatticeData& latDat,
+                                  const util::Vector3D<site_t>& location) const;
+
+          /**
+           * The velocity at a site on this rank.
+           * @param latDat
+           * @param location
+           * @return
+           */
+          util::Vector3D<float> GetLocalVelocity(const geometry::LatticeData& latDat,
+                                                 const util::Vector3D<site_t>& location) const;
+
+          /**
+           * Store the velocity received for a site in the halo.
+           * @param latDat
+           * @param location
+           * @param velocity
+           */
+          void SetHaloVelocity(const geometry::LatticeData& latDat,
+                               const util::Vector3D<site_t>& location,
+                               const util::Vector3D<float>& velocity);
 
           void GetVelocityFieldAroundPoint(const util::Vector3D<site_t> location,
                                            const geometry::LatticeData& latDat,
-                                           util::Vector3D<float> localVelocityField[2][2][2]);
+                                           util::Vector3D<float> localVelocityField[2][2][2]) const;
 
           util::Vector3D<float>
           InterpolateVelocityForPoint(const util::Vector3D<float> position,
                                       const util::Vector3D<float> localVelocityField[2][2][2]) const;
 
-          void InvalidateAllCalculatedVelocities();
+          /**
+           * Interpolate the velocity at many points at once. The points are taken in order of
+           * the block their cell of the lattice starts in, and the corners of a cell within one
+           * block are read through that block, rather than being looked up one by one through
+           * the lattice.
+           * @param points
+           * @param latDat
+           * @param velocities Has the velocity at each point.
+           */
+          void InterpolateVelocities(const std::vector<util::Vector3D<float> >& points,
+                                     const geometry::LatticeData& latDat,
+                                     std::vector<util::Vector3D<float> >& velocities) const;
 
-          void UpdateLocalField(const util::Vector3D<site_t>& position, const geometry::LatticeData& latDat);
+          void InvalidateAllCalculatedVelocities();
 
           bool NeededFromNeighbour(const util::Vector3D<site_t> location,
                                    const geometry::LatticeData& latDat,
                                    proc_t* sourceProcessor);
 
         private:
-          void UpdateLocalField(VelocitySiteData* localVelocitySiteData, const geometry::LatticeData& latDat);
-
-          // Counter to make sure the velocity field blocks are correct for the current iteration.
+          /**
+           * Where the cell of the lattice around a point starts.
+           */
+          struct PointInBlock
+          {
+              site_t block;
+              //! The local site id of the cell's lowest corner, or -1 if the cell isn't all in
+              //! the block.
+              site_t site;
+              size_t point;
+
+              bool operator<(const PointInBlock& other) const
+              {
+                return block < other.block || (block == other.block && site < other.site);
+              }
+          };
+
+          /**
+           * The velocity at a site, given its block and its id within it as well as its location,
+           * zero if it is solid or neither on this rank nor in the halo.
+           */
+          util::Vector3D<float> GetSiteVelocity(const geometry::LatticeData& latDat,
+                                                const geometry::Block& block,
+                                                site_t localSiteId,
+                                                const util::Vector3D<site_t>& location) const;
+
+          // Counter to make sure the halo velocities are requested once per iteration.
           site_t counter;
 
-          VelocitySiteData& GetSiteData(site_t iBlockNumber, site_t iSiteNumber);
-
-          void InitializeVelocityFieldBlock(const geometry::LatticeData& latDat,
-                                            const util::Vector3D<site_t> location,
-                                            const proc_t proc_id);
-
           const proc_t localRank;
-          // Vector containing VelocityFields
-          std::vector<std::vector<VelocitySiteData> > velocityField;
+          // The sites on neighbouring ranks next to sites on this one, by global site id.
+          std::map<site_t, VelocitySiteData> haloSites;
           std::map<proc_t, NeighbouringProcessor>& neighbouringProcessors;
           const lb::MacroscopicPropertyCache& propertyCache;
       };
@@ -15,12 +15,12 @@ namespace hemelb
   {
     namespace streaklinedrawer
     {
-      // Class to hold information about the velocity field at some point.
+      // Class to hold information about the velocity field at a site on a neighbouring rank.
       class VelocitySiteData
       {
         public:
           VelocitySiteData() :
-              counter(-1), proc_id(-1), site_id(-1), velocity(NO_VALUE)
+              counter(-1), proc_id(-1), velocity(NO_VALUE)
           {
           }
 
@@ -37,12 +37,7 @@ namespace hemelb
           proc_t proc_id;
 
           /**
-           * The site id of the volume represented.
-           */
-          site_t site_id;
-
-          /**
-           * The velocity calculated for that site.
+           * The velocity received for that site.
            */
           util::Vector3D<float> velocity;
       };
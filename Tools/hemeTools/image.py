@@ -6,6 +6,7 @@
 
 import pdb
 import xdrlib
+import zlib
 import numpy as N
 
 class Image(object):
@@ -22,13 +23,19 @@ class Image(object):
         self.screen = (reader.unpack_uint(), reader.unpack_uint())
         self.nPixels = reader.unpack_uint()
 
-        tempPixels = N.zeros((self.nPixels,4), dtype=N.uint32)
-
-        for i in xrange(self.nPixels):
-            for j in xrange(4):
-                tempPixels[i,j] = reader.unpack_uint()
+        # The pixels may be an encoded block, which starts with the HemeLB magic number.
+        start = reader.get_position()
+        if self.nPixels > 0 and reader.unpack_uint() == type(self).HemeLbMagicNumber:
+            tempPixels = self._InflatePixels(reader)
+        else:
+            reader.set_position(start)
+            tempPixels = N.zeros((self.nPixels,4), dtype=N.uint32)
+
+            for i in xrange(self.nPixels):
+                for j in xrange(4):
+                    tempPixels[i,j] = reader.unpack_uint()
+                    continue
                 continue
-            continue
         sortedIndices = N.argsort(tempPixels[:,0])
         self.pixels = tempPixels[sortedIndices].view(dtype=[('index', N.uint16, 2),
                                                             ('r', N.uint8, 4),
@@ -41,6 +48,26 @@ class Image(object):
 
         return
     
+    HemeLbMagicNumber = 0x686c6221
+
+    def _InflatePixels(self, reader):
+        """Read the rest of an encoded block of pixels, after the HemeLB magic
+        number, returning them as an array of four uints per pixel.
+        """
+        imageMagic = reader.unpack_uint()
+        version = reader.unpack_uint()
+        encoding = reader.unpack_uint()
+        assert version == 1 and encoding == 1
+        count = reader.unpack_uint()
+        length = reader.unpack_uint()
+        planes = N.frombuffer(zlib.decompress(reader.unpack_fopaque(length)), dtype=N.uint8)
+
+        # The planes hold each big-endian byte of every pixel in turn.
+        pixels = planes.reshape(16, count).T.copy().view('>u4').astype(N.uint32)
+        # The positions are the differences from the one before.
+        pixels[:, 0] = N.cumsum(pixels[:, 0], dtype=N.uint32)
+        return pixels
+
     def old__init__(self, filename):
         self.filename = filename
         
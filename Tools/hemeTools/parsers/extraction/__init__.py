@@ -6,6 +6,7 @@
 
 import os.path
 import xdrlib
+import zlib
 import numpy as np
 
 from .. import HemeLbMagicNumber
@@ -13,6 +14,55 @@ from .. import HemeLbMagicNumber
 ExtractionMagicNumber = 0x78747204
 MainHeaderLength = 60
 TimeStepDataLength = 8
+# In version 5 files, a block starting with this instead of a time step is a
+# site list, giving the grid position of every site in the records after it.
+SiteListMarker = 0xffffffffffffffff
+SiteListRowDtype = np.dtype([('grid', '>i4', (3,))])
+# In surface site lists, each site also has its wall normal and the area of
+# wall it stands for, both zero at non-wall sites.
+SurfaceSiteListRowDtype = np.dtype([('grid', '>i4', (3,)), ('normal', '>f4', (3,)),
+                                    ('area', '>f4')])
+# The encodings of the field values in version 6 files, and their XDR dtypes.
+# Delta encoded records are compressed, so have no fixed layout.
+Float32Encoding, Float16Encoding, Fixed16Encoding, DeltaEncoding = 0, 1, 2, 3
+EncodedXdrTypes = {Float32Encoding: '>f4', Float16Encoding: '>f2', Fixed16Encoding: '>u2'}
+# The flag for positions in site lists in version 6 files
+SiteListsFlag = 1
+# The flag for surface site lists in version 6 files
+SurfaceSiteListsFlag = 2
+# A subfile index stands in for an extraction file written in parts, one per
+# node or group of cores, each a whole extraction file of the group's sites.
+SubfilesMagicNumber = 0x73756204
+SubfilesVersionNumber = 1
+
+def ReadSubfileIndex(filename):
+    """If the file is a subfile index of extraction files, return the path of
+    each part, relative to the current directory, and its site count.
+    Otherwise return None.
+    """
+    with open(filename, 'rb') as f:
+        magic = f.read(8)
+        if len(magic) < 8:
+            return None
+        decoder = xdrlib.Unpacker(magic)
+        if decoder.unpack_uint() != HemeLbMagicNumber or \
+                decoder.unpack_uint() != SubfilesMagicNumber:
+            return None
+        decoder = xdrlib.Unpacker(f.read())
+
+    assert decoder.unpack_uint() == SubfilesVersionNumber, \
+        "Incorrect subfile index version number in '{}'".format(filename)
+    assert decoder.unpack_uint() == ExtractionMagicNumber, \
+        "Subfile index '{}' is not of extraction files".format(filename)
+    directory = os.path.dirname(filename)
+    parts = []
+    for i in xrange(decoder.unpack_uint()):
+        name = decoder.unpack_string()
+        firstSite = decoder.unpack_uhyper()
+        siteCount = decoder.unpack_uhyper()
+        parts.append((os.path.join(directory, name), siteCount))
+        continue
+    return parts
 
 class FieldSpec(object):
     """Represent the data type of a single record in both XDR format and
@@ -30,11 +80,21 @@ class FieldSpec(object):
          
     """
 
-    def __init__(self, memspec):
+    def __init__(self, memspec, gridInRecord=True):
         # name, XDR dtype, in-memory dtype, length, offset
-        self._filespec = [('grid', '>i4', np.uint32, (3,), 0)]
+        if gridInRecord:
+            self._filespec = [('grid', '>i4', np.uint32, (3,), 0)]
+        else:
+            self._filespec = []
         
         self._memspec = memspec
+        self._padding = 0
+        return
+
+    def SetPadding(self, padding):
+        """Set the number of bytes of padding at the end of each row.
+        """
+        self._padding = padding
         return
 
     def Append(self, name, length, pyType, datatype):
@@ -57,8 +117,14 @@ class FieldSpec(object):
     def GetXdr(self):
         """Get the numpy datatype for the XDR file.
         """
-        return np.dtype([(name, xdrType, length) 
-                         for name, xdrType, memType, length, offset in self._filespec])
+        unpadded = np.dtype([(name, xdrType, length) 
+                             for name, xdrType, memType, length, offset in self._filespec])
+        if self._padding == 0:
+            return unpadded
+        return np.dtype({'names': unpadded.names,
+                         'formats': [unpadded.fields[name][0] for name in unpadded.names],
+                         'offsets': [unpadded.fields[name][1] for name in unpadded.names],
+                         'itemsize': unpadded.itemsize + self._padding})
 
     def GetRecordLength(self):
         """Get the length of the record as stored in the XDR file.
@@ -72,11 +138,20 @@ class FieldSpec(object):
     pass
 
 class ExtractedPropertyV3Parser(object):
+    # Whether the positions are in site lists rather than every record
+    siteLists = False
+    # The layout of a site in the site lists
+    siteListDtype = SiteListRowDtype
+    # Whether the records are delta encoded, and so vary in length
+    deltas = False
+    # The length of the data at the start of a record, before the sites'
+    recordHeaderLength = TimeStepDataLength
+
     def __init__(self, fieldCount, siteCount):
         self._fieldCount = fieldCount
         self._siteCount = siteCount
 
-    def parse(self, memoryMappedData):
+    def parse(self, memoryMappedData, recordHeader=None):
         result = np.recarray(self._siteCount, dtype=self._fieldSpec.GetMem())
         
         for name, xdrType, memType, length, offset in self._fieldSpec:
@@ -99,11 +174,15 @@ class ExtractedPropertyV3Parser(object):
         return self._fieldSpec.GetRecordLength()
 
 class ExtractedPropertyV4Parser(object):
+    siteLists = False
+    deltas = False
+    recordHeaderLength = TimeStepDataLength
+
     def __init__(self, fieldCount, siteCount):
         self._fieldCount = fieldCount
         self._siteCount = siteCount
 
-    def parse(self, memoryMappedData):
+    def parse(self, memoryMappedData, recordHeader=None):
         result = np.recarray(self._siteCount, dtype=self._fieldSpec.GetMem())
         
         for ((name, xdrType, memType, length, offset),dataOffset) in zip(self._fieldSpec, self._dataOffset):
@@ -132,11 +211,164 @@ class ExtractedPropertyV4Parser(object):
             return data + operand
         pass
 
+class ExtractedPropertyV5Parser(ExtractedPropertyV4Parser):
+    """As version 4, but the grid positions are kept in separate site list
+    blocks rather than in every record.
+    """
+    siteLists = True
+
+    def ParseFieldHeader(self, decoder):
+        self._fieldSpec = FieldSpec([('id', None, np.uint64, 1, None),
+                                     ('position', None, np.float32, (3,), None),
+                                     ('grid', None, np.uint32, (3,), None)],
+                                    gridInRecord=False)
+        self._dataOffset = []
+
+        for iField in xrange(self._fieldCount):
+            name = decoder.unpack_string()
+            length = decoder.unpack_uint()
+            self._dataOffset.append(decoder.unpack_double())
+            self._fieldSpec.Append(name, length, '>f4', np.float32)
+            continue
+        return self._fieldSpec
+
+class ExtractedPropertyV6Parser(ExtractedPropertyV4Parser):
+    """As version 4 or 5, but with the field values encoded in fewer bits.
+    """
+    def ParseFieldHeader(self, decoder):
+        self._encoding = decoder.unpack_uint()
+        assert self._encoding in EncodedXdrTypes or self._encoding == DeltaEncoding, \
+            "Unknown extraction field encoding"
+        flags = decoder.unpack_uint()
+        self.siteLists = bool(flags & SiteListsFlag)
+        if flags & SurfaceSiteListsFlag:
+            self.siteListDtype = SurfaceSiteListRowDtype
+        self.deltas = self._encoding == DeltaEncoding
+        if self._encoding == Fixed16Encoding:
+            # Each field's minimum and scale follow the time step
+            self.recordHeaderLength = TimeStepDataLength + 16 * self._fieldCount
+
+        memspec = [('id', None, np.uint64, 1, None),
+                   ('position', None, np.float32, (3,), None)]
+        if self.siteLists:
+            memspec.append(('grid', None, np.uint32, (3,), None))
+        if self.siteListDtype is SurfaceSiteListRowDtype:
+            memspec.append(('normal', None, np.float32, (3,), None))
+            memspec.append(('area', None, np.float32, 1, None))
+        self._fieldSpec = FieldSpec(memspec, gridInRecord=not self.siteLists)
+        self._dataOffset = []
+
+        valueCount = 0
+        self._fieldLengths = []
+        for iField in xrange(self._fieldCount):
+            name = decoder.unpack_string()
+            length = decoder.unpack_uint()
+            self._dataOffset.append(decoder.unpack_double())
+            self._fieldSpec.Append(name, length, EncodedXdrTypes.get(self._encoding, '>i4'), np.float32)
+            self._fieldLengths.append(length)
+            valueCount += length
+            continue
+        self._valueCount = valueCount
+
+        # 16-bit values are padded to a multiple of four bytes per site
+        if self._encoding in (Float16Encoding, Fixed16Encoding) and valueCount % 2:
+            self._fieldSpec.SetPadding(2)
+        return self._fieldSpec
+
+    def ReadDeltaRecordHeader(self, f, pos):
+        """Read the header of the delta encoded record at pos, returning
+        whether it is a keyframe, the (minimum, scale) of each field, the
+        length of each chunk, and the lengths of the header and the record.
+        """
+        f.seek(pos)
+        fixedLength = TimeStepDataLength + 4 + 16 * self._fieldCount + 4
+        decoder = xdrlib.Unpacker(f.read(fixedLength))
+        decoder.unpack_uhyper()
+        keyframe = bool(decoder.unpack_uint())
+        ranges = [(decoder.unpack_double(), decoder.unpack_double())
+                  for iField in xrange(self._fieldCount)]
+        chunkCount = decoder.unpack_uint()
+        chunkLengths = np.frombuffer(f.read(4 * chunkCount), dtype='>u4').astype(int)
+
+        headerLength = fixedLength + 4 * chunkCount
+        recordLength = headerLength + int(np.sum(4 * ((chunkLengths + 3) // 4)))
+        return keyframe, ranges, chunkLengths, headerLength, recordLength
+
+    def ReadDeltas(self, f, pos):
+        """Read the delta encoded record at pos, returning the (minimum,
+        scale) of each field and the stored value of each site's values, in
+        order, which are differences from the record before unless it is a
+        keyframe.
+        """
+        keyframe, ranges, chunkLengths, headerLength, recordLength = \
+            self.ReadDeltaRecordHeader(f, pos)
+        f.seek(pos + headerLength)
+
+        stored = []
+        for length in chunkLengths.tolist():
+            chunk = f.read(4 * ((length + 3) // 4))
+            if length == 0:
+                continue
+            # The bytes of the values are in planes, most significant first
+            planes = np.frombuffer(zlib.decompress(chunk[:length]), dtype=np.uint8).reshape(4, -1)
+            zigzag = ((planes[0].astype(np.uint32) << 24) | (planes[1].astype(np.uint32) << 16) |
+                      (planes[2].astype(np.uint32) << 8) | planes[3].astype(np.uint32))
+            stored.append((zigzag >> 1).astype(np.int64) ^ -(zigzag & 1).astype(np.int64))
+            continue
+
+        if not stored:
+            return ranges, np.zeros(0, dtype=np.int64)
+        return ranges, np.concatenate(stored)
+
+    def ParseDeltas(self, quantised, ranges):
+        """Turn the quantised values of a delta encoded record into fields.
+        """
+        result = np.recarray(self._siteCount, dtype=self._fieldSpec.GetMem())
+        quantised = quantised.reshape(self._siteCount, self._valueCount)
+
+        first = 0
+        for iField, ((name, xdrType, memType, length, offset), dataOffset) in enumerate(zip(self._fieldSpec, self._dataOffset)):
+            valueCount = self._fieldLengths[iField]
+            minimum, scale = ranges[iField]
+            data = minimum + scale * quantised[:, first:first + valueCount]
+            if valueCount == 1:
+                data = data[:, 0]
+            setattr(result, name, data + dataOffset)
+            first += valueCount
+            continue
+        return result
+
+    def parse(self, memoryMappedData, recordHeader=None):
+        result = np.recarray(self._siteCount, dtype=self._fieldSpec.GetMem())
+
+        if self._encoding == Fixed16Encoding:
+            decoder = xdrlib.Unpacker(recordHeader[TimeStepDataLength:])
+            ranges = [(decoder.unpack_double(), decoder.unpack_double())
+                      for iField in xrange(self._fieldCount)]
+
+        if self.siteLists:
+            fields = list(self._fieldSpec)
+        else:
+            # The grid comes first, and doesn't need decoding
+            fields = list(self._fieldSpec)[1:]
+            result.grid = memoryMappedData.getfield(('>i4', (3,)), 0)
+
+        for iField, ((name, xdrType, memType, length, offset), dataOffset) in enumerate(zip(fields, self._dataOffset)):
+            data = memoryMappedData.getfield((xdrType, length), offset).astype(np.float64)
+            if self._encoding == Fixed16Encoding:
+                minimum, scale = ranges[iField]
+                data = minimum + scale * data
+            setattr(result, name, data + dataOffset)
+            continue
+        return result
+
 class ExtractedProperty(object):
     """Represent the contents of a HemeLB property extraction file.
-    
+
+    The file can also be the index of one written in parts, whose sites are
+    then those of all the parts, one after the other.
     """
-    HandledVersions = [3,4]
+    HandledVersions = [3,4,5,6]
 
     def __init__(self, filename):
         """Read the file's headers and determine how many times and which times
@@ -144,6 +376,11 @@ class ExtractedProperty(object):
         """
 
         self.filename = filename
+        parts = ReadSubfileIndex(filename)
+        if parts is not None:
+            self._ReadParts(parts)
+            return
+        self._parts = None
         self._file = file(filename, 'rb')
 
         self._ReadMainHeader()
@@ -154,6 +391,29 @@ class ExtractedProperty(object):
         self._file.close()
         return
 
+    def _ReadParts(self, parts):
+        """Read the headers of each part of a file written in parts. They all
+        have the same fields and times.
+        """
+        self._parts = [ExtractedProperty(path) for path, siteCount in parts]
+        first = self._parts[0]
+        for part, (path, siteCount) in zip(self._parts, parts):
+            assert part.siteCount == siteCount, \
+                "Extraction file '{}' does not have the sites its index says".format(path)
+            assert np.array_equal(part.times, first.times), \
+                "Extraction file '{}' does not have the times of its other parts".format(path)
+            continue
+
+        self.voxelSizeMetres = first.voxelSizeMetres
+        self.originMetres = first.originMetres
+        self.siteCount = sum(part.siteCount for part in self._parts)
+        self.fieldCount = first.fieldCount
+        self._version = first._version
+        self.parser = first.parser
+        self._fieldSpec = first._fieldSpec
+        self.times = first.times
+        return
+
     def _ReadMainHeader(self):
         """Read data from the main header and store it in attributes.
         
@@ -178,10 +438,15 @@ class ExtractedProperty(object):
         self.fieldCount = decoder.unpack_uint()
         self._fieldHeaderLength = decoder.unpack_uint()
 
+        self._version = version
         if version == 3:
             self.parser = ExtractedPropertyV3Parser(self.fieldCount, self.siteCount)
         elif version == 4:
             self.parser = ExtractedPropertyV4Parser(self.fieldCount, self.siteCount)
+        elif version == 5:
+            self.parser = ExtractedPropertyV5Parser(self.fieldCount, self.siteCount)
+        elif version == 6:
+            self.parser = ExtractedPropertyV6Parser(self.fieldCount, self.siteCount)
         return
 
     def _ReadFieldHeader(self):
@@ -202,7 +467,8 @@ class ExtractedProperty(object):
         self._fieldSpec = self.parser.ParseFieldHeader(decoder)
 
         self._rowLength = self._fieldSpec.GetRecordLength()
-        self._recordLength = TimeStepDataLength + self._rowLength * self.siteCount
+        self._recordHeaderLength = self.parser.recordHeaderLength
+        self._recordLength = self._recordHeaderLength + self._rowLength * self.siteCount
 
         return
 
@@ -212,6 +478,10 @@ class ExtractedProperty(object):
         """
         filesize = os.path.getsize(self.filename)
         self._totalHeaderLength = MainHeaderLength + self._fieldHeaderLength
+        if self.parser.siteLists:
+            self._DetermineTimesWithSiteLists(filesize)
+            return
+
         bodysize = filesize - self._totalHeaderLength
         assert bodysize % self._recordLength == 0, \
             "Extraction file appears to have partial record(s), residual %s / %s , bodysize %s"%(bodysize % self._recordLength,self._recordLength,bodysize)
@@ -228,9 +498,60 @@ class ExtractedProperty(object):
         assert np.alltrue(np.argsort(times) == np.arange(len(times))), \
             "Times in extraction file are not monotonically increasing!"
         self.times = times
+        self._recordOffsets = self._totalHeaderLength + \
+            np.arange(nTimes) * self._recordLength
 
         return
 
+    def _DetermineTimesWithSiteLists(self, filesize):
+        """Walk the blocks of a version 5 file, noting where each time step's
+        data and the site list that applies to it start.
+        """
+        siteListLength = TimeStepDataLength + self.parser.siteListDtype.itemsize * self.siteCount
+        times = []
+        recordOffsets = []
+        siteListOffsets = []
+        keyframes = []
+        siteListOffset = None
+
+        pos = self._totalHeaderLength
+        while pos < filesize:
+            self._file.seek(pos)
+            timeBuf = self._file.read(TimeStepDataLength)
+            assert len(timeBuf) == TimeStepDataLength, \
+                "Extraction file appears to have a partial block at %s" % pos
+            time = xdrlib.Unpacker(timeBuf).unpack_uhyper()
+
+            if time == SiteListMarker:
+                siteListOffset = pos + TimeStepDataLength
+                pos += siteListLength
+            else:
+                assert siteListOffset is not None, \
+                    "Extraction file has a record before any site list"
+                times.append(time)
+                recordOffsets.append(pos)
+                siteListOffsets.append(siteListOffset)
+                if self.parser.deltas:
+                    keyframe, ranges, chunkLengths, headerLength, recordLength = \
+                        self.parser.ReadDeltaRecordHeader(self._file, pos)
+                    keyframes.append(keyframe)
+                    pos += recordLength
+                else:
+                    pos += self._recordLength
+            continue
+
+        assert pos == filesize, \
+            "Extraction file appears to have partial record(s), %s bytes over" % (pos - filesize)
+
+        times = np.array(times, dtype=int)
+        assert np.alltrue(np.argsort(times) == np.arange(len(times))), \
+            "Times in extraction file are not monotonically increasing!"
+        self.times = times
+        self._recordOffsets = np.array(recordOffsets, dtype=int)
+        self._siteListOffsets = np.array(siteListOffsets, dtype=int)
+        self._keyframes = np.array(keyframes, dtype=bool)
+        return
+
     def GetByIndex(self, idx):
         """Get the fields by time index. 
         """
@@ -256,26 +577,62 @@ class ExtractedProperty(object):
         """Use numpy.memmap to make a single timestep's worth of data
         accessible through a numpy array.
         """
-        # Figure out the start position of the data for this timestep in the
-        # file. This is made up of
-        #    - file headers
-        #    - number of previous records * record length
-        #    - stored timestep 
-        start = self._totalHeaderLength + \
-            idx * self._recordLength + \
-            TimeStepDataLength
+        # The start position of the record for this timestep in the file was
+        # found by _DetermineTimes; the data follows the stored timestep and
+        # anything else in the record's header.
+        start = int(self._recordOffsets[idx]) + self._recordHeaderLength
         return np.memmap(self.filename, dtype=self._fieldSpec.GetXdr(),
                          mode='r', offset=start, shape=(self.siteCount,))
 
+    def _LoadDeltasByIndex(self, idx):
+        """Decode a delta encoded record, by adding up the differences in the
+        records from the keyframe before it.
+        """
+        keyframe = idx
+        while not self._keyframes[keyframe]:
+            keyframe -= 1
+            continue
+
+        quantised = 0
+        with open(self.filename, 'rb') as f:
+            for i in xrange(keyframe, idx + 1):
+                ranges, stored = self.parser.ReadDeltas(f, int(self._recordOffsets[i]))
+                quantised = quantised + stored
+                continue
+        return self.parser.ParseDeltas(quantised, ranges)
+
     def _LoadByIndex(self, idx):
         """Create a numpy record array with a single timestep of data.
         
         Fields are as specified in the file with the addition of 
         """
-        mapped = self._MemMap(idx)
-
-        answer = self.parser.parse(mapped)
+        if self._parts is not None:
+            answer = np.concatenate([part._LoadByIndex(idx) for part in self._parts])
+            answer = answer.view(np.recarray)
+            answer.id = np.arange(self.siteCount)
+            return answer
+
+        if self.parser.deltas:
+            answer = self._LoadDeltasByIndex(idx)
+        else:
+            mapped = self._MemMap(idx)
+
+            recordHeader = None
+            if self._recordHeaderLength > TimeStepDataLength:
+                with open(self.filename, 'rb') as f:
+                    f.seek(int(self._recordOffsets[idx]))
+                    recordHeader = f.read(self._recordHeaderLength)
+            answer = self.parser.parse(mapped, recordHeader)
         
+        if self.parser.siteLists:
+            siteList = np.memmap(self.filename, dtype=self.parser.siteListDtype, mode='r',
+                                 offset=int(self._siteListOffsets[idx]),
+                                 shape=(self.siteCount,))
+            answer.grid = siteList.grid
+            if self.parser.siteListDtype is SurfaceSiteListRowDtype:
+                answer.normal = siteList.normal
+                answer.area = siteList.area
+
         answer.id = np.arange(self.siteCount)
         answer.position = self.voxelSizeMetres * answer.grid + self.originMetres
         return answer
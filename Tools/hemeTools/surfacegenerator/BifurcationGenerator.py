@@ -0,0 +1,74 @@
+# This file is part of HemeLB and is Copyright (C)
+# the HemeLB team and/or their institutions, as detailed in the
+# file AUTHORS. This software is provided under the terms of the
+# license in the file LICENSE.
+
+from TriangulatedCylinderSource import TriangulatedCylinderSource
+from vtk import vtkBooleanOperationPolyDataFilter, vtkSTLWriter
+import numpy as np
+
+def DaughterDirections(angle):
+    """The unit vectors along the two daughter vessels, each at angle degrees
+    to the z-axis, in the x-z plane.
+    """
+    theta = np.deg2rad(angle)
+    return (np.array([np.sin(theta), 0., np.cos(theta)]),
+            np.array([-np.sin(theta), 0., np.cos(theta)]))
+
+def DaughterRadius(radius):
+    """The radius of each daughter vessel, by Murray's law."""
+    return radius * 2. ** (-1. / 3.)
+
+def BifurcationSurface(radius, length, angle, resolution):
+    """Return a vtkPolyData of a symmetric bifurcation: a parent vessel of
+    the given radius along the z-axis, ending at the origin, and two daughter
+    vessels leaving the origin at angle degrees either side of it. Each
+    vessel is length long. The vessels are capped, closed tubes, joined by a
+    boolean union.
+    """
+    def Tube(centre, direction, r, h):
+        tcs = TriangulatedCylinderSource()
+        tcs.SetCenter(centre)
+        tcs.SetDirection(direction)
+        tcs.SetRadius(r)
+        tcs.SetHeight(h)
+        tcs.SetResolution(resolution)
+        tcs.CappingOn()
+        return tcs
+
+    # The parent runs a radius past the origin, so no caps coincide
+    parent = Tube((0., 0., 0.5 * (radius - length)), (0., 0., 1.), radius, length + radius)
+
+    union = parent
+    for d in DaughterDirections(angle):
+        daughter = Tube(0.5 * length * d, d, DaughterRadius(radius), length)
+        join = vtkBooleanOperationPolyDataFilter()
+        join.SetOperationToUnion()
+        join.SetInputConnection(0, union.GetOutputPort())
+        join.SetInputConnection(1, daughter.GetOutputPort())
+        union = join
+        continue
+
+    union.Update()
+    return union.GetOutput()
+
+def BifurcationGenerator(radius, length, angle, resolution, outfile):
+    """Write an STL file of a bifurcation (see BifurcationSurface) to the
+    specified file.
+    """
+    w = vtkSTLWriter()
+    w.SetInput(BifurcationSurface(radius, length, angle, resolution))
+    w.SetFileName(outfile)
+    w.Write()
+
+if __name__ == "__main__":
+    import argparse
+    p = argparse.ArgumentParser()
+    p.add_argument('radius', type=float, help='parent vessel radius / mm')
+    p.add_argument('length', type=float, help='length of each vessel / mm')
+    p.add_argument('angle', type=float, help='angle between each daughter and the parent axis in degrees')
+    p.add_argument('resolution', type=int, help='number of segments around circumference')
+    p.add_argument('outfile', help='output file name')
+
+    args = p.parse_args()
+    BifurcationGenerator(args.radius, args.length, args.angle, args.resolution, args.outfile)
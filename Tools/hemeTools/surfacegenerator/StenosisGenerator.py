@@ -0,0 +1,69 @@
+# This file is part of HemeLB and is Copyright (C)
+# the HemeLB team and/or their institutions, as detailed in the
+# file AUTHORS. This software is provided under the terms of the
+# license in the file LICENSE.
+
+from vtk import vtkPoints, vtkCellArray, vtkPolyData, vtkSTLWriter
+import numpy as np
+
+def StenosisSurface(radius, length, severity, stenosisLength, resolution):
+    """Return a vtkPolyData of a triangulated, uncapped, origin-centred tube
+    along the z-axis, whose radius is reduced by the fraction severity at its
+    centre, following a cosine over stenosisLength.
+    """
+    # Rows of near-right-angled triangles, as for TriangulatedCylinderSource
+    dx = 2 * radius * np.sin(np.pi / resolution)
+    nz = int(np.round(length / dx))
+    zs = np.linspace(-0.5 * length, 0.5 * length, nz + 1)
+    thetas = np.linspace(0., 2 * np.pi, resolution, endpoint=False)
+
+    def RadiusAt(z):
+        if abs(z) >= 0.5 * stenosisLength:
+            return radius
+        return radius * (1. - 0.5 * severity * (1. + np.cos(2 * np.pi * z / stenosisLength)))
+
+    points = vtkPoints()
+    for z in zs:
+        r = RadiusAt(z)
+        for theta in thetas:
+            points.InsertNextPoint(r * np.cos(theta), r * np.sin(theta), z)
+            continue
+        continue
+
+    triangles = vtkCellArray()
+    for i in xrange(nz):
+        for j in xrange(resolution):
+            a = i * resolution + j
+            b = i * resolution + (j + 1) % resolution
+            triangles.InsertNextCell(3, (a, b, b + resolution))
+            triangles.InsertNextCell(3, (a, b + resolution, a + resolution))
+            continue
+        continue
+
+    surface = vtkPolyData()
+    surface.SetPoints(points)
+    surface.SetPolys(triangles)
+    return surface
+
+def StenosisGenerator(radius, length, severity, stenosisLength, resolution, outfile):
+    """Write an STL file of a stenosed tube (see StenosisSurface) to the
+    specified file.
+    """
+    w = vtkSTLWriter()
+    w.SetInput(StenosisSurface(radius, length, severity, stenosisLength, resolution))
+    w.SetFileName(outfile)
+    w.Write()
+
+if __name__ == "__main__":
+    import argparse
+    p = argparse.ArgumentParser()
+    p.add_argument('radius', type=float, help='unconstricted radius / mm')
+    p.add_argument('length', type=float, help='tube length / mm')
+    p.add_argument('severity', type=float, help='fraction of the radius lost at the throat')
+    p.add_argument('stenosis_length', type=float, help='length of the constriction / mm')
+    p.add_argument('resolution', type=int, help='number of segments around circumference')
+    p.add_argument('outfile', help='output file name')
+
+    args = p.parse_args()
+    StenosisGenerator(args.radius, args.length, args.severity, args.stenosis_length,
+                      args.resolution, args.outfile)
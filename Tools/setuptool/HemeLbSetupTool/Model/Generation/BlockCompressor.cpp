@@ -0,0 +1,135 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+
+#include <zlib.h>
+#ifdef HEMELB_SETUPTOOL_ZSTD
+#include <zstd.h>
+#include <zdict.h>
+#endif
+
+#include "BlockCompressor.h"
+#include "GenerationError.h"
+
+#include "io/formats/geometry.h"
+
+using hemelb::io::formats::geometry;
+
+#ifdef HEMELB_SETUPTOOL_ZSTD
+// Decompression speed barely depends on the level, so spend the time here.
+static const int ZstdLevel = 19;
+#endif
+
+BlockCompressor::BlockCompressor(unsigned int compression) :
+		compression(compression), compressionDictionary(NULL) {
+	switch (compression) {
+	case geometry::ZLIB_COMPRESSION:
+		break;
+	case geometry::ZSTD_COMPRESSION:
+#ifdef HEMELB_SETUPTOOL_ZSTD
+		break;
+#else
+		throw GenerationErrorMessage(
+				"zstd compression needs the setup tool built with HEMELB_SETUPTOOL_ZSTD");
+#endif
+	default:
+		throw GenerationErrorMessage("Unknown block compression");
+	}
+}
+
+BlockCompressor::~BlockCompressor() {
+#ifdef HEMELB_SETUPTOOL_ZSTD
+	ZSTD_freeCDict(static_cast<ZSTD_CDict*>(this->compressionDictionary));
+#endif
+}
+
+void BlockCompressor::TrainDictionary(const std::vector<char>& samples,
+		const std::vector<size_t>& sampleLengths) {
+#ifdef HEMELB_SETUPTOOL_ZSTD
+	if (this->compression != geometry::ZSTD_COMPRESSION
+			|| sampleLengths.empty())
+		return;
+
+	// zdict wants a good deal more sample data than dictionary.
+	std::vector<char> trained(
+			std::min<size_t>(geometry::MaxDictionaryLength,
+					samples.size() / 16));
+	if (trained.empty())
+		return;
+	size_t length = ZDICT_trainFromBuffer(&trained[0], trained.size(),
+			&samples[0], &sampleLengths[0], sampleLengths.size());
+	if (ZDICT_isError(length))
+		// Too few or too alike samples; the blocks go without.
+		return;
+
+	trained.resize(length);
+	this->dictionary.swap(trained);
+	ZSTD_freeCDict(static_cast<ZSTD_CDict*>(this->compressionDictionary));
+	this->compressionDictionary = ZSTD_createCDict(&this->dictionary[0],
+			this->dictionary.size(), ZstdLevel);
+	if (this->compressionDictionary == NULL)
+		throw GenerationErrorMessage("Cannot digest zstd dictionary");
+#endif
+}
+
+size_t BlockCompressor::Compress(const char* in, size_t length, char* out,
+		size_t capacity) const {
+#ifdef HEMELB_SETUPTOOL_ZSTD
+	if (this->compression == geometry::ZSTD_COMPRESSION) {
+		// A context each time, so that threads can compress at once.
+		ZSTD_CCtx* context = ZSTD_createCCtx();
+		if (context == NULL)
+			throw GenerationErrorMessage("Cannot init zstd structures");
+		size_t ret =
+				this->compressionDictionary == NULL ?
+						ZSTD_compressCCtx(context, out, capacity, in, length,
+								ZstdLevel) :
+						ZSTD_compress_usingCDict(context, out, capacity, in,
+								length,
+								static_cast<const ZSTD_CDict*>(this->compressionDictionary));
+		ZSTD_freeCCtx(context);
+		if (ZSTD_isError(ret))
+			throw GenerationErrorMessage("Error compressing buffer");
+		return ret;
+	}
+#endif
+
+	int ret; // zlib return code
+
+	// Set up our compressor
+	z_stream stream;
+	stream.zalloc = Z_NULL;
+	stream.zfree = Z_NULL;
+	stream.opaque = Z_NULL;
+	// Max compression
+	ret = deflateInit(&stream, 9);
+	if (ret != Z_OK)
+		throw GenerationErrorMessage("Cannot init zlib structures");
+
+	// Set input. The XDR buffer has to be char but zlib only works with
+	// unsigned char. Just cast for now...
+	stream.next_in = reinterpret_cast<unsigned char*>(const_cast<char*>(in));
+	stream.avail_in = length;
+	// Set output
+	stream.next_out = reinterpret_cast<unsigned char*>(out);
+	stream.avail_out = capacity;
+
+	// Deflate. This should be it, if not their was an error.
+	ret = deflate(&stream, Z_FINISH);
+	if (ret != Z_STREAM_END)
+		throw GenerationErrorMessage("Error compressing buffer");
+
+	// How much space did we actually use?
+	size_t compressedLength = reinterpret_cast<char*>(stream.next_out) - out;
+
+	// Tell zlib to clean up.
+	ret = deflateEnd(&stream);
+	if (ret != Z_OK)
+		throw GenerationErrorMessage("Cannot free zlib structures");
+
+	return compressedLength;
+}
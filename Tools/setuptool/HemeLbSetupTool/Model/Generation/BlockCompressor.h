@@ -0,0 +1,53 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELBSETUPTOOL_BLOCKCOMPRESSOR_H
+#define HEMELBSETUPTOOL_BLOCKCOMPRESSOR_H
+
+#include <stddef.h>
+#include <vector>
+
+/*
+ * Compresses the data of each block with the codec named in the geometry
+ * file's preamble (see io/formats/geometry.h). For zstd, a dictionary may be
+ * trained on some blocks first and is then used for all of them. Compress is
+ * safe to call from several threads at once.
+ */
+class BlockCompressor {
+public:
+	BlockCompressor(unsigned int compression);
+	~BlockCompressor();
+
+	unsigned int GetCompression() const {
+		return this->compression;
+	}
+
+	// Train a zstd dictionary on the samples, which must all be concatenated
+	// in samples. Does nothing for zlib, or if the samples are too few to
+	// train on.
+	void TrainDictionary(const std::vector<char>& samples,
+			const std::vector<size_t>& sampleLengths);
+
+	const std::vector<char>& GetDictionary() const {
+		return this->dictionary;
+	}
+
+	// Compress length bytes from in to out, which has space for capacity
+	// bytes, returning the compressed length.
+	size_t Compress(const char* in, size_t length, char* out,
+			size_t capacity) const;
+
+private:
+	BlockCompressor(const BlockCompressor&);
+	BlockCompressor& operator=(const BlockCompressor&);
+
+	unsigned int compression;
+	std::vector<char> dictionary;
+	// The digested dictionary (a ZSTD_CDict), or NULL.
+	void* compressionDictionary;
+};
+
+#endif // HEMELBSETUPTOOL_BLOCKCOMPRESSOR_H
@@ -6,21 +6,29 @@
 
 #include <cstdio>
 
-#include <zlib.h>
-
 #include "BlockWriter.h"
+#include "BlockCompressor.h"
 #include "GeometryWriter.h"
 #include "Neighbours.h"
 #include "GenerationError.h"
 #include "BufferPool.h"
 
-BlockWriter::BlockWriter(BufferPool* bp) :
-		writer(NULL), buffer(NULL), bufferPool(bp) {
+#include "io/formats/formats.h"
+#ifdef HEMELB_SETUPTOOL_MPI
+#include "ParallelGeometryWriter.h"
+#endif
+
+BlockWriter::BlockWriter(BufferPool* bp, const BlockCompressor* compressor) :
+		writer(NULL), buffer(NULL), bufferPool(bp), compressor(compressor) {
 	this->Reset();
 }
 
 void BlockWriter::Reset() {
 	this->nFluidSites = 0;
+	for (unsigned int i = 0;
+			i < hemelb::io::formats::blockstats::CollisionTypeCount; ++i) {
+		this->SitesOfType[i] = 0;
+	}
 	this->CompressedBlockLength = 0;
 	this->UncompressedBlockLength = 0;
 
@@ -43,53 +51,43 @@ void BlockWriter::IncrementFluidSitesCount() {
 	this->nFluidSites++;
 }
 
+void BlockWriter::CountCollisionType(unsigned int collisionType) {
+	this->SitesOfType[collisionType]++;
+}
+
+BlockStats BlockWriter::GetStats(uint64_t bodyOffset) const {
+	BlockStats stats;
+	stats.nFluidSites = this->nFluidSites;
+	stats.BodyOffset = bodyOffset;
+	for (unsigned int i = 0;
+			i < hemelb::io::formats::blockstats::CollisionTypeCount; ++i) {
+		stats.SitesOfType[i] = this->SitesOfType[i];
+	}
+	return stats;
+}
+
+void BlockWriter::AppendSample(std::vector<char>& samples,
+		std::vector<size_t>& sampleLengths) const {
+	if (this->nFluidSites > 0) {
+		const size_t length = this->writer->getCurrentStreamPosition();
+		samples.insert(samples.end(), this->buffer, this->buffer + length);
+		sampleLengths.push_back(length);
+	}
+}
+
 void BlockWriter::Finish() {
 	this->CompressedBlockLength = 0;
 	this->UncompressedBlockLength = 0;
 
 	if (this->nFluidSites > 0) {
-		int ret; // zlib return code
-
 		// How much data to compress?
 		this->UncompressedBlockLength =
 				this->writer->getCurrentStreamPosition();
 
-		// Set up our compressor
-		z_stream stream;
-		stream.zalloc = Z_NULL;
-		stream.zfree = Z_NULL;
-		stream.opaque = Z_NULL;
-		// Max compression
-		ret = deflateInit(&stream, 9);
-		if (ret != Z_OK)
-			throw GenerationErrorMessage("Cannot init zlib structures");
-
-//		// Compute upper bound for how much space we'll need.
-//		int maxDeflatedLength = deflateBound(&stream,
-//				this->UncompressedBlockLength);
 		char* compressedBuffer = this->bufferPool->New();
-
-		// Set input. The XDR buffer has to be char but zlib only works with
-		// unsigned char. Just cast for now...
-		stream.next_in = reinterpret_cast<unsigned char*>(this->buffer);
-		stream.avail_in = this->UncompressedBlockLength;
-		// Set output
-		stream.next_out = reinterpret_cast<unsigned char*>(compressedBuffer);
-		stream.avail_out = this->bufferPool->GetSize();
-
-		// Deflate. This should be it, if not their was an error.
-		ret = deflate(&stream, Z_FINISH);
-		if (ret != Z_STREAM_END)
-			throw GenerationErrorMessage("Error compressing buffer");
-
-		// How much space did we actually use?
-		this->CompressedBlockLength = reinterpret_cast<char*>(stream.next_out)
-				- compressedBuffer;
-
-		// Tell zlib to clean up.
-		ret = deflateEnd(&stream);
-		if (ret != Z_OK)
-			throw GenerationErrorMessage("Cannot free zlib structures");
+		this->CompressedBlockLength = this->compressor->Compress(this->buffer,
+				this->UncompressedBlockLength, compressedBuffer,
+				this->bufferPool->GetSize());
 
 		std::swap(this->buffer, compressedBuffer);
 		this->bufferPool->Free(compressedBuffer);
@@ -110,6 +108,53 @@ void BlockWriter::Write(GeometryWriter& gw) {
 
 		std::fwrite(this->buffer, 1, this->CompressedBlockLength, gw.bodyFile);
 	}
+	if (gw.writeBlockStats) {
+		gw.blockStats.push_back(this->GetStats(gw.bodyBytes));
+	}
+	gw.bodyBytes += this->CompressedBlockLength;
+	*(gw.headerEncoder) << this->nFluidSites << this->CompressedBlockLength
+			<< this->UncompressedBlockLength;
+}
+
+#ifdef HEMELB_SETUPTOOL_MPI
+void BlockWriter::Write(ParallelGeometryWriter& gw) {
+	if (this->nFluidSites > 0) {
+		if (this->buffer == NULL)
+			throw GenerationErrorMessage("Cannot write NULL buffer");
+
+		gw.body.insert(gw.body.end(), this->buffer,
+				this->buffer + this->CompressedBlockLength);
+	}
+	if (gw.writeBlockStats) {
+		// The offset is from the start of this rank's part for now.
+		gw.blockStats.push_back(
+				this->GetStats(gw.body.size() - this->CompressedBlockLength));
+	}
 	*(gw.headerEncoder) << this->nFluidSites << this->CompressedBlockLength
 			<< this->UncompressedBlockLength;
 }
+#endif
+
+void BlockStats::Encode(hemelb::io::writers::xdr::XdrWriter& encoder,
+		uint64_t bodyStart) const {
+	encoder << this->nFluidSites << static_cast<uint64_t>(bodyStart
+			+ this->BodyOffset);
+	for (unsigned int i = 0;
+			i < hemelb::io::formats::blockstats::CollisionTypeCount; ++i) {
+		encoder << this->SitesOfType[i];
+	}
+}
+
+void BlockStats::EncodePreamble(hemelb::io::writers::xdr::XdrWriter& encoder,
+		unsigned int nBlocks, unsigned int geometryChecksum) {
+	encoder
+			<< static_cast<unsigned int>(hemelb::io::formats::HemeLbMagicNumber);
+	encoder
+			<< static_cast<unsigned int>(hemelb::io::formats::blockstats::MagicNumber);
+	encoder
+			<< static_cast<unsigned int>(hemelb::io::formats::blockstats::VersionNumber);
+	encoder << nBlocks;
+	encoder
+			<< static_cast<unsigned int>(hemelb::io::formats::blockstats::CollisionTypeCount);
+	encoder << geometryChecksum;
+}
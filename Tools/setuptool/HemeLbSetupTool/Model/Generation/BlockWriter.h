@@ -8,11 +8,35 @@
 #define HEMELBSETUPTOOL_BLOCKWRITER_H
 
 #include <stddef.h>
+#include <stdint.h>
 #include <string>
+#include <vector>
+#include "io/formats/blockstats.h"
 #include "io/writers/xdr/XdrMemWriter.h"
 
 class GeometryWriter;
+class ParallelGeometryWriter;
 class BufferPool;
+class BlockCompressor;
+
+/*
+ * What the block statistics file records about a block: its fluid sites,
+ * where its data starts in the body of the geometry file and how many of its
+ * sites are of each collision type.
+ */
+struct BlockStats {
+	unsigned int nFluidSites;
+	uint64_t BodyOffset;
+	unsigned int SitesOfType[hemelb::io::formats::blockstats::CollisionTypeCount];
+
+	// Encode a record, with the offset counted from the start of the file.
+	void Encode(hemelb::io::writers::xdr::XdrWriter& encoder,
+			uint64_t bodyStart) const;
+	// Encode the preamble for nBlocks blocks.
+	static void EncodePreamble(hemelb::io::writers::xdr::XdrWriter& encoder,
+			unsigned int nBlocks, unsigned int geometryChecksum);
+};
+
 /*
  * Extension of a hemelb::io::XdrWriter that notes how many fluid sites, in how
  * much space, have been written. It then pushes this to the GeometryWriter's
@@ -21,15 +45,24 @@ class BufferPool;
 
 class BlockWriter {
 public:
-	BlockWriter(BufferPool* bp);
+	BlockWriter(BufferPool* bp, const BlockCompressor* compressor);
 	void Reset();
 
 	~BlockWriter();
 
 	void IncrementFluidSitesCount();
+	// Count a fluid site of a collision type, in the order of BlockStats.
+	void CountCollisionType(unsigned int collisionType);
+
+	// Append the data written so far to samples for training a dictionary.
+	void AppendSample(std::vector<char>& samples,
+			std::vector<size_t>& sampleLengths) const;
 
 	void Finish();
 	void Write(GeometryWriter& gw);
+#ifdef HEMELB_SETUPTOOL_MPI
+	void Write(ParallelGeometryWriter& gw);
+#endif
 
 	// Overload << to delegate to the XdrMemWriter
 	template<typename T>
@@ -39,10 +72,14 @@ public:
 	}
 
 protected:
+	BlockStats GetStats(uint64_t bodyOffset) const;
+
 	char* buffer;
 	hemelb::io::writers::xdr::XdrMemWriter* writer;
 	BufferPool* bufferPool;
+	const BlockCompressor* compressor;
 	unsigned int nFluidSites;
+	unsigned int SitesOfType[hemelb::io::formats::blockstats::CollisionTypeCount];
 	unsigned int CompressedBlockLength;
 	unsigned int UncompressedBlockLength;
 	bool IsFinished;
@@ -20,6 +20,7 @@ BufferPool::~BufferPool() {
 
 char* BufferPool::New() {
 	// If the stack is empty, create a new array, otherwise pop an array
+	std::lock_guard<std::mutex> lock(this->mutex);
 	if (this->unused.empty()) {
 		return new char[this->size];
 	} else {
@@ -33,6 +34,7 @@ void BufferPool::Free(char* buf) {
 	// If the buffer is NULL, skip
 	if (buf == NULL)
 		return;
+	std::lock_guard<std::mutex> lock(this->mutex);
 	// If we have fewer than 10, add this one to the unused, otherwise delete it
 	if (this->unused.size() < 10) {
 		this->unused.push(buf);
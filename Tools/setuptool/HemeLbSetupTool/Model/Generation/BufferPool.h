@@ -6,9 +6,11 @@
 
 #ifndef HEMELBSETUPTOOL_BUFFERPOOL_H
 #define HEMELBSETUPTOOL_BUFFERPOOL_H
+#include <mutex>
 #include <stack>
 
-// Allocates and frees or reuses buffers of a given size.
+// Allocates and frees or reuses buffers of a given size. Blocks may be
+// compressed on several threads at once, so this is thread safe.
 class BufferPool {
 public:
 	// C'tor- argument is the size of buffers to work with.
@@ -23,6 +25,7 @@ public:
 private:
 	unsigned int size;
 	std::stack<char*> unused;
+	std::mutex mutex;
 };
 
 #endif
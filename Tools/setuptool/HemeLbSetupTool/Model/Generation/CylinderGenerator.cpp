@@ -202,6 +202,10 @@ Hit ComputeIntersection(CylinderData* cyl, std::vector<Iolet*>& iolets,
 	return ans;
 }
 
+bool CylinderGenerator::IsInside(Site& site) {
+	return IsInsideCylinder(this->Cylinder, site.Position);
+}
+
 /*
  * Given a site with known fluidness, examine the links to not-yet-visited
  * neighbouring sites. If the neighbours have unknown fluidness, set that.
@@ -47,6 +47,7 @@ public:
 private:
 	virtual void ComputeBounds(double []) const;
 	void ClassifySite(Site& site);
+	virtual bool IsInside(Site& site);
 	void ComputeCylinderNormalAtAPoint(Vector& wallNormal, const Vector& surfacePoint, const Vector& cylinderAxis) const;
 	CylinderData* Cylinder;
 protected:
@@ -11,6 +11,11 @@
 #include "Site.h"
 #include "Block.h"
 #include "Domain.h"
+#include "BlockWriter.h"
+#include "ThreadPool.h"
+#ifdef HEMELB_SETUPTOOL_MPI
+#include "ParallelGeometryWriter.h"
+#endif
 
 #include "Debug.h"
 
@@ -19,7 +24,12 @@
 
 using namespace hemelb::io::formats;
 
-GeometryGenerator::GeometryGenerator() {
+// The number of classified blocks kept to be compressed together.
+static const unsigned int CommitBlockCount = 64;
+
+GeometryGenerator::GeometryGenerator() :
+		Threads(1), WriteBlockStats(false), BlockCompression(
+				geometry::ZLIB_COMPRESSION) {
 	Neighbours::Init();
 }
 
@@ -30,6 +40,32 @@ void GeometryGenerator::PreExecute() {
 
 }
 
+void GeometryGenerator::PrepareBlock(Block& block, ThreadPool& pool) {
+
+}
+
+// Compress the blocks on all the pool's threads, then write them in order.
+template<typename WriterType>
+static void CommitBlocksTo(std::vector<BlockWriter*>& blockWriters,
+		WriterType& writer, ThreadPool& pool) {
+	writer.PrepareToCompress(blockWriters);
+	pool.ForEach(blockWriters.size(),
+			[&blockWriters](unsigned int worker, unsigned int i) {
+				blockWriters[i]->Finish();
+			});
+
+	for (unsigned int i = 0; i < blockWriters.size(); ++i) {
+		blockWriters[i]->Write(writer);
+		delete blockWriters[i];
+	}
+	blockWriters.clear();
+}
+
+void GeometryGenerator::CommitBlocks(std::vector<BlockWriter*>& blockWriters,
+		GeometryWriter& writer, ThreadPool& pool) {
+	CommitBlocksTo(blockWriters, writer, pool);
+}
+
 void GeometryGenerator::Execute(bool skipNonIntersectingBlocks)
 		throw (GenerationError) {
 
@@ -43,8 +79,29 @@ void GeometryGenerator::Execute(bool skipNonIntersectingBlocks)
 	this->ComputeBounds(bounds);
 	Domain domain(this->OriginWorking, this->SiteCounts);
 
+	// Classification goes through the blocks in order, as the fluidness of
+	// each site is worked out from its neighbours'. The pool prepares each
+	// block before that, and compresses the finished blocks, which wait here
+	// so that they are written in order.
+	ThreadPool pool(this->Threads);
+
+#ifdef HEMELB_SETUPTOOL_MPI
+	int mpiInitialised = 0;
+	MPI_Initialized(&mpiInitialised);
+	int ranks = 1;
+	if (mpiInitialised) {
+		MPI_Comm_size(MPI_COMM_WORLD, &ranks);
+	}
+	if (ranks > 1) {
+		this->ExecuteDistributed(domain, pool, skipNonIntersectingBlocks);
+		return;
+	}
+#endif
+
 	GeometryWriter writer(this->OutputGeometryFile, domain.GetBlockSize(),
-			domain.GetBlockCounts());
+			domain.GetBlockCounts(), this->WriteBlockStats,
+			this->BlockCompression);
+	std::vector<BlockWriter*> classifiedBlocks;
 
 	for (BlockIterator blockIt = domain.begin(); blockIt != domain.end();
 			++blockIt) {
@@ -52,61 +109,144 @@ void GeometryGenerator::Execute(bool skipNonIntersectingBlocks)
 		// deal with flushing the state to the file (or not, in the
 		// case where there are no fluid sites).
 		BlockWriter* blockWriterPtr = writer.StartNextBlock();
-		Block& block = *blockIt;
+		this->ClassifyBlock(*blockIt, *blockWriterPtr, pool,
+				skipNonIntersectingBlocks);
+		classifiedBlocks.push_back(blockWriterPtr);
+		if (classifiedBlocks.size() == CommitBlockCount) {
+			this->CommitBlocks(classifiedBlocks, writer, pool);
+		}
+	}
+	this->CommitBlocks(classifiedBlocks, writer, pool);
+	writer.Close();
+}
+
+#ifdef HEMELB_SETUPTOOL_MPI
+void GeometryGenerator::ExecuteDistributed(Domain& domain, ThreadPool& pool,
+		bool skipNonIntersectingBlocks) {
+	int rank, ranks;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &ranks);
 
-		int side = 0; // represents whether the block is inside (-1) outside (+1) or undetermined (0)
+	// Each rank has a run of whole planes of blocks (of constant x), whose
+	// blocks are consecutive in the file.
+	const Index blockCounts = domain.GetBlockCounts();
+	const int firstPlane = static_cast<long>(blockCounts[0]) * rank / ranks;
+	const int endPlane = static_cast<long>(blockCounts[0]) * (rank + 1) / ranks;
+	const unsigned int blocksPerPlane = blockCounts[1] * blockCounts[2];
 
-		if (skipNonIntersectingBlocks) {
-			side = this->BlockInsideOrOutsideSurface(block);
-		} else { // don't use the optimisation -- check every site
-			side = 0;
+	ParallelGeometryWriter writer(this->OutputGeometryFile,
+			domain.GetBlockSize(), blockCounts, MPI_COMM_WORLD,
+			firstPlane * blocksPerPlane, (endPlane - firstPlane) * blocksPerPlane,
+			this->WriteBlockStats, this->BlockCompression);
+
+	if (firstPlane > 0 && firstPlane < endPlane) {
+		this->ClassifyHaloPlane(domain, firstPlane);
+	}
+
+	std::vector<BlockWriter*> classifiedBlocks;
+	const BlockIterator end(domain, Index(endPlane, 0, 0));
+	for (BlockIterator blockIt(domain, Index(firstPlane, 0, 0)); blockIt != end;
+			++blockIt) {
+		BlockWriter* blockWriterPtr = writer.StartNextBlock();
+		this->ClassifyBlock(*blockIt, *blockWriterPtr, pool,
+				skipNonIntersectingBlocks);
+		classifiedBlocks.push_back(blockWriterPtr);
+		if (classifiedBlocks.size() == CommitBlockCount) {
+			CommitBlocksTo(classifiedBlocks, writer, pool);
 		}
+	}
+	CommitBlocksTo(classifiedBlocks, writer, pool);
+	writer.Close();
+}
 
-		switch (side) {
-		case 1:
-			// Block is entirely outside the domain.
-			// We don't have to do anything.
-			break;
-		case 0:
-			// Block has some surface within it.
+void GeometryGenerator::ClassifyHaloPlane(Domain& domain, int firstPlane) {
+	// The last plane of sites before this rank's. The rank before classifies
+	// these sites too, having found their fluidness from their neighbours';
+	// here it is found directly, and they are classified to set the links
+	// from them to this rank's first sites.
+	const int blockSize = domain.GetBlockSize();
+	const Index blockCounts = domain.GetBlockCounts();
+	const int haloSiteX = firstPlane * blockSize - 1;
+
+	std::vector<Site*> haloSites;
+	for (int j = 0; j < blockCounts[1]; ++j) {
+		for (int k = 0; k < blockCounts[2]; ++k) {
+			Block& block = domain.GetBlock(Index(firstPlane - 1, j, k));
 			for (SiteIterator siteIt = block.begin(); siteIt != block.end();
 					++siteIt) {
 				Site& site = **siteIt;
-				this->ClassifySite(site);
-				// here we should check site
-				if (site.IsFluid) {
-					blockWriterPtr->IncrementFluidSitesCount();
-					WriteFluidSite(*blockWriterPtr, site);
-				} else {
-					WriteSolidSite(*blockWriterPtr, site);
+				if (site.GetIndex()[0] != haloSiteX) {
+					continue;
+				}
+				if (!site.IsFluidKnown) {
+					site.IsFluid = this->IsInside(site);
+					site.IsFluidKnown = true;
+					if (site.IsFluid) {
+						site.CreateLinksVector();
+					}
 				}
+				haloSites.push_back(&site);
+			}
+		}
+	}
 
+	for (unsigned int i = 0; i < haloSites.size(); ++i) {
+		this->ClassifySite(*haloSites[i]);
+	}
+}
+#endif
+
+void GeometryGenerator::ClassifyBlock(Block& block, BlockWriter& blockWriter,
+		ThreadPool& pool, bool skipNonIntersectingBlocks) {
+	int side = 0; // represents whether the block is inside (-1) outside (+1) or undetermined (0)
+
+	if (skipNonIntersectingBlocks) {
+		side = this->BlockInsideOrOutsideSurface(block);
+	} else { // don't use the optimisation -- check every site
+		side = 0;
+	}
+
+	switch (side) {
+	case 1:
+		// Block is entirely outside the domain.
+		// We don't have to do anything.
+		break;
+	case 0:
+		// Block has some surface within it.
+		this->PrepareBlock(block, pool);
+		for (SiteIterator siteIt = block.begin(); siteIt != block.end();
+				++siteIt) {
+			Site& site = **siteIt;
+			this->ClassifySite(site);
+			// here we should check site
+			if (site.IsFluid) {
+				blockWriter.IncrementFluidSitesCount();
+				WriteFluidSite(blockWriter, site);
+			} else {
+				WriteSolidSite(blockWriter, site);
 			}
-			break;
-		case -1:
-			// Block is entirely inside the domain
-			for (SiteIterator siteIt = block.begin(); siteIt != block.end();
-					++siteIt) {
-				Site& site = **siteIt;
-				site.IsFluidKnown = true;
-				site.IsFluid = true;
-				site.CreateLinksVector();
-				for (unsigned int link_index = 0;
-						link_index < site.Links.size(); ++link_index) {
-					site.Links[link_index].Type = geometry::CUT_NONE;
-				}
-				blockWriterPtr->IncrementFluidSitesCount();
-				WriteFluidSite(*blockWriterPtr, site);
+
+		}
+		break;
+	case -1:
+		// Block is entirely inside the domain
+		for (SiteIterator siteIt = block.begin(); siteIt != block.end();
+				++siteIt) {
+			Site& site = **siteIt;
+			site.IsFluidKnown = true;
+			site.IsFluid = true;
+			site.CreateLinksVector();
+			for (unsigned int link_index = 0;
+					link_index < site.Links.size(); ++link_index) {
+				site.Links[link_index].Type = geometry::CUT_NONE;
 			}
-			break;
-		default:
-			break;
+			blockWriter.IncrementFluidSitesCount();
+			WriteFluidSite(blockWriter, site);
 		}
-		blockWriterPtr->Finish();
-		blockWriterPtr->Write(writer);
-		delete blockWriterPtr;
+		break;
+	default:
+		break;
 	}
-	writer.Close();
 }
 
 void GeometryGenerator::WriteSolidSite(BlockWriter& blockWriter, Site& site) {
@@ -117,9 +257,17 @@ void GeometryGenerator::WriteSolidSite(BlockWriter& blockWriter, Site& site) {
 void GeometryGenerator::WriteFluidSite(BlockWriter& blockWriter, Site& site) {
 	blockWriter << static_cast<unsigned int>(geometry::FLUID);
 
+	// Which kinds of boundary the site's links cut, for its collision type.
+	bool hasWall = false;
+	bool hasInlet = false;
+	bool hasOutlet = false;
+
 	// Iterate over the displacements of the neighbourhood
 	for (unsigned int i = 0; i < Neighbours::n; ++i) {
 		unsigned int cutType = site.Links[i].Type;
+		hasWall = hasWall || cutType == geometry::CUT_WALL;
+		hasInlet = hasInlet || cutType == geometry::CUT_INLET;
+		hasOutlet = hasOutlet || cutType == geometry::CUT_OUTLET;
 
 		if (cutType == geometry::CUT_NONE) {
 			blockWriter << static_cast<unsigned int>(geometry::CUT_NONE);
@@ -140,6 +288,15 @@ void GeometryGenerator::WriteFluidSite(BlockWriter& blockWriter, Site& site) {
 		}
 	}
 
+	// Bulk, wall, inlet, outlet, wall/inlet or wall/outlet, as HemeLB decides
+	// it, with an inlet taking precedence over an outlet.
+	const unsigned int ioletType = hasInlet ? 1 : (hasOutlet ? 2 : 0);
+	if (hasWall) {
+		blockWriter.CountCollisionType(ioletType == 0 ? 1 : ioletType + 3);
+	} else {
+		blockWriter.CountCollisionType(ioletType == 0 ? 0 : ioletType + 1);
+	}
+
 	// Indicate whether the current fluid site has a wall normal available and
 	// if so write it.
 	if (site.WallNormalAvailable) {
@@ -17,6 +17,8 @@ class GeometryWriter;
 class Site;
 class BlockWriter;
 class Block;
+class Domain;
+class ThreadPool;
 
 class GeometryGenerator {
 public:
@@ -50,6 +52,32 @@ public:
 		this->SiteCounts[2] = z;
 	}
 
+	// The number of threads to generate with, including the calling one.
+	inline unsigned GetThreads(void) {
+		return this->Threads;
+	}
+	inline void SetThreads(unsigned val) {
+		this->Threads = val > 0 ? val : 1;
+	}
+
+	// Whether to write a block statistics file beside the geometry file, so
+	// that HemeLB can balance the decomposition without reading the blocks.
+	inline bool GetWriteBlockStats(void) {
+		return this->WriteBlockStats;
+	}
+	inline void SetWriteBlockStats(bool val) {
+		this->WriteBlockStats = val;
+	}
+
+	// How to compress each block, as one of the geometry format's
+	// BlockCompressions.
+	inline unsigned GetBlockCompression(void) {
+		return this->BlockCompression;
+	}
+	inline void SetBlockCompression(unsigned val) {
+		this->BlockCompression = val;
+	}
+
 	/**
 	 * This method implements the algorithm used to approximate the wall normal at a given
 	 * fluid site. This is done based on the normal of the triangles intersected by
@@ -66,6 +94,31 @@ protected:
 	virtual void ComputeBounds(double[]) const = 0;
 	virtual void PreExecute(void);
 	virtual void ClassifySite(Site& site) = 0;
+	/*
+	 * Called before the sites of a block with some surface in it are
+	 * classified, in order, to do the work for them that doesn't depend on
+	 * the order (such as intersecting the links with the surface) on all the
+	 * pool's threads.
+	 */
+	virtual void PrepareBlock(Block& block, ThreadPool& pool);
+	// Compress the blocks on all the pool's threads, then write them in order.
+	void CommitBlocks(std::vector<BlockWriter*>& blockWriters,
+			GeometryWriter& writer, ThreadPool& pool);
+	// Classify a block's sites and write them to the block's writer.
+	void ClassifyBlock(Block& block, BlockWriter& blockWriter,
+			ThreadPool& pool, bool skipNonIntersectingBlocks);
+	// Whether a site is fluid, found directly rather than from a neighbour.
+	virtual bool IsInside(Site& site) = 0;
+#ifdef HEMELB_SETUPTOOL_MPI
+	/*
+	 * Generate the blocks of a run of planes of blocks on each rank of
+	 * MPI_COMM_WORLD, writing the file collectively.
+	 */
+	void ExecuteDistributed(Domain& domain, ThreadPool& pool,
+			bool skipNonIntersectingBlocks);
+	// Classify the plane of sites just before a rank's first plane of blocks.
+	void ClassifyHaloPlane(Domain& domain, int firstPlane);
+#endif
 	//virtual void CreateCGALPolygon(void);
 	void WriteSolidSite(BlockWriter& blockWriter, Site& site);
 	void WriteFluidSite(BlockWriter& blockWriter, Site& site);
@@ -74,6 +127,9 @@ protected:
 	unsigned SiteCounts[3];
 	std::string OutputGeometryFile;
 	std::vector<Iolet*> Iolets;
+	unsigned Threads;
+	bool WriteBlockStats;
+	unsigned BlockCompression;
 	virtual int BlockInsideOrOutsideSurface(const Block &block) = 0;
 };
 
@@ -4,9 +4,12 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <zlib.h>
+
 #include "GeometryWriter.h"
 #include "BlockWriter.h"
 #include "BufferPool.h"
+#include "GenerationError.h"
 
 #include "io/formats/formats.h"
 #include "io/formats/geometry.h"
@@ -16,8 +19,11 @@
 using hemelb::io::formats::geometry;
 
 GeometryWriter::GeometryWriter(const std::string& OutputGeometryFile,
-		int BlockSize, Index BlockCounts) :
-		OutputGeometryFile(OutputGeometryFile), BlockSize(BlockSize) {
+		int BlockSize, Index BlockCounts, bool writeBlockStats,
+		unsigned int compression) :
+		OutputGeometryFile(OutputGeometryFile), BlockSize(BlockSize), Compressor(
+				compression), dictionaryTrained(false), bodyBytes(0), writeBlockStats(
+				writeBlockStats) {
 
 	this->BlockBufferPool = new BufferPool(
 			geometry::GetMaxBlockRecordLength(BlockSize));
@@ -49,8 +55,8 @@ GeometryWriter::GeometryWriter(const std::string& OutputGeometryFile,
 		// Sites along 1 dimension of a block
 		encoder << this->BlockSize;
 
-		// padding
-		encoder << 0U;
+		// How the blocks are compressed
+		encoder << compression;
 		// TODO: Check that buffer length is 32 bytes
 
 		// (Dummy) Header
@@ -71,10 +77,18 @@ GeometryWriter::GeometryWriter(const std::string& OutputGeometryFile,
 			encoder << 0;
 		}
 
+		// Space for a zstd dictionary, filled in on closing.
+		this->dictionaryStart = encoder.getCurrentStreamPosition();
+		unsigned int dictionaryLengthInXdrWords =
+				geometry::GetDictionaryRecordLength(compression) / 4;
+		for (unsigned int i = 0; i < dictionaryLengthInXdrWords; ++i) {
+			encoder << 0;
+		}
+
 		this->bodyStart = encoder.getCurrentStreamPosition();
 
 		// Setup the encoder for the header
-		this->headerBufferLength = this->bodyStart - this->headerStart;
+		this->headerBufferLength = this->dictionaryStart - this->headerStart;
 		this->headerBuffer = new char[this->headerBufferLength];
 		this->headerEncoder = new hemelb::io::writers::xdr::XdrMemWriter(
 				this->headerBuffer, this->headerBufferLength);
@@ -102,11 +116,61 @@ void GeometryWriter::Close() {
 	std::FILE* cfg = std::fopen(this->OutputGeometryFile.c_str(), "r+");
 	std::fseek(cfg, this->headerStart, SEEK_SET);
 	std::fwrite(this->headerBuffer, 1, this->headerBufferLength, cfg);
+
+	if (this->Compressor.GetCompression() == geometry::ZSTD_COMPRESSION) {
+		// The dictionary's length, then the dictionary.
+		const std::vector<char>& dictionary = this->Compressor.GetDictionary();
+		char dictionaryLength[4];
+		hemelb::io::writers::xdr::XdrMemWriter encoder(dictionaryLength, 4);
+		encoder << static_cast<unsigned int>(dictionary.size());
+		std::fwrite(dictionaryLength, 1, 4, cfg);
+		if (!dictionary.empty())
+			std::fwrite(&dictionary[0], 1, dictionary.size(), cfg);
+	}
+
+	if (this->writeBlockStats) {
+		// HemeLB checks the statistics are for this geometry with the CRC-32
+		// of everything before the blocks' data.
+		std::vector<unsigned char> preamble(this->bodyStart);
+		std::fseek(cfg, 0, SEEK_SET);
+		if (std::fread(&preamble[0], 1, preamble.size(), cfg)
+				!= preamble.size()) {
+			std::fclose(cfg);
+			throw GenerationErrorMessage(
+					"Cannot reread the header of " + this->OutputGeometryFile);
+		}
+		uLong checksum = crc32(0L, Z_NULL, 0);
+		checksum = crc32(checksum, &preamble[0], preamble.size());
+
+		hemelb::io::writers::xdr::XdrFileWriter encoder(
+				this->OutputGeometryFile
+						+ hemelb::io::formats::blockstats::Extension());
+		BlockStats::EncodePreamble(encoder, this->blockStats.size(), checksum);
+		for (unsigned int i = 0; i < this->blockStats.size(); ++i) {
+			this->blockStats[i].Encode(encoder, this->bodyStart);
+		}
+	}
 	std::fclose(cfg);
 
 }
 
 BlockWriter* GeometryWriter::StartNextBlock() {
-	return new BlockWriter(this->BlockBufferPool);
+	return new BlockWriter(this->BlockBufferPool, &this->Compressor);
+}
+
+void GeometryWriter::PrepareToCompress(
+		const std::vector<BlockWriter*>& blockWriters) {
+	if (this->dictionaryTrained)
+		return;
+	this->dictionaryTrained = true;
+	if (this->Compressor.GetCompression() != geometry::ZSTD_COMPRESSION)
+		return;
+
+	std::vector<char> samples;
+	std::vector<size_t> sampleLengths;
+	for (unsigned int i = 0; i < blockWriters.size(); ++i) {
+		blockWriters[i]->AppendSample(samples, sampleLengths);
+	}
+	this->Compressor.TrainDictionary(samples, sampleLengths);
 }
 
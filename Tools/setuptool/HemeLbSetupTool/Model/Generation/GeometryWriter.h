@@ -9,24 +9,33 @@
 
 #include <string>
 #include <cstdio>
+#include <vector>
 
 #include "Index.h"
+#include "BlockWriter.h"
+#include "BlockCompressor.h"
 
 #include "io/writers/xdr/XdrWriter.h"
 using hemelb::io::writers::xdr::XdrWriter;
 
-class BlockWriter;
 class BufferPool;
 
 class GeometryWriter {
 public:
+	// With writeBlockStats, Close also writes a block statistics file (see
+	// io/formats/blockstats.h) beside the geometry file. compression is one
+	// of the geometry format's BlockCompressions.
 	GeometryWriter(const std::string& OutputGeometryFile, int BlockSize,
-			Index BlockCounts);
+			Index BlockCounts, bool writeBlockStats = false,
+			unsigned int compression = 0);
 
 	~GeometryWriter();
 
 	void Close();
 	BlockWriter* StartNextBlock();
+	// Called with each batch of blocks before they are finished; the first
+	// trains the zstd dictionary, if there is to be one.
+	void PrepareToCompress(const std::vector<BlockWriter*>& blockWriters);
 
 protected:
 	std::string OutputGeometryFile;
@@ -38,8 +47,16 @@ protected:
 	unsigned int headerBufferLength;
 	char *headerBuffer;
 
+	int dictionaryStart;
+	BlockCompressor Compressor;
+	bool dictionaryTrained;
+
 	int bodyStart;
 	FILE* bodyFile;
+	uint64_t bodyBytes;
+
+	bool writeBlockStats;
+	std::vector<BlockStats> blockStats;
 	BufferPool* BlockBufferPool;
 	friend class BlockWriter;
 };
@@ -0,0 +1,197 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+
+#include <zlib.h>
+
+#include "ParallelGeometryWriter.h"
+#include "BlockWriter.h"
+#include "BufferPool.h"
+#include "GenerationError.h"
+
+#include "io/formats/formats.h"
+#include "io/formats/geometry.h"
+
+using hemelb::io::formats::geometry;
+
+ParallelGeometryWriter::ParallelGeometryWriter(
+		const std::string& OutputGeometryFile, int BlockSize,
+		Index BlockCounts, MPI_Comm comm, unsigned int firstBlock,
+		unsigned int blockCount, bool writeBlockStats, unsigned int compression) :
+		OutputGeometryFile(OutputGeometryFile), BlockSize(BlockSize), comm(
+				comm), firstBlock(firstBlock), Compressor(compression), writeBlockStats(
+				writeBlockStats) {
+
+	this->BlockBufferPool = new BufferPool(
+			geometry::GetMaxBlockRecordLength(BlockSize));
+
+	for (unsigned int i = 0; i < 3; ++i) {
+		this->BlockCounts[i] = BlockCounts[i];
+	}
+
+	this->headerBufferLength = geometry::HeaderRecordLength * blockCount;
+	// Keep the buffer valid even for a rank with no blocks.
+	this->headerBuffer = new char[std::max(this->headerBufferLength, 1U)];
+	this->headerEncoder = new hemelb::io::writers::xdr::XdrMemWriter(
+			this->headerBuffer, this->headerBufferLength);
+}
+
+ParallelGeometryWriter::~ParallelGeometryWriter() {
+	delete this->headerEncoder;
+	delete[] this->headerBuffer;
+	delete this->BlockBufferPool;
+}
+
+void ParallelGeometryWriter::Close() {
+	int rank;
+	MPI_Comm_rank(this->comm, &rank);
+
+	// Where this rank's blocks start, after those of the ranks before it.
+	unsigned long long bodyBytes = this->body.size();
+	unsigned long long bodyOffset = 0;
+	MPI_Exscan(&bodyBytes, &bodyOffset, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM,
+			this->comm);
+	if (rank == 0) {
+		// The scan leaves rank 0's undefined.
+		bodyOffset = 0;
+	}
+
+	MPI_File file;
+	if (MPI_File_open(this->comm, const_cast<char*>(this->OutputGeometryFile.c_str()),
+			MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &file)
+			!= MPI_SUCCESS) {
+		throw GenerationErrorMessage(
+				"Cannot open geometry file " + this->OutputGeometryFile);
+	}
+	// Get rid of anything longer that was there before.
+	MPI_File_set_size(file, 0);
+
+	const unsigned int nBlocks = this->BlockCounts[0] * this->BlockCounts[1]
+			* this->BlockCounts[2];
+	const MPI_Offset headerStart = geometry::PreambleLength;
+	const MPI_Offset dictionaryStart = headerStart
+			+ MPI_Offset(geometry::HeaderRecordLength) * nBlocks;
+	const MPI_Offset bodyStart = geometry::GetBlockDataStart(nBlocks,
+			this->Compressor.GetCompression());
+	// A zstd file's dictionary space, saying there is no dictionary.
+	std::vector<char> dictionary(bodyStart - dictionaryStart, 0);
+
+	char preamble[geometry::PreambleLength];
+	if (rank == 0) {
+		hemelb::io::writers::xdr::XdrMemWriter encoder(preamble,
+				geometry::PreambleLength);
+		encoder
+				<< static_cast<unsigned int>(hemelb::io::formats::HemeLbMagicNumber);
+		encoder
+				<< static_cast<unsigned int>(hemelb::io::formats::geometry::MagicNumber);
+		encoder
+				<< static_cast<unsigned int>(hemelb::io::formats::geometry::VersionNumber);
+		for (unsigned int i = 0; i < 3; ++i)
+			encoder << this->BlockCounts[i];
+		encoder << this->BlockSize;
+		// How the blocks are compressed
+		encoder << this->Compressor.GetCompression();
+		MPI_File_write_at(file, 0, preamble, geometry::PreambleLength,
+				MPI_CHAR, MPI_STATUS_IGNORE);
+		if (!dictionary.empty())
+			MPI_File_write_at(file, dictionaryStart, &dictionary[0],
+					dictionary.size(), MPI_CHAR, MPI_STATUS_IGNORE);
+	}
+
+	MPI_File_write_at_all(file,
+			headerStart + MPI_Offset(geometry::HeaderRecordLength) * this->firstBlock,
+			this->headerBuffer, this->headerBufferLength, MPI_CHAR,
+			MPI_STATUS_IGNORE);
+
+	// Write in pieces small enough for an int to count.
+	const unsigned long long maxPiece = 1ULL << 30;
+	for (unsigned long long written = 0; written < bodyBytes; written +=
+			maxPiece) {
+		const int piece = std::min(maxPiece, bodyBytes - written);
+		MPI_File_write_at(file, bodyStart + bodyOffset + written,
+				&this->body[written], piece, MPI_CHAR, MPI_STATUS_IGNORE);
+	}
+
+	MPI_File_close(&file);
+	std::vector<char>().swap(this->body);
+
+	if (this->writeBlockStats) {
+		this->WriteBlockStats(rank, preamble, dictionary,
+				bodyStart + bodyOffset);
+	}
+}
+
+void ParallelGeometryWriter::WriteBlockStats(int rank, const char* preamble,
+		const std::vector<char>& dictionary, unsigned long long bodyStart) {
+	namespace blockstats = hemelb::io::formats::blockstats;
+
+	// Rank 0 needs the whole header for the geometry's checksum.
+	int ranks;
+	MPI_Comm_size(this->comm, &ranks);
+	int headerBytes = this->headerBufferLength;
+	std::vector<int> headerBytesOnEachRank(ranks);
+	MPI_Gather(&headerBytes, 1, MPI_INT, &headerBytesOnEachRank[0], 1, MPI_INT,
+			0, this->comm);
+	std::vector<int> headerStartOnEachRank(ranks, 0);
+	for (int i = 1; i < ranks; ++i) {
+		headerStartOnEachRank[i] = headerStartOnEachRank[i - 1]
+				+ headerBytesOnEachRank[i - 1];
+	}
+	std::vector<char> header(
+			rank == 0 ?
+					headerStartOnEachRank.back() + headerBytesOnEachRank.back() :
+					1);
+	MPI_Gatherv(this->headerBuffer, headerBytes, MPI_CHAR, &header[0],
+			&headerBytesOnEachRank[0], &headerStartOnEachRank[0], MPI_CHAR, 0,
+			this->comm);
+
+	MPI_File file;
+	const std::string path = this->OutputGeometryFile + blockstats::Extension();
+	if (MPI_File_open(this->comm, const_cast<char*>(path.c_str()),
+			MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &file)
+			!= MPI_SUCCESS) {
+		throw GenerationErrorMessage("Cannot open block statistics file " + path);
+	}
+	MPI_File_set_size(file, 0);
+
+	if (rank == 0) {
+		uLong checksum = crc32(0L, Z_NULL, 0);
+		checksum = crc32(checksum, reinterpret_cast<const Bytef*>(preamble),
+				geometry::PreambleLength);
+		checksum = crc32(checksum, reinterpret_cast<const Bytef*>(&header[0]),
+				header.size());
+		if (!dictionary.empty())
+			checksum = crc32(checksum,
+					reinterpret_cast<const Bytef*>(&dictionary[0]),
+					dictionary.size());
+
+		char statsPreamble[blockstats::PreambleLength];
+		hemelb::io::writers::xdr::XdrMemWriter encoder(statsPreamble,
+				blockstats::PreambleLength);
+		BlockStats::EncodePreamble(encoder,
+				this->BlockCounts[0] * this->BlockCounts[1] * this->BlockCounts[2],
+				checksum);
+		MPI_File_write_at(file, 0, statsPreamble, blockstats::PreambleLength,
+				MPI_CHAR, MPI_STATUS_IGNORE);
+	}
+
+	const unsigned int recordBytes = blockstats::BlockRecordLength
+			* this->blockStats.size();
+	std::vector<char> records(std::max(recordBytes, 1U));
+	hemelb::io::writers::xdr::XdrMemWriter encoder(&records[0], recordBytes);
+	for (unsigned int i = 0; i < this->blockStats.size(); ++i) {
+		this->blockStats[i].Encode(encoder, bodyStart);
+	}
+	MPI_File_write_at_all(file,
+			blockstats::PreambleLength
+					+ MPI_Offset(blockstats::BlockRecordLength) * this->firstBlock,
+			&records[0], recordBytes, MPI_CHAR, MPI_STATUS_IGNORE);
+	MPI_File_close(&file);
+}
+
+BlockWriter* ParallelGeometryWriter::StartNextBlock() {
+	return new BlockWriter(this->BlockBufferPool, &this->Compressor);
+}
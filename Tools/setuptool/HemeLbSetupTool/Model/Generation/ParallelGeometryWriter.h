@@ -0,0 +1,68 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELBSETUPTOOL_PARALLELGEOMETRYWRITER_H
+#define HEMELBSETUPTOOL_PARALLELGEOMETRYWRITER_H
+
+#include <string>
+#include <vector>
+#include <mpi.h>
+
+#include "Index.h"
+#include "BlockWriter.h"
+#include "BlockCompressor.h"
+
+#include "io/writers/xdr/XdrMemWriter.h"
+
+class BufferPool;
+
+/*
+ * Writes a geometry file collectively from the ranks of a communicator,
+ * each of which generates a run of consecutive blocks. A rank's blocks are
+ * kept in memory until Close, which finds where they go in the file with an
+ * exclusive scan over the ranks' compressed sizes. zstd blocks are written
+ * without a dictionary, as every rank would need the same one.
+ */
+class ParallelGeometryWriter {
+public:
+	ParallelGeometryWriter(const std::string& OutputGeometryFile,
+			int BlockSize, Index BlockCounts, MPI_Comm comm,
+			unsigned int firstBlock, unsigned int blockCount,
+			bool writeBlockStats = false, unsigned int compression = 0);
+
+	~ParallelGeometryWriter();
+
+	void Close();
+	BlockWriter* StartNextBlock();
+	void PrepareToCompress(const std::vector<BlockWriter*>& blockWriters) {
+	}
+
+protected:
+	std::string OutputGeometryFile;
+	int BlockSize;
+	Index BlockCounts;
+	MPI_Comm comm;
+	unsigned int firstBlock;
+
+	// The header records of this rank's blocks.
+	hemelb::io::writers::xdr::XdrMemWriter* headerEncoder;
+	unsigned int headerBufferLength;
+	char *headerBuffer;
+
+	// The compressed data of this rank's blocks.
+	std::vector<char> body;
+	BufferPool* BlockBufferPool;
+	BlockCompressor Compressor;
+
+	bool writeBlockStats;
+	std::vector<BlockStats> blockStats;
+	friend class BlockWriter;
+
+	// Write the block statistics file collectively, given the preamble.
+	void WriteBlockStats(int rank, const char* preamble,
+			const std::vector<char>& dictionary, unsigned long long bodyStart);
+};
+
+#endif // HEMELBSETUPTOOL_PARALLELGEOMETRYWRITER_H
@@ -30,6 +30,7 @@
 #include "vtkDataSet.h"
 #include "vtkMatrix4x4.h"
 #include "Block.h"
+#include "ThreadPool.h"
 #include "vtkXMLPolyDataWriter.h"
 
 #include <iostream>
@@ -41,7 +42,8 @@
 using namespace hemelb::io::formats;
 
 PolyDataGenerator::PolyDataGenerator():
-	GeometryGenerator(), ClippedSurface(NULL) {
+	GeometryGenerator(), BlockFloodFill(true), ClippedSurface(NULL),
+	havePreparedBlock(false), preparedBlockFarFromSurface(false) {
 
 	this->Locator = vtkOBBTree::New();
 	//this->Locator->SetNumberOfCellsPerNode(32); // the default
@@ -200,6 +202,9 @@ void PolyDataGenerator::CreateCGALPolygon(void){
 		}
 	}
 	this->AABBtree = new Tree(this->ClippedCGALSurface->facets_begin(),this->ClippedCGALSurface->facets_end());
+	// Build the tree now rather than on the first query, which may be on
+	// any of several threads.
+	this->AABBtree->build();
 	duration = ( std::clock() - start ) / (double) CLOCKS_PER_SEC;
     std::cout << "Preprocessing took: "<< duration << " s " << endl;
 
@@ -242,7 +247,7 @@ void PolyDataGenerator::ClassifySite(Site& site) {
 		 ++neighIt) {
 	  	Site& neigh = *neighIt;
 		unsigned int iNeigh = neighIt.GetNeighbourIndex();
-		int nHits = Intersect(site,neigh);
+		int nHits = Intersect(site,neigh,iNeigh);
 		// Four cases: fluid-fluid, solid-solid, fluid-solid and solid-fluid.
 		// Will handle the last two together.
 		if (site.IsFluid == neigh.IsFluid) {
@@ -391,12 +396,12 @@ void PolyDataGenerator::ClassifySite(Site& site) {
 	this->ComputeAveragedNormal(site);
 }
 
-int PolyDataGenerator::Intersect(Site& site, Site& neigh){
+int PolyDataGenerator::Intersect(Site& site, Site& neigh, unsigned int iNeigh){
 	int nHits;
 	bool debugintersect = false;
 	if (!neigh.IsFluidKnown) {
 	// Neighbour unknown, must always intersect
-		nHits = this->ComputeIntersectionsCGAL(site, neigh);
+		nHits = this->ComputeIntersectionsCGAL(site, neigh, iNeigh);
 		if (nHits % 2 == 0) {
 		// Even # hits, hence neigh has same type as site
 		neigh.IsFluid = site.IsFluid;
@@ -415,7 +420,7 @@ int PolyDataGenerator::Intersect(Site& site, Site& neigh){
 	else {
 	// We know the fluidness of neigh, maybe don't need to intersect
 	if (site.IsFluid != neigh.IsFluid) {
-		nHits = this->ComputeIntersectionsCGAL(site, neigh);
+		nHits = this->ComputeIntersectionsCGAL(site, neigh, iNeigh);
 	// Only in the case of difference must we intersect.
 		if (nHits % 2 == 0) {
 			bool Sinside = InsideOutside(site);
@@ -440,6 +445,10 @@ int PolyDataGenerator::Intersect(Site& site, Site& neigh){
 
 
 
+bool PolyDataGenerator::IsInside(Site& site) {
+	return this->InsideOutside(site);
+}
+
 bool PolyDataGenerator::InsideOutside(Site& site){
 	PointCGAL point(site.Position[0], site.Position[1], site.Position[2]);
 	bool inside;
@@ -498,9 +507,92 @@ int PolyDataGenerator::ComputeIntersections(Site& from, Site& to) {
 	return hitpoints;
 }
 
-int PolyDataGenerator::ComputeIntersectionsCGAL(Site& from, Site& to) {
-	PointCGAL p1(from.Position[0], from.Position[1], from.Position[2]);
-	PointCGAL p2(to.Position[0], to.Position[1], to.Position[2]);
+bool PolyDataGenerator::BlockNearSurface(const Block& block) const {
+	// The sites' links reach one site beyond the block on every side; pad
+	// that a little more so that touching the surface counts.
+	const int blockSize = block.GetDomain().GetBlockSize();
+	const Vector lower = block.GetDomain().CalcPositionWorkingFromIndex(
+			block.GetIndex() * blockSize - Index(1));
+	const double pad = 1e-3;
+	const CGAL::Bbox_3 box(lower[0] - pad, lower[1] - pad, lower[2] - pad,
+			lower[0] + blockSize + 1 + pad, lower[1] + blockSize + 1 + pad,
+			lower[2] + blockSize + 1 + pad);
+	return this->AABBtree->do_intersect(box);
+}
+
+void PolyDataGenerator::PrepareBlock(Block& block, ThreadPool& pool) {
+	const unsigned int siteCount = block.end() - block.begin();
+	this->preparedLinks.resize(siteCount * Neighbours::n);
+	for (unsigned int i = 0; i < this->preparedLinks.size(); ++i) {
+		this->preparedLinks[i].Valid = false;
+	}
+	this->preparedBlockIndex = block.GetIndex();
+	this->havePreparedBlock = true;
+	this->threadHitCellIds.resize(pool.GetThreadCount());
+
+	// No link of a block well away from the surface can cross it, so every
+	// site in it has the fluidness of the one it is reached from.
+	this->preparedBlockFarFromSurface = this->BlockFloodFill
+			&& !this->BlockNearSurface(block);
+	if (this->preparedBlockFarFromSurface) {
+		return;
+	}
+
+	// Intersect every link from the block's sites to later ones with the
+	// surface, whether or not classification will need it.
+
+	// Neighbouring sites aren't dereferenced, as that would make blocks.
+	const Domain& domain = block.GetDomain();
+	SiteIterator firstSite = block.begin();
+	pool.ForEach(siteCount,
+			[this, &domain, firstSite](unsigned int worker, unsigned int siteIndex) {
+				Site& site = *firstSite[siteIndex];
+				for (LaterNeighbourIterator neighIt = site.begin();
+						neighIt != site.end(); ++neighIt) {
+					const unsigned int iNeigh = neighIt.GetNeighbourIndex();
+					const Vector neighPosition = domain.CalcPositionWorkingFromIndex(
+							site.GetIndex() + Index(Neighbours::vectors[iNeigh]));
+					PreparedLink& link =
+							this->preparedLinks[siteIndex * Neighbours::n + iNeigh];
+					link.nHits = this->ComputeIntersectionsCGAL(site.Position,
+							neighPosition, this->threadHitCellIds[worker],
+							link.Intersections);
+					link.Valid = true;
+				}
+			});
+}
+
+int PolyDataGenerator::ComputeIntersectionsCGAL(Site& from, Site& to,
+		unsigned int iNeigh) {
+	// Use the intersections from PrepareBlock if it has done this link.
+	if (this->havePreparedBlock
+			&& from.GetBlock().GetIndex() == this->preparedBlockIndex) {
+		if (this->preparedBlockFarFromSurface) {
+			this->IntersectionCGAL.clear();
+			return 0;
+		}
+		const int blockSize = from.GetDomainBlockSize();
+		const Index local = from.GetIndex()
+				- this->preparedBlockIndex * blockSize;
+		const unsigned int siteIndex = (local[0] * blockSize + local[1])
+				* blockSize + local[2];
+		PreparedLink& link = this->preparedLinks[siteIndex * Neighbours::n
+				+ iNeigh];
+		if (link.Valid) {
+			this->IntersectionCGAL.swap(link.Intersections);
+			link.Valid = false;
+			return link.nHits;
+		}
+	}
+	return this->ComputeIntersectionsCGAL(from.Position, to.Position,
+			this->hitCellIdsCGAL, this->IntersectionCGAL);
+}
+
+int PolyDataGenerator::ComputeIntersectionsCGAL(const Vector& from,
+		const Vector& to, std::vector<Object_and_primitive_id>& hitCellIds,
+		std::vector<Object_Primitive_and_distance>& intersections) const {
+	PointCGAL p1(from[0], from[1], from[2]);
+	PointCGAL p2(to[0], to[1], to[2]);
 	PointCGAL p3;
 	PointCGAL v1;
 	PointCGAL v2;
@@ -511,14 +603,14 @@ int PolyDataGenerator::ComputeIntersectionsCGAL(Site& from, Site& to) {
 	SegmentCGAL segment_query(p1,p2);
 	int ori[5];
 	int nHitsCGAL = this->AABBtree->number_of_intersected_primitives(segment_query);
-	this->hitCellIdsCGAL.clear();
-	this->IntersectionCGAL.clear();
-	this->AABBtree->all_intersections(segment_query, std::back_inserter(this->hitCellIdsCGAL));
+	hitCellIds.clear();
+	intersections.clear();
+	this->AABBtree->all_intersections(segment_query, std::back_inserter(hitCellIds));
 	Object_Primitive_and_distance OPD;
 
 	if (nHitsCGAL) {
-	    for (std::vector<Object_and_primitive_id>::iterator i = this->hitCellIdsCGAL.begin();
-		 i != this->hitCellIdsCGAL.end(); ++i) {
+	    for (std::vector<Object_and_primitive_id>::iterator i = hitCellIds.begin();
+		 i != hitCellIds.end(); ++i) {
 		 	f = i->second;
 			
 			v1 = f->halfedge()->vertex()->point();
@@ -533,14 +625,14 @@ int PolyDataGenerator::ComputeIntersectionsCGAL(Site& from, Site& to) {
 			if(CGAL::assign(hitpoint,i->first)){
 				double distance = CGAL::to_double(CGAL::sqrt(CGAL::squared_distance(hitpoint,p1)));
 				OPD = std::make_pair(*i,distance);
-				this->IntersectionCGAL.push_back(OPD);
+				intersections.push_back(OPD);
 			}
 			else if (CGAL::assign(hitsegment,i->first)){
 				double distance1 = CGAL::to_double(CGAL::sqrt(CGAL::squared_distance(hitsegment.vertex(0),p1)));
 				double distance2 = CGAL::to_double(CGAL::sqrt(CGAL::squared_distance(hitsegment.vertex(1),p1)));
 				double distance = (distance1 + distance2)/2;
 				OPD = std::make_pair(*i,distance);
-				this->IntersectionCGAL.push_back(OPD);
+				intersections.push_back(OPD);
 			}
 			else{
 				throw GenerationErrorMessage(
@@ -557,7 +649,7 @@ int PolyDataGenerator::ComputeIntersectionsCGAL(Site& from, Site& to) {
 	}
 
 	if (nHitsCGAL != 1){		
-		std::sort(this->IntersectionCGAL.begin(), this->IntersectionCGAL.end(), distancesort);
+		std::sort(intersections.begin(), intersections.end(), distancesort);
 	}
 	return nHitsCGAL;
 }
@@ -49,6 +49,18 @@ public:
 		this->SeedPointWorking[2] = z;
 	}
 
+	/*
+	 * Whether to intersect the surface only with the links of blocks that
+	 * it comes near. The sites of other blocks get their fluidness from
+	 * their neighbours without intersecting any links.
+	 */
+	inline bool GetBlockFloodFill(void) {
+		return this->BlockFloodFill;
+	}
+	inline void SetBlockFloodFill(bool val) {
+		this->BlockFloodFill = val;
+	}
+
 	inline vtkPolyData* GetClippedSurface(void) {
 		return this->ClippedSurface;
 	}
@@ -62,14 +74,23 @@ private:
 	void CreateCGALPolygon(void);
 	void ClosePolygon(void);
 	void ClassifySite(Site& site);
+	virtual bool IsInside(Site& site);
+	virtual void PrepareBlock(Block& block, ThreadPool& pool);
 	int ComputeIntersections(Site& from, Site& to);
-	int ComputeIntersectionsCGAL(Site& from, Site& to);
+	int ComputeIntersectionsCGAL(Site& from, Site& to, unsigned int iNeigh);
+	int ComputeIntersectionsCGAL(const Vector& from, const Vector& to,
+			std::vector<Object_and_primitive_id>& hitCellIds,
+			std::vector<Object_Primitive_and_distance>& intersections) const;
 	bool InsideOutside(Site& site);
+	// Whether the surface comes within the box around a block's sites and
+	// their neighbours.
+	bool BlockNearSurface(const Block& block) const;
 	BuildCGALPolygon<HalfedgeDS>* triangle;
 	// represents whether the block is inside (-1) outside (+1) or undetermined (0)
 	virtual int BlockInsideOrOutsideSurface(const Block &block);
 	// Members set from outside to initialise
 	double SeedPointWorking[3];
+	bool BlockFloodFill;
 	vtkPolyData* ClippedSurface;
 	vtkOBBTree* Locator;
 	Polyhedron* ClippedCGALSurface;
@@ -82,7 +103,25 @@ private:
 	std::vector<Object_Primitive_and_distance> IntersectionCGAL;
 	vtkIntArray* IoletIdArray;
 	std::vector<PointCGAL> HitPointsCGAL;
-	int Intersect(Site& site, Site& neigh);
+	int Intersect(Site& site, Site& neigh, unsigned int iNeigh);
+
+	// The intersections of a link with the surface, worked out ahead by
+	// PrepareBlock.
+	struct PreparedLink {
+		bool Valid;
+		int nHits;
+		std::vector<Object_Primitive_and_distance> Intersections;
+	};
+	// The block that preparedLinks are for, whether there is one, and
+	// whether its links were found not to cross the surface at all.
+	Index preparedBlockIndex;
+	bool havePreparedBlock;
+	bool preparedBlockFarFromSurface;
+	// Indexed by the site's position in the block times Neighbours::n plus
+	// the neighbour index.
+	std::vector<PreparedLink> preparedLinks;
+	// Each pool thread's scratch space for the AABB tree's hits.
+	std::vector<std::vector<Object_and_primitive_id> > threadHitCellIds;
 	static bool distancesort(const Object_Primitive_and_distance i,const Object_Primitive_and_distance j);
 
 };
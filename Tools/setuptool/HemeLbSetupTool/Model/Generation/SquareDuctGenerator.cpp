@@ -44,6 +44,10 @@ bool IsInsideDuct(SquareDuctData* duct, Vector& pt) {
 	return true;
 }
 
+bool SquareDuctGenerator::IsInside(Site& site) {
+	return IsInsideDuct(this->SquareDuct, site.Position);
+}
+
 /*
  * Given a site with known fluidness, examine the links to not-yet-visited
  * neighbouring sites. If the neighbours have unknown fluidness, set that.
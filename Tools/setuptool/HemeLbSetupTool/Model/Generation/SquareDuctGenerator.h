@@ -42,6 +42,7 @@ public:
 private:
 	virtual void ComputeBounds(double []) const;
 	void ClassifySite(Site& site);
+	virtual bool IsInside(Site& site);
 	SquareDuctData* SquareDuct;
 protected:
 	virtual int BlockInsideOrOutsideSurface(const Block &block) {
@@ -0,0 +1,95 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int threads) :
+		task(NULL), count(0), next(0), generation(0), busy(0), stopping(false) {
+	// The calling thread is worker 0.
+	for (unsigned int worker = 1; worker < threads; ++worker) {
+		this->workers.push_back(std::thread(&ThreadPool::Work, this, worker));
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stopping = true;
+	}
+	this->started.notify_all();
+	for (unsigned int i = 0; i < this->workers.size(); ++i) {
+		this->workers[i].join();
+	}
+}
+
+unsigned int ThreadPool::GetThreadCount() const {
+	return this->workers.size() + 1;
+}
+
+void ThreadPool::ForEach(unsigned int count, const Task& task) {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->task = &task;
+		this->count = count;
+		this->next = 0;
+		this->busy = this->workers.size();
+		this->error = std::exception_ptr();
+		++this->generation;
+	}
+	this->started.notify_all();
+
+	this->RunItems(0);
+
+	std::unique_lock<std::mutex> lock(this->mutex);
+	while (this->busy > 0) {
+		this->finished.wait(lock);
+	}
+	this->task = NULL;
+	if (this->error) {
+		std::rethrow_exception(this->error);
+	}
+}
+
+void ThreadPool::Work(unsigned int worker) {
+	unsigned int seen = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			while (!this->stopping && this->generation == seen) {
+				this->started.wait(lock);
+			}
+			if (this->stopping) {
+				return;
+			}
+			seen = this->generation;
+		}
+
+		this->RunItems(worker);
+
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if (--this->busy == 0) {
+			this->finished.notify_one();
+		}
+	}
+}
+
+void ThreadPool::RunItems(unsigned int worker) {
+	while (true) {
+		const unsigned int item = this->next++;
+		if (item >= this->count) {
+			return;
+		}
+		try {
+			(*this->task)(worker, item);
+		} catch (...) {
+			std::lock_guard<std::mutex> lock(this->mutex);
+			if (!this->error) {
+				this->error = std::current_exception();
+			}
+			// Stop handing out items.
+			this->next = this->count;
+		}
+	}
+}
@@ -0,0 +1,53 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELBSETUPTOOL_THREADPOOL_H
+#define HEMELBSETUPTOOL_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of threads that share out the items of a loop between them.
+class ThreadPool {
+public:
+	typedef std::function<void(unsigned int, unsigned int)> Task;
+
+	// C'tor- argument is the number of threads, including the calling one.
+	ThreadPool(unsigned int threads);
+	~ThreadPool();
+
+	unsigned int GetThreadCount() const;
+
+	// Call task(worker, item) for every item from 0 to count - 1, where
+	// worker (from 0 to GetThreadCount() - 1) identifies the thread running
+	// it, and return once all are done. If any call throws, the remaining
+	// items are skipped and the first exception is rethrown here.
+	void ForEach(unsigned int count, const Task& task);
+
+private:
+	void Work(unsigned int worker);
+	void RunItems(unsigned int worker);
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable started;
+	std::condition_variable finished;
+
+	// The loop being run, which the workers pick up when generation changes.
+	const Task* task;
+	unsigned int count;
+	std::atomic<unsigned int> next;
+	unsigned int generation;
+	unsigned int busy;
+	bool stopping;
+	std::exception_ptr error;
+};
+
+#endif // HEMELBSETUPTOOL_THREADPOOL_H
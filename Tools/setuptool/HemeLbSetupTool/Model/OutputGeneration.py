@@ -6,6 +6,7 @@
 
 import numpy as np
 import os.path
+import multiprocessing
 
 from vtk import vtkClipPolyData, vtkAppendPolyData, vtkPlane, vtkStripper, \
     vtkFeatureEdges, vtkPolyDataConnectivityFilter, vtkProgrammableFilter, \
@@ -30,6 +31,16 @@ import pdb
 np.seterr(divide='ignore')
 
 
+def _MpiRank():
+    """The MPI rank, when running in parallel with mpi4py, or else 0.
+    """
+    try:
+        from mpi4py import MPI
+    except ImportError:
+        return 0
+    return MPI.COMM_WORLD.Get_rank()
+
+
 def DVfromV(v):
     """Translate a Model.Vector.Vector to a Generation.DoubleVector.
     """
@@ -40,6 +51,13 @@ class GeometryGenerator(object):
 
     def __init__(self):
         self.skipNonIntersectingBlocks = False
+        self.threads = multiprocessing.cpu_count()
+        # Write per-block site statistics beside the geometry file, which
+        # HemeLB uses to balance its first decomposition.
+        self.writeBlockStats = False
+        # How to compress the blocks: 0 for zlib, 1 for zstd (see
+        # io/formats/geometry.h).
+        self.blockCompression = 0
 
     def _MakeIoletProxies(self):
         # Construct the Iolet structs
@@ -72,6 +90,9 @@ class GeometryGenerator(object):
         # We need to keep a reference to this to make sure it's not GC'ed
         self.ioletProxies = self._MakeIoletProxies()
         self.generator.SetIolets(self.ioletProxies)
+        self.generator.SetThreads(self.threads)
+        self.generator.SetWriteBlockStats(self.writeBlockStats)
+        self.generator.SetBlockCompression(self.blockCompression)
         return
 
     def Execute(self):
@@ -80,9 +101,10 @@ class GeometryGenerator(object):
         t = Timer()
         t.Start()
         self.generator.Execute(self.skipNonIntersectingBlocks)
-        XmlWriter(self).Write()
-        t.Stop()
-        print "Setup time: %f s" % t.GetTime()
+        if _MpiRank() == 0:
+            XmlWriter(self).Write()
+            t.Stop()
+            print "Setup time: %f s" % t.GetTime()
         return
 
     pass
@@ -303,8 +303,8 @@ if __name__ == "__main__":
     vtkLibBaseNames = ['vtkCommonCore', 'vtkCommonDataModel', 'vtkFiltersGeneral', 'vtkFiltersSources']
     libraries = ['CGAL', 'gmp'] + AddVTKVersionToLibNames(vtkLibBaseNames)
     library_dirs = [vtkLibDir]
-    extra_compile_args = ['-std=c++11'] + GetVtkCompileFlags(vtkLibDir) + GetHemeLbCompileFlags()
-    extra_link_args = []
+    extra_compile_args = ['-std=c++11', '-pthread'] + GetVtkCompileFlags(vtkLibDir) + GetHemeLbCompileFlags()
+    extra_link_args = ['-pthread']
     
     # Create the list of extension modules
     ext_modules = []
@@ -314,6 +314,7 @@ if __name__ == "__main__":
                                   'BuildCGALPolygon.cpp',
                                   'Block.cpp',
                                   'BlockWriter.cpp',
+                                  'BlockCompressor.cpp',
                                   'BufferPool.cpp',
                                   'GeometryGenerator.cpp',
                                   'GeometryWriter.cpp',
@@ -324,6 +325,7 @@ if __name__ == "__main__":
                                   'CylinderGenerator.cpp',
                                   'PolyDataGenerator.cpp',
                                   'SquareDuctGenerator.cpp',
+                                  'ThreadPool.cpp',
                                   'Debug.cpp']]
     # HemeLB classes
     hemelb_cpp = [os.path.join(HemeLbDir, cpp)
@@ -336,6 +338,22 @@ if __name__ == "__main__":
                               'io/writers/xdr/XdrWriter.cc',
                               'io/writers/Writer.cc']]
 
+    # With HEMELB_SETUPTOOL_MPI set, build with the MPI compiler so that
+    # generation is spread over the ranks when run under mpirun (with mpi4py
+    # to initialise MPI).
+    if os.getenv('HEMELB_SETUPTOOL_MPI'):
+        os.environ.setdefault('CC', 'mpicxx')
+        os.environ.setdefault('CXX', 'mpicxx')
+        os.environ.setdefault('LDSHARED', 'mpicxx -shared')
+        extra_compile_args.append('-DHEMELB_SETUPTOOL_MPI')
+        generation_cpp.append('HemeLbSetupTool/Model/Generation/ParallelGeometryWriter.cpp')
+
+    # With HEMELB_SETUPTOOL_ZSTD set, geometry blocks can be compressed with
+    # zstd (which HemeLB must be built with HEMELB_USE_ZSTD to read).
+    if os.getenv('HEMELB_SETUPTOOL_ZSTD'):
+        extra_compile_args.append('-DHEMELB_SETUPTOOL_ZSTD')
+        libraries.append('zstd')
+
     # SWIG wrapper
     swig_cpp = ['HemeLbSetupTool/Model/Generation/Wrap.cpp']
     # Do we need to swig it?
@@ -242,6 +242,18 @@ public class DirectBiConnection implements SteeringConnection {
 			dos.writeFloat(sd.getVis_streaklines_per_pulsatile_period());
 			dos.writeFloat(sd.getVis_streakline_length());
 			dos.writeFloat(10.0f); // Max framerate
+			// No region of interest to stream: its corners, a stride of one and a period of zero.
+			for (int i = 0; i < 6; ++i) {
+				dos.writeFloat(0.0f);
+			}
+			dos.writeFloat(1.0f);
+			dos.writeFloat(0.0f);
+			// No restart of a simulation server: no request, the first configuration, not warm.
+			for (int i = 0; i < 3; ++i) {
+				dos.writeFloat(0.0f);
+			}
+			// No samples of the flight recorder asked for.
+			dos.writeFloat(0.0f);
 			return true;
 		} catch (Exception e) {
 
@@ -11,6 +11,9 @@ except ImportError:
     from ordereddict import OrderedDict
     
 import numpy as N
+import struct
+import xdrlib
+import zlib
 
 
 """
@@ -27,6 +30,29 @@ class Image(object):
         self.data = N.frombuffer(unpacker.unpack_fopaque(pixel_count * Image.bytes_per_pixel), dtype=Image.pixel)
     
         
+    @staticmethod
+    def from_frame(width, height, frame_length, unpacker):
+        """
+        Read an image whose pixels take frame_length bytes, whether raw or encoded
+        """
+        data = unpacker.unpack_fopaque(frame_length)
+        if len(data) >= 4 and struct.unpack('>I', data[:4])[0] == Image.hemelb_magic:
+            data = Image.inflate(data)
+        return Image(width, height, len(data) / Image.bytes_per_pixel, xdrlib.Unpacker(data))
+
+    @staticmethod
+    def inflate(block):
+        """
+        Recover the raw pixels from a deflate encoded block: a header of six uints, then
+        the zlib stream of the byte planes of the pixels, with position differences.
+        """
+        magic, image_magic, version, encoding, count, length = struct.unpack('>6I', block[:24])
+        planes = N.frombuffer(zlib.decompress(block[24:24 + length]), dtype=N.uint8)
+        pixels = planes.reshape(Image.bytes_per_pixel, count).T.copy()
+        positions = pixels[:, :4].copy().view('>u4')
+        pixels[:, :4] = N.cumsum(positions, dtype=N.uint32).astype('>u4').view(N.uint8).reshape(count, 4)
+        return pixels.tostring()
+
     def pil(self, component='velocity'):
         """ 
         Transform the data to python image library format
@@ -46,5 +72,6 @@ class Image(object):
     subimages=['velocity', 'stress', 'pressure', 'stress2']
     colors=['red', 'green', 'blue']
     fields=["%s_%s" % (subimage, color) for subimage in subimages for color in colors ]
+    hemelb_magic=0x686c6221 # Starts an encoded block of pixels rather than a raw pixel
     bytes_per_pixel=2*2 + 3*4 #each of three colors with four sub-images per color and two two-byte coordinates
     pixel=N.dtype({'names': ['x', 'y'] + fields, 'formats': [N.dtype('>H')] * 2 + [N.uint8] * len(subimages) * len(colors)})
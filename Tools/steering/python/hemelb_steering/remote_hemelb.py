@@ -8,6 +8,7 @@ from paged_socket import PagedSocket
 from steered_parameter import SteeredParameter
 from image import Image
 from config import config
+import numpy as N
 import xdrlib
 
 class RemoteHemeLB(object):
@@ -27,11 +28,16 @@ class RemoteHemeLB(object):
             additional_receive_length_function=RemoteHemeLB._calculate_receive_length)
         self.latitude = 0
         self.image = None
+        self.region = None
         for steered_parameter in self.steered_parameters:
             steered_parameter.initialise_in_instance(self, config['steered_parameter_defaults'][steered_parameter.name])
 
     xdr_int_bytes = 4
     xdr_double_bytes = 8
+    # A frame of field data for the steered region has this in place of the image width.
+    field_frame_marker = -1
+    region_site = N.dtype({'names': ['x', 'y', 'z', 'pressure', 'velocity_x', 'velocity_y', 'velocity_z'],
+                           'formats': [N.dtype('>i4')] * 3 + [N.dtype('>f4')] * 4})
 
     def step(self):
         self.receive()
@@ -50,15 +56,25 @@ class RemoteHemeLB(object):
         width = unpacker.unpack_int()
         height = unpacker.unpack_int()
         frame = unpacker.unpack_int()
+        if width == RemoteHemeLB.field_frame_marker:
+            # The step, then the number of sites.
+            return frame * RemoteHemeLB.region_site.itemsize
         return frame + 3*RemoteHemeLB.xdr_double_bytes + 3*RemoteHemeLB.xdr_int_bytes
         
     def receive(self):
         page = self.socket.receive()
         unpacker = xdrlib.Unpacker(page)
-        self.width = unpacker.unpack_int()
+        width = unpacker.unpack_int()
+        if width == RemoteHemeLB.field_frame_marker:
+            self.region_time_step = unpacker.unpack_int()
+            site_count = unpacker.unpack_int()
+            self.region = N.frombuffer(unpacker.unpack_fopaque(site_count * RemoteHemeLB.region_site.itemsize),
+                dtype=RemoteHemeLB.region_site)
+            return
+        self.width = width
         self.height = unpacker.unpack_int()
         self.frame = unpacker.unpack_int()
-        self.image = Image(self.width, self.height, self.frame / Image.bytes_per_pixel, unpacker)
+        self.image = Image.from_frame(self.width, self.height, self.frame, unpacker)
         self.time_step = unpacker.unpack_int()
         self.time = unpacker.unpack_double()
         unpacker.unpack_int() # throw away cycle
@@ -45,6 +45,29 @@ class TestRemoteHemeLB(unittest.TestCase):
 	    self.assertEqual(7, self.rhlb.time_step)
 	    self.assertEqual(0.7, self.rhlb.time)
 	    
+	def test_receive_region(self):
+	    fixture = xdrlib.Packer()
+	    fixture.pack_int(-1) # a field frame
+	    fixture.pack_int(9) # step
+	    fixture.pack_int(2) # sites
+	    for site in xrange(2):
+	        fixture.pack_int(site) #x
+	        fixture.pack_int(3) #y
+	        fixture.pack_int(4) #z
+	        fixture.pack_float(80.0 + site) #pressure
+	        fixture.pack_float(0.5) #velocity
+	        fixture.pack_float(0.0)
+	        fixture.pack_float(-0.5)
+	    header = fixture.get_buffer()[:12]
+	    self.assertEqual(2 * 28, RemoteHemeLB._calculate_receive_length(header))
+	    self.mockSocket.receive.return_value = str(bytearray(fixture.get_buffer()))
+	    self.rhlb.step()
+	    self.assertEqual(9, self.rhlb.region_time_step)
+	    self.assertEqual([0, 1], list(self.rhlb.region['x']))
+	    self.assertEqual(81.0, self.rhlb.region['pressure'][1])
+	    self.assertEqual(-0.5, self.rhlb.region['velocity_z'][0])
+	    self.assertEqual(None, self.rhlb.image)
+	    
 	def test_no_change_no_send(self):
 	    self.rhlb.step()
 	    self.assertEqual(self.rhlb.Latitude, 45.0)
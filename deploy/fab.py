@@ -27,6 +27,7 @@ import numpy as np
 import yaml
 import tempfile
 from os.path import expanduser
+import scaling
 
 
 @task
@@ -578,6 +579,55 @@ def hemelb_benchmark(config, min_cores, max_cores, **args):
             cores=cores_used, images=10, steering=1111, wall_time='0:15:0', memory='2G'), args)
         cores_used *= 2
 
+def scaling_cases(geometries, resolutions):
+    return [(geometry, int(resolution))
+            for geometry in (geometries.split(';') if geometries else scaling.GEOMETRIES)
+            for resolution in (resolutions.split(';') if resolutions else scaling.RESOLUTIONS)]
+
+@task
+def scaling_configs(geometries=None, resolutions=None, steps=scaling.STEPS):
+    """Generate the synthetic geometries of the scaling suite into the local config store.
+    Configs are named scaling_<geometry>_<resolution>, e.g. scaling_bifurcation_16.
+    geometries : semicolon-separated, from tube, stenosis and bifurcation (default all)
+    resolutions : semicolon-separated voxel counts across the vessel radius (default 8;16;32)
+    steps : time steps to run each config for
+    """
+    for geometry, resolution in scaling_cases(geometries, resolutions):
+        with_config(scaling.config_name(geometry, resolution))
+        scaling.generate_config(geometry, resolution, os.path.expanduser(env.job_config_path_local), steps)
+
+@task
+def scaling_benchmark(min_cores, max_cores, geometries=None, resolutions=None, create_configs=True, **args):
+    """Submit the scaling suite: every synthetic geometry and resolution on <min_cores> to <max_cores> cores,
+    in steps of a factor 2. Strong scaling is read along a config, weak scaling across resolutions.
+    Configs are generated first unless create_configs=False. Gather the timings with scaling_table.
+    """
+    if not str(create_configs).lower()[0] == 'f':
+        scaling_configs(geometries, resolutions)
+    for geometry, resolution in scaling_cases(geometries, resolutions):
+        config = scaling.config_name(geometry, resolution)
+        with_config(config)
+        execute(put_configs, config)
+        cores_used = int(min_cores)
+        while cores_used <= int(max_cores):
+            job(dict(script='scaling', cores=cores_used, images=0, wall_time='0:30:0', memory='2G'), args)
+            cores_used *= 2
+
+@task
+def scaling_table(output='scaling.txt', fetch=True):
+    """Fetch the results of the scaling suite and tabulate the slowest rank's startup, decomposition,
+    LB and I/O times for each run, with the strong scaling of the LB step, into <output> in the local results store.
+    """
+    if not str(fetch).lower()[0] == 'f':
+        fetch_results(regex='scaling_*')
+    with_job('')
+    results = os.path.expanduser(env.job_results_local)
+    out = open(os.path.join(results, output), 'w')
+    jobs = [os.path.join(results, name) for name in os.listdir(results) if scaling.CONFIG_PATTERN.match(name)]
+    scaling.write_table(scaling.scaling_table(jobs), out)
+    out.close()
+    local(template("cat %s" % os.path.join(results, output)))
+
 @task(alias='regress')
 def regression_test(**args):
     """Submit a regression-testing job to the remote queue."""
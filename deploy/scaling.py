@@ -0,0 +1,231 @@
+# This file is part of HemeLB and is Copyright (C)
+# the HemeLB team and/or their institutions, as detailed in the
+# file AUTHORS. This software is provided under the terms of the
+# license in the file LICENSE.
+
+"""
+Strong and weak scaling benchmarks of HemeLB on synthetic vascular geometries.
+
+Configs are named scaling_<geometry>_<resolution>, where the geometry is one of
+tube, stenosis or bifurcation and the resolution is the number of voxels across
+the radius of the (parent) vessel. Every geometry is the same physical size, so
+doubling the resolution gives about eight times the sites.
+
+Usage:
+    python scaling.py generate --out CONFIGS [--geometries ...] [--resolutions ...] [--steps N]
+    python scaling.py run --hemelb HEMELB --configs CONFIGS --out RESULTS [--cores ...]
+    python scaling.py table RESULTS... [--out FILE]
+
+The same configs and table are used by the fab tasks scaling_configs,
+scaling_benchmark and scaling_table, which run the jobs on a remote machine
+with the 'scaling' job template.
+"""
+import os
+import re
+import shutil
+import subprocess
+import sys
+from xml.etree import ElementTree
+
+GEOMETRIES = ('tube', 'stenosis', 'bifurcation')
+RESOLUTIONS = (8, 16, 32)
+CORES = (1, 2, 4, 8)
+STEPS = 1000
+
+# Physical size of every geometry, in metres
+RADIUS = 1e-3
+LENGTH = 1e-2
+# Fraction of the radius lost at the throat of the stenosis
+SEVERITY = 0.5
+# Angle between each daughter vessel and the parent, in degrees
+BIFURCATION_ANGLE = 30.
+# Triangles around the circumference of the surfaces
+SURFACE_RESOLUTION = 64
+
+CONFIG_PATTERN = re.compile(r'(scaling_(?:%s)_\d+)' % '|'.join(GEOMETRIES))
+
+def config_name(geometry, resolution):
+    return 'scaling_%s_%d' % (geometry, int(resolution))
+
+def _setup_paths():
+    """Make the setup tool and surface generators importable from a checkout."""
+    tools = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'Tools')
+    for path in (os.path.join(tools, 'setuptool'), os.path.join(tools, 'hemeTools', 'surfacegenerator')):
+        if path not in sys.path:
+            sys.path.append(path)
+
+def _profile_from_surface(stl, voxel_size, seed, iolets, gmy, xml):
+    from HemeLbSetupTool.Model.Profile import Profile, metre
+    from HemeLbSetupTool.Model.Vector import Vector
+
+    p = Profile()
+    p.StlFileUnitId = Profile._UnitChoices.index(metre)
+    p.StlFile = stl
+    p.VoxelSize = voxel_size
+    p.SeedPoint = Vector(*seed)
+    for iolet in iolets:
+        p.Iolets.append(iolet)
+    p.OutputGeometryFile = gmy
+    p.OutputXmlFile = xml
+    return p
+
+def _iolet(cls, centre, normal, radius):
+    from HemeLbSetupTool.Model.Vector import Vector
+    iolet = cls()
+    iolet.Centre = Vector(*centre)
+    iolet.Normal = Vector(*normal)
+    iolet.Radius = radius
+    return iolet
+
+def generate_config(geometry, resolution, path, steps=STEPS):
+    """Write config.gmy and config.xml for one geometry at one resolution into path."""
+    _setup_paths()
+    from HemeLbSetupTool.Model.OutputGeneration import CylinderGenerator
+    from HemeLbSetupTool.Model.Iolets import Inlet, Outlet
+
+    if not os.path.isdir(path):
+        os.makedirs(path)
+    gmy = os.path.join(path, 'config.gmy')
+    xml = os.path.join(path, 'config.xml')
+    voxel_size = RADIUS / resolution
+    # The iolets sit a few voxels in from the ends of the surfaces, which the setup tool clips
+    inset = 4 * voxel_size
+
+    if geometry == 'tube':
+        CylinderGenerator(gmy, xml, voxel_size, (0., 0., 1.), LENGTH, RADIUS).Execute()
+    elif geometry == 'stenosis':
+        from StenosisGenerator import StenosisGenerator
+        stl = os.path.join(path, 'surface.stl')
+        StenosisGenerator(RADIUS, LENGTH + 2 * inset, SEVERITY, 0.4 * LENGTH, SURFACE_RESOLUTION, stl)
+        iolets = [_iolet(Inlet, (0., 0., -0.5 * LENGTH), (0., 0., 1.), RADIUS),
+                  _iolet(Outlet, (0., 0., 0.5 * LENGTH), (0., 0., -1.), RADIUS)]
+        _profile_from_surface(stl, voxel_size, (0., 0., 0.), iolets, gmy, xml).Generate()
+    elif geometry == 'bifurcation':
+        from BifurcationGenerator import BifurcationGenerator, DaughterDirections, DaughterRadius
+        stl = os.path.join(path, 'surface.stl')
+        BifurcationGenerator(RADIUS, LENGTH, BIFURCATION_ANGLE, SURFACE_RESOLUTION, stl)
+        iolets = [_iolet(Inlet, (0., 0., inset - LENGTH), (0., 0., 1.), RADIUS)]
+        for d in DaughterDirections(BIFURCATION_ANGLE):
+            iolets.append(_iolet(Outlet, (LENGTH - inset) * d, -d, DaughterRadius(RADIUS)))
+        _profile_from_surface(stl, voxel_size, (0., 0., -0.5 * LENGTH), iolets, gmy, xml).Generate()
+    else:
+        raise ValueError("Unknown scaling geometry '%s'" % geometry)
+
+    set_steps(xml, steps)
+
+def set_steps(xml, steps):
+    """Run the config for a fixed number of steps, rather than the setup tool's default duration."""
+    config = ElementTree.parse(xml)
+    config.find('simulation/steps').set('value', str(int(steps)))
+    config.write(xml)
+
+def generate_configs(out, geometries=GEOMETRIES, resolutions=RESOLUTIONS, steps=STEPS):
+    """Generate every combination of geometry and resolution as a config directory under out."""
+    names = []
+    for geometry in geometries:
+        for resolution in resolutions:
+            name = config_name(geometry, resolution)
+            generate_config(geometry, resolution, os.path.join(out, name), steps)
+            names.append(name)
+    return names
+
+def run_local(hemelb, configs, out, cores=CORES, mpiexec='mpirun', numproc_flag='-np'):
+    """Run every config in the configs directory on each number of cores, with mpiexec on this machine.
+    Each run goes in out/<config>_<cores>, laid out as the scaling job template lays out a remote job."""
+    for name in sorted(os.listdir(configs)):
+        if not CONFIG_PATTERN.match(name):
+            continue
+        for n in cores:
+            job = os.path.join(out, '%s_%d' % (name, int(n)))
+            if os.path.isdir(job):
+                shutil.rmtree(job)
+            shutil.copytree(os.path.join(configs, name), job)
+            subprocess.check_call([mpiexec, numproc_flag, str(n), hemelb,
+                                   '-in', 'config.xml', '-out', 'results', '-i', '0'], cwd=job)
+
+def _timer_maxima(report):
+    timers = {}
+    for timer in report.findall('timings/timer'):
+        timers[timer.findtext('name').strip()] = float(timer.findtext('max'))
+    return timers
+
+def read_report(path):
+    """The row of the scaling table for one report.xml: the slowest rank's time in each phase."""
+    report = ElementTree.parse(path).getroot()
+    timers = _timer_maxima(report)
+    match = CONFIG_PATTERN.search(os.path.abspath(path))
+    return dict(config=match.group(1) if match else os.path.dirname(path),
+                sites=int(report.findtext('geometry/sites')),
+                ranks=len(report.findall('geometry/domain')),
+                startup=timers['Total'] - timers['Simulation total'],
+                decomposition=timers['Domain Decomposition'],
+                lb=timers['Lattice Boltzmann'],
+                io=timers['Extraction writing'] + timers['Checkpointing'],
+                total=timers['Total'])
+
+def find_reports(paths):
+    for path in paths:
+        if os.path.isfile(path):
+            yield path
+            continue
+        for root, dirs, files in os.walk(path):
+            if 'report.xml' in files:
+                yield os.path.join(root, 'report.xml')
+
+def scaling_table(paths):
+    """Rows for every report.xml found under paths, sorted by config then ranks, with the
+    strong-scaling speedup and parallel efficiency of the LB step relative to the
+    fewest ranks each config was run on."""
+    rows = sorted((read_report(path) for path in find_reports(paths)),
+                  key=lambda row: (row['config'], row['ranks']))
+    baselines = {}
+    for row in rows:
+        baseline = baselines.setdefault(row['config'], row)
+        row['speedup'] = baseline['lb'] / row['lb'] if row['lb'] > 0 else 0.
+        row['efficiency'] = row['speedup'] * baseline['ranks'] / row['ranks']
+    return rows
+
+COLUMNS = (('config', '%-28s'), ('sites', '%10d'), ('ranks', '%6d'), ('startup', '%10.3f'),
+           ('decomposition', '%14.3f'), ('lb', '%10.3f'), ('io', '%8.3f'), ('total', '%10.3f'),
+           ('speedup', '%8.2f'), ('efficiency', '%10.2f'))
+
+def write_table(rows, out=sys.stdout):
+    """Write the table as whitespace-separated columns, times in seconds."""
+    # Headings as wide as their columns, keeping the same alignment
+    headings = (re.sub(r'(\.\d+)?[a-z]$', 's', fmt) % name for name, fmt in COLUMNS)
+    out.write(' '.join(headings) + '\n')
+    for row in rows:
+        out.write(' '.join(fmt % row[name] for name, fmt in COLUMNS) + '\n')
+
+if __name__ == "__main__":
+    import argparse
+    p = argparse.ArgumentParser(description='HemeLB scaling benchmarks on synthetic geometries')
+    sub = p.add_subparsers(dest='command')
+
+    g = sub.add_parser('generate', help='generate the configs')
+    g.add_argument('--out', required=True, help='directory to put a config directory in for each case')
+    g.add_argument('--geometries', nargs='+', choices=GEOMETRIES, default=GEOMETRIES)
+    g.add_argument('--resolutions', nargs='+', type=int, default=RESOLUTIONS,
+                   help='voxels across the vessel radius')
+    g.add_argument('--steps', type=int, default=STEPS)
+
+    r = sub.add_parser('run', help='run the configs on this machine')
+    r.add_argument('--hemelb', required=True, help='the hemelb executable')
+    r.add_argument('--configs', required=True, help='directory of generated configs')
+    r.add_argument('--out', required=True, help='directory to put a job directory in for each run')
+    r.add_argument('--cores', nargs='+', type=int, default=CORES)
+    r.add_argument('--mpiexec', default='mpirun')
+    r.add_argument('--numproc-flag', default='-np')
+
+    t = sub.add_parser('table', help='tabulate the timings of finished runs')
+    t.add_argument('results', nargs='+', help='report.xml files, or directories to search for them')
+    t.add_argument('--out', help='file to write the table to, instead of standard output')
+
+    args = p.parse_args()
+    if args.command == 'generate':
+        generate_configs(args.out, args.geometries, args.resolutions, args.steps)
+    elif args.command == 'run':
+        run_local(args.hemelb, args.configs, args.out, args.cores, args.mpiexec, args.numproc_flag)
+    else:
+        out = open(args.out, 'w') if args.out else sys.stdout
+        write_table(scaling_table(args.results), out)